@@ -22,6 +22,9 @@
 /* Define if debug output should be supported. */
 #cmakedefine DEBUG
 
+/* Define to compile in the solver trace scopes. */
+#cmakedefine ENABLE_TRACE 1
+
 /* Define to 1 if you have the `acos' function. */
 #cmakedefine HAVE_ACOS 1
 
@@ -136,6 +139,9 @@
 /* Define to 1 if you have the `floor' function. */
 #cmakedefine HAVE_FLOOR 1
 
+/* Define to 1 if you have the `fork' function. */
+#cmakedefine HAVE_FORK 1
+
 /* Define to 1 if you have the <ieeefp.h> header file. */
 #cmakedefine HAVE_IEEEFP_H 1
 
@@ -157,6 +163,9 @@
 /* Define to 1 if you have the <memory.h> header file. */
 #cmakedefine HAVE_MEMORY_H 1
 
+/* Define to 1 if you have the `mmap' function. */
+#cmakedefine HAVE_MMAP 1
+
 /* Define to 1 if you have the `modf' function. */
 #cmakedefine HAVE_MODF 1
 
@@ -28,7 +28,12 @@
 
 #include <stdio.h>
 #include <cmath>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <limits>
 
+#include "logging.h"
 #include "object.h"
 #include "complex.h"
 #include "circuit.h"
@@ -36,11 +41,46 @@
 #include "net.h"
 #include "netdefs.h"
 #include "analysis.h"
+#include "exception.h"
+#include "exceptionstack.h"
+#include "numstatus.h"
 #include "nasolver.h"
 #include "acsolver.h"
+#include "reducer.h"
+#include "threadpool.h"
+#include "batchlu.h"
+
+// Number of frequency points per worker thread solved in one batch.
+#define AC_BATCH_SIZE 8
+
+// Largest number of expansion points of the fast frequency sweep.
+#define AC_FAST_EXPANSIONS 16
+
+// Number of moments matched at each expansion point.
+#define AC_FAST_MOMENTS 8
+
+// Number of sweep points checked while refining the reduced model.
+#define AC_FAST_CHECKS 64
+
+// Solution magnitudes, relative to the largest one, ignored by the
+// adaptive sweep.
+#define AC_ADAPT_FLOOR 1e-6
+
+// Narrowest interval refined by the adaptive sweep, relative to its end.
+#define AC_ADAPT_WIDTH 1e-9
 
 namespace qucs {
 
+/* The structure holds the equation system of a single frequency point
+   during the parallel AC analysis. */
+struct acpoint_t {
+  nr_double_t freq;
+  tmatrix<nr_complex_t> A;
+  tvector<nr_complex_t> x;
+  tvector<nr_complex_t> z;
+  exceptionstack errors;
+};
+
 // Constructor creates an unnamed instance of the acsolver class.
 acsolver::acsolver () : nasolver<nr_complex_t> () {
   swp = NULL;
@@ -48,6 +88,7 @@ acsolver::acsolver () : nasolver<nr_complex_t> () {
   setDescription ("AC");
   xn = NULL;
   noise = 0;
+  noiseNode = -1;
 }
 
 // Constructor creates a named instance of the acsolver class.
@@ -57,6 +98,7 @@ acsolver::acsolver (char * n) : nasolver<nr_complex_t> (n) {
   setDescription ("AC");
   xn = NULL;
   noise = 0;
+  noiseNode = -1;
 }
 
 // Destructor deletes the acsolver class object.
@@ -71,6 +113,8 @@ acsolver::acsolver (acsolver & o) : nasolver<nr_complex_t> (o) {
   swp = o.swp ? new sweep (*(o.swp)) : NULL;
   xn = o.xn ? new tvector<nr_double_t> (*(o.xn)) : NULL;
   noise = o.noise;
+  noiseNode = -1;
+  adaptFreqs = o.adaptFreqs;
 }
 
 /* This is the AC netlist solver.  It prepares the circuit list for
@@ -85,6 +129,12 @@ int acsolver::solve (void) {
   if (swp == NULL) {
     swp = createSweep ("acfrequency");
   }
+  setResultPoints (swp->getSize ());
+
+  // replace large linear subcircuits by reduced models, these are
+  // noiseless thus not used with the noise analysis
+  reducer mor (subnet, getName ());
+  if (!strcmp (getPropertyString ("Reduce"), "yes") && !noise) mor.reduce ();
 
   // initialize node voltages, first guess for non-linear circuits and
   // generate extra circuits if necessary
@@ -92,6 +142,49 @@ int acsolver::solve (void) {
   setCalculation ((calculate_func_t) &calc);
   solve_pre ();
 
+  // the adjoint noise analysis computes the noise of a single node
+  noiseNode = -1;
+  const char * out = getPropertyString ("NoiseNode");
+  if (noise && out != NULL && *out != '\0') {
+    if ((noiseNode = getNodeNr (out)) <= 0) {
+      logprint (LOG_ERROR, "ERROR: %s: no such noise output node `%s'\n",
+		getName (), out);
+      solve_post ();
+      return -1;
+    }
+    noiseNode--;
+    createNoiseSources ();
+  }
+
+  // refine the sweep where the solution is not resolved
+  if (!strcmp (getPropertyString ("Adaptive"), "yes")) {
+    int error = solve_adaptive ();
+    solve_post ();
+    if (progress) logprogressclear (40);
+    return error;
+  }
+
+  // evaluate long sweeps of circuits linear in frequency by a reduced
+  // model, the noise analysis needs the full equation system
+  if (!noise && !strcmp (getPropertyString ("FastSweep"), "yes") &&
+      solve_fast () == 0) {
+    solve_post ();
+    if (progress) logprogressclear (40);
+    return 0;
+  }
+
+  // number of worker threads, zero means one per processor
+  int threads = threadpool::threads (getPropertyInteger ("Threads"));
+
+  // the noise analysis re-uses the factorized matrix, thus run serially
+  if (threads > 1 && !noise) {
+    eqnAlgo = ALGO_LU_DECOMPOSITION;
+    solve_parallel (threads);
+    solve_post ();
+    if (progress) logprogressclear (40);
+    return 0;
+  }
+
   swp->reset ();
   for (int i = 0; i < swp->getSize (); i++) {
     freq = swp->next ();
@@ -107,7 +200,12 @@ int acsolver::solve (void) {
     solve_linear ();
 
     // compute noise if requested
-    if (noise) solve_noise ();
+    if (noise) {
+      if (noiseNode >= 0)
+	solve_noise_adjoint ();
+      else
+	solve_noise ();
+    }
 
     // save results
     saveAllResults (freq);
@@ -117,14 +215,352 @@ int acsolver::solve (void) {
   return 0;
 }
 
+/* The function solves every n-th equation system of the given batch
+   beginning with the given one.  Each worker thread uses its own
+   equation system solver, exceptions are collected per frequency
+   point.  The dense systems are decomposed BATCHLU_LANES at a time in
+   lock-step, the ones the shared row exchanges do not suit are solved
+   one by one. */
+static void solve_points (std::vector<acpoint_t> * points, int n,
+			  int first, int step, int algo) {
+  eqnsys<nr_complex_t> eqns;
+  eqns.setAlgo (algo);
+  int N = (*points)[0].A.getRows ();
+  bool batch = algo == ALGO_LU_DECOMPOSITION && N > 0 &&
+    (n - first + step - 1) / step > 1;
+  batchlu * lu = batch ? new batchlu (N) : NULL;
+  for (int i = first; i < n; ) {
+    int lanes[BATCHLU_LANES], used = 0, valid = 0;
+    for (; i < n && used < BATCHLU_LANES; i += step) lanes[used++] = i;
+    if (lu && used > 1) {
+      for (int l = 0; l < used; l++) {
+	lu->setMatrix (l, (*points)[lanes[l]].A.getData ());
+	lu->setVector (l, (*points)[lanes[l]].z.getData ());
+      }
+      if ((valid = lu->factorize (used)) != 0) lu->substitute ();
+    }
+    for (int l = 0; l < used; l++) {
+      acpoint_t & p = (*points)[lanes[l]];
+      if (valid & (1 << l)) {
+	lu->getVector (l, p.x.getData ());
+	continue;
+      }
+      eqns.passEquationSys (&p.A, &p.x, &p.z);
+      int mark = numstatus::mark ();
+      eqns.solve ();
+      numstatus::report (mark);
+      p.errors.take (estack);
+    }
+  }
+  delete lu;
+}
+
+/* This function runs the AC analysis using the given number of worker
+   threads.  The circuits are calculated and the equation systems are
+   created in sweep order for a batch of frequency points.  These are
+   solved concurrently and the results are finally saved in sweep
+   order again. */
+void acsolver::solve_parallel (int threads) {
+  int size = swp->getSize ();
+  int batch = threads * AC_BATCH_SIZE;
+  std::vector<acpoint_t> points (batch);
+
+  swp->reset ();
+  updateMatrix = 1;
+  for (int i = 0; i < size; i += batch) {
+    int k, n = std::min (batch, size - i);
+
+    // create the equation systems
+    for (k = 0; k < n; k++) {
+      freq = swp->next ();
+      if (progress) logprogressbar (i + k, size, 40);
+      calculate ();
+      createMatrix ();
+      acpoint_t & p = points[k];
+      p.freq = freq;
+      p.A = *A;
+      p.z = *z;
+      p.x = *x;
+    }
+
+    // solve them concurrently
+    int parts = std::min (threads, n);
+    threadpool::run (parts, [this, &points, n, parts] (int k) {
+	solve_points (&points, n, k, parts, eqnAlgo);
+      });
+
+    // save results
+    for (k = 0; k < n; k++) {
+      acpoint_t & p = points[k];
+      *x = p.x;
+      estack.take (p.errors);
+      if (!checkErrors ()) saveSolution ();
+      saveAllResults (p.freq);
+    }
+  }
+}
+
+/* The state of the fast frequency sweep: the equation system
+   (G + sC) x = z of the circuit, the orthonormal basis V of the
+   Krylov subspaces around the expansion points and the projected
+   system (V' G V + s V' C V) y = V' z. */
+struct acfast_t {
+  int n;
+  tmatrix<nr_complex_t> G, C;
+  tvector<nr_complex_t> z;
+  std::vector<std::vector<nr_complex_t> > V;
+  std::vector<std::vector<nr_complex_t> > GV, CV;
+  tmatrix<nr_complex_t> Gr, Cr;
+  tvector<nr_complex_t> zr;
+};
+
+/* Orthogonalizes the vector against the basis twice and appends it
+   normalized.  Returns false if it is dependent on the basis. */
+static bool orthonormalize (std::vector<std::vector<nr_complex_t> > & V,
+			    std::vector<nr_complex_t> & w) {
+  nr_double_t n0 = 0, n = 0;
+  for (nr_complex_t & x : w) n0 += norm (x);
+  if (n0 == 0) return false;
+  for (int pass = 0; pass < 2; pass++) {
+    for (std::vector<nr_complex_t> & v : V) {
+      nr_complex_t d = 0;
+      for (size_t i = 0; i < w.size (); i++) d += conj (v[i]) * w[i];
+      for (size_t i = 0; i < w.size (); i++) w[i] -= d * v[i];
+    }
+  }
+  for (nr_complex_t & x : w) n += norm (x);
+  if (n <= 1e-20 * n0) return false;
+  n = std::sqrt (n);
+  for (nr_complex_t & x : w) x /= n;
+  V.push_back (w);
+  return true;
+}
+
+/* Extends the basis by the moments of the solution around the given
+   expansion point, the Krylov subspace of (G + s0 C)^-1 C started
+   with (G + s0 C)^-1 z.  Returns the number of new basis vectors. */
+static int expand (acfast_t & m, nr_complex_t s0) {
+  int n = m.n, added = 0;
+  tmatrix<nr_complex_t> A0 (n);
+  nr_complex_t * a = A0.getData (), * g = m.G.getData (), * c = m.C.getData ();
+  for (int i = 0; i < n * n; i++) a[i] = g[i] + s0 * c[i];
+
+  tvector<nr_complex_t> x (n), b (n);
+  eqnsys<nr_complex_t> eqns;
+  eqns.setAlgo (ALGO_LU_DECOMPOSITION);
+  eqns.passEquationSys (&A0, &x, &b);
+  int mark = numstatus::mark ();
+  eqns.factorize ();
+  if (numstatus::raised (mark)) {
+    numstatus::release (mark);
+    return 0;
+  }
+
+  tmatrix<nr_complex_t> B (n, 1), X (n, 1);
+  for (int r = 0; r < n; r++) B (r, 0) = m.z (r);
+  for (int k = 0; k < AC_FAST_MOMENTS; k++) {
+    eqns.solveMany (&B, &X);
+    std::vector<nr_complex_t> w (n);
+    for (int r = 0; r < n; r++) w[r] = X (r, 0);
+    if (!orthonormalize (m.V, w)) break;
+    added++;
+    // the next moment of the orthonormalized one
+    std::vector<nr_complex_t> & v = m.V.back ();
+    for (int r = 0; r < n; r++) {
+      nr_complex_t s = 0;
+      for (int j = 0; j < n; j++) s += m.C (r, j) * v[j];
+      B (r, 0) = s;
+    }
+  }
+  return added;
+}
+
+// Projects the equation system onto the current basis.
+static void project (acfast_t & m) {
+  int n = m.n, q = m.V.size ();
+  for (int k = (int) m.GV.size (); k < q; k++) {
+    std::vector<nr_complex_t> & v = m.V[k];
+    std::vector<nr_complex_t> gv (n, 0), cv (n, 0);
+    for (int r = 0; r < n; r++)
+      for (int j = 0; j < n; j++) {
+	gv[r] += m.G (r, j) * v[j];
+	cv[r] += m.C (r, j) * v[j];
+      }
+    m.GV.push_back (gv);
+    m.CV.push_back (cv);
+  }
+  m.Gr = tmatrix<nr_complex_t> (q);
+  m.Cr = tmatrix<nr_complex_t> (q);
+  m.zr = tvector<nr_complex_t> (q);
+  for (int i = 0; i < q; i++) {
+    std::vector<nr_complex_t> & v = m.V[i];
+    for (int r = 0; r < n; r++) m.zr (i) += conj (v[r]) * m.z (r);
+    for (int j = 0; j < q; j++) {
+      nr_complex_t g = 0, c = 0;
+      for (int r = 0; r < n; r++) {
+	g += conj (v[r]) * m.GV[j][r];
+	c += conj (v[r]) * m.CV[j][r];
+      }
+      m.Gr (i, j) = g;
+      m.Cr (i, j) = c;
+    }
+  }
+}
+
+/* Solves the projected system at the given frequency and returns the
+   residual of the solution relative to the right hand side of the
+   full equation system, infinity if it could not be solved. */
+static nr_double_t residual (acfast_t & m, nr_complex_t s,
+			     tvector<nr_complex_t> & y) {
+  int n = m.n, q = m.V.size ();
+  tmatrix<nr_complex_t> M (q);
+  for (int i = 0; i < q; i++)
+    for (int j = 0; j < q; j++) M (i, j) = m.Gr (i, j) + s * m.Cr (i, j);
+  tvector<nr_complex_t> b = m.zr;
+  y = tvector<nr_complex_t> (q);
+  eqnsys<nr_complex_t> eqns;
+  eqns.setAlgo (ALGO_LU_DECOMPOSITION);
+  eqns.passEquationSys (&M, &y, &b);
+  int mark = numstatus::mark ();
+  eqns.solve ();
+  if (numstatus::raised (mark)) {
+    numstatus::release (mark);
+    return std::numeric_limits<nr_double_t>::infinity ();
+  }
+  nr_double_t res = 0, ref = 0;
+  for (int r = 0; r < n; r++) {
+    nr_complex_t d = m.z (r);
+    for (int k = 0; k < q; k++) d -= (m.GV[k][r] + s * m.CV[k][r]) * y (k);
+    res += norm (d);
+    ref += norm (m.z (r));
+  }
+  return ref > 0 ? std::sqrt (res / ref) : std::sqrt (res);
+}
+
+/* The fast frequency sweep.  The equation system of a circuit being
+   linear in frequency, A(s) = G + sC with a constant right hand side,
+   is projected onto the Krylov subspaces of its moments around a few
+   expansion points (the multi-point Pade approximation).  Expansion
+   points are added at the worst of a set of checked sweep points until
+   the residual of the reduced solution falls below the tolerance.
+   Points whose residual still exceeds it are solved directly.  Returns
+   non-zero without saving results if the circuit is not suitable. */
+int acsolver::solve_fast (void) {
+  int size = swp->getSize ();
+  nr_double_t tol = getPropertyDouble ("FastTol");
+  if (size <= AC_FAST_CHECKS) return -1;
+
+  // the lowest, highest and a middle frequency of the sweep
+  nr_double_t fa = swp->get (0), fb = fa, fc = swp->get (size / 2);
+  for (int i = 0; i < size; i++) {
+    fa = std::min (fa, swp->get (i));
+    fb = std::max (fb, swp->get (i));
+  }
+  if (fa == fb || fc == fa || fc == fb) return -1;
+
+  // the equation systems at these frequencies
+  acfast_t m;
+  tmatrix<nr_complex_t> Ab, Ac;
+  tvector<nr_complex_t> zb, zc;
+  updateMatrix = 1;
+  freq = fa; calculate (); createMatrix (); m.G = *A; m.z = *z;
+  freq = fb; calculate (); createMatrix (); Ab = *A; zb = *z;
+  freq = fc; calculate (); createMatrix (); Ac = *A; zc = *z;
+  int n = m.n = m.G.getRows ();
+
+  // derive G and C and check the system is linear in frequency
+  nr_complex_t sa (0, 2 * pi * fa), sb (0, 2 * pi * fb), sc (0, 2 * pi * fc);
+  m.C = tmatrix<nr_complex_t> (n);
+  nr_double_t err = 0, scale = 0;
+  for (int r = 0; r < n; r++) {
+    for (int c = 0; c < n; c++) {
+      m.C (r, c) = (Ab (r, c) - m.G (r, c)) / (sb - sa);
+      m.G (r, c) -= sa * m.C (r, c);
+      err = std::max (err, abs (Ac (r, c) - m.G (r, c) - sc * m.C (r, c)));
+      scale = std::max (scale, abs (Ac (r, c)));
+    }
+    err = std::max (err, abs (zb (r) - m.z (r)) + abs (zc (r) - m.z (r)));
+    scale = std::max (scale, abs (m.z (r)));
+  }
+  if (err > 1e-9 * scale) {
+    logprint (LOG_STATUS, "NOTIFY: %s: circuit is not linear in frequency, "
+	      "fast sweep not used\n", getName ());
+    return -1;
+  }
+
+  // check points evenly spaced in the sweep
+  std::vector<int> checks;
+  for (int k = 0; k < AC_FAST_CHECKS; k++)
+    checks.push_back ((int) ((nr_double_t) k * (size - 1) /
+			     (AC_FAST_CHECKS - 1)));
+
+  // expand around the sweep ends, then where the model is worst
+  int expansions = 0;
+  expansions += expand (m, sa) > 0;
+  expansions += expand (m, sb) > 0;
+  tvector<nr_complex_t> y;
+  while (!m.V.empty ()) {
+    project (m);
+    int worst = -1;
+    nr_double_t res = 0;
+    for (int i : checks) {
+      nr_complex_t s (0, 2 * pi * swp->get (i));
+      nr_double_t r = residual (m, s, y);
+      if (!(r <= res)) { res = r; worst = i; }
+    }
+    if (res <= tol || expansions >= AC_FAST_EXPANSIONS) break;
+    if (!expand (m, nr_complex_t (0, 2 * pi * swp->get (worst)))) break;
+    expansions++;
+  }
+  if (m.V.empty ()) return -1;
+
+  // evaluate the reduced model at each point of the sweep
+  int q = m.V.size (), direct = 0;
+  swp->reset ();
+  for (int i = 0; i < size; i++) {
+    freq = swp->next ();
+    if (progress) logprogressbar (i, size, 40);
+    if (residual (m, nr_complex_t (0, 2 * pi * freq), y) <= tol) {
+      for (int r = 0; r < n; r++) {
+	nr_complex_t v = 0;
+	for (int k = 0; k < q; k++) v += m.V[k][r] * y (k);
+	x->set (r, v);
+      }
+      saveSolution ();
+    }
+    else {
+      eqnAlgo = ALGO_LU_DECOMPOSITION;
+      solve_linear ();
+      direct++;
+    }
+    saveAllResults (freq);
+  }
+  logprint (LOG_STATUS, "NOTIFY: %s: fast sweep with %d expansion points "
+	    "and %d states, %d of %d points solved directly\n", getName (),
+	    expansions, q, direct, size);
+  return 0;
+}
+
 /* Goes through the list of circuit objects and runs its calcAC()
-   function. */
+   function, circuits of the same type one after the other. */
 void acsolver::calc (acsolver * self) {
-  circuit * root = self->getNet()->getRoot ();
-  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
-    c->calcAC (self->freq);
-    if (self->noise) c->calcNoiseAC (self->freq);
-  }
+  self->evaluateAll (self->noise ? &calcCircuitNoise : &calcCircuit);
+}
+
+// Runs the calcAC() function of a single circuit object.
+void acsolver::calcCircuit (circuit * c, nasolver<nr_complex_t> * self) {
+  c->calcAC (((acsolver *) self)->freq);
+}
+
+// Runs the calcAC() and calcNoiseAC() functions of a circuit object.
+void acsolver::calcCircuitNoise (circuit * c, nasolver<nr_complex_t> * self) {
+  c->calcAC (((acsolver *) self)->freq);
+  c->calcNoiseAC (((acsolver *) self)->freq);
+}
+
+// Runs the initAC() function of a single circuit object.
+void acsolver::initCircuit (circuit * c, nasolver<nr_complex_t> *) {
+  c->initAC ();
 }
 
 /* Goes through the list of circuit objects and runs its initAC()
@@ -132,12 +568,104 @@ void acsolver::calc (acsolver * self) {
 void acsolver::init (void) {
   circuit * root = subnet->getRoot ();
   for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    c->setRealMNA (false);
     if (c->isNonLinear ()) c->calcOperatingPoints ();
     c->initAC ();
     if (noise) c->initNoiseAC ();
   }
 }
 
+/* The adaptive frequency sweep starts with the points of the given
+   sweep.  Each interval is checked at its midpoint, geometric for
+   logarithmic sweeps, and split further if the solution there deviates
+   from the mean of the solutions at its ends by more than the relative
+   tolerance.  The refinement stops once all the intervals are resolved,
+   become too narrow or the largest number of points is reached.  The
+   results are saved in ascending frequency order afterwards.  Later
+   runs of a parameter sweep solve the frequencies of the first one. */
+int acsolver::solve_adaptive (void) {
+  nr_double_t tol = getPropertyDouble ("AdaptTol");
+  int most = getPropertyInteger ("AdaptPoints");
+  bool log = !strcmp (getPropertyString ("Type"), "log");
+  std::map<nr_double_t, tvector<nr_complex_t> > points;
+  eqnAlgo = ALGO_LU_DECOMPOSITION;
+
+  // solve the initial points, the frequencies of the first run once
+  // the dataset has got its dependency
+  std::vector<nr_double_t> initial = adaptFreqs;
+  if (runs == 1 || initial.empty ()) {
+    swp->reset ();
+    initial.clear ();
+    for (int i = 0; i < swp->getSize (); i++) initial.push_back (swp->next ());
+  }
+  for (nr_double_t f : initial) {
+    if (points.find (f) != points.end ()) continue;
+    freq = f;
+    solve_linear ();
+    points[freq] = *x;
+  }
+  if (runs > 1) most = 0;
+  nr_double_t floor = 0;
+  for (auto & p : points) floor = std::max (floor, maxnorm (p.second));
+  floor *= AC_ADAPT_FLOOR;
+
+  // the intervals to be checked by their lower ends, pass by pass
+  std::vector<nr_double_t> pending, next;
+  for (auto it = points.begin (); it != points.end (); ++it)
+    if (std::next (it) != points.end ()) pending.push_back (it->first);
+  while (!pending.empty () && (int) points.size () < most) {
+    next.clear ();
+    for (nr_double_t fa : pending) {
+      if ((int) points.size () >= most) break;
+      auto a = points.find (fa);
+      auto b = std::next (a);
+      nr_double_t fb = b->first;
+      nr_double_t fm = (log && fa > 0) ? std::sqrt (fa * fb) : (fa + fb) / 2;
+      if (fm - fa <= AC_ADAPT_WIDTH * std::fabs (fb)) continue;
+      if (progress) logprogressbar (points.size (), most, 40);
+      freq = fm;
+      solve_linear ();
+      bool resolved = true;
+      for (std::size_t r = 0; r < x->size () && resolved; r++) {
+        nr_complex_t v = x->get (r);
+        nr_complex_t m = (a->second.get (r) + b->second.get (r)) / 2.0;
+        if (abs (v - m) > tol * std::max (abs (v), floor)) resolved = false;
+      }
+      points[fm] = *x;
+      if (!resolved) {
+        next.push_back (fa);
+        next.push_back (fm);
+      }
+    }
+    pending.swap (next);
+  }
+
+  // save the results, the noise analysis needs the equation system
+  for (auto & p : points) {
+    freq = p.first;
+    if (noise) {
+      solve_linear ();
+      if (noiseNode >= 0)
+        solve_noise_adjoint ();
+      else
+        solve_noise ();
+    }
+    else {
+      *x = p.second;
+      saveSolution ();
+    }
+    saveAllResults (freq);
+  }
+  if (runs == 1) {
+    adaptFreqs.clear ();
+    for (auto & p : points) adaptFreqs.push_back (p.first);
+    logprint (LOG_STATUS, "NOTIFY: %s: adaptive sweep with %d points, "
+	      "%d initial ones\n", getName (), (int) points.size (),
+	      swp->getSize ());
+  }
+  return 0;
+}
+
 /* This function saves the results of a single solve() functionality
    (for the given frequency) into the output dataset. */
 void acsolver::saveAllResults (nr_double_t freq) {
@@ -150,6 +678,14 @@ void acsolver::saveAllResults (nr_double_t freq) {
   if (runs == 1) f->add (freq);
   saveResults ("v", "i", 0, f);
 
+  // derivatives of the requested outputs with respect to the parameters
+  // of linear circuits, the operating points are kept
+  const char * const sens = getPropertyString ("Sensitivity");
+  if (sens != NULL && *sens != '\0') {
+    this->freq = freq;
+    saveSensitivities (sens, "v", "i", &initCircuit, &calcCircuit, false, f);
+  }
+
   // additionally save noise results if requested
   if (noise) {
     saveNoiseResults (f);
@@ -161,6 +697,18 @@ void acsolver::saveAllResults (nr_double_t freq) {
 void acsolver::saveNoiseResults (qucs::vector * f) {
   int N = countNodes ();
   int M = countVoltageSources ();
+
+  // the noise of the output node and the contribution of each circuit
+  if (noiseNode >= 0) {
+    saveVariable (nlist->get (noiseNode) + ".vn",
+		  fabs (xn->get (noiseNode) * sqrt (kB * T0)), f);
+    for (auto & s : sources) {
+      saveVariable (std::string (s.c->getName ()) + ".vn",
+		    sqrt (s.power * kB * T0), f);
+    }
+    return;
+  }
+
   for (int r = 0; r < N + M; r++) {
     // renormalise the results
     x->set (r, fabs (xn->get (r) * sqrt (kB * T0)));
@@ -203,21 +751,20 @@ void acsolver::solve_noise (void) {
   // create the MNA matrix once again and LU decompose the adjoint matrix
   createMatrix ();
   A->transpose ();
-  eqnAlgo = ALGO_LU_FACTORIZATION_CROUT;
-  runMNA ();
+  eqnsys<nr_complex_t> eqns;
+  eqns.setAlgo (ALGO_LU_DECOMPOSITION_CROUT);
+  eqns.passEquationSys (A, x, z);
+  eqns.factorize ();
 
-  // ensure skipping LU decomposition
-  updateMatrix = 0;
-  convHelper = CONV_None;
-  eqnAlgo = ALGO_LU_SUBSTITUTION_CROUT;
+  // the transimpedances of all nodes (and voltage sources) at once
+  tmatrix<nr_complex_t> En = tmatrix<nr_complex_t> (N + M);
+  tmatrix<nr_complex_t> Zn = tmatrix<nr_complex_t> (N + M);
+  for (int i = 0; i < N + M; i++) En (i, i) = -1;
+  eqns.solveMany (&En, &Zn);
 
   // compute noise voltage for each node (and voltage source)
   for (int i = 0; i < N + M; i++) {
-    z->set (0); z->set (i, -1); // modify right hand side appropriately
-    runMNA ();                  // solve
-    zn = *x;                    // save transimpedance vector
-
-    // compute actual noise voltage
+    for (int r = 0; r < N + M; r++) zn (r) = Zn (r, i);
     xn->set (i, sqrt (real (scalar (zn * (*C), conj (zn)))));
   }
 
@@ -225,16 +772,101 @@ void acsolver::solve_noise (void) {
   *x = xsave;
 }
 
+/* The function finds the unknowns of the ports and voltage sources of
+   each circuit, which are the rows and columns its noise correlation
+   matrix contributes to. */
+void acsolver::createNoiseSources (void) {
+  int N = countNodes ();
+  std::map<circuit *, std::vector<int> > ports;
+
+  for (int r = 0; r < N; r++) {
+    for (auto & n : *nlist->getNode (r)) {
+      circuit * c = n->getCircuit ();
+      std::vector<int> & p = ports[c];
+      if (p.empty ()) p.assign (c->getSize (), -1);
+      p[n->getPort ()] = r;
+    }
+  }
+  sources.clear ();
+  circuit * root = subnet->getRoot ();
+  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    noisesource_t s;
+    s.c = c;
+    s.power = 0.0;
+    s.unknowns = ports[c];
+    s.unknowns.resize (c->getSize (), -1);
+    for (int v = 0; v < c->getVoltageSources (); v++)
+      s.unknowns.push_back (N + c->getVoltageSource () + v);
+    sources.push_back (s);
+  }
+}
+
+/* This function runs the AC noise analysis for the output node only.
+   A single solution of the adjoint equation system gives the
+   transimpedances from each unknown to the output node, so the noise
+   power contributed by each circuit is obtained from its own noise
+   correlation matrix without creating the one of the whole netlist.
+   It saves the noise voltage of the output node in the 'xn' vector
+   and the contributions in the noise sources. */
+void acsolver::solve_noise_adjoint (void) {
+  int N = countNodes ();
+  int M = countVoltageSources ();
+
+  // save usual AC results
+  tvector<nr_complex_t> xsave = *x;
+  if (xn == NULL) xn = new tvector<nr_double_t> (N + M);
+
+  // create the MNA matrix once again and solve the adjoint system
+  createMatrix ();
+  A->transpose ();
+  z->set (0); z->set (noiseNode, -1);
+  eqnAlgo = ALGO_LU_DECOMPOSITION;
+  runMNA ();
+  tvector<nr_complex_t> zn = *x;
+
+  // sum up the contributions of each noise source, the ones being
+  // noiseless at this frequency included (losses growing with it)
+  nr_double_t total = 0.0;
+  for (auto & s : sources) {
+    nr_complex_t p = 0.0;
+    int size = s.unknowns.size ();
+    for (int r = 0; r < size; r++) {
+      if (s.unknowns[r] < 0) continue;
+      nr_complex_t zr = zn (s.unknowns[r]);
+      for (int c = 0; c < size; c++) {
+	if (s.unknowns[c] < 0) continue;
+	p += zr * s.c->getN (r, c) * conj (zn (s.unknowns[c]));
+      }
+    }
+    s.power = std::max (real (p), 0.0);
+    total += s.power;
+  }
+  xn->set (noiseNode, sqrt (total));
+
+  // restore usual AC results
+  *x = xsave;
+}
+
 // properties
 PROP_REQ [] = {
   { "Type", PROP_STR, { PROP_NO_VAL, "lin" }, PROP_RNG_TYP },
   PROP_NO_PROP };
 PROP_OPT [] = {
   { "Noise", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+  { "NoiseNode", PROP_STR, { PROP_NO_VAL, "" }, PROP_NO_RANGE },
   { "Start", PROP_REAL, { 1e9, PROP_NO_STR }, PROP_POS_RANGE },
   { "Stop", PROP_REAL, { 10e9, PROP_NO_STR }, PROP_POS_RANGE },
   { "Points", PROP_INT, { 10, PROP_NO_STR }, PROP_MIN_VAL (2) },
   { "Values", PROP_LIST, { 10, PROP_NO_STR }, PROP_POS_RANGE },
+  { "Threads", PROP_INT, { 1, PROP_NO_STR }, PROP_RNGII (0, 256) },
+  { "Reduce", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+  { "FastSweep", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+  { "FastTol", PROP_REAL, { 1e-6, PROP_NO_STR }, PROP_RNGXI (0, 1) },
+  { "Sensitivity", PROP_STR, { PROP_NO_VAL, "" }, PROP_NO_RANGE },
+  { "Save", PROP_STR, { PROP_NO_VAL, "" }, PROP_NO_RANGE },
+  { "Adaptive", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+  { "AdaptTol", PROP_REAL, { 1e-3, PROP_NO_STR }, PROP_RNGXI (0, 1) },
+  { "AdaptPoints", PROP_INT, { 10000, PROP_NO_STR }, PROP_MIN_VAL (2) },
   PROP_NO_PROP };
 struct define_t acsolver::anadef =
   { "AC", 0, PROP_ACTION, PROP_NO_SUBSTRATE, PROP_LINEAR, PROP_DEF };
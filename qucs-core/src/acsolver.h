@@ -25,6 +25,8 @@
 #ifndef __ACSOLVER_H__
 #define __ACSOLVER_H__
 
+#include <vector>
+
 #include "nasolver.h"
 
 namespace qucs {
@@ -41,16 +43,37 @@ class acsolver : public nasolver<nr_complex_t>
   ~acsolver ();
   int  solve (void);
   void solve_noise (void);
+  void solve_noise_adjoint (void);
+  void createNoiseSources (void);
+  void solve_parallel (int);
+  int  solve_fast (void);
+  int  solve_adaptive (void);
   static void calc (acsolver *);
+  static void calcCircuit (circuit *, nasolver<nr_complex_t> *);
+  static void calcCircuitNoise (circuit *, nasolver<nr_complex_t> *);
+  static void initCircuit (circuit *, nasolver<nr_complex_t> *);
   void init (void);
   void saveAllResults (nr_double_t);
   void saveNoiseResults (qucs::vector *);
 
+ private:
+  /* The circuit of a noise source together with the unknowns its
+     ports and voltage sources belong to, -1 for ground. */
+  struct noisesource_t {
+    circuit * c;
+    std::vector<int> unknowns;
+    nr_double_t power;
+  };
+
  private:
   sweep * swp;
   nr_double_t freq;
   int noise;
   tvector<nr_double_t> * xn;
+  int noiseNode;
+  std::vector<noisesource_t> sources;
+  // frequencies of the first adaptive sweep, reused by the later runs
+  std::vector<nr_double_t> adaptFreqs;
 };
 
 } // namespace qucs
@@ -37,9 +37,13 @@
 #include "spsolver.h"
 #include "dcsolver.h"
 #include "parasweep.h"
+#include "optimizer.h"
+#include "mcsolver.h"
 #include "acsolver.h"
 #include "trsolver.h"
 #include "hbsolver.h"
 #include "e_trsolver.h"
+#include "digisolver.h"
+#include "psssolver.h"
 
 #endif /* __ANALYSES_H__ */
@@ -37,6 +37,7 @@
 //#include <stdio.h>
 //#include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 #include "object.h"
 #include "complex.h"
@@ -49,6 +50,8 @@
 
 namespace qucs {
 
+bool analysis::reproducible = false;
+
 //Constructor. Creates an unnamed instance of the analysis class.
 analysis::analysis () : object () {
   data = NULL;
@@ -58,6 +61,7 @@ analysis::analysis () : object () {
   type = ANALYSIS_UNKNOWN;
   runs = 0;
   progress = true;
+  points = 0;
 }
 
 // Constructor creates a named instance of the analysis class.
@@ -69,6 +73,7 @@ analysis::analysis (const std::string &n) : object (n) {
   type = ANALYSIS_UNKNOWN;
   runs = 0;
   progress = true;
+  points = 0;
 }
 
 // Destructor deletes the analysis class object.
@@ -86,6 +91,7 @@ analysis::analysis (analysis & a) : object (a) {
   type = a.type;
   runs = a.runs;
   progress = a.progress;
+  points = a.points;
 }
 
 /* This function adds the given analysis to the actions being
@@ -155,8 +161,9 @@ sweep * analysis::createSweep (const std::string& n) {
   if ((d = data->findVariable (n)) == NULL) {
     d = new vector (n);
     if (f != NULL) {
-      d->setDependencies (new strlist ());
-      d->getDependencies()->add (f->getName ());
+      strlist * deps = new strlist ();
+      deps->add (f->getName ());
+      d->setDependencies (deps);
     }
     d->setOrigin (getName ());
     data->addVariable (d);
@@ -164,4 +171,33 @@ sweep * analysis::createSweep (const std::string& n) {
   d->add (z);
 }
 
+/* Returns the dataset vector of the given variable depending on the
+   given vector.  Creates the dataset vector if necessary and makes
+   room for the result points of the current run.  The vector should
+   be looked up once per run, the values are appended directly. */
+vector * analysis::findVariable (const std::string &n, vector * f) {
+  vector * d;
+  if ((d = data->findVariable (n)) == NULL) {
+    d = new vector (n);
+    if (f != NULL) {
+      strlist * deps = new strlist ();
+      deps->add (f->getName ());
+      d->setDependencies (deps);
+    }
+    d->setOrigin (getName ());
+    data->addVariable (d);
+  }
+  reserveVariable (d);
+  return d;
+}
+
+/* Preallocates the given vector for the result points of the current
+   run.  A streaming dataset spools its vectors in chunks, thus more
+   room is never needed. */
+void analysis::reserveVariable (vector * v) {
+  if (v == NULL || points <= 1) return;
+  int n = data->isStreaming () ? std::min (points, DATASET_CHUNK) : points;
+  v->reserve (v->getSize () + n);
+}
+
 } // namespace qucs
@@ -67,7 +67,9 @@ enum analysis_type
     ANALYSIS_HBALANCE,
     ANALYSIS_TRANSIENT,
     ANALYSIS_SPARAMETER,
-    ANALYSIS_E_TRANSIENT
+    ANALYSIS_E_TRANSIENT,
+    ANALYSIS_DIGITAL,
+    ANALYSIS_PSS
 };
 
 /*! \class analysis
@@ -145,6 +147,30 @@ public:
         return 0;
     }
 
+    /*! \fn setSweepPoint
+    * \brief announces the next point of a parameter sweep
+    * \param v value of the swept parameter
+    *
+    * Parameter sweeps pass the value of the next point to their
+    * children before solving them.  Analyses may use it to predict
+    * their solution from the previous points.  Does nothing by
+    * default.
+    */
+    virtual void setSweepPoint (nr_double_t)
+    {
+    }
+
+    /*! \fn resetSweep
+    * \brief forgets the previous points of a parameter sweep
+    *
+    * Parameter sweeps call it in reproducible mode before each block
+    * of points, the next solution must not depend on the points
+    * before.  Does nothing by default.
+    */
+    virtual void resetSweep (void)
+    {
+    }
+
     /*! \fn isExternal
     * \brief informs whether this is an external sim
     *
@@ -246,6 +272,36 @@ public:
      */
     void saveVariable (const std::string &, nr_complex_t, qucs::vector *);
 
+    /*! \fn findVariable
+     * \brief Find or create a variable of the analysis dataset.
+     * \param n Name of the variable
+     * \param f The dependency of the variable
+     *
+     * Returns the dataset vector of the variable, creating it if
+     * necessary, thus several values can be appended at once.  The
+     * vector is preallocated for the number of result points.
+     */
+    qucs::vector * findVariable (const std::string &, qucs::vector *);
+
+    /*! \fn reserveVariable
+     * \brief Preallocate a vector for the coming result points.
+     * \param v The vector of the dataset
+     *
+     * Makes room for the number of result points of the current run
+     * set by setResultPoints(), at most one chunk of a streaming
+     * dataset.
+     */
+    void reserveVariable (qucs::vector *);
+
+    /*! \fn setResultPoints
+     * \brief Sets the number of result points of the current run.
+     * \param n The number of points, e.g. the size of the sweep
+     */
+    void setResultPoints (int n)
+    {
+        points = n;
+    }
+
     /*! \fn getProgress
      * \brief get
      * \param progress
@@ -267,6 +323,23 @@ public:
         progress = p;
     }
 
+    /*! \fn setReproducible
+     * \brief Enables the reproducible mode
+     * \param r new state
+     *
+     * In reproducible mode the results do not depend on the number of
+     * threads and processes used.
+     */
+    static void setReproducible (bool r)
+    {
+        reproducible = r;
+    }
+
+    static bool isReproducible (void)
+    {
+        return reproducible;
+    }
+
 protected:
     int runs;
     int type;
@@ -275,6 +348,10 @@ protected:
     environment * env;
     ptrlist<analysis> * actions;
     bool progress;
+    int points;
+
+private:
+    static bool reproducible;
 };
 
 } // namespace qucs
@@ -0,0 +1,139 @@
+/*
+ * arena.cpp - pool of netlist-lifetime objects implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <new>
+#include <algorithm>
+
+#include "arena.h"
+
+// size of the chunks objects are carved out of
+#define ARENA_CHUNK (64 * 1024)
+
+namespace qucs {
+
+/* Every block is preceded by a header naming the arena it has been
+   carved out of, or NULL if it has been allocated on the heap.  The
+   header keeps the alignment of the block. */
+union arena_header {
+  arena * owner;
+  std::max_align_t align;
+};
+
+arena * arena::current = NULL;
+std::mutex arena::lock;
+
+// Constructor creates an empty arena.
+arena::arena () {
+  pos = end = NULL;
+  live = 0;
+  closed = false;
+}
+
+// Destructor releases the chunks of the arena in bulk.
+arena::~arena () {
+  for (char * c : chunks) ::operator delete (c);
+}
+
+// The function makes this arena the one new objects are allocated in.
+void arena::activate (void) {
+  std::lock_guard<std::mutex> guard (lock);
+  current = this;
+}
+
+/* The function closes the arena, i.e. no more objects are allocated
+   in it.  The arena is deleted as soon as its last object is gone,
+   possibly right away. */
+void arena::close (void) {
+  bool empty;
+  {
+    std::lock_guard<std::mutex> guard (lock);
+    if (current == this) current = NULL;
+    closed = true;
+    empty = live == 0;
+  }
+  if (empty) delete this;
+}
+
+/* This function carves a block of the given size out of the current
+   chunk.  Large blocks get a chunk of their own. */
+void * arena::carve (std::size_t n) {
+  if (n > ARENA_CHUNK / 4) {
+    char * c = static_cast<char *> (::operator new (n));
+    chunks.push_back (c);
+    return c;
+  }
+  if (pos == NULL || pos + n > end) {
+    pos = static_cast<char *> (::operator new (ARENA_CHUNK));
+    end = pos + ARENA_CHUNK;
+    chunks.push_back (pos);
+  }
+  void * p = pos;
+  pos += n;
+  return p;
+}
+
+/* Allocates a block of the given size in the current arena, or on the
+   heap if there is none. */
+void * arena::allocate (std::size_t n) {
+  const std::size_t h = sizeof (arena_header);
+  // round the size up to keep the next block aligned
+  n = h + (n + h - 1) / h * h;
+  arena_header * b;
+  {
+    std::lock_guard<std::mutex> guard (lock);
+    if (current != NULL) {
+      b = static_cast<arena_header *> (current->carve (n));
+      b->owner = current;
+      current->live++;
+      return b + 1;
+    }
+  }
+  b = static_cast<arena_header *> (::operator new (n));
+  b->owner = NULL;
+  return b + 1;
+}
+
+/* Frees the given block.  Blocks of an arena are only counted, the
+   arena is deleted together with its last block once it is closed. */
+void arena::deallocate (void * p) {
+  if (p == NULL) return;
+  arena_header * b = static_cast<arena_header *> (p) - 1;
+  arena * a = b->owner;
+  if (a == NULL) {
+    ::operator delete (b);
+    return;
+  }
+  bool last;
+  {
+    std::lock_guard<std::mutex> guard (lock);
+    last = --a->live == 0 && a->closed;
+  }
+  if (last) delete a;
+}
+
+} // namespace qucs
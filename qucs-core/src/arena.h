@@ -0,0 +1,95 @@
+/*
+ * arena.h - pool of netlist-lifetime objects definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace qucs {
+
+/*! \class arena
+ * \brief pool of netlist-lifetime objects.
+ *
+ * The circuits, their nodes and the properties of all objects are
+ * carved out of large chunks of the current arena, which is the one
+ * of the netlist being built.  Freeing such an object only counts it,
+ * thus tearing down a large netlist does not return thousands of
+ * small blocks to the heap one at a time.  The chunks are released in
+ * bulk once the arena has been closed and its last object is gone.
+ * Without a current arena objects are allocated on the heap.
+ */
+class arena
+{
+ public:
+  arena ();
+  void activate (void);
+  void close (void);
+  static void * allocate (std::size_t);
+  static void deallocate (void *);
+
+ private:
+  ~arena ();
+  void * carve (std::size_t);
+
+ private:
+  std::vector<char *> chunks;
+  char * pos;
+  char * end;
+  std::size_t live;
+  bool closed;
+  static arena * current;
+  static std::mutex lock;
+};
+
+/*! \class arena_allocator
+ * \brief allocator of standard containers using the current arena.
+ */
+template <class T>
+struct arena_allocator
+{
+  typedef T value_type;
+  arena_allocator () { }
+  template <class U> arena_allocator (const arena_allocator<U> &) { }
+  T * allocate (std::size_t n) {
+    return static_cast<T *> (arena::allocate (n * sizeof (T)));
+  }
+  void deallocate (T * p, std::size_t) { arena::deallocate (p); }
+};
+
+template <class T, class U>
+bool operator== (const arena_allocator<T> &, const arena_allocator<U> &) {
+  return true;
+}
+
+template <class T, class U>
+bool operator!= (const arena_allocator<T> &, const arena_allocator<U> &) {
+  return false;
+}
+
+} // namespace qucs
+
+#endif /* __ARENA_H__ */
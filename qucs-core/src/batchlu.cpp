@@ -0,0 +1,271 @@
+/*
+ * batchlu.cpp - batched dense complex LU decomposition
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <algorithm>
+
+#include "complex.h"
+#include "tvector.h"
+#include "tmatrix.h"
+#include "batchlu.h"
+
+// Smallest accepted pivot relative to the largest one of a system.
+#define BATCHLU_THRESHOLD 0.1
+
+namespace qucs {
+
+static const int L = BATCHLU_LANES;
+
+// Constructor creates the storage for systems of the given size.
+batchlu::batchlu (int size) {
+  n = size;
+  valid = 0;
+  re.assign (n * n * L, 0);
+  im.assign (n * n * L, 0);
+  xr.assign (n * L, 0);
+  xi.assign (n * L, 0);
+  dr.assign (n * L, 0);
+  di.assign (n * L, 0);
+  scale.assign (n * L, 0);
+  rMap.assign (n, 0);
+}
+
+// Sets the (row major) matrix of the given system.
+void batchlu::setMatrix (int l, const nr_complex_t * a) {
+  for (int i = 0; i < n * n; i++) {
+    re[i * L + l] = real (a[i]);
+    im[i * L + l] = imag (a[i]);
+  }
+}
+
+// Sets the right hand side of the given system.
+void batchlu::setVector (int l, const nr_complex_t * b) {
+  for (int i = 0; i < n; i++) {
+    xr[i * L + l] = real (b[i]);
+    xi[i * L + l] = imag (b[i]);
+  }
+}
+
+// Returns the solution of the given system.
+void batchlu::getVector (int l, nr_complex_t * x) {
+  for (int i = 0; i < n; i++)
+    x[i] = nr_complex_t (xr[i * L + l], xi[i * L + l]);
+}
+
+/* The update u -= f * v of the given number of interleaved entries,
+   with the factor f of each system. */
+static inline void update (nr_double_t * ur, nr_double_t * ui,
+			   const nr_double_t * vr, const nr_double_t * vi,
+			   const nr_double_t * fr, const nr_double_t * fi,
+			   int count) {
+  for (int j = 0; j < count * L; j += L) {
+    for (int b = 0; b < L; b++) {
+      nr_double_t r = vr[j + b], i = vi[j + b];
+      ur[j + b] -= fr[b] * r - fi[b] * i;
+      ui[j + b] -= fr[b] * i + fi[b] * r;
+    }
+  }
+}
+
+// The multiplication u *= f of the given number of interleaved entries.
+static inline void multiply (nr_double_t * ur, nr_double_t * ui,
+			     const nr_double_t * fr, const nr_double_t * fi,
+			     int count) {
+  for (int j = 0; j < count * L; j += L) {
+    for (int b = 0; b < L; b++) {
+      nr_double_t r = ur[j + b], i = ui[j + b];
+      ur[j + b] = fr[b] * r - fi[b] * i;
+      ui[j + b] = fr[b] * i + fi[b] * r;
+    }
+  }
+}
+
+/* Chooses the pivot of the given column among the lower matrix
+   entries.  The row maximizing the smallest ratio to the largest
+   candidate of each system is taken, systems the pivot is too small
+   for are given up. */
+void batchlu::pivot (int c, int & row) {
+  nr_double_t M[L], d, worst, best = -1;
+  int b, r;
+  for (b = 0; b < L; b++) M[b] = 0;
+  for (r = c; r < n; r++) {
+    const nr_double_t * ar = &re[(r * n + c) * L], * ai = &im[(r * n + c) * L];
+    for (b = 0; b < L; b++) {
+      d = scale[r * L + b] * (ar[b] * ar[b] + ai[b] * ai[b]);
+      if (d > M[b]) M[b] = d;
+    }
+  }
+  for (b = 0; b < L; b++)
+    if ((valid & (1 << b)) && M[b] <= 0) valid &= ~(1 << b);
+
+  row = c;
+  for (r = c; r < n; r++) {
+    const nr_double_t * ar = &re[(r * n + c) * L], * ai = &im[(r * n + c) * L];
+    for (worst = 1, b = 0; b < L; b++) {
+      if (!(valid & (1 << b))) continue;
+      d = scale[r * L + b] * (ar[b] * ar[b] + ai[b] * ai[b]) / M[b];
+      if (d < worst) worst = d;
+    }
+    if (worst > best) {
+      best = worst;
+      row = r;
+    }
+  }
+
+  // the ratios are of squared magnitudes
+  const nr_double_t * ar = &re[(row * n + c) * L], * ai = &im[(row * n + c) * L];
+  for (b = 0; b < L; b++) {
+    if (!(valid & (1 << b))) continue;
+    d = scale[row * L + b] * (ar[b] * ar[b] + ai[b] * ai[b]);
+    if (d < BATCHLU_THRESHOLD * BATCHLU_THRESHOLD * M[b]) valid &= ~(1 << b);
+  }
+}
+
+/* Decomposes the matrices of the given number of systems (Crout's
+   definition) blocked along the columns the way eqnsys does.  Returns
+   the bit mask of the systems decomposed, the others have to be
+   solved otherwise. */
+int batchlu::factorize (int count) {
+  int b, c, r, k, row, pb, pe;
+  nr_double_t fr[L], fi[L];
+
+  valid = (1 << count) - 1;
+
+  // the systems not set are kept regular
+  for (b = count; b < L; b++) {
+    for (r = 0; r < n; r++) {
+      for (c = 0; c < n; c++) {
+	re[(r * n + c) * L + b] = r == c ? 1 : 0;
+	im[(r * n + c) * L + b] = 0;
+      }
+    }
+  }
+
+  // implicit row scaling of each system
+  for (r = 0; r < n; r++) {
+    for (b = 0; b < L; b++) {
+      nr_double_t m = 0;
+      for (c = 0; c < n; c++) {
+	int i = (r * n + c) * L + b;
+	m = std::max (m, re[i] * re[i] + im[i] * im[i]);
+      }
+      scale[r * L + b] = m > 0 ? 1 / m : 0;
+    }
+    rMap[r] = r;
+  }
+
+  for (pb = 0; pb < n && valid; pb = pe) {
+    pe = std::min (pb + TMATRIX_BLOCK, n);
+
+    // decompose the panel of columns pb to pe - 1
+    for (c = pb; c < pe && valid; c++) {
+      pivot (c, row);
+      if (row != c) {
+	std::swap_ranges (&re[row * n * L], &re[(row + 1) * n * L],
+			  &re[c * n * L]);
+	std::swap_ranges (&im[row * n * L], &im[(row + 1) * n * L],
+			  &im[c * n * L]);
+	std::swap_ranges (&scale[row * L], &scale[(row + 1) * L],
+			  &scale[c * L]);
+	std::swap (rMap[c], rMap[row]);
+      }
+
+      // inverse of the pivot, zero for the systems given up
+      const nr_double_t * pr = &re[(c * n + c) * L], * pi = &im[(c * n + c) * L];
+      for (b = 0; b < L; b++) {
+	nr_double_t m = pr[b] * pr[b] + pi[b] * pi[b];
+	fr[b] = m > 0 ? pr[b] / m : 0;
+	fi[b] = m > 0 ? -pi[b] / m : 0;
+	dr[c * L + b] = fr[b];
+	di[c * L + b] = fi[b];
+      }
+
+      // upper matrix entries of this row and update of the panel
+      int w = pe - c - 1;
+      nr_double_t * ur = &re[(c * n + c + 1) * L], * ui = &im[(c * n + c + 1) * L];
+      multiply (ur, ui, fr, fi, w);
+      for (r = c + 1; r < n; r++) {
+	const nr_double_t * ar = &re[(r * n + c) * L], * ai = &im[(r * n + c) * L];
+	update (&re[(r * n + c + 1) * L], &im[(r * n + c + 1) * L],
+		ur, ui, ar, ai, w);
+      }
+    }
+    if (pe == n || !valid) break;
+
+    // upper matrix entries right of the panel
+    for (r = pb; r < pe; r++) {
+      nr_double_t * ur = &re[(r * n + pe) * L], * ui = &im[(r * n + pe) * L];
+      for (k = pb; k < r; k++) {
+	update (ur, ui, &re[(k * n + pe) * L], &im[(k * n + pe) * L],
+		&re[(r * n + k) * L], &im[(r * n + k) * L], n - pe);
+      }
+      multiply (ur, ui, &dr[r * L], &di[r * L], n - pe);
+    }
+
+    // update the remaining matrix, blocked along the columns
+    for (c = pe; c < n; c += TMATRIX_BLOCK) {
+      int w = std::min (c + TMATRIX_BLOCK, n) - c;
+      for (r = pe; r < n; r++) {
+	nr_double_t * ur = &re[(r * n + c) * L], * ui = &im[(r * n + c) * L];
+	for (k = pb; k < pe; k++) {
+	  update (ur, ui, &re[(k * n + c) * L], &im[(k * n + c) * L],
+		  &re[(r * n + k) * L], &im[(r * n + k) * L], w);
+	}
+      }
+    }
+  }
+  return valid;
+}
+
+/* Solves the decomposed systems for the right hand sides set, the
+   solutions replace them. */
+void batchlu::substitute (void) {
+  std::vector<nr_double_t> br (xr), bi (xi);
+  int b, i, c;
+
+  // forward substitution in order to solve LY = B
+  for (i = 0; i < n; i++) {
+    nr_double_t * yr = &xr[i * L], * yi = &xi[i * L];
+    for (b = 0; b < L; b++) {
+      yr[b] = br[rMap[i] * L + b];
+      yi[b] = bi[rMap[i] * L + b];
+    }
+    for (c = 0; c < i; c++)
+      update (yr, yi, &xr[c * L], &xi[c * L],
+	      &re[(i * n + c) * L], &im[(i * n + c) * L], 1);
+    multiply (yr, yi, &dr[i * L], &di[i * L], 1);
+  }
+
+  // backward substitution in order to solve UX = Y
+  for (i = n - 1; i >= 0; i--) {
+    for (c = i + 1; c < n; c++)
+      update (&xr[i * L], &xi[i * L], &xr[c * L], &xi[c * L],
+	      &re[(i * n + c) * L], &im[(i * n + c) * L], 1);
+  }
+}
+
+} // namespace qucs
@@ -0,0 +1,74 @@
+/*
+ * batchlu.h - batched dense complex LU decomposition definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __BATCHLU_H__
+#define __BATCHLU_H__
+
+#include <vector>
+
+// Number of equation systems solved in lock-step.
+#define BATCHLU_LANES 4
+
+namespace qucs {
+
+/*! \class batchlu
+ * \brief dense complex equation systems of equal size solved at once.
+ *
+ * The systems, e.g. of neighbouring frequency points, are kept
+ * interleaved with the real and imaginary parts apart, each operation
+ * of the Crout LU decomposition is done for all of them in a row of
+ * plain floating point operations.  The systems share the row
+ * exchanges: a pivot is taken if it is not smaller than
+ * BATCHLU_THRESHOLD times the largest (scaled) candidate of each
+ * system.  A system for which there is no such pivot is given up and
+ * left to the caller, e.g. to be solved by eqnsys with the usual
+ * failure handling.
+ */
+class batchlu
+{
+ public:
+  batchlu (int);
+  int  getSize (void) { return n; }
+  void setMatrix (int, const nr_complex_t *);
+  void setVector (int, const nr_complex_t *);
+  void getVector (int, nr_complex_t *);
+  int  factorize (int);
+  void substitute (void);
+
+ private:
+  void pivot (int, int &);
+
+ private:
+  int n;
+  int valid;   // bit mask of the systems decomposed
+  std::vector<nr_double_t> re, im;    // matrices, row by row
+  std::vector<nr_double_t> xr, xi;    // right hand sides and solutions
+  std::vector<nr_double_t> dr, di;    // inverse diagonals of L
+  std::vector<nr_double_t> scale;     // squared inverse row maxima
+  std::vector<int> rMap;
+};
+
+} // namespace qucs
+
+#endif /* __BATCHLU_H__ */
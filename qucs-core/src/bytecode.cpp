@@ -0,0 +1,576 @@
+/*
+ * bytecode.cpp - compiled equation evaluation class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <stdint.h>
+
+#include "logging.h"
+#include "complex.h"
+#include "object.h"
+#include "constants.h"
+#include "fspecial.h"
+#include "equation.h"
+#include "evaluate.h"
+#include "bytecode.h"
+
+using namespace qucs;
+using namespace qucs::eqn;
+using namespace fspecial;
+
+// Short helper macros.
+#define C(con) ((constant *) (con))
+#define A(con) ((assignment *) (con))
+#define R(con) ((reference *) (con))
+
+// Available instructions.
+enum {
+  OP_LOAD,   // r = *d
+  OP_LOADB,  // r = *p
+  OP_FUNC,   // r = f (a)
+  OP_NEG,    // r = -a
+  OP_ADD,    // r = a + b
+  OP_SUB,    // r = a - b
+  OP_MUL,    // r = a * b
+  OP_DIV,    // r = a / b, fails on division by zero
+  OP_POW,    // r = a ^ b
+  OP_MIN,    // r = min (a, b)
+  OP_MAX,    // r = max (a, b)
+  OP_LT,     // r = a < b
+  OP_LE,     // r = a <= b
+  OP_GT,     // r = a > b
+  OP_GE,     // r = a >= b
+  OP_EQ,     // r = a == b
+  OP_NE,     // r = a != b
+  OP_AND,    // r = a && b
+  OP_OR,     // r = a || b
+  OP_NOT,    // r = !a
+  OP_SEL,    // r = a ? b : c
+  OP_RFUNC,  // r = h (complex a)
+  OP_CLOAD,  // complex r = *z
+  OP_CFUNC,  // complex r = g (a)
+  OP_CNEG,   // complex r = -a
+  OP_CADD,   // complex r = a + b
+  OP_CSUB,   // complex r = a - b
+  OP_CMUL,   // complex r = a * b
+  OP_CDIV,   // complex r = a / b, fails on division by zero
+  OP_CPOW    // complex r = a ^ b
+};
+
+// Real and complex arguments of the complex binary instructions.
+enum {
+  ARGS_CC,
+  ARGS_CD,
+  ARGS_DC
+};
+
+/* The real valued functions exactly as resolved by the evaluate class
+   (which lives in the qucs namespace), so compiled and interpreted
+   equations give the same results. */
+#define MAKE_FUNC_STD(cfunc) \
+  static nr_double_t f_##cfunc (nr_double_t d) { return std::cfunc (d); }
+#define MAKE_FUNC_QUCS(cfunc) \
+  static nr_double_t f_##cfunc (nr_double_t d) { return qucs::cfunc (d); }
+#define MAKE_FUNC_SPECIAL(cfunc) \
+  static nr_double_t f_##cfunc (nr_double_t d) { return fspecial::cfunc (d); }
+
+MAKE_FUNC_QUCS (exp)
+MAKE_FUNC_QUCS (limexp)
+MAKE_FUNC_QUCS (sin)
+MAKE_FUNC_QUCS (cos)
+MAKE_FUNC_QUCS (tan)
+MAKE_FUNC_QUCS (sinh)
+MAKE_FUNC_QUCS (cosh)
+MAKE_FUNC_QUCS (tanh)
+MAKE_FUNC_QUCS (coth)
+MAKE_FUNC_QUCS (sech)
+MAKE_FUNC_QUCS (cosech)
+MAKE_FUNC_QUCS (signum)
+MAKE_FUNC_QUCS (sign)
+MAKE_FUNC_QUCS (sinc)
+MAKE_FUNC_QUCS (sqr)
+MAKE_FUNC_QUCS (abs)
+MAKE_FUNC_STD (ceil)
+MAKE_FUNC_STD (floor)
+MAKE_FUNC_QUCS (fix)
+MAKE_FUNC_QUCS (step)
+MAKE_FUNC_QUCS (round)
+MAKE_FUNC_SPECIAL (erf)
+MAKE_FUNC_STD (atan)
+
+/* The complex valued functions, resolved like in the evaluate class
+   as well. */
+#define MAKE_CFUNC(cfunc) \
+  static nr_complex_t c_##cfunc (nr_complex_t z) { return cfunc (z); }
+#define MAKE_RFUNC(cfunc) \
+  static nr_double_t r_##cfunc (nr_complex_t z) { return cfunc (z); }
+
+MAKE_CFUNC (exp)
+MAKE_CFUNC (limexp)
+MAKE_CFUNC (sin)
+MAKE_CFUNC (cos)
+MAKE_CFUNC (tan)
+MAKE_CFUNC (sinh)
+MAKE_CFUNC (cosh)
+MAKE_CFUNC (tanh)
+MAKE_CFUNC (sqr)
+MAKE_CFUNC (conj)
+static nr_complex_t c_sqrt (nr_complex_t z) { return std::sqrt (z); }
+static nr_complex_t c_ln (nr_complex_t z) { return std::log (z); }
+static nr_complex_t c_log10 (nr_complex_t z) { return std::log10 (z); }
+MAKE_RFUNC (real)
+MAKE_RFUNC (imag)
+MAKE_RFUNC (abs)
+MAKE_RFUNC (arg)
+MAKE_RFUNC (norm)
+
+// Translation of evaluation functions into instructions.
+static struct {
+  evaluator_t eval;
+  int op;
+  nr_double_t (* f) (nr_double_t);
+}
+instructions[] = {
+  { evaluate::minus_d,            OP_NEG,  NULL      },
+  { evaluate::plus_d_d,           OP_ADD,  NULL      },
+  { evaluate::minus_d_d,          OP_SUB,  NULL      },
+  { evaluate::times_d_d,          OP_MUL,  NULL      },
+  { evaluate::over_d_d,           OP_DIV,  NULL      },
+  { evaluate::power_d_d,          OP_POW,  NULL      },
+  { evaluate::min_d_d,            OP_MIN,  NULL      },
+  { evaluate::max_d_d,            OP_MAX,  NULL      },
+  { evaluate::less_d_d,           OP_LT,   NULL      },
+  { evaluate::lessorequal_d_d,    OP_LE,   NULL      },
+  { evaluate::greater_d_d,        OP_GT,   NULL      },
+  { evaluate::greaterorequal_d_d, OP_GE,   NULL      },
+  { evaluate::equal_d_d,          OP_EQ,   NULL      },
+  { evaluate::notequal_d_d,       OP_NE,   NULL      },
+  { evaluate::and_b_b,            OP_AND,  NULL      },
+  { evaluate::or_b_b,             OP_OR,   NULL      },
+  { evaluate::not_b,              OP_NOT,  NULL      },
+  { evaluate::ifthenelse_d_d,     OP_SEL,  NULL      },
+  { evaluate::ifthenelse_b_b,     OP_SEL,  NULL      },
+  { evaluate::ifthenelse_d_b,     OP_SEL,  NULL      },
+  { evaluate::ifthenelse_b_d,     OP_SEL,  NULL      },
+  { evaluate::exp_d,              OP_FUNC, f_exp     },
+  { evaluate::limexp_d,           OP_FUNC, f_limexp  },
+  { evaluate::sin_d,              OP_FUNC, f_sin     },
+  { evaluate::cos_d,              OP_FUNC, f_cos     },
+  { evaluate::tan_d,              OP_FUNC, f_tan     },
+  { evaluate::sinh_d,             OP_FUNC, f_sinh    },
+  { evaluate::cosh_d,             OP_FUNC, f_cosh    },
+  { evaluate::tanh_d,             OP_FUNC, f_tanh    },
+  { evaluate::coth_d,             OP_FUNC, f_coth    },
+  { evaluate::sech_d,             OP_FUNC, f_sech    },
+  { evaluate::cosech_d,           OP_FUNC, f_cosech  },
+  { evaluate::signum_d,           OP_FUNC, f_signum  },
+  { evaluate::sign_d,             OP_FUNC, f_sign    },
+  { evaluate::sinc_d,             OP_FUNC, f_sinc    },
+  { evaluate::sqr_d,              OP_FUNC, f_sqr     },
+  { evaluate::abs_d,              OP_FUNC, f_abs     },
+  { evaluate::ceil_d,             OP_FUNC, f_ceil    },
+  { evaluate::floor_d,            OP_FUNC, f_floor   },
+  { evaluate::fix_d,              OP_FUNC, f_fix     },
+  { evaluate::step_d,             OP_FUNC, f_step    },
+  { evaluate::round_d,            OP_FUNC, f_round   },
+  { evaluate::erf_d,              OP_FUNC, f_erf     },
+  { evaluate::arctan_d,           OP_FUNC, f_atan    },
+  { NULL, -1, NULL }
+};
+
+// Translation of real valued functions of complex arguments.
+static struct {
+  evaluator_t eval;
+  nr_double_t (* h) (nr_complex_t);
+}
+rinstructions[] = {
+  { evaluate::real_c, r_real },
+  { evaluate::imag_c, r_imag },
+  { evaluate::abs_c,  r_abs  },
+  { evaluate::arg_c,  r_arg  },
+  { evaluate::norm_c, r_norm },
+  { NULL, NULL }
+};
+
+// Translation of complex evaluation functions into instructions.
+static struct {
+  evaluator_t eval;
+  int op, m;
+  nr_complex_t (* g) (nr_complex_t);
+}
+cinstructions[] = {
+  { evaluate::minus_c,   OP_CNEG,  ARGS_CC, NULL    },
+  { evaluate::plus_c_c,  OP_CADD,  ARGS_CC, NULL    },
+  { evaluate::plus_c_d,  OP_CADD,  ARGS_CD, NULL    },
+  { evaluate::plus_d_c,  OP_CADD,  ARGS_DC, NULL    },
+  { evaluate::minus_c_c, OP_CSUB,  ARGS_CC, NULL    },
+  { evaluate::minus_c_d, OP_CSUB,  ARGS_CD, NULL    },
+  { evaluate::minus_d_c, OP_CSUB,  ARGS_DC, NULL    },
+  { evaluate::times_c_c, OP_CMUL,  ARGS_CC, NULL    },
+  { evaluate::times_c_d, OP_CMUL,  ARGS_CD, NULL    },
+  { evaluate::times_d_c, OP_CMUL,  ARGS_DC, NULL    },
+  { evaluate::over_c_c,  OP_CDIV,  ARGS_CC, NULL    },
+  { evaluate::over_c_d,  OP_CDIV,  ARGS_CD, NULL    },
+  { evaluate::over_d_c,  OP_CDIV,  ARGS_DC, NULL    },
+  { evaluate::power_c_c, OP_CPOW,  ARGS_CC, NULL    },
+  { evaluate::power_c_d, OP_CPOW,  ARGS_CD, NULL    },
+  { evaluate::power_d_c, OP_CPOW,  ARGS_DC, NULL    },
+  { evaluate::exp_c,     OP_CFUNC, ARGS_CC, c_exp   },
+  { evaluate::limexp_c,  OP_CFUNC, ARGS_CC, c_limexp },
+  { evaluate::sin_c,     OP_CFUNC, ARGS_CC, c_sin   },
+  { evaluate::cos_c,     OP_CFUNC, ARGS_CC, c_cos   },
+  { evaluate::tan_c,     OP_CFUNC, ARGS_CC, c_tan   },
+  { evaluate::sinh_c,    OP_CFUNC, ARGS_CC, c_sinh  },
+  { evaluate::cosh_c,    OP_CFUNC, ARGS_CC, c_cosh  },
+  { evaluate::tanh_c,    OP_CFUNC, ARGS_CC, c_tanh  },
+  { evaluate::sqr_c,     OP_CFUNC, ARGS_CC, c_sqr   },
+  { evaluate::conj_c,    OP_CFUNC, ARGS_CC, c_conj  },
+  { evaluate::sqrt_c,    OP_CFUNC, ARGS_CC, c_sqrt  },
+  { evaluate::ln_c,      OP_CFUNC, ARGS_CC, c_ln    },
+  { evaluate::log10_c,   OP_CFUNC, ARGS_CC, c_log10 },
+  { NULL, -1, 0, NULL }
+};
+
+// Constructor creates an empty instance of the bytecode class.
+bytecode::bytecode () {
+}
+
+// Destructor deletes an instance of the bytecode class.
+bytecode::~bytecode () {
+}
+
+/* Appends an instruction writing into a new register and returns the
+   index of the instruction. */
+int bytecode::emit (int op, int a, int b, int c) {
+  instruction i;
+  i.op = op;
+  i.r = regs.size ();
+  i.a = a;
+  i.b = b;
+  i.c = c;
+  i.m = ARGS_CC;
+  i.d = NULL;
+  i.p = NULL;
+  i.z = NULL;
+  i.f = NULL;
+  i.g = NULL;
+  i.h = NULL;
+  code.push_back (i);
+  regs.push_back (0.0);
+  known.push_back (false);
+  producer.push_back (code.size () - 1);
+  return code.size () - 1;
+}
+
+/* Returns a register holding the given literal constant.  Its value is
+   set once here, no instruction writes it. */
+int bytecode::literal (nr_double_t d) {
+  unsigned long long bits;
+  memcpy (&bits, &d, sizeof (bits));
+  auto it = literals.find (bits);
+  if (it != literals.end ()) return it->second;
+  regs.push_back (d);
+  known.push_back (true);
+  producer.push_back (-1);
+  return literals[bits] = regs.size () - 1;
+}
+
+/* Returns the register holding the result of the given real valued
+   operation.  Identities are passed through, operations on literals
+   are folded into a literal and an operation already emitted with the
+   same arguments is reused. */
+int bytecode::value (int op, nr_double_t (* f) (nr_double_t),
+		     int a, int b, int c) {
+  switch (op) {
+  case OP_ADD:
+    if (isLiteral (b) && regs[b] == 0.0) return a;
+    if (isLiteral (a) && regs[a] == 0.0) return b;
+    break;
+  case OP_SUB:
+    if (isLiteral (b) && regs[b] == 0.0) return a;
+    break;
+  case OP_MUL:
+    if (isLiteral (b) && regs[b] == 1.0) return a;
+    if (isLiteral (a) && regs[a] == 1.0) return b;
+    break;
+  case OP_DIV:
+  case OP_POW:
+    if (isLiteral (b) && regs[b] == 1.0) return a;
+    break;
+  case OP_NEG:
+    if (producer[a] >= 0 && code[producer[a]].op == OP_NEG)
+      return code[producer[a]].a;
+    break;
+  case OP_SEL:
+    if (isLiteral (a)) return regs[a] != 0.0 ? b : c;
+    break;
+  }
+
+  // the operands of commutative operations in a canonical order
+  if ((op == OP_ADD || op == OP_MUL) && a > b) std::swap (a, b);
+  std::vector<long long> key = { op, a, b, c, (long long) (intptr_t) f };
+  auto it = values.find (key);
+  if (it != values.end ()) return it->second;
+
+  int i = emit (op, a, b, c);
+  code[i].f = f;
+  int r = code[i].r;
+  if ((a < 0 || isLiteral (a)) && (b < 0 || isLiteral (b)) &&
+      (c < 0 || isLiteral (c)) &&
+      execute (code[i], regs.data (), cregs.data ()) == 0) {
+    // fold into a literal, failing instructions fail at run time
+    nr_double_t d = regs[r];
+    code.pop_back ();
+    regs.pop_back ();
+    known.pop_back ();
+    producer.pop_back ();
+    r = literal (d);
+  }
+  return values[key] = r;
+}
+
+/* Appends an instruction writing into a new complex register and
+   returns the index of the instruction. */
+int bytecode::emitComplex (int op, int a, int b, int c) {
+  int i = emit (op, a, b, c);
+  regs.pop_back ();
+  known.pop_back ();
+  producer.pop_back ();
+  code[i].r = cregs.size ();
+  cregs.push_back (0.0);
+  return i;
+}
+
+/* Compiles the given equation node and everything it depends on.  The
+   function returns the register holding the result of the node or -1
+   if the node cannot be compiled, e.g. because it is not real valued
+   or uses functions without bytecode representation. */
+int bytecode::compile (node * eqn) {
+  if (eqn == NULL) return -1;
+  auto it = results.find (eqn);
+  if (it != results.end ()) return it->second;
+  int r = compileNode (eqn);
+  if (r >= 0) results[eqn] = r;
+  return r;
+}
+
+// Compiles a single equation node.
+int bytecode::compileNode (node * eqn) {
+  int type = eqn->getType ();
+  if (type != TAG_DOUBLE && type != TAG_BOOLEAN) return -1;
+
+  switch (eqn->getTag ()) {
+  case CONSTANT:
+    // constants within the equations are literals
+    return literal (type == TAG_DOUBLE ? C(eqn)->d : C(eqn)->b ? 1.0 : 0.0);
+  case REFERENCE:
+    // references use the result of the referenced assignment
+    R(eqn)->findVariable ();
+    return compile (R(eqn)->ref);
+  case ASSIGNMENT:
+    // assigned constants may be changed, they are loaded each run
+    if (A(eqn)->body->getTag () == CONSTANT &&
+	A(eqn)->body->getType () == type) {
+      constant * con = C(A(eqn)->body);
+      int i = emit (type == TAG_DOUBLE ? OP_LOAD : OP_LOADB);
+      if (type == TAG_DOUBLE)
+	code[i].d = &con->d;
+      else
+	code[i].p = &con->b;
+      return code[i].r;
+    }
+    return compile (A(eqn)->body);
+  case APPLICATION:
+    return compileApplication ((application *) eqn);
+  }
+  return -1;
+}
+
+// Compiles an application node.
+int bytecode::compileApplication (application * app) {
+  // ddx() applications evaluate their precomputed derivative
+  if (app->nargs == 2 && !strcmp (app->n, "ddx")) {
+    return app->ddx ? compile (app->ddx) : -1;
+  }
+  // unary plus is a no-op
+  if (app->eval == evaluate::plus_d) {
+    return compile (app->args);
+  }
+
+  int k;
+  for (k = 0; instructions[k].eval != NULL; k++)
+    if (instructions[k].eval == app->eval) break;
+  if (instructions[k].eval == NULL) {
+    // real valued functions of a complex argument
+    for (k = 0; rinstructions[k].eval != NULL; k++)
+      if (rinstructions[k].eval == app->eval) break;
+    if (rinstructions[k].eval == NULL || app->nargs != 1) return -1;
+    int a = compileComplex (app->args);
+    if (a < 0) return -1;
+    int i = emit (OP_RFUNC, a);
+    code[i].h = rinstructions[k].h;
+    return code[i].r;
+  }
+  if (app->nargs > 3) return -1;
+
+  int arg[3] = { -1, -1, -1 }, n = 0;
+  for (node * a = app->args; a != NULL; a = a->getNext (), n++) {
+    if ((arg[n] = compile (a)) < 0) return -1;
+  }
+  return value (instructions[k].op, instructions[k].f, arg[0], arg[1], arg[2]);
+}
+
+/* Compiles the given complex valued equation node and everything it
+   depends on.  The function returns the complex register holding the
+   result of the node or -1 if the node cannot be compiled. */
+int bytecode::compileComplex (node * eqn) {
+  if (eqn == NULL) return -1;
+  auto it = cresults.find (eqn);
+  if (it != cresults.end ()) return it->second;
+  int r = compileComplexNode (eqn);
+  if (r >= 0) cresults[eqn] = r;
+  return r;
+}
+
+// Compiles a single complex equation node.
+int bytecode::compileComplexNode (node * eqn) {
+  if (eqn->getType () != TAG_COMPLEX) return -1;
+
+  switch (eqn->getTag ()) {
+  case CONSTANT:
+    {
+      int i = emitComplex (OP_CLOAD);
+      code[i].z = C(eqn)->c;
+      return code[i].r;
+    }
+  case REFERENCE:
+    R(eqn)->findVariable ();
+    return compileComplex (R(eqn)->ref);
+  case ASSIGNMENT:
+    return compileComplex (A(eqn)->body);
+  case APPLICATION:
+    return compileComplexApplication ((application *) eqn);
+  }
+  return -1;
+}
+
+/* Compiles a complex application node.  The real arguments of the
+   mixed binary operators are used as they are, which keeps the results
+   of these operations. */
+int bytecode::compileComplexApplication (application * app) {
+  if (app->eval == evaluate::plus_c) {
+    return compileComplex (app->args);
+  }
+  int k;
+  for (k = 0; cinstructions[k].eval != NULL; k++)
+    if (cinstructions[k].eval == app->eval) break;
+  if (cinstructions[k].eval == NULL || app->nargs > 2) return -1;
+
+  int m = cinstructions[k].m, arg[2] = { -1, -1 }, n = 0;
+  for (node * a = app->args; a != NULL; a = a->getNext (), n++) {
+    bool real = (m == ARGS_CD && n == 1) || (m == ARGS_DC && n == 0);
+    if ((arg[n] = real ? compile (a) : compileComplex (a)) < 0) return -1;
+  }
+  int i = emitComplex (cinstructions[k].op, arg[0], arg[1]);
+  code[i].m = m;
+  code[i].g = cinstructions[k].g;
+  return code[i].r;
+}
+
+// Applies the binary operator to the real or complex arguments.
+#define CBINARY(op) \
+  switch (i.m) { \
+  case ARGS_CC: z[i.r] = z[i.a] op z[i.b]; break; \
+  case ARGS_CD: z[i.r] = z[i.a] op x[i.b]; break; \
+  default:      z[i.r] = x[i.a] op z[i.b]; break; \
+  }
+
+/* Executes a single instruction.  Returns zero on success and -1 if
+   the evaluation failed. */
+inline int bytecode::execute (const instruction & i, nr_double_t * x,
+			      nr_complex_t * z) {
+  switch (i.op) {
+  case OP_LOAD:  x[i.r] = *i.d; break;
+  case OP_LOADB: x[i.r] = *i.p ? 1.0 : 0.0; break;
+  case OP_FUNC:  x[i.r] = i.f (x[i.a]); break;
+  case OP_NEG:   x[i.r] = -x[i.a]; break;
+  case OP_ADD:   x[i.r] = x[i.a] + x[i.b]; break;
+  case OP_SUB:   x[i.r] = x[i.a] - x[i.b]; break;
+  case OP_MUL:   x[i.r] = x[i.a] * x[i.b]; break;
+  case OP_DIV:
+    if (x[i.b] == 0.0) return -1;
+    x[i.r] = x[i.a] / x[i.b];
+    break;
+  case OP_POW:   x[i.r] = std::pow (x[i.a], x[i.b]); break;
+  case OP_MIN:   x[i.r] = std::min (x[i.a], x[i.b]); break;
+  case OP_MAX:   x[i.r] = std::max (x[i.a], x[i.b]); break;
+  case OP_LT:    x[i.r] = x[i.a] <  x[i.b] ? 1.0 : 0.0; break;
+  case OP_LE:    x[i.r] = x[i.a] <= x[i.b] ? 1.0 : 0.0; break;
+  case OP_GT:    x[i.r] = x[i.a] >  x[i.b] ? 1.0 : 0.0; break;
+  case OP_GE:    x[i.r] = x[i.a] >= x[i.b] ? 1.0 : 0.0; break;
+  case OP_EQ:    x[i.r] = x[i.a] == x[i.b] ? 1.0 : 0.0; break;
+  case OP_NE:    x[i.r] = x[i.a] != x[i.b] ? 1.0 : 0.0; break;
+  case OP_AND:   x[i.r] = x[i.a] != 0.0 && x[i.b] != 0.0 ? 1.0 : 0.0; break;
+  case OP_OR:    x[i.r] = x[i.a] != 0.0 || x[i.b] != 0.0 ? 1.0 : 0.0; break;
+  case OP_NOT:   x[i.r] = x[i.a] == 0.0 ? 1.0 : 0.0; break;
+  case OP_SEL:   x[i.r] = x[i.a] != 0.0 ? x[i.b] : x[i.c]; break;
+  case OP_RFUNC: x[i.r] = i.h (z[i.a]); break;
+  case OP_CLOAD: z[i.r] = *i.z; break;
+  case OP_CFUNC: z[i.r] = i.g (z[i.a]); break;
+  case OP_CNEG:  z[i.r] = -z[i.a]; break;
+  case OP_CADD:  CBINARY (+); break;
+  case OP_CSUB:  CBINARY (-); break;
+  case OP_CMUL:  CBINARY (*); break;
+  case OP_CDIV:
+    if (i.m == ARGS_CD ? x[i.b] == 0.0 : z[i.b] == 0.0) return -1;
+    CBINARY (/);
+    break;
+  case OP_CPOW:
+    switch (i.m) {
+    case ARGS_CC: z[i.r] = std::pow (z[i.a], z[i.b]); break;
+    case ARGS_CD: z[i.r] = pow (z[i.a], x[i.b]); break;
+    default:      z[i.r] = pow (x[i.a], z[i.b]); break;
+    }
+    break;
+  }
+  return 0;
+}
+
+/* Runs the compiled instructions.  Returns zero on success and -1 if
+   the evaluation failed, in which case the caller should fall back to
+   the equation solver to get the appropriate error handling. */
+int bytecode::run (void) {
+  nr_double_t * x = regs.data ();
+  nr_complex_t * z = cregs.data ();
+  for (auto &i : code) {
+    if (execute (i, x, z)) return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * bytecode.h - compiled equation evaluation class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __BYTECODE_H__
+#define __BYTECODE_H__
+
+#include <vector>
+#include <map>
+
+namespace qucs {
+
+namespace eqn {
+
+class node;
+class application;
+
+/* The bytecode class translates checked equation trees with real
+   valued and boolean results into a flat list of register based
+   instructions.  Each compiled assignment owns a register which is
+   preallocated, thus repeated evaluation does not allocate memory and
+   avoids the tree walk and the constant objects of the equation
+   solver.  Constants are loaded by reference, so values changed in the
+   equations (e.g. by checker::setDouble()) are seen by the next run.
+   Complex valued equations are compiled into a separate bank of
+   complex registers.
+
+   The real valued instructions are simplified as they are emitted.
+   Literal constants live in registers set at compile time, operations
+   on literals only are folded, the identities x+0, x-0, x*1, x/1, x^1
+   and -(-x) are dropped and equal instructions on equal registers are
+   emitted once.  The symbolic derivatives of the equation defined
+   devices repeat large parts of the original equations, these share
+   their registers across all the equations of a program. */
+class bytecode
+{
+ public:
+  bytecode ();
+  ~bytecode ();
+  int compile (node *);
+  int compileComplex (node *);
+  int run (void);
+  nr_double_t get (int r) { return regs[r]; }
+  nr_complex_t getComplex (int r) { return cregs[r]; }
+  int size (void) { return code.size (); }
+
+ private:
+  int emit (int, int a = -1, int b = -1, int c = -1);
+  int literal (nr_double_t);
+  int value (int, nr_double_t (*) (nr_double_t), int a = -1, int b = -1,
+	     int c = -1);
+  bool isLiteral (int r) { return r >= 0 && known[r]; }
+  int compileNode (node *);
+  int compileApplication (application *);
+  int emitComplex (int, int a = -1, int b = -1, int c = -1);
+  int compileComplexNode (node *);
+  int compileComplexApplication (application *);
+
+ private:
+  struct instruction {
+    int op;
+    int r;                      // result register
+    int a, b, c;                // argument registers
+    int m;                      // real and complex arguments
+    const nr_double_t * d;      // double constant to load
+    const bool * p;             // boolean constant to load
+    const nr_complex_t * z;     // complex constant to load
+    nr_double_t (* f) (nr_double_t);
+    nr_complex_t (* g) (nr_complex_t);
+    nr_double_t (* h) (nr_complex_t);
+  };
+  static int execute (const instruction &, nr_double_t *, nr_complex_t *);
+  std::vector<instruction> code;
+  std::vector<nr_double_t> regs;
+  std::vector<nr_complex_t> cregs;
+  // registers of already compiled nodes
+  std::map<node *, int> results, cresults;
+  // literal registers, the instruction writing each real register and
+  // the registers of the emitted real instructions by their operands
+  std::vector<bool> known;
+  std::vector<int> producer;
+  std::map<unsigned long long, int> literals;
+  std::map<std::vector<long long>, int> values;
+};
+
+} // namespace eqn
+
+} // namespace qucs
+
+#endif /* __BYTECODE_H__ */
@@ -31,6 +31,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <cmath>
+#include <string>
 
 #include "logging.h"
 #include "complex.h"
@@ -41,6 +42,7 @@
 #include "dataset.h"
 #include "strlist.h"
 #include "constants.h"
+#include "tokenizer.h"
 #include "check_citi.h"
 
 using namespace qucs;
@@ -94,7 +96,6 @@ static qucs::vector * citi_create_vector (struct citi_package_t * p, int i,
   qucs::vector * vec;
   vec = citi_get_vector (p, i); // fetch vector
   vec = new qucs::vector (*vec);      // copy vector
-  vec->reverse ();              // reverse vector
 
   // convert data if necessary
   if (!strcmp (type, "MAGANGLE")) {
@@ -279,6 +280,230 @@ void citi_destroy (void) {
   }
 }
 
+/* The fast CITIfile reader below goes through the contents of the file
+   once and builds the packages the parser would, the values of each
+   data block are appended to its vector right away.  The checker above
+   creates the dataset from them.  A file the reader does not fully
+   understand is left to the scanner and parser, which give the
+   appropriate error messages. */
+
+// Variable types of the CITIfile format.
+static const char * citi_types[] = { "RI", "MAG", "MAGANGLE", "DBANGLE",
+				      NULL };
+
+// Returns the variable type of the given word or NULL if it is none.
+static const char * citi_type (const std::string & word) {
+  for (int i = 0; citi_types[i] != NULL; i++)
+    if (word == citi_types[i]) return citi_types[i];
+  return NULL;
+}
+
+// Returns non-zero if the given word is a version like 'A.01.00'.
+static int citi_version (const std::string & word) {
+  const char * s = word.c_str ();
+  if (!isalpha ((unsigned char) *s++)) return 0;
+  for (int i = 0; i < 2; i++) {
+    if (*s++ != '.' || !isdigit ((unsigned char) *s)) return 0;
+    while (isdigit ((unsigned char) *s)) s++;
+  }
+  return *s == '\0';
+}
+
+/* Returns the word at the cursor and moves past it, the characters of
+   identifiers and versions only. */
+static std::string citi_word (tokenizer & t) {
+  t.skip ();
+  const char * s = t.getCursor ();
+  if (t.atEnd () || (!isalpha ((unsigned char) *s) && *s != '_'))
+    return std::string ();
+  return t.take (t.span ("_."));
+}
+
+/* Returns the identifier at the cursor, NULL if there is none.  The
+   scanner takes variable types for identifiers in constant lines
+   only. */
+static char * citi_ident (tokenizer & t, int constant = 0) {
+  std::string id = citi_word (t);
+  if (id.empty () || citi_version (id) || (!constant && citi_type (id)))
+    return NULL;
+  return strdup (id.c_str ());
+}
+
+// Reads the integer at the cursor.  Returns non-zero if there is none.
+static int citi_integer (tokenizer & t, int & n) {
+  t.skip ();
+  const char * s = t.getCursor (), * e = s;
+  int negative = 0;
+  if (e < t.getEnd () && (*e == '+' || *e == '-')) negative = *e++ == '-';
+  if (e == t.getEnd () || !isdigit ((unsigned char) *e)) return -1;
+  for (n = 0; e < t.getEnd () && isdigit ((unsigned char) *e); e++)
+    n = n * 10 + (*e - '0');
+  if (negative) n = -n;
+  t.advance (e - s);
+  return 0;
+}
+
+// Reads the number at the cursor.  Returns non-zero if there is none.
+static int citi_float (tokenizer & t, nr_double_t & val) {
+  t.skip ();
+  return t.number (val) && t.delimited (" \t,") ? 0 : -1;
+}
+
+// Returns non-zero if there is nothing but spaces left on the line.
+static int citi_eol (tokenizer & t) {
+  t.skip ();
+  return t.atEnd ();
+}
+
+/* Reads the lines of a data block up to the line starting with the
+   given keyword into the given vector.  A line holds one value or the
+   real and imaginary part of a complex value if complex values are
+   allowed.  Returns non-zero if the block is invalid. */
+static int citi_block (tokenizer & t, qucs::vector * v, const char * end,
+		       int complex) {
+  nr_double_t re, im;
+  while (t.next ()) {
+    // empty lines are allowed inside data blocks
+    if (t.atEnd ()) continue;
+    if (t.keyword (end)) return citi_eol (t) ? 0 : -1;
+    if (citi_float (t, re)) return -1;
+    t.skip ();
+    if (complex && t.literal (",")) {
+      if (citi_float (t, im)) return -1;
+      v->add (nr_complex_t (re, im));
+    }
+    else v->add (re);
+    if (!citi_eol (t)) return -1;
+  }
+  return -1;
+}
+
+/* Reads the header line at the cursor into the given header.  Returns
+   non-zero if it is invalid. */
+static int citi_header (tokenizer & t, struct citi_header_t * h) {
+  std::string type;
+  if (t.keyword ("NAME")) {
+    return (h->package = citi_ident (t)) && citi_eol (t) ? 0 : -1;
+  }
+  if (t.keyword ("VAR")) {
+    if (!(h->var = citi_ident (t))) return -1;
+    if (!citi_type (type = citi_word (t))) return -1;
+    h->type = strdup (type.c_str ());
+    h->i1 = h->i2 = -1;
+    return !citi_integer (t, h->n) && citi_eol (t) ? 0 : -1;
+  }
+  if (t.keyword ("DATA")) {
+    if (!(h->var = citi_ident (t))) return -1;
+    h->n = h->i1 = h->i2 = -1;
+    t.skip ();
+    if (t.literal ("[")) {
+      if (citi_integer (t, h->i1)) return -1;
+      t.skip ();
+      if (t.literal (",") && citi_integer (t, h->i2)) return -1;
+      t.skip ();
+      if (!t.literal ("]")) return -1;
+    }
+    if (!citi_type (type = citi_word (t))) return -1;
+    h->type = strdup (type.c_str ());
+    return citi_eol (t) ? 0 : -1;
+  }
+  return 1;
+}
+
+// Reads the given CITIfile contents into the packages.
+static int citi_fast (const char * data, long size) {
+  tokenizer t (data, size);
+  struct citi_package_t * p = NULL, ** pn = &citi_root;
+  struct citi_header_t ** hn = NULL;
+  qucs::vector * last = NULL, * v;
+  nr_double_t start, stop, points;
+
+  while (t.next ()) {
+    // empty lines and comments
+    if (t.atEnd ()) continue;
+    if (*t.getCursor () == '#' || t.keyword ("COMMENT")) continue;
+
+    // each package starts with the version line
+    if (t.keyword ("CITIFILE")) {
+      if (!citi_version (citi_word (t)) || !citi_eol (t)) return 1;
+      p = (struct citi_package_t *) calloc (sizeof (struct citi_package_t), 1);
+      *pn = p;
+      pn = &p->next;
+      hn = &p->head;
+      last = NULL;
+      continue;
+    }
+    if (p == NULL) return 1;
+
+    // the data blocks
+    v = NULL;
+    if (t.keyword ("BEGIN")) {
+      v = new qucs::vector ();
+      if (!citi_eol (t) || citi_block (t, v, "END", 1)) {
+	delete v;
+	return 1;
+      }
+    }
+    else if (t.keyword ("VAR_LIST_BEGIN")) {
+      v = new qucs::vector ();
+      if (!citi_eol (t) || citi_block (t, v, "VAR_LIST_END", 0)) {
+	delete v;
+	return 1;
+      }
+    }
+    else if (t.keyword ("SEG_LIST_BEGIN")) {
+      if (!citi_eol (t)) return 1;
+      do if (!t.next ()) return 1; while (t.atEnd ());
+      if (!t.keyword ("SEG") || citi_float (t, start) ||
+	  citi_float (t, stop) || citi_float (t, points) || !citi_eol (t))
+	return 1;
+      do if (!t.next ()) return 1; while (t.atEnd ());
+      if (!t.keyword ("SEG_LIST_END") || !citi_eol (t)) return 1;
+      v = new qucs::vector (qucs::linspace (start, stop, (int) points));
+    }
+    if (v != NULL) {
+      if (last) last->setNext (v);
+      else p->data = v;
+      last = v;
+      continue;
+    }
+
+    // the header lines precede the data blocks
+    if (last) return 1;
+    if (t.keyword ("CONSTANT")) {
+      char * id = citi_ident (t, 1);
+      int n = 0;
+      if (id == NULL) return 1;
+      free (id);
+      for (t.skip (); !t.atEnd (); t.skip (), n++)
+	if (citi_float (t, start)) return 1;
+      if (!n) return 1;
+      continue;
+    }
+    struct citi_header_t * h =
+      (struct citi_header_t *) calloc (sizeof (struct citi_header_t), 1);
+    *hn = h;
+    hn = &h->next;
+    if (citi_header (t, h)) return 1;
+  }
+  return citi_root ? 0 : 1;
+}
+
+/* The function reads the given contents of a CITIfile without the
+   scanner and parser and checks them.  It returns zero on success and
+   -1 on errors, the result is the citi_result dataset.  It returns 1
+   if the file should be read by the parser and checked instead. */
+int citi_read (const char * data, long size) {
+  citi_result = NULL;
+  citi_root = NULL;
+  if (citi_fast (data, size)) {
+    citi_finalize ();
+    citi_root = NULL;
+    return 1;
+  }
+  return citi_check ();
+}
+
 // Initializes the CITIfile checker.
 void citi_init (void) {
   citi_result = NULL;
@@ -64,6 +64,7 @@ int citi_error (const char *);
 int citi_lex (void);
 int citi_lex_destroy (void);
 int citi_check (void);
+int citi_read (const char *, long);
 void citi_init (void);
 void citi_destroy (void);
 
@@ -31,6 +31,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <cmath>
+#include <vector>
 
 #include "logging.h"
 #include "complex.h"
@@ -41,6 +42,7 @@
 #include "dataset.h"
 #include "strlist.h"
 #include "constants.h"
+#include "tokenizer.h"
 #include "check_csv.h"
 
 using namespace qucs;
@@ -77,17 +79,22 @@ static void csv_validate_str (char * n) {
 }
 
 /* Creates dataset from CSV vectors. */
-static void csv_create_dataset (int len) {
-  qucs::vector * dep, * indep, * v;
+/* Creates the dataset with a vector for each of the given number of
+   columns, the first one is the dependency of the others.  The column
+   vectors are left empty. */
+static void csv_create_dataset (int len, std::vector<qucs::vector *> & cols) {
+  qucs::vector * indep, * v;
   char * n, depn[256];
   strlist * s;
 
   // create dataset
   csv_result = new dataset ();
+  cols.assign (len, NULL);
 
   // add dependency vector
   indep = new qucs::vector ();
   csv_result->appendDependency (indep);
+  cols[0] = indep;
   s = new strlist ();
   n = csv_header ? csv_header->get (0) : (char *) "x";
   csv_validate_str (n);
@@ -106,23 +113,23 @@ static void csv_create_dataset (int len) {
     v->setName (n);
     v->setDependencies (new strlist (*s));
     csv_result->addVariable (v);
-  }
-
-  // fill all vectors in dataset
-  for (v = csv_vector; v != NULL; v = (qucs::vector *) v->getNext ()) {
-    dep = csv_result->getVariables ();
-    int l;
-    for (l = 0; l < v->getSize () - 1; l++) {
-      dep->add (v->get (l));
-      dep = (qucs::vector *) dep->getNext ();
-    }
-    indep->add (v->get (l));
+    cols[i] = v;
   }
 
   // cleanup
   delete s;
 }
 
+/* Fills the column vectors with the parsed data lines, their values
+   are in reverse order. */
+static void csv_fill_dataset (std::vector<qucs::vector *> & cols) {
+  int len = cols.size ();
+  for (qucs::vector * v = csv_vector; v != NULL;
+       v = (qucs::vector *) v->getNext ()) {
+    for (int l = 0; l < len; l++) cols[len - 1 - l]->add (v->get (l));
+  }
+}
+
 /* This function is the checker routine for a parsed CSV.  It returns
    zero on success or non-zero if the parsed csv contained errors. */
 int csv_check (void) {
@@ -155,7 +162,9 @@ int csv_check (void) {
     }
     // create dataset if possible
     if (!errors) {
-      csv_create_dataset (len);
+      std::vector<qucs::vector *> cols;
+      csv_create_dataset (len, cols);
+      csv_fill_dataset (cols);
     }
   }
 
@@ -179,6 +188,107 @@ void csv_destroy (void) {
   }
 }
 
+/* The fast CSV reader below goes through the contents of the file once
+   and appends the values of each data line to the column vectors of
+   the resulting dataset right away.  A file it does not fully
+   understand is left to the scanner, parser and checker above, which
+   give the appropriate error messages. */
+
+// Spaces and separators between the fields of a line.
+#define CSV_SEPARATORS " \t;,"
+
+/* Reads the header line at the cursor into csv_header.  Returns
+   non-zero if the scanner would see anything but identifiers. */
+static int csv_header_line (tokenizer & t) {
+  csv_header = new strlist ();
+  for (; !t.atEnd (); t.skip (CSV_SEPARATORS)) {
+    const char * s = t.getCursor (), * e;
+    // quoted identifiers run until the closing quote
+    if (*s == '"') {
+      s++;
+      e = (const char *) memchr (s, '"', t.getEnd () - s);
+      if (e == NULL || e == s) return -1;
+      csv_header->append (std::string (s, e).c_str ());
+      t.advance (e + 1 - t.getCursor ());
+      continue;
+    }
+    // identifiers with an optional matrix index like 'S[1,2]'
+    int n = t.span ("_.");
+    if (!n || (!isalpha ((unsigned char) *s) && *s != '_')) return -1;
+    e = s + n;
+    if (e < t.getEnd () && *e == '[') {
+      const char * i = e + 1;
+      int rows = 0, cols = 0;
+      for (; i < t.getEnd () && isdigit ((unsigned char) *i); i++) rows++;
+      if (!rows || i == t.getEnd () || *i++ != ',') return -1;
+      for (; i < t.getEnd () && isdigit ((unsigned char) *i); i++) cols++;
+      if (!cols || i == t.getEnd () || *i != ']') return -1;
+      n = i + 1 - s;
+    }
+    std::string ident = t.take (n);
+    if (!t.delimited (CSV_SEPARATORS)) return -1;
+    csv_header->append (ident.c_str ());
+  }
+  return 0;
+}
+
+// Reads the given CSV file contents.
+static int csv_fast (const char * data, long size) {
+  tokenizer t (data, size);
+  std::vector<qucs::vector *> cols;
+  std::vector<nr_double_t> row;
+  nr_double_t val;
+  int len = -1;
+
+  while (t.next ()) {
+    t.skip (CSV_SEPARATORS);
+    if (t.atEnd ()) continue;
+
+    // the header line precedes the data lines
+    const char * s = t.getCursor ();
+    if (*s == '"' || isalpha ((unsigned char) *s) || *s == '_') {
+      if (len >= 0 || csv_header) return 1;
+      if (csv_header_line (t)) return 1;
+      continue;
+    }
+
+    row.clear ();
+    for (; !t.atEnd (); t.skip (CSV_SEPARATORS)) {
+      if (!t.number (val) || !t.delimited (CSV_SEPARATORS)) return 1;
+      row.push_back (val);
+    }
+    // the first data line gives the number of columns
+    if (len < 0) {
+      len = row.size ();
+      if (csv_header && csv_header->length () != len) return 1;
+      csv_create_dataset (len, cols);
+      int lines = size / (t.getEnd () - t.getBegin () + 1) + 1;
+      for (int i = 0; i < len; i++) cols[i]->reserve (lines);
+    }
+    if ((int) row.size () != len) return 1;
+    for (int i = 0; i < len; i++) cols[i]->add (row[i]);
+  }
+  return len < 0 ? 1 : 0;
+}
+
+/* The function reads the given contents of a CSV file without the
+   scanner and parser.  It returns zero on success, the result is the
+   csv_result dataset.  It returns 1 if the file should be read by the
+   parser and checked instead. */
+int csv_read (const char * data, long size) {
+  csv_result = NULL;
+  int status = csv_fast (data, size);
+  if (status && csv_result != NULL) {
+    delete csv_result;
+    csv_result = NULL;
+  }
+  if (csv_header != NULL) {
+    delete csv_header;
+    csv_header = NULL;
+  }
+  return status;
+}
+
 // Initializes the CSV file checker.
 void csv_init (void) {
   csv_result = NULL;
@@ -48,6 +48,7 @@ int csv_error (const char *);
 int csv_lex (void);
 int csv_lex_destroy (void);
 int csv_check (void);
+int csv_read (const char *, long);
 void csv_init (void);
 void csv_destroy (void);
 
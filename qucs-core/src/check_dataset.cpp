@@ -87,9 +87,10 @@ int dataset_check (dataset * data) {
 	}
       }
       if (n != 0) {
-	if (v->getSize () % n != 0) {
+	if (data->countValues (v) % n != 0) {
 	  logprint (LOG_ERROR, "checker error, size of vector `%s' %d should "
-		    "be dividable by %d\n", v->getName (), v->getSize (), n);
+		    "be dividable by %d\n", v->getName (), data->countValues (v),
+		    n);
 	  errors++;
 	}
       }
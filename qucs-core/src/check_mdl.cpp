@@ -33,6 +33,7 @@
 #include <assert.h>
 #include <float.h>
 #include <ctype.h>
+#include <string>
 
 #include "logging.h"
 #include "strlist.h"
@@ -43,6 +44,7 @@
 #include "sweep.h"
 #include "valuelist.h"
 #include "constants.h"
+#include "tokenizer.h"
 #include "check_mdl.h"
 #include "parse_mdl.hpp"
 
@@ -693,6 +695,600 @@ void mdl_destroy (void) {
   }
 }
 
+/* The fast MDL reader below goes through the contents of the file once
+   and builds the links the parser would, which the checker above
+   turns into the dataset.  It takes the tokens the way the scanner
+   does: the keywords start the lines, the contents of block editor,
+   circuit deck and view data tables are skipped up to the line
+   starting with the closing brace.  A file the reader does not fully
+   understand is left to the scanner and parser, which give the
+   appropriate error messages. */
+
+// Tokens of the MDL scanner.
+enum mdl_token_t {
+  MDL_END,
+  MDL_INVALID,
+  MDL_LBRACE,
+  MDL_RBRACE,
+  MDL_STRING,
+  MDL_REAL,
+  MDL_IDENT,
+  MDL_LINKTYPE,
+  MDL_KEYWORD
+};
+
+// States of the MDL scanner.
+enum mdl_state_t {
+  MDL_INITIAL,
+  MDL_PLINK,   // a link type follows
+  MDL_BLKEDIT, // a string and a skipped block follow
+  MDL_BLOCK,   // a skipped block follows
+  MDL_SKIP     // inside a skipped block
+};
+
+// Keywords of the MDL files, in the order of the list below.
+enum mdl_keyword_t {
+  MDL_LINK, MDL_VIEW, MDL_TABLE, MDL_PSTABLE, MDL_BLKEDIT_KEY, MDL_CNTABLE,
+  MDL_OPTIMEDIT, MDL_HYPTABLE, MDL_ELEMENT, MDL_DATA, MDL_DATASET,
+  MDL_DATASIZE, MDL_POINT, MDL_MEMBER, MDL_LIST, MDL_PLOTOPTIMIZEROPT,
+  MDL_PLOTOPTIMIZERTRACESET, MDL_PLOTOPTIMIZERTRACEREGSET,
+  MDL_PLOTOPTIMIZERTRACENATREGSET, MDL_PLOTERROR, MDL_TYPE, MDL_EDITSIZE,
+  MDL_PLOTSIZE, MDL_OPTRANGE, MDL_PARAM, MDL_RANGE, MDL_TERM, MDL_CALSET,
+  MDL_CALDATA, MDL_APPLIC, MDL_SUBAPP, MDL_CONNPAIR, MDL_CIRCUITDECK,
+  MDL_ICVIEWDATA
+};
+
+static const char * mdl_keywords[] = {
+  "LINK", "View", "TABLE", "PSTABLE", "BLKEDIT", "CNTABLE", "OPTIMEDIT",
+  "HYPTABLE", "element", "data", "dataset", "datasize", "point", "member",
+  "list", "PlotOptimizerOpt", "PlotOptimizerTraceSet",
+  "PlotOptimizerTraceRegSet", "PlotOptimizerTraceNatRegSet", "PlotError",
+  "type", "editsize", "plotsize", "optrange", "param", "range", "term",
+  "calset", "caldata", "applic", "subapp", "connpair", "circuitdeck", NULL
+};
+
+static const char * mdl_links[] = {
+  "MODEL", "CIRC", "PS", "DUT", "DPS", "DAT", "OUT", "SWEEP", "XFORM",
+  "MACRO", "TCIRC", "CONN", "PLOT", NULL
+};
+
+// State of the fast MDL reader.
+struct mdl_reader_t {
+  tokenizer * t;
+  int token;        // the current token
+  int keyword;      // the current keyword
+  int state;        // the scanner state
+  std::string text; // the text of words and strings
+  nr_double_t real; // the value of numbers
+};
+
+// Returns the index of the word in the given list or -1.
+static int mdl_lookup (const std::string & word, const char ** list) {
+  for (int i = 0; list[i] != NULL; i++)
+    if (word == list[i]) return i;
+  return -1;
+}
+
+/* Returns non-zero if the given word is an identifier of the scanner.
+   It consists of names separated by dots, the ones after the first
+   may be numbers, and may end with a matrix index if they are not. */
+static int mdl_identifier (const std::string & word) {
+  const char * s = word.c_str ();
+  int numbers = 0;
+  if (!isalpha ((unsigned char) *s)) return 0;
+  for (;;) {
+    if (isalpha ((unsigned char) *s)) {
+      while (isalnum ((unsigned char) *s) || *s == '_') s++;
+    }
+    else if (isdigit ((unsigned char) *s)) {
+      while (isdigit ((unsigned char) *s)) s++;
+      numbers++;
+    }
+    else return 0;
+    if (*s != '.') break;
+    s++;
+  }
+  if (*s == '[' && !numbers) {
+    s++;
+    if (!isdigit ((unsigned char) *s)) return 0;
+    while (isdigit ((unsigned char) *s)) s++;
+    if (*s++ != ',' || !isdigit ((unsigned char) *s)) return 0;
+    while (isdigit ((unsigned char) *s)) s++;
+    if (*s++ != ']') return 0;
+  }
+  return *s == '\0';
+}
+
+// Characters which may follow numbers and words.
+#define MDL_DELIMITERS " \t\r{}\""
+
+// Moves on to the next token, line ends are spaces.
+static void mdl_next (mdl_reader_t & r) {
+  tokenizer & t = *r.t;
+
+  // skipped blocks end with the line starting with '}'
+  if (r.state == MDL_SKIP) {
+    while (t.next ()) {
+      if (!t.atEnd () && *t.getCursor () == '}') {
+	t.advance (1);
+	r.token = MDL_RBRACE;
+	r.state = MDL_INITIAL;
+	return;
+      }
+    }
+    r.token = MDL_INVALID;
+    return;
+  }
+
+  for (t.skip (" \t\r"); t.atEnd (); t.skip (" \t\r")) {
+    if (!t.next ()) {
+      r.token = MDL_END;
+      return;
+    }
+  }
+  const char * s = t.getCursor ();
+  if (r.state == MDL_PLINK) {
+    r.text = t.take (t.span (""));
+    r.token = mdl_lookup (r.text, mdl_links) < 0 ? MDL_INVALID : MDL_LINKTYPE;
+    r.state = MDL_INITIAL;
+  }
+  else if (*s == '{' && r.state != MDL_INITIAL) {
+    t.advance (1);
+    r.token = MDL_LBRACE;
+    r.state = MDL_SKIP;
+    return;
+  }
+  else if (*s == '"' && r.state != MDL_BLOCK) {
+    // strings may run through several lines
+    t.advance (1);
+    if (!t.find ('"')) {
+      r.token = MDL_INVALID;
+      return;
+    }
+    r.text = std::string (s + 1, t.getCursor ());
+    t.advance (1);
+    r.token = MDL_STRING;
+    return;
+  }
+  else if (r.state != MDL_INITIAL) {
+    r.token = MDL_INVALID;
+    return;
+  }
+  else if (*s == '{' || *s == '}') {
+    t.advance (1);
+    r.token = *s == '{' ? MDL_LBRACE : MDL_RBRACE;
+    return;
+  }
+  else if (t.atBegin () && t.literal ("TABLE \"ICVIEWDATA\"")) {
+    r.token = MDL_KEYWORD;
+    r.keyword = MDL_ICVIEWDATA;
+    r.state = MDL_BLOCK;
+    return;
+  }
+  else if (t.number (r.real, TOKENIZER_LEADING)) {
+    r.token = MDL_REAL;
+  }
+  else if (isalpha ((unsigned char) *s)) {
+    int n = t.span ("_.");
+    if (s + n < t.getEnd () && s[n] == '[') {
+      const char * e = (const char *) memchr (s + n, ']', t.getEnd () - s - n);
+      if (e != NULL) n = e + 1 - s;
+    }
+    r.text = t.take (n);
+    r.keyword = s == t.getBegin () ? mdl_lookup (r.text, mdl_keywords) : -1;
+    if (r.keyword >= 0) {
+      r.token = MDL_KEYWORD;
+      if (r.keyword == MDL_LINK || r.keyword == MDL_MEMBER ||
+	  r.keyword == MDL_LIST)
+	r.state = MDL_PLINK;
+      else if (r.keyword == MDL_BLKEDIT_KEY)
+	r.state = MDL_BLKEDIT;
+      else if (r.keyword == MDL_CIRCUITDECK)
+	r.state = MDL_BLOCK;
+    }
+    else
+      r.token = mdl_identifier (r.text) ? MDL_IDENT : MDL_INVALID;
+  }
+  else {
+    r.token = MDL_INVALID;
+    return;
+  }
+  if (!t.delimited (MDL_DELIMITERS)) r.token = MDL_INVALID;
+}
+
+// Returns non-zero if the current token is the given keyword.
+static int mdl_at (mdl_reader_t & r, int keyword) {
+  return r.token == MDL_KEYWORD && r.keyword == keyword;
+}
+
+/* Returns non-zero if the current token is not the given one, moves
+   on otherwise. */
+static int mdl_expect (mdl_reader_t & r, int token) {
+  if (r.token != token) return -1;
+  mdl_next (r);
+  return 0;
+}
+
+// Reads a token with a text and returns a copy of it.
+static char * mdl_text (mdl_reader_t & r, int token) {
+  if (r.token != token) return NULL;
+  char * text = strdup (r.text.c_str ());
+  mdl_next (r);
+  return text;
+}
+
+// Reads a number.  Returns non-zero if there is none.
+static int mdl_real (mdl_reader_t & r, nr_double_t & val) {
+  val = r.real;
+  return mdl_expect (r, MDL_REAL);
+}
+
+/* Reads the current keyword and its arguments the contents of which
+   are not needed.  The arguments are given by the letters 'S'tring,
+   'R'eal, 'I'dentifier and 'L'ink type, a lower case letter denotes
+   an optional one.  Returns non-zero if they are invalid. */
+static int mdl_line (mdl_reader_t & r, const char * args) {
+  mdl_next (r);
+  for (; *args; args++) {
+    int token;
+    switch (toupper ((unsigned char) *args)) {
+    case 'S': token = MDL_STRING; break;
+    case 'R': token = MDL_REAL; break;
+    case 'I': token = MDL_IDENT; break;
+    default:  token = MDL_LINKTYPE; break;
+    }
+    if (islower ((unsigned char) *args) && r.token != token) continue;
+    if (mdl_expect (r, token)) return -1;
+  }
+  return 0;
+}
+
+/* Reads the element line into the given element.  Returns non-zero if
+   it is invalid. */
+static int mdl_element (mdl_reader_t & r, struct mdl_element_t * e) {
+  nr_double_t number;
+  mdl_next (r);
+  if (r.token == MDL_REAL) {
+    mdl_real (r, number);
+    e->number = (int) number;
+    if (!(e->name = mdl_text (r, MDL_STRING)) ||
+	!(e->value = mdl_text (r, MDL_STRING)))
+      return -1;
+    if (r.token == MDL_STRING) e->attr = mdl_text (r, MDL_STRING);
+    return 0;
+  }
+  return (e->name = mdl_text (r, MDL_STRING)) &&
+    (e->value = mdl_text (r, MDL_STRING)) ? 0 : -1;
+}
+
+/* Reads the point lines at the current token into the given list.
+   Returns non-zero if they are invalid. */
+static int mdl_points (mdl_reader_t & r, struct mdl_point_t ** pn) {
+  nr_double_t n, x, y;
+  while (mdl_at (r, MDL_POINT)) {
+    struct mdl_point_t * p =
+      (struct mdl_point_t *) calloc (sizeof (struct mdl_point_t), 1);
+    *pn = p;
+    pn = &p->next;
+    mdl_next (r);
+    if (mdl_real (r, n) || mdl_real (r, x) || mdl_real (r, y) ||
+	mdl_real (r, p->r) || mdl_real (r, p->i))
+      return -1;
+    p->n = (int) n;
+    p->x = (int) x;
+    p->y = (int) y;
+  }
+  return 0;
+}
+
+// Destroys the given point list.
+static void mdl_free_points (struct mdl_point_t * p) {
+  for (struct mdl_point_t * next; p != NULL; p = next) {
+    next = p->next;
+    free (p);
+  }
+}
+
+/* Reads the table definition into the given table.  Its view lines
+   and the tables inside are left out.  Returns non-zero if it is
+   invalid. */
+static int mdl_table (mdl_reader_t & r, struct mdl_table_t * tab) {
+  struct mdl_element_t ** en = &tab->data;
+  nr_double_t val;
+  int inner = mdl_at (r, MDL_ICVIEWDATA);
+  mdl_next (r);
+  if (inner || r.token == MDL_LBRACE)
+    return mdl_expect (r, MDL_LBRACE) || mdl_expect (r, MDL_RBRACE);
+  if (!(tab->name = mdl_text (r, MDL_STRING))) return -1;
+  if (r.token == MDL_REAL) mdl_real (r, val);
+  if (mdl_expect (r, MDL_LBRACE)) return -1;
+  while (r.token == MDL_KEYWORD) {
+    if (r.keyword == MDL_VIEW) {
+      if (mdl_line (r, "IRS")) return -1;
+    }
+    else if (r.keyword == MDL_ELEMENT) {
+      struct mdl_element_t * e =
+	(struct mdl_element_t *) calloc (sizeof (struct mdl_element_t), 1);
+      *en = e;
+      en = &e->next;
+      if (mdl_element (r, e)) return -1;
+    }
+    else if (r.keyword == MDL_TABLE || r.keyword == MDL_ICVIEWDATA) {
+      struct mdl_table_t * t =
+	(struct mdl_table_t *) calloc (sizeof (struct mdl_table_t), 1);
+      int error = mdl_table (r, t);
+      mdl_free_table (t);
+      if (error) return -1;
+    }
+    else break;
+  }
+  return mdl_expect (r, MDL_RBRACE);
+}
+
+/* Reads the hypertable definition into the given hypertable.  Returns
+   non-zero if it is invalid. */
+static int mdl_hyptable (mdl_reader_t & r, struct mdl_hyptable_t * h) {
+  struct mdl_element_t ** en = &h->data;
+  mdl_next (r);
+  if (!(h->name = mdl_text (r, MDL_STRING)) || mdl_expect (r, MDL_LBRACE))
+    return -1;
+  while (r.token == MDL_KEYWORD) {
+    if (r.keyword == MDL_VIEW) {
+      if (mdl_line (r, "IRS")) return -1;
+    }
+    else if (r.keyword == MDL_ELEMENT) {
+      struct mdl_element_t * e =
+	(struct mdl_element_t *) calloc (sizeof (struct mdl_element_t), 1);
+      *en = e;
+      en = &e->next;
+      if (mdl_element (r, e)) return -1;
+    }
+    else break;
+  }
+  return mdl_expect (r, MDL_RBRACE);
+}
+
+/* Reads the dataset definition into the given dataset.  Returns
+   non-zero if it is invalid. */
+static int mdl_dataset (mdl_reader_t & r, struct mdl_dataset_t * d) {
+  nr_double_t size, x, y;
+  mdl_next (r);
+  if (mdl_expect (r, MDL_LBRACE) || !mdl_at (r, MDL_DATASIZE)) return -1;
+  d->dsize = (struct mdl_datasize_t *)
+    calloc (sizeof (struct mdl_datasize_t), 1);
+  mdl_next (r);
+  if (!(d->dsize->type = mdl_text (r, MDL_IDENT)) || mdl_real (r, size) ||
+      mdl_real (r, x) || mdl_real (r, y))
+    return -1;
+  d->dsize->size = (int) size;
+  d->dsize->x = (int) x;
+  d->dsize->y = (int) y;
+  if (!mdl_at (r, MDL_TYPE)) return -1;
+  mdl_next (r);
+  if (!(d->type1 = mdl_text (r, MDL_IDENT)) || mdl_points (r, &d->data1))
+    return -1;
+  if (mdl_at (r, MDL_TYPE)) {
+    mdl_next (r);
+    if (!(d->type2 = mdl_text (r, MDL_IDENT)) || mdl_points (r, &d->data2))
+      return -1;
+  }
+  return mdl_expect (r, MDL_RBRACE);
+}
+
+/* Reads the contents of the calibration set definition, which are not
+   needed.  Returns non-zero if they are invalid. */
+static int mdl_calset (mdl_reader_t & r) {
+  nr_double_t val;
+  if (mdl_line (r, "S") || mdl_expect (r, MDL_LBRACE)) return -1;
+  for (int i = 0; i < 3; i++)
+    if (mdl_expect (r, MDL_IDENT) || mdl_real (r, val)) return -1;
+  if (!mdl_at (r, MDL_CALDATA)) return -1;
+  mdl_next (r);
+  if (mdl_expect (r, MDL_LBRACE)) return -1;
+  while (mdl_at (r, MDL_TERM)) {
+    struct mdl_point_t * points = NULL;
+    int error = mdl_line (r, "R") || mdl_points (r, &points);
+    mdl_free_points (points);
+    if (error) return -1;
+  }
+  return mdl_expect (r, MDL_RBRACE) || mdl_expect (r, MDL_RBRACE);
+}
+
+/* Reads a block with the given lines, each of them given by its
+   keyword and arguments, which are not needed.  The tables inside are
+   left out as well if allowed.  Returns non-zero if it is invalid. */
+static int mdl_block (mdl_reader_t & r, const char * args, int n,
+		      const int * keys, const char ** lines, int tables) {
+  if (mdl_line (r, args) || mdl_expect (r, MDL_LBRACE)) return -1;
+  while (r.token == MDL_KEYWORD) {
+    int i;
+    for (i = 0; i < n && keys[i] != r.keyword; i++) ;
+    if (i < n) {
+      if (mdl_line (r, lines[i])) return -1;
+    }
+    else if (tables && (r.keyword == MDL_TABLE ||
+			r.keyword == MDL_ICVIEWDATA)) {
+      struct mdl_table_t * t =
+	(struct mdl_table_t *) calloc (sizeof (struct mdl_table_t), 1);
+      int error = mdl_table (r, t);
+      mdl_free_table (t);
+      if (error) return -1;
+    }
+    else break;
+  }
+  return mdl_expect (r, MDL_RBRACE);
+}
+
+// Lines of the parameter sweep tables.
+static const int mdl_ps_keys[] = { MDL_PARAM, MDL_RANGE, MDL_OPTRANGE };
+static const char * mdl_ps_lines[] = { "IS", "ISS", "ISS" };
+
+// Lines of the connection tables.
+static const int mdl_cn_keys[] = { MDL_CONNPAIR };
+static const char * mdl_cn_lines[] = { "SS" };
+
+// Lines of the optimizer editors.
+static const int mdl_opt_keys[] = { MDL_VIEW };
+static const char * mdl_opt_lines[] = { "IRS" };
+
+// Lines of the data definitions the contents of which are not needed.
+static const int mdl_data_keys[] = {
+  MDL_PLOTOPTIMIZEROPT, MDL_PLOTOPTIMIZERTRACESET,
+  MDL_PLOTOPTIMIZERTRACEREGSET, MDL_PLOTOPTIMIZERTRACENATREGSET,
+  MDL_PLOTERROR, MDL_EDITSIZE, MDL_PLOTSIZE
+};
+static const char * mdl_data_lines[] = {
+  "IR", "SSs", "SRSSSS", "SRSSSS", "IR", "RR", "RR"
+};
+
+/* Reads the data definition into the given data.  Returns non-zero if
+   it is invalid. */
+static int mdl_data (mdl_reader_t & r, struct mdl_data_t * d) {
+  struct mdl_dcontent_t ** cn = &d->content;
+  int error;
+  mdl_next (r);
+  if (mdl_expect (r, MDL_LBRACE)) return -1;
+  while (r.token == MDL_KEYWORD) {
+    int i, n = sizeof (mdl_data_keys) / sizeof (mdl_data_keys[0]);
+    for (i = 0; i < n && mdl_data_keys[i] != r.keyword; i++) ;
+    if (i < n) {
+      error = mdl_line (r, mdl_data_lines[i]);
+    }
+    else if (r.keyword == MDL_HYPTABLE || r.keyword == MDL_DATASET) {
+      struct mdl_dcontent_t * c = (struct mdl_dcontent_t *)
+	calloc (sizeof (struct mdl_dcontent_t), 1);
+      *cn = c;
+      cn = &c->next;
+      if (r.keyword == MDL_HYPTABLE) {
+	c->type = t_HYPTABLE;
+	c->hyptable = (struct mdl_hyptable_t *)
+	  calloc (sizeof (struct mdl_hyptable_t), 1);
+	error = mdl_hyptable (r, c->hyptable);
+      }
+      else {
+	c->type = t_DATASET;
+	c->data = (struct mdl_dataset_t *)
+	  calloc (sizeof (struct mdl_dataset_t), 1);
+	error = mdl_dataset (r, c->data);
+      }
+    }
+    else if (r.keyword == MDL_TABLE || r.keyword == MDL_ICVIEWDATA) {
+      struct mdl_table_t * t =
+	(struct mdl_table_t *) calloc (sizeof (struct mdl_table_t), 1);
+      error = mdl_table (r, t);
+      mdl_free_table (t);
+    }
+    else if (r.keyword == MDL_PSTABLE) {
+      error = mdl_block (r, "S", 3, mdl_ps_keys, mdl_ps_lines, 0);
+    }
+    else if (r.keyword == MDL_CNTABLE) {
+      error = mdl_block (r, "S", 1, mdl_cn_keys, mdl_cn_lines, 0);
+    }
+    else if (r.keyword == MDL_OPTIMEDIT) {
+      error = mdl_block (r, "", 1, mdl_opt_keys, mdl_opt_lines, 1);
+    }
+    else if (r.keyword == MDL_CALSET) {
+      error = mdl_calset (r);
+    }
+    else if (r.keyword == MDL_BLKEDIT_KEY) {
+      error = mdl_block (r, "S", 0, NULL, NULL, 0);
+    }
+    else if (r.keyword == MDL_CIRCUITDECK) {
+      error = mdl_block (r, "", 0, NULL, NULL, 0);
+    }
+    else break;
+    if (error) return -1;
+  }
+  return mdl_expect (r, MDL_RBRACE);
+}
+
+/* Reads the link definition into the given link.  Returns non-zero if
+   it is invalid. */
+static int mdl_link (mdl_reader_t & r, struct mdl_link_t * l) {
+  struct mdl_lcontent_t ** cn = &l->content;
+  int error;
+  mdl_next (r);
+  if (!(l->type = mdl_text (r, MDL_LINKTYPE)) ||
+      !(l->name = mdl_text (r, MDL_STRING)) || mdl_expect (r, MDL_LBRACE))
+    return -1;
+  while (r.token == MDL_KEYWORD) {
+    switch (r.keyword) {
+    case MDL_VIEW:    error = mdl_line (r, "IRS"); break;
+    case MDL_APPLIC:  error = mdl_line (r, "SRRR"); break;
+    case MDL_SUBAPP:  error = mdl_line (r, "SR"); break;
+    case MDL_LIST:
+    case MDL_MEMBER:  error = mdl_line (r, "LS"); break;
+    case MDL_TABLE:
+    case MDL_ICVIEWDATA:
+    case MDL_LINK:
+    case MDL_DATA: {
+      struct mdl_lcontent_t * c = (struct mdl_lcontent_t *)
+	calloc (sizeof (struct mdl_lcontent_t), 1);
+      *cn = c;
+      cn = &c->next;
+      if (r.keyword == MDL_LINK) {
+	c->type = t_LINK;
+	c->link = (struct mdl_link_t *) calloc (sizeof (struct mdl_link_t), 1);
+	error = mdl_link (r, c->link);
+      }
+      else if (r.keyword == MDL_DATA) {
+	c->type = t_DATA;
+	c->data = (struct mdl_data_t *) calloc (sizeof (struct mdl_data_t), 1);
+	error = mdl_data (r, c->data);
+      }
+      else {
+	c->type = t_TABLE;
+	c->table = (struct mdl_table_t *)
+	  calloc (sizeof (struct mdl_table_t), 1);
+	error = mdl_table (r, c->table);
+      }
+      break;
+    }
+    default:
+      return mdl_expect (r, MDL_RBRACE);
+    }
+    if (error) return -1;
+  }
+  return mdl_expect (r, MDL_RBRACE);
+}
+
+// Reads the given MDL file contents into the links.
+static int mdl_fast (const char * data, long size) {
+  tokenizer t (data, size);
+  struct mdl_link_t ** ln = &mdl_root;
+  mdl_reader_t r;
+  r.t = &t;
+  r.state = MDL_INITIAL;
+  mdl_next (r);
+  while (mdl_at (r, MDL_LINK)) {
+    struct mdl_link_t * l =
+      (struct mdl_link_t *) calloc (sizeof (struct mdl_link_t), 1);
+    *ln = l;
+    ln = &l->next;
+    if (mdl_link (r, l)) return 1;
+  }
+  return r.token == MDL_END ? 0 : 1;
+}
+
+/* The function reads the given contents of a MDL file without the
+   scanner and parser and checks them.  It returns zero on success and
+   -1 on errors, the result is the mdl_result dataset.  It returns 1 if
+   the file should be read by the parser and checked instead. */
+int mdl_read (const char * data, long size) {
+  mdl_result = NULL;
+  mdl_root = NULL;
+  if (mdl_fast (data, size)) {
+    struct mdl_link_t * root, * next;
+    for (root = mdl_root; root; root = next) {
+      next = root->next;
+      mdl_free_link (root);
+    }
+    mdl_root = NULL;
+    return 1;
+  }
+  return mdl_check ();
+}
+
 // Initializes the MDL checker.
 void mdl_init (void) {
   mdl_root = NULL;
@@ -32,6 +32,10 @@
 #include <cmath>
 #include <assert.h>
 #include <float.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "logging.h"
 #include "strlist.h"
@@ -50,6 +54,94 @@ using namespace qucs::eqn;
 struct definition_t * definition_root = NULL;
 struct definition_t * subcircuit_root = NULL;
 environment * env_root = NULL;
+int netlist_templates = 0;
+
+/* Hashed lookups into the list of definitions being checked.  They are
+   built by checker_build_index() for each list. */
+static struct
+{
+    // number of definitions by type and instance name
+    std::unordered_map<std::string, int> definitions;
+    // first identifier value by type, property key and identifier
+    std::unordered_map<std::string, struct value_t *> references;
+}
+checker_index;
+
+// Subcircuit types by name.
+static std::unordered_map<std::string, struct definition_t *>
+checker_subcircuits;
+
+// Shared environments of the subcircuit instances by instance key.
+static std::unordered_map<std::string, environment *> checker_templates;
+
+/* Node names and definition types are interned.  Each distinct string
+   is stored once in large chunks which are kept until the netlist is
+   destroyed. */
+#define NETLIST_CHUNK 65536
+
+struct netlist_string_hash
+{
+    size_t operator() (const char * s) const
+    {
+        size_t h = 2166136261u;
+        for (; *s; s++) h = (h ^ (unsigned char) *s) * 16777619u;
+        return h;
+    }
+};
+
+struct netlist_string_equal
+{
+    bool operator() (const char * a, const char * b) const
+    {
+        return !strcmp (a, b);
+    }
+};
+
+static std::unordered_set<const char *, netlist_string_hash,
+       netlist_string_equal> netlist_strings;
+static std::vector<char *> netlist_chunks;
+static char * netlist_chunk_pos = NULL;
+static size_t netlist_chunk_left = 0;
+
+/* Returns the key of the hashed lookups for the given strings. */
+static std::string checker_key (const char * a, const char * b,
+                                const char * c = NULL)
+{
+    std::string key (a);
+    key += ':';
+    key += b;
+    if (c != NULL)
+    {
+        key += ':';
+        key += c;
+    }
+    return key;
+}
+
+/* The function builds the hashed lookups for the given list of
+   definitions.  Repeated definitions of the same type and instance
+   name are marked as duplicates. */
+static void checker_build_index (struct definition_t * root)
+{
+    checker_index.definitions.clear ();
+    checker_index.references.clear ();
+    for (struct definition_t * def = root; def != NULL; def = def->next)
+    {
+        if (++checker_index.definitions[checker_key (def->type,
+                                        def->instance)] > 1)
+            def->duplicate = 1;
+        for (struct pair_t * pair = def->pairs; pair != NULL; pair = pair->next)
+        {
+            if (pair->value != NULL && pair->value->ident != NULL)
+            {
+                std::string key =
+                    checker_key (def->type, pair->key, pair->value->ident);
+                checker_index.references.insert (std::make_pair (key,
+                                                 pair->value));
+            }
+        }
+    }
+}
 
 /* The function counts the nodes in a definition line. */
 static int checker_count_nodes (struct definition_t * def)
@@ -104,45 +196,23 @@ static int checker_is_property (struct define_t * available,
 }
 
 /* Counts the number of definitions given by the specified type and
-   instance name in the definition list. */
-static int checker_count_definition (struct definition_t * root,
-                                     const char * type, char * instance)
+   instance name in the definition list being checked. */
+static int checker_count_definition (const char * type, char * instance)
 {
-    int count = 0;
-    for (struct definition_t * def = root; def != NULL; def = def->next)
-    {
-        if (!strcmp (def->type, type) && !strcmp (def->instance, instance))
-        {
-            if (++count > 1)
-                def->duplicate = 1;
-        }
-    }
-    return count;
+    auto it = checker_index.definitions.find (checker_key (type, instance));
+    return it != checker_index.definitions.end () ? it->second : 0;
 }
 
 /* Returns the value for a given definition type, key and variable
-   identifier if it is in the list of definitions.  Otherwise the
-   function returns NULL. */
-static struct value_t * checker_find_variable (struct definition_t * root,
-        const char * type,
+   identifier if it is in the list of definitions being checked.
+   Otherwise the function returns NULL. */
+static struct value_t * checker_find_variable (const char * type,
         const char * key,
         char * ident)
 {
-    struct pair_t * pair;
-    for (struct definition_t * def = root; def != NULL; def = def->next)
-    {
-        if (!strcmp (def->type, type))
-        {
-            for (pair = def->pairs; pair != NULL; pair = pair->next)
-            {
-                if (!strcmp (pair->key, key))
-                    if (pair->value->ident != NULL && ident != NULL &&
-                            strcmp (pair->value->ident, ident) == 0)
-                        return pair->value;
-            }
-        }
-    }
-    return NULL;
+    if (ident == NULL) return NULL;
+    auto it = checker_index.references.find (checker_key (type, key, ident));
+    return it != checker_index.references.end () ? it->second : NULL;
 }
 
 /* The function returns the appropriate value for a given key within
@@ -253,7 +323,7 @@ static int checker_resolve_variable (struct definition_t * root,
     {
         int found = 0;
         /* 1. find variable in parameter sweeps */
-        if ((val = checker_find_variable (root, "SW", "Param", value->ident)))
+        if ((val = checker_find_variable ("SW", "Param", value->ident)))
         {
             /* add parameter sweep variable to environment */
             if (!strcmp (def->type, "SW") && !strcmp (pair->key, "Param"))
@@ -266,11 +336,62 @@ static int checker_resolve_variable (struct definition_t * root,
             value->var = TAG_DOUBLE;
             found++;
         }
-        /* 2. find analysis in parameter sweeps */
-        if ((val = checker_find_variable (root, "SW", "Sim", value->ident)))
+        /* 1a. find variable in optimizations */
+        if ((val = checker_find_variable ("OptVar", "Var", value->ident)))
         {
+            /* add optimization variable to environment */
+            if (!strcmp (def->type, "OptVar") && !strcmp (pair->key, "Var"))
+            {
+                checker_add_variable (root->env, value->ident, TAG_DOUBLE, true);
+            }
+            val->var = TAG_DOUBLE;
+            value->var = TAG_DOUBLE;
             found++;
         }
+        /* 1b. find variable in Monte-Carlo analyses, names containing a
+           dot refer to circuit properties */
+        if (strchr (value->ident, '.') == NULL &&
+                (val = checker_find_variable ("MCVar", "Var", value->ident)))
+        {
+            /* add statistical variable to environment */
+            if (!strcmp (def->type, "MCVar") && !strcmp (pair->key, "Var"))
+            {
+                checker_add_variable (root->env, value->ident, TAG_DOUBLE, true);
+            }
+            val->var = TAG_DOUBLE;
+            value->var = TAG_DOUBLE;
+            found++;
+        }
+        /* 2. find analysis in parameter sweeps, optimizations and
+           Monte-Carlo analyses */
+        if ((val = checker_find_variable ("SW", "Sim", value->ident)))
+        {
+            found++;
+        }
+        if ((val = checker_find_variable ("Opt", "Sim", value->ident)))
+        {
+            found++;
+        }
+        if ((val = checker_find_variable ("MC", "Sim", value->ident)))
+        {
+            found++;
+        }
+        /* 2a. optimization references and goals, the goals are taken
+           from the results and validated by the optimizer */
+        if (!strcmp (def->type, "OptVar") || !strcmp (def->type, "OptGoal"))
+        {
+            if (!strcmp (pair->key, "Opt") ||
+                    (!strcmp (def->type, "OptGoal") && !strcmp (pair->key, "Var")))
+                found++;
+        }
+        /* 2b. Monte-Carlo references and circuit properties, the latter
+           are validated by the Monte-Carlo analysis */
+        if (!strcmp (def->type, "MCVar"))
+        {
+            if (!strcmp (pair->key, "MC") || (!strcmp (pair->key, "Var") &&
+                                              strchr (value->ident, '.') != NULL))
+                found++;
+        }
         /* 3. find substrate in microstrip components */
         if ((val = checker_find_substrate (def, value->ident)))
         {
@@ -278,7 +399,7 @@ static int checker_resolve_variable (struct definition_t * root,
             found++;
         }
         /* 4. find subcircuit definition in subcircuit components */
-        if ((val = checker_find_variable (root, "Sub", "Type", value->ident)))
+        if ((val = checker_find_variable ("Sub", "Type", value->ident)))
         {
             found++;
         }
@@ -288,12 +409,12 @@ static int checker_resolve_variable (struct definition_t * root,
             found++;
         }
         /* 6. find file reference in S-parameter file components */
-        if ((val = checker_find_variable (root, "SPfile", "File", value->ident)))
+        if ((val = checker_find_variable ("SPfile", "File", value->ident)))
         {
             found++;
         }
         /* 6a. find file reference in S-parameter de-embedding file components */
-        if ((val = checker_find_variable (root, "SPDfile", "File", value->ident)))
+        if ((val = checker_find_variable ("SPDfile", "File", value->ident)))
         {
             found++;
         }
@@ -313,11 +434,11 @@ static int checker_resolve_variable (struct definition_t * root,
             }
         }
         /* 8. find file reference in file based sources */
-        if ((val = checker_find_variable (root, "Vfile", "File", value->ident)))
+        if ((val = checker_find_variable ("Vfile", "File", value->ident)))
         {
             found++;
         }
-        if ((val = checker_find_variable (root, "Ifile", "File", value->ident)))
+        if ((val = checker_find_variable ("Ifile", "File", value->ident)))
         {
             found++;
         }
@@ -515,10 +636,9 @@ static int checker_count_definitions (struct definition_t * root,
    no such subcircuit the function returns NULL: */
 static struct definition_t * checker_find_subcircuit (char * n)
 {
-    struct definition_t * def;
-    for (def = subcircuit_root; def != NULL; def = def->next)
-        if (n != NULL && !strcmp (def->instance, n)) return def;
-    return NULL;
+    if (n == NULL) return NULL;
+    auto it = checker_subcircuits.find (n);
+    return it != checker_subcircuits.end () ? it->second : NULL;
 }
 
 /* The function returns the subcircuit definition for the given
@@ -537,8 +657,10 @@ checker_get_subcircuit (struct definition_t * def)
 static int checker_sub_cycles = 0;
 
 /* The following function returns the number of circuit instances
-   requiring a DC analysis (being nonlinear) in the list of definitions. */
-static int checker_count_nonlinearities (struct definition_t * root)
+   requiring a DC analysis (being nonlinear) in the list of definitions.
+   The counts of the subcircuit types are saved in the given map. */
+static int checker_count_nonlinearities (struct definition_t * root,
+        std::unordered_map<struct definition_t *, int> & counted)
 {
     int count = 0;
     struct definition_t * sub;
@@ -552,7 +674,14 @@ static int checker_count_nonlinearities (struct definition_t * root)
             {
                 if ((sub = checker_get_subcircuit (def)) != NULL)
                 {
-                    count += checker_count_nonlinearities (sub->sub);
+                    // count each subcircuit type once
+                    auto it = counted.find (sub);
+                    if (it == counted.end ())
+                    {
+                        int n = checker_count_nonlinearities (sub->sub, counted);
+                        it = counted.insert (std::make_pair (sub, n)).first;
+                    }
+                    count += it->second;
                 }
             }
         }
@@ -595,8 +724,10 @@ static int checker_validate_para_cycles (struct definition_t * root,
                 return ++errors;
             }
             deps->append (instance);
-            /* recurse into parameter sweeps */
-            if (!strcmp (def->type, "SW"))
+            /* recurse into parameter sweeps, optimizations and Monte-Carlo
+               analyses */
+            if (!strcmp (def->type, "SW") || !strcmp (def->type, "Opt") ||
+                    !strcmp (def->type, "MC"))
             {
                 if ((val = checker_find_reference (def, "Sim")) != NULL)
                 {
@@ -617,8 +748,10 @@ static int checker_validate_para (struct definition_t * root)
     struct value_t * val;
     for (struct definition_t * def = root; def != NULL; def = def->next)
     {
-        /* find parameter sweep */
-        if (def->action == 1 && !strcmp (def->type, "SW"))
+        /* find parameter sweep, optimization or Monte-Carlo analysis */
+        if (def->action == 1 && (!strcmp (def->type, "SW") ||
+                                 !strcmp (def->type, "Opt") ||
+                                 !strcmp (def->type, "MC")))
         {
             /* the 'Sim' property must be an identifier */
             if ((val = checker_validate_reference (def, "Sim")) == NULL)
@@ -652,6 +785,45 @@ static int checker_validate_para (struct definition_t * root)
     return errors;
 }
 
+/* This function validates the variables and goals of optimizations
+   and the variables of Monte-Carlo analyses within the list of
+   definitions.  Each of them must refer to an appropriate action.
+   Returns non-zero on errors. */
+static int checker_validate_optimizations (struct definition_t * root)
+{
+    int errors = 0;
+    struct value_t * val;
+    for (struct definition_t * def = root; def != NULL; def = def->next)
+    {
+        if (def->action || (strcmp (def->type, "OptVar") &&
+                            strcmp (def->type, "OptGoal") &&
+                            strcmp (def->type, "MCVar")))
+            continue;
+        const char * type = strcmp (def->type, "MCVar") ? "Opt" : "MC";
+        if ((val = checker_validate_reference (def, type)) == NULL)
+        {
+            errors++;
+            continue;
+        }
+        struct definition_t * opt;
+        for (opt = root; opt != NULL; opt = opt->next)
+        {
+            if (opt->action == 1 && !strcmp (opt->type, type) &&
+                    !strcmp (opt->instance, val->ident))
+                break;
+        }
+        if (opt == NULL)
+        {
+            logprint (LOG_ERROR, "line %d: checker error, no such %s "
+                      "`%s' found as referred in `%s:%s'\n", def->line,
+                      strcmp (type, "MC") ? "optimization" : "Monte-Carlo analysis",
+                      val->ident, def->type, def->instance);
+            errors++;
+        }
+    }
+    return errors;
+}
+
 /* This function returns the next port definition in the given list of
    definitions or NULL if there is no such definition. */
 static struct definition_t * checker_find_port (struct definition_t * root)
@@ -673,15 +845,19 @@ static int checker_validate_ports (struct definition_t * root)
 {
     int p, errors = 0;
     struct value_t * val;
-    struct definition_t * port, * def = root;
+    struct definition_t * def;
     const char * prop = "Num";
-    while ((def = checker_find_port (def)) != NULL)
+    // collect the port definitions once
+    std::vector<struct definition_t *> ports;
+    for (def = root; (def = checker_find_port (def)) != NULL; def = def->next)
+        ports.push_back (def);
+    for (size_t i = 0; i < ports.size (); i++)
     {
+        def = ports[i];
         if ((val = checker_find_prop_value (def, prop)) != NULL)
         {
             p = (int) val->value;
-            port = root;
-            while ((port = checker_find_port (port)) != NULL)
+            for (struct definition_t * port : ports)
             {
                 if (port != def)
                 {
@@ -697,10 +873,8 @@ static int checker_validate_ports (struct definition_t * root)
                         }
                     }
                 }
-                port = port->next;
             }
         }
-        def = def->next;
     }
     return errors;
 }
@@ -867,7 +1041,8 @@ static int checker_validate_actions (struct definition_t * root)
         // count analyses requiring a DC solution
         a += checker_count_definitions (root, "AC", 1);
         // check dc-analysis requirements
-        c = checker_count_nonlinearities (root);
+        std::unordered_map<struct definition_t *, int> counted;
+        c = checker_count_nonlinearities (root, counted);
         n = checker_count_definitions (root, "DC", 1);
         if (n > 1)
         {
@@ -883,6 +1058,7 @@ static int checker_validate_actions (struct definition_t * root)
         }
     }
     errors += checker_validate_para (root);
+    errors += checker_validate_optimizations (root);
     errors += checker_validate_ports (root);
     errors += checker_validate_lists (root);
     return errors;
@@ -909,7 +1085,7 @@ static int checker_validate_strips (struct definition_t * root)
                 }
                 else
                 {
-                    if (checker_count_definition (root, "SUBST", val->ident) != 1)
+                    if (checker_count_definition ("SUBST", val->ident) != 1)
                     {
                         logprint (LOG_ERROR, "line %d: checker error, no such substrate "
                                   "`%s' found as specified in `%s:%s'\n", def->line,
@@ -930,39 +1106,16 @@ static int checker_validate_strips (struct definition_t * root)
     return errors;
 }
 
-/* This function counts the number of occurrences of the given node
-   name in the given netlist definition root. */
-static int checker_count_nodes (struct definition_t * root, char * n)
-{
-    int count = 0;
-    struct node_t * node;
-    for (struct definition_t * def = root; def != NULL; def = def->next)
-    {
-        if (!def->action && !def->nodeset)
-        {
-            for (node = def->nodes; node != NULL; node = node->next)
-                if (!strcmp (node->node, n)) count++;
-        }
-    }
-    return count;
-}
-
 /* The function identifies duplicate nodesets for the same node which
-   is not allowed.  It returns the number of duplications. */
-static int checker_count_nodesets (struct definition_t * root, char * n)
-{
-    int count = 0;
-    for (struct definition_t * def = root; def != NULL; def = def->next)
-    {
-        if (def->nodeset && !def->duplicate && def->nodes)
-        {
-            char * node = def->nodes->node;
-            if (!strcmp (node, n))
-            {
-                if (++count > 1) def->duplicate = 1;
-            }
-        }
-    }
+   is not allowed.  It returns the number of duplications given by the
+   nodesets of the node and marks all but the first as duplicates. */
+static int
+checker_count_nodesets (std::vector<struct definition_t *> & nodesets)
+{
+    int count = nodesets.size ();
+    for (size_t i = 1; i < nodesets.size (); i++)
+        nodesets[i]->duplicate = 1;
+    if (count > 1) nodesets.resize (1);
     return count;
 }
 
@@ -972,19 +1125,35 @@ static int checker_count_nodesets (struct definition_t * root, char * n)
 static int checker_validate_nodesets (struct definition_t * root)
 {
     int errors = 0;
-    for (struct definition_t * def = root; def != NULL; def = def->next)
+    struct definition_t * def;
+    // collect the nodes of the components and the nodesets by node
+    std::unordered_map<std::string, int> nodes;
+    std::unordered_map<std::string, std::vector<struct definition_t *> > sets;
+    for (def = root; def != NULL; def = def->next)
+    {
+        if (!def->action && !def->nodeset)
+        {
+            for (struct node_t * node = def->nodes; node; node = node->next)
+                nodes[node->node]++;
+        }
+        if (def->nodeset && !def->duplicate && def->nodes)
+        {
+            sets[def->nodes->node].push_back (def);
+        }
+    }
+    for (def = root; def != NULL; def = def->next)
     {
         if (def->nodeset && checker_count_nodes (def) == 1)
         {
             char * node = def->nodes->node;
-            if (checker_count_nodes (root, node) <= 0)
+            if (nodes.find (node) == nodes.end ())
             {
                 logprint (LOG_ERROR, "line %d: checker error, no such node `%s' found "
                           "as referenced by `%s:%s'\n", def->line, node, def->type,
                           def->instance);
                 errors++;
             }
-            if (checker_count_nodesets (root, node) > 1)
+            if (checker_count_nodesets (sets[node]) > 1)
             {
                 logprint (LOG_ERROR, "line %d: checker error, the node `%s' is not "
                           "uniquely defined by `%s:%s'\n", def->line, node, def->type,
@@ -1059,6 +1228,19 @@ static int netlist_checker_variables_intern (struct definition_t * root,
                 refs->add (ref->ident);
             }
         }
+        // find optimization and statistical variables
+        else if (!def->action && (!strcmp (def->type, "OptVar") ||
+                                  !strcmp (def->type, "MCVar")))
+        {
+            para = checker_find_reference (def, "Var");
+            if (para != NULL && eqnvars && eqnvars->contains (para->ident))
+            {
+                logprint (LOG_ERROR, "checker error, equation variable `%s' "
+                          "already defined by `%s:%s'\n", para->ident,
+                          def->type, def->instance);
+                errors++;
+            }
+        }
     }
     delete eqnvars;
     delete refs;
@@ -1253,6 +1435,7 @@ checker_build_subcircuits (struct definition_t * root)
             def->sub = checker_build_subcircuits (def->sub);
             def->next = subcircuit_root;
             subcircuit_root = def;
+            checker_subcircuits[def->instance] = def;
         }
         else prev = def;
     }
@@ -1274,7 +1457,7 @@ checker_copy_subcircuit (struct definition_t * sub)
     copy->define = sub->define;
     copy->pairs = sub->pairs;
     copy->ncount = sub->ncount;
-    copy->type = strdup (sub->type);
+    copy->type = sub->type;
     copy->copy = 1;
     return copy;
 }
@@ -1300,7 +1483,7 @@ static void checker_xlat_subcircuit_nodes (struct definition_t * type,
             with the 'type', then assign the 'inst's node name */
             if (!strcmp (n->node, ntype->node))
             {
-                n->xlate = strdup (ninst->node);
+                n->xlate = ninst->node;
                 n->xlatenr = i;
             }
         }
@@ -1309,18 +1492,14 @@ static void checker_xlat_subcircuit_nodes (struct definition_t * type,
 
 /* The function creates a subcircuit node name consisting of the given
    arguments.  If the given 'instances' is NULL it is left out.  The
-   caller is responsible to free() the returned string. */
+   returned string is interned. */
 static char * checker_subcircuit_node (char * type, char * instances,
                                        char * instance, char * node)
 {
-    char * txt = (char *)
-                 calloc (1, strlen (type) + strlen (instance) + strlen (node) +
-                         (instances ? strlen (instances) : 0) + 4);
-    if (instances)
-        sprintf (txt, "%s.%s.%s.%s", type, instances, instance, node);
-    else
-        sprintf (txt, "%s.%s.%s", type, instance, node);
-    return txt;
+    std::string txt (type);
+    if (instances) txt.append (".").append (instances);
+    txt.append (".").append (instance).append (".").append (node);
+    return netlist_intern (txt.c_str ());
 }
 
 /* The function reverses the order of the given node list and returns
@@ -1337,6 +1516,65 @@ struct node_t * netlist_reverse_nodes (struct node_t * nodes)
     return root;
 }
 
+/* The function reverses the order of the given definition list and
+   returns the reversed list. */
+struct definition_t *
+netlist_reverse_definitions (struct definition_t * defs)
+{
+    struct definition_t * root, * next;
+    for (root = NULL; defs != NULL; defs = next)
+    {
+        next = defs->next;
+        defs->next = root;
+        root = defs;
+    }
+    return root;
+}
+
+/* Returns the interned copy of the given string.  It is valid until
+   netlist_destroy() and must not be free()'d. */
+char * netlist_intern (const char * str)
+{
+    auto it = netlist_strings.find (str);
+    if (it != netlist_strings.end ()) return (char *) *it;
+
+    size_t len = strlen (str) + 1;
+    char * txt;
+    if (len > NETLIST_CHUNK / 16)
+    {
+        // long strings get a chunk of their own
+        txt = (char *) malloc (len);
+        netlist_chunks.push_back (txt);
+    }
+    else
+    {
+        if (len > netlist_chunk_left)
+        {
+            netlist_chunk_pos = (char *) malloc (NETLIST_CHUNK);
+            netlist_chunk_left = NETLIST_CHUNK;
+            netlist_chunks.push_back (netlist_chunk_pos);
+        }
+        txt = netlist_chunk_pos;
+        netlist_chunk_pos += len;
+        netlist_chunk_left -= len;
+    }
+    memcpy (txt, str, len);
+    netlist_strings.insert (txt);
+    return txt;
+}
+
+// Releases all interned strings.
+static void netlist_release_strings (void)
+{
+    for (char * chunk : netlist_chunks) free (chunk);
+    netlist_chunks.clear ();
+    netlist_chunks.shrink_to_fit ();
+    std::unordered_set<const char *, netlist_string_hash,
+        netlist_string_equal> ().swap (netlist_strings);
+    netlist_chunk_pos = NULL;
+    netlist_chunk_left = 0;
+}
+
 /* This function assigns new node names to the subcircuit element
    'copy' based upon the previous node translation between the
    subcircuit 'type' and the instance 'inst' of this type.  The global
@@ -1360,17 +1598,17 @@ checker_copy_subcircuit_nodes (struct definition_t * type,
         if (n->xlate)   // translated node
         {
             if (instances == NULL)
-                ncopy->node = strdup (n->xlate);
+                ncopy->node = n->xlate;
             else
                 ncopy->node = NULL; // leave it blank yet, indicates translation
         }
         else if (!strcmp (n->node, "gnd"))   // ground node
         {
-            ncopy->node = strdup (n->node);
+            ncopy->node = n->node;
         }
         else if (n->node[strlen (n->node) - 1] == '!')   // global node
         {
-            ncopy->node = strdup (n->node);
+            ncopy->node = n->node;
         }
         else   // internal subcircuit element node
         {
@@ -1403,7 +1641,6 @@ static void checker_cleanup_xlat_nodes (struct definition_t * sub)
 {
     for (struct node_t * n = sub->nodes; n != NULL; n = n->next)
     {
-        free (n->xlate);
         n->xlate = NULL;
         n->xlatenr = 0;
     }
@@ -1439,17 +1676,17 @@ checker_copy_circuit_nodes (struct definition_t * type,
             {
                 if (instances == NULL)
                     // external node indicated by no instances given
-                    ncopy->node = strdup (n->xlate);
+                    ncopy->node = n->xlate;
                 else
                     ncopy->node = NULL; // keep blank
             }
             else if (!strcmp (n->node, "gnd"))   // global ground node
             {
-                ncopy->node = strdup (n->node);
+                ncopy->node = n->node;
             }
             else if (n->node[strlen (n->node) - 1] == '!')   // other global node
             {
-                ncopy->node = strdup (n->node);
+                ncopy->node = n->node;
             }
             else   // internal subcircuit element node
             {
@@ -1495,6 +1732,37 @@ static char * checker_subcircuit_instance (char * type, char * instances,
     return txt;
 }
 
+/* Returns the key of the environment of the given instance of the
+   subcircuit 'type' within the given parent environment.  Instances
+   with the same key are passed the same parameters. */
+static std::string checker_template_key (struct definition_t * type,
+        struct definition_t * inst,
+        environment * parent)
+{
+    char txt[64];
+    sprintf (txt, "%p", (void *) parent);
+    std::string key = checker_key (txt, type->instance);
+    for (struct pair_t * pair = inst->pairs; pair != NULL; pair = pair->next)
+    {
+        if (strcmp (pair->key, "Type"))
+        {
+            key += ':';
+            key += pair->key;
+            if (pair->value->ident == NULL)
+            {
+                sprintf (txt, "=%.17g", pair->value->value);
+                key += txt;
+            }
+            else
+            {
+                key += '@';
+                key += pair->value->ident;
+            }
+        }
+    }
+    return key;
+}
+
 /* This function produces a copy of the given subcircuit 'type'
    containing the subcircuit elements.  Based upon the instance 'inst'
    definitions (node names and instance name) it assign new element
@@ -1510,12 +1778,28 @@ checker_copy_subcircuits (struct definition_t * type,
     strlist * instcopy;
     char * list;
 
+    // with templates share the environment of an identical instance
+    environment * child = NULL;
+    std::string key;
+    if (netlist_templates)
+    {
+        key = checker_template_key (type, inst, parent);
+        auto it = checker_templates.find (key);
+        if (it != checker_templates.end ()) child = it->second;
+    }
+    bool shared = child != NULL;
+
     // create environment for subcircuit instance
-    environment * child = new environment (*(type->env));
-    parent->push_front_Child (child);
+    if (!shared)
+    {
+        child = new environment (*(type->env));
+        parent->push_front_Child (child);
+        if (netlist_templates) checker_templates[key] = child;
+    }
 
     // put instance properties into subcircuit environment
-    for (struct pair_t * pair = inst->pairs; pair != NULL; pair = pair->next)
+    for (struct pair_t * pair = inst->pairs; !shared && pair != NULL;
+            pair = pair->next)
     {
         // anything else than the 'Type'
         if (strcmp (pair->key, "Type"))
@@ -1594,12 +1878,15 @@ checker_copy_subcircuits (struct definition_t * type,
     }
 
     // try giving child environment a unique name
-    strlist * icopy = new strlist ();
-    icopy->append (type->instance);
-    icopy->append (*(instances));
-    icopy->append (inst->instance);
-    child->setName (std::string(icopy->toString (".")));
-    delete icopy;
+    if (!shared)
+    {
+        strlist * icopy = new strlist ();
+        icopy->append (type->instance);
+        icopy->append (*(instances));
+        icopy->append (inst->instance);
+        child->setName (std::string(icopy->toString (".")));
+        delete icopy;
+    }
 
     return root;
 }
@@ -1838,6 +2125,9 @@ static int checker_validate_properties (struct definition_t * root,
 static int checker_validate_subcircuits (struct definition_t * root)
 {
     int errors = 0;
+    // property definitions and acyclic state of the subcircuit types
+    std::unordered_map<struct definition_t *, struct define_t *> defines;
+    std::unordered_map<struct definition_t *, int> acyclic;
     // go through list of definitions
     for (struct definition_t * def = root; def != NULL; def = def->next)
     {
@@ -1875,20 +2165,28 @@ static int checker_validate_subcircuits (struct definition_t * root)
                         errors++;
                     }
                     // check the subcircuit instance properties
-                    struct define_t * available = netlist_create_define (sub);
+                    struct define_t * & available = defines[sub];
+                    if (available == NULL)
+                        available = netlist_create_define (sub);
                     errors += checker_validate_properties (root, def, available);
-                    netlist_free_define (available);
                     // and finally check for cyclic definitions
-                    strlist * deps = new strlist ();
-                    int err = checker_validate_sub_cycles (sub, sub->instance,
+                    int err = 0;
+                    if (!acyclic[sub])
+                    {
+                        strlist * deps = new strlist ();
+                        err = checker_validate_sub_cycles (sub, sub->instance,
                                                            def->instance, &deps);
+                        acyclic[sub] = !err;
+                        delete deps;
+                    }
                     errors += err;
                     checker_sub_cycles = err;
-                    delete deps;
                 }
             }
         }
     }
+    for (auto & it : defines)
+        netlist_free_define (it.second);
     return errors;
 }
 
@@ -1899,7 +2197,6 @@ static void netlist_free_nodes (struct node_t * node)
     for (; node != NULL; node = n)
     {
         n = node->next;
-        free (node->node);
         free (node);
     }
 }
@@ -1937,7 +2234,6 @@ static void netlist_free_definition (struct definition_t * def)
     netlist_free_nodes (def->nodes);
     if (!def->copy) netlist_free_pairs (def->pairs);
     free (def->subcircuit);
-    free (def->type);
     free (def->instance);
     free (def);
 }
@@ -1969,7 +2265,8 @@ netlist_unchain_definition (struct definition_t * root,
 
 /* The function expands the subcircuits within the given definition
    list and returns the expanded list with the subcircuit definitions
-   removed. */
+   removed.  With templates identical instances of a subcircuit share
+   a single environment, thus its equations are solved once. */
 static struct definition_t *
 checker_expand_subcircuits (struct definition_t * root, environment * parent)
 {
@@ -2018,6 +2315,7 @@ checker_expand_subcircuits (struct definition_t * root, environment * parent)
             def->env = parent;
         }
     }
+    checker_templates.clear ();
     return root;
 }
 
@@ -2030,6 +2328,9 @@ static int netlist_checker_intern (struct definition_t * root)
     struct define_t * available;
     int n, errors = 0;
 
+    /* build the hashed lookups of the definitions */
+    checker_build_index (root);
+
     /* go through all definitions */
     for (def = root; def != NULL; def = def->next)
     {
@@ -2081,7 +2382,7 @@ static int netlist_checker_intern (struct definition_t * root)
             }
         }
         /* check the number of definitions */
-        n = checker_count_definition (root, def->type, def->instance);
+        n = checker_count_definition (def->type, def->instance);
         if (n != 1 && def->duplicate == 0)
         {
             logprint (LOG_ERROR, "checker error, found %d definitions of `%s:%s'\n",
@@ -2341,6 +2642,8 @@ void netlist_destroy (void)
     }
     netlist_destroy_intern (subcircuit_root);
     definition_root = subcircuit_root = NULL;
+    checker_subcircuits.clear ();
+    netlist_release_strings ();
     netlist_lex_destroy ();
 }
 
@@ -2354,3 +2657,13 @@ void netlist_destroy_env (void)
     }
 }
 
+/* Hands the root environment(s) of the last checked netlist over to
+   the caller, who deletes them after the environment copied by the
+   checker.  Netlists checked later do not touch them. */
+environment * netlist_release_env (void)
+{
+    environment * env = env_root;
+    env_root = NULL;
+    return env;
+}
+
@@ -40,12 +40,14 @@ __BEGIN_DECLS
 
 /* Externalize variables used by the scanner and parser. */
 extern struct definition_t * definition_root;
+extern int netlist_templates;
 
 /* Available functions of the checker. */
 void netlist_status (void);
 void netlist_list (void);
 void netlist_destroy (void);
 void netlist_destroy_env (void);
+qucs::environment * netlist_release_env (void);
 int  netlist_checker (qucs::environment *);
 int  netlist_parse (void);
 int  netlist_error (const char *);
@@ -56,6 +58,8 @@ int  netlist_checker_variables (qucs::environment *);
 /* Some more functionality. */
 struct definition_t *
 netlist_unchain_definition (struct definition_t *, struct definition_t *);
+struct definition_t * netlist_reverse_definitions (struct definition_t *);
+char * netlist_intern (const char *);
 
 __END_DECLS
 
@@ -31,6 +31,8 @@
 #include <string.h>
 #include <ctype.h>
 #include <cmath>
+#include <string>
+#include <vector>
 
 #include "logging.h"
 #include "complex.h"
@@ -155,58 +157,88 @@ static int touchstone_vector_check (void) {
   return errors;
 }
 
+/* The function evaluates the given option identifier and puts the
+   appropriate values into the touchstone_options structure. */
+static void touchstone_option_eval (const char * str) {
+  /* frequency unit */
+  if (!strcmp (str, "hz")) {
+    touchstone_options.factor = 1.0;
+    touchstone_options.unit = "Hz";
+  }
+  else if (!strcmp (str, "khz")) {
+    touchstone_options.factor = 1e3;
+    touchstone_options.unit = "kHz";
+  }
+  else if (!strcmp (str, "mhz")) {
+    touchstone_options.factor = 1e6;
+    touchstone_options.unit = "MHz";
+  }
+  else if (!strcmp (str, "ghz")) {
+    touchstone_options.factor = 1e9;
+    touchstone_options.unit = "GHz";
+  }
+  /* parameter type */
+  else if (!strcmp (str, "s")) {
+    touchstone_options.parameter = 'S';
+  }
+  else if (!strcmp (str, "y")) {
+    touchstone_options.parameter = 'Y';
+  }
+  else if (!strcmp (str, "z")) {
+    touchstone_options.parameter = 'Z';
+  }
+  else if (!strcmp (str, "g")) {
+    touchstone_options.parameter = 'G';
+  }
+  else if (!strcmp (str, "h")) {
+    touchstone_options.parameter = 'H';
+  }
+  /* value formats */
+  else if (!strcmp (str, "ma")) {
+    touchstone_options.format = "MA";
+  }
+  else if (!strcmp (str, "db")) {
+    touchstone_options.format = "dB";
+  }
+  else if (!strcmp (str, "ri")) {
+    touchstone_options.format = "RI";
+  }
+}
+
 /* The function evaluates the identifiers in the option line and fills
    the touchstone_options structure with appropriate values. */
 static void touchstone_options_eval (void) {
   /* go through all identifiers */
-  for (int i = 0; i < touchstone_idents->length (); i++) {
-    char * str = touchstone_idents->get (i);
-    /* frequency unit */
-    if (!strcmp (str, "hz")) {
-      touchstone_options.factor = 1.0;
-      touchstone_options.unit = "Hz";
-    }
-    else if (!strcmp (str, "khz")) {
-      touchstone_options.factor = 1e3;
-      touchstone_options.unit = "kHz";
-    }
-    else if (!strcmp (str, "mhz")) {
-      touchstone_options.factor = 1e6;
-      touchstone_options.unit = "MHz";
-    }
-    else if (!strcmp (str, "ghz")) {
-      touchstone_options.factor = 1e9;
-      touchstone_options.unit = "GHz";
-    }
-    /* parameter type */
-    else if (!strcmp (str, "s")) {
-      touchstone_options.parameter = 'S';
-    }
-    else if (!strcmp (str, "y")) {
-      touchstone_options.parameter = 'Y';
-    }
-    else if (!strcmp (str, "z")) {
-      touchstone_options.parameter = 'Z';
-    }
-    else if (!strcmp (str, "g")) {
-      touchstone_options.parameter = 'G';
-    }
-    else if (!strcmp (str, "h")) {
-      touchstone_options.parameter = 'H';
-    }
-    /* value formats */
-    else if (!strcmp (str, "ma")) {
-      touchstone_options.format = "MA";
-    }
-    else if (!strcmp (str, "db")) {
-      touchstone_options.format = "dB";
-    }
-    else if (!strcmp (str, "ri")) {
-      touchstone_options.format = "RI";
-    }
+  for (int i = 0; i < touchstone_idents->length (); i++)
+    touchstone_option_eval (touchstone_idents->get (i));
+}
+
+/* Returns the matrix entry given by the pair of values in the current
+   touchstone data format. */
+static nr_complex_t touchstone_value (nr_double_t a, nr_double_t b) {
+  switch (touchstone_options.format[0]) {
+  case 'R': // real and imaginary part
+    return nr_complex_t (a, b);
+  case 'd': // magnitude in dB and angle
+    return qucs::polar (std::pow (10.0, a / 20.0), deg2rad (b));
+  default:  // magnitude and angle
+    return qucs::polar (a, deg2rad (b));
   }
 }
 
+/* Returns the optimal noise reflexion coefficient given by its
+   magnitude and angle, re-normalized to the internal reference
+   impedance if necessary. */
+static nr_complex_t touchstone_sopt (nr_double_t mag, nr_double_t ang) {
+  nr_complex_t val = qucs::polar (mag, deg2rad (ang));
+  if (ZREF != touchstone_options.resistance) {
+    nr_double_t r = (ZREF - touchstone_options.resistance) /
+      (ZREF + touchstone_options.resistance);
+    val = (val - r) / (1.0 - r * val);
+  }
+  return val;
+}
+
 /* This little function returns a static string containing an
    appropriate variable name. */
 static char * touchstone_create_set (int r, int c) {
@@ -276,18 +308,8 @@ static void touchstone_create (void) {
 	    pos = 1 + i * 2 + j * 2 * ports;
 	  }
 	  /* depending on the touchstone data format */
-	  if (!strcmp (touchstone_options.format, "RI")) {
-	    val = nr_complex_t (real (root->get (pos + 0)),
-			real (root->get (pos + 1)));
-	  }
-	  else if (!strcmp (touchstone_options.format, "MA")) {
-	    val = qucs::polar (real (root->get (pos + 0)),
-			 deg2rad (real (root->get (pos + 1))));
-	  }
-	  else if (!strcmp (touchstone_options.format, "dB")) {
-	    val = qucs::polar (std::pow (10.0, real (root->get (pos + 0)) / 20.0),
-			 deg2rad (real (root->get (pos + 1))));
-	  }
+	  val = touchstone_value (real (root->get (pos + 0)),
+				  real (root->get (pos + 1)));
 	  v->add (val);
 	  v = (qucs::vector *) v->getNext ();
 	}
@@ -303,13 +325,7 @@ static void touchstone_create (void) {
       v->add (val);
       /* fill optimal noise reflexion coefficient vector */
       v = touchstone_result->findVariable ("Sopt");
-      val = qucs::polar (real (root->get (2)), deg2rad (real (root->get (3))));
-      if (ZREF != touchstone_options.resistance) {
-	// re-normalize reflexion coefficient if necessary
-	nr_double_t r = (ZREF - touchstone_options.resistance) /
-	  (ZREF + touchstone_options.resistance);
-	val = (val - r) / (1.0 - r * val);
-      }
+      val = touchstone_sopt (real (root->get (2)), real (root->get (3)));
       v->add (val);
       /* fill equivalent noise resistance vector */
       v = touchstone_result->findVariable ("Rn");
@@ -320,8 +336,9 @@ static void touchstone_create (void) {
 }
 
 /* The function re-normalizes S-parameters to the internal reference
-   impedance 50 Ohms. */
-static void touchstone_normalize_sp (void) {
+   impedance 50 Ohms.  The given port reference impedances replace the
+   one of the option line if there are any. */
+static void touchstone_normalize_sp (const qucs::vector * zref = NULL) {
   int ports = touchstone_options.ports;
   qucs::vector * v = touchstone_result->getVariables ();
   int i, j, n, len = v->getSize ();
@@ -338,7 +355,10 @@ static void touchstone_normalize_sp (void) {
       }
     }
     // convert the temporary matrix
-    s = stos (s, touchstone_options.resistance, ZREF);
+    if (zref != NULL)
+      s = stos (s, *zref, nr_complex_t (ZREF));
+    else
+      s = stos (s, touchstone_options.resistance, ZREF);
     v = touchstone_result->getVariables ();
     // restore the results in the entries
     for (i = 0; i < ports; i++) {
@@ -390,6 +410,18 @@ static void touchstone_normalize (void) {
   }
 }
 
+/* Applies the default touchstone options again. */
+static void touchstone_defaults (void) {
+  touchstone_options.unit = "GHz";
+  touchstone_options.parameter = 'S';
+  touchstone_options.format = "MA";
+  touchstone_options.resistance = 50.0;
+  touchstone_options.factor = 1e9;
+  touchstone_options.ports = 0;
+  touchstone_options.noise = 0;
+  touchstone_options.lines = 0;
+}
+
 /* Removes temporary data items from memory if necessary. */
 static void touchstone_finalize (void) {
   qucs::vector * root, * next;
@@ -403,15 +435,7 @@ static void touchstone_finalize (void) {
     touchstone_idents = NULL;
   }
   touchstone_lex_destroy ();
-  /* apply default values again */
-  touchstone_options.unit = "GHz";
-  touchstone_options.parameter = 'S';
-  touchstone_options.format = "MA";
-  touchstone_options.resistance = 50.0;
-  touchstone_options.factor = 1e9;
-  touchstone_options.ports = 0;
-  touchstone_options.noise = 0;
-  touchstone_options.lines = 0;
+  touchstone_defaults ();
 }
 
 
@@ -529,3 +553,541 @@ void touchstone_init (void) {
   touchstone_vector = NULL;
   touchstone_idents = NULL;
 }
+
+/* The fast touchstone reader below goes through the contents of the
+   file once, collects the values of all data lines in a single array
+   and fills the resulting dataset from it directly.  Besides the 1.x
+   files it reads the Touchstone 2.0 files with their keywords.  A 1.x
+   file it does not fully understand is left to the scanner, parser
+   and checker above, which give the appropriate error messages. */
+
+// Sections of a Touchstone 2.0 file.
+enum touchstone_section_t {
+  TOUCHSTONE_HEADER,
+  TOUCHSTONE_REFERENCE,
+  TOUCHSTONE_INFORMATION,
+  TOUCHSTONE_NETWORK,
+  TOUCHSTONE_NOISE,
+  TOUCHSTONE_END
+};
+
+// State of the fast touchstone reader.
+struct touchstone_reader_t {
+  int version;      // major version of the file format
+  int line;         // current line number
+  int content;      // number of non-empty lines so far
+  int option;       // option line found
+  int section;      // current section of a 2.0 file
+  int network;      // [Network Data] found
+  int ports;        // [Number of Ports]
+  int order;        // [Two-Port Data Order], 21_12 (0) or 12_21 (1)
+  int frequencies;  // [Number of Frequencies]
+  int nfrequencies; // [Number of Noise Frequencies]
+  char matrix;      // [Matrix Format], 'F'ull, 'L'ower or 'U'pper
+  std::vector<nr_double_t> values;    // values of the data lines
+  std::vector<nr_double_t> noise;     // values of the noise lines (2.0)
+  std::vector<nr_double_t> reference; // port reference impedances (2.0)
+  std::vector<size_t> records;        // start of each data line (1.x)
+};
+
+/* Reports an error at the current line of a 2.0 file and returns -1.
+   A 1.x file is handed over to the parser instead. */
+static int touchstone_fail (touchstone_reader_t & r, const char * error) {
+  if (r.version < 2) return 1;
+  logprint (LOG_ERROR, "line %d: %s\n", r.line, error);
+  return -1;
+}
+
+// Skips the spaces at the given position.
+static const char * touchstone_space (const char * p, const char * eol) {
+  while (p < eol && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+  return p;
+}
+
+/* Reads the number at the given position.  It has the syntax of the
+   scanner and is followed by a space or the end of the line.  Returns
+   non-zero if there is none. */
+static int touchstone_number (const char *& p, const char * eol,
+			      nr_double_t & val) {
+  const char * s = p;
+  int digits = 0, fraction = 0;
+  char buf[64];
+
+  if (s < eol && (*s == '+' || *s == '-')) s++;
+  for (; s < eol && isdigit ((unsigned char) *s); s++) digits++;
+  if (s < eol && *s == '.') {
+    for (s++; s < eol && isdigit ((unsigned char) *s); s++) fraction++;
+    if (!fraction) return -1;
+  }
+  else if (!digits) return -1;
+  if (s < eol && (*s == 'e' || *s == 'E')) {
+    s++;
+    if (s < eol && (*s == '+' || *s == '-')) s++;
+    if (s == eol || !isdigit ((unsigned char) *s)) return -1;
+    while (s < eol && isdigit ((unsigned char) *s)) s++;
+  }
+  if (s < eol && *s != ' ' && *s != '\t' && *s != '\r') return -1;
+
+  // the file contents are not terminated after the number
+  if (s - p >= (int) sizeof (buf)) return -1;
+  memcpy (buf, p, s - p);
+  buf[s - p] = '\0';
+  val = strtod (buf, NULL);
+  p = s;
+  return 0;
+}
+
+/* Appends the numbers on the given line to the given values.  Returns
+   their count or -1 if there is anything else on the line. */
+static int touchstone_numbers (const char * p, const char * eol,
+			       std::vector<nr_double_t> & values) {
+  nr_double_t val;
+  int n = 0;
+  for (p = touchstone_space (p, eol); p < eol; p = touchstone_space (p, eol)) {
+    if (touchstone_number (p, eol, val)) return -1;
+    values.push_back (val);
+    n++;
+  }
+  return n;
+}
+
+/* Reads the option line following the '#' and puts its values into
+   the touchstone_options structure.  Returns non-zero if it is
+   invalid. */
+static int touchstone_option_line (const char * p, const char * eol) {
+  std::vector<std::string> options;
+  int resistance = 0;
+
+  for (p = touchstone_space (p, eol); p < eol; p = touchstone_space (p, eol)) {
+    if (!isalpha ((unsigned char) *p) && *p != '_') return -1;
+    std::string str;
+    for (; p < eol && (isalnum ((unsigned char) *p) || *p == '_'); p++)
+      str += (char) tolower ((unsigned char) *p);
+    // reference resistance
+    if (str == "r") {
+      p = touchstone_space (p, eol);
+      if (resistance++ ||
+	  touchstone_number (p, eol, touchstone_options.resistance))
+	return -1;
+      continue;
+    }
+    // valid options occur once only
+    int valid = 0;
+    for (int v = 0; touchstone_valid_options[v] != NULL; v++)
+      if (str == touchstone_valid_options[v]) valid = 1;
+    for (auto & o : options)
+      if (o == str) valid = 0;
+    if (!valid) return -1;
+    options.push_back (str);
+  }
+  if (options.size () > 3) return -1;
+  for (auto & o : options) touchstone_option_eval (o.c_str ());
+  return 0;
+}
+
+/* Evaluates the keyword line of a 2.0 file.  Returns zero on success,
+   -1 on errors and 1 if the file is no 2.0 file. */
+static int touchstone_keyword (touchstone_reader_t & r, const char * p,
+			       const char * eol) {
+  const char * k = (const char *) memchr (p, ']', eol - p);
+  std::string key, arg;
+  int n;
+
+  if (k == NULL) return touchstone_fail (r, "missing `]' after keyword");
+  for (p++; p < k; p++) key += (char) tolower ((unsigned char) *p);
+  for (p = touchstone_space (k + 1, eol); p < eol; p++)
+    arg += (char) tolower ((unsigned char) *p);
+  while (!arg.empty () && isspace ((unsigned char) arg[arg.size () - 1]))
+    arg.erase (arg.size () - 1);
+  n = atoi (arg.c_str ());
+
+  // the version keyword is the first one of a 2.0 file
+  if (key == "version") {
+    if (r.content > 1 || (arg != "2.0" && arg != "2.1"))
+      return touchstone_fail (r, "invalid [Version]");
+    r.version = 2;
+    return 0;
+  }
+  if (r.version < 2) return 1;
+
+  if (r.section == TOUCHSTONE_INFORMATION) {
+    if (key == "end information") r.section = TOUCHSTONE_HEADER;
+    return 0;
+  }
+  if (r.section == TOUCHSTONE_REFERENCE)
+    return touchstone_fail (r, "too few values in [Reference]");
+  if (r.section == TOUCHSTONE_END)
+    return touchstone_fail (r, "keyword after [End]");
+
+  if (key == "number of ports") {
+    if (r.ports || n < 1)
+      return touchstone_fail (r, "invalid [Number of Ports]");
+    r.ports = n;
+  }
+  else if (key == "two-port data order") {
+    if (arg == "12_21") r.order = 1;
+    else if (arg == "21_12") r.order = 0;
+    else return touchstone_fail (r, "invalid [Two-Port Data Order]");
+  }
+  else if (key == "number of frequencies") {
+    if (n < 1) return touchstone_fail (r, "invalid [Number of Frequencies]");
+    r.frequencies = n;
+  }
+  else if (key == "number of noise frequencies") {
+    if (n < 1)
+      return touchstone_fail (r, "invalid [Number of Noise Frequencies]");
+    r.nfrequencies = n;
+  }
+  else if (key == "reference") {
+    if (!r.ports)
+      return touchstone_fail (r, "[Reference] before [Number of Ports]");
+    if (touchstone_numbers (k + 1, eol, r.reference) < 0)
+      return touchstone_fail (r, "invalid [Reference]");
+    if ((int) r.reference.size () > r.ports)
+      return touchstone_fail (r, "too many values in [Reference]");
+    if ((int) r.reference.size () < r.ports)
+      r.section = TOUCHSTONE_REFERENCE;
+  }
+  else if (key == "matrix format") {
+    if (arg == "full") r.matrix = 'F';
+    else if (arg == "lower") r.matrix = 'L';
+    else if (arg == "upper") r.matrix = 'U';
+    else return touchstone_fail (r, "invalid [Matrix Format]");
+  }
+  else if (key == "mixed-mode order") {
+    return touchstone_fail (r, "mixed-mode parameters not supported");
+  }
+  else if (key == "begin information") {
+    r.section = TOUCHSTONE_INFORMATION;
+  }
+  else if (key == "network data") {
+    if (!r.option || !r.ports || !r.frequencies || r.network)
+      return touchstone_fail (r, "[Network Data] requires the option line, "
+			      "[Number of Ports] and [Number of Frequencies]");
+    r.network = 1;
+    r.section = TOUCHSTONE_NETWORK;
+    r.values.reserve ((size_t) r.frequencies * (1 + 2 * r.ports * r.ports));
+  }
+  else if (key == "noise data") {
+    if (!r.nfrequencies || !r.network)
+      return touchstone_fail (r, "[Noise Data] requires [Network Data] and "
+			      "[Number of Noise Frequencies]");
+    r.section = TOUCHSTONE_NOISE;
+  }
+  else if (key == "end") {
+    r.section = TOUCHSTONE_END;
+  }
+  else {
+    return touchstone_fail (r, "unknown keyword");
+  }
+  return 0;
+}
+
+/* Reads the values on the given data line.  Returns zero on success,
+   -1 on errors and 1 if the file is left to the parser. */
+static int touchstone_data (touchstone_reader_t & r, const char * p,
+			    const char * eol) {
+  size_t start = r.values.size ();
+  int n;
+
+  // lines with an odd number of values start the next frequency
+  if (r.version < 2) {
+    if (!r.option) return 1;
+    n = touchstone_numbers (p, eol, r.values);
+    if (n < 2 || n > 9) return 1;
+    if (n & 1)
+      r.records.push_back (start);
+    else if (r.records.empty ())
+      return 1;
+    return 0;
+  }
+
+  // in 2.0 files the values may wrap at any position
+  switch (r.section) {
+  case TOUCHSTONE_REFERENCE:
+    n = touchstone_numbers (p, eol, r.reference);
+    if ((int) r.reference.size () > r.ports)
+      return touchstone_fail (r, "too many values in [Reference]");
+    if ((int) r.reference.size () == r.ports)
+      r.section = TOUCHSTONE_HEADER;
+    break;
+  case TOUCHSTONE_NETWORK:
+    n = touchstone_numbers (p, eol, r.values);
+    break;
+  case TOUCHSTONE_NOISE:
+    n = touchstone_numbers (p, eol, r.noise);
+    break;
+  case TOUCHSTONE_INFORMATION:
+    return 0;
+  default:
+    return touchstone_fail (r, "data outside of [Network Data]");
+  }
+  return n < 0 ? touchstone_fail (r, "invalid number") : 0;
+}
+
+/* Creates the resulting dataset from the values collected by the fast
+   reader.  Each data line holds the frequency and the matrix entries
+   at the given positions, each noise line holds the frequency and the
+   four noise parameters.  The noise resistance is scaled by the given
+   factor. */
+static void touchstone_fill (const nr_double_t * data, int stride,
+			     int lines, const std::vector<int> & pos,
+			     const nr_double_t * noise, int nlines,
+			     nr_double_t rn) {
+  int ports = touchstone_options.ports, n, k;
+  nr_double_t factor = touchstone_options.factor;
+  std::vector<qucs::vector *> v (ports * ports);
+  strlist * s;
+
+  /* create dataset and frequency vector */
+  touchstone_result = new dataset ();
+  qucs::vector * f = new qucs::vector ("frequency", lines);
+  touchstone_result->appendDependency (f);
+  s = new strlist ();
+  s->add (f->getName ());
+  for (int r = 0; r < ports; r++) {
+    for (int c = 0; c < ports; c++) {
+      k = r * ports + c;
+      v[k] = new qucs::vector (touchstone_create_set (r, c), lines);
+      v[k]->setDependencies (new strlist (*s));
+      touchstone_result->appendVariable (v[k]);
+    }
+  }
+  delete s;
+  for (n = 0; n < lines; n++, data += stride) {
+    f->set (data[0] * factor, n);
+    for (k = 0; k < ports * ports; k++)
+      v[k]->set (touchstone_value (data[pos[k]], data[pos[k] + 1]), n);
+  }
+
+  /* create noise vectors if necessary */
+  if (nlines > 0) {
+    qucs::vector * nf = new qucs::vector ("nfreq", nlines);
+    touchstone_result->appendDependency (nf);
+    s = new strlist ();
+    s->add (nf->getName ());
+    qucs::vector * fmin = new qucs::vector ("Fmin", nlines);
+    qucs::vector * sopt = new qucs::vector ("Sopt", nlines);
+    qucs::vector * rres = new qucs::vector ("Rn", nlines);
+    fmin->setDependencies (new strlist (*s));
+    sopt->setDependencies (new strlist (*s));
+    rres->setDependencies (new strlist (*s));
+    touchstone_result->appendVariable (fmin);
+    touchstone_result->appendVariable (sopt);
+    touchstone_result->appendVariable (rres);
+    delete s;
+    for (n = 0; n < nlines; n++, noise += 5) {
+      nf->set (noise[0] * factor, n);
+      fmin->set (std::pow (10.0, noise[1] / 10.0), n);
+      sopt->set (touchstone_sopt (noise[2], noise[3]), n);
+      rres->set (noise[4] * rn, n);
+    }
+  }
+}
+
+/* Checks the frequencies of the given lines to be increasing. */
+static int touchstone_increasing (const nr_double_t * data, int stride,
+				  int lines) {
+  for (int n = 0; n < lines; n++, data += stride) {
+    if (data[0] < 0.0 || (n > 0 && data[0] <= data[-stride])) return -1;
+  }
+  return 0;
+}
+
+/* Creates the dataset of a 1.x file like the checker does.  Returns 1
+   for anything the checker would complain about. */
+static int touchstone_finish_v1 (touchstone_reader_t & r) {
+  if (!r.option || r.records.empty ()) return 1;
+  r.records.push_back (r.values.size ());
+
+  // the first line determines the number of ports
+  int size = r.records[1] - r.records[0];
+  int ports = (int) std::sqrt ((size - 1) / 2.0);
+  int records = r.records.size () - 1, lines = 0, n;
+  if (size != 1 + 2 * ports * ports) return 1;
+
+  // the noise parameters start at a decreasing frequency
+  for (n = 0; n < records; n++) {
+    int len = r.records[n + 1] - r.records[n];
+    if (n > 0 && r.values[r.records[n]] <= r.values[r.records[n - 1]])
+      break;
+    if (len != size) return 1;
+    lines++;
+  }
+  for (; n < records; n++) {
+    if (r.records[n + 1] - r.records[n] != 5) return 1;
+  }
+  const nr_double_t * noise = &r.values[0] + r.records[lines];
+  int nlines = records - lines;
+  if (touchstone_increasing (&r.values[0], size, lines) ||
+      touchstone_increasing (noise, 5, nlines))
+    return 1;
+  if ((touchstone_options.parameter == 'G' ||
+       touchstone_options.parameter == 'H') && ports != 2)
+    return 1;
+  if (nlines && ports != 2) return 1;
+
+  // '21' data precedes the '12' data of 2-ports
+  std::vector<int> pos (ports * ports);
+  for (int i = 0; i < ports; i++) {
+    for (int j = 0; j < ports; j++) {
+      pos[i * ports + j] = 1 + 2 * (ports == 2 && i != j ?
+				    i + j * ports : j + i * ports);
+    }
+  }
+  touchstone_options.ports = ports;
+  touchstone_options.noise = nlines > 0;
+  touchstone_options.lines = lines;
+  touchstone_fill (&r.values[0], size, lines, pos, noise, nlines,
+		   touchstone_options.resistance);
+  touchstone_normalize ();
+  return 0;
+}
+
+/* Creates the dataset of a 2.0 file.  Their Y-, Z-, G- and
+   H-parameters and noise resistances are not normalized.  Returns -1
+   on errors. */
+static int touchstone_finish_v2 (touchstone_reader_t & r) {
+  int ports = r.ports, entries, size, i, j, k;
+
+  if (!r.network) {
+    logprint (LOG_ERROR, "checker error, no [Network Data] in touchstone "
+	      "file\n");
+    return -1;
+  }
+  if (ports == 2 && r.order < 0) {
+    logprint (LOG_ERROR, "checker error, no [Two-Port Data Order] in "
+	      "touchstone file\n");
+    return -1;
+  }
+  if (r.section == TOUCHSTONE_REFERENCE) {
+    logprint (LOG_ERROR, "checker error, too few values in [Reference]\n");
+    return -1;
+  }
+  entries = r.matrix == 'F' ? ports * ports : ports * (ports + 1) / 2;
+  size = 1 + 2 * entries;
+  if (r.values.size () != (size_t) r.frequencies * size ||
+      r.noise.size () != (size_t) r.nfrequencies * 5) {
+    logprint (LOG_ERROR, "checker error, %d frequencies with %d values and "
+	      "%d noise frequencies with 5 values required\n",
+	      r.frequencies, size, r.nfrequencies);
+    return -1;
+  }
+  if (touchstone_increasing (&r.values[0], size, r.frequencies) ||
+      (r.nfrequencies && touchstone_increasing (&r.noise[0], 5,
+						r.nfrequencies))) {
+    logprint (LOG_ERROR, "checker error, frequencies not increasing\n");
+    return -1;
+  }
+  if ((touchstone_options.parameter == 'G' ||
+       touchstone_options.parameter == 'H') && ports != 2) {
+    logprint (LOG_ERROR, "checker error, %c-parameters for %d-ports not "
+	      "defined\n", touchstone_options.parameter, ports);
+    return -1;
+  }
+  if (r.nfrequencies && ports != 2) {
+    logprint (LOG_ERROR, "checker error, noise parameters for %d-ports not "
+	      "defined\n", ports);
+    return -1;
+  }
+
+  // the entries of the lower or upper triangle apply to both
+  std::vector<int> pos (ports * ports);
+  for (k = 1, i = 0; i < ports; i++) {
+    for (j = r.matrix == 'U' ? i : 0; j < (r.matrix == 'L' ? i + 1 : ports);
+	 j++, k += 2) {
+      if (r.matrix != 'F')
+	pos[i * ports + j] = pos[j * ports + i] = k;
+      else if (ports == 2 && i != j && r.order == 0)
+	pos[j * ports + i] = k;
+      else
+	pos[i * ports + j] = k;
+    }
+  }
+
+  // all ports at the reference resistance of the option line by default
+  if (r.reference.empty ())
+    r.reference.assign (ports, touchstone_options.resistance);
+  touchstone_options.resistance = r.reference[0];
+  touchstone_options.ports = ports;
+  touchstone_options.noise = r.nfrequencies > 0;
+  touchstone_options.lines = r.frequencies;
+  touchstone_fill (&r.values[0], size, r.frequencies, pos,
+		   r.nfrequencies ? &r.noise[0] : NULL, r.nfrequencies, 1.0);
+  if (touchstone_options.parameter == 'S') {
+    qucs::vector zref (ports);
+    int same = 1;
+    for (i = 0; i < ports; i++) {
+      zref.set (r.reference[i], i);
+      if (r.reference[i] != r.reference[0]) same = 0;
+    }
+    if (same && r.reference[0] != ZREF)
+      touchstone_normalize_sp ();
+    else if (!same)
+      touchstone_normalize_sp (&zref);
+  }
+  return 0;
+}
+
+// Reads the given touchstone file contents.
+static int touchstone_fast (const char * data, long size) {
+  const char * end = data + size, * eol, * e, * s;
+  touchstone_reader_t r;
+  int error;
+
+  r.version = 1;
+  r.line = r.content = r.option = r.network = 0;
+  r.section = TOUCHSTONE_HEADER;
+  r.ports = r.frequencies = r.nfrequencies = 0;
+  r.order = -1;
+  r.matrix = 'F';
+  if (size > 0) r.values.reserve (size / 8);
+
+  for (const char * p = data; p < end; p = eol + 1) {
+    r.line++;
+    if ((eol = (const char *) memchr (p, '\n', end - p)) == NULL) eol = end;
+    // the comments run until the end of the line
+    if ((e = (const char *) memchr (p, '!', eol - p)) == NULL) e = eol;
+    if ((s = touchstone_space (p, e)) == e) continue;
+    r.content++;
+
+    if (r.section == TOUCHSTONE_INFORMATION && *s != '[')
+      continue;
+    if (*s == '#') {
+      // the '#' starts the line in 1.x files
+      if (r.option || (r.version < 2 && s != p) ||
+	  touchstone_option_line (s + 1, e))
+	return touchstone_fail (r, "invalid option line");
+      r.option = 1;
+      continue;
+    }
+    if (*s == '[')
+      error = touchstone_keyword (r, s, e);
+    else
+      error = touchstone_data (r, s, e);
+    if (error) return error;
+  }
+  return r.version < 2 ? touchstone_finish_v1 (r) : touchstone_finish_v2 (r);
+}
+
+/* The function reads the given contents of a touchstone file without
+   the scanner and parser.  It returns zero on success and -1 on
+   errors, the result is the touchstone_result dataset.  It returns 1
+   if the file should be read by the parser and checked instead. */
+int touchstone_read (const char * data, long size) {
+  touchstone_result = NULL;
+  int status = touchstone_fast (data, size);
+
+#if DEBUG
+  /* emit little notify message on successful loading */
+  if (!status) {
+    logprint (LOG_STATUS, "NOTIFY: touchstone %d-port %c-data%s loaded\n",
+	      touchstone_options.ports, touchstone_options.parameter,
+	      touchstone_options.noise ? " including noise" : "");
+  }
+#endif
+
+  /* apply default values again */
+  touchstone_defaults ();
+  return status;
+}
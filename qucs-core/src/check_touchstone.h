@@ -76,6 +76,7 @@ int touchstone_error (const char *);
 int touchstone_lex (void);
 int touchstone_lex_destroy (void);
 int touchstone_check (void);
+int touchstone_read (const char *, long);
 void touchstone_init (void);
 void touchstone_destroy (void);
 
@@ -33,6 +33,7 @@
 #include <assert.h>
 #include <float.h>
 #include <ctype.h>
+#include <string>
 
 #include "strlist.h"
 #include "object.h"
@@ -40,6 +41,7 @@
 #include "vector.h"
 #include "dataset.h"
 #include "constants.h"
+#include "tokenizer.h"
 #include "check_zvr.h"
 
 using namespace qucs;
@@ -264,6 +266,242 @@ void zvr_destroy (void) {
   }
 }
 
+/* The fast ZVR reader below goes through the contents of the file once
+   and builds the data the parser would, the values of the data lines
+   are appended to the vectors right away.  The checker above creates
+   the dataset from them.  A file the reader does not fully understand
+   is left to the scanner and parser, which give the appropriate error
+   messages. */
+
+// Tokens of the ZVR scanner.
+enum zvr_token_t {
+  ZVR_END,
+  ZVR_INVALID,
+  ZVR_SEMICOLON,
+  ZVR_REAL,
+  ZVR_UNIT,
+  ZVR_FORMAT,
+  ZVR_TYPE,
+  ZVR_IDENT,
+  ZVR_DATAIDN
+};
+
+// State of the fast ZVR reader.
+struct zvr_reader_t {
+  tokenizer * t;
+  int token;        // the current token
+  std::string text; // the text of words
+  nr_double_t real; // the value of numbers
+};
+
+static const char * zvr_units[] = {
+  "Hz", "none", "dB", NULL };
+static const char * zvr_formats[] = {
+  "RI", "COMPLEX", "MAGNITUDE", "PHASE", "MA", "DB", NULL };
+static const char * zvr_prefixes[] = {
+  "re", "im", "mag", "ang", "db", NULL };
+
+// Returns non-zero if the given word is in the given list.
+static int zvr_member (const char * word, const char ** list) {
+  for (int i = 0; list[i] != NULL; i++)
+    if (!strcmp (word, list[i])) return 1;
+  return 0;
+}
+
+// Returns non-zero if the given word is a data type like 'S21'.
+static int zvr_type (const char * word) {
+  if (!isupper ((unsigned char) *word++)) return 0;
+  for (int i = 0; i < 2 && isdigit ((unsigned char) *word); i++) word++;
+  return *word == '\0';
+}
+
+/* Returns the token of the given word.  The scanner takes the longest
+   match and the first of its rules for equally long ones, a word it
+   would not take as a whole is invalid. */
+static int zvr_classify (const char * word) {
+  if (zvr_member (word, zvr_units)) return ZVR_UNIT;
+  if (zvr_member (word, zvr_formats)) return ZVR_FORMAT;
+  if (zvr_type (word)) return ZVR_TYPE;
+  const char * s = word;
+  if (isalpha ((unsigned char) *s)) {
+    while (isalpha ((unsigned char) *s) || *s == '-') s++;
+    if (*s == '\0') return ZVR_IDENT;
+  }
+  for (int i = 0; zvr_prefixes[i] != NULL; i++) {
+    size_t len = strlen (zvr_prefixes[i]);
+    if (!strncmp (word, zvr_prefixes[i], len) && zvr_type (word + len))
+      return ZVR_DATAIDN;
+  }
+  return ZVR_INVALID;
+}
+
+// Moves on to the next token, line ends are spaces.
+static void zvr_next (zvr_reader_t & r) {
+  tokenizer & t = *r.t;
+  for (t.skip (" \t\r"); t.atEnd (); t.skip (" \t\r")) {
+    if (!t.next ()) {
+      r.token = ZVR_END;
+      return;
+    }
+  }
+  if (t.literal (";"))
+    r.token = ZVR_SEMICOLON;
+  else if (t.number (r.real, TOKENIZER_LEADING))
+    r.token = ZVR_REAL;
+  else if (isalpha ((unsigned char) *t.getCursor ())) {
+    r.text = t.take (t.span ("-"));
+    r.token = zvr_classify (r.text.c_str ());
+  }
+  else
+    r.token = ZVR_INVALID;
+  if (r.token != ZVR_SEMICOLON && !t.delimited (" \t\r;"))
+    r.token = ZVR_INVALID;
+}
+
+/* Returns non-zero if the current token is none of the given ones,
+   moves on otherwise. */
+static int zvr_expect (zvr_reader_t & r, int token, int other = ZVR_END) {
+  if (r.token != token && (other == ZVR_END || r.token != other)) return -1;
+  zvr_next (r);
+  return 0;
+}
+
+// Reads a word of the given kinds and returns a copy of it.
+static char * zvr_word (zvr_reader_t & r, int token, int other = ZVR_END) {
+  if (r.token != token && (other == ZVR_END || r.token != other))
+    return NULL;
+  char * word = strdup (r.text.c_str ());
+  zvr_next (r);
+  return word;
+}
+
+// Reads a number.  Returns non-zero if there is none.
+static int zvr_real (zvr_reader_t & r, nr_double_t & val) {
+  val = r.real;
+  return zvr_expect (r, ZVR_REAL);
+}
+
+/* Reads the given number of identifiers separated by semicolons.
+   Returns non-zero if they are invalid. */
+static int zvr_paralist (zvr_reader_t & r, int n) {
+  for (int i = 0; i < n; i++) {
+    if ((i && zvr_expect (r, ZVR_SEMICOLON)) || zvr_expect (r, ZVR_IDENT))
+      return -1;
+  }
+  return 0;
+}
+
+/* Reads the header of a data body into the given header.  Returns
+   non-zero if it is invalid. */
+static int zvr_header (zvr_reader_t & r, struct zvr_header_t * h) {
+  nr_double_t points;
+  if (zvr_paralist (r, 6)) return -1;
+  if (zvr_real (r, h->start) || zvr_expect (r, ZVR_SEMICOLON) ||
+      zvr_real (r, h->stop) || zvr_expect (r, ZVR_SEMICOLON) ||
+      !(h->funit = zvr_word (r, ZVR_UNIT)) ||
+      zvr_expect (r, ZVR_SEMICOLON) ||
+      zvr_real (r, points) || zvr_expect (r, ZVR_SEMICOLON) ||
+      !(h->d_TYP = zvr_word (r, ZVR_TYPE)) ||
+      zvr_expect (r, ZVR_SEMICOLON) || zvr_real (r, h->zref))
+    return -1;
+  h->points = (int) points;
+  if (zvr_paralist (r, 6)) return -1;
+  if (zvr_expect (r, ZVR_TYPE) || zvr_expect (r, ZVR_SEMICOLON) ||
+      zvr_expect (r, ZVR_IDENT, ZVR_UNIT) || zvr_expect (r, ZVR_SEMICOLON) ||
+      !(h->d_FMT = zvr_word (r, ZVR_FORMAT)) ||
+      zvr_expect (r, ZVR_SEMICOLON) ||
+      !(h->d_UNT = zvr_word (r, ZVR_IDENT, ZVR_UNIT)) ||
+      zvr_expect (r, ZVR_SEMICOLON) ||
+      zvr_expect (r, ZVR_IDENT, ZVR_UNIT) || zvr_expect (r, ZVR_SEMICOLON) ||
+      zvr_expect (r, ZVR_IDENT, ZVR_UNIT))
+    return -1;
+  if (zvr_paralist (r, 2)) return -1;
+  if (zvr_expect (r, ZVR_IDENT, ZVR_UNIT) || zvr_expect (r, ZVR_SEMICOLON) ||
+      zvr_expect (r, ZVR_IDENT, ZVR_UNIT))
+    return -1;
+  return 0;
+}
+
+/* Reads the data header and the data lines of a data body into the
+   given vector description.  Returns non-zero if they are invalid. */
+static int zvr_body (zvr_reader_t & r, struct zvr_vector_t * v) {
+  nr_double_t d, re, im;
+  if (!(v->nf = zvr_word (r, ZVR_IDENT)) || zvr_expect (r, ZVR_SEMICOLON) ||
+      !(v->n1 = zvr_word (r, ZVR_TYPE, ZVR_DATAIDN)))
+    return -1;
+  if (!zvr_expect (r, ZVR_SEMICOLON) &&
+      !(v->n2 = zvr_word (r, ZVR_TYPE, ZVR_DATAIDN)))
+    return -1;
+  v->vi = new qucs::vector ();
+  v->vd = new qucs::vector ();
+  while (r.token == ZVR_REAL) {
+    zvr_real (r, d);
+    if (zvr_expect (r, ZVR_SEMICOLON) || zvr_real (r, re)) return -1;
+    im = 0;
+    if (!zvr_expect (r, ZVR_SEMICOLON) && zvr_real (r, im)) return -1;
+    v->vi->add (d);
+    v->vd->add (nr_complex_t (re, im));
+  }
+  return 0;
+}
+
+// Moves past the digits at the cursor and returns their number.
+static int zvr_digits (tokenizer & t) {
+  const char * s = t.getCursor ();
+  int n = 0;
+  while (s + n < t.getEnd () && isdigit ((unsigned char) s[n])) n++;
+  t.advance (n);
+  return n;
+}
+
+// Reads the given ZVR file contents into the data bodies.
+static int zvr_fast (const char * data, long size) {
+  tokenizer t (data, size);
+  struct zvr_data_t ** dn = &zvr_root;
+  zvr_reader_t r;
+  r.t = &t;
+
+  // the version header
+  t.next ();
+  t.skip (" \t\r");
+  if (!t.literal ("ZVR,")) return 1;
+  for (t.skip (" \t\r"); t.atEnd (); t.skip (" \t\r"))
+    if (!t.next ()) return 1;
+  if (!zvr_digits (t) || !t.literal (".") || !zvr_digits (t)) return 1;
+  zvr_next (r);
+
+  // at least one data body
+  do {
+    struct zvr_data_t * d =
+      (struct zvr_data_t *) calloc (sizeof (struct zvr_data_t), 1);
+    *dn = d;
+    dn = &d->next;
+    d->h = (struct zvr_header_t *) calloc (sizeof (struct zvr_header_t), 1);
+    d->v = (struct zvr_vector_t *) calloc (sizeof (struct zvr_vector_t), 1);
+    if (zvr_header (r, d->h) || zvr_body (r, d->v)) return 1;
+  }
+  while (r.token != ZVR_END);
+  return 0;
+}
+
+/* The function reads the given contents of a ZVR file without the
+   scanner and parser and checks them.  It returns zero on success and
+   -1 on errors, the result is the zvr_result dataset.  It returns 1 if
+   the file should be read by the parser and checked instead. */
+int zvr_read (const char * data, long size) {
+  zvr_result = NULL;
+  zvr_root = NULL;
+  if (zvr_fast (data, size)) {
+    for (struct zvr_data_t * d = zvr_root; d != NULL; d = d->next) {
+      delete d->v->vi;
+      delete d->v->vd;
+    }
+    zvr_finalize ();
+    return 1;
+  }
+  return zvr_check ();
+}
+
 // Initializes the ZVR checker.
 void zvr_init (void) {
   zvr_result = NULL;
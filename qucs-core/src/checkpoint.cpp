@@ -0,0 +1,185 @@
+/*
+ * checkpoint.cpp - analysis checkpoint file implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "qucs_typedefs.h"
+#include "logging.h"
+#include "checkpoint.h"
+
+namespace qucs {
+
+std::string checkpoint::base;
+double checkpoint::interval = 0;
+bool checkpoint::resuming = false;
+
+/* Sets up the checkpoint of the analysis with the given name.  The
+   first one is due after the interval. */
+checkpoint::checkpoint (const std::string & name) {
+  file = base + "." + name + ".checkpoint";
+  f = NULL;
+  ok = false;
+  last = std::chrono::steady_clock::now ();
+}
+
+checkpoint::~checkpoint () {
+  close ();
+}
+
+/* Enables checkpoints every given number of seconds, kept in files
+   starting with the given base name. */
+void checkpoint::enable (const std::string & name, double seconds) {
+  base = name;
+  interval = seconds;
+}
+
+// Returns true if the interval passed since the last checkpoint.
+bool checkpoint::due (void) {
+  std::chrono::duration<double> d = std::chrono::steady_clock::now () - last;
+  return d.count () >= interval;
+}
+
+/* Starts writing a checkpoint with the given key into the temporary
+   file.  Returns zero on success. */
+int checkpoint::create (const std::string & key) {
+  close ();
+  last = std::chrono::steady_clock::now ();
+  if ((f = fopen ((file + ".tmp").c_str (), "wb")) == NULL) {
+    logprint (LOG_ERROR, "cannot create file `%s.tmp'\n", file.c_str ());
+    return -1;
+  }
+  ok = fwrite (CHECKPOINT_MAGIC, 8, 1, f) == 1;
+  put (CHECKPOINT_VERSION);
+  put (key);
+  return ok ? 0 : -1;
+}
+
+/* Finishes writing the checkpoint, it replaces the previous one.
+   Returns zero on success. */
+int checkpoint::commit (void) {
+  if (f == NULL) return -1;
+  ok = fclose (f) == 0 && ok;
+  f = NULL;
+  std::string tmp = file + ".tmp";
+  if (!ok || rename (tmp.c_str (), file.c_str ())) {
+    logprint (LOG_ERROR, "cannot write checkpoint `%s'\n", file.c_str ());
+    ::remove (tmp.c_str ());
+    return -1;
+  }
+  return 0;
+}
+
+/* Opens the checkpoint for reading if it has the given key.  Returns
+   zero on success, non-zero if there is no such file or it belongs to
+   another netlist. */
+int checkpoint::open (const std::string & key) {
+  close ();
+  if ((f = fopen (file.c_str (), "rb")) == NULL) return -1;
+  char magic[8];
+  int version = 0;
+  std::string k;
+  ok = fread (magic, 8, 1, f) == 1 && !memcmp (magic, CHECKPOINT_MAGIC, 8);
+  get (version);
+  get (k);
+  if (ok && version == CHECKPOINT_VERSION && k == key) return 0;
+  logprint (LOG_STATUS, "NOTIFY: checkpoint `%s' does not match the "
+	    "netlist, starting over\n", file.c_str ());
+  close ();
+  return -1;
+}
+
+void checkpoint::close (void) {
+  if (f != NULL) fclose (f);
+  f = NULL;
+}
+
+// Removes the checkpoint once the analysis finished.
+void checkpoint::remove (void) {
+  close ();
+  ::remove (file.c_str ());
+}
+
+void checkpoint::put (int n) {
+  ok = ok && fwrite (&n, sizeof (n), 1, f) == 1;
+}
+
+void checkpoint::put (nr_double_t d) {
+  ok = ok && fwrite (&d, sizeof (d), 1, f) == 1;
+}
+
+void checkpoint::put (const nr_double_t * d, int n) {
+  put (n);
+  ok = ok && (n == 0 || fwrite (d, sizeof (*d), n, f) == (size_t) n);
+}
+
+void checkpoint::put (const std::string & s) {
+  put ((int) s.size ());
+  ok = ok && (s.empty () || fwrite (s.data (), s.size (), 1, f) == 1);
+}
+
+void checkpoint::put (const std::vector<int> & v) {
+  put ((int) v.size ());
+  ok = ok && (v.empty () || fwrite (v.data (), sizeof (int), v.size (), f) ==
+	      v.size ());
+}
+
+void checkpoint::get (int & n) {
+  ok = ok && fread (&n, sizeof (n), 1, f) == 1;
+}
+
+void checkpoint::get (nr_double_t & d) {
+  ok = ok && fread (&d, sizeof (d), 1, f) == 1;
+}
+
+/* Reads the given number of values, the number stored must match. */
+void checkpoint::get (nr_double_t * d, int n) {
+  int m = -1;
+  get (m);
+  ok = ok && m == n && (n == 0 || fread (d, sizeof (*d), n, f) == (size_t) n);
+}
+
+void checkpoint::get (std::string & s) {
+  int n = -1;
+  get (n);
+  ok = ok && n >= 0 && n < (1 << 20);
+  if (!ok) return;
+  s.resize (n);
+  ok = n == 0 || fread (&s[0], n, 1, f) == 1;
+}
+
+void checkpoint::get (std::vector<int> & v) {
+  int n = -1;
+  get (n);
+  ok = ok && n >= 0 && n < (1 << 28);
+  if (!ok) return;
+  v.resize (n);
+  ok = n == 0 || fread (&v[0], sizeof (int), n, f) == (size_t) n;
+}
+
+} // namespace qucs
@@ -0,0 +1,99 @@
+/*
+ * checkpoint.h - analysis checkpoint file definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// checkpoint file identification and version
+#define CHECKPOINT_MAGIC   "QucsCkpt"
+#define CHECKPOINT_VERSION 1
+
+// default seconds between two checkpoints of an analysis
+#define CHECKPOINT_INTERVAL 600
+
+namespace qucs {
+
+/*! \class checkpoint
+ * \brief periodically written state of a long running analysis.
+ *
+ * An analysis writes its state every so many seconds of wall clock
+ * time into a file next to the output dataset, named after the
+ * analysis.  The file starts with a key describing the netlist, a
+ * resumed run reads the state back only if its own key matches.  The
+ * file is first written under a temporary name and then renamed, thus
+ * a run killed while writing leaves the previous checkpoint intact.
+ * The values are stored in binary form of the host.
+ */
+class checkpoint
+{
+ public:
+  checkpoint (const std::string &);
+  ~checkpoint ();
+
+  static void enable (const std::string &, double interval =
+		      CHECKPOINT_INTERVAL);
+  static bool enabled (void) { return interval > 0; }
+  static void resume (void) { resuming = true; }
+  static bool resumes (void) { return resuming && enabled (); }
+
+  bool due (void);
+  int create (const std::string &);
+  int commit (void);
+  int open (const std::string &);
+  void close (void);
+  void remove (void);
+  bool good (void) const { return ok; }
+  void setFile (const std::string & name) { file = name; }
+
+  void put (int);
+  void put (nr_double_t);
+  void put (const nr_double_t *, int);
+  void put (const std::string &);
+  void put (const std::vector<int> &);
+  void get (int &);
+  void get (nr_double_t &);
+  void get (nr_double_t *, int);
+  void get (std::string &);
+  void get (std::vector<int> &);
+
+ private:
+  std::string file;
+  FILE * f;
+  bool ok;
+  std::chrono::steady_clock::time_point last;
+
+ private:
+  static std::string base;
+  static double interval;
+  static bool resuming;
+};
+
+} // namespace qucs
+
+#endif /* __CHECKPOINT_H__ */
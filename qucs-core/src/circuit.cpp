@@ -30,6 +30,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <cmath>
+#include <algorithm>
 
 #include "logging.h"
 #include "complex.h"
@@ -41,10 +43,12 @@
 #include "tvector.h"
 #include "history.h"
 #include "circuit.h"
+#include "hbstamps.h"
 #include "microstrip/substrate.h"
 #include "operatingpoint.h"
 #include "characteristic.h"
 #include "component_id.h"
+#include "profile.h"
 
 namespace qucs {
 
@@ -55,9 +59,12 @@ const nr_double_t circuit::z0 = 50.0;
 circuit::circuit () : object (), integrator () {
   next = prev = NULL;
   size = 0;
-  MatrixN = MatrixS = MatrixY = NULL;
-  MatrixB = MatrixC = MatrixD = NULL;
-  VectorQ = VectorE = VectorI = VectorV = VectorJ = NULL;
+  MatrixN = MatrixS = NULL;
+  MatrixY = MatrixB = MatrixC = MatrixD = NULL;
+  VectorE = VectorI = VectorV = VectorJ = NULL;
+  VectorQ = NULL;
+  realMNA = false;
+  mnaSources = 0;
   MatrixQV = NULL;
   VectorCV = VectorGV = NULL;
   nodes = NULL;
@@ -75,6 +82,11 @@ circuit::circuit () : object (), integrator () {
   histories = NULL;
   nHistories = 0;
   type = CIR_UNKNOWN;
+  bypassRel = bypassAbs = 0;
+  bypassValid = false;
+  bypassCalls = bypassHits = bypassN = 0;
+  bypassV = NULL;
+  bypassYI = NULL;
 }
 
 /* Constructor creates an unnamed instance of the circuit class with a
@@ -84,9 +96,13 @@ circuit::circuit (int s) : object (), integrator () {
   assert (s >= 0);
   size = s;
   if (size > 0) nodes = new node[s];
-  MatrixN = MatrixS = MatrixY = NULL;
-  MatrixB = MatrixC = MatrixD = NULL;
-  VectorQ = VectorE = VectorI = VectorV = VectorJ = NULL;
+  nodeRows.assign (size, -1);
+  MatrixN = MatrixS = NULL;
+  MatrixY = MatrixB = MatrixC = MatrixD = NULL;
+  VectorE = VectorI = VectorV = VectorJ = NULL;
+  VectorQ = NULL;
+  realMNA = false;
+  mnaSources = 0;
   MatrixQV = NULL;
   VectorCV = VectorGV = NULL;
   pacport = 0;
@@ -103,6 +119,11 @@ circuit::circuit (int s) : object (), integrator () {
   histories = NULL;
   nHistories = 0;
   type = CIR_UNKNOWN;
+  bypassRel = bypassAbs = 0;
+  bypassValid = false;
+  bypassCalls = bypassHits = bypassN = 0;
+  bypassV = NULL;
+  bypassYI = NULL;
 }
 
 /* The copy constructor creates a new instance based on the given
@@ -125,6 +146,19 @@ circuit::circuit (const circuit & c) : object (c), integrator (c) {
   nHistories = c.nHistories;
   histories = NULL;
   subcircuit = c.subcircuit;
+  bypassRel = c.bypassRel;
+  bypassAbs = c.bypassAbs;
+  bypassValid = false;
+  bypassCalls = bypassHits = bypassN = 0;
+  bypassV = NULL;
+  bypassYI = NULL;
+  realMNA = c.realMNA;
+  mnaSources = 0;
+  nodeRows = c.nodeRows;
+  MatrixN = MatrixS = NULL;
+  MatrixY = MatrixB = MatrixC = MatrixD = NULL;
+  VectorE = VectorI = VectorV = VectorJ = NULL;
+  VectorQ = MatrixQV = VectorCV = VectorGV = NULL;
 
   if (size > 0) {
     // copy each node and set its circuit to the current circuit object
@@ -155,25 +189,20 @@ circuit::circuit (const circuit & c) : object (c), integrator (c) {
     // copy each G-MNA matrix entry
     if (c.MatrixY) {
       allocMatrixMNA ();
-      memcpy (MatrixY, c.MatrixY, size * size * sizeof (nr_complex_t));
-      memcpy (VectorI, c.VectorI, size * sizeof (nr_complex_t));
-      memcpy (VectorV, c.VectorV, size * sizeof (nr_complex_t));
+      memcpy (MatrixY, c.MatrixY, sizeMNA (size * size));
+      memcpy (VectorI, c.VectorI, sizeMNA (size));
+      memcpy (VectorV, c.VectorV, sizeMNA (size));
       if (vsources > 0) {
-	memcpy (MatrixB, c.MatrixB, vsources * size * sizeof (nr_complex_t));
-	memcpy (MatrixC, c.MatrixC, vsources * size * sizeof (nr_complex_t));
-	memcpy (MatrixD, c.MatrixD, vsources * vsources * sizeof (nr_complex_t));
-	memcpy (VectorE, c.VectorE, vsources * sizeof (nr_complex_t));
-	memcpy (VectorJ, c.VectorJ, vsources * sizeof (nr_complex_t));
+	memcpy (MatrixB, c.MatrixB, sizeMNA (vsources * size));
+	memcpy (MatrixC, c.MatrixC, sizeMNA (vsources * size));
+	memcpy (MatrixD, c.MatrixD, sizeMNA (vsources * vsources));
+	memcpy (VectorE, c.VectorE, sizeMNA (vsources));
+	memcpy (VectorJ, c.VectorJ, sizeMNA (vsources));
       }
     }
   }
   else {
     nodes = NULL;
-    MatrixS = MatrixN = MatrixY = NULL;
-    MatrixB = MatrixC = MatrixD = NULL;
-    VectorQ = VectorE = VectorI = VectorV = VectorJ = NULL;
-    MatrixQV = NULL;
-    VectorCV = VectorGV = NULL;
   }
 
   // copy operating points
@@ -200,6 +229,8 @@ void circuit::setSize (int s) {
   if (size == s) return;
   assert (s >= 0);
 
+  // the S-parameter and noise matrices are re-created if used only
+  bool sp = MatrixS != NULL, noise = MatrixN != NULL;
   if (size > 0) {
     // destroy any matrix and node information
     delete[] MatrixS;
@@ -209,11 +240,12 @@ void circuit::setSize (int s) {
     delete[] nodes; nodes = NULL;
   }
 
+  nodeRows.assign (s, -1);
   if ((size = s) > 0) {
     // re-create matrix and node information space
     nodes = new node[size];
-    allocMatrixS ();
-    allocMatrixN (nsources);
+    if (sp) allocMatrixS ();
+    if (noise) allocMatrixN (nsources);
     allocMatrixMNA ();
   }
 }
@@ -232,21 +264,47 @@ void circuit::allocMatrixHB (void) {
     memset (VectorQ, 0, size * sizeof (nr_complex_t));
   } else {
     VectorQ = new nr_complex_t[size];
+    profile::count (PROFILE_ALLOCATIONS);
   }
   if (MatrixQV) {
     memset (MatrixQV, 0, size * size * sizeof (nr_complex_t));
   } else {
     MatrixQV = new nr_complex_t[size * size];
+    profile::count (PROFILE_ALLOCATIONS);
   }
   if (VectorCV) {
     memset (VectorCV, 0, size * sizeof (nr_complex_t));
   } else {
     VectorCV = new nr_complex_t[size];
+    profile::count (PROFILE_ALLOCATIONS);
   }
   if (VectorGV) {
     memset (VectorGV, 0, size * sizeof (nr_complex_t));
   } else {
     VectorGV = new nr_complex_t[size];
+    profile::count (PROFILE_ALLOCATIONS);
+  }
+}
+
+/* Evaluates the HB model at all the time samples of the given stamps.
+   By default the node voltages of each sample are applied one after
+   the other and the stamps of calcHB() per sample are collected. */
+void circuit::calcHB (hbstamps & s) {
+  int r, c, n = s.getSamples ();
+  for (int f = 0; f < n; f++) {
+    nr_double_t * v = s.v (f), * y = s.y (f), * qv = s.qv (f);
+    for (r = 0; r < size; r++) setV (r, v[r]);
+    calcHB (f);
+    for (r = 0; r < size; r++) {
+      s.i (f)[r] = real (getI (r));
+      s.q (f)[r] = real (getQ (r));
+      s.gv (f)[r] = real (getGV (r));
+      s.cv (f)[r] = real (getCV (r));
+      for (c = 0; c < size; c++) {
+	y[r * size + c] = real (getY (r, c));
+	qv[r * size + c] = real (getQV (r, c));
+      }
+    }
   }
 }
 
@@ -256,6 +314,7 @@ void circuit::allocMatrixS (void) {
     memset (MatrixS, 0, size * size * sizeof (nr_complex_t));
   } else {
     MatrixS = new nr_complex_t[size * size];
+    profile::count (PROFILE_ALLOCATIONS);
   }
 }
 
@@ -264,25 +323,101 @@ void circuit::allocMatrixN (int sources) {
   nsources = sources;
   delete[] MatrixN;
   MatrixN = new nr_complex_t[(size + sources) * (size + sources)];
+  profile::count (PROFILE_ALLOCATIONS);
 }
 
 /* Allocates the matrix memory for the MNA matrices. */
 void circuit::allocMatrixMNA (void) {
   freeMatrixMNA ();
+  mnaSources = vsources;
   if (size > 0) {
-    MatrixY = new nr_complex_t[size * size];
-    VectorI = new nr_complex_t[size];
-    VectorV = new nr_complex_t[size];
+    MatrixY = newMNA (size * size);
+    VectorI = newMNA (size);
+    VectorV = newMNA (size);
     if (vsources > 0) {
-      MatrixB = new nr_complex_t[vsources * size];
-      MatrixC = new nr_complex_t[vsources * size];
-      MatrixD = new nr_complex_t[vsources * vsources];
-      VectorE = new nr_complex_t[vsources];
-      VectorJ = new nr_complex_t[vsources];
+      MatrixB = newMNA (vsources * size);
+      MatrixC = newMNA (vsources * size);
+      MatrixD = newMNA (vsources * vsources);
+      VectorE = newMNA (vsources);
+      VectorJ = newMNA (vsources);
     }
   }
 }
 
+/* The MNA stamps are kept as real values or as interleaved real and
+   imaginary parts of complex values.  These helpers return the number
+   of bytes of the given number of stamps, allocate them cleared and
+   access a single stamp. */
+std::size_t circuit::sizeMNA (int n) const {
+  return n * (realMNA ? sizeof (nr_double_t) : sizeof (nr_complex_t));
+}
+
+nr_double_t * circuit::newMNA (int n) const {
+  profile::count (PROFILE_ALLOCATIONS);
+  return new nr_double_t[realMNA ? n : 2 * n] ();
+}
+
+inline nr_complex_t circuit::getMNA (const nr_double_t * p, int i) const {
+  if (realMNA) return p[i];
+  return nr_complex_t (p[2 * i], p[2 * i + 1]);
+}
+
+inline void circuit::setMNA (nr_double_t * p, int i, nr_complex_t z) {
+  if (realMNA) {
+    p[i] = real (z);
+  } else {
+    p[2 * i] = real (z);
+    p[2 * i + 1] = imag (z);
+  }
+}
+
+inline void circuit::addMNA (nr_double_t * p, int i, nr_complex_t z) {
+  if (realMNA) {
+    p[i] += real (z);
+  } else {
+    p[2 * i] += real (z);
+    p[2 * i + 1] += imag (z);
+  }
+}
+
+/* Converts the given MNA stamps into the given precision.  Imaginary
+   parts are dropped when converting into real precision. */
+static void convertMNA (nr_double_t *& p, int n, bool r) {
+  if (p == NULL) return;
+  nr_double_t * q;
+  if (r) {
+    q = new nr_double_t[n];
+    for (int i = 0; i < n; i++) q[i] = p[2 * i];
+  } else {
+    q = new nr_double_t[2 * n];
+    for (int i = 0; i < n; i++) {
+      q[2 * i] = p[i];
+      q[2 * i + 1] = 0.0;
+    }
+  }
+  delete[] p;
+  p = q;
+}
+
+/* The function selects whether the MNA stamps are kept in real
+   precision, which the purely real DC and transient analyses require
+   only, or in complex precision.  Present stamps are converted. */
+void circuit::setRealMNA (bool r) {
+  if (r == realMNA) return;
+  int v = mnaSources;
+  convertMNA (MatrixY, size * size, r);
+  convertMNA (VectorI, size, r);
+  convertMNA (VectorV, size, r);
+  convertMNA (MatrixB, v * size, r);
+  convertMNA (MatrixC, v * size, r);
+  convertMNA (MatrixD, v * v, r);
+  convertMNA (VectorE, v, r);
+  convertMNA (VectorJ, v, r);
+  delete[] bypassYI; bypassYI = NULL;
+  bypassValid = false;
+  realMNA = r;
+}
+
 /* Free()'s all memory used by the MNA matrices. */
 void circuit::freeMatrixMNA (void) {
   if (MatrixY) { delete[] MatrixY; MatrixY = NULL; }
@@ -293,6 +428,10 @@ void circuit::freeMatrixMNA (void) {
   if (VectorI) { delete[] VectorI; VectorI = NULL; }
   if (VectorV) { delete[] VectorV; VectorV = NULL; }
   if (VectorJ) { delete[] VectorJ; VectorJ = NULL; }
+  if (bypassV) { delete[] bypassV; bypassV = NULL; }
+  if (bypassYI) { delete[] bypassYI; bypassYI = NULL; }
+  bypassValid = false;
+  bypassN = 0;
 }
 
 /* This function sets the name and port number of one of the circuit's
@@ -343,72 +482,72 @@ void circuit::setSubstrate (substrate * s) {
 /* Returns the circuits B-MNA matrix value of the given voltage source
    built in the circuit depending on the port number. */
 nr_complex_t circuit::getB (int port, int nr) {
-  return MatrixB[(nr - vsource) * size + port];
+  return getMNA (MatrixB, (nr - vsource) * size + port);
 }
 
 /* Sets the circuits B-MNA matrix value of the given voltage source
    built in the circuit depending on the port number. */
 void circuit::setB (int port, int nr, nr_complex_t z) {
-  MatrixB[nr * size + port] = z;
+  setMNA (MatrixB, nr * size + port, z);
 }
 
 /* Returns the circuits C-MNA matrix value of the given voltage source
    built in the circuit depending on the port number. */
 nr_complex_t circuit::getC (int nr, int port) {
-  return MatrixC[(nr - vsource) * size + port];
+  return getMNA (MatrixC, (nr - vsource) * size + port);
 }
 
 /* Sets the circuits C-MNA matrix value of the given voltage source
    built in the circuit depending on the port number. */
 void circuit::setC (int nr, int port, nr_complex_t z) {
-  MatrixC[nr * size + port] = z;
+  setMNA (MatrixC, nr * size + port, z);
 }
 
 /* Returns the circuits D-MNA matrix value of the given voltage source
    built in the circuit. */
 nr_complex_t circuit::getD (int r, int c) {
-  return MatrixD[(r - vsource) * vsources + c - vsource];
+  return getMNA (MatrixD, (r - vsource) * vsources + c - vsource);
 }
 
 /* Sets the circuits D-MNA matrix value of the given voltage source
    built in the circuit. */
 void circuit::setD (int r, int c, nr_complex_t z) {
-  MatrixD[r * vsources + c] = z;
+  setMNA (MatrixD, r * vsources + c, z);
 }
 
 /* Returns the circuits E-MNA matrix value of the given voltage source
    built in the circuit. */
 nr_complex_t circuit::getE (int nr) {
-  return VectorE[nr - vsource];
+  return getMNA (VectorE, nr - vsource);
 }
 
 /* Sets the circuits E-MNA matrix value of the given voltage source
    built in the circuit. */
 void circuit::setE (int nr, nr_complex_t z) {
-  VectorE[nr] = z;
+  setMNA (VectorE, nr, z);
 }
 
 /* Returns the circuits I-MNA matrix value of the current source built
    in the circuit. */
 nr_complex_t circuit::getI (int port) {
-  return VectorI[port];
+  return getMNA (VectorI, port);
 }
 
 /* Sets the circuits I-MNA matrix value of the current source built in
    the circuit depending on the port number. */
 void circuit::setI (int port, nr_complex_t z) {
-  VectorI[port] = z;
+  setMNA (VectorI, port, z);
 }
 
 /* Modifies the circuits I-MNA matrix value of the current source
    built in the circuit depending on the port number. */
 void circuit::addI (int port, nr_complex_t i) {
-  VectorI[port] += i;
+  addMNA (VectorI, port, i);
 }
 
 /* Same as above with different argument type. */
 void circuit::addI (int port, nr_double_t i) {
-  VectorI[port] += i;
+  addMNA (VectorI, port, i);
 }
 
 /* Returns the circuits Q-HB vector value. */
@@ -424,58 +563,58 @@ void circuit::setQ (int port, nr_complex_t q) {
 /* Returns the circuits J-MNA matrix value of the given voltage source
    built in the circuit. */
 nr_complex_t circuit::getJ (int nr) {
-  return VectorJ[nr];
+  return getMNA (VectorJ, nr);
 }
 
 /* Sets the circuits J-MNA matrix value of the given voltage source
    built in the circuit. */
 void circuit::setJ (int nr, nr_complex_t z) {
-  VectorJ[nr - vsource] = z;
+  setMNA (VectorJ, nr - vsource, z);
 }
 
 // Returns the circuits voltage value at the given port.
 nr_complex_t circuit::getV (int port) {
-  return VectorV[port];
+  return getMNA (VectorV, port);
 }
 
 // Sets the circuits voltage value at the given port.
 void circuit::setV (int port, nr_complex_t z) {
-  VectorV[port] = z;
+  setMNA (VectorV, port, z);
 }
 
 /* Returns the circuits G-MNA matrix value depending on the port
    numbers. */
 nr_complex_t circuit::getY (int r, int c) {
-  return MatrixY[r * size + c];
+  return getMNA (MatrixY, r * size + c);
 }
 
 /* Sets the circuits G-MNA matrix value depending on the port
    numbers. */
 void circuit::setY (int r, int c, nr_complex_t y) {
-  MatrixY[r * size + c] = y;
+  setMNA (MatrixY, r * size + c, y);
 }
 
 /* Modifies the circuits G-MNA matrix value depending on the port
    numbers. */
 void circuit::addY (int r, int c, nr_complex_t y) {
-  MatrixY[r * size + c] += y;
+  addMNA (MatrixY, r * size + c, y);
 }
 
 /* Same as above with different argument type. */
 void circuit::addY (int r, int c, nr_double_t y) {
-  MatrixY[r * size + c] += y;
+  addMNA (MatrixY, r * size + c, y);
 }
 
 /* Returns the circuits G-MNA matrix value depending on the port
    numbers. */
 nr_double_t circuit::getG (int r, int c) {
-  return real (MatrixY[r * size + c]);
+  return realMNA ? MatrixY[r * size + c] : MatrixY[2 * (r * size + c)];
 }
 
 /* Sets the circuits G-MNA matrix value depending on the port
    numbers. */
 void circuit::setG (int r, int c, nr_double_t y) {
-  MatrixY[r * size + c] = y;
+  setMNA (MatrixY, r * size + c, y);
 }
 
 /* Returns the circuits C-HB matrix value depending on the port
@@ -641,7 +780,7 @@ void circuit::setInternalNode (int node, const std::string &suffix) {
 
 /* This function copies the matrix elements inside the given matrix to
    the internal S-parameter matrix of the circuit. */
-void circuit::setMatrixS (matrix s) {
+void circuit::setMatrixS (const matrix & s) {
   int r = s.getRows ();
   int c = s.getCols ();
   // copy matrix elements
@@ -662,7 +801,7 @@ matrix circuit::getMatrixS (void) {
 
 /* This function copies the matrix elements inside the given matrix to
    the internal noise correlation matrix of the circuit. */
-void circuit::setMatrixN (matrix n) {
+void circuit::setMatrixN (const matrix & n) {
   int r = n.getRows ();
   int c = n.getCols ();
   // copy matrix elements
@@ -683,12 +822,12 @@ matrix circuit::getMatrixN (void) {
 
 /* This function copies the matrix elements inside the given matrix to
    the internal G-MNA matrix of the circuit. */
-void circuit::setMatrixY (matrix y) {
+void circuit::setMatrixY (const matrix & y) {
   int r = y.getRows ();
   int c = y.getCols ();
   // copy matrix elements
   if (r > 0 && c > 0 && r * c == size * size) {
-    memcpy (MatrixY, y.getData (), sizeof (nr_complex_t) * r * c);
+    for (int i = 0; i < r * c; i++) setMNA (MatrixY, i, y.getData ()[i]);
   }
 }
 
@@ -698,48 +837,98 @@ matrix circuit::getMatrixY (void) {
   matrix res (size);
   for(unsigned int i=0; i < size; ++i)
     for(unsigned int j=0; j < size; ++j)
-      res(i,j) = MatrixY[i*size + j];
+      res(i,j) = getMNA (MatrixY, i*size + j);
   return res;
 }
 
+/* The function enables (positive relative tolerance) or disables the
+   bypass of unchanged non-linear device evaluations and resets the
+   bypass statistics.  A device evaluation is bypassed if each of its
+   controlling voltages changed less than the given tolerances since
+   the last full evaluation. */
+void circuit::setBypass (nr_double_t reltol, nr_double_t vntol) {
+  bypassRel = std::max (reltol, 0.0);
+  bypassAbs = vntol;
+  bypassValid = false;
+  bypassCalls = bypassHits = 0;
+}
+
+/* Non-linear devices call this function with their controlling
+   voltages before evaluating the model.  If the voltages are close
+   enough to those of the last evaluation the stamps saved by
+   saveBypass() are put back into the G-MNA matrix and the I-vector
+   and the function returns true, i.e. the device can skip the model
+   evaluation. */
+bool circuit::checkBypass (nr_double_t * v, int n) {
+  if (bypassRel <= 0) return false;
+  bypassCalls++;
+  if (!bypassValid || n != bypassN) return false;
+  for (int i = 0; i < n; i++) {
+    nr_double_t tol = bypassAbs +
+      bypassRel * std::max (std::fabs (v[i]), std::fabs (bypassV[i]));
+    if (std::fabs (v[i] - bypassV[i]) > tol) return false;
+  }
+  memcpy (MatrixY, bypassYI, sizeMNA (size * size));
+  memcpy (VectorI, (char *) bypassYI + sizeMNA (size * size), sizeMNA (size));
+  bypassHits++;
+  return true;
+}
+
+/* After a full model evaluation the device passes its (limited)
+   controlling voltages to this function which saves them together
+   with the G-MNA matrix and I-vector stamps for later bypassing. */
+void circuit::saveBypass (nr_double_t * v, int n) {
+  if (bypassRel <= 0) return;
+  if (n != bypassN) {
+    delete[] bypassV;
+    bypassV = new nr_double_t[n];
+    bypassN = n;
+  }
+  if (bypassYI == NULL) bypassYI = newMNA (size * size + size);
+  memcpy (bypassV, v, sizeof (nr_double_t) * n);
+  memcpy (bypassYI, MatrixY, sizeMNA (size * size));
+  memcpy ((char *) bypassYI + sizeMNA (size * size), VectorI, sizeMNA (size));
+  bypassValid = true;
+}
+
 // The function cleans up the B-MNA matrix entries.
 void circuit::clearB (void) {
-  memset (MatrixB, 0, sizeof (nr_complex_t) * size * vsources);
+  memset (MatrixB, 0, sizeMNA (size * vsources));
 }
 
 // The function cleans up the C-MNA matrix entries.
 void circuit::clearC (void) {
-  memset (MatrixC, 0, sizeof (nr_complex_t) * size * vsources);
+  memset (MatrixC, 0, sizeMNA (size * vsources));
 }
 
 // The function cleans up the D-MNA matrix entries.
 void circuit::clearD (void) {
-  memset (MatrixD, 0, sizeof (nr_complex_t) * vsources * vsources);
+  memset (MatrixD, 0, sizeMNA (vsources * vsources));
 }
 
 // The function cleans up the E-MNA matrix entries.
 void circuit::clearE (void) {
-  memset (VectorE, 0, sizeof (nr_complex_t) * vsources);
+  memset (VectorE, 0, sizeMNA (vsources));
 }
 
 // The function cleans up the J-MNA matrix entries.
 void circuit::clearJ (void) {
-  memset (VectorJ, 0, sizeof (nr_complex_t) * vsources);
+  memset (VectorJ, 0, sizeMNA (vsources));
 }
 
 // The function cleans up the I-MNA matrix entries.
 void circuit::clearI (void) {
-  memset (VectorI, 0, sizeof (nr_complex_t) * size);
+  memset (VectorI, 0, sizeMNA (size));
 }
 
 // The function cleans up the V-MNA matrix entries.
 void circuit::clearV (void) {
-  memset (VectorV, 0, sizeof (nr_complex_t) * size);
+  memset (VectorV, 0, sizeMNA (size));
 }
 
 // The function cleans up the G-MNA matrix entries.
 void circuit::clearY (void) {
-  memset (MatrixY, 0, sizeof (nr_complex_t) * size * size);
+  memset (MatrixY, 0, sizeMNA (size * size));
 }
 
 /* This function can be used by several components in order to place
@@ -919,6 +1108,12 @@ int circuit::getHistorySize (void) {
   return histories[0].size ();
 }
 
+// Returns the given value history of the circuit.
+history * circuit::getHistory (int n)
+{
+  return &histories[n];
+}
+
 // Returns the time with the specified index
 nr_double_t circuit::getHistoryTFromIndex (int idx)
 {
@@ -57,9 +57,11 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "integrator.h"
 #include "valuelist.h"
+#include "arena.h"
 
 namespace qucs {
 
@@ -73,6 +75,8 @@ enum circuit_flag {
   CIRCUIT_VARSIZE     = 64,
   CIRCUIT_PROBE       = 128,
   CIRCUIT_HISTORY     = 256,
+  CIRCUIT_PARALLEL    = 512,
+  CIRCUIT_EVALUATED   = 1024,
 };
 
 class node;
@@ -82,6 +86,8 @@ class matrix;
 class net;
 class environment;
 class history;
+class circuitbatch;
+class hbstamps;
 
 /*! \class circuit
  * \brief base class for qucs circuit elements.
@@ -110,6 +116,10 @@ class circuit : public object, public integrator
   circuit (const circuit &);
   virtual ~circuit ();
 
+  // circuits live in the arena of the netlist
+  static void * operator new (std::size_t n) { return arena::allocate (n); }
+  static void operator delete (void * p) { arena::deallocate (p); }
+
   // functionality to be overloaded by real, derived circuit element
   // implementations
   /*! \fn initSP
@@ -137,6 +147,7 @@ class circuit : public object, public integrator
   virtual void calcHB (nr_double_t) { }
   virtual void initHB (int) { allocMatrixMNA (); }
   virtual void calcHB (int) { }
+  virtual void calcHB (hbstamps &);
   virtual void calcOperatingPoints (void) { }
   virtual void saveOperatingPoints (void) { }
   virtual void calcCharacteristics (nr_double_t) { }
@@ -182,6 +193,16 @@ class circuit : public object, public integrator
   void   setVariableSized (bool v) { MODFLAG (v, CIRCUIT_VARSIZE); }
   bool   isProbe (void) { return RETFLAG (CIRCUIT_PROBE); }
   void   setProbe (bool p) { MODFLAG (p, CIRCUIT_PROBE); }
+  /* Circuits whose DC and transient evaluation touches their own data
+     only may be evaluated concurrently with other circuits. */
+  bool   isParallel (void) { return RETFLAG (CIRCUIT_PARALLEL); }
+  void   setParallel (bool p) { MODFLAG (p, CIRCUIT_PARALLEL); }
+  // circuits of the same type may be evaluated by a common batch
+  virtual circuitbatch * createBatch (void) { return NULL; }
+  // D-MNA entries of the given voltage sources which are ever non-zero
+  virtual bool hasD (int, int) { return true; }
+  bool   isEvaluated (void) { return RETFLAG (CIRCUIT_EVALUATED); }
+  void   setEvaluated (bool e) { MODFLAG (e, CIRCUIT_EVALUATED); }
   void   setNet (net * n) { subnet = n; }
   net *  getNet (void) { return subnet; }
 
@@ -198,6 +219,11 @@ class circuit : public object, public integrator
   bool isInternalVoltageSource (void) { return RETFLAG (CIRCUIT_INTVSOURCE); }
   void setVoltageSource (int s) { vsource = s; }
   int  getVoltageSource (void) { return vsource; }
+  /* MNA row of each port assigned by the nodal analyses, ports at the
+     ground node get -1. */
+  void setNodeRow (int port, int r) { nodeRows[port] = r; }
+  int  getNodeRow (int port) { return nodeRows[port]; }
+  const int * getNodeRows (void) { return nodeRows.data (); }
   int  getVoltageSources (void);
   void setVoltageSources (int);
   void voltageSource (int, int, int, nr_double_t value = 0.0);
@@ -236,6 +262,8 @@ class circuit : public object, public integrator
   void setHistoryAge (nr_double_t);
   int getHistorySize (void);
   nr_double_t getHistoryTFromIndex (int);
+  int getHistories (void) { return nHistories; }
+  history * getHistory (int);
 
   // s-parameter helpers
   int  getPort (void) { return pacport; }
@@ -323,13 +351,25 @@ class circuit : public object, public integrator
   void   freeMatrixMNA (void);
   void   allocMatrixHB (void);
   void   freeMatrixHB (void);
-  void   setMatrixS (matrix);
+  void   setMatrixS (const matrix &);
   matrix getMatrixS (void);
-  void   setMatrixN (matrix);
+  void   setMatrixN (const matrix &);
   matrix getMatrixN (void);
-  void   setMatrixY (matrix);
+  void   setMatrixY (const matrix &);
   matrix getMatrixY (void);
 
+  // precision of the MNA stamps, real ones suffice for DC and transient
+  void setRealMNA (bool);
+  bool isRealMNA (void) { return realMNA; }
+
+  // bypass of unchanged non-linear device evaluations
+  void setBypass (nr_double_t, nr_double_t);
+  void resetBypass (void) { bypassValid = false; }
+  bool checkBypass (nr_double_t *, int);
+  void saveBypass (nr_double_t *, int);
+  int  getBypassCalls (void) { return bypassCalls; }
+  int  getBypassHits (void) { return bypassHits; }
+
   static const nr_double_t z0;
 
  protected:
@@ -346,20 +386,24 @@ class circuit : public object, public integrator
   int flag;
   nr_complex_t * MatrixS;
   nr_complex_t * MatrixN;
-  nr_complex_t * MatrixY;
-  nr_complex_t * MatrixB;
-  nr_complex_t * MatrixC;
-  nr_complex_t * MatrixD;
-  nr_complex_t * VectorE;
-  nr_complex_t * VectorI;
-  nr_complex_t * VectorV;
-  nr_complex_t * VectorJ;
+  // MNA stamps, either real or interleaved complex values
+  bool realMNA;
+  int mnaSources;
+  nr_double_t * MatrixY;
+  nr_double_t * MatrixB;
+  nr_double_t * MatrixC;
+  nr_double_t * MatrixD;
+  nr_double_t * VectorE;
+  nr_double_t * VectorI;
+  nr_double_t * VectorV;
+  nr_double_t * VectorJ;
   nr_complex_t * VectorQ;
   nr_complex_t * MatrixQV;
   nr_complex_t * VectorGV;
   nr_complex_t * VectorCV;
   std::string subcircuit;
   node * nodes;
+  std::vector<int> nodeRows;
   substrate * subst;
   valuelist<operatingpoint> oper;
   valuelist<characteristic> charac;
@@ -368,6 +412,21 @@ class circuit : public object, public integrator
   nr_double_t * deltas;
   int nHistories;
   history * histories;
+  nr_double_t bypassRel;
+  nr_double_t bypassAbs;
+  bool bypassValid;
+  int bypassCalls;
+  int bypassHits;
+  int bypassN;
+  nr_double_t * bypassV;
+  nr_double_t * bypassYI;
+
+ private:
+  nr_complex_t getMNA (const nr_double_t *, int) const;
+  void setMNA (nr_double_t *, int, nr_complex_t);
+  void addMNA (nr_double_t *, int, nr_complex_t);
+  nr_double_t * newMNA (int) const;
+  std::size_t sizeMNA (int) const;
 };
 
 } // namespace qucs
@@ -0,0 +1,67 @@
+/*
+ * circuitbatch.h - batched circuit evaluation class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __CIRCUITBATCH_H__
+#define __CIRCUITBATCH_H__
+
+#include <vector>
+
+namespace qucs {
+
+class circuit;
+
+/*! \class circuitbatch
+ * \brief base class for the batched evaluation of circuits of one type.
+ *
+ * Circuits of the same type can provide a batch which evaluates the
+ * DC model of many instances at once.  The batch keeps the cached
+ * model parameters and the node voltages of its instances in
+ * structure-of-arrays form such that the model equations are
+ * evaluated by loops the compiler can vectorize.  Each evaluated
+ * circuit is marked, its next calcDC() call then returns at once.
+ */
+class circuitbatch
+{
+ public:
+  circuitbatch () { }
+  virtual ~circuitbatch () { }
+  void add (circuit * c) { circuits.push_back (c); }
+  int size (void) const { return circuits.size (); }
+  circuit * get (int i) const { return circuits[i]; }
+
+  /* Allocates the arrays and caches the model parameters once all
+     circuits have been added and initialized. */
+  virtual void prepare (void) = 0;
+
+  /* Evaluates the DC model of the circuits first to last - 1.
+     Different ranges may be evaluated concurrently. */
+  virtual void calcDC (int first, int last) = 0;
+
+ protected:
+  std::vector<circuit *> circuits;
+};
+
+} // namespace qucs
+
+#endif /* __CIRCUITBATCH_H__ */
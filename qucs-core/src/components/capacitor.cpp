@@ -101,6 +101,7 @@ void capacitor::initAC (void) {
 
 void capacitor::initTR (void) {
   setStates (2);
+  setParallel (!hasProperty ("Controlled"));
   initDC ();
 }
 
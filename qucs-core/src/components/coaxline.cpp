@@ -167,6 +167,46 @@ void coaxline::calcNoiseAC (nr_double_t) {
   setMatrixN (4 * celsius2kelvin (T) / T0 * real (getMatrixY ()));
 }
 
+/* The transient analysis uses the method of characteristics with the
+   propagation function fitted to the frequency domain model of the
+   line below its cutoff frequency. */
+void coaxline::initTR (void) {
+  nr_double_t l   = getPropertyDouble ("L");
+  nr_double_t d   = getPropertyDouble ("d");
+  nr_double_t rho = getPropertyDouble ("rho");
+  line = mocline ();
+  deleteHistory ();
+  if (l == 0.0) {
+    initDC ();
+    return;
+  }
+  initCheck ();
+  std::vector<nr_double_t> freq =
+    mocline::frequencies (std::min (fc, (nr_double_t) MOCLINE_FMAX));
+  std::vector<nr_complex_t> yc, gamma;
+  for (nr_double_t f : freq) {
+    calcPropagation (f);
+    yc.push_back (1.0 / zl);
+    gamma.push_back (nr_complex_t (alpha, beta));
+  }
+  nr_double_t rdc = d != 0.0 ? rho * l / pi / sqr (d / 2) : 0;
+  int m = line.addMode (rdc);
+  line.addNode (m, 0, NODE_1, 1, 1);
+  line.addNode (m, 1, NODE_2, 1, 1);
+  if (line.fitMode (m, l, freq, yc, gamma)) {
+    logprint (LOG_ERROR, "WARNING: Cannot fit the transient model of `%s', "
+	      "using its DC model\n", getName ());
+    line = mocline ();
+    initDC ();
+    return;
+  }
+  line.initTR (this);
+}
+
+void coaxline::calcTR (nr_double_t t) {
+  if (line.getModes ()) line.calcTR (this, t);
+}
+
 // properties
 PROP_REQ [] = {
   { "D", PROP_REAL, { 2.95e-3, PROP_NO_STR }, PROP_POS_RANGEX },
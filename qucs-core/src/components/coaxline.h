@@ -25,6 +25,8 @@
 #ifndef __COAXLINE_H__
 #define __COAXLINE_H__
 
+#include "mocline.h"
+
 class coaxline : public qucs::circuit
 {
  public:
@@ -36,12 +38,15 @@ class coaxline : public qucs::circuit
   void initAC (void);
   void calcAC (nr_double_t);
   void calcNoiseAC (nr_double_t);
+  void initTR (void);
+  void calcTR (nr_double_t);
   void saveCharacteristics (nr_double_t);
 
  private:
   void calcPropagation (nr_double_t);
   void initCheck (void);
   nr_double_t alpha, beta, zl, fc;
+  mocline line;
 };
 
 #endif /* __COAXLINE_H__ */
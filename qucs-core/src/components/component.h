@@ -41,6 +41,8 @@
 #include "node.h"
 #include "net.h"
 #include "circuit.h"
+#include "circuitbatch.h"
+#include "hbstamps.h"
 #include "component_id.h"
 #include "constants.h"
 #include "netdefs.h"
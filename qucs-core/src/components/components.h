@@ -32,6 +32,8 @@
 #include "object.h"
 #include "node.h"
 #include "circuit.h"
+#include "circuitbatch.h"
+#include "hbstamps.h"
 #include "component_id.h"
 #include "ground.h"
 #include "open.h"
@@ -39,6 +41,7 @@
 #include "tee.h"
 #include "cross.h"
 #include "itrafo.h"
+#include "romodel.h"
 
 #include "resistor.h"
 #include "capacitor.h"
@@ -138,6 +138,37 @@ void ctline::calcAC (nr_double_t frequency) {
   }
 }
 
+/* The transient analysis uses the method of characteristics for the
+   even and odd mode.  Both are dispersionless, the line model needs
+   no fit therefore. */
+void ctline::initTR (void) {
+  nr_double_t l   = getPropertyDouble ("L");
+  nr_double_t ze  = getPropertyDouble ("Ze");
+  nr_double_t zo  = getPropertyDouble ("Zo");
+  nr_double_t ere = getPropertyDouble ("Ere");
+  nr_double_t ero = getPropertyDouble ("Ero");
+  nr_double_t ae  = getPropertyDouble ("Ae");
+  nr_double_t ao  = getPropertyDouble ("Ao");
+  line = mocline ();
+  deleteHistory ();
+  if (l == 0.0) {
+    initDC ();
+    return;
+  }
+  int e = line.addMode (0), o = line.addMode (0);
+  line.setMode (e, l * std::sqrt (ere) / C0, 1 / ze, std::exp (-std::log (ae) / 2 * l));
+  line.setMode (o, l * std::sqrt (ero) / C0, 1 / zo, std::exp (-std::log (ao) / 2 * l));
+  line.addNode (e, 0, NODE_1, 0.5, +1); line.addNode (e, 0, NODE_4, +0.5, +1);
+  line.addNode (e, 1, NODE_2, 0.5, +1); line.addNode (e, 1, NODE_3, +0.5, +1);
+  line.addNode (o, 0, NODE_1, 0.5, +1); line.addNode (o, 0, NODE_4, -0.5, -1);
+  line.addNode (o, 1, NODE_2, 0.5, +1); line.addNode (o, 1, NODE_3, -0.5, -1);
+  line.initTR (this);
+}
+
+void ctline::calcTR (nr_double_t t) {
+  if (line.getModes ()) line.calcTR (this, t);
+}
+
 // properties
 PROP_REQ [] = {
   { "Ze", PROP_REAL, { 50, PROP_NO_STR }, PROP_POS_RANGE },
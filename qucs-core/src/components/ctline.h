@@ -25,6 +25,8 @@
 #ifndef __CTLINE_H__
 #define __CTLINE_H__
 
+#include "mocline.h"
+
 class ctline : public qucs::circuit
 {
  public:
@@ -35,6 +37,11 @@ class ctline : public qucs::circuit
   void calcAC (nr_double_t);
   void calcNoiseAC (nr_double_t);
   void calcNoiseSP (nr_double_t);
+  void initTR (void);
+  void calcTR (nr_double_t);
+
+ private:
+  mocline line;
 };
 
 #endif /* __CTLINE_H__ */
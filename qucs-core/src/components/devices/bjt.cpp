@@ -40,9 +40,17 @@
 using namespace qucs;
 using namespace qucs::device;
 
-bjt::bjt () : circuit (4) {
+bjt::bjt () : circuit (4),
+  pPtf ("Ptf"), pTf ("Tf"), pIs ("Is"), pNf ("Nf"), pNr ("Nr"),
+  pVaf ("Vaf"), pVar ("Var"), pIkf ("Ikf"), pIkr ("Ikr"), pBf ("Bf"),
+  pBr ("Br"), pIse ("Ise"), pIsc ("Isc"), pNe ("Ne"), pNc ("Nc"),
+  pRb ("Rb"), pRbm ("Rbm"), pIrb ("Irb"), pTemp ("Temp"), pCje ("Cje"),
+  pVje ("Vje"), pMje ("Mje"), pCjc ("Cjc"), pVjc ("Vjc"), pMjc ("Mjc"),
+  pXcjc ("Xcjc"), pCjs ("Cjs"), pVjs ("Vjs"), pMjs ("Mjs"), pFc ("Fc"),
+  pVtf ("Vtf"), pXtf ("Xtf"), pItf ("Itf"), pTr ("Tr") {
   cbcx = rb = re = rc = NULL;
   type = CIR_BJT;
+  setParallel (true);
 }
 
 void bjt::calcSP (nr_double_t frequency) {
@@ -162,58 +170,91 @@ matrix bjt::calcMatrixCy (nr_double_t frequency) {
   return cy;
 }
 
+// The model properties the temperature scaled BJT parameters depend on.
+static const char * const bjtCard[] = {
+  "Temp", "Tnom", "Is", "Xti", "Eg", "Vje", "Vjc", "Vjs", "Bf", "Br", "Xtb",
+  "Ise", "Isc", "Ne", "Nc", "Cje", "Cjc", "Cjs", "Mje", "Mjc", "Mjs", NULL };
+
 void bjt::initModel (void) {
   // fetch necessary device properties
-  nr_double_t T  = getPropertyDouble ("Temp");
-  nr_double_t Tn = getPropertyDouble ("Tnom");
   nr_double_t A  = getPropertyDouble ("Area");
 
-  // compute Is temperature and area dependency
-  nr_double_t Is  = getPropertyDouble ("Is");
-  nr_double_t Xti = getPropertyDouble ("Xti");
-  nr_double_t Eg  = getPropertyDouble ("Eg");
-  nr_double_t T1, T2, IsT;
-  T2 = celsius2kelvin (T);
-  T1 = celsius2kelvin (Tn);
-  IsT = pnCurrent_T (T1, T2, Is, Eg, 1, Xti);
-  setScaledProperty ("Is", IsT * A);
-
-  // compute Vje, Vjc and Vjs temperature dependencies
-  nr_double_t Vje = getPropertyDouble ("Vje");
-  nr_double_t Vjc = getPropertyDouble ("Vjc");
-  nr_double_t Vjs = getPropertyDouble ("Vjs");
-  nr_double_t VjeT, VjcT, VjsT;
-  VjeT = pnPotential_T (T1,T2, Vje);
-  VjcT = pnPotential_T (T1,T2, Vjc);
-  VjsT = pnPotential_T (T1,T2, Vjs);
-  setScaledProperty ("Vje", VjeT);
-  setScaledProperty ("Vjc", VjcT);
-  setScaledProperty ("Vjs", VjsT);
-
-  // compute Bf and Br temperature dependencies
-  nr_double_t Bf  = getPropertyDouble ("Bf");
-  nr_double_t Br  = getPropertyDouble ("Br");
-  nr_double_t Xtb = getPropertyDouble ("Xtb");
-  nr_double_t F = qucs::exp (Xtb * qucs::log (T2 / T1));
-  setScaledProperty ("Bf", Bf * F);
-  setScaledProperty ("Br", Br * F);
-
-  // compute Ise and Isc temperature and area dependencies
-  nr_double_t Ise = getPropertyDouble ("Ise");
-  nr_double_t Isc = getPropertyDouble ("Isc");
-  nr_double_t Ne  = getPropertyDouble ("Ne");
-  nr_double_t Nc  = getPropertyDouble ("Nc");
-  nr_double_t G = qucs::log (IsT / Is);
-  nr_double_t F1 = qucs::exp (G / Ne);
-  nr_double_t F2 = qucs::exp (G / Nc);
-  Ise = Ise / F * F1;
-  Isc = Isc / F * F2;
-  setScaledProperty ("Ise", Ise * A);
-  setScaledProperty ("Isc", Isc * A);
+  // the temperature dependencies are computed once per model card
+  std::vector<nr_double_t> card = modelCard (this, bjtCard);
+  nr_double_t p[11];
+  if (!modelCardLookup (card, p, 11)) {
+    nr_double_t T  = getPropertyDouble ("Temp");
+    nr_double_t Tn = getPropertyDouble ("Tnom");
+
+    // compute Is temperature dependency
+    nr_double_t Is  = getPropertyDouble ("Is");
+    nr_double_t Xti = getPropertyDouble ("Xti");
+    nr_double_t Eg  = getPropertyDouble ("Eg");
+    nr_double_t T1, T2, IsT;
+    T2 = celsius2kelvin (T);
+    T1 = celsius2kelvin (Tn);
+    IsT = pnCurrent_T (T1, T2, Is, Eg, 1, Xti);
+    p[0] = IsT;
+
+    // compute Vje, Vjc and Vjs temperature dependencies
+    nr_double_t Vje = getPropertyDouble ("Vje");
+    nr_double_t Vjc = getPropertyDouble ("Vjc");
+    nr_double_t Vjs = getPropertyDouble ("Vjs");
+    nr_double_t VjeT, VjcT, VjsT;
+    p[1] = VjeT = pnPotential_T (T1,T2, Vje);
+    p[2] = VjcT = pnPotential_T (T1,T2, Vjc);
+    p[3] = VjsT = pnPotential_T (T1,T2, Vjs);
+
+    // compute Bf and Br temperature dependencies
+    nr_double_t Bf  = getPropertyDouble ("Bf");
+    nr_double_t Br  = getPropertyDouble ("Br");
+    nr_double_t Xtb = getPropertyDouble ("Xtb");
+    nr_double_t F = qucs::exp (Xtb * qucs::log (T2 / T1));
+    p[4] = Bf * F;
+    p[5] = Br * F;
+
+    // compute Ise and Isc temperature dependencies
+    nr_double_t Ise = getPropertyDouble ("Ise");
+    nr_double_t Isc = getPropertyDouble ("Isc");
+    nr_double_t Ne  = getPropertyDouble ("Ne");
+    nr_double_t Nc  = getPropertyDouble ("Nc");
+    nr_double_t G = qucs::log (IsT / Is);
+    nr_double_t F1 = qucs::exp (G / Ne);
+    nr_double_t F2 = qucs::exp (G / Nc);
+    p[6] = Ise / F * F1;
+    p[7] = Isc / F * F2;
+
+    // compute Cje, Cjc and Cjs temperature dependencies
+    nr_double_t Cje = getPropertyDouble ("Cje");
+    nr_double_t Cjc = getPropertyDouble ("Cjc");
+    nr_double_t Cjs = getPropertyDouble ("Cjs");
+    nr_double_t Mje = getPropertyDouble ("Mje");
+    nr_double_t Mjc = getPropertyDouble ("Mjc");
+    nr_double_t Mjs = getPropertyDouble ("Mjs");
+    p[8]  = pnCapacitance_T (T1, T2, Mje, VjeT / Vje, Cje);
+    p[9]  = pnCapacitance_T (T1, T2, Mjc, VjcT / Vjc, Cjc);
+    p[10] = pnCapacitance_T (T1, T2, Mjs, VjsT / Vjs, Cjs);
+    modelCardStore (card, p, 11);
+  }
+
+  // apply the area dependencies
+  setScaledProperty ("Is", p[0] * A);
+  setScaledProperty ("Vje", p[1]);
+  setScaledProperty ("Vjc", p[2]);
+  setScaledProperty ("Vjs", p[3]);
+  setScaledProperty ("Bf", p[4]);
+  setScaledProperty ("Br", p[5]);
+  setScaledProperty ("Ise", p[6] * A);
+  setScaledProperty ("Isc", p[7] * A);
+  setScaledProperty ("Cje", p[8] * A);
+  setScaledProperty ("Cjc", p[9] * A);
+  setScaledProperty ("Cjs", p[10] * A);
 
   // check unphysical parameters
   nr_double_t Nf = getPropertyDouble ("Nf");
   nr_double_t Nr = getPropertyDouble ("Nr");
+  nr_double_t Ne = getPropertyDouble ("Ne");
+  nr_double_t Nc = getPropertyDouble ("Nc");
   if (Nf < 1.0) {
     logprint (LOG_ERROR, "WARNING: Unphysical model parameter Nf = %g in "
 	      "BJT `%s'\n", Nf, getName ());
@@ -241,20 +282,6 @@ void bjt::initModel (void) {
 	      "BJT `%s'\n", Vtf, getName ());
   }
 
-  // compute Cje, Cjc and Cjs temperature and area dependencies
-  nr_double_t Cje = getPropertyDouble ("Cje");
-  nr_double_t Cjc = getPropertyDouble ("Cjc");
-  nr_double_t Cjs = getPropertyDouble ("Cjs");
-  nr_double_t Mje = getPropertyDouble ("Mje");
-  nr_double_t Mjc = getPropertyDouble ("Mjc");
-  nr_double_t Mjs = getPropertyDouble ("Mjs");
-  Cje = pnCapacitance_T (T1, T2, Mje, VjeT / Vje, Cje);
-  Cjc = pnCapacitance_T (T1, T2, Mjc, VjcT / Vjc, Cjc);
-  Cjs = pnCapacitance_T (T1, T2, Mjs, VjsT / Vjs, Cjs);
-  setScaledProperty ("Cje", Cje * A);
-  setScaledProperty ("Cjc", Cjc * A);
-  setScaledProperty ("Cjs", Cjs * A);
-
   // compute Rb, Rc, Re and Rbm area dependencies
   nr_double_t Rb  = getPropertyDouble ("Rb");
   nr_double_t Re  = getPropertyDouble ("Re");
@@ -362,94 +389,41 @@ void bjt::restartDC (void) {
 
 #define cexState 6 // extra excess phase state
 
-void bjt::calcDC (void) {
-
-  // fetch device model parameters
-  nr_double_t Is   = getScaledProperty ("Is");
-  nr_double_t Nf   = getPropertyDouble ("Nf");
-  nr_double_t Nr   = getPropertyDouble ("Nr");
-  nr_double_t Vaf  = getPropertyDouble ("Vaf");
-  nr_double_t Var  = getPropertyDouble ("Var");
-  nr_double_t Ikf  = getScaledProperty ("Ikf");
-  nr_double_t Ikr  = getScaledProperty ("Ikr");
-  nr_double_t Bf   = getScaledProperty ("Bf");
-  nr_double_t Br   = getScaledProperty ("Br");
-  nr_double_t Ise  = getScaledProperty ("Ise");
-  nr_double_t Isc  = getScaledProperty ("Isc");
-  nr_double_t Ne   = getPropertyDouble ("Ne");
-  nr_double_t Nc   = getPropertyDouble ("Nc");
-  nr_double_t Rb   = getScaledProperty ("Rb");
-  nr_double_t Rbm  = getScaledProperty ("Rbm");
-  nr_double_t Irb  = getScaledProperty ("Irb");
-  nr_double_t T    = getPropertyDouble ("Temp");
-
-  nr_double_t Ut, Q1, Q2;
-  nr_double_t Iben, Ibcn, Ibei, Ibci, Ibc, gbe, gbc, gtiny;
-  nr_double_t IeqB, IeqC, IeqE, IeqS, UbeCrit, UbcCrit;
-  nr_double_t gm, go;
-
-  // interpret zero as infinity for these model parameters
-  Ikf = Ikf > 0 ? 1.0 / Ikf : 0;
-  Ikr = Ikr > 0 ? 1.0 / Ikr : 0;
-  Vaf = Vaf > 0 ? 1.0 / Vaf : 0;
-  Var = Var > 0 ? 1.0 / Var : 0;
-
-  T = celsius2kelvin (T);
-  Ut = T * kBoverQ;
-  Ube = real (getV (NODE_B) - getV (NODE_E)) * pol;
-  Ubc = real (getV (NODE_B) - getV (NODE_C)) * pol;
-
-  // critical voltage necessary for bad start values
-  UbeCrit = pnCriticalVoltage (Is, Nf * Ut);
-  UbcCrit = pnCriticalVoltage (Is, Nr * Ut);
-  UbePrev = Ube = pnVoltage (Ube, UbePrev, Ut * Nf, UbeCrit);
-  UbcPrev = Ubc = pnVoltage (Ubc, UbcPrev, Ut * Nr, UbcCrit);
-
-  Uce = Ube - Ubc;
+/* The function computes the currents and conductances of the base
+   diodes and the base charge for the given (limited) voltages.  The
+   pn-junction currents If, Iben, Ir and Ibcn and their derivatives
+   are passed in, the single instance computes them one by one and the
+   batched model evaluation over the arrays of instances. */
+static inline void bjtJunctions (nr_double_t Ube, nr_double_t Ubc,
+				 nr_double_t Ut, nr_double_t Is,
+				 nr_double_t Nf, nr_double_t Nr,
+				 nr_double_t Ise, nr_double_t Isc,
+				 nr_double_t Bf, nr_double_t Br,
+				 nr_double_t Vaf, nr_double_t Var,
+				 nr_double_t Ikf, nr_double_t Ikr,
+				 nr_double_t If, nr_double_t gif,
+				 nr_double_t& Ibei, nr_double_t& gbei,
+				 nr_double_t& Iben, nr_double_t& gben,
+				 nr_double_t Ir, nr_double_t gir,
+				 nr_double_t& Ibci, nr_double_t& gbci,
+				 nr_double_t& Ibcn, nr_double_t& gbcn,
+				 nr_double_t& Qb, nr_double_t& dQbdUbe,
+				 nr_double_t& dQbdUbc) {
+  nr_double_t gtiny, Q1, Q2;
 
   // base-emitter diodes
   gtiny = Ube < - 10 * Ut * Nf ? (Is + Ise) : 0;
-#if 0
-  If = pnCurrent (Ube, Is, Ut * Nf);
   Ibei = If / Bf;
-  gif = pnConductance (Ube, Is, Ut * Nf);
   gbei = gif / Bf;
-  Iben = pnCurrent (Ube, Ise, Ut * Ne);
-  gben = pnConductance (Ube, Ise, Ut * Ne);
-  Ibe = Ibei + Iben + gtiny * Ube;
-  gbe = gbei + gben + gtiny;
-#else
-  pnJunctionBIP (Ube, Is, Ut * Nf, If, gif);
-  Ibei = If / Bf;
-  gbei = gif / Bf;
-  pnJunctionBIP (Ube, Ise, Ut * Ne, Iben, gben);
   Iben += gtiny * Ube;
   gben += gtiny;
-  Ibe = Ibei + Iben;
-  gbe = gbei + gben;
-#endif
 
   // base-collector diodes
   gtiny = Ubc < - 10 * Ut * Nr ? (Is + Isc) : 0;
-#if 0
-  Ir = pnCurrent (Ubc, Is, Ut * Nr);
-  Ibci = Ir / Br;
-  gir = pnConductance (Ubc, Is, Ut * Nr);
-  gbci = gir / Br;
-  Ibcn = pnCurrent (Ubc, Isc, Ut * Nc);
-  gbcn = pnConductance (Ubc, Isc, Ut * Nc);
-  Ibc = Ibci + Ibcn + gtiny * Ubc;
-  gbc = gbci + gbcn + gtiny;
-#else
-  pnJunctionBIP (Ubc, Is, Ut * Nr, Ir, gir);
   Ibci = Ir / Br;
   gbci = gir / Br;
-  pnJunctionBIP (Ubc, Isc, Ut * Nc, Ibcn, gbcn);
   Ibcn += gtiny * Ubc;
   gbcn += gtiny;
-  Ibc = Ibci + Ibcn;
-  gbc = gbci + gbcn;
-#endif
 
   // compute base charge quantities
   Q1 = 1 / (1 - Ubc * Vaf - Ube * Var);
@@ -459,26 +433,52 @@ void bjt::calcDC (void) {
   Qb = Q1 * (1 + Sqrt) / 2;
   dQbdUbe = Q1 * (Qb * Var + gif * Ikf / Sqrt);
   dQbdUbc = Q1 * (Qb * Vaf + gir * Ikr / Sqrt);
+}
 
-  // If and gif will be later used also for the capacitance/charge calculations
-  // Values computed from the excess phase routine should be used only
-  //   for computing the companion model current and conductance
-  nr_double_t Ifx = If;
-  nr_double_t gifx = gif;
-  // during transient analysis only
-  if (doTR) {
-    // calculate excess phase influence
-    Ifx /= Qb;
-    excessPhase (cexState, Ifx, gifx);
-    Ifx *= Qb;
-  }
-
+/* The function computes the transfer current and its derivatives. */
+static inline void bjtTransfer (nr_double_t Ifx, nr_double_t gifx,
+				nr_double_t Ir, nr_double_t gir,
+				nr_double_t Qb, nr_double_t dQbdUbe,
+				nr_double_t dQbdUbc, nr_double_t& It,
+				nr_double_t& gitf, nr_double_t& gitr) {
   // compute transfer current
   It = (Ifx - Ir) / Qb;
 
   // compute forward and backward transconductance
   gitf = (+gifx - It * dQbdUbe) / Qb;
   gitr = (-gir - It * dQbdUbc) / Qb;
+}
+
+// Fetches the base-emitter and base-collector voltages.
+void bjt::controlVoltages (nr_double_t * U) {
+  U[0] = real (getV (NODE_B) - getV (NODE_E)) * pol;
+  U[1] = real (getV (NODE_B) - getV (NODE_C)) * pol;
+}
+
+/* The function limits the given control voltages with respect to the
+   previous iteration for better convergence. */
+void bjt::limitVoltages (nr_double_t * U, nr_double_t Ut, nr_double_t Is,
+			 nr_double_t Nf, nr_double_t Nr) {
+  // critical voltage necessary for bad start values
+  nr_double_t UbeCrit = pnCriticalVoltage (Is, Nf * Ut);
+  nr_double_t UbcCrit = pnCriticalVoltage (Is, Nr * Ut);
+  UbePrev = Ube = pnVoltage (U[0], UbePrev, Ut * Nf, UbeCrit);
+  UbcPrev = Ubc = pnVoltage (U[1], UbcPrev, Ut * Nr, UbcCrit);
+
+  Uce = Ube - Ubc;
+}
+
+/* The function fills in the G-MNA matrix and I-vector entries of the
+   evaluated model including the current-dependent base resistance. */
+void bjt::stampDC (nr_double_t Ibei, nr_double_t Iben, nr_double_t Ibci,
+		   nr_double_t Ibcn, nr_double_t Rb, nr_double_t Rbm,
+		   nr_double_t Irb) {
+  nr_double_t Ibc, gbe, gbc, IeqB, IeqC, IeqE, IeqS, gm, go;
+
+  Ibe = Ibei + Iben;
+  gbe = gbei + gben;
+  Ibc = Ibci + Ibcn;
+  gbc = gbci + gbcn;
 
   // compute old SPICE values
   go = -gitr;
@@ -555,6 +555,205 @@ void bjt::calcDC (void) {
 #endif
 }
 
+// The excess phase currents depend on the time step history.
+bool bjt::hasExcessPhase (void) {
+  return doTR && getPropertyDouble (pPtf) != 0.0 &&
+    getPropertyDouble (pTf) != 0.0;
+}
+
+void bjt::calcDC (void) {
+
+  // already evaluated by the batch
+  if (isEvaluated ()) {
+    setEvaluated (false);
+    return;
+  }
+
+  // skip the evaluation if the junction voltages did not change
+  nr_double_t U[2];
+  controlVoltages (U);
+  bool bypass = !hasExcessPhase ();
+  if (bypass && checkBypass (U, 2)) return;
+
+  // fetch device model parameters
+  nr_double_t Is   = getScaledProperty (pIs);
+  nr_double_t Nf   = getPropertyDouble (pNf);
+  nr_double_t Nr   = getPropertyDouble (pNr);
+  nr_double_t Vaf  = getPropertyDouble (pVaf);
+  nr_double_t Var  = getPropertyDouble (pVar);
+  nr_double_t Ikf  = getScaledProperty (pIkf);
+  nr_double_t Ikr  = getScaledProperty (pIkr);
+  nr_double_t Bf   = getScaledProperty (pBf);
+  nr_double_t Br   = getScaledProperty (pBr);
+  nr_double_t Ise  = getScaledProperty (pIse);
+  nr_double_t Isc  = getScaledProperty (pIsc);
+  nr_double_t Ne   = getPropertyDouble (pNe);
+  nr_double_t Nc   = getPropertyDouble (pNc);
+  nr_double_t Rb   = getScaledProperty (pRb);
+  nr_double_t Rbm  = getScaledProperty (pRbm);
+  nr_double_t Irb  = getScaledProperty (pIrb);
+  nr_double_t T    = getPropertyDouble (pTemp);
+
+  nr_double_t Ut, Iben, Ibcn, Ibei, Ibci;
+
+  // interpret zero as infinity for these model parameters
+  Ikf = Ikf > 0 ? 1.0 / Ikf : 0;
+  Ikr = Ikr > 0 ? 1.0 / Ikr : 0;
+  Vaf = Vaf > 0 ? 1.0 / Vaf : 0;
+  Var = Var > 0 ? 1.0 / Var : 0;
+
+  T = celsius2kelvin (T);
+  Ut = T * kBoverQ;
+  limitVoltages (U, Ut, Is, Nf, Nr);
+
+  pnJunctionBIP (Ube, Is, Ut * Nf, If, gif);
+  pnJunctionBIP (Ube, Ise, Ut * Ne, Iben, gben);
+  pnJunctionBIP (Ubc, Is, Ut * Nr, Ir, gir);
+  pnJunctionBIP (Ubc, Isc, Ut * Nc, Ibcn, gbcn);
+  bjtJunctions (Ube, Ubc, Ut, Is, Nf, Nr, Ise, Isc, Bf, Br,
+		Vaf, Var, Ikf, Ikr, If, gif, Ibei, gbei, Iben, gben,
+		Ir, gir, Ibci, gbci, Ibcn, gbcn, Qb, dQbdUbe, dQbdUbc);
+
+  // If and gif will be later used also for the capacitance/charge calculations
+  // Values computed from the excess phase routine should be used only
+  //   for computing the companion model current and conductance
+  nr_double_t Ifx = If;
+  nr_double_t gifx = gif;
+  // during transient analysis only
+  if (doTR) {
+    // calculate excess phase influence
+    Ifx /= Qb;
+    excessPhase (cexState, Ifx, gifx);
+    Ifx *= Qb;
+  }
+
+  bjtTransfer (Ifx, gifx, Ir, gir, Qb, dQbdUbe, dQbdUbc, It, gitf, gitr);
+  stampDC (Ibei, Iben, Ibci, Ibcn, Rb, Rbm, Irb);
+
+  if (bypass) {
+    U[0] = Ube;
+    U[1] = Ubc;
+    saveBypass (U, 2);
+  }
+}
+
+// Creates the batch evaluating many BJT instances at once.
+circuitbatch * bjt::createBatch (void) {
+  return new bjtbatch ();
+}
+
+/* The function caches the model parameters of each instance of the
+   batch in structure-of-arrays form. */
+void bjtbatch::prepare (void) {
+  int i, n = size ();
+  Ut.resize (n); Is.resize (n); Nf.resize (n); Nr.resize (n);
+  Ise.resize (n); Ne.resize (n); Isc.resize (n); Nc.resize (n);
+  Bf.resize (n); Br.resize (n); Vaf.resize (n); Var.resize (n);
+  Ikf.resize (n); Ikr.resize (n); Rb.resize (n); Rbm.resize (n);
+  Irb.resize (n);
+  UtNf.resize (n); UtNe.resize (n); UtNr.resize (n); UtNc.resize (n);
+  Ube.resize (n); Ubc.resize (n);
+  If.resize (n); gif.resize (n); Ibei.resize (n); gbei.resize (n);
+  Iben.resize (n); gben.resize (n); Ir.resize (n); gir.resize (n);
+  Ibci.resize (n); gbci.resize (n); Ibcn.resize (n); gbcn.resize (n);
+  Qb.resize (n); dQbdUbe.resize (n); dQbdUbc.resize (n);
+  It.resize (n); gitf.resize (n); gitr.resize (n);
+  skipped.resize (n);
+  for (i = 0; i < n; i++) {
+    bjt * c = (bjt *) circuits[i];
+    nr_double_t T = celsius2kelvin (c->getPropertyDouble ("Temp"));
+    Ut[i]  = T * kBoverQ;
+    Is[i]  = c->getScaledProperty ("Is");
+    Nf[i]  = c->getPropertyDouble ("Nf");
+    Nr[i]  = c->getPropertyDouble ("Nr");
+    Ise[i] = c->getScaledProperty ("Ise");
+    Ne[i]  = c->getPropertyDouble ("Ne");
+    Isc[i] = c->getScaledProperty ("Isc");
+    Nc[i]  = c->getPropertyDouble ("Nc");
+    Bf[i]  = c->getScaledProperty ("Bf");
+    Br[i]  = c->getScaledProperty ("Br");
+    Rb[i]  = c->getScaledProperty ("Rb");
+    Rbm[i] = c->getScaledProperty ("Rbm");
+    Irb[i] = c->getScaledProperty ("Irb");
+    // interpret zero as infinity for these model parameters
+    nr_double_t a;
+    a = c->getScaledProperty ("Ikf"); Ikf[i] = a > 0 ? 1.0 / a : 0;
+    a = c->getScaledProperty ("Ikr"); Ikr[i] = a > 0 ? 1.0 / a : 0;
+    a = c->getPropertyDouble ("Vaf"); Vaf[i] = a > 0 ? 1.0 / a : 0;
+    a = c->getPropertyDouble ("Var"); Var[i] = a > 0 ? 1.0 / a : 0;
+    UtNf[i] = Ut[i] * Nf[i]; UtNe[i] = Ut[i] * Ne[i];
+    UtNr[i] = Ut[i] * Nr[i]; UtNc[i] = Ut[i] * Nc[i];
+    Ube[i] = Ubc[i] = 0;
+  }
+}
+
+/* This function evaluates the DC model of the given range of BJT
+   instances.  The voltages are gathered and limited per instance,
+   then the model equations run over the contiguous arrays and the
+   results are finally scattered back into the instances.  Instances
+   with excess phase during transient analysis are left to their own
+   calcDC() function. */
+void bjtbatch::calcDC (int first, int last) {
+  int i;
+
+  // gather and limit the control voltages
+  for (i = first; i < last; i++) {
+    bjt * c = (bjt *) circuits[i];
+    nr_double_t U[2];
+    skipped[i] = c->hasExcessPhase ();
+    if (skipped[i]) continue;
+    c->controlVoltages (U);
+    if ((skipped[i] = c->checkBypass (U, 2))) {
+      c->setEvaluated (true);
+      continue;
+    }
+    c->limitVoltages (U, Ut[i], Is[i], Nf[i], Nr[i]);
+    Ube[i] = c->Ube; Ubc[i] = c->Ubc;
+  }
+
+  // pn-junction currents over the whole range
+  int n = last - first;
+  pnJunctionBIP (n, Ube.data () + first, Is.data () + first,
+		 UtNf.data () + first, If.data () + first, gif.data () + first);
+  pnJunctionBIP (n, Ube.data () + first, Ise.data () + first,
+		 UtNe.data () + first, Iben.data () + first,
+		 gben.data () + first);
+  pnJunctionBIP (n, Ubc.data () + first, Is.data () + first,
+		 UtNr.data () + first, Ir.data () + first, gir.data () + first);
+  pnJunctionBIP (n, Ubc.data () + first, Isc.data () + first,
+		 UtNc.data () + first, Ibcn.data () + first,
+		 gbcn.data () + first);
+
+  // base diodes and base charge
+  for (i = first; i < last; i++) {
+    bjtJunctions (Ube[i], Ubc[i], Ut[i], Is[i], Nf[i], Nr[i], Ise[i],
+		  Isc[i], Bf[i], Br[i], Vaf[i], Var[i],
+		  Ikf[i], Ikr[i], If[i], gif[i], Ibei[i], gbei[i], Iben[i],
+		  gben[i], Ir[i], gir[i], Ibci[i], gbci[i], Ibcn[i],
+		  gbcn[i], Qb[i], dQbdUbe[i], dQbdUbc[i]);
+  }
+
+  // transfer current
+  for (i = first; i < last; i++) {
+    bjtTransfer (If[i], gif[i], Ir[i], gir[i], Qb[i], dQbdUbe[i],
+		 dQbdUbc[i], It[i], gitf[i], gitr[i]);
+  }
+
+  // scatter the results and stamp them
+  for (i = first; i < last; i++) {
+    bjt * c = (bjt *) circuits[i];
+    if (skipped[i]) continue;
+    c->If = If[i]; c->gif = gif[i]; c->gbei = gbei[i]; c->gben = gben[i];
+    c->Ir = Ir[i]; c->gir = gir[i]; c->gbci = gbci[i]; c->gbcn = gbcn[i];
+    c->Qb = Qb[i]; c->dQbdUbe = dQbdUbe[i]; c->dQbdUbc = dQbdUbc[i];
+    c->It = It[i]; c->gitf = gitf[i]; c->gitr = gitr[i];
+    c->stampDC (Ibei[i], Iben[i], Ibci[i], Ibcn[i], Rb[i], Rbm[i], Irb[i]);
+    nr_double_t U[2] = { c->Ube, c->Ubc };
+    c->saveBypass (U, 2);
+    c->setEvaluated (true);
+  }
+}
+
 void bjt::saveOperatingPoints (void) {
   nr_double_t Vbe, Vbc;
   Vbe = real (getV (NODE_B) - getV (NODE_E)) * pol;
@@ -580,22 +779,22 @@ void bjt::loadOperatingPoints (void) {
 void bjt::calcOperatingPoints (void) {
 
   // fetch device model parameters
-  nr_double_t Cje0 = getScaledProperty ("Cje");
-  nr_double_t Vje  = getScaledProperty ("Vje");
-  nr_double_t Mje  = getPropertyDouble ("Mje");
-  nr_double_t Cjc0 = getScaledProperty ("Cjc");
-  nr_double_t Vjc  = getScaledProperty ("Vjc");
-  nr_double_t Mjc  = getPropertyDouble ("Mjc");
-  nr_double_t Xcjc = getPropertyDouble ("Xcjc");
-  nr_double_t Cjs0 = getScaledProperty ("Cjs");
-  nr_double_t Vjs  = getScaledProperty ("Vjs");
-  nr_double_t Mjs  = getPropertyDouble ("Mjs");
-  nr_double_t Fc   = getPropertyDouble ("Fc");
-  nr_double_t Vtf  = getPropertyDouble ("Vtf");
-  nr_double_t Tf   = getPropertyDouble ("Tf");
-  nr_double_t Xtf  = getPropertyDouble ("Xtf");
-  nr_double_t Itf  = getScaledProperty ("Itf");
-  nr_double_t Tr   = getPropertyDouble ("Tr");
+  nr_double_t Cje0 = getScaledProperty (pCje);
+  nr_double_t Vje  = getScaledProperty (pVje);
+  nr_double_t Mje  = getPropertyDouble (pMje);
+  nr_double_t Cjc0 = getScaledProperty (pCjc);
+  nr_double_t Vjc  = getScaledProperty (pVjc);
+  nr_double_t Mjc  = getPropertyDouble (pMjc);
+  nr_double_t Xcjc = getPropertyDouble (pXcjc);
+  nr_double_t Cjs0 = getScaledProperty (pCjs);
+  nr_double_t Vjs  = getScaledProperty (pVjs);
+  nr_double_t Mjs  = getPropertyDouble (pMjs);
+  nr_double_t Fc   = getPropertyDouble (pFc);
+  nr_double_t Vtf  = getPropertyDouble (pVtf);
+  nr_double_t Tf   = getPropertyDouble (pTf);
+  nr_double_t Xtf  = getPropertyDouble (pXtf);
+  nr_double_t Itf  = getScaledProperty (pItf);
+  nr_double_t Tr   = getPropertyDouble (pTr);
 
   nr_double_t Cbe, Cbci, Cbcx, Ccs;
 
@@ -603,8 +802,7 @@ void bjt::calcOperatingPoints (void) {
   Vtf = Vtf > 0 ? 1.0 / Vtf : 0;
 
   // depletion capacitance of base-emitter diode
-  Cbe = pnCapacitance (Ube, Cje0, Vje, Mje, Fc);
-  Qbe = pnCharge (Ube, Cje0, Vje, Mje, Fc);
+  pnDepletion (Ube, Cje0, Vje, Mje, Fc, Qbe, Cbe);
 
   // diffusion capacitance of base-emitter diode
   if (If != 0.0) {
@@ -620,16 +818,15 @@ void bjt::calcOperatingPoints (void) {
   }
 
   // depletion and diffusion capacitance of base-collector diode
-  Cbci = pnCapacitance (Ubc, Cjc0 * Xcjc, Vjc, Mjc, Fc) + Tr * gir;
-  Qbci = pnCharge (Ubc, Cjc0 * Xcjc, Vjc, Mjc, Fc) + Tr * Ir;
+  pnDepletion (Ubc, Cjc0 * Xcjc, Vjc, Mjc, Fc, Qbci, Cbci);
+  Cbci += Tr * gir;
+  Qbci += Tr * Ir;
 
   // depletion and diffusion capacitance of external base-collector capacitor
-  Cbcx = pnCapacitance (Ubx, Cjc0 * (1 - Xcjc), Vjc, Mjc, Fc);
-  Qbcx = pnCharge (Ubx, Cjc0 * (1 - Xcjc), Vjc, Mjc, Fc);
+  pnDepletion (Ubx, Cjc0 * (1 - Xcjc), Vjc, Mjc, Fc, Qbcx, Cbcx);
 
   // depletion capacitance of collector-substrate diode
-  Ccs = pnCapacitance (Ucs, Cjs0, Vjs, Mjs);
-  Qcs = pnCharge (Ucs, Cjs0, Vjs, Mjs);
+  pnDepletion (Ucs, Cjs0, Vjs, Mjs, Qcs, Ccs);
 
   // finally save the operating points
   setOperatingPoint ("Cbe", Cbe);
@@ -747,8 +944,8 @@ void bjt::calcTR (nr_double_t t) {
 void bjt::excessPhase (int istate, nr_double_t& i, nr_double_t& g) {
 
   // fetch device properties
-  nr_double_t Ptf = getPropertyDouble ("Ptf");
-  nr_double_t Tf = getPropertyDouble ("Tf");
+  nr_double_t Ptf = getPropertyDouble (pPtf);
+  nr_double_t Tf = getPropertyDouble (pTf);
   nr_double_t td = deg2rad (Ptf) * Tf;
 
   // return if nothing todo
@@ -44,7 +44,16 @@ class bjt : public qucs::circuit
   void initTR (void);
   void calcTR (nr_double_t);
 
+  qucs::circuitbatch * createBatch (void);
+
  private:
+  friend class bjtbatch;
+  void controlVoltages (nr_double_t *);
+  void limitVoltages (nr_double_t *, nr_double_t, nr_double_t, nr_double_t,
+		      nr_double_t);
+  void stampDC (nr_double_t, nr_double_t, nr_double_t, nr_double_t,
+		nr_double_t, nr_double_t, nr_double_t);
+  bool hasExcessPhase (void);
   void initModel (void);
   void processCbcx (void);
   qucs::matrix calcMatrixY (nr_double_t);
@@ -61,6 +70,30 @@ class bjt : public qucs::circuit
   nr_double_t gbei, gben, gbci, gbcn, gitf, gitr, gif, gir, Rbb, Ibe;
   nr_double_t Qbe, Qbci, Qbcx, Qcs;
   bool doTR;
+  // cached property bindings
+  qucs::parameter pPtf, pTf, pIs, pNf, pNr, pVaf, pVar, pIkf, pIkr, pBf,
+    pBr, pIse, pIsc, pNe, pNc, pRb, pRbm, pIrb, pTemp, pCje, pVje, pMje,
+    pCjc, pVjc, pMjc, pXcjc, pCjs, pVjs, pMjs, pFc, pVtf, pXtf, pItf, pTr;
+};
+
+/* Batched DC evaluation of many BJT instances, the cached model
+   parameters, the limited voltages and the results are kept in
+   structure-of-arrays form. */
+class bjtbatch : public qucs::circuitbatch
+{
+ public:
+  void prepare (void);
+  void calcDC (int, int);
+
+ private:
+  std::vector<nr_double_t> Ut, Is, Nf, Nr, Ise, Ne, Isc, Nc, Bf, Br;
+  std::vector<nr_double_t> Vaf, Var, Ikf, Ikr, Rb, Rbm, Irb;
+  std::vector<nr_double_t> UtNf, UtNe, UtNr, UtNc;
+  std::vector<nr_double_t> Ube, Ubc;
+  std::vector<nr_double_t> If, gif, Ibei, gbei, Iben, gben;
+  std::vector<nr_double_t> Ir, gir, Ibci, gbci, Ibcn, gbcn;
+  std::vector<nr_double_t> Qb, dQbdUbe, dQbdUbc, It, gitf, gitr;
+  std::vector<char> skipped;
 };
 
 #endif /* __BJT_H__ */
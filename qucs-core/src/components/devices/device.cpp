@@ -30,6 +30,8 @@
 #include <stdlib.h>
 #include <cmath>
 #include <algorithm>
+#include <map>
+#include <mutex>
 
 #include "complex.h"
 #include "object.h"
@@ -168,6 +170,37 @@ void device::pnJunctionBIP (nr_double_t Upn, nr_double_t Iss, nr_double_t Ute,
   }
 }
 
+/* Computes currents and derivatives of the given array of MOS
+   pn-junctions.  Both branches are evaluated and selected without
+   jumps, each result equals the one of the single junction. */
+void device::pnJunctionMOS (int n, const nr_double_t * Upn,
+			    const nr_double_t * Iss, const nr_double_t * Ute,
+			    nr_double_t * I, nr_double_t * g) {
+  for (int i = 0; i < n; i++) {
+    nr_double_t u = Upn[i], s = Iss[i], t = Ute[i];
+    nr_double_t e = exp (std::min (u / t, 709.0));
+    nr_double_t l = s / t;
+    bool r = u <= 0;
+    I[i] = r ? l * u : s * (e - 1);
+    g[i] = r ? l : s * e / t;
+  }
+}
+
+/* Computes currents and derivatives of the given array of bipolar
+   pn-junctions, the same way as for the MOS junctions. */
+void device::pnJunctionBIP (int n, const nr_double_t * Upn,
+			    const nr_double_t * Iss, const nr_double_t * Ute,
+			    nr_double_t * I, nr_double_t * g) {
+  for (int i = 0; i < n; i++) {
+    nr_double_t u = Upn[i], s = Iss[i], t = Ute[i];
+    nr_double_t e = exp (std::min (u / t, 709.0));
+    nr_double_t a = cubic (3 * t / (u * euler));
+    bool r = u < -3 * t;
+    I[i] = r ? -s * (1 + a) : s * (e - 1);
+    g[i] = r ? +s * 3 * a / u : s * e / t;
+  }
+}
+
 // The function computes the exponential pn-junction current.
 nr_double_t
 device::pnCurrent (nr_double_t Upn, nr_double_t Iss, nr_double_t Ute) {
@@ -180,6 +213,15 @@ device::pnConductance (nr_double_t Upn, nr_double_t Iss, nr_double_t Ute) {
   return Iss * exp (std::min (Upn / Ute, 709.0)) / Ute;
 }
 
+/* The function computes the exponential pn-junction current and its
+   derivative from a single exponential. */
+void device::pnExponential (nr_double_t Upn, nr_double_t Iss, nr_double_t Ute,
+			    nr_double_t& I, nr_double_t& g) {
+  nr_double_t e = exp (std::min (Upn / Ute, 709.0));
+  I = Iss * (e - 1);
+  g = Iss * e / Ute;
+}
+
 // Computes pn-junction depletion capacitance.
 nr_double_t
 device::pnCapacitance (nr_double_t Uj, nr_double_t Cj, nr_double_t Vj,
@@ -249,6 +291,46 @@ nr_double_t device::pnCharge (nr_double_t Uj, nr_double_t Cj, nr_double_t Vj,
   return q;
 }
 
+/* Computes pn-junction depletion charge and capacitance.  Below the
+   linearization point both share the power (1 - Uj/Vj)^-Mj. */
+void device::pnDepletion (nr_double_t Uj, nr_double_t Cj, nr_double_t Vj,
+			  nr_double_t Mj, nr_double_t Fc,
+			  nr_double_t& Q, nr_double_t& C) {
+  nr_double_t a, b;
+  if (Uj <= Fc * Vj) {
+    a = 1 - Uj / Vj;
+    b = exp (-Mj * log (a));
+    C = Cj * b;
+    Q = Cj * Vj / (1 - Mj) * (1 - a * b);
+  }
+  else {
+    a = 1 - Fc;
+    b = exp (-Mj * log (a));
+    nr_double_t f = Fc * Vj;
+    nr_double_t c = Cj * (1 - Fc * (1 + Mj)) * b / a;
+    nr_double_t d = Cj * Mj * b / a / Vj;
+    nr_double_t e = Cj * Vj * (1 - a * b) / (1 - Mj) - d / 2 * f * f - f * c;
+    C = Cj * b * (1 + Mj * (Uj - f) / Vj / a);
+    Q = e + Uj * (c + Uj * d / 2);
+  }
+}
+
+/* Computes pn-junction depletion charge and capacitance with no
+   linearization factor given. */
+void device::pnDepletion (nr_double_t Uj, nr_double_t Cj, nr_double_t Vj,
+			  nr_double_t Mj, nr_double_t& Q, nr_double_t& C) {
+  if (Uj <= 0) {
+    nr_double_t a = 1 - Uj / Vj;
+    nr_double_t b = exp (-Mj * log (a));
+    C = Cj * b;
+    Q = Cj * Vj / (1 - Mj) * (1 - a * b);
+  }
+  else {
+    C = Cj * (1 + Mj * Uj / Vj);
+    Q = Cj * Uj * (1 + Mj * Uj / 2 / Vj);
+  }
+}
+
 // Compute critical voltage of pn-junction.
 nr_double_t device::pnCriticalVoltage (nr_double_t Iss, nr_double_t Ute) {
   return Ute * log (Ute / sqrt2 / Iss);
@@ -413,3 +495,43 @@ device::pnCapacitance_F (nr_double_t T1, nr_double_t T2, nr_double_t M,
   nr_double_t DT = T2 - T1;
   return 1 + M * (4e-4 * DT - VR + 1);
 }
+
+/* The temperature scaled parameters of the model cards.  Instances of
+   a device sharing the model properties and temperatures share them,
+   the geometry scaling is applied per instance. */
+static std::mutex modelcardlock;
+static std::map<std::vector<nr_double_t>, std::vector<nr_double_t> > modelcards;
+
+/* Returns the model card of the given device, i.e. its type followed
+   by the values of the given model properties. */
+std::vector<nr_double_t>
+device::modelCard (circuit * base, const char * const * names) {
+  std::vector<nr_double_t> card;
+  card.push_back (base->getType ());
+  for (; *names != NULL; names++)
+    card.push_back (base->getPropertyDouble (*names));
+  return card;
+}
+
+/* Looks up the n temperature scaled parameters of the given model card.
+   Returns true if they have been computed before. */
+bool
+device::modelCardLookup (const std::vector<nr_double_t>& card,
+			 nr_double_t * values, int n) {
+  std::lock_guard<std::mutex> lock (modelcardlock);
+  auto it = modelcards.find (card);
+  if (it == modelcards.end () || (int) it->second.size () != n) return false;
+  std::copy (it->second.begin (), it->second.end (), values);
+  return true;
+}
+
+/* Keeps the n temperature scaled parameters of the given model card.
+   All cards are dropped once there are too many of them, e.g. with
+   a long temperature sweep. */
+void
+device::modelCardStore (const std::vector<nr_double_t>& card,
+			const nr_double_t * values, int n) {
+  std::lock_guard<std::mutex> lock (modelcardlock);
+  if (modelcards.size () >= MODELCARD_MAX) modelcards.clear ();
+  modelcards[card].assign (values, values + n);
+}
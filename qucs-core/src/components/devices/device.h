@@ -25,6 +25,11 @@
 #ifndef __DEVICE_H__
 #define __DEVICE_H__
 
+#include <vector>
+
+// largest number of model cards kept with their temperature scaling
+#define MODELCARD_MAX 4096
+
 namespace qucs {
 
 class circuit;
@@ -87,6 +92,26 @@ namespace device {
       nr_double_t& I,  // result current
       nr_double_t& g); // result derivative
 
+  // computes currents and derivatives of an array of MOS pn-junctions
+  void
+    pnJunctionMOS (
+      int n,                   // number of junctions
+      const nr_double_t * Upn, // pn-voltages
+      const nr_double_t * Iss, // saturation currents
+      const nr_double_t * Ute, // temperature voltages
+      nr_double_t * I,         // result currents
+      nr_double_t * g);        // result derivatives
+
+  // computes currents and derivatives of an array of bipolar pn-junctions
+  void
+    pnJunctionBIP (
+      int n,                   // number of junctions
+      const nr_double_t * Upn, // pn-voltages
+      const nr_double_t * Iss, // saturation currents
+      const nr_double_t * Ute, // temperature voltages
+      nr_double_t * I,         // result currents
+      nr_double_t * g);        // result derivatives
+
   // limits the forward pn-voltage
   nr_double_t
      pnVoltage (
@@ -109,6 +134,15 @@ namespace device {
       nr_double_t Iss,  // saturation current
       nr_double_t Ute); // temperature voltage
 
+  // computes the exponential pn-junction current and its derivative
+  void
+    pnExponential (
+      nr_double_t Upn, // pn-voltage
+      nr_double_t Iss, // saturation current
+      nr_double_t Ute, // temperature voltage
+      nr_double_t& I,  // result current
+      nr_double_t& g); // result derivative
+
   // computes pn-junction depletion capacitance
   nr_double_t
     pnCapacitance (
@@ -143,6 +177,27 @@ namespace device {
       nr_double_t Vj,  // built-in potential
       nr_double_t Mj); // grading coefficient
 
+  // computes pn-junction depletion charge and capacitance
+  void
+    pnDepletion (
+      nr_double_t Uj,  // pn-voltage
+      nr_double_t Cj,  // zero-bias capacitance
+      nr_double_t Vj,  // built-in potential
+      nr_double_t Mj,  // grading coefficient
+      nr_double_t Fc,  // forward-bias coefficient
+      nr_double_t& Q,  // result charge
+      nr_double_t& C); // result capacitance
+
+  // computes pn-junction depletion charge and capacitance
+  void
+    pnDepletion (
+      nr_double_t Uj,  // pn-voltage
+      nr_double_t Cj,  // zero-bias capacitance
+      nr_double_t Vj,  // built-in potential
+      nr_double_t Mj,  // grading coefficient
+      nr_double_t& Q,  // result charge
+      nr_double_t& C); // result capacitance
+
   // compute critical voltage of pn-junction
   nr_double_t
     pnCriticalVoltage (
@@ -222,6 +277,26 @@ namespace device {
       nr_double_t M,   // grading coefficient
       nr_double_t VR); // built-in potential ratio: Vj(T2) / Vj(T1)
 
+  // collects the values of the model properties identifying a model card
+  std::vector<nr_double_t>
+    modelCard (
+      circuit * base,               // calling circuit (this)
+      const char * const * names);  // model properties, NULL terminated
+
+  // looks up the temperature scaled parameters of a model card
+  bool
+    modelCardLookup (
+      const std::vector<nr_double_t>& card, // model card
+      nr_double_t * values,                 // resulting parameters
+      int n);                               // number of parameters
+
+  // keeps the temperature scaled parameters of a model card
+  void
+    modelCardStore (
+      const std::vector<nr_double_t>& card, // model card
+      const nr_double_t * values,           // parameters
+      int n);                               // number of parameters
+
 } // namespace device
 
 } // namespace qucs
@@ -46,9 +46,13 @@ using namespace qucs;
 using namespace qucs::device;
 
 // Constructor for the diode.
-diode::diode () : circuit (2) {
+diode::diode () : circuit (2),
+  pIs ("Is"), pN ("N"), pIsr ("Isr"), pNr ("Nr"), pIkf ("Ikf"),
+  pTemp ("Temp"), pM ("M"), pCj0 ("Cj0"), pVj ("Vj"), pFc ("Fc"),
+  pCp ("Cp"), pTt ("Tt") {
   rs = NULL;
   type = CIR_DIODE;
+  setParallel (true);
 }
 
 // Callback for S-parameter analysis.
@@ -106,28 +110,69 @@ matrix diode::calcMatrixCy (nr_double_t frequency) {
 }
 
 // Initializes the diode model including temperature and area effects.
+// The model properties the temperature scaled diode parameters depend on.
+static const char * const diodeCard[] = {
+  "Temp", "Tnom", "Is", "N", "Xti", "Eg", "Isr", "Nr", "Vj", "Cj0", "M",
+  "Bv", "Tbv", "Tt", "Ttt1", "Ttt2", "Tm1", "Tm2", "Rs", "Trs", NULL };
+
 void diode::initModel (void) {
   // fetch necessary device properties
-  nr_double_t T  = getPropertyDouble ("Temp");
-  nr_double_t Tn = getPropertyDouble ("Tnom");
   nr_double_t A  = getPropertyDouble ("Area");
+  nr_double_t N  = getPropertyDouble ("N");
+  nr_double_t Nr = getPropertyDouble ("Nr");
+  nr_double_t M  = getPropertyDouble ("M");
+
+  // the temperature dependencies are computed once per model card
+  std::vector<nr_double_t> card = modelCard (this, diodeCard);
+  nr_double_t p[8];
+  if (!modelCardLookup (card, p, 8)) {
+    nr_double_t T   = getPropertyDouble ("Temp");
+    nr_double_t Tn  = getPropertyDouble ("Tnom");
+    nr_double_t Xti = getPropertyDouble ("Xti");
+    nr_double_t Eg  = getPropertyDouble ("Eg");
+    nr_double_t T1, T2;
+    T2 = celsius2kelvin (T);
+    T1 = celsius2kelvin (Tn);
+
+    // compute Is and Isr temperature dependency
+    p[0] = pnCurrent_T (T1, T2, getPropertyDouble ("Is"), Eg, N, Xti);
+    p[1] = pnCurrent_T (T1, T2, getPropertyDouble ("Isr"), Eg, Nr, Xti);
+
+    // compute Vj and Cj0 temperature dependency
+    nr_double_t Vj = getPropertyDouble ("Vj");
+    p[2] = pnPotential_T (T1,T2, Vj);
+    p[3] = pnCapacitance_T (T1, T2, M, p[2] / Vj, getPropertyDouble ("Cj0"));
+
+    // compute Bv temperature dependency
+    nr_double_t Tbv = getPropertyDouble ("Tbv");
+    nr_double_t DT  = T2 - T1;
+    p[4] = getPropertyDouble ("Bv") - Tbv * DT;
+
+    // compute Tt temperature dependency
+    nr_double_t Ttt1 = getPropertyDouble ("Ttt1");
+    nr_double_t Ttt2 = getPropertyDouble ("Ttt2");
+    p[5] = getPropertyDouble ("Tt") * (1 + Ttt1 * DT + Ttt2 * DT * DT);
+
+    // compute M temperature dependency
+    nr_double_t Tm1 = getPropertyDouble ("Tm1");
+    nr_double_t Tm2 = getPropertyDouble ("Tm2");
+    p[6] = M * (1 + Tm1 * DT + Tm2 * DT * DT);
+
+    // compute Rs temperature dependency
+    nr_double_t Trs = getPropertyDouble ("Trs");
+    p[7] = getPropertyDouble ("Rs") * (1 + Trs * DT);
+    modelCardStore (card, p, 8);
+  }
 
-  // compute Is temperature and area dependency
-  nr_double_t Is  = getPropertyDouble ("Is");
-  nr_double_t N   = getPropertyDouble ("N");
-  nr_double_t Xti = getPropertyDouble ("Xti");
-  nr_double_t Eg  = getPropertyDouble ("Eg");
-  nr_double_t T1, T2;
-  T2 = celsius2kelvin (T);
-  T1 = celsius2kelvin (Tn);
-  Is = pnCurrent_T (T1, T2, Is, Eg, N, Xti);
-  setScaledProperty ("Is", Is * A);
-
-  // compute Isr temperature and area dependency
-  nr_double_t Isr = getPropertyDouble ("Isr");
-  nr_double_t Nr  = getPropertyDouble ("Nr");
-  Isr = pnCurrent_T (T1, T2, Isr, Eg, Nr, Xti);
-  setScaledProperty ("Isr", Isr * A);
+  // apply the area dependencies
+  setScaledProperty ("Is", p[0] * A);
+  setScaledProperty ("Isr", p[1] * A);
+  setScaledProperty ("Vj", p[2]);
+  setScaledProperty ("Cj0", p[3] * A);
+  setScaledProperty ("Bv", p[4]);
+  setScaledProperty ("Tt", p[5]);
+  setScaledProperty ("M", p[6]);
+  setScaledProperty ("Rs", p[7] / A);
 
   // check unphysical parameters
   if (Nr < 1.0) {
@@ -138,50 +183,10 @@ void diode::initModel (void) {
     logprint (LOG_ERROR, "WARNING: Unphysical model parameter N = %g in "
 	      "diode `%s'\n", N, getName ());
   }
-
-  // compute Vj temperature dependency
-  nr_double_t Vj = getPropertyDouble ("Vj");
-  nr_double_t VjT;
-  VjT = pnPotential_T (T1,T2, Vj);
-  setScaledProperty ("Vj", VjT);
-
-  // compute Cj0 temperature and area dependency
-  nr_double_t Cj0 = getPropertyDouble ("Cj0");
-  nr_double_t M   = getPropertyDouble ("M");
-  Cj0 = pnCapacitance_T (T1, T2, M, VjT / Vj, Cj0);
-  setScaledProperty ("Cj0", Cj0 * A);
-
-  // check unphysical parameters
   if (M > 1.0) {
     logprint (LOG_ERROR, "WARNING: Unphysical model parameter M = %g in "
 	      "Diode `%s'\n", M, getName ());
   }
-
-  // compute Bv temperature dependency
-  nr_double_t Bv  = getPropertyDouble ("Bv");
-  nr_double_t Tbv = getPropertyDouble ("Tbv");
-  nr_double_t DT  = T2 - T1;
-  Bv = Bv - Tbv * DT;
-  setScaledProperty ("Bv", Bv);
-
-  // compute Tt temperature dependency
-  nr_double_t Tt   = getPropertyDouble ("Tt");
-  nr_double_t Ttt1 = getPropertyDouble ("Ttt1");
-  nr_double_t Ttt2 = getPropertyDouble ("Ttt2");
-  Tt = Tt * (1 + Ttt1 * DT + Ttt2 * DT * DT);
-  setScaledProperty ("Tt", Tt);
-
-  // compute M temperature dependency
-  nr_double_t Tm1 = getPropertyDouble ("Tm1");
-  nr_double_t Tm2 = getPropertyDouble ("Tm2");
-  M = M * (1 + Tm1 * DT + Tm2 * DT * DT);
-  setScaledProperty ("M", M);
-
-  // compute Rs temperature and area dependency
-  nr_double_t Rs  = getPropertyDouble ("Rs");
-  nr_double_t Trs = getPropertyDouble ("Trs");
-  Rs = Rs * (1 + Trs * DT);
-  setScaledProperty ("Rs", Rs / A);
 }
 
 // Prepares DC (i.e. HB) analysis.
@@ -268,19 +273,52 @@ void diode::restartDC (void) {
 
 // Callback for DC analysis.
 void diode::calcDC (void) {
+  // skip the evaluation if the junction voltage did not change
+  nr_double_t U = real (getV (NODE_A) - getV (NODE_C));
+  if (checkBypass (&U, 1)) return;
+
+  // junction current and conductance
+  calcJunction (U);
+
+  nr_double_t Ieq;
+
+  // HB simulation
+  if (doHB) {
+    Ieq = Id;
+    setGV (NODE_C, -gd * Ud);
+    setGV (NODE_A, +gd * Ud);
+  }
+  // DC and transient simulation
+  else {
+    Ieq = Id - Ud * gd;
+  }
+
+  // fill in I-Vector
+  setI (NODE_C, +Ieq);
+  setI (NODE_A, -Ieq);
+
+  // fill in G-Matrix
+  setY (NODE_C, NODE_C, +gd); setY (NODE_A, NODE_A, +gd);
+  setY (NODE_C, NODE_A, -gd); setY (NODE_A, NODE_C, -gd);
+  saveBypass (&Ud, 1);
+}
+
+/* Computes the limited junction voltage Ud and the junction current
+   Id and conductance gd for the given junction voltage. */
+void diode::calcJunction (nr_double_t U) {
   // get device properties
-  nr_double_t Is  = getScaledProperty ("Is");
-  nr_double_t N   = getPropertyDouble ("N");
-  nr_double_t Isr = getScaledProperty ("Isr");
-  nr_double_t Nr  = getPropertyDouble ("Nr");
-  nr_double_t Ikf = getPropertyDouble ("Ikf");
-  nr_double_t T   = getPropertyDouble ("Temp");
+  nr_double_t Is  = getScaledProperty (pIs);
+  nr_double_t N   = getPropertyDouble (pN);
+  nr_double_t Isr = getScaledProperty (pIsr);
+  nr_double_t Nr  = getPropertyDouble (pNr);
+  nr_double_t Ikf = getPropertyDouble (pIkf);
+  nr_double_t T   = getPropertyDouble (pTemp);
 
-  nr_double_t Ut, Ieq, Ucrit, gtiny;
+  nr_double_t Ut, Ucrit, gtiny;
 
   T = celsius2kelvin (T);
   Ut = T * kBoverQ;
-  Ud = real (getV (NODE_A) - getV (NODE_C));
+  Ud = U;
 
   // critical voltage necessary for bad start values
   Ucrit = pnCriticalVoltage (Is, N * Ut);
@@ -298,8 +336,11 @@ void diode::calcDC (void) {
   gtiny = (Ud < - 10 * Ut * N && Bv != 0) ? (Is + Isr) : 0;
 
   if (Ud >= -3 * N * Ut) { // forward region
-    gd = pnConductance (Ud, Is, Ut * N) + pnConductance (Ud, Isr, Ut * Nr);
-    Id = pnCurrent (Ud, Is, Ut * N) + pnCurrent (Ud, Isr, Ut * Nr);
+    nr_double_t Ir, gr;
+    pnExponential (Ud, Is, Ut * N, Id, gd);
+    pnExponential (Ud, Isr, Ut * Nr, Ir, gr);
+    Id += Ir;
+    gd += gr;
   }
   else if (Bv == 0 || Ud >= -Bv) { // reverse region
     nr_double_t a = 3 * N * Ut / (Ud * euler);
@@ -322,25 +363,6 @@ void diode::calcDC (void) {
 
   Id += gtiny * Ud;
   gd += gtiny;
-
-  // HB simulation
-  if (doHB) {
-    Ieq = Id;
-    setGV (NODE_C, -gd * Ud);
-    setGV (NODE_A, +gd * Ud);
-  }
-  // DC and transient simulation
-  else {
-    Ieq = Id - Ud * gd;
-  }
-
-  // fill in I-Vector
-  setI (NODE_C, +Ieq);
-  setI (NODE_A, -Ieq);
-
-  // fill in G-Matrix
-  setY (NODE_C, NODE_C, +gd); setY (NODE_A, NODE_A, +gd);
-  setY (NODE_C, NODE_A, -gd); setY (NODE_A, NODE_C, -gd);
 }
 
 // Saves operating points (voltages).
@@ -360,18 +382,8 @@ void diode::calcOperatingPoints (void) {
   // load operating points
   loadOperatingPoints ();
 
-  // get necessary properties
-  nr_double_t M   = getScaledProperty ("M");
-  nr_double_t Cj0 = getScaledProperty ("Cj0");
-  nr_double_t Vj  = getScaledProperty ("Vj");
-  nr_double_t Fc  = getPropertyDouble ("Fc");
-  nr_double_t Cp  = getPropertyDouble ("Cp");
-  nr_double_t Tt  = getScaledProperty ("Tt");
-
   // calculate capacitances and charges
-  nr_double_t Cd;
-  Cd = pnCapacitance (Ud, Cj0, Vj, M, Fc) + Tt * gd + Cp;
-  Qd = pnCharge (Ud, Cj0, Vj, M, Fc) + Tt * Id + Cp * Ud;
+  nr_double_t Cd = calcCharge ();
 
   // save operating points
   setOperatingPoint ("gd", gd);
@@ -379,6 +391,25 @@ void diode::calcOperatingPoints (void) {
   setOperatingPoint ("Cd", Cd);
 }
 
+/* Computes the junction charge Qd at the junction voltage Ud and
+   returns the junction capacitance. */
+nr_double_t diode::calcCharge (void) {
+  // get necessary properties
+  nr_double_t M   = getScaledProperty (pM);
+  nr_double_t Cj0 = getScaledProperty (pCj0);
+  nr_double_t Vj  = getScaledProperty (pVj);
+  nr_double_t Fc  = getPropertyDouble (pFc);
+  nr_double_t Cp  = getPropertyDouble (pCp);
+  nr_double_t Tt  = getScaledProperty (pTt);
+
+  // calculate capacitances and charges
+  nr_double_t Cd;
+  pnDepletion (Ud, Cj0, Vj, M, Fc, Qd, Cd);
+  Cd += Tt * gd + Cp;
+  Qd += Tt * Id + Cp * Ud;
+  return Cd;
+}
+
 // Callback for initializing the AC analysis.
 void diode::initAC (void) {
   allocMatrixMNA ();
@@ -452,6 +483,44 @@ void diode::calcHB (int frequency) {
   setQV (NODE_C, NODE_A, -Cd); setQV (NODE_A, NODE_C, -Cd);
 }
 
+/* Batched callback for the HB analysis.  The junction is evaluated at
+   all the time samples in one loop, the stamps are written directly
+   and the operating points are the ones of the last sample. */
+void diode::calcHB (hbstamps & s) {
+  int n = s.getSamples ();
+  nr_double_t U = 0, Cd = 0;
+  for (int f = 0; f < n; f++) {
+    nr_double_t * v = s.v (f), * y = s.y (f), * qv = s.qv (f);
+    nr_double_t * i = s.i (f), * q = s.q (f);
+    nr_double_t * gv = s.gv (f), * cv = s.cv (f);
+
+    // g's (dI/dU) and I's at the limited junction voltage
+    deviceState (f);
+    U = v[NODE_A] - v[NODE_C];
+    calcJunction (U);
+    i[NODE_C] = +Id;
+    i[NODE_A] = -Id;
+    gv[NODE_C] = -gd * Ud;
+    gv[NODE_A] = +gd * Ud;
+    y[NODE_C * 2 + NODE_C] = +gd; y[NODE_A * 2 + NODE_A] = +gd;
+    y[NODE_C * 2 + NODE_A] = -gd; y[NODE_A * 2 + NODE_C] = -gd;
+
+    // Q's and C's (dQ/dU) at the junction voltage
+    Ud = U;
+    Cd = calcCharge ();
+    q[NODE_C] = +Qd;
+    q[NODE_A] = -Qd;
+    cv[NODE_C] = -Cd * Ud;
+    cv[NODE_A] = +Cd * Ud;
+    qv[NODE_C * 2 + NODE_C] = +Cd; qv[NODE_A * 2 + NODE_A] = +Cd;
+    qv[NODE_C * 2 + NODE_A] = -Cd; qv[NODE_A * 2 + NODE_C] = -Cd;
+  }
+  setOperatingPoint ("Vd", U);
+  setOperatingPoint ("gd", gd);
+  setOperatingPoint ("Id", Id);
+  setOperatingPoint ("Cd", Cd);
+}
+
 // properties
 PROP_REQ [] = {
   { "Is", PROP_REAL, { 1e-15, PROP_NO_STR }, PROP_POS_RANGE },
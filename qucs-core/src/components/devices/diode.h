@@ -46,6 +46,7 @@ class diode : public qucs::circuit, public qucs::devstates
   void calcTR (nr_double_t);
   void initHB (int);
   void calcHB (int);
+  void calcHB (qucs::hbstamps &);
 
  private:
   nr_double_t Ud, gd, Id, Qd, Bv;
@@ -55,7 +56,12 @@ class diode : public qucs::circuit, public qucs::devstates
  private:
   qucs::matrix calcMatrixCy (nr_double_t);
   void prepareDC (void);
+  void calcJunction (nr_double_t);
+  nr_double_t calcCharge (void);
   void initModel (void);
+  // cached property bindings
+  qucs::parameter pIs, pN, pIsr, pNr, pIkf, pTemp, pM, pCj0, pVj, pFc, pCp,
+    pTt;
 };
 
 #endif /* __DIODE_H__ */
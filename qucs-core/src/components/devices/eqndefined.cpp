@@ -28,6 +28,7 @@
 
 #include "component.h"
 #include "equation.h"
+#include "bytecode.h"
 #include "environment.h"
 #include "device.h"
 #include "eqndefined.h"
@@ -47,6 +48,9 @@ eqndefined::eqndefined () : circuit () {
   _jstat = NULL;
   _jdyna = NULL;
   _charges = NULL;
+  program = NULL;
+  _ireg = NULL;
+  compiled = false;
 }
 
 // Destructor deletes equation defined device object from memory.
@@ -59,12 +63,15 @@ eqndefined::~eqndefined () {
   free (_jstat);
   free (_jdyna);
   free (_charges);
+  free (_ireg);
+  delete program;
 }
 
 // Callback for initializing the DC analysis.
 void eqndefined::initDC (void) {
   allocMatrixMNA ();
   if (ieqn == NULL) initModel ();
+  compileModel ();
   doHB = false;
 }
 
@@ -110,8 +117,10 @@ void eqndefined::setResult (void * eqn, nr_double_t val) {
   c->d = val;
 }
 
-// Returns the result of the equation.
-nr_double_t eqndefined::getResult (void * eqn) {
+/* Returns the result of the equation, either from the given register
+   of the compiled equations or by evaluating the equation tree. */
+nr_double_t eqndefined::getResult (void * eqn, int reg) {
+  if (compiled) return program->get (reg);
   A(eqn)->evaluate ();
   return A(eqn)->getResultDouble ();
 }
@@ -265,6 +274,48 @@ void eqndefined::initModel (void) {
   }
 }
 
+/* Compiles the current, charge and derivative equations into bytecode.
+   This is redone when an analysis gets initialized since the equation
+   nodes may have been changed by the equation checker meanwhile.  If
+   any of the equations cannot be compiled the device falls back to
+   the equation solver. */
+void eqndefined::compileModel (void) {
+  int i, branches = getSize () / 2;
+
+  delete program;
+  program = new bytecode ();
+  compiled = false;
+  if (_ireg == NULL) {
+    _ireg = (int *) malloc (sizeof (int) * 2 * branches * (branches + 1));
+    _qreg = _ireg + branches;
+    _greg = _qreg + branches;
+    _creg = _greg + branches * branches;
+  }
+
+  // the branch voltages get assigned directly
+  bool ok = true;
+  for (i = 0; ok && i < branches; i++) {
+    ok = A(veqn[i])->body->getTag () == CONSTANT;
+  }
+  for (i = 0; ok && i < branches; i++) {
+    ok = (_ireg[i] = program->compile (A(ieqn[i]))) >= 0 &&
+      (_qreg[i] = program->compile (A(qeqn[i]))) >= 0;
+  }
+  for (i = 0; ok && i < branches * branches; i++) {
+    ok = (_greg[i] = program->compile (A(geqn[i]))) >= 0 &&
+      (_creg[i] = program->compile (A(ceqn[i]))) >= 0;
+  }
+  if (!ok) {
+    delete program;
+    program = NULL;
+  }
+#if DEBUG
+  if (program)
+    logprint (LOG_STATUS, "DEBUG: EDD `%s' compiled into %d instructions\n",
+	      getName (), program->size ());
+#endif
+}
+
 // Update local variable equations.
 void eqndefined::updateLocals (void) {
   int i, branches = getSize () / 2;
@@ -273,9 +324,16 @@ void eqndefined::updateLocals (void) {
   for (i = 0; i < branches; i++) {
     setResult (veqn[i], BP (i));
   }
+  runLocals ();
+}
+
+// Evaluates the local equations at the current branch voltages.
+void eqndefined::runLocals (void) {
   // get local subcircuit values
   getEnv()->passConstants ();
-  getEnv()->equationSolver ();
+  // run the compiled equations if possible, the solver otherwise
+  compiled = program != NULL && program->run () == 0;
+  if (!compiled) getEnv()->equationSolver ();
 }
 
 // Callback for DC analysis.
@@ -287,7 +345,7 @@ void eqndefined::calcDC (void) {
 
   // calculate currents and put into right-hand side
   for (i = 0; i < branches; i++) {
-    nr_double_t c = getResult (ieqn[i]);
+    nr_double_t c = getResult (ieqn[i], _ireg[i]);
     setI (i * 2 + 0, -c);
     setI (i * 2 + 1, +c);
   }
@@ -297,7 +355,7 @@ void eqndefined::calcDC (void) {
     nr_double_t gv = 0;
     // usual G (dI/dV) entries
     for (j = 0; j < branches; j++, k++) {
-      nr_double_t g = getResult (geqn[k]);
+      nr_double_t g = getResult (geqn[k], _greg[k]);
       setY (i * 2 + 0, j * 2 + 0, +g);
       setY (i * 2 + 1, j * 2 + 1, +g);
       setY (i * 2 + 0, j * 2 + 1, -g);
@@ -323,12 +381,12 @@ void eqndefined::evalOperatingPoints (void) {
 
   // save values for charges, conductances and capacitances
   for (k = 0, i = 0; i < branches; i++) {
-    nr_double_t q = getResult (qeqn[i]);
+    nr_double_t q = getResult (qeqn[i], _qreg[i]);
     _charges[i] = q;
     for (j = 0; j < branches; j++, k++) {
-      nr_double_t g = getResult (geqn[k]);
+      nr_double_t g = getResult (geqn[k], _greg[k]);
       _jstat[k] = g;
-      nr_double_t c = getResult (ceqn[k]);
+      nr_double_t c = getResult (ceqn[k], _creg[k]);
       _jdyna[k] = c;
     }
   }
@@ -342,6 +400,9 @@ void eqndefined::saveOperatingPoints (void) {
 
   // save values for charges, conductances and capacitances
   evalOperatingPoints ();
+
+  // bring the remaining subcircuit equations up to date
+  if (compiled) getEnv()->equationSolver ();
 }
 
 // Callback for initializing the AC analysis.
@@ -427,6 +488,7 @@ void eqndefined::calcSP (nr_double_t frequency) {
 void eqndefined::initHB (int) {
   allocMatrixHB ();
   if (ieqn == NULL) initModel ();
+  compileModel ();
   doHB = true;
 }
 
@@ -464,6 +526,61 @@ void eqndefined::calcHB (int) {
   }
 }
 
+/* Batched callback for HB analysis.  The equations are evaluated once
+   per time sample at the branch voltages of the sample, each current,
+   charge and derivative is stamped directly. */
+void eqndefined::calcHB (hbstamps & s) {
+  int i, j, k, f, size = getSize (), branches = size / 2;
+  int n = s.getSamples ();
+
+  for (f = 0; f < n; f++) {
+    nr_double_t * v = s.v (f), * y = s.y (f), * qv = s.qv (f);
+    nr_double_t * I = s.i (f), * Q = s.q (f);
+    nr_double_t * GV = s.gv (f), * CV = s.cv (f);
+
+    // update local equations
+    for (i = 0; i < branches; i++) {
+      setResult (veqn[i], v[i * 2 + 0] - v[i * 2 + 1]);
+    }
+    runLocals ();
+
+    // currents and charges into the right-hand sides
+    for (i = 0; i < branches; i++) {
+      nr_double_t c = getResult (ieqn[i], _ireg[i]);
+      I[i * 2 + 0] = -c;
+      I[i * 2 + 1] = +c;
+      nr_double_t q = getResult (qeqn[i], _qreg[i]);
+      _charges[i] = q;
+      Q[i * 2 + 0] = -q;
+      Q[i * 2 + 1] = +q;
+    }
+
+    // G's (dI/dV) and C's (dQ/dV) with their products with the voltages
+    for (k = 0, i = 0; i < branches; i++) {
+      nr_double_t gv = 0, cv = 0;
+      int r = i * 2;
+      for (j = 0; j < branches; j++, k++) {
+	int c = j * 2;
+	nr_double_t u = v[c + 0] - v[c + 1];
+	nr_double_t g = getResult (geqn[k], _greg[k]);
+	nr_double_t C = getResult (ceqn[k], _creg[k]);
+	_jstat[k] = g;
+	_jdyna[k] = C;
+	y[(r + 0) * size + c + 0] = +g;  qv[(r + 0) * size + c + 0] = +C;
+	y[(r + 1) * size + c + 1] = +g;  qv[(r + 1) * size + c + 1] = +C;
+	y[(r + 0) * size + c + 1] = -g;  qv[(r + 0) * size + c + 1] = -C;
+	y[(r + 1) * size + c + 0] = -g;  qv[(r + 1) * size + c + 0] = -C;
+	gv += g * u;
+	cv += C * u;
+      }
+      GV[r + 0] = +gv;
+      GV[r + 1] = -gv;
+      CV[r + 0] = +cv;
+      CV[r + 1] = -cv;
+    }
+  }
+}
+
 // properties
 PROP_REQ [] = {
   { "I1", PROP_REAL, { 0, PROP_NO_STR }, PROP_NO_RANGE },
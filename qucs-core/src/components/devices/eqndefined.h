@@ -25,6 +25,8 @@
 #ifndef __EQNDEFINED_H__
 #define __EQNDEFINED_H__
 
+namespace qucs { namespace eqn { class bytecode; } }
+
 class eqndefined : public qucs::circuit
 {
  public:
@@ -41,16 +43,19 @@ class eqndefined : public qucs::circuit
   void calcTR (nr_double_t);
   void initHB (int);
   void calcHB (int);
+  void calcHB (qucs::hbstamps &);
 
  private:
   void initModel (void);
+  void compileModel (void);
   char * createVariable (const char *, int, int, bool prefix = true);
   char * createVariable (const char *, int, bool prefix = true);
   void setResult (void *, nr_double_t);
-  nr_double_t getResult (void *);
+  nr_double_t getResult (void *, int);
   qucs::matrix calcMatrixY (nr_double_t);
   void evalOperatingPoints (void);
   void updateLocals (void);
+  void runLocals (void);
 
  private:
   void ** veqn;
@@ -61,6 +66,13 @@ class eqndefined : public qucs::circuit
   nr_double_t * _jstat;
   nr_double_t * _jdyna;
   nr_double_t * _charges;
+  // compiled equations and result registers of the I, Q, G and C's
+  qucs::eqn::bytecode * program;
+  int * _ireg;
+  int * _qreg;
+  int * _greg;
+  int * _creg;
+  bool compiled;
   bool doHB;
 };
 
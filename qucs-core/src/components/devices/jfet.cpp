@@ -37,9 +37,13 @@
 using namespace qucs;
 using namespace qucs::device;
 
-jfet::jfet () : circuit (3) {
+jfet::jfet () : circuit (3),
+  pIs ("Is"), pN ("N"), pIsr ("Isr"), pNr ("Nr"), pVt0 ("Vt0"),
+  pLambda ("Lambda"), pBeta ("Beta"), pTemp ("Temp"), pM ("M"),
+  pCgd ("Cgd"), pCgs ("Cgs"), pPb ("Pb"), pFc ("Fc") {
   rs = rd = NULL;
   type = CIR_JFET;
+  setParallel (true);
 }
 
 void jfet::calcSP (nr_double_t frequency) {
@@ -103,56 +107,60 @@ matrix jfet::calcMatrixCy (nr_double_t frequency) {
   return cy;
 }
 
+// The model properties the temperature scaled JFET parameters depend on.
+static const char * const jfetCard[] = {
+  "Temp", "Tnom", "Is", "N", "Xti", "Isr", "Nr", "Pb", "M", "Vt0", "Vt0tc",
+  "Beta", "Betatce", NULL };
+
 void jfet::initModel (void) {
   // fetch necessary device properties
-  nr_double_t T  = getPropertyDouble ("Temp");
-  nr_double_t Tn = getPropertyDouble ("Tnom");
   nr_double_t A  = getPropertyDouble ("Area");
 
-  // compute Is temperature and area dependency
-  nr_double_t Is  = getPropertyDouble ("Is");
-  nr_double_t N   = getPropertyDouble ("N");
-  nr_double_t Xti = getPropertyDouble ("Xti");
-  nr_double_t T1, T2, Eg;
-  T2 = celsius2kelvin (T);
-  T1 = celsius2kelvin (Tn);
-  Eg = Egap (300);
-  Is = pnCurrent_T (T1, T2, Is, Eg, N, Xti);
-  setScaledProperty ("Is", Is * A);
-
-  // compute Isr temperature and area dependency
-  nr_double_t Isr = getPropertyDouble ("Isr");
-  nr_double_t Nr  = getPropertyDouble ("Nr");
-  Isr = pnCurrent_T (T1, T2, Isr, Eg, Nr, Xti);
-  setScaledProperty ("Isr", Isr * A);
-
-  // compute Pb temperature dependency
-  nr_double_t Pb = getPropertyDouble ("Pb");
-  nr_double_t PbT;
-  PbT = pnPotential_T (T1,T2, Pb);
-  setScaledProperty ("Pb", PbT);
-
-  // compute Cgs and Cgd temperature and area dependency
-  nr_double_t Cgs = getPropertyDouble ("Cgs");
-  nr_double_t Cgd = getPropertyDouble ("Cgd");
-  nr_double_t M   = getPropertyDouble ("M");
-  nr_double_t F;
-  F = A * pnCapacitance_F (T1, T2, M, PbT / Pb);
-  setScaledProperty ("Cgs", Cgs * F);
-  setScaledProperty ("Cgd", Cgd * F);
-
-  // compute Vth temperature dependency
-  nr_double_t Vt0   = getPropertyDouble ("Vt0");
-  nr_double_t Vt0tc = getPropertyDouble ("Vt0tc");
-  nr_double_t DT    = T2 - T1;
-  Vt0 = Vt0 + Vt0tc * DT;
-  setScaledProperty ("Vt0", Vt0);
-
-  // compute Beta temperature and area dependency
-  nr_double_t Beta    = getPropertyDouble ("Beta");
-  nr_double_t Betatce = getPropertyDouble ("Betatce");
-  Beta = Beta * qucs::exp (Betatce * DT * qucs::log (1.01));
-  setScaledProperty ("Beta", Beta * A);
+  // the temperature dependencies are computed once per model card
+  std::vector<nr_double_t> card = modelCard (this, jfetCard);
+  nr_double_t p[6];
+  if (!modelCardLookup (card, p, 6)) {
+    nr_double_t T  = getPropertyDouble ("Temp");
+    nr_double_t Tn = getPropertyDouble ("Tnom");
+
+    // compute Is and Isr temperature dependency
+    nr_double_t N   = getPropertyDouble ("N");
+    nr_double_t Nr  = getPropertyDouble ("Nr");
+    nr_double_t Xti = getPropertyDouble ("Xti");
+    nr_double_t T1, T2, Eg;
+    T2 = celsius2kelvin (T);
+    T1 = celsius2kelvin (Tn);
+    Eg = Egap (300);
+    p[0] = pnCurrent_T (T1, T2, getPropertyDouble ("Is"), Eg, N, Xti);
+    p[1] = pnCurrent_T (T1, T2, getPropertyDouble ("Isr"), Eg, Nr, Xti);
+
+    // compute Pb temperature dependency and the capacitance factor
+    nr_double_t Pb = getPropertyDouble ("Pb");
+    nr_double_t M  = getPropertyDouble ("M");
+    p[2] = pnPotential_T (T1,T2, Pb);
+    p[3] = pnCapacitance_F (T1, T2, M, p[2] / Pb);
+
+    // compute Vth temperature dependency
+    nr_double_t Vt0tc = getPropertyDouble ("Vt0tc");
+    nr_double_t DT    = T2 - T1;
+    p[4] = getPropertyDouble ("Vt0") + Vt0tc * DT;
+
+    // compute Beta temperature dependency
+    nr_double_t Betatce = getPropertyDouble ("Betatce");
+    p[5] = getPropertyDouble ("Beta") *
+      qucs::exp (Betatce * DT * qucs::log (1.01));
+    modelCardStore (card, p, 6);
+  }
+
+  // apply the area dependencies
+  setScaledProperty ("Is", p[0] * A);
+  setScaledProperty ("Isr", p[1] * A);
+  setScaledProperty ("Pb", p[2]);
+  nr_double_t F = A * p[3];
+  setScaledProperty ("Cgs", getPropertyDouble ("Cgs") * F);
+  setScaledProperty ("Cgd", getPropertyDouble ("Cgd") * F);
+  setScaledProperty ("Vt0", p[4]);
+  setScaledProperty ("Beta", p[5] * A);
 
   // compute Rs and Rd area dependency
   nr_double_t Rs = getPropertyDouble ("Rs");
@@ -218,23 +226,29 @@ void jfet::initDC (void) {
 
 void jfet::calcDC (void) {
 
+  // skip the evaluation if the junction voltages did not change
+  nr_double_t U[2];
+  U[0] = real (getV (NODE_G) - getV (NODE_S)) * pol;
+  U[1] = real (getV (NODE_G) - getV (NODE_D)) * pol;
+  if (checkBypass (U, 2)) return;
+
   // fetch device model parameters
-  nr_double_t Is   = getScaledProperty ("Is");
-  nr_double_t n    = getPropertyDouble ("N");
-  nr_double_t Isr  = getScaledProperty ("Isr");
-  nr_double_t nr   = getPropertyDouble ("Nr");
-  nr_double_t Vt0  = getScaledProperty ("Vt0");
-  nr_double_t l    = getPropertyDouble ("Lambda");
-  nr_double_t beta = getScaledProperty ("Beta");
-  nr_double_t T    = getPropertyDouble ("Temp");
+  nr_double_t Is   = getScaledProperty (pIs);
+  nr_double_t n    = getPropertyDouble (pN);
+  nr_double_t Isr  = getScaledProperty (pIsr);
+  nr_double_t nr   = getPropertyDouble (pNr);
+  nr_double_t Vt0  = getScaledProperty (pVt0);
+  nr_double_t l    = getPropertyDouble (pLambda);
+  nr_double_t beta = getScaledProperty (pBeta);
+  nr_double_t T    = getPropertyDouble (pTemp);
 
   nr_double_t Ut, IeqG, IeqD, IeqS, UgsCrit, UgdCrit;
   nr_double_t Igs, Igd, gtiny;
 
   T = celsius2kelvin (T);
   Ut = T * kBoverQ;
-  Ugd = real (getV (NODE_G) - getV (NODE_D)) * pol;
-  Ugs = real (getV (NODE_G) - getV (NODE_S)) * pol;
+  Ugs = U[0];
+  Ugd = U[1];
 
   // critical voltage necessary for bad start values
   UgsCrit = pnCriticalVoltage (Is, Ut * n);
@@ -327,6 +341,9 @@ void jfet::calcDC (void) {
   setY (NODE_S, NODE_G, -ggs - gm);
   setY (NODE_S, NODE_D, -gds);
   setY (NODE_S, NODE_S, ggs + gds + gm);
+  U[0] = Ugs;
+  U[1] = Ugd;
+  saveBypass (U, 2);
 }
 
 void jfet::loadOperatingPoints (void) {
@@ -347,21 +364,19 @@ void jfet::saveOperatingPoints (void) {
 void jfet::calcOperatingPoints (void) {
 
   // fetch device model parameters
-  nr_double_t z    = getPropertyDouble ("M");
-  nr_double_t Cgd0 = getScaledProperty ("Cgd");
-  nr_double_t Cgs0 = getScaledProperty ("Cgs");
-  nr_double_t Pb   = getScaledProperty ("Pb");
-  nr_double_t Fc   = getPropertyDouble ("Fc");
+  nr_double_t z    = getPropertyDouble (pM);
+  nr_double_t Cgd0 = getScaledProperty (pCgd);
+  nr_double_t Cgs0 = getScaledProperty (pCgs);
+  nr_double_t Pb   = getScaledProperty (pPb);
+  nr_double_t Fc   = getPropertyDouble (pFc);
 
   nr_double_t Cgs, Cgd;
 
   // capacitance of gate-drain diode
-  Cgd = pnCapacitance (Ugd, Cgd0, Pb, z, Fc);
-  Qgd = pnCharge (Ugd, Cgd0, Pb, z, Fc);
+  pnDepletion (Ugd, Cgd0, Pb, z, Fc, Qgd, Cgd);
 
   // capacitance of gate-source diode
-  Cgs = pnCapacitance (Ugs, Cgs0, Pb, z, Fc);
-  Qgs = pnCharge (Ugs, Cgs0, Pb, z, Fc);
+  pnDepletion (Ugs, Cgs0, Pb, z, Fc, Qgs, Cgs);
 
   // save operating points
   setOperatingPoint ("ggs", ggs);
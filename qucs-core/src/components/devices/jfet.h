@@ -53,6 +53,9 @@ class jfet : public qucs::circuit
   nr_double_t ggs, ggd, gm, gds, Ids, Qgs, Qgd;
   qucs::circuit * rs;
   qucs::circuit * rd;
+  // cached property bindings
+  qucs::parameter pIs, pN, pIsr, pNr, pVt0, pLambda, pBeta, pTemp, pM, pCgd,
+    pCgs, pPb, pFc;
 };
 
 #endif /* __JFET_H__ */
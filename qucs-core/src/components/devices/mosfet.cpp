@@ -38,10 +38,15 @@
 using namespace qucs;
 using namespace qucs::device;
 
-mosfet::mosfet () : circuit (4) {
+mosfet::mosfet () : circuit (4),
+  pIsd ("Isd"), pIss ("Iss"), pN ("N"), pLambda ("Lambda"), pTemp ("Temp"),
+  pCbd ("Cbd"), pCbs ("Cbs"), pCbds ("Cbds"), pCbss ("Cbss"),
+  pCgso ("Cgso"), pCgdo ("Cgdo"), pCgbo ("Cgbo"), pPb ("Pb"), pMj ("Mj"),
+  pMjsw ("Mjsw"), pFc ("Fc"), pTt ("Tt"), pW ("W"), pCapModel ("capModel") {
   transientMode = 0;
   rg = rs = rd = NULL;
   type = CIR_MOSFET;
+  setParallel (true);
 }
 
 void mosfet::calcSP (nr_double_t frequency) {
@@ -187,28 +192,21 @@ void mosfet::initDC (void) {
   }
 }
 
-void mosfet::initModel (void) {
+// The model properties the temperature scaled MOSFET parameters depend on.
+static const char * const mosfetCard[] = {
+  "Temp", "Tnom", "Tox", "Kp", "Uo", "Phi", "Nsub", "Gamma", "Vt0", "Tpg",
+  "Nss", "Cj", "Mj", "Mjsw", "Pb", NULL };
+
+/* Computes the temperature scaled parameters of the MOSFET model which
+   do not depend on the geometry of the instance. */
+void mosfet::initModelCard (nr_double_t * p) {
 
   // get device temperature
   nr_double_t T  = getPropertyDouble ("Temp");
   nr_double_t T2 = celsius2kelvin (getPropertyDouble ("Temp"));
   nr_double_t T1 = celsius2kelvin (getPropertyDouble ("Tnom"));
 
-  // apply polarity of MOSFET
-  const char * const type = getPropertyString ("Type");
-  pol = !strcmp (type, "pfet") ? -1 : 1;
-
-  // calculate effective channel length
-  nr_double_t L  = getPropertyDouble ("L");
-  nr_double_t Ld = getPropertyDouble ("Ld");
-  if ((Leff = L - 2 * Ld) <= 0) {
-    logprint (LOG_STATUS, "WARNING: effective MOSFET channel length %g <= 0, "
-	      "set to L = %g\n", Leff, L);
-    Leff = L;
-  }
-
-  // calculate gate oxide overlap capacitance
-  nr_double_t W   = getPropertyDouble ("W");
+  // calculate gate oxide capacitance per area
   nr_double_t Tox = getPropertyDouble ("Tox");
   if (Tox <= 0) {
     logprint (LOG_STATUS, "WARNING: disabling gate oxide capacitance, "
@@ -224,26 +222,12 @@ void mosfet::initModel (void) {
   nr_double_t F1 = qucs::exp (1.5 * qucs::log (T1 / T2));
   Kp = Kp * F1;
   Uo = Uo * F1;
-  setScaledProperty ("Kp", Kp);
-  setScaledProperty ("Uo", Uo);
-  if (Kp > 0) {
-    beta = Kp * W / Leff;
-  } else {
-    if (Cox > 0 && Uo > 0) {
-      beta = Uo * 1e-4 * Cox * W / Leff;
-    } else {
-      logprint (LOG_STATUS, "WARNING: adjust Tox, Uo or Kp to get a valid "
-		"transconductance coefficient\n");
-      beta = 2e-5 * W / Leff;
-    }
-  }
 
   // calculate surface potential
   nr_double_t P    = getPropertyDouble ("Phi");
   nr_double_t Nsub = getPropertyDouble ("Nsub");
   nr_double_t Ut   = T0 * kBoverQ;
   P = pnPotential_T (T1,T2, P);
-  setScaledProperty ("Phi", P);
   if ((Phi = P) <= 0) {
     if (Nsub > 0) {
       if (Nsub * 1e6 >= NiSi) {
@@ -295,19 +279,6 @@ void mosfet::initModel (void) {
     }
   }
 
-  Cox = Cox * W * Leff;
-
-  // calculate drain and source resistance if necessary
-  nr_double_t Rsh = getPropertyDouble ("Rsh");
-  nr_double_t Nrd = getPropertyDouble ("Nrd");
-  nr_double_t Nrs = getPropertyDouble ("Nrs");
-  Rd = getPropertyDouble ("Rd");
-  Rs = getPropertyDouble ("Rs");
-  if (Rsh > 0) {
-    if (Nrd > 0) Rd += Rsh * Nrd;
-    if (Nrs > 0) Rs += Rsh * Nrs;
-  }
-
   // calculate zero-bias junction capacitance
   nr_double_t Cj  = getPropertyDouble ("Cj");
   nr_double_t Mj  = getPropertyDouble ("Mj");
@@ -318,7 +289,6 @@ void mosfet::initModel (void) {
   F2  = pnCapacitance_F (T1, T2, Mj, PbT / Pb);
   F3  = pnCapacitance_F (T1, T2, Mjs, PbT / Pb);
   Pb  = PbT;
-  setScaledProperty ("Pb", Pb);
   if (Cj <= 0) {
     if (Pb > 0 && Nsub >= 0) {
       Cj = qucs::sqrt (ESi * E0 * Q_e * Nsub * 1e6 / 2 / Pb);
@@ -330,8 +300,76 @@ void mosfet::initModel (void) {
     }
   }
   Cj = Cj * F2;
+
+  // calculate saturation current factor
+  nr_double_t F4, E1, E2;
+  E1 = Egap (T1);
+  E2 = Egap (T2);
+  F4 = qucs::exp (- QoverkB / T2 * (T2 / T1 * E1 - E2));
+
+  p[0] = Cox; p[1] = Kp; p[2] = Uo; p[3] = P; p[4] = Phi; p[5] = Ga;
+  p[6] = Vto; p[7] = Pb; p[8] = Cj; p[9] = F2; p[10] = F3; p[11] = F4;
+}
+
+void mosfet::initModel (void) {
+
+  // apply polarity of MOSFET
+  const char * const type = getPropertyString ("Type");
+  pol = !strcmp (type, "pfet") ? -1 : 1;
+
+  // the temperature dependencies are computed once per model card
+  std::vector<nr_double_t> card = modelCard (this, mosfetCard);
+  card.push_back (pol);
+  nr_double_t p[12];
+  if (!modelCardLookup (card, p, 12)) {
+    initModelCard (p);
+    modelCardStore (card, p, 12);
+  }
+  nr_double_t Kp, Uo, Cj, F2, F3, F4;
+  Cox = p[0]; Kp = p[1]; Uo = p[2]; Phi = p[4]; Ga = p[5]; Vto = p[6];
+  Cj = p[8]; F2 = p[9]; F3 = p[10]; F4 = p[11];
+  setScaledProperty ("Kp", Kp);
+  setScaledProperty ("Uo", Uo);
+  setScaledProperty ("Phi", p[3]);
+  setScaledProperty ("Pb", p[7]);
   setScaledProperty ("Cj", Cj);
 
+  // calculate effective channel length
+  nr_double_t L  = getPropertyDouble ("L");
+  nr_double_t Ld = getPropertyDouble ("Ld");
+  if ((Leff = L - 2 * Ld) <= 0) {
+    logprint (LOG_STATUS, "WARNING: effective MOSFET channel length %g <= 0, "
+	      "set to L = %g\n", Leff, L);
+    Leff = L;
+  }
+
+  // calculate DC transconductance coefficient
+  nr_double_t W = getPropertyDouble ("W");
+  if (Kp > 0) {
+    beta = Kp * W / Leff;
+  } else {
+    if (Cox > 0 && Uo > 0) {
+      beta = Uo * 1e-4 * Cox * W / Leff;
+    } else {
+      logprint (LOG_STATUS, "WARNING: adjust Tox, Uo or Kp to get a valid "
+		"transconductance coefficient\n");
+      beta = 2e-5 * W / Leff;
+    }
+  }
+
+  Cox = Cox * W * Leff;
+
+  // calculate drain and source resistance if necessary
+  nr_double_t Rsh = getPropertyDouble ("Rsh");
+  nr_double_t Nrd = getPropertyDouble ("Nrd");
+  nr_double_t Nrs = getPropertyDouble ("Nrs");
+  Rd = getPropertyDouble ("Rd");
+  Rs = getPropertyDouble ("Rs");
+  if (Rsh > 0) {
+    if (Nrd > 0) Rd += Rsh * Nrd;
+    if (Nrs > 0) Rs += Rsh * Nrs;
+  }
+
   // calculate junction capacitances
   nr_double_t Cbd0 = getPropertyDouble ("Cbd");
   nr_double_t Cbs0 = getPropertyDouble ("Cbs");
@@ -359,10 +397,6 @@ void mosfet::initModel (void) {
   // calculate junction capacitances and saturation currents
   nr_double_t Js  = getPropertyDouble ("Js");
   nr_double_t Is  = getPropertyDouble ("Is");
-  nr_double_t F4, E1, E2;
-  E1 = Egap (T1);
-  E2 = Egap (T2);
-  F4 = qucs::exp (- QoverkB / T2 * (T2 / T1 * E1 - E2));
   Is = Is * F4;
   Js = Js * F4;
   nr_double_t Isd = (Ad > 0) ? Js * Ad : Is;
@@ -376,63 +410,38 @@ void mosfet::initModel (void) {
 #endif /* DEBUG */
 }
 
-void mosfet::calcDC (void) {
-
-  // fetch device model parameters
-  nr_double_t Isd = getPropertyDouble ("Isd");
-  nr_double_t Iss = getPropertyDouble ("Iss");
-  nr_double_t n   = getPropertyDouble ("N");
-  nr_double_t l   = getPropertyDouble ("Lambda");
-  nr_double_t T   = getPropertyDouble ("Temp");
-
-  nr_double_t Ut, IeqBS, IeqBD, IeqDS, UbsCrit, UbdCrit, gtiny;
-
-  T = celsius2kelvin (T);
-  Ut = T * kBoverQ;
-  Ugd = real (getV (NODE_G) - getV (NODE_D)) * pol;
-  Ugs = real (getV (NODE_G) - getV (NODE_S)) * pol;
-  Ubs = real (getV (NODE_B) - getV (NODE_S)) * pol;
-  Ubd = real (getV (NODE_B) - getV (NODE_D)) * pol;
-  Uds = Ugs - Ugd;
-
-  // critical voltage necessary for bad start values
-  UbsCrit = pnCriticalVoltage (Iss, Ut * n);
-  UbdCrit = pnCriticalVoltage (Isd, Ut * n);
-
-  // for better convergence
-  if (Uds >= 0) {
-    Ugs = fetVoltage (Ugs, UgsPrev, Vto * pol);
-    Uds = Ugs - Ugd;
-    Uds = fetVoltageDS (Uds, UdsPrev);
-    Ugd = Ugs - Uds;
-  }
-  else {
-    Ugd = fetVoltage (Ugd, UgdPrev, Vto * pol);
-    Uds = Ugs - Ugd;
-    Uds = -fetVoltageDS (-Uds, -UdsPrev);
-    Ugs = Ugd + Uds;
-  }
-  if (Uds >= 0) {
-    Ubs = pnVoltage (Ubs, UbsPrev, Ut * n, UbsCrit);
-    Ubd = Ubs - Uds;
-  }
-  else {
-    Ubd = pnVoltage (Ubd, UbdPrev, Ut * n, UbdCrit);
-    Ubs = Ubd + Uds;
-  }
-  UgsPrev = Ugs; UgdPrev = Ugd; UbdPrev = Ubd; UdsPrev = Uds; UbsPrev = Ubs;
+/* The function completes the currents and conductances of the bulk
+   diodes given the pn-junction currents.  It is shared by the single
+   instance and the batched model evaluation. */
+static inline void mosfetJunctions (nr_double_t Ubs, nr_double_t Ubd,
+				    nr_double_t Iss, nr_double_t Isd,
+				    nr_double_t& Ibs, nr_double_t& gbs,
+				    nr_double_t& Ibd, nr_double_t& gbd) {
+  nr_double_t gtiny;
 
   // parasitic bulk-source diode
   gtiny = Iss;
-  pnJunctionMOS (Ubs, Iss, Ut * n, Ibs, gbs);
   Ibs += gtiny * Ubs;
   gbs += gtiny;
 
   // parasitic bulk-drain diode
   gtiny = Isd;
-  pnJunctionMOS (Ubd, Isd, Ut * n, Ibd, gbd);
   Ibd += gtiny * Ubd;
   gbd += gtiny;
+}
+
+/* The function computes the drain current and its derivatives for
+   the given (limited) voltages.  It is shared by the single instance
+   and the batched model evaluation. */
+static inline void mosfetChannel (nr_double_t Ugs, nr_double_t Ugd,
+				  nr_double_t Ubs, nr_double_t Ubd,
+				  nr_double_t Uds, nr_double_t Vto,
+				  nr_double_t Ga, nr_double_t Phi,
+				  nr_double_t beta, nr_double_t l,
+				  nr_double_t pol, nr_double_t& MOSdir,
+				  nr_double_t& Uon, nr_double_t& Udsat,
+				  nr_double_t& Ids, nr_double_t& gm,
+				  nr_double_t& gds, nr_double_t& gmb) {
 
   // differentiate inverse and forward mode
   MOSdir = (Uds >= 0) ? +1 : -1;
@@ -451,7 +460,7 @@ void mosfet::calcDC (void) {
   }
 
   // calculate bias-dependent threshold voltage
-  Uon = Vto * pol + Ga * (Sarg - Sphi);
+  Uon = Vto + Ga * (Sarg - Sphi);
   nr_double_t Utst = ((MOSdir > 0) ? Ugs : Ugd) - Uon;
   // no infinite backgate transconductance (if non-zero Ga)
   nr_double_t arg = (Sarg != 0.0) ? (Ga / Sarg / 2) : 0;
@@ -483,6 +492,59 @@ void mosfet::calcDC (void) {
   Udsat = pol * std::max (Utst, 0.0);
   Ids = MOSdir * Ids;
   Uon = pol * Uon;
+}
+
+// Fetches the gate-source, gate-drain and bulk-source voltages.
+void mosfet::controlVoltages (nr_double_t * U) {
+  U[0] = real (getV (NODE_G) - getV (NODE_S)) * pol;
+  U[1] = real (getV (NODE_G) - getV (NODE_D)) * pol;
+  U[2] = real (getV (NODE_B) - getV (NODE_S)) * pol;
+}
+
+/* The function limits the given control voltages with respect to the
+   previous iteration for better convergence. */
+void mosfet::limitVoltages (nr_double_t * U, nr_double_t nUt,
+			    nr_double_t Iss, nr_double_t Isd) {
+  nr_double_t UbsCrit, UbdCrit;
+
+  Ugs = U[0];
+  Ugd = U[1];
+  Ubs = U[2];
+  Ubd = real (getV (NODE_B) - getV (NODE_D)) * pol;
+  Uds = Ugs - Ugd;
+
+  // critical voltage necessary for bad start values
+  UbsCrit = pnCriticalVoltage (Iss, nUt);
+  UbdCrit = pnCriticalVoltage (Isd, nUt);
+
+  // for better convergence
+  if (Uds >= 0) {
+    Ugs = fetVoltage (Ugs, UgsPrev, Vto * pol);
+    Uds = Ugs - Ugd;
+    Uds = fetVoltageDS (Uds, UdsPrev);
+    Ugd = Ugs - Uds;
+  }
+  else {
+    Ugd = fetVoltage (Ugd, UgdPrev, Vto * pol);
+    Uds = Ugs - Ugd;
+    Uds = -fetVoltageDS (-Uds, -UdsPrev);
+    Ugs = Ugd + Uds;
+  }
+  if (Uds >= 0) {
+    Ubs = pnVoltage (Ubs, UbsPrev, nUt, UbsCrit);
+    Ubd = Ubs - Uds;
+  }
+  else {
+    Ubd = pnVoltage (Ubd, UbdPrev, nUt, UbdCrit);
+    Ubs = Ubd + Uds;
+  }
+  UgsPrev = Ugs; UgdPrev = Ugd; UbdPrev = Ubd; UdsPrev = Uds; UbsPrev = Ubs;
+}
+
+/* The function fills in the G-MNA matrix and I-vector entries of the
+   evaluated model. */
+void mosfet::stampDC (void) {
+  nr_double_t IeqBS, IeqBD, IeqDS;
 
   // compute autonomic current sources
   IeqBD = Ibd - gbd * Ubd;
@@ -519,6 +581,125 @@ void mosfet::calcDC (void) {
   setY (NODE_B, NODE_D, -gbd);
   setY (NODE_B, NODE_S, -gbs);
   setY (NODE_B, NODE_B, gbs + gbd);
+
+  nr_double_t U[3] = { Ugs, Ugd, Ubs };
+  saveBypass (U, 3);
+}
+
+void mosfet::calcDC (void) {
+
+  // already evaluated by the batch
+  if (isEvaluated ()) {
+    setEvaluated (false);
+    return;
+  }
+
+  // skip the evaluation if the terminal voltages did not change
+  nr_double_t U[3];
+  controlVoltages (U);
+  if (checkBypass (U, 3)) return;
+
+  // fetch device model parameters
+  nr_double_t Isd = getPropertyDouble (pIsd);
+  nr_double_t Iss = getPropertyDouble (pIss);
+  nr_double_t n   = getPropertyDouble (pN);
+  nr_double_t l   = getPropertyDouble (pLambda);
+  nr_double_t T   = getPropertyDouble (pTemp);
+
+  T = celsius2kelvin (T);
+  nr_double_t Ut = T * kBoverQ;
+
+  limitVoltages (U, Ut * n, Iss, Isd);
+  pnJunctionMOS (Ubs, Iss, Ut * n, Ibs, gbs);
+  pnJunctionMOS (Ubd, Isd, Ut * n, Ibd, gbd);
+  mosfetJunctions (Ubs, Ubd, Iss, Isd, Ibs, gbs, Ibd, gbd);
+  mosfetChannel (Ugs, Ugd, Ubs, Ubd, Uds, Vto * pol, Ga, Phi, beta, l, pol,
+		 MOSdir, Uon, Udsat, Ids, gm, gds, gmb);
+  stampDC ();
+}
+
+// Creates the batch evaluating many MOSFET instances at once.
+circuitbatch * mosfet::createBatch (void) {
+  return new mosfetbatch ();
+}
+
+/* The function caches the model parameters of each instance of the
+   batch in structure-of-arrays form. */
+void mosfetbatch::prepare (void) {
+  int i, n = size ();
+  Vto.resize (n); Ga.resize (n); Phi.resize (n); beta.resize (n);
+  l.resize (n); pol.resize (n); nUt.resize (n); Iss.resize (n);
+  Isd.resize (n);
+  Ugs.resize (n); Ugd.resize (n); Ubs.resize (n); Ubd.resize (n);
+  Uds.resize (n);
+  Ibs.resize (n); gbs.resize (n); Ibd.resize (n); gbd.resize (n);
+  MOSdir.resize (n); Uon.resize (n); Udsat.resize (n); Ids.resize (n);
+  gm.resize (n); gds.resize (n); gmb.resize (n);
+  bypassed.resize (n);
+  for (i = 0; i < n; i++) {
+    mosfet * c = (mosfet *) circuits[i];
+    nr_double_t T = celsius2kelvin (c->getPropertyDouble ("Temp"));
+    nr_double_t Ut = T * kBoverQ;
+    pol[i]  = c->pol;
+    Vto[i]  = c->Vto * c->pol;
+    Ga[i]   = c->Ga;
+    Phi[i]  = c->Phi;
+    beta[i] = c->beta;
+    l[i]    = c->getPropertyDouble ("Lambda");
+    nUt[i]  = Ut * c->getPropertyDouble ("N");
+    Iss[i]  = c->getPropertyDouble ("Iss");
+    Isd[i]  = c->getPropertyDouble ("Isd");
+    Ugs[i] = Ugd[i] = Ubs[i] = Ubd[i] = Uds[i] = 0;
+  }
+}
+
+/* This function evaluates the DC model of the given range of MOSFET
+   instances.  The voltages are gathered and limited per instance,
+   then the model equations run over the contiguous arrays and the
+   results are finally scattered back into the instances. */
+void mosfetbatch::calcDC (int first, int last) {
+  int i;
+
+  // gather and limit the control voltages
+  for (i = first; i < last; i++) {
+    mosfet * c = (mosfet *) circuits[i];
+    nr_double_t U[3];
+    c->controlVoltages (U);
+    bypassed[i] = c->checkBypass (U, 3);
+    if (bypassed[i]) continue;
+    c->limitVoltages (U, nUt[i], Iss[i], Isd[i]);
+    Ugs[i] = c->Ugs; Ugd[i] = c->Ugd; Ubs[i] = c->Ubs; Ubd[i] = c->Ubd;
+    Uds[i] = c->Uds;
+  }
+
+  // bulk diodes
+  int n = last - first;
+  pnJunctionMOS (n, Ubs.data () + first, Iss.data () + first,
+		 nUt.data () + first, Ibs.data () + first, gbs.data () + first);
+  pnJunctionMOS (n, Ubd.data () + first, Isd.data () + first,
+		 nUt.data () + first, Ibd.data () + first, gbd.data () + first);
+  for (i = first; i < last; i++) {
+    mosfetJunctions (Ubs[i], Ubd[i], Iss[i], Isd[i],
+		     Ibs[i], gbs[i], Ibd[i], gbd[i]);
+  }
+
+  // drain current
+  for (i = first; i < last; i++) {
+    mosfetChannel (Ugs[i], Ugd[i], Ubs[i], Ubd[i], Uds[i], Vto[i], Ga[i],
+		   Phi[i], beta[i], l[i], pol[i], MOSdir[i], Uon[i],
+		   Udsat[i], Ids[i], gm[i], gds[i], gmb[i]);
+  }
+
+  // scatter the results and stamp them
+  for (i = first; i < last; i++) {
+    mosfet * c = (mosfet *) circuits[i];
+    c->setEvaluated (true);
+    if (bypassed[i]) continue;
+    c->Ibs = Ibs[i]; c->gbs = gbs[i]; c->Ibd = Ibd[i]; c->gbd = gbd[i];
+    c->MOSdir = MOSdir[i]; c->Uon = Uon[i]; c->Udsat = Udsat[i];
+    c->Ids = Ids[i]; c->gm = gm[i]; c->gds = gds[i]; c->gmb = gmb[i];
+    c->stampDC ();
+  }
 }
 
 /* Usual and additional state definitions. */
@@ -566,33 +747,34 @@ void mosfet::loadOperatingPoints (void) {
 void mosfet::calcOperatingPoints (void) {
 
   // fetch device model parameters
-  nr_double_t Cbd0 = getScaledProperty ("Cbd");
-  nr_double_t Cbs0 = getScaledProperty ("Cbs");
-  nr_double_t Cbds = getPropertyDouble ("Cbds");
-  nr_double_t Cbss = getPropertyDouble ("Cbss");
-  nr_double_t Cgso = getPropertyDouble ("Cgso");
-  nr_double_t Cgdo = getPropertyDouble ("Cgdo");
-  nr_double_t Cgbo = getPropertyDouble ("Cgbo");
-  nr_double_t Pb   = getScaledProperty ("Pb");
-  nr_double_t M    = getPropertyDouble ("Mj");
-  nr_double_t Ms   = getPropertyDouble ("Mjsw");
-  nr_double_t Fc   = getPropertyDouble ("Fc");
-  nr_double_t Tt   = getPropertyDouble ("Tt");
-  nr_double_t W    = getPropertyDouble ("W");
+  nr_double_t Cbd0 = getScaledProperty (pCbd);
+  nr_double_t Cbs0 = getScaledProperty (pCbs);
+  nr_double_t Cbds = getPropertyDouble (pCbds);
+  nr_double_t Cbss = getPropertyDouble (pCbss);
+  nr_double_t Cgso = getPropertyDouble (pCgso);
+  nr_double_t Cgdo = getPropertyDouble (pCgdo);
+  nr_double_t Cgbo = getPropertyDouble (pCgbo);
+  nr_double_t Pb   = getScaledProperty (pPb);
+  nr_double_t M    = getPropertyDouble (pMj);
+  nr_double_t Ms   = getPropertyDouble (pMjsw);
+  nr_double_t Fc   = getPropertyDouble (pFc);
+  nr_double_t Tt   = getPropertyDouble (pTt);
+  nr_double_t W    = getPropertyDouble (pW);
 
   nr_double_t Cbs, Cbd, Cgd, Cgb, Cgs;
 
   // capacitance of bulk-drain diode
-  Cbd = gbd * Tt + pnCapacitance (Ubd, Cbd0, Pb, M, Fc) +
-    pnCapacitance (Ubd, Cbds, Pb, Ms, Fc);
-  Qbd = Ibd * Tt + pnCharge (Ubd, Cbd0, Pb, M, Fc) +
-    pnCharge (Ubd, Cbds, Pb, Ms, Fc);
+  nr_double_t Qa, Qs, Ca, Cs;
+  pnDepletion (Ubd, Cbd0, Pb, M, Fc, Qa, Ca);
+  pnDepletion (Ubd, Cbds, Pb, Ms, Fc, Qs, Cs);
+  Cbd = gbd * Tt + Ca + Cs;
+  Qbd = Ibd * Tt + Qa + Qs;
 
   // capacitance of bulk-source diode
-  Cbs = gbs * Tt + pnCapacitance (Ubs, Cbs0, Pb, M, Fc) +
-    pnCapacitance (Ubs, Cbss, Pb, Ms, Fc);
-  Qbs = Ibs * Tt + pnCharge (Ubs, Cbs0, Pb, M, Fc) +
-    pnCharge (Ubs, Cbss, Pb, Ms, Fc);
+  pnDepletion (Ubs, Cbs0, Pb, M, Fc, Qa, Ca);
+  pnDepletion (Ubs, Cbss, Pb, Ms, Fc, Qs, Cs);
+  Cbs = gbs * Tt + Ca + Cs;
+  Qbs = Ibs * Tt + Qa + Qs;
 
   // calculate bias-dependent MOS overlap capacitances
   if (MOSdir > 0) {
@@ -659,7 +841,7 @@ void mosfet::initTR (void) {
 
 void mosfet::calcTR (nr_double_t) {
   calcDC ();
-  transientMode = getPropertyInteger ("capModel");
+  transientMode = getPropertyInteger (pCapModel);
   saveOperatingPoints ();
   loadOperatingPoints ();
   calcOperatingPoints ();
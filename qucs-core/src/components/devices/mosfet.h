@@ -35,6 +35,7 @@ class mosfet : public qucs::circuit
   void initDC (void);
   void restartDC (void);
   void initModel (void);
+  void initModelCard (nr_double_t *);
   void saveOperatingPoints (void);
   void calcOperatingPoints (void);
   void loadOperatingPoints (void);
@@ -44,7 +45,13 @@ class mosfet : public qucs::circuit
   void initTR (void);
   void calcTR (nr_double_t);
 
+  qucs::circuitbatch * createBatch (void);
+
  private:
+  friend class mosfetbatch;
+  void controlVoltages (nr_double_t *);
+  void limitVoltages (nr_double_t *, nr_double_t, nr_double_t, nr_double_t);
+  void stampDC (void);
   nr_double_t transientChargeTR (int, nr_double_t&, nr_double_t, nr_double_t);
   nr_double_t transientChargeSR (int, nr_double_t&, nr_double_t, nr_double_t);
   qucs::matrix calcMatrixY (nr_double_t);
@@ -60,6 +67,26 @@ class mosfet : public qucs::circuit
   qucs::circuit * rs;
   qucs::circuit * rd;
   qucs::circuit * rg;
+  // cached property bindings
+  qucs::parameter pIsd, pIss, pN, pLambda, pTemp, pCbd, pCbs, pCbds, pCbss,
+    pCgso, pCgdo, pCgbo, pPb, pMj, pMjsw, pFc, pTt, pW, pCapModel;
+};
+
+/* Batched DC evaluation of many MOSFET instances, the cached model
+   parameters, the limited voltages and the results are kept in
+   structure-of-arrays form. */
+class mosfetbatch : public qucs::circuitbatch
+{
+ public:
+  void prepare (void);
+  void calcDC (int, int);
+
+ private:
+  std::vector<nr_double_t> Vto, Ga, Phi, beta, l, pol, nUt, Iss, Isd;
+  std::vector<nr_double_t> Ugs, Ugd, Ubs, Ubd, Uds;
+  std::vector<nr_double_t> Ibs, gbs, Ibd, gbd, MOSdir, Uon, Udsat;
+  std::vector<nr_double_t> Ids, gm, gds, gmb;
+  std::vector<char> bypassed;
 };
 
 #endif /* __MOSFET_H__ */
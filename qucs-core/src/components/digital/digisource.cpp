@@ -62,6 +62,16 @@ void digisource::initTR (void) {
   qucs::vector * values = getPropertyVector ("times");
   T = real (sum (*values));
   initDC ();
+
+  // register the switching times of each period
+  nr_double_t stop = getNet()->getBreakpointStop ();
+  for (nr_double_t t = 0; T > 0 && t <= stop; t += T) {
+    nr_double_t ti = t;
+    for (int i = 0; i < values->getSize (); i++) {
+      ti += real (values->get (i));
+      getNet()->addBreakpoint (ti);
+    }
+  }
 }
 
 void digisource::calcTR (nr_double_t t) {
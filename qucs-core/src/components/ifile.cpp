@@ -28,6 +28,7 @@
 
 #include "component.h"
 #include "dataset.h"
+#include "filecache.h"
 #include "poly.h"
 #include "spline.h"
 #include "interpolator.h"
@@ -40,14 +41,10 @@ ifile::ifile () : circuit (2) {
   type = CIR_IFILE;
   setISource (true);
   interpolType = dataType = 0;
-  data = NULL;
-  inter = NULL;
 }
 
 // Destructor deletes ifile object from memory.
 ifile::~ifile () {
-  delete data;
-  delete inter;
 }
 
 void ifile::prepare (void) {
@@ -74,12 +71,12 @@ void ifile::prepare (void) {
 
   // load file with samples
   const char * file = getPropertyString ("File");
-  if (data == NULL) {
+  if (!data) {
     if (strlen (file) > 4 && !strcasecmp (&file[strlen (file) - 4], ".dat"))
-      data = dataset::load (file);
+      data = filecache::load (file, dataset::load);
     else
-      data = dataset::load_csv (file);
-    if (data != NULL) {
+      data = filecache::load (file, dataset::load_csv);
+    if (data) {
       // check number of variables / dependencies defined by that file
       if (data->countVariables () != 1 || data->countDependencies () != 1) {
 	logprint (LOG_ERROR, "ERROR: file `%s' must have time as an "
@@ -89,9 +86,15 @@ void ifile::prepare (void) {
       }
       qucs::vector * is = data->getVariables();    // current
       qucs::vector * ts = data->getDependencies(); // time
-      inter = new interpolator ();
-      inter->rvectors (is, ts);
-      inter->prepare (interpolType, dataType);
+      // instances with the same settings share the interpolator
+      char key[32];
+      sprintf (key, "interpolator %d %d", interpolType, dataType);
+      inter = filecache::prepared<interpolator> (data, key, [&] {
+	  interpolator * i = new interpolator ();
+	  i->rvectors (is, ts);
+	  i->prepare (interpolType, dataType);
+	  return i;
+	});
     }
   }
 }
@@ -25,6 +25,8 @@
 #ifndef __IFILE_H__
 #define __IFILE_H__
 
+#include <memory>
+
 namespace qucs {
   class dataset;
   class interpolator;
@@ -43,10 +45,10 @@ class ifile : public qucs::circuit
   void prepare (void);
 
 private:
-  qucs::dataset * data;
+  std::shared_ptr<qucs::dataset> data;
   int dataType;
   int interpolType;
-  qucs::interpolator * inter;
+  std::shared_ptr<qucs::interpolator> inter;
 };
 
 #endif /* __IFILE_H__ */
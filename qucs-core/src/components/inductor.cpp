@@ -34,6 +34,7 @@ using namespace qucs;
 inductor::inductor () : circuit (2) {
   type = CIR_INDUCTOR;
   setISource (true);
+  setParallel (true);
 }
 
 void inductor::calcSP (nr_double_t frequency) {
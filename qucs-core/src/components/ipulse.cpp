@@ -56,7 +56,16 @@ void ipulse::initAC (void) {
 }
 
 void ipulse::initTR (void) {
+  nr_double_t t1 = getPropertyDouble ("T1");
+  nr_double_t t2 = getPropertyDouble ("T2");
+  nr_double_t tr = getPropertyDouble ("Tr");
+  nr_double_t tf = getPropertyDouble ("Tf");
   initDC ();
+  // register the corners of the pulse
+  getNet()->addBreakpoint (t1);
+  getNet()->addBreakpoint (t1 + tr);
+  getNet()->addBreakpoint (t2 - tf);
+  getNet()->addBreakpoint (t2);
 }
 
 void ipulse::calcTR (nr_double_t t) {
@@ -32,6 +32,7 @@
 #include "component.h"
 #include "substrate.h"
 #include "cpwline.h"
+#include "fspecial.h"
 
 using namespace qucs;
 
@@ -71,11 +72,13 @@ nr_double_t cpwline::ellipk (nr_double_t k) {
   return (pi_over_2 / a);
 }
 
+/* The ratio K(k)/K'(k) is computed by the nome of the modulus, see
+   fspecial::ellip_kratio(), instead of two AGM iterations. */
 nr_double_t cpwline::KoverKp(nr_double_t k) {
   if ((k < 0.0) || (k >= 1.0))
     return std::numeric_limits<nr_double_t>::quiet_NaN();
 
-  return (ellipk(k) / ellipk(qucs::sqrt(1-k*k)));
+  return fspecial::ellip_kratio (k);
 }
 
 /* Approximation of K(k)/K'(k).
@@ -142,7 +145,7 @@ void cpwline::initPropagation (void) {
     if (approx) {
       q3 = ellipa (k3);
     } else {
-      q3 = ellipk (k3) / ellipk (qucs::sqrt (1 - k3 * k3));
+      q3 = KoverKp (k3);
     }
     qz  = 1 / (q1 + q3);
     er0 = 1 + q3 * qz * (er - 1);
@@ -154,7 +157,7 @@ void cpwline::initPropagation (void) {
     if (approx) {
       q2 = ellipa (k2);
     } else {
-      q2 = ellipk (k2) / ellipk (qucs::sqrt (1 - k2 * k2));
+      q2 = KoverKp (k2);
     }
     er0 = 1 + (er - 1) / 2 * q2 / q1;
     zl_factor = Z0 / 4 / q1;
@@ -170,7 +173,7 @@ void cpwline::initPropagation (void) {
     if (approx) {
       qe = ellipa (ke);
     } else {
-      qe = ellipk (ke) / ellipk (qucs::sqrt (1 - ke * ke));
+      qe = KoverKp (ke);
     }
     // backside is metal
     if (backMetal) {
@@ -285,12 +288,12 @@ void cpwline::analyseQuasiStatic (nr_double_t W, nr_double_t s, nr_double_t h,
 
   // compute the necessary quasi-static approx. (K1, K3, er(0) and Z(0))
   k1 = W / (W + s + s);
-  q1 = ellipk (k1) / ellipk (qucs::sqrt (1 - k1 * k1));
+  q1 = KoverKp (k1);
 
   // backside is metal
   if (backMetal) {
     k3  = qucs::tanh ((pi / 4) * (W / h)) / qucs::tanh ((pi / 4) * (W + s + s) / h);
-    q3 = ellipk (k3) / ellipk (qucs::sqrt (1 - k3 * k3));
+    q3 = KoverKp (k3);
     qz  = 1 / (q1 + q3);
     ErEff = 1 + q3 * qz * (er - 1);
     ZlEff = Z0 / 2 * qz;
@@ -298,7 +301,7 @@ void cpwline::analyseQuasiStatic (nr_double_t W, nr_double_t s, nr_double_t h,
   // backside is air
   else {
     k2  = qucs::sinh ((pi / 4) * (W / h)) / qucs::sinh ((pi / 4) * (W + s + s) / h);
-    q2 = ellipk (k2) / ellipk (qucs::sqrt (1 - k2 * k2));
+    q2 = KoverKp (k2);
     ErEff = 1 + (er - 1) / 2 * q2 / q1;
     ZlEff = Z0 / 4 / q1;
   }
@@ -310,7 +313,7 @@ void cpwline::analyseQuasiStatic (nr_double_t W, nr_double_t s, nr_double_t h,
 
     // modifies k1 accordingly (k1 = ke)
     ke = k1 + (1 - k1 * k1) * d / 2 / s;
-    qe = ellipk (ke) / ellipk (qucs::sqrt (1 - ke * ke));
+    qe = KoverKp (ke);
 
     // backside is metal
     if (backMetal) {
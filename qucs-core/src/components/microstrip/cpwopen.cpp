@@ -34,9 +34,23 @@
 using namespace qucs;
 
 cpwopen::cpwopen () : circuit (1) {
+  ZlEff = ErEff = 0;
   type = CIR_CPWOPEN;
 }
 
+/* Computes the frequency independent quasi-static line properties
+   once, instead of the elliptic integrals at each frequency. */
+void cpwopen::initQuasiStatic (void) {
+  nr_double_t W =  getPropertyDouble ("W");
+  nr_double_t s =  getPropertyDouble ("S");
+  substrate * subst = getSubstrate ();
+  nr_double_t er = subst->getPropertyDouble ("er");
+  nr_double_t h  = subst->getPropertyDouble ("h");
+  nr_double_t t  = subst->getPropertyDouble ("t");
+  int backMetal  = !strcmp (getPropertyString ("Backside"), "Metal");
+  cpwline::analyseQuasiStatic (W, s, h, t, er, backMetal, ZlEff, ErEff);
+}
+
 // Returns the coplanar open end capacitance.
 nr_double_t cpwopen::calcCend (nr_double_t frequency) {
 
@@ -46,11 +60,8 @@ nr_double_t cpwopen::calcCend (nr_double_t frequency) {
   substrate * subst = getSubstrate ();
   nr_double_t er = subst->getPropertyDouble ("er");
   nr_double_t h  = subst->getPropertyDouble ("h");
-  nr_double_t t  = subst->getPropertyDouble ("t");
-  int backMetal  = !strcmp (getPropertyString ("Backside"), "Metal");
 
-  nr_double_t ZlEff, ErEff, ZlEffFreq, ErEffFreq;
-  cpwline::analyseQuasiStatic (W, s, h, t, er, backMetal, ZlEff, ErEff);
+  nr_double_t ZlEffFreq, ErEffFreq;
   cpwline::analyseDispersion  (W, s, h, er, ZlEff, ErEff, frequency,
 			       ZlEffFreq, ErEffFreq);
   nr_double_t dl = (W / 2 + s) / 2;
@@ -60,6 +71,7 @@ nr_double_t cpwopen::calcCend (nr_double_t frequency) {
 void cpwopen::initSP (void) {
   allocMatrixS ();
   checkProperties ();
+  initQuasiStatic ();
 }
 
 void cpwopen::calcSP (nr_double_t frequency) {
@@ -95,6 +107,7 @@ void cpwopen::initDC (void) {
 void cpwopen::initAC (void) {
   allocMatrixMNA ();
   checkProperties ();
+  initQuasiStatic ();
 }
 
 void cpwopen::calcAC (nr_double_t frequency) {
@@ -36,8 +36,12 @@ class cpwopen : public qucs::circuit
   void calcAC (nr_double_t);
 
   void checkProperties (void);
+  void initQuasiStatic (void);
   nr_double_t calcCend (nr_double_t);
   nr_complex_t calcY (nr_double_t);
+
+ private:
+  nr_double_t ZlEff, ErEff;
 };
 
 #endif /* __CPWOPEN_H__ */
@@ -34,9 +34,27 @@
 using namespace qucs;
 
 cpwstep::cpwstep () : circuit (2) {
+  ZlEff1 = ErEff1 = ZlEff2 = ErEff2 = 0;
   type = CIR_CPWSTEP;
 }
 
+/* Computes the frequency independent quasi-static properties of both
+   lines once, instead of the elliptic integrals at each frequency. */
+void cpwstep::initQuasiStatic (void) {
+  nr_double_t W1 = getPropertyDouble ("W1");
+  nr_double_t W2 = getPropertyDouble ("W2");
+  nr_double_t s  = getPropertyDouble ("S");
+  nr_double_t s1 = (s - W1) / 2;
+  nr_double_t s2 = (s - W2) / 2;
+  substrate * subst = getSubstrate ();
+  nr_double_t er = subst->getPropertyDouble ("er");
+  nr_double_t h  = subst->getPropertyDouble ("h");
+  nr_double_t t  = subst->getPropertyDouble ("t");
+  int backMetal  = !strcmp (getPropertyString ("Backside"), "Metal");
+  cpwline::analyseQuasiStatic (W1, s1, h, t, er, backMetal, ZlEff1, ErEff1);
+  cpwline::analyseQuasiStatic (W2, s2, h, t, er, backMetal, ZlEff2, ErEff2);
+}
+
 // Returns the coplanar step capacitances per unit length.
 void cpwstep::calcCends (nr_double_t frequency,
 			 nr_double_t& C1, nr_double_t& C2) {
@@ -50,16 +68,12 @@ void cpwstep::calcCends (nr_double_t frequency,
   substrate * subst = getSubstrate ();
   nr_double_t er = subst->getPropertyDouble ("er");
   nr_double_t h  = subst->getPropertyDouble ("h");
-  nr_double_t t  = subst->getPropertyDouble ("t");
-  int backMetal  = !strcmp (getPropertyString ("Backside"), "Metal");
 
-  nr_double_t ZlEff, ErEff, ZlEffFreq, ErEffFreq;
-  cpwline::analyseQuasiStatic (W1, s1, h, t, er, backMetal, ZlEff, ErEff);
-  cpwline::analyseDispersion  (W1, s1, h, er, ZlEff, ErEff, frequency,
+  nr_double_t ZlEffFreq, ErEffFreq;
+  cpwline::analyseDispersion  (W1, s1, h, er, ZlEff1, ErEff1, frequency,
 			       ZlEffFreq, ErEffFreq);
   C1 = ErEffFreq / C0 / ZlEffFreq;
-  cpwline::analyseQuasiStatic (W2, s2, h, t, er, backMetal, ZlEff, ErEff);
-  cpwline::analyseDispersion  (W2, s2, h, er, ZlEff, ErEff, frequency,
+  cpwline::analyseDispersion  (W2, s2, h, er, ZlEff2, ErEff2, frequency,
 			       ZlEffFreq, ErEffFreq);
   C2 = ErEffFreq / C0 / ZlEffFreq;
 }
@@ -67,6 +81,7 @@ void cpwstep::calcCends (nr_double_t frequency,
 void cpwstep::initSP (void) {
   allocMatrixS ();
   checkProperties ();
+  initQuasiStatic ();
 }
 
 void cpwstep::calcSP (nr_double_t frequency) {
@@ -134,6 +149,7 @@ void cpwstep::initAC (void) {
   setC (VSRC_2, NODE_1, +0.0); setC (VSRC_2, NODE_2, -1.0);
   setE (VSRC_1, +0.0); setE (VSRC_2, +0.0);
   checkProperties ();
+  initQuasiStatic ();
 }
 
 void cpwstep::calcAC (nr_double_t frequency) {
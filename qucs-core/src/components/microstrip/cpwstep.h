@@ -36,8 +36,12 @@ class cpwstep : public qucs::circuit
   void calcAC (nr_double_t);
 
   void checkProperties (void);
+  void initQuasiStatic (void);
   void calcCends (nr_double_t, nr_double_t&, nr_double_t&);
   nr_complex_t calcY (nr_double_t);
+
+ private:
+  nr_double_t ZlEff1, ErEff1, ZlEff2, ErEff2;
 };
 
 #endif /* __CPWSTEP_H__ */
@@ -74,7 +74,6 @@ void mscross::calcAC (nr_double_t frequency) {
 
 nr_double_t mscross::capCorrection (nr_double_t W, nr_double_t f) {
   substrate * subst = getSubstrate ();
-  nr_double_t er = subst->getPropertyDouble ("er");
   nr_double_t h  = subst->getPropertyDouble ("h");
   nr_double_t t  = subst->getPropertyDouble ("t");
   const char * SModel = getPropertyString ("MSModel");
@@ -84,8 +83,8 @@ nr_double_t mscross::capCorrection (nr_double_t W, nr_double_t f) {
   msline::analyseQuasiStatic (W, h, t, 9.9, SModel, ZlEff, ErEff, WEff);
   msline::analyseDispersion  (W, h, 9.9, ZlEff, ErEff, f, DModel,
                               Zl1, Er1);
-  msline::analyseQuasiStatic (W, h, t, er, SModel, ZlEff, ErEff, WEff);
-  msline::analyseDispersion  (W, h, er, ZlEff, ErEff, f, DModel,
+  msline::analyseQuasiStatic (subst, W, SModel, ZlEff, ErEff, WEff);
+  msline::analyseDispersion  (subst, W, ZlEff, ErEff, f, SModel, DModel,
                               Zl2, Er2);
   return Zl1 / Zl2 * qucs::sqrt (Er2 / Er1);
 }
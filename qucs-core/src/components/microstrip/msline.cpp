@@ -34,6 +34,8 @@ using namespace qucs;
 
 msline::msline () : circuit (2) {
   alpha = beta = zl = ereff = 0;
+  W = er = t = tand = rho = D = ZlEff = ErEff = WEff = 0;
+  SModel = DModel = NULL;
   type = CIR_MSLINE;
 }
 
@@ -47,33 +49,35 @@ void msline::calcNoiseSP (nr_double_t) {
   setMatrixN (celsius2kelvin (T) / T0 * (e - s * transpose (conj (s))));
 }
 
-void msline::calcPropagation (nr_double_t frequency) {
-
-  /* how to get properties of this component, e.g. L, W */
-  nr_double_t W = getPropertyDouble ("W");
-  const char * SModel = getPropertyString ("Model");
-  const char * DModel = getPropertyString ("DispModel");
+/* The function fetches the properties of the line and its substrate
+   and computes the frequency independent quasi-static values once
+   before the frequency sweep. */
+void msline::initPropagation (void) {
+  W      = getPropertyDouble ("W");
+  SModel = getPropertyString ("Model");
+  DModel = getPropertyString ("DispModel");
 
-  /* how to get properties of the substrate, e.g. Er, H */
   substrate * subst = getSubstrate ();
-  nr_double_t er    = subst->getPropertyDouble ("er");
-  nr_double_t h     = subst->getPropertyDouble ("h");
-  nr_double_t t     = subst->getPropertyDouble ("t");
-  nr_double_t tand  = subst->getPropertyDouble ("tand");
-  nr_double_t rho   = subst->getPropertyDouble ("rho");
-  nr_double_t D     = subst->getPropertyDouble ("D");
-
-  /* local variables */
-  nr_double_t ac, ad;
-  nr_double_t ZlEff, ErEff, WEff, ZlEffFreq, ErEffFreq;
+  er   = subst->getPropertyDouble ("er");
+  t    = subst->getPropertyDouble ("t");
+  tand = subst->getPropertyDouble ("tand");
+  rho  = subst->getPropertyDouble ("rho");
+  D    = subst->getPropertyDouble ("D");
 
   // quasi-static effective dielectric constant of substrate + line and
   // the impedance of the microstrip line
-  analyseQuasiStatic (W, h, t, er, SModel, ZlEff, ErEff, WEff);
+  analyseQuasiStatic (subst, W, SModel, ZlEff, ErEff, WEff);
+}
+
+void msline::calcPropagation (nr_double_t frequency) {
+
+  /* local variables */
+  nr_double_t ac, ad;
+  nr_double_t ZlEffFreq, ErEffFreq;
 
   // analyse dispersion of Zl and Er (use WEff here?)
-  analyseDispersion (W, h, er, ZlEff, ErEff, frequency, DModel,
-		     ZlEffFreq, ErEffFreq);
+  analyseDispersion (getSubstrate (), W, ZlEff, ErEff, frequency,
+		     SModel, DModel, ZlEffFreq, ErEffFreq);
 
   // analyse losses of line
   analyseLoss (W, t, er, rho, D, tand, ZlEff, ZlEff, ErEff,
@@ -86,6 +90,11 @@ void msline::calcPropagation (nr_double_t frequency) {
   beta  = qucs::sqrt (ErEffFreq) * 2 * pi * frequency / C0;
 }
 
+void msline::initSP (void) {
+  allocMatrixS ();
+  initPropagation ();
+}
+
 void msline::calcSP (nr_double_t frequency) {
   nr_double_t l = getPropertyDouble ("L");
 
@@ -306,6 +315,41 @@ void msline::analyseDispersion (nr_double_t W, nr_double_t h, nr_double_t er,
   ErEffFreq = e;
 }
 
+/* The function computes the quasi-static values of a microstrip line
+   on the given substrate.  These are computed once for each width and
+   model and the substrate keeps them for the other lines. */
+void msline::analyseQuasiStatic (substrate * subst, nr_double_t W,
+				 const char * const Model,
+				 nr_double_t& ZlEff, nr_double_t& ErEff,
+				 nr_double_t& WEff) {
+  if (subst->getQuasiStatic (W, Model, ZlEff, ErEff, WEff)) return;
+  nr_double_t er = subst->getPropertyDouble ("er");
+  nr_double_t h  = subst->getPropertyDouble ("h");
+  nr_double_t t  = subst->getPropertyDouble ("t");
+  analyseQuasiStatic (W, h, t, er, Model, ZlEff, ErEff, WEff);
+  subst->setQuasiStatic (W, Model, ZlEff, ErEff, WEff);
+}
+
+/* Computes the dispersion of a microstrip line on the given substrate
+   whose quasi-static values ZlEff and ErEff have been computed with
+   the model SModel.  The values are kept by the substrate per width
+   and frequency, thus lines of the same width share them. */
+void msline::analyseDispersion (substrate * subst, nr_double_t W,
+				nr_double_t ZlEff, nr_double_t ErEff,
+				nr_double_t frequency,
+				const char * const SModel,
+				const char * const DModel,
+				nr_double_t& ZlEffFreq,
+				nr_double_t& ErEffFreq) {
+  if (subst->getDispersion (W, SModel, DModel, frequency,
+			    ZlEffFreq, ErEffFreq)) return;
+  nr_double_t er = subst->getPropertyDouble ("er");
+  nr_double_t h  = subst->getPropertyDouble ("h");
+  analyseDispersion (W, h, er, ZlEff, ErEff, frequency, DModel,
+		     ZlEffFreq, ErEffFreq);
+  subst->setDispersion (W, SModel, DModel, frequency, ZlEffFreq, ErEffFreq);
+}
+
 /* Computes the exponent factors a(u) and b(er) used within the
    effective relative dielectric constant calculations for single and
    coupled microstrip lines by Hammerstad and Jensen. */
@@ -461,6 +505,7 @@ void msline::initDC (void) {
 void msline::initAC (void) {
   setVoltageSources (0);
   allocMatrixMNA ();
+  initPropagation ();
 }
 
 void msline::calcAC (nr_double_t frequency) {
@@ -485,6 +530,42 @@ void msline::calcNoiseAC (nr_double_t) {
   setMatrixN (4 * celsius2kelvin (T) / T0 * real (getMatrixY ()));
 }
 
+/* The transient analysis uses the method of characteristics with the
+   characteristic admittance and propagation function fitted to the
+   dispersive and lossy frequency domain model of the line. */
+void msline::initTR (void) {
+  nr_double_t l = getPropertyDouble ("L");
+  line = mocline ();
+  deleteHistory ();
+  if (l == 0.0) {
+    initDC ();
+    return;
+  }
+  initPropagation ();
+  std::vector<nr_double_t> freq = mocline::frequencies (MOCLINE_FMAX);
+  std::vector<nr_complex_t> yc, gamma;
+  for (nr_double_t f : freq) {
+    calcPropagation (f);
+    yc.push_back (1.0 / zl);
+    gamma.push_back (nr_complex_t (alpha, beta));
+  }
+  int m = line.addMode (t != 0.0 ? rho * l / t / W : 0);
+  line.addNode (m, 0, NODE_1, 1, 1);
+  line.addNode (m, 1, NODE_2, 1, 1);
+  if (line.fitMode (m, l, freq, yc, gamma)) {
+    logprint (LOG_ERROR, "WARNING: Cannot fit the transient model of `%s', "
+	      "using its DC model\n", getName ());
+    line = mocline ();
+    initDC ();
+    return;
+  }
+  line.initTR (this);
+}
+
+void msline::calcTR (nr_double_t t) {
+  if (line.getModes ()) line.calcTR (this, t);
+}
+
 // properties
 PROP_REQ [] = {
   { "W", PROP_REAL, { 1e-3, PROP_NO_STR }, PROP_POS_RANGE },
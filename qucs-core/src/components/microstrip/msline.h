@@ -25,17 +25,23 @@
 #ifndef __MSLINE_H__
 #define __MSLINE_H__
 
+#include "mocline.h"
+
 class msline : public qucs::circuit
 {
  public:
   CREATOR (msline);
   void initDC (void);
+  void initSP (void);
   void calcNoiseSP (nr_double_t);
   void calcSP (nr_double_t);
+  void initPropagation (void);
   void calcPropagation (nr_double_t);
   void initAC (void);
   void calcAC (nr_double_t);
   void calcNoiseAC (nr_double_t);
+  void initTR (void);
+  void calcTR (nr_double_t);
   void saveCharacteristics (nr_double_t);
 
   static void analyseQuasiStatic (nr_double_t, nr_double_t, nr_double_t,
@@ -44,6 +50,13 @@ class msline : public qucs::circuit
   static void analyseDispersion (nr_double_t, nr_double_t, nr_double_t,
 				 nr_double_t, nr_double_t, nr_double_t, const char * const,
 				 nr_double_t&, nr_double_t&);
+  static void analyseQuasiStatic (qucs::substrate *, nr_double_t,
+				  const char * const,
+				  nr_double_t&, nr_double_t&, nr_double_t&);
+  static void analyseDispersion (qucs::substrate *, nr_double_t,
+				 nr_double_t, nr_double_t, nr_double_t,
+				 const char * const, const char * const,
+				 nr_double_t&, nr_double_t&);
   static void Hammerstad_ab (nr_double_t, nr_double_t,
 			     nr_double_t&, nr_double_t&);
   static void Hammerstad_er (nr_double_t, nr_double_t, nr_double_t,
@@ -64,6 +77,10 @@ class msline : public qucs::circuit
 
  private:
   nr_double_t alpha, beta, zl, ereff;
+  nr_double_t W, er, t, tand, rho, D, ZlEff, ErEff, WEff;
+  const char * SModel;
+  const char * DModel;
+  mocline line;
 };
 
 #endif /* __MSLINE_H__ */
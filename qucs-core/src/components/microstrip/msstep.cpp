@@ -54,7 +54,6 @@ matrix msstep::calcMatrixZ (nr_double_t frequency) {
   substrate * subst = getSubstrate ();
   nr_double_t er    = subst->getPropertyDouble ("er");
   nr_double_t h     = subst->getPropertyDouble ("h");
-  nr_double_t t     = subst->getPropertyDouble ("t");
 
   // compute parallel capacitance
   nr_double_t t1 = std::log10 (er);
@@ -68,14 +67,14 @@ matrix msstep::calcMatrixZ (nr_double_t frequency) {
   nr_double_t Ls = h * (t2 * (40.5 + 0.2 * t2) - 75 * t1);
 
   nr_double_t ZlEff, ErEff, WEff, ZlEffFreq, ErEffFreq;
-  msline::analyseQuasiStatic (W1, h, t, er, SModel, ZlEff, ErEff, WEff);
-  msline::analyseDispersion  (W1, h, er, ZlEff, ErEff, frequency, DModel,
-			      ZlEffFreq, ErEffFreq);
+  msline::analyseQuasiStatic (subst, W1, SModel, ZlEff, ErEff, WEff);
+  msline::analyseDispersion  (subst, W1, ZlEff, ErEff, frequency,
+			      SModel, DModel, ZlEffFreq, ErEffFreq);
   nr_double_t L1 = ZlEffFreq * std::sqrt (ErEffFreq) / C0;
 
-  msline::analyseQuasiStatic (W2, h, t, er, SModel, ZlEff, ErEff, WEff);
-  msline::analyseDispersion  (W2, h, er, ZlEff, ErEff, frequency, DModel,
-			      ZlEffFreq, ErEffFreq);
+  msline::analyseQuasiStatic (subst, W2, SModel, ZlEff, ErEff, WEff);
+  msline::analyseDispersion  (subst, W2, ZlEff, ErEff, frequency,
+			      SModel, DModel, ZlEffFreq, ErEffFreq);
   nr_double_t L2 = ZlEffFreq * std::sqrt (ErEffFreq) / C0;
 
   Ls /= (L1 + L2);
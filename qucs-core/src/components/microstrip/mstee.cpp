@@ -114,7 +114,6 @@ void mstee::calcPropagation (nr_double_t f) {
   substrate * subst = getSubstrate ();
   nr_double_t er = subst->getPropertyDouble ("er");
   nr_double_t h  = subst->getPropertyDouble ("h");
-  nr_double_t t  = subst->getPropertyDouble ("t");
   nr_double_t Wa = getPropertyDouble ("W1");
   nr_double_t Wb = getPropertyDouble ("W2");
   nr_double_t W2 = getPropertyDouble ("W3");
@@ -123,14 +122,14 @@ void mstee::calcPropagation (nr_double_t f) {
 
   // computation of impedances and effective dielectric constants
   nr_double_t ZlEff, ErEff, WEff;
-  msline::analyseQuasiStatic (Wa, h, t, er, SModel, ZlEff, ErEff, WEff);
-  msline::analyseDispersion  (Wa, h, er, ZlEff, ErEff, f, DModel,
+  msline::analyseQuasiStatic (subst, Wa, SModel, ZlEff, ErEff, WEff);
+  msline::analyseDispersion  (subst, Wa, ZlEff, ErEff, f, SModel, DModel,
 			      Zla, Era);
-  msline::analyseQuasiStatic (Wb, h, t, er, SModel, ZlEff, ErEff, WEff);
-  msline::analyseDispersion  (Wb, h, er, ZlEff, ErEff, f, DModel,
+  msline::analyseQuasiStatic (subst, Wb, SModel, ZlEff, ErEff, WEff);
+  msline::analyseDispersion  (subst, Wb, ZlEff, ErEff, f, SModel, DModel,
 			      Zlb, Erb);
-  msline::analyseQuasiStatic (W2, h, t, er, SModel, ZlEff, ErEff, WEff);
-  msline::analyseDispersion  (W2, h, er, ZlEff, ErEff, f, DModel,
+  msline::analyseQuasiStatic (subst, W2, SModel, ZlEff, ErEff, WEff);
+  msline::analyseDispersion  (subst, W2, ZlEff, ErEff, f, SModel, DModel,
 			      Zl2, Er2);
 
   // local variables
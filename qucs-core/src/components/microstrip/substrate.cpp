@@ -33,17 +33,83 @@ using namespace qucs;
 
 // Constructor creates an unnamed instance of the substrate class.
 substrate::substrate () : object () {
+  er = h = t = 0;
 }
 
 /* The copy constructor creates a new instance based on the given
    substrate object. */
 substrate::substrate (const substrate & c) : object (c) {
+  er = h = t = 0;
 }
 
 // Destructor deletes a substrate object.
 substrate::~substrate () {
 }
 
+/* The function drops the cached microstrip line models if the
+   substrate properties have changed since they were computed, e.g.
+   during a parameter sweep. */
+void substrate::validate (void) {
+  nr_double_t e = getPropertyDouble ("er");
+  nr_double_t d = getPropertyDouble ("h");
+  nr_double_t s = getPropertyDouble ("t");
+  if (e != er || d != h || s != t) {
+    quasiStatic.clear ();
+    dispersion.clear ();
+    er = e; h = d; t = s;
+  }
+}
+
+/* Looks up the quasi-static impedance, effective dielectric constant
+   and effective width of a microstrip line with the given width and
+   model.  Returns true if these have been computed before. */
+bool substrate::getQuasiStatic (nr_double_t W, const char * Model,
+				nr_double_t& ZlEff, nr_double_t& ErEff,
+				nr_double_t& WEff) {
+  validate ();
+  std::map<qskey_t, qsmodel_t>::iterator it =
+    quasiStatic.find (qskey_t (W, Model));
+  if (it == quasiStatic.end ()) return false;
+  ZlEff = it->second.ZlEff;
+  ErEff = it->second.ErEff;
+  WEff  = it->second.WEff;
+  return true;
+}
+
+// Saves the quasi-static values of a microstrip line.
+void substrate::setQuasiStatic (nr_double_t W, const char * Model,
+				nr_double_t ZlEff, nr_double_t ErEff,
+				nr_double_t WEff) {
+  if (quasiStatic.size () >= SUBSTRATE_CACHE_MAX) quasiStatic.clear ();
+  qsmodel_t m = { ZlEff, ErEff, WEff };
+  quasiStatic[qskey_t (W, Model)] = m;
+}
+
+/* Looks up the frequency dependent impedance and effective
+   dielectric constant of a microstrip line with the given width,
+   quasi-static and dispersion model at the given frequency. */
+bool substrate::getDispersion (nr_double_t W, const char * SModel,
+			       const char * DModel, nr_double_t frequency,
+			       nr_double_t& ZlEffFreq,
+			       nr_double_t& ErEffFreq) {
+  validate ();
+  std::map<dispkey_t, dispmodel_t>::iterator it =
+    dispersion.find (dispkey_t (W, SModel, DModel, frequency));
+  if (it == dispersion.end ()) return false;
+  ZlEffFreq = it->second.ZlEffFreq;
+  ErEffFreq = it->second.ErEffFreq;
+  return true;
+}
+
+// Saves the frequency dependent values of a microstrip line.
+void substrate::setDispersion (nr_double_t W, const char * SModel,
+			       const char * DModel, nr_double_t frequency,
+			       nr_double_t ZlEffFreq, nr_double_t ErEffFreq) {
+  if (dispersion.size () >= SUBSTRATE_CACHE_MAX) dispersion.clear ();
+  dispmodel_t m = { ZlEffFreq, ErEffFreq };
+  dispersion[dispkey_t (W, SModel, DModel, frequency)] = m;
+}
+
 // properties
 PROP_REQ [] = {
   { "er", PROP_REAL, { 9.8, PROP_NO_STR }, PROP_RNGII (1, 100) },
@@ -25,8 +25,15 @@
 #ifndef __SUBSTRATE_H__
 #define __SUBSTRATE_H__
 
+#include <map>
+#include <string>
+#include <tuple>
+
 #include "object.h"
 
+// Maximum number of cached microstrip line models per substrate.
+#define SUBSTRATE_CACHE_MAX 16384
+
 namespace qucs {
 
 class substrate : public qucs::object
@@ -35,6 +42,30 @@ class substrate : public qucs::object
   MCREATOR (substrate);
   substrate (const substrate &);
   ~substrate ();
+
+  bool getQuasiStatic (nr_double_t, const char *,
+		       nr_double_t&, nr_double_t&, nr_double_t&);
+  void setQuasiStatic (nr_double_t, const char *,
+		       nr_double_t, nr_double_t, nr_double_t);
+  bool getDispersion (nr_double_t, const char *, const char *, nr_double_t,
+		      nr_double_t&, nr_double_t&);
+  void setDispersion (nr_double_t, const char *, const char *, nr_double_t,
+		      nr_double_t, nr_double_t);
+
+ private:
+  void validate (void);
+
+  /* Single microstrip line models of a width and model on this
+     substrate, the dispersion ones per frequency as well.  They are
+     valid for the substrate properties er, h and t below. */
+  typedef std::tuple<nr_double_t, std::string> qskey_t;
+  typedef std::tuple<nr_double_t, std::string, std::string,
+		     nr_double_t> dispkey_t;
+  struct qsmodel_t { nr_double_t ZlEff, ErEff, WEff; };
+  struct dispmodel_t { nr_double_t ZlEffFreq, ErEffFreq; };
+  std::map<qskey_t, qsmodel_t> quasiStatic;
+  std::map<dispkey_t, dispmodel_t> dispersion;
+  nr_double_t er, h, t;
 };
 
 } // namespace qucs
@@ -0,0 +1,304 @@
+/*
+ * mocline.cpp - transient transmission line model class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <algorithm>
+
+#include "component.h"
+#include "vectfit.h"
+#include "mocline.h"
+
+using namespace qucs;
+
+mocline::mocline () : tState (0), started (false) {
+}
+
+/* Adds a mode with the given series DC resistance and returns its
+   index.  Without further characteristics it is lossless and matched
+   to a zero admittance. */
+int mocline::addMode (nr_double_t rdc) {
+  mocmode_t m;
+  m.tau = 0;
+  m.rdc = rdc;
+  m.yc.d = 0;
+  m.h.d = 1;
+  m.v[0] = m.v[1] = m.ud[0] = m.ud[1] = 0;
+  modes.push_back (m);
+  return (int) modes.size () - 1;
+}
+
+/* Adds the node with the given voltage and current weight to the
+   port at the given end of the mode. */
+void mocline::addNode (int mode, int end, int node, nr_double_t cv,
+		       nr_double_t cb) {
+  mocmode_t & m = modes[mode];
+  m.node[end].push_back (node);
+  m.cv[end].push_back (cv);
+  m.cb[end].push_back (cb);
+}
+
+/* Sets frequency independent characteristics of the mode. */
+void mocline::setMode (int mode, nr_double_t tau, nr_double_t yc,
+		       nr_double_t h) {
+  mocmode_t & m = modes[mode];
+  m.tau = tau;
+  m.yc.d = yc;
+  m.yc.p.clear (); m.yc.r.clear ();
+  m.h.d = h;
+  m.h.p.clear (); m.h.r.clear ();
+}
+
+/* Returns the frequencies the line characteristics are sampled at for
+   the fit, logarithmically spaced up to the given one. */
+std::vector<nr_double_t> mocline::frequencies (nr_double_t fmax) {
+  std::vector<nr_double_t> f;
+  for (int i = -10 * MOCLINE_DECADES; i <= 0; i++)
+    f.push_back (fmax * std::pow (10.0, i / 10.0));
+  return f;
+}
+
+static nr_complex_t evaluate (const mocfunc_t & fn, nr_complex_t s) {
+  nr_complex_t v = fn.d;
+  for (size_t k = 0; k < fn.p.size (); k++) {
+    v += fn.r[k] / (s - fn.p[k]);
+    if (imag (fn.p[k]) != 0) v += conj (fn.r[k]) / (s - conj (fn.p[k]));
+  }
+  return v;
+}
+
+/* Approximates the samples by a rational function.  Samples which do
+   not depend on frequency give a constant.  Returns zero on
+   success. */
+static int approximate (const std::vector<nr_double_t> & freq,
+			const std::vector<nr_complex_t> & val, mocfunc_t & fn) {
+  nr_double_t mag = 0, dev = 0;
+  for (const nr_complex_t & v : val) {
+    mag = std::max (mag, abs (v));
+    dev = std::max (dev, abs (v - val[0]));
+  }
+  fn.p.clear ();
+  fn.r.clear ();
+  fn.d = real (val[0]);
+  if (dev <= 1e-9 * mag) return 0;
+
+  std::vector<matrix> samples;
+  for (const nr_complex_t & v : val) {
+    matrix m (1);
+    m (0, 0) = v / mag;
+    samples.push_back (m);
+  }
+  vectfit vf;
+  if (vf.fit (freq, samples, 0)) return -1;
+  fn.d = real (vf.D (0, 0)) * mag;
+  for (int k = 0; k < vf.getPoles (); k++) {
+    fn.p.push_back (vf.poles[k]);
+    fn.r.push_back (vf.residues[k] (0, 0) * mag);
+  }
+  return 0;
+}
+
+/* Fits the characteristics of the mode to the characteristic
+   admittance and propagation constant of the line at the given
+   frequencies.  The delay is the smallest phase delay of the samples,
+   the remaining propagation function is made passive if the fit is
+   not.  Returns zero on success. */
+int mocline::fitMode (int mode, nr_double_t length,
+		      const std::vector<nr_double_t> & freq,
+		      const std::vector<nr_complex_t> & yc,
+		      const std::vector<nr_complex_t> & gamma) {
+  mocmode_t & m = modes[mode];
+  nr_double_t tau = -1;
+  for (size_t i = 0; i < freq.size (); i++) {
+    nr_double_t t = imag (gamma[i]) * length / (2 * pi * freq[i]);
+    tau = tau < 0 ? t : std::min (tau, t);
+  }
+  m.tau = std::max (tau, 0.0);
+
+  std::vector<nr_complex_t> h;
+  for (size_t i = 0; i < freq.size (); i++)
+    h.push_back (std::exp (-gamma[i] * length +
+			   nr_complex_t (0, 2 * pi * freq[i] * m.tau)));
+  if (approximate (freq, yc, m.yc) || approximate (freq, h, m.h))
+    return -1;
+
+  nr_double_t g = abs (evaluate (m.h, 0));
+  for (nr_double_t f : freq) {
+    g = std::max (g, abs (evaluate (m.h, nr_complex_t (0, 2 * pi * f))));
+    g = std::max (g, abs (evaluate (m.h, nr_complex_t (0, 20 * pi * f))));
+  }
+  if (g > 1) {
+    m.h.d /= g;
+    for (nr_complex_t & r : m.h.r) r /= g;
+  }
+  return 0;
+}
+
+/* Sets up the ports of the modes and the convolution history of the
+   given circuit. */
+void mocline::initTR (circuit * c) {
+  c->setVoltageSources (2 * (int) modes.size ());
+  c->allocMatrixMNA ();
+  for (size_t i = 0; i < modes.size (); i++) {
+    mocmode_t & m = modes[i];
+    for (int e = 0; e < 2; e++) {
+      for (size_t k = 0; k < m.node[e].size (); k++)
+	c->setB (m.node[e][k], VSRC_1 + 2 * i + e, m.cb[e][k]);
+      m.xy[e].assign (m.yc.p.size (), 0);
+      m.xh[e].assign (m.h.p.size (), 0);
+      m.uv[e].clear ();
+      m.v[e] = m.ud[e] = 0;
+    }
+    m.ut.clear ();
+  }
+  // the history keeps the accepted time steps only
+  c->setHistory (true);
+  c->initHistory (NR_TINY);
+  tState = 0;
+  started = false;
+}
+
+/* Returns the wave leaving the other end of the mode one delay before
+   the given time, interpolated between the recorded ones. */
+nr_double_t mocline::delayed (mocmode_t & m, int end, nr_double_t t) {
+  std::deque<nr_double_t> & u = m.uv[1 - end];
+  t -= m.tau;
+  if (t <= m.ut.front ()) return u.front ();
+  if (t >= m.ut.back ()) return u.back ();
+  size_t i = std::upper_bound (m.ut.begin (), m.ut.end (), t) - m.ut.begin ();
+  nr_double_t f = (t - m.ut[i - 1]) / (m.ut[i] - m.ut[i - 1]);
+  return u[i - 1] + f * (u[i] - u[i - 1]);
+}
+
+/* Advances the convolution states and records the waves leaving the
+   line at the accepted time step of the given history index.  The
+   states start in their steady state at the first one. */
+void mocline::advance (circuit * c, int idx) {
+  nr_double_t t = c->getHistoryTFromIndex (idx), h = t - tState;
+  for (size_t i = 0; i < modes.size (); i++) {
+    mocmode_t & m = modes[i];
+    nr_double_t v[2], u[2];
+    for (int e = 0; e < 2; e++) {
+      v[e] = 0;
+      for (size_t k = 0; k < m.node[e].size (); k++)
+	v[e] += m.cv[e][k] * c->getV (m.node[e][k], idx);
+      nr_double_t j = c->getV (c->getSize () + VSRC_1 + 2 * i + e, idx);
+      nr_double_t y = m.yc.d * v[e];
+      for (size_t k = 0; k < m.yc.p.size (); k++) {
+	nr_complex_t p = m.yc.p[k], & x = m.xy[e][k], alpha, b0, b1;
+	if (started) {
+	  vectfit::recursion (p, h, alpha, b0, b1);
+	  x = alpha * x + b1 * m.v[e] + b0 * v[e];
+	}
+	else x = -v[e] / p;
+	y += (imag (p) != 0 ? 2 : 1) * real (m.yc.r[k] * x);
+      }
+      u[e] = y + j;
+    }
+    m.ut.push_back (t);
+    m.uv[0].push_back (u[0]);
+    m.uv[1].push_back (u[1]);
+
+    for (int e = 0; e < 2; e++) {
+      nr_double_t d = delayed (m, e, t);
+      for (size_t k = 0; k < m.h.p.size (); k++) {
+	nr_complex_t p = m.h.p[k], & x = m.xh[e][k], alpha, b0, b1;
+	if (started) {
+	  vectfit::recursion (p, h, alpha, b0, b1);
+	  x = alpha * x + b1 * m.ud[e] + b0 * d;
+	}
+	else x = -d / p;
+      }
+      m.ud[e] = d;
+      m.v[e] = v[e];
+    }
+    // drop the waves no later time step can be delayed to
+    while (m.ut.size () > 2 && m.ut[1] <= t - m.tau) {
+      m.ut.pop_front ();
+      m.uv[0].pop_front ();
+      m.uv[1].pop_front ();
+    }
+  }
+  tState = t;
+  started = true;
+}
+
+/* Stamps the port equations of the modes at the given time.  Until
+   the first time step has been accepted these are the series DC
+   resistance of the mode, afterwards the Norton equivalent
+
+     j = Geff v + Jy - W
+
+   of the characteristic admittance and the delayed incident wave. */
+void mocline::calcTR (circuit * c, nr_double_t t) {
+  // catch up with the time steps accepted meanwhile
+  int n = c->getHistorySize (), i = n;
+  while (i > 0 && (!started || c->getHistoryTFromIndex (i - 1) > tState)) i--;
+  for (; i < n; i++) advance (c, i);
+
+  nr_double_t h = t - tState;
+  for (size_t i = 0; i < modes.size (); i++) {
+    mocmode_t & m = modes[i];
+    int vs[2] = { (int) (VSRC_1 + 2 * i), (int) (VSRC_1 + 2 * i + 1) };
+    if (!started) {
+      for (int e = 0; e < 2; e++) {
+	for (size_t k = 0; k < m.node[e].size (); k++) {
+	  c->setC (vs[0], m.node[e][k], e ? -m.cv[e][k] : m.cv[e][k]);
+	  c->setC (vs[1], m.node[e][k], 0);
+	}
+	c->setD (vs[1], vs[e], 1);
+	c->setE (vs[e], 0);
+      }
+      c->setD (vs[0], vs[0], -m.rdc);
+      c->setD (vs[0], vs[1], 0);
+      continue;
+    }
+
+    for (int e = 0; e < 2; e++) {
+      nr_double_t g = m.yc.d, jy = 0, d = delayed (m, e, t), w = m.h.d * d;
+      for (size_t k = 0; k < m.yc.p.size (); k++) {
+	nr_complex_t alpha, b0, b1, r = m.yc.r[k];
+	vectfit::recursion (m.yc.p[k], h, alpha, b0, b1);
+	nr_double_t wgt = imag (m.yc.p[k]) != 0 ? 2 : 1;
+	g += wgt * real (r * b0);
+	jy += wgt * real (r * (alpha * m.xy[e][k] + b1 * m.v[e]));
+      }
+      for (size_t k = 0; k < m.h.p.size (); k++) {
+	nr_complex_t alpha, b0, b1, r = m.h.r[k];
+	vectfit::recursion (m.h.p[k], h, alpha, b0, b1);
+	nr_double_t wgt = imag (m.h.p[k]) != 0 ? 2 : 1;
+	w += wgt * real (r * (alpha * m.xh[e][k] + b1 * m.ud[e] + b0 * d));
+      }
+      for (size_t k = 0; k < m.node[e].size (); k++)
+	c->setC (vs[e], m.node[e][k], g * m.cv[e][k]);
+      for (size_t k = 0; k < m.node[1 - e].size (); k++)
+	c->setC (vs[e], m.node[1 - e][k], 0);
+      c->setD (vs[e], vs[e], -1);
+      c->setD (vs[e], vs[1 - e], 0);
+      c->setE (vs[e], w - jy);
+    }
+  }
+}
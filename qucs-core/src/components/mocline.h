@@ -0,0 +1,106 @@
+/*
+ * mocline.h - transient transmission line model class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __MOCLINE_H__
+#define __MOCLINE_H__
+
+#include <deque>
+#include <vector>
+
+namespace qucs {
+  class circuit;
+}
+
+// highest frequency the line characteristics are fitted up to
+#define MOCLINE_FMAX    100e9
+
+// decades below MOCLINE_FMAX sampled for the fit
+#define MOCLINE_DECADES 8
+
+/* A rational function d + sum r/(s-p) of a line characteristic,
+   complex poles are stored once like in the vectfit class. */
+struct mocfunc_t
+{
+  nr_double_t d;
+  std::vector<nr_complex_t> p;
+  std::vector<nr_complex_t> r;
+};
+
+/* The line characteristics and convolution states of a mode. */
+struct mocmode_t
+{
+  nr_double_t tau, rdc;
+  mocfunc_t yc, h;
+  // nodes, voltage and current weights of the port at each end
+  std::vector<int> node[2];
+  std::vector<nr_double_t> cv[2], cb[2];
+  std::vector<nr_complex_t> xy[2], xh[2];
+  nr_double_t v[2], ud[2];
+  std::deque<nr_double_t> ut, uv[2];
+};
+
+/*! \class mocline
+ * \brief transient model of transmission lines by the method of
+ * characteristics.
+ *
+ * Each mode of the line is described by its characteristic admittance
+ * Yc(s) and propagation function exp(-gamma(s) l) = H(s) exp(-s tau),
+ * the frequency dependent parts being rational functions fitted to the
+ * frequency domain model of the line.  The current into each end is
+ *
+ *   i1 = Yc * v1 - H * (Yc * v2 + i2)(t - tau)
+ *
+ * with the convolutions evaluated recursively.  A port of the model is
+ * a voltage source whose current is the modal current, its voltage is
+ * the weighted sum of node voltages.  Until the first time step the
+ * model stamps the series DC resistance of the mode.
+ */
+class mocline
+{
+ public:
+  mocline ();
+
+  int addMode (nr_double_t rdc);
+  void addNode (int mode, int end, int node, nr_double_t cv, nr_double_t cb);
+  void setMode (int mode, nr_double_t tau, nr_double_t yc, nr_double_t h);
+  int fitMode (int mode, nr_double_t length, const std::vector<nr_double_t> &,
+	       const std::vector<nr_complex_t> & yc,
+	       const std::vector<nr_complex_t> & gamma);
+  static std::vector<nr_double_t> frequencies (nr_double_t);
+  int getModes (void) const { return (int) modes.size (); }
+
+  void initTR (qucs::circuit *);
+  void calcTR (qucs::circuit *, nr_double_t);
+
+ private:
+  void advance (qucs::circuit *, int);
+  nr_double_t delayed (mocmode_t &, int, nr_double_t);
+
+ private:
+  std::vector<mocmode_t> modes;
+  nr_double_t tState;
+  bool started;
+};
+
+#endif /* __MOCLINE_H__ */
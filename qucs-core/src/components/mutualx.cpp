@@ -36,6 +36,69 @@ mutualx::mutualx () : circuit () {
   setVariableSized (true);
 }
 
+/* Drops the couplings whose factor is below the "kMin" property and
+   reports the error made.  With the currents bounded by I, the voltage
+   induced into inductor r changes by at most I times the sum of the
+   dropped mutual inductances of the row, relative to its self
+   inductance this is the reported bound per inductor. */
+void mutualx::initCoupling (void) {
+  int inductors = getSize () / 2;
+  int r, c, state, dropped = 0;
+  qucs::vector * L = getPropertyVector ("L");
+  qucs::vector * C = getPropertyVector ("k");
+  nr_double_t kmin = getPropertyDouble ("kMin");
+  nr_double_t total = 0, error = 0, bound = 0;
+
+  coupled.assign (inductors * inductors, true);
+  for (state = 0, r = 0; r < inductors; r++) {
+    nr_double_t row = 0;
+    nr_double_t l1 = real (L->get (r));
+    for (c = 0; c < inductors; c++, state++) {
+      nr_double_t l2 = real (L->get (c));
+      nr_double_t k = real (C->get (state));
+      nr_double_t m = k * std::sqrt (l1 * l2);
+      total += m * m;
+      if (r != c && std::fabs (k) < kmin) {
+	coupled[state] = false;
+	error += m * m;
+	row += std::fabs (m);
+	dropped++;
+      }
+    }
+    bound = std::max (bound, row / l1);
+  }
+  if (dropped > 0) {
+    logprint (LOG_STATUS, "NOTIFY: %s: %d of %d couplings below k = %g "
+	      "dropped, relative error %.3e of L, at most %.3e per "
+	      "inductor\n", getName (), dropped,
+	      inductors * (inductors - 1), kmin,
+	      std::sqrt (error / total), bound);
+  }
+}
+
+/* Returns the mutual inductance between the given inductors, zero if
+   the coupling has been dropped. */
+nr_double_t mutualx::getM (int r, int c) {
+  int inductors = getSize () / 2;
+  if (!coupled.empty () && !coupled[r * inductors + c]) return 0.0;
+  qucs::vector * L = getPropertyVector ("L");
+  qucs::vector * C = getPropertyVector ("k");
+  nr_double_t l1 = real (L->get (r));
+  nr_double_t l2 = real (L->get (c));
+  return real (C->get (r * inductors + c)) * std::sqrt (l1 * l2);
+}
+
+/* The voltage sources of the inductors are coupled in the D-MNA matrix
+   by the couplings kept only. */
+bool mutualx::hasD (int r, int c) {
+  return coupled.empty () || coupled[r * (getSize () / 2) + c];
+}
+
+void mutualx::initSP (void) {
+  initCoupling ();
+  allocMatrixS ();
+}
+
 void mutualx::calcSP (nr_double_t frequency) {
   setMatrixS (ytos (calcMatrixY (frequency)));
 }
@@ -64,19 +127,14 @@ matrix mutualx::calcMatrixY (nr_double_t frequency) {
 
 matrix mutualx::calcMatrixZ (nr_double_t frequency) {
   int inductors = getSize () / 2;
-  int r, c, state;
-  qucs::vector * L = getPropertyVector ("L");
-  qucs::vector * C = getPropertyVector ("k");
+  int r, c;
   nr_double_t o = 2 * pi * frequency;
   matrix z = matrix (inductors);
 
   // fill Z-Matrix entries
-  for (state = 0, r = 0; r < inductors; r++) {
-    for (c = 0; c < inductors; c++, state++) {
-      nr_double_t l1 = real (L->get (r));
-      nr_double_t l2 = real (L->get (c));
-      nr_double_t k = real (C->get (state)) * std::sqrt (l1 * l2);
-      z.set (r, c, nr_complex_t (0.0, k * o));
+  for (r = 0; r < inductors; r++) {
+    for (c = 0; c < inductors; c++) {
+      z.set (r, c, nr_complex_t (0.0, getM (r, c) * o));
     }
   }
   return z;
@@ -89,17 +147,13 @@ void mutualx::initAC (void) {
 void mutualx::calcAC (nr_double_t frequency) {
   int inductors = getSize () / 2;
   int r, c, state;
-  qucs::vector * L = getPropertyVector ("L");
-  qucs::vector * C = getPropertyVector ("k");
   nr_double_t o = 2 * pi * frequency;
 
   // fill D-Matrix
   for (state = 0, r = 0; r < inductors; r++) {
     for (c = 0; c < inductors; c++, state++) {
-      nr_double_t l1 = real (L->get (r));
-      nr_double_t l2 = real (L->get (c));
-      nr_double_t k = real (C->get (state)) * std::sqrt (l1 * l2);
-      setD (VSRC_1 + r, VSRC_1 + c, nr_complex_t (0.0, - k * o));
+      if (!coupled[state]) continue;
+      setD (VSRC_1 + r, VSRC_1 + c, nr_complex_t (0.0, - getM (r, c) * o));
     }
   }
 }
@@ -108,6 +162,7 @@ void mutualx::initDC (void) {
   int inductors = getSize () / 2;
   setVoltageSources (inductors);
   allocMatrixMNA ();
+  initCoupling ();
   // fill C and B-Matrix entries
   for (int i = 0; i < inductors; i++)
     voltageSource (VSRC_1 + i, NODE_1 + i * 2, NODE_2 + i * 2);
@@ -122,8 +177,6 @@ void mutualx::initTR (void) {
 void mutualx::calcTR (nr_double_t) {
   int inductors = getSize () / 2;
   int r, c, state;
-  qucs::vector * L = getPropertyVector ("L");
-  qucs::vector * C = getPropertyVector ("k");
 
   nr_double_t * veq = new nr_double_t[inductors * inductors];
   nr_double_t * req = new nr_double_t[inductors * inductors];
@@ -131,10 +184,12 @@ void mutualx::calcTR (nr_double_t) {
   // integration for self and mutual inductances
   for (state = 0, r = 0; r < inductors; r++) {
     for (c = 0; c < inductors; c++, state++) {
-      nr_double_t l1 = real (L->get (r));
-      nr_double_t l2 = real (L->get (c));
+      if (!coupled[state]) {
+	req[state] = veq[state] = 0;
+	continue;
+      }
       nr_double_t i = real (getJ (VSRC_1 + c));
-      nr_double_t k = real (C->get (state)) * std::sqrt (l1 * l2);
+      nr_double_t k = getM (r, c);
       setState  (2 * state, i * k);
       integrate (2 * state, k, req[state], veq[state]);
     }
@@ -144,6 +199,7 @@ void mutualx::calcTR (nr_double_t) {
   for (state = 0, r = 0; r < inductors; r++) {
     nr_double_t v = 0;
     for (c = 0; c < inductors; c++, state++) {
+      if (!coupled[state]) continue;
       setD (VSRC_1 + r, VSRC_1 + c, -req[state]);
       v += veq[state];
     }
@@ -160,6 +216,7 @@ PROP_REQ [] = {
   { "k", PROP_LIST, { 0.9, PROP_NO_STR }, PROP_RNGII (-1, +1) },
   PROP_NO_PROP };
 PROP_OPT [] = {
+  { "kMin", PROP_REAL, { 0, PROP_NO_STR }, PROP_RNGII (0, 1) },
   PROP_NO_PROP };
 struct define_t mutualx::cirdef =
   { "MUTX",
@@ -29,16 +29,24 @@ class mutualx : public qucs::circuit
 {
  public:
   CREATOR (mutualx);
+  void initSP (void);
   void calcSP (nr_double_t);
   void initDC (void);
   void initAC (void);
   void calcAC (nr_double_t);
   void initTR (void);
   void calcTR (nr_double_t);
+  bool hasD (int, int);
 
  private:
+  void initCoupling (void);
+  nr_double_t getM (int, int);
   qucs::matrix calcMatrixZ (nr_double_t);
   qucs::matrix calcMatrixY (nr_double_t);
+
+ private:
+  // couplings kept, the others are below the threshold
+  std::vector<bool> coupled;
 };
 
 #endif /* __MUTUALX_H__ */
@@ -70,7 +70,9 @@ void resistor::calcNoiseAC (nr_double_t) {
 }
 
 void resistor::initModel (void) {
-  /* if this is a controlled resistor then do nothing here */
+  /* if this is a controlled resistor then do nothing here, the
+     controlling device evaluates it as well */
+  setParallel (!hasProperty ("Controlled"));
   if (hasProperty ("Controlled")) return;
 
   nr_double_t T  = getPropertyDouble ("Temp");
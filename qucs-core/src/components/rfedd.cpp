@@ -29,6 +29,7 @@
 #include "component.h"
 #include "equation.h"
 #include "environment.h"
+#include "bytecode.h"
 #include "rfedd.h"
 
 using namespace qucs;
@@ -39,11 +40,18 @@ rfedd::rfedd () : circuit () {
   type = CIR_RFEDD;
   setVariableSized (true);
   peqn = NULL;
+  program = NULL;
+  _preg = NULL;
+  _pcomplex = NULL;
+  compiled = false;
 }
 
 // Destructor deletes equation defined RF device object from memory.
 rfedd::~rfedd () {
   free (peqn);
+  free (_preg);
+  free (_pcomplex);
+  delete program;
 }
 
 // Callback for initializing the DC analysis.
@@ -72,6 +80,7 @@ void rfedd::initDC (void) {
   // zero frequency evaluation
   else if (!strcmp (dc, "zerofrequency")) {
     prepareModel ();
+    compileModel ();
     initMNA ();
     calcMNA (0);
     return;
@@ -130,8 +139,13 @@ void rfedd::setResult (void * eqn, nr_complex_t val) {
   *(c->c) = val;
 }
 
-// Returns the result of the equation.
-nr_complex_t rfedd::getResult (void * eqn) {
+/* Returns the result of the equation, either from the given register
+   of the compiled equations or by evaluating the equation tree. */
+nr_complex_t rfedd::getResult (void * eqn, int k) {
+  if (compiled) {
+    if (_pcomplex[k]) return program->getComplex (_preg[k]);
+    return program->get (_preg[k]);
+  }
   A(eqn)->evaluate ();
   return A(eqn)->getResultComplex ();
 }
@@ -193,6 +207,46 @@ void rfedd::prepareModel (void) {
   if (peqn == NULL) initModel ();
 }
 
+/* Compiles the parameter equations into bytecode, evaluating all the
+   matrix entries of a frequency in one run.  This is redone when an
+   analysis gets initialized since the equation nodes may have been
+   changed by the equation checker meanwhile.  If any of the equations
+   cannot be compiled the device falls back to the equation solver. */
+void rfedd::compileModel (void) {
+  int k, ports = getSize ();
+
+  delete program;
+  program = new bytecode ();
+  compiled = false;
+  if (_preg == NULL) {
+    _preg = (int *) malloc (sizeof (int) * ports * ports);
+    _pcomplex = (bool *) malloc (sizeof (bool) * ports * ports);
+  }
+
+  // the frequency variables get assigned directly
+  bool ok = A(seqn)->body->getTag () == CONSTANT &&
+    A(feqn)->body->getTag () == CONSTANT;
+  for (k = 0; ok && k < ports * ports; k++) {
+    ok = peqn[k] != NULL;
+    if (!ok) break;
+    _pcomplex[k] = A(peqn[k])->getType () == TAG_COMPLEX;
+    if (_pcomplex[k])
+      _preg[k] = program->compileComplex (A(peqn[k]));
+    else
+      _preg[k] = program->compile (A(peqn[k]));
+    ok = _preg[k] >= 0;
+  }
+  if (!ok) {
+    delete program;
+    program = NULL;
+  }
+#if DEBUG
+  if (program)
+    logprint (LOG_STATUS, "DEBUG: RFEDD `%s' compiled into %d instructions\n",
+	      getName (), program->size ());
+#endif
+}
+
 // Update local variable equations.
 void rfedd::updateLocals (nr_double_t frequency) {
 
@@ -202,7 +256,9 @@ void rfedd::updateLocals (nr_double_t frequency) {
 
   // get local subcircuit values
   getEnv()->passConstants ();
-  getEnv()->equationSolver ();
+  // run the compiled equations if possible, the solver otherwise
+  compiled = program != NULL && program->run () == 0;
+  if (!compiled) getEnv()->equationSolver ();
 }
 
 // Callback for DC analysis.
@@ -307,6 +363,7 @@ void rfedd::calcMNA (nr_double_t frequency) {
 void rfedd::initAC (void) {
   initMNA ();
   prepareModel ();
+  compileModel ();
 }
 
 // Callback for AC analysis.
@@ -325,7 +382,7 @@ matrix rfedd::calcMatrix (nr_double_t frequency) {
   // calculate parameters and put into Jacobian
   for (k = 0, i = 0; i < ports; i++) {
     for (j = 0; j < ports; j++, k++) {
-      p (i, j) = getResult (peqn[k]);
+      p (i, j) = getResult (peqn[k], k);
     }
   }
 
@@ -346,6 +403,7 @@ void rfedd::calcTR (nr_double_t) {
 void rfedd::initSP (void) {
   allocMatrixS ();
   prepareModel ();
+  compileModel ();
 }
 
 // Callback for S-parameter analysis.
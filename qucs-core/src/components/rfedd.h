@@ -25,6 +25,8 @@
 #ifndef __RFEDD_H__
 #define __RFEDD_H__
 
+namespace qucs { namespace eqn { class bytecode; } }
+
 class rfedd : public qucs::circuit
 {
  public:
@@ -41,11 +43,12 @@ class rfedd : public qucs::circuit
 
  private:
   void initModel (void);
+  void compileModel (void);
   char * createVariable (const char *, int, int, bool prefix = true);
   char * createVariable (const char *, bool prefix = true);
   void setResult (void *, nr_double_t);
   void setResult (void *, nr_complex_t);
-  nr_complex_t getResult (void *);
+  nr_complex_t getResult (void *, int);
   qucs::matrix calcMatrix (nr_double_t);
   void updateLocals (nr_double_t);
   void prepareModel (void);
@@ -56,6 +59,11 @@ class rfedd : public qucs::circuit
   void ** peqn;
   void * seqn;
   void * feqn;
+  // compiled parameter equations and their result registers
+  qucs::eqn::bytecode * program;
+  int * _preg;
+  bool * _pcomplex;
+  bool compiled;
 };
 
 #endif /* __RFEDD_H__ */
@@ -123,8 +123,39 @@ void rlcg::calcAC (nr_double_t frequency) {
   }
 }
 
+/* The transient analysis uses the method of characteristics with the
+   characteristic admittance and propagation function fitted to the
+   frequency domain model of the line. */
 void rlcg::initTR (void) {
-  initDC ();
+  nr_double_t l = getPropertyDouble ("Length");
+  line = mocline ();
+  deleteHistory ();
+  if (l == 0.0) {
+    initDC ();
+    return;
+  }
+  std::vector<nr_double_t> freq = mocline::frequencies (MOCLINE_FMAX);
+  std::vector<nr_complex_t> yc, gamma;
+  for (nr_double_t f : freq) {
+    calcPropagation (f);
+    yc.push_back (1.0 / z);
+    gamma.push_back (g);
+  }
+  int m = line.addMode (getPropertyDouble ("R") * l);
+  line.addNode (m, 0, NODE_1, 1, 1);
+  line.addNode (m, 1, NODE_2, 1, 1);
+  if (line.fitMode (m, l, freq, yc, gamma)) {
+    logprint (LOG_ERROR, "WARNING: Cannot fit the transient model of `%s', "
+	      "using its DC model\n", getName ());
+    line = mocline ();
+    initDC ();
+    return;
+  }
+  line.initTR (this);
+}
+
+void rlcg::calcTR (nr_double_t t) {
+  if (line.getModes ()) line.calcTR (this, t);
 }
 
 // properties
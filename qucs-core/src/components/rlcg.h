@@ -25,6 +25,8 @@
 #ifndef __RLCG_H__
 #define __RLCG_H__
 
+#include "mocline.h"
+
 class rlcg : public qucs::circuit
 {
  public:
@@ -34,6 +36,7 @@ class rlcg : public qucs::circuit
   void initAC (void);
   void calcAC (nr_double_t);
   void initTR (void);
+  void calcTR (nr_double_t);
   void calcNoiseAC (nr_double_t);
   void calcNoiseSP (nr_double_t);
   void saveCharacteristics (nr_double_t);
@@ -42,6 +45,7 @@ class rlcg : public qucs::circuit
   void calcPropagation (nr_double_t);
   nr_complex_t g;
   nr_complex_t z;
+  mocline line;
 };
 
 #endif /* __RLCG_H__ */
@@ -0,0 +1,82 @@
+/*
+ * romodel.cpp - reduced order model class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "component.h"
+#include "romodel.h"
+
+using namespace qucs;
+
+/* The circuit has a node for each port and for each reduced state,
+   the latter are made internal nodes by the creator. */
+romodel::romodel (const std::shared_ptr<romodel_t> & m) :
+  circuit (m->ports + m->states), model (m) {
+  type = CIR_ROMODEL;
+}
+
+void romodel::initDC (void) {
+  int n = getSize ();
+  setVoltageSources (0);
+  allocMatrixMNA ();
+  for (int r = 0; r < n; r++)
+    for (int c = 0; c < n; c++)
+      setY (NODE_1 + r, NODE_1 + c, model->G[r * n + c]);
+}
+
+void romodel::initAC (void) {
+  initDC ();
+}
+
+void romodel::calcAC (nr_double_t frequency) {
+  int n = getSize ();
+  nr_double_t o = 2 * pi * frequency;
+  for (int r = 0; r < n; r++)
+    for (int c = 0; c < n; c++)
+      setY (NODE_1 + r, NODE_1 + c,
+	    nr_complex_t (model->G[r * n + c], o * model->C[r * n + c]));
+}
+
+void romodel::initTR (void) {
+  setStates (2 * getSize ());
+  initDC ();
+}
+
+/* Each row of the C matrix is the charge of a node, its integration
+   gives the companion conductances along the row. */
+void romodel::calcTR (nr_double_t) {
+  int n = getSize ();
+  for (int r = 0; r < n; r++) {
+    const nr_double_t * G = &model->G[r * n], * C = &model->C[r * n];
+    nr_double_t q = 0, g = 0, i = 0;
+    for (int c = 0; c < n; c++) q += C[c] * real (getV (NODE_1 + c));
+    setState (2 * r, q);
+    integrate (2 * r, 1, g, i);
+    for (int c = 0; c < n; c++)
+      setY (NODE_1 + r, NODE_1 + c, G[c] + g * C[c]);
+    setI (NODE_1 + r, -i);
+  }
+}
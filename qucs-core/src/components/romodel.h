@@ -0,0 +1,55 @@
+/*
+ * romodel.h - reduced order model class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __ROMODEL_H__
+#define __ROMODEL_H__
+
+#include <memory>
+#include <vector>
+
+/* The reduced model (G + sC) x = i of a linear subnetwork.  The first
+   unknowns are the port voltages with i being the currents into the
+   ports, the others are the reduced states.  The matrices are stored
+   row by row. */
+struct romodel_t
+{
+  int ports, states;
+  std::vector<nr_double_t> G, C;
+};
+
+class romodel : public qucs::circuit
+{
+ public:
+  romodel (const std::shared_ptr<romodel_t> &);
+  void initDC (void);
+  void initAC (void);
+  void calcAC (nr_double_t);
+  void initTR (void);
+  void calcTR (nr_double_t);
+
+ private:
+  std::shared_ptr<romodel_t> model;
+};
+
+#endif /* __ROMODEL_H__ */
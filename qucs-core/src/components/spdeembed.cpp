@@ -27,6 +27,7 @@
 #include "component.h"
 #include "matvec.h"
 #include "dataset.h"
+#include "filecache.h"
 #include "strlist.h"
 #include "poly.h"
 #include "spline.h"
@@ -70,8 +71,8 @@ void spdeembed::initSP (void) {
 
   // load S-parameter file
   const char * file = getPropertyString ("File");
-  if (data == NULL) data = dataset::load_touchstone (file);
-  if (data != NULL) {
+  if (!data) data = filecache::load (file, dataset::load_touchstone);
+  if (data) {
     // determine the number of ports defined by that file
     nPorts = (int) std::sqrt ((double) data->countVariables ());
   }
@@ -25,13 +25,18 @@
 # include <config.h>
 #endif
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 #include "component.h"
 #include "matvec.h"
 #include "dataset.h"
+#include "filecache.h"
 #include "strlist.h"
 #include "poly.h"
 #include "spline.h"
 #include "interpolator.h"
+#include "vectfit.h"
 #include "spembed.h"
 
 using namespace qucs;
@@ -40,6 +45,8 @@ using namespace qucs;
 spembed::spembed () : spfile () {
   type = CIR_SPFILE;
   setVariableSized (true); // number of ports is not fixed
+  tState = 0;
+  started = false;
 }
 
 void spembed::initSP (void) {
@@ -71,8 +78,8 @@ void spembed::initSP (void) {
 
   // load S-parameter file
   const char * file = getPropertyString ("File");
-  if (data == NULL) data = dataset::load_touchstone (file);
-  if (data != NULL) {
+  if (!data) data = filecache::load (file, dataset::load_touchstone);
+  if (data) {
     // determine the number of ports defined by that file
     nPorts = (int) std::sqrt ((double) data->countVariables ());
   }
@@ -275,8 +282,14 @@ void spembed::initDC (void) {
     allocMatrixMNA ();
     return;
   }
-  // none specified, DC value of IDFT ?
+  // none specified, DC value of the transient model
   else {
+    if (fitModel ()) {
+      initModel ();
+      stampModel (real (vfit->evaluate (0)),
+		  std::vector<nr_double_t> (nPorts, 0));
+      return;
+    }
     setVoltageSources (0);
     allocMatrixMNA ();
   }
@@ -297,8 +310,175 @@ void spembed::calcAC (nr_double_t frequency) {
   setMatrixY (stoy (getMatrixS ()));
 }
 
+/* Fits the pole-residue model to the S-parameters of the file.  It is
+   loaded from the cache file next to the file instead if that has been
+   fitted to the same data. */
+vectfit * spembed::createModel (const char * file) {
+  int poles = getPropertyInteger ("Poles");
+  struct stat st;
+  long size = 0, mtime = 0;
+  if (stat (file, &st) == 0) {
+    size = (long) st.st_size;
+    mtime = (long) st.st_mtime;
+  }
+  char key[64];
+  sprintf (key, "%ld %ld %d", size, mtime, poles);
+  std::string cache = std::string (file) + ".vfit";
+
+  vectfit * vf = new vectfit ();
+  if (!vf->load (cache.c_str (), key) && vf->getPorts () == nPorts)
+    return vf;
+
+  std::vector<nr_double_t> freq;
+  std::vector<matrix> s;
+  for (int i = 0; i < sfreq->getSize (); i++) {
+    freq.push_back (real (sfreq->get (i)));
+    s.push_back (getInterpolMatrixS (freq.back ()));
+  }
+  if (vf->fit (freq, s, poles)) {
+    logprint (LOG_ERROR, "WARNING: %s: cannot fit a transient model to "
+	      "`%s'\n", getName (), file);
+    delete vf;
+    return NULL;
+  }
+
+  // check the passivity up to well beyond the data
+  nr_double_t fmax = freq.back ();
+  for (int i = -150; i <= 50; i++)
+    freq.push_back (fmax * std::pow (10.0, i / 50.0));
+  nr_double_t g = vf->gain (freq);
+  if (g > 1) {
+    logprint (LOG_ERROR, "WARNING: %s: transient model of `%s' is not "
+	      "passive (gain %g), scaled down\n", getName (), file, g);
+    vf->scale (1 / g);
+  }
+  logprint (LOG_STATUS, "NOTIFY: %s: fitted %d poles to `%s', RMS error "
+	    "%g\n", getName (), vf->getPoles (), file, vf->getError ());
+  if (vf->save (cache.c_str (), key))
+    logprint (LOG_STATUS, "NOTIFY: %s: cannot cache transient model in "
+	      "`%s'\n", getName (), cache.c_str ());
+  return vf;
+}
+
+/* Provides the transient model of the file, instances with the same
+   pole setting share it.  Returns false if there is none. */
+bool spembed::fitModel (void) {
+  if (!vfit) {
+    initSP ();
+    if (spara == NULL || sfreq == NULL) return false;
+    const char * file = getPropertyString ("File");
+    char key[32];
+    sprintf (key, "vectfit %d", getPropertyInteger ("Poles"));
+    vfit = filecache::prepared<vectfit> (data, key, [&] {
+	return createModel (file);
+      });
+  }
+  return vfit != nullptr;
+}
+
+/* The model is stamped in terms of the port waves a = (V + z0 J) / 2
+   and b = (V - z0 J) / 2, with J being the current into the port. */
+void spembed::initModel (void) {
+  setVoltageSources (nPorts);
+  allocMatrixMNA ();
+  for (int i = 0; i < nPorts; i++) {
+    setB (NODE_1 + i, VSRC_1 + i, +1);
+    setB (NODE_1 + nPorts, VSRC_1 + i, -1);
+  }
+}
+
+/* Stamps the port equations b = S a + h for the given real S-matrix
+   and history waves h. */
+void spembed::stampModel (const matrix & s, const std::vector<nr_double_t> & h) {
+  for (int r = 0; r < nPorts; r++) {
+    nr_double_t sum = 0;
+    for (int c = 0; c < nPorts; c++) {
+      nr_double_t d = r == c ? 1 : 0, v = real (s (r, c));
+      setC (VSRC_1 + r, NODE_1 + c, d - v);
+      setD (VSRC_1 + r, VSRC_1 + c, -z0 * (d + v));
+      sum += d - v;
+    }
+    setC (VSRC_1 + r, NODE_1 + nPorts, -sum);
+    setE (VSRC_1 + r, 2 * h[r]);
+  }
+}
+
+/* Advances the convolution states to the accepted time step at the
+   given history index.  The first one is the DC operating point, the
+   states start in their steady state. */
+void spembed::advanceModel (int idx) {
+  int P = nPorts, K = vfit->getPoles ();
+  nr_double_t t = getHistoryTFromIndex (idx);
+  std::vector<nr_double_t> a (P);
+  for (int c = 0; c < P; c++) {
+    nr_double_t v = getV (NODE_1 + c, idx) - getV (NODE_1 + P, idx);
+    nr_double_t j = getV (getSize () + c, idx);
+    a[c] = (v + z0 * j) / 2;
+  }
+  for (int k = 0; k < K; k++) {
+    nr_complex_t p = vfit->poles[k], alpha, b0, b1;
+    if (started) vectfit::recursion (p, t - tState, alpha, b0, b1);
+    for (int c = 0; c < P; c++) {
+      nr_complex_t & x = state[k * P + c];
+      x = started ? alpha * x + b1 * wave[c] + b0 * a[c] : -a[c] / p;
+    }
+  }
+  wave = a;
+  tState = t;
+  started = true;
+}
+
+/* The transient analysis uses the pole-residue model fitted to the
+   S-parameters.  Each pole is convolved recursively with the incident
+   waves, which costs the same for each time step instead of a
+   convolution over the whole history. */
 void spembed::initTR (void) {
-  initDC ();
+  deleteHistory ();
+  if (!fitModel ()) {
+    initDC ();
+    return;
+  }
+  initModel ();
+  // the last of the accepted time steps is needed only
+  setHistory (true);
+  initHistory (NR_TINY);
+  state.assign (vfit->getPoles () * nPorts, 0);
+  wave.assign (nPorts, 0);
+  tState = 0;
+  started = false;
+}
+
+void spembed::calcTR (nr_double_t t) {
+  // the DC replacement is in place without a model
+  if (!vfit) return;
+
+  // catch up with the time steps accepted meanwhile, rejected ones
+  // never enter the history
+  int n = getHistorySize (), i = n;
+  while (i > 0 && (!started || getHistoryTFromIndex (i - 1) > tState)) i--;
+  for (; i < n; i++) advanceModel (i);
+
+  std::vector<nr_double_t> h (nPorts, 0);
+  if (!started) {
+    stampModel (real (vfit->evaluate (0)), h);
+    return;
+  }
+
+  int P = nPorts, K = vfit->getPoles ();
+  matrix s = vfit->D;
+  for (int k = 0; k < K; k++) {
+    nr_complex_t alpha, b0, b1;
+    vectfit::recursion (vfit->poles[k], t - tState, alpha, b0, b1);
+    nr_double_t w = vfit->isPair (k) ? 2 : 1;
+    const matrix & R = vfit->residues[k];
+    for (int r = 0; r < P; r++) {
+      for (int c = 0; c < P; c++) {
+	s (r, c) += w * real (R (r, c) * b0);
+	h[r] += w * real (R (r, c) * (alpha * state[k * P + c] + b1 * wave[c]));
+      }
+    }
+  }
+  stampModel (s, h);
 }
 
 // properties
@@ -313,6 +493,7 @@ PROP_OPT [] = {
   { "Temp", PROP_REAL, { 26.85, PROP_NO_STR }, PROP_MIN_VAL (K) },
   { "duringDC", PROP_STR, { PROP_NO_VAL, "open" },
     PROP_RNG_STR4 ("open", "short", "shortall", "unspecified") },
+  { "Poles", PROP_INT, { 0, PROP_NO_STR }, PROP_RNGII (0, VECTFIT_MAXPOLES) },
   PROP_NO_PROP };
 struct define_t spembed::cirdef =
   { "SPfile",
@@ -26,6 +26,10 @@
 
 #include "spfile.h"
 
+namespace qucs {
+  class vectfit;
+}
+
 /* S-parameters embedding component takes data from an SnP file */
 class spembed : public spfile, public qucs::circuit
 {
@@ -36,6 +40,7 @@ class spembed : public spfile, public qucs::circuit
   void calcSP (nr_double_t);
   void initDC (void);
   void initTR (void);
+  void calcTR (nr_double_t);
   void initAC (void);
   void calcAC (nr_double_t);
 
@@ -47,6 +52,20 @@ class spembed : public spfile, public qucs::circuit
   qucs::matrix expandNoiseMatrix (qucs::matrix, qucs::matrix);
   qucs::matrix shrinkNoiseMatrix (qucs::matrix, qucs::matrix);
   qucs::matrix calcMatrixCs (nr_double_t);
+
+ private:
+  bool fitModel (void);
+  qucs::vectfit * createModel (const char *);
+  void initModel (void);
+  void stampModel (const qucs::matrix &, const std::vector<nr_double_t> &);
+  void advanceModel (int);
+
+ private:
+  std::shared_ptr<qucs::vectfit> vfit;
+  std::vector<nr_complex_t> state;
+  std::vector<nr_double_t> wave;
+  nr_double_t tState;
+  bool started;
 };
 
 #endif /* SPEMBED_H */
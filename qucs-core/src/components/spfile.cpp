@@ -26,11 +26,14 @@
 # include <config.h>
 #endif
 
+#include <algorithm>
+
 #include "object.h"
 #include "vector.h"
 #include "matrix.h"
 #include "matvec.h"
 #include "dataset.h"
+#include "filecache.h"
 #include "strlist.h"
 #include "poly.h"
 #include "spline.h"
@@ -77,9 +80,131 @@ nr_complex_t spfile_vector::interpolate (nr_double_t x) {
     return inter->cinterpolate (x);
 }
 
+// Constructor for the S-parameter matrix interpolator.
+spfile_matrix::spfile_matrix () {
+  ports = points = 0;
+  interpolType = dataType = 0;
+  cursor = 0;
+}
+
+// Destructor for the S-parameter matrix interpolator.
+spfile_matrix::~spfile_matrix () {
+}
+
+/* Prepares the interpolation of the matrix entries of the given
+   S-parameter file vectors over the frequency vector.  Each row of
+   the coefficient table belongs to a frequency interval and holds the
+   polynomials of the real and imaginary parts of all entries.  For
+   cubic splines the first row extrapolates below the first frequency,
+   the other interpolators extrapolate the first interval. */
+void spfile_matrix::prepare (spfile_vector * spara, int n, qucs::vector * f,
+			     int it, int dt) {
+  ports = n;
+  points = f ? f->getSize () : 0;
+  interpolType = it;
+  dataType = dt;
+  cursor = 0;
+  // too few points for a spline
+  if ((interpolType & INTERPOL_CUBIC) && points < 3)
+    interpolType = INTERPOL_LINEAR;
+
+  freq.resize (points);
+  for (int i = 0; i < points; i++) freq[i] = real (f->get (i));
+
+  int rows = points;
+  if ((interpolType & INTERPOL_CUBIC)) rows++;
+  int entries = ports * ports;
+  origin.assign (rows, 0);
+  coeff.assign (rows * entries * 8, 0);
+  for (int r = 0; r < rows; r++)
+    origin[r] = freq[(interpolType & INTERPOL_CUBIC) && r > 0 ? r - 1 : r];
+
+  std::vector<nr_double_t> y[2];
+  y[0].resize (points);
+  y[1].resize (points);
+  // the splines of all entries share the frequency grid
+  spline sp (SPLINE_BC_NATURAL);
+  bool grid = false;
+  for (int k = 0; k < entries; k++) {
+    spfile_vector * e = &spara[(k / ports) * (ports + 1) + k % ports];
+    if (e->v == NULL) continue;
+
+    // magnitude and unwrapped phase of polar data
+    qucs::vector v = *e->v;
+    if ((dataType & DATA_POLAR) && points > 1) {
+      qucs::vector ang = unwrap (arg (v));
+      for (int i = 0; i < points; i++)
+	v (i) = nr_complex_t (abs (v (i)), real (ang (i)));
+    }
+    for (int i = 0; i < points; i++) {
+      y[0][i] = real (v (i));
+      y[1][i] = imag (v (i));
+    }
+
+    for (int p = 0; p < 2; p++) {
+      nr_double_t * c = &coeff[k * 8 + p * 4];
+      int stride = entries * 8;
+      if (interpolType & INTERPOL_CUBIC) {
+	if (grid)
+	  sp.values (&y[p][0]);
+	else
+	  sp.vectors (&y[p][0], &freq[0], points);
+	grid = true;
+	sp.construct ();
+	sp.coefficients (0, c);
+	c[2] = c[3] = 0;
+	for (int i = 0; i < points; i++)
+	  sp.coefficients (i, c + (i + 1) * stride);
+      }
+      else {
+	for (int i = 0; i < points; i++, c += stride) {
+	  c[0] = y[p][i];
+	  if (!(interpolType & INTERPOL_LINEAR) || points < 2) continue;
+	  // the last row extrapolates the last interval
+	  int j = std::min (i, points - 2);
+	  nr_double_t h = freq[j + 1] - freq[j];
+	  if (h != 0) c[1] = (y[p][j + 1] - y[p][j]) / h;
+	}
+      }
+    }
+  }
+}
+
+/* Returns the row of the coefficient table for the given frequency.
+   The number of frequencies not above it is kept, thus sweeps with
+   ascending frequencies find their interval without a search. */
+int spfile_matrix::findRow (nr_double_t x) {
+  int n = cursor;
+  if (points <= 1) return 0;
+  if ((n > 0 && freq[n - 1] > x) || (n < points && freq[n] <= x)) {
+    if (n < points && freq[n] <= x && (n + 1 == points || x < freq[n + 1]))
+      n++;
+    else
+      n = std::upper_bound (freq.begin (), freq.end (), x) - freq.begin ();
+  }
+  cursor = n;
+  if (interpolType & INTERPOL_CUBIC) return n;
+  return n > 0 ? n - 1 : 0;
+}
+
+// Stores the interpolated matrix entries into the given matrix.
+void spfile_matrix::interpolate (nr_double_t x, matrix & s) {
+  if (points <= 0) return;
+  int row = findRow (x), entries = ports * ports;
+  nr_double_t dx = x - origin[row];
+  const nr_double_t * c = &coeff[row * entries * 8];
+  for (int k = 0; k < entries; k++, c += 8) {
+    nr_double_t re = c[0] + dx * (c[1] + dx * (c[2] + dx * c[3]));
+    nr_double_t im = c[4] + dx * (c[5] + dx * (c[6] + dx * c[7]));
+    if (dataType & DATA_POLAR)
+      s.set (k / ports, k % ports, std::polar (re, im));
+    else
+      s.set (k / ports, k % ports, nr_complex_t (re, im));
+  }
+}
+
 // Constructor creates an empty and unnamed instance of the spfile class.
 spfile::spfile () {
-  data = NULL;
   sfreq = nfreq = NULL;
   spara = FMIN = SOPT = RN = NULL;
   interpolType = dataType = 0;
@@ -97,7 +222,6 @@ spfile::~spfile () {
     data->print ();
   }
 #endif
-  delete data;
 }
 
 /* This function returns the S-parameter matrix of the circuit for the
@@ -107,12 +231,7 @@ matrix spfile::getInterpolMatrixS (nr_double_t frequency) {
 
   // first interpolate the matrix values
   matrix s (nPorts);
-  for (int r = 0; r < nPorts; r++) {
-    for (int c = 0; c < nPorts; c++) {
-      int i = r * (nPorts + 1) + c;
-      s.set (r, c, spara[i].interpolate (frequency));
-    }
-  }
+  sinter->interpolate (frequency, s);
 
   // then convert them to S-parameters if necessary
   switch (paraType) {
@@ -135,7 +254,7 @@ matrix spfile::getInterpolMatrixS (nr_double_t frequency) {
 /* This function expands the actual S-parameter file data stored
    within the touchstone file to have an additional reference one-port
    whose S-parameter is -1 (i.e. ground). */
-matrix spfile::expandSParaMatrix (matrix s) {
+matrix spfile::expandSParaMatrix (const matrix & s) {
   assert (s.getCols () == s.getRows ());
   int r, c, ports = s.getCols () + 1;
   nr_double_t g = -1;
@@ -175,7 +294,7 @@ matrix spfile::expandSParaMatrix (matrix s) {
 /* The function is the counterpart of the above expandSParaMatrix()
    function.  It shrinks the S-parameter matrix by removing the
    reference port. */
-matrix spfile::shrinkSParaMatrix (matrix s) {
+matrix spfile::shrinkSParaMatrix (const matrix & s) {
   assert (s.getCols () == s.getRows () && s.getCols () > 0);
   int r, c, ports = s.getCols ();
   nr_double_t g = -1;
@@ -203,8 +322,9 @@ void spfile::createVector (int r, int c) {
   spara[i].c = c;
   qucs::vector * v = new qucs::vector (matvec::createMatrixString ("S", r, c),
 			       sfreq->getSize ());
-  v->setDependencies (new strlist ());
-  v->getDependencies()->add (sfreq->getName ());
+  strlist * deps = new strlist ();
+  deps->add (sfreq->getName ());
+  v->setDependencies (deps);
   data->addVariable (v);
   spara[i].v = v;
 }
@@ -237,7 +357,9 @@ void spfile::createIndex (void) {
       i = r * s + c;
       spara[i].r = r;
       spara[i].c = c;
-      spara[i].prepare (v, sfreq, false, interpolType, dataType);
+      spara[i].v = v;
+      spara[i].f = sfreq;
+      spara[i].isreal = 0;
       paraType = n[0];  // save type of touchstone data
       free (n);
     }
@@ -257,4 +379,14 @@ void spfile::createIndex (void) {
       }
     }
   }
+
+  /* interpolate the matrix entries together, instances with the same
+     settings share the coefficients */
+  char key[32];
+  sprintf (key, "spfile_matrix %d %d %d", nPorts, interpolType, dataType);
+  sinter = filecache::prepared<spfile_matrix> (data, key, [&] {
+      spfile_matrix * m = new spfile_matrix ();
+      m->prepare (spara, nPorts, sfreq, interpolType, dataType);
+      return m;
+    });
 }
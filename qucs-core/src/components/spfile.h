@@ -25,6 +25,9 @@
 #ifndef __SPFILE_H__
 #define __SPFILE_H__
 
+#include <vector>
+#include <memory>
+
 namespace qucs {
   class vector;
   class matvec;
@@ -51,6 +54,33 @@ class spfile_vector
   int c;
 };
 
+/* Interpolator for all the entries of the S-parameter matrix at once.
+   The frequency interval is located once per evaluation, its
+   polynomial coefficients are stored contiguously for all entries. */
+class spfile_matrix
+{
+ public:
+  spfile_matrix ();
+  ~spfile_matrix ();
+
+ public:
+  void prepare (spfile_vector *, int, qucs::vector *, int, int);
+  void interpolate (nr_double_t, qucs::matrix &);
+
+ private:
+  int findRow (nr_double_t);
+
+ private:
+  int ports;
+  int points;
+  int interpolType;
+  int dataType;
+  int cursor;
+  std::vector<nr_double_t> freq;
+  std::vector<nr_double_t> origin;
+  std::vector<nr_double_t> coeff;
+};
+
 class spfile
 {
  public:
@@ -59,15 +89,16 @@ class spfile
   void createIndex (void);
   void prepare (void);
   void createVector (int, int);
-  qucs::matrix expandSParaMatrix (qucs::matrix);
-  qucs::matrix shrinkSParaMatrix (qucs::matrix);
+  qucs::matrix expandSParaMatrix (const qucs::matrix &);
+  qucs::matrix shrinkSParaMatrix (const qucs::matrix &);
   qucs::matrix getInterpolMatrixS (nr_double_t);
 
   int nPorts;
-  qucs::dataset * data;
+  std::shared_ptr<qucs::dataset> data;
   qucs::vector * sfreq;
   qucs::vector * nfreq;
   spfile_vector * spara;
+  std::shared_ptr<spfile_matrix> sinter;
   spfile_vector * RN;
   spfile_vector * FMIN;
   spfile_vector * SOPT;
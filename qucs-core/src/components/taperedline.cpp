@@ -41,7 +41,7 @@ US department of commerce (1964). Link: http://people.math.sfu.ca/~cbm/aands/pag
 
 using namespace qucs;
 
-taperedline::taperedline () : circuit (2) {
+taperedline::taperedline () : circuit (2), ABCD (2) {
   type = CIR_TAPEREDLINE;
 }
 //------------------------------------------------------------------
@@ -55,34 +55,29 @@ void taperedline::calcABCDparams(nr_double_t frequency)
   nr_double_t lstep = L/Nsteps; //Size of the differential elements
   nr_double_t beta = 2*pi*frequency/C0; //Propagation constant
   nr_complex_t gamma = nr_complex_t (alpha, beta); //Complex propagation constant
-  matrix ABCD_ = eye(2);//Overall ABCD matrix
-  matrix ABCDaux = eye(2);//Auxiliar matrix for performing the iterative product
-  nr_double_t Zi;
-  nr_complex_t a, b, c, d;
-  // ABCD coefficients
-  a = cosh(gamma*lstep);
-  b = sinh(gamma*lstep); // need to be multiplied by Zi
-  c = sinh(gamma*lstep); // need to be divided by Zi
-  d = cosh(gamma*lstep); 
+  // ABCD coefficients a = d = cosh(gamma*lstep), b = Zi*sh and c = sh/Zi
+  // being the same for all sections but the impedance
+  nr_complex_t ch = cosh(gamma*lstep);
+  nr_complex_t sh = sinh(gamma*lstep);
+  // Overall ABCD coefficients, starting with the identity
+  nr_complex_t A = 1.0, B = 0.0, C = 0.0, D = 1.0;
 
-  nr_double_t l = lstep/2.0; // compute impedance in the middle of the section
   for (int idx = 0 ; idx < Nsteps; idx++)
   {
     // The line is discretized in finite elements. The size of these elements can be considered a differential
     // length since the impedance change across the actual section is small. 
     // Taking into account the cascading property of the ABCD matrix, the overall
-    // ABCD matrix can be calculated as the product of the individual ABCD matrices.   
-    Zi = Zprofile[idx];
-    ABCDaux.set(0,0,a);
-    ABCDaux.set(0,1,Zi*b);
-    ABCDaux.set(1,0,c/Zi);
-    ABCDaux.set(1,1,d);
-    //Iterative product
-    ABCD_=ABCD_*ABCDaux;
-    l += lstep; // move to the next section
+    // ABCD matrix can be calculated as the product of the individual ABCD matrices,
+    // expanded here for the 2x2 section matrices.
+    nr_complex_t bz = sh*Zprofile[idx], cy = sh*Yprofile[idx];
+    nr_complex_t An = A*ch + B*cy, Bn = A*bz + B*ch;
+    nr_complex_t Cn = C*ch + D*cy, Dn = C*bz + D*ch;
+    A = An; B = Bn; C = Cn; D = Dn;
   }
-  // Overall ABCD coefficients
-  ABCD = ABCD_;
+  ABCD.set(0,0,A);
+  ABCD.set(0,1,B);
+  ABCD.set(1,0,C);
+  ABCD.set(1,1,D);
 }
 
 //------------------------------------------------------------------
@@ -168,6 +163,7 @@ nr_double_t L = getPropertyDouble ("L");//Length
            }
         }
     }
+    Yprofile[idx] = 1/Zprofile[idx];
  }
 }
 
@@ -50,6 +50,7 @@ private:
   nr_double_t phi(nr_double_t, nr_double_t);
   qucs::matrix ABCD;
   double Zprofile[Nsteps];
+  double Yprofile[Nsteps];
 };
 
 #endif /* __taperedline_H__ */
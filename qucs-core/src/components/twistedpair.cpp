@@ -191,8 +191,45 @@ void twistedpair::calcNoiseAC (nr_double_t) {
   setMatrixN (4 * celsius2kelvin (T) / T0 * real (getMatrixY ()));
 }
 
+/* The transient analysis uses the method of characteristics for the
+   differential mode with the propagation function fitted to the
+   frequency domain model of the pair.  Like for the AC analysis the
+   common mode is left floating. */
 void twistedpair::initTR (void) {
-  initDC ();
+  nr_double_t d   = getPropertyDouble ("d");
+  nr_double_t rho = getPropertyDouble ("rho");
+  calcLength ();
+  line = mocline ();
+  deleteHistory ();
+  if (len == 0.0) {
+    initDC ();
+    return;
+  }
+  std::vector<nr_double_t> freq = mocline::frequencies (MOCLINE_FMAX);
+  std::vector<nr_complex_t> yc, gamma;
+  for (nr_double_t f : freq) {
+    calcPropagation (f);
+    yc.push_back (1.0 / zl);
+    gamma.push_back (nr_complex_t (alpha, beta));
+  }
+  nr_double_t rdc = d != 0.0 ? 2 * rho * len / pi / sqr (d / 2) : 0;
+  int m = line.addMode (rdc);
+  line.addNode (m, 0, NODE_1, +1, +1);
+  line.addNode (m, 0, NODE_4, -1, -1);
+  line.addNode (m, 1, NODE_2, +1, +1);
+  line.addNode (m, 1, NODE_3, -1, -1);
+  if (line.fitMode (m, len, freq, yc, gamma)) {
+    logprint (LOG_ERROR, "WARNING: Cannot fit the transient model of `%s', "
+	      "using its DC model\n", getName ());
+    line = mocline ();
+    initDC ();
+    return;
+  }
+  line.initTR (this);
+}
+
+void twistedpair::calcTR (nr_double_t t) {
+  if (line.getModes ()) line.calcTR (this, t);
 }
 
 // properties
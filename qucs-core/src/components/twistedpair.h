@@ -25,6 +25,8 @@
 #ifndef __TWISTEDPAIR_H__
 #define __TWISTEDPAIR_H__
 
+#include "mocline.h"
+
 class twistedpair : public qucs::circuit
 {
  public:
@@ -37,6 +39,7 @@ class twistedpair : public qucs::circuit
   void calcAC (nr_double_t);
   void calcNoiseAC (nr_double_t);
   void initTR (void);
+  void calcTR (nr_double_t);
   void saveCharacteristics (nr_double_t);
 
  private:
@@ -46,6 +49,7 @@ class twistedpair : public qucs::circuit
 
  private:
   nr_double_t zl, ereff, alpha, beta, len, angle;
+  mocline line;
 };
 
 #endif /* __TWISTEDPAIR_H__ */
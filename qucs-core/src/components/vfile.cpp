@@ -29,6 +29,7 @@
 
 #include "component.h"
 #include "dataset.h"
+#include "filecache.h"
 #include "poly.h"
 #include "spline.h"
 #include "interpolator.h"
@@ -42,14 +43,10 @@ vfile::vfile () : circuit (2) {
   setVSource (true);
   setVoltageSources (1);
   interpolType = dataType = 0;
-  data = NULL;
-  inter = NULL;
 }
 
 // Destructor deletes vfile object from memory.
 vfile::~vfile () {
-  delete data;
-  delete inter;
 }
 
 void vfile::prepare (void) {
@@ -76,12 +73,12 @@ void vfile::prepare (void) {
 
   // load file with samples
   const char * file = getPropertyString ("File");
-  if (data == NULL) {
+  if (!data) {
     if (strlen (file) > 4 && !strcasecmp (&file[strlen (file) - 4], ".dat"))
-      data = dataset::load (file);
+      data = filecache::load (file, dataset::load);
     else
-      data = dataset::load_csv (file);
-    if (data != NULL) {
+      data = filecache::load (file, dataset::load_csv);
+    if (data) {
       // check number of variables / dependencies defined by that file
       if (data->countVariables () != 1 || data->countDependencies () != 1) {
 	logprint (LOG_ERROR, "ERROR: file `%s' must have time as an "
@@ -91,9 +88,15 @@ void vfile::prepare (void) {
       }
       qucs::vector * vs = data->getVariables();    // voltage
       qucs::vector * ts = data->getDependencies(); // time
-      inter = new interpolator ();
-      inter->rvectors (vs, ts);
-      inter->prepare (interpolType, dataType);
+      // instances with the same settings share the interpolator
+      char key[32];
+      sprintf (key, "interpolator %d %d", interpolType, dataType);
+      inter = filecache::prepared<interpolator> (data, key, [&] {
+	  interpolator * i = new interpolator ();
+	  i->rvectors (vs, ts);
+	  i->prepare (interpolType, dataType);
+	  return i;
+	});
     }
   }
 }
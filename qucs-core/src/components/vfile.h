@@ -26,6 +26,8 @@
 #ifndef __VFILE_H__
 #define __VFILE_H__
 
+#include <memory>
+
 namespace qucs {
   class dataset;
   class interpolator;
@@ -44,10 +46,10 @@ class vfile : public qucs::circuit
   void prepare (void);
 
 private:
-  qucs::dataset * data;
+  std::shared_ptr<qucs::dataset> data;
   int dataType;
   int interpolType;
-  qucs::interpolator * inter;
+  std::shared_ptr<qucs::interpolator> inter;
 };
 
 #endif /* __VFILE_H__ */
@@ -57,7 +57,16 @@ void vpulse::initAC (void) {
 }
 
 void vpulse::initTR (void) {
+  nr_double_t t1 = getPropertyDouble ("T1");
+  nr_double_t t2 = getPropertyDouble ("T2");
+  nr_double_t tr = getPropertyDouble ("Tr");
+  nr_double_t tf = getPropertyDouble ("Tf");
   initDC ();
+  // register the corners of the pulse
+  getNet()->addBreakpoint (t1);
+  getNet()->addBreakpoint (t1 + tr);
+  getNet()->addBreakpoint (t2 - tf);
+  getNet()->addBreakpoint (t2);
 }
 
 void vpulse::calcTR (nr_double_t t) {
@@ -68,7 +68,24 @@ void vrect::initAC (void) {
 }
 
 void vrect::initTR (void) {
+  nr_double_t th = getPropertyDouble ("TH");
+  nr_double_t tl = getPropertyDouble ("TL");
+  nr_double_t tr = getPropertyDouble ("Tr");
+  nr_double_t tf = getPropertyDouble ("Tf");
+  nr_double_t td = getPropertyDouble ("Td");
   initDC ();
+
+  // register the corners of each period
+  if (tr > th) tr = th;
+  if (tf > tl) tf = tl;
+  nr_double_t stop = getNet()->getBreakpointStop ();
+  nr_double_t k = td < 0 ? qucs::floor (-td / (th + tl)) : 0;
+  for (nr_double_t t = td + k * (th + tl); t <= stop; t += th + tl) {
+    getNet()->addBreakpoint (t);
+    getNet()->addBreakpoint (t + tr);
+    getNet()->addBreakpoint (t + th);
+    getNet()->addBreakpoint (t + th + tf);
+  }
 }
 
 void vrect::calcTR (nr_double_t t) {
@@ -50,6 +50,9 @@ struct definition_t * device_root = NULL;
 int spice_errors = 0;
 char * spice_title = NULL;
 
+// The device descriptions in device_root indexed by their instance names.
+static qucs::hash<struct definition_t> spice_Models;
+
 // List of available Spice component properties.
 static struct property_t spice_noprops[] = { PROP_NO_PROP };
 
@@ -246,13 +249,57 @@ netlist_append_nodes (struct node_t * n1, struct node_t * n2) {
   return n1;
 }
 
-/* This function goes through the list of available definitions and
-   checks whether the given component type can be found. */
+/* Hash tables of definitions indexed case-insensitively by their type
+   and instance names. */
+typedef qucs::hash<struct definition_t> spice_index_t;
+
+/* Returns the upper-cased key of the given type and instance name into
+   the hash tables of definitions.  It must be freed by the caller. */
+static char * spice_index_key (const char * type, const char * inst) {
+  char * key = (char *) malloc (strlen (type) + strlen (inst) + 2);
+  sprintf (key, "%s:%s", type, inst);
+  for (char * p = key; *p; p++) *p = toupper (*p);
+  return key;
+}
+
+/* The function adds a definition to the given hash table unless there
+   is already one with the same key.  Thus the first one in list order
+   is found just as by looking through the list. */
+static void spice_index_add (spice_index_t * index, struct definition_t * def) {
+  char * key = spice_index_key (def->type, def->instance);
+  if (!index->get (key)) index->put (key, def);
+  free (key);
+}
+
+/* Looks for the definition with the given type and instance name in
+   the hash table.  Returns NULL if there is no such definition. */
+static struct definition_t *
+spice_index_find (spice_index_t * index, const char * type, char * inst) {
+  char * key = spice_index_key (type, inst);
+  struct definition_t * def = index->get (key);
+  free (key);
+  return def;
+}
+
+/* Available definition types indexed by their upper-cased names. */
+static qucs::hash<struct define_t> spice_definition_index;
+
+/* This function looks up the given component type in the list of
+   available definitions. */
 static struct define_t * spice_find_definition (const char * n) {
-  struct define_t * def;
-  for (def = spice_definition_available; def->type != NULL; def++)
-    if (!strcasecmp (n, def->type)) return def;
-  return NULL;
+  if (spice_definition_index.count () == 0) {
+    for (struct define_t * def = spice_definition_available;
+	 def->type != NULL; def++) {
+      char * key = spice_index_key ("", def->type);
+      if (!spice_definition_index.get (key))
+	spice_definition_index.put (key, def);
+      free (key);
+    }
+  }
+  char * key = spice_index_key ("", n);
+  struct define_t * def = spice_definition_index.get (key);
+  free (key);
+  return def;
 }
 
 /* The function creates a single translated spice node. */
@@ -418,18 +465,26 @@ static struct pair_t * spice_get_pairs (struct definition_t * def) {
   return netlist_reverse_pairs (root);
 }
 
-/* The function goes through the list of definitions and tries to find
-   the given device model.  It returns NULL if there is no such
-   model. */
-static struct definition_t *
-spice_find_device (struct definition_t * root, char * type) {
+/* The .MODEL definitions of the global definition root. */
+static spice_index_t * spice_models = NULL;
+
+/* The function puts the .MODEL definitions of the given list of
+   definitions into the hash table. */
+static void spice_index_models (spice_index_t * models,
+				struct definition_t * root) {
   for (struct definition_t * def = root; def != NULL; def = def->next) {
-    if (def->action && !strcasecmp (def->type, "MODEL") &&
-	!strcasecmp (def->instance, type)) {
-      return def;
-    }
+    if (def->action && !strcasecmp (def->type, "MODEL"))
+      spice_index_add (models, def);
   }
-  return NULL;
+}
+
+/* The function tries to find the given device model in the hash table
+   of .MODEL definitions.  It returns NULL if there is no such
+   model. */
+static struct definition_t *
+spice_find_device (spice_index_t * models, char * type) {
+  if (models == NULL) return NULL;
+  return spice_index_find (models, "MODEL", type);
 }
 
 /* Looks for the first possible .MODEL or any other device reference
@@ -653,7 +708,7 @@ static void spice_adjust_device (struct definition_t * def,
 
 /* The function translates .MODEL specifications in device (MOSFET,
    BJT, etc.)  instances. */
-static void spice_translate_device (struct definition_t * root,
+static void spice_translate_device (spice_index_t * models,
 				    struct definition_t * def) {
   struct value_t * inst = spice_find_device_instance (def);
 
@@ -663,8 +718,8 @@ static void spice_translate_device (struct definition_t * root,
   /* first look for the Model in the local definition root, then in
      the global definition root */
   struct definition_t * tran;
-  if ((tran = spice_find_device (root, inst->ident)) == NULL)
-    tran = spice_find_device (definition_root, inst->ident);
+  if ((tran = spice_find_device (models, inst->ident)) == NULL)
+    tran = spice_find_device (spice_models, inst->ident);
   // really translate the instance here
   if (tran != NULL) {
     spice_value_done (inst);
@@ -1145,6 +1200,7 @@ static void netlist_destroy_intern (struct definition_t * root) {
 void spice_destroy (void) {
   netlist_destroy_intern (definition_root);
   netlist_destroy_intern (device_root);
+  spice_Models.clear ();
   for (struct definition_t * def = subcircuit_root; def; def = def->next) {
     netlist_destroy_intern (def->sub);
   }
@@ -1659,16 +1715,10 @@ static void spice_collect_external_nodes (struct definition_t * def) {
   }
 }
 
-/* This function goes through the list of device descriptions and
-   checks whether the given model is already in the list.  Returns
-   NULL if there is no such model. */
+/* This function checks whether the given model is already in the list
+   of device descriptions.  Returns NULL if there is no such model. */
 static struct definition_t * spice_find_Model (char * instance) {
-  struct definition_t * dev;
-  for (dev = device_root; dev; dev = dev->next) {
-    if (!strcmp (dev->instance, instance))
-      return dev;
-  }
-  return NULL;
+  return spice_Models.get (instance);
 }
 
 /* The function appends a new device model.  It creates the actual
@@ -1690,6 +1740,7 @@ static struct definition_t * spice_add_Model (struct definition_t * def) {
     spice_adjust_optional_properties (Model);
     Model->next = device_root;
     device_root = Model;
+    spice_Models.put (Model->instance, Model);
   }
   else {
     free (Model->instance);
@@ -2249,7 +2300,8 @@ spice_create_poly (struct value_t * prop, int nd, int integrate) {
 
 /* Translates E and G poly sources. */
 static struct definition_t *
-spice_translate_poly (struct definition_t * root, struct definition_t * def) {
+spice_translate_poly (spice_index_t * sources, struct definition_t * root,
+		      struct definition_t * def) {
   struct value_t * prop;
   int nd, type = -1;
 
@@ -2300,7 +2352,8 @@ spice_translate_poly (struct definition_t * root, struct definition_t * def) {
 	int p = i + 1;
 	// find referenced voltage source (where current flows through)
 	vn = prop->ident;
-	vdc = spice_find_definition (root, "Vdc", vn);
+	vdc = sources ? spice_index_find (sources, "Vdc", vn) :
+	  spice_find_definition (root, "Vdc", vn);
 	if (vdc) {
 	  // create intermediate current controlled voltage source
 	  // passing voltage to an EDD branch
@@ -2465,6 +2518,13 @@ spice_translate_poly_lc (struct definition_t * root,
    resulting netlist. */
 static struct definition_t *
 spice_post_translator (struct definition_t * root) {
+  /* index the sources referenced by other definitions, the ones added
+     below are of different types */
+  spice_index_t sources;
+  for (struct definition_t * def = root; def != NULL; def = def->next) {
+    if (!strcasecmp (def->type, "Vdc") || !strcasecmp (def->type, "Idc"))
+      spice_index_add (&sources, def);
+  }
   for (struct definition_t * def = root; def != NULL; def = def->next) {
     // post-process parameter sweep
     if (def->action && !strcmp (def->type, "SW")) {
@@ -2473,13 +2533,13 @@ spice_post_translator (struct definition_t * root) {
       char * val = spice_toupper (prop->value->ident);
       struct definition_t * target;
       // get the target voltage or current source and adjust the property
-      target = spice_find_definition (root, "Vdc", val);
+      target = spice_index_find (&sources, "Vdc", val);
       if (target) {
 	prop = spice_find_property (target, "U");
 	prop->value->ident = strdup (val);
       }
       else {
-	target = spice_find_definition (root, "Idc", val);
+	target = spice_index_find (&sources, "Idc", val);
 	if (target) {
 	  prop = spice_find_property (target, "I");
 	  prop->value->ident = strdup (val);
@@ -2498,7 +2558,7 @@ spice_post_translator (struct definition_t * root) {
       struct value_t * val = spice_find_device_instance (def);
       if (val) {
 	char * key = val->ident;
-	target = spice_find_definition (root, "Vdc", key);
+	target = spice_index_find (&sources, "Vdc", key);
 	if (target) {
 	  // adjust the controlling nodes of the source
 	  spice_adjust_vsource_nodes (def, target);
@@ -2515,7 +2575,7 @@ spice_post_translator (struct definition_t * root) {
     // post-process F and H poly sources
     if (!def->action && (!strcmp (def->type, "F") ||
 			 !strcmp (def->type, "H"))) {
-      root = spice_translate_poly (root, def);
+      root = spice_translate_poly (&sources, root, def);
     }
     // post-process switches
     if (!def->action && !strcmp (def->type, "Relais")) {
@@ -2895,6 +2955,8 @@ spice_translate_nodeset (struct definition_t * root,
 /* This is the overall Spice netlist translator.  It adjusts the list
    of definitions into usable structures. */
 static struct definition_t * spice_translator (struct definition_t * root) {
+  spice_index_t models;
+  spice_index_models (&models, root);
   for (struct definition_t * def = root; def != NULL; def = def->next) {
     if ((def->define = spice_find_definition (def->type)) != NULL) {
       strcpy (def->type, def->define->type);
@@ -2906,11 +2968,11 @@ static struct definition_t * spice_translator (struct definition_t * root) {
 	    !strcasecmp (def->type, "J") || !strcasecmp (def->type, "D") ||
 	    !strcasecmp (def->type, "S") || !strcasecmp (def->type, "R") ||
 	    !strcasecmp (def->type, "C")) {
-	  spice_translate_device (root, def);
+	  spice_translate_device (&models, def);
 	}
 	// controlled sources
 	if (!strcasecmp (def->type, "E") || !strcasecmp (def->type, "G")) {
-	  root = spice_translate_poly (root, def);
+	  root = spice_translate_poly (NULL, root, def);
 	}
 	// controlled sources
 	if (!strcasecmp (def->type, "C") || !strcasecmp (def->type, "L")) {
@@ -3020,7 +3082,11 @@ struct definition_t * spice_checker_intern (struct definition_t * root) {
 
 /* This function is the overall spice checker and translator. */
 int spice_checker (void) {
+  spice_index_t models;
   spice_errors = 0;
+  spice_index_models (&models, definition_root);
+  spice_models = &models;
   definition_root = spice_checker_intern (definition_root);
+  spice_models = NULL;
   return spice_errors;
 }
@@ -34,6 +34,9 @@
 #include <assert.h>
 #include <float.h>
 #include <ctype.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
 
 #include "check_vcd.h"
 
@@ -50,163 +53,114 @@ struct vcd_file * vcd = NULL;
 int vcd_errors = 0;
 int vcd_freehdl = 1;
 int vcd_correct = 0;
-struct vcd_set * vcd_sets = NULL;
+double vcd_start = -DBL_MAX;
+double vcd_stop = DBL_MAX;
+char * vcd_scope = NULL;
 struct dataset_variable * dataset_root = NULL;
 
-/* The function looks through all variable definitions in all scopes
-   to find the given reference code. */
-static struct vcd_vardef *
-vcd_find_code (struct vcd_scope * root, char * code) {
+/* The signals by their identifier codes and the time stamps of the
+   change sets. */
+static std::unordered_map<std::string, struct vcd_signal *> vcd_signals;
+static std::vector<double> vcd_times;
+static int vcd_inside = 0;
+
+/* Returns the hierarchical name of the given scope below the scope
+   with the given name. */
+static std::string
+vcd_scope_path (struct vcd_scope * scope, const std::string & parent) {
+  std::string path = parent;
+  if (scope != vcd->scopes) {
+    if (!path.empty ()) path += '.';
+    path += scope->ident;
+  }
+  return path;
+}
+
+/* Returns non-zero if the given scope path lies within the requested
+   scope. */
+static int vcd_scope_requested (const std::string & path) {
+  if (vcd_scope == NULL) return 1;
+  size_t len = strlen (vcd_scope);
+  return !path.compare (0, len, vcd_scope) &&
+    (path.size () == len || path[len] == '.');
+}
+
+/* The function creates the signals of all variable definitions in all
+   scopes.  Variables sharing their identifier code share the signal,
+   it refers to the variable found first. */
+static void vcd_create_signals (struct vcd_scope * root,
+				const std::string & parent) {
   struct vcd_scope * scope;
   for (scope = root; scope; scope = scope->next) {
+    std::string path = vcd_scope_path (scope, parent);
+    int output = vcd_scope_requested (path);
     struct vcd_vardef * var;
     for (var = scope->vardefs; var; var = var->next) {
-      if (!strcmp (var->code, code))
-	return var;
+      struct vcd_signal * & sig = vcd_signals[var->code];
+      if (sig == NULL) {
+	sig = new vcd_signal ();
+	sig->var = var;
+      }
+      if (output) sig->output = 1;
     }
-    // search in sub-scopes
-    if ((var = vcd_find_code (scope->scopes, code)) != NULL)
-      return var;
+    // signals in sub-scopes
+    vcd_create_signals (scope->scopes, path);
   }
-  return NULL;
-}
-
-// Free's the given VCD change.
-static void vcd_free_change (struct vcd_change * vc) {
-  free (vc->code);
-  free (vc->value);
-  free (vc);
 }
 
-// Free's the given VCD changeset.
-static void vcd_free_changeset (struct vcd_changeset * cs) {
-  struct vcd_change * vc, * vnext;
-  for (vc = cs->changes; vc; vc = vnext) {
-    vnext = vc->next;
-    vcd_free_change (vc);
-  }
-  free (cs);
+/* Returns the signal with the given identifier code, the signal table
+   is created once the definitions are complete. */
+static struct vcd_signal * vcd_find_signal (const char * code) {
+  if (vcd_signals.empty ()) vcd_create_signals (vcd->scopes, "");
+  auto it = vcd_signals.find (code);
+  return it != vcd_signals.end () ? it->second : NULL;
 }
 
-#if VCD_FAST
-
-/* Returns changes sets in the list's order itself. */
-static struct vcd_changeset *
-vcd_find_firstset_fast (struct vcd_changeset * root) {
-  static struct vcd_changeset * last = root;
-  struct vcd_changeset * result = NULL;
-  result = last;
-  if (last) last = last->next;
-  return result;
+/* The function starts the change set at the given time stamp.
+   Consecutive change sets with the same time stamp are merged.  Value
+   changes before the requested time window only update the initial
+   values.  Returns non-zero past the time window. */
+int vcd_time (double t) {
+  double time = t * vcd->t * vcd->scale;
+  if (time > vcd_stop) return 1;
+  vcd_inside = time >= vcd_start;
+  if (vcd_inside && (vcd_times.empty () || vcd_times.back () != t))
+    vcd_times.push_back (t);
+  return 0;
 }
 
-/* Reverses the given change set and returns the pointer to the new
-   root change set. */
-static struct vcd_changeset *
-vcd_reverse_changesets (struct vcd_changeset * root) {
-  struct vcd_changeset * cs = NULL;
-  while (root != NULL) {
-    struct vcd_changeset * next = root->next;
-    root->next = cs;
-    cs = root;
-    root = next;
+/* The function appends the given value change of the signal with the
+   given identifier code to the current change set.  Signals outside
+   the requested scope are skipped.  Takes over the given strings. */
+void vcd_change (char * value, char * code, int isreal) {
+  struct vcd_signal * sig = vcd_find_signal (code);
+  if (sig == NULL) {
+    fprintf (stderr, "vcd error, no such variable reference `%s' "
+	     "found\n", code);
+    vcd_errors++;
   }
-  return cs;
-}
-
-#else
-
-/* Returns the change set with the smallest time stamp which is yet
-   unprocessed.  It is based upon the fact that the list is in reverse
-   order. */
-static struct vcd_changeset *
-vcd_find_firstset (struct vcd_changeset * root) {
-  struct vcd_changeset * cs, * result = NULL;
-  double Min = root ? root->t : 0;
-  for (cs = root; cs; cs = cs->next) {
-    if (!cs->done && cs->t <= Min) {
-      Min = cs->t;
-      result = cs;
-    }
+  else if (sig->output && !vcd_inside) {
+    sig->initial = (isreal ? 'R' : ' ') + std::string (value);
   }
-  return result;
-}
-
-#endif
-
-/* Looks for the a variable name in the given list of variables. */
-static struct vcd_variable *
-vcd_find_variable (struct vcd_variable * root, struct vcd_vardef * var) {
-  for (struct vcd_variable * vv = root; vv; vv = vv->next) {
-    if (!strcmp (vv->code, var->code))
-      return vv;
-  }
-  return NULL;
-}
-
-/* The function sorts the given VCD changesets.  For this it creates a
-   new list of VCD sets.  Changesets with the same timestamp are
-   merged appropriately. */
-static void vcd_sort_changesets (struct vcd_changeset * root) {
-  struct vcd_changeset * cs;
-  struct vcd_set * vs, * current = NULL;
-  struct vcd_change * vc;
-  struct vcd_variable * vv;
-
-#if VCD_FAST
-  // for fast lookup, need to reverse list
-  root = vcd_reverse_changesets (root);
-#endif
-
-  // as long as there are still changesets unprocessed
-#if VCD_FAST
-  while ((cs = vcd_find_firstset_fast (root)) != NULL) {
-#else
-  while ((cs = vcd_find_firstset (root)) != NULL) {
-#endif
-    // create set if necessary
-    if (current == NULL || current->t != cs->t) {
-      vs = (struct vcd_set *) calloc (1, sizeof (struct vcd_set));
-      vs->t = cs->t;
-      // chain the list of sets
-      if (!current)
-	vcd_sets = vs;
-      else
-	current->next = vs;
-      current = vs;
-    }
-
-    // go through list of value changes
-    for (vc = cs->changes; vc; vc = vc->next) {
-      vv = vcd_find_variable (current->variables, vc->var);
-      if (vv != NULL) {
-	// duplicate value change
-	vv->value = vc->value;
-	vv->isreal = vc->isreal;
-	if (current->t > 0) { // due to a $dumpvars before
-	  fprintf (stderr, "vcd notice, duplicate value change at t = %g of "
-		   "variable `%s'\n", current->t, vc->var->ident);
-	}
-      }
-      else {
-	// add variable to set
-	vv = (struct vcd_variable *) calloc (1, sizeof (struct vcd_variable));
-	vv->ident = vc->var->ident;
-	vv->type = vc->var->type;
-	vv->value = vc->value;
-	vv->isreal = vc->isreal;
-	vv->code = vc->code;
-	vv->next = current->variables;
-	current->variables = vv;
+  else if (sig->output) {
+    int set = vcd_times.size () - 1;
+    if (!sig->sets.empty () && sig->sets.back () == set) {
+      // duplicate value change
+      sig->values.resize (sig->offsets.back ());
+      if (vcd_times.back () > 0) { // due to a $dumpvars before
+	fprintf (stderr, "vcd notice, duplicate value change at t = %g of "
+		 "variable `%s'\n", vcd_times.back (), sig->var->ident);
       }
     }
-#ifndef VCD_FAST
-    // changeset processed
-    cs->done = 1;
-#else
-    //vcd_free_changeset (cs);
-#endif
+    else {
+      sig->sets.push_back (set);
+      sig->offsets.push_back (sig->values.size ());
+    }
+    sig->values += isreal ? 'R' : ' ';
+    sig->values.append (value, strlen (value) + 1);
   }
+  free (value);
+  free (code);
 }
 
 /* Predends the scope identifiers in front of a variable identfier. */
@@ -303,154 +257,142 @@ vcd_create_variable (struct vcd_vardef * var) {
   return ds;
 }
 
-/* Based on the value in the given VCD variable and the size (in bits)
-   the function returns a nicely formatted value for the dataset. */
-static char * vcd_create_value (struct vcd_variable * vv, int size) {
-  int i, len = strlen (vv->value);
+/* Based on the given value of a VCD variable of the given type and
+   size (in bits) the function returns a nicely formatted value for
+   the dataset. */
+static char * vcd_create_value (const char * val, int type, int size) {
+  int i, len = strlen (val);
   char * value;
 
-  if (vv->type == VAR_REAL) {
+  if (type == VAR_REAL) {
     // a real
     char txt[64];
-    double val = strtod (vv->value, NULL);
-    sprintf (txt, "%+.11e", val);
+    double d = strtod (val, NULL);
+    sprintf (txt, "%+.11e", d);
     value = strdup (txt);
-  } else if (vv->type == VAR_INTEGER) {
+  } else if (type == VAR_INTEGER) {
     // an integer
     char txt[64];
-    long val = 0, bit, i = strlen (vv->value) - 1;
+    long n = 0, bit, i = len - 1;
     for (bit = 1; i >= 0; i--, bit <<= 1) {
-      if (vv->value[i] == '1')
-	val |= bit;
-      else if (vv->value[i] == '0')
-	val &= ~bit;
+      if (val[i] == '1')
+	n |= bit;
+      else if (val[i] == '0')
+	n &= ~bit;
     }
-    sprintf (txt, "%+ld", val);
+    sprintf (txt, "%+ld", n);
     value = strdup (txt);
-    vv->isreal = 1;
   } else if (size == len) {
     // already good
-    value = strdup (vv->value);
+    value = strdup (val);
   } else {
     // fill left extending values for vectors
     value = (char *) calloc (1, size + 1);
     char fill;
-    fill = (vv->value[0] == '1') ? '0' : vv->value[0];
+    fill = (val[0] == '1') ? '0' : val[0];
     for (i = 0; i < size - len; i++) value[i] = fill;
-    strcpy (&value[i], vv->value);
+    strcpy (&value[i], val);
   }
   return value;
 }
 
 /* The function creates a full dataset variable for the given VCD
-   variable. */
+   variable.  Its values are not created but printed from the value
+   changes of its signal. */
 static struct dataset_variable *
-vcd_create_dataset (struct vcd_vardef * var) {
+vcd_create_dataset (struct vcd_vardef * var, struct vcd_signal * sig) {
   struct dataset_variable * ds;
-  struct dataset_value * dv, * current = NULL;
-  struct vcd_set * vs;
-  struct vcd_variable * vv;
-  char * currentval = NULL;
-  int found;
 
   ds = vcd_create_variable (var);
+  ds->var = var;
+  ds->signal = sig;
+
+  // the variable needs a value in the first change set
+  if (!vcd_times.empty () && sig->initial.empty () &&
+      (sig->sets.empty () || sig->sets[0] > 0)) {
+    fprintf (stderr, "vcd error, variable `%s' has no initial value\n",
+	     ds->ident);
+    vcd_errors++;
+  }
 
-  // go through all VCD sets
-  for (vs = vcd_sets; vs; vs = vs->next) {
-    found = 0;
-    // through all variables in the set
-    for (vv = vs->variables; vv; vv = vv->next) {
-      if (!strcmp (vv->code, var->code)) {
-	// found the variable in the set
-	dv = (struct dataset_value *)
-	  calloc (1, sizeof (struct dataset_value));
-	dv->value = vcd_create_value (vv, var->size);
-	// get value attribute
-	ds->isreal = vv->isreal;
-	// chain the list of values
-	if (!current)
-	  ds->values = dv;
-	else
-	  current->next = dv;
-	current = dv;
-	// save current value of the variable
-	currentval = dv->value;
-	found++;
-	break;
-      }
+  // get value attribute of the last value
+  const char * last = NULL;
+  if (!sig->sets.empty ())
+    last = &sig->values[sig->offsets.back ()];
+  else if (!sig->initial.empty ())
+    last = sig->initial.c_str ();
+  if (last != NULL)
+    ds->isreal = sig->var->type == VAR_INTEGER || last[0] == 'R';
+  return ds;
+}
+
+/* The function prints the values of the given dataset variable, one
+   for each change set.  Signals keep their value in change sets
+   without a change. */
+void vcd_print_values (struct dataset_variable * ds, FILE * f) {
+  int i, n = vcd_times.size ();
+
+  // the independent variable
+  if (ds->type == DATA_INDEPENDENT) {
+    for (i = 0; i < n; i++) {
+      // apply timestamp transformation
+      fprintf (f, "  %+.11e\n", vcd_times[i] * vcd->t * vcd->scale);
     }
-    if (!found) {
-      // variable did not occur in the current VCD set
-      if (!currentval) {
-	// no initial value given
-	fprintf (stderr, "vcd error, variable `%s' has no initial value\n",
-		 ds->ident);
-	vcd_errors++;
-      } else {
-	// else: apply previous value
-	dv = (struct dataset_value *)
-	  calloc (1, sizeof (struct dataset_value));
-	dv->value = strdup (currentval);
-	// chain the list
-	if (!current)
-	  ds->values = dv;
-	else
-	  current->next = dv;
-	current = dv;
-      }
+    return;
+  }
+
+  // the dependent variables
+  struct vcd_signal * sig = ds->signal;
+  int type = sig->var->type, size = ds->var->size;
+  char * value = NULL;
+  size_t k = 0;
+  if (!sig->initial.empty ())
+    value = vcd_create_value (sig->initial.c_str () + 1, type, size);
+  for (i = 0; i < n; i++) {
+    if (k < sig->sets.size () && sig->sets[k] == i) {
+      free (value);
+      value = vcd_create_value (&sig->values[sig->offsets[k] + 1],
+				type, size);
+      k++;
     }
+    if (value != NULL) fprintf (f, "  %s\n", value);
   }
-  return ds;
+  free (value);
 }
 
-/* The function creates the independent (timestamps) variable.  It
-   passes through all VCD changesets and collects the simulation
-   times. */
+/* The function creates the independent (timestamps) variable. */
 static struct dataset_variable * vcd_create_indep (const char * name) {
   struct dataset_variable * ds;
-  struct dataset_value * dv, * current = NULL;
-  struct vcd_set * vs;
 
   // create dataset
   ds = (struct dataset_variable *)
     calloc (1, sizeof (struct dataset_variable));
   ds->ident = strdup (name);
   ds->output = 1;
-
-  // go through all VCD sets
-  for (vs = vcd_sets; vs; vs = vs->next) {
-    dv = (struct dataset_value *) calloc (1, sizeof (struct dataset_value));
-    ds->size++;
-    // apply timestamp transformation
-    char txt[64];
-    sprintf (txt, "%+.11e", vs->t * vcd->t * vcd->scale);
-    dv->value = strdup (txt);
-    // chain the list
-    if (!current)
-      ds->values = dv;
-    else
-      current->next = dv;
-    current = dv;
-  }
+  ds->size = vcd_times.size ();
   return ds;
 }
 
-/* The function creates a list of dataset for each VCD variable. */
-static void vcd_prepare_variable_datasets (struct vcd_scope * root) {
+/* The function creates a list of dataset for each VCD variable inside
+   the requested scope. */
+static void vcd_prepare_variable_datasets (struct vcd_scope * root,
+					   const std::string & parent) {
   struct vcd_scope * scope;
   struct dataset_variable * data;
   // through each scope
   for (scope = root; scope; scope = scope->next) {
+    std::string path = vcd_scope_path (scope, parent);
     struct vcd_vardef * var;
     // through each variable in this scope
-    for (var = scope->vardefs; var; var = var->next) {
-      data = vcd_create_dataset (var);
+    for (var = scope->vardefs; var && vcd_scope_requested (path);
+	 var = var->next) {
+      data = vcd_create_dataset (var, vcd_find_signal (var->code));
       data->type = DATA_DEPENDENT;
       data->dependencies = strdup (VCD_TIMEVAR);
       data->next = dataset_root;
       dataset_root = data;
     }
-    vcd_prepare_variable_datasets (scope->scopes);
+    vcd_prepare_variable_datasets (scope->scopes, path);
   }
 }
 
@@ -459,7 +401,7 @@ static void vcd_prepare_variable_datasets (struct vcd_scope * root) {
 static void vcd_prepare_datasets (void) {
   struct dataset_variable * data;
   // the dependent variables
-  vcd_prepare_variable_datasets (vcd->scopes);
+  vcd_prepare_variable_datasets (vcd->scopes, "");
   // the independent variable
   data = vcd_create_indep (VCD_TIMEVAR);
   data->type = DATA_INDEPENDENT;
@@ -468,61 +410,29 @@ static void vcd_prepare_datasets (void) {
 }
 
 #if VCD_DEBUG
-// Debugging: Prints the VCD sets.
-static void vcd_print_sets (void) {
-  struct vcd_changeset * vs;
-  struct vcd_change * vv;
-  for (vs = vcd->changesets; vs; vs = vs->next) {
-    fprintf (stderr, "--- t => %g\n", vs->t);
-    for (vv = vs->changes; vv; vv = vv->next) {
-      fprintf (stderr, "%s\t => %s\n", vv->value, vv->var->ident);
-    }
-  }
-}
-
 // Debugging: Prints the generate data sets.
 static void vcd_dataset_print (void) {
   struct dataset_variable * ds;
-  struct dataset_value * dv;
   for (ds = dataset_root; ds; ds = ds->next) {
     fprintf (stderr, "\n%s%s => %s\n",
 	     ds->type == DATA_INDEPENDENT ? "in" : "",
 	     ds->type == DATA_UNKNOWN ? "xxx" : "dep", ds->ident);
-    for (dv = ds->values; dv; dv = dv->next) {
-      fprintf (stderr, "  %s\n", dv->value);
-    }
+    vcd_print_values (ds, stderr);
   }
 }
 #endif /* VCD_DEBUG */
 
-/* This function is the overall VCD data checker.  It returns zero on
+/* This function is the overall VCD data checker.  The value changes
+   have been checked while parsing already.  It returns zero on
    success, non-zero otherwise. */
 int vcd_checker (void) {
 
-  // de-reference each value change identfier code
-  struct vcd_changeset * changeset;
-  for (changeset = vcd->changesets; changeset; changeset = changeset->next) {
-    struct vcd_change * change;
-    for (change = changeset->changes; change; change = change->next) {
-      change->var = vcd_find_code (vcd->scopes, change->code);
-      if (change->var == NULL) {
-	fprintf (stderr, "vcd error, no such variable reference `%s' "
-		 "found\n", change->code);
-	vcd_errors++;
-      }
-    }
-  }
-
   if (vcd_errors) return -1;
 
-  // sort the VCD changesets
-  vcd_sort_changesets (vcd->changesets);
-
   // create the outgoing datasets
   vcd_prepare_datasets ();
 
 #if VCD_DEBUG
-  vcd_print_sets ();
   vcd_dataset_print ();
 #endif /* VCD_DEBUG */
 
@@ -551,26 +461,15 @@ static void vcd_free_scope (struct vcd_scope * root) {
 // Free's the given VCD file.
 static void vcd_free_file (struct vcd_file * vcd) {
   vcd_free_scope (vcd->scopes);
-  struct vcd_changeset * cs, * cnext;
-  for (cs = vcd->changesets; cs; cs = cnext) {
-    cnext = cs->next;
-    vcd_free_changeset (cs);
-  }
   free (vcd);
 }
 
-// Free's the given set of VCD changes.
-static void vcd_free_set (struct vcd_set * root) {
-  struct vcd_set * vs, * snext;
-  for (vs = root; vs; vs = snext) {
-    snext = vs->next;
-    struct vcd_variable * vv, * vnext;
-    for (vv = vs->variables; vv; vv = vnext) {
-      vnext = vv->next;
-      free (vv);
-    }
-    free (vs);
-  }
+// Free's the signal table.
+static void vcd_free_signals (void) {
+  for (auto &it : vcd_signals) delete it.second;
+  vcd_signals.clear ();
+  vcd_times.clear ();
+  vcd_inside = 0;
 }
 
 // Free's the given dataset list.
@@ -580,12 +479,6 @@ static void vcd_free_dataset (struct dataset_variable * root) {
     snext = ds->next;
     free (ds->ident);
     free (ds->dependencies);
-    struct dataset_value * dv, * dnext;
-    for (dv = ds->values; dv; dv = dnext) {
-      dnext = dv->next;
-      free (dv->value);
-      free (dv);
-    }
     free (ds);
   }
 }
@@ -595,8 +488,7 @@ void vcd_destroy (void) {
   vcd_errors = 0;
   vcd_free_file (vcd);
   vcd = NULL;
-  vcd_free_set (vcd_sets);
-  vcd_sets = NULL;
+  vcd_free_signals ();
   vcd_free_dataset (dataset_root);
   dataset_root = NULL;
 }
@@ -26,13 +26,15 @@
 #ifndef __CHECK_VCD_H__
 #define __CHECK_VCD_H__
 
+#include <string>
+#include <vector>
+
 /* Externalize variables used by the scanner and parser. */
 extern int vcd_lineno;
 extern FILE * vcd_in;
 
 /* Useful defines. */
 #define VCD_NOSCOPE "noscope"
-#define VCD_FAST 1
 
 __BEGIN_DECLS
 
@@ -40,9 +42,15 @@ __BEGIN_DECLS
 extern struct vcd_file * vcd;
 extern struct dataset_variable * dataset_root;
 extern int vcd_correct;
+extern double vcd_start;
+extern double vcd_stop;
+extern char * vcd_scope;
 
 /* Available functions of the checker. */
 int  vcd_checker (void);
+int  vcd_time (double);
+void vcd_change (char *, char *, int);
+void vcd_print_values (struct dataset_variable *, FILE *);
 int  vcd_parse (void);
 int  vcd_error (const char *);
 int  vcd_lex (void);
@@ -111,61 +119,29 @@ struct vcd_scope {
   struct vcd_scope * next;
 };
 
-// Value change definition.
-struct vcd_change {
-  char * value;            // the value
-  char * code;             // identifier code, references 'var'
-  int isreal;              // indicates type of value
-  struct vcd_vardef * var; // pointer to variable
-  struct vcd_change * next;
-};
-
-// A full set of VCD value changes.
-struct vcd_changeset {
-  double t;                    // time stamp
-  struct vcd_change * changes; // list of VCD changes 
-#ifndef VCD_FAST
-  int done;                    // flag for the checker
-#endif
-  struct vcd_changeset * next;
-};
-
 // Representation of a VCD file.
 struct vcd_file {
-  int t;                             // time scale (1, 10 or 100)
-  double scale;                      // time unit factor
-  struct vcd_scope * scopes;         // scopes
-  struct vcd_scope * currentscope;   // the current scope
-  struct vcd_changeset * changesets; // change sets
+  int t;                           // time scale (1, 10 or 100)
+  double scale;                    // time unit factor
+  struct vcd_scope * scopes;       // scopes
+  struct vcd_scope * currentscope; // the current scope
 };
 
 /* Checker specific data structures. */
 
-// A VCD variable.
-struct vcd_variable {
-  char * code;  // identifier code, references 'var'
-  char * ident; // variable identifer
-  char * value; // the value
-  int isreal;   // indicates type of value
-  int type;     // variable type
-  struct vcd_variable * next;
-};
-
-// A VCD change set.
-struct vcd_set {
-  double t;                        // time stamp
-  struct vcd_variable * variables; // list of VCD variables
-  struct vcd_set * next;
+// The value changes of an identifier code.
+struct vcd_signal {
+  struct vcd_vardef * var;     // first variable using the code
+  int output;                  // is a variable inside the requested scope?
+  std::vector<int> sets;       // indices of the change sets
+  std::vector<size_t> offsets; // positions of the values
+  std::string values;          // type ('R' for reals) and value, each
+                               // terminated by a zero character
+  std::string initial;         // last value before the time window
 };
 
 /* Qucs dataset specific data structures. */
 
-// Dataset value structure.
-struct dataset_value {
-  char * value; // the value
-  struct dataset_value * next;
-};
-
 // Types of dataset variables.
 enum dataset_vartypes {
   DATA_UNKNOWN,
@@ -181,7 +157,8 @@ struct dataset_variable {
   char * ident;                  // variable identifier
   char * dependencies;           // variable dependencies (if dependent)
   int isreal;                    // indicates type of values
-  struct dataset_value * values; // list of values
+  struct vcd_vardef * var;       // VCD variable (if dependent)
+  struct vcd_signal * signal;    // its value changes
   struct dataset_variable * next;
 };
 
@@ -30,9 +30,11 @@
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include <algorithm>
 #include "dataset.h"
 
 #include "csv_producer.h"
+#include "dataset_reader.h"
 
 using namespace qucs;
 
@@ -42,7 +44,7 @@ qucs::dataset * qucs_data = NULL;
 
 struct csv_data {
   char type;  // type of variable
-  vector * v; // appropriate data vector
+  dataset_cursor * v; // appropriate data vector
   int idx;    // index into vector
   int skip;   // skip length
   int len;    // length of vector
@@ -88,9 +90,79 @@ void csv_print (struct csv_data * data, int vectors, const char * sep) {
   }
 }
 
+/* Fills in the given data structure for the given vector. */
+static void csv_init (struct csv_data * data, dataset_cursor * v, int skip) {
+  data->type = v->isComplex () ? 'c' : 'r';
+  data->v = v;
+  data->idx = 0;
+  data->skip = skip;
+  data->len = v->getSize ();
+}
+
+/* Prints the given vectors and deletes their data structures. */
+static void csv_done (struct csv_data * data, int vectors, const char * sep) {
+  csv_print (data, vectors, sep);
+  for (int i = 0; i < vectors; i++) delete data[i].v;
+  delete[] data;
+}
+
+/* The CSV producer for a dataset read by the streaming reader.  The
+   vectors are read chunk by chunk while printing. */
+static void csv_producer_stream (char * variable, const char * sep) {
+  const dataset_entry_t * v;
+  // save variable including its dependencies
+  if (variable && (v = qucs_stream->findVariable (variable)) != NULL) {
+
+    // prepare variable + dependency structures
+    int vectors = 1 + v->deps.size ();
+    struct csv_data * data = new struct csv_data[vectors];
+    int i = vectors - 1;
+    csv_init (&data[i], new dataset_cursor (qucs_stream, v), 1);
+
+    int a = v->size;
+    for (i = vectors - 2; i >= 0; i--) {
+      const dataset_entry_t * d =
+	qucs_stream->findDependency (v->deps[i].c_str ());
+      a /= d->size;
+      csv_init (&data[i], new dataset_cursor (qucs_stream, d), a);
+    }
+    csv_done (data, vectors, sep);
+  }
+  // save dependency + all variable depending on it
+  else if (variable && (v = qucs_stream->findDependency (variable)) != NULL) {
+
+    // prepare dependency + variables structures
+    std::vector<dataset_entry_t> & vars = qucs_stream->getVariables ();
+    int vectors = 1;
+    for (auto &d : vars) {
+      if (std::find (d.deps.begin (), d.deps.end (), v->name) !=
+	  d.deps.end ())
+	vectors++;
+    }
+    struct csv_data * data = new struct csv_data[vectors];
+
+    csv_init (&data[0], new dataset_cursor (qucs_stream, v), 1);
+    int i = 1;
+    for (auto &d : vars) {
+      if (std::find (d.deps.begin (), d.deps.end (), v->name) !=
+	  d.deps.end ())
+	csv_init (&data[i++], new dataset_cursor (qucs_stream, &d), 1);
+    }
+    csv_done (data, vectors, sep);
+  }
+  // no such data found
+  else {
+    fprintf (stderr, "no such data variable `%s' found\n", variable);
+  }
+}
+
 /* This is the overall CSV producer. */
 void csv_producer (char * variable, const char * sep) {
   vector * v;
+  if (qucs_stream != NULL) {
+    csv_producer_stream (variable, sep);
+    return;
+  }
   // save variable including its dependencies
   if (variable && (v = qucs_data->findVariable (variable)) != NULL) {
 
@@ -99,25 +171,15 @@ void csv_producer (char * variable, const char * sep) {
     int vectors = 1 + (deps ? deps->length () : 0);
     struct csv_data * data = new struct csv_data[vectors];
     int i = vectors - 1;
-    data[i].type = real (sum (norm (imag (*v)))) > 0.0 ? 'c' : 'r';
-    data[i].v = v;
-    data[i].idx = 0;
-    data[i].skip = 1;
-    data[i].len = v->getSize ();
+    csv_init (&data[i], new dataset_cursor (v), 1);
 
     int a = v->getSize ();
     for (i = vectors - 2; i >= 0; i--) {
       vector * d = qucs_data->findDependency (deps->get (i));
-      data[i].type = real (sum (norm (imag (*d)))) > 0.0 ? 'c' : 'r';
-      data[i].v = d;
-      data[i].idx = 0;
       a /= d->getSize ();
-      data[i].skip = a;
-      data[i].len = d->getSize ();
+      csv_init (&data[i], new dataset_cursor (d), a);
     }
-
-    csv_print (data, vectors, sep);
-    delete[] data;
+    csv_done (data, vectors, sep);
   }
   // save dependency + all variable depending on it
   else if (variable && (v = qucs_data->findDependency (variable)) != NULL) {
@@ -133,28 +195,15 @@ void csv_producer (char * variable, const char * sep) {
     }
     struct csv_data * data = new struct csv_data[vectors];
 
-    data[0].type = real (sum (norm (imag (*v)))) > 0.0 ? 'c' : 'r';
-    data[0].v = v;
-    data[0].idx = 0;
-    data[0].skip = 1;
-    data[0].len = v->getSize ();
+    csv_init (&data[0], new dataset_cursor (v), 1);
     int i = 1;
     for (vars = qucs_data->getVariables (); vars != NULL;
 	 vars = (vector *) vars->getNext ()) {
       strlist * deps = vars->getDependencies ();
-      if (deps->contains (v->getName ())) {
-	vector * d = vars;
-	data[i].type = real (sum (norm (imag (*d)))) > 0.0 ? 'c' : 'r';
-	data[i].v = d;
-	data[i].idx = 0;
-	data[i].skip = 1;
-	data[i].len = d->getSize ();
-	i++;
-      }
+      if (deps->contains (v->getName ()))
+	csv_init (&data[i++], new dataset_cursor (qucs_data->fetch (vars)), 1);
     }
-
-    csv_print (data, vectors, sep);
-    delete[] data;
+    csv_done (data, vectors, sep);
   }
   // no such data found
   else {
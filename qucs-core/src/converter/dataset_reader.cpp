@@ -0,0 +1,357 @@
+/*
+ * dataset_reader.cpp - streaming dataset reader implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <cmath>
+#include <algorithm>
+
+#include "logging.h"
+#include "complex.h"
+#include "object.h"
+#include "vector.h"
+#include "dataset_reader.h"
+
+using namespace qucs;
+
+/* Global variables. */
+dataset_reader * qucs_stream = NULL;
+
+/* Tokens of a dataset file. */
+enum {
+  DATASET_EOF,
+  DATASET_VALUE,
+  DATASET_DESC,
+  DATASET_ERROR
+};
+
+/* Reads the next token of a dataset file into the given string, either
+   a value or the text of a description in angle brackets.  Spaces,
+   escaped line ends and comments are skipped, line ends are counted in
+   the given line number. */
+static int dataset_token (FILE * f, std::string & tok, int & line) {
+  int c;
+  tok.clear ();
+  while ((c = getc (f)) != EOF) {
+    if (c == '\n') {
+      line++;
+    }
+    else if (c == '#') {
+      while ((c = getc (f)) != EOF && c != '\n') ;
+      if (c == '\n') line++;
+    }
+    else if (c == '<') {
+      while ((c = getc (f)) != EOF && c != '>') {
+	if (c == '\n') line++;
+	tok += (char) c;
+      }
+      return c == EOF ? DATASET_ERROR : DATASET_DESC;
+    }
+    else if (!isspace (c) && c != '\\') {
+      do tok += (char) c;
+      while ((c = getc (f)) != EOF && !isspace (c) && c != '<' && c != '#');
+      if (c != EOF) ungetc (c, f);
+      return DATASET_VALUE;
+    }
+  }
+  return DATASET_EOF;
+}
+
+/* Parses the magnitude of the imaginary part following the `i' or
+   `j' and applies the given sign.  Returns zero on success. */
+static int dataset_imag (const char * s, char sign, double & i) {
+  char * end;
+  if (!isdigit ((unsigned char) *s) && *s != '.') return -1;
+  i = strtod (s, &end);
+  if (*end) return -1;
+  if (sign == '-') i = -i;
+  return 0;
+}
+
+/* Parses a real, imaginary or complex value like the dataset scanner
+   does.  Returns zero on success. */
+static int dataset_value (const char * s, nr_complex_t & z) {
+  char * end;
+  double r = 0.0, i = 0.0;
+  const char * p = (*s == '+' || *s == '-') ? s + 1 : s;
+
+  // imaginary value
+  if (*p == 'i' || *p == 'j') {
+    if (dataset_imag (p + 1, *s, i)) return -1;
+  }
+  // real or complex value
+  else {
+    r = strtod (s, &end);
+    if (end == s) return -1;
+    if (*end == '+' || *end == '-') {
+      if (end[1] != 'i' && end[1] != 'j') return -1;
+      if (dataset_imag (end + 2, *end, i)) return -1;
+    }
+    else if (*end) return -1;
+  }
+  z = nr_complex_t (r, i);
+  return 0;
+}
+
+// Splits the given description into words.
+static std::vector<std::string> dataset_words (const std::string & s) {
+  std::vector<std::string> words;
+  size_t i = 0, n = s.size ();
+  while (i < n) {
+    while (i < n && isspace ((unsigned char) s[i])) i++;
+    size_t k = i;
+    while (i < n && !isspace ((unsigned char) s[i])) i++;
+    if (i > k) words.push_back (s.substr (k, i - k));
+  }
+  return words;
+}
+
+// Constructor creates an unopened dataset reader.
+dataset_reader::dataset_reader () {
+  file = NULL;
+}
+
+// Destructor closes the dataset file.
+dataset_reader::~dataset_reader () {
+  if (file != NULL) fclose (file);
+}
+
+/* The function scans the given dataset file and creates the index of
+   its vectors.  It returns zero on success, otherwise it emits
+   appropriate error messages and returns non-zero. */
+int dataset_reader::open (const char * name) {
+  if ((file = fopen (name, "rb")) == NULL) {
+    logprint (LOG_ERROR, "cannot open file `%s': %s\n", name,
+	      strerror (errno));
+    return -1;
+  }
+
+  std::string tok;
+  int line = 1, t;
+  dataset_entry_t * e = NULL;
+  bool indep = false;
+
+  // version line
+  t = dataset_token (file, tok, line);
+  if (t != DATASET_DESC || tok.compare (0, 13, "Qucs Dataset ")) {
+    logprint (LOG_ERROR, "line %d: syntax error, no Qucs dataset\n", line);
+    return -1;
+  }
+
+  // vectors
+  double imags = 0.0;
+  while ((t = dataset_token (file, tok, line)) != DATASET_EOF) {
+    if (t == DATASET_ERROR) {
+      logprint (LOG_ERROR, "line %d: syntax error, unterminated "
+		"description\n", line);
+      return -1;
+    }
+    if (t == DATASET_VALUE) {
+      nr_complex_t z;
+      if (e == NULL || dataset_value (tok.c_str (), z)) {
+	logprint (LOG_ERROR, "line %d: syntax error, unexpected `%s'\n",
+		  line, tok.c_str ());
+	return -1;
+      }
+      e->size++;
+      imags += norm (imag (z));
+      continue;
+    }
+    std::vector<std::string> w = dataset_words (tok);
+    if (e == NULL && w.size () >= 2 && w[0] == "dep") {
+      variables.push_back (dataset_entry_t ());
+      e = &variables.back ();
+      e->deps.assign (w.begin () + 2, w.end ());
+      e->requested = 0;
+      indep = false;
+    }
+    else if (e == NULL && w.size () == 3 && w[0] == "indep") {
+      dependencies.push_back (dataset_entry_t ());
+      e = &dependencies.back ();
+      e->requested = atoi (w[2].c_str ());
+      indep = true;
+    }
+    else if (e != NULL && w.size () == 1 &&
+	     w[0] == (indep ? "/indep" : "/dep")) {
+      e->complex = imags > 0.0;
+      e = NULL;
+      continue;
+    }
+    else {
+      logprint (LOG_ERROR, "line %d: syntax error, unexpected `<%s>'\n",
+		line, tok.c_str ());
+      return -1;
+    }
+    e->name = w[1];
+    e->offset = ftell (file);
+    e->size = 0;
+    e->complex = 0;
+    imags = 0.0;
+  }
+  if (e != NULL) {
+    logprint (LOG_ERROR, "line %d: syntax error, vector `%s' not "
+	      "terminated\n", line, e->name.c_str ());
+    return -1;
+  }
+  return check ();
+}
+
+/* This function checks the sizes and dependencies of the vectors like
+   the checker of parsed datasets.  It returns zero on success. */
+int dataset_reader::check (void) {
+  int errors = 0;
+
+  // check actual size and requested size of independent vectors
+  for (auto &v : dependencies) {
+    if (v.size != v.requested) {
+      logprint (LOG_ERROR, "checker error, vector `%s' contains %d values, "
+		"%d have been stated\n", v.name.c_str (), v.size,
+		v.requested);
+      errors++;
+    }
+  }
+
+  // check dependencies of dependent vectors
+  for (auto &v : variables) {
+    if (v.deps.empty ()) {
+      logprint (LOG_ERROR, "checker error, vector `%s' contains no "
+		"dependencies\n", v.name.c_str ());
+      errors++;
+      continue;
+    }
+    int n = 1;
+    for (auto &dep : v.deps) {
+      const dataset_entry_t * d = findDependency (dep.c_str ());
+      if (d == NULL) {
+	logprint (LOG_ERROR, "checker error, no such dependency `%s' as "
+		  "stated in `%s'\n", dep.c_str (), v.name.c_str ());
+	errors++;
+      }
+      else {
+	n *= d->size;
+      }
+    }
+    if (n != 0 && v.size % n != 0) {
+      logprint (LOG_ERROR, "checker error, size of vector `%s' %d should "
+		"be dividable by %d\n", v.name.c_str (), v.size, n);
+      errors++;
+    }
+  }
+  return errors ? -1 : 0;
+}
+
+/* Reads up to the given number of values starting at the given file
+   position.  The position is advanced past the values read.  Returns
+   the number of values read. */
+int dataset_reader::read (long & pos, nr_complex_t * values, int n) {
+  std::string tok;
+  int line = 0, i;
+  if (fseek (file, pos, SEEK_SET)) return 0;
+  for (i = 0; i < n; i++) {
+    if (dataset_token (file, tok, line) != DATASET_VALUE ||
+	dataset_value (tok.c_str (), values[i]))
+      break;
+  }
+  pos = ftell (file);
+  return i;
+}
+
+// Returns the independent vector with the given name.
+const dataset_entry_t * dataset_reader::findDependency (const char * n) {
+  for (auto &v : dependencies) {
+    if (v.name == n)
+      return &v;
+  }
+  return NULL;
+}
+
+// Returns the dependent vector with the given name.
+const dataset_entry_t * dataset_reader::findVariable (const char * n) {
+  for (auto &v : variables) {
+    if (v.name == n)
+      return &v;
+  }
+  return NULL;
+}
+
+// Constructor creates a cursor for the given vector in memory.
+dataset_cursor::dataset_cursor (qucs::vector * data) {
+  v = data;
+  reader = NULL;
+  entry = NULL;
+  name = v->getName ();
+  size = v->getSize ();
+  complex = real (sum (norm (imag (*v)))) > 0.0;
+  buffer = NULL;
+  first = count = 0;
+  next = 0;
+}
+
+/* Constructor creates a cursor for the given vector of the dataset
+   reader. */
+dataset_cursor::dataset_cursor (dataset_reader * r,
+				const dataset_entry_t * e) {
+  v = NULL;
+  reader = r;
+  entry = e;
+  name = e->name.c_str ();
+  size = e->size;
+  complex = e->complex;
+  buffer = new nr_complex_t[std::min (size, DATASET_READ_CHUNK) + 1];
+  first = count = 0;
+  next = e->offset;
+}
+
+// Destructor deletes the cursor.
+dataset_cursor::~dataset_cursor () {
+  delete[] buffer;
+}
+
+/* Returns the value at the given index.  A value before the values
+   read last starts the reading over at the beginning of the vector. */
+nr_complex_t dataset_cursor::get (int i) {
+  if (v != NULL) return v->get (i);
+  if (i < 0 || i >= size) return 0.0;
+  if (i < first) {
+    first = count = 0;
+    next = entry->offset;
+  }
+  while (i >= first + count) {
+    first += count;
+    count = reader->read (next, buffer, std::min (size - first,
+						  DATASET_READ_CHUNK));
+    if (count <= 0) {
+      count = 0;
+      return 0.0;
+    }
+  }
+  return buffer[i - first];
+}
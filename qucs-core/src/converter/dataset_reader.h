@@ -0,0 +1,116 @@
+/*
+ * dataset_reader.h - streaming dataset reader definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __DATASET_READER_H__
+#define __DATASET_READER_H__
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "complex.h"
+
+// number of values a cursor reads from the file at once
+#define DATASET_READ_CHUNK 256
+
+namespace qucs {
+  class vector;
+}
+
+/* Index entry of a vector of a dataset file. */
+struct dataset_entry_t {
+  std::string name;              // name of the vector
+  std::vector<std::string> deps; // names of its dependencies
+  long offset;                   // file position of its first value
+  int size;                      // number of values
+  int requested;                 // stated size of independent vectors
+  int complex;                   // has non-zero imaginary parts
+};
+
+/*! \class dataset_reader
+ * \brief index of a Qucs dataset file read in chunks.
+ *
+ * The file is scanned once for the names, dependencies and positions
+ * of its vectors, the values are not kept.  They are read by cursors
+ * on demand, thus the memory needed is independent of the file size.
+ */
+class dataset_reader
+{
+ public:
+  dataset_reader ();
+  ~dataset_reader ();
+  int open (const char *);
+  int read (long &, nr_complex_t *, int);
+  std::vector<dataset_entry_t> & getDependencies (void) {
+    return dependencies;
+  }
+  std::vector<dataset_entry_t> & getVariables (void) { return variables; }
+  const dataset_entry_t * findDependency (const char *);
+  const dataset_entry_t * findVariable (const char *);
+
+ private:
+  int check (void);
+
+ private:
+  FILE * file;
+  std::vector<dataset_entry_t> dependencies;
+  std::vector<dataset_entry_t> variables;
+};
+
+/*! \class dataset_cursor
+ * \brief sequential access to the values of a vector.
+ *
+ * A cursor either wraps a vector in memory or reads the values of an
+ * index entry of a dataset reader chunk by chunk.  Accessing the
+ * values in increasing order, starting over at any time, reads the
+ * file once per pass.
+ */
+class dataset_cursor
+{
+ public:
+  dataset_cursor (qucs::vector *);
+  dataset_cursor (dataset_reader *, const dataset_entry_t *);
+  ~dataset_cursor ();
+  const char * getName (void) { return name; }
+  int getSize (void) { return size; }
+  int isComplex (void) { return complex; }
+  nr_complex_t get (int);
+
+ private:
+  qucs::vector * v;
+  dataset_reader * reader;
+  const dataset_entry_t * entry;
+  const char * name;
+  int size;
+  int complex;
+  nr_complex_t * buffer; // values first ... first + count - 1
+  int first;
+  int count;
+  long next;             // file position of the value first + count
+};
+
+/* Externalize variables. */
+extern dataset_reader * qucs_stream;
+
+#endif /* __DATASET_READER_H__ */
@@ -36,8 +36,10 @@
 #include "matrix.h"
 #include "matvec.h"
 #include "constants.h"
+#include "dataset_reader.h"
 
 #include <cstdint>
+#include <algorithm>
 
 using namespace qucs;
 
@@ -46,6 +48,9 @@ FILE * matlab_out = NULL; // output file stream
 int matlab_symbols = 1;   // convert data names to have valid Matlab identifier
 int nr_bigendian = 0;     // endianness
 
+// Number of values converted and written at once.
+#define MATLAB_CHUNK 4096
+
 // Test endianness.
 // http://www.geeksforgeeks.org/little-and-big-endian-mystery/
 static void initendian (void) {
@@ -54,8 +59,9 @@ static void initendian (void) {
   nr_bigendian = (*c == 1) ? 0 : 1;
 }
 
-// Writes a Matlab v4 header.
-static void matlab_header (int32_t rows, int32_t cols, const char * name) {
+// Writes a Matlab v4 header, of a complex or real matrix.
+static void matlab_header (int32_t rows, int32_t cols, const char * name,
+			   int complex = 1) {
 
   // MOPT
   char mopt[4];
@@ -73,7 +79,7 @@ static void matlab_header (int32_t rows, int32_t cols, const char * name) {
   fwrite (&cols, sizeof (int32_t), 1, matlab_out);
 
   // imaginary flag
-  int32_t imag = 1;
+  int32_t imag = complex ? 1 : 0;
   fwrite (&imag, sizeof (int32_t), 1, matlab_out);
 
   // data name length
@@ -94,22 +100,55 @@ static void matlab_header (int32_t rows, int32_t cols, const char * name) {
   free(ns);
 }
 
-// Writes a Matlab v4 vector.
-static void matlab_vector (::vector * v) {
-  int n;
+/* Writes a Matlab v4 vector chunk by chunk, the imaginary part of a
+   complex vector follows the real part.  Into a seekable file both
+   parts of a chunk are written at once, thus a streamed vector is read
+   once, otherwise the values are read once per part. */
+static void matlab_vector (dataset_cursor * v) {
+  nr_double_t re[MATLAB_CHUNK], im[MATLAB_CHUNK];
+  int n, i, count, size = v->getSize ();
+  int complex = v->isComplex ();
+  long start = complex ? ftell (matlab_out) : -1;
+  long bytes = sizeof (nr_double_t);
 
-  // real part
-  for (n = 0; n < v->getSize (); n++) {
-    nr_double_t r = real (v->get (n));
-    fwrite (&r, sizeof (nr_double_t), 1, matlab_out);
+  if (!complex || start >= 0) {
+    for (n = 0; n < size; n += count) {
+      count = std::min (size - n, MATLAB_CHUNK);
+      for (i = 0; i < count; i++) {
+	nr_complex_t z = v->get (n + i);
+	re[i] = real (z);
+	im[i] = imag (z);
+      }
+      if (complex) fseek (matlab_out, start + n * bytes, SEEK_SET);
+      fwrite (re, sizeof (nr_double_t), count, matlab_out);
+      if (complex) {
+	fseek (matlab_out, start + (size + n) * bytes, SEEK_SET);
+	fwrite (im, sizeof (nr_double_t), count, matlab_out);
+      }
+    }
+    if (complex) fseek (matlab_out, start + 2 * size * bytes, SEEK_SET);
+    return;
   }
-  // imaginary part
-  for (n = 0; n < v->getSize (); n++) {
-    nr_double_t i = imag (v->get (n));
-    fwrite (&i, sizeof (nr_double_t), 1, matlab_out);
+
+  // real part, then imaginary part
+  for (n = 0; n < size; n += count) {
+    count = std::min (size - n, MATLAB_CHUNK);
+    for (i = 0; i < count; i++) re[i] = real (v->get (n + i));
+    fwrite (re, sizeof (nr_double_t), count, matlab_out);
+  }
+  for (n = 0; n < size; n += count) {
+    count = std::min (size - n, MATLAB_CHUNK);
+    for (i = 0; i < count; i++) im[i] = imag (v->get (n + i));
+    fwrite (im, sizeof (nr_double_t), count, matlab_out);
   }
 }
 
+// Writes the header and the values of a Matlab v4 vector.
+static void matlab_column (dataset_cursor * v, const char * name) {
+  matlab_header (v->getSize (), 1, name, v->isComplex ());
+  matlab_vector (v);
+}
+
 // Writes a Matlab v4 matrix.
 static void matlab_matrix (matrix * m) {
   int r, c;
@@ -130,23 +169,34 @@ static void matlab_matrix (matrix * m) {
   }
 }
 
-// Saves a dataset vector into a Matlab file.
+/* Saves a dataset vector into a Matlab file.  The entries of a simple
+   matrix are collected into the matrix directly, without creating the
+   matrix vector. */
 static void matlab_save (::vector * v) {
-  int r, c;
-  char * n, * sn;
+  int r, c, ri, ci;
+  char * n, * sn, * en;
   const char * vn = v->getName ();
-  matvec * mv = NULL;
-  matrix m;
 
   // is vector matrix entry
   if ((n = matvec::isMatrixVector (vn, r, c)) != NULL) {
+    // dimensions of the matrix vector
+    int rs, cs, ss;
+    matvec::getMatrixVectorSize (v, n, rs, cs, ss);
     // valid matrix vector and simple matrix
-    if ((mv = matvec::getMatrixVector (v, n)) != NULL && mv->getSize () == 1) {
+    if (rs >= 0 && cs >= 0 && ss == 1) {
       // only save at first matrix entry [1,1]
       if (r == 0 && c == 0) {
 	// save matrix
-	matlab_header (mv->getRows (), mv->getCols (), n);
-	m = mv->get (0);
+	matrix m (rs + 1, cs + 1);
+	for (::vector * e = v; e != NULL; e = (::vector *) e->getNext ()) {
+	  const char * ename = e->getName ();
+	  if (strstr (ename, n) == ename &&
+	      (en = matvec::isMatrixVector (ename, ri, ci)) != NULL) {
+	    m.set (ri, ci, e->get (0));
+	    free (en);
+	  }
+	}
+	matlab_header (rs + 1, cs + 1, n);
 	matlab_matrix (&m);
       }
     }
@@ -159,17 +209,81 @@ static void matlab_save (::vector * v) {
       } else {
 	sprintf (sn, "%s", vn);
       }
-      matlab_header (v->getSize (), 1, sn);
-      matlab_vector (v);
+      dataset_cursor cv (v);
+      matlab_column (&cv, sn);
       free (sn);
     }
     free (n);
-    delete mv;
   }
   else {
     // save vector
-    matlab_header (v->getSize (), 1, vn);
-    matlab_vector (v);
+    dataset_cursor cv (v);
+    matlab_column (&cv, vn);
+  }
+}
+
+/* Saves the vector at the given position of the index of a streamed
+   dataset like the function above.  Matrix entries are collected from
+   the given position onwards. */
+static void matlab_save_stream (dataset_reader * data,
+				std::vector<dataset_entry_t> & list,
+				unsigned int k) {
+  int r, c, ri, ci;
+  char * n, * sn, * en;
+  const char * vn = list[k].name.c_str ();
+  dataset_cursor cv (data, &list[k]);
+
+  // is vector matrix entry
+  if ((n = matvec::isMatrixVector (vn, r, c)) != NULL) {
+    // dimensions of the matrix vector
+    int rs = -1, cs = -1, ss = -1;
+    unsigned int i;
+    for (i = k; i < list.size (); i++) {
+      const char * ename = list[i].name.c_str ();
+      if (strstr (ename, n) == ename &&
+	  (en = matvec::isMatrixVector (ename, ri, ci)) != NULL) {
+	if (rs < ri) rs = ri;
+	if (cs < ci) cs = ci;
+	if (ss < list[i].size) ss = list[i].size;
+	free (en);
+      }
+    }
+    // valid matrix vector and simple matrix
+    if (rs >= 0 && cs >= 0 && ss == 1) {
+      // only save at first matrix entry [1,1]
+      if (r == 0 && c == 0) {
+	// save matrix
+	matrix m (rs + 1, cs + 1);
+	for (i = k; i < list.size (); i++) {
+	  const char * ename = list[i].name.c_str ();
+	  if (strstr (ename, n) == ename &&
+	      (en = matvec::isMatrixVector (ename, ri, ci)) != NULL) {
+	    dataset_cursor ce (data, &list[i]);
+	    m.set (ri, ci, ce.get (0));
+	    free (en);
+	  }
+	}
+	matlab_header (rs + 1, cs + 1, n);
+	matlab_matrix (&m);
+      }
+    }
+    else {
+      // save vector
+      sn = (char *) malloc (strlen (n) + 8);
+      if (matlab_symbols) {
+	// convert indices to valid Matlab identifiers
+	sprintf (sn, "%s_%d_%d", n, r + 1, c + 1);
+      } else {
+	sprintf (sn, "%s", vn);
+      }
+      matlab_column (&cv, sn);
+      free (sn);
+    }
+    free (n);
+  }
+  else {
+    // save vector
+    matlab_column (&cv, vn);
   }
 }
 
@@ -182,6 +296,18 @@ void matlab_producer (void) {
   // initialize endianness
   initendian ();
 
+  // streamed dataset
+  if (qucs_stream != NULL) {
+    unsigned int k;
+    std::vector<dataset_entry_t> & deps = qucs_stream->getDependencies ();
+    for (k = 0; k < deps.size (); k++)
+      matlab_save_stream (qucs_stream, deps, k);
+    std::vector<dataset_entry_t> & vars = qucs_stream->getVariables ();
+    for (k = 0; k < vars.size (); k++)
+      matlab_save_stream (qucs_stream, vars, k);
+    return;
+  }
+
   // independent vectors and matrices
   for (v = data->getDependencies (); v != NULL; v = (::vector *) v->getNext ()) {
     matlab_save (v);
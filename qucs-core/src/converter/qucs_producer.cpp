@@ -382,7 +382,6 @@ void qucslib_producer (void) {
 /* This function is the Qucs dataset producer for VCD files. */
 void qucsdata_producer_vcd (void) {
   struct dataset_variable * ds;
-  struct dataset_value * dv;
   fprintf (qucs_out, "<Qucs Dataset " PACKAGE_VERSION ">\n");
   for (ds = dataset_root; ds; ds = ds->next) {
     if (!ds->output || ds->type == DATA_UNKNOWN)
@@ -392,9 +391,7 @@ void qucsdata_producer_vcd (void) {
     else if (ds->type == DATA_DEPENDENT)
       fprintf (qucs_out, "<dep %s.%s %s>\n", ds->ident, ds->isreal ? "R" : "X",
 	       ds->dependencies);
-    for (dv = ds->values; dv; dv = dv->next) {
-      fprintf (qucs_out, "  %s\n", dv->value);
-    }
+    vcd_print_values (ds, qucs_out);
     if (ds->type == DATA_INDEPENDENT)
       fprintf (qucs_out, "</indep>\n");
     else if (ds->type == DATA_DEPENDENT)
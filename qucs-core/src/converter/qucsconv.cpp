@@ -45,6 +45,7 @@
 #include "csv_producer.h"
 #include "touchstone_producer.h"
 #include "matlab_producer.h"
+#include "dataset_reader.h"
 #include "dataset.h"
 
 using namespace qucs;
@@ -61,6 +62,12 @@ struct actionset_t {
 /* data variable specification */
 char * data_var = NULL;
 
+/* read the dataset in chunks instead of loading it */
+int data_stream = 0;
+
+/* pack the values of binary output datasets */
+int data_packed = 0;
+
 /* required forward declarations */
 int spice2qucs (struct actionset_t *, char *, char *);
 int vcd2qucs   (struct actionset_t *, char *, char *);
@@ -72,6 +79,8 @@ int csv2qucs   (struct actionset_t *, char *, char *);
 int zvr2qucs   (struct actionset_t *, char *, char *);
 int mdl2qucs   (struct actionset_t *, char *, char *);
 int qucs2mat   (struct actionset_t *, char *, char *);
+int qucs2bin   (struct actionset_t *, char *, char *);
+int bin2qucs   (struct actionset_t *, char *, char *);
 
 /* conversion definitions */
 struct actionset_t actionset[] = {
@@ -86,6 +95,8 @@ struct actionset_t actionset[] = {
   { "zvr",        "qucsdata",   zvr2qucs   },
   { "mdl",        "qucsdata",   mdl2qucs   },
   { "qucsdata",   "matlab",     qucs2mat   },
+  { "qucsdata",   "qucsbin",    qucs2bin   },
+  { "qucsbin",    "qucsdata",   bin2qucs   },
   { NULL, NULL, NULL}
 };
 
@@ -105,6 +116,22 @@ FILE * open_file (char * file, const char * flag) {
   return fd;
 }
 
+/* Applies the given VCD time window START:STOP.  Returns zero on
+   success. */
+int vcd_window (char * window) {
+  char * end, * p = strchr (window, ':');
+  if (p == NULL) return -1;
+  if (p != window) {
+    vcd_start = strtod (window, &end);
+    if (end != p) return -1;
+  }
+  if (p[1] != '\0') {
+    vcd_stop = strtod (p + 1, &end);
+    if (*end != '\0') return -1;
+  }
+  return 0;
+}
+
 /* main entry point */
 int main (int argc, char ** argv) {
 
@@ -142,6 +169,10 @@ int main (int argc, char ** argv) {
 	"  -g  GNDNODE     replace ground node\n"
 	"  -d  DATANAME    data variable specification\n"
 	"  -c, --correct   enable node correction\n"
+	"  -s, --stream    read qucsdata input in chunks while converting\n"
+	"  -z, --compress  pack the values of qucsbin output\n"
+	"  -w  START:STOP  VCD time window in seconds (either may be omitted)\n"
+	"  -S  SCOPE       VCD scope to convert, e.g. top.cpu\n"
   "\nFORMAT: The input - output format pair should be one of the following:\n"
   "  inputformat - outputformat\n"
   "  spice       - qucs\n"
@@ -155,6 +186,8 @@ int main (int argc, char ** argv) {
   "  zvr         - qucsdata\n"
   "  mdl         - qucsdata\n"
   "  qucsdata    - matlab\n"
+  "  qucsdata    - qucsbin\n"
+  "  qucsbin     - qucsdata\n"
 	"\nReport bugs to <" PACKAGE_BUGREPORT ">.\n", argv[0]);
       return 0;
     }
@@ -182,6 +215,21 @@ int main (int argc, char ** argv) {
     else if (!strcmp (argv[i], "-c") || !strcmp (argv[i], "--correct")) {
       vcd_correct = 1;
     }
+    else if (!strcmp (argv[i], "-s") || !strcmp (argv[i], "--stream")) {
+      data_stream = 1;
+    }
+    else if (!strcmp (argv[i], "-z") || !strcmp (argv[i], "--compress")) {
+      data_packed = 1;
+    }
+    else if (!strcmp (argv[i], "-w")) {
+      if (argv[++i] && vcd_window (argv[i]) != 0) {
+	fprintf (stderr, "invalid time window `%s'\n", argv[i]);
+	return -1;
+      }
+    }
+    else if (!strcmp (argv[i], "-S")) {
+      if (argv[++i]) vcd_scope = argv[i];
+    }
   }
 
   // check input/output formats
@@ -214,6 +262,22 @@ int main (int argc, char ** argv) {
   return -1;
 }
 
+/* Opens the given Qucs dataset for the streaming producers.  The
+   dataset is indexed but not loaded, thus it must be a file. */
+int open_stream (char * infile) {
+  if (infile == NULL) {
+    fprintf (stderr, "streaming requires an input file\n");
+    return -1;
+  }
+  qucs_stream = new dataset_reader ();
+  if (qucs_stream->open (infile) != 0) {
+    delete qucs_stream;
+    qucs_stream = NULL;
+    return -1;
+  }
+  return 0;
+}
+
 // SPICE to Qucs conversion.
 int spice2qucs (struct actionset_t * action, char * infile, char * outfile) {
   int ret = 0;
@@ -274,7 +338,13 @@ int vcd2qucs (struct actionset_t * action, char * infile, char * outfile) {
 // Qucs dataset to CSV conversion.
 int qucs2csv (struct actionset_t * action, char * infile, char * outfile) {
   int ret = 0;
-  if ((dataset_in = open_file (infile, "r")) == NULL) {
+  if (data_stream) {
+    ret = open_stream (infile);
+  } else if (infile && dataset::isBinaryFile (infile)) {
+    // only the requested variable gets read
+    if ((dataset_result = dataset::open (infile)) == NULL)
+      ret = -1;
+  } else if ((dataset_in = open_file (infile, "r")) == NULL) {
     ret = -1;
   } else if (dataset_parse () != 0) {
     ret = -1;
@@ -311,7 +381,9 @@ int qucs2csv (struct actionset_t * action, char * infile, char * outfile) {
 // Qucs dataset to Touchstone conversion.
 int qucs2touch (struct actionset_t * action, char * infile, char * outfile) {
   int ret = 0;
-  if ((dataset_in = open_file (infile, "r")) == NULL) {
+  if (data_stream) {
+    ret = open_stream (infile);
+  } else if ((dataset_in = open_file (infile, "r")) == NULL) {
     ret = -1;
   } else if (dataset_parse () != 0) {
     ret = -1;
@@ -343,7 +415,9 @@ int qucs2touch (struct actionset_t * action, char * infile, char * outfile) {
 // Qucs dataset to Matlab conversion.
 int qucs2mat (struct actionset_t * action, char * infile, char * outfile) {
   int ret = 0;
-  if ((dataset_in = open_file (infile, "r")) == NULL) {
+  if (data_stream) {
+    ret = open_stream (infile);
+  } else if ((dataset_in = open_file (infile, "r")) == NULL) {
     ret = -1;
   } else if (dataset_parse () != 0) {
     ret = -1;
@@ -505,3 +579,55 @@ int mdl2qucs (struct actionset_t * action, char * infile, char * outfile) {
   return 0;
 }
 
+// Qucs dataset to binary dataset conversion.
+int qucs2bin (struct actionset_t * action, char * infile, char * outfile) {
+  int ret = 0;
+  if (outfile == NULL) {
+    fprintf (stderr, "binary dataset requires an output file\n");
+    return -1;
+  }
+  if ((dataset_in = open_file (infile, "r")) == NULL) {
+    ret = -1;
+  } else if (dataset_parse () != 0) {
+    ret = -1;
+  } else if (dataset_result == NULL) {
+    ret = -1;
+  } else if (dataset_check (dataset_result) != 0) {
+    delete dataset_result;
+    dataset_result = NULL;
+    ret = -1;
+  }
+  qucs_data = dataset_result;
+  dataset_result = NULL;
+  dataset_lex_destroy ();
+  if (dataset_in)
+    fclose (dataset_in);
+  if (ret)
+    return -1;
+
+  if (!strcmp (action->out, "qucsbin")) {
+    qucs_data->setFile (outfile);
+    qucs_data->setBinary (data_packed ? 2 : 1);
+    qucs_data->print ();
+  }
+  delete qucs_data;
+  qucs_data = NULL;
+  return 0;
+}
+
+// Binary dataset to Qucs dataset conversion.
+int bin2qucs (struct actionset_t * action, char * infile, char * outfile) {
+  if (infile == NULL) {
+    fprintf (stderr, "binary dataset requires an input file\n");
+    return -1;
+  }
+  dataset * data = dataset::load_binary (infile);
+  if (data == NULL)
+    return -1;
+  if (!strcmp (action->out, "qucsdata")) {
+    data->setFile (outfile);
+    qucsdata_producer (data);
+  }
+  delete data;
+  return 0;
+}
@@ -36,6 +36,7 @@
 #include "matrix.h"
 #include "matvec.h"
 #include "constants.h"
+#include "dataset_reader.h"
 
 using namespace qucs;
 
@@ -48,12 +49,13 @@ struct touchstone_data_t {
   int ports;           // number of S-parameter ports
   double resistance;   // reference impedance
   const char * format; // data format
-  qucs::vector * vd;         // appropriate dependency vector
+  dataset_cursor * vd;       // appropriate dependency vector
   matvec * mv;         // appropriate data matrix vector
-  qucs::vector * fmin;       // minimum noise figure
-  qucs::vector * sopt;       // optimum input refelction for minimum noise figure
-  qucs::vector * rn;         // effective noise resistance
-  qucs::vector * vf;         // dependency vector for noise
+  dataset_cursor ** me;      // matrix entries of a streamed dataset
+  dataset_cursor * fmin;     // minimum noise figure
+  dataset_cursor * sopt;     // optimum input refelction for minimum noise figure
+  dataset_cursor * rn;       // effective noise resistance
+  dataset_cursor * vf;       // dependency vector for noise
 }
 touchstone_data;
 
@@ -64,6 +66,21 @@ touchstone_data;
 #define touchstone_crlf "\r\n"
 #endif
 
+/* Returns the parameter matrix at the given index. */
+static matrix touchstone_matrix (int i) {
+  if (touchstone_data.mv != NULL)
+    return touchstone_data.mv->get (i);
+  int n = touchstone_data.ports;
+  matrix S (n, n);
+  for (int r = 0; r < n; r++) {
+    for (int c = 0; c < n; c++) {
+      dataset_cursor * e = touchstone_data.me[r * n + c];
+      if (e != NULL) S.set (r, c, e->get (i));
+    }
+  }
+  return S;
+}
+
 /* The Touchstone noise data printer. */
 void touchstone_print_noise (void) {
   if (touchstone_data.vf != NULL && touchstone_data.sopt != NULL &&
@@ -96,7 +113,7 @@ void touchstone_print (void) {
   // one-port file
   if (touchstone_data.ports == 1) {
     for (int i = 0; i < touchstone_data.vd->getSize (); i++) {
-      matrix S = touchstone_data.mv->get (i);
+      matrix S = touchstone_matrix (i);
       nr_double_t f = real (touchstone_data.vd->get (i));
       fprintf (touchstone_out, "%." "20" "e"
 	       " %+." "20" "e" " %+." "20" "e"
@@ -106,7 +123,7 @@ void touchstone_print (void) {
   // two-port file
   else if (touchstone_data.ports == 2) {
     for (int i = 0; i < touchstone_data.vd->getSize (); i++) {
-      matrix S = touchstone_data.mv->get (i);
+      matrix S = touchstone_matrix (i);
       nr_double_t f = real (touchstone_data.vd->get (i));
       fprintf (touchstone_out, "%." "20" "e"
 	       " %+." "20" "e" " %+." "20" "e"
@@ -123,7 +140,7 @@ void touchstone_print (void) {
   // three-port file
   else if (touchstone_data.ports == 3) {
     for (int i = 0; i < touchstone_data.vd->getSize (); i++) {
-      matrix S = touchstone_data.mv->get (i);
+      matrix S = touchstone_matrix (i);
       nr_double_t f = real (touchstone_data.vd->get (i));
       fprintf (touchstone_out, "%." "20" "e"
 	       " %+." "20" "e" " %+." "20" "e"
@@ -153,7 +170,7 @@ void touchstone_print (void) {
   // four-port and above files
   else if (touchstone_data.ports >= 4) {
     for (int i = 0; i < touchstone_data.vd->getSize (); i++) {
-      matrix S = touchstone_data.mv->get (i);
+      matrix S = touchstone_matrix (i);
       nr_double_t f = real (touchstone_data.vd->get (i));
       int cs = S.getCols ();
       int rs = S.getRows ();
@@ -202,17 +219,17 @@ void touchstone_find_data (dataset * data, const char * name) {
     }
     // minimum noise figure?
     if (!strcmp (vn, "Fmin")) {
-      touchstone_data.fmin = v;
+      touchstone_data.fmin = new dataset_cursor (v);
       if ((deps = v->getDependencies ()) != NULL) vf = deps->get (0);
     }
     // optimal input reflection for minimum noise figure?
     else if (!strcmp (vn, "Sopt")) {
-      touchstone_data.sopt = v;
+      touchstone_data.sopt = new dataset_cursor (v);
       if ((deps = v->getDependencies ()) != NULL) vf = deps->get (0);
     }
     // effective noise resitance?
     else if (!strcmp (vn, "Rn")) {
-      touchstone_data.rn = v;
+      touchstone_data.rn = new dataset_cursor (v);
       if ((deps = v->getDependencies ()) != NULL) vf = deps->get (0);
     }
   }
@@ -241,10 +258,77 @@ void touchstone_find_data (dataset * data, const char * name) {
     // look for dependency (frequency) vector
     for (v = data->getDependencies (); v; v = (::vector *) v->getNext ()) {
       if (vd && !strcmp (v->getName (), vd)) {
-	touchstone_data.vd = v;
+	touchstone_data.vd = new dataset_cursor (v);
       }
       if (vf && !strcmp (v->getName (), vf)) {
-	touchstone_data.vf = v;
+	touchstone_data.vf = new dataset_cursor (v);
+      }
+    }
+  }
+}
+
+/* The function finds the parameter matrix entries like the function
+   above in the index of a streamed dataset and opens cursors for
+   them. */
+void touchstone_find_stream (dataset_reader * data, const char * name) {
+  char * n;
+  const char * vn;
+  const char * vd = NULL, * vf = NULL;
+  int r, c, rs = -1, cs  = -1;
+
+  // find parameter matrix data and its dimensions
+  for (auto &v : data->getVariables ()) {
+    vn = v.name.c_str ();
+    // requested matrix vector name found?
+    if (strstr (vn, name) == vn) {
+      if ((n = matvec::isMatrixVector (vn, r, c)) != NULL) {
+	if (rs < r) rs = r;
+	if (cs < c) cs = c;
+	free (n);
+	vd = v.deps.empty () ? NULL : v.deps[0].c_str ();
+      }
+    }
+    // noise parameters
+    dataset_cursor ** noise = NULL;
+    if (!strcmp (vn, "Fmin"))
+      noise = &touchstone_data.fmin;
+    else if (!strcmp (vn, "Sopt"))
+      noise = &touchstone_data.sopt;
+    else if (!strcmp (vn, "Rn"))
+      noise = &touchstone_data.rn;
+    if (noise != NULL) {
+      delete *noise;
+      *noise = new dataset_cursor (data, &v);
+      if (!v.deps.empty ()) vf = v.deps[0].c_str ();
+    }
+  }
+
+  // matrix entries found
+  if (rs >= 0 && cs >= 0 && vd != NULL) {
+    int ss = (rs > cs ? rs : cs) + 1;
+    touchstone_data.ports = ss;
+    touchstone_data.me = new dataset_cursor * [ss * ss];
+    for (r = 0; r < ss * ss; r++) touchstone_data.me[r] = NULL;
+    for (auto &v : data->getVariables ()) {
+      vn = v.name.c_str ();
+      if (strstr (vn, name) == vn) {
+	if ((n = matvec::isMatrixVector (vn, r, c)) != NULL) {
+	  delete touchstone_data.me[r * ss + c];
+	  touchstone_data.me[r * ss + c] = new dataset_cursor (data, &v);
+	  free (n);
+	}
+      }
+    }
+    touchstone_data.parameter = toupper (name[0]);
+    // look for dependency (frequency) vector
+    for (auto &v : data->getDependencies ()) {
+      if (v.name == vd) {
+	delete touchstone_data.vd;
+	touchstone_data.vd = new dataset_cursor (data, &v);
+      }
+      if (vf && v.name == vf) {
+	delete touchstone_data.vf;
+	touchstone_data.vf = new dataset_cursor (data, &v);
       }
     }
   }
@@ -260,6 +344,7 @@ void touchstone_producer (const char * variable) {
 
   // initialize global Touchstone structure
   touchstone_data.mv = NULL;
+  touchstone_data.me = NULL;
   touchstone_data.vd = NULL;
   touchstone_data.format = "RI";
   touchstone_data.resistance = 50.0;
@@ -269,15 +354,30 @@ void touchstone_producer (const char * variable) {
   touchstone_data.vf = NULL;
 
   // look for appropriate matrix data
-  touchstone_find_data (qucs_data, variable);
+  if (qucs_stream != NULL)
+    touchstone_find_stream (qucs_stream, variable);
+  else
+    touchstone_find_data (qucs_data, variable);
 
   // print matrix data if available
-  if (touchstone_data.mv != NULL) {
+  if (touchstone_data.mv != NULL || touchstone_data.me != NULL) {
     touchstone_print ();
-    delete touchstone_data.mv;
     touchstone_print_noise ();
   }
   else {
     fprintf (stderr, "no such data variable `%s' found\n", variable);
   }
+
+  // free matrix data and cursors
+  delete touchstone_data.mv;
+  if (touchstone_data.me != NULL) {
+    int n = touchstone_data.ports;
+    for (int i = 0; i < n * n; i++) delete touchstone_data.me[i];
+    delete[] touchstone_data.me;
+  }
+  delete touchstone_data.vd;
+  delete touchstone_data.fmin;
+  delete touchstone_data.sopt;
+  delete touchstone_data.rn;
+  delete touchstone_data.vf;
 }
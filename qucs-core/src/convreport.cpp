@@ -0,0 +1,303 @@
+/*
+ * convreport.cpp - Newton convergence report implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#include "logging.h"
+#include "convreport.h"
+
+namespace qucs {
+
+// one Newton iteration
+struct convit_t {
+  double dx, dz, ratio, damping;
+  int worst;
+};
+
+// the plain iteration or one step of a continuation method
+struct convstep_t {
+  std::string parameter;
+  double value;
+  bool converged;
+  int iterations;
+  std::vector<convit_t> its;
+};
+
+// how often an unknown was the one farthest from convergence
+struct convoffender_t {
+  int count;
+  double ratio;
+};
+
+struct convsolve_t {
+  std::string analysis, helper;
+  int number, iterations, kept;
+  std::vector<convstep_t> steps;
+  std::map<int, convoffender_t> offenders;
+  std::map<int, std::string> names;
+  std::map<int, std::vector<std::string> > devices;
+};
+
+struct convsummary_t {
+  std::string analysis;
+  int solves, iterations, maxiterations, failures;
+};
+
+bool convreport::active = false;
+
+static std::mutex reportlock;
+static std::vector<convsummary_t> summaries;
+static std::vector<convsolve_t> failures;
+static int dropped = 0;
+
+// the solve being recorded by this thread
+static thread_local convsolve_t * current = NULL;
+
+/* Starts recording a non-linear solve of the given analysis using the
+   given convergence helper. */
+void convreport::begin (const std::string & analysis, const char * helper) {
+  if (!active) return;
+  delete current;
+  current = new convsolve_t ();
+  current->analysis = analysis;
+  current->helper = helper;
+  current->number = current->iterations = current->kept = 0;
+  step ("", 0);
+}
+
+/* Starts a continuation step with the given parameter value.  An
+   unused plain step is replaced. */
+void convreport::step (const char * parameter, double value) {
+  if (!active || !current) return;
+  if (!current->steps.empty () && current->steps.back ().iterations == 0 &&
+      current->steps.back ().parameter.empty ())
+    current->steps.pop_back ();
+  convstep_t s;
+  s.parameter = parameter;
+  s.value = value;
+  s.converged = false;
+  s.iterations = 0;
+  current->steps.push_back (s);
+}
+
+void convreport::iteration (double dx, double dz, int worst, double ratio,
+			    double damping) {
+  if (!active || !current) return;
+  convstep_t & s = current->steps.back ();
+  s.iterations++;
+  current->iterations++;
+  if (current->kept < CONVREPORT_ITERATIONS) {
+    convit_t it = { dx, dz, ratio, damping, worst };
+    s.its.push_back (it);
+    current->kept++;
+  }
+  if (worst >= 0 && ratio >= 1) {
+    convoffender_t & o = current->offenders[worst];
+    o.count++;
+    o.ratio = std::max (o.ratio, ratio);
+  }
+}
+
+void convreport::endStep (bool converged) {
+  if (!active || !current) return;
+  current->steps.back ().converged = converged;
+}
+
+/* Returns the unknowns named in the report of the current solve, the
+   worst offenders and those reported per iteration. */
+std::vector<int> convreport::unknowns (void) {
+  std::vector<int> res;
+  if (!active || !current) return res;
+  for (auto & o : current->offenders) res.push_back (o.first);
+  for (convstep_t & s : current->steps)
+    for (convit_t & it : s.its)
+      if (it.worst >= 0) res.push_back (it.worst);
+  std::sort (res.begin (), res.end ());
+  res.erase (std::unique (res.begin (), res.end ()), res.end ());
+  return res;
+}
+
+/* Finishes the current solve.  A failed one is kept along with the
+   names of its unknowns and the devices connected to them. */
+void convreport::end (bool failed, const std::map<int, std::string> & names,
+		      const std::map<int, std::vector<std::string> > & devices) {
+  if (!active || !current) return;
+  std::lock_guard<std::mutex> lock (reportlock);
+
+  convsummary_t * sum = NULL;
+  for (convsummary_t & s : summaries)
+    if (s.analysis == current->analysis) sum = &s;
+  if (sum == NULL) {
+    convsummary_t s = { current->analysis, 0, 0, 0, 0 };
+    summaries.push_back (s);
+    sum = &summaries.back ();
+  }
+  current->number = ++sum->solves;
+  sum->iterations += current->iterations;
+  sum->maxiterations = std::max (sum->maxiterations, current->iterations);
+
+  if (failed) {
+    sum->failures++;
+    if (failures.size () < CONVREPORT_FAILURES) {
+      current->names = names;
+      current->devices = devices;
+      failures.push_back (*current);
+    }
+    else dropped++;
+  }
+  delete current;
+  current = NULL;
+}
+
+/* Prints the string as JSON string. */
+static void print (FILE * f, const std::string & s) {
+  fputc ('"', f);
+  for (char c : s) {
+    if (c == '"' || c == '\\') fputc ('\\', f);
+    fputc (c, f);
+  }
+  fputc ('"', f);
+}
+
+/* Prints the value as JSON number, diverged values as null. */
+static void print (FILE * f, double d) {
+  if (std::isfinite (d))
+    fprintf (f, "%g", d);
+  else
+    fprintf (f, "null");
+}
+
+static std::string name (const convsolve_t & s, int r) {
+  auto it = s.names.find (r);
+  return it != s.names.end () ? it->second : "#" + std::to_string (r);
+}
+
+/* Writes the report into the given file in JSON format.  Returns zero
+   on success. */
+int convreport::write (const char * file) {
+  if (!active) return 0;
+
+  FILE * f = fopen (file, "w");
+  if (f == NULL) {
+    logprint (LOG_ERROR, "cannot create file `%s'\n", file);
+    return -1;
+  }
+  std::lock_guard<std::mutex> lock (reportlock);
+
+  fprintf (f, "{\n  \"analyses\": [");
+  for (size_t i = 0; i < summaries.size (); i++) {
+    convsummary_t & s = summaries[i];
+    fprintf (f, "%s\n    { \"name\": ", i ? "," : "");
+    print (f, s.analysis);
+    fprintf (f, ", \"solves\": %d, \"iterations\": %d, "
+	     "\"maxIterations\": %d, \"failures\": %d }",
+	     s.solves, s.iterations, s.maxiterations, s.failures);
+  }
+  fprintf (f, "\n  ],\n  \"unreported\": %d,\n  \"failures\": [", dropped);
+
+  for (size_t i = 0; i < failures.size (); i++) {
+    convsolve_t & s = failures[i];
+    fprintf (f, "%s\n    {\n      \"analysis\": ", i ? "," : "");
+    print (f, s.analysis);
+    fprintf (f, ",\n      \"solve\": %d,\n      \"helper\": ", s.number);
+    print (f, s.helper);
+    fprintf (f, ",\n      \"iterations\": %d,\n      \"steps\": [",
+	     s.iterations);
+    for (size_t k = 0; k < s.steps.size (); k++) {
+      convstep_t & st = s.steps[k];
+      fprintf (f, "%s\n        { ", k ? "," : "");
+      if (!st.parameter.empty ()) {
+	fprintf (f, "\"parameter\": ");
+	print (f, st.parameter);
+	fprintf (f, ", \"value\": ");
+	print (f, st.value);
+	fprintf (f, ", ");
+      }
+      fprintf (f, "\"converged\": %s, \"iterations\": %d,\n"
+	       "          \"history\": [", st.converged ? "true" : "false",
+	       st.iterations);
+      for (size_t n = 0; n < st.its.size (); n++) {
+	convit_t & it = st.its[n];
+	fprintf (f, "%s\n            { \"dx\": ", n ? "," : "");
+	print (f, it.dx);
+	fprintf (f, ", \"dz\": ");
+	print (f, it.dz);
+	fprintf (f, ", \"ratio\": ");
+	print (f, it.ratio);
+	fprintf (f, ", \"damping\": %g, \"worst\": ", it.damping);
+	print (f, name (s, it.worst));
+	fprintf (f, " }");
+      }
+      fprintf (f, "\n          ] }");
+    }
+
+    // the worst offending unknowns, the most frequent first
+    std::vector<std::pair<int, int> > worst;
+    for (auto & o : s.offenders)
+      worst.push_back (std::make_pair (-o.second.count, o.first));
+    std::sort (worst.begin (), worst.end ());
+    if (worst.size () > CONVREPORT_WORST) worst.resize (CONVREPORT_WORST);
+    fprintf (f, "\n      ],\n      \"nodes\": [");
+    for (size_t n = 0; n < worst.size (); n++) {
+      int r = worst[n].second;
+      fprintf (f, "%s\n        { \"name\": ", n ? "," : "");
+      print (f, name (s, r));
+      fprintf (f, ", \"count\": %d, \"ratio\": ", -worst[n].first);
+      print (f, s.offenders[r].ratio);
+      fprintf (f, " }");
+    }
+
+    // devices connected to the offending unknowns, weighted by count
+    std::map<std::string, int> devs;
+    for (auto & o : s.offenders) {
+      auto d = s.devices.find (o.first);
+      if (d == s.devices.end ()) continue;
+      for (const std::string & dev : d->second)
+	devs[dev] += o.second.count;
+    }
+    std::vector<std::pair<int, std::string> > ranked;
+    for (auto & d : devs) ranked.push_back (std::make_pair (-d.second, d.first));
+    std::sort (ranked.begin (), ranked.end ());
+    if (ranked.size () > CONVREPORT_WORST) ranked.resize (CONVREPORT_WORST);
+    fprintf (f, "\n      ],\n      \"devices\": [");
+    for (size_t n = 0; n < ranked.size (); n++) {
+      fprintf (f, "%s\n        { \"name\": ", n ? "," : "");
+      print (f, ranked[n].second);
+      fprintf (f, ", \"count\": %d }", -ranked[n].first);
+    }
+    fprintf (f, "\n      ]\n    }");
+  }
+  fprintf (f, "\n  ]\n}\n");
+  fclose (f);
+  return 0;
+}
+
+} // namespace qucs
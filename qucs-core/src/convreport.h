@@ -0,0 +1,80 @@
+/*
+ * convreport.h - Newton convergence report definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __CONVREPORT_H__
+#define __CONVREPORT_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace qucs {
+
+// failed solves kept in the report, further ones are counted only
+#define CONVREPORT_FAILURES   50
+
+// iterations kept per failed solve
+#define CONVREPORT_ITERATIONS 500
+
+// offending unknowns and devices listed per failed solve
+#define CONVREPORT_WORST      8
+
+/*! \class convreport
+ * \brief record of the Newton iterations of the non-linear solves.
+ *
+ * Each non-linear solve consists of one or more steps, the plain
+ * Newton-Raphson iteration or the steps of a continuation method.  For
+ * every iteration the largest solution and right hand side changes,
+ * the unknown farthest from convergence and the damping factor applied
+ * are recorded.  Solves that converge are summarized per analysis
+ * only, failed ones are kept with their iterations and the unknowns
+ * and devices which most often prevented the convergence.  The solves
+ * of each thread are recorded independently.
+ */
+class convreport
+{
+ public:
+  static void enable (void) { active = true; }
+  static bool enabled (void) { return active; }
+
+  static void begin (const std::string &, const char *);
+  static void step (const char *, double);
+  static void iteration (double dx, double dz, int worst, double ratio,
+			 double damping);
+  static void endStep (bool);
+  static std::vector<int> unknowns (void);
+  static void end (bool, const std::map<int, std::string> & names =
+		   std::map<int, std::string> (),
+		   const std::map<int, std::vector<std::string> > & devices =
+		   std::map<int, std::vector<std::string> > ());
+
+  static int write (const char *);
+
+ private:
+  static bool active;
+};
+
+} // namespace qucs
+
+#endif /* __CONVREPORT_H__ */
@@ -31,7 +31,15 @@
 #include <string.h>
 #include <errno.h>
 #include <assert.h>
+#include <stdint.h>
 #include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#if HAVE_MMAP
+# include <sys/mman.h>
+#endif
 
 #include "logging.h"
 #include "complex.h"
@@ -39,6 +47,7 @@
 #include "strlist.h"
 #include "vector.h"
 #include "dataset.h"
+#include "dtoa.h"
 #include "check_dataset.h"
 #include "check_touchstone.h"
 #include "check_csv.h"
@@ -52,25 +61,49 @@ namespace qucs {
 dataset::dataset () : object () {
   variables = dependencies = NULL;
   file = NULL;
+  binary = 0;
+  digits = 0;
+  chunk = 0;
+  spool = NULL;
+  spoolout = 0;
+  mapping = NULL;
+  mapsize = 0;
 }
 
 // Constructor creates an named instance of the dataset class.
 dataset::dataset (char * n) : object (n) {
   variables = dependencies = NULL;
   file = NULL;
+  binary = 0;
+  digits = 0;
+  chunk = 0;
+  spool = NULL;
+  spoolout = 0;
+  mapping = NULL;
+  mapsize = 0;
 }
 
 /* The copy constructor creates a new instance based on the given
-   dataset object. */
+   dataset object.  Spooled data is not copied, vectors not yet read
+   from the file of an opened dataset are read first. */
 dataset::dataset (const dataset & d) : object (d) {
+  variables = dependencies = NULL;
   file = d.file ? strdup (d.file) : NULL;
+  binary = d.binary;
+  digits = d.digits;
+  chunk = 0;
+  spool = NULL;
+  spoolout = 0;
+  mapping = NULL;
+  mapsize = 0;
+  const_cast<dataset &> (d).fetchAll ();
   vector * v;
   // copy dependency vectors
   for (v = d.dependencies; v != NULL; v = (vector *) v->getNext ()) {
     addDependency (new vector (*v));
   }
   // copy variable vectors
-  for (v = variables; v != NULL; v = (vector *) v->getNext ()) {
+  for (v = d.variables; v != NULL; v = (vector *) v->getNext ()) {
     addVariable (new vector (*v));
   }
 }
@@ -89,6 +122,10 @@ dataset::~dataset () {
     delete v;
   }
   free (file);
+  if (spool) fclose (spool);
+#if HAVE_MMAP
+  if (mapping) munmap (mapping, mapsize);
+#endif
 }
 
 // This function adds a dependency vector to the current dataset.
@@ -111,6 +148,7 @@ void dataset::delDependency (vector * v) {
     prev->setNext (next);
     if (next) next->setPrev (prev);
   }
+  forget (v);
   delete v;
 }
 
@@ -169,6 +207,7 @@ void dataset::delVariable (vector * v) {
     prev->setNext (next);
     if (next) next->setPrev (prev);
   }
+  forget (v);
   delete v;
 }
 
@@ -216,7 +255,7 @@ void dataset::applyDependencies (vector * v) {
     for (vector * t = (vector *) v->getNext (); t != NULL; t = next) {
       next = (vector *) t->getNext ();
       if (t->getDependencies () == NULL) {
-	t->setDependencies (new strlist (*deps));
+	t->shareDependencies (v);
       }
     }
   }
@@ -249,7 +288,9 @@ void dataset::assignDependency (const char * const origin, const char * const de
       strlist * deplist = v->getDependencies ();
       if (deplist != NULL) {
 	if (!deplist->contains (depvar)) {
+	  deplist = new strlist (*deplist);
 	  deplist->append (depvar);
+	  v->setDependencies (deplist);
 	}
       }
       else {
@@ -281,7 +322,7 @@ int dataset::isVariable (vector * var) {
 vector * dataset::findDependency (const char * n) {
   for (vector * v = dependencies; v != NULL; v = (vector *) v->getNext ()) {
     if (!strcmp (v->getName (), n))
-      return v;
+      return fetch (v);
   }
   return NULL;
 }
@@ -292,7 +333,7 @@ vector * dataset::findDependency (const char * n) {
 vector * dataset::findVariable (const std::string &name) {
   for (vector * v = variables; v != NULL; v = (vector *) v->getNext ()) {
     if (!strcmp (v->getName (), name.c_str()))
-      return v;
+      return fetch (v);
   }
   return NULL;
 }
@@ -305,6 +346,16 @@ int dataset::countVariables (void) {
   return count;
 }
 
+/* Returns the number of values of the given vector including the ones
+   not yet read from the file. */
+int dataset::countValues (vector * v) {
+  auto it = lazy.find (v);
+  if (it == lazy.end ()) return v->getSize ();
+  int n = 0;
+  for (auto &c : it->second) n += c.size;
+  return n;
+}
+
 // Returns the number of dependency vectors.
 int dataset::countDependencies (void) {
   int count = 0;
@@ -331,6 +382,12 @@ void dataset::setFile (const char * f) {
 void dataset::print (void) {
 
   FILE * f = stdout;
+  fetchAll ();
+
+  if (binary) {
+    printBinary ();
+    return;
+  }
 
   // open file for writing
   if (file) {
@@ -365,7 +422,7 @@ void dataset::print (void) {
    given file descriptor. */
 void dataset::printDependency (vector * v, FILE * f) {
   // print data header
-  fprintf (f, "<indep %s %d>\n", v->getName (), v->getSize ());
+  fprintf (f, "<indep %s %d>\n", v->getName (), spooled (v) + v->getSize ());
   // print data itself
   printData (v, f);
   // print data footer
@@ -390,20 +447,590 @@ void dataset::printVariable (vector * v, FILE * f) {
   fprintf (f, "</dep>\n");
 }
 
+/* Collects the lines of printed data items and writes them to the
+   output stream in large blocks. */
+struct datasetbuf {
+  FILE * f;
+  int digits;
+  size_t n;
+  std::vector<char> data;
+  datasetbuf (FILE * file, int d) : f (file), digits (d), n (0),
+    data (DATASET_TEXTBUF) { }
+  ~datasetbuf () { flush (); }
+  void flush (void) { fwrite (&data[0], 1, n, f); n = 0; }
+  void print (nr_complex_t);
+};
+
+/* Appends a single data item, the imaginary part of complex ones like
+   "+1.0e+00-j2.5e-01".  The numbers are the shortest representations
+   reading back as the same values unless fewer digits are requested. */
+void datasetbuf::print (nr_complex_t c) {
+  if (data.size () - n < 2 * DTOA_MAXLEN + 4) flush ();
+  char * p = &data[n];
+  *p++ = ' ';
+  *p++ = ' ';
+  p += dtoa ((double) real (c), p, digits);
+  if (imag (c) != 0.0) {
+    dtoa ((double) imag (c), p + 1, digits);
+    *p = p[1];
+    *++p = 'j';
+    p += strlen (p);
+  }
+  *p++ = '\n';
+  n = p - &data[0];
+}
+
 /* This function is a helper routine for the print() functionality of
    the dataset class.  It prints the data items of the given vector
    object to the given output stream. */
 void dataset::printData (vector * v, FILE * f) {
+  printSpooled (v, f);
+  datasetbuf out (f, digits);
   for (int i = 0; i < v->getSize (); i++) {
-    nr_complex_t c = v->get (i);
-    if (imag (c) == 0.0) {
-      fprintf (f, "  %+." "20" "e\n", (double) real (c));
+    out.print (v->get (i));
+  }
+}
+
+/* The binary dataset format is a column oriented file in native byte
+   order.  It starts with the DATASET_MAGIC string, a 32 bit version,
+   a reserved 32 bit word and the 64 bit position of the index (zero
+   while the file is still being written).  Then follows a sequence of
+   records each starting with a 32 bit tag:
+
+     'V'  declaration: id, kind (0 = independent, 1 = dependent),
+          name and the names of the dependencies
+     'D'  data: id, count, flags and count real or complex doubles
+     'P'  packed data: id, count, flags, number of bytes and the
+          packed values
+     'I'  index: number of vectors and for each of them in print
+          order its id, the position of its declaration and the
+          position, count and flags of each of its data records
+
+   The flags tell whether the values are complex (1) and packed (2).
+   Files containing packed records have version 2, otherwise 1.
+
+   Strings are stored as 32 bit length followed by the characters.
+   The data records of a vector need not be contiguous, which allows
+   spooling the vectors of a streaming analysis in any order. */
+#define BIN_HEADER 24
+#define BIN_DECL   'V'
+#define BIN_DATA   'D'
+#define BIN_PACKED 'P'
+#define BIN_INDEX  'I'
+
+#define BIN_COMPLEX 1
+#define BIN_PACK    2
+
+// Writes a 32 bit unsigned integer to the given file.
+static void binWrite32 (FILE * f, uint32_t n) {
+  fwrite (&n, sizeof (n), 1, f);
+}
+
+// Writes a 64 bit unsigned integer to the given file.
+static void binWrite64 (FILE * f, uint64_t n) {
+  fwrite (&n, sizeof (n), 1, f);
+}
+
+// Writes a length prefixed string to the given file.
+static void binWriteString (FILE * f, const char * str) {
+  uint32_t len = str ? strlen (str) : 0;
+  binWrite32 (f, len);
+  if (len) fwrite (str, 1, len, f);
+}
+
+// Writes the binary file header with the given index position.
+static void binWriteHeader (FILE * f, uint64_t index, int packed) {
+  fwrite (DATASET_MAGIC, 1, 8, f);
+  binWrite32 (f, packed ? 2 : 1);
+  binWrite32 (f, 0);
+  binWrite64 (f, index);
+}
+
+/* Packed data records hold the real parts of the values followed by
+   the imaginary parts of complex ones.  Each value is stored as the
+   XOR of its bit pattern with the one of its prediction from the two
+   previous values of the column, least significant byte first and
+   without the leading zero bytes.  Smooth waveforms and equidistant
+   sweeps leave few bytes.  A control byte precedes each pair of
+   values, its low and high nibble count the bytes kept of them. */
+static double binPredict (int k, double a, double b) {
+  if (k == 0) return 0.0;
+  if (k == 1) return a;
+  double p = 2 * a - b;
+  return std::isfinite (p) ? p : a;
+}
+
+// Appends the packed column of doubles with the given stride.
+static void binPack (std::string & out, const double * x, int n,
+		     int stride) {
+  double a = 0.0, b = 0.0;
+  size_t ctrl = 0;
+  for (int k = 0; k < n; k++) {
+    double p = binPredict (k, a, b), d = x[k * stride];
+    uint64_t u, q;
+    memcpy (&u, &d, sizeof (u));
+    memcpy (&q, &p, sizeof (q));
+    u ^= q;
+    int len = 0;
+    while (len < 8 && (u >> (8 * len)) != 0) len++;
+    if (!(k & 1)) {
+      ctrl = out.size ();
+      out.push_back (0);
+    }
+    out[ctrl] |= len << ((k & 1) ? 4 : 0);
+    for (int i = 0; i < len; i++) out.push_back ((char) (u >> (8 * i)));
+    b = a;
+    a = d;
+  }
+}
+
+/* Unpacks a column of doubles with the given stride.  Returns the
+   position behind it or NULL if the data is truncated. */
+static const unsigned char * binUnpack (const unsigned char * p,
+					const unsigned char * end,
+					double * x, int n, int stride) {
+  double a = 0.0, b = 0.0;
+  int ctrl = 0;
+  for (int k = 0; k < n; k++) {
+    if (!(k & 1)) {
+      if (p >= end) return NULL;
+      ctrl = *p++;
+    }
+    int len = (k & 1) ? ctrl >> 4 : ctrl & 15;
+    if (len > 8 || end - p < len) return NULL;
+    uint64_t u = 0, q;
+    for (int i = 0; i < len; i++) u |= (uint64_t) p[i] << (8 * i);
+    p += len;
+    double d = binPredict (k, a, b);
+    memcpy (&q, &d, sizeof (q));
+    u ^= q;
+    memcpy (&d, &u, sizeof (d));
+    x[k * stride] = d;
+    b = a;
+    a = d;
+  }
+  return p;
+}
+
+/* Copies the values of a data record with the given flags in a binary
+   dataset into the vector starting at the given position.  Returns
+   non-zero and stores zeros if the record is truncated. */
+static int copyValues (const char * p, const char * end, int n, int flags,
+		       vector * v, int at) {
+  int cols = (flags & BIN_COMPLEX) ? 2 : 1, err = 0;
+  std::vector<double> d (2 * (size_t) n, 0.0);
+  if (flags & BIN_PACK) {
+    const unsigned char * q = (const unsigned char *) p;
+    for (int c = 0; c < cols && q != NULL; c++)
+      q = binUnpack (q, (const unsigned char *) end, &d[c], n, 2);
+    err = q == NULL;
+  }
+  else if (end - p < (long) (sizeof (double) * cols * n)) {
+    err = 1;
+  }
+  else {
+    for (int i = 0; i < n; i++, p += sizeof (double) * cols)
+      memcpy (&d[2 * i], p, sizeof (double) * cols);
+  }
+  if (err) std::fill (d.begin (), d.end (), 0.0);
+  for (int i = 0; i < n; i++)
+    v->set (nr_complex_t (d[2 * i], d[2 * i + 1]), at + i);
+  return err;
+}
+
+/* Reads the given number of values of a data record with the given
+   flags at the given position of the spool file into the vector
+   starting at the given index. */
+static void readValues (FILE * f, long pos, int n, int flags,
+			vector * v, int at) {
+  int cols = (flags & BIN_COMPLEX) ? 2 : 1;
+  size_t max = sizeof (double) * cols * (size_t) n;
+  if (flags & BIN_PACK) max += cols * ((size_t) n + 1) / 2;
+  std::vector<char> buf (max + 1);
+  fseek (f, pos, SEEK_SET);
+  size_t got = fread (&buf[0], 1, max, f);
+  copyValues (&buf[0], &buf[0] + got, n, flags, v, at);
+}
+
+/* The function enables streaming of the dataset.  Then vectors longer
+   than the given number of values are moved into a spool file each
+   time flush() is called, which keeps the memory usage bounded during
+   long analyses.  For binary datasets with an output file the spool
+   file is the output file itself.  Zero disables streaming. */
+void dataset::setStreaming (int n) {
+  chunk = n > 0 ? n : 0;
+}
+
+/* Moves the values of all vectors having reached the chunk size into
+   the spool file.  Analyses call this after saving their results,
+   since they only ever append to the vectors. */
+void dataset::flush (void) {
+  if (chunk <= 0) return;
+  vector * v;
+  for (v = dependencies; v != NULL; v = (vector *) v->getNext ()) spill (v);
+  for (v = variables; v != NULL; v = (vector *) v->getNext ()) spill (v);
+  if (spool) fflush (spool);
+}
+
+// Opens the spool file if necessary and returns it.
+FILE * dataset::openSpool (void) {
+  if (spool != NULL) return spool;
+  if (binary && file) {
+    if ((spool = fopen (file, "w+b")) == NULL) {
+      logprint (LOG_ERROR, "cannot create file `%s': %s\n",
+		file, strerror (errno));
+      chunk = 0;
+      return NULL;
+    }
+    spoolout = 1;
+  }
+  else if ((spool = tmpfile ()) == NULL) {
+    logprint (LOG_ERROR, "cannot create spool file: %s\n", strerror (errno));
+    chunk = 0;
+    return NULL;
+  }
+  binWriteHeader (spool, 0, binary > 1);
+  return spool;
+}
+
+/* Returns the spool entry of the given vector in the given map.  A
+   declaration record is appended to the file if the vector has not
+   yet been declared. */
+dataset::spoolvector_t &
+dataset::declare (FILE * f, spoolmap & m, vector * v) {
+  auto it = m.find (v);
+  if (it != m.end ()) return it->second;
+  spoolvector_t & s = m[v];
+  fseek (f, 0, SEEK_END);
+  s.id = m.size () - 1;
+  s.decl = ftell (f);
+  strlist * deps = v->getDependencies ();
+  binWrite32 (f, BIN_DECL);
+  binWrite32 (f, s.id);
+  binWrite32 (f, isDependency (v) || deps == NULL ? 0 : 1);
+  binWriteString (f, v->getName ());
+  binWrite32 (f, deps ? deps->length () : 0);
+  if (deps != NULL) {
+    for (strlistiterator it (deps); *it; ++it)
+      binWriteString (f, *it);
+  }
+  return s;
+}
+
+/* Appends the values of the given vector as data record to the file.
+   Purely real vectors are stored without their imaginary parts.  Packed
+   values are split into records of DATASET_CHUNK values, which can be
+   unpacked separately. */
+void dataset::writeData (FILE * f, spoolvector_t & s, vector * v) {
+  int i, n = v->getSize (), cplx = 0;
+  if (n <= 0) return;
+  for (i = 0; i < n && !cplx; i++) if (imag (v->get (i)) != 0.0) cplx = 1;
+  if (binary > 1) {
+    for (int start = 0; start < n; start += DATASET_CHUNK) {
+      int m = std::min (n - start, DATASET_CHUNK);
+      std::vector<double> d (2 * (size_t) m);
+      for (i = 0; i < m; i++) {
+	nr_complex_t z = v->get (start + i);
+	d[2 * i] = (double) real (z);
+	d[2 * i + 1] = (double) imag (z);
+      }
+      std::string buf;
+      binPack (buf, &d[0], m, 2);
+      if (cplx) binPack (buf, &d[1], m, 2);
+      fseek (f, 0, SEEK_END);
+      binWrite32 (f, BIN_PACKED);
+      binWrite32 (f, s.id);
+      binWrite32 (f, m);
+      binWrite32 (f, cplx | BIN_PACK);
+      binWrite32 (f, buf.size ());
+      spoolchunk_t c;
+      c.offset = ftell (f);
+      c.size = m;
+      c.complex = cplx | BIN_PACK;
+      fwrite (buf.data (), 1, buf.size (), f);
+      s.chunks.push_back (c);
+    }
+    return;
+  }
+  fseek (f, 0, SEEK_END);
+  binWrite32 (f, BIN_DATA);
+  binWrite32 (f, s.id);
+  binWrite32 (f, n);
+  binWrite32 (f, cplx);
+  spoolchunk_t c;
+  c.offset = ftell (f);
+  c.size = n;
+  c.complex = cplx;
+  for (i = 0; i < n; i++) {
+    nr_complex_t z = v->get (i);
+    double d[2] = { (double) real (z), (double) imag (z) };
+    fwrite (d, sizeof (double), cplx ? 2 : 1, f);
+  }
+  s.chunks.push_back (c);
+}
+
+// Writes the values of the given vector into the spool file.
+void dataset::spill (vector * v) {
+  if (v->getSize () < chunk) return;
+  FILE * f = openSpool ();
+  if (f == NULL) return;
+  writeData (f, declare (f, spools, v), v);
+  v->clear ();
+}
+
+// Returns the number of spooled values of the given vector.
+int dataset::spooled (vector * v) {
+  auto it = spools.find (v);
+  if (it == spools.end ()) return 0;
+  int n = 0;
+  for (auto &c : it->second.chunks) n += c.size;
+  return n;
+}
+
+// Prints the spooled values of the given vector.
+void dataset::printSpooled (vector * v, FILE * f) {
+  auto it = spools.find (v);
+  if (it == spools.end ()) return;
+  fflush (spool);
+  datasetbuf out (f, digits);
+  for (auto &c : it->second.chunks) {
+    vector part (c.size);
+    readValues (spool, c.offset, c.size, c.complex, &part, 0);
+    for (int i = 0; i < c.size; i++) out.print (part.get (i));
+  }
+}
+
+/* The function reads the spooled values back into their vectors.  It
+   must be called before the dataset is used other than by append or
+   print and disables streaming. */
+void dataset::restore (void) {
+  fetchAll ();
+  if (spool != NULL) {
+    fflush (spool);
+    for (auto &it : spools) {
+      vector * v = it.first;
+      vector all (spooled (v) + v->getSize ());
+      int i, n = 0;
+      for (auto &c : it.second.chunks) {
+	readValues (spool, c.offset, c.size, c.complex, &all, n);
+	n += c.size;
+      }
+      for (i = 0; i < v->getSize (); i++, n++) all.set (v->get (i), n);
+      *v = all;
+    }
+    fclose (spool);
+    spool = NULL;
+    // the output file is incomplete now, rewrite it when printing
+    spoolout = 0;
+  }
+  spools.clear ();
+  chunk = 0;
+}
+
+// Drops the spooled or unread values of the given vector.
+void dataset::forget (vector * v) {
+  spools.erase (v);
+  lazy.erase (v);
+}
+
+// Helper functions writing and reading the process data.
+static void writeInt (FILE * f, int i) {
+  fwrite (&i, sizeof (int), 1, f);
+}
+
+static int readInt (FILE * f, int & i) {
+  return fread (&i, sizeof (int), 1, f) == 1;
+}
+
+static void writeString (FILE * f, const char * s) {
+  int len = s ? strlen (s) : -1;
+  writeInt (f, len);
+  if (len > 0) fwrite (s, 1, len, f);
+}
+
+static int readString (FILE * f, std::string & s, bool & null) {
+  int len;
+  if (!readInt (f, len)) return 0;
+  null = len < 0;
+  s.resize (len > 0 ? len : 0);
+  return len <= 0 || fread (&s[0], 1, len, f) == (size_t) len;
+}
+
+/* The function returns the sizes of the dependencies and variables,
+   these are the items a forked process does not need to give back. */
+std::map<std::string,int> dataset::getSizes (void) {
+  std::map<std::string,int> sizes;
+  for (vector * v = dependencies; v != NULL; v = (vector *) v->getNext ())
+    sizes[std::string ("D") + v->getName ()] = v->getSize ();
+  for (vector * v = variables; v != NULL; v = (vector *) v->getNext ())
+    sizes[std::string ("V") + v->getName ()] = v->getSize ();
+  return sizes;
+}
+
+/* The function writes the dataset vectors into the given file.  Only
+   the data items beyond the given sizes, i.e. the ones added by this
+   process, are saved.  The vectors are written in the order they have
+   been created. */
+void dataset::writeAdded (FILE * f, const std::map<std::string,int> & sizes) {
+  for (int kind = 0; kind < 2; kind++) {
+    vector * v = kind ? variables : dependencies;
+    while (v && v->getNext ()) v = (vector *) v->getNext ();
+    for (; v != NULL; v = (vector *) v->getPrev ()) {
+      strlist * deps = v->getDependencies ();
+      std::map<std::string,int>::const_iterator it =
+	sizes.find (std::string (kind ? "V" : "D") + v->getName ());
+      int start = it != sizes.end () ? it->second : 0;
+      writeInt (f, kind);
+      writeString (f, v->getName ());
+      writeString (f, v->getOrigin ());
+      writeInt (f, deps ? deps->length () : -1);
+      for (int i = 0; deps && i < deps->length (); i++)
+	writeString (f, deps->get (i));
+      writeInt (f, start);
+      writeInt (f, v->getSize () - start);
+      for (int i = start; i < v->getSize (); i++) {
+	nr_complex_t c = v->get (i);
+	nr_double_t re = real (c), im = imag (c);
+	fwrite (&re, sizeof (nr_double_t), 1, f);
+	fwrite (&im, sizeof (nr_double_t), 1, f);
+      }
+    }
+  }
+}
+
+/* This function merges the data of a forked process into the dataset.
+   The analyses save their independent variables during their first
+   run only, thus these are taken over when they are not yet in the
+   dataset, except for the given swept variable.  All other vectors are
+   concatenated.  Returns non-zero on errors. */
+int dataset::mergeAdded (FILE * f, const char * sweep) {
+  int kind, ndeps, start, count;
+  std::string name, origin, dep;
+  bool nullorigin, null;
+
+  while (readInt (f, kind)) {
+    if (!readString (f, name, null) || !readString (f, origin, nullorigin))
+      return 1;
+    if (!readInt (f, ndeps)) return 1;
+    strlist * deps = ndeps >= 0 ? new strlist () : NULL;
+    for (int i = 0; i < ndeps; i++) {
+      if (!readString (f, dep, null)) { delete deps; return 1; }
+      deps->append (dep.c_str ());
+    }
+    if (!readInt (f, start) || !readInt (f, count)) { delete deps; return 1; }
+
+    // find the vector in the dataset or create a new one
+    vector * v = kind ? findVariable (name) : findDependency (name.c_str ());
+    bool skip = false;
+    if (v == NULL) {
+      v = new vector (name);
+      if (!nullorigin) v->setOrigin (origin.c_str ());
+      v->setDependencies (deps);
+      deps = NULL;
+      if (kind) addVariable (v); else addDependency (v);
     }
     else {
-      fprintf (f, "  %+." "20" "e%cj%." "20" "e\n", (double) real (c), 
-	       imag (c) >= 0.0 ? '+' : '-', (double) fabs (imag (c)));
+      skip = !kind && (sweep == NULL || name != sweep);
+      // merge dependencies assigned by the process
+      strlist * merged = NULL;
+      for (int i = 0; deps && i < deps->length (); i++) {
+	if (merged == NULL) merged = v->getDependencies () ?
+	  new strlist (*v->getDependencies ()) : new strlist ();
+	if (!merged->contains (deps->get (i)))
+	  merged->append (deps->get (i));
+      }
+      if (merged) v->setDependencies (merged);
+    }
+    delete deps;
+
+    // read the data items
+    for (int i = 0; i < count; i++) {
+      nr_double_t re, im;
+      if (fread (&re, sizeof (nr_double_t), 1, f) != 1 ||
+	  fread (&im, sizeof (nr_double_t), 1, f) != 1)
+	return 1;
+      if (!skip) v->add (nr_complex_t (re, im));
     }
   }
+  return 0;
+}
+
+/* This function prints the current dataset in the binary format into
+   the file specified by setFile().  If the file is the spool file of
+   a streaming dataset only the remaining values and the index get
+   appended, otherwise the spooled values are copied. */
+void dataset::printBinary (void) {
+  FILE * f;
+  spoolmap copy;
+  spoolmap & out = spoolout ? spools : copy;
+  vector * v, * vecs[2] = { dependencies, variables };
+
+  if (spoolout) {
+    f = spool;
+  }
+  else {
+    if (file == NULL) {
+      logprint (LOG_ERROR, "cannot print binary dataset without file\n");
+      return;
+    }
+    if ((f = fopen (file, "w+b")) == NULL) {
+      logprint (LOG_ERROR, "cannot create file `%s': %s\n",
+		file, strerror (errno));
+      return;
+    }
+    binWriteHeader (f, 0, binary > 1);
+  }
+
+  // write declarations and values in print order
+  for (int k = 0; k < 2; k++) {
+    for (v = vecs[k]; v != NULL; v = (vector *) v->getNext ()) {
+      spoolvector_t & s = declare (f, out, v);
+      if (!spoolout) {
+	auto it = spools.find (v);
+	if (it != spools.end ()) {
+	  fflush (spool);
+	  for (auto &c : it->second.chunks) {
+	    vector part (c.size);
+	    readValues (spool, c.offset, c.size, c.complex, &part, 0);
+	    writeData (f, s, &part);
+	  }
+	}
+	writeData (f, s, v);
+      }
+      else {
+	// the vector becomes part of the output file
+	writeData (f, s, v);
+	v->clear ();
+      }
+    }
+  }
+
+  // write index
+  fseek (f, 0, SEEK_END);
+  uint64_t index = ftell (f);
+  binWrite32 (f, BIN_INDEX);
+  binWrite32 (f, countDependencies () + countVariables ());
+  for (int k = 0; k < 2; k++) {
+    for (v = vecs[k]; v != NULL; v = (vector *) v->getNext ()) {
+      spoolvector_t & s = out[v];
+      binWrite32 (f, s.id);
+      binWrite64 (f, s.decl);
+      binWrite32 (f, s.chunks.size ());
+      for (auto &c : s.chunks) {
+	binWrite64 (f, c.offset);
+	binWrite32 (f, c.size);
+	binWrite32 (f, c.complex);
+      }
+    }
+  }
+
+  // finally make the index known
+  fseek (f, 0, SEEK_SET);
+  binWriteHeader (f, index, binary > 1);
+  if (spoolout)
+    fflush (f);
+  else
+    fclose (f);
 }
 
 /* This static function read a full dataset from the given file and
@@ -415,6 +1042,13 @@ dataset * dataset::load (const char * file) {
     logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
     return NULL;
   }
+  // binary datasets are recognized by their magic string
+  char magic[8];
+  if (fread (magic, 1, 8, f) == 8 && !memcmp (magic, DATASET_MAGIC, 8)) {
+    fclose (f);
+    return load_binary (file);
+  }
+  rewind (f);
   dataset_in = f;
   dataset_restart (dataset_in);
   if (dataset_parse () != 0) {
@@ -434,15 +1068,388 @@ dataset * dataset::load (const char * file) {
   return dataset_result;
 }
 
-/* This static function read a full dataset from the given touchstone
-   file and returns it.  On failure the function emits appropriate
+/* Bounds checked cursor over the contents of a binary dataset file.
+   Reads past the end set the failure flag, which is how partially
+   written files of a running analysis are detected. */
+struct bincursor {
+  const char * data;
+  size_t size, pos;
+  int fail;
+  bincursor (const char * d, size_t s, size_t p = 0)
+    : data (d), size (s), pos (p), fail (0) { }
+  int left (size_t n) {
+    if (fail || pos > size || size - pos < n) fail = 1;
+    return !fail;
+  }
+  uint32_t u32 (void) {
+    uint32_t n = 0;
+    if (left (sizeof (n))) { memcpy (&n, data + pos, sizeof (n)); pos += sizeof (n); }
+    return n;
+  }
+  uint64_t u64 (void) {
+    uint64_t n = 0;
+    if (left (sizeof (n))) { memcpy (&n, data + pos, sizeof (n)); pos += sizeof (n); }
+    return n;
+  }
+  std::string str (void) {
+    uint32_t len = u32 ();
+    if (!left (len)) return std::string ();
+    std::string s (data + pos, len);
+    pos += len;
+    return s;
+  }
+};
+
+// Description of a vector found in a binary dataset file.
+struct binvector {
+  std::string name;
+  strlist * deps;
+  int kind;
+  // positions, counts and flags of the data records
+  std::vector<std::pair<size_t,std::pair<int,int> > > chunks;
+};
+
+// Parses a declaration record at the cursor position.
+static int binReadDecl (bincursor & c, uint32_t & id, binvector & b) {
+  if (c.u32 () != BIN_DECL) return -1;
+  id = c.u32 ();
+  b.kind = c.u32 ();
+  b.name = c.str ();
+  uint32_t n = c.u32 ();
+  b.deps = NULL;
+  for (uint32_t i = 0; i < n && !c.fail; i++) {
+    std::string dep = c.str ();
+    if (c.fail) break;
+    if (b.deps == NULL) b.deps = new strlist ();
+    b.deps->append (dep.c_str ());
+  }
+  if (c.fail) {
+    delete b.deps;
+    b.deps = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+/* Collects the vectors of the given binary dataset file contents.  If
+   the file has an index the vectors are taken from there, otherwise
+   the records are scanned up to the first incomplete one. */
+static int binReadVectors (const char * data, size_t size,
+			   std::vector<binvector> & vecs) {
+  bincursor c (data, size, 8);
+  uint32_t version = c.u32 ();
+  if (version < 1 || version > DATASET_VERSION) return -1;
+  c.u32 ();
+  uint64_t index = c.u64 ();
+  if (c.fail) return -1;
+
+  if (index != 0) {
+    c.pos = index;
+    if (c.u32 () != BIN_INDEX) return -1;
+    uint32_t n = c.u32 ();
+    for (uint32_t i = 0; i < n && !c.fail; i++) {
+      binvector b;
+      uint32_t id, nid;
+      id = c.u32 ();
+      bincursor d (data, size, c.u64 ());
+      if (binReadDecl (d, nid, b) != 0) return -1;
+      if (nid != id) { delete b.deps; return -1; }
+      vecs.push_back (b);
+      uint32_t nchunks = c.u32 ();
+      for (uint32_t k = 0; k < nchunks && !c.fail; k++) {
+	size_t pos = c.u64 ();
+	int count = c.u32 ();
+	int cplx = c.u32 ();
+	vecs.back().chunks.push_back (std::make_pair (pos,
+				      std::make_pair (count, cplx)));
+      }
+    }
+    return c.fail ? -1 : 0;
+  }
+
+  std::map<uint32_t,size_t> ids;
+  while (c.pos < size) {
+    size_t start = c.pos;
+    uint32_t tag = c.u32 (), id, n;
+    bincursor d (data, size, start);
+    binvector b;
+    switch (tag) {
+    case BIN_DECL:
+      if (binReadDecl (d, id, b) != 0) return 0;
+      c.pos = d.pos;
+      ids[id] = vecs.size ();
+      vecs.push_back (b);
+      break;
+    case BIN_DATA:
+      {
+	id = c.u32 ();
+	int count = c.u32 ();
+	int cplx = c.u32 ();
+	size_t pos = c.pos;
+	if (!c.left (sizeof (double) * (cplx ? 2 : 1) * count)) return 0;
+	c.pos += sizeof (double) * (cplx ? 2 : 1) * count;
+	auto it = ids.find (id);
+	if (it == ids.end ()) return -1;
+	vecs[it->second].chunks.push_back (std::make_pair (pos,
+					   std::make_pair (count, cplx)));
+      }
+      break;
+    case BIN_PACKED:
+      {
+	id = c.u32 ();
+	int count = c.u32 ();
+	int flags = c.u32 ();
+	uint32_t bytes = c.u32 ();
+	size_t pos = c.pos;
+	if (!c.left (bytes)) return 0;
+	c.pos += bytes;
+	auto it = ids.find (id);
+	if (it == ids.end ()) return -1;
+	vecs[it->second].chunks.push_back (std::make_pair (pos,
+					   std::make_pair (count, flags)));
+      }
+      break;
+    case BIN_INDEX:
+      // skip outdated index of a file still being written
+      n = c.u32 ();
+      for (uint32_t i = 0; i < n && !c.fail; i++) {
+	c.u32 (); c.u64 ();
+	uint32_t nchunks = c.u32 ();
+	if (c.left (16 * (size_t) nchunks)) c.pos += 16 * (size_t) nchunks;
+      }
+      if (c.fail) return 0;
+      break;
+    default:
+      return c.fail ? 0 : -1;
+    }
+  }
+  return 0;
+}
+
+/* This static function reads a full dataset from the given binary
+   dataset file and returns it.  The file gets memory mapped if
+   possible, so the values are copied straight into the vectors
+   without any parsing.  On failure the function emits appropriate
    error messages and returns NULL. */
+dataset * dataset::load_binary (const char * file) {
+  FILE * f;
+  if ((f = fopen (file, "rb")) == NULL) {
+    logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
+    return NULL;
+  }
+  fseek (f, 0, SEEK_END);
+  long size = ftell (f);
+  char * data = NULL;
+  int mapped = 0;
+  if (size < BIN_HEADER) {
+    logprint (LOG_ERROR, "error loading `%s': truncated file\n", file);
+    fclose (f);
+    return NULL;
+  }
+#if HAVE_MMAP
+  void * m = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fileno (f), 0);
+  if (m != MAP_FAILED) {
+    data = (char *) m;
+    mapped = 1;
+  }
+#endif
+  if (!mapped) {
+    data = (char *) malloc (size);
+    fseek (f, 0, SEEK_SET);
+    if (fread (data, 1, size, f) != (size_t) size) {
+      logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
+      free (data);
+      fclose (f);
+      return NULL;
+    }
+  }
+  fclose (f);
+
+  std::vector<binvector> vecs;
+  dataset * data_set = NULL;
+  if (memcmp (data, DATASET_MAGIC, 8) != 0 ||
+      binReadVectors (data, size, vecs) != 0) {
+    logprint (LOG_ERROR, "error loading `%s': invalid binary dataset\n",
+	      file);
+    for (auto &b : vecs) delete b.deps;
+  }
+  else {
+    data_set = new dataset ();
+    for (auto &b : vecs) {
+      int n = 0, i = 0;
+      for (auto &c : b.chunks) n += c.second.first;
+      vector * v = new vector (b.name, n);
+      for (auto &c : b.chunks) {
+	if (copyValues (data + c.first, data + size, c.second.first,
+			c.second.second, v, i) != 0)
+	  logprint (LOG_ERROR, "error loading `%s': truncated data of `%s'\n",
+		    file, b.name.c_str ());
+	i += c.second.first;
+      }
+      if (b.kind == 0) {
+	delete b.deps;
+	v->setRequested (n);
+	data_set->appendDependency (v);
+      }
+      else {
+	v->setDependencies (b.deps);
+	data_set->appendVariable (v);
+      }
+    }
+  }
+
+#if HAVE_MMAP
+  if (mapped) munmap (data, size);
+#endif
+  if (!mapped) free (data);
+
+  if (data_set != NULL && dataset_check (data_set) != 0) {
+    delete data_set;
+    return NULL;
+  }
+  if (data_set) data_set->setFile (file);
+  return data_set;
+}
+
+// Returns non-zero if the given file is a binary dataset.
+int dataset::isBinaryFile (const char * file) {
+  FILE * f;
+  char magic[8];
+  if ((f = fopen (file, "rb")) == NULL) return 0;
+  int binary = fread (magic, 1, 8, f) == 8 && !memcmp (magic, DATASET_MAGIC, 8);
+  fclose (f);
+  return binary;
+}
+
+/* This static function opens the given dataset file.  Of a binary
+   dataset only the directory of vectors and the dependencies are read,
+   the values of a variable are read on its first access by
+   findVariable() or fetch().  The file gets memory mapped for this
+   purpose and must not be truncated meanwhile.  Other files are read
+   in full.  On failure the function returns NULL. */
+dataset * dataset::open (const char * file) {
+#if HAVE_MMAP
+  if (!isBinaryFile (file))
+    return load (file);
+  FILE * f;
+  if ((f = fopen (file, "rb")) == NULL) {
+    logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
+    return NULL;
+  }
+  fseek (f, 0, SEEK_END);
+  long size = ftell (f);
+  void * m = MAP_FAILED;
+  if (size >= BIN_HEADER)
+    m = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fileno (f), 0);
+  fclose (f);
+  if (m == MAP_FAILED)
+    return load_binary (file);
+
+  std::vector<binvector> vecs;
+  if (binReadVectors ((const char *) m, size, vecs) != 0) {
+    logprint (LOG_ERROR, "error loading `%s': invalid binary dataset\n",
+	      file);
+    for (auto &b : vecs) delete b.deps;
+    munmap (m, size);
+    return NULL;
+  }
+  dataset * data_set = new dataset ();
+  data_set->mapping = (char *) m;
+  data_set->mapsize = size;
+  for (auto &b : vecs) {
+    vector * v = new vector (b.name);
+    std::vector<spoolchunk_t> & chunks = data_set->lazy[v];
+    int n = 0;
+    for (auto &c : b.chunks) {
+      spoolchunk_t s = { (long) c.first, c.second.first, c.second.second };
+      chunks.push_back (s);
+      n += s.size;
+    }
+    if (b.kind == 0) {
+      // the dependencies are needed by any variable
+      delete b.deps;
+      v->setRequested (n);
+      data_set->appendDependency (v);
+      data_set->fetch (v);
+    }
+    else {
+      v->setDependencies (b.deps);
+      data_set->appendVariable (v);
+    }
+  }
+  if (dataset_check (data_set) != 0) {
+    delete data_set;
+    return NULL;
+  }
+  data_set->setFile (file);
+  return data_set;
+#else
+  return load (file);
+#endif
+}
+
+/* Reads the values of the given vector from the file of an opened
+   dataset if not yet done.  Returns the vector. */
+vector * dataset::fetch (vector * v) {
+  auto it = lazy.find (v);
+  if (it == lazy.end ()) return v;
+  vector all (countValues (v));
+  int n = 0;
+  for (auto &c : it->second) {
+    if (copyValues (mapping + c.offset, mapping + mapsize, c.size, c.complex,
+		    &all, n) != 0)
+      logprint (LOG_ERROR, "error loading `%s': truncated data of `%s'\n",
+		file, v->getName ());
+    n += c.size;
+  }
+  *v = std::move (all);
+  lazy.erase (it);
+  return v;
+}
+
+// Reads all vectors of an opened dataset not yet read.
+void dataset::fetchAll (void) {
+  while (!lazy.empty ()) fetch (lazy.begin()->first);
+}
+
+/* Reads the contents of the given opened file and hands them to the
+   given fast reader.  Returns its status, zero on success, -1 on errors
+   and 1 if the file is left to the parser, which is the status if the
+   file cannot be read at once.  The file is rewound for the parser. */
+static int dataset_read (FILE * f, int (* reader) (const char *, long)) {
+  int status = 1;
+  fseek (f, 0, SEEK_END);
+  long size = ftell (f);
+  if (size >= 0) {
+    char * data = (char *) malloc (size + 1);
+    fseek (f, 0, SEEK_SET);
+    size = fread (data, 1, size, f);
+    status = reader (data, size);
+    free (data);
+  }
+  rewind (f);
+  return status;
+}
+
+/* This static function read a full dataset from the given touchstone
+   file and returns it.  Touchstone 1.x and 2.0 files are supported.
+   On failure the function emits appropriate error messages and
+   returns NULL. */
 dataset * dataset::load_touchstone (const char * file) {
   FILE * f;
   if ((f = fopen (file, "r")) == NULL) {
     logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
     return NULL;
   }
+  /* try the fast reader on the file contents first, the parser and
+     checker are left for the files it does not understand */
+  int status = dataset_read (f, touchstone_read);
+  if (status <= 0) {
+    fclose (f);
+    if (status < 0) return NULL;
+    touchstone_result->setFile (file);
+    return touchstone_result;
+  }
   touchstone_in = f;
   touchstone_restart (touchstone_in);
   if (touchstone_parse () != 0) {
@@ -468,6 +1475,13 @@ dataset * dataset::load_csv (const char * file) {
     logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
     return NULL;
   }
+  int status = dataset_read (f, csv_read);
+  if (status <= 0) {
+    fclose (f);
+    if (status < 0) return NULL;
+    csv_result->setFile (file);
+    return csv_result;
+  }
   csv_in = f;
   csv_restart (csv_in);
   if (csv_parse () != 0) {
@@ -493,6 +1507,13 @@ dataset * dataset::load_citi (const char * file) {
     logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
     return NULL;
   }
+  int status = dataset_read (f, citi_read);
+  if (status <= 0) {
+    fclose (f);
+    if (status < 0) return NULL;
+    citi_result->setFile (file);
+    return citi_result;
+  }
   citi_in = f;
   citi_restart (citi_in);
   if (citi_parse () != 0) {
@@ -518,6 +1539,13 @@ dataset * dataset::load_zvr (const char * file) {
     logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
     return NULL;
   }
+  int status = dataset_read (f, zvr_read);
+  if (status <= 0) {
+    fclose (f);
+    if (status < 0) return NULL;
+    if (zvr_result) zvr_result->setFile (file);
+    return zvr_result;
+  }
   zvr_in = f;
   zvr_restart (zvr_in);
   if (zvr_parse () != 0) {
@@ -543,6 +1571,13 @@ dataset * dataset::load_mdl (const char * file) {
     logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
     return NULL;
   }
+  int status = dataset_read (f, mdl_read);
+  if (status <= 0) {
+    fclose (f);
+    if (status < 0) return NULL;
+    if (mdl_result) mdl_result->setFile (file);
+    return mdl_result;
+  }
   mdl_in = f;
   mdl_restart (mdl_in);
   if (mdl_parse () != 0) {
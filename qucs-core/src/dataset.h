@@ -25,8 +25,23 @@
 #ifndef __DATASET_H__
 #define __DATASET_H__
 
+#include <stdio.h>
+#include <map>
+#include <vector>
+#include <utility>
+
 #include "object.h"
 
+// number of values spooled at once by a streaming dataset
+#define DATASET_CHUNK 65536
+
+// bytes of text output collected before being written
+#define DATASET_TEXTBUF 65536
+
+// binary dataset file identification and newest version
+#define DATASET_MAGIC   "QucsData"
+#define DATASET_VERSION 2
+
 namespace qucs {
 
 class vector;
@@ -70,12 +85,63 @@ class dataset : public object
   static dataset * load_citi (const char *);
   static dataset * load_zvr (const char *);
   static dataset * load_mdl (const char *);
+  static dataset * load_binary (const char *);
+  static dataset * open (const char *);
+  static int isBinaryFile (const char *);
+  qucs::vector * fetch (qucs::vector *);
+  void fetchAll (void);
 
   int countDependencies (void);
   int countVariables (void);
+  int countValues (qucs::vector *);
+
+  void setStreaming (int);
+  int isStreaming (void) { return chunk > 0; }
+  // zero for text, 1 for binary and 2 for packed binary output
+  void setBinary (int b) { binary = b; }
+  int isBinary (void) { return binary; }
+  // significant digits of text output, zero for the shortest exact ones
+  void setPrecision (int d) { digits = d; }
+  int getPrecision (void) { return digits; }
+  void flush (void);
+  void restore (void);
+  std::map<std::string,int> getSizes (void);
+  void writeAdded (FILE *, const std::map<std::string,int> &);
+  int mergeAdded (FILE *, const char * sweep = NULL);
+
+ private:
+  struct spoolchunk_t {
+    long offset;  // position of the values in the file
+    int size;     // number of values
+    int complex;  // non-zero if values have imaginary parts
+  };
+  struct spoolvector_t {
+    int id;       // vector identifier within the file
+    long decl;    // position of the vector declaration
+    std::vector<spoolchunk_t> chunks;
+  };
+  typedef std::map<qucs::vector *, spoolvector_t> spoolmap;
+
+  FILE * openSpool (void);
+  void spill (qucs::vector *);
+  int spooled (qucs::vector *);
+  void printSpooled (qucs::vector *, FILE *);
+  void forget (qucs::vector *);
+  void printBinary (void);
+  spoolvector_t & declare (FILE *, spoolmap &, qucs::vector *);
+  void writeData (FILE *, spoolvector_t &, qucs::vector *);
 
  private:
   char * file;
+  int binary;
+  int digits;
+  int chunk;
+  FILE * spool;
+  int spoolout;
+  spoolmap spools;
+  std::map<qucs::vector *, std::vector<spoolchunk_t> > lazy;
+  char * mapping;
+  long mapsize;
   qucs::vector * dependencies;
   qucs::vector * variables;
 };
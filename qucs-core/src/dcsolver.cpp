@@ -27,6 +27,10 @@
 #endif
 
 #include <stdio.h>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <vector>
 
 #include "object.h"
 #include "complex.h"
@@ -36,12 +40,21 @@
 #include "analysis.h"
 #include "nasolver.h"
 #include "dcsolver.h"
+#include "reducer.h"
+#include "environment.h"
+#include "trace.h"
+#include "numstatus.h"
+#include "opcache.h"
 
 namespace qucs {
 
 // Constructor creates an unnamed instance of the dcsolver class.
 dcsolver::dcsolver () : nasolver<nr_double_t> () {
   saveOPs = 0;
+  useWarm = 1;
+  warmCount = warmSwept = 0;
+  swept = false;
+  point = 0;
   type = ANALYSIS_DC;
   setDescription ("DC");
 }
@@ -49,6 +62,10 @@ dcsolver::dcsolver () : nasolver<nr_double_t> () {
 // Constructor creates a named instance of the dcsolver class.
 dcsolver::dcsolver (char * n) : nasolver<nr_double_t> (n) {
   saveOPs = 0;
+  useWarm = 1;
+  warmCount = warmSwept = 0;
+  swept = false;
+  point = 0;
   type = ANALYSIS_DC;
   setDescription ("DC");
 }
@@ -61,14 +78,41 @@ dcsolver::~dcsolver () {
    based on the given dcsolver object. */
 dcsolver::dcsolver (dcsolver & o) : nasolver<nr_double_t> (o) {
   saveOPs = o.saveOPs;
+  useWarm = o.useWarm;
+  warmCount = warmSwept = 0;
+  swept = false;
+  point = 0;
 }
 
 /* This is the DC netlist solver.  It prepares the circuit list and
    solves it then. */
 int dcsolver::solve (void) {
+  // replace large linear subcircuits by reduced models
+  reducer mor (subnet, getName ());
+  if (!strcmp (getPropertyString ("Reduce"), "yes")) mor.reduce ();
+
+  prepare ();
+  int error = converge ();
+
+  // save results and cleanup the solver
+  savePoint ();
+
+  // derivatives of the requested outputs with respect to all parameters
+  const char * const sens = getPropertyString ("Sensitivity");
+  if (!error && sens != NULL && *sens != '\0')
+    saveSensitivities (sens, "V", "I", &initCircuit, &calcCircuit, true);
+
+  solve_post ();
+  return 0;
+}
+
+/* Fetches the simulation properties, initializes the circuits and
+   sets up the solver. */
+void dcsolver::prepare (void) {
   // fetch simulation properties
   saveOPs |= !strcmp (getPropertyString ("saveOPs"), "yes") ? SAVE_OPS : 0;
   saveOPs |= !strcmp (getPropertyString ("saveAll"), "yes") ? SAVE_ALL : 0;
+  useWarm = !strcmp (getPropertyString ("WarmStart"), "yes");
   const char * const solver = getPropertyString ("Solver");
 
   // initialize node voltages, first guess for non-linear circuits and
@@ -76,9 +120,6 @@ int dcsolver::solve (void) {
   init ();
   setCalculation ((calculate_func_t) &calc);
 
-  // start the iterative solver
-  solve_pre ();
-
   // choose a solver
   if (!strcmp (solver, "CroutLU"))
     eqnAlgo = ALGO_LU_DECOMPOSITION_CROUT;
@@ -90,7 +131,20 @@ int dcsolver::solve (void) {
     eqnAlgo = ALGO_QR_DECOMPOSITION_LS;
   else if (!strcmp (solver, "GolubSVD"))
     eqnAlgo = ALGO_SV_DECOMPOSITION;
+  else if (!strcmp (solver, "SparseLU"))
+    eqnAlgo = ALGO_LU_DECOMPOSITION_SPARSE;
+  else if (!strcmp (solver, "BiCGStab"))
+    eqnAlgo = ALGO_BICGSTAB;
+  else if (!strcmp (solver, "GMRES"))
+    eqnAlgo = ALGO_GMRES;
+
+  // start the iterative solver
+  solve_pre ();
+}
 
+/* Runs the solver until convergence, using the fallbacks if
+   necessary.  Returns non-zero if there is no solution. */
+int dcsolver::converge (void) {
   // local variables for the fallback thingies
   int retry = -1, error, fallback = 0, preferred;
   int helpers[] = {
@@ -117,15 +171,25 @@ int dcsolver::solve (void) {
   }
   preferred = convHelper;
 
+  // start at the operating point solved by another analysis in the
+  // same state, else at the previous solutions if there are any
+  const nasolution<nr_double_t> * op = opcache::find ();
+  int warm = warmStart ();
+
   if (!subnet->isNonLinear ()) {
-    // Start the linear solver.
+    // Start the linear solver, the points of a sweep differing in a
+    // few linear circuits are solved by updating a previous one.
     convHelper = CONV_None;
+    lowRank = swept;
     error = solve_linear ();
+    lowRank = 0;
   }
   else do {
     // Run the DC solver once.
     try_running () {
       applyNodeset ();
+      if (op != NULL) applySolution (*op);
+      else if (warm) applyWarmStart (warm);
       error = solve_nonlinear ();
 #if DEBUG
       if (!error) {
@@ -134,12 +198,31 @@ int dcsolver::solve (void) {
 		  getName (), iterations);
       }
 #endif /* DEBUG */
-      if (!error) retry = -1;
+      if (!error) {
+	retry = -1;
+	storeWarmStart ();
+	opcache::store (solution);
+      }
     }
     // Appropriate exception handling.
     catch_exception () {
     case EXCEPTION_NO_CONVERGENCE:
       pop_exception ();
+      // retry without the cached operating point, at the last solution
+      // without prediction, then without previous solutions before
+      // using the fallbacks
+      if (op != NULL) {
+	op = NULL;
+	retry++;
+	restart ();
+	break;
+      }
+      if (warm) {
+	warm--;
+	retry++;
+	restart ();
+	break;
+      }
       if (preferred == helpers[fallback] && preferred) fallback++;
       convHelper = helpers[fallback++];
       if (convHelper != -1) {
@@ -160,22 +243,285 @@ int dcsolver::solve (void) {
       break;
     }
   } while (retry != -1);
+  swept = false;
+  return error;
+}
 
-  // save results and cleanup the solver
+// Saves the operating points and the results of the solution.
+void dcsolver::savePoint (void) {
   saveOperatingPoints ();
   saveResults ("V", "I", saveOPs);
+}
+
+/* Sets the given parameter of the netlist and solves the equations. */
+void dcsolver::setParameter (const char * param, nr_double_t v) {
+  env->setDoubleConstant (param, v);
+  env->setDouble (param, v);
+  env->runSolver ();
+}
+
+/* The function traces the solution curve of the circuit over the
+   given parameter range by pseudo-arclength continuation, such that
+   turning points of the curve, e.g. of hysteresis, are passed.  The
+   parameter is scaled to the unit range.  Each step predicts the next
+   point along the tangent of the curve and corrects it by Newton
+   iterations on the equations bordered by the arclength condition
+
+     t' (x - xp) + tp (p - pp) = 0.
+
+   The Jacobian is factorized once per correction and kept as long as
+   the iterations contract well, also for the next step.  Its
+   factorization gives the derivative of the solution with respect to
+   the parameter as well, thus the tangent comes at no cost.  Steps
+   are halved on failures and double again up to the initial one
+   after fast corrections.  The last step ends at the stop value.
+   Every point is saved, then the given function is run.  Returns
+   non-zero on errors. */
+int dcsolver::solveArclength (const char * param, nr_double_t start,
+			      nr_double_t stop, int points,
+			      std::function<void (void)> saved) {
+  reducer mor (subnet, getName ());
+  if (!strcmp (getPropertyString ("Reduce"), "yes")) mor.reduce ();
+
+  // the first point is solved like a single one, using the fallbacks
+  setParameter (param, start);
+  prepare ();
+  int error = converge ();
+  savePoint ();
+  saved ();
+  if (error) {
+    solve_post ();
+    return error;
+  }
+
+  int i, N = countNodes (), n = N + countVoltageSources ();
+  nr_double_t span = stop - start;
+  nr_double_t rtol = getPropertyDouble ("reltol");
+  nr_double_t atol = getPropertyDouble ("abstol");
+  nr_double_t vtol = getPropertyDouble ("vntol");
+  std::vector<nr_double_t> X (n), Z (n), T (n), Tp (n), Xp (n), Fp (n);
+  tvector<nr_double_t> F (n), Fd (n), xa (n), za (n);
+  tmatrix<nr_double_t> J (n), R (n, 2), S (n, 2);
+  eqnsys<nr_double_t> lu;
+  lu.setAlgo (ALGO_LU_DECOMPOSITION);
+  for (i = 0; i < n; i++) X[i] = x->get (i);
+
+  // evaluates the residual at the given solution and scaled parameter
+  auto evaluateAt = [&] (std::vector<nr_double_t> & y, nr_double_t p,
+			 tvector<nr_double_t> & res) {
+    setParameter (param, start + p * span);
+    for (i = 0; i < n; i++) x->set (i, y[i]);
+    reinitialize (&initCircuit);
+    calculate ();
+    stampResidual (res);
+  };
+
+  // factorizes the Jacobian and keeps the derivative of the residual
+  // with respect to the parameter, returns false if it is singular
+  auto factorize = [&] (std::vector<nr_double_t> & y, nr_double_t p) {
+    evaluateAt (y, p + DC_ARC_DELTA, Fd);
+    evaluateAt (y, p, F);
+    stampMatrix (J);
+    for (i = 0; i < n; i++) Fp[i] = (Fd.get (i) - F.get (i)) / DC_ARC_DELTA;
+    lu.passEquationSys (&J, &xa, &za);
+    int mark = numstatus::mark ();
+    lu.factorize ();
+    if (!numstatus::raised (mark)) return true;
+    numstatus::release (mark);
+    return false;
+  };
+
+  // solves for the Newton update (column 0) and the derivative of the
+  // solution with respect to the parameter (column 1, negated)
+  auto substitute = [&] (void) {
+    for (i = 0; i < n; i++) {
+      R (i, 0) = -F.get (i);
+      R (i, 1) = Fp[i];
+    }
+    lu.solveMany (&R, &S);
+  };
+
+  // normalized tangent from the last substitution, oriented along the
+  // previous one
+  nr_double_t p = 0, tp = 1;
+  auto tangent = [&] (void) {
+    nr_double_t norm = 1, dot = tp;
+    for (i = 0; i < n; i++) norm += S (i, 1) * S (i, 1);
+    norm = std::sqrt (norm);
+    for (i = 0; i < n; i++) dot -= T[i] * S (i, 1);
+    nr_double_t sign = dot < 0 ? -1 : 1;
+    for (i = 0; i < n; i++) T[i] = -sign * S (i, 1) / norm;
+    tp = sign / norm;
+  };
+
+  if (!factorize (X, p)) {
+    logprint (LOG_ERROR, "WARNING: %s: singular Jacobian at %s = %g, no "
+	      "continuation\n", getName (), param, start);
+    solve_post ();
+    return 1;
+  }
+  substitute ();
+  tangent ();
+
+  nr_double_t h0 = 1.0 / (points - 1), h = h0;
+  bool last = false, refactor = false;
+  for (int steps = 0; !last && steps < DC_ARC_STEPS * points; steps++) {
+    // predict along the tangent, a step leaving the range ends at its
+    // border with the parameter being fixed there
+    nr_double_t s = h, pp = p + h * tp, tpp = tp;
+    Tp = T;
+    if ((pp >= 1 && tp > 0) || (pp <= 0 && tp < 0)) {
+      pp = tp > 0 ? 1 : 0;
+      s = (pp - p) / tp;
+      std::fill (Tp.begin (), Tp.end (), 0.0);
+      tpp = 1;
+      last = true;
+    }
+    for (i = 0; i < n; i++) Xp[i] = X[i] + s * T[i];
+
+    // correct by Newton iterations
+    Z = Xp;
+    nr_double_t q = pp, prev = 0;
+    int it, converged = 0;
+    for (it = 0; it < DC_ARC_ITERATIONS && !converged; it++) {
+      if (refactor) {
+	if (!factorize (Z, q)) break;
+      }
+      else evaluateAt (Z, q, F);
+      substitute ();
+
+      // the update of the parameter fulfilling the arclength condition
+      nr_double_t g = tpp * (q - pp), td = 0, ty = 0;
+      for (i = 0; i < n; i++) {
+	g += Tp[i] * (Z[i] - Xp[i]);
+	td += Tp[i] * S (i, 0);
+	ty += Tp[i] * S (i, 1);
+      }
+      nr_double_t dq = -(g + td) / (tpp - ty), norm = 0;
+      converged = std::fabs (dq) <= rtol * h;
+      for (i = 0; i < n; i++) {
+	nr_double_t dz = S (i, 0) - S (i, 1) * dq;
+	Z[i] += dz;
+	norm += dz * dz;
+	if (std::fabs (dz) > rtol * std::fabs (Z[i]) + (i < N ? vtol : atol))
+	  converged = 0;
+      }
+      q += dq;
+      if (!std::isfinite (norm)) break;
+
+      // keep the factorization if the iterations contract well
+      refactor = it > 0 && norm > 0.25 * prev;
+      prev = norm;
+    }
+
+    if (!converged) {
+      // retry with a shorter step at a newly factorized Jacobian
+      last = false;
+      refactor = true;
+      h /= 2;
+      if (h < h0 * DC_ARC_MINSTEP) {
+	logprint (LOG_ERROR, "WARNING: %s: arclength continuation failed "
+		  "at %s = %g\n", getName (), param, start + p * span);
+	error++;
+	break;
+      }
+      continue;
+    }
+
+    // accept the point and save it, then find the next tangent
+    X = Z;
+    p = q;
+    evaluateAt (X, p, F);
+    savePoint ();
+    saved ();
+    tangent ();
+    if (it <= 3) h = std::min (2 * h, h0);
+    refactor = it > 3;
+  }
+  if (!last && !error) {
+    logprint (LOG_ERROR, "WARNING: %s: arclength continuation stopped after "
+	      "%d steps at %s = %g\n", getName (), DC_ARC_STEPS * points,
+	      param, start + p * span);
+    error++;
+  }
 
   solve_post ();
-  return 0;
+  return error;
+}
+
+/* Remembers the value of the swept parameter for the next solution
+   in a parameter sweep. */
+void dcsolver::setSweepPoint (nr_double_t v) {
+  swept = true;
+  point = v;
+}
+
+/* Forgets the solutions of the previous points, the next one starts
+   at the nodesets and factorizes its equation system anew. */
+void dcsolver::resetSweep (void) {
+  warmCount = warmSwept = 0;
+  clearLowRank ();
+}
+
+/* Returns how to start the non-linear solver: 2 at the solution
+   predicted from the last two points of the sweep, 1 at the last
+   solution and 0 at the nodesets only. */
+int dcsolver::warmStart (void) {
+  if (!useWarm || warmCount < 1) return 0;
+  if (swept && warmSwept >= 2 && warmAt[0] != warmAt[1]) {
+    // extrapolate only further into the direction of the sweep
+    nr_double_t t = (point - warmAt[0]) / (warmAt[0] - warmAt[1]);
+    if (t > 0 && t <= 2) return 2;
+  }
+  return 1;
+}
+
+/* Applies the last solution, or the solution extrapolated linearly
+   from the last two points of the sweep, as starting values. */
+void dcsolver::applyWarmStart (int mode) {
+  nasolution<nr_double_t> start = warm[0];
+  if (mode > 1) {
+    nr_double_t t = (point - warmAt[0]) / (warmAt[0] - warmAt[1]);
+    for (auto & e : start) {
+      auto p = warm[1].find (e.first);
+      if (p != warm[1].end () && p->second.current == e.second.current)
+	e.second.value += t * (e.second.value - p->second.value);
+    }
+  }
+  applySolution (start);
+#if DEBUG
+  logprint (LOG_STATUS, "NOTIFY: %s: starting at the %s solution\n",
+	    getName (), mode > 1 ? "predicted" : "previous");
+#endif
+}
+
+/* Keeps the converged solution as starting values of the next
+   one. */
+void dcsolver::storeWarmStart (void) {
+  warm[1] = warm[0];
+  warmAt[1] = warmAt[0];
+  storeSolution ();
+  warm[0] = solution;
+  warmAt[0] = point;
+  if (warmCount < 2) warmCount++;
+  warmSwept = swept ? std::min (warmSwept + 1, 2) : 0;
 }
 
 /* Goes through the list of circuit objects and runs its calcDC()
    function. */
 void dcsolver::calc (dcsolver * self) {
-  circuit * root = self->getNet()->getRoot ();
-  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
-    c->calcDC ();
-  }
+  TRACE_SCOPE ("circuit::calcDC");
+  self->evaluate (&calcCircuit);
+}
+
+// Runs the calcDC() function of a single circuit object.
+void dcsolver::calcCircuit (circuit * c, nasolver<nr_double_t> *) {
+  c->calcDC ();
+}
+
+// Runs the initDC() function of a single circuit object.
+void dcsolver::initCircuit (circuit * c, nasolver<nr_double_t> *) {
+  c->initDC ();
 }
 
 /* Goes through the list of circuit objects and runs its initDC()
@@ -183,6 +529,7 @@ void dcsolver::calc (dcsolver * self) {
 void dcsolver::init (void) {
   circuit * root = subnet->getRoot ();
   for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    c->setRealMNA (true);
     c->initDC ();
   }
 }
@@ -192,7 +539,10 @@ void dcsolver::init (void) {
 void dcsolver::restart (void) {
   circuit * root = subnet->getRoot ();
   for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
-    if (c->isNonLinear ()) c->restartDC ();
+    if (c->isNonLinear ()) {
+      c->restartDC ();
+      c->resetBypass ();
+    }
   }
 }
 
@@ -220,6 +570,14 @@ PROP_OPT [] = {
     PROP_RNG_STR6 ("none", "SourceStepping", "gMinStepping",
 		   "LineSearch", "Attenuation", "SteepestDescent") },
   { "Solver", PROP_STR, { PROP_NO_VAL, "CroutLU" }, PROP_RNG_SOL },
+  { "Bypass", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+  { "Newton", PROP_STR, { PROP_NO_VAL, "full" },
+    PROP_RNG_STR3 ("full", "chord", "Broyden") },
+  { "Threads", PROP_INT, { 1, PROP_NO_STR }, PROP_RNGII (0, 256) },
+  { "WarmStart", PROP_STR, { PROP_NO_VAL, "yes" }, PROP_RNG_YESNO },
+  { "Reduce", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+  { "Sensitivity", PROP_STR, { PROP_NO_VAL, "" }, PROP_NO_RANGE },
+  { "Save", PROP_STR, { PROP_NO_VAL, "" }, PROP_NO_RANGE },
   PROP_NO_PROP };
 struct define_t dcsolver::anadef =
   { "DC", 0, PROP_ACTION, PROP_NO_SUBSTRATE, PROP_LINEAR, PROP_DEF };
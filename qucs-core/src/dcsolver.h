@@ -25,8 +25,22 @@
 #ifndef __DCSOLVER_H__
 #define __DCSOLVER_H__
 
+#include <functional>
+
 #include "nasolver.h"
 
+// maximum number of Newton iterations correcting a continuation step
+#define DC_ARC_ITERATIONS 8
+
+// change of the scaled parameter for the derivative of the residual
+#define DC_ARC_DELTA      1e-7
+
+// smallest continuation step relative to the initial one
+#define DC_ARC_MINSTEP    1e-6
+
+// maximum number of continuation steps per sweep point
+#define DC_ARC_STEPS      50
+
 namespace qucs {
 
 class dcsolver : public nasolver<nr_double_t>
@@ -38,12 +52,35 @@ class dcsolver : public nasolver<nr_double_t>
   ~dcsolver ();
   int  solve (void);
   static void calc (dcsolver *);
+  static void calcCircuit (circuit *, nasolver<nr_double_t> *);
+  static void initCircuit (circuit *, nasolver<nr_double_t> *);
   void init (void);
   void restart (void);
   void saveOperatingPoints (void);
 
+  void setSweepPoint (nr_double_t);
+  void resetSweep (void);
+  int  solveArclength (const char *, nr_double_t, nr_double_t, int,
+		       std::function<void (void)>);
+
+ private:
+  void prepare (void);
+  int  converge (void);
+  void savePoint (void);
+  void setParameter (const char *, nr_double_t);
+  int  warmStart (void);
+  void applyWarmStart (int);
+  void storeWarmStart (void);
+
  private:
   int saveOPs;
+  // starting values taken from the previous solutions
+  int useWarm;
+  nasolution<nr_double_t> warm[2];
+  nr_double_t warmAt[2];
+  int warmCount, warmSwept;
+  bool swept;
+  nr_double_t point;
 };
 
 } // namespace qucs
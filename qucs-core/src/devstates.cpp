@@ -44,8 +44,9 @@ devstates::devstates () {
 }
 
 // Constructor for device state class instance.
-devstates::devstates (int vars, int states) {
-  deviceStates (vars, states);
+devstates::devstates (int vars, int stats) {
+  states = NULL;
+  deviceStates (vars, stats);
 }
 
 // Destructor for device state class instance.
@@ -0,0 +1,347 @@
+/*
+ * digisim.cpp - event-driven logic simulation class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "logging.h"
+#include "complex.h"
+#include "object.h"
+#include "node.h"
+#include "circuit.h"
+#include "digisim.h"
+#include "components/component_id.h"
+
+namespace qucs {
+
+// Constructor creates an empty logic simulation.
+digisim::digisim () {
+  resolution = 1e-15;
+  clear ();
+}
+
+// Destructor deletes the digisim class object.
+digisim::~digisim () {
+}
+
+// Removes all nodes, gates and sources, node 0 is the ground node.
+void digisim::clear (void) {
+  index.clear ();
+  names.clear (); levels.clear (); gates.clear (); inputs.clear ();
+  sources.clear ();
+  names.push_back ("gnd");
+  levels.push_back (0);
+  now = 0;
+  stop = DIGI_NEVER;
+  pass = pending = 0;
+  changed = false;
+}
+
+// Returns true if the given circuit is a logic gate.
+bool digisim::isGate (circuit * c) {
+  switch (c->getType ()) {
+  case CIR_INVERTER: case CIR_BUFFER:
+  case CIR_AND: case CIR_NAND: case CIR_OR: case CIR_NOR:
+  case CIR_XOR: case CIR_XNOR:
+    return true;
+  }
+  return false;
+}
+
+// Makes the given node an alias of the ground node.
+void digisim::addGround (const std::string & n) {
+  index[n] = 0;
+}
+
+// Returns the logic node of the given name, creates it if necessary.
+int digisim::addNode (const std::string & n) {
+  auto it = index.find (n);
+  if (it != index.end ()) return it->second;
+  int i = names.size ();
+  index[n] = i;
+  names.push_back (n);
+  levels.push_back (0);
+  return i;
+}
+
+// Returns the logic node of the given name or -1 if there is none.
+int digisim::findNode (const std::string & n) {
+  auto it = index.find (n);
+  return it != index.end () ? it->second : -1;
+}
+
+/* Adds the given logic gate.  Its first node is the output, the
+   others are the inputs. */
+void digisim::addGate (circuit * c) {
+  digigate_t g;
+  g.c = c;
+  g.type = c->getType ();
+  g.out = addNode (c->getNode (0)->getName ());
+  g.first = inputs.size ();
+  for (int i = 1; i < c->getSize (); i++)
+    inputs.push_back (addNode (c->getNode (i)->getName ()));
+  g.last = inputs.size ();
+  g.delay = ticks (c->getPropertyDouble ("t"));
+  levels[g.out] = c->getPropertyDouble ("V");
+  gates.push_back (g);
+}
+
+/* Adds a source driving the first node of the given circuit.  It
+   toggles its value after each of the given periods in turn. */
+void digisim::addSource (circuit * c, int init,
+                         const std::vector<digitime_t> & times) {
+  digisource_t s;
+  s.out = addNode (c->getNode (0)->getName ());
+  s.init = init;
+  s.times = times;
+  s.next = 0;
+  levels[s.out] = c->getPropertyDouble ("V");
+  sources.push_back (s);
+}
+
+/* Prepares the simulation after all gates and sources have been
+   added.  Returns non-zero if a node is driven by more than one
+   output. */
+int digisim::setup (void) {
+  int N = names.size ();
+  drivers.assign (N, 0);
+  for (auto & s : sources) drivers[s.out]++;
+  for (auto & g : gates) drivers[g.out]++;
+  for (int n = 0; n < N; n++) {
+    if (drivers[n] > (n ? 1 : 0)) {
+      logprint (LOG_ERROR, "ERROR: %s: node `%s' is driven by %d outputs\n",
+                name.c_str (), names[n].c_str (), drivers[n]);
+      return -1;
+    }
+  }
+
+  // gates connected to each node
+  fanstart.assign (N + 1, 0);
+  for (auto & g : gates)
+    for (int i = g.first; i < g.last; i++) fanstart[inputs[i] + 1]++;
+  for (int n = 0; n < N; n++) fanstart[n + 1] += fanstart[n];
+  fanout.resize (fanstart[N]);
+  std::vector<int> pos (fanstart.begin (), fanstart.end () - 1);
+  for (unsigned int k = 0; k < gates.size (); k++)
+    for (int i = gates[k].first; i < gates[k].last; i++)
+      fanout[pos[inputs[i]]++] = k;
+
+  values.assign (N, 0);
+  projected.assign (N, 0);
+  marks.assign (gates.size (), 0);
+  return 0;
+}
+
+// Computes the logic output value of the given gate.
+int digisim::evaluate (const digigate_t & g) {
+  int n = g.last - g.first, high = 0;
+  for (int i = g.first; i < g.last; i++) high += values[inputs[i]];
+  switch (g.type) {
+  case CIR_INVERTER: return !high;
+  case CIR_BUFFER:   return high != 0;
+  case CIR_AND:      return high == n;
+  case CIR_NAND:     return high != n;
+  case CIR_OR:       return high != 0;
+  case CIR_NOR:      return high == 0;
+  case CIR_XOR:      return high & 1;
+  case CIR_XNOR:     return !((n - high) & 1);
+  }
+  return 0;
+}
+
+/* Schedules a value change of the given node.  Events within the
+   range of the timing wheel go into their slot, the others wait in
+   the priority queue until the wheel comes close. */
+void digisim::schedule (digitime_t t, int node, int value, int source) {
+  digievent_t e;
+  e.time = t;
+  e.node = node;
+  e.value = value;
+  e.source = source;
+  if (t - now < DIGI_WHEEL_SIZE) {
+    wheel[t & (DIGI_WHEEL_SIZE - 1)].push_back (e);
+    pending++;
+  }
+  else {
+    future.push (e);
+  }
+}
+
+// Schedules the next output change of the given digital source.
+void digisim::scheduleSource (unsigned int i, digitime_t t, int value) {
+  digisource_t & s = sources[i];
+  if (s.times.empty ()) return;
+  t += s.times[s.next++ % s.times.size ()];
+  if (t <= stop) schedule (t, s.out, value, i);
+}
+
+/* Changes the value of a node not driven by the gates or sources at
+   the given time.  Times already passed are moved to the present. */
+void digisim::force (digitime_t t, int node, int value) {
+  schedule (t < now ? now : t, node, value);
+}
+
+/* Moves the time of the timing wheel to the given one and fetches
+   the events that come into its range. */
+void digisim::advance (digitime_t t) {
+  now = t;
+  while (!future.empty () && future.top ().time - now < DIGI_WHEEL_SIZE) {
+    digievent_t e = future.top ();
+    future.pop ();
+    wheel[e.time & (DIGI_WHEEL_SIZE - 1)].push_back (e);
+    pending++;
+  }
+}
+
+/* Applies all events of the current time slot.  Gates without delay
+   schedule their changes into the same slot, these are processed in
+   further passes, during the initial pass all the gates behave this
+   way.  Returns non-zero if the passes do not come to an end. */
+int digisim::settle (digitime_t t, bool initial) {
+  std::vector<digievent_t> & slot = wheel[t & (DIGI_WHEEL_SIZE - 1)];
+  std::vector<digievent_t> current;
+  std::vector<int> dirty;
+  changed = false;
+
+  for (int delta = 0; !slot.empty (); delta++) {
+    if (delta == DIGI_MAX_DELTA && initial) {
+      // oscillators have no stable state, start them with delays
+      logprint (LOG_ERROR, "WARNING: %s: no stable initial state\n",
+                name.c_str ());
+      initial = false;
+      delta = 0;
+    }
+    if (delta >= DIGI_MAX_DELTA) {
+      logprint (LOG_ERROR, "ERROR: %s: zero-delay loop at t = %g\n",
+                name.c_str (), (double) seconds (t));
+      return -1;
+    }
+    current.swap (slot);
+    pending -= current.size ();
+    pass++;
+    for (auto & e : current) {
+      if (e.source >= 0) scheduleSource (e.source, t, !e.value);
+      if (values[e.node] == e.value) continue;
+      values[e.node] = e.value;
+      changed = true;
+      for (int i = fanstart[e.node]; i < fanstart[e.node + 1]; i++) {
+        int k = fanout[i];
+        if (marks[k] != pass) {
+          marks[k] = pass;
+          dirty.push_back (k);
+        }
+      }
+    }
+    current.clear ();
+    for (int k : dirty) {
+      digigate_t & g = gates[k];
+      int v = evaluate (g);
+      if (v != projected[g.out]) {
+        projected[g.out] = v;
+        schedule (initial ? t : t + g.delay, g.out, v);
+      }
+    }
+    dirty.clear ();
+  }
+  return 0;
+}
+
+/* Computes the state at time zero, it is the solution of the gates
+   without delays for the initial values of the sources and the
+   current values of the nodes which are not driven, like the DC
+   operating point of a transient analysis.  Then the sources start
+   toggling.  The function can be called again to restart. */
+int digisim::initial (void) {
+  wheel.assign (DIGI_WHEEL_SIZE, std::vector<digievent_t> ());
+  future = decltype (future) ();
+  pending = 0;
+  now = 0;
+
+  int N = names.size ();
+  for (int n = 0; n < N; n++)
+    if (drivers[n]) values[n] = projected[n] = 0;
+  for (unsigned int i = 0; i < sources.size (); i++) {
+    digisource_t & s = sources[i];
+    values[s.out] = projected[s.out] = s.init;
+    s.next = 0;
+  }
+
+  /* Evaluate the gates in topological order, thus each one only once.
+     The gates in feedback loops remain and are settled by events. */
+  std::vector<int> driver (N, -1), order, count (gates.size (), 0);
+  for (unsigned int k = 0; k < gates.size (); k++) driver[gates[k].out] = k;
+  for (unsigned int k = 0; k < gates.size (); k++) {
+    for (int i = gates[k].first; i < gates[k].last; i++)
+      if (driver[inputs[i]] >= 0) count[k]++;
+    if (!count[k]) order.push_back (k);
+  }
+  for (unsigned int o = 0; o < order.size (); o++) {
+    digigate_t & g = gates[order[o]];
+    values[g.out] = projected[g.out] = evaluate (g);
+    for (int i = fanstart[g.out]; i < fanstart[g.out + 1]; i++)
+      if (!--count[fanout[i]]) order.push_back (fanout[i]);
+  }
+  for (unsigned int k = 0; k < gates.size (); k++) {
+    if (!count[k]) continue;
+    digigate_t & g = gates[k];
+    int v = evaluate (g);
+    if (v != projected[g.out]) {
+      projected[g.out] = v;
+      schedule (0, g.out, v);
+    }
+  }
+  if (settle (0, true)) return -1;
+  for (unsigned int i = 0; i < sources.size (); i++)
+    scheduleSource (i, 0, !sources[i].init);
+  return 0;
+}
+
+/* Returns the time of the next pending event, it is in the wheel or
+   in the queue. */
+digisim::digitime_t digisim::next (void) {
+  if (pending <= 0 && future.empty ()) return DIGI_NEVER;
+  digitime_t t = future.empty () ? now + DIGI_WHEEL_SIZE : future.top ().time;
+  if (pending > 0) {
+    for (digitime_t i = now; i < t; i++) {
+      if (!wheel[i & (DIGI_WHEEL_SIZE - 1)].empty ()) {
+        t = i;
+        break;
+      }
+    }
+  }
+  return t;
+}
+
+/* Applies the events of the given time, which must be the one of the
+   next pending event.  Returns non-zero on zero-delay loops. */
+int digisim::step (digitime_t t) {
+  advance (t);
+  return settle (t);
+}
+
+} // namespace qucs
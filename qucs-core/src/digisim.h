@@ -0,0 +1,155 @@
+/*
+ * digisim.h - event-driven logic simulation class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __DIGISIM_H__
+#define __DIGISIM_H__
+
+#include <vector>
+#include <queue>
+#include <map>
+#include <string>
+#include <cstdint>
+#include <cmath>
+
+// Number of slots of the timing wheel, must be a power of two.
+#define DIGI_WHEEL_SIZE 4096
+
+// Maximum number of zero-delay evaluation passes per time slot.
+#define DIGI_MAX_DELTA  1000
+
+// Time of no further events.
+#define DIGI_NEVER      INT64_MAX
+
+namespace qucs {
+
+class circuit;
+
+/*! \class digisim
+ * \brief event-driven simulation of logic gates.
+ *
+ * Each node carries a logic value and the gates are evaluated only
+ * when one of their inputs changes.  Output changes are scheduled
+ * after the `t' property of the gate on a timing wheel, events beyond
+ * the range of the wheel wait in a priority queue.  Nodes can be
+ * driven by periodic sources or externally by forced changes.
+ */
+class digisim
+{
+ public:
+  typedef int64_t digitime_t;
+
+  digisim ();
+  ~digisim ();
+  void clear (void);
+  void setName (const std::string & n) { name = n; }
+  void setResolution (nr_double_t r) { resolution = r; }
+  void setStop (digitime_t t) { stop = t; }
+  digitime_t ticks (nr_double_t t) { return (digitime_t) std::llround (t / resolution); }
+  nr_double_t seconds (digitime_t t) { return t * resolution; }
+
+  static bool isGate (circuit *);
+  void addGround (const std::string &);
+  int  addNode (const std::string &);
+  int  findNode (const std::string &);
+  void addGate (circuit *);
+  void addSource (circuit *, int, const std::vector<digitime_t> &);
+  int  setup (void);
+  int  initial (void);
+  void force (digitime_t, int, int);
+  digitime_t next (void);
+  int  step (digitime_t);
+
+  int getNodes (void) { return names.size (); }
+  int getGates (void) { return gates.size (); }
+  int getSources (void) { return sources.size (); }
+  const std::string & getName (int n) { return names[n]; }
+  nr_double_t getLevel (int n) { return levels[n]; }
+  int getValue (int n) { return values[n]; }
+  void setValue (int n, int v) { values[n] = projected[n] = v; }
+  bool isDriven (int n) { return drivers[n] > 0; }
+  bool hasChanged (void) { return changed; }
+
+ private:
+  /* A value change of a node, sources schedule their next change when
+     this one takes place. */
+  struct digievent_t
+  {
+    digitime_t time;
+    int node;
+    int value;
+    int source;
+    bool operator > (const digievent_t & e) const { return time > e.time; }
+  };
+
+  struct digigate_t
+  {
+    circuit * c;
+    int type;
+    int out;
+    int first, last;  // inputs in the inputs array
+    digitime_t delay;
+  };
+
+  struct digisource_t
+  {
+    int out;
+    int init;
+    std::vector<digitime_t> times;
+    unsigned int next;
+  };
+
+  int  evaluate (const digigate_t &);
+  void schedule (digitime_t, int, int, int = -1);
+  void scheduleSource (unsigned int, digitime_t, int);
+  void advance (digitime_t);
+  int  settle (digitime_t, bool = false);
+
+ private:
+  std::string name;
+  nr_double_t resolution;
+  digitime_t now, stop;
+  std::map<std::string, int> index;
+  std::vector<std::string> names;
+  std::vector<nr_double_t> levels;
+  std::vector<int> values;
+  std::vector<int> projected;
+  std::vector<int> drivers;
+  std::vector<digigate_t> gates;
+  std::vector<int> inputs;
+  std::vector<int> fanout, fanstart;
+  std::vector<digisource_t> sources;
+  std::vector<int> marks;
+  int pass;
+  bool changed;
+
+  // timing wheel and far future events
+  std::vector<std::vector<digievent_t> > wheel;
+  int pending;
+  std::priority_queue<digievent_t, std::vector<digievent_t>,
+                      std::greater<digievent_t> > future;
+};
+
+} // namespace qucs
+
+#endif /* __DIGISIM_H__ */
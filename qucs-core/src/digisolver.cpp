@@ -0,0 +1,215 @@
+/*
+ * digisolver.cpp - event-driven digital solver class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "logging.h"
+#include "complex.h"
+#include "object.h"
+#include "node.h"
+#include "circuit.h"
+#include "vector.h"
+#include "dataset.h"
+#include "net.h"
+#include "netdefs.h"
+#include "analysis.h"
+#include "digisolver.h"
+#include "components/component_id.h"
+
+namespace qucs {
+
+// Constructor creates an unnamed instance of the digisolver class.
+digisolver::digisolver () : analysis () {
+  type = ANALYSIS_DIGITAL;
+  stop = 0;
+}
+
+// Constructor creates a named instance of the digisolver class.
+digisolver::digisolver (char * n) : analysis (n) {
+  type = ANALYSIS_DIGITAL;
+  stop = 0;
+}
+
+// Destructor deletes the digisolver class object.
+digisolver::~digisolver () {
+}
+
+/* The copy constructor creates a new instance of the digisolver class
+   based on the given digisolver object. */
+digisolver::digisolver (digisolver & o) : analysis (o) {
+  stop = 0;
+}
+
+/* The function creates the logic nodes, gates and sources of the
+   netlist.  It returns non-zero if the netlist contains anything but
+   digital sources and logic gates. */
+int digisolver::init (void) {
+  circuit * root = subnet->getRoot ();
+  circuit * c;
+  bool truth = !strcmp (getPropertyString ("Type"), "TruthTable");
+
+  sim.clear ();
+  sim.setName (getName ());
+  sim.setResolution (getPropertyDouble ("Resolution"));
+  saved.clear (); times.clear (); samples.clear ();
+
+  for (c = root; c != NULL; c = (circuit *) c->getNext ())
+    if (c->getType () == CIR_GROUND)
+      sim.addGround (c->getNode (0)->getName ());
+
+  for (c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    if (c->getType () == CIR_GROUND)
+      continue;
+    if (c->getType () == CIR_DIGISOURCE) {
+      std::vector<digisim::digitime_t> t;
+      int init = 0;
+      if (truth) {
+        // the sources count through all input combinations, 1ns each
+        t.assign (2, sim.ticks (1e-9 * (1 << sim.getSources ())));
+      }
+      else {
+        init = strcmp (c->getPropertyString ("init"), "low") ? 1 : 0;
+        qucs::vector * v = c->getPropertyVector ("times");
+        // sources without a period are constant
+        if (real (sum (*v)) > 0)
+          for (int i = 0; i < v->getSize (); i++)
+            t.push_back (sim.ticks (real (v->get (i))));
+      }
+      sim.addSource (c, init, t);
+    }
+    else if (digisim::isGate (c)) {
+      sim.addGate (c);
+    }
+    else {
+      logprint (LOG_ERROR, "ERROR: %s: `%s' is not a digital component, "
+                "use a transient analysis instead\n", getName (),
+                c->getName ());
+      return -1;
+    }
+  }
+  if (truth && sim.getSources () > 24) {
+    logprint (LOG_ERROR, "ERROR: %s: too many digital sources (%d) for a "
+              "truth table\n", getName (), sim.getSources ());
+    return -1;
+  }
+  if (sim.setup ()) return -1;
+
+  // save the nodes at top level only, like the other analyses
+  for (int n = 1; n < sim.getNodes (); n++)
+    if (sim.getName (n).find ('.') == std::string::npos) saved.push_back (n);
+  samples.assign (saved.size (), std::vector<char> ());
+
+  if (truth)
+    stop = sim.ticks (1e-9 * (1 << sim.getSources ()));
+  else
+    stop = sim.ticks (getPropertyDouble ("time"));
+  sim.setStop (stop);
+  return 0;
+}
+
+// Records the values of the saved nodes at the given time.
+void digisolver::record (digisim::digitime_t t) {
+  nr_double_t time = sim.seconds (t);
+  bool same = !times.empty () && times.back () == time;
+  if (!same) times.push_back (time);
+  for (unsigned int k = 0; k < saved.size (); k++) {
+    if (same)
+      samples[k].back () = sim.getValue (saved[k]);
+    else
+      samples[k].push_back (sim.getValue (saved[k]));
+  }
+}
+
+// Runs the event loop from the initial state until the stop time.
+int digisolver::run (void) {
+  digisim::digitime_t t;
+  if (sim.initial ()) return -1;
+  record (0);
+  while ((t = sim.next ()) <= stop) {
+    if (sim.step (t)) return -1;
+    if (sim.hasChanged ()) record (t);
+  }
+
+  // hold the last values until the end of the simulation
+  nr_double_t end = sim.seconds (stop);
+  if (times.back () < end) {
+    times.push_back (end);
+    for (auto & s : samples) s.push_back (s.back ());
+  }
+  return 0;
+}
+
+/* Saves the node voltages into the dataset.  Within a parameter sweep
+   the time points of the first run are used and the node values are
+   held between their changes. */
+void digisolver::saveResults (void) {
+  qucs::vector * t;
+  if ((t = data->findDependency ("time")) == NULL) {
+    t = new qucs::vector ("time");
+    data->addDependency (t);
+  }
+  if (runs == 1)
+    for (auto time : times) t->add (time);
+
+  for (unsigned int k = 0; k < saved.size (); k++) {
+    std::string n = sim.getName (saved[k]) + ".Vt";
+    nr_double_t v = sim.getLevel (saved[k]);
+    unsigned int s = 0;
+    for (int i = 0; i < t->getSize (); i++) {
+      nr_double_t time = real (t->get (i));
+      while (s + 1 < times.size () && times[s + 1] <= time) s++;
+      saveVariable (n, samples[k][s] ? v : 0.0, t);
+    }
+  }
+}
+
+// This is the digital netlist solver.
+int digisolver::solve (void) {
+  runs++;
+  if (init ()) return -1;
+  logprint (LOG_STATUS, "NOTIFY: %s: simulating %d gates and %d sources\n",
+            getName (), sim.getGates (), sim.getSources ());
+  if (run ()) return -1;
+  saveResults ();
+  return 0;
+}
+
+// properties
+PROP_REQ [] = {
+  PROP_NO_PROP };
+PROP_OPT [] = {
+  { "Type", PROP_STR, { PROP_NO_VAL, "TimeList" },
+    PROP_RNG_STR2 ("TimeList", "TruthTable") },
+  { "time", PROP_REAL, { 10e-9, PROP_NO_STR }, PROP_POS_RANGEX },
+  { "Resolution", PROP_REAL, { 1e-15, PROP_NO_STR }, PROP_POS_RANGEX },
+  PROP_NO_PROP };
+struct define_t digisolver::anadef =
+  { "DIGI", 0, PROP_ACTION, PROP_NO_SUBSTRATE, PROP_LINEAR, PROP_DEF };
+
+} // namespace qucs
@@ -0,0 +1,72 @@
+/*
+ * digisolver.h - event-driven digital solver class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __DIGISOLVER_H__
+#define __DIGISOLVER_H__
+
+#include <vector>
+
+#include "analysis.h"
+#include "digisim.h"
+
+namespace qucs {
+
+class circuit;
+
+/*! \class digisolver
+ * \brief event-driven logic simulator for pure digital netlists.
+ *
+ * Instead of solving the tanh transfer functions of the logic gates
+ * by the Newton loop of the transient analysis, the netlist is run by
+ * the event-driven logic simulation.  The node voltages are saved at
+ * each time a node changes its value.
+ */
+class digisolver : public analysis
+{
+ public:
+  ACREATOR (digisolver);
+  digisolver (char *);
+  digisolver (digisolver &);
+  ~digisolver ();
+  int solve (void);
+
+ private:
+  int  init (void);
+  int  run (void);
+  void record (digisim::digitime_t);
+  void saveResults (void);
+
+ private:
+  digisim sim;
+  digisim::digitime_t stop;
+
+  // recorded changes of the saved nodes
+  std::vector<int> saved;
+  std::vector<nr_double_t> times;
+  std::vector<std::vector<char> > samples;
+};
+
+} // namespace qucs
+
+#endif /* __DIGISOLVER_H__ */
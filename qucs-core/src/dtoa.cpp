@@ -0,0 +1,334 @@
+/*
+ * dtoa.cpp - decimal representation of doubles implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <cmath>
+#include <vector>
+
+#include "dtoa.h"
+
+namespace qucs {
+
+// bits of the tabulated powers of five and of their inverses
+#define POW5_BITCOUNT     125
+#define POW5_INV_BITCOUNT 125
+
+// largest powers needed by the exponent range of doubles
+#define POW5_TABLE_SIZE     326
+#define POW5_INV_TABLE_SIZE 342
+
+/* The powers of five 5^i with their leading POW5_BITCOUNT bits and the
+   inverses 2^(b + POW5_INV_BITCOUNT - 1) / 5^i, b being the bit length
+   of 5^i, rounded up.  Both are computed once from the exact powers
+   instead of being compiled in. */
+struct pow5table {
+  uint64_t pow5[POW5_TABLE_SIZE][2];
+  uint64_t inv[POW5_INV_TABLE_SIZE][2];
+  pow5table ();
+};
+
+// Bit length of a multiple precision number of 32 bit words.
+static int bitlength (const std::vector<uint32_t> & x) {
+  for (int i = (int) x.size () - 1; i >= 0; i--)
+    if (x[i]) {
+      int n = 32 * i;
+      for (uint32_t w = x[i]; w; w >>= 1) n++;
+      return n;
+    }
+  return 0;
+}
+
+static int bit (const std::vector<uint32_t> & x, int n) {
+  return n >= 0 && n / 32 < (int) x.size () ? (x[n / 32] >> (n % 32)) & 1 : 0;
+}
+
+// Returns non-zero if a >= b, both having the same number of words.
+static int greaterequal (const std::vector<uint32_t> & a,
+			 const std::vector<uint32_t> & b) {
+  for (int i = (int) a.size () - 1; i >= 0; i--)
+    if (a[i] != b[i]) return a[i] > b[i];
+  return 1;
+}
+
+pow5table::pow5table () {
+  std::vector<uint32_t> p (1, 1);
+  for (int i = 0; i < POW5_INV_TABLE_SIZE; i++) {
+    int len = bitlength (p);
+
+    // the leading bits of the power
+    if (i < POW5_TABLE_SIZE) {
+      int shift = len - POW5_BITCOUNT;
+      uint64_t w[2] = { 0, 0 };
+      for (int b = 0; b < POW5_BITCOUNT; b++)
+	if (bit (p, b + shift)) w[b / 64] |= (uint64_t) 1 << (b % 64);
+      pow5[i][0] = w[0];
+      pow5[i][1] = w[1];
+    }
+
+    // the long division starts with a remainder of 2^(len - 1) < 5^i
+    std::vector<uint32_t> r (p.size () + 1, 0), d (p);
+    d.push_back (0);
+    r[(len - 1) / 32] = (uint32_t) 1 << ((len - 1) % 32);
+    uint64_t q[2] = { 0, 0 };
+    for (int b = 0; b < POW5_INV_BITCOUNT; b++) {
+      uint32_t carry = 0;
+      for (size_t k = 0; k < r.size (); k++) {
+	uint32_t c = r[k] >> 31;
+	r[k] = (r[k] << 1) | carry;
+	carry = c;
+      }
+      q[1] = (q[1] << 1) | (q[0] >> 63);
+      q[0] <<= 1;
+      if (greaterequal (r, d)) {
+	uint64_t borrow = 0;
+	for (size_t k = 0; k < r.size (); k++) {
+	  uint64_t t = (uint64_t) r[k] - d[k] - borrow;
+	  r[k] = (uint32_t) t;
+	  borrow = (t >> 32) & 1;
+	}
+	q[0] |= 1;
+      }
+    }
+    if (++q[0] == 0) q[1]++;
+    inv[i][0] = q[0];
+    inv[i][1] = q[1];
+
+    // next power of five
+    uint64_t carry = 0;
+    for (size_t k = 0; k < p.size (); k++) {
+      uint64_t t = (uint64_t) p[k] * 5 + carry;
+      p[k] = (uint32_t) t;
+      carry = t >> 32;
+    }
+    if (carry) p.push_back ((uint32_t) carry);
+  }
+}
+
+static const pow5table & tables (void) {
+  static const pow5table t;
+  return t;
+}
+
+// Full 64 x 64 bit product, returns the low word.
+static uint64_t umul128 (uint64_t a, uint64_t b, uint64_t & hi) {
+  uint64_t al = (uint32_t) a, ah = a >> 32, bl = (uint32_t) b, bh = b >> 32;
+  uint64_t ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+  uint64_t mid = (ll >> 32) + (uint32_t) lh + (uint32_t) hl;
+  hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+  return (mid << 32) | (uint32_t) ll;
+}
+
+// Returns (m * mul) >> j for 64 < j < 128.
+static uint64_t mulShift (uint64_t m, const uint64_t * mul, int j) {
+  uint64_t hi0, hi1, lo1;
+  umul128 (m, mul[0], hi0);
+  lo1 = umul128 (m, mul[1], hi1);
+  uint64_t sum = hi0 + lo1;
+  if (sum < hi0) hi1++;
+  int dist = j - 64;
+  return (hi1 << (64 - dist)) | (sum >> dist);
+}
+
+static int pow5bits (int e) {
+  return (int) (((uint32_t) e * 1217359) >> 19) + 1;
+}
+
+static int log10Pow2 (int e) {
+  return (int) (((uint32_t) e * 78913) >> 18);
+}
+
+static int log10Pow5 (int e) {
+  return (int) (((uint32_t) e * 732923) >> 20);
+}
+
+static int multipleOfPowerOf5 (uint64_t v, int p) {
+  int n = 0;
+  while (v && v % 5 == 0) { v /= 5; n++; }
+  return n >= p;
+}
+
+void dtoa_shortest (double x, unsigned long long & digits, int & exponent) {
+  uint64_t bits;
+  memcpy (&bits, &x, sizeof (bits));
+  uint64_t mantissa = bits & (((uint64_t) 1 << 52) - 1);
+  int ieeeexp = (int) ((bits >> 52) & 0x7ff);
+  if (ieeeexp == 0 && mantissa == 0) {
+    digits = 0;
+    exponent = 0;
+    return;
+  }
+
+  // the value is m2 * 2^e2 with one guard digit and the halfway points
+  // to its neighbours as bounds
+  int e2;
+  uint64_t m2;
+  if (ieeeexp == 0) {
+    e2 = 1 - 1023 - 52 - 2;
+    m2 = mantissa;
+  }
+  else {
+    e2 = ieeeexp - 1023 - 52 - 2;
+    m2 = ((uint64_t) 1 << 52) | mantissa;
+  }
+  bool acceptBounds = (m2 & 1) == 0;
+  uint64_t mv = 4 * m2;
+  int mmShift = mantissa != 0 || ieeeexp <= 1;
+
+  // the decimal interval of the representations reading back as x
+  const pow5table & t = tables ();
+  uint64_t vr, vp, vm;
+  int e10;
+  bool vmTrailingZeros = false, vrTrailingZeros = false;
+  if (e2 >= 0) {
+    int q = log10Pow2 (e2) - (e2 > 3);
+    e10 = q;
+    int k = POW5_INV_BITCOUNT + pow5bits (q) - 1;
+    int i = -e2 + q + k;
+    vr = mulShift (4 * m2, t.inv[q], i);
+    vp = mulShift (4 * m2 + 2, t.inv[q], i);
+    vm = mulShift (4 * m2 - 1 - mmShift, t.inv[q], i);
+    if (q <= 21) {
+      if (mv % 5 == 0)
+	vrTrailingZeros = multipleOfPowerOf5 (mv, q);
+      else if (acceptBounds)
+	vmTrailingZeros = multipleOfPowerOf5 (mv - 1 - mmShift, q);
+      else
+	vp -= multipleOfPowerOf5 (mv + 2, q);
+    }
+  }
+  else {
+    int q = log10Pow5 (-e2) - (-e2 > 1);
+    e10 = q + e2;
+    int i = -e2 - q;
+    int k = pow5bits (i) - POW5_BITCOUNT;
+    int j = q - k;
+    vr = mulShift (4 * m2, t.pow5[i], j);
+    vp = mulShift (4 * m2 + 2, t.pow5[i], j);
+    vm = mulShift (4 * m2 - 1 - mmShift, t.pow5[i], j);
+    if (q <= 1) {
+      vrTrailingZeros = true;
+      if (acceptBounds)
+	vmTrailingZeros = mmShift == 1;
+      else
+	vp--;
+    }
+    else if (q < 63) {
+      vrTrailingZeros = (mv & (((uint64_t) 1 << q) - 1)) == 0;
+    }
+  }
+
+  // remove the digits as long as the interval allows
+  int removed = 0, last = 0;
+  uint64_t output;
+  if (vmTrailingZeros || vrTrailingZeros) {
+    while (vp / 10 > vm / 10) {
+      vmTrailingZeros &= vm % 10 == 0;
+      vrTrailingZeros &= last == 0;
+      last = (int) (vr % 10);
+      vr /= 10; vp /= 10; vm /= 10;
+      removed++;
+    }
+    if (vmTrailingZeros) {
+      while (vm % 10 == 0) {
+	vrTrailingZeros &= last == 0;
+	last = (int) (vr % 10);
+	vr /= 10; vp /= 10; vm /= 10;
+	removed++;
+      }
+    }
+    // round half to even
+    if (vrTrailingZeros && last == 5 && vr % 2 == 0) last = 4;
+    output = vr + ((vr == vm && (!acceptBounds || !vmTrailingZeros)) ||
+		   last >= 5);
+  }
+  else {
+    bool roundUp = false;
+    while (vp / 10 > vm / 10) {
+      roundUp = vr % 10 >= 5;
+      vr /= 10; vp /= 10; vm /= 10;
+      removed++;
+    }
+    output = vr + (vr == vm || roundUp);
+  }
+  digits = output;
+  exponent = e10 + removed;
+}
+
+int dtoa (double x, char * buf, int digits) {
+  char * p = buf;
+  *p++ = std::signbit (x) ? '-' : '+';
+  if (!std::isfinite (x)) {
+    strcpy (p, std::isnan (x) ? "nan" : "inf");
+    return 4;
+  }
+
+  unsigned long long d;
+  int e, n = 1;
+  dtoa_shortest (std::fabs (x), d, e);
+  for (unsigned long long v = d; v >= 10; v /= 10) n++;
+
+  // round to the given number of digits, dropping trailing zeros
+  if (digits > 0 && n > digits) {
+    unsigned long long s = 1;
+    for (int i = digits; i < n; i++) s *= 10;
+    unsigned long long r = d % s;
+    d /= s;
+    if (r >= s - r) d++;
+    e += n - digits;
+    n = digits;
+    unsigned long long lim = 1;
+    for (int i = 0; i < n; i++) lim *= 10;
+    if (d >= lim) { d /= 10; e++; }
+  }
+  while (n > 1 && d % 10 == 0) { d /= 10; e++; n--; }
+
+  // mantissa with one digit before the point and at least one behind
+  char num[24];
+  for (int i = n - 1; i >= 0; i--, d /= 10) num[i] = (char) ('0' + d % 10);
+  *p++ = num[0];
+  *p++ = '.';
+  if (n > 1) {
+    memcpy (p, num + 1, n - 1);
+    p += n - 1;
+  }
+  else *p++ = '0';
+
+  // exponent with at least two digits
+  e += n - 1;
+  *p++ = 'e';
+  *p++ = e < 0 ? '-' : '+';
+  if (e < 0) e = -e;
+  if (e >= 100) *p++ = (char) ('0' + e / 100);
+  *p++ = (char) ('0' + e / 10 % 10);
+  *p++ = (char) ('0' + e % 10);
+  *p = '\0';
+  return (int) (p - buf);
+}
+
+} // namespace qucs
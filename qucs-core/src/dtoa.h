@@ -0,0 +1,51 @@
+/*
+ * dtoa.h - decimal representation of doubles definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __DTOA_H__
+#define __DTOA_H__
+
+// characters written by dtoa() at most, including the terminating zero
+#define DTOA_MAXLEN 32
+
+// significant digits needed to tell any two doubles apart
+#define DTOA_DIGITS 17
+
+namespace qucs {
+
+/* Writes the given value in scientific notation with an explicit sign
+   like "%+e" does, e.g. "+1.5e-03", into the buffer and returns the
+   number of characters written.  With zero digits the shortest
+   representation which reads back as the same double is written,
+   otherwise that one rounded to the given number of significant
+   digits. */
+int dtoa (double, char *, int digits = 0);
+
+/* Decomposes a finite, non-negative value into the decimal digits and
+   the exponent of its shortest representation, value = digits *
+   10^exponent.  The Ryu algorithm of Ulf Adams is used. */
+void dtoa_shortest (double, unsigned long long &, int &);
+
+} // namespace qucs
+
+#endif /* __DTOA_H__ */
@@ -0,0 +1,242 @@
+/*
+ * eco.cpp - incremental re-simulation implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#if __MINGW32__
+# include <io.h>
+#endif
+
+#include "qucs_typedefs.h"
+#include "logging.h"
+#include "netdefs.h"
+#include "checkpoint.h"
+#include "opcache.h"
+#include "resultcache.h"
+#include "eco.h"
+
+// Largest number of changed definitions named by the report.
+#define ECO_NAMES 8
+
+namespace qucs {
+
+std::string eco::base;
+eco::lines_t eco::lines;
+eco::lines_t eco::nodes;
+std::mutex eco::lock;
+std::map<std::string, eco::ordering_t> eco::orderings;
+
+/* Enables ECO mode, the snapshot is kept in a file starting with the
+   given base name. */
+void eco::enable (const std::string & name) {
+  base = name;
+}
+
+/* Returns the directory of the result cache next to the output
+   dataset, it is created if necessary. */
+std::string eco::directory (void) {
+  std::string dir = base + ".eco.d";
+  struct stat st;
+  if (stat (dir.c_str (), &st)) {
+#if __MINGW32__
+    mkdir (dir.c_str ());
+#else
+    mkdir (dir.c_str (), 0777);
+#endif
+  }
+  return dir;
+}
+
+/* Appends the topology of the given netlist definition, i.e. the
+   nodes and the subcircuit it instantiates without any other
+   property. */
+void eco::topology (struct definition_t * def, std::string & s) {
+  s += def->type;
+  s += ":";
+  s += def->instance ? def->instance : "";
+  for (struct node_t * n = def->nodes; n != NULL; n = n->next) {
+    s += " ";
+    s += n->node;
+  }
+  if (!strcmp (def->type, "Sub")) {
+    for (struct pair_t * p = def->pairs; p != NULL; p = p->next)
+      if (!strcmp (p->key, "Type") && p->value && p->value->ident) {
+	s += " Type=";
+	s += p->value->ident;
+      }
+  }
+  if (def->sub) {
+    std::vector<std::string> subs;
+    for (struct definition_t * d = def->sub; d != NULL; d = d->next) {
+      if (d->action) continue;
+      subs.push_back ("");
+      topology (d, subs.back ());
+    }
+    std::sort (subs.begin (), subs.end ());
+    s += " {\n";
+    for (std::string & l : subs) s += l + "\n";
+    s += "}";
+  }
+}
+
+/* Records the canonical lines and the topology of the given parsed
+   netlist.  The analyses have no topology. */
+void eco::netlist (struct definition_t * root) {
+  lines.clear ();
+  nodes.clear ();
+  for (struct definition_t * def = root; def != NULL; def = def->next) {
+    std::string name = def->instance ? def->instance : "";
+    resultcache::line (def, lines[name]);
+    if (!def->action || !strcmp (def->type, "Eqn") ||
+	!strcmp (def->type, "Def"))
+      topology (def, nodes[name]);
+  }
+}
+
+/* Reads the snapshot of the previous run and compares the checked
+   netlist with it.  The operating points become the seeds of the
+   operating point cache, the symbolic analyses are kept if the
+   topology did not change. */
+void eco::load (void) {
+  std::lock_guard<std::mutex> guard (lock);
+  checkpoint cp ("");
+  cp.setFile (base + ".eco");
+  orderings.clear ();
+  if (cp.open (ECO_KEY)) {
+    logprint (LOG_STATUS, "NOTIFY: eco: no snapshot of a previous run, "
+	      "solving from scratch\n");
+    return;
+  }
+
+  // the netlist of the previous run
+  lines_t before, topo;
+  int n = -1;
+  cp.get (n);
+  for (int i = 0; cp.good () && i < n; i++) {
+    std::string name, line, t;
+    cp.get (name);
+    cp.get (line);
+    cp.get (t);
+    before[name] = line;
+    if (!t.empty ()) topo[name] = t;
+  }
+
+  // its operating points and symbolic analyses
+  int points = cp.good () ? opcache::load (cp) : -1;
+  n = -1;
+  cp.get (n);
+  for (int i = 0; cp.good () && i < n; i++) {
+    std::string key;
+    ordering_t o;
+    cp.get (key);
+    cp.get (o.Ap);
+    cp.get (o.Ai);
+    cp.get (o.Q);
+    cp.get (o.Vol);
+    orderings[key] = o;
+  }
+  cp.close ();
+  if (!cp.good () || points < 0) {
+    logprint (LOG_ERROR, "WARNING: eco: broken snapshot `%s.eco', solving "
+	      "from scratch\n", base.c_str ());
+    orderings.clear ();
+    return;
+  }
+
+  // the definitions changed, added or removed
+  std::vector<std::string> changed;
+  for (auto & l : lines) {
+    auto it = before.find (l.first);
+    if (it == before.end () || it->second != l.second)
+      changed.push_back (l.first);
+  }
+  for (auto & l : before)
+    if (!lines.count (l.first)) changed.push_back (l.first);
+  bool same = topo == nodes;
+  if (!same) orderings.clear ();
+
+  if (changed.empty ()) {
+    logprint (LOG_STATUS, "NOTIFY: eco: netlist unchanged\n");
+    return;
+  }
+  std::string names;
+  for (int i = 0; i < (int) changed.size () && i < ECO_NAMES; i++)
+    names += (i ? ", " : "") + changed[i];
+  if (changed.size () > ECO_NAMES) names += ", ...";
+  logprint (LOG_STATUS, "NOTIFY: eco: %d of %d definitions changed (%s), "
+	    "topology %s, %d operating points\n", (int) changed.size (),
+	    (int) lines.size (), names.c_str (),
+	    same ? "unchanged" : "changed", points);
+}
+
+/* Writes the snapshot of the current run, replacing the previous one
+   once it is complete. */
+void eco::save (void) {
+  std::lock_guard<std::mutex> guard (lock);
+  checkpoint cp ("");
+  cp.setFile (base + ".eco");
+  if (cp.create (ECO_KEY)) return;
+  cp.put ((int) lines.size ());
+  for (auto & l : lines) {
+    auto it = nodes.find (l.first);
+    cp.put (l.first);
+    cp.put (l.second);
+    cp.put (it != nodes.end () ? it->second : std::string ());
+  }
+  opcache::save (cp);
+  cp.put ((int) orderings.size ());
+  for (auto & o : orderings) {
+    cp.put (o.first);
+    cp.put (o.second.Ap);
+    cp.put (o.second.Ai);
+    cp.put (o.second.Q);
+    cp.put (o.second.Vol);
+  }
+  cp.commit ();
+}
+
+/* Passes the symbolic analysis of the equation system with the given
+   name to take over.  Returns false if there is none. */
+bool eco::ordering (const std::string & name, ordering_t & o) {
+  std::lock_guard<std::mutex> guard (lock);
+  auto it = orderings.find (name);
+  if (it == orderings.end ()) return false;
+  o = it->second;
+  return true;
+}
+
+// Keeps the symbolic analysis of the equation system with the given name.
+void eco::keep (const std::string & name, const ordering_t & o) {
+  std::lock_guard<std::mutex> guard (lock);
+  orderings[name] = o;
+}
+
+} // namespace qucs
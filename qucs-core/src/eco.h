@@ -0,0 +1,90 @@
+/*
+ * eco.h - incremental re-simulation definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __ECO_H__
+#define __ECO_H__
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// snapshot file key, changes with its layout
+#define ECO_KEY "eco snapshot 1"
+
+struct definition_t;
+
+namespace qucs {
+
+/*! \class eco
+ * \brief incremental re-simulation after small netlist edits.
+ *
+ * A run in ECO mode leaves a snapshot next to the output dataset: the
+ * canonical lines of the netlist definitions and of their topology,
+ * i.e. the nodes only, the DC operating points found and the symbolic
+ * analyses of the sparse LU decompositions of each analysis.  The next
+ * run checks its netlist, then compares it with the snapshot and
+ * reports the definitions changed.  The operating points seed the DC
+ * iterations of the analyses (see opcache), including the initial DC
+ * of the transient analyses.  If the topology did not change the
+ * equation systems take over the previous column orderings, which are
+ * dropped by the solver unless the pattern of the matrix is covered.
+ * An edit of any circuit runs all analyses again, starting at the
+ * previous solution, since the keys of the result cache cover all the
+ * circuits.  If analyses are edited only, the other ones take their
+ * results from the result cache.
+ */
+class eco
+{
+ public:
+  //! Symbolic analysis of a sparse equation system.
+  struct ordering_t {
+    std::vector<int> Ap, Ai, Q, Vol;
+  };
+
+  static void enable (const std::string &);
+  static bool enabled (void) { return !base.empty (); }
+  static std::string directory (void);
+
+  static void netlist (struct definition_t *);
+  static void load (void);
+  static void save (void);
+
+  static bool ordering (const std::string &, ordering_t &);
+  static void keep (const std::string &, const ordering_t &);
+
+ private:
+  typedef std::map<std::string, std::string> lines_t;
+  static void topology (struct definition_t *, std::string &);
+
+ private:
+  static std::string base;
+  static lines_t lines, nodes;
+  static std::mutex lock;
+  static std::map<std::string, ordering_t> orderings;
+};
+
+} // namespace qucs
+
+#endif /* __ECO_H__ */
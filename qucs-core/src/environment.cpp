@@ -52,6 +52,7 @@ environment::environment () :
   checkee = NULL;
   defs = NULL;
   iscopy = false;
+  indexed = false;
 }
 
 
@@ -65,6 +66,7 @@ environment::environment (const std::string & p_name) :
   checkee = NULL;
   defs = NULL;
   iscopy = false;
+  indexed = false;
 }
 
 /* The copy constructor creates a new instance of the environment
@@ -117,6 +119,7 @@ environment::~environment () {
 void environment::copyVariables (variable * org) {
   variable * var;
   root = NULL;
+  indexed = false;
   while (org != NULL) {
     // copy variable (references only)
     var = new variable (*org);
@@ -162,6 +165,7 @@ void environment::deleteVariables (void) {
     delete var;
   }
   root = NULL;
+  indexed = false;
 }
 
 /* This function adds a variable to the environment. */
@@ -169,17 +173,31 @@ void environment::addVariable (variable * const var, const bool pass) {
   var->setNext (root);
   var->setPassing (pass);
   this->root = var;
+  indexed = false;
 }
 
 /* This function looks for the variable name in the environment and
    returns it if possible.  Otherwise the function returns NULL. */
 variable * environment::getVariable (const char * const n) const {
+  indexVariables ();
+  auto it = variables.find (n);
+  return it != variables.end () ? it->second : NULL;
+}
+
+/* Indexes the variables by name unless done since the last change of
+   the list.  As in a walk through the list, the most recently added
+   variable of a name is found.  Saved values are kept apart. */
+void environment::indexVariables (void) const {
+  if (indexed) return;
+  variables.clear ();
+  values.clear ();
   for (variable * var = root; var != NULL; var = var->getNext ()) {
-    if (var->getType () != VAR_VALUE)
-      if (!strcmp (var->getName (), n))
-	return var;
+    if (var->getType () == VAR_VALUE)
+      values.emplace (var->getName (), var);
+    else
+      variables.emplace (var->getName (), var);
   }
-  return NULL;
+  indexed = true;
 }
 
 // The function runs the equation checker for this environment.
@@ -268,12 +286,9 @@ void environment::fetchConstants (void) {
    being a saved value and returns the variable pointer or NULL if
    there is no such variable. */
 variable * environment::findValue (char * n) {
-  for (variable * var = root; var != NULL; var = var->getNext ()) {
-    if (var->getType () == VAR_VALUE)
-      if (!strcmp (var->getName (), n))
-	return var;
-  }
-  return NULL;
+  indexVariables ();
+  auto it = values.find (n);
+  return it != values.end () ? it->second : NULL;
 }
 
 /* Puts the given variable name and its computed result into the list
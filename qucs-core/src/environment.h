@@ -33,6 +33,7 @@
 
 #include <list>
 #include <string>
+#include <unordered_map>
 
 #include "equation.h"
 
@@ -115,9 +116,15 @@ class environment
     return this->name;
   }
 
+ private:
+  void indexVariables (void) const;
+
  private:
   std::string name;
   variable * root;
+  // variables and saved values by name, rebuilt after the list changed
+  mutable std::unordered_map<std::string, variable *> variables, values;
+  mutable bool indexed;
   eqn::checker * checkee;
   eqn::solver * solvee;
   std::list<environment *> children;
@@ -32,28 +32,46 @@
 #include <assert.h>
 #include <time.h>
 #include <cmath>
+#include <cstring>
 #include <float.h>
 
 #include <limits>
+#include <set>
+#include <algorithm>
+#include <iterator>
 
 #include "compat.h"
 #include "logging.h"
 #include "precision.h"
 #include "complex.h"
 #include "tmatrix.h"
+#include "tspmatrix.h"
 #include "eqnsys.h"
 #include "exception.h"
-#include "exceptionstack.h"
+#include "numstatus.h"
+#include "trace.h"
 
 //! Little helper macro.
 #define Swap(type,a,b) { type t; t = a; a = b; b = t; }
 
+// Default residual tolerance and fill level of the Krylov solvers
+#define KRYLOV_TOL     1e-9
+#define KRYLOV_FILL    1
+// Maximum number of iterations and restart length (GMRES only)
+#define KRYLOV_MAXITER 500
+#define KRYLOV_RESTART 30
+// Maximum number of refinement steps of the mixed precision solver
+// and the residual reduction of each step considered as stagnation
+#define MIXED_MAXITER     30
+#define MIXED_STAGNATION  0.5
+
 namespace qucs {
 
 //! Constructor creates an unnamed instance of the eqnsys class.
 template <class nr_type_t>
 eqnsys<nr_type_t>::eqnsys () {
   A = V = NULL;
+  As = NULL;
   B = X = NULL;
   S = E = NULL;
   T = R = NULL;
@@ -62,6 +80,17 @@ eqnsys<nr_type_t>::eqnsys () {
   update = 1;
   pivoting = PIVOT_PARTIAL;
   N = 0;
+  spN = 0;
+  spValid = false;
+  luAlgo = 0;
+  kTol = KRYLOV_TOL;
+  kFill = KRYLOV_FILL;
+  kN = 0;
+  kValid = false;
+  kSolves = kIterations = kFallbacks = 0;
+  kResidual = 0.0;
+  mpNorm = 0.0;
+  mpValid = mpDirect = false;
 }
 
 //! Destructor deletes the eqnsys class object.
@@ -83,6 +112,7 @@ eqnsys<nr_type_t>::~eqnsys () {
 template <class nr_type_t>
 eqnsys<nr_type_t>::eqnsys (eqnsys & e) {
   A = e.A;
+  As = e.As;
   V = NULL;
   S = E = NULL;
   T = R = NULL;
@@ -92,6 +122,17 @@ eqnsys<nr_type_t>::eqnsys (eqnsys & e) {
   update = 1;
   X = e.X;
   N = 0;
+  spN = 0;
+  spValid = false;
+  luAlgo = 0;
+  kTol = e.kTol;
+  kFill = e.kFill;
+  kN = 0;
+  kValid = false;
+  kSolves = kIterations = kFallbacks = 0;
+  kResidual = 0.0;
+  mpNorm = 0.0;
+  mpValid = mpDirect = false;
 }
 
 /*! With this function the describing matrices for the equation system
@@ -105,6 +146,7 @@ void eqnsys<nr_type_t>::passEquationSys (tmatrix<nr_type_t> * nA,
 					 tvector<nr_type_t> * nB) {
   if (nA != NULL) {
     A = nA;
+    As = NULL;
     update = 1;
     if (N != A->getCols ()) {
       N = A->getCols ();
@@ -116,8 +158,40 @@ void eqnsys<nr_type_t>::passEquationSys (tmatrix<nr_type_t> * nA,
   else {
     update = 0;
   }
-  delete B;
-  B = new tvector<nr_type_t> (*nB);
+  // keep the copy of the right hand side vector if its size fits
+  if (B != NULL && B->size () == nB->size ())
+    *B = *nB;
+  else {
+    delete B;
+    B = new tvector<nr_type_t> (*nB);
+  }
+  X = refX;
+}
+
+/*! This function passes a sparse left hand side matrix to the equation
+   system solver.  It can only be used together with the sparse LU
+   decomposition algorithms.  Passing a NULL matrix keeps the previous
+   factorization and only solves for the new right hand side. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::passEquationSys (tspmatrix<nr_type_t> * nA,
+					 tvector<nr_type_t> * refX,
+					 tvector<nr_type_t> * nB) {
+  if (nA != NULL) {
+    As = nA;
+    A = NULL;
+    update = 1;
+    N = As->getCols ();
+  }
+  else {
+    update = 0;
+  }
+  // keep the copy of the right hand side vector if its size fits
+  if (B != NULL && B->size () == nB->size ())
+    *B = *nB;
+  else {
+    delete B;
+    B = new tvector<nr_type_t> (*nB);
+  }
   X = refX;
 }
 
@@ -126,6 +200,7 @@ void eqnsys<nr_type_t>::passEquationSys (tmatrix<nr_type_t> * nA,
    pointed to by the X matrix reference. */
 template <class nr_type_t>
 void eqnsys<nr_type_t>::solve (void) {
+  TRACE_SCOPE ("eqnsys::solve");
 #if DEBUG && 0
   time_t t = time (NULL);
 #endif
@@ -157,6 +232,21 @@ void eqnsys<nr_type_t>::solve (void) {
   case ALGO_LU_SUBSTITUTION_DOOLITTLE:
     substitute_lu_doolittle ();
     break;
+  case ALGO_LU_DECOMPOSITION_SPARSE:
+    solve_lu_sparse ();
+    break;
+  case ALGO_LU_DECOMPOSITION_MIXED:
+    solve_lu_mixed ();
+    break;
+  case ALGO_LU_FACTORIZATION_SPARSE:
+    factorize_lu_sparse ();
+    break;
+  case ALGO_LU_SUBSTITUTION_SPARSE:
+    substitute_lu_sparse ();
+    break;
+  case ALGO_BICGSTAB: case ALGO_GMRES:
+    solve_krylov ();
+    break;
   case ALGO_JACOBI: case ALGO_GAUSS_SEIDEL:
     solve_iterative ();
     break;
@@ -182,6 +272,120 @@ void eqnsys<nr_type_t>::solve (void) {
 #endif
 }
 
+/*! The function decomposes the matrix passed last to the equation
+   system solver without solving for a right hand side.  The LU
+   decomposition of the current algorithm is used, i.e. the sparse one
+   or Doolittle's definition if requested and Crout's definition
+   otherwise.  An unchanged matrix re-uses the factors of the previous
+   decomposition.  Afterwards the algorithm is set to the appropriate
+   substitution, thus solveMany() or passing further right hand sides
+   and calling solve() just run the forward and backward
+   substitutions. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::factorize (void) {
+  switch (algo) {
+  case ALGO_LU_DECOMPOSITION_SPARSE:
+  case ALGO_LU_FACTORIZATION_SPARSE:
+  case ALGO_LU_SUBSTITUTION_SPARSE:
+    factorize_lu_sparse ();
+    algo = ALGO_LU_SUBSTITUTION_SPARSE;
+    break;
+  case ALGO_LU_DECOMPOSITION_DOOLITTLE:
+  case ALGO_LU_FACTORIZATION_DOOLITTLE:
+  case ALGO_LU_SUBSTITUTION_DOOLITTLE:
+    algo = ALGO_LU_DECOMPOSITION_DOOLITTLE;
+    decompose_lu (false);
+    algo = ALGO_LU_SUBSTITUTION_DOOLITTLE;
+    break;
+  default:
+    algo = ALGO_LU_DECOMPOSITION_CROUT;
+    decompose_lu (true);
+    algo = ALGO_LU_SUBSTITUTION_CROUT;
+    break;
+  }
+  update = 0;
+}
+
+/*! The function solves the equation system for each column of the nB
+   matrix using the factors of the last call to factorize() and stores
+   the solutions into the columns of the nX matrix, which must not be
+   the nB matrix.  The dense substitutions run for all right hand sides
+   at once along the matrix rows, such that one factorization and
+   these substitutions replace a factorization per right hand side.
+   The same holds for the sparse substitutions running along the
+   columns of the factors. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::solveMany (tmatrix<nr_type_t> * nB,
+				   tmatrix<nr_type_t> * nX) {
+  int i, c, k, K = nB->getCols ();
+  assert (nB->getRows () == N && nX->getRows () == N &&
+	  nX->getCols () == K && nB != nX);
+
+  // the sparse factors are applied to all columns at once, each entry
+  // of the factors is loaded once for the whole block
+  if (algo == ALGO_LU_SUBSTITUTION_SPARSE) {
+    std::vector<nr_type_t> w (nB->getData (), nB->getData () + N * K);
+    std::vector<nr_type_t> t (N * K);
+    int p;
+
+    // forward substitution in order to solve LY = PB
+    for (c = 0; c < N; c++) {
+      nr_type_t * tc = &t[c * K], * wr = &w[spProw[c] * K];
+      for (k = 0; k < K; k++) tc[k] = wr[k];
+      for (p = spLp[c]; p < spLp[c + 1]; p++) {
+	nr_type_t f = spLx[p], * wi = &w[spLi[p] * K];
+	for (k = 0; k < K; k++) wi[k] -= f * tc[k];
+      }
+    }
+
+    // backward substitution in order to solve UZ = Y
+    for (c = N - 1; c >= 0; c--) {
+      nr_type_t d = spUd[c], * tc = &t[c * K];
+      for (k = 0; k < K; k++) tc[k] /= d;
+      for (p = spUp[c]; p < spUp[c + 1]; p++) {
+	nr_type_t f = spUx[p], * ti = &t[spUi[p] * K];
+	for (k = 0; k < K; k++) ti[k] -= f * tc[k];
+      }
+    }
+
+    // undo the column ordering
+    nr_type_t * x = nX->getData ();
+    for (c = 0; c < N; c++)
+      for (k = 0; k < K; k++) x[spQ[c] * K + k] = t[c * K + k];
+    return;
+  }
+
+  // remember that the diagonal of U is one in Crout's definition and
+  // the one of L in Doolittle's definition
+  bool crout = algo != ALGO_LU_SUBSTITUTION_DOOLITTLE;
+  nr_type_t * a = A->getData ();
+  nr_type_t * x = nX->getData ();
+  nr_type_t * b = nB->getData ();
+
+  // forward substitution in order to solve LY = B
+  for (i = 0; i < N; i++) {
+    nr_type_t * xi = x + i * K, * ai = a + i * N, * bi = b + rMap[i] * K;
+    for (k = 0; k < K; k++) xi[k] = bi[k];
+    for (c = 0; c < i; c++) {
+      nr_type_t f = ai[c], * xc = x + c * K;
+      if (f == 0.0) continue;
+      for (k = 0; k < K; k++) xi[k] -= f * xc[k];
+    }
+    if (crout) for (k = 0; k < K; k++) xi[k] /= ai[i];
+  }
+
+  // backward substitution in order to solve UX = Y
+  for (i = N - 1; i >= 0; i--) {
+    nr_type_t * xi = x + i * K, * ai = a + i * N;
+    for (c = i + 1; c < N; c++) {
+      nr_type_t f = ai[c], * xc = x + c * K;
+      if (f == 0.0) continue;
+      for (k = 0; k < K; k++) xi[k] -= f * xc[k];
+    }
+    if (!crout) for (k = 0; k < K; k++) xi[k] /= ai[i];
+  }
+}
+
 /*! Simple matrix inversion is used to solve the equation system. */
 template <class nr_type_t>
 void eqnsys<nr_type_t>::solve_inverse (void) {
@@ -277,11 +481,8 @@ void eqnsys<nr_type_t>::solve_gauss_jordan (void) {
 
 #define LU_FAILURE 0
 #define VIRTUAL_RES(txt,i) {					  \
-  qucs::exception * e = new qucs::exception (EXCEPTION_SINGULAR); \
-  e->setText (txt);						  \
-  e->setData (rMap[i]);						  \
   A_(i, i) = NR_TINY; /* virtual resistance to ground */	  \
-  throw_exception (e); }
+  numstatus::raise (EXCEPTION_SINGULAR, rMap[i], txt); }
 
 /*! The function uses LU decomposition and the appropriate forward and
    backward substitutions in order to solve the linear equation
@@ -292,38 +493,254 @@ template <class nr_type_t>
 void eqnsys<nr_type_t>::solve_lu_crout (void) {
 
   // skip decomposition if requested
-  if (update) {
-    // perform LU composition
-    factorize_lu_crout ();
-  }
+  if (update) decompose_lu (true);
 
   // finally solve the equation system
   substitute_lu_crout ();
 }
 
+/*! The function performs the LU decomposition of the A matrix (Crout's
+   or Doolittle's definition) unless the matrix did not change since
+   the last decomposition by the current algorithm. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::decompose_lu (bool crout) {
+  if (reuse_lu ()) return;
+  tmatrix<nr_type_t> M = *A;
+  int mark = numstatus::mark ();
+  if (crout)
+    factorize_lu_crout ();
+  else
+    factorize_lu_doolittle ();
+  keep_lu (M, mark);
+}
+
+/*! The function checks whether the A matrix equals the matrix of the
+   last LU decomposition by the current algorithm.  If so, the A matrix
+   is replaced by the previous factors and the function returns true.
+   Transient analyses of mostly linear circuits re-use the factors this
+   way as long as the step size does not change. */
+template <class nr_type_t>
+bool eqnsys<nr_type_t>::reuse_lu (void) {
+  if (luAlgo != algo || luA.getCols () != N || A->getCols () != N)
+    return false;
+  size_t size = sizeof (nr_type_t) * N * N;
+  if (memcmp (A->getData (), luA.getData (), size)) return false;
+  memcpy (A->getData (), luF.getData (), size);
+  return true;
+}
+
+/*! Saves the given matrix and its LU factors (the current A matrix)
+   for reuse.  Failed decompositions or factors computed with the help
+   of virtual resistances, i.e. if failures have been raised since the
+   given mark, are not saved. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::keep_lu (tmatrix<nr_type_t> & M, int mark) {
+  if (numstatus::raised (mark)) return;
+  luA = std::move (M);
+  luF = *A;
+  luAlgo = algo;
+}
+
 /*! The other LU decomposition. */
 template <class nr_type_t>
 void eqnsys<nr_type_t>::solve_lu_doolittle (void) {
 
   // skip decomposition if requested
-  if (update) {
-    // perform LU composition
-    factorize_lu_doolittle ();
-  }
+  if (update) decompose_lu (false);
 
   // finally solve the equation system
   substitute_lu_doolittle ();
 }
 
+/* Complex and real products of single precision values accumulated
+   into the given vector, y += a * x.  The complex one is written out
+   such that the loop is vectorised by the compiler. */
+static inline void axpy_single (float * y, const float a, const float * x,
+				int n) {
+  for (int i = 0; i < n; i++) y[i] += a * x[i];
+}
+
+static inline void axpy_single (std::complex<float> * y,
+				const std::complex<float> a,
+				const std::complex<float> * x, int n) {
+  float * py = reinterpret_cast<float *> (y);
+  const float * px = reinterpret_cast<const float *> (x);
+  float ar = real (a), ai = imag (a);
+  for (int i = 0; i < n; i++) {
+    float xr = px[2 * i], xi = px[2 * i + 1];
+    py[2 * i]     += ar * xr - ai * xi;
+    py[2 * i + 1] += ar * xi + ai * xr;
+  }
+}
+
+/*! The mixed precision LU decomposition.  The A matrix is decomposed
+   in single precision, which halves the memory traffic of the
+   decomposition, and the solution is refined iteratively using the
+   residual computed with the double precision A matrix, which is left
+   untouched.  Unless the refinement reaches double precision accuracy
+   within MIXED_MAXITER iterations or whenever it stagnates the system
+   is solved by Crout's LU decomposition of the A matrix instead. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::solve_lu_mixed (void) {
+  int i, c, iter;
+
+  // new matrix requires a new single precision decomposition
+  if (update) {
+    mpDirect = false;
+    mpValid = factorize_lu_mixed ();
+  }
+
+  // the A matrix already holds the double precision factors
+  if (mpDirect) {
+    substitute_lu_crout ();
+    return;
+  }
+
+  std::vector<nr_type_t> x (N, 0.0), r (N), d (N);
+  nr_double_t bnorm = 0.0, xnorm, rnorm;
+  nr_double_t prev = std::numeric_limits<nr_double_t>::max ();
+  for (i = 0; i < N; i++) {
+    r[i] = B_(i);
+    bnorm = std::max (bnorm, (nr_double_t) abs (r[i]));
+  }
+
+  // iterative refinement of the solution
+  bool conv = bnorm == 0.0;
+  for (iter = 0; mpValid && !conv && iter < MIXED_MAXITER; iter++) {
+    // correction by the single precision factors
+    d = r;
+    substitute_lu_mixed (d);
+    for (xnorm = 0.0, i = 0; i < N; i++) {
+      x[i] += d[i];
+      xnorm = std::max (xnorm, (nr_double_t) abs (x[i]));
+    }
+    // residual in double precision
+    nr_type_t * a = A->getData ();
+    for (rnorm = 0.0, i = 0; i < N; i++, a += N) {
+      nr_type_t f = B_(i);
+      for (c = 0; c < N; c++) f -= a[c] * x[c];
+      r[i] = f;
+      rnorm = std::max (rnorm, (nr_double_t) abs (f));
+    }
+    if (!std::isfinite (rnorm)) break;
+    conv = rnorm <= std::sqrt ((nr_double_t) N) *
+      std::numeric_limits<nr_double_t>::epsilon () * mpNorm * xnorm;
+    // stop if the residual does not decrease sufficiently
+    if (rnorm > MIXED_STAGNATION * prev) break;
+    prev = rnorm;
+  }
+
+  if (conv) {
+    for (i = 0; i < N; i++) X_(i) = x[i];
+    return;
+  }
+
+#if DEBUG
+  logprint (LOG_STATUS, "NOTIFY: mixed precision refinement failed after %d "
+	    "iterations, using double precision LU decomposition\n", iter);
+#endif
+  mpDirect = true;
+  update = 1;
+  solve_lu_crout ();
+}
+
+/*! The function decomposes a single precision copy of the A matrix
+   using partial row pivoting.  It returns false if the matrix is
+   singular in single precision. */
+template <class nr_type_t>
+bool eqnsys<nr_type_t>::factorize_lu_mixed (void) {
+  typedef typename eqnsys_single<nr_type_t>::type single_t;
+  int i, j, k, p;
+
+  mpF.resize (N * N);
+  mpP.resize (N);
+  nr_type_t * a = A->getData ();
+  mpNorm = 0.0;
+  for (i = 0; i < N; i++) {
+    nr_double_t s = 0.0;
+    for (j = 0; j < N; j++) {
+      mpF[i * N + j] = single_t (a[i * N + j]);
+      s += abs (a[i * N + j]);
+    }
+    mpNorm = std::max (mpNorm, s);
+  }
+  if (!std::isfinite (mpNorm)) return false;
+
+  single_t * F = &mpF[0];
+  for (k = 0; k < N; k++) {
+    // find the pivot row
+    float max = 0.0;
+    for (p = k, i = k; i < N; i++) {
+      float v = abs (F[i * N + k]);
+      if (v > max) {
+	max = v;
+	p = i;
+      }
+    }
+    if (max == 0.0 || !std::isfinite (max)) return false;
+    mpP[k] = p;
+    if (p != k) std::swap_ranges (F + k * N, F + k * N + N, F + p * N);
+
+    // eliminate the column below the pivot
+    single_t d = single_t (1.0) / F[k * N + k];
+    for (i = k + 1; i < N; i++) {
+      single_t f = F[i * N + k] *= d;
+      if (f != single_t (0.0))
+	axpy_single (F + i * N + k + 1, -f, F + k * N + k + 1, N - k - 1);
+    }
+  }
+  return true;
+}
+
+/*! Solves the system for the given right hand side using the single
+   precision factors.  The result replaces the given vector. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::substitute_lu_mixed (std::vector<nr_type_t> & v) {
+  typedef typename eqnsys_single<nr_type_t>::type single_t;
+  std::vector<single_t> y (N);
+  const single_t * F = &mpF[0];
+  int i, c;
+
+  // apply the row interchanges
+  for (i = 0; i < N; i++) y[i] = single_t (v[i]);
+  for (i = 0; i < N; i++) if (mpP[i] != i) std::swap (y[i], y[mpP[i]]);
+
+  // forward substitution with the ones on the diagonal of L
+  for (i = 0; i < N; i++) {
+    single_t f = y[i];
+    for (c = 0; c < i; c++) f -= F[i * N + c] * y[c];
+    y[i] = f;
+  }
+  // backward substitution
+  for (i = N - 1; i >= 0; i--) {
+    single_t f = y[i];
+    for (c = i + 1; c < N; c++) f -= F[i * N + c] * y[c];
+    y[i] = f / F[i * N + i];
+  }
+  for (i = 0; i < N; i++) v[i] = y[i];
+}
+
 /*! This function decomposes the left hand matrix into an upper U and
    lower L matrix.  The algorithm is called LU decomposition (Crout's
    definition).  The function performs the actual LU decomposition of
-   the matrix A using (implicit) partial row pivoting. */
+   the matrix A using (implicit) partial row pivoting.
+
+   The decomposition is right-looking and blocked: a panel of
+   TMATRIX_BLOCK columns is decomposed, then the block row of U right
+   of it is computed and the remaining matrix updated by the product
+   of both.  Apart from the panel everything runs along matrix rows,
+   which keeps the data in the cache and lets the compiler vectorize
+   the inner loops.  The pivots chosen are the same as the ones of the
+   column-wise Crout algorithm. */
 template <class nr_type_t>
 void eqnsys<nr_type_t>::factorize_lu_crout (void) {
   nr_double_t d, MaxPivot;
   nr_type_t f;
-  int k, c, r, pivot;
+  int k, c, r, pivot, j, pb, pe;
+  nr_type_t * a = A->getData ();
+
+  // the saved factors are replaced
+  luAlgo = 0;
 
   // initialize pivot exchange table
   for (r = 0; r < N; r++) {
@@ -335,45 +752,70 @@ void eqnsys<nr_type_t>::factorize_lu_crout (void) {
     rMap[r] = r;
   }
 
-  // decompose the matrix into L (lower) and U (upper) matrix
-  for (c = 0; c < N; c++) {
-    // upper matrix entries
-    for (r = 0; r < c; r++) {
-      f = A_(r, c);
-      for (k = 0; k < r; k++) f -= A_(r, k) * A_(k, c);
-      A_(r, c) = f / A_(r, r);
-    }
-    // lower matrix entries
-    for (MaxPivot = 0, pivot = r; r < N; r++) {
-      f = A_(r, c);
-      for (k = 0; k < c; k++) f -= A_(r, k) * A_(k, c);
-      A_(r, c) = f;
-      // larger pivot ?
-      if ((d = nPvt[r] * abs (f)) > MaxPivot) {
-	MaxPivot = d;
-	pivot = r;
+  for (pb = 0; pb < N; pb = pe) {
+    pe = std::min (pb + TMATRIX_BLOCK, N);
+
+    // decompose the panel of columns pb to pe - 1
+    for (c = pb; c < pe; c++) {
+      // find the pivot among the lower matrix entries
+      for (MaxPivot = 0, pivot = r = c; r < N; r++) {
+	if ((d = nPvt[r] * abs (A_(r, c))) > MaxPivot) {
+	  MaxPivot = d;
+	  pivot = r;
+	}
       }
-    }
 
-    // check pivot element and throw appropriate exception
-    if (MaxPivot <= 0) {
+      // check pivot element and raise the appropriate failure
+      if (MaxPivot <= 0) {
 #if LU_FAILURE
-      qucs::exception * e = new qucs::exception (EXCEPTION_PIVOT);
-      e->setText ("no pivot != 0 found during Crout LU decomposition");
-      e->setData (c);
-      throw_exception (e);
-      goto fail;
+	numstatus::raise (EXCEPTION_PIVOT, c,
+			  "no pivot != 0 found during Crout LU decomposition");
+	goto fail;
 #else /* insert virtual resistance */
-      VIRTUAL_RES ("no pivot != 0 found during Crout LU decomposition", c);
+	VIRTUAL_RES ("no pivot != 0 found during Crout LU decomposition", c);
 #endif
+      }
+
+      // swap matrix rows if necessary and remember that step in the
+      // exchange table
+      if (c != pivot) {
+	A->exchangeRows (c, pivot);
+	Swap (int, rMap[c], rMap[pivot]);
+	Swap (nr_double_t, nPvt[c], nPvt[pivot]);
+      }
+
+      // upper matrix entries of this row and update of the panel
+      for (k = c + 1; k < pe; k++) A_(c, k) /= A_(c, c);
+      for (r = c + 1; r < N; r++) {
+	f = A_(r, c);
+	for (k = c + 1; k < pe; k++) A_(r, k) -= f * A_(c, k);
+      }
+    }
+    if (pe == N) break;
+
+    // upper matrix entries right of the panel
+    for (r = pb; r < pe; r++) {
+      nr_type_t * u = &a[r * N];
+      for (k = pb; k < r; k++) {
+	const nr_type_t * v = &a[k * N];
+	f = u[k];
+	for (j = pe; j < N; j++) u[j] -= f * v[j];
+      }
+      f = u[r];
+      for (j = pe; j < N; j++) u[j] /= f;
     }
 
-    // swap matrix rows if necessary and remember that step in the
-    // exchange table
-    if (c != pivot) {
-      A->exchangeRows (c, pivot);
-      Swap (int, rMap[c], rMap[pivot]);
-      Swap (nr_double_t, nPvt[c], nPvt[pivot]);
+    // update the remaining matrix, blocked along the columns
+    for (c = pe; c < N; c += TMATRIX_BLOCK) {
+      int ce = std::min (c + TMATRIX_BLOCK, N);
+      for (r = pe; r < N; r++) {
+	nr_type_t * u = &a[r * N];
+	for (k = pb; k < pe; k++) {
+	  const nr_type_t * v = &a[k * N];
+	  f = u[k];
+	  for (j = c; j < ce; j++) u[j] -= f * v[j];
+	}
+      }
     }
   }
 #if LU_FAILURE
@@ -391,6 +833,9 @@ void eqnsys<nr_type_t>::factorize_lu_doolittle (void) {
   nr_type_t f;
   int k, c, r, pivot;
 
+  // the saved factors are replaced
+  luAlgo = 0;
+
   // initialize pivot exchange table
   for (r = 0; r < N; r++) {
     for (MaxPivot = 0, c = 0; c < N; c++)
@@ -421,13 +866,11 @@ void eqnsys<nr_type_t>::factorize_lu_doolittle (void) {
       }
     }
 
-    // check pivot element and throw appropriate exception
+    // check pivot element and raise the appropriate failure
     if (MaxPivot <= 0) {
 #if LU_FAILURE
-      qucs::exception * e = new qucs::exception (EXCEPTION_PIVOT);
-      e->setText ("no pivot != 0 found during Doolittle LU decomposition");
-      e->setData (c);
-      throw_exception (e);
+      numstatus::raise (EXCEPTION_PIVOT, c,
+			"no pivot != 0 found during Doolittle LU decomposition");
       goto fail;
 #else /* insert virtual resistance */
       VIRTUAL_RES ("no pivot != 0 found during Doolittle LU decomposition", c);
@@ -502,6 +945,870 @@ void eqnsys<nr_type_t>::substitute_lu_doolittle (void) {
   }
 }
 
+/*! The sparse LU decomposition.  The algorithm works on the
+   sparsity pattern of the A matrix only.  The fill-reducing column
+   ordering is computed once for each pattern, subsequent calls with a
+   matrix of the same (or smaller) pattern just redo the numerical
+   factorization re-using the pivot sequence and the structure of the
+   L and U factors.  Unlike the dense decompositions the A matrix is
+   left untouched. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::solve_lu_sparse (void) {
+
+  // skip decomposition if requested
+  if (update) {
+    // perform LU composition
+    factorize_lu_sparse ();
+  }
+
+  // finally solve the equation system
+  substitute_lu_sparse ();
+}
+
+/*! The function decomposes the A matrix into the sparse L and U
+   factors.  If the sparsity pattern did not change since the last
+   factorization the numerical values are recomputed only.  Whenever
+   the previous pivot sequence turns out to be numerically unsuitable
+   a complete factorization with threshold partial pivoting is
+   performed. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::factorize_lu_sparse (void) {
+
+  // convert the system matrix into compressed columns
+  extract_sparse ();
+
+  // new pattern requires a new column ordering (symbolic analysis)
+  if (!pattern_sparse ()) {
+    if (!seeded_sparse ()) order_sparse ();
+    spValid = false;
+  }
+
+  if (spValid) {
+    bool grown;
+    int first = changed_sparse (grown);
+
+    // the factors of an unchanged matrix are still valid
+    if (first >= N) return;
+
+    /* Columns changing between factorizations are ordered last, then
+       refactorizing the columns in front of them can be skipped. */
+    if (grown) {
+      order_sparse ();
+      spValid = false;
+    }
+    // try re-using the previous pivot sequence first
+    else if (refactorize_sparse (first)) {
+      keep_sparse ();
+      return;
+    }
+  }
+
+  // perform a complete factorization
+  int mark = numstatus::mark ();
+  decompose_sparse ();
+  if (!numstatus::raised (mark))
+    keep_sparse ();
+  else
+    spOp.clear ();
+}
+
+/*! The function compares the current matrix with the one of the last
+   factorization and marks the changed columns as volatile.  It returns
+   the first changed position of the column ordering (N if there is
+   none) and whether new volatile columns have been found. */
+template <class nr_type_t>
+int eqnsys<nr_type_t>::changed_sparse (bool & grown) {
+  int c, p, q, n, first = N;
+
+  grown = false;
+  if ((int) spOp.size () != N + 1) return 0;
+  for (c = 0; c < N; c++) {
+    p = spCp[c];
+    q = spOp[c];
+    n = spCp[c + 1] - p;
+    if (n == spOp[c + 1] - q &&
+	std::equal (spCi.begin () + p, spCi.begin () + p + n,
+		    spOi.begin () + q) &&
+	std::equal (spCx.begin () + p, spCx.begin () + p + n,
+		    spOx.begin () + q))
+      continue;
+    first = std::min (first, spQinv[c]);
+    if (!spVol[c]) {
+      spVol[c] = 1;
+      grown = true;
+    }
+  }
+  return first;
+}
+
+/*! Saves the matrix the current factors have been computed for. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::keep_sparse (void) {
+  spOp = spCp;
+  spOi = spCi;
+  spOx = spCx;
+}
+
+/*! The function runs the forward and backward substitutions using the
+   sparse L and U factors.  The solution is stored into the X vector. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::substitute_lu_sparse (void) {
+  nr_type_t f;
+  int i, k, p;
+
+  // forward substitution in order to solve LY = PB
+  for (i = 0; i < N; i++) spW[i] = B_(i);
+  for (k = 0; k < N; k++) {
+    f = spT[k] = spW[spProw[k]];
+    for (p = spLp[k]; p < spLp[k + 1]; p++) spW[spLi[p]] -= spLx[p] * f;
+  }
+  // the factorizations expect a cleared work vector
+  for (i = 0; i < N; i++) spW[i] = 0.0;
+
+  // backward substitution in order to solve UZ = Y
+  for (k = N - 1; k >= 0; k--) {
+    f = spT[k] /= spUd[k];
+    for (p = spUp[k]; p < spUp[k + 1]; p++) spT[spUi[p]] -= spUx[p] * f;
+  }
+
+  // undo the column ordering
+  for (k = 0; k < N; k++) X_(spQ[k]) = spT[k];
+}
+
+/*! This function stores the non-zero entries of the A matrix in
+   compressed column form. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::extract_sparse (void) {
+
+  // a sparse matrix can be taken over as is
+  if (As != NULL) {
+    int nnz = As->getNnz ();
+    spCp.assign (As->getColPtr (), As->getColPtr () + N + 1);
+    spCi.assign (As->getRowIdx (), As->getRowIdx () + nnz);
+    spCx.assign (As->getData (), As->getData () + nnz);
+    return;
+  }
+
+  nr_type_t * data = A->getData ();
+  int r, c, nnz;
+
+  spCp.assign (N + 1, 0);
+  for (r = 0; r < N; r++)
+    for (c = 0; c < N; c++)
+      if (data[r * N + c] != 0.0) spCp[c + 1]++;
+  for (c = 0; c < N; c++) spCp[c + 1] += spCp[c];
+  nnz = spCp[N];
+  spCi.resize (nnz);
+  spCx.resize (nnz);
+  std::vector<int> pos (spCp.begin (), spCp.end () - 1);
+  for (r = 0; r < N; r++) {
+    for (c = 0; c < N; c++) {
+      if (data[r * N + c] != 0.0) {
+	spCi[pos[c]] = r;
+	spCx[pos[c]++] = data[r * N + c];
+      }
+    }
+  }
+}
+
+/*! The function checks whether the current pattern is covered by the
+   pattern the symbolic analysis has been done for.  If not, the union
+   of both patterns is saved and the function returns false.  Keeping
+   the union prevents a new analysis each time an entry toggles between
+   zero and non-zero during the Newton iterations. */
+/* Returns true if the sorted column pattern (Ap, Ai) contains the
+   sorted column pattern (Bp, Bi) of N columns. */
+static inline bool covers_sparse (int N, const std::vector<int> & Ap,
+				  const std::vector<int> & Ai,
+				  const std::vector<int> & Bp,
+				  const std::vector<int> & Bi) {
+  for (int c = 0; c < N; c++) {
+    for (int q = Ap[c], p = Bp[c]; p < Bp[c + 1]; p++) {
+      while (q < Ap[c + 1] && Ai[q] < Bi[p]) q++;
+      if (q >= Ap[c + 1] || Ai[q] != Bi[p]) return false;
+    }
+  }
+  return true;
+}
+
+template <class nr_type_t>
+bool eqnsys<nr_type_t>::pattern_sparse (void) {
+  int c;
+
+  if (spN == N && covers_sparse (N, spAp, spAi, spCp, spCi)) return true;
+
+  // build the union of both patterns, diagonal entries always included
+  std::vector<int> Ap (N + 1, 0), Ai;
+  Ai.reserve (spCp[N] + N);
+  for (c = 0; c < N; c++) {
+    std::vector<int> col (spCi.begin () + spCp[c], spCi.begin () + spCp[c+1]);
+    col.push_back (c);
+    if (spN == N)
+      col.insert (col.end (), spAi.begin () + spAp[c],
+		  spAi.begin () + spAp[c + 1]);
+    std::sort (col.begin (), col.end ());
+    col.erase (std::unique (col.begin (), col.end ()), col.end ());
+    Ai.insert (Ai.end (), col.begin (), col.end ());
+    Ap[c + 1] = Ai.size ();
+  }
+  spAp.swap (Ap);
+  spAi.swap (Ai);
+
+  // (re-)allocate the working storage
+  if (spN != N) {
+    spN = N;
+    spW.assign (N, 0.0);
+    spT.assign (N, 0.0);
+    spMark.assign (N, -1);
+    spXi.assign (N, 0);
+    spPs.assign (N, 0);
+    spPp.assign (N, 0);
+    spPinv.assign (N, -1);
+    spProw.assign (N, 0);
+    spUd.assign (N, 0.0);
+    spQinv.assign (N, 0);
+    spVol.assign (N, 0);
+    spOp.clear ();
+  }
+  return false;
+}
+
+/*! The function takes over the symbolic analysis passed by
+   setOrdering() instead of computing a new column ordering, provided
+   it has been done for a pattern covering the current one.  It is
+   offered once, for the first pattern only. */
+template <class nr_type_t>
+bool eqnsys<nr_type_t>::seeded_sparse (void) {
+  bool fits = (int) sdQ.size () == N && (int) sdAp.size () == N + 1 &&
+    (int) sdVol.size () == N && sdAp[N] == (int) sdAi.size () &&
+    covers_sparse (N, sdAp, sdAi, spAp, spAi);
+  if (fits) {
+    spAp.swap (sdAp);
+    spAi.swap (sdAi);
+    spQ.swap (sdQ);
+    spVol.assign (sdVol.begin (), sdVol.end ());
+    for (int k = 0; k < N; k++) spQinv[spQ[k]] = k;
+  }
+  std::vector<int> ().swap (sdAp);
+  std::vector<int> ().swap (sdAi);
+  std::vector<int> ().swap (sdQ);
+  std::vector<int> ().swap (sdVol);
+  return fits;
+}
+
+/*! The function returns the symbolic analysis of the sparse LU
+   decomposition, i.e. the pattern it has been done for, the column
+   ordering and the volatile columns.  Returns false if there is
+   none. */
+template <class nr_type_t>
+bool eqnsys<nr_type_t>::getOrdering (std::vector<int> & Ap,
+				     std::vector<int> & Ai,
+				     std::vector<int> & Q,
+				     std::vector<int> & Vol) {
+  if (spN == 0 || spN != N || (int) spQ.size () != N) return false;
+  Ap = spAp;
+  Ai = spAi;
+  Q = spQ;
+  Vol.assign (spVol.begin (), spVol.end ());
+  return true;
+}
+
+/*! Passes a symbolic analysis as returned by getOrdering(), e.g. by
+   a previous run over the same netlist topology, unless the system
+   has been ordered already.  The next sparse factorization uses it
+   instead of a new column ordering if it fits the matrix, it is
+   dropped otherwise. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::setOrdering (const std::vector<int> & Ap,
+				     const std::vector<int> & Ai,
+				     const std::vector<int> & Q,
+				     const std::vector<int> & Vol) {
+  if (!spQ.empty ()) return;
+  sdAp = Ap;
+  sdAi = Ai;
+  sdQ = Q;
+  sdVol = Vol;
+}
+
+/*! The function computes a fill-reducing column ordering of the A
+   matrix by applying the minimum degree algorithm to the pattern of
+   A+A^T.  The preferred pivot for each column is its diagonal entry.
+   Volatile columns are eliminated after all other ones. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::order_sparse (void) {
+  std::vector< std::vector<int> > adj (N);
+  std::vector<int> scratch;
+  int c, p, k, i, j;
+
+  // symmetric adjacency lists without the diagonal
+  for (c = 0; c < N; c++) {
+    for (p = spAp[c]; p < spAp[c + 1]; p++) {
+      if ((i = spAi[p]) == c) continue;
+      adj[i].push_back (c);
+      adj[c].push_back (i);
+    }
+  }
+  std::set< std::pair<int,int> > degree;
+  auto rank = [&] (int u) {
+    return std::make_pair ((int) adj[u].size () + (spVol[u] ? N : 0), u);
+  };
+  for (i = 0; i < N; i++) {
+    std::sort (adj[i].begin (), adj[i].end ());
+    adj[i].erase (std::unique (adj[i].begin (), adj[i].end ()),
+		  adj[i].end ());
+    degree.insert (rank (i));
+  }
+
+  // eliminate the node of minimum degree and connect its neighbours
+  spQ.resize (N);
+  for (k = 0; k < N; k++) {
+    int v = degree.begin()->second;
+    degree.erase (degree.begin ());
+    spQ[k] = v;
+    std::vector<int> & nbrs = adj[v];
+    for (j = 0; j < (int) nbrs.size (); j++) {
+      int u = nbrs[j];
+      std::vector<int> & a = adj[u];
+      degree.erase (rank (u));
+      scratch.clear ();
+      std::set_union (a.begin (), a.end (), nbrs.begin (), nbrs.end (),
+		      std::back_inserter (scratch));
+      a.clear ();
+      for (i = 0; i < (int) scratch.size (); i++)
+	if (scratch[i] != u && scratch[i] != v) a.push_back (scratch[i]);
+      degree.insert (rank (u));
+    }
+    std::vector<int> ().swap (nbrs);
+  }
+  for (k = 0; k < N; k++) spQinv[spQ[k]] = k;
+}
+
+/*! The function computes the non-zero pattern of the k-th column of
+   the L and U factors, i.e. the set of rows reachable from the
+   pattern of A(:,Q[k]) in the graph of the L factor computed so far.
+   The rows are stored in topological order into spXi[top..N-1] and
+   the function returns top. */
+template <class nr_type_t>
+int eqnsys<nr_type_t>::reach_sparse (int k) {
+  int c = spQ[k], top = N, head, p, i, j, r;
+
+  for (p = spAp[c]; p < spAp[c + 1]; p++) {
+    if (spMark[spAi[p]] == k) continue;
+    // non-recursive depth-first search starting at this row
+    head = 0;
+    spPs[0] = spAi[p];
+    spPp[0] = -1;
+    spMark[spAi[p]] = k;
+    while (head >= 0) {
+      i = spPs[head];
+      j = spPinv[i];
+      if (j < 0) {
+	// not yet pivoted, thus no outgoing edges
+	spXi[--top] = i;
+	head--;
+	continue;
+      }
+      if (spPp[head] < 0) spPp[head] = spLp[j];
+      for (; spPp[head] < spLp[j + 1]; spPp[head]++) {
+	r = spLi[spPp[head]];
+	if (spMark[r] != k) break;
+      }
+      if (spPp[head] < spLp[j + 1]) {
+	// descend into the unvisited row
+	spPp[head]++;
+	spMark[r] = k;
+	spPs[++head] = r;
+	spPp[head] = -1;
+      }
+      else {
+	spXi[--top] = i;
+	head--;
+      }
+    }
+  }
+  return top;
+}
+
+//! Threshold for preferring the diagonal as pivot element.
+#define SPARSE_DIAG_TOL 0.1
+//! Minimum relative pivot magnitude when re-using the pivot sequence.
+#define SPARSE_REFACTOR_TOL 1e-3
+
+/*! The function performs a left-looking (Gilbert-Peierls) sparse LU
+   decomposition of the column ordered A matrix using threshold
+   partial pivoting.  Zero pivots are replaced by a virtual resistance
+   like in the dense decompositions. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::decompose_sparse (void) {
+  nr_double_t d, MaxPivot;
+  nr_type_t f;
+  int k, p, px, i, j, c, top, pivot;
+
+  spLp.assign (N + 1, 0);
+  spUp.assign (N + 1, 0);
+  spLi.clear (); spLx.clear ();
+  spUi.clear (); spUx.clear ();
+  spPinv.assign (N, -1);
+  spMark.assign (N, -1);
+
+  for (k = 0; k < N; k++) {
+    c = spQ[k];
+
+    // compute the pattern of the k-th column of L and U
+    top = reach_sparse (k);
+
+    // scatter the current values of the column into the work vector
+    for (p = spCp[c]; p < spCp[c + 1]; p++) spW[spCi[p]] = spCx[p];
+
+    // sparse triangular solve of Lx = A(:,c)
+    for (px = top; px < N; px++) {
+      i = spXi[px];
+      if ((j = spPinv[i]) < 0) continue;
+      f = spW[i];
+      for (p = spLp[j]; p < spLp[j + 1]; p++) spW[spLi[p]] -= spLx[p] * f;
+    }
+
+    // save upper matrix entries and look for the largest pivot
+    for (MaxPivot = 0, pivot = -1, px = top; px < N; px++) {
+      i = spXi[px];
+      if (spPinv[i] >= 0) {
+	spUi.push_back (spPinv[i]);
+	spUx.push_back (spW[i]);
+      }
+      else if ((d = abs (spW[i])) > MaxPivot) {
+	MaxPivot = d;
+	pivot = i;
+      }
+    }
+
+    // prefer the diagonal element if it is large enough
+    if (spPinv[c] < 0 && spMark[c] == k &&
+	abs (spW[c]) >= SPARSE_DIAG_TOL * MaxPivot && MaxPivot > 0)
+      pivot = c;
+
+    // check pivot element and insert virtual resistance to ground
+    if (MaxPivot <= 0) {
+      if (spPinv[c] < 0)
+	pivot = c;
+      else
+	for (pivot = 0; spPinv[pivot] >= 0; pivot++) ;
+      spW[pivot] = NR_TINY;
+      numstatus::raise (EXCEPTION_SINGULAR, pivot,
+			"no pivot != 0 found during sparse LU decomposition");
+    }
+
+    // remember the pivot step
+    spPinv[pivot] = k;
+    spProw[k] = pivot;
+    spUd[k] = f = spW[pivot];
+    spW[pivot] = 0.0;
+
+    // lower matrix entries
+    for (px = top; px < N; px++) {
+      i = spXi[px];
+      if (spPinv[i] < 0) {
+	spLi.push_back (i);
+	spLx.push_back (spW[i] / f);
+      }
+      spW[i] = 0.0;
+    }
+    spLp[k + 1] = spLi.size ();
+    spUp[k + 1] = spUi.size ();
+  }
+  spValid = true;
+}
+
+/*! The function re-computes the numerical values of the L and U
+   factors based on the pivot sequence and structure of the last
+   complete decomposition.  The columns in front of the given position
+   did not change and are kept.  It returns false if a pivot element
+   becomes too small, the factors are unusable then. */
+template <class nr_type_t>
+bool eqnsys<nr_type_t>::refactorize_sparse (int first) {
+  nr_double_t MaxPivot;
+  nr_type_t f;
+  int k, p, q, j, c;
+  bool ok = true;
+
+  for (k = first; ok && k < N; k++) {
+    c = spQ[k];
+
+    // scatter the current values of the column into the work vector
+    for (p = spCp[c]; p < spCp[c + 1]; p++) spW[spCi[p]] = spCx[p];
+
+    // upper matrix entries, stored in topological order
+    for (p = spUp[k]; p < spUp[k + 1]; p++) {
+      j = spUi[p];
+      f = spUx[p] = spW[spProw[j]];
+      spW[spProw[j]] = 0.0;
+      for (q = spLp[j]; q < spLp[j + 1]; q++) spW[spLi[q]] -= spLx[q] * f;
+    }
+
+    // check the pivot element against the lower matrix entries
+    f = spW[spProw[k]];
+    spW[spProw[k]] = 0.0;
+    for (MaxPivot = 0, p = spLp[k]; p < spLp[k + 1]; p++)
+      MaxPivot = std::max (MaxPivot, (nr_double_t) abs (spW[spLi[p]]));
+    if (f == 0.0 || abs (f) < SPARSE_REFACTOR_TOL * MaxPivot) ok = false;
+    spUd[k] = f;
+
+    // lower matrix entries
+    for (p = spLp[k]; p < spLp[k + 1]; p++) {
+      if (ok) spLx[p] = spW[spLi[p]] / f;
+      spW[spLi[p]] = 0.0;
+    }
+  }
+  spValid = ok;
+  return ok;
+}
+
+/*! Sets the relative residual tolerance and the fill level k of the
+   ILU(k) preconditioner used by the Krylov solvers.  The convergence
+   statistics are reset as well. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::setKrylov (nr_double_t tol, int fill) {
+  kTol = tol;
+  if (kFill != fill) kN = 0;
+  kFill = fill;
+  kSolves = kIterations = kFallbacks = 0;
+  kResidual = 0.0;
+}
+
+/*! The function solves the equation system using the stabilized
+   biconjugate gradient method (BiCGStab) or the restarted generalized
+   minimal residual method (GMRES) depending on the given algorithm.
+   Both work on the non-zero entries of the A matrix only and are
+   right preconditioned by its incomplete LU factorization.  The
+   current X vector is used as initial guess.  Unless the relative
+   residual drops below the requested tolerance the system is solved
+   by the sparse LU decomposition. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::solve_krylov (void) {
+
+  // a new matrix requires a new preconditioner
+  if (update || !kValid) {
+    extract_sparse ();
+    factorize_ilu ();
+  }
+
+  std::vector<nr_type_t> x (N), b (N);
+  for (int r = 0; r < N; r++) {
+    b[r] = B_(r);
+    x[r] = X_(r);
+    if (!std::isfinite (abs (x[r]))) x[r] = 0.0;
+  }
+
+  int iter = 0;
+  nr_double_t res = 0.0;
+  bool conv = algo == ALGO_GMRES ?
+    solve_gmres (x, b, iter, res) : solve_bicgstab (x, b, iter, res);
+  kSolves++;
+  kIterations += iter;
+  kResidual = std::max (kResidual, res);
+
+  if (conv) {
+    for (int r = 0; r < N; r++) X_(r) = x[r];
+#if DEBUG && 0
+    logprint (LOG_STATUS,
+	      "NOTIFY: %s convergence after %d iterations, residual %g\n",
+	      algo == ALGO_GMRES ? "gmres" : "bicgstab", iter, res);
+#endif
+    return;
+  }
+
+  logprint (LOG_ERROR,
+	    "WARNING: no convergence after %d %s iterations (residual %g)\n",
+	    iter, algo == ALGO_GMRES ? "gmres" : "bicgstab", res);
+  kFallbacks++;
+  update = 1;
+  solve_lu_sparse ();
+}
+
+/*! The function computes the sparsity pattern of the ILU(k) factors.
+   Each entry is given a level, the entries of the A matrix and the
+   diagonal have level zero and the fill-in of eliminating entry (i,k)
+   in row i by row k obtains the level of (i,k) plus the one of (k,j)
+   plus one.  Only entries up to the requested fill level are kept. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::pattern_ilu (void) {
+  int i, j, k, l, p, q;
+  std::vector<int> lev (N, -1), lvl;
+
+  kRp.assign (N + 1, 0);
+  kRi.clear ();
+  kDg.assign (N, 0);
+  for (i = 0; i < N; i++) {
+    std::set<int> row;
+    for (p = kAp[i]; p < kAp[i + 1]; p++) {
+      row.insert (kAi[p]);
+      lev[kAi[p]] = 0;
+    }
+    row.insert (i);
+    lev[i] = 0;
+    // new entries are right of the current one, thus visited later on
+    for (auto it = row.begin (); it != row.end () && *it < i; ++it) {
+      k = *it;
+      for (q = kDg[k] + 1; q < kRp[k + 1]; q++) {
+	if ((l = lev[k] + lvl[q] + 1) > kFill) continue;
+	j = kRi[q];
+	if (lev[j] < 0) {
+	  row.insert (j);
+	  lev[j] = l;
+	}
+	else if (l < lev[j]) lev[j] = l;
+      }
+    }
+    for (int c : row) {
+      if (c == i) kDg[i] = kRi.size ();
+      kRi.push_back (c);
+      lvl.push_back (lev[c]);
+      lev[c] = -1;
+    }
+    kRp[i + 1] = kRi.size ();
+  }
+}
+
+/*! This function computes the incomplete LU factors of the A matrix.
+   The rows of the A matrix are taken from its compressed columns.  The
+   symbolic analysis is only repeated if the pattern changed.  Zero
+   pivots are replaced by small values, the factors are used as a
+   preconditioner only. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::factorize_ilu (void) {
+  int i, j, k, p, q, nnz = spCp[N];
+
+  // transpose the compressed columns into compressed rows
+  kAp.assign (N + 1, 0);
+  kAi.resize (nnz);
+  kAx.resize (nnz);
+  for (p = 0; p < nnz; p++) kAp[spCi[p] + 1]++;
+  for (i = 0; i < N; i++) kAp[i + 1] += kAp[i];
+  std::vector<int> pos (kAp.begin (), kAp.end () - 1);
+  for (k = 0; k < N; k++) {
+    for (p = spCp[k]; p < spCp[k + 1]; p++) {
+      q = pos[spCi[p]]++;
+      kAi[q] = k;
+      kAx[q] = spCx[p];
+    }
+  }
+
+  // new pattern requires a new symbolic analysis
+  if (kN != N || kSp != spCp || kSi != spCi) {
+    pattern_ilu ();
+    kSp = spCp;
+    kSi = spCi;
+    kN = N;
+  }
+
+  // row by row elimination restricted to the pattern
+  kRx.assign (kRi.size (), 0.0);
+  kMap.assign (N, -1);
+  for (i = 0; i < N; i++) {
+    for (p = kRp[i]; p < kRp[i + 1]; p++) kMap[kRi[p]] = p;
+    for (p = kAp[i]; p < kAp[i + 1]; p++) kRx[kMap[kAi[p]]] = kAx[p];
+    for (p = kRp[i]; p < kDg[i]; p++) {
+      k = kRi[p];
+      nr_type_t f = kRx[p] /= kRx[kDg[k]];
+      for (q = kDg[k] + 1; q < kRp[k + 1]; q++) {
+	if ((j = kMap[kRi[q]]) >= 0) kRx[j] -= f * kRx[q];
+      }
+    }
+    if (kRx[kDg[i]] == 0.0) {
+      nr_double_t s = 0.0;
+      for (p = kAp[i]; p < kAp[i + 1]; p++) s = std::max (s, abs (kAx[p]));
+      kRx[kDg[i]] = s > 0.0 ? s * NR_TINY : 1.0;
+    }
+    for (p = kRp[i]; p < kRp[i + 1]; p++) kMap[kRi[p]] = -1;
+  }
+  kValid = true;
+}
+
+/*! Applies the inverse of the incomplete LU factors to the given
+   vector, i.e. runs the forward and backward substitutions. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::apply_ilu (std::vector<nr_type_t> & v) {
+  nr_type_t f;
+  int i, p;
+
+  // forward substitution with the ones on the diagonal of L
+  for (i = 0; i < N; i++) {
+    f = v[i];
+    for (p = kRp[i]; p < kDg[i]; p++) f -= kRx[p] * v[kRi[p]];
+    v[i] = f;
+  }
+  // backward substitution
+  for (i = N - 1; i >= 0; i--) {
+    f = v[i];
+    for (p = kDg[i] + 1; p < kRp[i + 1]; p++) f -= kRx[p] * v[kRi[p]];
+    v[i] = f / kRx[kDg[i]];
+  }
+}
+
+//! Computes y = A * x using the compressed rows of the A matrix.
+template <class nr_type_t>
+void eqnsys<nr_type_t>::multiply_krylov (const std::vector<nr_type_t> & x,
+					 std::vector<nr_type_t> & y) {
+  for (int i = 0; i < N; i++) {
+    nr_type_t f = 0.0;
+    for (int p = kAp[i]; p < kAp[i + 1]; p++) f += kAx[p] * x[kAi[p]];
+    y[i] = f;
+  }
+}
+
+// Euclidean norm and inner product of vectors used by the Krylov solvers.
+template <class nr_type_t>
+static nr_double_t krylov_norm (const std::vector<nr_type_t> & a) {
+  nr_double_t n = 0.0;
+  for (unsigned int i = 0; i < a.size (); i++) n += norm (a[i]);
+  return std::sqrt (n);
+}
+
+template <class nr_type_t>
+static nr_type_t krylov_dot (const std::vector<nr_type_t> & a,
+			     const std::vector<nr_type_t> & b) {
+  nr_type_t d = 0.0;
+  for (unsigned int i = 0; i < a.size (); i++) d += conj (a[i]) * b[i];
+  return d;
+}
+
+/*! The function runs the right preconditioned BiCGStab iteration
+   starting at the given x vector.  The number of iterations and the
+   final relative residual are returned in the given references. */
+template <class nr_type_t>
+bool eqnsys<nr_type_t>::solve_bicgstab (std::vector<nr_type_t> & x,
+					const std::vector<nr_type_t> & b,
+					int & iter, nr_double_t & res) {
+  std::vector<nr_type_t> r (N), h (N), p (N, 0.0), v (N, 0.0);
+  std::vector<nr_type_t> ph (N), s (N), sh (N), t (N);
+  nr_type_t rho = 1.0, alpha = 1.0, omega = 1.0, beta, f;
+  nr_double_t bnorm;
+  int i;
+
+  if ((bnorm = krylov_norm (b)) == 0.0) bnorm = 1.0;
+  multiply_krylov (x, r);
+  for (i = 0; i < N; i++) h[i] = r[i] = b[i] - r[i];
+  if ((res = krylov_norm (r) / bnorm) <= kTol) return true;
+
+  for (iter = 1; iter <= KRYLOV_MAXITER; iter++) {
+    f = krylov_dot (h, r);
+    if (f == 0.0 || omega == 0.0) break; // breakdown
+    beta = (f / rho) * (alpha / omega);
+    rho = f;
+    for (i = 0; i < N; i++) ph[i] = p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    apply_ilu (ph);
+    multiply_krylov (ph, v);
+    if ((f = krylov_dot (h, v)) == 0.0) break;
+    alpha = rho / f;
+    for (i = 0; i < N; i++) sh[i] = s[i] = r[i] - alpha * v[i];
+    if ((res = krylov_norm (s) / bnorm) <= kTol) {
+      for (i = 0; i < N; i++) x[i] += alpha * ph[i];
+      return true;
+    }
+    apply_ilu (sh);
+    multiply_krylov (sh, t);
+    nr_double_t tt = krylov_norm (t);
+    omega = tt > 0.0 ? krylov_dot (t, s) / (tt * tt) : 0.0;
+    for (i = 0; i < N; i++) {
+      x[i] += alpha * ph[i] + omega * sh[i];
+      r[i] = s[i] - omega * t[i];
+    }
+    if (!std::isfinite (res = krylov_norm (r) / bnorm)) break;
+    if (res <= kTol) return true;
+  }
+  iter = std::min (iter, KRYLOV_MAXITER);
+  return false;
+}
+
+/*! The function runs the right preconditioned GMRES iteration starting
+   at the given x vector.  It is restarted every KRYLOV_RESTART
+   iterations.  The number of iterations and the final relative
+   residual are returned in the given references. */
+template <class nr_type_t>
+bool eqnsys<nr_type_t>::solve_gmres (std::vector<nr_type_t> & x,
+				     const std::vector<nr_type_t> & b,
+				     int & iter, nr_double_t & res) {
+  int m = std::min (KRYLOV_RESTART, N);
+  int i, j, k;
+  nr_double_t bnorm, beta;
+
+  std::vector<nr_type_t> r (N), w (N), z (N);
+  std::vector< std::vector<nr_type_t> > V (m + 1, std::vector<nr_type_t> (N));
+  tmatrix<nr_type_t> H (m + 1, m);
+  std::vector<nr_type_t> sn (m), e (m + 1), y (m);
+  std::vector<nr_double_t> cs (m);
+
+  if ((bnorm = krylov_norm (b)) == 0.0) bnorm = 1.0;
+
+  for (iter = 0; iter < KRYLOV_MAXITER; ) {
+    // residual of the current solution
+    multiply_krylov (x, r);
+    for (i = 0; i < N; i++) r[i] = b[i] - r[i];
+    beta = krylov_norm (r);
+    if ((res = beta / bnorm) <= kTol) return true;
+    if (!std::isfinite (res)) return false;
+    for (i = 0; i < N; i++) V[0][i] = r[i] / beta;
+    std::fill (e.begin (), e.end (), nr_type_t (0.0));
+    e[0] = beta;
+
+    // Arnoldi process
+    for (k = 0, j = 0; j < m && iter < KRYLOV_MAXITER; j++, iter++) {
+      z = V[j];
+      apply_ilu (z);
+      multiply_krylov (z, w);
+      // modified Gram-Schmidt orthogonalization
+      for (i = 0; i <= j; i++) {
+	H (i, j) = krylov_dot (V[i], w);
+	for (int l = 0; l < N; l++) w[l] -= H (i, j) * V[i][l];
+      }
+      nr_double_t h = krylov_norm (w);
+      if (h != 0.0) for (i = 0; i < N; i++) V[j + 1][i] = w[i] / h;
+
+      // apply previous Givens rotations to the new column
+      for (i = 0; i < j; i++) {
+	nr_type_t t = cs[i] * H (i, j) + sn[i] * H (i + 1, j);
+	H (i + 1, j) = -conj (sn[i]) * H (i, j) + cs[i] * H (i + 1, j);
+	H (i, j) = t;
+      }
+      // compute new rotation eliminating the subdiagonal entry
+      nr_double_t a = abs (H (j, j));
+      if (a == 0.0) {
+	cs[j] = 0.0;
+	sn[j] = 1.0;
+      } else {
+	nr_double_t t = xhypot (a, h);
+	cs[j] = a / t;
+	sn[j] = H (j, j) / a * h / t;
+      }
+      H (j, j) = cs[j] * H (j, j) + sn[j] * h;
+      e[j + 1] = -conj (sn[j]) * e[j];
+      e[j] = cs[j] * e[j];
+      k = j + 1;
+
+      // residual norm of the current iterate
+      res = abs (e[j + 1]) / bnorm;
+      if (res <= kTol || h == 0.0) {
+	iter++;
+	break;
+      }
+    }
+
+    // solve the upper triangular system
+    for (i = k - 1; i >= 0; i--) {
+      nr_type_t t = e[i];
+      for (j = i + 1; j < k; j++) t -= H (i, j) * y[j];
+      y[i] = t / H (i, i);
+    }
+    // update solution --> x += M^-1 * V * y
+    std::fill (w.begin (), w.end (), nr_type_t (0.0));
+    for (i = 0; i < k; i++)
+      for (j = 0; j < N; j++) w[j] += y[i] * V[i][j];
+    apply_ilu (w);
+    for (i = 0; i < N; i++) x[i] += w[i];
+    if (res <= kTol) return true;
+  }
+  return false;
+}
+
 /*! The function solves the equation system using a full-step iterative
    method (called Jacobi's method) or a single-step method (called
    Gauss-Seidel) depending on the given algorithm.  If the current X
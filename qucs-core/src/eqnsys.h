@@ -25,7 +25,9 @@
 #ifndef __EQNSYS_H__
 #define __EQNSYS_H__
 
+#include <complex>
 #include <limits>
+#include <vector>
 
 //! Definition of equation system solving algorithms.
 enum algo_type {
@@ -45,6 +47,13 @@ enum algo_type {
   ALGO_QR_DECOMPOSITION           = 0x0400,
   ALGO_QR_DECOMPOSITION_LS        = 0x0800,
   ALGO_SV_DECOMPOSITION           = 0x1000,
+  ALGO_LU_FACTORIZATION_SPARSE    = 0x4000,
+  ALGO_LU_SUBSTITUTION_SPARSE     = 0x8000,
+  ALGO_LU_DECOMPOSITION_SPARSE    = 0xC000,
+  ALGO_BICGSTAB                   = 0x10000,
+  ALGO_GMRES                      = 0x20000,
+  ALGO_KRYLOV                     = 0x30000,
+  ALGO_LU_DECOMPOSITION_MIXED     = 0x40000,
   // testing
   ALGO_QR_DECOMPOSITION_2         = 0x2000,
 };
@@ -58,9 +67,17 @@ enum pivot_type {
 
 #include "tvector.h"
 #include "tmatrix.h"
+#include "tspmatrix.h"
 
 namespace qucs {
 
+//! Single precision type of the mixed precision LU decomposition.
+template <class nr_type_t> struct eqnsys_single;
+template <> struct eqnsys_single<nr_double_t> { typedef float type; };
+template <> struct eqnsys_single< std::complex<nr_double_t> > {
+  typedef std::complex<float> type;
+};
+
 template <class nr_type_t>
 class eqnsys
 {
@@ -72,7 +89,20 @@ class eqnsys
   int  getAlgo (void) { return algo; }
   void passEquationSys (tmatrix<nr_type_t> *, tvector<nr_type_t> *,
 			tvector<nr_type_t> *);
+  void passEquationSys (tspmatrix<nr_type_t> *, tvector<nr_type_t> *,
+			tvector<nr_type_t> *);
   void solve (void);
+  void factorize (void);
+  void solveMany (tmatrix<nr_type_t> *, tmatrix<nr_type_t> *);
+  void setKrylov (nr_double_t, int);
+  int  getKrylovSolves (void) { return kSolves; }
+  int  getKrylovIterations (void) { return kIterations; }
+  int  getKrylovFallbacks (void) { return kFallbacks; }
+  nr_double_t getKrylovResidual (void) { return kResidual; }
+  bool getOrdering (std::vector<int> &, std::vector<int> &,
+		    std::vector<int> &, std::vector<int> &);
+  void setOrdering (const std::vector<int> &, const std::vector<int> &,
+		    const std::vector<int> &, const std::vector<int> &);
 
  private:
   int update;
@@ -83,7 +113,48 @@ class eqnsys
   int N;
   nr_double_t * nPvt;
 
+  // sparse LU factorization state (reused across factorizations)
+  int spN;
+  std::vector<int> spAp, spAi;
+  std::vector<int> spCp, spCi;
+  std::vector<nr_type_t> spCx;
+  std::vector<int> spQ, spPinv, spProw;
+  std::vector<int> spLp, spLi, spUp, spUi;
+  std::vector<nr_type_t> spLx, spUx, spUd, spW, spT;
+  std::vector<int> spXi, spPs, spPp, spMark;
+  bool spValid;
+  // matrix of the last sparse factorization and columns changing
+  std::vector<int> spOp, spOi, spQinv;
+  std::vector<nr_type_t> spOx;
+  std::vector<char> spVol;
+  // symbolic analysis of a previous run offered for the first pattern
+  std::vector<int> sdAp, sdAi, sdQ, sdVol;
+
+  // incomplete LU factors of the Krylov solvers stored by rows, the
+  // diagonal of L being ones, and the A matrix they are computed for
+  nr_double_t kTol;
+  int kFill, kN;
+  std::vector<int> kAp, kAi, kRp, kRi, kDg, kMap;
+  std::vector<nr_type_t> kAx, kRx;
+  std::vector<int> kSp, kSi;
+  bool kValid;
+  // convergence statistics of the Krylov solvers
+  int kSolves, kIterations, kFallbacks;
+  nr_double_t kResidual;
+
+  // single precision LU factors and row interchanges of the mixed
+  // precision solver, or the A matrix holds double precision factors
+  std::vector<typename eqnsys_single<nr_type_t>::type> mpF;
+  std::vector<int> mpP;
+  nr_double_t mpNorm;
+  bool mpValid, mpDirect;
+
+  // matrix and factors of the last dense LU decomposition
+  tmatrix<nr_type_t> luA, luF;
+  int luAlgo;
+
   tmatrix<nr_type_t> * A;
+  tspmatrix<nr_type_t> * As;
   tmatrix<nr_type_t> * V;
   tvector<nr_type_t> * B;
   tvector<nr_type_t> * X;
@@ -101,6 +172,24 @@ class eqnsys
   void factorize_lu_doolittle (void);
   void substitute_lu_crout (void);
   void substitute_lu_doolittle (void);
+  void solve_lu_sparse (void);
+  void solve_lu_mixed (void);
+  bool factorize_lu_mixed (void);
+  void substitute_lu_mixed (std::vector<nr_type_t> &);
+  void factorize_lu_sparse (void);
+  void substitute_lu_sparse (void);
+  void extract_sparse (void);
+  bool pattern_sparse (void);
+  bool seeded_sparse (void);
+  void order_sparse (void);
+  int  reach_sparse (int);
+  void decompose_sparse (void);
+  bool refactorize_sparse (int);
+  int  changed_sparse (bool &);
+  void keep_sparse (void);
+  bool reuse_lu (void);
+  void decompose_lu (bool);
+  void keep_lu (tmatrix<nr_type_t> &, int);
   void solve_qr (void);
   void solve_qr_ls (void);
   void solve_qrh (void);
@@ -125,6 +214,16 @@ class eqnsys
   void factorize_svd (void);
   void substitute_svd (void);
   void diagonalize_svd (void);
+  void solve_krylov (void);
+  void pattern_ilu (void);
+  void factorize_ilu (void);
+  void apply_ilu (std::vector<nr_type_t> &);
+  void multiply_krylov (const std::vector<nr_type_t> &,
+			std::vector<nr_type_t> &);
+  bool solve_bicgstab (std::vector<nr_type_t> &,
+		       const std::vector<nr_type_t> &, int &, nr_double_t &);
+  bool solve_gmres (std::vector<nr_type_t> &,
+		    const std::vector<nr_type_t> &, int &, nr_double_t &);
   void solve_iterative (void);
   void solve_sor (void);
   nr_double_t convergence_criteria (void);
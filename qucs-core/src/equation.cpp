@@ -31,6 +31,8 @@
 #include <string.h>
 #include <cmath>
 #include <ctype.h>
+#include <map>
+#include <string>
 
 #include "logging.h"
 #include "complex.h"
@@ -59,6 +61,15 @@ using namespace eqn;
 #define C(c) ((constant *) (c))
 #define R(r) ((reference *) (r))
 
+// Markers of the application kept for the argument types.
+#define APP_UNRESOLVED -2
+#define APP_NOT_FOUND  -1
+
+// Argument types packed into the signature, all the tags fit in 10 bits.
+#define APP_SIGNATURE_ARGS 6
+#define APP_SIGNATURE_BITS 10
+#define APP_SIGNATURE_MASK ((1 << APP_SIGNATURE_BITS) - 1)
+
 // Constructor creates an untyped instance of the constant class.
 constant::constant () : node (CONSTANT)
 {
@@ -597,6 +608,8 @@ application::application () : node (APPLICATION)
     eval = NULL;
     derive = NULL;
     ddx = NULL;
+    typesig = 0;
+    typeapp = APP_UNRESOLVED;
 }
 
 /* Constructor creates an instance of the application class with a
@@ -609,6 +622,8 @@ application::application (const char * func, int a) : node (APPLICATION)
     eval = NULL;
     derive = NULL;
     ddx = NULL;
+    typesig = 0;
+    typeapp = APP_UNRESOLVED;
 }
 
 /* This copy constructor creates a instance of the application class
@@ -630,6 +645,8 @@ application::application (const application & o) : node (o)
     eval = o.eval;
     derive = o.derive;
     ddx = o.ddx ? o.ddx->recreate () : NULL;
+    typesig = o.typesig;
+    typeapp = o.typeapp;
 }
 
 // Re-creates the given instance.
@@ -785,30 +802,75 @@ void application::evalTypeArgs (void)
 #endif
 #include "gperfapphash.cpp"
 
-/* The function creates a hash key for the given type of
-   application. */
-char * application::createKey (void)
+/* The function writes the hash key for the given type of application
+   into the given buffer.  Returns the length of the key, or -1 if the
+   buffer is too small. */
+int application::createKey (char * key, int size)
 {
-    char * key = (char *) calloc (1, strlen (n) + nargs * 3 + 5);
-    strcat (key, n);
+    int len = strlen (n);
+    if (len >= size) return -1;
+    memcpy (key, n, len);
     for (node * arg = args; arg != NULL; arg = arg->getNext ())
     {
-        strcat (key, "_");
-        strcat (key, checker::tag2key (arg->getType ()));
+        const char * tag = checker::tag2key (arg->getType ());
+        int l = strlen (tag);
+        if (len + 1 + l >= size) return -1;
+        key[len++] = '_';
+        memcpy (key + len, tag, l);
+        len += l;
     }
-    return key;
+    key[len] = '\0';
+    return len;
+}
+
+/* The function packs the argument types into a single integer.
+   Returns false if there are too many arguments for it. */
+bool application::typeSignature (unsigned long long & sig)
+{
+    if (nargs > APP_SIGNATURE_ARGS) return false;
+    sig = nargs;
+    for (node * arg = args; arg != NULL; arg = arg->getNext ())
+        sig = (sig << APP_SIGNATURE_BITS) | (arg->getType () & APP_SIGNATURE_MASK);
+    return true;
 }
 
 /* This function returns the return type of the application using a
-   gperf-generated hash. */
+   gperf-generated hash.  The application found is kept together with
+   the argument types, re-checking the equations with unchanged types
+   neither builds the key nor queries the hash again. */
 int application::evalTypeFast (void)
 {
-    char * key = createKey ();
-    struct appindex * idx = gperfapphash::get (key, strlen (key));
-    free (key);
-    if (idx != NULL)
+    unsigned long long sig = 0;
+    bool packed = typeSignature (sig);
+    int index = APP_UNRESOLVED;
+    if (packed && typeapp != APP_UNRESOLVED && typesig == sig)
+    {
+        index = typeapp;
+    }
+    else
     {
-        application_t * app = &applications[idx->index];
+        char buf[128];
+        char * key = buf;
+        int len = createKey (buf, sizeof (buf));
+        if (len < 0)
+        {
+            // unusually long function name
+            int size = strlen (n) + nargs * 4 + 1;
+            key = (char *) malloc (size);
+            len = createKey (key, size);
+        }
+        struct appindex * idx = gperfapphash::get (key, len);
+        if (key != buf) free (key);
+        index = idx != NULL ? idx->index : APP_NOT_FOUND;
+        if (packed)
+        {
+            typesig = sig;
+            typeapp = index;
+        }
+    }
+    if (index >= 0)
+    {
+        application_t * app = &applications[index];
         if (app->eval)
         {
             eval = app->eval;
@@ -1386,6 +1448,7 @@ checker::checker ()
     defs = NULL;
     equations = NULL;
     consts = false;
+    indexed = false;
 }
 
 // Destructor deletes an instance of the checker class.
@@ -1762,6 +1825,7 @@ node * checker::lastEquation (node * root)
 // Removes the given equation node from the list of known equations.
 void checker::dropEquation (node * eqn)
 {
+    indexed = false;
     if (eqn == equations)
     {
         equations = eqn->getNext ();
@@ -1814,6 +1878,7 @@ void checker::reorderEquations (void)
         last->setNext (equations);
         equations = root;
     }
+    indexed = false;
 }
 
 
@@ -1822,6 +1887,7 @@ void checker::reorderEquations (void)
 void checker::setEquations (node * eqns)
 {
     equations = eqns;
+    indexed = false;
     foreach_equation (eqn)
     {
         eqn->checkee = this;
@@ -1873,6 +1939,7 @@ solver::solver (checker * c)
 {
     equations = NULL;
     data = NULL;
+    evalData = NULL;
     generated = 0;
     checkee = c;
 }
@@ -1888,24 +1955,127 @@ solver::~solver ()
     }
 }
 
-// The function finally evaluates each equation passed to the solver.
-void solver::evaluate (void)
+/* Returns true if the given equation node contains an application
+   giving a different result each time it is evaluated. */
+static bool isVolatile (node * eqn)
 {
+    switch (eqn->getTag ())
+    {
+    case ASSIGNMENT:
+        return isVolatile (A(eqn)->body);
+    case APPLICATION:
+    {
+        application * app = (application *) eqn;
+        if (app->eval == evaluate::rand || app->eval == evaluate::srand_d)
+            return true;
+        if (app->ddx && isVolatile (app->ddx))
+            return true;
+        for (node * arg = app->args; arg != NULL; arg = arg->getNext ())
+            if (isVolatile (arg)) return true;
+        break;
+    }
+    }
+    return false;
+}
+
+/* Forgets about the already evaluated equations, thus the following
+   evaluation runs through all of them. */
+void solver::invalidate (void)
+{
+    evalOrder.clear ();
+    evalState.clear ();
+    evalData = NULL;
+}
+
+/* The function prepares the incremental evaluation of the equations.
+   As long as the set and order of equations stays the same only the
+   equations downstream of changed constants get evaluated again.  The
+   dependency lists built by the checker are resolved once into the
+   positions of the equations, which are in dependency order after
+   checker::reorderEquations(). */
+void solver::prepareIncremental (void)
+{
+    // check whether the set of equations has changed
+    bool same = data == evalData;
+    size_t n = 0;
+    for (node * eqn = equations; eqn != NULL; eqn = eqn->getNext (), n++)
+    {
+        if (n >= evalOrder.size () || evalOrder[n] != eqn) same = false;
+    }
+    if (same && n == evalOrder.size ()) return;
+
+    evalOrder.clear ();
+    evalState.assign (n, evalstate ());
+    evalData = data;
+    std::map<std::string,int> position;
     foreach_equation (eqn)
     {
-        // FIXME: Can save evaluation of already evaluated equations?
-        if (eqn->evalPossible && !eqn->skip /* && eqn->evaluated == 0 */)
+        position[eqn->result] = evalOrder.size ();
+        evalOrder.push_back (eqn);
+    }
+    for (n = 0; n < evalOrder.size (); n++)
+    {
+        assignment * eqn = A (evalOrder[n]);
+        evalstate & st = evalState[n];
+        st.valid = false;
+        st.value = 0.0;
+        // equations not evaluated by the solver may change at any time
+        st.always = !eqn->evalPossible || isVolatile (eqn);
+        if (eqn->skip && eqn->body->getTag () != CONSTANT) st.always = true;
+        strlist * deps = eqn->getDependencies ();
+        if (deps == NULL) continue;
+        for (strlistiterator it (deps); *it; ++it)
+        {
+            auto p = position.find (*it);
+            // unknown and misordered dependencies are always considered changed
+            if (p == position.end () || p->second >= (int) n)
+                st.always = true;
+            else
+                st.deps.push_back (p->second);
+        }
+    }
+}
+
+/* The function finally evaluates each equation passed to the solver.
+   Equations whose dependencies did not change since the previous
+   evaluation keep their results. */
+void solver::evaluate (void)
+{
+    prepareIncremental ();
+    std::vector<char> dirty (evalOrder.size (), 0);
+    for (size_t i = 0; i < evalOrder.size (); i++)
+    {
+        assignment * eqn = A (evalOrder[i]);
+        evalstate & st = evalState[i];
+
+        // find out whether the equation needs to be evaluated
+        bool changed = st.always || !st.valid;
+        if (!changed && eqn->body->getTag () == CONSTANT)
+        {
+            constant * c = C (eqn->body);
+            changed = c->type != TAG_DOUBLE || c->d != st.value;
+        }
+        for (size_t k = 0; !changed && k < st.deps.size (); k++)
+            changed = dirty[st.deps[k]];
+        if (!changed) continue;
+        dirty[i] = 1;
+        if (eqn->body->getTag () == CONSTANT && C (eqn->body)->type == TAG_DOUBLE)
+            st.value = C (eqn->body)->d;
+
+        if (eqn->evalPossible && !eqn->skip)
         {
             // exception handling around evaluation
             try_running ()
             {
                 eqn->solvee = this;
                 eqn->calculate ();
+                st.valid = true;
             }
             // handle evaluation exceptions
             catch_exception ()
             {
             default:
+                st.valid = false;
                 estack.print ("evaluation");
                 break;
             }
@@ -1922,6 +2092,11 @@ void solver::evaluate (void)
 #endif
 #endif
         }
+        else
+        {
+            // keep track of the value of skipped constants
+            st.valid = eqn->body->getTag () == CONSTANT;
+        }
     }
 }
 
@@ -2518,6 +2693,7 @@ node * checker::addComplex (const char * type, const char * ident,
 // Adds given equation to the equation list.
 void checker::addEquation (node * eqn)
 {
+    indexed = false;
     eqn->setNext (equations);
     equations = eqn;
 }
@@ -2525,6 +2701,7 @@ void checker::addEquation (node * eqn)
 // Appends the given equation to the equation list.
 void checker::appendEquation (node * eqn)
 {
+    indexed = false;
     eqn->setNext (NULL);
     node * last = lastEquation (equations);
     if (last != NULL)
@@ -2595,12 +2772,10 @@ node * checker::createReference (const char * type, const char * ident,
    returned. */
 nr_double_t checker::getDouble (const char * const ident) const
 {
-    foreach_equation (eqn)
+    const std::vector<assignment *> * eqns = lookup (ident);
+    if (eqns != NULL)
     {
-        if (!strcmp (ident, eqn->result))
-        {
-            return eqn->getResultDouble ();
-        }
+        return eqns->front ()->getResultDouble ();
     }
     return 0.0;
 }
@@ -2609,15 +2784,14 @@ nr_double_t checker::getDouble (const char * const ident) const
    specified assignment.  If found the given value is set. */
 void checker::setDouble (const char * const ident, nr_double_t val)
 {
-    foreach_equation (eqn)
+    const std::vector<assignment *> * eqns = lookup (ident);
+    if (eqns == NULL) return;
+    for (assignment * eqn : *eqns)
     {
-        if (!strcmp (ident, eqn->result))
+        if (eqn->body->getTag () == CONSTANT)
         {
-            if (eqn->body->getTag () == CONSTANT)
-            {
-                constant * c = C (eqn->body);
-                if (c->type == TAG_DOUBLE) c->d = val;
-            }
+            constant * c = C (eqn->body);
+            if (c->type == TAG_DOUBLE) c->d = val;
         }
     }
 }
@@ -2627,14 +2801,32 @@ void checker::setDouble (const char * const ident, nr_double_t val)
    vector is returned. */
 qucs::vector checker::getVector (const char * const ident) const
 {
-    foreach_equation (eqn)
+    const std::vector<assignment *> * eqns = lookup (ident);
+    if (eqns != NULL)
     {
-        if (!strcmp (ident, eqn->result))
+        return eqns->front ()->getResultVector ();
+    }
+    return qucs::vector ();
+}
+
+/* Returns the assignments to the given variable in the order of the
+   equation list or NULL if there are none.  The index is built on the
+   first lookup after the list changed, the sweeps setting and reading
+   subcircuit parameters at every point then find them without walking
+   the list. */
+const std::vector<assignment *> * checker::lookup (const char * const ident) const
+{
+    if (!indexed)
+    {
+        index.clear ();
+        foreach_equation (eqn)
         {
-            return eqn->getResultVector ();
+            index[eqn->result].push_back (eqn);
         }
+        indexed = true;
     }
-    return qucs::vector ();
+    auto it = index.find (ident);
+    return it != index.end () ? &it->second : NULL;
 }
 
 } // namespace qucs
@@ -31,6 +31,10 @@
 #include "matrix.h"
 #include "matvec.h"
 
+#include <vector>
+#include <string>
+#include <unordered_map>
+
 struct definition_t;
 
 namespace qucs {
@@ -258,9 +262,15 @@ public:
   evaluator_t eval;
   differentiator_t derive;
 
+private:
+  // argument types and the application found for them
+  unsigned long long typesig;
+  int typeapp;
+
 private:
   void evalTypeArgs (void);
-  char * createKey (void);
+  int createKey (char *, int);
+  bool typeSignature (unsigned long long &);
   int evalTypeFast (void);
   int findDifferentiator (void);
 };
@@ -315,9 +325,15 @@ public:
 public:
   node * equations;
 
+ private:
+  const std::vector<assignment *> * lookup (const char * const) const;
+
  private:
   bool consts;
   struct definition_t * defs;
+  // assignments by result name, rebuilt after the list changed
+  mutable std::unordered_map<std::string, std::vector<assignment *> > index;
+  mutable bool indexed;
 };
 
 /* The solver class is finally used to solve the list of equations. */
@@ -347,14 +363,30 @@ public:
   char * isMatrixVector (char *, int&, int&);
   int findEquationResult (node *);
   int solve (dataset *);
+  void invalidate (void);
 
 public:
   node * equations;
 
+private:
+  void prepareIncremental (void);
+
 private:
   dataset * data;
   int generated;
   checker * checkee;
+
+  // state of an equation for the incremental evaluation
+  struct evalstate
+  {
+    std::vector<int> deps; // positions of the equations it depends on
+    nr_double_t value;     // last value of a double constant
+    bool always;           // needs evaluation whenever asked
+    bool valid;            // holds an up-to-date result
+  };
+  std::vector<node *> evalOrder;
+  std::vector<evalstate> evalState;
+  dataset * evalData;
 };
 
 } /* namespace eqn */
@@ -139,6 +139,42 @@ using namespace fspecial;
 
 #define SOLVEE(idx) args->get(idx)->solvee
 
+/* Returns the vector result of the given argument if it is a temporary,
+   i.e. it has been computed by a nested application and nothing else
+   refers to it, and holds at least 'len' values.  The vector is passed
+   to the caller which can then compute its own result in place; the
+   argument is left with an empty vector. */
+static qucs::vector * temporary (constant * args, int idx, int len = 0) {
+  eqn::node * arg = args->get (idx);
+  constant * c = arg->getResult ();
+  if (arg->getTag () != APPLICATION || c == NULL ||
+      c->getType () != TAG_VECTOR || c->v == NULL ||
+      c->v->getSize () < len)
+    return NULL;
+  qucs::vector * v = c->v;
+  c->v = new qucs::vector ();
+  return v;
+}
+
+/* Drops the properties of a reused temporary vector which a newly
+   assigned result vector would not carry. */
+static qucs::vector * anonymous (qucs::vector * v) {
+  v->setName ("");
+  v->setDependencies (NULL);
+  v->setOrigin (NULL);
+  v->setNext (NULL);
+  v->setPrev (NULL);
+  return v;
+}
+
+// Temporary vector macros, see above.
+#define _TMPV(var,idx,len) qucs::vector * (var) = temporary (args, idx, len);
+#define _MAPV(var,func) do { \
+  qucs::vector * _v = (var); nr_complex_t * _d = _v->getData (); \
+  for (int _i = 0; _i < _v->getSize (); _i++) _d[_i] = func (_d[_i]); \
+  } while (0)
+#define _RETTMPV(var) res->v = (var); return res;
+
 // Throws a math exception.
 #define THROW_MATH_EXCEPTION(txt) do { \
   qucs::exception * e = new qucs::exception (EXCEPTION_MATH); \
@@ -170,7 +206,9 @@ constant * evaluate:: QUCS_CONCAT2 (cfunc,_c) (constant * args) { \
 }								  \
 constant * evaluate:: QUCS_CONCAT2 (cfunc,_v) (constant * args) { \
   _ARV0 (v);							  \
+  _TMPV (t, 0, 0);						  \
   _DEFV ();							  \
+  if (t) { _MAPV (t, cfunc); _RETTMPV (t); }			  \
   _RETV (cfunc (*v));						  \
 }
 
@@ -189,7 +227,9 @@ constant * evaluate:: QUCS_CONCAT2 (cfunc,_c) (constant * args) { \
 }								  \
 constant * evaluate:: QUCS_CONCAT2 (cfunc,_v) (constant * args) { \
   _ARV0 (v);							  \
+  _TMPV (t, 0, 0);						  \
   _DEFV ();							  \
+  if (t) { _MAPV (t, cfunc); _RETTMPV (t); }			  \
   _RETV (cfunc (*v));						  \
 }
 
@@ -208,7 +248,9 @@ constant * evaluate:: QUCS_CONCAT2 (cfunc,_c) (constant * args) { \
 }								  \
 constant * evaluate:: QUCS_CONCAT2 (cfunc,_v) (constant * args) { \
   _ARV0 (v);							  \
+  _TMPV (t, 0, 0);						  \
   _DEFV ();							  \
+  if (t) { _MAPV (t, cfunc); _RETTMPV (t); }			  \
   _RETV (cfunc (*v));						  \
 }
 
@@ -227,7 +269,9 @@ constant * evaluate:: QUCS_CONCAT2 (cfunc,_c) (constant * args) { \
 }								  \
 constant * evaluate:: QUCS_CONCAT2 (cfunc,_v) (constant * args) { \
   _ARV0 (v);							  \
+  _TMPV (t, 0, 0);						  \
   _DEFV ();							  \
+  if (t) { _MAPV (t, cfunc); _RETTMPV (t); }			  \
   _RETV (cfunc (*v));						  \
 }
 
@@ -244,7 +288,9 @@ constant * evaluate:: QUCS_CONCAT2 (cfunc,_c) (constant * args) { \
 }								  \
 constant * evaluate:: QUCS_CONCAT2 (cfunc,_v) (constant * args) { \
   _ARV0 (v);							  \
+  _TMPV (t, 0, 0);						  \
   _DEFV ();							  \
+  if (t) { _MAPV (t, cfunc); _RETTMPV (t); }			  \
   _RETV (cfunc (*v));						  \
 }								  \
 constant * evaluate:: QUCS_CONCAT2 (cfunc,_m) (constant * args) { \
@@ -331,7 +377,9 @@ constant * evaluate::plus_d_c (constant * args) {
 constant * evaluate::plus_v_d (constant * args) {
   _ARV0 (v1);
   _ARD1 (d2);
+  _TMPV (t, 0, 0);
   _DEFV ();
+  if (t) { *anonymous (t) += d2; _RETTMPV (t); }
   _RETV (*v1 + d2);
 }
 
@@ -345,7 +393,9 @@ constant * evaluate::plus_d_v (constant * args) {
 constant * evaluate::plus_v_c (constant * args) {
   _ARV0 (v1);
   _ARC1 (c2);
+  _TMPV (t, 0, 0);
   _DEFV ();
+  if (t) { *anonymous (t) += *c2; _RETTMPV (t); }
   _RETV (*v1 + *c2);
 }
 
@@ -360,6 +410,14 @@ constant * evaluate::plus_v_v (constant * args) {
   _ARV0 (v1);
   _ARV1 (v2);
   _DEFV ();
+  int len1 = v1->getSize (), len2 = v2->getSize ();
+  if (len1 >= len2) {
+    _TMPV (t, 0, len1);
+    if (t) { *anonymous (t) += *v2; _RETTMPV (t); }
+  } else {
+    _TMPV (t, 1, len2);
+    if (t) { *anonymous (t) += *v1; _RETTMPV (t); }
+  }
   _RETV (*v1 + *v2);
 }
 
@@ -501,7 +559,9 @@ constant * evaluate::minus_c (constant * args) {
 }
 
 constant * evaluate::minus_v (constant * args) {
-  _ARV0 (v1); _DEFV (); _RETV (-*v1);
+  _ARV0 (v1); _TMPV (t, 0, 0); _DEFV ();
+  if (t) { _MAPV (anonymous (t), -); _RETTMPV (t); }
+  _RETV (-*v1);
 }
 
 constant * evaluate::minus_m (constant * args) {
@@ -544,7 +604,9 @@ constant * evaluate::minus_d_c (constant * args) {
 constant * evaluate::minus_v_d (constant * args) {
   _ARV0 (v1);
   _ARD1 (d2);
+  _TMPV (t, 0, 0);
   _DEFV ();
+  if (t) { *anonymous (t) -= d2; _RETTMPV (t); }
   _RETV (*v1 - d2);
 }
 
@@ -558,7 +620,9 @@ constant * evaluate::minus_d_v (constant * args) {
 constant * evaluate::minus_v_c (constant * args) {
   _ARV0 (v1);
   _ARC1 (c2);
+  _TMPV (t, 0, 0);
   _DEFV ();
+  if (t) { *anonymous (t) -= *c2; _RETTMPV (t); }
   _RETV (*v1 - *c2);
 }
 
@@ -573,6 +637,14 @@ constant * evaluate::minus_v_v (constant * args) {
   _ARV0 (v1);
   _ARV1 (v2);
   _DEFV ();
+  int len1 = v1->getSize (), len2 = v2->getSize ();
+  if (len1 >= len2) {
+    _TMPV (t, 0, len1);
+    if (t) { *anonymous (t) -= *v2; _RETTMPV (t); }
+  } else {
+    _TMPV (t, 1, len2);
+    if (t) { _MAPV (anonymous (t), -); *t += *v1; _RETTMPV (t); }
+  }
   _RETV (*v1 - *v2);
 }
 
@@ -706,7 +778,9 @@ constant * evaluate::times_d_c (constant * args) {
 constant * evaluate::times_v_d (constant * args) {
   _ARV0 (v1);
   _ARD1 (d2);
+  _TMPV (t, 0, 0);
   _DEFV ();
+  if (t) { *anonymous (t) *= d2; _RETTMPV (t); }
   _RETV (*v1 * d2);
   return res;
 }
@@ -721,7 +795,9 @@ constant * evaluate::times_d_v (constant * args) {
 constant * evaluate::times_v_c (constant * args) {
   _ARV0 (v1);
   _ARC1 (c2);
+  _TMPV (t, 0, 0);
   _DEFV ();
+  if (t) { *anonymous (t) *= *c2; _RETTMPV (t); }
   _RETV (*v1 * *c2);
 }
 
@@ -736,6 +812,14 @@ constant * evaluate::times_v_v (constant * args) {
   _ARV0 (v1);
   _ARV1 (v2);
   _DEFV ();
+  int len1 = v1->getSize (), len2 = v2->getSize ();
+  if (len1 >= len2) {
+    _TMPV (t, 0, len1);
+    if (t) { *anonymous (t) *= *v2; _RETTMPV (t); }
+  } else {
+    _TMPV (t, 1, len2);
+    if (t) { *anonymous (t) *= *v1; _RETTMPV (t); }
+  }
   _RETV (*v1 * *v2);
 }
 
@@ -897,8 +981,10 @@ constant * evaluate::over_d_c (constant * args) {
 constant * evaluate::over_v_d (constant * args) {
   _ARV0 (v1);
   _ARD1 (d2);
+  _TMPV (t, 0, 0);
   _DEFV ();
   if (d2 == 0.0) THROW_MATH_EXCEPTION ("division by zero");
+  if (t) { *anonymous (t) /= d2; _RETTMPV (t); }
   _RETV (*v1 / d2);
 }
 
@@ -912,8 +998,10 @@ constant * evaluate::over_d_v (constant * args) {
 constant * evaluate::over_v_c (constant * args) {
   _ARV0 (v1);
   _ARC1 (c2);
+  _TMPV (t, 0, 0);
   _DEFV ();
   if (*c2 == 0.0) THROW_MATH_EXCEPTION ("division by zero");
+  if (t) { *anonymous (t) /= *c2; _RETTMPV (t); }
   _RETV (*v1 / *c2);
 }
 
@@ -928,6 +1016,14 @@ constant * evaluate::over_v_v (constant * args) {
   _ARV0 (v1);
   _ARV1 (v2);
   _DEFV ();
+  int len1 = v1->getSize (), len2 = v2->getSize ();
+  if (len1 >= len2) {
+    _TMPV (t, 0, len1);
+    if (t) { *anonymous (t) /= *v2; _RETTMPV (t); }
+  } else {
+    _TMPV (t, 1, len2);
+    if (t) { _MAPV (anonymous (t), 1.0 /); *t *= *v1; _RETTMPV (t); }
+  }
   _RETV (*v1 / *v2);
 }
 
@@ -1208,7 +1304,9 @@ constant * evaluate::conj_c (constant * args) {
 
 constant * evaluate::conj_v (constant * args) {
   _ARV0 (v1);
+  _TMPV (t, 0, 0);
   _DEFV ();
+  if (t) { _MAPV (t, conj); _RETTMPV (t); }
   _RETV (conj (*v1));
 }
 
@@ -1239,7 +1337,9 @@ constant * evaluate::norm_c (constant * args) {
 
 constant * evaluate::norm_v (constant * args) {
   _ARV0 (v1);
+  _TMPV (t, 0, 0);
   _DEFV ();
+  if (t) { _MAPV (t, norm); _RETTMPV (t); }
   _RETV (norm (*v1));
 }
 
@@ -1289,7 +1389,9 @@ constant * evaluate::arg_c (constant * args) {
 
 constant * evaluate::arg_v (constant * args) {
   _ARV0 (v1);
+  _TMPV (t, 0, 0);
   _DEFV ();
+  if (t) { _MAPV (t, arg); _RETTMPV (t); }
   _RETV (arg (*v1));
 }
 
@@ -1379,7 +1481,9 @@ constant * evaluate::dB_c (constant * args) {
 
 constant * evaluate::dB_v (constant * args) {
   _ARV0 (v1);
+  _TMPV (t, 0, 0);
   _DEFV ();
+  if (t) { _MAPV (t, dB); _RETTMPV (t); }
   _RETV (dB (*v1));
 }
 
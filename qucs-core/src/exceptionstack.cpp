@@ -36,8 +36,8 @@
 
 using namespace qucs;
 
-// Global exception stack.
-exceptionstack qucs::estack;
+// Global exception stack, each thread has its own one.
+thread_local exceptionstack qucs::estack;
 
 // Constructor creates an instance of the exception stack class.
 exceptionstack::exceptionstack () {
@@ -90,6 +90,18 @@ exception * exceptionstack::top (void) {
   return root;
 }
 
+/* The function moves all exceptions of the given exception stack on
+   top of this one keeping their order.  The given stack is empty
+   afterwards. */
+void exceptionstack::take (exceptionstack & e) {
+  if (e.root == NULL) return;
+  exception * last = e.root;
+  while (last->getNext () != NULL) last = last->getNext ();
+  last->setNext (root);
+  root = e.root;
+  e.root = NULL;
+}
+
 /* This function prints the complete exception stack and removes each
    exception from the stack. */
 void exceptionstack::print (const char * prefix) {
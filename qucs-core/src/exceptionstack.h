@@ -38,14 +38,15 @@ class exceptionstack
   void push (exception *);
   exception * pop (void);
   exception * top (void);
+  void take (exceptionstack &);
   void print (const char * prefix = NULL);
 
  private:
   exception * root;
 };
 
-// Global exception stack.
-extern exceptionstack estack;
+// Global exception stack, each thread has its own one.
+extern thread_local exceptionstack estack;
 
 } /* namespace qucs */
 
@@ -0,0 +1,140 @@
+/*
+ * filecache.cpp - cache of loaded data files implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <set>
+
+#include "object.h"
+#include "dataset.h"
+#include "filecache.h"
+
+namespace qucs {
+
+std::mutex filecache::mutex;
+std::map<std::string, filecache::fileentry_t> filecache::files;
+std::map<std::pair<dataset *, std::string>, std::weak_ptr<void> >
+  filecache::objects;
+bool filecache::retaining = false;
+std::map<std::pair<dataset *, std::string>, std::shared_ptr<void> >
+  filecache::kept;
+
+// Removes the entries whose objects have all been released.
+void filecache::cleanup (void) {
+  // retained objects prepared from datasets of changed files
+  std::set<dataset *> held;
+  for (auto & f : files) held.insert (f.second.held.get ());
+  for (auto it = kept.begin (); it != kept.end ();) {
+    if (!held.count (it->first.first))
+      it = kept.erase (it);
+    else
+      ++it;
+  }
+  for (auto it = files.begin (); it != files.end ();) {
+    if (it->second.data.expired ())
+      it = files.erase (it);
+    else
+      ++it;
+  }
+  for (auto it = objects.begin (); it != objects.end ();) {
+    if (it->second.expired ())
+      it = objects.erase (it);
+    else
+      ++it;
+  }
+}
+
+/* Returns the dataset of the given file read by the given loader
+   function.  A dataset loaded before is shared unless the file has
+   been modified since.  Returns an empty pointer if the file cannot be
+   loaded. */
+std::shared_ptr<dataset> filecache::load (const char * file, loader_t loader) {
+  std::lock_guard<std::mutex> lock (mutex);
+  cleanup ();
+
+  // the canonical name of the file, and its modification time
+  std::string name = file;
+#if __MINGW32__
+  char path[_MAX_PATH];
+  if (_fullpath (path, file, _MAX_PATH) != NULL) name = path;
+#else
+  char * path = realpath (file, NULL);
+  if (path != NULL) {
+    name = path;
+    free (path);
+  }
+#endif
+  struct stat st;
+  time_t mtime = 0;
+  long size = -1;
+  if (stat (name.c_str (), &st) == 0) {
+    mtime = st.st_mtime;
+    size = st.st_size;
+  }
+
+  // loaders differ in the datasets they create from the same file
+  char id[32];
+  sprintf (id, "%p:", (void *) loader);
+  std::string key = id + name;
+
+  auto it = files.find (key);
+  if (it != files.end () && it->second.mtime == mtime &&
+      it->second.size == size) {
+    std::shared_ptr<dataset> data = it->second.data.lock ();
+    if (data) return data;
+  }
+
+  std::shared_ptr<dataset> data ((*loader) (file));
+  if (data) {
+    fileentry_t & e = files[key];
+    e.mtime = mtime;
+    e.size = size;
+    e.data = data;
+    e.held = retaining ? data : NULL;
+  }
+  return data;
+}
+
+/* Makes the cache keep the datasets and the objects prepared from them
+   when the components release them, so that the next simulation of
+   the process finds them.  Otherwise these get released along with
+   the components. */
+void filecache::retain (bool r) {
+  std::lock_guard<std::mutex> lock (mutex);
+  retaining = r;
+  if (!retaining) {
+    for (auto & f : files) f.second.held = NULL;
+    kept.clear ();
+    cleanup ();
+  }
+}
+
+} // namespace qucs
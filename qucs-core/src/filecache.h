@@ -0,0 +1,96 @@
+/*
+ * filecache.h - cache of loaded data files definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __FILECACHE_H__
+#define __FILECACHE_H__
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <ctime>
+
+namespace qucs {
+
+class dataset;
+
+/*! \class filecache
+ * \brief process-wide cache of the data files loaded by components.
+ *
+ * Components reading the same file share a single dataset, together
+ * with the interpolation data prepared from it.  The files are known
+ * by their canonical path and loader, a file modified since it has
+ * been loaded is loaded again.  The shared objects are reference
+ * counted and must not be modified, they are deleted once the last
+ * component releases them, or when the file changes while they are
+ * retained between the simulations of a server process.
+ */
+class filecache
+{
+ public:
+  typedef dataset * (* loader_t) (const char *);
+
+  static std::shared_ptr<dataset> load (const char *, loader_t);
+  static void retain (bool);
+
+  /* Returns the object prepared from the given dataset under the given
+     key.  It is created by the given function if there is none. */
+  template <class T, class F>
+  static std::shared_ptr<T> prepared (const std::shared_ptr<dataset> & data,
+				      const std::string & key, F create) {
+    std::lock_guard<std::mutex> lock (mutex);
+    std::weak_ptr<void> & p = objects[std::make_pair (data.get (), key)];
+    std::shared_ptr<T> o = std::static_pointer_cast<T> (p.lock ());
+    if (!o) {
+      o = std::shared_ptr<T> (create ());
+      p = o;
+      if (retaining) kept[std::make_pair (data.get (), key)] = o;
+    }
+    return o;
+  }
+
+ private:
+  struct fileentry_t
+  {
+    time_t mtime;
+    long size;
+    std::weak_ptr<dataset> data;
+    std::shared_ptr<dataset> held;  // while retaining
+  };
+  static void cleanup (void);
+
+ private:
+  static std::mutex mutex;
+  static std::map<std::string, fileentry_t> files;
+  static std::map<std::pair<dataset *, std::string>, std::weak_ptr<void> >
+    objects;
+  static bool retaining;
+  static std::map<std::pair<dataset *, std::string>, std::shared_ptr<void> >
+    kept;
+};
+
+} // namespace qucs
+
+#endif /* __FILECACHE_H__ */
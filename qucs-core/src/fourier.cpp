@@ -31,67 +31,217 @@
 #include <string.h>
 #include <cmath>
 
+#include <map>
+#include <memory>
+#include <mutex>
+
 #include "consts.h"
 #include "object.h"
 #include "complex.h"
 #include "vector.h"
 #include "fourier.h"
 
-// Helper macro.
-#define Swap(a,b) { nr_double_t t; t = a; a = b; b = t; }
-
 namespace qucs {
 
 using namespace fourier;
 
-/* The function performs a 1-dimensional fast fourier transformation.
-   Each data item is meant to be defined in equidistant steps.  The
-   number of data items needs to be of binary size, e.g. 64, 128. */
-void fourier::_fft_1d (nr_double_t * data, int len, int isign) {
+/* Constructor creates a plan for the fast fourier transformation of
+   the given length.  The length is split into radix 4, 2, 3 and 5
+   factors, remaining prime factors are handled by a generic
+   butterfly.  The twiddle factors of each stage are pre-computed. */
+fourier::fftplan::fftplan (int len) {
+  int p, l, j, q, m = n = len;
+
+  // factorize the length
+  while (m % 4 == 0) { radix.push_back (4); m /= 4; }
+  while (m % 2 == 0) { radix.push_back (2); m /= 2; }
+  for (p = 3; m > 1; p += 2) {
+    while (m % p == 0) { radix.push_back (p); m /= p; }
+    if (p * p > m && m > 1) { radix.push_back (m); m = 1; }
+  }
 
-  // bit reversal method
-  int i, j, m, n;
-  n = 2 * len;
-  j = 0;
-  for (i = 0; i < n; i += 2) {
-    if (j > i) {                   // was index already swapped ?
-      Swap (data[j], data[i]);     // swap real part
-      Swap (data[j+1], data[i+1]); // swap imaginary part
+  // compute twiddle factors for each stage
+  for (l = 1, j = 0; j < (int) radix.size (); j++) {
+    p = radix[j];
+    offset.push_back (wr.size ());
+    for (int k = 0; k < l; k++) {
+      for (q = 1; q < p; q++) {
+	nr_double_t th = 2 * pi * k * q / (l * p);
+	wr.push_back (cos (th));
+	wi.push_back (sin (th));
+      }
     }
-    m = len;
-    while (m >= 2 && j >= m) {     // calculate next swap index
-      j -= m;
-      m >>= 1;
+    // roots of unity for the generic butterfly
+    if (p > 4) {
+      for (q = 0; q < p; q++) {
+	nr_double_t th = 2 * pi * q / p;
+	wr.push_back (cos (th));
+	wi.push_back (sin (th));
+      }
     }
-    j += m;
+    l *= p;
   }
+}
 
-  // Danielson-Lanzcos algorithm
-  int mmax, istep;
-  nr_double_t wt, th, wr, wi, wpr, wpi, ti, tr;
-  mmax = 2;
-  while (n > mmax) {
-    istep = mmax << 1;
-    th = isign * (2 * pi / mmax);
-    wt = sin (0.5 * th);
-    wpr = -2.0 * wt * wt;
-    wpi = sin (th);
-    wr = 1.0;
-    wi = 0.0;
-    for (m = 1; m < mmax; m += 2) {
-      for (i = m; i <= n; i += istep) {
-	j = i + mmax;
-	tr = wr * data[j] - wi * data[j-1];
-	ti = wr * data[j-1] + wi * data[j];
-	data[j] = data[i] - tr;
-	data[j-1] = data[i-1] - ti;
-	data[i] += tr;
-	data[i-1] += ti;
+/* The function runs the fast fourier transformation on the given
+   real and imaginary parts.  The results are stored in place.  Each
+   stage is a self-sorting (Stockham) butterfly reading from one and
+   writing to the other pair of arrays, thus the additional real and
+   imaginary work arrays of the same length are required.  The inner
+   loops run over consecutive items. */
+void fourier::fftplan::execute (nr_double_t * re, nr_double_t * im,
+				nr_double_t * wre, nr_double_t * wim,
+				int isign) const {
+  const nr_double_t sg = isign < 0 ? 1 : -1;
+  const nr_double_t * xr = re, * xi = im;
+  nr_double_t * yr = wre, * yi = wim;
+  int s, j, k, q, m, p, l, r, rp;
+
+  for (l = 1, s = 0; s < (int) radix.size (); s++) {
+    p = radix[s];
+    r = n / (l * p);
+    rp = r * p;
+    const nr_double_t * tr = &wr[offset[s]], * ti = &wi[offset[s]];
+
+    for (j = 0; j < l; j++, tr += p - 1, ti += p - 1) {
+      const nr_double_t * ar = xr + j * rp, * ai = xi + j * rp;
+      nr_double_t * br = yr + j * r, * bi = yi + j * r;
+      int ls = l * r;
+
+      switch (p) {
+      case 2: {
+	nr_double_t w1r = tr[0], w1i = sg * ti[0];
+	for (k = 0; k < r; k++) {
+	  nr_double_t t1r = w1r * ar[r+k] - w1i * ai[r+k];
+	  nr_double_t t1i = w1r * ai[r+k] + w1i * ar[r+k];
+	  br[k] = ar[k] + t1r;
+	  bi[k] = ai[k] + t1i;
+	  br[ls+k] = ar[k] - t1r;
+	  bi[ls+k] = ai[k] - t1i;
+	}
+	break;
+      }
+      case 3: {
+	const nr_double_t c3 = sg * sqrt (3.0) / 2;
+	nr_double_t w1r = tr[0], w1i = sg * ti[0];
+	nr_double_t w2r = tr[1], w2i = sg * ti[1];
+	for (k = 0; k < r; k++) {
+	  nr_double_t a1r = w1r * ar[r+k] - w1i * ai[r+k];
+	  nr_double_t a1i = w1r * ai[r+k] + w1i * ar[r+k];
+	  nr_double_t a2r = w2r * ar[2*r+k] - w2i * ai[2*r+k];
+	  nr_double_t a2i = w2r * ai[2*r+k] + w2i * ar[2*r+k];
+	  nr_double_t t1r = a1r + a2r, t1i = a1i + a2i;
+	  nr_double_t t2r = ar[k] - 0.5 * t1r, t2i = ai[k] - 0.5 * t1i;
+	  nr_double_t t3r = -c3 * (a1i - a2i), t3i = c3 * (a1r - a2r);
+	  br[k] = ar[k] + t1r;
+	  bi[k] = ai[k] + t1i;
+	  br[ls+k] = t2r + t3r;
+	  bi[ls+k] = t2i + t3i;
+	  br[2*ls+k] = t2r - t3r;
+	  bi[2*ls+k] = t2i - t3i;
+	}
+	break;
+      }
+      case 4: {
+	nr_double_t w1r = tr[0], w1i = sg * ti[0];
+	nr_double_t w2r = tr[1], w2i = sg * ti[1];
+	nr_double_t w3r = tr[2], w3i = sg * ti[2];
+	for (k = 0; k < r; k++) {
+	  nr_double_t a1r = w1r * ar[r+k] - w1i * ai[r+k];
+	  nr_double_t a1i = w1r * ai[r+k] + w1i * ar[r+k];
+	  nr_double_t a2r = w2r * ar[2*r+k] - w2i * ai[2*r+k];
+	  nr_double_t a2i = w2r * ai[2*r+k] + w2i * ar[2*r+k];
+	  nr_double_t a3r = w3r * ar[3*r+k] - w3i * ai[3*r+k];
+	  nr_double_t a3i = w3r * ai[3*r+k] + w3i * ar[3*r+k];
+	  nr_double_t t0r = ar[k] + a2r, t0i = ai[k] + a2i;
+	  nr_double_t t1r = ar[k] - a2r, t1i = ai[k] - a2i;
+	  nr_double_t t2r = a1r + a3r, t2i = a1i + a3i;
+	  nr_double_t t3r = -sg * (a1i - a3i), t3i = sg * (a1r - a3r);
+	  br[k] = t0r + t2r;
+	  bi[k] = t0i + t2i;
+	  br[ls+k] = t1r + t3r;
+	  bi[ls+k] = t1i + t3i;
+	  br[2*ls+k] = t0r - t2r;
+	  bi[2*ls+k] = t0i - t2i;
+	  br[3*ls+k] = t1r - t3r;
+	  bi[3*ls+k] = t1i - t3i;
+	}
+	break;
+      }
+      default: {
+	// generic butterfly using the roots of unity
+	const nr_double_t * ur = &wr[offset[s] + l * (p - 1)];
+	const nr_double_t * ui = &wi[offset[s] + l * (p - 1)];
+	for (k = 0; k < r; k++) {
+	  for (m = 0; m < p; m++) {
+	    nr_double_t sr = ar[k], si = ai[k];
+	    for (q = 1; q < p; q++) {
+	      nr_double_t xr1 = tr[q-1] * ar[q*r+k] - sg * ti[q-1] * ai[q*r+k];
+	      nr_double_t xi1 = tr[q-1] * ai[q*r+k] + sg * ti[q-1] * ar[q*r+k];
+	      int t = (q * m) % p;
+	      sr += ur[t] * xr1 - sg * ui[t] * xi1;
+	      si += ur[t] * xi1 + sg * ui[t] * xr1;
+	    }
+	    br[m*ls+k] = sr;
+	    bi[m*ls+k] = si;
+	  }
+	}
+	break;
+      }
       }
-      wr = (wt = wr) * wpr - wi * wpi + wr;
-      wi = wi * wpr + wt * wpi + wi;
     }
-    mmax = istep;
+
+    // results of this stage are the input to the next one
+    if (xr == re) {
+      xr = wre; xi = wim; yr = re; yi = im;
+    } else {
+      xr = re; xi = im; yr = wre; yi = wim;
+    }
+    l *= p;
+  }
+
+  // copy results back if necessary
+  if (xr != re) {
+    memcpy (re, xr, n * sizeof (nr_double_t));
+    memcpy (im, xi, n * sizeof (nr_double_t));
+  }
+}
+
+/* The function returns the plan for the given transformation length.
+   Plans are created once and kept for subsequent transformations. */
+const fftplan * fourier::plan (int len) {
+  static std::map<int, std::unique_ptr<fftplan> > plans;
+  static std::mutex lock;
+  std::lock_guard<std::mutex> guard (lock);
+  std::unique_ptr<fftplan> & p = plans[len];
+  if (!p) p.reset (new fftplan (len));
+  return p.get ();
+}
+
+/* The function performs a 1-dimensional fast fourier transformation.
+   Each data item is meant to be defined in equidistant steps.  The
+   data items are stored as real and imaginary pairs.  Any number of
+   data items is allowed, though products of small primes are
+   fastest. */
+void fourier::_fft_1d (nr_double_t * data, int len, int isign) {
+  int i;
+  const fftplan * p = plan (len);
+
+  // split data into real and imaginary parts
+  static thread_local std::vector<nr_double_t> work;
+  work.resize (4 * len);
+  nr_double_t * re = &work[0], * im = re + len;
+  for (i = 0; i < len; i++) {
+    re[i] = data[2*i];
+    im[i] = data[2*i+1];
+  }
+
+  p->execute (re, im, im + len, im + 2 * len, isign);
+
+  // store transformed data items
+  for (i = 0; i < len; i++) {
+    data[2*i] = re[i];
+    data[2*i+1] = im[i];
   }
 }
 
@@ -239,74 +389,38 @@ void fourier::_idft_1d (nr_double_t * data, int len) {
 
 /* The function performs a n-dimensional fast fourier transformation.
    Each data item is meant to be defined in equidistant steps.  The
-   number of data items needs to be of binary size, e.g. 64, 128 for
-   each dimension. */
+   data is stored with the last dimension varying fastest.  Each
+   dimension is transformed separately.  Note that the meaning of the
+   sign is opposite to the 1-dimensional transformation. */
 void fourier::_fft_nd (nr_double_t * data, int len[], int nd, int isign) {
-
- int i, i1, i2, i3, i2rev, i3rev, ip1, ip2, ip3, ifp1, ifp2;
- int ibit, k1, k2, n, np, nr, nt;
-
- // compute total number of complex values
- for (nt = 1, i = 0; i < nd; i++) nt *= len[i];
-
- // main loop over the dimensions
- for (np = 1, i = nd - 1; i >= 0; i--) {
-   n = len[i];
-   nr = nt / (n * np);
-   ip1 = np << 1;
-   ip2 = ip1 * n;
-   ip3 = ip2 * nr;
-
-   // bit-reversal method
-   for (i2rev = 1, i2 = 1; i2 <= ip2; i2 += ip1) {
-     if (i2 < i2rev) {
-       for (i1 = i2; i1 <= i2 + ip1 - 2; i1 += 2) {
-	 for (i3 = i1; i3 <= ip3; i3 += ip2) {
-	   i3rev = i2rev + i3 - i2;
-	   Swap (data[i3-1], data[i3rev-1]);
-	   Swap (data[i3], data[i3rev]);
-	 }
-       }
-     }
-     ibit = ip2 >> 1;
-     while (ibit >= ip1 && i2rev > ibit) {
-       i2rev -= ibit;
-       ibit >>= 1;
-     }
-     i2rev += ibit;
-   }
-
-   // Danielson-Lanzcos algorithm
-   nr_double_t ti, tr, wt, th, wr, wi, wpi, wpr;
-   ifp1 = ip1;
-   while (ifp1 < ip2) {
-     ifp2 = ifp1 << 1;
-     th = isign * 2 * pi / (ifp2 / ip1);
-     wt = sin (0.5 * th);
-     wpr = -2.0 * wt * wt;
-     wpi = sin (th);
-     wr = 1.0;
-     wi = 0.0;
-     for (i3 = 1; i3 <= ifp1; i3 += ip1) {
-       for (i1 = i3; i1 <= i3 + ip1 - 2; i1 += 2) {
-	 for (i2 = i1; i2 <= ip3; i2 += ifp2) {
-	   k1 = i2;
-	   k2 = k1 + ifp1;
-	   tr = wr * data[k2-1] - wi * data[k2];
-	   ti = wr * data[k2] + wi * data[k2-1];
-	   data[k2-1] = data[k1-1] - tr;
-	   data[k2] = data[k1] - ti;
-	   data[k1-1] += tr;
-	   data[k1] += ti;
-	 }
-       }
-       wr = (wt = wr) * wpr - wi * wpi + wr;
-       wi = wi * wpr + wt * wpi + wi;
-     }
-     ifp1 = ifp2;
-   }
-   np *= n;
- }
+  int i, k, t, n, nt, stride;
+
+  // compute total number of complex values
+  for (nt = 1, i = 0; i < nd; i++) nt *= len[i];
+
+  static thread_local std::vector<nr_double_t> work;
+  for (stride = 1, i = nd - 1; i >= 0; stride *= len[i], i--) {
+    n = len[i];
+    if (n < 2) continue;
+    const fftplan * p = plan (n);
+    work.resize (4 * n);
+    nr_double_t * re = &work[0], * im = re + n;
+
+    // transform each line of the current dimension
+    for (k = 0; k < nt; k++) {
+      if ((k / stride) % n != 0) continue;
+      nr_double_t * d = data + 2 * k;
+      for (t = 0; t < n; t++) {
+	re[t] = d[2*t*stride];
+	im[t] = d[2*t*stride+1];
+      }
+      p->execute (re, im, im + n, im + 2 * n, -isign);
+      for (t = 0; t < n; t++) {
+	d[2*t*stride] = re[t];
+	d[2*t*stride+1] = im[t];
+      }
+    }
+  }
 }
 
 // Helper functions.
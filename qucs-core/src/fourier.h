@@ -25,12 +25,36 @@
 #ifndef __FOURIER_H__
 #define __FOURIER_H__
 
+#include <vector>
+
 namespace qucs {
 
 class vector;
 
 namespace fourier {
 
+  /* The plan holds the factorization of the transformation length and
+     the twiddle factors of a mixed radix fast fourier transformation.
+     It operates on separate real and imaginary parts. */
+  class fftplan
+  {
+  public:
+    fftplan (int);
+    int getSize (void) const { return n; }
+    void execute (nr_double_t *, nr_double_t *, nr_double_t *, nr_double_t *,
+		  int isign = 1) const;
+
+  private:
+    int n;
+    std::vector<int> radix;
+    std::vector<int> offset;
+    std::vector<nr_double_t> wr;
+    std::vector<nr_double_t> wi;
+  };
+
+  // returns the (cached) plan for the given length
+  const fftplan * plan (int);
+
   // public functions
   qucs::vector  fft_1d (qucs::vector, int isign = 1);
   qucs::vector ifft_1d (qucs::vector);
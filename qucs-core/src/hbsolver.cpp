@@ -27,8 +27,11 @@
 #endif
 
 #include<algorithm>
+#include <vector>
+#include <random>
 
 #include <stdio.h>
+#include <string.h>
 
 #include "object.h"
 #include "logging.h"
@@ -48,9 +51,27 @@
 #include "dataset.h"
 #include "fourier.h"
 #include "hbsolver.h"
+#include "trace.h"
+#include "checkpoint.h"
+#include "threadpool.h"
+#include "exception.h"
+#include "exceptionstack.h"
+#include "numstatus.h"
 
 #define HB_DEBUG 0
 
+// Krylov subspace dimension and maximum number of restarts for GMRES
+#define HB_GMRES_RESTART 30
+#define HB_GMRES_CYCLES  20
+
+// decrease of the error norm required to keep the Jacobian
+#define HB_CHORD_RATIO   0.5
+
+/* dense matrices of the direct solver: the transadmittance matrix, the
+   Jacobians JG, JQ and JF and the matrix and factors kept by the LU
+   decomposition */
+#define HB_DIRECT_MATRICES 6
+
 namespace qucs {
 
 using namespace fourier;
@@ -60,11 +81,15 @@ hbsolver::hbsolver () : analysis () {
   type = ANALYSIS_HBALANCE;
   frequency = 0;
   nlnodes = lnnodes = banodes = nanodes = NULL;
-  Y = Z = A = NULL;
-  NA = YV = JQ = JG = JF = NULL;
+  YV = YD = PC = JQ = JG = JF = NULL;
   OM = IR = QR = RH = IG = FQ = VS = VP = FV = IL = IN = IC = IS = NULL;
   vs = x = NULL;
+  ws = NULL;
   runs = 0;
+  threads = 1;
+  krylov = false;
+  mixed = false;
+  almost = false;
   ndfreqs = NULL;
 }
 
@@ -73,11 +98,15 @@ hbsolver::hbsolver (char * n) : analysis (n) {
   type = ANALYSIS_HBALANCE;
   frequency = 0;
   nlnodes = lnnodes = banodes = nanodes = NULL;
-  Y = Z = A = NULL;
-  NA = YV = JQ = JG = JF = NULL;
+  YV = YD = PC = JQ = JG = JF = NULL;
   OM = IR = QR = RH = IG = FQ = VS = VP = FV = IL = IN = IC = IS = NULL;
   vs = x = NULL;
+  ws = NULL;
   runs = 0;
+  threads = 1;
+  krylov = false;
+  mixed = false;
+  almost = false;
   ndfreqs = NULL;
 }
 
@@ -89,14 +118,10 @@ hbsolver::~hbsolver () {
   delete banodes;
   delete nanodes;
 
-  // delete temporary matrices
-  delete A;
-  delete Z;
-  delete Y;
-
   // delete matrices
-  delete NA;
   delete YV;
+  delete YD;
+  delete PC;
   delete JQ;
   delete JG;
   delete JF;
@@ -118,6 +143,7 @@ hbsolver::~hbsolver () {
   delete RH;
 
   delete x;
+  delete ws;
   delete[] ndfreqs;
 }
 
@@ -131,11 +157,15 @@ hbsolver::hbsolver (hbsolver & o) : analysis (o) {
   lnnodes = o.lnnodes;
   banodes = o.banodes;
   nanodes = o.nanodes;
-  Y = Z = A = NULL;
-  NA = YV = JQ = JG = JF = NULL;
+  YV = YD = PC = JQ = JG = JF = NULL;
   OM = IR = QR = RH = IG = FQ = VS = VP = FV = IL = IN = IC = IS = NULL;
   vs = x = NULL;
+  ws = NULL;
   runs = o.runs;
+  threads = o.threads;
+  krylov = o.krylov;
+  mixed = o.mixed;
+  almost = false;
   ndfreqs = NULL;
 }
 
@@ -149,17 +179,47 @@ int hbsolver::solve (void) {
   int iterations = 0, done = 0;
   int MaxIterations = getPropertyInteger ("MaxIter");
 
-  // collect different parts of the circuit
-  splitCircuits ();
+  // number of worker threads, zero means one per processor
+  threads = threadpool::threads (getPropertyInteger ("Threads"));
+
+  // matrix-free iterative or direct solution of the Newton steps
+  krylov = !strcmp (getPropertyString ("Solver"), "GMRES");
+  mixed = !strcmp (getPropertyString ("Solver"), "MixedLU");
+
+  // Newton steps using the same Jacobian, not for the mixed precision
+  int jsteps = mixed ? 1 : getPropertyInteger ("JacobianSteps");
+
+  // collect different parts of the circuit and find interconnects
+  // between the linear and non-linear subcircuit, once for a sweep
+  if (nolcircuits.empty () && lincircuits.empty () && excitations.empty ()) {
+    splitCircuits ();
+    getNodeLists ();
+  }
 
   // create frequency array
   collectFrequencies ();
 
-  // find interconnects between the linear and non-linear subcircuit
-  getNodeLists ();
+  // the direct solver gives way to the iterative one above the budget
+  selectSolver ();
 
-  // prepares the linear part --> 0 = IC + [YV] * VS
-  prepareLinear ();
+  // prepares the linear part --> 0 = IC + [YV] * VS, which a swept HB
+  // keeps as long as neither its circuits nor the frequencies change
+  if (linearChanged ()) {
+    prepareLinear ();
+  }
+  else {
+    logprint (LOG_STATUS, "NOTIFY: %s: reusing the linear network\n",
+	      getName ());
+    calcConstantCurrent ();
+  }
+
+  // a swept HB continues from the solution of the previous point
+  if (VS != NULL && VS->size () != (std::size_t) (nbanodes * nlfreqs))
+    releaseNonLinear ();
+  if (VS != NULL) {
+    logprint (LOG_STATUS, "NOTIFY: %s: continuing from the previous "
+	      "solution\n", getName ());
+  }
 
   runs++;
   logprint (LOG_STATUS, "NOTIFY: %s: solving for %d frequencies\n",
@@ -179,8 +239,21 @@ int hbsolver::solve (void) {
       fprintf (stderr, "IC -- constant current in f:\n"); IC->print ();
 #endif
 
+    // continue from the Newton iterate of a previous run if requested
+    checkpoint cp (getName ());
+    bool checkpointing = checkpoint::enabled () && runs == 1;
+    if (checkpointing && checkpoint::resumes () &&
+	!loadCheckpoint (cp, iterations)) {
+      logprint (LOG_STATUS, "NOTIFY: %s: resuming after %d iterations\n",
+		getName (), iterations);
+    }
+
     // start iteration
+    nr_double_t fprev = 0.0;
+    int age = jsteps;
     do {
+      if (checkpointing && iterations > 0 && cp.due ())
+	saveCheckpoint (cp, iterations);
       iterations++;
 
 #if HB_DEBUG
@@ -229,11 +302,39 @@ int hbsolver::solve (void) {
 	break;
       }
 
+      /* the Jacobian is kept for the given number of Newton steps
+	 (Samanskii's method) as long as the error decreases fast
+	 enough */
+      nr_double_t fnorm = 0.0;
+      for (std::size_t i = 0; i < FV->size (); i++) fnorm += norm (FV->get (i));
+      bool refresh = age >= jsteps || fnorm > HB_CHORD_RATIO * fprev;
+      age = refresh ? 1 : age + 1;
+      fprev = fnorm;
+
 #if HB_DEBUG
       fprintf (stderr, "JG -- G-Jacobian in t:\n"); JG->print ();
       fprintf (stderr, "JQ -- C-Jacobian in t:\n"); JQ->print ();
 #endif
 
+      if (krylov) {
+	// block-diagonal preconditioner --> P = [YV] + j[O] * JQ0 + JG0
+	if (refresh) calcPreconditioner ();
+
+	// solve equation system iteratively --> JF * VS(n+1) = RH
+	solveVoltagesKrylov ();
+
+	// inverse FFT of frequency domain voltage vector VS(n+1)
+	VectorIFFT (vs);
+	continue;
+      }
+
+      if (!refresh) {
+	// solve with the previous factors --> JF * dV = -FV
+	solveVoltagesChord ();
+	VectorIFFT (vs);
+	continue;
+      }
+
       // G-Jacobian into frequency domain
       MatrixFFT (JG);
 
@@ -266,6 +367,9 @@ int hbsolver::solve (void) {
     while (!done && iterations < MaxIterations);
 
     if (iterations >= MaxIterations) {
+      // the next point of a sweep starts over
+      VS->set (0.0);
+      vs->set (0.0);
       qucs::exception * e = new qucs::exception (EXCEPTION_NO_CONVERGENCE);
       e->setText ("no convergence in %s analysis after %d iterations",
 		  getName (), iterations);
@@ -276,7 +380,9 @@ int hbsolver::solve (void) {
     else {
       logprint (LOG_STATUS, "%s: convergence reached after %d iterations\n",
 		getName (), iterations);
+      if (checkpointing) cp.remove ();
     }
+    reportWorkspace ();
   }
   else {
     // no balancing necessary
@@ -295,6 +401,12 @@ int hbsolver::solve (void) {
   return 0;
 }
 
+/* Forgets the solution of the previous point of a sweep, the next one
+   starts at the DC solution. */
+void hbsolver::resetSweep (void) {
+  releaseNonLinear ();
+}
+
 /* Goes through the list of circuit objects and runs its calcHB()
    function. */
 void hbsolver::calc (hbsolver * self) {
@@ -309,6 +421,7 @@ void hbsolver::calc (hbsolver * self) {
 void hbsolver::initHB (void) {
   circuit * root = subnet->getRoot ();
   for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    c->setRealMNA (false);
     c->initHB ();
   }
 }
@@ -318,6 +431,7 @@ void hbsolver::initHB (void) {
 void hbsolver::initDC (void) {
   circuit * root = subnet->getRoot ();
   for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    c->setRealMNA (false);
     c->initDC ();
   }
 }
@@ -363,13 +477,6 @@ void hbsolver::expandFrequencies (nr_double_t f, int n) {
   }
 }
 
-// Calculates an order fulfilling the "power of two" requirement.
-int hbsolver::calcOrder (int n) {
-  int o, order = n * 2;             // current order + DC + negative freqencies
-  for (o = 1; o < order; o <<= 1) ; // a power of 2
-  return o / 2 - 1;
-}
-
 /* The function computes the harmonic frequencies excited in the
    circuit list depending on the maximum number of harmonics per
    exitation and saves its results into the 'negfreqs' vector. */
@@ -382,8 +489,8 @@ void hbsolver::collectFrequencies (void) {
   dfreqs.clear ();
   delete[] ndfreqs;
 
-  // obtain order
-  int i, n = calcOrder (getPropertyInteger ("n"));
+  // obtain order, the mixed radix FFT handles any number of harmonics
+  int i, n = getPropertyInteger ("n");
 
   // expand frequencies for each exitation
   nr_double_t f;
@@ -419,6 +526,10 @@ void hbsolver::collectFrequencies (void) {
     ndfreqs[i] = (n + 1) * 2;
   }
 
+  // keep the relevant mixing products only
+  almost = strcmp (getPropertyString ("Truncation"), "box") != 0;
+  if (almost) truncateFrequencies (n);
+
 #if HB_DEBUG
   fprintf (stderr, "%d frequencies: [ ", negfreqs.getSize ());
   for (i = 0; i < negfreqs.getSize (); i++) {
@@ -435,10 +546,158 @@ void hbsolver::collectFrequencies (void) {
   lnfreqs = rfreqs.size ();
   nlfreqs = negfreqs.size ();
 
+  /* map the spectrum onto the real frequencies, the negative
+     frequencies are the conjugates of their positive counterparts;
+     in a box some of them have none and are not represented */
+  rindex.clear ();
+  sindex.assign (nlfreqs, -1);
+  rpair.assign (lnfreqs, false);
+  for (n = 0; n < nlfreqs; n++) {
+    if (negfreqs[n] < 0.0) continue;
+    sindex[n] = rindex.size ();
+    rindex.push_back (n);
+  }
+  for (n = 0; n < nlfreqs; n++) {
+    if ((f = negfreqs[n]) >= 0.0) continue;
+    for (i = 0; i < lnfreqs; i++) {
+      if (std::abs (rfreqs[i] + f) <= 1e-12 * -f) {
+	sindex[n] = i;
+	rpair[i] = true;
+	break;
+      }
+    }
+  }
+
   // pre-calculate the j[O] vector
+  delete OM;
   OM = new tvector<nr_complex_t> (nlfreqs);
   for (n = i = 0; n < nlfreqs; n++, i++)
     OM_(n) = nr_complex_t (0, 2 * pi * negfreqs[i]);
+
+  // time samples of the almost periodic transform
+  if (almost) almostPeriodic ();
+}
+
+/* The function replaces the box of mixing products of the excited
+   frequencies by the products retained by the truncation scheme.  The
+   diamond keeps the products whose orders sum up to at most the given
+   maximum order, the user list gives the orders of each product.  The
+   set is completed by the negative frequencies, coinciding frequencies
+   are merged.  The number of unknowns thus grows with the number of
+   retained products only. */
+void hbsolver::truncateFrequencies (int n) {
+  int i, k, nd = dfreqs.size (), all = negfreqs.size ();
+  const char * const type = getPropertyString ("Truncation");
+  std::vector< std::vector<int> > products;
+
+  if (!strcmp (type, "diamond")) {
+    int order = getPropertyInteger ("MaxOrder");
+    if (order <= 0) order = n;
+    // run through the box of orders of each frequency
+    std::vector<int> m (nd, -n);
+    while (true) {
+      int sum = 0;
+      for (i = 0; i < nd; i++) sum += std::abs (m[i]);
+      if (sum <= order) products.push_back (m);
+      for (i = 0; i < nd && ++m[i] > n; i++) m[i] = -n;
+      if (i == nd) break;
+    }
+  }
+  else {
+    // the orders of the products listed one frequency after another
+    vector * v = getPropertyVector ("Products");
+    int len = v ? v->getSize () : 0;
+    if (len % nd) {
+      logprint (LOG_ERROR, "WARNING: %s: %d orders do not make up products "
+		"of %d frequencies\n", getName (), len, nd);
+    }
+    for (k = 0; k + nd <= len; k += nd) {
+      std::vector<int> m (nd);
+      for (i = 0; i < nd; i++) m[i] = (int) std::lround (real (v->get (k + i)));
+      products.push_back (m);
+    }
+  }
+
+  // the distinct positive frequencies of the products
+  nr_double_t fmax = 0.0;
+  for (i = 0; i < nd; i++) fmax = std::max (fmax, std::abs (dfreqs[i]));
+  std::vector<nr_double_t> pos;
+  for (auto & m : products) {
+    nr_double_t f = 0.0;
+    for (i = 0; i < nd; i++) f += m[i] * dfreqs[i];
+    if (std::abs (f) > 1e-12 * fmax) pos.push_back (std::abs (f));
+  }
+  std::sort (pos.begin (), pos.end ());
+  rfreqs.clear ();
+  rfreqs.push_back (0.0);
+  for (nr_double_t f : pos)
+    if (f - rfreqs.back () > 1e-12 * fmax) rfreqs.push_back (f);
+
+  // DC, the positive and then the negative frequencies
+  negfreqs = rfreqs;
+  for (k = 1; k < (int) rfreqs.size (); k++) negfreqs.push_back (-rfreqs[k]);
+  rfreqs.clear ();
+
+  logprint (LOG_STATUS, "NOTIFY: %s: %d of %d mixing products retained by "
+	    "%s truncation\n", getName (), (int) negfreqs.size (), all, type);
+}
+
+/* The almost periodic transform evaluates the spectrum at as many time
+   samples as there are frequencies.  Out of twice as many random
+   samples over the period of the lowest frequency those are chosen
+   one by one which are farthest from the span of the already chosen
+   ones, i.e. the most orthogonal, such that the transform stays well
+   conditioned (Kundert, Sorkin and Sangiovanni-Vincentelli).  The
+   inverse transform maps the time samples back onto the spectrum. */
+void hbsolver::almostPeriodic (void) {
+  int i, k, c, n = nlfreqs, cands = 2 * nlfreqs;
+  // the transform of the previous point of a sweep
+  if (apfreqs == negfreqs) return;
+  apfreqs = negfreqs;
+  nr_double_t T = lnfreqs > 1 ? 1.0 / negfreqs[1] : 1.0;
+  std::mt19937 rng (1);
+  std::uniform_real_distribution<nr_double_t> dist (0.0, T);
+
+  // the rows of the transform for each candidate sample
+  std::vector<nr_double_t> t (cands);
+  std::vector< std::vector<nr_complex_t> > r (cands);
+  for (c = 0; c < cands; c++) {
+    t[c] = dist (rng);
+    r[c].resize (n);
+    for (k = 0; k < n; k++)
+      r[c][k] = std::polar (1.0, 2 * pi * negfreqs[k] * t[c]);
+  }
+  std::vector<bool> used (cands, false);
+  std::vector<nr_double_t> times;
+
+  // greedy selection by modified Gram-Schmidt orthogonalization
+  for (i = 0; i < n; i++) {
+    int best = -1;
+    nr_double_t nbest = -1;
+    for (c = 0; c < cands; c++) {
+      if (used[c]) continue;
+      nr_double_t nc = 0.0;
+      for (k = 0; k < n; k++) nc += norm (r[c][k]);
+      if (nc > nbest) { nbest = nc; best = c; }
+    }
+    used[best] = true;
+    times.push_back (t[best]);
+    std::vector<nr_complex_t> q = r[best];
+    nr_double_t d = std::sqrt (nbest);
+    for (k = 0; k < n; k++) q[k] /= d;
+    for (c = 0; c < cands; c++) {
+      if (used[c]) continue;
+      nr_complex_t p = 0.0;
+      for (k = 0; k < n; k++) p += conj (q[k]) * r[c][k];
+      for (k = 0; k < n; k++) r[c][k] -= p * q[k];
+    }
+  }
+
+  APT = tmatrix<nr_complex_t> (n);
+  for (i = 0; i < n; i++)
+    for (k = 0; k < n; k++)
+      APT (i, k) = std::polar (1.0, 2 * pi * negfreqs[k] * times[i]);
+  APF = inverse (APT);
 }
 
 // Split netlist into excitation, linear and non-linear part.
@@ -547,10 +806,25 @@ int hbsolver::assignNodes (ptrlist<circuit> circuits, strlist * nodes,
   return nodes->length ();
 }
 
+/* The function returns true if the linear part of the netlist changed
+   since the previous call, i.e. the frequencies or any of the numeric
+   properties of the linear circuits, e.g. by a parameter sweep. */
+bool hbsolver::linearChanged (void) {
+  std::vector<nr_double_t> sig = negfreqs;
+  for (auto *lc : lincircuits)
+    for (const std::string & p : lc->getDoubleProperties ())
+      sig.push_back (lc->getPropertyDouble (p));
+  bool changed = sig != linsig;
+  linsig = std::move (sig);
+  return changed;
+}
+
 // Prepares the linear operations.
 void hbsolver::prepareLinear (void) {
-  for (auto *lc : lincircuits)
+  for (auto *lc : lincircuits) {
+    lc->setRealMNA (false);
     lc->initHB ();
+  }
   nlnvsrcs = assignVoltageSources (lincircuits);
   nnlvsrcs = excitations.size ();
   nnanodes = nanodes->length ();
@@ -563,44 +837,39 @@ void hbsolver::prepareLinear (void) {
   calcConstantCurrent ();
 }
 
-/* The function creates the complex linear network MNA matrix.  It
-   contains the MNA entries for all linear components for each
-   requested frequency. */
+/* The function creates the complex linear network MNA matrices.  The
+   linear network does not couple different frequencies, thus there
+   is one MNA matrix containing the entries of all linear components
+   for each requested frequency. */
 void hbsolver::createMatrixLinearA (void) {
   int M = nlnvsrcs;
   int N = nnanodes;
-  int f = 0;
-  nr_double_t freq;
 
-  // create new MNA matrix
-  A = new tmatrix<nr_complex_t> ((N + M) * lnfreqs);
+  // create new MNA matrices
+  NB.assign (lnfreqs, tmatrix<nr_complex_t> (N + M));
 
   // through each frequency
-  for (int i = 0; i < rfreqs.size (); i++) {
-    freq = rfreqs[i];
+  for (int f = 0; f < lnfreqs; f++) {
     // calculate components' MNA matrix for the given frequency
     for (auto *lc : lincircuits)
-      lc->calcHB (freq);
+      lc->calcHB (rfreqs[f]);
     // fill in all matrix entries for the given frequency
-    fillMatrixLinearA (A, f++);
+    fillMatrixLinearA (&NB[f]);
   }
-
-  // save a copy of the original MNA matrix
-  NA = new tmatrix<nr_complex_t> (*A);
 }
 
 // some definitions for the linear matrix filler
 #undef  A_
 #undef  B_
-#define A_(r,c) (*A) ((r)*lnfreqs+f,(c)*lnfreqs+f)
+#define A_(r,c) (*A) (r,c)
 #define G_(r,c) A_(r,c)
 #define B_(r,c) A_(r,c+N)
 #define C_(r,c) A_(r+N,c)
 #define D_(r,c) A_(r+N,c+N)
 
-/* This function fills in the MNA matrix entries into the A matrix for
-   a given frequency index. */
-void hbsolver::fillMatrixLinearA (tmatrix<nr_complex_t> * A, int f) {
+/* This function fills in the MNA matrix entries into the A matrix of
+   a single frequency. */
+void hbsolver::fillMatrixLinearA (tmatrix<nr_complex_t> * A) {
   int N = nnanodes;
 
   // through each linear circuit
@@ -658,29 +927,21 @@ void hbsolver::invertMatrix (tmatrix<nr_complex_t> * A,
   tvector<nr_complex_t> * x = new tvector<nr_complex_t> (N);
   tvector<nr_complex_t> * z = new tvector<nr_complex_t> (N);
 
-  try_running () {
-    // create LU decomposition of the A matrix
-    eqns.setAlgo (ALGO_LU_FACTORIZATION_CROUT);
-    eqns.passEquationSys (A, x, z);
-    eqns.solve ();
-  }
-  // appropriate exception handling
-  catch_exception () {
-  case EXCEPTION_PIVOT:
-  default:
+  int mark = numstatus::mark ();
+  // create LU decomposition of the A matrix
+  eqns.setAlgo (ALGO_LU_DECOMPOSITION_CROUT);
+  eqns.passEquationSys (A, x, z);
+  eqns.factorize ();
+  // appropriate failure handling
+  if (numstatus::raised (mark)) {
     logprint (LOG_ERROR, "WARNING: %s: during TI inversion\n", getName ());
+    numstatus::report (mark);
     estack.print ();
   }
 
   // use the LU decomposition to obtain the inverse H
-  eqns.setAlgo (ALGO_LU_SUBSTITUTION_CROUT);
-  for (int c = 0; c < N; c++) {
-    z->set (0.0);
-    z->set (c, 1.0);
-    eqns.passEquationSys (A, x, z);
-    eqns.solve ();
-    for (int r = 0; r < N; r++) H->set (r, c, x->get (r));
-  }
+  tmatrix<nr_complex_t> E = teye<nr_complex_t> (N);
+  eqns.solveMany (&E, H);
   delete x;
   delete z;
 }
@@ -694,177 +955,158 @@ void hbsolver::invertMatrix (tmatrix<nr_complex_t> * A,
 #define Z_(r,c) (*Z) (r,c)
 #define Y_(r,c) (*Y) (r,c)
 
-#define ZVU_(r,c) Z_(r,c)
-#define ZVL_(r,c) Z_((r)*lnfreqs+f+sn,c)
-#define ZCU_(r,c) Z_(r,(c)*lnfreqs+f+sn)
-#define ZCL_(r,c) Z_((r)*lnfreqs+f+sn,(c)*lnfreqs+f+sn)
-
 #define YV_(r,c) (*YV) (r,c)
-#define NA_(r,c) (*NA) (r,c)
+#define YD_(r,c) (*YD) (r,c)
+#define PC_(r,c) (*PC) (r,c)
 #define JF_(r,c) (*JF) (r,c)
 
-/* The following function performs the following steps:
+/* The following function computes the transadmittance matrices of
+   the linear network.  They are block diagonal in the frequencies,
+   thus the blocks are computed independently of each other by the
+   worker threads.  Only the full variable transadmittance matrix
+   required by the direct solver is expanded from the blocks. */
+void hbsolver::createMatrixLinearY (void) {
+  int n = std::min (threads, lnfreqs);
+  int sv = nbanodes;
+
+  // distribute the frequencies over the worker threads
+  YB.assign (lnfreqs, tmatrix<nr_complex_t> ());
+  if (n > 1) {
+    threadpool::run (n, [this, n] (int t) { calcMatrixLinearY (t, n); });
+  }
+  else {
+    calcMatrixLinearY (0, 1);
+  }
+
+  delete YD; YD = NULL;
+  delete YV; YV = NULL;
+  if (krylov) {
+    // keep the frequency diagonals of the transadmittance matrix only
+    YD = new tmatrix<nr_complex_t> (sv * nlfreqs, sv);
+    *YD = expandDiagonals (YB, sv);
+  }
+  else {
+    // extract the variable transadmittance matrix
+    YV = new tmatrix<nr_complex_t> (sv * nlfreqs);
+
+    // variable transadmittance matrix must be continued conjugately
+    *YV = expandMatrix (YB, sv);
+  }
+}
+
+/* The following function performs the following steps for every n-th
+   frequency beginning with the given one:
    1. form the MNA matrix A including all nodes (linear, non-linear and
       excitations)
    2. compute the variable transimpedance matrix entries for the nodes
       to be balanced
    3. compute the constant transimpedance matrix entries for the constant
       current vector caused by the excitations
-   4. invert this overall transimpedance matrix
-   5. extract the variable transadmittance matrix entries
+   4. invert this transimpedance matrix
+   5. extract the transadmittance matrix entries
 */
-void hbsolver::createMatrixLinearY (void) {
+void hbsolver::calcMatrixLinearY (int first, int step) {
   int M = nlnvsrcs;
   int N = nnanodes;
   int c, r, f;
 
-  // size of overall MNA matrix
-  int sa = (N + M) * lnfreqs;
+  // size of MNA matrix
+  int sa = N + M;
   int sv = nbanodes;
   int se = nnlvsrcs;
   int sy = sv + se;
 
-  // allocate new transimpedance matrix
-  Z = new tmatrix<nr_complex_t> (sy * lnfreqs);
-
-  // prepare equation system
-  eqnsys<nr_complex_t> eqns;
-  tvector<nr_complex_t> * V;
-  tvector<nr_complex_t> * I;
-
-  // 1. create variable transimpedance matrix entries relating
-  // voltages at the balanced nodes to the currents through these
-  // nodes into the non-linear part
-  int sn = sv * lnfreqs;
-  V = new tvector<nr_complex_t> (sa);
-  I = new tvector<nr_complex_t> (sa);
+  for (f = first; f < lnfreqs; f += step) {
+    tmatrix<nr_complex_t> * A = new tmatrix<nr_complex_t> (NB[f]);
+    tmatrix<nr_complex_t> * I = new tmatrix<nr_complex_t> (sa, sy);
+    tmatrix<nr_complex_t> * V = new tmatrix<nr_complex_t> (sa, sy);
+    tmatrix<nr_complex_t> * Z = new tmatrix<nr_complex_t> (sy);
+    tmatrix<nr_complex_t> * Y = new tmatrix<nr_complex_t> (sy);
+    tvector<nr_complex_t> x (sa), z (sa);
+    eqnsys<nr_complex_t> eqns;
 
-  // connect a 100 Ohm resistor (to ground) to balanced node in the MNA matrix
-  for (c = 0; c < sv * lnfreqs; c++) A_(c, c) += 0.01;
+    // connect a 100 Ohm resistor (to ground) to balanced node in the MNA
+    // matrix and feed a unit current into it
+    for (c = 0; c < sv; c++) {
+      A_(c, c) += 0.01;
+      (*I) (c, c) = 1.0;
+    }
 
-  // connect a 100 Ohm resistor (in parallel) to each excitation
-  for (auto *vs : excitations) {
-    // get positive and negative node
-    int pnode = vs->getNode(NODE_1)->getNode ();
-    int nnode = vs->getNode(NODE_2)->getNode ();
-    for (f = 0; f < lnfreqs; f++) { // for each frequency
-      int pn = (pnode - 1) * lnfreqs + f;
-      int nn = (nnode - 1) * lnfreqs + f;
-      if (pnode) A_(pn, pn) += 0.01;
-      if (nnode) A_(nn, nn) += 0.01;
-      if (pnode && nnode) {
+    // connect a 100 Ohm resistor (in parallel) to each excitation and
+    // feed a unit current through it
+    c = sv;
+    for (auto *vs : excitations) {
+      // get positive and negative node
+      int pn = vs->getNode(NODE_1)->getNode () - 1;
+      int nn = vs->getNode(NODE_2)->getNode () - 1;
+      if (pn >= 0) {
+	A_(pn, pn) += 0.01;
+	(*I) (pn, c) = +1.0;
+      }
+      if (nn >= 0) {
+	A_(nn, nn) += 0.01;
+	(*I) (nn, c) = -1.0;
+      }
+      if (pn >= 0 && nn >= 0) {
 	A_(pn, nn) -= 0.01;
 	A_(nn, pn) -= 0.01;
       }
+      c++;
     }
-  }
 
-  // LU decompose the MNA matrix
-  try_running () {
-    eqns.setAlgo (ALGO_LU_FACTORIZATION_CROUT);
-    eqns.passEquationSys (A, V, I);
-    eqns.solve ();
-  }
-  // appropriate exception handling
-  catch_exception () {
-  case EXCEPTION_PIVOT:
-  default:
-    logprint (LOG_ERROR, "WARNING: %s: during A factorization\n", getName ());
-    estack.print ();
-  }
-
-  // aquire variable transimpedance matrix entries
-  eqns.setAlgo (ALGO_LU_SUBSTITUTION_CROUT);
-  for (c = 0; c < sn; c++) {
-    I->set (0.0);
-    I_(c) = 1.0;
-    eqns.passEquationSys (A, V, I);
-    eqns.solve ();
-    // ZV | ..
-    // ---+---
-    // .. | ..
-    for (r = 0; r < sn; r++) ZVU_(r, c) = V_(r);
-    // .. | ..
-    // ---+---
-    // ZV | ..
-    r = 0;
-    for (auto ite = excitations.begin(); ite != excitations.end(); ++ite, r++) {
-      // lower part entries
-      for (f = 0; f < lnfreqs; f++) {
-	ZVL_(r, c) = excitationZ (V, *ite, f);
-      }
+    // LU decompose the MNA matrix
+    int mark = numstatus::mark ();
+    eqns.setAlgo (ALGO_LU_DECOMPOSITION_CROUT);
+    eqns.passEquationSys (A, &x, &z);
+    eqns.factorize ();
+    // appropriate failure handling
+    if (numstatus::raised (mark)) {
+      logprint (LOG_ERROR, "WARNING: %s: during A factorization\n",
+		getName ());
+      numstatus::report (mark);
+      estack.print ();
     }
-  }
 
-  // create constant transimpedance matrix entries relating the
-  // source voltages to the interconnection currents
-  int vsrc = 0;
-  // aquire constant transadmittance matrix entries
-  for (auto it = excitations.begin(); it != excitations.end(); ++it, vsrc++) {
-    circuit * vs = *it;
-    // get positive and negative node
-    int pnode = vs->getNode(NODE_1)->getNode ();
-    int nnode = vs->getNode(NODE_2)->getNode ();
-    for (f = 0; f < lnfreqs; f++) { // for each frequency
-      int pn = (pnode - 1) * lnfreqs + f;
-      int nn = (nnode - 1) * lnfreqs + f;
-      I->set (0.0);
-      if (pnode) I_(pn) = +1.0;
-      if (nnode) I_(nn) = -1.0;
-      eqns.passEquationSys (A, V, I);
-      eqns.solve ();
-      // .. | ZC
+    // aquire the transimpedance matrix entries for all unit currents
+    eqns.solveMany (I, V);
+    for (c = 0; c < sy; c++) {
+      // ZV | ZC
       // ---+---
       // .. | ..
-      for (r = 0; r < sn; r++) {
-	// upper part of the entries
-	ZCU_(r, vsrc) = V_(r);
-      }
+      for (r = 0; r < sv; r++) Z_(r, c) = (*V) (r, c);
       // .. | ..
       // ---+---
-      // .. | ZC
-      r = 0;
-      for (auto ite = excitations.begin(); ite != excitations.end(); ++ite, r++) {
-	// lower part entries
-	ZCL_(r, vsrc) = excitationZ (V, *ite, f);
-      }
+      // ZV | ZC
+      r = sv;
+      for (auto *vs : excitations) Z_(r++, c) = excitationZ (V, vs, c);
     }
-  }
-  delete I;
-  delete V;
-
-  // allocate new transadmittance matrix
-  Y = new tmatrix<nr_complex_t> (sy * lnfreqs);
 
-  // invert the Z matrix to a Y matrix
-  invertMatrix (Z, Y);
+    // invert the Z matrix to a Y matrix
+    invertMatrix (Z, Y);
 
-  // substract the 100 Ohm resistor
-  for (c = 0; c < sy * lnfreqs; c++) Y_(c, c) -= 0.01;
+    // substract the 100 Ohm resistor
+    for (c = 0; c < sy; c++) Y_(c, c) -= 0.01;
+    YB[f] = *Y;
 
-  // extract the variable transadmittance matrix
-  YV = new tmatrix<nr_complex_t> (sv * nlfreqs);
-
-  // variable transadmittance matrix must be continued conjugately
-  *YV = expandMatrix (*Y, sv);
-
-  // delete overall temporary MNA matrix
-  delete A; A = NULL;
-  // delete transimpedance matrix
-  delete Z; Z = NULL;
+    delete A;
+    delete I;
+    delete V;
+    delete Z;
+    delete Y;
+  }
 }
 
 /* Little helper function obtaining a transimpedance value for the
-   given voltage source (excitation) and for a given frequency
-   index. */
-nr_complex_t hbsolver::excitationZ (tvector<nr_complex_t> * V, circuit * vs,
-				    int f) {
+   given voltage source (excitation) from the given column of node
+   voltages. */
+nr_complex_t hbsolver::excitationZ (tmatrix<nr_complex_t> * V, circuit * vs,
+				    int c) {
   // get positive and negative node
   int pnode = vs->getNode(NODE_1)->getNode ();
   int nnode = vs->getNode(NODE_2)->getNode ();
   nr_complex_t z = 0.0;
-  if (pnode) z += V_((pnode - 1) * lnfreqs + f);
-  if (nnode) z -= V_((nnode - 1) * lnfreqs + f);
+  if (pnode) z += (*V) (pnode - 1, c);
+  if (nnode) z -= (*V) (nnode - 1, c);
   return z;
 }
 
@@ -874,53 +1116,56 @@ nr_complex_t hbsolver::excitationZ (tvector<nr_complex_t> * V, circuit * vs,
 void hbsolver::calcConstantCurrent (void) {
   int se = nnlvsrcs * lnfreqs;
   int sn = nbanodes * lnfreqs;
-  int r, c, vsrc = 0;
+  int sv = nbanodes;
+  int r, c, f, vsrc = 0;
 
   // collect excitation voltages
   tvector<nr_complex_t> VC (se);
   for (auto it = excitations.begin(); it != excitations.end(); ++it, vsrc++) {
     circuit * vs = *it;
+    vs->setRealMNA (false);
     vs->initHB ();
     vs->setVoltageSource (0);
-    for (int f = 0; f < rfreqs.size (); f++) { // for each frequency
+    for (f = 0; f < rfreqs.size (); f++) { // for each frequency
       nr_double_t freq = rfreqs[f];
       vs->calcHB (freq);
       VC (vsrc * lnfreqs + f) = vs->getE (VSRC_1);
     }
   }
 
-  // compute constant current vector for balanced nodes
+  // compute constant current vectors for balanced nodes and for the
+  // sources itself, frequency by frequency
+  delete IC;
+  delete IS;
   IC = new tvector<nr_complex_t> (sn);
-  // .. | YC * VC
-  // ---+---
-  // .. | ..
-  for (r = 0; r < sn; r++) {
-    nr_complex_t i = 0.0;
-    for (c = 0; c < se; c++) {
-      i += Y_(r, c + sn) * VC (c);
-    }
-    int f = r % lnfreqs;
-    if (f != 0 && f != lnfreqs - 1) i /= 2;
-    IC->set (r, i);
-  }
-  // expand the constant current conjugate
-  *IC = expandVector (*IC, nbanodes);
-
-  // compute constant current vector for sources itself
   IS = new tvector<nr_complex_t> (se);
-  // .. | ..
-  // ---+---
-  // .. | YC * VC
-  for (r = 0; r < se; r++) {
-    nr_complex_t i = 0.0;
-    for (c = 0; c < se; c++) {
-      i += Y_(r + sn, c + sn) * VC (c);
+  for (f = 0; f < lnfreqs; f++) {
+    tmatrix<nr_complex_t> * Y = &YB[f];
+    // .. | YC * VC
+    // ---+---
+    // .. | ..
+    for (r = 0; r < nbanodes; r++) {
+      nr_complex_t i = 0.0;
+      for (c = 0; c < nnlvsrcs; c++) {
+	i += Y_(r, c + sv) * VC (c * lnfreqs + f);
+      }
+      if (rpair[f]) i /= 2;
+      IC->set (r * lnfreqs + f, i);
+    }
+    // .. | ..
+    // ---+---
+    // .. | YC * VC
+    for (r = 0; r < nnlvsrcs; r++) {
+      nr_complex_t i = 0.0;
+      for (c = 0; c < nnlvsrcs; c++) {
+	i += Y_(r + sv, c + sv) * VC (c * lnfreqs + f);
+      }
+      IS->set (r * lnfreqs + f, i);
     }
-    IS->set (r, i);
   }
-
-  // delete overall transadmittance matrix
-  delete Y; Y = NULL;
+  // expand the constant current conjugate, the transadmittance
+  // matrices are kept for the following points of a sweep
+  *IC = expandVector (*IC, nbanodes);
 }
 
 /* Checks whether currents through the interconnects of the linear and
@@ -952,6 +1197,8 @@ int hbsolver::checkBalance (void) {
 #undef  C_
 #define G_(r,c) (*jg) ((r)*nlfreqs+f,(c)*nlfreqs+f)
 #define C_(r,c) (*jq) ((r)*nlfreqs+f,(c)*nlfreqs+f)
+#define GD_(r,c) (*jg) ((r)*nlfreqs+f,c)
+#define CD_(r,c) (*jq) ((r)*nlfreqs+f,c)
 #undef  FI_
 #undef  FQ_
 #define FI_(r) (*ig) ((r)*nlfreqs+f)
@@ -968,25 +1215,35 @@ void hbsolver::fillMatrixNonLinear (tmatrix<nr_complex_t> * jg,
 				    tvector<nr_complex_t> * ir,
 				    tvector<nr_complex_t> * qr,
 				    int f) {
-  // through each linear circuit
-  for (auto *cir: nolcircuits) {
+  // through each non-linear circuit
+  for (unsigned int k = 0; k < nlcircuits.size (); k++) {
+    circuit * cir = nlcircuits[k];
+    hbstamps & st = nlstamps[k];
     int s = cir->getSize ();
     int nr, nc, r, c;
+    nr_double_t * y = st.y (f), * qv = st.qv (f);
+    nr_double_t * i = st.i (f), * q = st.q (f);
+    nr_double_t * gv = st.gv (f), * cv = st.cv (f);
 
     for (r = 0; r < s; r++) {
       if ((nr = cir->getNode(r)->getNode () - 1) < 0) continue;
       // apply G- and C-matrix entries
       for (c = 0; c < s; c++) {
 	if ((nc = cir->getNode(c)->getNode () - 1) < 0) continue;
-	G_(nr, nc) += cir->getY (r, c);
-	C_(nr, nc) += cir->getQV (r, c);
+	if (krylov) {
+	  GD_(nr, nc) += y[r * s + c];
+	  CD_(nr, nc) += qv[r * s + c];
+	} else {
+	  G_(nr, nc) += y[r * s + c];
+	  C_(nr, nc) += qv[r * s + c];
+	}
       }
       // apply I- and Q-vector entries
-      FI_(nr) -= cir->getI (r);
-      FQ_(nr) -= cir->getQ (r);
+      FI_(nr) -= i[r];
+      FQ_(nr) -= q[r];
       // ThinkME: positive or negative?
-      IR_(nr) += cir->getGV (r) + cir->getI (r);
-      QR_(nr) += cir->getCV (r) + cir->getQ (r);
+      IR_(nr) += gv[r] + i[r];
+      QR_(nr) += cv[r] + q[r];
     }
   }
 }
@@ -1008,14 +1265,28 @@ void hbsolver::prepareNonLinear (void) {
   if (QR == NULL) {
     QR = new tvector<nr_complex_t> (N * nlfreqs);
   }
-  if (JG == NULL) {
-    JG = new tmatrix<nr_complex_t> (N * nlfreqs);
-  }
-  if (JQ == NULL) {
-    JQ = new tmatrix<nr_complex_t> (N * nlfreqs);
+  if (krylov) {
+    // time samples of the Jacobians and the preconditioner blocks
+    if (JG == NULL) {
+      JG = new tmatrix<nr_complex_t> (N * nlfreqs, N);
+    }
+    if (JQ == NULL) {
+      JQ = new tmatrix<nr_complex_t> (N * nlfreqs, N);
+    }
+    if (PC == NULL) {
+      PC = new tmatrix<nr_complex_t> (N * nlfreqs, N);
+    }
   }
-  if (JF == NULL) {
-    JF = new tmatrix<nr_complex_t> (N * nlfreqs);
+  else {
+    if (JG == NULL) {
+      JG = new tmatrix<nr_complex_t> (N * nlfreqs);
+    }
+    if (JQ == NULL) {
+      JQ = new tmatrix<nr_complex_t> (N * nlfreqs);
+    }
+    if (JF == NULL) {
+      JF = new tmatrix<nr_complex_t> (N * nlfreqs);
+    }
   }
 
   // voltage vector in frequency and time domain
@@ -1046,29 +1317,182 @@ void hbsolver::prepareNonLinear (void) {
     IN = new tvector<nr_complex_t> (N * nlfreqs);
   }
 
+  // workspace of the iterations
+  if (ws == NULL) {
+    ws = new hbworkspace (N, nlfreqs, threads, krylov,
+			  getPropertyInteger ("JacobianSteps") > 1);
+    ws->account (FQ); ws->account (IG); ws->account (IR); ws->account (QR);
+    ws->account (JG); ws->account (JQ);
+    ws->account (krylov ? PC : JF);
+    ws->account (VS); ws->account (vs); ws->account (VP);
+    ws->account (FV); ws->account (RH); ws->account (IL); ws->account (IN);
+    ws->account (krylov ? YD : YV);
+    ws->account (IC);
+  }
+
   // assign nodes
   assignNodes (nolcircuits, nanodes);
 
   // initialize circuits
+  nlcircuits.clear ();
   for (auto *cir : nolcircuits) {
+    cir->setRealMNA (false);
     cir->initHB (nlfreqs);
+    nlcircuits.push_back (cir);
+  }
+  nlstamps.resize (nlcircuits.size ());
+  for (unsigned int k = 0; k < nlcircuits.size (); k++)
+    nlstamps[k].resize (nlcircuits[k]->getSize (), nlfreqs);
+}
+
+/* The function estimates the memory of the Newton steps.  The direct
+   solvers hold several dense matrices of the size of all unknowns, the
+   matrix-free GMRES solver keeps the frequency diagonals of the node
+   blocks and its Krylov basis only.  If the direct solver exceeds the
+   MemoryLimit property (in MB, zero for none), the GMRES solver is
+   used instead.  The choice is made from the sizes only, thus it is the
+   same for all points of a sweep with unchanged frequencies. */
+void hbsolver::selectSolver (void) {
+  nr_double_t limit = getPropertyDouble ("MemoryLimit");
+  if (limit <= 0) return;
+
+  nr_double_t N = banodes->length (), n = N * nlfreqs;
+  nr_double_t MB = sizeof (nr_complex_t) / 1048576.0;
+  nr_double_t direct = HB_DIRECT_MATRICES * n * n * MB;
+  nr_double_t iterative = (4 * N + HB_GMRES_RESTART + 6) * n * MB;
+
+  if (!krylov && direct > limit) {
+    krylov = true;
+    mixed = false;
+    logprint (LOG_STATUS, "NOTIFY: %s: direct solver requires %.1f MB, "
+	      "above the limit of %.1f MB, using GMRES with %.1f MB\n",
+	      getName (), direct, limit, iterative);
+  }
+  else if (!krylov) {
+    logprint (LOG_STATUS, "NOTIFY: %s: direct solver requires %.1f MB "
+	      "within the limit of %.1f MB\n", getName (), direct, limit);
+  }
+  if (krylov && iterative > limit) {
+    logprint (LOG_ERROR, "WARNING: %s: GMRES solver requires %.1f MB, "
+	      "above the limit of %.1f MB\n", getName (), iterative, limit);
+  }
+}
+
+/* The function deletes the buffers of the non-linear balancing, e.g.
+   if the number of frequencies changed between the points of a
+   sweep. */
+void hbsolver::releaseNonLinear (void) {
+  delete FQ; delete IG; delete IR; delete QR;
+  delete JG; delete JQ; delete JF; delete PC;
+  delete VS; delete vs; delete VP;
+  delete FV; delete RH; delete IL; delete IN;
+  delete ws;
+  FQ = IG = IR = QR = VS = vs = VP = FV = RH = IL = IN = NULL;
+  JG = JQ = JF = PC = NULL;
+  ws = NULL;
+}
+
+/* Constructor creates the workspace of the HB iterations for the
+   given number of balanced nodes, time samples and worker threads.
+   Only the buffers required by the given solver are allocated, the
+   last argument requests those of the simplified Newton steps. */
+hbworkspace::hbworkspace (int nodes, int samples, int threads,
+			  bool krylov, bool chord) {
+  int n = nodes * samples;
+  buffers = 0;
+  bytes = 0;
+
+  if (krylov) {
+    int m = std::min (HB_GMRES_RESTART, n);
+    r = w = z = g = q = tvector<nr_complex_t> (n);
+    V.assign (m + 1, tvector<nr_complex_t> (n));
+    H = tmatrix<nr_complex_t> (m + 1, m);
+    sn.resize (m);
+    e.resize (m + 1);
+    y.resize (m);
+    cs.resize (m);
+    buffers += 5 + m + 1 + 5;
+    bytes += (5 + m + 1) * n * sizeof (nr_complex_t);
+    bytes += (m + 1) * m * sizeof (nr_complex_t);
+    bytes += (3 * m + 1) * sizeof (nr_complex_t) + m * sizeof (nr_double_t);
+
+    G0 = Q0 = P = PH = tmatrix<nr_complex_t> (nodes);
+    E = teye<nr_complex_t> (nodes);
+    px = pz = tvector<nr_complex_t> (nodes);
+    buffers += 7;
+    bytes += (5 * nodes + 2) * nodes * sizeof (nr_complex_t);
+  }
+  else {
+    int t = std::max (1, std::min (threads, nodes * nodes));
+    fft.assign (t, std::vector<nr_complex_t> (samples));
+    buffers += t;
+    bytes += t * samples * sizeof (nr_complex_t);
+    if (chord) {
+      d = b = tvector<nr_complex_t> (n);
+      buffers += 2;
+      bytes += 2 * n * sizeof (nr_complex_t);
+    }
   }
 }
 
-/* Saves the node voltages of the given circuit and for the given
-   frequency entry into the circuit voltage vector. */
-void hbsolver::saveNodeVoltages (circuit * cir, int f) {
+// The functions add the given vector or matrix to the statistics.
+void hbworkspace::account (tvector<nr_complex_t> * v) {
+  buffers++;
+  bytes += v->size () * sizeof (nr_complex_t);
+}
+
+void hbworkspace::account (tmatrix<nr_complex_t> * m) {
+  buffers++;
+  bytes += (std::size_t) m->getRows () * m->getCols () *
+    sizeof (nr_complex_t);
+}
+
+// Logs the number of buffers and the memory used by the iterations.
+void hbsolver::reportWorkspace (void) {
+  logprint (LOG_STATUS, "NOTIFY: %s: %d buffers with %.3f MB allocated "
+	    "before the iterations\n", getName (), ws->getBuffers (),
+	    ws->getBytes () / 1048576.0);
+}
+
+/* Saves the node voltages of the given circuit at all the time samples
+   into its stamps, the ground node is at zero voltage. */
+void hbsolver::saveNodeVoltages (circuit * cir, hbstamps & st) {
   int r, nr, s = cir->getSize ();
   for (r = 0; r < s; r++) {
-    if ((nr = cir->getNode(r)->getNode () - 1) < 0) continue;
-    // apply V-vector entries
-    cir->setV (r, real (vs->get (nr * nlfreqs + f)));
+    nr = cir->getNode(r)->getNode () - 1;
+    for (int f = 0; f < nlfreqs; f++)
+      st.v (f)[r] = nr < 0 ? 0.0 : real (vs->get (nr * nlfreqs + f));
+  }
+}
+
+/* Runs the HB calculators of the k-th of n parts of the concurrently
+   evaluated non-linear circuits, or of all the others if n is zero.
+   Each circuit gets the node voltages of all the time samples at once
+   and writes into its own stamps only. */
+void hbsolver::calcNonLinear (int k, int n) {
+  int i, p, first = 0, last = 0, size = nlcircuits.size ();
+  if (n > 0) {
+    for (p = 0, i = 0; i < size; i++) p += nlcircuits[i]->isParallel ();
+    first = p * k / n;
+    last = p * (k + 1) / n;
+  }
+  for (p = 0, i = 0; i < size; i++) {
+    circuit * cir = nlcircuits[i];
+    if (n > 0) {
+      if (!cir->isParallel ()) continue;
+      if (p++ < first || p > last) continue;
+    }
+    else if (cir->isParallel ()) continue;
+    saveNodeVoltages (cir, nlstamps[i]);
+    cir->calcHB (nlstamps[i]);
   }
 }
 
 /* The function saves voltages into non-linear circuits, runs each
-   non-linear components' HB calculator for each frequency and applies
-   the matrix and vector entries appropriately. */
+   non-linear components' HB calculator for all the time samples and
+   applies the matrix and vector entries appropriately.  The stamps are
+   collected in circuit order, thus the result does not depend on the
+   number of threads. */
 void hbsolver::loadMatrices (void) {
   // clear matrices and vectors before
   IG->set (0.0);
@@ -1077,14 +1501,18 @@ void hbsolver::loadMatrices (void) {
   QR->set (0.0);
   JG->set (0.0);
   JQ->set (0.0);
-  // through each frequency
+  // calculate components' HB matrices and vectors for all samples
+  int n = std::min (threads, (int) nlcircuits.size ());
+  if (n > 1) {
+    threadpool::run (n, [this, n] (int t) { calcNonLinear (t, n); });
+  }
+  else {
+    calcNonLinear (0, 1);
+  }
+  calcNonLinear (0, 0);
+
+  // fill in all matrix entries for each frequency
   for (int f = 0; f < nlfreqs; f++) {
-    // calculate components' HB matrices and vector for the given frequency
-    for (auto *cir : nolcircuits) {
-      saveNodeVoltages (cir, f); // node voltages
-      cir->calcHB (f);         // HB calculator
-    }
-    // fill in all matrix entries for the given frequency
     fillMatrixNonLinear (JG, JQ, IG, FQ, IR, QR, f);
   }
 }
@@ -1094,27 +1522,41 @@ void hbsolver::loadMatrices (void) {
    \todo rewrite ugly sould die
 */
 void hbsolver::VectorFFT (tvector<nr_complex_t> * V, int isign) {
-  int i, k, r;
   int n = nlfreqs;
-  int nd = dfreqs.size ();
   int nodes = V->size () / n;
   nr_double_t * d = (double *)V->getData ();
 
-  if (nd == 1) {
-    // for each node a single 1d-FFT
-    for (k = i = 0; i < nodes; i++, k += 2 * n) {
-      nr_double_t * dst = &d[k];
-      _fft_1d (dst, n, isign);
-      if (isign > 0) for (r = 0; r < 2 * n; r++) *dst++ /= n;
+  // for each node a single FFT
+  for (int k = 0, i = 0; i < nodes; i++, k += 2 * n) {
+    NodeFFT (&d[k], isign);
+  }
+}
+
+/* The function transforms the data of a single node (real and
+   imaginary pairs) in place. */
+void hbsolver::NodeFFT (nr_double_t * dst, int isign) {
+  int r, n = nlfreqs;
+  int nd = dfreqs.size ();
+
+  if (almost) {
+    // dense almost periodic transform
+    static thread_local std::vector<nr_complex_t> work;
+    nr_complex_t * d = (nr_complex_t *) dst;
+    tmatrix<nr_complex_t> & A = isign > 0 ? APF : APT;
+    work.assign (d, d + n);
+    for (r = 0; r < n; r++) {
+      nr_complex_t v = 0.0;
+      for (int c = 0; c < n; c++) v += A (r, c) * work[c];
+      d[r] = v;
     }
   }
+  else if (nd == 1) {
+    _fft_1d (dst, n, isign);
+    if (isign > 0) for (r = 0; r < 2 * n; r++) *dst++ /= n;
+  }
   else {
-    // for each node a single nd-FFT
-    for (k = i = 0; i < nodes; i++, k += 2 * n) {
-      nr_double_t * dst = &d[k];
-      _fft_nd (dst, ndfreqs, nd, isign);
-      if (isign > 0) for (r = 0; r < 2 * n; r++) *dst++ /= ndfreqs[0];
-    }
+    _fft_nd (dst, ndfreqs, nd, isign);
+    if (isign > 0) for (r = 0; r < 2 * n; r++) *dst++ /= ndfreqs[0];
   }
 }
 
@@ -1125,6 +1567,49 @@ void hbsolver::VectorIFFT (tvector<nr_complex_t> * V, int isign) {
   VectorFFT (V, -isign);
 }
 
+/* The function returns the key of the checkpoint.  It consists of the
+   size of the HB equations and a hash of the non-linear circuits. */
+std::string hbsolver::checkpointKey (void) {
+  std::string list;
+  for (circuit * c : nolcircuits) {
+    list += c->getName ();
+    list += ";";
+  }
+  return std::string ("harmonic balance ") + getName () + " " +
+    std::to_string (nbanodes) + " " + std::to_string (nlfreqs) + " " +
+    std::to_string (std::hash<std::string> () (list));
+}
+
+/* Writes the number of iterations done and the current and previous
+   Newton iterate into the checkpoint.  Returns zero on success. */
+int hbsolver::saveCheckpoint (checkpoint & cp, int iterations) {
+  if (cp.create (checkpointKey ())) return -1;
+  cp.put (iterations);
+  cp.put ((nr_double_t *) VS->getData (), 2 * (int) VS->size ());
+  cp.put ((nr_double_t *) VP->getData (), 2 * (int) VP->size ());
+  return cp.commit ();
+}
+
+/* Reads the Newton iterate back and restores its time domain voltages.
+   Returns zero on success. */
+int hbsolver::loadCheckpoint (checkpoint & cp, int & iterations) {
+  if (cp.open (checkpointKey ())) return -1;
+  tvector<nr_complex_t> S (VS->size ()), P (VP->size ());
+  int n = 0;
+  cp.get (n);
+  cp.get ((nr_double_t *) S.getData (), 2 * (int) S.size ());
+  cp.get ((nr_double_t *) P.getData (), 2 * (int) P.size ());
+  bool ok = cp.good ();
+  cp.close ();
+  if (!ok) return -1;
+  iterations = n;
+  *VS = S;
+  *VP = P;
+  *vs = *VS;
+  VectorIFFT (vs);
+  return 0;
+}
+
 /* The following function transforms a matrix using a Fast Fourier
    Transformation from the time domain to the frequency domain. */
 void hbsolver::MatrixFFT (tmatrix<nr_complex_t> * M) {
@@ -1144,25 +1629,53 @@ void hbsolver::MatrixFFT (tmatrix<nr_complex_t> * M) {
     M->setRow (r, V);
   }
 #else
-  int c, r, nc, nr;
-  // for each non-linear node block
-  for (nc = c = 0; c < nbanodes; c++, nc += nlfreqs) {
-    for (nr = r = 0; r < nbanodes; r++, nr += nlfreqs) {
-      tvector<nr_complex_t> V (nlfreqs);
-      int fr, fc, fi;
-      // transform the sub-diagonal only
-      for (fc = 0; fc < nlfreqs; fc++) V (fc) = M->get (nr + fc, nc + fc);
-      VectorFFT (&V);
-      // fill in resulting sub-matrix for the node
-      for (fc = 0; fc < nlfreqs; fc++) {
-	for (fi = nlfreqs - 1 - fc, fr = 0; fr < nlfreqs; fr++) {
-	  if (++fi >= nlfreqs) fi = 0;
-	  M->set (nr + fr, nc + fc, V (fi));
+  int blocks = nbanodes * nbanodes;
+  int n = std::min (threads, blocks);
+
+  // distribute the non-linear node blocks over the worker threads
+  if (n > 1) {
+    threadpool::run (n, [this, M, n] (int t) { MatrixFFTBlocks (M, t, n); });
+  }
+  else {
+    MatrixFFTBlocks (M, 0, 1);
+  }
+#endif
+}
+
+/* This function transforms every n-th non-linear node block of the
+   given matrix beginning with the given one.  The blocks are
+   transformed in place on the matrix data. */
+void hbsolver::MatrixFFTBlocks (tmatrix<nr_complex_t> * M, int first,
+				int step) {
+  int b, nr, nc, fr, fc, fi, cols = M->getCols ();
+  nr_complex_t * data = M->getData ();
+  std::vector<nr_complex_t> & V = ws->fft[first];
+
+  for (b = first; b < nbanodes * nbanodes; b += step) {
+    nc = (b / nbanodes) * nlfreqs;
+    nr = (b % nbanodes) * nlfreqs;
+    // transform the sub-diagonal only
+    for (fc = 0; fc < nlfreqs; fc++) V[fc] = data[(nr + fc) * cols + nc + fc];
+    if (almost) {
+      // the sub-matrix is APF * diag (V) * APT
+      for (fr = 0; fr < nlfreqs; fr++) {
+	for (fc = 0; fc < nlfreqs; fc++) {
+	  nr_complex_t v = 0.0;
+	  for (fi = 0; fi < nlfreqs; fi++) v += APF (fr, fi) * V[fi] * APT (fi, fc);
+	  data[(nr + fr) * cols + nc + fc] = v;
 	}
       }
+      continue;
+    }
+    NodeFFT ((nr_double_t *) &V[0]);
+    // fill in resulting sub-matrix for the node
+    for (fc = 0; fc < nlfreqs; fc++) {
+      for (fi = nlfreqs - 1 - fc, fr = 0; fr < nlfreqs; fr++) {
+	if (++fi >= nlfreqs) fi = 0;
+	data[(nr + fr) * cols + nc + fc] = V[fi];
+      }
     }
   }
-#endif
 }
 
 /* This function solves the actual HB equation in the frequency domain.
@@ -1175,6 +1688,7 @@ void hbsolver::MatrixFFT (tmatrix<nr_complex_t> * M) {
    Also the right hand side of the equation system for the new voltage
    vector is computed here. */
 void hbsolver::solveHB (void) {
+  TRACE_SCOPE ("hbsolver::solveHB");
   // for each non-linear node
   for (int r = 0; r < nbanodes * nlfreqs; ) {
     // for each frequency
@@ -1185,8 +1699,15 @@ void hbsolver::solveHB (void) {
       // part 1 of right hand side vector
       ir -= il;
       // transadmittance matrix multiplied by voltage vector
-      for (int c = 0; c < nbanodes * nlfreqs; c++) {
-	il += YV_(r, c) * VS_(c);
+      if (krylov) {
+	for (int c = 0; c < nbanodes; c++) {
+	  il += YD_(r, c) * VS_(c * nlfreqs + f);
+	}
+      }
+      else {
+	for (int c = 0; c < nbanodes * nlfreqs; c++) {
+	  il += YV_(r, c) * VS_(c);
+	}
       }
       // charge vector
       in += OM_(f) * FQ->get (r);
@@ -1231,38 +1752,53 @@ tvector<nr_complex_t> hbsolver::expandVector (tvector<nr_complex_t> V,
   int r, ff, rf, rt;
   for (r = 0; r < nodes; r++) {
     rt = r * nlfreqs;
-    rf = r * lnfreqs;
-    // copy first part of vector
-    for (ff = 0; ff < lnfreqs; ff++, rf++, rt++) {
-      res (rt) = V (rf);
-    }
-    // continue vector conjugated
-    for (rf -= 2; ff < nlfreqs; ff++, rf--, rt++) {
-      res (rt) = conj (V (rf));
+    for (ff = 0; ff < nlfreqs; ff++, rt++) {
+      if ((rf = sindex[ff]) < 0) continue;
+      // negative frequencies conjugated
+      rf += r * lnfreqs;
+      res (rt) = negfreqs[ff] < 0.0 ? conj (V (rf)) : V (rf);
     }
   }
   return res;
 }
 
-/* The function expands the given matrix in the frequency domain to
-   make it a real valued signal in the time domain. */
-tmatrix<nr_complex_t> hbsolver::expandMatrix (tmatrix<nr_complex_t> M,
-					      int nodes) {
+/* The function expands the given frequency blocks to a matrix in the
+   frequency domain in order to make it a real valued signal in the
+   time domain.  The blocks do not couple different frequencies, thus
+   only the frequency diagonals of the node blocks are filled. */
+tmatrix<nr_complex_t> hbsolver::expandMatrix (
+	std::vector< tmatrix<nr_complex_t> > & M, int nodes) {
   tmatrix<nr_complex_t> res (nodes * nlfreqs);
-  int r, c, rf, rt, cf, ct, ff;
+  int r, c, rt, ct, ff, rf;
   for (r = 0; r < nodes; r++) {
     for (c = 0; c < nodes; c++) {
-      rf = r * lnfreqs;
       rt = r * nlfreqs;
-      cf = c * lnfreqs;
       ct = c * nlfreqs;
-      // copy first part of diagonal
-      for (ff = 0; ff < lnfreqs; ff++, cf++, ct++, rf++, rt++) {
-	res (rt, ct) = M (rf, cf);
+      for (ff = 0; ff < nlfreqs; ff++, ct++, rt++) {
+	if ((rf = sindex[ff]) < 0) continue;
+	// negative frequencies conjugated
+	res (rt, ct) = negfreqs[ff] < 0.0 ? conj (M[rf] (r, c)) : M[rf] (r, c);
       }
-      // continue diagonal conjugated
-      for (cf -= 2, rf -= 2; ff < nlfreqs; ff++, cf--, ct++, rf--, rt++) {
-	res (rt, ct) = conj (M (rf, cf));
+    }
+  }
+  return res;
+}
+
+/* The function expands the frequency blocks in the same way as
+   expandMatrix() does, but keeps the frequency diagonals only.  Row
+   r * nlfreqs + f of the result holds the entries of frequency f in
+   row r of the node blocks. */
+tmatrix<nr_complex_t> hbsolver::expandDiagonals (
+	std::vector< tmatrix<nr_complex_t> > & M, int nodes) {
+  tmatrix<nr_complex_t> res (nodes * nlfreqs, nodes);
+  int r, c, rt, ff, rf;
+  for (r = 0; r < nodes; r++) {
+    for (c = 0; c < nodes; c++) {
+      rt = r * nlfreqs;
+      for (ff = 0; ff < nlfreqs; ff++, rt++) {
+	if ((rf = sindex[ff]) < 0) continue;
+	// negative frequencies conjugated
+	res (rt, c) = negfreqs[ff] < 0.0 ? conj (M[rf] (r, c)) : M[rf] (r, c);
       }
     }
   }
@@ -1277,18 +1813,16 @@ void hbsolver::solveVoltages (void) {
   *VP = *VS;
 
   // setup equation system
-  eqnsys<nr_complex_t> eqns;
-  try_running () {
-    // use LU decomposition for solving
-    eqns.setAlgo (ALGO_LU_DECOMPOSITION);
-    eqns.passEquationSys (JF, VS, RH);
-    eqns.solve ();
-  }
-  // appropriate exception handling
-  catch_exception () {
-  case EXCEPTION_PIVOT:
-  default:
+  eqnsys<nr_complex_t> & eqns = ws->eqns;
+  int mark = numstatus::mark ();
+  // use LU decomposition for solving, in single precision if requested
+  eqns.setAlgo (mixed ? ALGO_LU_DECOMPOSITION_MIXED : ALGO_LU_DECOMPOSITION);
+  eqns.passEquationSys (JF, VS, RH);
+  eqns.solve ();
+  // appropriate failure handling
+  if (numstatus::raised (mark)) {
     logprint (LOG_ERROR, "WARNING: %s: during NR iteration\n", getName ());
+    numstatus::report (mark);
     estack.print ();
   }
 
@@ -1296,99 +1830,336 @@ void hbsolver::solveVoltages (void) {
   *vs = *VS;
 }
 
-/* The following function extends the existing linear MNA matrix to
-   contain the additional rows and columns for the excitation voltage
-   sources. */
-tmatrix<nr_complex_t> hbsolver::extendMatrixLinear (tmatrix<nr_complex_t> M,
-						    int nodes) {
-  int no = M.getCols ();
-  tmatrix<nr_complex_t> res (no + nodes * lnfreqs);
-  // copy the existing part
-  for (int r = 0; r < no; r++) {
-    for (int c = 0; c < no; c++) {
-      res (r, c) = M (r, c);
+/* This function solves the equation system
+   JF * (VS(n+1) - VS(n)) = -FV
+   using the factors of the Jacobian of an earlier iteration, i.e. the
+   simplified Newton step of Samanskii's method. */
+void hbsolver::solveVoltagesChord (void) {
+  tvector<nr_complex_t> & d = ws->d, & b = ws->b;
+  int i, n = VS->size ();
+
+  // save previous iteration voltage
+  *VP = *VS;
+
+  // forward and backward substitutions only
+  for (i = 0; i < n; i++) b (i) = -FV->get (i);
+  eqnsys<nr_complex_t> & eqns = ws->eqns;
+  eqns.setAlgo (ALGO_LU_SUBSTITUTION_CROUT);
+  eqns.passEquationSys (JF, &d, &b);
+  eqns.solve ();
+  for (i = 0; i < n; i++) (*VS) (i) += d (i);
+
+  // save new voltages in time domain vector
+  *vs = *VS;
+}
+
+/* The function computes the product y = JF * x of the full Jacobian
+   and the given frequency domain vector without forming the Jacobian.
+   The non-linear parts are applied to the time domain samples of x and
+   transformed back.  The vectors g and q are used as workspace. */
+void hbsolver::applyJacobian (tvector<nr_complex_t> * x,
+			      tvector<nr_complex_t> * y,
+			      tvector<nr_complex_t> * g,
+			      tvector<nr_complex_t> * q) {
+  int r, c, f, N = nbanodes;
+
+  // voltages into time domain
+  *y = *x;
+  VectorIFFT (y);
+
+  // conductance and capacitance Jacobians for each time sample
+  for (f = 0; f < nlfreqs; f++) {
+    for (r = 0; r < N; r++) {
+      nr_complex_t ig = 0.0, iq = 0.0;
+      for (c = 0; c < N; c++) {
+	nr_complex_t v = (*y) (c * nlfreqs + f);
+	ig += (*JG) (r * nlfreqs + f, c) * v;
+	iq += (*JQ) (r * nlfreqs + f, c) * v;
+      }
+      (*g) (r * nlfreqs + f) = ig;
+      (*q) (r * nlfreqs + f) = iq;
+    }
+  }
+
+  // currents and charges into frequency domain
+  VectorFFT (g);
+  VectorFFT (q);
+
+  // add linear transadmittances --> y = [YV] * x + j[O] * q + g
+  for (r = 0; r < N; r++) {
+    for (f = 0; f < nlfreqs; f++) {
+      nr_complex_t i = (*g) (r * nlfreqs + f) +
+	OM_(f) * (*q) (r * nlfreqs + f);
+      for (c = 0; c < N; c++) {
+	i += YD_(r * nlfreqs + f, c) * (*x) (c * nlfreqs + f);
+      }
+      (*y) (r * nlfreqs + f) = i;
+    }
+  }
+}
+
+/* The function creates the preconditioner for the iterative solver.
+   Replacing the time varying Jacobians by their averages makes the
+   Jacobian block circulant, i.e. decoupled in the frequency domain.
+   For each frequency the inverse of the remaining node block is
+   saved. */
+void hbsolver::calcPreconditioner (void) {
+  int r, c, f, N = nbanodes;
+  tmatrix<nr_complex_t> & G0 = ws->G0, & Q0 = ws->Q0;
+  tmatrix<nr_complex_t> & P = ws->P, & H = ws->PH;
+
+  // averages (DC terms) of the time domain Jacobians
+  for (r = 0; r < N; r++) {
+    for (c = 0; c < N; c++) {
+      nr_complex_t g = 0.0, q = 0.0;
+      for (f = 0; f < nlfreqs; f++) {
+	nr_complex_t w = almost ? APF (0, f) : 1.0 / nlfreqs;
+	g += w * (*JG) (r * nlfreqs + f, c);
+	q += w * (*JQ) (r * nlfreqs + f, c);
+      }
+      G0 (r, c) = g;
+      Q0 (r, c) = q;
+    }
+  }
+
+  // invert node block for each frequency
+  for (f = 0; f < nlfreqs; f++) {
+    for (r = 0; r < N; r++) {
+      for (c = 0; c < N; c++) {
+	P (r, c) = YD_(r * nlfreqs + f, c) + G0 (r, c) + OM_(f) * Q0 (r, c);
+      }
+    }
+    int mark = numstatus::mark ();
+    ws->peqns.setAlgo (ALGO_LU_DECOMPOSITION_CROUT);
+    ws->peqns.passEquationSys (&P, &ws->px, &ws->pz);
+    ws->peqns.factorize ();
+    // appropriate failure handling
+    if (numstatus::raised (mark)) {
+      logprint (LOG_ERROR, "WARNING: %s: during preconditioner inversion\n",
+		getName ());
+      numstatus::report (mark);
+      estack.print ();
+    }
+    ws->peqns.solveMany (&ws->E, &H);
+    for (r = 0; r < N; r++) {
+      for (c = 0; c < N; c++) PC_(r * nlfreqs + f, c) = H (r, c);
+    }
+  }
+}
+
+/* The function applies the preconditioner to the given vector. */
+void hbsolver::applyPreconditioner (tvector<nr_complex_t> * x,
+				    tvector<nr_complex_t> * y) {
+  int r, c, f, N = nbanodes;
+  for (r = 0; r < N; r++) {
+    for (f = 0; f < nlfreqs; f++) {
+      nr_complex_t v = 0.0;
+      for (c = 0; c < N; c++) {
+	v += PC_(r * nlfreqs + f, c) * (*x) (c * nlfreqs + f);
+      }
+      (*y) (r * nlfreqs + f) = v;
     }
   }
-  return res;
+}
+
+// Euclidean norm and inner product of vectors used by GMRES.
+static nr_double_t gmres_norm (tvector<nr_complex_t> & a) {
+  nr_double_t n = 0.0;
+  for (std::size_t i = 0; i < a.size (); i++) n += norm (a (i));
+  return std::sqrt (n);
+}
+
+static nr_complex_t gmres_dot (tvector<nr_complex_t> & a,
+			       tvector<nr_complex_t> & b) {
+  nr_complex_t d = 0.0;
+  for (std::size_t i = 0; i < a.size (); i++) d += conj (a (i)) * b (i);
+  return d;
+}
+
+/* This function solves the equation system
+   JF * VS(n+1) = RH
+   using the restarted GMRES algorithm with right preconditioning.  The
+   Jacobian is never formed, the previous voltage vector is used as
+   initial guess. */
+void hbsolver::solveVoltagesKrylov (void) {
+  int n = nbanodes * nlfreqs;
+  int m = std::min (HB_GMRES_RESTART, n);
+  int i, j, k, cycle, converged = 0;
+  nr_double_t tol = getPropertyDouble ("reltol") * 1e-3;
+  nr_double_t bnorm, beta = 0.0;
+
+  // save previous iteration voltage
+  *VP = *VS;
+
+  tvector<nr_complex_t> & r = ws->r, & w = ws->w, & z = ws->z;
+  tvector<nr_complex_t> & g = ws->g, & q = ws->q;
+  std::vector< tvector<nr_complex_t> > & V = ws->V;
+  tmatrix<nr_complex_t> & H = ws->H;
+  std::vector<nr_complex_t> & sn = ws->sn, & e = ws->e, & y = ws->y;
+  std::vector<nr_double_t> & cs = ws->cs;
+
+  if ((bnorm = gmres_norm (*RH)) == 0.0) bnorm = 1.0;
+
+  for (cycle = 0; cycle < HB_GMRES_CYCLES && !converged; cycle++) {
+    // residual of the current solution
+    applyJacobian (VS, &w, &g, &q);
+    for (i = 0; i < n; i++) r (i) = (*RH) (i) - w (i);
+    if ((beta = gmres_norm (r)) <= tol * bnorm) {
+      converged = 1;
+      break;
+    }
+    for (i = 0; i < n; i++) V[0] (i) = r (i) / beta;
+    std::fill (e.begin (), e.end (), nr_complex_t (0.0));
+    e[0] = beta;
+
+    // Arnoldi process
+    for (k = 0, j = 0; j < m; j++) {
+      applyPreconditioner (&V[j], &z);
+      applyJacobian (&z, &w, &g, &q);
+      // modified Gram-Schmidt orthogonalization
+      for (i = 0; i <= j; i++) {
+	H (i, j) = gmres_dot (V[i], w);
+	for (int l = 0; l < n; l++) w (l) -= H (i, j) * V[i] (l);
+      }
+      nr_double_t h = gmres_norm (w);
+      H (j + 1, j) = h;
+      if (h != 0.0) for (i = 0; i < n; i++) V[j + 1] (i) = w (i) / h;
+
+      // apply previous Givens rotations to the new column
+      for (i = 0; i < j; i++) {
+	nr_complex_t t = cs[i] * H (i, j) + sn[i] * H (i + 1, j);
+	H (i + 1, j) = -conj (sn[i]) * H (i, j) + cs[i] * H (i + 1, j);
+	H (i, j) = t;
+      }
+      // compute new rotation eliminating the subdiagonal entry
+      nr_double_t a = abs (H (j, j));
+      if (a == 0.0) {
+	cs[j] = 0.0;
+	sn[j] = 1.0;
+      } else {
+	nr_double_t t = xhypot (a, h);
+	cs[j] = a / t;
+	sn[j] = H (j, j) / a * h / t;
+      }
+      H (j, j) = cs[j] * H (j, j) + sn[j] * h;
+      H (j + 1, j) = 0.0;
+      e[j + 1] = -conj (sn[j]) * e[j];
+      e[j] = cs[j] * e[j];
+      k = j + 1;
+
+      // residual norm of the current iterate
+      beta = abs (e[j + 1]);
+      if (beta <= tol * bnorm || h == 0.0) {
+	converged = beta <= tol * bnorm;
+	break;
+      }
+    }
+
+    // solve the upper triangular system
+    for (i = k - 1; i >= 0; i--) {
+      nr_complex_t t = e[i];
+      for (j = i + 1; j < k; j++) t -= H (i, j) * y[j];
+      y[i] = t / H (i, i);
+    }
+    // update solution --> VS += P * V * y
+    w.set (0.0);
+    for (i = 0; i < k; i++) {
+      for (j = 0; j < n; j++) w (j) += y[i] * V[i] (j);
+    }
+    applyPreconditioner (&w, &z);
+    for (i = 0; i < n; i++) (*VS) (i) += z (i);
+  }
+
+  if (!converged) {
+    logprint (LOG_ERROR, "WARNING: %s: GMRES residual %g after %d "
+	      "restarts\n", getName (), beta / bnorm, HB_GMRES_CYCLES);
+  }
+
+  // save new voltages in time domain vector
+  *vs = *VS;
 }
 
 /* The function fills in the missing MNA entries for the excitation
-   voltage sources into the extended rows and columns as well as the
-   actual voltage values into the right hand side vector. */
-void hbsolver::fillMatrixLinearExtended (tmatrix<nr_complex_t> * Y,
-					 tvector<nr_complex_t> * I) {
+   voltage sources into the extended rows and columns of the given
+   frequency's MNA matrix as well as the actual voltage values into the
+   right hand side vector. */
+void hbsolver::fillMatrixLinearExtended (tmatrix<nr_complex_t> * A,
+					 tvector<nr_complex_t> * I, int f) {
   // through each excitation source
-  int of = lnfreqs * (nlnvsrcs + nnanodes);
-  int sc = of;
+  int sc = nlnvsrcs + nnanodes;
 
   for (auto *vs : excitations) {
     // get positive and negative node
     int pnode = vs->getNode(NODE_1)->getNode ();
     int nnode = vs->getNode(NODE_2)->getNode ();
-    for (int f = 0; f < lnfreqs; f++, sc++) { // for each frequency
-      // fill right hand side vector
-      nr_double_t freq = rfreqs[f];
-      vs->calcHB (freq);
-      I_(sc) = vs->getE (VSRC_1);
-      // fill MNA entries
-      int pn = (pnode - 1) * lnfreqs + f;
-      int nn = (nnode - 1) * lnfreqs + f;
-      if (pnode) {
-	Y_(pn, sc) = +1.0;
-	Y_(sc, pn) = +1.0;
-      }
-      if (nnode) {
-	Y_(nn, sc) = -1.0;
-	Y_(sc, nn) = -1.0;
-      }
+    // fill right hand side vector
+    vs->calcHB (rfreqs[f]);
+    I_(sc) = vs->getE (VSRC_1);
+    // fill MNA entries
+    if (pnode) {
+      A_(pnode - 1, sc) = +1.0;
+      A_(sc, pnode - 1) = +1.0;
     }
+    if (nnode) {
+      A_(nnode - 1, sc) = -1.0;
+      A_(sc, nnode - 1) = -1.0;
+    }
+    sc++;
   }
 }
 
-/* The function calculates and saves the final solution. */
+/* The function calculates and saves the final solution.  The linear
+   network is solved for each frequency on its own. */
 void hbsolver::finalSolution (void) {
+  int no = nnanodes + nlnvsrcs;
+  int S = no + nnlvsrcs;
+  int N = nnanodes;
+  int r, c, n, f;
 
-  // extend the linear MNA matrix
-  *NA = extendMatrixLinear (*NA, nnlvsrcs);
-
-  int S = NA->getCols ();
-  int N = nnanodes * lnfreqs;
-
-  // right hand side vector
-  tvector<nr_complex_t> * I = new tvector<nr_complex_t> (S);
-  // temporary solution
-  tvector<nr_complex_t> * V = new tvector<nr_complex_t> (S);
   // final solution
-  x = new tvector<nr_complex_t> (N);
-
-  // fill in missing MNA entries
-  fillMatrixLinearExtended (NA, I);
+  delete x;
+  x = new tvector<nr_complex_t> (N * lnfreqs);
 
-  // put currents through balanced nodes into right hand side
-  for (int n = 0; n < nbanodes; n++) {
-    for (int f = 0; f < lnfreqs; f++) {
-      nr_complex_t i = IL->get (n * nlfreqs + f);
-      if (f != 0 && f != lnfreqs - 1) i *= 2;
-      I_(n * lnfreqs + f) = i;
+  for (f = 0; f < lnfreqs; f++) {
+    // extend the linear MNA matrix by the excitation voltage sources
+    tmatrix<nr_complex_t> * A = new tmatrix<nr_complex_t> (S);
+    for (r = 0; r < no; r++) {
+      for (c = 0; c < no; c++) A_(r, c) = NB[f] (r, c);
+    }
+    // right hand side vector
+    tvector<nr_complex_t> * I = new tvector<nr_complex_t> (S);
+    // temporary solution
+    tvector<nr_complex_t> * V = new tvector<nr_complex_t> (S);
+
+    // fill in missing MNA entries
+    fillMatrixLinearExtended (A, I, f);
+
+    // put currents through balanced nodes into right hand side
+    for (n = 0; n < nbanodes; n++) {
+      nr_complex_t i = IL->get (n * nlfreqs + rindex[f]);
+      if (rpair[f]) i *= 2;
+      I_(n) = i;
     }
-  }
 
-  // use QR decomposition for the final solution
-  try_running () {
+    // use LU decomposition for the final solution
+    int mark = numstatus::mark ();
     eqnsys<nr_complex_t> eqns;
     eqns.setAlgo (ALGO_LU_DECOMPOSITION);
-    eqns.passEquationSys (NA, V, I);
+    eqns.passEquationSys (A, V, I);
     eqns.solve ();
+    // appropriate failure handling
+    if (numstatus::raised (mark)) {
+      logprint (LOG_ERROR, "WARNING: %s: during final AC analysis\n",
+		getName ());
+      numstatus::report (mark);
+      estack.print ();
+    }
+    for (n = 0; n < N; n++) x->set (n * lnfreqs + f, V_(n));
+
+    delete A;
+    delete I;
+    delete V;
   }
-  // appropriate exception handling
-  catch_exception () {
-  case EXCEPTION_PIVOT:
-  default:
-    logprint (LOG_ERROR, "WARNING: %s: during final AC analysis\n",
-	      getName ());
-    estack.print ();
-  }
-  for (int i = 0; i < N; i++) x->set (i, V_(i));
 }
 
 // Saves simulation results.
@@ -1425,6 +2196,14 @@ PROP_OPT [] = {
   { "vabstol", PROP_REAL, { 1e-6, PROP_NO_STR }, PROP_RNG_X01I },
   { "reltol", PROP_REAL, { 1e-3, PROP_NO_STR }, PROP_RNG_X01I },
   { "MaxIter", PROP_INT, { 150, PROP_NO_STR }, PROP_RNGII (2, 10000) },
+  { "Threads", PROP_INT, { 1, PROP_NO_STR }, PROP_RNGII (0, 256) },
+  { "Solver", PROP_STR, { PROP_NO_VAL, "LU" }, PROP_RNG_STR3 ("LU", "GMRES", "MixedLU") },
+  { "Truncation", PROP_STR, { PROP_NO_VAL, "box" },
+    PROP_RNG_STR3 ("box", "diamond", "user") },
+  { "MaxOrder", PROP_INT, { 0, PROP_NO_STR }, PROP_RNGII (0, 1000) },
+  { "JacobianSteps", PROP_INT, { 1, PROP_NO_STR }, PROP_RNGII (1, 100) },
+  { "Products", PROP_LIST, { 0, PROP_NO_STR }, PROP_NO_RANGE },
+  { "MemoryLimit", PROP_REAL, { 0, PROP_NO_STR }, PROP_POS_RANGE },
   PROP_NO_PROP };
 struct define_t hbsolver::anadef =
   { "HB", 0, PROP_ACTION, PROP_NO_SUBSTRATE, PROP_LINEAR, PROP_DEF };
@@ -29,12 +29,50 @@
 
 #include "ptrlist.h"
 #include "tvector.h"
+#include "tmatrix.h"
+#include "eqnsys.h"
+#include "hbstamps.h"
 
 namespace qucs {
 
 class vector;
 class strlist;
 class circuit;
+class checkpoint;
+
+/* The workspace of the HB iterations.  Its buffers are allocated at
+   their final size before the iterations start and are reused in
+   place by each Newton step. */
+class hbworkspace
+{
+ public:
+  hbworkspace (int, int, int, bool, bool);
+  void account (tvector<nr_complex_t> *);
+  void account (tmatrix<nr_complex_t> *);
+  int getBuffers (void) { return buffers; }
+  std::size_t getBytes (void) { return bytes; }
+
+  // direct Newton steps
+  eqnsys<nr_complex_t> eqns;
+  std::vector< std::vector<nr_complex_t> > fft; // a node block per thread
+  tvector<nr_complex_t> d, b; // simplified Newton steps
+
+  // GMRES vectors, basis and Hessenberg matrix
+  tvector<nr_complex_t> r, w, z, g, q;
+  std::vector< tvector<nr_complex_t> > V;
+  tmatrix<nr_complex_t> H;
+  std::vector<nr_complex_t> sn, e, y;
+  std::vector<nr_double_t> cs;
+
+  // preconditioner blocks and their inversion
+  eqnsys<nr_complex_t> peqns;
+  tmatrix<nr_complex_t> G0, Q0, P, PH, E;
+  tvector<nr_complex_t> px, pz;
+
+ private:
+  int buffers;
+  std::size_t bytes;
+};
 
 class hbsolver : public analysis
 {
@@ -44,47 +82,68 @@ class hbsolver : public analysis
   hbsolver (hbsolver &);
   ~hbsolver ();
   int  solve (void);
+  void resetSweep (void);
   void initHB (void);
   void initDC (void);
   static void calc (hbsolver *);
   void collectFrequencies (void);
+  void selectSolver (void);
   int  checkBalance (void);
 
   void splitCircuits (void);
   void expandFrequencies (nr_double_t, int);
+  void truncateFrequencies (int);
+  void almostPeriodic (void);
   bool isExcitation (circuit *);
   strlist * circuitNodes (ptrlist<circuit>);
   void getNodeLists (void);
   int  assignVoltageSources (ptrlist<circuit>);
   int  assignNodes (ptrlist<circuit>, strlist *, int offset = 0);
+  bool linearChanged (void);
   void prepareLinear (void);
   void createMatrixLinearA (void);
-  void fillMatrixLinearA (tmatrix<nr_complex_t> *, int);
+  void fillMatrixLinearA (tmatrix<nr_complex_t> *);
   void invertMatrix (tmatrix<nr_complex_t> *, tmatrix<nr_complex_t> *);
   void createMatrixLinearY (void);
+  void calcMatrixLinearY (int, int);
   void saveResults (void);
   void calcConstantCurrent (void);
-  nr_complex_t excitationZ (tvector<nr_complex_t> *, circuit *, int);
+  nr_complex_t excitationZ (tmatrix<nr_complex_t> *, circuit *, int);
   void finalSolution (void);
   void fillMatrixNonLinear (tmatrix<nr_complex_t> *, tmatrix<nr_complex_t> *,
 			    tvector<nr_complex_t> *, tvector<nr_complex_t> *,
 			    tvector<nr_complex_t> *, tvector<nr_complex_t> *,
 			    int);
   void prepareNonLinear (void);
+  void releaseNonLinear (void);
   void solveHB (void);
   void loadMatrices (void);
   void VectorFFT (tvector<nr_complex_t> *, int isign = 1);
   void VectorIFFT (tvector<nr_complex_t> *, int isign = 1);
-  int  calcOrder (int);
   void MatrixFFT (tmatrix<nr_complex_t> *);
+  void MatrixFFTBlocks (tmatrix<nr_complex_t> *, int, int);
+  void reportWorkspace (void);
+  void NodeFFT (nr_double_t *, int isign = 1);
   void calcJacobian (void);
   void solveVoltages (void);
+  void solveVoltagesChord (void);
   tvector<nr_complex_t> expandVector (tvector<nr_complex_t>, int);
-  tmatrix<nr_complex_t> expandMatrix (tmatrix<nr_complex_t>, int);
-  tmatrix<nr_complex_t> extendMatrixLinear (tmatrix<nr_complex_t>, int);
+  tmatrix<nr_complex_t> expandMatrix (std::vector< tmatrix<nr_complex_t> > &,
+				      int);
+  tmatrix<nr_complex_t> expandDiagonals (std::vector< tmatrix<nr_complex_t> > &,
+					 int);
+  void applyJacobian (tvector<nr_complex_t> *, tvector<nr_complex_t> *,
+		      tvector<nr_complex_t> *, tvector<nr_complex_t> *);
+  void calcPreconditioner (void);
+  void applyPreconditioner (tvector<nr_complex_t> *, tvector<nr_complex_t> *);
+  void solveVoltagesKrylov (void);
   void fillMatrixLinearExtended (tmatrix<nr_complex_t> *,
-				 tvector<nr_complex_t> *);
-  void saveNodeVoltages (circuit *, int);
+				 tvector<nr_complex_t> *, int);
+  void saveNodeVoltages (circuit *, hbstamps &);
+  void calcNonLinear (int, int);
+  std::string checkpointKey (void);
+  int saveCheckpoint (checkpoint &, int);
+  int loadCheckpoint (checkpoint &, int &);
 
  private:
   std::vector<nr_double_t> negfreqs;    // full frequency set
@@ -92,18 +151,30 @@ class hbsolver : public analysis
   std::vector<nr_double_t> rfreqs;      // real positive frequency set
   int * ndfreqs;                    // number of frequencies for each dimension
   std::vector<nr_double_t> dfreqs;      // base frequencies for each dimension
+  std::vector<int> sindex;   // real frequency of each spectrum entry
+  std::vector<int> rindex;   // spectrum entry of each real frequency
+  std::vector<bool> rpair;   // real frequency has a conjugate entry
+  bool almost;               // almost periodic transform of truncated sets
+  tmatrix<nr_complex_t> APT; // spectrum into time samples
+  tmatrix<nr_complex_t> APF; // time samples into spectrum
+  std::vector<nr_double_t> apfreqs; // frequencies of the transform
+  std::vector<nr_double_t> linsig;  // signature of the linear part
   nr_double_t frequency;
   strlist * nlnodes, * lnnodes, * banodes, * nanodes, * exnodes;
   ptrlist<circuit> excitations;
   ptrlist<circuit> nolcircuits;
+  std::vector<circuit *> nlcircuits; // non-linear circuits by index
+  std::vector<hbstamps> nlstamps;    // their stamps at all time samples
   ptrlist<circuit> lincircuits;
 
-  tmatrix<nr_complex_t> * Y;  // transadmittance matrix of linear network
-  tmatrix<nr_complex_t> * A;  // MNA-matrix of linear network
-  tmatrix<nr_complex_t> * Z;  // transimpedance matrix of linear network
+  // MNA-matrices and transadmittance matrices of linear network, one
+  // for each frequency
+  std::vector< tmatrix<nr_complex_t> > NB;
+  std::vector< tmatrix<nr_complex_t> > YB;
 
   tmatrix<nr_complex_t> * YV; // linear transadmittance matrix
-  tmatrix<nr_complex_t> * NA; // MNA-matrix of complete network
+  tmatrix<nr_complex_t> * YD; // its frequency diagonals (GMRES only)
+  tmatrix<nr_complex_t> * PC; // preconditioner blocks (GMRES only)
 
   tmatrix<nr_complex_t> * JQ; // C-Jacobian in t and f
   tmatrix<nr_complex_t> * JG; // G-Jacobian in t and f
@@ -126,7 +197,12 @@ class hbsolver : public analysis
   tvector<nr_complex_t> * x;
   tvector<nr_complex_t> * vs;
 
+  hbworkspace * ws;           // buffers of the iterations
+
   int runs;
+  int threads;
+  bool krylov;
+  bool mixed;
   int lnfreqs;
   int nlfreqs;
   int nnlvsrcs;
@@ -0,0 +1,80 @@
+/*
+ * hbstamps.h - batched HB stamps definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+
+#ifndef __HBSTAMPS_H__
+#define __HBSTAMPS_H__
+
+#include <vector>
+
+namespace qucs {
+
+/*! \class hbstamps
+ * \brief stamps of a non-linear circuit at all the HB time samples.
+ *
+ * The harmonic balance passes the node voltages of all the time
+ * samples to a non-linear circuit at once and gets back its currents,
+ * charges and their derivatives at all the samples.  The arrays are
+ * sample-major, the entries of one sample are contiguous, then the
+ * samples follow each other.  A circuit evaluating its model for all
+ * the samples in one loop saves the per-sample calls and the round
+ * trips through its MNA stamps.
+ */
+class hbstamps
+{
+ public:
+  hbstamps () : size (0), samples (0) { }
+
+  /* Sets the number of nodes and time samples, the contents are
+     undefined afterwards. */
+  void resize (int s, int n) {
+    if (s == size && n == samples) return;
+    size = s;
+    samples = n;
+    V.assign (s * n, 0); I.assign (s * n, 0); Q.assign (s * n, 0);
+    GV.assign (s * n, 0); CV.assign (s * n, 0);
+    Y.assign (s * s * n, 0); QV.assign (s * s * n, 0);
+  }
+  int getSize (void) const { return size; }
+  int getSamples (void) const { return samples; }
+
+  // node voltages of the given sample
+  nr_double_t * v (int f) { return &V[f * size]; }
+  // currents and charges into the nodes, the G*V and C*V products
+  nr_double_t * i (int f) { return &I[f * size]; }
+  nr_double_t * q (int f) { return &Q[f * size]; }
+  nr_double_t * gv (int f) { return &GV[f * size]; }
+  nr_double_t * cv (int f) { return &CV[f * size]; }
+  // conductance (dI/dV) and capacitance (dQ/dV) matrices, row-major
+  nr_double_t * y (int f) { return &Y[f * size * size]; }
+  nr_double_t * qv (int f) { return &QV[f * size * size]; }
+
+ private:
+  int size, samples;
+  std::vector<nr_double_t> V, I, Q, GV, CV, Y, QV;
+};
+
+} // namespace qucs
+
+#endif /* __HBSTAMPS_H__ */
@@ -44,41 +44,46 @@ namespace qucs {
    than the specified time. */
 void history::truncate (const nr_double_t tcut)
 {
-    std::size_t i;
-    std::size_t ts = this->t->size ();
+  // find first time value newer than the given time
+  std::size_t i, ts = this->t->size ();
+  std::size_t l = this->leftidx (), r = ts;
+  while (l < r) {
+    i = (l + r) / 2;
+    if ((*this->t)[i] > tcut) r = i;
+    else l = i + 1;
+  }
+  std::size_t cut = this->t->offset () + l;
 
-    for (i = this->leftidx (); i < ts; i++)
-    {
-      if ( (*this->t)[i] > tcut)
-      {
-	break;
-      }
-    }
-    this->resize (ts - i);
+  // drop the values and times behind that position
+  std::size_t ve = this->values->offset () + this->values->size ();
+  if (ve > cut) this->values->pop_back (ve - cut);
+  std::size_t te = this->t->offset () + ts;
+  if (te > cut) this->t->pop_back (te - cut);
 }
 
-
 /* This function drops those values in the history which are older
    than the specified age of the history instance. */
 void history::drop (void) {
-  if(this->values->empty())
+  if (this->values->empty() || this->t->empty())
     return;
   nr_double_t f = this->first ();
   nr_double_t l = this->last ();
   if (age > 0.0 && l - f > age) {
-    std::size_t r;
-    std::size_t i = this->leftidx ();
-    for (r = 0; i < this->t->size (); r++, i++)
-      if (l - (*this->t)[i] < age)
-	break;
+    // find first time value within the age
+    std::size_t i, lo = this->leftidx (), hi = this->t->size ();
+    while (lo < hi) {
+      i = (lo + hi) / 2;
+      if (l - (*this->t)[i] < age) hi = i;
+      else lo = i + 1;
+    }
     // keep 2 values being older than specified age
-    r += this->unused ();
-    if (r >= 2)
-      r -= 2;
-    r = std::min(r,this->values->size()-1);
-    if (r > 127)
-      /* erase the first r value */
-      this->values->erase(this->values->begin(),this->values->begin()+r);
+    lo = lo >= 2 ? lo - 2 : 0;
+    std::size_t keep = this->t->offset () + lo;
+    std::size_t vo = this->values->offset ();
+    if (keep > vo) {
+      std::size_t r = std::min (keep - vo, this->values->size () - 1);
+      this->values->pop_front (r);
+    }
   }
 }
 
@@ -89,25 +94,28 @@ nr_double_t history::interpol (nr_double_t tval, int idx, bool left) {
   static tvector<nr_double_t> x (4);
   static tvector<nr_double_t> y (4);
 
-  unsigned int n = left ? idx + 1: idx;
-  if (n > 1 && n + 2 < this->values->size ()) {
-    int i, k, l = this->leftidx ();
+  int n = left ? idx + 1: idx;
+  int l = this->leftidx ();
+  int v = validx (l);
+  if (n > 1 && l + n + 2 < (int) this->t->size () &&
+      v + n + 2 < (int) this->values->size ()) {
+    int i, k;
     for (k = 0, i = n - 2; k < 4; i++, k++) {
       x (k) = (*this->t)[i + l];
-      y (k) = (*this->values)[i];
+      y (k) = (*this->values)[i + v];
     }
     spl.vectors (y, x);
     spl.construct ();
     return spl.evaluate (tval).f0;
   }
-  return (*this->values)[idx];
+  return (*this->values)[idx + v];
 }
 
 /* The function returns the value nearest to the given time value.  If
    the otional parameter is true then additionally cubic spline
    interpolation is used. */
 nr_double_t history::nearest (nr_double_t tval, bool interpolate) {
-  if (t->empty())
+  if (t->empty() || values->empty())
     return 0.0;
 
   int l = this->leftidx ();
@@ -119,7 +127,7 @@ nr_double_t history::nearest (nr_double_t tval, bool interpolate) {
   i = i - l;
   if (interpolate)
     return interpol (tval, i, sign);
-  return (*this->values)[i];
+  return (*this->values)[validx (i + l)];
 }
 
 /* The function is utilized in order to find the nearest value to a
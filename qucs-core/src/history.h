@@ -25,58 +25,147 @@
 #ifndef __HISTORY_H__
 #define __HISTORY_H__
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <utility>
 
 namespace qucs {
 
+/*! The ringbuffer class is a growable circular buffer.  Dropping
+    values at either end is O(1) and appending values never
+    reallocates unless the number of stored values exceeds the
+    capacity.  Each value has an absolute index which stays valid
+    while the value remains in the buffer. */
+template <class nr_type_t>
+class ringbuffer
+{
+public:
+  ringbuffer (std::size_t n = 16) : head (0), count (0), origin (0) {
+    data.resize (roundup (n));
+  }
+
+  //! Enlarges the capacity to hold at least n values.
+  void reserve (const std::size_t n) {
+    if (n > data.size ()) grow (n);
+  }
+
+  void push_back (const nr_type_t val) {
+    if (count == data.size ()) grow (2 * count);
+    data[(head + count) & (data.size () - 1)] = val;
+    count++;
+  }
+
+  //! Drops the n oldest values.
+  void pop_front (std::size_t n) {
+    n = std::min (n, count);
+    head = (head + n) & (data.size () - 1);
+    count -= n;
+    origin += n;
+  }
+
+  //! Drops the n most recent values.
+  void pop_back (const std::size_t n) {
+    count -= std::min (n, count);
+  }
+
+  std::size_t size (void) const { return count; }
+  std::size_t capacity (void) const { return data.size (); }
+  bool empty (void) const { return count == 0; }
+
+  nr_type_t & operator[] (const std::size_t i) {
+    return data[(head + i) & (data.size () - 1)];
+  }
+  nr_type_t operator[] (const std::size_t i) const {
+    return data[(head + i) & (data.size () - 1)];
+  }
+  nr_type_t back (void) const { return (*this)[count - 1]; }
+
+  //! Returns the absolute index of the oldest value.
+  std::size_t offset (void) const { return origin; }
+
+  //! Renumbers the values such that the next one gets the given index.
+  void rebase (const std::size_t end) { origin = end - count; }
+
+private:
+  static std::size_t roundup (std::size_t n) {
+    std::size_t c = 1;
+    while (c < n) c <<= 1;
+    return c;
+  }
+
+  void grow (const std::size_t n) {
+    std::vector<nr_type_t> d (roundup (n));
+    for (std::size_t i = 0; i < count; i++) d[i] = (*this)[i];
+    data.swap (d);
+    head = 0;
+  }
+
+  std::vector<nr_type_t> data;
+  std::size_t head;
+  std::size_t count;
+  std::size_t origin;
+};
+
+/*! The history class stores values of a circuit for past time steps.
+    The time values are shared among the histories of all circuits.
+    The value and time buffers are aligned by their absolute indices,
+    i.e. the n-th value ever appended belongs to the n-th time
+    value. */
 class history
 {
 public:
+  typedef ringbuffer<nr_double_t> buffer;
+
   /*! default constructor */
   history ():
     sign(false),
     age(0),
-    values(std::make_shared<std::vector<nr_double_t>>()),
-    t(std::make_shared<std::vector<nr_double_t>>()) 
+    values(std::make_shared<buffer>()),
+    t(std::make_shared<buffer>())
   {};
-  
+
   /*! The copy constructor creates a new instance based on the given
       history object. */
   history (const history &h)
   {
+      this->sign = h.sign;
       this->age = h.age;
-      this->t = std::make_shared<std::vector<nr_double_t>>(*(h.t));
-      this->values = std::make_shared<std::vector<nr_double_t>>(*(h.values));
+      this->t = std::make_shared<buffer>(*(h.t));
+      if (h.values == h.t)
+	this->values = this->t;
+      else
+	this->values = std::make_shared<buffer>(*(h.values));
   }
 
   /*! The function appends the given value to the history. */
   void push_back (const nr_double_t val) {
     this->values->push_back(val);
-    if (this->values != this->t) 
+    if (this->values != this->t)
       this->drop ();
   }
 
   /* This function drops the most recent n values in the history. */
   void truncate (const std::size_t n) = delete;
-  void resize(const std::size_t n)
-  {
-    this->t->resize (n);
-    this->values->resize (n);
-  }
 
   std::size_t size (void) const
   {
     return t->size ();
   }
 
+  //! Enlarges the history to hold at least n values without reallocation.
+  void reserve (const std::size_t n) { this->values->reserve (n); }
+
   void setAge (const nr_double_t a) { this->age = a; }
   nr_double_t getAge (void) const { return this->age; }
 
-  // apply history
+  /* Applies the time values of the given history.  The next value
+     appended belongs to its most recent time value. */
   void apply (const history & h) {
     this->t = h.t;
+    this->values->reserve (this->t->capacity ());
+    this->values->rebase (this->t->empty () ? 0 :
+			  this->t->offset () + this->t->size () - 1);
   }
 
   //! Returns the last (youngest) time value in the history
@@ -91,26 +180,26 @@ public:
 
   // Returns left-most valid index into the time value vector.
   unsigned int leftidx (void) const {
-    int ts = this->t->size ();
-    int vs = this->values->size ();
-    return ts - vs > 0 ? ts - vs : 0;
+    std::size_t to = this->t->offset ();
+    std::size_t vo = this->values->offset ();
+    return vo > to ? vo - to : 0;
   }
 
-  /*! Returns number of unused values (time value vector shorter than
-   value vector). */
+  /*! Returns number of unused values (values older than the oldest
+      time value). */
   std::size_t unused (void) {
-    int ts = t->size ();
-    int vs = values->size ();
-    return vs - ts > 0 ? vs - ts : 0;
+    std::size_t to = this->t->offset ();
+    std::size_t vo = this->values->offset ();
+    return to > vo ? std::min (to - vo, this->values->size ()) : 0;
   }
-  
+
   //! Returns the duration of the history.
   nr_double_t duration(void) const {
      return last () - first ();
   }
-  
+
   void truncate (const nr_double_t);
-  
+
   void drop (void);
   void self (void) { this->t = this->values; }
 
@@ -122,14 +211,19 @@ public:
     return this->t == NULL ? 0.0 : (*this->t)[idx];
   }
   nr_double_t getValfromidx (const int idx) {
-    return this->values == NULL ? 0.0 : (*this->values)[idx];
+    return this->values == NULL ? 0.0 : (*this->values)[validx (idx)];
   }
 
  private:
+  // Converts an index into the time values into an index into the values.
+  std::size_t validx (const int idx) const {
+    return this->t->offset () + idx - this->values->offset ();
+  }
+
   bool sign;
   nr_double_t age;
-  std::shared_ptr<std::vector<nr_double_t>> values;
-  std::shared_ptr<std::vector<nr_double_t>> t;
+  std::shared_ptr<buffer> values;
+  std::shared_ptr<buffer> t;
 };
 
 } // namespace qucs
@@ -40,10 +40,17 @@
 #include "property.h"
 #include "environment.h"
 #include "nodeset.h"
+#include "analysis.h"
+#include "optimizer.h"
+#include "parasweep.h"
+#include "mcsolver.h"
 #include "input.h"
 #include "check_netlist.h"
 #include "equation.h"
 #include "module.h"
+#include "profile.h"
+#include "resultcache.h"
+#include "eco.h"
 
 namespace qucs {
 
@@ -88,15 +95,28 @@ int input::netlist (net * netlist) {
 
   logprint (LOG_STATUS, "parsing netlist...\n");
 
-  if (netlist_parse () != 0)
-    return -1;
+  {
+    profile::phase p (PROFILE_PARSE);
+    if (netlist_parse () != 0)
+      return -1;
+  }
+
+  // remember the canonical netlist before the checker expands it
+  if (resultcache::enabled ()) resultcache::netlist (definition_root);
+  if (eco::enabled ()) eco::netlist (definition_root);
 
   logprint (LOG_STATUS, "checking netlist...\n");
-  if (netlist_checker (env) != 0)
-    return -1;
+  {
+    profile::phase p (PROFILE_CHECK);
+    if (netlist_checker (env) != 0)
+      return -1;
 
-  if (netlist_checker_variables (env) != 0)
-    return -1;
+    if (netlist_checker_variables (env) != 0)
+      return -1;
+  }
+
+  // compare the checked netlist with the one of the previous run
+  if (eco::enabled ()) eco::load ();
 
 #if DEBUG
   netlist_list ();
@@ -104,7 +124,10 @@ int input::netlist (net * netlist) {
   netlist_status ();
 
   logprint (LOG_STATUS, "creating netlist...\n");
-  factory ();
+  {
+    profile::phase p (PROFILE_SETUP);
+    factory ();
+  }
 
   netlist_destroy ();
   return 0;
@@ -118,11 +141,21 @@ qucs::vector * input::createVector (struct value_t * values) {
   return v;
 }
 
+/* Removes a definition consumed by the factory from the list of input
+   definitions.  Given its predecessor this takes constant time. */
+static void consume (struct definition_t * prev, struct definition_t * def) {
+  if (prev != NULL)
+    netlist_unchain_definition (prev, def);
+  else
+    definition_root = netlist_unchain_definition (definition_root, def);
+}
+
 /* This function builds up the netlist representation from the checked
-   netlist input.  It creates circuit components as necessary. */
+   netlist input.  It creates circuit components as necessary.  Each
+   definition is released as soon as it has been consumed. */
 void input::factory (void) {
 
-  struct definition_t * def, * next;
+  struct definition_t * def, * next, * prev;
   struct node_t * nodes;
   struct pair_t * pairs;
   circuit * c;
@@ -133,7 +166,7 @@ void input::factory (void) {
   int i;
 
   // go through the list of input definitions
-  for (def = definition_root; def != NULL; def = next) {
+  for (prev = NULL, def = definition_root; def != NULL; def = next) {
     next = def->next;
     // handle actions
     if (def->action) {
@@ -177,12 +210,13 @@ void input::factory (void) {
 	subnet->insertAnalysis (a);
       }
       // remove this definition from the list
-      definition_root = netlist_unchain_definition (definition_root, def);
+      consume (prev, def);
     }
+    else prev = def;
   }
 
   // go through the list of input definitions
-  for (def = definition_root; def != NULL; def = next) {
+  for (prev = NULL, def = definition_root; def != NULL; def = next) {
     next = def->next;
     // handle substrate definitions
     if (!def->action && def->substrate) {
@@ -216,7 +250,7 @@ void input::factory (void) {
 	def->env->addVariable (v);
       }
       // remove this definition from the list
-      definition_root = netlist_unchain_definition (definition_root, def);
+      consume (prev, def);
     }
     // handle nodeset definitions
     else if (!def->action && def->nodeset) {
@@ -225,12 +259,45 @@ void input::factory (void) {
       n->setValue (def->pairs->value->value);
       subnet->addNodeset (n);
       // remove this definition from the list
-      definition_root = netlist_unchain_definition (definition_root, def);
+      consume (prev, def);
+    }
+    // handle optimization variables and goals and statistical variables
+    else if (!def->action && (!strcmp (def->type, "OptVar") ||
+			      !strcmp (def->type, "OptGoal") ||
+			      !strcmp (def->type, "MCVar"))) {
+      o = new object (def->instance);
+      for (pairs = def->pairs; pairs != NULL; pairs = pairs->next)
+	if (pairs->value->ident)
+	  o->addProperty (pairs->key, pairs->value->ident);
+	else
+	  o->addProperty (pairs->key, pairs->value->value);
+      assignDefaultProperties (o, def->define);
+
+      // pass them to the referred optimization or Monte-Carlo analysis
+      mcsolver * mc = NULL;
+      optimizer * opt = NULL;
+      if (!strcmp (def->type, "MCVar"))
+	mc = dynamic_cast<mcsolver *>
+	  (subnet->findAnalysis (o->getPropertyString ("MC")));
+      else
+	opt = dynamic_cast<optimizer *>
+	  (subnet->findAnalysis (o->getPropertyString ("Opt")));
+      if (mc != NULL)
+	mc->addVariable (o);
+      else if (opt == NULL)
+	delete o;
+      else if (!strcmp (def->type, "OptVar"))
+	opt->addVariable (o);
+      else
+	opt->addGoal (o);
+      // remove this definition from the list
+      consume (prev, def);
     }
+    else prev = def;
   }
 
   // go through the list of input definitions
-  for (def = definition_root; def != NULL; def = next) {
+  for (prev = NULL, def = definition_root; def != NULL; def = next) {
     next = def->next;
     // handle component definitions
     if (!def->action && !def->substrate && !def->nodeset) {
@@ -296,8 +363,9 @@ void input::factory (void) {
       subnet->insertCircuit (c);
 
       // remove this definition from the list
-      definition_root = netlist_unchain_definition (definition_root, def);
+      consume (prev, def);
     }
+    else prev = def;
   }
 }
 
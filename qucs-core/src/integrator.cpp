@@ -44,8 +44,8 @@ integrator::integrator () : states<nr_double_t> () {
   coefficients = NULL;
   order = 0;
   state = 0;
-  integrate_func = NULL;
-  conductor_func = NULL;
+  method = INTEGRATOR_UNKNOWN;
+  kernel = -1;
 }
 
 /* The copy constructor creates a new instance based on the given
@@ -54,27 +54,36 @@ integrator::integrator (const integrator & c) : states<nr_double_t> (c) {
   coefficients = c.coefficients;
   order = c.order;
   state = c.state;
-  integrate_func = c.integrate_func;
-  conductor_func = c.conductor_func;
+  method = c.method;
+  kernel = c.kernel;
 }
 
 // Destructor deletes a integrator object.
 integrator::~integrator () {
 }
 
-/* The function evaluates the state of the integration-using component
-   and runs the appropriate integrator function. */
-void integrator::integrate (int qstate, nr_double_t cap, nr_double_t& geq,
-			    nr_double_t& ceq) {
-  int cstate = qstate + 1;
-  if (state & MODE_INIT) fillState (qstate, getState (qstate));
-  (*integrate_func) (this, qstate, cap, geq, ceq);
-  if (state & MODE_INIT) fillState (cstate, getState (cstate));
-}
-
-/* This function runs the appropriate conductor function. */
-void integrator::conductor (nr_double_t cap, nr_double_t& geq) {
-  (*conductor_func) (this, cap, geq);
+/* Selects the integration kernel for the current method and order.
+   Euler and trapezoidal integration do not depend on the order, the
+   other methods are limited to the orders 1 to 6. */
+void integrator::selectKernel (void) {
+  switch (method) {
+  case INTEGRATOR_EULER:
+    kernel = INTEGRATOR_KERNEL (method, 1);
+    break;
+  case INTEGRATOR_TRAPEZOIDAL:
+    kernel = INTEGRATOR_KERNEL (method, 2);
+    break;
+  case INTEGRATOR_GEAR:
+  case INTEGRATOR_ADAMSMOULTON:
+    if (order >= 1 && order <= 6)
+      kernel = INTEGRATOR_KERNEL (method, order);
+    else
+      kernel = -1;
+    break;
+  default:
+    kernel = -1;
+    break;
+  }
 }
 
 } // namespace qucs
@@ -26,10 +26,14 @@
 #define __INTEGRATOR_H__
 
 #include "states.h"
+#include "transient.h"
 
 #define MODE_NONE 0
 #define MODE_INIT 1
 
+// Defines where the equivalent admittance coefficient is going to be stored.
+#define COEFF_G 0
+
 namespace qucs {
 
 class integrator : public states<nr_double_t>
@@ -41,29 +45,98 @@ class integrator : public states<nr_double_t>
   ~integrator ();
 
   // integration specific
-  typedef void (* integrate_func_t)
-    (integrator *, int, nr_double_t, nr_double_t&, nr_double_t&);
-  void setIntegration (integrate_func_t f) { integrate_func = f; }
-  typedef void (* conductor_func_t)
-    (integrator *, nr_double_t, nr_double_t&);
-  void setConductance (conductor_func_t f) { conductor_func = f; }
-  void integrate (int, nr_double_t, nr_double_t&, nr_double_t&);
-  void conductor (nr_double_t, nr_double_t&);
-  void setOrder (int o) { order = o; }
+  void setIntegration (int m) { method = m; selectKernel (); }
+  int  getIntegration (void) { return method; }
+  inline void integrate (int, nr_double_t, nr_double_t&, nr_double_t&);
+  void conductor (nr_double_t cap, nr_double_t& geq) {
+    geq = cap * coefficients[COEFF_G];
+  }
+  void setOrder (int o) { order = o; selectKernel (); }
   int  getOrder (void) { return order; }
   void setMode (int s) { state = s; }
   int  getMode (void) { return state; }
   void setCoefficients (nr_double_t * c) { coefficients = c; }
   nr_double_t * getCoefficients (void) { return coefficients; }
 
+ private:
+  void selectKernel (void);
+  template <int method_t, int order_t>
+    inline void integrateKernel (int, nr_double_t, nr_double_t&, nr_double_t&);
+
  private:
   int order;
   int state;
+  int method;
+  int kernel;
   nr_double_t * coefficients;
-  integrate_func_t integrate_func;
-  conductor_func_t conductor_func;
 };
 
+/* The integration kernels.  The method and the order are constants
+   here, the loops over the history are unrolled.  The kernel is
+   selected when the method or the order change, once per time step at
+   most, instead of being looked up for every charge state. */
+template <int method_t, int order_t>
+inline void integrator::integrateKernel (int qstate, nr_double_t cap,
+					 nr_double_t& geq, nr_double_t& ceq) {
+  nr_double_t * coeff = coefficients;
+  int cstate = qstate + 1;
+  geq = cap * coeff[COEFF_G];
+  switch (method_t) {
+  case INTEGRATOR_EULER:
+    ceq = getState (qstate, 1) * coeff[1];
+    break;
+  case INTEGRATOR_TRAPEZOIDAL:
+    ceq = getState (qstate, 1) * coeff[1] - getState (cstate, 1);
+    break;
+  case INTEGRATOR_GEAR:
+    ceq = 0;
+    for (int i = 1; i <= order_t; i++)
+      ceq += getState (qstate, i) * coeff[i];
+    break;
+  case INTEGRATOR_ADAMSMOULTON:
+    ceq = getState (qstate, 1) * coeff[1];
+    for (int i = 2; i <= order_t; i++)
+      ceq += getState (cstate, i - 1) * coeff[i];
+    break;
+  }
+  setState (cstate, getState (qstate) * coeff[COEFF_G] + ceq);
+}
+
+// Kernel identifiers made of the integration method and order.
+#define INTEGRATOR_KERNEL(m,o) ((m) * 8 + (o))
+
+/* The function evaluates the state of the integration-using component
+   and runs the selected integration kernel. */
+inline void integrator::integrate (int qstate, nr_double_t cap,
+				   nr_double_t& geq, nr_double_t& ceq) {
+  int cstate = qstate + 1;
+  if (state & MODE_INIT) fillState (qstate, getState (qstate));
+  switch (kernel) {
+#define KERNEL_CASE(m,o) \
+  case INTEGRATOR_KERNEL (m, o): \
+    integrateKernel<m, o> (qstate, cap, geq, ceq); break;
+  KERNEL_CASE (INTEGRATOR_EULER, 1)
+  KERNEL_CASE (INTEGRATOR_TRAPEZOIDAL, 2)
+  KERNEL_CASE (INTEGRATOR_GEAR, 1)
+  KERNEL_CASE (INTEGRATOR_GEAR, 2)
+  KERNEL_CASE (INTEGRATOR_GEAR, 3)
+  KERNEL_CASE (INTEGRATOR_GEAR, 4)
+  KERNEL_CASE (INTEGRATOR_GEAR, 5)
+  KERNEL_CASE (INTEGRATOR_GEAR, 6)
+  KERNEL_CASE (INTEGRATOR_ADAMSMOULTON, 1)
+  KERNEL_CASE (INTEGRATOR_ADAMSMOULTON, 2)
+  KERNEL_CASE (INTEGRATOR_ADAMSMOULTON, 3)
+  KERNEL_CASE (INTEGRATOR_ADAMSMOULTON, 4)
+  KERNEL_CASE (INTEGRATOR_ADAMSMOULTON, 5)
+  KERNEL_CASE (INTEGRATOR_ADAMSMOULTON, 6)
+#undef KERNEL_CASE
+  default:
+    geq = ceq = 0;
+    return;
+  }
+  if (state & MODE_INIT) fillState (cstate, getState (cstate));
+}
+
 } // namespace qucs
 
 #endif /* __INTEGRATOR_H__ */
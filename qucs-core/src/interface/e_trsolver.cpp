@@ -39,6 +39,7 @@
 #include <string.h>
 #include <cmath>
 #include <float.h>
+#include <algorithm>
 
 #include "compat.h"
 #include "object.h"
@@ -211,6 +212,12 @@ int e_trsolver::init (nr_double_t start, nr_double_t firstdelta, int mode)
         eqnAlgo = ALGO_QR_DECOMPOSITION_LS;
     else if (!strcmp (solver, "GolubSVD"))
         eqnAlgo = ALGO_SV_DECOMPOSITION;
+    else if (!strcmp (solver, "SparseLU"))
+        eqnAlgo = ALGO_LU_DECOMPOSITION_SPARSE;
+    else if (!strcmp (solver, "BiCGStab"))
+        eqnAlgo = ALGO_BICGSTAB;
+    else if (!strcmp (solver, "GMRES"))
+        eqnAlgo = ALGO_GMRES;
 
     // Perform initial DC analysis.
     if (initialDC)
@@ -261,6 +268,7 @@ int e_trsolver::init (nr_double_t start, nr_double_t firstdelta, int mode)
     adjustOrder (1);
 
     storeHistoryAges ();
+    snapshotPending = truncatePending = stepped = false;
 
     return 0;
 
@@ -271,6 +279,8 @@ int e_trsolver::init (nr_double_t start, nr_double_t firstdelta, int mode)
    to be less than these initial requested values) */
 void e_trsolver::storeHistoryAges (void)
 {
+    initialhistages.clear ();
+    histcircuits.clear ();
     circuit * root = subnet->getRoot ();
     for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
     {
@@ -278,6 +288,7 @@ void e_trsolver::storeHistoryAges (void)
         if (c->hasHistory ())
         {
             initialhistages.push_back (c->getHistoryAge ());
+            histcircuits.push_back (c);
         }
     }
 }
@@ -365,6 +376,7 @@ void e_trsolver::initETR (nr_double_t start, nr_double_t firstdelta, int mode)
     // also initialize the created circuit elements
     for (c = root; c != NULL; c = (circuit *) c->getPrev ())
         initCircuitTR (c);
+    poolStates ();
 }
 
 void e_trsolver::printx()
@@ -492,7 +504,7 @@ int e_trsolver::stepsolve_sync(nr_double_t synctime)
     if (error) return -1;
 
     // check whether Jacobian matrix is still non-singular
-    if (!A->isFinite ())
+    if (!isFiniteMatrix ())
     {
 //        messagefcn (LOG_ERROR, "ERROR: %s: Jacobian singular at t = %.3e, "
 //                  "aborting %s analysis\n", getName (), (double) current,
@@ -641,6 +653,20 @@ int e_trsolver::stepsolve_async(nr_double_t steptime)
     convError = 0;
 
     time = steptime;
+
+    // keep the state of the last accepted step before changing it
+    if (snapshotPending)
+    {
+        copySolution (solution, lastsolution);
+        snapshotPending = false;
+    }
+    if (truncatePending)
+    {
+        truncateHistory (lastasynctime);
+        truncatePending = false;
+    }
+    stepped = true;
+
     // update the interpolation time of any externally controlled
     // components which require it.
     updateExternalInterpTime(time);
@@ -728,7 +754,7 @@ int e_trsolver::stepsolve_async(nr_double_t steptime)
         if (rejected) continue;
 
         // check whether Jacobian matrix is still non-singular
-        if (!A->isFinite ())
+        if (!isFiniteMatrix ())
         {
             messagefcn (LOG_ERROR, "ERROR: %s: Jacobian singular at t = %.3e, "
                       "aborting %s analysis\n", getName (), (double) current,
@@ -780,8 +806,10 @@ int e_trsolver::stepsolve_async(nr_double_t steptime)
 void e_trsolver::acceptstep_async(void)
 {
     // copy the solution in case we wish to step back to this
-    // point later
-    copySolution (solution, lastsolution);
+    // point later, this is done by the next step
+    snapshotPending = true;
+    truncatePending = false;
+    stepped = false;
 
     // Store the time
     lastasynctime = time;
@@ -798,11 +826,18 @@ void e_trsolver::acceptstep_async(void)
 void e_trsolver::rejectstep_async(void)
 {
     // restore the solution (node voltages and branch currents) from
-    // the previously stored solution
-    copySolution (lastsolution, solution);
+    // the previously stored solution, nothing changed unless a step
+    // was taken since
+    if (stepped)
+    {
+        for (int i = 0; i < 8; i++) std::swap (solution[i], lastsolution[i]);
 
-    // Restore the circuit histories to their previous states
-    truncateHistory (lastasynctime);
+        // the stored solution is taken again and the circuit histories
+        // are restored to their previous states by the next step
+        snapshotPending = true;
+        truncatePending = true;
+        stepped = false;
+    }
 
     // Restore the time deltas
     inputState (dState, lastdeltas);
@@ -830,26 +865,17 @@ void e_trsolver::copySolution (tvector<nr_double_t> * src[8], tvector<nr_double_
         // check sizes are the same
         assert (src[i]->size () == dest[i]->size ());
         // copy over the data values
-        for (int j = 0; j < src[i]->size (); j++)
-        {
-            dest[i]->set (j, src[i]->get (j));
-        }
+        *dest[i] = *src[i];
     }
 }
 
 void e_trsolver::updateHistoryAges (nr_double_t newage)
 {
-    int i = 0;
-    circuit * root = subnet->getRoot ();
-    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    for (unsigned int i = 0; i < histcircuits.size (); i++)
     {
         // set the history length to retain to be at least
         // the length of the supplied age
-        if (c->hasHistory ())
-        {
-            c->setHistoryAge (std::max (initialhistages[i], newage));
-            i++;
-        }
+        histcircuits[i]->setHistoryAge (std::max (initialhistages[i], newage));
     }
 }
 
@@ -894,24 +920,26 @@ int e_trsolver::getNodeV (char * label, nr_double_t& nodeV)
     }
     else
     {
-      nodeV = x->get(r);
+      // the ground node has no row in the solution vector
+      nodeV = r > 0 ? x->get(r - 1) : 0.0;
       return 0;
     }
 }
 
-/* Get the voltage reported by a voltage probe */
-int e_trsolver::getVProbeV (char * probename, nr_double_t& probeV)
+/* Returns the circuit of the given type with the given name.  The
+   names of circuits in subcircuits are prefixed by the subcircuit. */
+circuit * e_trsolver::findCircuit (int type, char * name)
 {
     // string to hold the full name of the circuit
     std::string fullname;
 
     // check for NULL name
-    if (probename)
+    if (name)
     {
         circuit * root = subnet->getRoot ();
         for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
         {
-            if (c->getType () == CIR_VPROBE) {
+            if (c->getType () == type) {
 
                 fullname.clear ();
 
@@ -925,107 +953,134 @@ int e_trsolver::getVProbeV (char * probename, nr_double_t& probeV)
                 }
 
                 // append the user supplied name to search for
-                fullname.append (probename);
+                fullname.append (name);
 
-                // Check if it is the desired voltage source
+                // Check if it is the desired circuit
                 if (strcmp (fullname.c_str(), c->getName ()) == 0)
-                {
-                    // Saves the real and imaginary voltages in the probe to the
-                    // named variables Vr and Vi
-                    c->saveOperatingPoints ();
-                    // We are only interested in the real part for transient
-                    // analysis
-                    probeV = c->getOperatingPoint ("Vr");
-
-                    return 0;
-                }
+                    return c;
             }
         }
     }
-    return -1;
+    return NULL;
+}
+
+/* Get the voltage reported by a voltage probe */
+int e_trsolver::getVProbeV (char * probename, nr_double_t& probeV)
+{
+    circuit * c = findCircuit (CIR_VPROBE, probename);
+    if (c == NULL) return -1;
+
+    // Saves the real and imaginary voltages in the probe to the
+    // named variables Vr and Vi
+    c->saveOperatingPoints ();
+    // We are only interested in the real part for transient
+    // analysis
+    probeV = c->getOperatingPoint ("Vr");
+    return 0;
 }
 
 /* Get the current reported by a current probe */
 int e_trsolver::getIProbeI (char * probename, nr_double_t& probeI)
 {
-    // string to hold the full name of the circuit
-    std::string fullname;
+    circuit * c = findCircuit (CIR_IPROBE, probename);
+    if (c == NULL) return -1;
 
-    // check for NULL name
-    if (probename)
-    {
-        circuit * root = subnet->getRoot ();
-        for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
-        {
-            if (c->getType () == CIR_IPROBE) {
+    // Get the current reported by the probe
+    probeI = real (x->get (c->getVoltageSource () + getN ()));
+    return 0;
+}
 
-                fullname.clear ();
+int e_trsolver::setECVSVoltage(char * ecvsname, nr_double_t V)
+{
+    circuit * c = findCircuit (CIR_ECVS, ecvsname);
+    if (c == NULL) return -1;
 
-                // Subcircuit elements top level name is the
-                // subcircuit type (the base name of the subcircuit
-                // file)
-                if (!c->getSubcircuit ().empty())
-                {
-                    fullname.append (c->getSubcircuit ());
-                    fullname.append (".");
-                }
+    // Set the voltage to the desired value
+    c->setProperty("U", V);
+    return 0;
+}
 
-                // append the user supplied name to search for
-                fullname.append (probename);
+// Appends an element to the bulk exchange and returns its handle.
+int e_trsolver::addExchange (int type, int row, circuit * c)
+{
+    exchange_t e = { type, row, c };
+    exchange.push_back (e);
+    return exchange.size () - 1;
+}
 
-                // Check if it is the desired voltage source
-                if (strcmp (fullname.c_str(), c->getName ()) == 0)
-                {
-                    // Get the current reported by the probe
-                    probeI = real (x->get (c->getVoltageSource () + getN ()));
+int e_trsolver::getNodeHandle (char * name)
+{
+    int r = name ? nlist->getNodeNr (name) : -1;
+    if (r == -1) return -1;
+    return addExchange (CIR_UNKNOWN, r - 1, NULL);
+}
 
-                    return 0;
-                }
-            }
-        }
-    }
-    return -1;
+int e_trsolver::getVProbeHandle (char * name)
+{
+    circuit * c = findCircuit (CIR_VPROBE, name);
+    if (c == NULL) return -1;
+    return addExchange (CIR_VPROBE, -1, c);
 }
 
-int e_trsolver::setECVSVoltage(char * ecvsname, nr_double_t V)
+int e_trsolver::getIProbeHandle (char * name)
 {
-    // string to hold the full name of the circuit
-    std::string fullname;
+    circuit * c = findCircuit (CIR_IPROBE, name);
+    if (c == NULL) return -1;
+    return addExchange (CIR_IPROBE, c->getVoltageSource () + getN (), c);
+}
 
-    // check for NULL name
-    if (ecvsname)
+int e_trsolver::getECVSHandle (char * name)
+{
+    circuit * c = findCircuit (CIR_ECVS, name);
+    if (c == NULL) return -1;
+    return addExchange (CIR_ECVS, -1, c);
+}
+
+/* Obtains the values of the given node, voltage and current probe
+   handles.  Returns -1 if any handle is invalid. */
+int e_trsolver::getValues (int n, const int * handles, double * values)
+{
+    int error = 0;
+    for (int i = 0; i < n; i++)
     {
-        circuit * root = subnet->getRoot ();
-        for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+        int h = handles[i];
+        if (h < 0 || h >= (int) exchange.size () ||
+            exchange[h].type == CIR_ECVS)
         {
-            // examine only ECVS elements
-            if (c->getType () == CIR_ECVS) {
-
-                fullname.clear ();
-
-                // Subcircuit elements top level name is the
-                // subcircuit type (the base name of the subcircuit
-                // file)
-                if (!c->getSubcircuit ().empty())
-                {
-                    fullname.append (c->getSubcircuit ());
-                    fullname.append (".");
-                }
-
-                // append the user supplied name to search for
-                fullname.append (ecvsname);
+            error = -1;
+            continue;
+        }
+        exchange_t & e = exchange[h];
+        if (e.type == CIR_VPROBE)
+        {
+            e.c->saveOperatingPoints ();
+            values[i] = e.c->getOperatingPoint ("Vr");
+        }
+        else
+        {
+            values[i] = e.row < 0 ? 0.0 : x->get (e.row);
+        }
+    }
+    return error;
+}
 
-                // Check if it is the desired voltage source
-                if (strcmp (fullname.c_str(), c->getName ()) == 0)
-                {
-                    // Set the voltage to the desired value
-                    c->setProperty("U", V);
-                    return 0;
-                }
-            }
+/* Sets the voltages of the given ecvs handles.  Returns -1 if any
+   handle is invalid. */
+int e_trsolver::setECVSVoltages (int n, const int * handles, const double * V)
+{
+    int error = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int h = handles[i];
+        if (h < 0 || h >= (int) exchange.size () ||
+            exchange[h].type != CIR_ECVS)
+        {
+            error = -1;
+            continue;
         }
+        exchange[h].c->setProperty ("U", V[i]);
     }
-    return -1;
+    return error;
 }
 
 void e_trsolver::updateExternalInterpTime(nr_double_t t)
@@ -1051,26 +1106,61 @@ void e_trsolver::updateExternalInterpTime(nr_double_t t)
 void e_trsolver::truncateHistory (nr_double_t t)
 {
     // truncate all the circuit element histories
-    circuit * root = subnet->getRoot ();
-    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
-    {
-        if (c->hasHistory ()) c->truncateHistory (t);
-    }
+    for (circuit * c : histcircuits) c->truncateHistory (t);
 }
 
 int e_trsolver::getJacRows()
 {
-    return A->getRows();
+    return As != NULL ? As->getRows() : A->getRows();
 }
 
 int e_trsolver::getJacCols()
 {
-    return A->getCols();
+    return As != NULL ? As->getCols() : A->getCols();
 }
 
 void e_trsolver::getJacData(int r, int c, nr_double_t& data)
 {
-    data = A->get(r,c);
+    data = As != NULL ? As->get(r,c) : A->get(r,c);
+}
+
+/* Copies the Jacobian matrix in column major order, as expected by
+   MATLAB, in a single pass over the dense or sparse storage. */
+void e_trsolver::getJacobian (double * data)
+{
+    int rows = getJacRows (), cols = getJacCols ();
+    if (As != NULL)
+    {
+        const int * colptr = As->getColPtr ();
+        const int * rowidx = As->getRowIdx ();
+        const nr_double_t * val = As->getData ();
+        std::fill (data, data + rows * cols, 0.0);
+        for (int c = 0; c < cols; c++)
+            for (int k = colptr[c]; k < colptr[c + 1]; k++)
+                data[c * rows + rowidx[k]] = val[k];
+    }
+    else
+    {
+        const nr_double_t * val = A->getData ();
+        for (int r = 0; r < rows; r++)
+            for (int c = 0; c < cols; c++)
+                data[c * rows + r] = val[r * cols + c];
+    }
+}
+
+const nr_double_t * e_trsolver::getJacBuffer (void)
+{
+    return As != NULL ? NULL : A->getData ();
+}
+
+int e_trsolver::getJacSparse (const int ** colptr, const int ** rowidx,
+                              const nr_double_t ** data)
+{
+    if (As == NULL) return -1;
+    *colptr = As->getColPtr ();
+    *rowidx = As->getRowIdx ();
+    *data = As->getData ();
+    return As->getNnz ();
 }
 
 // properties
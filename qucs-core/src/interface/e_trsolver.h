@@ -148,6 +148,55 @@ public:
       */
     int getIProbeI (char * probename, nr_double_t& probeI);
 
+    /** \brief Pre-resolves a node, probe or ecvs for the bulk exchange
+      * \param name Pointer to character array containing the name
+      * \return Integer handle, or -1 if there is no such element
+      *
+      * The names are looked up the same way as by getNodeV(),
+      * getVProbeV(), getIProbeI() and setECVSVoltage().  The
+      * returned handles are passed to getValues() and
+      * setECVSVoltages() during the simulation, thus no names need
+      * to be looked up at each time step.
+      */
+    int getNodeHandle (char * name);
+    int getVProbeHandle (char * name);
+    int getIProbeHandle (char * name);
+    int getECVSHandle (char * name);
+
+    /** \brief Obtains the values of the given nodes and probes
+      * \param n Number of handles
+      * \param handles Node, voltage and current probe handles
+      * \param values Array of \a n doubles receiving the values
+      * \return Integer flag, -1 if a handle is invalid
+      */
+    int getValues (int n, const int * handles, double * values);
+
+    /** \brief Sets the voltages of the given ecvs components
+      * \param n Number of handles
+      * \param handles Ecvs handles
+      * \param V Array of \a n new voltages
+      * \return Integer flag, -1 if a handle is invalid
+      */
+    int setECVSVoltages (int n, const int * handles, const double * V);
+
+    /** \brief Copies the whole Jacobian matrix in column major order
+      * \param data Array of getJacRows() times getJacCols() doubles
+      */
+    void getJacobian (double * data);
+
+    /// Returns the dense Jacobian matrix in row major order, or NULL
+    /// if the matrix is sparse
+    const nr_double_t * getJacBuffer (void);
+
+    /** \brief Gives access to the sparse Jacobian matrix
+      * \param colptr Receives the column pointers (getJacCols() + 1)
+      * \param rowidx Receives the row indices of the entries
+      * \param data Receives the entries in compressed column order
+      * \return The number of entries, or -1 if the matrix is dense
+      */
+    int getJacSparse (const int ** colptr, const int ** rowidx,
+                      const nr_double_t ** data);
+
     // debugging functions
     void debug (void);
     void printx (void);
@@ -186,6 +235,18 @@ private:
     void updateExternalInterpTime(nr_double_t);
     void storeHistoryAges (void);
     void updateHistoryAges(nr_double_t);
+    circuit * findCircuit (int, char *);
+    int addExchange (int, int, circuit *);
+
+    // The pre-resolved elements of the bulk exchange, the handles
+    // are indices into this list
+    struct exchange_t
+    {
+        int type;       // circuit type, CIR_UNKNOWN for nodes
+        int row;        // row of the solution vector, -1 for ground
+        circuit * c;
+    };
+    std::vector<exchange_t> exchange;
 
 //    int solve_nonlinear_step (void);
     void adjustDelta_sync (nr_double_t);
@@ -195,7 +256,15 @@ private:
     // For going back in history of a solution after multiple
     // solution steps
     std::vector<nr_double_t> initialhistages;
+    // the circuits keeping a history
+    std::vector<circuit *> histcircuits;
     tvector<nr_double_t> * lastsolution[8];
+    // the solution is copied into lastsolution at the first step
+    // after acceptstep_async() or rejectstep_async() only, and the
+    // histories are truncated by the first step after a rejection
+    bool snapshotPending;
+    bool truncatePending;
+    bool stepped;
     nr_double_t lastasynctime;
     nr_double_t lastdeltas[8];
     nr_double_t lastdelta;
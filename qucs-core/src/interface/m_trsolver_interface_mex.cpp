@@ -28,7 +28,10 @@ enum ClassMethods { evNotDefined,
                     setecvs,
                     getnodev,
                     getvprobe,
-                    getiprobe
+                    getiprobe,
+                    gethandle,
+                    getvalues,
+                    setecvsv
                   };
 
 // Map to associate the command strings with the class
@@ -56,6 +59,9 @@ void Initialize()
     s_mapClassMethodStrs["getnodev"]            = getnodev;
     s_mapClassMethodStrs["getvprobe"]           = getvprobe;
     s_mapClassMethodStrs["getiprobe"]           = getiprobe;
+    s_mapClassMethodStrs["gethandle"]           = gethandle;
+    s_mapClassMethodStrs["getvalues"]           = getvalues;
+    s_mapClassMethodStrs["setecvsv"]            = setecvsv;
 }
 
 void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
@@ -157,6 +163,15 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     case getiprobe:
         mextrsolver_instance->getiprobe(nlhs, plhs, nrhs, prhs);
         return;
+    case gethandle:
+        mextrsolver_instance->gethandle(nlhs, plhs, nrhs, prhs);
+        return;
+    case getvalues:
+        mextrsolver_instance->getvalues(nlhs, plhs, nrhs, prhs);
+        return;
+    case setecvsv:
+        mextrsolver_instance->setecvsv(nlhs, plhs, nrhs, prhs);
+        return;
     default:
         mexErrMsgTxt("Unrecognised class command string.");
         break;
@@ -1,4 +1,6 @@
 #include <string>
+#include <cstring>
+#include <vector>
 #include <qucs-core/qucs_interface.h>
 #include "mextrsolver.h"
 
@@ -374,13 +376,7 @@ void mextrsolver::getJac(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prh
     outpointer = mxGetPr (plhs[0]);
 
     // copy the jacobian matrix data into the matlab matrix
-    for(int c = 0; c < jcols; c++)
-    {
-        for(int r = 0; r < jrows; r++)
-        {
-            qtr.getJacData(r, c, outpointer[(c*jrows)+r]);
-        }
-    }
+    qtr.getJacobian (outpointer);
 
 }
 
@@ -568,3 +564,94 @@ void mextrsolver::getnodev(int nlhs, mxArray *plhs[], int nrhs, const mxArray *p
         outpointer[0] = (double)voltage;
     }
 }
+
+// resolves the name of a node, probe or ecvs into a handle
+void mextrsolver::gethandle(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    char *kind, *name;
+    int handle = -1;
+
+    /* check for proper number of arguments */
+    if (nrhs != 4)
+        mexErrMsgIdAndTxt ( "MATLAB:trsolver:invalidNumInputs",
+                            "Two inputs required.");
+    else if (nlhs > 1)
+        mexErrMsgIdAndTxt ( "MATLAB:trsolver:maxlhs",
+                            "Too many output arguments.");
+
+    /* 3rd and 4th input must be strings (first two are used for the class interface) */
+    if ((mxIsChar(prhs[2]) != 1) | (mxIsChar(prhs[3]) != 1))
+        mexErrMsgIdAndTxt ( "MATLAB:trsolver:inputNotString",
+                            "Inputs must be strings containing the type and name.");
+
+    kind = mxArrayToString (prhs[2]);
+    name = mxArrayToString (prhs[3]);
+
+    if (!strcmp (kind, "node"))
+        handle = qtr.getNodeHandle (name);
+    else if (!strcmp (kind, "vprobe"))
+        handle = qtr.getVProbeHandle (name);
+    else if (!strcmp (kind, "iprobe"))
+        handle = qtr.getIProbeHandle (name);
+    else if (!strcmp (kind, "ecvs"))
+        handle = qtr.getECVSHandle (name);
+    else
+        mexErrMsgIdAndTxt ( "MATLAB:trsolver:invalidType",
+                            "Unknown element type %s.", kind );
+
+    if (handle < 0)
+    {
+        // Throw an error if the element was not found
+        mexErrMsgIdAndTxt ( "MATLAB:trsolver:notfound",
+                            "The %s with name %s was not found.",
+                            kind, name );
+    }
+
+    plhs[0] = mxCreateDoubleScalar ((double)handle);
+}
+
+// gets the values of a vector of node and probe handles
+void mextrsolver::getvalues(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    /* check for proper number of arguments */
+    if (nrhs != 3)
+        mexErrMsgIdAndTxt ( "MATLAB:trsolver:invalidNumInputs",
+                            "One input required.");
+    else if (nlhs > 1)
+        mexErrMsgIdAndTxt ( "MATLAB:trsolver:maxlhs",
+                            "Too many output arguments.");
+
+    int n = (int) mxGetNumberOfElements (prhs[2]);
+    double * in = mxGetPr (prhs[2]);
+    std::vector<int> handles (in, in + n);
+
+    plhs[0] = mxCreateDoubleMatrix ( (mwSize)(n), (mwSize)(1), mxREAL);
+
+    if (qtr.getValues (n, &handles[0], mxGetPr (plhs[0])) != 0)
+        mexErrMsgIdAndTxt ( "MATLAB:trsolver:invalidHandle",
+                            "Invalid node or probe handle.");
+}
+
+// sets the voltages of a vector of ecvs handles
+void mextrsolver::setecvsv(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    /* check for proper number of arguments */
+    if (nrhs != 4)
+        mexErrMsgIdAndTxt ( "MATLAB:trsolver:invalidNumInputs",
+                            "Two inputs required.");
+    else if (nlhs > 0)
+        mexErrMsgIdAndTxt ( "MATLAB:trsolver:maxlhs",
+                            "Too many output arguments.");
+
+    int n = (int) mxGetNumberOfElements (prhs[2]);
+    if ((int) mxGetNumberOfElements (prhs[3]) != n)
+        mexErrMsgIdAndTxt ( "MATLAB:trsolver:inputNotVector",
+                            "Handles and voltages must have the same length.");
+
+    double * in = mxGetPr (prhs[2]);
+    std::vector<int> handles (in, in + n);
+
+    if (qtr.setECVSVoltages (n, &handles[0], mxGetPr (prhs[3])) != 0)
+        mexErrMsgIdAndTxt ( "MATLAB:trsolver:invalidHandle",
+                            "Invalid ecvs handle.");
+}
@@ -33,6 +33,9 @@ class mextrsolver
         void getiprobe(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
         void getvprobe(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
         void getnodev(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+        void gethandle(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+        void getvalues(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+        void setecvsv(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
 
     private:
         // the one and only trsolver_interface object, interface to the
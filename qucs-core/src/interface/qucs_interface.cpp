@@ -47,15 +47,39 @@
 #include "qucs_interface.h"
 #include "analysis.h"
 #include "e_trsolver.h"
+#include "threadpool.h"
 
 #if HAVE_UNISTD_H
 #include <unistd.h>
 #endif
 
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 using namespace qucs;
 
+/* The netlist parser and the module registry are shared by all
+   instances.  The netlists are therefore parsed one at a time, and
+   the modules are registered by the first instance and unregistered
+   by the last one.  Everything else belongs to the instance, thus
+   instances may be run on different threads at the same time. */
+static std::mutex setup_lock;
+static int setup_users = 0;
+static std::once_flag setup_once;
+
+// Initializes the logging streams and random numbers once.
+static void setup (void)
+{
+    std::call_once (setup_once, [] ()
+    {
+        loginit ();
+        ::srand (::time (NULL));
+    });
+}
+
 // constructor
 qucsint::qucsint ()
 {
@@ -63,9 +87,16 @@ qucsint::qucsint ()
     //int listing = 0;
     ret = 0;
     err = 0;
+    subnet = NULL;
+    in = NULL;
+    gnd = NULL;
+    out = NULL;
+    root = NULL;
+    checker = NULL;
+    messagefcn = &logprint;
+    registered = false;
 
-    loginit ();
-    ::srand (::time (NULL));
+    setup ();
 
 }
 
@@ -74,9 +105,16 @@ qucsint::qucsint (char* infile)
     //int listing = 0;
     ret = 0;
     err = 0;
+    subnet = NULL;
+    in = NULL;
+    gnd = NULL;
+    out = NULL;
+    root = NULL;
+    checker = NULL;
+    messagefcn = &logprint;
+    registered = false;
 
-    loginit ();
-    ::srand (::time (NULL));
+    setup ();
 
     prepare_netlist (infile);
 }
@@ -84,23 +122,57 @@ qucsint::qucsint (char* infile)
 // destructor
 qucsint::~qucsint ()
 {
-    delete subnet;
-    delete in;
-//    delete out;
-    delete root;
+    clear ();
 
     // delete modules
-    module::unregisterModules ();
+    std::lock_guard<std::mutex> guard (setup_lock);
+    if (registered && --setup_users == 0)
+    {
+        module::unregisterModules ();
+    }
+}
 
-    netlist_destroy_env ();
+// Deletes the netlist, its environments and results.
+void qucsint::clear (void)
+{
+    vectors.clear ();
+    delete subnet;
+    delete in;
+    delete out;
+    delete root;
+    // the checker environments go after the copy made of them
+    delete checker;
+    subnet = NULL;
+    in = NULL;
+    gnd = NULL;
+    out = NULL;
+    root = NULL;
+    checker = NULL;
 }
 
 /*!\ todo: replace "root" by / as environement root */
 int qucsint::prepare_netlist (char * infile)
 {
+    // the messages of this instance go into its message function
+    logsetsink (messagefcn);
+    int result = parse_netlist (infile);
+    logsetsink (NULL);
+    return result;
+}
+
+int qucsint::parse_netlist (char * infile)
+{
+    std::lock_guard<std::mutex> guard (setup_lock);
 
     // create static modules
-    module::registerModules ();
+    if (!registered)
+    {
+        if (setup_users++ == 0) module::registerModules ();
+        registered = true;
+    }
+
+    // a netlist prepared before is replaced
+    clear ();
 
     // create root environment
     root = new qucs::environment (std::string("root"));
@@ -128,7 +200,9 @@ int qucsint::prepare_netlist (char * infile)
     in->setEnv (root);
 
     // get input netlist
-    if (in->netlist (subnet) != 0)
+    int result = in->netlist (subnet);
+    checker = netlist_release_env ();
+    if (result != 0)
     {
         if (netlist_check)
         {
@@ -152,10 +226,19 @@ int qucsint::prepare_netlist (char * infile)
 
 int qucsint::evaluate ()
 {
+    if (!subnet) return -2;
+
+    // the results of a previous run are replaced
+    vectors.clear ();
+    delete out;
+    out = NULL;
+
     // analyse the netlist
     err = 0;
     ret = 0;
+    logsetsink (messagefcn);
     out = subnet->runAnalysis (err);
+    logsetsink (NULL);
     ret |= err;
 
     return ret;
@@ -163,7 +246,10 @@ int qucsint::evaluate ()
 
 int qucsint::output (char * outfile)
 {
+    if (!out) return -2;
+
     // evaluate output dataset
+    logsetsink (messagefcn);
     ret |= root->equationSolver (out);
 
     if (outfile != NULL)
@@ -171,10 +257,53 @@ int qucsint::output (char * outfile)
         out->setFile (outfile);
         out->print ();
     }
+    logsetsink (NULL);
 
     return ret;
 }
 
+int qucsint::getVectorHandle (const char * name)
+{
+    if (!out || !name) return -1;
+    qucs::vector * v = out->findVariable (name);
+    if (!v) v = out->findDependency (name);
+    if (!v) return -1;
+    vectors.push_back (v);
+    return vectors.size () - 1;
+}
+
+int qucsint::getVectorLength (int handle)
+{
+    if (handle < 0 || handle >= (int) vectors.size ()) return -1;
+    return vectors[handle]->getSize ();
+}
+
+int qucsint::getVectorData (int handle, double * re, double * im)
+{
+    if (handle < 0 || handle >= (int) vectors.size ()) return -1;
+    qucs::vector * v = vectors[handle];
+    for (int i = 0; i < v->getSize (); i++)
+    {
+        nr_complex_t c = v->get (i);
+        if (re) re[i] = (double) real (c);
+        if (im) im[i] = (double) imag (c);
+    }
+    return 0;
+}
+
+const double * qucsint::getVectorView (int handle)
+{
+    if (handle < 0 || handle >= (int) vectors.size ()) return NULL;
+    // only doubles can be handed out as they are
+    if (sizeof (nr_double_t) != sizeof (double)) return NULL;
+    return reinterpret_cast<const double *> (vectors[handle]->getData ());
+}
+
+void qucsint::setMessageFcn (void (*newmessagefcn)(int level, const char * format, ...))
+{
+    messagefcn = newmessagefcn ? newmessagefcn : &logprint;
+}
+
 /*/////////////////////////////////////////////////////////////////////////////
 
                             trsolver_interface
@@ -191,6 +320,7 @@ trsolver_interface::trsolver_interface ()
 trsolver_interface::trsolver_interface (char * infile)
     : qucsint (infile)
 {
+    etr = 0;
     isInitialised = false;
 
     int result = prepare_netlist (infile);
@@ -238,26 +368,77 @@ void trsolver_interface::getETR()
 
 int trsolver_interface::init (double start, double firstdelta, int mode)
 {
-    if (etr) return etr->init ((nr_double_t)start, (nr_double_t)firstdelta, mode);
-    else return -2;
+    if (!etr) return -2;
+    logsetsink (etr->messagefcn);
+    int result = etr->init ((nr_double_t)start, (nr_double_t)firstdelta, mode);
+    logsetsink (NULL);
+    return result;
 }
 
 
 int trsolver_interface::stepsolve_sync (double synctime)
 {
-    if (etr) return etr->stepsolve_sync ((nr_double_t)synctime);
-    else return -2;
+    if (!etr) return -2;
+    // messages of the solver go into the message function of this instance
+    logsetsink (etr->messagefcn);
+    int result = etr->stepsolve_sync ((nr_double_t)synctime);
+    logsetsink (NULL);
+    return result;
+}
+
+/* Runs the given function for each of the instances on a number of
+   threads.  The instances are independent of each other, each thread
+   takes the next one until all are done.  The threads are the ones of
+   the shared pool, a single one runs the instances in order. */
+template <class func_t>
+static void runBatch (trsolver_interface ** solvers, int n, int threads,
+                      func_t func)
+{
+    if (threads == 1)
+    {
+        for (int i = 0; i < n; i++) func (i, solvers[i]);
+        return;
+    }
+    threadpool::run (n, [&] (int i) { func (i, solvers[i]); });
+}
+
+int trsolver_interface::stepsolve_sync (trsolver_interface ** solvers, int n,
+                                        double synctime, int * results,
+                                        int threads)
+{
+    std::atomic<int> failed (0);
+    runBatch (solvers, n, threads,
+              [&] (int i, trsolver_interface * s)
+              {
+                  int result = s->stepsolve_sync (synctime);
+                  if (results) results[i] = result;
+                  if (result != 0) failed++;
+              });
+    return failed;
+}
+
+void trsolver_interface::acceptstep_sync (trsolver_interface ** solvers,
+                                          int n, int threads)
+{
+    runBatch (solvers, n, threads,
+              [] (int, trsolver_interface * s) { s->acceptstep_sync (); });
 }
 
 void trsolver_interface::acceptstep_sync (void)
 {
-    if (etr) etr->acceptstep_sync ();
+    if (!etr) return;
+    logsetsink (etr->messagefcn);
+    etr->acceptstep_sync ();
+    logsetsink (NULL);
 }
 
 int trsolver_interface::stepsolve_async (double steptime)
 {
-    if (etr) return etr->stepsolve_async ((nr_double_t)steptime);
-    else return -2;
+    if (!etr) return -2;
+    logsetsink (etr->messagefcn);
+    int result = etr->stepsolve_async ((nr_double_t)steptime);
+    logsetsink (NULL);
+    return result;
 }
 
 void trsolver_interface::acceptstep_async (void)
@@ -354,6 +535,56 @@ int trsolver_interface::getIProbeI (char * probename, double& probeI)
     }
 }
 
+int trsolver_interface::getNodeHandle (char * name)
+{
+    if (etr) return etr->getNodeHandle (name);
+    else return -2;
+}
+
+int trsolver_interface::getVProbeHandle (char * name)
+{
+    if (etr) return etr->getVProbeHandle (name);
+    else return -2;
+}
+
+int trsolver_interface::getIProbeHandle (char * name)
+{
+    if (etr) return etr->getIProbeHandle (name);
+    else return -2;
+}
+
+int trsolver_interface::getECVSHandle (char * name)
+{
+    if (etr) return etr->getECVSHandle (name);
+    else return -2;
+}
+
+int trsolver_interface::getValues (int n, const int * handles, double * values)
+{
+    if (etr) return etr->getValues (n, handles, values);
+    else return -2;
+}
+
+int trsolver_interface::setECVSVoltages (int n, const int * handles,
+                                         const double * V)
+{
+    if (etr) return etr->setECVSVoltages (n, handles, V);
+    else return -2;
+}
+
+int trsolver_interface::getJacobian (double * data)
+{
+    if (etr)
+    {
+        etr->getJacobian (data);
+        return 0;
+    }
+    else
+    {
+        return -2;
+    }
+}
+
 //void trsolver_interface::debug (void)
 //{
 //    if (etr) etr->debug ();
@@ -367,5 +598,64 @@ void trsolver_interface::printSolution (void)
 
 void trsolver_interface::setMessageFcn(void (*newmessagefcn)(int level, const char * format, ...))
 {
-    etr->messagefcn = newmessagefcn;
+    qucsint::setMessageFcn (newmessagefcn);
+    if (etr) etr->messagefcn = newmessagefcn;
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+
+                            C interface
+
+/////////////////////////////////////////////////////////////////////////////*/
+
+struct qucs_session : public qucs::qucsint
+{
+};
+
+qucs_session * qucs_session_create (void)
+{
+    return new qucs_session ();
+}
+
+void qucs_session_destroy (qucs_session * s)
+{
+    delete s;
+}
+
+int qucs_session_load (qucs_session * s, const char * netlist)
+{
+    return s->prepare_netlist (const_cast<char *> (netlist));
+}
+
+int qucs_session_run (qucs_session * s)
+{
+    int result = s->evaluate ();
+    return s->output (NULL) | result;
+}
+
+int qucs_session_vector (qucs_session * s, const char * name)
+{
+    return s->getVectorHandle (name);
+}
+
+int qucs_session_vector_length (qucs_session * s, int handle)
+{
+    return s->getVectorLength (handle);
+}
+
+int qucs_session_vector_data (qucs_session * s, int handle,
+                              double * re, double * im)
+{
+    return s->getVectorData (handle, re, im);
+}
+
+const double * qucs_session_vector_view (qucs_session * s, int handle)
+{
+    return s->getVectorView (handle);
+}
+
+void qucs_session_message_fcn (qucs_session * s,
+                               void (*fcn)(int level, const char * format, ...))
+{
+    s->setMessageFcn (fcn);
 }
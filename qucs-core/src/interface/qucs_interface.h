@@ -35,6 +35,9 @@
 #ifndef __QUCS_INTERFACE_H__
 #define __QUCS_INTERFACE_H__
 
+#ifdef __cplusplus
+
+#include <vector>
 
 namespace qucs
 {
@@ -52,6 +55,7 @@ class circuit;
 class dataset;
 class environment;
 class e_trsolver;
+class vector;
 
 /** \class qucsint
   * \brief superclass for interfacing to the Qucs circuit solvers.
@@ -60,6 +64,9 @@ class e_trsolver;
   *
   * This class is used for interfacing qucs with external software
   *
+  * Each instance is a simulation session of its own.  Different
+  * instances can be run on different threads at the same time, only
+  * the parsing of their netlists is serialized.
   */
 class qucsint
 {
@@ -73,6 +80,45 @@ public:
     int evaluate ();
     int output (char* outfile);
 
+    /** \brief Looks up a result vector of the last evaluation
+      * \param name Name of the variable or dependency
+      * \return Integer handle, -1 if there is no such vector
+      *
+      * The handles are valid until the next evaluate().  Variables
+      * defined by equations are available after output().
+      */
+    int getVectorHandle (const char * name);
+
+    /// Returns the number of values of the vector, -1 if the handle is invalid
+    int getVectorLength (int handle);
+
+    /** \brief Copies the values of the vector
+      * \param handle Vector handle
+      * \param re Array of getVectorLength() doubles for the real parts, or NULL
+      * \param im Array of getVectorLength() doubles for the imaginary parts, or NULL
+      * \return Integer flag, -1 if the handle is invalid
+      */
+    int getVectorData (int handle, double * re, double * im);
+
+    /** \brief Gives access to the values of the vector without copying
+      * \param handle Vector handle
+      * \return Pointer to getVectorLength() pairs of real and imaginary
+      *   parts, NULL if the handle is invalid or the values are not
+      *   stored as doubles
+      *
+      * The values are the ones held by the dataset, they must not be
+      * modified and are valid until the next evaluate() only.
+      */
+    const double * getVectorView (int handle);
+
+    /** \brief Sets the function the messages of this instance go into
+      *
+      * The messages printed while preparing, evaluating and writing
+      * the output of the calling thread go into this function, NULL
+      * restores the standard logprint function.
+      */
+    void setMessageFcn (void (*newmessagefcn)(int level, const char * format, ...));
+
 protected:
 
     qucs::net * subnet;
@@ -83,6 +129,20 @@ protected:
     int err;
     int ret;
 
+private:
+
+    void clear (void);
+    int parse_netlist (char* infile);
+
+    // the environments created by the netlist checker
+    qucs::environment * checker;
+    // the function the messages go into
+    void (*messagefcn)(int level, const char * format, ...);
+    // the vectors by handle
+    std::vector<qucs::vector *> vectors;
+    // whether this instance holds a reference to the static modules
+    bool registered;
+
 };
 
 
@@ -121,6 +181,25 @@ public:
     void rejectstep_async (void);
     void getsolution (double *);
 
+    /** \brief Steps several independent instances at once
+      * \param solvers Array of \a n initialised instances
+      * \param n Number of instances
+      * \param synctime Time to step to, as for stepsolve_sync()
+      * \param results Array of \a n results of stepsolve_sync(), or NULL
+      * \param threads Number of threads, zero for the number of cores
+      * \return The number of instances which failed
+      *
+      * The instances are distributed among the threads, each one
+      * reports its messages into its own message function.
+      */
+    static int stepsolve_sync (trsolver_interface ** solvers, int n,
+                               double synctime, int * results,
+                               int threads = 0);
+
+    /// Accepts the last step of each of the \a n given instances
+    static void acceptstep_sync (trsolver_interface ** solvers, int n,
+                                 int threads = 0);
+
     /// Returns the number of node voltages in the circuit.
     int getN ();
 
@@ -201,6 +280,42 @@ public:
       */
     int getIProbeI (char * probename, double& probeI);
 
+    /** \brief Pre-resolves a node, probe or ecvs for the bulk exchange
+      * \param name Pointer to character array containing the name
+      * \return Integer handle, -1 if there is no such element
+      *
+      * The names are looked up the same way as by getNodeV(),
+      * getVProbeV(), getIProbeI() and setECVSVoltage(), but once
+      * only.  The handles are passed to getValues() and
+      * setECVSVoltages() at each time step.
+      */
+    int getNodeHandle (char * name);
+    int getVProbeHandle (char * name);
+    int getIProbeHandle (char * name);
+    int getECVSHandle (char * name);
+
+    /** \brief Obtains the values of the given nodes and probes
+      * \param n Number of handles
+      * \param handles Node, voltage and current probe handles
+      * \param values Array of \a n doubles receiving the values
+      * \return Integer flag, -1 if a handle is invalid
+      */
+    int getValues (int n, const int * handles, double * values);
+
+    /** \brief Sets the voltages of the given ecvs components
+      * \param n Number of handles
+      * \param handles Ecvs handles
+      * \param V Array of \a n new voltages
+      * \return Integer flag, -1 if a handle is invalid
+      */
+    int setECVSVoltages (int n, const int * handles, const double * V);
+
+    /** \brief Copies the whole Jacobian matrix in column major order
+      * \param data Array of getJacRows() times getJacCols() doubles
+      * \return Integer flag reporting success or failure
+      */
+    int getJacobian (double * data);
+
     /** \brief Sets pointer to function used to print messages during a sim
       * \param printing function to be used by e_trsolver
       *
@@ -216,6 +331,10 @@ public:
       * string in the same style as printf (when using logprint). The
       * additional arguments are used by logprint in the supplied
       * formatting string.
+      *
+      * While the instance is initialised or stepped, all the messages
+      * of the solver of the calling thread go into this function, so
+      * each instance has its own message sink.
       */
     void setMessageFcn (void (*newmessagefcn)(int level, const char * format, ...));
 
@@ -239,4 +358,39 @@ private:
 
 } // namespace qucs
 
+extern "C" {
+#endif /* __cplusplus */
+
+/*/////////////////////////////////////////////////////////////////////////////
+
+                            C interface
+
+/////////////////////////////////////////////////////////////////////////////*/
+
+/** \brief Opaque simulation session of the C interface
+  *
+  * The functions correspond to the ones of the qucsint class.  A
+  * session is created, loads a netlist, runs all its analyses and
+  * equations, then the results are fetched by vector handles.
+  * Different sessions can be run on different threads at the same
+  * time.
+  */
+typedef struct qucs_session qucs_session;
+
+qucs_session * qucs_session_create (void);
+void qucs_session_destroy (qucs_session *);
+int  qucs_session_load (qucs_session *, const char * netlist);
+int  qucs_session_run (qucs_session *);
+int  qucs_session_vector (qucs_session *, const char * name);
+int  qucs_session_vector_length (qucs_session *, int handle);
+int  qucs_session_vector_data (qucs_session *, int handle,
+                               double * re, double * im);
+const double * qucs_session_vector_view (qucs_session *, int handle);
+void qucs_session_message_fcn (qucs_session *,
+                               void (*fcn)(int level, const char * format, ...));
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __QUCS_INTERFACE_H__ */
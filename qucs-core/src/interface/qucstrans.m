@@ -129,6 +129,36 @@ classdef qucstrans < qucs
             this.cppcall ('setecvs', name, voltage);
         end
         
+        function handle = gethandle (this, type, name)
+            % resolves a named element once for getvalues and setecvsv
+            %
+            % Syntax
+            %
+            % handle = gethandle (type, name)
+            %
+            % Input
+            %
+            %  type - one of 'node', 'vprobe', 'iprobe' or 'ecvs'
+            %
+            %  name - name of the element as given to getnodev,
+            %    getvprobe, getiprobe or setecvs
+            %
+            
+            handle = this.cppcall ('gethandle', type, name);
+        end
+        
+        function values = getvalues (this, handles)
+            % gets the values of a vector of node and probe handles
+            
+            values = this.cppcall ('getvalues', handles);
+        end
+        
+        function setecvsv (this, handles, voltages)
+            % sets the voltages of a vector of ecvs handles
+            
+            this.cppcall ('setecvsv', handles, voltages);
+        end
+        
     end
     
 end
\ No newline at end of file
@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <vector>
 
 #include "poly.h"
 #include "spline.h"
@@ -179,18 +180,18 @@ void interpolator::prepare (int interpol, int repitition, int domain) {
 	isp->setBoundary (SPLINE_BC_PERIODIC);
       }
       // prepare data vectors
-      vector rv = vector (length);
-      vector iv = vector (length);
-      vector rt = vector (length);
+      std::vector<nr_double_t> rv (length);
+      std::vector<nr_double_t> iv (length);
       for (int i = 0; i < length; i++) {
-	rv (i) = real (cy[i]);
-	iv (i) = imag (cy[i]);
-	rt (i) = rx[i];
+	rv[i] = real (cy[i]);
+	iv[i] = imag (cy[i]);
       }
-      // pass data vectors to splines and construct these
-      rsp->vectors (rv, rt);
-      isp->vectors (iv, rt);
+      // pass data vectors to splines and construct these, both parts
+      // share the grid
+      rsp->vectors (&rv[0], rx, length);
       rsp->construct ();
+      isp->shareGrid (*rsp);
+      isp->values (&iv[0]);
       isp->construct ();
     }
 
@@ -299,7 +300,8 @@ nr_double_t interpolator::rinterpolate (nr_double_t x) {
   // cubic spline interpolation
   else if (interpolType & INTERPOL_CUBIC) {
     // evaluate spline functions
-    res = rsp->evaluate (x).f0;
+    nr_double_t d;
+    rsp->evaluate (x, res, d);
   }
   else if (interpolType & INTERPOL_HOLD) {
     // find appropriate dependency index
@@ -343,8 +345,9 @@ nr_complex_t interpolator::cinterpolate (nr_double_t x) {
   // cubic spline interpolation
   else if (interpolType & INTERPOL_CUBIC) {
     // evaluate spline functions
-    nr_double_t r = rsp->evaluate (x).f0;
-    nr_double_t i = isp->evaluate (x).f0;
+    nr_double_t r, i, d;
+    rsp->evaluate (x, r, d);
+    isp->evaluate (x, i, d);
     res = nr_complex_t (r, i);
   }
   else if (interpolType & INTERPOL_HOLD) {
@@ -29,59 +29,175 @@
 
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
+#include <time.h>
 
 #include "logging.h"
 
+#if defined (__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+# define LOG_THREAD_LOCAL _Thread_local
+#elif defined (_MSC_VER)
+# define LOG_THREAD_LOCAL __declspec (thread)
+#else
+# define LOG_THREAD_LOCAL __thread
+#endif
+
+/* Size of the message buffer of each thread. */
+#define LOG_BUFFER 8192
+
+/* Seconds between writes of the message buffers and between updates
+   of the progress bar. */
+#define LOG_FLUSH_INTERVAL    0.1
+#define LOG_PROGRESS_INTERVAL 0.2
+
 /* Both of the log level dependent FILE streams. */
 FILE * file_status = NULL;
 FILE * file_error = NULL;
 
+/* Messages above this level are dropped before being formatted. */
+static int log_level = LOG_STATUS;
+
+/* The message sink of the current thread, if any. */
+static LOG_THREAD_LOCAL logsink_t log_sink = NULL;
+
+/* The messages of the current thread not yet written, all for the
+   same stream. */
+static LOG_THREAD_LOCAL char log_text[LOG_BUFFER];
+static LOG_THREAD_LOCAL int log_used = 0;
+static LOG_THREAD_LOCAL FILE * log_file = NULL;
+static LOG_THREAD_LOCAL double log_flushed = 0;
+
+/* Returns a monotonic time in seconds. */
+static double lognow (void) {
+#if defined (CLOCK_MONOTONIC)
+  struct timespec t;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+#else
+  return (double) time (NULL);
+#endif
+}
+
+/* Writes the buffered messages of the current thread.  A single write
+   per buffer keeps the messages of concurrent threads apart. */
+void logflush (void) {
+  if (log_used > 0 && log_file != NULL) {
+    fwrite (log_text, 1, log_used, log_file);
+    fflush (log_file);
+  }
+  log_used = 0;
+  log_flushed = lognow ();
+}
+
 /* This function prints the given messages format and the appropriate
-   arguments to a FILE stream depending on the given log level. */
+   arguments to a FILE stream depending on the given log level.  The
+   messages are collected per thread and written at most every
+   LOG_FLUSH_INTERVAL seconds, at the latest by logflush().  If the
+   current thread has its own message sink the message is passed to it
+   instead. */
 void logprint (int level, const char * format, ...) {
   FILE * f;
   va_list args;
+  int n;
 
+  if (level > log_level) return;
+  if (log_sink != NULL) {
+    char buf[1024];
+    va_start (args, format);
+    vsnprintf (buf, sizeof (buf), format, args);
+    va_end (args);
+    log_sink (level, "%s", buf);
+    return;
+  }
   f = level == LOG_STATUS ? file_status : file_error;
-  if (f != NULL) {
+  if (f == NULL) return;
+  if (f != log_file) {
+    logflush ();
+    log_file = f;
+  }
+  va_start (args, format);
+  n = vsnprintf (log_text + log_used, LOG_BUFFER - log_used, format, args);
+  va_end (args);
+  if (n >= LOG_BUFFER - log_used && log_used > 0) {
+    // no room left, write the previous messages first
+    logflush ();
+    va_start (args, format);
+    n = vsnprintf (log_text, LOG_BUFFER, format, args);
+    va_end (args);
+  }
+  if (n >= LOG_BUFFER) {
+    // too long for the buffer at all
     va_start (args, format);
     vfprintf (f, format, args);
     va_end (args);
     fflush (f);
+    n = 0;
   }
+  if (n > 0) log_used += n;
+  if (lognow () - log_flushed >= LOG_FLUSH_INTERVAL) logflush ();
+}
+
+/* Sets the highest level of the messages printed. */
+void logsetlevel (int level) {
+  log_level = level;
+}
+
+/* Writes the messages of the main thread at program exit. */
+static void logexit (void) {
+  logflush ();
 }
 
 /* Initialization of the logging interface. */
 void loginit (void) {
   file_error = file_status = stderr;
+  atexit (logexit);
+}
+
+/* Passes the messages of the current thread to the given function
+   instead of the FILE streams, NULL restores the streams.  This
+   allows concurrent simulations to report into separate sinks. */
+void logsetsink (logsink_t sink) {
+  log_sink = sink == logprint ? NULL : sink;
 }
 
 /* Customize logging. */
 void redirect_status_to_stdout(){
+	logflush ();
 	file_status = stdout;
 }
 
-/* Last number of '*' in the progress bar. */
-int progressbar_last = 0;
+/* Last number of '*' in the progress bar and the time it was
+   painted. */
+static LOG_THREAD_LOCAL int progressbar_last = 0;
+static LOG_THREAD_LOCAL double progressbar_time = 0;
 
-/* Print a tiny progress-bar depending on the arguments. */
+/* Print a tiny progress-bar depending on the arguments.  The bar is
+   painted at most every LOG_PROGRESS_INTERVAL seconds and in a single
+   message. */
 void logprogressbar (nr_double_t current, nr_double_t final, int points) {
-  int i;
+  int i, n;
+  char bar[256];
+  double now;
   if (progressbar_enable) {
     if (((int) (current * 100 / final)) == progressbar_last && current)
       return;
+    now = lognow ();
+    if (current && now - progressbar_time < LOG_PROGRESS_INTERVAL)
+      return;
+    progressbar_time = now;
     progressbar_last = (int) (current * 100 / final);
     if (progressbar_gui) {
       logprint (LOG_STATUS, "\t%02d\r", progressbar_last);
     }
     else {
-      logprint (LOG_STATUS, "[");
-      for (i = 0; i < (current  * points / final); i++)
-	logprint (LOG_STATUS, "*");
-      for (; i < points; i++) logprint (LOG_STATUS, " ");
-      logprint (LOG_STATUS, "] %.2f%%      \r",
-		(double) (current * 100.0 / final));
+      if (points > (int) sizeof (bar) - 1) points = sizeof (bar) - 1;
+      n = (int) (current * points / final);
+      for (i = 0; i < points; i++) bar[i] = i < n ? '*' : ' ';
+      bar[points] = '\0';
+      logprint (LOG_STATUS, "[%s] %.2f%%      \r",
+		bar, (double) (current * 100.0 / final));
     }
+    logflush ();
   }
 }
 
@@ -95,8 +211,13 @@ int progressbar_gui = 0;
 void logprogressclear (int points) {
   int i;
   progressbar_last = 0;
+  progressbar_time = 0;
   if (progressbar_enable && !progressbar_gui) {
-    for (i = 0; i < points + 15; i++) logprint (LOG_STATUS, " ");
-    logprint (LOG_STATUS, "\r");
+    char blank[256];
+    if (points + 15 > (int) sizeof (blank) - 1) points = sizeof (blank) - 16;
+    for (i = 0; i < points + 15; i++) blank[i] = ' ';
+    blank[points + 15] = '\0';
+    logprint (LOG_STATUS, "%s\r", blank);
+    logflush ();
   }
 }
@@ -30,8 +30,13 @@
 #include <stdio.h>
 __BEGIN_DECLS
 
+typedef void (* logsink_t) (int, const char *, ...);
+
 void logprint (int, const char *, ...);
+void logflush (void);
+void logsetlevel (int);
 void loginit (void);
+void logsetsink (logsink_t);
 void redirect_status_to_stdout();
 void logprogressbar (nr_double_t, nr_double_t, int);
 void logprogressclear (int);
@@ -724,10 +724,15 @@ nr_complex_t cbesselj (unsigned int, nr_complex_t);
    \param[in] n order
    \param[in] z argument
    \return Bessel function of first kind of order n
-   \bug Not implemented
+
+   Real arguments are passed to the libm implementation, which is
+   accurate to a few ulps and much faster than the series and
+   quadratures of the complex argument.
 */
 nr_complex_t jn (const int n, const nr_complex_t z)
 {
+    if (std::imag (z) == 0.0)
+        return nr_complex_t (::jn (n, std::real (z)), 0);
     return cbesselj (n, z);
 }
 
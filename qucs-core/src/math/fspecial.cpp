@@ -92,6 +92,37 @@ void fspecial::ellip_ke (nr_double_t arg, nr_double_t &k, nr_double_t &e) {
   }
 }
 
+/* Returns the nome q = exp (-pi K'/K) of the given modulus k and the
+   complementary modulus k' = sqrt (1 - k^2) by the series (A&S
+   17.3.21) q = l + 2 l^5 + 15 l^9 + 150 l^13 + 1707 l^17 with
+   l = (1 - sqrt (k')) / (2 (1 + sqrt (k'))).  The logarithm of the
+   nome is returned, l is rearranged to avoid cancellation for small
+   moduli. */
+static nr_double_t ellip_lognome (nr_double_t k, nr_double_t kp) {
+  nr_double_t r = sqrt (kp);
+  nr_double_t l = k * k / (2 * (1 + kp) * (1 + r) * (1 + r));
+  nr_double_t l4 = l * l; l4 *= l4;
+  nr_double_t s = l4 * (2 + l4 * (15 + l4 * (150 + l4 * 1707)));
+  return log (l) + log1p (s);
+}
+
+/* The function computes the ratio K(k)/K'(k) of the complete elliptic
+   integrals of the first kind of the modulus k and the complementary
+   modulus k' = sqrt (1 - k^2), which is -pi / ln (q) by the nome q.
+   The series of the nome is used for k <= 1/sqrt(2) only, where
+   l < 0.044 and the truncated terms are below 1e-23 relative.  Above
+   the ratio follows by symmetry from k'.  The relative error is a few
+   ulps, compared to two AGM evaluations of the integrals. */
+nr_double_t fspecial::ellip_kratio (nr_double_t k) {
+  nr_double_t kp = sqrt ((1 - k) * (1 + k));
+  if (k <= kp) {
+    if (k == 0) return 0;
+    return -M_PI / ellip_lognome (k, kp);
+  }
+  if (kp == 0) return std::numeric_limits<nr_double_t>::infinity();
+  return -ellip_lognome (kp, k) / M_PI;
+}
+
 const nr_double_t SN_ACC = 1e-5;	// Accuracy of sn(x) is SN_ACC^2
 const nr_double_t K_ERR  = 1e-8;	// Accuracy of K(k)
 
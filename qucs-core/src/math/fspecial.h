@@ -39,6 +39,7 @@ namespace fspecial {
   nr_double_t      i0 (nr_double_t);
 
   void        ellip_ke (nr_double_t, nr_double_t&, nr_double_t&);
+  nr_double_t ellip_kratio (nr_double_t);
   nr_double_t ellip_rf (nr_double_t, nr_double_t, nr_double_t);
   nr_double_t ellip_sncndn (nr_double_t, nr_double_t,
 			    nr_double_t&, nr_double_t&, nr_double_t&);
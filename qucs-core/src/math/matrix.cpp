@@ -90,6 +90,7 @@
 #include <cstdlib>
 #include <string.h>
 #include <cmath>
+#include <utility>
 
 #include "logging.h"
 #include "object.h"
@@ -179,6 +180,36 @@ const matrix& matrix::operator=(const matrix & m) {
   return *this;
 }
 
+/*!\brief Move constructor
+
+   The move constructor takes over the element storage of the given
+   temporary matrix which is left empty.
+*/
+matrix::matrix (matrix && m) {
+  rows = m.rows;
+  cols = m.cols;
+  data = m.data;
+  m.rows = m.cols = 0;
+  m.data = NULL;
+}
+
+/*!\brief Move assignment operator
+
+  Swaps the element storage with the given temporary matrix which
+  releases the previous elements on destruction.
+
+  \param[in] m object to move from
+  \return assigned object
+*/
+matrix& matrix::operator=(matrix && m) {
+  if (&m != this) {
+    std::swap (rows, m.rows);
+    std::swap (cols, m.cols);
+    std::swap (data, m.data);
+  }
+  return *this;
+}
+
 /*!\brief Destructor
 
    Destructor deletes a matrix object.
@@ -193,7 +224,7 @@ matrix::~matrix () {
    \todo Why not inline and synonymous of ()
    \todo c and r const
 */
-nr_complex_t matrix::get (int r, int c) {
+nr_complex_t matrix::get (int r, int c) const {
   return data[r * cols + c];
 }
 
@@ -225,9 +256,8 @@ void matrix::print (void) {
    \param[a] first matrix
    \param[b] second matrix
    \note assert same size
-   \todo a and b are const
 */
-matrix operator + (matrix a, matrix b) {
+matrix operator + (const matrix & a, const matrix & b) {
   assert (a.getRows () == b.getRows () && a.getCols () == b.getCols ());
 
   matrix res (a.getRows (), a.getCols ());
@@ -240,9 +270,8 @@ matrix operator + (matrix a, matrix b) {
 /*!\brief Intrinsic matrix addition.
    \param[in] a matrix to add
    \note assert same size
-   \todo a is const
 */
-matrix matrix::operator += (matrix a) {
+matrix& matrix::operator += (const matrix & a) {
   assert (a.getRows () == rows && a.getCols () == cols);
 
   int r, c, i;
@@ -256,9 +285,8 @@ matrix matrix::operator += (matrix a) {
    \param[a] first matrix
    \param[b] second matrix
    \note assert same size
-   \todo a and b are const
 */
-matrix operator - (matrix a, matrix b) {
+matrix operator - (const matrix & a, const matrix & b) {
   assert (a.getRows () == b.getRows () && a.getCols () == b.getCols ());
 
   matrix res (a.getRows (), a.getCols ());
@@ -282,7 +310,7 @@ matrix matrix::operator - () {
    \param[in] a matrix to substract
    \note assert same size
 */
-matrix matrix::operator -= (matrix a) {
+matrix& matrix::operator -= (const matrix & a) {
   assert (a.getRows () == rows && a.getCols () == cols);
   int r, c, i;
   for (i = 0, r = 0; r < a.getRows (); r++)
@@ -298,11 +326,8 @@ matrix matrix::operator -= (matrix a) {
    \todo Why not a and z const
 */
 matrix operator * (matrix a, nr_complex_t z) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, a.get (r, c) * z);
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] *= z;
+  return a;
 }
 
 /*!\brief Matrix scaling complex version (different order)
@@ -313,7 +338,8 @@ matrix operator * (matrix a, nr_complex_t z) {
    \todo Why not inline
 */
 matrix operator * (nr_complex_t z, matrix a) {
-  return a * z;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] *= z;
+  return a;
 }
 
 /*!\brief Matrix scaling complex version
@@ -323,11 +349,8 @@ matrix operator * (nr_complex_t z, matrix a) {
    \todo Why not d and a const
 */
 matrix operator * (matrix a, nr_double_t d) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, a.get (r, c) * d);
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] *= d;
+  return a;
 }
 
 /*!\brief Matrix scaling real version (different order)
@@ -338,7 +361,8 @@ matrix operator * (matrix a, nr_double_t d) {
    \todo Why not d and a const
 */
 matrix operator * (nr_double_t d, matrix a) {
-  return a * d;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] *= d;
+  return a;
 }
 
 /*!\brief Matrix scaling division by complex version
@@ -348,11 +372,8 @@ matrix operator * (nr_double_t d, matrix a) {
    \todo Why not a and z const
 */
 matrix operator / (matrix a, nr_complex_t z) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, a.get (r, c) / z);
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] /= z;
+  return a;
 }
 
 /*!\brief Matrix scaling division by real version
@@ -362,11 +383,8 @@ matrix operator / (matrix a, nr_complex_t z) {
    \todo Why not a and d const
 */
 matrix operator / (matrix a, nr_double_t d) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, a.get (r, c) / d);
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] /= d;
+  return a;
 }
 
 /*! Matrix multiplication.
@@ -375,9 +393,8 @@ matrix operator / (matrix a, nr_double_t d) {
     \param[a] first matrix
     \param[b] second matrix
     \note assert compatibility
-    \todo a and b are const
 */
-matrix operator * (matrix a, matrix b) {
+matrix operator * (const matrix & a, const matrix & b) {
   assert (a.getCols () == b.getRows ());
 
   int r, c, i, n = a.getCols ();
@@ -399,11 +416,8 @@ matrix operator * (matrix a, matrix b) {
    \todo a and z are const
 */
 matrix operator + (matrix a, nr_complex_t z) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, a.get (r, c) + z);
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] += z;
+  return a;
 }
 
 /*!\brief Complex scalar addition different order.
@@ -414,7 +428,8 @@ matrix operator + (matrix a, nr_complex_t z) {
    \todo Why not inline
 */
 matrix operator + (nr_complex_t z, matrix a) {
-  return a + z;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] += z;
+  return a;
 }
 
 /*!\brief Real scalar addition.
@@ -424,11 +439,8 @@ matrix operator + (nr_complex_t z, matrix a) {
    \todo a and d are const
 */
 matrix operator + (matrix a, nr_double_t d) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, a.get (r, c) + d);
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] += d;
+  return a;
 }
 
 /*!\brief Real scalar addition different order.
@@ -439,7 +451,8 @@ matrix operator + (matrix a, nr_double_t d) {
    \todo Why not inline
 */
 matrix operator + (nr_double_t d, matrix a) {
-  return a + d;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] += d;
+  return a;
 }
 
 /*!\brief Complex scalar substraction
@@ -450,7 +463,8 @@ matrix operator + (nr_double_t d, matrix a) {
    \todo Why not inline
 */
 matrix operator - (matrix a, nr_complex_t z) {
-  return -z + a;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] -= z;
+  return a;
 }
 
 /*!\brief Complex scalar substraction different order
@@ -461,7 +475,8 @@ matrix operator - (matrix a, nr_complex_t z) {
    \todo Why not inline
 */
 matrix operator - (nr_complex_t z, matrix a) {
-  return -a + z;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] = z - a.data[i];
+  return a;
 }
 
 /*!\brief Real scalar substraction
@@ -472,7 +487,8 @@ matrix operator - (nr_complex_t z, matrix a) {
    \todo Why not inline
 */
 matrix operator - (matrix a, nr_double_t d) {
-  return -d + a;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] -= d;
+  return a;
 }
 
 /*!\brief Real scalar substraction different order
@@ -483,15 +499,15 @@ matrix operator - (matrix a, nr_double_t d) {
    \todo Why not inline
 */
 matrix operator - (nr_double_t d, matrix a) {
-  return -a + d;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] = d - a.data[i];
+  return a;
 }
 
 /*!\brief Matrix transposition
    \param[in] a Matrix to transpose
    \todo add transpose in place
-   \todo a is const
 */
-matrix transpose (matrix a) {
+matrix transpose (const matrix & a) {
   matrix res (a.getCols (), a.getRows ());
   for (int r = 0; r < a.getRows (); r++)
     for (int c = 0; c < a.getCols (); c++)
@@ -501,15 +517,10 @@ matrix transpose (matrix a) {
 
 /*!\brief Conjugate complex matrix.
   \param[in] a Matrix to conjugate
-  \todo add conj in place
-  \todo a is const
 */
 matrix conj (matrix a) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, conj (a.get (r, c)));
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] = conj (a.data[i]);
+  return a;
 }
 
 /*!\brief adjoint matrix
@@ -519,79 +530,55 @@ matrix conj (matrix a) {
    \param[in] a Matrix to transpose
    \todo add adjoint in place
    \todo Do not lazy and avoid conj and transpose copy
-   \todo a is const
 */
-matrix adjoint (matrix a) {
+matrix adjoint (const matrix & a) {
   return transpose (conj (a));
 }
 
 /*!\brief Computes magnitude of each matrix element.
    \param[in] a matrix
-   \todo add abs in place
-   \todo a is const
 */
 matrix abs (matrix a) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, abs (a.get (r, c)));
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] = abs (a.data[i]);
+  return a;
 }
 
 /*!\brief Computes magnitude in dB of each matrix element.
    \param[in] a matrix
 */
 matrix dB (matrix a) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, dB (a.get (r, c)));
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] = dB (a.data[i]);
+  return a;
 }
 
 /*!\brief Computes the argument of each matrix element.
    \param[in] a matrix
-   \todo add arg in place
-   \todo a is const
 */
 matrix arg (matrix a) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, arg (a.get (r, c)));
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] = arg (a.data[i]);
+  return a;
 }
 
 /*!\brief Real part matrix.
    \param[in] a matrix
-   \todo add real in place
-   \todo a is const
 */
 matrix real (matrix a) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, real (a.get (r, c)));
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] = real (a.data[i]);
+  return a;
 }
 
 /*!\brief Imaginary part matrix.
    \param[in] a matrix
-   \todo add imag in place
-   \todo a is const
 */
 matrix imag (matrix a) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, imag (a.get (r, c)));
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] = imag (a.data[i]);
+  return a;
 }
 
 /*!\brief Multiply a matrix by itself
    \param[in] a matrix
 */
-matrix sqr (matrix a) {
+matrix sqr (const matrix & a) {
   return a * a;
 }
 
@@ -623,7 +610,7 @@ matrix eye (int s) {
    \param[in] diag vector to write on the diagonal
    \todo diag is const
 */
-matrix diagonal (qucs::vector diag) {
+matrix diagonal (const qucs::vector & diag) {
   int size = diag.getSize ();
   matrix res (size);
   for (int i = 0; i < size; i++) res (i, i) = diag (i);
@@ -656,7 +643,7 @@ matrix pow (matrix a, int n) {
    \todo #ifdef 0
    \todo static?
 */
-nr_complex_t cofactor (matrix a, int u, int v) {
+nr_complex_t cofactor (const matrix & a, int u, int v) {
   matrix res (a.getRows () - 1, a.getCols () - 1);
   int r, c, ra, ca;
   for (ra = r = 0; r < res.getRows (); r++, ra++) {
@@ -685,7 +672,7 @@ nr_complex_t cofactor (matrix a, int u, int v) {
    \todo #ifdef 0
    \todo static ?
 */
-nr_complex_t detLaplace (matrix a) {
+nr_complex_t detLaplace (const matrix & a) {
   assert (a.getRows () == a.getCols ());
   int s = a.getRows ();
   nr_complex_t res = 0;
@@ -714,9 +701,8 @@ nr_complex_t detLaplace (matrix a) {
    \param[in] a matrix
    \note assert square matrix
    \todo static ?
-   \todo a const?
    */
-nr_complex_t detGauss (matrix a) {
+nr_complex_t detGauss (const matrix & a) {
   assert (a.getRows () == a.getCols ());
   nr_double_t MaxPivot;
   nr_complex_t f, res;
@@ -759,9 +745,8 @@ nr_complex_t detGauss (matrix a) {
 /*!\brief Compute determinant of the given matrix.
    \param[in] a matrix
    \return Complex determinant
-   \todo a const?
 */
-nr_complex_t det (matrix a) {
+nr_complex_t det (const matrix & a) {
 #if 0
   return detLaplace (a);
 #else
@@ -775,10 +760,9 @@ nr_complex_t det (matrix a) {
   \param[in] a matrix to invert
   \todo Static?
   \bug recursive! Stack overflow
-  \todo a const?
   \todo #ifdef 0
 */
-matrix inverseLaplace (matrix a) {
+matrix inverseLaplace (const matrix & a) {
   matrix res (a.getRows (), a.getCols ());
   nr_complex_t d = detLaplace (a);
   assert (abs (d) != 0); // singular matrix
@@ -792,12 +776,11 @@ matrix inverseLaplace (matrix a) {
 
    Compute inverse matrix of the given matrix by Gauss-Jordan
    elimination.
-   \todo a const?
    \todo static?
    \note assert non singulat matix
    \param[in] a matrix to invert
 */
-matrix inverseGaussJordan (matrix a) {
+matrix inverseGaussJordan (const matrix & a) {
   nr_double_t MaxPivot;
   nr_complex_t f;
   matrix b, e;
@@ -844,9 +827,8 @@ matrix inverseGaussJordan (matrix a) {
 
 /*!\brief Compute inverse matrix
    \param[in] a matrix to invert
-   \todo a is const
 */
-matrix inverse (matrix a) {
+matrix inverse (const matrix & a) {
 #if 0
   return inverseLaplace (a);
 #else
@@ -890,7 +872,7 @@ matrix inverse (matrix a) {
   \return Renormalized scattering matrix
   \todo s, zref and z0 const
 */
-matrix stos (matrix s, qucs::vector zref, qucs::vector z0) {
+matrix stos (const matrix & s, const qucs::vector & zref, const qucs::vector & z0) {
   int d = s.getRows ();
   matrix e, r;
   qucs::vector a;
@@ -911,7 +893,7 @@ matrix stos (matrix s, qucs::vector zref, qucs::vector z0) {
    \return Renormalized scattering matrix
    \todo s, zref and z0 const
 */
-matrix stos (matrix s, nr_complex_t zref, nr_complex_t z0) {
+matrix stos (const matrix & s, nr_complex_t zref, nr_complex_t z0) {
   int d = s.getRows ();
   return stos (s, qucs::vector (d, zref), qucs::vector (d, z0));
 }
@@ -924,7 +906,7 @@ matrix stos (matrix s, nr_complex_t zref, nr_complex_t z0) {
   \return Renormalized scattering matrix
   \todo s, zref and z0 const
 */
-matrix stos (matrix s, nr_double_t zref, nr_double_t z0) {
+matrix stos (const matrix & s, nr_double_t zref, nr_double_t z0) {
   return stos (s, nr_complex_t (zref, 0), nr_complex_t (z0, 0));
 }
 
@@ -936,7 +918,7 @@ matrix stos (matrix s, nr_double_t zref, nr_double_t z0) {
    \return Renormalized scattering matrix
    \todo s, zref and z0 const
 */
-matrix stos (matrix s, qucs::vector zref, nr_complex_t z0) {
+matrix stos (const matrix & s, const qucs::vector & zref, nr_complex_t z0) {
   return stos (s, zref, qucs::vector (zref.getSize (), z0));
 }
 
@@ -948,7 +930,7 @@ matrix stos (matrix s, qucs::vector zref, nr_complex_t z0) {
   \todo s, zref and z0 const
   \return Renormalized scattering matrix
 */
-matrix stos (matrix s, nr_complex_t zref, qucs::vector z0) {
+matrix stos (const matrix & s, nr_complex_t zref, const qucs::vector & z0) {
   return stos (s, qucs::vector (z0.getSize (), zref), z0);
 }
 
@@ -974,7 +956,7 @@ matrix stos (matrix s, nr_complex_t zref, qucs::vector z0) {
   \todo s, z0 const
   \return Impedance matrix
 */
-matrix stoz (matrix s, qucs::vector z0) {
+matrix stoz (const matrix & s, const qucs::vector & z0) {
   int d = s.getRows ();
   matrix e, zref, gref;
 
@@ -993,7 +975,7 @@ matrix stoz (matrix s, qucs::vector z0) {
    \todo Why not inline?
    \todo s and z0 const?
 */
-matrix stoz (matrix s, nr_complex_t z0) {
+matrix stoz (const matrix & s, nr_complex_t z0) {
   return stoz (s, qucs::vector (s.getRows (), z0));
 }
 
@@ -1019,7 +1001,7 @@ matrix stoz (matrix s, nr_complex_t z0) {
   \bug not correct if zref is complex
   \todo z and z0 const?
 */
-matrix ztos (matrix z, qucs::vector z0) {
+matrix ztos (const matrix & z, const qucs::vector & z0) {
   int d = z.getRows ();
   matrix e, zref, gref;
 
@@ -1038,7 +1020,7 @@ matrix ztos (matrix z, qucs::vector z0) {
    \todo Why not inline
    \todo z and z0 const
  */
-matrix ztos (matrix z, nr_complex_t z0) {
+matrix ztos (const matrix & z, nr_complex_t z0) {
   return ztos (z, qucs::vector (z.getRows (), z0));
 }
 
@@ -1049,9 +1031,8 @@ matrix ztos (matrix z, nr_complex_t z0) {
    \param[in] z impedance matrix
    \return Admittance matrix
    \todo Why not inline
-   \todo z const
 */
-matrix ztoy (matrix z) {
+matrix ztoy (const matrix & z) {
   assert (z.getRows () == z.getCols ());
   return inverse (z);
 }
@@ -1083,7 +1064,7 @@ matrix ztoy (matrix z) {
   \todo s and z0 const
   \return Admittance matrix
 */
-matrix stoy (matrix s, qucs::vector z0) {
+matrix stoy (const matrix & s, const qucs::vector & z0) {
   int d = s.getRows ();
   matrix e, zref, gref;
 
@@ -1102,7 +1083,7 @@ matrix stoy (matrix s, qucs::vector z0) {
    \todo Why not inline
    \todo s and z0 const
  */
-matrix stoy (matrix s, nr_complex_t z0) {
+matrix stoy (const matrix & s, nr_complex_t z0) {
   return stoy (s, qucs::vector (s.getRows (), z0));
 }
 
@@ -1134,7 +1115,7 @@ matrix stoy (matrix s, nr_complex_t z0) {
    \todo why not y and z0 const
    \return Scattering matrix
 */
-matrix ytos (matrix y, qucs::vector z0) {
+matrix ytos (const matrix & y, const qucs::vector & z0) {
   int d = y.getRows ();
   matrix e, zref, gref;
 
@@ -1152,7 +1133,7 @@ matrix ytos (matrix y, qucs::vector z0) {
    \todo Why not inline
    \todo y and z0 const
  */
-matrix ytos (matrix y, nr_complex_t z0) {
+matrix ytos (const matrix & y, nr_complex_t z0) {
   return ytos (y, qucs::vector (y.getRows (), z0));
 }
 /*!\brief Converts chain matrix to scattering parameters.
@@ -1182,7 +1163,7 @@ matrix ytos (matrix y, nr_complex_t z0) {
     \note Assert 2 by 2 matrix
     \todo Why not s,z1,z2 const
 */
-matrix stoa (matrix s, nr_complex_t z1, nr_complex_t z2) {
+matrix stoa (const matrix & s, nr_complex_t z1, nr_complex_t z2) {
   nr_complex_t d = s (0, 0) * s (1, 1) - s (0, 1) * s (1, 0);
   nr_complex_t n = 2.0 * s (1, 0) * sqrt (fabs (real (z1) * real (z2)));
   matrix a (2);
@@ -1223,7 +1204,7 @@ matrix stoa (matrix s, nr_complex_t z1, nr_complex_t z2) {
     \bug Do not use fabs
     \todo a, z1, z2 const
 */
-matrix atos (matrix a, nr_complex_t z1, nr_complex_t z2) {
+matrix atos (const matrix & a, nr_complex_t z1, nr_complex_t z2) {
   nr_complex_t d = 2.0 * sqrt (fabs (real (z1) * real (z2)));
   nr_complex_t n = a (0, 0) * z2 + a (0, 1) +
     a (1, 0) * z1 * z2 + a (1, 1) * z1;
@@ -1270,7 +1251,7 @@ matrix atos (matrix a, nr_complex_t z1, nr_complex_t z2) {
     \note Assert 2 by 2 matrix
     \todo Why not s,z1,z2 const
  */
-matrix stoh (matrix s, nr_complex_t z1, nr_complex_t z2) {
+matrix stoh (const matrix & s, nr_complex_t z1, nr_complex_t z2) {
   nr_complex_t n = s (0, 1) * s (1, 0);
   nr_complex_t d = (1.0 - s (0, 0)) * (1.0 + s (1, 1)) + n;
   matrix h (2);
@@ -1308,7 +1289,7 @@ matrix stoh (matrix s, nr_complex_t z1, nr_complex_t z2) {
    \note Assert 2 by 2 matrix
    \todo Why not h,z1,z2 const
 */
-matrix htos (matrix h, nr_complex_t z1, nr_complex_t z2) {
+matrix htos (const matrix & h, nr_complex_t z1, nr_complex_t z2) {
   nr_complex_t n = h (0, 1) * h (1, 0);
   nr_complex_t d = (1.0 + h (0, 0) / z1) * (1.0 + z2 * h (1, 1)) - n;
   matrix s (2);
@@ -1332,7 +1313,7 @@ matrix htos (matrix h, nr_complex_t z1, nr_complex_t z2) {
   \note Assert 2 by 2 matrix
   \todo Why not s,z1,z2 const
 */
-matrix stog (matrix s, nr_complex_t z1, nr_complex_t z2) {
+matrix stog (const matrix & s, nr_complex_t z1, nr_complex_t z2) {
   nr_complex_t n = s (0, 1) * s (1, 0);
   nr_complex_t d = (1.0 + s (0, 0)) * (1.0 - s (1, 1)) + n;
   matrix g (2);
@@ -1356,7 +1337,7 @@ matrix stog (matrix s, nr_complex_t z1, nr_complex_t z2) {
   \note Assert 2 by 2 matrix
   \todo Why not g,z1,z2 const
 */
-matrix gtos (matrix g, nr_complex_t z1, nr_complex_t z2) {
+matrix gtos (const matrix & g, nr_complex_t z1, nr_complex_t z2) {
   nr_complex_t n = g (0, 1) * g (1, 0);
   nr_complex_t d = (1.0 + g (0, 0) * z1) * (1.0 + g (1, 1) / z2) - n;
   matrix s (2);
@@ -1378,10 +1359,9 @@ matrix gtos (matrix g, nr_complex_t z1, nr_complex_t z2) {
   \return Impedance matrix
   \note Check if y matrix is a square matrix
   \todo Why not inline
-  \todo y const
   \todo move near ztoy()
 */
-matrix ytoz (matrix y) {
+matrix ytoz (const matrix & y) {
   assert (y.getRows () == y.getCols ());
   return inverse (y);
 }
@@ -1403,9 +1383,8 @@ matrix ytoz (matrix y) {
    \param[in] s S parameter matrix of device
    \return S-parameter noise correlation matrix
    \note Assert compatiblity of matrix
-   \todo cy s const
 */
-matrix cytocs (matrix cy, matrix s) {
+matrix cytocs (const matrix & cy, const matrix & s) {
   matrix e = eye (s.getRows ());
 
   assert (cy.getRows () == cy.getCols () && s.getRows () == s.getCols () &&
@@ -1429,9 +1408,8 @@ matrix cytocs (matrix cy, matrix s) {
     \param[in]  cs S parameter noise correlation
     \param[in] y Admittance matrix of device
     \return admittance noise correlation matrix
-    \todo cs, y const
 */
-matrix cstocy (matrix cs, matrix y) {
+matrix cstocy (const matrix & cs, const matrix & y) {
   matrix e = eye (y.getRows ());
 
   assert (cs.getRows () == cs.getCols () && y.getRows () == y.getCols () &&
@@ -1456,9 +1434,8 @@ matrix cstocy (matrix cs, matrix y) {
    \param[in] s S parameter matrix of device
    \return S-parameter noise correlation matrix
    \note Assert compatiblity of matrix
-   \todo cz, s const
 */
-matrix cztocs (matrix cz, matrix s) {
+matrix cztocs (const matrix & cz, const matrix & s) {
   matrix e = eye (s.getRows ());
 
   assert (cz.getRows () == cz.getCols () && s.getRows () == s.getCols () &&
@@ -1482,9 +1459,8 @@ matrix cztocs (matrix cz, matrix s) {
     \param[in]  cs S parameter noise correlation
     \param[in] z Impedance matrix of device
     \return Impedance noise correlation matrix
-    \todo cs, z const
 */
-matrix cstocz (matrix cs, matrix z) {
+matrix cstocz (const matrix & cs, const matrix & z) {
   assert (cs.getRows () == cs.getCols () && z.getRows () == z.getCols () &&
 	  cs.getRows () == z.getRows ());
   matrix e = eye (z.getRows ());
@@ -1506,9 +1482,8 @@ matrix cstocz (matrix cs, matrix z) {
     \param[in]  cz impedance noise correlation
     \param[in]  y Admittance matrix of device
     \return admittance noise correlation matrix
-    \todo cs, y const
 */
-matrix cztocy (matrix cz, matrix y) {
+matrix cztocy (const matrix & cz, const matrix & y) {
   assert (cz.getRows () == cz.getCols () && y.getRows () == y.getCols () &&
 	  cz.getRows () == y.getRows ());
 
@@ -1530,9 +1505,8 @@ matrix cztocy (matrix cz, matrix y) {
     \param[in]  cy Admittance noise correlation
     \param[in]  z Impedance matrix of device
     \return Impedance noise correlation matrix
-    \todo cs, z const
 */
-matrix cytocz (matrix cy, matrix z) {
+matrix cytocz (const matrix & cy, const matrix & z) {
   assert (cy.getRows () == cy.getCols () && z.getRows () == z.getCols () &&
 	  cy.getRows () == z.getRows ());
   return z * cy * adjoint (z);
@@ -1649,7 +1623,7 @@ matrix matrix::getBottomRightCorner(int p, int q) {
   \return matrix with assigned submatrix portion
   \todo check that (p+i)<rows and (q+j)<cols?
 */
-void matrix::setBlock(matrix m, int i, int j, int p, int q) {
+void matrix::setBlock(const matrix & m, int i, int j, int p, int q) {
   // copy matrix elements
   for (int r = 0; r < p; r++) {
     for (int c = 0; c < q; c++) {
@@ -1666,7 +1640,7 @@ void matrix::setBlock(matrix m, int i, int j, int p, int q) {
   \param[in] q number of columns to assign
   \return matrix with assigned submatrix portion
 */
-void matrix::setTopLeftCorner(matrix m, int p, int q) {
+void matrix::setTopLeftCorner(const matrix & m, int p, int q) {
   setBlock(m, 0, 0, p, q);
 }
 
@@ -1678,7 +1652,7 @@ void matrix::setTopLeftCorner(matrix m, int p, int q) {
   \param[in] q number of columns to assign
   \return matrix with assigned submatrix portion
 */
-void matrix::setBottomLeftCorner(matrix m, int p, int q) {
+void matrix::setBottomLeftCorner(const matrix & m, int p, int q) {
   setBlock(m, getRows()-p, 0, p, q);
 }
 
@@ -1690,7 +1664,7 @@ void matrix::setBottomLeftCorner(matrix m, int p, int q) {
   \param[in] q number of columns to assign
   \return matrix with assigned submatrix portion
 */
-void matrix::setTopRightCorner(matrix m, int p, int q) {
+void matrix::setTopRightCorner(const matrix & m, int p, int q) {
   setBlock(m, 0, getCols()-q, p, q);
 }
 
@@ -1702,7 +1676,7 @@ void matrix::setTopRightCorner(matrix m, int p, int q) {
   \param[in] q number of columns to assign
   \return matrix with assigned submatrix portion
 */
-void matrix::setBottomRightCorner(matrix m, int p, int q) {
+void matrix::setBottomRightCorner(const matrix & m, int p, int q) {
   setBlock(m, getRows()-p, getCols()-q, p, q);
 }
 
@@ -1727,7 +1701,7 @@ void matrix::setBottomRightCorner(matrix m, int p, int q) {
   \return matrix given by format out
   \todo m, in, out const
 */
-matrix twoport (matrix m, char in, char out) {
+matrix twoport (const matrix & m, char in, char out) {
   assert (m.getRows () >= 2 && m.getCols () >= 2);
   nr_complex_t d;
   matrix res (2);
@@ -1984,10 +1958,9 @@ matrix twoport (matrix m, char in, char out) {
    \param[in] m S parameter matrix
    \return Rollet factor
    \note Assert 2x2 matrix
-   \todo m const?
    \todo Rewrite with abs and expand det. It is cleaner.
 */
-nr_double_t rollet (matrix m) {
+nr_double_t rollet (const matrix & m) {
   assert (m.getRows () >= 2 && m.getCols () >= 2);
   nr_double_t res;
   res = (1 - norm (m (0, 0)) - norm (m (1, 1)) + norm (det (m))) /
@@ -1996,7 +1969,7 @@ nr_double_t rollet (matrix m) {
 }
 
 /* Computes stability measure B1 of the given S-parameter matrix. */
-nr_double_t b1 (matrix m) {
+nr_double_t b1 (const matrix & m) {
   assert (m.getRows () >= 2 && m.getCols () >= 2);
   nr_double_t res;
   res = 1 + norm (m (0, 0)) - norm (m (1, 1)) - norm (det (m));
@@ -2005,19 +1978,13 @@ nr_double_t b1 (matrix m) {
 
 
 matrix rad2deg (matrix a) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, rad2deg (a.get (r, c)));
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] = rad2deg (a.data[i]);
+  return a;
 }
 
 matrix deg2rad (matrix a) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, deg2rad (a.get (r, c)));
-  return res;
+  for (int i = 0; i < a.rows * a.cols; i++) a.data[i] = deg2rad (a.data[i]);
+  return a;
 }
 
 } // namespace qucs
@@ -36,55 +36,55 @@ class vector;
 class matrix;
 
 matrix eye (int);
-matrix transpose (matrix);
+matrix transpose (const matrix &);
 matrix conj (matrix);
 matrix abs (matrix);
 matrix dB (matrix);
 matrix arg (matrix);
-matrix adjoint (matrix);
+matrix adjoint (const matrix &);
 matrix real (matrix);
 matrix imag (matrix);
-matrix sqr (matrix);
+matrix sqr (const matrix &);
 matrix eye (int, int);
-matrix diagonal (vector);
+matrix diagonal (const vector &);
 matrix pow (matrix, int);
-nr_complex_t cofactor (matrix, int, int);
-nr_complex_t detLaplace (matrix);
-nr_complex_t detGauss (matrix);
-nr_complex_t det (matrix);
-matrix inverseLaplace (matrix);
-matrix inverseGaussJordan (matrix);
-matrix inverse (matrix);
-matrix stos (matrix, nr_complex_t, nr_complex_t z0 = 50.0);
-matrix stos (matrix, nr_double_t, nr_double_t z0 = 50.0);
-matrix stos (matrix, vector, nr_complex_t z0 = 50.0);
-matrix stos (matrix, nr_complex_t, vector);
-matrix stos (matrix, vector, vector);
-matrix stoz (matrix, nr_complex_t z0 = 50.0);
-matrix stoz (matrix, vector);
-matrix ztos (matrix, nr_complex_t z0 = 50.0);
-matrix ztos (matrix, vector);
-matrix ztoy (matrix);
-matrix stoy (matrix, nr_complex_t z0 = 50.0);
-matrix stoy (matrix, vector);
-matrix ytos (matrix, nr_complex_t z0 = 50.0);
-matrix ytos (matrix, vector);
-matrix ytoz (matrix);
-matrix stoa (matrix, nr_complex_t z1 = 50.0, nr_complex_t z2 = 50.0);
-matrix atos (matrix, nr_complex_t z1 = 50.0, nr_complex_t z2 = 50.0);
-matrix stoh (matrix, nr_complex_t z1 = 50.0, nr_complex_t z2 = 50.0);
-matrix htos (matrix, nr_complex_t z1 = 50.0, nr_complex_t z2 = 50.0);
-matrix stog (matrix, nr_complex_t z1 = 50.0, nr_complex_t z2 = 50.0);
-matrix gtos (matrix, nr_complex_t z1 = 50.0, nr_complex_t z2 = 50.0);
-matrix cytocs (matrix, matrix);
-matrix cztocs (matrix, matrix);
-matrix cztocy (matrix, matrix);
-matrix cstocy (matrix, matrix);
-matrix cytocz (matrix, matrix);
-matrix cstocz (matrix, matrix);
-matrix twoport (matrix, char, char);
-nr_double_t rollet (matrix);
-nr_double_t b1 (matrix);
+nr_complex_t cofactor (const matrix &, int, int);
+nr_complex_t detLaplace (const matrix &);
+nr_complex_t detGauss (const matrix &);
+nr_complex_t det (const matrix &);
+matrix inverseLaplace (const matrix &);
+matrix inverseGaussJordan (const matrix &);
+matrix inverse (const matrix &);
+matrix stos (const matrix &, nr_complex_t, nr_complex_t z0 = 50.0);
+matrix stos (const matrix &, nr_double_t, nr_double_t z0 = 50.0);
+matrix stos (const matrix &, const vector &, nr_complex_t z0 = 50.0);
+matrix stos (const matrix &, nr_complex_t, const vector &);
+matrix stos (const matrix &, const vector &, const vector &);
+matrix stoz (const matrix &, nr_complex_t z0 = 50.0);
+matrix stoz (const matrix &, const vector &);
+matrix ztos (const matrix &, nr_complex_t z0 = 50.0);
+matrix ztos (const matrix &, const vector &);
+matrix ztoy (const matrix &);
+matrix stoy (const matrix &, nr_complex_t z0 = 50.0);
+matrix stoy (const matrix &, const vector &);
+matrix ytos (const matrix &, nr_complex_t z0 = 50.0);
+matrix ytos (const matrix &, const vector &);
+matrix ytoz (const matrix &);
+matrix stoa (const matrix &, nr_complex_t z1 = 50.0, nr_complex_t z2 = 50.0);
+matrix atos (const matrix &, nr_complex_t z1 = 50.0, nr_complex_t z2 = 50.0);
+matrix stoh (const matrix &, nr_complex_t z1 = 50.0, nr_complex_t z2 = 50.0);
+matrix htos (const matrix &, nr_complex_t z1 = 50.0, nr_complex_t z2 = 50.0);
+matrix stog (const matrix &, nr_complex_t z1 = 50.0, nr_complex_t z2 = 50.0);
+matrix gtos (const matrix &, nr_complex_t z1 = 50.0, nr_complex_t z2 = 50.0);
+matrix cytocs (const matrix &, const matrix &);
+matrix cztocs (const matrix &, const matrix &);
+matrix cztocy (const matrix &, const matrix &);
+matrix cstocy (const matrix &, const matrix &);
+matrix cytocz (const matrix &, const matrix &);
+matrix cstocz (const matrix &, const matrix &);
+matrix twoport (const matrix &, char, char);
+nr_double_t rollet (const matrix &);
+nr_double_t b1 (const matrix &);
 matrix rad2deg     (matrix);
 matrix deg2rad     (matrix);
 
@@ -100,24 +100,27 @@ class matrix
   matrix (int);
   matrix (int, int);
   matrix (const matrix &);
+  matrix (matrix &&);
   const matrix& operator = (const matrix &);
+  matrix& operator = (matrix &&);
   ~matrix ();
-  nr_complex_t get (int, int);
+  nr_complex_t get (int, int) const;
   void set (int, int, nr_complex_t);
-  int getCols (void) { return cols; }
-  int getRows (void) { return rows; }
+  int getCols (void) const { return cols; }
+  int getRows (void) const { return rows; }
   nr_complex_t * getData (void) { return data; }
+  const nr_complex_t * getData (void) const { return data; }
   void print (void);
   void exchangeRows (int, int);
   void exchangeCols (int, int);
 
   // operator functions
-  friend matrix operator + (matrix, matrix);
+  friend matrix operator + (const matrix &, const matrix &);
   friend matrix operator + (nr_complex_t, matrix);
   friend matrix operator + (matrix, nr_complex_t);
   friend matrix operator + (nr_double_t, matrix);
   friend matrix operator + (matrix, nr_double_t);
-  friend matrix operator - (matrix, matrix);
+  friend matrix operator - (const matrix &, const matrix &);
   friend matrix operator - (nr_complex_t, matrix);
   friend matrix operator - (matrix, nr_complex_t);
   friend matrix operator - (nr_double_t, matrix);
@@ -128,12 +131,12 @@ class matrix
   friend matrix operator * (matrix, nr_complex_t);
   friend matrix operator * (nr_double_t, matrix);
   friend matrix operator * (matrix, nr_double_t);
-  friend matrix operator * (matrix, matrix);
+  friend matrix operator * (const matrix &, const matrix &);
 
   // intrinsic operator functions
   matrix operator  - ();
-  matrix operator += (matrix);
-  matrix operator -= (matrix);
+  matrix& operator += (const matrix &);
+  matrix& operator -= (const matrix &);
 
   // block operations
   matrix getBlock(int, int, int, int);
@@ -141,63 +144,63 @@ class matrix
   matrix getBottomLeftCorner(int, int);
   matrix getTopRightCorner(int, int);
   matrix getBottomRightCorner(int, int);
-  void setBlock(matrix, int, int, int, int);
-  void setTopLeftCorner(matrix, int, int);
-  void setBottomLeftCorner(matrix, int, int);
-  void setTopRightCorner(matrix, int, int);
-  void setBottomRightCorner(matrix, int, int);
+  void setBlock(const matrix &, int, int, int, int);
+  void setTopLeftCorner(const matrix &, int, int);
+  void setBottomLeftCorner(const matrix &, int, int);
+  void setTopRightCorner(const matrix &, int, int);
+  void setBottomRightCorner(const matrix &, int, int);
 
   // other operations
-  friend matrix transpose (matrix);
+  friend matrix transpose (const matrix &);
   friend matrix conj (matrix);
   friend matrix abs (matrix);
   friend matrix dB (matrix);
   friend matrix arg (matrix);
-  friend matrix adjoint (matrix);
+  friend matrix adjoint (const matrix &);
   friend matrix real (matrix);
   friend matrix imag (matrix);
-  friend matrix sqr (matrix);
+  friend matrix sqr (const matrix &);
   friend matrix eye (int, int);
-  friend matrix diagonal (qucs::vector);
+  friend matrix diagonal (const qucs::vector &);
   friend matrix pow (matrix, int);
-  friend nr_complex_t cofactor (matrix, int, int);
-  friend nr_complex_t detLaplace (matrix);
-  friend nr_complex_t detGauss (matrix);
-  friend nr_complex_t det (matrix);
-  friend matrix inverseLaplace (matrix);
-  friend matrix inverseGaussJordan (matrix);
-  friend matrix inverse (matrix);
-  friend matrix stos (matrix, nr_complex_t, nr_complex_t);
-  friend matrix stos (matrix, nr_double_t, nr_double_t);
-  friend matrix stos (matrix, qucs::vector, nr_complex_t);
-  friend matrix stos (matrix, nr_complex_t, qucs::vector);
-  friend matrix stos (matrix, qucs::vector, qucs::vector);
-  friend matrix stoz (matrix, nr_complex_t);
-  friend matrix stoz (matrix, qucs::vector);
-  friend matrix ztos (matrix, nr_complex_t);
-  friend matrix ztos (matrix, qucs::vector);
-  friend matrix ztoy (matrix);
-  friend matrix stoy (matrix, nr_complex_t);
-  friend matrix stoy (matrix, qucs::vector);
-  friend matrix ytos (matrix, nr_complex_t);
-  friend matrix ytos (matrix, qucs::vector);
-  friend matrix ytoz (matrix);
-  friend matrix stoa (matrix, nr_complex_t, nr_complex_t);
-  friend matrix atos (matrix, nr_complex_t, nr_complex_t);
-  friend matrix stoh (matrix, nr_complex_t, nr_complex_t);
-  friend matrix htos (matrix, nr_complex_t, nr_complex_t);
-  friend matrix stog (matrix, nr_complex_t, nr_complex_t);
-  friend matrix gtos (matrix, nr_complex_t, nr_complex_t);
-  friend matrix cytocs (matrix, matrix);
-  friend matrix cztocs (matrix, matrix);
-  friend matrix cztocy (matrix, matrix);
-  friend matrix cstocy (matrix, matrix);
-  friend matrix cytocz (matrix, matrix);
-  friend matrix cstocz (matrix, matrix);
-
-  friend matrix twoport (matrix, char, char);
-  friend nr_double_t rollet (matrix);
-  friend nr_double_t b1 (matrix);
+  friend nr_complex_t cofactor (const matrix &, int, int);
+  friend nr_complex_t detLaplace (const matrix &);
+  friend nr_complex_t detGauss (const matrix &);
+  friend nr_complex_t det (const matrix &);
+  friend matrix inverseLaplace (const matrix &);
+  friend matrix inverseGaussJordan (const matrix &);
+  friend matrix inverse (const matrix &);
+  friend matrix stos (const matrix &, nr_complex_t, nr_complex_t);
+  friend matrix stos (const matrix &, nr_double_t, nr_double_t);
+  friend matrix stos (const matrix &, const qucs::vector &, nr_complex_t);
+  friend matrix stos (const matrix &, nr_complex_t, const qucs::vector &);
+  friend matrix stos (const matrix &, const qucs::vector &, const qucs::vector &);
+  friend matrix stoz (const matrix &, nr_complex_t);
+  friend matrix stoz (const matrix &, const qucs::vector &);
+  friend matrix ztos (const matrix &, nr_complex_t);
+  friend matrix ztos (const matrix &, const qucs::vector &);
+  friend matrix ztoy (const matrix &);
+  friend matrix stoy (const matrix &, nr_complex_t);
+  friend matrix stoy (const matrix &, const qucs::vector &);
+  friend matrix ytos (const matrix &, nr_complex_t);
+  friend matrix ytos (const matrix &, const qucs::vector &);
+  friend matrix ytoz (const matrix &);
+  friend matrix stoa (const matrix &, nr_complex_t, nr_complex_t);
+  friend matrix atos (const matrix &, nr_complex_t, nr_complex_t);
+  friend matrix stoh (const matrix &, nr_complex_t, nr_complex_t);
+  friend matrix htos (const matrix &, nr_complex_t, nr_complex_t);
+  friend matrix stog (const matrix &, nr_complex_t, nr_complex_t);
+  friend matrix gtos (const matrix &, nr_complex_t, nr_complex_t);
+  friend matrix cytocs (const matrix &, const matrix &);
+  friend matrix cztocs (const matrix &, const matrix &);
+  friend matrix cztocy (const matrix &, const matrix &);
+  friend matrix cstocy (const matrix &, const matrix &);
+  friend matrix cytocz (const matrix &, const matrix &);
+  friend matrix cstocz (const matrix &, const matrix &);
+
+  friend matrix twoport (const matrix &, char, char);
+  friend nr_double_t rollet (const matrix &);
+  friend nr_double_t b1 (const matrix &);
 
   friend matrix rad2deg    (matrix);
   friend matrix deg2rad    (matrix);
@@ -36,6 +36,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <cmath>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 #include "logging.h"
 #include "object.h"
@@ -43,6 +46,7 @@
 #include "vector.h"
 #include "matrix.h"
 #include "matvec.h"
+#include "threadpool.h"
 
 #if !HAVE_STRCHR
 # define strchr  index
@@ -51,6 +55,9 @@
 
 namespace qucs {
 
+// vectors of matrices with fewer entries are processed in one thread
+#define MATVEC_PARALLEL 65536
+
 /*!\brief Create an empty vector of matrices
 
    Constructor creates an unnamed instance of the matvec class.
@@ -65,7 +72,9 @@ matvec::matvec () {
 /*!\brief Creates a vector of matrices
 
    Constructor creates an unnamed instance of the matvec class with a
-   certain number of empty matrices.
+   certain number of empty matrices.  All of them are stored in one
+   block, the matrices one after the other with their entries in row
+   major order.
    \param[in] length number of matrices in the vector
    \param[in] r number of rows of each matrix
    \param[in] c number of columns of each matrix
@@ -75,12 +84,7 @@ matvec::matvec (int length, int r, int c) {
   rows = r;
   cols = c;
   name = NULL;
-  if (size > 0) {
-    data = new matrix[size];
-    for (int i = 0; i < size; i++) data[i] = matrix (r, c);
-  } else {
-    data = NULL;
-  }
+  data = getEntries () > 0 ? new nr_complex_t[getEntries ()] : NULL;
 }
 
 /*!\brief copy constructor
@@ -96,10 +100,51 @@ matvec::matvec (const matvec & m) {
   data = NULL;
 
   // copy matvec elements
-  if (size > 0) {
-    data = new matrix[size];
-    for (int i = 0; i < size; i++) data[i] = m.data[i];
+  if (getEntries () > 0) {
+    data = new nr_complex_t[getEntries ()];
+    memcpy (data, m.data, sizeof (nr_complex_t) * getEntries ());
+  }
+}
+
+/*!\brief move constructor
+
+   Takes over the matrices of the given temporary matvec object.
+*/
+matvec::matvec (matvec && m) {
+  size = m.size;
+  rows = m.rows;
+  cols = m.cols;
+  name = m.name;
+  data = m.data;
+  m.size = m.rows = m.cols = 0;
+  m.name = NULL;
+  m.data = NULL;
+}
+
+/*!\brief Assignment operator
+
+   Copies the matrices and the name of the given matvec object.
+*/
+matvec & matvec::operator = (const matvec & m) {
+  if (this != &m) {
+    matvec tmp (m);
+    *this = std::move (tmp);
   }
+  return *this;
+}
+
+/*!\brief Move assignment operator
+
+   Swaps the storage with the given temporary matvec object which
+   releases the previous matrices on destruction.
+*/
+matvec & matvec::operator = (matvec && m) {
+  std::swap (size, m.size);
+  std::swap (rows, m.rows);
+  std::swap (cols, m.cols);
+  std::swap (name, m.name);
+  std::swap (data, m.data);
+  return *this;
 }
 
 /*!\brief Destructor
@@ -128,10 +173,11 @@ char * matvec::getName (void) {
 
 /* This function saves the given vector to the matvec object with the
    appropriate matrix indices. */
-void matvec::set (qucs::vector v, int r, int c) {
+void matvec::set (const qucs::vector & v, int r, int c) {
   assert (v.getSize () == size &&
 	  r >= 0 && r < rows && c >= 0 && c < cols);
-  for (int i = 0; i < size; i++) data[i].set (r, c, v.get (i));
+  nr_complex_t * p = data + r * cols + c;
+  for (int i = 0; i < size; i++, p += rows * cols) *p = v (i);
 }
 
 /* The function returns the vector specified by the given matrix
@@ -139,8 +185,9 @@ void matvec::set (qucs::vector v, int r, int c) {
    vector gets the name 'A[r,c]'. */
 qucs::vector matvec::get (int r, int c) {
   assert (r >= 0 && r < rows && c >= 0 && c < cols);
-  qucs::vector res;
-  for (int i = 0; i < size; i++) res.add (data[i].get (r, c));
+  qucs::vector res (size);
+  const nr_complex_t * p = data + r * cols + c;
+  for (int i = 0; i < size; i++, p += rows * cols) res (i) = *p;
   if (name != NULL) {
     res.setName (createMatrixString (name, r, c));
   }
@@ -255,17 +302,68 @@ matvec * matvec::getMatrixVector (qucs::vector * data, char * name) {
 
 /* This function saves the given matrix in the matrix vector at the
    specified position. */
-void matvec::set (matrix m, int idx) {
+void matvec::set (const matrix & m, int idx) {
   assert (m.getRows () == rows && m.getCols () == cols &&
 	  idx >= 0 && idx < size);
-  data[idx] = m;
+  memcpy (getData (idx), m.getData (), sizeof (nr_complex_t) * rows * cols);
 }
 
 /* The function returns the matrix stored within the matrix vector at
    the given position. */
 matrix matvec::get (int idx) {
   assert (idx >= 0 && idx < size);
-  matrix res (data[idx]);
+  matrix res (rows, cols);
+  memcpy (res.getData (), getData (idx), sizeof (nr_complex_t) * rows * cols);
+  return res;
+}
+
+/* Calls the given function for each matrix index.  Large vectors of
+   matrices are split into blocks of consecutive matrices processed by
+   one thread of the pool each. */
+template <class F>
+static void parallel (int size, int entries, F f) {
+  int threads = std::min (threadpool::getThreads (), size);
+  if (threads <= 1 || (long) size * entries < MATVEC_PARALLEL) {
+    for (int i = 0; i < size; i++) f (i);
+    return;
+  }
+  threadpool::run (threads, [&f, size, threads] (int k) {
+      int from = (long) size * k / threads;
+      int to = (long) size * (k + 1) / threads;
+      for (int i = from; i < to; i++) f (i);
+    });
+}
+
+/* Returns the vector of the matrices f(a[i], i) with r rows and c
+   columns each. */
+template <class F>
+static matvec matrixwise (matvec & a, int r, int c, F f) {
+  matvec res (a.getSize (), r, c);
+  parallel (a.getSize (), a.getRows () * a.getCols (),
+	    [&] (int i) { res.set (f (a.get (i), i), i); });
+  return res;
+}
+
+/* Returns the vector of the values f(a[i]). */
+template <class F>
+static qucs::vector valuewise (matvec & a, F f) {
+  qucs::vector res (a.getSize ());
+  parallel (a.getSize (), a.getRows () * a.getCols (),
+	    [&] (int i) { res (i) = f (a.get (i)); });
+  return res;
+}
+
+/* Returns the vector of matrices with the entries f(x, i, k) of the
+   entries x of the given one, i being the index of their matrix and k
+   their position in the storage. */
+template <class F>
+static matvec entrywise (matvec & a, F f) {
+  matvec res (a.getSize (), a.getRows (), a.getCols ());
+  const nr_complex_t * x = a.getData ();
+  nr_complex_t * y = res.getData ();
+  int n = a.getRows () * a.getCols ();
+  for (int i = 0, k = 0; i < a.getSize (); i++)
+    for (int e = 0; e < n; e++, k++) y[k] = f (x[k], i, k);
   return res;
 }
 
@@ -273,25 +371,24 @@ matrix matvec::get (int idx) {
 matvec operator + (matvec a, matvec b) {
   assert (a.getRows () == b.getRows () && a.getCols () == b.getCols () &&
 	  a.getSize () == b.getSize ());
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) + b.get (i), i);
-  return res;
+  const nr_complex_t * y = b.getData ();
+  return entrywise (a, [y] (nr_complex_t x, int, int k) { return x + y[k]; });
 }
 
 // Matrix vector addition with single matrix.
 matvec operator + (matvec a, matrix b) {
   assert (a.getRows () == b.getRows () && a.getCols () == b.getCols ());
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) + b, i);
-  return res;
+  const nr_complex_t * y = b.getData ();
+  int n = b.getRows () * b.getCols ();
+  return entrywise (a, [y, n] (nr_complex_t x, int, int k) {
+      return x + y[k % n]; });
 }
 
 // Matrix vector addition with vector.
 matvec operator + (matvec a, qucs::vector b) {
   assert (a.getSize () == b.getSize ());
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) + b.get (i), i);
-  return res;
+  return entrywise (a, [&b] (nr_complex_t x, int i, int) {
+      return x + b (i); });
 }
 
 // Matrix vector addition with vector in different order.
@@ -306,65 +403,49 @@ matvec operator + (matrix a, matvec b) {
 
 // Matrix vector scalar addition.
 matvec operator + (matvec a, nr_complex_t z) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) + z, i);
-  return res;
+  return entrywise (a, [z] (nr_complex_t x, int, int) { return x + z; });
 }
 
 // Matrix vector scalar addition in different order.
 matvec operator + (nr_complex_t z, matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (z + a.get (i), i);
-  return res;
+  return entrywise (a, [z] (nr_complex_t x, int, int) { return z + x; });
 }
 
 // Matrix vector scalar addition.
 matvec operator + (matvec a, nr_double_t d) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) + d, i);
-  return res;
+  return entrywise (a, [d] (nr_complex_t x, int, int) { return x + d; });
 }
 
 // Matrix vector scalar addition in different order.
 matvec operator + (nr_double_t d, matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (d + a.get (i), i);
-  return res;
+  return entrywise (a, [d] (nr_complex_t x, int, int) { return d + x; });
 }
 
 // Matrix vector scalar subtraction.
 matvec operator - (matvec a, nr_complex_t z) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) - z, i);
-  return res;
+  return entrywise (a, [z] (nr_complex_t x, int, int) { return x - z; });
 }
 
 // Matrix vector scalar subtraction in different order.
 matvec operator - (nr_complex_t z, matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (z - a.get (i), i);
-  return res;
+  return entrywise (a, [z] (nr_complex_t x, int, int) { return z - x; });
 }
 
 // Matrix vector scalar subtraction.
 matvec operator - (matvec a, nr_double_t d) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) - d, i);
-  return res;
+  return entrywise (a, [d] (nr_complex_t x, int, int) { return x - d; });
 }
 
 // Matrix vector scalar subtraction in different order.
 matvec operator - (nr_double_t d, matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (d - a.get (i), i);
-  return res;
+  return entrywise (a, [d] (nr_complex_t x, int, int) { return d - x; });
 }
 
 // Intrinsic matrix vector addition.
 matvec matvec::operator += (matvec a) {
   assert (a.getRows () == rows && a.getCols () == cols &&
 	  a.getSize () == size);
-  for (int i = 0; i < size; i++) data[i] = data[i] + a.get (i);
+  for (int k = 0; k < getEntries (); k++) data[k] += a.data[k];
   return *this;
 }
 
@@ -372,17 +453,17 @@ matvec matvec::operator += (matvec a) {
 matvec operator - (matvec a, matvec b) {
   assert (a.getRows () == b.getRows () && a.getCols () == b.getCols () &&
 	  a.getSize () == b.getSize ());
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) - b.get (i), i);
-  return res;
+  const nr_complex_t * y = b.getData ();
+  return entrywise (a, [y] (nr_complex_t x, int, int k) { return x - y[k]; });
 }
 
 // Matrix vector subtraction with single matrix.
 matvec operator - (matvec a, matrix b) {
   assert (a.getRows () == b.getRows () && a.getCols () == b.getCols ());
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) - b, i);
-  return res;
+  const nr_complex_t * y = b.getData ();
+  int n = b.getRows () * b.getCols ();
+  return entrywise (a, [y, n] (nr_complex_t x, int, int k) {
+      return x - y[k % n]; });
 }
 
 // Matrix vector subtraction with single matrix in different order.
@@ -402,24 +483,20 @@ matvec operator - (qucs::vector b, matvec a) {
 
 // Unary minus.
 matvec matvec::operator - () {
-  matvec res (getSize (), getRows (), getCols ());
-  for (int i = 0; i < getSize (); i++) res.set (-data[i], i);
-  return res;
+  return entrywise (*this, [] (nr_complex_t x, int, int) { return -x; });
 }
 
 // Intrinsic matrix vector subtraction.
 matvec matvec::operator -= (matvec a) {
   assert (a.getRows () == rows && a.getCols () == cols &&
 	  a.getSize () == size);
-  for (int i = 0; i < a.getSize (); i++) data[i] = data[i] - a.get (i);
+  for (int k = 0; k < getEntries (); k++) data[k] -= a.data[k];
   return *this;
 }
 
 // Matrix vector scaling.
 matvec operator * (matvec a, nr_complex_t z) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) * z, i);
-  return res;
+  return entrywise (a, [z] (nr_complex_t x, int, int) { return x * z; });
 }
 
 // Matrix vector scaling in different order.
@@ -429,9 +506,7 @@ matvec operator * (nr_complex_t z, matvec a) {
 
 // Scalar matrix vector scaling.
 matvec operator * (matvec a, nr_double_t d) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) * d, i);
-  return res;
+  return entrywise (a, [d] (nr_complex_t x, int, int) { return x * d; });
 }
 
 // Scalar matrix vector scaling in different order.
@@ -442,9 +517,8 @@ matvec operator * (nr_double_t d, matvec a) {
 // Matrix vector scaling by a second vector.
 matvec operator * (matvec a, qucs::vector b) {
   assert (a.getSize () == b.getSize ());
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) * b.get (i), i);
-  return res;
+  return entrywise (a, [&b] (nr_complex_t x, int i, int) {
+      return x * b (i); });
 }
 
 // Matrix vector scaling by a second vector in different order.
@@ -454,40 +528,33 @@ matvec operator * (qucs::vector a, matvec b) {
 
 // Matrix vector scaling.
 matvec operator / (matvec a, nr_complex_t z) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) / z, i);
-  return res;
+  return entrywise (a, [z] (nr_complex_t x, int, int) { return x / z; });
 }
 
 // Scalar matrix vector scaling.
 matvec operator / (matvec a, nr_double_t d) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) / d, i);
-  return res;
+  return entrywise (a, [d] (nr_complex_t x, int, int) { return x / d; });
 }
 
 // Matrix vector scaling by a second vector.
 matvec operator / (matvec a, qucs::vector b) {
   assert (a.getSize () == b.getSize ());
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) / b.get (i), i);
-  return res;
+  return entrywise (a, [&b] (nr_complex_t x, int i, int) {
+      return x / b (i); });
 }
 
 // Matrix vector multiplication.
 matvec operator * (matvec a, matvec b) {
   assert (a.getCols () == b.getRows () && a.getSize () == b.getSize ());
-  matvec res (a.getSize (), a.getRows (), b.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) * b.get (i), i);
-  return res;
+  return matrixwise (a, a.getRows (), b.getCols (),
+		     [&b] (const matrix & m, int i) { return m * b.get (i); });
 }
 
 // Matrix vector multiplication with a single matrix.
 matvec operator * (matvec a, matrix b) {
   assert (a.getCols () == b.getRows ());
-  matvec res (a.getSize (), a.getRows (), b.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (a.get (i) * b, i);
-  return res;
+  return matrixwise (a, a.getRows (), b.getCols (),
+		     [&b] (const matrix & m, int) { return m * b; });
 }
 
 // Matrix vector multiplication with a single matrix in different order.
@@ -497,16 +564,13 @@ matvec operator * (matrix a, matvec b) {
 
 // Compute determinants of the given matrix vector.
 qucs::vector det (matvec a) {
-  qucs::vector res (a.getSize ());
-  for (int i = 0; i < a.getSize (); i++) res.set (det (a.get (i)), i);
-  return res;
+  return valuewise (a, [] (const matrix & m) { return det (m); });
 }
 
 // Compute inverse matrices of the given matrix vector.
 matvec inverse (matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (inverse (a.get (i)), i);
-  return res;
+  return matrixwise (a, a.getRows (), a.getCols (),
+		     [] (const matrix & m, int) { return inverse (m); });
 }
 
 // Compute inverse matrices of the given matrix vector.
@@ -516,75 +580,64 @@ matvec sqr (matvec a) {
 
 // Compute n-th power of the given matrix vector.
 matvec pow (matvec a, int n) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (pow (a.get (i), n), i);
-  return res;
+  return matrixwise (a, a.getRows (), a.getCols (),
+		     [n] (const matrix & m, int) { return pow (m, n); });
 }
 
 // Compute n-th powers in the vector of the given matrix vector.
 matvec pow (matvec a, qucs::vector v) {
   assert (a.getSize () == v.getSize ());
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++)
-    res.set (pow (a.get (i), (int) real (v.get (i))), i);
-  return res;
+  return matrixwise (a, a.getRows (), a.getCols (),
+		     [&v] (const matrix & m, int i) {
+		       return pow (m, (int) real (v (i))); });
 }
 
 // Conjugate complex matrix vector.
 matvec conj (matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (conj (a.get (i)), i);
-  return res;
+  return entrywise (a, [] (nr_complex_t x, int, int) { return conj (x); });
 }
 
 // Computes magnitude of each matrix vector element.
 matvec abs (matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (abs (a.get (i)), i);
-  return res;
+  return matrixwise (a, a.getRows (), a.getCols (),
+		     [] (const matrix & m, int) { return abs (m); });
 }
 
 // Computes magnitude in dB of each matrix vector element.
 matvec dB (matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (dB (a.get (i)), i);
-  return res;
+  return matrixwise (a, a.getRows (), a.getCols (),
+		     [] (const matrix & m, int) { return dB (m); });
 }
 
 // Computes the argument of each matrix vector element.
 matvec arg (matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (arg (a.get (i)), i);
-  return res;
+  return matrixwise (a, a.getRows (), a.getCols (),
+		     [] (const matrix & m, int) { return arg (m); });
 }
 
 // Real part matrix vector.
 matvec real (matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (real (a.get (i)), i);
-  return res;
+  return entrywise (a, [] (nr_complex_t x, int, int) {
+      return nr_complex_t (real (x), 0); });
 }
 
 // Real part matrix vector.
 matvec imag (matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (imag (a.get (i)), i);
-  return res;
+  return entrywise (a, [] (nr_complex_t x, int, int) {
+      return nr_complex_t (imag (x), 0); });
 }
 
 /* The function returns the adjoint complex matrix vector.  This is
    also called the adjugate or transpose conjugate. */
 matvec adjoint (matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (adjoint (a.get (i)), i);
-  return res;
+  return matrixwise (a, a.getCols (), a.getRows (),
+		     [] (const matrix & m, int) { return adjoint (m); });
 }
 
 // Transpose the matrix vector.
 matvec transpose (matvec a) {
-  matvec res (a.getSize (), a.getCols (), a.getRows ());
-  for (int i = 0; i < a.getSize (); i++) res.set (transpose (a.get (i)), i);
-  return res;
+  return matrixwise (a, a.getCols (), a.getRows (),
+		     [] (const matrix & m, int) { return transpose (m); });
 }
 
 /* Convert scattering parameters with the reference impedance 'zref'
@@ -592,10 +645,9 @@ matvec transpose (matvec a) {
 matvec stos (matvec s, qucs::vector zref, qucs::vector z0) {
   assert (s.getCols () == s.getRows () &&
 	  s.getCols () == zref.getSize () && s.getCols () == z0.getSize ());
-  matvec res (s.getSize (), s.getCols (), s.getRows ());
-  for (int i = 0; i < s.getSize (); i++)
-    res.set (stos (s.get (i), zref, z0), i);
-  return res;
+  return matrixwise (s, s.getCols (), s.getRows (),
+		     [&] (const matrix & m, int) {
+		       return stos (m, zref, z0); });
 }
 
 matvec stos (matvec s, nr_complex_t zref, nr_complex_t z0) {
@@ -618,9 +670,8 @@ matvec stos (matvec s, nr_complex_t zref, qucs::vector z0) {
 // Convert scattering parameters to admittance matrix vector.
 matvec stoy (matvec s, qucs::vector z0) {
   assert (s.getCols () == s.getRows () && s.getCols () == z0.getSize ());
-  matvec res (s.getSize (), s.getCols (), s.getRows ());
-  for (int i = 0; i < s.getSize (); i++) res.set (stoy (s.get (i), z0), i);
-  return res;
+  return matrixwise (s, s.getCols (), s.getRows (),
+		     [&z0] (const matrix & m, int) { return stoy (m, z0); });
 }
 
 matvec stoy (matvec s, nr_complex_t z0) {
@@ -630,9 +681,8 @@ matvec stoy (matvec s, nr_complex_t z0) {
 // Convert admittance matrix to scattering parameter matrix vector.
 matvec ytos (matvec y, qucs::vector z0) {
   assert (y.getCols () == y.getRows () && y.getCols () == z0.getSize ());
-  matvec res (y.getSize (), y.getCols (), y.getRows ());
-  for (int i = 0; i < y.getSize (); i++) res.set (ytos (y.get (i), z0), i);
-  return res;
+  return matrixwise (y, y.getCols (), y.getRows (),
+		     [&z0] (const matrix & m, int) { return ytos (m, z0); });
 }
 
 matvec ytos (matvec y, nr_complex_t z0) {
@@ -642,9 +692,8 @@ matvec ytos (matvec y, nr_complex_t z0) {
 // Convert scattering parameters to impedance matrix vector.
 matvec stoz (matvec s, qucs::vector z0) {
   assert (s.getCols () == s.getRows () && s.getCols () == z0.getSize ());
-  matvec res (s.getSize (), s.getCols (), s.getRows ());
-  for (int i = 0; i < s.getSize (); i++) res.set (stoz (s.get (i), z0), i);
-  return res;
+  return matrixwise (s, s.getCols (), s.getRows (),
+		     [&z0] (const matrix & m, int) { return stoz (m, z0); });
 }
 
 matvec stoz (matvec s, nr_complex_t z0) {
@@ -654,9 +703,8 @@ matvec stoz (matvec s, nr_complex_t z0) {
 // Convert impedance matrix vector scattering parameter matrix vector.
 matvec ztos (matvec z, qucs::vector z0) {
   assert (z.getCols () == z.getRows () && z.getCols () == z0.getSize ());
-  matvec res (z.getSize (), z.getCols (), z.getRows ());
-  for (int i = 0; i < z.getSize (); i++) res.set (ztos (z.get (i), z0), i);
-  return res;
+  return matrixwise (z, z.getCols (), z.getRows (),
+		     [&z0] (const matrix & m, int) { return ztos (m, z0); });
 }
 
 matvec ztos (matvec z, nr_complex_t z0) {
@@ -666,17 +714,15 @@ matvec ztos (matvec z, nr_complex_t z0) {
 // Convert impedance matrix vector to admittance matrix vector.
 matvec ztoy (matvec z) {
   assert (z.getCols () == z.getRows ());
-  matvec res (z.getSize (), z.getCols (), z.getRows ());
-  for (int i = 0; i < z.getSize (); i++) res.set (ztoy (z.get (i)), i);
-  return res;
+  return matrixwise (z, z.getCols (), z.getRows (),
+		     [] (const matrix & m, int) { return ztoy (m); });
 }
 
 // Convert admittance matrix vector to impedance matrix vector.
 matvec ytoz (matvec y) {
   assert (y.getCols () == y.getRows ());
-  matvec res (y.getSize (), y.getCols (), y.getRows ());
-  for (int i = 0; i < y.getSize (); i++) res.set (ytoz (y.get (i)), i);
-  return res;
+  return matrixwise (y, y.getCols (), y.getRows (),
+		     [] (const matrix & m, int) { return ytoz (m); });
 }
 
 /* This function converts 2x2 matrix vectors from any of the matrix
@@ -684,40 +730,32 @@ matvec ytoz (matvec y) {
    and Z) matrix vectors. */
 matvec twoport (matvec m, char in, char out) {
   assert (m.getCols () >= 2 && m.getRows () >= 2);
-  matvec res (m.getSize (), 2, 2);
-  for (int i = 0; i < m.getSize (); i++)
-    res.set (twoport (m.get (i), in, out), i);
-  return res;
+  return matrixwise (m, 2, 2, [in, out] (const matrix & x, int) {
+      return twoport (x, in, out); });
 }
 
 /* The function returns the Rollet stability factor vector of the
    given S-parameter matrix vector. */
 qucs::vector rollet (matvec m) {
   assert (m.getCols () >= 2 && m.getRows () >= 2);
-  qucs::vector res (m.getSize ());
-  for (int i = 0; i < m.getSize (); i++) res.set (rollet (m.get (i)), i);
-  return res;
+  return valuewise (m, [] (const matrix & x) { return rollet (x); });
 }
 
 /* The function returns the stability measure B1 vector of the given
    S-parameter matrix vector. */
 qucs::vector b1 (matvec m) {
   assert (m.getCols () >= 2 && m.getRows () >= 2);
-  qucs::vector res (m.getSize ());
-  for (int i = 0; i < m.getSize (); i++) res.set (b1 (m.get (i)), i);
-  return res;
+  return valuewise (m, [] (const matrix & x) { return b1 (x); });
 }
 
 matvec rad2deg (matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (rad2deg (a.get (i)), i);
-  return res;
+  return matrixwise (a, a.getRows (), a.getCols (),
+		     [] (const matrix & m, int) { return rad2deg (m); });
 }
 
 matvec deg2rad (matvec a) {
-  matvec res (a.getSize (), a.getRows (), a.getCols ());
-  for (int i = 0; i < a.getSize (); i++) res.set (deg2rad (a.get (i)), i);
-  return res;
+  return matrixwise (a, a.getRows (), a.getCols (),
+		     [] (const matrix & m, int) { return deg2rad (m); });
 }
 
 } // namespace qucs
@@ -76,14 +76,24 @@ class matvec
   matvec ();
   matvec (int, int, int);
   matvec (const matvec &);
+  matvec (matvec &&);
   ~matvec ();
+  matvec & operator = (const matvec &);
+  matvec & operator = (matvec &&);
   int getSize (void) { return size; }
   int getCols (void) { return cols; }
   int getRows (void) { return rows; }
   void setName (const char *);
   char * getName (void);
-  void set (qucs::vector, int, int);
-  void set (matrix, int);
+  // number of complex values stored in all matrices
+  int getEntries (void) const { return size * rows * cols; }
+  // the matrices one after the other, each of them in row major order
+  nr_complex_t * getData (void) { return data; }
+  const nr_complex_t * getData (void) const { return data; }
+  nr_complex_t * getData (int i) { return data + i * rows * cols; }
+  const nr_complex_t * getData (int i) const { return data + i * rows * cols; }
+  void set (const qucs::vector &, int, int);
+  void set (const matrix &, int);
   qucs::vector get (int, int);
   matrix get (int);
   static char * createMatrixString (const char *, int, int);
@@ -170,7 +180,7 @@ class matvec
   int rows; /*! Number of rows of each matrix */
   int cols; /*! Number of columns of each matrix */
   char * name; /*! Name of the matrix array (optional) */
-  matrix * data; /*! matrix (used as array) of data matrices */
+  nr_complex_t * data; /*! entries of all matrices in one block */
 };
 
 } // namespace qucs
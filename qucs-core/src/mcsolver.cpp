@@ -0,0 +1,536 @@
+/*
+ * mcsolver.cpp - Monte-Carlo analysis class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <algorithm>
+
+#include "logging.h"
+#include "complex.h"
+#include "object.h"
+#include "vector.h"
+#include "dataset.h"
+#include "net.h"
+#include "netdefs.h"
+#include "ptrlist.h"
+#include "analysis.h"
+#include "circuit.h"
+#include "variable.h"
+#include "strlist.h"
+#include "environment.h"
+#include "equation.h"
+#include "sweep.h"
+#include "parasweep.h"
+#include "mcsolver.h"
+#include "profile.h"
+#include "opcache.h"
+
+using namespace qucs::eqn;
+
+namespace qucs {
+
+// Distributions of statistical variables.
+enum {
+  DIST_UNIFORM,
+  DIST_GAUSS,
+  DIST_LOGNORMAL
+};
+
+// Constructor creates an unnamed instance of the mcsolver class.
+mcsolver::mcsolver () : parasweep () {
+  results = NULL;
+  solved = 0;
+}
+
+// Constructor creates a named instance of the mcsolver class.
+mcsolver::mcsolver (char * n) : parasweep (n) {
+  results = NULL;
+  solved = 0;
+}
+
+// Destructor deletes the mcsolver class object.
+mcsolver::~mcsolver () {
+  for (auto * o : varobjs) delete o;
+  delete results;
+}
+
+/* The copy constructor creates a new instance of the mcsolver class
+   based on the given mcsolver object. */
+mcsolver::mcsolver (mcsolver & o) : parasweep (o) {
+  for (auto * v : o.varobjs) varobjs.push_back (new object (*v));
+  vars = o.vars;
+  sample = o.sample;
+  results = NULL;
+  solved = 0;
+}
+
+// Adds the properties of a statistical variable.
+void mcsolver::addVariable (object * o) {
+  varobjs.push_back (o);
+}
+
+// Short macro in order to obtain the correct equation node.
+#define E(equ) ((eqn::node *) (equ))
+
+/* Initializes the Monte-Carlo analysis. */
+int mcsolver::initialize (void) {
+  int err = 0;
+
+  // the sample number is swept like a parameter
+  sample = std::string (getName ()) + ".sample";
+  const char * const n = sample.c_str ();
+  if (swp == NULL) {
+    int samples = getPropertyInteger ("Samples");
+    swp = new lstsweep (sample);
+    ((lstsweep *) swp)->create (samples);
+    for (int i = 0; i < samples; i++) swp->set (i, i + 1);
+  }
+  if ((var = env->getVariable (n)) == NULL) {
+    var = new variable (n);
+    var->setConstant (new constant (TAG_DOUBLE));
+    env->addVariable (var);
+  }
+  if (!env->getChecker()->containsVariable (n)) {
+    eqn = env->getChecker()->addDouble ("#sweep", n, 0);
+  }
+  env->setDoubleConstant (n, 1);
+  env->setDouble (n, 1);
+
+  // get the statistical variables, the names containing a dot refer
+  // to circuit properties, the others are put into the environment
+  // and into the equation checker if necessary
+  static const char * const dists[] = { "uniform", "gauss", "lognormal", NULL };
+  vars.clear ();
+  for (auto * o : varobjs) {
+    mcvar_t v;
+    v.name = o->getPropertyString ("Var");
+    v.nom = o->getPropertyDouble ("Nom");
+    v.tol = o->getPropertyDouble ("Tol");
+    v.c = NULL;
+    const char * const t = o->getPropertyString ("Dist");
+    for (v.dist = 0; dists[v.dist] && strcmp (dists[v.dist], t); v.dist++) ;
+
+    size_t dot = v.name.rfind ('.');
+    if (dot != std::string::npos) {
+      std::string cname = v.name.substr (0, dot);
+      v.prop = v.name.substr (dot + 1);
+      for (v.c = subnet->getRoot (); v.c != NULL; v.c = v.c->getNext ())
+	if (cname == v.c->getName ()) break;
+      if (v.c == NULL || !v.c->hasProperty (v.prop)) {
+	logprint (LOG_ERROR, "ERROR: %s: no such circuit property `%s'\n",
+		  getName (), v.name.c_str ());
+	err++;
+	continue;
+      }
+      if (v.c->getPropertyReference (v.prop) != NULL) {
+	logprint (LOG_ERROR, "ERROR: %s: circuit property `%s' refers to "
+		  "variable `%s', vary the variable instead\n", getName (),
+		  v.name.c_str (), v.c->getPropertyReference (v.prop));
+	err++;
+	continue;
+      }
+      v.nom = v.c->getPropertyDouble (v.prop);
+    }
+    else {
+      const char * const name = v.name.c_str ();
+      if (env->getVariable (name) == NULL) {
+	variable * x = new variable (name);
+	x->setConstant (new constant (TAG_DOUBLE));
+	env->addVariable (x);
+      }
+      if (!env->getChecker()->containsVariable (name)) {
+	eqns.push_back (env->getChecker()->addDouble ("#montecarlo", name,
+						      v.nom));
+      }
+      env->setDoubleConstant (name, v.nom);
+      env->setDouble (name, v.nom);
+    }
+    v.value = v.nom;
+    vars.push_back (v);
+  }
+  if (vars.empty ()) {
+    logprint (LOG_ERROR, "ERROR: %s: no statistical variables\n", getName ());
+    err++;
+  }
+
+  // also run initialize functionality for all children
+  initChildren ();
+  return err;
+}
+
+/* Cleans the Monte-Carlo analysis up. */
+int mcsolver::cleanup (void) {
+
+  // remove additional equations from equation checker
+  for (auto * e : eqns) {
+    env->getChecker()->dropEquation (E (e));
+    delete E (e);
+  }
+  eqns.clear ();
+  return parasweep::cleanup ();
+}
+
+/* The Monte-Carlo analysis sweeps the sample number.  The child
+   analyses save their results into a dataset of their own, from which
+   each sample is appended to the output dataset and taken into the
+   statistics.  If the samples have been solved by other processes the
+   statistics are taken from the merged results instead.  At the end
+   the variables get their nominal values again. */
+int mcsolver::solve (void) {
+  int err = 0;
+  qucs::vector * v;
+  if (vars.empty ()) return 1;
+
+  // remember the sizes of the results before the samples
+  std::map<std::string,int> sizes;
+  for (v = data->getVariables (); v != NULL; v = (qucs::vector *) v->getNext ())
+    sizes[v->getName ()] = v->getSize ();
+
+  stats.clear ();
+  solved = 0;
+  results = new dataset ();
+  for (auto *a : *actions) setResults (a, results);
+  err = parasweep::solve ();
+  for (auto *a : *actions) setResults (a, data);
+  delete results;
+  results = NULL;
+
+  if (solved == 0) {
+    int samples = swp->getSize ();
+    for (v = data->getVariables (); v != NULL;
+	 v = (qucs::vector *) v->getNext ()) {
+      strlist * deps = v->getDependencies ();
+      if (deps == NULL || !deps->contains (sample.c_str ())) continue;
+      auto it = sizes.find (v->getName ());
+      int first = it != sizes.end () ? it->second : 0;
+      int inner = (v->getSize () - first) / samples;
+      for (int i = 0; i < samples; i++)
+	accumulate (v, first + i * inner, inner);
+    }
+  }
+
+  restore ();
+  saveStatistics ();
+  return err;
+}
+
+/* The function runs the child analyses for the given sample number. */
+int mcsolver::solvePoint (nr_double_t v) {
+  int err = 0;
+  const char * const n = var->getName ();
+
+  // update the sample number and draw the variables, then run solver
+  env->setDoubleConstant (n, v);
+  env->setDouble (n, v);
+  if (draw ((int) std::lround (v))) {
+    profile::phase p (PROFILE_EQUATIONS);
+    env->runSolver ();
+  }
+  // save results (sample numbers)
+  if (runs == 1) saveResults ();
+#if DEBUG
+  logprint (LOG_STATUS, "NOTIFY: %s: running netlist for sample %d\n",
+	    getName (), (int) std::lround (v));
+#endif
+  while (results->getVariables () != NULL)
+    results->delVariable (results->getVariables ());
+  opcache::enter (n, v);
+  for (auto *a : *actions) {
+    a->setSweepPoint (v);
+    profile::enter (a->getName (), a->getType ());
+    err |= a->solve ();
+    profile::leave ();
+  }
+  opcache::leave ();
+  saveSample ();
+  solved++;
+  return err;
+}
+
+/* Draws the values of the statistical variables for the given sample.
+   The random numbers are generated from the seed and the sample
+   number only, thus a sample gets the same values in any process and
+   sample order.  Circuit properties are set directly.  Returns true
+   if netlist variables have been changed and the equations need to be
+   solved. */
+bool mcsolver::draw (int k) {
+  std::seed_seq seq { (unsigned) getPropertyInteger ("Seed"), (unsigned) k };
+  std::mt19937_64 rnd (seq);
+  std::uniform_real_distribution<nr_double_t> uni (-1.0, 1.0);
+  std::normal_distribution<nr_double_t> gauss (0.0, 1.0);
+  bool equations = false;
+
+  for (auto & v : vars) {
+    switch (v.dist) {
+    case DIST_UNIFORM:
+      v.value = v.nom * (1.0 + v.tol * uni (rnd));
+      break;
+    case DIST_GAUSS:
+      v.value = v.nom * (1.0 + v.tol * gauss (rnd));
+      break;
+    default:
+      v.value = v.nom * std::exp (v.tol * gauss (rnd));
+      break;
+    }
+    if (v.c != NULL)
+      v.c->setProperty (v.prop, v.value);
+    else {
+      env->setDoubleConstant (v.name.c_str (), v.value);
+      env->setDouble (v.name.c_str (), v.value);
+      equations = true;
+    }
+  }
+  return equations;
+}
+
+// Gives the statistical variables their nominal values.
+void mcsolver::restore (void) {
+  bool equations = false;
+  for (auto & v : vars) {
+    if (v.c != NULL)
+      v.c->setProperty (v.prop, v.nom);
+    else {
+      env->setDoubleConstant (v.name.c_str (), v.nom);
+      env->setDouble (v.name.c_str (), v.nom);
+      equations = true;
+    }
+  }
+  if (equations) env->runSolver ();
+}
+
+/* This function appends the results of the child analyses for the
+   current sample and the values of the statistical variables to the
+   output dataset.  The vectors depend on the sample number in
+   addition. */
+void mcsolver::saveSample (void) {
+  qucs::vector * v, * d;
+
+  for (v = results->getDependencies (); v != NULL;
+       v = (qucs::vector *) v->getNext ()) {
+    if (data->findDependency (v->getName ()) == NULL)
+      data->appendDependency (new qucs::vector (*v));
+  }
+  for (v = results->getVariables (); v != NULL;
+       v = (qucs::vector *) v->getNext ()) {
+    if ((d = data->findVariable (v->getName ())) == NULL) {
+      d = new qucs::vector (v->getName ());
+      d->setOrigin (v->getOrigin ());
+      strlist * deps = v->getDependencies () ?
+	new strlist (*v->getDependencies ()) : new strlist ();
+      deps->append (sample.c_str ());
+      d->setDependencies (deps);
+      data->appendVariable (d);
+    }
+    for (int i = 0; i < v->getSize (); i++) d->add (v->get (i));
+    accumulate (v, 0, v->getSize ());
+  }
+
+  for (auto & x : vars) {
+    if ((d = data->findVariable (x.name)) == NULL) {
+      d = new qucs::vector (x.name);
+      d->setOrigin (origin ());
+      strlist * deps = new strlist ();
+      deps->append (sample.c_str ());
+      d->setDependencies (deps);
+      data->appendVariable (d);
+    }
+    d->add (x.value);
+    qucs::vector value (x.name);
+    value.add (x.value);
+    accumulate (&value, 0, 1);
+  }
+
+  // move long vectors out of memory when streaming
+  data->flush ();
+}
+
+/* Takes the given number of values of a result vector starting at the
+   given position as one sample into its statistics.  The mean values
+   and the sums of squared deviations are updated by Welford's method,
+   the values of scalar results are kept for the histogram. */
+void mcsolver::accumulate (qucs::vector * v, int first, int inner) {
+  if (inner <= 0) return;
+  mcstat_t & s = stats[v->getName ()];
+  if (s.mean.empty ()) {
+    strlist * deps = v->getDependencies ();
+    for (int i = 0; deps && i < deps->length (); i++) {
+      if (!strcmp (deps->get (i), sample.c_str ())) break;
+      s.deps.push_back (deps->get (i));
+    }
+    s.mean.assign (inner, 0.0);
+    s.m2.assign (inner, 0.0);
+    s.n = 0;
+  }
+  if ((int) s.mean.size () != inner) return;
+
+  s.n++;
+  for (int i = 0; i < inner; i++) {
+    nr_complex_t x = v->get (first + i);
+    nr_complex_t delta = x - s.mean[i];
+    s.mean[i] += delta / (nr_double_t) s.n;
+    s.m2[i] += real (conj (delta) * (x - s.mean[i]));
+  }
+  if (inner == 1) s.values.push_back (real (v->get (first)));
+}
+
+/* The function saves the mean value and standard deviation of each
+   result and the histogram of each scalar result.  The bins of a
+   histogram span the range of the values in the first run and are
+   kept for later runs, values beyond count in the outer bins. */
+void mcsolver::saveStatistics (void) {
+  for (auto & it : stats) {
+    mcstat_t & s = it.second;
+    const std::string & n = it.first;
+    std::vector<nr_complex_t> dev (s.m2.size ());
+    for (size_t i = 0; i < s.m2.size (); i++)
+      dev[i] = s.n > 1 ? std::sqrt (s.m2[i] / (s.n - 1)) : 0.0;
+    saveVariable (n + ".mean", s.deps, s.mean);
+    saveVariable (n + ".std", s.deps, dev);
+    if (s.values.empty ()) continue;
+
+    // find the bins or create them
+    std::string b = n + ".bins";
+    qucs::vector * v = data->findDependency (b.c_str ());
+    int bins = getPropertyInteger ("Bins");
+    nr_double_t lo, w;
+    if (v != NULL && v->getSize () >= 2) {
+      bins = v->getSize ();
+      w = real (v->get (1)) - real (v->get (0));
+      lo = real (v->get (0)) - w / 2;
+    }
+    else {
+      auto mm = std::minmax_element (s.values.begin (), s.values.end ());
+      lo = *mm.first;
+      nr_double_t hi = *mm.second;
+      if (hi <= lo) {
+	nr_double_t e = lo != 0.0 ? std::fabs (lo) * 1e-3 : 1e-3;
+	lo -= e;
+	hi += e;
+      }
+      w = (hi - lo) / bins;
+      if (v == NULL) {
+	v = new qucs::vector (b);
+	v->setOrigin (getName ());
+	for (int i = 0; i < bins; i++) v->add (lo + (i + 0.5) * w);
+	data->appendDependency (v);
+      }
+    }
+
+    // count the values
+    std::vector<nr_complex_t> count (bins, 0.0);
+    for (nr_double_t x : s.values) {
+      int i = (int) std::floor ((x - lo) / w);
+      count[std::min (std::max (i, 0), bins - 1)] += 1.0;
+    }
+    saveVariable (n + ".hist", std::vector<std::string> (1, b), count);
+  }
+
+  // move long vectors out of memory when streaming
+  data->flush ();
+}
+
+/* Appends the given values to the variable of the output dataset,
+   creating it with the given dependencies if necessary. */
+void mcsolver::saveVariable (const std::string & n,
+			     const std::vector<std::string> & deps,
+			     const std::vector<nr_complex_t> & values) {
+  qucs::vector * v = data->findVariable (n);
+  if (v == NULL) {
+    v = new qucs::vector (n);
+    v->setOrigin (origin ());
+    strlist * d = new strlist ();
+    for (auto & dep : deps) d->append (dep.c_str ());
+    v->setDependencies (d);
+    data->appendVariable (v);
+  }
+  else if (v->getDependencies () != NULL &&
+	   v->getDependencies()->contains (sample.c_str ())) {
+    // a parallel run assigns the sample number to all the results of
+    // the children, the statistics do not depend on it
+    strlist * old = v->getDependencies (), * d = new strlist ();
+    for (int i = 0; i < old->length (); i++)
+      if (strcmp (old->get (i), sample.c_str ())) d->append (old->get (i));
+    v->setDependencies (d);
+  }
+  for (auto & x : values) v->add (x);
+}
+
+// Lets the given analysis and its children save into the dataset.
+void mcsolver::setResults (analysis * a, dataset * d) {
+  a->setData (d);
+  if (a->getAnalysis () != nullptr)
+    for (auto *c : *a->getAnalysis ())
+      setResults (c, d);
+}
+
+/* Returns the name of the last order child analysis.  The statistics
+   and the statistical variables are saved on its behalf, thus
+   enclosing sweeps assign their dependencies to them as well. */
+const char * mcsolver::origin (void) {
+  ptrlist<analysis> * lastorder = subnet->findLastOrderChildren (this);
+  if (lastorder != nullptr && !lastorder->empty ())
+    return lastorder->front()->getName ();
+  return getName ();
+}
+
+// properties
+PROP_REQ [] = {
+  { "Sim", PROP_STR, { PROP_NO_VAL, "DC1" }, PROP_NO_RANGE },
+  PROP_NO_PROP };
+PROP_OPT [] = {
+  { "Samples", PROP_INT, { 100, PROP_NO_STR }, PROP_MIN_VAL (1) },
+  { "Seed", PROP_INT, { 1, PROP_NO_STR }, PROP_POS_RANGE },
+  { "Bins", PROP_INT, { 20, PROP_NO_STR }, PROP_MIN_VAL (2) },
+  { "Processes", PROP_INT, { 0, PROP_NO_STR }, PROP_RNGII (0, 256) },
+  PROP_NO_PROP };
+struct define_t mcsolver::anadef =
+  { "MC", 0, PROP_ACTION, PROP_NO_SUBSTRATE, PROP_LINEAR, PROP_DEF };
+
+// properties of statistical variables
+static struct property_t varreq[] = {
+  { "MC", PROP_STR, { PROP_NO_VAL, "MC1" }, PROP_NO_RANGE },
+  { "Var", PROP_STR, { PROP_NO_VAL, "R1.R" }, PROP_NO_RANGE },
+  PROP_NO_PROP };
+static struct property_t varopt[] = {
+  { "Dist", PROP_STR, { PROP_NO_VAL, "gauss" },
+    PROP_RNG_STR3 ("uniform", "gauss", "lognormal") },
+  { "Tol", PROP_REAL, { 0.05, PROP_NO_STR }, PROP_POS_RANGE },
+  { "Nom", PROP_REAL, { 1, PROP_NO_STR }, PROP_NO_RANGE },
+  PROP_NO_PROP };
+struct define_t mcsolver::vardef =
+  { "MCVar", 0, PROP_COMPONENT, PROP_NO_SUBSTRATE, PROP_LINEAR,
+    varreq, varopt };
+
+} // namespace qucs
@@ -0,0 +1,100 @@
+/*
+ * mcsolver.h - Monte-Carlo analysis class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __MCSOLVER_H__
+#define __MCSOLVER_H__
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace qucs {
+
+class analysis;
+class circuit;
+class dataset;
+class object;
+
+/* The Monte-Carlo analysis draws the statistical variables ("MCVar"
+   definitions) of the netlist for each sample and runs the child
+   analyses on the netlist in memory.  A variable is either a netlist
+   variable or, if its name contains a dot, a property of a circuit,
+   which is then updated without solving the equations.  The random
+   numbers of a sample only depend on the seed and the sample number,
+   thus the samples can be run by several processes like a parameter
+   sweep over the sample number.  Besides the results of every sample
+   the mean value, standard deviation and histogram of each result are
+   saved. */
+class mcsolver : public parasweep
+{
+ public:
+  ACREATOR (mcsolver);
+  mcsolver (char *);
+  mcsolver (mcsolver &);
+  ~mcsolver ();
+  int  initialize (void);
+  int  solve (void);
+  int  cleanup (void);
+  void addVariable (object *);
+
+  static struct define_t vardef;
+
+ private:
+  struct mcvar_t {
+    std::string name, prop;
+    circuit * c;
+    int dist;
+    nr_double_t nom, tol, value;
+  };
+  struct mcstat_t {
+    std::vector<std::string> deps;
+    std::vector<nr_complex_t> mean;
+    std::vector<nr_double_t> m2;
+    std::vector<nr_double_t> values;
+    int n;
+  };
+
+  int  solvePoint (nr_double_t);
+  bool draw (int);
+  void restore (void);
+  void saveSample (void);
+  void accumulate (qucs::vector *, int, int);
+  void saveStatistics (void);
+  void saveVariable (const std::string &, const std::vector<std::string> &,
+		     const std::vector<nr_complex_t> &);
+  void setResults (analysis *, dataset *);
+  const char * origin (void);
+
+  std::vector<object *> varobjs;
+  std::vector<mcvar_t> vars;
+  std::map<std::string, mcstat_t> stats;
+  std::vector<void *> eqns;
+  std::string sample;
+  dataset * results;
+  int solved;
+};
+
+} // namespace qucs
+
+#endif /* __MCSOLVER_H__ */
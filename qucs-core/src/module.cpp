@@ -38,6 +38,7 @@
 #include "analyses.h"
 #include "netdefs.h"
 #include "module.h"
+#include "resultcache.h"
 
 #ifdef __MINGW32__
  #include <windows.h>
@@ -160,6 +161,9 @@ void module::registerModules (void) {
   registerModule (&miscdef2);
   REGISTER_MISC (nodeset);
   REGISTER_MISC (substrate);
+  registerModule (&optimizer::vardef);
+  registerModule (&optimizer::goaldef);
+  registerModule (&mcsolver::vardef);
 
   // circuit components
   REGISTER_CIRCUIT (resistor);
@@ -312,7 +316,11 @@ void module::registerModules (void) {
   REGISTER_ANALYSIS (trsolver);
   REGISTER_ANALYSIS (hbsolver);
   REGISTER_ANALYSIS (parasweep);
+  REGISTER_ANALYSIS (optimizer);
+  REGISTER_ANALYSIS (mcsolver);
   REGISTER_ANALYSIS (e_trsolver);
+  REGISTER_ANALYSIS (digisolver);
+  REGISTER_ANALYSIS (psssolver);
 }
 
 // Global module unregistration.
@@ -471,6 +479,7 @@ void module::registerDynamicModules (char *proj, std::list<std::string> modlist)
 
     // which lib is going to be loaded
     fprintf( stdout, "try loading %s\n", absPathLib.c_str() );
+    qucs::resultcache::addFile (absPathLib);
 
 #if __MINGW32__
     // Load the DLL
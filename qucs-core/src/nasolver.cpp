@@ -36,6 +36,9 @@
 #include <float.h>
 #include <assert.h>
 #include <limits>
+#include <vector>
+#include <map>
+#include <algorithm>
 
 #include "logging.h"
 #include "complex.h"
@@ -46,18 +49,26 @@
 #include "dataset.h"
 #include "net.h"
 #include "analysis.h"
+#include "circuitbatch.h"
 #include "nodelist.h"
 #include "nodeset.h"
 #include "strlist.h"
 #include "tvector.h"
 #include "tmatrix.h"
+#include "tspmatrix.h"
 #include "eqnsys.h"
+#include "profile.h"
+#include "convreport.h"
+#include "trace.h"
 #include "precision.h"
 #include "operatingpoint.h"
 #include "exception.h"
 #include "exceptionstack.h"
+#include "numstatus.h"
 #include "nasolver.h"
 #include "constants.h"
+#include "threadpool.h"
+#include "eco.h"
 
 namespace qucs {
 
@@ -67,14 +78,27 @@ nasolver<nr_type_t>::nasolver () : analysis ()
 {
     nlist = NULL;
     A = C = NULL;
+    As = NULL;
     z = x = xprev = zprev = NULL;
     reltol = abstol = vntol = 0;
+    damping = 1.0;
     calculate_func = NULL;
     convHelper = fixpoint = 0;
     eqnAlgo = ALGO_LU_DECOMPOSITION;
     updateMatrix = 1;
     gMin = srcFactor = 0;
+    threads = 1;
     eqns = new eqnsys<nr_type_t> ();
+    linearStamps = keepLinear = linearValid = 0;
+    schur = schurValid = 0;
+    Aii = NULL;
+    eqnsI = eqnsB = NULL;
+    lowRank = lowRankValid = 0;
+    eqnsL = NULL;
+    newton = NEWTON_FULL;
+    chordValid = 0;
+    chordNorm = 0;
+    newtonIterations = newtonFactorizations = chordSteps = chordReverts = 0;
 }
 
 // Constructor creates a named instance of the nasolver class.
@@ -83,14 +107,27 @@ nasolver<nr_type_t>::nasolver (const std::string &n) : analysis (n)
 {
     nlist = NULL;
     A = C = NULL;
+    As = NULL;
     z = x = xprev = zprev = NULL;
     reltol = abstol = vntol = 0;
+    damping = 1.0;
     calculate_func = NULL;
     convHelper = fixpoint = 0;
     eqnAlgo = ALGO_LU_DECOMPOSITION;
     updateMatrix = 1;
     gMin = srcFactor = 0;
+    threads = 1;
     eqns = new eqnsys<nr_type_t> ();
+    linearStamps = keepLinear = linearValid = 0;
+    schur = schurValid = 0;
+    Aii = NULL;
+    eqnsI = eqnsB = NULL;
+    lowRank = lowRankValid = 0;
+    eqnsL = NULL;
+    newton = NEWTON_FULL;
+    chordValid = 0;
+    chordNorm = 0;
+    newtonIterations = newtonFactorizations = chordSteps = chordReverts = 0;
 }
 
 // Destructor deletes the nasolver class object.
@@ -100,11 +137,15 @@ nasolver<nr_type_t>::~nasolver ()
     delete nlist;
     delete C;
     delete A;
+    delete As;
     delete z;
     delete x;
     delete xprev;
     delete zprev;
     delete eqns;
+    delete eqnsL;
+    clearEvaluation ();
+    clearSchur ();
 }
 
 /* The copy constructor creates a new instance of the nasolver class
@@ -114,6 +155,8 @@ nasolver<nr_type_t>::nasolver (nasolver & o) : analysis (o)
 {
     nlist = o.nlist ? new nodelist (*(o.nlist)) : NULL;
     A = o.A ? new tmatrix<nr_type_t> (*(o.A)) : NULL;
+    As = o.As ? new tspmatrix<nr_type_t> (*(o.As)) : NULL;
+    stamps = o.stamps;
     C = o.C ? new tmatrix<nr_type_t> (*(o.C)) : NULL;
     z = o.z ? new tvector<nr_type_t> (*(o.z)) : NULL;
     x = o.x ? new tvector<nr_type_t> (*(o.x)) : NULL;
@@ -121,6 +164,7 @@ nasolver<nr_type_t>::nasolver (nasolver & o) : analysis (o)
     reltol = o.reltol;
     abstol = o.abstol;
     vntol = o.vntol;
+    damping = o.damping;
     desc = o.desc;
     calculate_func = o.calculate_func;
     convHelper = o.convHelper;
@@ -129,8 +173,29 @@ nasolver<nr_type_t>::nasolver (nasolver & o) : analysis (o)
     fixpoint = o.fixpoint;
     gMin = o.gMin;
     srcFactor = o.srcFactor;
+    threads = o.threads;
     eqns = new eqnsys<nr_type_t> (*(o.eqns));
     solution = nasolution<nr_type_t> (o.solution);
+    linearStamps = o.linearStamps;
+    keepLinear = linearValid = 0;
+    linear = o.linear;
+    schur = o.schur;
+    schurValid = 0;
+    inner = o.inner;
+    bound = o.bound;
+    schurII = o.schurII;
+    schurIB = o.schurIB;
+    schurBI = o.schurBI;
+    schurBB = o.schurBB;
+    Aii = o.Aii ? new tspmatrix<nr_type_t> (*(o.Aii)) : NULL;
+    eqnsI = o.eqnsI ? new eqnsys<nr_type_t> () : NULL;
+    eqnsB = o.eqnsB ? new eqnsys<nr_type_t> () : NULL;
+    lowRank = lowRankValid = 0;
+    eqnsL = NULL;
+    newton = NEWTON_FULL;
+    chordValid = 0;
+    chordNorm = 0;
+    newtonIterations = newtonFactorizations = chordSteps = chordReverts = 0;
 }
 
 /* The function runs the nodal analysis solver once, reports errors if
@@ -138,22 +203,47 @@ nasolver<nr_type_t>::nasolver (nasolver & o) : analysis (o)
 template <class nr_type_t>
 int nasolver<nr_type_t>::solve_once (void)
 {
-    qucs::exception * e;
-    int error = 0, d;
+    TRACE_SCOPE ("nasolver::solve_once");
+    int error;
 
     // run the calculation function for each circuit
-    calculate ();
+    {
+        profile::phase p (PROFILE_DEVICES);
+        calculate ();
+    }
 
     // generate A matrix and z vector
-    createMatrix ();
+    {
+        profile::phase p (PROFILE_ASSEMBLY);
+        createMatrix ();
+    }
 
     // solve equation system
-    try_running ()
     {
+        profile::phase p (PROFILE_FACTORIZATION);
         runMNA ();
     }
+
     // appropriate exception handling
-    catch_exception ()
+    error = checkErrors ();
+
+    // save results into circuits
+    if (!error) saveSolution ();
+    return error;
+}
+
+/* This function handles the failures raised while solving the
+   equation system, these are reported through the exception stack
+   from here on.  It returns non-zero if the solution is not usable. */
+template <class nr_type_t>
+int nasolver<nr_type_t>::checkErrors (void)
+{
+    qucs::exception * e;
+    int error = 0, d;
+
+    numstatus::report ();
+    if (top_exception () == NULL) return 0;
+    switch (top_exception ()->getCode ())
     {
     case EXCEPTION_PIVOT:
     case EXCEPTION_WRONG_VOLTAGE:
@@ -195,8 +285,6 @@ int nasolver<nr_type_t>::solve_once (void)
         break;
     }
 
-    // save results into circuits
-    if (!error) saveSolution ();
     return error;
 }
 
@@ -205,6 +293,18 @@ int nasolver<nr_type_t>::solve_once (void)
 template <class nr_type_t>
 void nasolver<nr_type_t>::solve_post (void)
 {
+    // keep the symbolic analysis for the next run in ECO mode
+    if (eco::enabled ())
+    {
+        eco::ordering_t o;
+        if (eqns->getOrdering (o.Ap, o.Ai, o.Q, o.Vol))
+            eco::keep (std::string (getName ()) + ":" + desc, o);
+    }
+    reportBypass ();
+    reportKrylov ();
+    reportNewton ();
+    clearEvaluation ();
+    results.clear ();
     delete nlist;
     nlist = NULL;
 }
@@ -213,6 +313,8 @@ void nasolver<nr_type_t>::solve_post (void)
 template <class nr_type_t>
 void nasolver<nr_type_t>::solve_pre (void)
 {
+    profile::phase p (PROFILE_SETUP);
+
     // create node list, enumerate nodes and voltage sources
 #if DEBUG
     logprint (LOG_STATUS, "NOTIFY: %s: creating node list for %s analysis\n",
@@ -221,6 +323,8 @@ void nasolver<nr_type_t>::solve_pre (void)
     nlist = new nodelist (subnet);
     nlist->assignNodes ();
     assignVoltageSources ();
+    assignNodeRows ();
+    results.clear ();
 #if DEBUG && 0
     nlist->print ();
 #endif
@@ -229,12 +333,55 @@ void nasolver<nr_type_t>::solve_pre (void)
     int M = countVoltageSources ();
     int N = countNodes ();
     delete A;
-    A = new tmatrix<nr_type_t> (M + N);
+    A = NULL;
+    delete As;
+    As = NULL;
+    stamps.clear ();
+    clearSchur ();
+    // large circuits are assembled into a sparse matrix
+    if ((eqnAlgo == ALGO_LU_DECOMPOSITION_SPARSE || (eqnAlgo & ALGO_KRYLOV))
+        && M + N >= SPARSE_MNA_SIZE)
+        createStamps ();
+    else
+        A = new tmatrix<nr_type_t> (M + N);
+    setupBypass ();
+    setupEvaluation ();
     delete z;
     z = new tvector<nr_type_t> (N + M);
     delete x;
     x = new tvector<nr_type_t> (N + M);
 
+    // the chord and Broyden iterations need the factors of an LU solver
+    newton = NEWTON_FULL;
+    if (hasProperty ("Newton"))
+    {
+        const char * const n = getPropertyString ("Newton");
+        if (!strcmp (n, "chord"))
+            newton = NEWTON_CHORD;
+        else if (!strcmp (n, "Broyden"))
+            newton = NEWTON_BROYDEN;
+    }
+    if (eqnAlgo != ALGO_LU_DECOMPOSITION_CROUT &&
+        eqnAlgo != ALGO_LU_DECOMPOSITION_DOOLITTLE &&
+        eqnAlgo != ALGO_LU_DECOMPOSITION_SPARSE)
+        newton = NEWTON_FULL;
+    chordValid = 0;
+    newtonIterations = newtonFactorizations = chordSteps = chordReverts = 0;
+
+    // the iterative linear solvers need not be more accurate than the
+    // convergence criteria of the analysis
+    if (eqnAlgo & ALGO_KRYLOV)
+        eqns->setKrylov (getPropertyDouble ("reltol") * NA_KRYLOV_TOL,
+                         NA_KRYLOV_FILL);
+
+    // take over the symbolic analysis of the previous run in ECO mode
+    if (eco::enabled ())
+    {
+        eco::ordering_t o;
+        if (eco::ordering (std::string (getName ()) + ":" + desc, o))
+            eqns->setOrdering (o.Ap, o.Ai, o.Q, o.Vol);
+    }
+
 #if DEBUG
     logprint (LOG_STATUS, "NOTIFY: %s: solving %s netlist\n", getName (), desc.c_str());
 #endif
@@ -294,10 +441,13 @@ int nasolver<nr_type_t>::solve_nonlinear_continuation_gMin (void)
     do
     {
         // run solving loop until convergence is reached
+        convreport::step ("gMin", gMin);
         run = 0;
         do
         {
             error = solve_once ();
+            profile::count (PROFILE_NEWTON);
+            newtonIterations++;
             if (!error)
             {
                 // convergence check
@@ -309,6 +459,7 @@ int nasolver<nr_type_t>::solve_nonlinear_continuation_gMin (void)
         }
         while (!convergence && run < MaxIterations);
         iterations += run;
+        convreport::endStep (run < MaxIterations && !error);
 
         // not yet converged, so decreased the gMin-step
         if (run >= MaxIterations || error)
@@ -362,11 +513,14 @@ int nasolver<nr_type_t>::solve_nonlinear_continuation_Source (void)
     do
     {
         // run solving loop until convergence is reached
+        convreport::step ("source", srcFactor);
         run = 0;
         do
         {
             subnet->setSrcFactor (srcFactor);
             error = solve_once ();
+            profile::count (PROFILE_NEWTON);
+            newtonIterations++;
             if (!error)
             {
                 // convergence check
@@ -378,6 +532,7 @@ int nasolver<nr_type_t>::solve_nonlinear_continuation_Source (void)
         }
         while (!convergence && run < MaxIterations);
         iterations += run;
+        convreport::endStep (run < MaxIterations && !error);
 
         // not yet converged, so decreased the source-step
         if (run >= MaxIterations || error)
@@ -460,6 +615,12 @@ int nasolver<nr_type_t>::solve_nonlinear (void)
     abstol = getPropertyDouble ("abstol");
     vntol = getPropertyDouble ("vntol");
     updateMatrix = 1;
+    convreport::begin (desc, getHelperDescription ());
+
+    // linear circuits do not change during the iterations
+    linearValid = 0;
+    keepLinear = 1;
+    chordValid = 0;
 
     if (convHelper == CONV_GMinStepping)
     {
@@ -467,6 +628,8 @@ int nasolver<nr_type_t>::solve_nonlinear (void)
         // instead of the basic solver provided by this function
         iterations = 0;
         error = solve_nonlinear_continuation_gMin ();
+        keepLinear = 0;
+        reportConvergence (error);
         return error;
     }
     else if (convHelper == CONV_SourceStepping)
@@ -475,6 +638,8 @@ int nasolver<nr_type_t>::solve_nonlinear (void)
         // instead of the basic solver provided by this function
         iterations = 0;
         error = solve_nonlinear_continuation_Source ();
+        keepLinear = 0;
+        reportConvergence (error);
         return error;
     }
 
@@ -482,6 +647,8 @@ int nasolver<nr_type_t>::solve_nonlinear (void)
     do
     {
         error = solve_once ();
+        profile::count (PROFILE_NEWTON);
+        newtonIterations++;
         if (!error)
         {
             // convergence check
@@ -518,8 +685,11 @@ int nasolver<nr_type_t>::solve_nonlinear (void)
         throw_exception (e);
         error++;
     }
+    convreport::endStep (!error);
 
+    keepLinear = 0;
     iterations = run;
+    reportConvergence (error);
     return error;
 }
 
@@ -547,10 +717,18 @@ void nasolver<nr_type_t>::createMatrix (void)
        Each of these minor matrices is going to be generated here. */
     if (updateMatrix)
     {
-        createGMatrix ();
-        createBMatrix ();
-        createCMatrix ();
-        createDMatrix ();
+        if (As != NULL)
+        {
+            createSparseMatrix ();
+        }
+        else
+        {
+            A->set (0.0);
+            createGMatrix ();
+            createBMatrix ();
+            createCMatrix ();
+            createDMatrix ();
+        }
     }
 
     /* Adjust G matrix if requested. */
@@ -560,7 +738,10 @@ void nasolver<nr_type_t>::createMatrix (void)
         int M = countVoltageSources ();
         for (int n = 0; n < N + M; n++)
         {
-            A->set (n, n, A->get (n, n) + gMin);
+            if (As != NULL)
+                As->set (n, n, As->get (n, n) + gMin);
+            else
+                A->set (n, n, A->get (n, n) + gMin);
         }
     }
 
@@ -603,30 +784,20 @@ template <class nr_type_t>
 void nasolver<nr_type_t>::createBMatrix (void)
 {
     int N = countNodes ();
-    int M = countVoltageSources ();
-    circuit * vs;
-    struct nodelist_t * n;
-    nr_type_t val;
+    circuit * root = subnet->getRoot ();
 
-    // go through each voltage sources (first dimension)
-    for (int c = 0; c < M; c++)
+    // go through each voltage source and its connected ports
+    for (circuit * vs = root; vs != NULL; vs = (circuit *) vs->getNext ())
     {
-        vs = findVoltageSource (c);
-        // go through each node (second dimension)
-        for (int r = 0; r < N; r++)
+        int v0 = vs->getVoltageSource (), vn = vs->getVoltageSources ();
+        const int * p = vs->getNodeRows ();
+        for (int c = v0; c < v0 + vn; c++)
         {
-            val = 0.0;
-            n = nlist->getNode (r);
-            for (auto &current : *n)
+            for (int r = 0; r < vs->getSize (); r++)
             {
-                // is voltage source connected to node ?
-	      if (current->getCircuit () == vs)
-                {
-		  val += MatVal (vs->getB (current->getPort (), c));
-                }
+                if (p[r] < 0) continue;
+                (*A) (p[r], c + N) += MatVal (vs->getB (r, c));
             }
-            // put value into B matrix
-            A->set (r, c + N, val);
         }
     }
 }
@@ -643,30 +814,20 @@ template <class nr_type_t>
 void nasolver<nr_type_t>::createCMatrix (void)
 {
     int N = countNodes ();
-    int M = countVoltageSources ();
-    circuit * vs;
-    struct nodelist_t * n;
-    nr_type_t val;
+    circuit * root = subnet->getRoot ();
 
-    // go through each voltage sources (second dimension)
-    for (int r = 0; r < M; r++)
+    // go through each voltage source and its connected ports
+    for (circuit * vs = root; vs != NULL; vs = (circuit *) vs->getNext ())
     {
-        vs = findVoltageSource (r);
-        // go through each node (first dimension)
-        for (int c = 0; c < N; c++)
+        int v0 = vs->getVoltageSource (), vn = vs->getVoltageSources ();
+        const int * p = vs->getNodeRows ();
+        for (int r = v0; r < v0 + vn; r++)
         {
-            val = 0.0;
-            n = nlist->getNode (c);
-            for (auto &current: *n)
+            for (int c = 0; c < vs->getSize (); c++)
             {
-                // is voltage source connected to node ?
-	      if (current->getCircuit () == vs)
-                {
-		  val += MatVal (vs->getC (r, current->getPort ()));
-                }
+                if (p[c] < 0) continue;
+                (*A) (r + N, p[c]) += MatVal (vs->getC (r, c));
             }
-            // put value into C matrix
-            A->set (r + N, c, val);
         }
     }
 }
@@ -676,23 +837,16 @@ void nasolver<nr_type_t>::createCMatrix (void)
 template <class nr_type_t>
 void nasolver<nr_type_t>::createDMatrix (void)
 {
-    int M = countVoltageSources ();
     int N = countNodes ();
-    circuit * vsr, * vsc;
-    nr_type_t val;
-    for (int r = 0; r < M; r++)
+    circuit * root = subnet->getRoot ();
+
+    // only the voltage sources of the same circuit are coupled
+    for (circuit * vs = root; vs != NULL; vs = (circuit *) vs->getNext ())
     {
-        vsr = findVoltageSource (r);
-        for (int c = 0; c < M; c++)
-        {
-            vsc = findVoltageSource (c);
-            val = 0.0;
-            if (vsr == vsc)
-            {
-                val = MatVal (vsr->getD (r, c));
-            }
-            A->set (r + N, c + N, val);
-        }
+        int v0 = vs->getVoltageSource (), vn = vs->getVoltageSources ();
+        for (int r = v0; r < v0 + vn; r++)
+            for (int c = v0; c < v0 + vn; c++)
+                (*A) (r + N, c + N) = MatVal (vs->getD (r, c));
     }
 }
 
@@ -708,148 +862,570 @@ void nasolver<nr_type_t>::createDMatrix (void)
 template <class nr_type_t>
 void nasolver<nr_type_t>::createGMatrix (void)
 {
-    int pr, pc, N = countNodes ();
-    nr_type_t g;
-    struct nodelist_t * nr, * nc;
-    circuit * ct;
-
-    // go through each column of the G matrix
-    for (int c = 0; c < N; c++)
-    {
-        nc = nlist->getNode (c);
-        // go through each row of the G matrix
-        for (int r = 0; r < N; r++)
-        {
-            nr = nlist->getNode (r);
-            g = 0.0;
-            // sum up the conductance of each connected circuit
-            for (auto & currentnc  : *nc)
-	      for (auto & currentnr: *nr)
-		if (currentnc->getCircuit () == currentnr->getCircuit ())
-		  {
-		    ct = currentnc->getCircuit ();
-		    pc = currentnc->getPort ();
-		    pr = currentnr->getPort ();
-		    g += MatVal (ct->getY (pr, pc));
-		  }
-            // put value into G matrix
-            A->set (r, c, g);
+    circuit * root = subnet->getRoot ();
+
+    // add the conductances of each circuit to its connected port pairs
+    for (circuit * ct = root; ct != NULL; ct = (circuit *) ct->getNext ())
+    {
+        const int * p = ct->getNodeRows ();
+        for (int pc = 0; pc < ct->getSize (); pc++)
+        {
+            if (p[pc] < 0) continue;
+            for (int pr = 0; pr < ct->getSize (); pr++)
+            {
+                if (p[pr] < 0) continue;
+                (*A) (p[pr], p[pc]) += MatVal (ct->getY (pr, pc));
+            }
         }
     }
 }
 
-/* The following function creates the (N+M)x(N+M) noise current
-   correlation matrix used during the AC noise computations.  */
+/* The function determines the sparsity pattern of the A matrix and
+   the location each circuit matrix entry is going to be accumulated
+   into.  Thus the A matrix can be assembled by a single pass through
+   the list of stamps without looking up nodes again.  The diagonal is
+   always part of the pattern. */
 template <class nr_type_t>
-void nasolver<nr_type_t>::createNoiseMatrix (void)
+void nasolver<nr_type_t>::createStamps (void)
 {
-    int pr, pc, N = countNodes ();
+    int N = countNodes ();
     int M = countVoltageSources ();
-    struct nodelist_t * n;
-    nr_type_t val;
-    int r, c, ri, ci;
-    struct nodelist_t * nr, * nc;
-    circuit * ct;
-
-    // create new Cy matrix if necessary
-    delete C;
-    C = new tmatrix<nr_type_t> (N + M);
+    std::vector<int> rows, cols;
+    nastamp_t s;
+    int pr, pc, v, vr, vc;
 
-    // go through each column of the Cy matrix
-    for (c = 0; c < N; c++)
-    {
-        nc = nlist->getNode (c);
-        // go through each row of the Cy matrix
-        for (r = 0; r < N; r++)
-        {
-            nr = nlist->getNode (r);
-            val = 0.0;
-            // sum up the noise-correlation of each connected circuit
-            for (auto & currentnc: *nc)
-		/* a = 0; a < nc->size(); a++ */
-	      for (auto &currentnr : *nr)
-		/* b = 0; b < nr->size(); b++) */
-                    if (currentnc->getCircuit () == currentnr->getCircuit ())
-                    {
-                        ct = currentnc->getCircuit ();
-                        pc = currentnc->getPort ();
-                        pr = currentnr->getPort ();
-                        val += MatVal (ct->getN (pr, pc));
-                    }
-            // put value into Cy matrix
-            C->set (r, c, val);
+    // collect the entries of each circuit
+    for (circuit * ct = subnet->getRoot (); ct != NULL;
+            ct = (circuit *) ct->getNext ())
+    {
+        int v0 = ct->getVoltageSource (), vn = ct->getVoltageSources ();
+        const int * p = ct->getNodeRows ();
+        s.ct = ct;
+        for (pr = 0; pr < ct->getSize (); pr++)
+        {
+            if (p[pr] < 0) continue;
+            // G matrix entries of connected port pairs
+            for (pc = 0; pc < ct->getSize (); pc++)
+            {
+                if (p[pc] < 0) continue;
+                s.type = 'G'; s.r = pr; s.c = pc;
+                rows.push_back (p[pr]); cols.push_back (p[pc]);
+                stamps.push_back (s);
+            }
+            // B and C matrix entries of the circuit's voltage sources
+            for (v = v0; v < v0 + vn; v++)
+            {
+                s.type = 'B'; s.r = pr; s.c = v;
+                rows.push_back (p[pr]); cols.push_back (v + N);
+                stamps.push_back (s);
+                s.type = 'C'; s.r = v; s.c = pr;
+                rows.push_back (v + N); cols.push_back (p[pr]);
+                stamps.push_back (s);
+            }
+        }
+        // D matrix entries
+        for (vr = v0; vr < v0 + vn; vr++)
+        {
+            for (vc = v0; vc < v0 + vn; vc++)
+            {
+                if (!ct->hasD (vr - v0, vc - v0)) continue;
+                s.type = 'D'; s.r = vr; s.c = vc;
+                rows.push_back (vr + N); cols.push_back (vc + N);
+                stamps.push_back (s);
+            }
         }
     }
+    for (int n = 0; n < N + M; n++)
+    {
+        rows.push_back (n);
+        cols.push_back (n);
+    }
 
-    // go through each additional voltage source and put coefficients into
-    // the noise current correlation matrix
-    circuit * vsr, * vsc;
-    for (r = 0; r < M; r++)
+    // create sparse matrix and look up the slot of each entry
+    As = new tspmatrix<nr_type_t> (N + M, N + M, rows.size (),
+                                   &rows[0], &cols[0]);
+    for (unsigned int i = 0; i < stamps.size (); i++)
+        stamps[i].slot = As->find (rows[i], cols[i]);
+
+    // unknowns touched by non-linear circuits, linear stamps first
+    std::vector<bool> nonlinear (N + M, false);
+    for (unsigned int i = 0; i < stamps.size (); i++)
+    {
+        if (stamps[i].ct->isNonLinear ())
+            nonlinear[rows[i]] = nonlinear[cols[i]] = true;
+    }
+    linearStamps = std::stable_partition (stamps.begin (), stamps.end (),
+        [] (const nastamp_t & s) { return !s.ct->isNonLinear (); })
+        - stamps.begin ();
+    linear.assign (As->getNnz (), 0.0);
+    linearValid = 0;
+    // the Krylov solvers work on the whole matrix
+    if (!(eqnAlgo & ALGO_KRYLOV)) createSchur (nonlinear);
+}
+
+/* Prepares the Schur complement solver for the given boundary
+   unknowns.  The A matrix is partitioned into
+                  +-         -+
+              A = | Aii   Aib |
+                  | Abi   Abb |
+                  +-         -+
+   with the boundary unknowns b holding all the entries of the
+   non-linear circuits.  Thus Aii, Aib and Abi are constant during the
+   non-linear iterations and the boundary unknowns are obtained from
+   the small system (Abb - Abi Aii^-1 Aib) xb = zb - Abi Aii^-1 zi. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::createSchur (const std::vector<bool> & nonlinear)
+{
+    int n = As->getRows ();
+    std::vector<int> index (n);
+    inner.clear ();
+    bound.clear ();
+    for (int i = 0; i < n; i++)
+    {
+        if (nonlinear[i])
+        {
+            index[i] = bound.size ();
+            bound.push_back (i);
+        }
+        else
+        {
+            index[i] = inner.size ();
+            inner.push_back (i);
+        }
+    }
+    int ni = inner.size (), nb = bound.size ();
+    schur = nb > 0 && ni > 0 && nb <= NA_SCHUR_MAX && 4 * nb <= n;
+    if (!schur) return;
+
+    // sort the entries of the A matrix into the four blocks
+    int * colptr = As->getColPtr ();
+    int * rowidx = As->getRowIdx ();
+    std::vector<int> rows, cols, slots;
+    naentry_t e;
+    for (int c = 0; c < n; c++)
     {
-        vsr = findVoltageSource (r);
-        for (c = 0; c < M; c++)
+        for (int k = colptr[c]; k < colptr[c + 1]; k++)
         {
-            vsc = findVoltageSource (c);
-            val = 0.0;
-            if (vsr == vsc)
+            int r = rowidx[k];
+            e.r = index[r]; e.c = index[c]; e.slot = k;
+            if (!nonlinear[r] && !nonlinear[c])
             {
-                ri = vsr->getSize () + r - vsr->getVoltageSource ();
-                ci = vsc->getSize () + c - vsc->getVoltageSource ();
-                val = MatVal (vsr->getN (ri, ci));
+                rows.push_back (e.r); cols.push_back (e.c);
+                slots.push_back (k);
             }
-            C->set (r + N, c + N, val);
+            else if (!nonlinear[r])
+                schurIB.push_back (e);
+            else if (!nonlinear[c])
+                schurBI.push_back (e);
+            else
+                schurBB.push_back (e);
         }
     }
+    Aii = new tspmatrix<nr_type_t> (ni, ni, rows.size (), &rows[0], &cols[0]);
+    for (unsigned int i = 0; i < slots.size (); i++)
+        schurII.push_back (std::make_pair (Aii->find (rows[i], cols[i]),
+                                           slots[i]));
+
+    schurW.assign (nb, tvector<nr_type_t> (ni));
+    schurS0 = tmatrix<nr_type_t> (nb);
+    schurS = tmatrix<nr_type_t> (nb);
+    xi = zi = tvector<nr_type_t> (ni);
+    xb = zb = tvector<nr_type_t> (nb);
+    eqnsI = new eqnsys<nr_type_t> ();
+    eqnsB = new eqnsys<nr_type_t> ();
+    schurValid = 0;
+}
+
+// Releases the Schur complement solver.
+template <class nr_type_t>
+void nasolver<nr_type_t>::clearSchur (void)
+{
+    delete Aii;
+    Aii = NULL;
+    delete eqnsI;
+    eqnsI = NULL;
+    delete eqnsB;
+    eqnsB = NULL;
+    schur = schurValid = 0;
+    inner.clear ();
+    bound.clear ();
+    schurII.clear ();
+    schurIB.clear ();
+    schurBI.clear ();
+    schurBB.clear ();
+    schurW.clear ();
+}
+
+/* The function factorizes the inner block Aii of the A matrix and
+   computes W = Aii^-1 Aib and the constant part -Abi W of the Schur
+   complement.  Returns non-zero if Aii turns out to be singular. */
+template <class nr_type_t>
+int nasolver<nr_type_t>::factorizeSchur (void)
+{
+    nr_type_t * a = As->getData ();
+    nr_type_t * d = Aii->getData ();
+    for (auto & e : schurII) d[e.first] = a[e.second];
+
+    int mark = numstatus::mark ();
+    eqnsI->setAlgo (ALGO_LU_FACTORIZATION_SPARSE);
+    eqnsI->passEquationSys (Aii, &xi, &zi);
+    eqnsI->solve ();
+    profile::count (PROFILE_FACTORIZATIONS);
+    if (numstatus::raised (mark))
+    {
+        numstatus::release (mark);
+        return -1;
+    }
 
-    // go through each additional voltage source
-    for (r = 0; r < M; r++)
+    // one substitution per boundary unknown
+    int nb = bound.size ();
+    eqnsI->setAlgo (ALGO_LU_SUBSTITUTION_SPARSE);
+    auto e = schurIB.begin ();
+    for (int j = 0; j < nb; j++)
+    {
+        // the entries are sorted by columns
+        zi.set (0.0);
+        for (; e != schurIB.end () && e->c == j; ++e)
+            zi (e->r) = a[e->slot];
+        eqnsI->passEquationSys ((tspmatrix<nr_type_t> *) NULL,
+                                &schurW[j], &zi);
+        eqnsI->solve ();
+    }
+    schurS0 = tmatrix<nr_type_t> (nb);
+    for (auto & b : schurBI)
+        for (int j = 0; j < nb; j++)
+            schurS0 (b.r, j) -= a[b.slot] * schurW[j] (b.c);
+    schurValid = 1;
+    return 0;
+}
+
+/* Solves the equation system by eliminating the inner unknowns with
+   the Schur complement. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::runSchur (void)
+{
+    nr_type_t * a = As->getData ();
+    int ni = inner.size (), nb = bound.size ();
+
+    // boundary matrix, i.e. Abb - Abi Aii^-1 Aib
+    if (updateMatrix)
+    {
+        schurS = schurS0;
+        for (auto & e : schurBB) schurS (e.r, e.c) += a[e.slot];
+    }
+
+    // reduced right hand side
+    for (int i = 0; i < ni; i++) zi (i) = z->get (inner[i]);
+    for (int i = 0; i < nb; i++) zb (i) = z->get (bound[i]);
+    eqnsI->setAlgo (ALGO_LU_SUBSTITUTION_SPARSE);
+    eqnsI->passEquationSys ((tspmatrix<nr_type_t> *) NULL, &xi, &zi);
+    eqnsI->solve ();
+    for (auto & e : schurBI) zb (e.r) -= a[e.slot] * xi (e.c);
+
+    // solve for the boundary, then back substitute the inner unknowns
+    eqnsB->setAlgo (ALGO_LU_DECOMPOSITION);
+    eqnsB->passEquationSys (updateMatrix ? &schurS : NULL, &xb, &zb);
+    eqnsB->solve ();
+    for (int j = 0; j < nb; j++)
+    {
+        nr_type_t v = xb (j);
+        x->set (bound[j], v);
+        if (v == 0.0) continue;
+        tvector<nr_type_t> & w = schurW[j];
+        for (int i = 0; i < ni; i++) xi (i) -= v * w (i);
+    }
+    for (int i = 0; i < ni; i++) x->set (inner[i], xi (i));
+}
+
+/* Solves the linear equation system by a low-rank update of the base
+   system factorized at a previous point:  The A matrix differing from
+   the base matrix A0 in the columns J is A = A0 + D E', D holding the
+   differences in these columns and E the unit vectors of J.  With
+   y = A0^-1 z and Z = A0^-1 D the solution is
+
+     x = y - Z (I + E' Z)^-1 E' y,
+
+   by k + 1 substitutions and a k by k system for k columns changed.
+   A new base is factorized if the pattern changed, too many columns
+   changed or the update turns out to be inaccurate.  Returns non-zero
+   if the system is to be solved as usual. */
+template <class nr_type_t>
+int nasolver<nr_type_t>::runLowRank (void)
+{
+    if (As != NULL ? eqnAlgo != ALGO_LU_DECOMPOSITION_SPARSE :
+        eqnAlgo != ALGO_LU_DECOMPOSITION_CROUT &&
+        eqnAlgo != ALGO_LU_DECOMPOSITION_DOOLITTLE)
+        return -1;
+
+    int n = z->size ();
+    int nnz = As != NULL ? As->getNnz () : n * n;
+    nr_type_t * a = As != NULL ? As->getData () : A->getData ();
+    int * colptr = As != NULL ? As->getColPtr () : NULL;
+    int * rowidx = As != NULL ? As->getRowIdx () : NULL;
+    if (!lowRankValid || (int) lowRankA.size () != nnz)
+        return factorizeLowRank ();
+    if (As != NULL &&
+        (!std::equal (colptr, colptr + n + 1, lowRankColPtr.begin ()) ||
+         !std::equal (rowidx, rowidx + nnz, lowRankRowIdx.begin ())))
+        return factorizeLowRank ();
+
+    // the changed columns
+    std::vector<int> cols;
+    for (int c = 0; c < n && (int) cols.size () <= NA_LOWRANK_MAX; c++)
+    {
+        if (As != NULL)
+        {
+            for (int k = colptr[c]; k < colptr[c + 1]; k++)
+                if (a[k] != lowRankA[k]) { cols.push_back (c); break; }
+        }
+        else
+        {
+            for (int r = 0; r < n; r++)
+                if (a[r * n + c] != lowRankA[r * n + c]) { cols.push_back (c); break; }
+        }
+    }
+    int k = cols.size ();
+    if (k > NA_LOWRANK_MAX || 4 * k > n)
+        return factorizeLowRank ();
+
+    // y = A0^-1 z
+    eqnsL->passEquationSys ((tmatrix<nr_type_t> *) NULL, x, z);
+    eqnsL->solve ();
+    if (k == 0) return 0;
+
+    // Z = A0^-1 D
+    tmatrix<nr_type_t> D (n, k), Z (n, k);
+    for (int j = 0; j < k; j++)
+    {
+        int c = cols[j];
+        if (As != NULL)
+        {
+            for (int p = colptr[c]; p < colptr[c + 1]; p++)
+                D (rowidx[p], j) = a[p] - lowRankA[p];
+        }
+        else
+        {
+            for (int r = 0; r < n; r++)
+                D (r, j) = a[r * n + c] - lowRankA[r * n + c];
+        }
+    }
+    eqnsL->solveMany (&D, &Z);
+
+    // w = (I + E' Z)^-1 E' y
+    tmatrix<nr_type_t> S (k);
+    tvector<nr_type_t> w (k), v (k);
+    for (int i = 0; i < k; i++)
+    {
+        for (int j = 0; j < k; j++) S (i, j) = Z (cols[i], j);
+        S (i, i) += 1.0;
+        v (i) = x->get (cols[i]);
+    }
+    eqnsys<nr_type_t> small;
+    small.setAlgo (ALGO_LU_DECOMPOSITION);
+    small.passEquationSys (&S, &w, &v);
+    int mark = numstatus::mark ();
+    small.solve ();
+    if (numstatus::raised (mark))
+    {
+        numstatus::release (mark);
+        return factorizeLowRank ();
+    }
+    for (int r = 0; r < n; r++)
     {
-        vsr = findVoltageSource (r);
-        // go through each node
-        for (c = 0; c < N; c++)
+        nr_type_t d = 0.0;
+        for (int j = 0; j < k; j++) d += Z (r, j) * w (j);
+        x->set (r, x->get (r) - d);
+    }
+
+    // the residual z - A x must not exceed the one of a factorization
+    std::vector<nr_type_t> res (n);
+    std::vector<nr_double_t> mag (n);
+    for (int r = 0; r < n; r++)
+    {
+        res[r] = z->get (r);
+        mag[r] = abs (z->get (r));
+    }
+    for (int c = 0; c < n; c++)
+    {
+        nr_type_t xc = x->get (c);
+        if (As != NULL)
         {
-            val = 0.0;
-            n = nlist->getNode (c);
-            for (auto &currentn: *n)
-	      /*i = 0; i < n->size(); i++ )*/
+            for (int p = colptr[c]; p < colptr[c + 1]; p++)
             {
-                // is voltage source connected to node ?
-                if (currentn->getCircuit () == vsr)
-                {
-                    ri = vsr->getSize () + r - vsr->getVoltageSource ();
-                    ci = currentn->getPort ();
-                    val += MatVal (vsr->getN (ri, ci));
-                }
+                res[rowidx[p]] -= a[p] * xc;
+                mag[rowidx[p]] += abs (a[p] * xc);
+            }
+        }
+        else
+        {
+            for (int r = 0; r < n; r++)
+            {
+                res[r] -= a[r * n + c] * xc;
+                mag[r] += abs (a[r * n + c] * xc);
             }
-            // put value into Cy matrix
-            C->set (r + N, c, val);
         }
     }
+    for (int r = 0; r < n; r++)
+    {
+        if (!(abs (res[r]) <= NA_LOWRANK_TOL * mag[r]))
+            return factorizeLowRank ();
+    }
+    return 0;
+}
 
-    // go through each voltage source
-    for (c = 0; c < M; c++)
+/* Factorizes the current equation system as the base of the following
+   low-rank updates and solves it.  Returns non-zero if the factors are
+   unusable, e.g. need virtual resistances, the base is dropped then. */
+template <class nr_type_t>
+int nasolver<nr_type_t>::factorizeLowRank (void)
+{
+    int n = z->size ();
+    if (eqnsL == NULL) eqnsL = new eqnsys<nr_type_t> ();
+    lowRankValid = 0;
+    eqnsL->setAlgo (eqnAlgo);
+    if (As != NULL)
+    {
+        int nnz = As->getNnz ();
+        lowRankA.assign (As->getData (), As->getData () + nnz);
+        lowRankColPtr.assign (As->getColPtr (), As->getColPtr () + n + 1);
+        lowRankRowIdx.assign (As->getRowIdx (), As->getRowIdx () + nnz);
+        eqnsL->passEquationSys (As, x, z);
+    }
+    else
+    {
+        lowRankA.assign (A->getData (), A->getData () + n * n);
+        lowRankF = *A;
+        eqnsL->passEquationSys (&lowRankF, x, z);
+    }
+
+    int mark = numstatus::mark ();
+    profile::count (PROFILE_FACTORIZATIONS);
+    eqnsL->factorize ();
+    if (numstatus::raised (mark))
+    {
+        numstatus::release (mark);
+        lowRankA.clear ();
+        return -1;
+    }
+    eqnsL->solve ();
+    lowRankValid = 1;
+    return 0;
+}
+
+/* Drops the base system of the low-rank updates, the next linear
+   system is factorized again. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::clearLowRank (void)
+{
+    lowRankValid = 0;
+    lowRankA.clear ();
+    lowRankColPtr.clear ();
+    lowRankRowIdx.clear ();
+}
+
+/* This function assembles the sparse A matrix by accumulating the
+   matrix entries of each circuit into their precomputed slots.  The
+   linear circuits are restamped once per non-linear solve only. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::createSparseMatrix (void)
+{
+    nr_type_t * data = As->getData ();
+    int nnz = As->getNnz ();
+    if (!keepLinear || !linearValid)
+    {
+        // the Schur complement remains valid if nothing changed
+        As->set (0.0);
+        addStamps (0, linearStamps);
+        if (!std::equal (data, data + nnz, linear.begin ()))
+        {
+            std::copy (data, data + nnz, linear.begin ());
+            schurValid = 0;
+        }
+        linearValid = 1;
+    }
+    else
+    {
+        std::copy (linear.begin (), linear.end (), data);
+    }
+    addStamps (linearStamps, stamps.size ());
+}
+
+// Accumulates the given range of stamps into the sparse A matrix.
+template <class nr_type_t>
+void nasolver<nr_type_t>::addStamps (int first, int last)
+{
+    nr_type_t * data = As->getData ();
+    for (int i = first; i < last; i++)
+    {
+        nastamp_t & s = stamps[i];
+        switch (s.type)
+        {
+        case 'G':
+            data[s.slot] += MatVal (s.ct->getY (s.r, s.c));
+            break;
+        case 'B':
+            data[s.slot] += MatVal (s.ct->getB (s.r, s.c));
+            break;
+        case 'C':
+            data[s.slot] += MatVal (s.ct->getC (s.r, s.c));
+            break;
+        case 'D':
+            data[s.slot] += MatVal (s.ct->getD (s.r, s.c));
+            break;
+        }
+    }
+}
+
+/* Checks whether the A matrix (dense or sparse) contains finite
+   values only. */
+template <class nr_type_t>
+int nasolver<nr_type_t>::isFiniteMatrix (void)
+{
+    return As != NULL ? As->isFinite () : A->isFinite ();
+}
+
+/* The following function creates the (N+M)x(N+M) noise current
+   correlation matrix used during the AC noise computations.  */
+template <class nr_type_t>
+void nasolver<nr_type_t>::createNoiseMatrix (void)
+{
+    int N = countNodes ();
+    int M = countVoltageSources ();
+    circuit * root = subnet->getRoot ();
+
+    // create new Cy matrix if necessary
+    delete C;
+    C = new tmatrix<nr_type_t> (N + M);
+
+    // go through each circuit and add its noise-correlation entries
+    for (circuit * ct = root; ct != NULL; ct = (circuit *) ct->getNext ())
     {
-        vsc = findVoltageSource (c);
-        // go through each node
-        for (r = 0; r < N; r++)
+        const int * p = ct->getNodeRows ();
+        int s = ct->getSize ();
+        int v0 = ct->getVoltageSource (), vn = ct->getVoltageSources ();
+        for (int pc = 0; pc < s; pc++)
         {
-            val = 0.0;
-            n = nlist->getNode (r);
-            for (auto & currentn: *n)/*i = 0; i < n->size(); i++)*/
+            if (p[pc] < 0) continue;
+            for (int pr = 0; pr < s; pr++)
             {
-                // is voltage source connected to node ?
-                if (currentn->getCircuit () == vsc)
-                {
-                    ci = vsc->getSize () + c - vsc->getVoltageSource ();
-                    ri = currentn->getPort ();
-                    val += MatVal (vsc->getN (ri, ci));
-                }
+                if (p[pr] < 0) continue;
+                (*C) (p[pr], p[pc]) += MatVal (ct->getN (pr, pc));
             }
-            // put value into Cy matrix
-            C->set (r, c + N, val);
         }
-    }
 
+        // the additional voltage sources follow the ports of the circuit
+        for (int v = 0; v < vn; v++)
+        {
+            for (int pc = 0; pc < s; pc++)
+            {
+                if (p[pc] < 0) continue;
+                (*C) (v0 + v + N, p[pc]) += MatVal (ct->getN (s + v, pc));
+                (*C) (p[pc], v0 + v + N) += MatVal (ct->getN (pc, s + v));
+            }
+            for (int w = 0; w < vn; w++)
+                (*C) (v0 + v + N, v0 + w + N) = MatVal (ct->getN (s + v, s + w));
+        }
+    }
 }
 
 /* The i matrix is an 1xN matrix with each element of the matrix
@@ -861,27 +1437,19 @@ template <class nr_type_t>
 void nasolver<nr_type_t>::createIVector (void)
 {
     int N = countNodes ();
-    nr_type_t val;
-    struct nodelist_t * n;
-    circuit * is;
+    circuit * root = subnet->getRoot ();
 
-    // go through each node
-    for (int r = 0; r < N; r++)
+    z->set ((nr_type_t) 0.0, 0, N);
+    // go through each current source and its connected ports
+    for (circuit * is = root; is != NULL; is = (circuit *) is->getNext ())
     {
-        val = 0.0;
-        n = nlist->getNode (r);
-        // go through each circuit connected to the node
-        for (auto &currentn: *n)/* int i = 0; i < n->size(); i++)*/
+        if (!is->isISource () && !is->isNonLinear ()) continue;
+        const int * p = is->getNodeRows ();
+        for (int i = 0; i < is->getSize (); i++)
         {
-	  is = currentn->getCircuit ();
-	  // is this a current source ?
-	  if (is->isISource () || is->isNonLinear ())
-	    {
-	      val += MatVal (is->getI (currentn->getPort ()));
-            }
+            if (p[i] < 0) continue;
+            (*z) (p[i]) += MatVal (is->getI (i));
         }
-        // put value into i vector
-        z->set (r, val);
     }
 }
 
@@ -891,17 +1459,14 @@ template <class nr_type_t>
 void nasolver<nr_type_t>::createEVector (void)
 {
     int N = countNodes ();
-    int M = countVoltageSources ();
-    nr_type_t val;
-    circuit * vs;
+    circuit * root = subnet->getRoot ();
 
     // go through each voltage source
-    for (int r = 0; r < M; r++)
+    for (circuit * vs = root; vs != NULL; vs = (circuit *) vs->getNext ())
     {
-        vs = findVoltageSource (r);
-        val = MatVal (vs->getE (r));
-        // put value into e vector
-        z->set (r + N, val);
+        int v0 = vs->getVoltageSource (), vn = vs->getVoltageSources ();
+        for (int r = v0; r < v0 + vn; r++)
+            z->set (r + N, MatVal (vs->getE (r)));
     }
 }
 
@@ -932,17 +1497,8 @@ int nasolver<nr_type_t>::getNodeNr (const std::string &str)
 template <class nr_type_t>
 int nasolver<nr_type_t>::findAssignedNode (circuit * c, int port)
 {
-    int N = countNodes ();
-    struct nodelist_t * n;
-    for (int r = 0; r < N; r++)
-    {
-        n = nlist->getNode (r);
-        for (auto &currentn : *n) /*int i = 0; i < n->size(); i++)*/
-            if (c == currentn->getCircuit ())
-                if (port == currentn->getPort ())
-                    return r;
-    }
-    return -1;
+    // the ground node has no row in the matrix
+    return c->getNodeRow (port);
 }
 
 // Returns the number of voltage sources in the nodelist.
@@ -987,35 +1543,208 @@ void nasolver<nr_type_t>::assignVoltageSources (void)
     subnet->setVoltageSources (nSources);
 }
 
+/* The function stores the matrix row of each circuit port into the
+   circuit, -1 for ports at the ground node.  Thus the matrices are
+   assembled without looking up the node list again. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::assignNodeRows (void)
+{
+    circuit * root = subnet->getRoot ();
+    int N = countNodes ();
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        for (int i = 0; i < c->getSize (); i++) c->setNodeRow (i, -1);
+    }
+    for (int r = 0; r < N; r++)
+    {
+        for (auto & current : *nlist->getNode (r))
+            current->getCircuit ()->setNodeRow (current->getPort (), r);
+    }
+}
+
 /* The matrix equation Ax = z is solved by x = A^-1*z.  The function
    applies the operation to the previously generated matrices. */
 template <class nr_type_t>
 void nasolver<nr_type_t>::runMNA (void)
 {
+    int mark = numstatus::mark ();
 
-    // just solve the equation system here
-    eqns->setAlgo (eqnAlgo);
-    eqns->passEquationSys (updateMatrix ? A : NULL, x, z);
-    eqns->solve ();
-
-    // if damped Newton-Raphson is requested
-    if (xprev != NULL && top_exception () == NULL)
+    // the chord and Broyden iterations step by the factors of an earlier
+    // iteration if the residual decreases fast enough
+    int chord = newton != NEWTON_FULL && keepLinear && updateMatrix &&
+        !fixpoint && convHelper == CONV_None;
+    if (chord)
     {
-        if (convHelper == CONV_Attenuation)
-        {
-            applyAttenuation ();
-        }
-        else if (convHelper == CONV_LineSearch)
+        newtonResidual (chordR);
+        if (chordValid && !runChord ())
         {
-            lineSearch ();
+            damping = 1.0;
+            return;
         }
-        else if (convHelper == CONV_SteepestDescent)
-        {
+        chordX = *x;
+    }
+
+    // during non-linear iterations the linear part can be eliminated,
+    // unless its inner block is singular
+    if (schur && keepLinear && convHelper != CONV_GMinStepping)
+    {
+        if (!schurValid && (!updateMatrix || factorizeSchur ()))
+            schur = 0;
+    }
+
+    // just solve the equation system here
+    if (schur && keepLinear && convHelper != CONV_GMinStepping)
+    {
+        if (updateMatrix) profile::count (PROFILE_FACTORIZATIONS);
+        if (updateMatrix) newtonFactorizations++;
+        runSchur ();
+    }
+    // linear sweeps try updating the factorized system of a previous point
+    else if (!lowRank || !updateMatrix || runLowRank ())
+    {
+        if (updateMatrix) profile::count (PROFILE_FACTORIZATIONS);
+        if (updateMatrix) newtonFactorizations++;
+        eqns->setAlgo (eqnAlgo);
+        if (As != NULL)
+            eqns->passEquationSys (updateMatrix ? As : NULL, x, z);
+        else if (chord)
+        {
+            chordF = *A;
+            eqns->passEquationSys (&chordF, x, z);
+        }
+        else
+            eqns->passEquationSys (updateMatrix ? A : NULL, x, z);
+        eqns->solve ();
+    }
+
+    // the full Newton step starts the following chord iterations
+    if (chord)
+    {
+        chordValid = !numstatus::raised (mark);
+        chordNorm = norm (chordR);
+        chordS.assign (1, *x - chordX);
+    }
+
+    // if damped Newton-Raphson is requested
+    damping = 1.0;
+    if (xprev != NULL && !numstatus::raised (mark))
+    {
+        if (convHelper == CONV_Attenuation)
+        {
+            applyAttenuation ();
+        }
+        else if (convHelper == CONV_LineSearch)
+        {
+            lineSearch ();
+        }
+        else if (convHelper == CONV_SteepestDescent)
+        {
             steepestDescent ();
         }
     }
 }
 
+/* Takes a chord or Broyden step from the current iterate x by the
+   factors of the last full Newton step, these being the ones of the
+   Jacobian J0.  The residual F of the equations at x is to be given in
+   chordR.  The chord step solves J0 s = -F, the Broyden step corrects
+   it by the rank-one updates of the steps since, see C. T. Kelley,
+   "Iterative Methods for Linear and Nonlinear Equations", algorithm
+   brsol.  Returns non-zero if the residual did not decrease by
+   NA_CHORD_RATE or too many steps have been taken, a full Newton step
+   is required then. */
+template <class nr_type_t>
+int nasolver<nr_type_t>::runChord (void)
+{
+    nr_double_t n = norm (chordR);
+    if (n > NA_CHORD_RATE * chordNorm)
+    {
+        chordReverts++;
+        return -1;
+    }
+    if ((int) chordS.size () > NA_CHORD_MAX) return -1;
+
+    // s = -J0^-1 F
+    tvector<nr_type_t> s (x->size ());
+    chordR *= -1.0;
+    solveFactorized (&chordR, &s);
+
+    if (newton == NEWTON_BROYDEN)
+    {
+        int k = chordS.size ();
+        for (int j = 0; j < k - 1; j++)
+        {
+            nr_double_t sj = norm (chordS[j]);
+            s += chordS[j + 1] * real (scalar (chordS[j], s) / (sj * sj));
+        }
+        nr_double_t sk = norm (chordS[k - 1]);
+        nr_double_t t = 1.0 - real (scalar (chordS[k - 1], s) / (sk * sk));
+        if (fabs (t) < std::numeric_limits<nr_double_t>::epsilon ()) return -1;
+        s *= 1.0 / t;
+    }
+
+    *x += s;
+    chordS.push_back (s);
+    chordNorm = n;
+    chordSteps++;
+    profile::count (PROFILE_CHORD);
+    return 0;
+}
+
+/* Computes the residual F = A x - z of the current equation system at
+   the current iterate. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::newtonResidual (tvector<nr_type_t> & F)
+{
+    int n = z->size ();
+    F = -(*z);
+    if (As != NULL)
+    {
+        nr_type_t * a = As->getData ();
+        int * colptr = As->getColPtr ();
+        int * rowidx = As->getRowIdx ();
+        for (int c = 0; c < n; c++)
+        {
+            nr_type_t xc = x->get (c);
+            for (int p = colptr[c]; p < colptr[c + 1]; p++)
+                F (rowidx[p]) += a[p] * xc;
+        }
+    }
+    else
+    {
+        nr_type_t * a = A->getData ();
+        for (int r = 0; r < n; r++)
+        {
+            nr_type_t f = F (r);
+            for (int c = 0; c < n; c++) f += a[r * n + c] * x->get (c);
+            F (r) = f;
+        }
+    }
+}
+
+/* Solves the equation system for the given right hand side by the
+   factors of the last full Newton step. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::solveFactorized (tvector<nr_type_t> * b,
+                                           tvector<nr_type_t> * s)
+{
+    tvector<nr_type_t> * zs = z, * xs = x;
+    int update = updateMatrix;
+    z = b;
+    x = s;
+    updateMatrix = 0;
+    if (schur)
+        runSchur ();
+    else
+    {
+        eqns->passEquationSys ((tmatrix<nr_type_t> *) NULL, x, z);
+        eqns->solve ();
+    }
+    z = zs;
+    x = xs;
+    updateMatrix = update;
+}
+
 /* This function applies a damped Newton-Raphson (limiting scheme) to
    the current solution vector in the form x1 = x0 + a * (x1 - x0).  This
    convergence helper is heuristic and does not ensure global convergence. */
@@ -1038,6 +1767,7 @@ void nasolver<nr_type_t>::applyAttenuation (void)
 
     // apply damped solution vector
     *x = *xprev + alpha * dx;
+    damping = alpha;
 }
 
 /* This is damped Newton-Raphson using nested iterations in order to
@@ -1093,6 +1823,7 @@ void nasolver<nr_type_t>::lineSearch (void)
     // apply final damping factor
     assert (alpha > 0 && alpha <= 1);
     *x = *xprev + alpha * dx;
+    damping = alpha;
 }
 
 /* The function looks for the optimal gradient for the right hand side
@@ -1129,6 +1860,7 @@ void nasolver<nr_type_t>::steepestDescent (void)
 
     // apply final damping factor
     *x = *xprev + alpha * dx;
+    damping = alpha;
 }
 
 /* The function checks whether the iterative algorithm for linearizing
@@ -1143,6 +1875,8 @@ int nasolver<nr_type_t>::checkConvergence (void)
     nr_double_t v_abs, v_rel, i_abs, i_rel;
     int r;
 
+    if (convreport::enabled ()) recordIteration ();
+
     // check the nodal voltage changes against the allowed absolute
     // and relative tolerance values
     for (r = 0; r < N; r++)
@@ -1173,6 +1907,77 @@ int nasolver<nr_type_t>::checkConvergence (void)
     return 1;
 }
 
+/* The function records the largest changes of the iteration and the
+   unknown farthest from the convergence criteria of checkConvergence()
+   in the convergence report. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::recordIteration (void)
+{
+    int N = countNodes ();
+    int M = countVoltageSources ();
+    nr_double_t ratio, worstRatio = 0;
+    int worst = -1;
+
+    for (int r = 0; r < N + M; r++)
+    {
+        // node voltages and branch currents swap their tolerances
+        nr_double_t xtol = r < N ? vntol : abstol;
+        nr_double_t ztol = r < N ? abstol : vntol;
+        ratio = abs (x->get (r) - xprev->get (r)) /
+            (xtol + reltol * abs (x->get (r)));
+        if (!convHelper)
+            ratio = std::max (ratio, (nr_double_t) (abs (z->get (r) - zprev->get (r)) /
+                (ztol + reltol * abs (z->get (r)))));
+        if (ratio > worstRatio)
+        {
+            worstRatio = ratio;
+            worst = r;
+        }
+    }
+    convreport::iteration (maxnorm (*x - *xprev), maxnorm (*z - *zprev),
+                           worst, worstRatio, damping);
+}
+
+/* Finishes the convergence report of the non-linear solve.  The
+   unknowns of a failed solve are named after their node or voltage
+   source and hold the devices connected to them. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::reportConvergence (int error)
+{
+    if (!convreport::enabled ()) return;
+    if (!error)
+    {
+        convreport::end (false);
+        return;
+    }
+
+    int N = countNodes ();
+    std::map<int, std::string> names;
+    std::map<int, std::vector<std::string> > devices;
+    for (int r : convreport::unknowns ())
+    {
+        if (r < N)
+        {
+            names[r] = nlist->get (r);
+            std::vector<std::string> & devs = devices[r];
+            for (node * n : (*nlist)[r])
+            {
+                std::string dev = n->getCircuit ()->getName ();
+                if (std::find (devs.begin (), devs.end (), dev) == devs.end ())
+                    devs.push_back (dev);
+            }
+        }
+        else
+        {
+            circuit * vs = findVoltageSource (r - N);
+            std::string dev = vs ? vs->getName () : "?";
+            names[r] = dev + ".I";
+            devices[r].push_back (dev);
+        }
+    }
+    convreport::end (true, names, devices);
+}
+
 /* The function saves the solution and right hand vector of the previous
    iteration. */
 template <class nr_type_t>
@@ -1205,32 +2010,268 @@ void nasolver<nr_type_t>::restartNR (void)
     circuit * root = subnet->getRoot ();
     for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
     {
-        if (c->isNonLinear ()) c->restartDC ();
+        if (c->isNonLinear ())
+        {
+            c->restartDC ();
+            c->resetBypass ();
+        }
+    }
+}
+
+/* The function enables the bypass of non-linear device evaluations
+   whose controlling voltages did not change since their last
+   evaluation if the analysis requests it, otherwise it disables the
+   bypass.  The device tolerances are the Newton iteration's voltage
+   tolerances. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::setupBypass (void)
+{
+    nr_double_t rtol = 0, vtol = 0;
+    if (hasProperty ("Bypass") && !strcmp (getPropertyString ("Bypass"), "yes"))
+    {
+        rtol = getPropertyDouble ("reltol");
+        vtol = getPropertyDouble ("vntol");
+    }
+    circuit * root = subnet->getRoot ();
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        if (c->isNonLinear ()) c->setBypass (rtol, vtol);
+    }
+}
+
+/* The function partitions the circuit list for the device evaluation
+   phase.  Many circuits of a type providing a batched evaluation are
+   grouped into one batch.  Circuits whose model evaluation touches
+   their own data only are evaluated concurrently if the analysis
+   requests more than one worker thread, all the others keep being
+   evaluated serially.  The concurrent ones are sorted by type, such
+   that the same model code and vtable serve a run of circuits. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::setupEvaluation (void)
+{
+    clearEvaluation ();
+    threads = hasProperty ("Threads") ?
+        threadpool::threads (getPropertyInteger ("Threads")) : 1;
+
+    // group the circuits by type
+    std::map<int, circuitbatch *> types;
+    circuit * root = subnet->getRoot ();
+    circuit * c;
+    for (c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        c->setEvaluated (false);
+        typename std::map<int, circuitbatch *>::iterator it =
+            types.find (c->getType ());
+        if (it == types.end ())
+            it = types.insert (std::make_pair (c->getType (),
+                                               c->createBatch ())).first;
+        if (it->second) it->second->add (c);
+    }
+    int count = 0;
+    for (typename std::map<int, circuitbatch *>::iterator it = types.begin ();
+         it != types.end (); ++it)
+    {
+        circuitbatch * b = it->second;
+        if (b == NULL) continue;
+        if (b->size () >= NA_BATCH_MIN)
+        {
+            b->prepare ();
+            batches.push_back (b);
+            count += b->size ();
+        }
+        else
+        {
+            delete b;
+            it->second = NULL;
+        }
+    }
+
+    // the remaining ones are evaluated one by one
+    for (c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        if (c->isParallel ())
+            ordered.push_back (c);
+        if (types[c->getType ()] != NULL) continue;
+        if (c->isParallel ())
+            parallels.push_back (c);
+        else
+            serials.push_back (c);
+    }
+    std::stable_sort (parallels.begin (), parallels.end (), typeOrder);
+    std::stable_sort (ordered.begin (), ordered.end (), typeOrder);
+    ordered.insert (ordered.end (), serials.begin (), serials.end ());
+    count += parallels.size ();
+
+    // not worth the thread overhead for a few devices only
+    threads = std::max (1, std::min (threads, count / NA_PARALLEL_MIN));
+}
+
+// Orders circuits by their type.
+template <class nr_type_t>
+bool nasolver<nr_type_t>::typeOrder (circuit * a, circuit * b)
+{
+    return a->getType () < b->getType ();
+}
+
+// Deletes the circuit batches and the evaluation lists.
+template <class nr_type_t>
+void nasolver<nr_type_t>::clearEvaluation (void)
+{
+    for (unsigned int i = 0; i < batches.size (); i++) delete batches[i];
+    batches.clear ();
+    parallels.clear ();
+    serials.clear ();
+    ordered.clear ();
+}
+
+/* The function evaluates the k-th of n parts of each circuit batch
+   and of the concurrently evaluated circuits.  The batches are split
+   into blocks of fixed size, the vectorised evaluation of a block does
+   not depend on the number of threads. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::evaluateRange (evaluate_func_t func, int k, int n)
+{
+    int i, first, last;
+    for (unsigned int b = 0; b < batches.size (); b++)
+    {
+        circuitbatch * batch = batches[b];
+        int size = batch->size ();
+        for (first = k * NA_BATCH_BLOCK; first < size;
+                first += n * NA_BATCH_BLOCK)
+        {
+            last = std::min (first + NA_BATCH_BLOCK, size);
+            batch->calcDC (first, last);
+            for (i = first; i < last; i++) (*func) (batch->get (i), this);
+        }
+    }
+    first = parallels.size () * k / n;
+    last = parallels.size () * (k + 1) / n;
+    for (i = first; i < last; i++) (*func) (parallels[i], this);
+}
+
+/* Each worker thread evaluates its part of the circuits.  The
+   exceptions thrown meanwhile are collected per thread. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::evaluateChunk (evaluate_func_t func, int k,
+        exceptionstack * errors)
+{
+    evaluateRange (func, k, threads);
+    errors->take (estack);
+}
+
+/* This function runs the given evaluation function for each circuit
+   of the netlist.  The circuits write stamps into their own matrices
+   only which are merged into the MNA matrix by createMatrix() in
+   netlist order afterwards, thus the result does not depend on the
+   number of threads.  Exceptions are passed on in chunk order. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::evaluate (evaluate_func_t func)
+{
+    if (threads <= 1 && batches.empty ())
+    {
+        evaluateAll (func);
+        return;
+    }
+
+    if (threads <= 1)
+    {
+        evaluateRange (func, 0, 1);
+    }
+    else
+    {
+        std::vector<exceptionstack> errors (threads);
+        threadpool::run (threads, [this, func, &errors] (int k)
+        {
+            evaluateChunk (func, k, &errors[k]);
+        });
+        for (int k = 0; k < threads; k++) estack.take (errors[k]);
+    }
+
+    // remaining circuits, these may depend on the devices above
+    for (unsigned int i = 0; i < serials.size (); i++)
+        (*func) (serials[i], this);
+}
+
+/* The function runs the given function for each circuit one after the
+   other, the ones independent of others grouped by type and the rest
+   in netlist order afterwards.  Without the evaluation set up the
+   circuits are run in netlist order. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::evaluateAll (evaluate_func_t func)
+{
+    if (ordered.empty ())
+    {
+        circuit * root = subnet->getRoot ();
+        for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+            (*func) (c, this);
+        return;
+    }
+    for (unsigned int i = 0; i < ordered.size (); i++)
+        (*func) (ordered[i], this);
+}
+
+/* This function reports the number of bypassed non-linear device
+   evaluations and disables the bypass for subsequent analyses. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::reportBypass (void)
+{
+    int calls = 0, hits = 0;
+    circuit * root = subnet->getRoot ();
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        if (!c->isNonLinear ()) continue;
+        calls += c->getBypassCalls ();
+        hits += c->getBypassHits ();
+        c->setBypass (0, 0);
+    }
+    if (calls > 0)
+    {
+        logprint (LOG_STATUS, "NOTIFY: %s: bypassed %d of %d non-linear device "
+                  "evaluations (%.1f%%)\n", getName (), hits, calls,
+                  100.0 * hits / calls);
     }
 }
 
+/* This function reports the convergence statistics of the iterative
+   linear solvers. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::reportKrylov (void)
+{
+    int solves = eqns->getKrylovSolves ();
+    if (!(eqnAlgo & ALGO_KRYLOV) || solves == 0) return;
+    logprint (LOG_STATUS, "NOTIFY: %s: %d %s solves, %.1f iterations on "
+              "average, largest residual %g, %d sparse LU fallbacks\n",
+              getName (), solves, eqnAlgo == ALGO_GMRES ? "GMRES" : "BiCGStab",
+              (double) eqns->getKrylovIterations () / solves,
+              (double) eqns->getKrylovResidual (), eqns->getKrylovFallbacks ());
+}
+
+/* This function reports the iterations and factorizations of the
+   chord and Broyden variants of the Newton iterations. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::reportNewton (void)
+{
+    if (newton == NEWTON_FULL || newtonIterations == 0) return;
+    logprint (LOG_STATUS, "NOTIFY: %s: %d Newton iterations, %d "
+              "factorizations, %d %s steps, %d reverted to full Newton\n",
+              getName (), newtonIterations, newtonFactorizations, chordSteps,
+              newton == NEWTON_CHORD ? "chord" : "Broyden", chordReverts);
+}
+
 /* This function goes through solution (the x vector) and saves the
    node voltages of the last iteration into each non-linear
    circuit. */
 template <class nr_type_t>
 void nasolver<nr_type_t>::saveNodeVoltages (void)
 {
-    int N = countNodes ();
-    struct nodelist_t * n;
-    // save all nodes except reference node
-    for (int r = 0; r < N; r++)
+    circuit * root = subnet->getRoot ();
+    // ports at the reference node get zero
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
     {
-        n = nlist->getNode (r);
-        /* for (int i = 0; i < n->size(); i++)*/
-	for(auto &currentn: *n)
-        {
-	  currentn->getCircuit()->setV (currentn->getPort (), x->get (r));
-        }
+        const int * p = c->getNodeRows ();
+        for (int i = 0; i < c->getSize (); i++)
+            c->setV (i, p[i] < 0 ? 0.0 : x->get (p[i]));
     }
-    // save reference node
-    n = nlist->getNode (-1);
-    for(auto &currentn: *n)
-      currentn->getCircuit()->setV (currentn->getPort (), 0.0);
 }
 
 /* This function goes through solution (the x vector) and saves the
@@ -1240,13 +2281,13 @@ template <class nr_type_t>
 void nasolver<nr_type_t>::saveBranchCurrents (void)
 {
     int N = countNodes ();
-    int M = countVoltageSources ();
-    circuit * vs;
+    circuit * root = subnet->getRoot ();
     // save all branch currents of voltage sources
-    for (int r = 0; r < M; r++)
+    for (circuit * vs = root; vs != NULL; vs = (circuit *) vs->getNext ())
     {
-        vs = findVoltageSource (r);
-        vs->setJ (r, x->get (r + N));
+        int v0 = vs->getVoltageSource (), vn = vs->getVoltageSources ();
+        for (int r = v0; r < v0 + vn; r++)
+            vs->setJ (r, x->get (r + N));
     }
 }
 
@@ -1314,6 +2355,19 @@ void nasolver<nr_type_t>::recallSolution (void)
     }
 }
 
+/* Starts the non-linear iterations at the given solution, the unknowns
+   not contained keep their current values. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::applySolution (const nasolution<nr_type_t> & s)
+{
+    solution = s;
+    recallSolution ();
+    if (xprev != NULL) *xprev = *x;
+    saveSolution ();
+    // propagate the solution to the non-linear circuits
+    restartNR ();
+}
+
 /* This function saves the results of a single solve() functionality
    into the output dataset. */
 template <class nr_type_t>
@@ -1323,31 +2377,13 @@ void nasolver<nr_type_t>::saveResults (const std::string &volts, const std::stri
     int N = countNodes ();
     int M = countVoltageSources ();
 
-    // add node voltage variables
-    if (!volts.empty())
+    // add node voltage and branch current variables
+    std::vector<qucs::vector *> & v = findResults (volts, amps, saveOPs, f);
+    for (int r = 0; r < N + M; r++)
     {
-        for (int r = 0; r < N; r++)
-        {
-	  std::string n = createV (r, volts, saveOPs);
-	  if(!n.empty())
-	    {
-                saveVariable (n, x->get (r), f);
-            }
-        }
-    }
-
-    // add branch current variables
-    if (!amps.empty())
-    {
-        for (int r = 0; r < M; r++)
-        {
-	  std::string n = createI (r, amps, saveOPs);
-	  if (!n.empty())
-            {
-                saveVariable (n, x->get (r + N), f);
-            }
-        }
+        if (v[r] != NULL) v[r]->add (x->get (r));
     }
+    bool listed = !saveList.empty ();
 
     // add voltage probe data
     if (!volts.empty())
@@ -1356,12 +2392,16 @@ void nasolver<nr_type_t>::saveResults (const std::string &volts, const std::stri
         for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
         {
             if (!c->isProbe ()) continue;
-            if (!c->getSubcircuit().empty() && !(saveOPs & SAVE_ALL)) continue;
+            if (listed) {
+              if (!isSaveCandidate (c->getName ())) continue;
+            }
+            else if (!c->getSubcircuit().empty() && !(saveOPs & SAVE_ALL)) continue;
             if (volts != "vn")
                 c->saveOperatingPoints ();
 	    std::string n = createOP (c->getName (), volts);
-            saveVariable (n, nr_complex_t (c->getOperatingPoint ("Vr"),
-            c->getOperatingPoint ("Vi")), f);
+            if (isSaved (c->getName (), n))
+                saveVariable (n, nr_complex_t (c->getOperatingPoint ("Vr"),
+                c->getOperatingPoint ("Vi")), f);
 
 	    //add watt probe data
 	    c->calcOperatingPoints ();
@@ -1376,35 +2416,169 @@ void nasolver<nr_type_t>::saveResults (const std::string &volts, const std::stri
 		if (strcmp(p.getName(), "VAr") == 0)
 		{
               	    std::string n = createOP(c->getName(), "S");
-              	    saveVariable (n, nr_complex_t (c->getOperatingPoint ("VAr"),
-                    c->getOperatingPoint ("VAi")), f);
+              	    if (isSaved (c->getName (), n))
+              	        saveVariable (n, nr_complex_t (c->getOperatingPoint ("VAr"),
+                        c->getOperatingPoint ("VAi")), f);
 		   continue;
 		}
            	
            	std::string n = createOP(c->getName(), p.getName());
-           	saveVariable(n, p.getValue(), f);
+           	if (isSaved (c->getName (), n))
+           	    saveVariable(n, p.getValue(), f);
        	    }	    
 	    	    
         }
     }
 
-    // save operating points of non-linear circuits if requested
-    if (saveOPs & SAVE_OPS)
+    // save operating points of non-linear circuits if requested, a
+    // save list requests the ones it names
+    if ((saveOPs & SAVE_OPS) || listed)
     {
         circuit * root = subnet->getRoot ();
         for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
         {
             if (!c->isNonLinear ()) continue;
-            if (!c->getSubcircuit ().empty() && !(saveOPs & SAVE_ALL)) continue;
+            if (listed) {
+              if (!isSaveCandidate (c->getName ())) continue;
+            }
+            else if (!c->getSubcircuit ().empty() && !(saveOPs & SAVE_ALL)) continue;
             c->calcOperatingPoints ();
             for (auto ops: c->getOperatingPoints ())
             {
                 operatingpoint &p = ops.second;
 		std::string n = createOP (c->getName (), p.getName ());
-                saveVariable (n, p.getValue (), f);
+                if (isSaved (c->getName (), n))
+                    saveVariable (n, p.getValue (), f);
+            }
+        }
+    }
+
+    // move long vectors out of memory when streaming
+    data->flush ();
+}
+
+/* Returns the dataset vectors of the node voltages and branch currents
+   saved under the given names.  The variable names are created and
+   looked up in the dataset at the first result point of an analysis
+   run only, the vectors are preallocated for the result points of the
+   run then. */
+template <class nr_type_t>
+std::vector<qucs::vector *> &
+nasolver<nr_type_t>::findResults (const std::string &volts,
+                                  const std::string &amps, int saveOPs,
+                                  qucs::vector * f)
+{
+    for (naresults_t & r : results)
+    {
+        if (r.volts == volts && r.amps == amps && r.saveOPs == saveOPs &&
+            r.f == f)
+            return r.vectors;
+    }
+
+    int N = countNodes ();
+    int M = countVoltageSources ();
+    naresults_t res;
+    res.volts = volts;
+    res.amps = amps;
+    res.saveOPs = saveOPs;
+    res.f = f;
+    res.vectors.assign (N + M, NULL);
+
+    // a save list may also name subcircuit nodes and any branch current
+    initSaveList ();
+    int flags = saveList.empty () ? saveOPs : (SAVE_OPS | SAVE_ALL);
+    for (int r = 0; r < N && !volts.empty (); r++)
+    {
+        std::string n = createV (r, volts, flags);
+        if (!n.empty () && isSaved (nlist->get (r), n))
+            res.vectors[r] = findVariable (n, f);
+    }
+    for (int r = 0; r < M && !amps.empty (); r++)
+    {
+        std::string n = createI (r, amps, flags);
+        if (!n.empty () && isSaved (findVoltageSource (r)->getName (), n))
+            res.vectors[r + N] = findVariable (n, f);
+    }
+    reserveVariable (f);
+    results.push_back (res);
+    return results.back ().vectors;
+}
+
+/* Reads the "Save" property of the analysis: patterns separated by
+   commas, semicolons or spaces, each one naming outputs like "out",
+   "X1.*", "**.Vt" or "D1.Id". */
+template <class nr_type_t>
+void nasolver<nr_type_t>::initSaveList (void)
+{
+    saveList.clear ();
+    const char * const s = getPropertyString ("Save");
+    if (s == NULL) return;
+    std::string list = s;
+    size_t pos = 0;
+    while (pos < list.size ())
+    {
+        size_t end = list.find_first_of (",; ", pos);
+        if (end == std::string::npos) end = list.size ();
+        if (end > pos) saveList.push_back (list.substr (pos, end - pos));
+        pos = end + 1;
+    }
+}
+
+/* Matches the name against the pattern.  '?' and '*' stand for one or
+   any number of characters within a hierarchy level, '**' also spans
+   the dots between the levels of subcircuits. */
+template <class nr_type_t>
+bool nasolver<nr_type_t>::saveMatch (const char * p, const char * s)
+{
+    for (; *p; p++, s++)
+    {
+        if (*p == '*')
+        {
+            bool deep = (p[1] == '*');
+            if (deep) p++;
+            for (;; s++)
+            {
+                if (saveMatch (p + 1, s)) return true;
+                if (!*s || (!deep && *s == '.')) return false;
             }
         }
+        if (!*s) return false;
+        if (*p == '?' ? *s == '.' : *p != *s) return false;
     }
+    return !*s;
+}
+
+/* Returns whether an output is selected by the save list: its full
+   name (e.g. "X1.out.Vt") or the name of its node or circuit matches
+   one of the patterns. */
+template <class nr_type_t>
+bool nasolver<nr_type_t>::isSaved (const std::string & object,
+                                   const std::string & name) const
+{
+    if (saveList.empty ()) return true;
+    for (const std::string & p : saveList)
+        if (saveMatch (p.c_str (), object.c_str ()) ||
+            saveMatch (p.c_str (), name.c_str ()))
+            return true;
+    return false;
+}
+
+/* Returns whether any output of the circuit may be selected by the
+   save list, so that its operating points are worth computing. */
+template <class nr_type_t>
+bool nasolver<nr_type_t>::isSaveCandidate (const std::string & object) const
+{
+    if (saveList.empty ()) return true;
+    for (const std::string & p : saveList)
+    {
+        if (saveMatch (p.c_str (), object.c_str ())) return true;
+        size_t dot = p.rfind ('.');
+        if (dot != std::string::npos &&
+            saveMatch (p.substr (0, dot).c_str (), object.c_str ()))
+            return true;
+        if (p.find ("**") != std::string::npos) return true;
+    }
+    return false;
 }
 
 /* Create an appropriate variable name for operating points.  The
@@ -1458,6 +2632,239 @@ std::string nasolver<nr_type_t>::createI (int n, const std::string &amps, int sa
 }
 
 
+/* Adds the residual of the given circuit's equations at the current
+   solution, weighted by w, to the rows of the MNA equation system. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::circuitResidual (circuit * c,
+                                           std::map<int, nr_type_t> & res,
+                                           nr_double_t w)
+{
+    int N = countNodes ();
+    int v0 = c->getVoltageSource (), vn = c->getVoltageSources ();
+    const int * p = c->getNodeRows ();
+    bool source = c->isISource () || c->isNonLinear ();
+    for (int r = 0; r < c->getSize (); r++)
+    {
+        if (p[r] < 0) continue;
+        nr_type_t f = source ? -MatVal (c->getI (r)) : 0;
+        for (int k = 0; k < c->getSize (); k++)
+            if (p[k] >= 0) f += MatVal (c->getY (r, k)) * x->get (p[k]);
+        for (int v = v0; v < v0 + vn; v++)
+            f += MatVal (c->getB (r, v)) * x->get (v + N);
+        res[p[r]] += w * f;
+    }
+    for (int v = v0; v < v0 + vn; v++)
+    {
+        nr_type_t f = -MatVal (c->getE (v));
+        for (int k = 0; k < c->getSize (); k++)
+            if (p[k] >= 0) f += MatVal (c->getC (v, k)) * x->get (p[k]);
+        for (int u = v0; u < v0 + vn; u++)
+            f += MatVal (c->getD (v, u)) * x->get (u + N);
+        res[v + N] += w * f;
+    }
+}
+
+/* The function assembles the MNA matrix, or its transpose, from the
+   stamps of the circuits into the given dense matrix. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::stampMatrix (tmatrix<nr_type_t> & A, bool transposed)
+{
+    int N = countNodes ();
+    A.set (0.0);
+    for (circuit * c = subnet->getRoot (); c != NULL; c = (circuit *) c->getNext ())
+    {
+        int v0 = c->getVoltageSource (), vn = c->getVoltageSources ();
+        const int * p = c->getNodeRows ();
+        for (int r = 0; r < c->getSize (); r++)
+        {
+            if (p[r] < 0) continue;
+            for (int k = 0; k < c->getSize (); k++)
+            {
+                if (p[k] < 0) continue;
+                if (transposed)
+                    A (p[k], p[r]) += MatVal (c->getY (r, k));
+                else
+                    A (p[r], p[k]) += MatVal (c->getY (r, k));
+            }
+            for (int v = v0; v < v0 + vn; v++)
+            {
+                if (transposed)
+                {
+                    A (v + N, p[r]) += MatVal (c->getB (r, v));
+                    A (p[r], v + N) += MatVal (c->getC (v, r));
+                }
+                else
+                {
+                    A (p[r], v + N) += MatVal (c->getB (r, v));
+                    A (v + N, p[r]) += MatVal (c->getC (v, r));
+                }
+            }
+        }
+        for (int v = v0; v < v0 + vn; v++)
+            for (int u = v0; u < v0 + vn; u++)
+            {
+                if (transposed)
+                    A (u + N, v + N) = MatVal (c->getD (v, u));
+                else
+                    A (v + N, u + N) = MatVal (c->getD (v, u));
+            }
+    }
+}
+
+/* Computes the residual F = A x - z of the equations at the current
+   solution from the circuits, which are expected to be evaluated
+   there. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::stampResidual (tvector<nr_type_t> & F)
+{
+    std::map<int, nr_type_t> res;
+    for (circuit * c = subnet->getRoot (); c != NULL; c = (circuit *) c->getNext ())
+        circuitResidual (c, res, 1);
+    F.set (0.0);
+    for (auto & e : res) F.set (e.first, e.second);
+}
+
+/* Initializes all the circuits again by the given function, e.g. after
+   a parameter of the netlist changed, and sets up their evaluation
+   again.  The circuits get the current solution, the non-linear ones
+   are evaluated right there without limiting. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::reinitialize (evaluate_func_t init)
+{
+    for (circuit * c = subnet->getRoot (); c != NULL; c = (circuit *) c->getNext ())
+        init (c, this);
+    setupBypass ();
+    setupEvaluation ();
+    saveSolution ();
+    restartNR ();
+}
+
+/* The function saves the derivatives of the given outputs, node
+   voltages or currents of voltage sources, with respect to every
+   numeric property of every circuit.  The circuits are expected to
+   be evaluated at the solution.  The adjoint system A' L = e is
+   solved once for all outputs.  The derivative of an output is then
+   -L' dF/dp, the residual F of the equations being differentiated
+   for each parameter of a circuit.  Only that circuit is initialized
+   and evaluated again for it by the given functions, keeping its node
+   voltages and branch currents.  Parameters being zero, and those of
+   non-linear circuits unless requested, are skipped. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::saveSensitivities (const std::string & outputs,
+                                             const std::string & volts,
+                                             const std::string & amps,
+                                             evaluate_func_t init,
+                                             evaluate_func_t calc,
+                                             bool nonlinear,
+                                             qucs::vector * f)
+{
+    int N = countNodes ();
+    int M = countVoltageSources ();
+    circuit * root = subnet->getRoot ();
+
+    // find the unknowns of the requested outputs
+    std::vector<int> rows;
+    std::vector<std::string> names;
+    size_t pos = 0;
+    while (pos < outputs.size ())
+    {
+        size_t end = outputs.find_first_of (",; ", pos);
+        if (end == std::string::npos) end = outputs.size ();
+        std::string out = outputs.substr (pos, end - pos);
+        pos = end + 1;
+        if (out.empty ()) continue;
+        int r = getNodeNr (out);
+        if (r > 0)
+        {
+            rows.push_back (r - 1);
+            names.push_back (out + "." + volts);
+            continue;
+        }
+        for (circuit * c = root; c != NULL && r <= 0;
+             c = (circuit *) c->getNext ())
+        {
+            if (out == c->getName () && c->getVoltageSources () > 0)
+                r = N + c->getVoltageSource () + 1;
+        }
+        if (r > 0)
+        {
+            rows.push_back (r - 1);
+            names.push_back (out + "." + amps);
+            continue;
+        }
+        logprint (LOG_ERROR, "WARNING: %s: no such sensitivity output `%s'\n",
+                  getName (), out.c_str ());
+    }
+    int O = rows.size ();
+    if (O == 0) return;
+
+    // evaluate the circuits at the solution
+    calculate ();
+
+    // the transposed MNA matrix, assembled from the circuits
+    tmatrix<nr_type_t> At (N + M);
+    stampMatrix (At, true);
+
+    // the adjoint solutions of all outputs at once
+    tvector<nr_type_t> xa (N + M), za (N + M);
+    tmatrix<nr_type_t> E (N + M, O), L (N + M, O);
+    for (int o = 0; o < O; o++) E (rows[o], o) = 1;
+    eqnsys<nr_type_t> adjoint;
+    adjoint.setAlgo (ALGO_LU_DECOMPOSITION);
+    adjoint.passEquationSys (&At, &xa, &za);
+    int mark = numstatus::mark ();
+    adjoint.factorize ();
+    if (numstatus::raised (mark))
+    {
+        numstatus::release (mark);
+        logprint (LOG_ERROR, "WARNING: %s: singular adjoint system, no "
+                  "sensitivities saved\n", getName ());
+        return;
+    }
+    adjoint.solveMany (&E, &L);
+
+    // differentiate the residual of each circuit for its parameters
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        if (c->isNonLinear () && !nonlinear) continue;
+        std::vector<nr_complex_t> V (c->getSize ());
+        std::vector<nr_complex_t> J (c->getVoltageSources ());
+        int v0 = c->getVoltageSource ();
+        for (int i = 0; i < (int) V.size (); i++) V[i] = c->getV (i);
+        for (int i = 0; i < (int) J.size (); i++) J[i] = c->getJ (i);
+        auto restamp = [&] (const std::string & key, nr_double_t val)
+        {
+            c->setProperty (key, val);
+            init (c, this);
+            for (int i = 0; i < (int) V.size (); i++) c->setV (i, V[i]);
+            for (int i = 0; i < (int) J.size (); i++) c->setJ (v0 + i, J[i]);
+            c->resetBypass ();
+            calc (c, this);
+        };
+        for (const std::string & n : c->getDoubleProperties ())
+        {
+            std::string key = c->hasProperty ("Scaled:" + n) ? "Scaled:" + n : n;
+            nr_double_t val = c->getPropertyDouble (key);
+            if (val == 0) continue;
+            nr_double_t delta = NA_SENS_DELTA * fabs (val);
+            std::map<int, nr_type_t> dF;
+            restamp (key, val + delta);
+            circuitResidual (c, dF, +0.5 / delta);
+            restamp (key, val - delta);
+            circuitResidual (c, dF, -0.5 / delta);
+            restamp (key, val);
+
+            std::string param = std::string (c->getName ()) + "." + n;
+            for (int o = 0; o < O; o++)
+            {
+                nr_type_t d = 0;
+                for (auto & e : dF) d -= L (e.first, o) * e.second;
+                saveVariable (names[o] + ".sens." + param, d, f);
+            }
+        }
+    }
+}
+
 /* Alternaive to countNodes () */
 template <class nr_type_t>
 int nasolver<nr_type_t>::getN()
@@ -31,11 +31,16 @@
 // BUG
 #include "qucs_typedefs.h"
 #endif
+#include <vector>
+#include <map>
+
 #include "tvector.h"
 #include "tmatrix.h"
+#include "tspmatrix.h"
 #include "eqnsys.h"
 #include "nasolution.h"
 #include "analysis.h"
+#include "exceptionstack.h"
 
 // Convergence helper definitions.
 #define CONV_None            0
@@ -45,10 +50,51 @@
 #define CONV_GMinStepping    4
 #define CONV_SourceStepping  5
 
+// Minimum MNA matrix size for sparse matrix assembly.
+#define SPARSE_MNA_SIZE      16
+
+// Residual tolerance of the Krylov solvers relative to reltol and the
+// fill level of their ILU preconditioner.
+#define NA_KRYLOV_TOL        1e-3
+#define NA_KRYLOV_FILL       1
+
+// Minimum number of concurrently evaluated circuits per worker thread.
+#define NA_PARALLEL_MIN      32
+
+// Minimum number of circuits of one type for a batched evaluation.
+#define NA_BATCH_MIN         16
+
+// Number of circuits of a batch evaluated together by a worker thread.
+#define NA_BATCH_BLOCK       64
+
+// Maximum number of non-linear unknowns for the Schur complement solver.
+#define NA_SCHUR_MAX         256
+
+// Variants of the Newton iterations.
+#define NEWTON_FULL          0
+#define NEWTON_CHORD         1
+#define NEWTON_BROYDEN       2
+
+// Reduction of the residual per iteration the chord and Broyden
+// iterations must achieve to keep the factorization of the Jacobian,
+// and the maximum number of iterations per factorization.
+#define NA_CHORD_RATE        0.5
+#define NA_CHORD_MAX         8
+
+// Relative change of the parameters for the derivatives of the stamps.
+#define NA_SENS_DELTA        1e-6
+
+// Maximum number of matrix columns differing from the factorized base
+// system of a parameter sweep solved by a low-rank update, and the
+// residual tolerance relative to the magnitude of the equations.
+#define NA_LOWRANK_MAX       16
+#define NA_LOWRANK_TOL       1e-12
+
 namespace qucs {
 
 class analysis;
 class circuit;
+class circuitbatch;
 class nodelist;
 class vector;
 
@@ -76,6 +122,12 @@ public:
     {
         if (calculate_func) (*calculate_func) (this);
     }
+    typedef void (* evaluate_func_t) (circuit *, nasolver<nr_type_t> *);
+    void evaluate (evaluate_func_t);
+    void evaluateAll (evaluate_func_t);
+    void saveSensitivities (const std::string &, const std::string &,
+                            const std::string &, evaluate_func_t,
+                            evaluate_func_t, bool, qucs::vector * f = NULL);
     const char * getHelperDescription (void);
 
     //interface convenience functions
@@ -100,27 +152,62 @@ protected:
     void createMatrix (void);
     void storeSolution (void);
     void recallSolution (void);
+    void applySolution (const nasolution<nr_type_t> &);
     int  checkConvergence (void);
+    int  checkErrors (void);
+    int  isFiniteMatrix (void);
+    void stampMatrix (tmatrix<nr_type_t> &, bool transposed = false);
+    void stampResidual (tvector<nr_type_t> &);
+    void reinitialize (evaluate_func_t);
+    void clearLowRank (void);
 
 private:
     void assignVoltageSources (void);
+    void assignNodeRows (void);
     void createGMatrix (void);
     void createBMatrix (void);
     void createCMatrix (void);
     void createDMatrix (void);
+    void createStamps (void);
+    void createSparseMatrix (void);
+    void addStamps (int, int);
+    void createSchur (const std::vector<bool> &);
+    void clearSchur (void);
+    int  factorizeSchur (void);
+    void runSchur (void);
+    int  runLowRank (void);
+    int  runChord (void);
+    void newtonResidual (tvector<nr_type_t> &);
+    void solveFactorized (tvector<nr_type_t> *, tvector<nr_type_t> *);
+    int  factorizeLowRank (void);
     void createIVector (void);
     void createEVector (void);
     void createZVector (void);
     void applyAttenuation (void);
     void lineSearch (void);
     void steepestDescent (void);
+    void recordIteration (void);
+    void reportConvergence (int);
+    void setupBypass (void);
+    void reportBypass (void);
+    void reportKrylov (void);
+    void reportNewton (void);
+    void setupEvaluation (void);
+    void clearEvaluation (void);
+    void evaluateRange (evaluate_func_t, int, int);
+    void evaluateChunk (evaluate_func_t, int, exceptionstack *);
+    static bool typeOrder (circuit *, circuit *);
     std::string createV (int, const std::string&, int);
     std::string createI (int, const std::string&, int);
     std::string createOP (const std::string&, const std::string &);
+    std::vector<qucs::vector *> & findResults (const std::string &,
+                                               const std::string &, int,
+                                               qucs::vector *);
     void saveNodeVoltages (void);
     void saveBranchCurrents (void);
     nr_type_t MatValX (nr_complex_t, nr_complex_t *);
     nr_type_t MatValX (nr_complex_t, nr_double_t *);
+    void circuitResidual (circuit *, std::map<int, nr_type_t> &, nr_double_t);
 
 protected:
     tvector<nr_type_t> * z;
@@ -128,22 +215,116 @@ protected:
     tvector<nr_type_t> * xprev;
     tvector<nr_type_t> * zprev;
     tmatrix<nr_type_t> * A;
+    tspmatrix<nr_type_t> * As;
     tmatrix<nr_type_t> * C;
     int iterations;
     int convHelper;
     int fixpoint;
     int eqnAlgo;
     int updateMatrix;
+    int lowRank;
     nr_double_t gMin, srcFactor;
     std::string desc;
     nodelist * nlist;
+    nasolution<nr_type_t> solution;
 
 private:
+    /* Location of a circuit matrix entry inside the sparse MNA matrix.
+       The type is one of the minor matrices G, B, C or D. */
+    struct nastamp_t
+    {
+        circuit * ct;
+        char type;
+        int r, c;
+        int slot;
+    };
+    std::vector<nastamp_t> stamps;
     eqnsys<nr_type_t> * eqns;
+
+    /* The stamps of linear circuits come first.  Their contribution to
+       the sparse A matrix is kept and restamped only once per non-linear
+       solve. */
+    int linearStamps;
+    int keepLinear;
+    int linearValid;
+    std::vector<nr_type_t> linear;
+
+    /* Splitting of the unknowns into inner ones, touched by linear
+       circuits only, and boundary ones.  During non-linear iterations
+       the inner part is eliminated by its factorized Schur complement
+       onto the boundary unknowns. */
+    struct naentry_t
+    {
+        int r, c;
+        int slot;
+    };
+    int schur;
+    int schurValid;
+    std::vector<int> inner;
+    std::vector<int> bound;
+    std::vector<std::pair<int, int> > schurII;
+    std::vector<naentry_t> schurIB;
+    std::vector<naentry_t> schurBI;
+    std::vector<naentry_t> schurBB;
+    tspmatrix<nr_type_t> * Aii;
+    std::vector<tvector<nr_type_t> > schurW;
+    tmatrix<nr_type_t> schurS0;
+    tmatrix<nr_type_t> schurS;
+    tvector<nr_type_t> xi, zi, xb, zb;
+    eqnsys<nr_type_t> * eqnsI;
+    eqnsys<nr_type_t> * eqnsB;
+
+    /* Factorized linear system of a previous point of a parameter sweep.
+       Systems differing from it in a few columns only, e.g. by the value
+       of a swept resistor, are solved by the Sherman-Morrison-Woodbury
+       formula without a factorization. */
+    eqnsys<nr_type_t> * eqnsL;
+    int lowRankValid;
+    tmatrix<nr_type_t> lowRankF;
+    std::vector<nr_type_t> lowRankA;
+    std::vector<int> lowRankColPtr, lowRankRowIdx;
+
+    /* The chord and Broyden variants of the Newton iterations keep the
+       factorization of the Jacobian of a full Newton step as long as
+       the residual decreases fast enough.  The steps taken since are
+       kept for the Broyden updates.  The dense factors are kept apart
+       from the A matrix being assembled anew each iteration. */
+    int newton;
+    int chordValid;
+    nr_double_t chordNorm;
+    tmatrix<nr_type_t> chordF;
+    tvector<nr_type_t> chordR, chordX;
+    std::vector<tvector<nr_type_t> > chordS;
+    int newtonIterations, newtonFactorizations, chordSteps, chordReverts;
     nr_double_t reltol;
     nr_double_t abstol;
     nr_double_t vntol;
-    nasolution<nr_type_t> solution;
+    nr_double_t damping;
+    int threads;
+    std::vector<circuit *> parallels;
+    std::vector<circuit *> serials;
+    std::vector<circuitbatch *> batches;
+    std::vector<circuit *> ordered;
+
+    /* The dataset vectors of the node voltages and branch currents,
+       NULL for unknowns not saved, resolved once per analysis run for
+       each set of variable names and dependency. */
+    struct naresults_t
+    {
+        std::string volts, amps;
+        int saveOPs;
+        qucs::vector * f;
+        std::vector<qucs::vector *> vectors;
+    };
+    std::vector<naresults_t> results;
+
+    /* Patterns of the "Save" property selecting the saved outputs, all
+       outputs are saved if it is empty. */
+    std::vector<std::string> saveList;
+    void initSaveList (void);
+    bool isSaved (const std::string &, const std::string &) const;
+    bool isSaveCandidate (const std::string &) const;
+    static bool saveMatch (const char *, const char *);
 
 private:
 
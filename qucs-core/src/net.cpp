@@ -30,6 +30,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <set>
+#include <map>
+#include <algorithm>
+
+#if HAVE_FORK
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
 
 #include "logging.h"
 #include "complex.h"
@@ -50,6 +59,10 @@
 #include "equation.h"
 #include "environment.h"
 #include "component_id.h"
+#include "profile.h"
+#include "resultcache.h"
+#include "threadpool.h"
+#include "opcache.h"
 
 namespace qucs {
 
@@ -63,6 +76,11 @@ net::net () : object () {
   env = NULL;
   nset = NULL;
   srcFactor = 1;
+  breakStop = 0;
+  nStamps = 0;
+  jobs = 1;
+  pool = new arena ();
+  pool->activate ();
 }
 
 // Constructor creates a named instance of the net class.
@@ -75,6 +93,11 @@ net::net (const std::string &n) : object (n) {
   env = NULL;
   nset = NULL;
   srcFactor = 1;
+  breakStop = 0;
+  nStamps = 0;
+  jobs = 1;
+  pool = new arena ();
+  pool->activate ();
 }
 
 // Destructor deletes the net class object.
@@ -95,6 +118,8 @@ net::~net () {
   // delete nodeset
   delNodeset ();
   delete actions;
+  // release the arena as soon as its remaining objects are gone
+  if (pool) pool->close ();
 }
 
 /* The copy constructor creates a new instance of the net class based
@@ -108,6 +133,10 @@ net::net (net & n) : object (n) {
   env = n.env;
   nset = NULL;
   srcFactor = 1;
+  breakStop = 0;
+  nStamps = 0;
+  jobs = n.jobs;
+  pool = NULL;
 }
 
 /* This function prepends the given circuit to the list of registered
@@ -125,6 +154,7 @@ void net::insertCircuit (circuit * c) {
   nCircuits++;
   c->setEnabled (1);
   c->setNet (this);
+  indexCircuit (c);
 
   /* handle AC power sources as s-parameter ports if it is not part of
      a subcircuit */
@@ -158,6 +188,7 @@ void net::removeCircuit (circuit * c, int dropping) {
   nCircuits--;
   c->setEnabled (0);
   c->setNet (NULL);
+  unindexCircuit (c);
   if (c->getPort ()) nPorts--;
   if (c->getVoltageSource () >= 0) nSources -= c->getVoltageSources ();
 
@@ -177,9 +208,44 @@ void net::removeCircuit (circuit * c, int dropping) {
 /* The function returns non-zero if the given circuit is already part
    of the netlist. It returns zero if not. */
 int net::containsCircuit (circuit * cand) {
-  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
-    if (c == cand) return 1;
-  return 0;
+  return stamps.count (cand) ? 1 : 0;
+}
+
+/* Records the terminals of the given inserted circuit.  These must
+   know their circuit in order to report their renaming. */
+void net::indexCircuit (circuit * c) {
+  stamps[c] = nStamps++;
+  for (int i = 0; i < c->getSize (); i++) {
+    node * n = c->getNode (i);
+    n->setCircuit (c);
+    terminals[n->getName ()].push_back (n);
+  }
+}
+
+// Forgets the terminals of the given removed circuit.
+void net::unindexCircuit (circuit * c) {
+  if (!stamps.erase (c)) return;
+  for (int i = 0; i < c->getSize (); i++) {
+    node * n = c->getNode (i);
+    unindexNode (n, n->getName ());
+  }
+}
+
+// Removes the given terminal from the entry of the given node name.
+void net::unindexNode (node * n, const std::string & name) {
+  auto it = terminals.find (name);
+  if (it == terminals.end ()) return;
+  std::vector<node *> & t = it->second;
+  t.erase (std::remove (t.begin (), t.end (), n), t.end ());
+  if (t.empty ()) terminals.erase (it);
+}
+
+/* The function moves the given terminal of a registered circuit from
+   the entry of its old node name to the one of its current name. */
+void net::renamedNode (node * n, const std::string & old) {
+  if (!stamps.count (n->getCircuit ())) return;
+  unindexNode (n, old);
+  terminals[n->getName ()].push_back (n);
 }
 
 /* This function prepends the given analysis to the list of registered
@@ -233,8 +299,8 @@ int net::containsAnalysis (analysis * child, int type) {
 
 /* This function runs all registered analyses applied to the current
    netlist, except for external analysis types. */
-dataset * net::runAnalysis (int &err) {
-  dataset * out = new dataset ();
+dataset * net::runAnalysis (int &err, dataset * out) {
+  if (out == NULL) out = new dataset ();
 
   // apply some data to all analyses
   for (auto *a : *actions) {
@@ -247,27 +313,64 @@ dataset * net::runAnalysis (int &err) {
 
   // re-order analyses
   orderAnalysis ();
+  opcache::clear ();
+
+  // unchanged analyses take their results from the cache
+  std::set<analysis *> cached;
+  for (auto *a: * actions) {
+    if (!a->isExternal () && resultcache::fetch (a, out))
+      cached.insert (a);
+  }
 
   // initialize analyses
   for (auto *a: * actions) {
-    if (!a->isExternal ())
+    if (!a->isExternal () && !cached.count (a))
     {
-      err |= a->initialize ();
+      profile::enter (a->getName (), a->getType ());
+      {
+        profile::phase p (PROFILE_SETUP);
+        err |= a->initialize ();
+      }
+      profile::leave ();
     }
   }
 
   // solve the analyses
+  std::vector<analysis *> todo;
   for (auto *a: * actions) {
-    if (!a->isExternal ())
-    {
-      a->getEnv()->runSolver ();
-      err |= a->solve ();
+    if (!a->isExternal () && !cached.count (a))
+      todo.push_back (a);
+  }
+  size_t i = 0;
+#if HAVE_FORK
+  /* The analyses behind the last one running a DC analysis neither
+     depend on each other nor on the operating point they leave, thus
+     these are solved in parallel if requested. */
+  size_t parallel = todo.size ();
+  if (jobs > 1) {
+    for (parallel = 0; i < todo.size (); i++)
+      if (todo[i]->getType () == ANALYSIS_DC ||
+	  containsAnalysis (todo[i], ANALYSIS_DC))
+	parallel = i + 1;
+  }
+  for (i = 0; i < parallel; i++) {
+    err |= solveAnalysis (todo[i], out);
+  }
+  if (todo.size () - parallel > 1) {
+    int e = solveParallel (todo, parallel, out);
+    if (e >= 0) {
+      err |= e;
+      i = todo.size ();
     }
   }
+#endif
+  for (; i < todo.size (); i++) {
+    err |= solveAnalysis (todo[i], out);
+  }
 
   // cleanup analyses
   for (auto *a: *actions) {
-    if (!a->isExternal ())
+    if (!a->isExternal () && !cached.count (a))
     {
         err |= a->cleanup ();
     }
@@ -276,6 +379,101 @@ dataset * net::runAnalysis (int &err) {
   return out;
 }
 
+/* The function solves the given analysis and keeps its results in the
+   cache if it succeeded. */
+int net::solveAnalysis (analysis * a, dataset * out) {
+  profile::enter (a->getName (), a->getType ());
+  {
+    profile::phase p (PROFILE_EQUATIONS);
+    a->getEnv()->runSolver ();
+  }
+  int err = a->solve ();
+  logflush ();
+  if (!err) resultcache::store (a, out);
+  profile::leave ();
+  return err;
+}
+
+#if HAVE_FORK
+/* The parallel run solves each of the given analyses starting at the
+   given index in a forked process working on its own copy of the
+   netlist, at most the number of jobs at a time.  The process writes
+   the data it added to the dataset into a temporary file and the
+   results are merged in the order of the analyses, thus the output is
+   the same as for the serial run.  The function returns -1 if the
+   processes could not be created or did not end properly, otherwise
+   the merged error state. */
+int net::solveParallel (std::vector<analysis *> & todo, size_t first,
+			dataset * out) {
+  size_t c, k, n = todo.size () - first;
+  std::vector<pid_t> pids (n, -1);
+  std::vector<FILE *> files (n, (FILE *) NULL);
+  std::vector<int> status (n, 0);
+  std::map<std::string,int> sizes = out->getSizes ();
+  int err = 0, failed = 0;
+
+  // flush output streams before the processes share them
+  logflush ();
+  fflush (NULL);
+  for (c = k = 0; c < n; c++) {
+    // wait for the earliest process if all jobs are busy
+    for (; c - k >= (size_t) jobs; k++)
+      waitpid (pids[k], &status[k], 0);
+    if ((files[c] = tmpfile ()) == NULL) break;
+    if ((pids[c] = fork ()) < 0) break;
+    if (pids[c] == 0) {
+      // child process: solve the analysis and save its data
+      analysis * a = todo[first + c];
+      threadpool::share (jobs);
+      a->setProgress (false);
+      // the merge relies on the vectors being complete in memory
+      out->setStreaming (0);
+      {
+	profile::phase p (PROFILE_EQUATIONS);
+	a->getEnv()->runSolver ();
+      }
+      int e = a->solve ();
+      out->writeAdded (files[c], sizes);
+      logflush ();
+      fflush (NULL);
+      _exit (e ? 1 : 0);
+    }
+  }
+
+  // collect the remaining child processes
+  failed = c < n;
+  for (; k < n; k++) {
+    if (pids[k] > 0) waitpid (pids[k], &status[k], 0);
+  }
+  for (k = 0; k < n && !failed; k++) {
+    if (!WIFEXITED (status[k]) || WEXITSTATUS (status[k]) > 1) failed = 1;
+  }
+
+  // merge the results in the order of the analyses
+  if (!failed) {
+    for (c = 0; c < n; c++) {
+      analysis * a = todo[first + c];
+      rewind (files[c]);
+      if (out->mergeAdded (files[c])) {
+	logprint (LOG_ERROR, "ERROR: %s: unable to merge results of analysis "
+		  "process\n", a->getName ());
+	err = 1;
+      }
+      else if (WEXITSTATUS (status[c]) == 1)
+	err = 1;
+      else
+	resultcache::store (a, out);
+    }
+  }
+  else {
+    logprint (LOG_ERROR, "WARNING: parallel analyses failed, running "
+	      "serial analyses\n");
+  }
+  for (c = 0; c < n; c++) if (files[c]) fclose (files[c]);
+  return failed ? -1 : err;
+}
+#endif /* HAVE_FORK */
+
 /* The function returns the analysis with the second lowest order.  If
    there is no recursive sweep it returns NULL. */
 analysis * net::findSecondOrder (void) {
@@ -428,46 +626,45 @@ void net::deleteUnusedCircuits (nodelist * nodes) {
    connected to the given node.  If there is no such node (unconnected
    node) the function returns NULL. */
 node * net::findConnectedCircuitNode (node * n) {
-
-  const char * _name = n->getName ();
-  node * _node;
-
-  // through the list of circuit objects
-  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
-    // skip signal circuits
-    if (c->getPort ()) continue;
-    // through the list of nodes in a circuit
-    for (int i = 0; i < c->getSize (); i++) {
-      _node = c->getNode (i);
-      if (!strcmp (_node->getName (), _name)) {
-	if (_node != n) {
-	  return _node;
-	}
-      }
+  return findPartner (n, true);
+}
+
+/* Returns the terminal connected to the given node which comes first
+   in the list of circuit objects, i.e. the one of the latest inserted
+   circuit and the lowest of its terminals.  Signal circuits are
+   skipped if requested. */
+node * net::findPartner (node * n, bool real) {
+  auto it = terminals.find (n->getName ());
+  if (it == terminals.end ()) return NULL;
+  node * best = NULL;
+  long first = -1;
+  for (node * t : it->second) {
+    if (t == n) continue;
+    circuit * c = t->getCircuit ();
+    if (real && c->getPort ()) continue;
+    long stamp = stamps[c];
+    if (stamp > first || (stamp == first && t < best)) {
+      best = t;
+      first = stamp;
     }
   }
-  return NULL;
+  return best;
 }
 
 /* Returns the first node in the list of circuit objects (including
    signals) connected to the given node.  If there is no such node
    (unconnected node) the function returns NULL. */
 node * net::findConnectedNode (node * n) {
+  return findPartner (n, false);
+}
 
-  const char * _name = n->getName ();
-  node * _node;
-
-  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
-    for (int i = 0; i < c->getSize (); i++) {
-      _node = c->getNode (i);
-      if (!strcmp (_node->getName (), _name)) {
-	if (_node != n) {
-	  return _node;
-	}
-      }
-    }
-  }
-  return NULL;
+/* Renames the node.  The netlist of its circuit keeps its terminals
+   by node name, thus it is told about the new name. */
+void node::setName (const std::string & n) {
+  std::string old = getName ();
+  object::setName (n);
+  if (_circuit != NULL && _circuit->getNet () != NULL)
+    _circuit->getNet()->renamedNode (this, old);
 }
 
 // Rename the given circuit and mark it as being a reduced one.
@@ -487,6 +684,19 @@ void net::insertedCircuit (circuit * c) {
   inserted++;
 }
 
+/* Starts a new table of transient breakpoints.  Later ones than the
+   given stop time are not recorded. */
+void net::clearBreakpoints (nr_double_t stop) {
+  breakpoints.clear ();
+  breakStop = stop;
+}
+
+/* Sources call this function during the initialization of the
+   transient analysis for each time their waveform has an edge. */
+void net::addBreakpoint (nr_double_t t) {
+  if (t > 0 && t <= breakStop) breakpoints.push_back (t);
+}
+
 // Rename the given node and mark it as being a inserted one.
 void net::insertedNode (node * c) {
   char n[32];
@@ -26,7 +26,10 @@
 #define __NET_H__
 
 #include <string>
+#include <vector>
+#include <unordered_map>
 #include "ptrlist.h"
+#include "arena.h"
 
 namespace qucs {
 
@@ -56,11 +59,14 @@ class net : public object
   void reducedCircuit (circuit *);
   node * findConnectedNode (node *);
   node * findConnectedCircuitNode (node *);
+  void renamedNode (node *, const std::string &);
   void insertedCircuit (circuit *);
   void insertedNode (node *);
   void insertAnalysis (analysis *);
   void removeAnalysis (analysis *);
-  dataset * runAnalysis (int &);
+  dataset * runAnalysis (int &, dataset * out = NULL);
+  void setJobs (int j) { jobs = j; }
+  int  getJobs (void) { return jobs; }
   void getDroppedCircuits (nodelist * nodes = NULL);
   void deleteUnusedCircuits (nodelist * nodes = NULL);
   int  getPorts (void) { return nPorts; }
@@ -88,6 +94,10 @@ class net : public object
   nodeset * getNodeset (void) { return nset; }
   void setSrcFactor (nr_double_t f) { srcFactor = f; }
   nr_double_t getSrcFactor (void) { return srcFactor; }
+  void clearBreakpoints (nr_double_t);
+  void addBreakpoint (nr_double_t);
+  nr_double_t getBreakpointStop (void) { return breakStop; }
+  std::vector<nr_double_t> & getBreakpoints (void) { return breakpoints; }
   void setActionNetAll(net *);
 
  private:
@@ -103,7 +113,25 @@ class net : public object
   int reduced;
   int inserted;
   int insertedNodes;
+  int jobs;                   // processes solving independent analyses
   nr_double_t srcFactor;
+  nr_double_t breakStop;
+  std::vector<nr_double_t> breakpoints;
+  arena * pool;               // circuits, nodes and properties
+
+  /* The terminals of the registered circuits by node name and the
+     insertion number of each circuit, the latest circuit being the
+     root of the list. */
+  std::unordered_map<std::string, std::vector<node *> > terminals;
+  std::unordered_map<circuit *, long> stamps;
+  long nStamps;
+
+  void indexCircuit (circuit *);
+  void unindexCircuit (circuit *);
+  void unindexNode (node *, const std::string &);
+  node * findPartner (node *, bool);
+  int  solveAnalysis (analysis *, dataset *);
+  int  solveParallel (std::vector<analysis *> &, size_t, dataset *);
 };
 
 } // namespace qucs
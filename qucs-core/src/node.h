@@ -25,6 +25,8 @@
 #ifndef __NODE_H__
 #define __NODE_H__
 
+#include "arena.h"
+
 namespace qucs {
 
 class circuit;
@@ -36,6 +38,11 @@ class node : public object
   node () : object (), nNode(0), port(0), internal(0), _circuit(nullptr) {};
   //! Constructor creates a named instance of the node class.
   node (char * const n) : object (n), nNode(0), port(0), internal(0), _circuit(nullptr) {};
+  //! Renames the node, the netlist of its circuit is told.
+  void setName (const std::string &);
+  //! Nodes live in the arena of the netlist.
+  static void * operator new[] (std::size_t n) { return arena::allocate (n); }
+  static void operator delete[] (void * p) { arena::deallocate (p); }
   //! Sets the unique number of this node
   void setNode (const int n) { this->nNode = n ; };
   //! Returns the unique number of this node.
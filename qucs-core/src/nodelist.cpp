@@ -50,24 +50,18 @@ nodelist::nodelist (net * subnet) {
   sorting = 0;
 
   circuit * c;
-  // go through circuit list and find unique nodes
+  // go through circuit list, find unique nodes and add the circuit
+  // nodes to them
   for (c = subnet->getRoot (); c != NULL; c = (circuit *) c->getNext ()) {
     for (int i = 0; i < c->getSize (); i++) {
       node * n = c->getNode (i);
-      if (contains (n->getName ()) == 0) {
-	root.push_front(new nodelist_t(n->getName (), n->getInternal ()));;
-      }
-    }
-  }
-  // add circuit nodes to each unique node in the list
-  for (auto &n : this->root) {
-    for (c = subnet->getRoot (); c != NULL; c = (circuit *) c->getNext ()) {
-      for (int i = 0; i < c->getSize (); i++) {
-	assert (c->getNode(i)->getName () != NULL);
-	if (n->name == c->getNode(i)->getName ()) {
-	  addCircuitNode(n, c->getNode (i));
-	}
+      assert (n->getName () != NULL);
+      nodelist_t * & nl = names[n->getName ()];
+      if (nl == NULL) {
+	nl = new nodelist_t(n->getName (), n->getInternal ());
+	root.push_front(nl);
       }
+      addCircuitNode(nl, n);
     }
   }
 }
@@ -87,22 +81,15 @@ int nodelist::length (void) const {
 
 // This function finds the specified node name in the list.
 bool nodelist::contains (const std::string &str) const {
-  return std::find_if(root.begin(),root.end(),[str](nodelist_t *n) { return n->name == str; }) != root.end();
+  return names.find(str) != names.end();
 }
 
 // Returns the node number of the given node name.
 int nodelist::getNodeNr (const std::string &str) const {
-  
-  if(sorting) {
-    auto it = std::find_if(narray.begin(),narray.end(),[str](nodelist_t *n) { return n->name == str; });
-    if(it == narray.end())
-      return -1;
-    return (*it)->n;
-  }
-  auto it = std::find_if(root.begin(),root.end(),[str](nodelist_t *n) { return n->name == str; });
-  if(it == root.end())
+  struct nodelist_t * n = getNode (str);
+  if(n == nullptr)
     return -1;
-  return (*it)->n;
+  return n->n;
 }
 
 /* This function returns the node name positioned at the specified
@@ -121,9 +108,9 @@ bool nodelist::isInternal (int nr) const {
 /* The function returns the nodelist structure with the given name in
    the node name list.  It returns NULL if there is no such node. */
 struct nodelist_t * nodelist::getNode (const std::string &str) const {
-  auto it = std::find_if(root.begin(),root.end(),[str](nodelist_t *n) { return n->name == str; });
-  if(it != root.end())
-    return *it;
+  auto it = names.find(str);
+  if(it != names.end())
+    return it->second;
   return nullptr;
 }
 
@@ -151,8 +138,7 @@ void nodelist::assignNodes (void) {
   int i = 1;
 
   // create fast array access possibility
-  narray.clear();
-  narray.reserve(this->length());
+  narray.assign(this->length() + 1, nullptr);
 
   for (auto n: root) {
     // ground node gets a zero counter
@@ -243,6 +229,7 @@ void nodelist::remove (circuit * c) {
       if (nl->empty()) {
 	// completely remove the node structure
 	root.erase(std::remove(root.begin(), root.end(), nl), root.end());
+	names.erase(nl->name);
 	delete nl;
       }
       else if (sorting && sortfunc (nl) > 0) {
@@ -266,6 +253,7 @@ void nodelist::insert (circuit * c) {
     if (contains (n->getName ()) == 0) {
       // no, create new node and put it into the list
       nl = new nodelist_t(n->getName (), n->getInternal ());
+      names[nl->name] = nl;
       addCircuitNode (nl, n);
       if (sorting) {
 	if (c->getPort ())
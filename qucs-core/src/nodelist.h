@@ -29,6 +29,8 @@
 #include <list>
 #include <memory>
 #include <algorithm>
+#include <string>
+#include <unordered_map>
 
 namespace qucs {
 
@@ -107,7 +109,7 @@ class nodelist
 {
  public:
   // Constructor creates an instance of the nodelist class.
-  nodelist () :  narray(), sorting(0) {
+  nodelist () :  narray(), root(), names(), sorting(0) {
   }
   nodelist (net *);
   ~nodelist ();
@@ -133,6 +135,7 @@ class nodelist
  private:
   std::vector<nodelist_t *> narray;
   std::list<nodelist_t *> root;
+  std::unordered_map<std::string, nodelist_t *> names;
   int sorting;
   bool contains (const std::string &) const;
   void insert (struct nodelist_t *);
@@ -0,0 +1,58 @@
+/*
+ * numstatus.cpp - failure status of the numeric kernels
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+
+#include "exception.h"
+#include "exceptionstack.h"
+#include "numstatus.h"
+
+namespace qucs {
+
+// Failures raised by the kernels of this thread, latest at the back.
+thread_local std::vector<numfailure_t> numstatus::failures;
+
+// Raises a failure of the given type.
+void numstatus::raise (int code, int data, const char * text) {
+  if (failures.capacity () == 0) failures.reserve (64);
+  failures.push_back ({ code, data, text });
+}
+
+/* Moves the failures raised since the given mark onto the exception
+   stack of this thread, the latest one on top. */
+void numstatus::report (int m) {
+  for (int i = m; i < (int) failures.size (); i++) {
+    qucs::exception * e = new qucs::exception (failures[i].code);
+    if (failures[i].text) e->setText ("%s", failures[i].text);
+    e->setData (failures[i].data);
+    throw_exception (e);
+  }
+  release (m);
+}
+
+} // namespace qucs
@@ -0,0 +1,69 @@
+/*
+ * numstatus.h - failure status of the numeric kernels
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __NUMSTATUS_H__
+#define __NUMSTATUS_H__
+
+#include <vector>
+
+namespace qucs {
+
+// A failure raised by a numeric kernel.
+struct numfailure_t {
+  int code;           // one of the exception types
+  int data;           // e.g. the row of a missing pivot
+  const char * text;  // static description
+};
+
+/*! \class numstatus
+ * \brief failure status of the numeric kernels.
+ *
+ * The equation system solvers raise their failures here instead of
+ * throwing exceptions, nothing is allocated once the first failures
+ * have been seen.  Each thread has its own status.  Callers take a mark
+ * before running a kernel and check whether failures have been raised
+ * since.  Failures not handled are reported through the exception
+ * stack at the analysis boundary.
+ */
+class numstatus
+{
+ public:
+  static void raise (int, int, const char *);
+  static int  mark (void) { return (int) failures.size (); }
+  static bool raised (int m = 0) { return (int) failures.size () > m; }
+  static const numfailure_t * top (void) {
+    return failures.empty () ? NULL : &failures.back ();
+  }
+  static void release (int m = 0) {
+    if ((int) failures.size () > m) failures.resize (m);
+  }
+  static void report (int m = 0);
+
+ private:
+  static thread_local std::vector<numfailure_t> failures;
+};
+
+} // namespace qucs
+
+#endif /* __NUMSTATUS_H__ */
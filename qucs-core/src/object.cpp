@@ -31,6 +31,7 @@
 #include <string.h>
 #include <assert.h>
 #include <utility>
+#include <algorithm>
 
 #include "logging.h"
 #include "complex.h"
@@ -47,6 +48,7 @@ void object::addProperty (const std::string &n, const char * const val, const bo
   p.set(val);
   p.setDefault(def);
   props.insert({{n,p}});
+  propgen++;
 }
 
 /* This function sets the specified property consisting of a key and a
@@ -66,6 +68,7 @@ void object::addProperty (const std::string &n, const nr_double_t val, const boo
   p.set(val);
   p.setDefault(def);
   props.insert({{n,p}});
+  propgen++;
 }
 
 /* This function sets the specified property consisting of a key and a
@@ -92,6 +95,7 @@ void object::addProperty (const std::string &n, variable * const val, const bool
   p.set(val);
   p.setDefault(def);
   props.insert({{n,p}});
+  propgen++;
 }
 
 /* Returns the requested property value which has been previously
@@ -177,11 +181,69 @@ bool object::isPropertyGiven (const std::string &n) const {
     return false;
 }
 
+/* The function resolves the given parameter binding.  Since the
+   properties are kept in a node based hash map the location of a
+   property does not change, thus the lookup by name is necessary only
+   once and again if properties have been added meanwhile. */
+const property * object::resolve (parameter & p, bool scaled) const {
+  if (p.owner != this || p.gen != propgen || p.scaled != scaled) {
+    properties::const_iterator it = props.end ();
+    if (scaled) it = props.find (std::string ("Scaled:") + p.name);
+    if (it == props.end ()) it = props.find (p.name);
+    p.prop = (it != props.end ()) ? &(*it).second : NULL;
+    p.owner = this;
+    p.gen = propgen;
+    p.scaled = scaled;
+  }
+  return p.prop;
+}
+
+/* Returns the value of the bound property as its text representation
+   or NULL if there is no such property. */
+const char * object::getPropertyString (parameter & p) const {
+  const property * prop = resolve (p, false);
+  return prop ? prop->getString () : NULL;
+}
+
+/* Returns the value of the bound property as double or zero if there
+   is no such property. */
+nr_double_t object::getPropertyDouble (parameter & p) const {
+  const property * prop = resolve (p, false);
+  return prop ? prop->getDouble () : 0.0;
+}
+
+/* Returns the value of the bound (scalability) property, the standard
+   property or zero. */
+nr_double_t object::getScaledProperty (parameter & p) const {
+  const property * prop = resolve (p, true);
+  return prop ? prop->getDouble () : 0.0;
+}
+
+/* Returns the value of the bound property as integer or zero if there
+   is no such property. */
+int object::getPropertyInteger (parameter & p) const {
+  const property * prop = resolve (p, false);
+  return prop ? prop->getInteger () : 0;
+}
+
 // The function returns the number of properties in the object.
 int object::countProperties (void) const {
   return props.size();
 }
 
+/* Returns the sorted names of the properties holding plain numbers,
+   without the scalability properties. */
+std::vector<std::string> object::getDoubleProperties (void) const {
+  std::vector<std::string> res;
+  for (auto it = props.cbegin (); it != props.cend (); ++it) {
+    if (it->second.getType () != PROPERTY_DOUBLE) continue;
+    if (it->first.compare (0, 7, "Scaled:") == 0) continue;
+    res.push_back (it->first);
+  }
+  std::sort (res.begin (), res.end ());
+  return res;
+}
+
 // This function returns a text representation of the objects properties.
 const char * object::propertyList (void) const {
   std::string ptxt;
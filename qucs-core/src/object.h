@@ -32,6 +32,7 @@
 #define __OBJECT_H__
 
 #include <string>
+#include <vector>
 #include "property.h"
 
 #define MCREATOR(val) \
@@ -56,9 +57,14 @@ class object
 {
  public:
   //! Constructor creates an unnamed instance of the object class.
-  object () : name(), props() {} ;
+  object () : name(), props(), propgen(0) {} ;
   //! This constructor creates a named instance of the object class.
-  object (const std::string &n) : name(n), props() {} ;
+  object (const std::string &n) : name(n), props(), propgen(0) {} ;
+  object (const object &) = default;
+  //! Assignment invalidates the parameter bindings of the object.
+  object & operator= (const object & o) {
+    name = o.name; props = o.props; propgen++; return *this;
+  };
   //! Sets the name of the object.
   void setName (const std::string &n) { this->name = n; };
   //! Get the name of the object.
@@ -76,15 +82,24 @@ class object
   nr_double_t getPropertyDouble (const std::string &n) const;
   nr_double_t getScaledProperty (const std::string &n) const;
   int  getPropertyInteger (const std::string &n) const;
+  const char * getPropertyString (parameter &) const;
+  nr_double_t getPropertyDouble (parameter &) const;
+  nr_double_t getScaledProperty (parameter &) const;
+  int  getPropertyInteger (parameter &) const;
   bool hasProperty (const std::string &n) const ;
   bool isPropertyGiven (const std::string &n) const;
   int  countProperties (void) const;
+  std::vector<std::string> getDoubleProperties (void) const;
   const char *
     propertyList (void) const;
 
+ private:
+  const property * resolve (parameter &, bool) const;
+
  private:
   std::string name;
   properties props;
+  unsigned int propgen;
 };
 
 } // namespace qucs
@@ -0,0 +1,155 @@
+/*
+ * opcache.cpp - shared DC operating points
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <algorithm>
+
+#include "checkpoint.h"
+#include "opcache.h"
+
+namespace qucs {
+
+std::mutex opcache::lock;
+opcache::state_t opcache::state;
+std::map<opcache::state_t, nasolution<nr_double_t> > opcache::points;
+std::deque<opcache::state_t> opcache::order;
+std::map<opcache::state_t, nasolution<nr_double_t> > opcache::seeds;
+
+// A parameter sweep starts solving the point of the given value.
+void opcache::enter (const std::string & name, nr_double_t value) {
+  std::lock_guard<std::mutex> guard (lock);
+  state.push_back (std::make_pair (name, value));
+}
+
+// The parameter sweep entered last has solved its point.
+void opcache::leave (void) {
+  std::lock_guard<std::mutex> guard (lock);
+  if (!state.empty ()) state.pop_back ();
+}
+
+// Nested sweeps give the same state in any order.
+opcache::state_t opcache::key (void) {
+  state_t k = state;
+  std::sort (k.begin (), k.end ());
+  return k;
+}
+
+/* Returns the operating point of the current state, else the seed
+   of the previous run, or NULL if there is none.  The pointer remains
+   valid until the next store(). */
+const nasolution<nr_double_t> * opcache::find (void) {
+  std::lock_guard<std::mutex> guard (lock);
+  state_t k = key ();
+  auto it = points.find (k);
+  if (it != points.end ()) return &it->second;
+  it = seeds.find (k);
+  return it != seeds.end () ? &it->second : NULL;
+}
+
+/* Keeps the given operating point for the current state, the oldest
+   one is dropped if there are too many. */
+void opcache::store (const nasolution<nr_double_t> & op) {
+  std::lock_guard<std::mutex> guard (lock);
+  state_t k = key ();
+  auto it = points.find (k);
+  if (it != points.end ()) {
+    it->second = op;
+    return;
+  }
+  if (order.size () >= OPCACHE_SIZE) {
+    points.erase (order.front ());
+    order.pop_front ();
+  }
+  points.insert (std::make_pair (k, op));
+  order.push_back (k);
+}
+
+/* Forgets all operating points, e.g. for a new netlist.  The seeds
+   are kept. */
+void opcache::clear (void) {
+  std::lock_guard<std::mutex> guard (lock);
+  points.clear ();
+  order.clear ();
+}
+
+/* Writes the operating points of the run into the given checkpoint,
+   the seeds not solved again included. */
+void opcache::save (checkpoint & cp) {
+  std::lock_guard<std::mutex> guard (lock);
+  std::map<state_t, nasolution<nr_double_t> > all = seeds;
+  for (auto & p : points) all[p.first] = p.second;
+  cp.put ((int) all.size ());
+  for (auto & p : all) {
+    cp.put ((int) p.first.size ());
+    for (auto & v : p.first) {
+      cp.put (v.first);
+      cp.put (v.second);
+    }
+    cp.put ((int) p.second.size ());
+    for (auto & e : p.second) {
+      cp.put (e.first);
+      cp.put (e.second.current);
+      cp.put (e.second.value);
+    }
+  }
+}
+
+/* Reads the operating points written by save() as seeds.  Returns
+   their number, or -1 if the checkpoint is broken. */
+int opcache::load (checkpoint & cp) {
+  std::lock_guard<std::mutex> guard (lock);
+  int n = -1;
+  seeds.clear ();
+  cp.get (n);
+  for (int i = 0; cp.good () && i < n; i++) {
+    state_t k;
+    int m = -1;
+    cp.get (m);
+    for (int j = 0; cp.good () && j < m; j++) {
+      std::string name;
+      nr_double_t value = 0;
+      cp.get (name);
+      cp.get (value);
+      k.push_back (std::make_pair (name, value));
+    }
+    nasolution<nr_double_t> & op = seeds[k];
+    cp.get (m);
+    for (int j = 0; cp.good () && j < m; j++) {
+      std::string name;
+      naentry<nr_double_t> e;
+      cp.get (name);
+      cp.get (e.current);
+      cp.get (e.value);
+      op[name] = e;
+    }
+  }
+  if (cp.good ()) return n;
+  seeds.clear ();
+  return -1;
+}
+
+} // namespace qucs
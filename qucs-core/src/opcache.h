@@ -0,0 +1,88 @@
+/*
+ * opcache.h - shared DC operating points definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __OPCACHE_H__
+#define __OPCACHE_H__
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nasolution.h"
+
+// Maximum number of operating points kept.
+#define OPCACHE_SIZE 1024
+
+namespace qucs {
+
+class checkpoint;
+
+/*! \class opcache
+ * \brief DC operating points shared by the analyses of a netlist.
+ *
+ * The parameter sweeps announce the values of their variables while
+ * solving a point, the DC solutions found meanwhile are kept by the
+ * state of all running sweeps.  Analyses solving the operating point
+ * again in the same state, e.g. the DC analysis added to several sweeps
+ * over the same parameter or the initial DC of a transient analysis,
+ * start the Newton iterations at the cached solution and converge
+ * within a single iteration.  The cached solutions merely seed the
+ * iterations, thus a state not covering all parameters costs
+ * iterations but never changes a result.
+ *
+ * In ECO mode the operating points of the previous run over an earlier
+ * version of the netlist are loaded as seeds.  They start the
+ * iterations of the states the current run has not solved yet.  Note
+ * that a circuit with several operating points may then settle at the
+ * one closest to the previous run.
+ */
+class opcache
+{
+ public:
+  static void enter (const std::string &, nr_double_t);
+  static void leave (void);
+  static const nasolution<nr_double_t> * find (void);
+  static void store (const nasolution<nr_double_t> &);
+  static void clear (void);
+  static void save (checkpoint &);
+  static int load (checkpoint &);
+
+ private:
+  typedef std::vector<std::pair<std::string, nr_double_t> > state_t;
+  static state_t key (void);
+
+ private:
+  static std::mutex lock;
+  static state_t state;
+  static std::map<state_t, nasolution<nr_double_t> > points;
+  static std::deque<state_t> order;
+  static std::map<state_t, nasolution<nr_double_t> > seeds;
+};
+
+} // namespace qucs
+
+#endif /* __OPCACHE_H__ */
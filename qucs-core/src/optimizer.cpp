@@ -0,0 +1,612 @@
+/*
+ * optimizer.cpp - optimization class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+
+#include <string>
+#include <vector>
+#include <set>
+#include <limits>
+#include <random>
+#include <algorithm>
+
+#if HAVE_FORK
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+#include "logging.h"
+#include "complex.h"
+#include "object.h"
+#include "vector.h"
+#include "dataset.h"
+#include "net.h"
+#include "netdefs.h"
+#include "ptrlist.h"
+#include "analysis.h"
+#include "variable.h"
+#include "environment.h"
+#include "equation.h"
+#include "optimizer.h"
+#include "threadpool.h"
+#include "opcache.h"
+
+using namespace qucs::eqn;
+
+namespace qucs {
+
+// Types of optimization goals.
+enum {
+  GOAL_MIN,
+  GOAL_MAX,
+  GOAL_MON,
+  GOAL_LE,
+  GOAL_GE,
+  GOAL_EQ
+};
+
+// The cost of a candidate which could not be evaluated.
+#define COST_FAILED std::numeric_limits<nr_double_t>::max ()
+
+// Constructor creates an unnamed instance of the optimizer class.
+optimizer::optimizer () : analysis () {
+  results = NULL;
+  evaluations = 0;
+  type = ANALYSIS_SWEEP;
+}
+
+// Constructor creates a named instance of the optimizer class.
+optimizer::optimizer (char * n) : analysis (n) {
+  results = NULL;
+  evaluations = 0;
+  type = ANALYSIS_SWEEP;
+}
+
+// Destructor deletes the optimizer class object.
+optimizer::~optimizer () {
+  for (auto * o : varobjs) delete o;
+  for (auto * o : goalobjs) delete o;
+  delete results;
+}
+
+/* The copy constructor creates a new instance of the optimizer class
+   based on the given optimizer object. */
+optimizer::optimizer (optimizer & o) : analysis (o) {
+  for (auto * v : o.varobjs) varobjs.push_back (new object (*v));
+  for (auto * g : o.goalobjs) goalobjs.push_back (new object (*g));
+  vars = o.vars;
+  goals = o.goals;
+  rnd = o.rnd;
+  results = NULL;
+  evaluations = 0;
+}
+
+// Adds the properties of an optimization variable.
+void optimizer::addVariable (object * o) {
+  varobjs.push_back (o);
+}
+
+// Adds the properties of an optimization goal.
+void optimizer::addGoal (object * o) {
+  goalobjs.push_back (o);
+}
+
+// Short macro in order to obtain the correct equation node.
+#define E(equ) ((eqn::node *) (equ))
+
+/* Initializes the optimization. */
+int optimizer::initialize (void) {
+  int err = 0;
+
+  // get the optimization variables and put them into the current
+  // environment and into the equation checker if necessary
+  vars.clear ();
+  for (auto * o : varobjs) {
+    optvar_t v;
+    v.name = o->getPropertyString ("Var");
+    v.init = o->getPropertyDouble ("Init");
+    v.lo = o->getPropertyDouble ("Min");
+    v.hi = o->getPropertyDouble ("Max");
+    v.log = !strcmp (o->getPropertyString ("Scale"), "log");
+    v.integer = !strcmp (o->getPropertyString ("Integer"), "yes");
+    if (v.lo > v.hi) std::swap (v.lo, v.hi);
+    if (v.log && v.lo <= 0.0) {
+      logprint (LOG_ERROR, "WARNING: %s: range of `%s' not positive, "
+		"varying it linearly\n", getName (), v.name.c_str ());
+      v.log = false;
+    }
+    v.init = std::min (std::max (v.init, v.lo), v.hi);
+    vars.push_back (v);
+
+    const char * const n = v.name.c_str ();
+    if (env->getVariable (n) == NULL) {
+      variable * var = new variable (n);
+      var->setConstant (new constant (TAG_DOUBLE));
+      env->addVariable (var);
+    }
+    if (!env->getChecker()->containsVariable (n)) {
+      eqns.push_back (env->getChecker()->addDouble ("#optimize", n, v.init));
+    }
+    env->setDoubleConstant (n, v.init);
+    env->setDouble (n, v.init);
+  }
+  if (vars.empty ()) {
+    logprint (LOG_ERROR, "ERROR: %s: no variables to optimize\n", getName ());
+    err++;
+  }
+
+  // get the optimization goals
+  static const char * const types[] = {
+    "min", "max", "mon", "le", "ge", "eq", NULL };
+  goals.clear ();
+  for (auto * o : goalobjs) {
+    optgoal_t g;
+    g.name = o->getPropertyString ("Var");
+    g.value = o->getPropertyDouble ("Value");
+    const char * const t = o->getPropertyString ("Type");
+    for (g.type = 0; types[g.type] && strcmp (types[g.type], t); g.type++) ;
+    goals.push_back (g);
+  }
+
+  rnd.seed (getPropertyInteger ("Seed"));
+  evaluations = 0;
+
+  // also run initialize functionality for all children
+  if (actions != nullptr) {
+    for (auto *a : *actions) {
+      a->initialize ();
+      a->setProgress (false);
+    }
+  }
+  return err;
+}
+
+/* Cleans the optimization up. */
+int optimizer::cleanup (void) {
+
+  // remove additional equations from equation checker
+  for (auto * e : eqns) {
+    env->getChecker()->dropEquation (E (e));
+    delete E (e);
+  }
+  eqns.clear ();
+
+  // also run cleanup functionality for all children
+  if (actions != nullptr)
+    for (auto *a : *actions)
+      a->cleanup ();
+
+  return 0;
+}
+
+/* Returns the value of a variable at the given position within its
+   range, the position being in [0,1]. */
+nr_double_t optimizer::value (int i, nr_double_t u) {
+  optvar_t & v = vars[i];
+  nr_double_t x;
+  if (v.log)
+    x = v.lo * std::pow (v.hi / v.lo, u);
+  else
+    x = v.lo + (v.hi - v.lo) * u;
+  if (v.integer) x = std::round (x);
+  return std::min (std::max (x, v.lo), v.hi);
+}
+
+// Returns the position of the given value of a variable in its range.
+nr_double_t optimizer::position (int i, nr_double_t x) {
+  optvar_t & v = vars[i];
+  if (v.hi <= v.lo) return 0.0;
+  if (v.log)
+    return std::log (x / v.lo) / std::log (v.hi / v.lo);
+  return (x - v.lo) / (v.hi - v.lo);
+}
+
+/* The optimization runs a differential evolution (DE/rand/1/bin) on
+   the positions of the variables in their ranges.  The first member
+   of the population holds the initial values, the others are spread
+   randomly.  It ends after the given number of generations or if the
+   costs of the population hardly differ anymore.  The child analyses
+   are run once more for the best member and their results are taken
+   over. */
+int optimizer::solve (void) {
+  int err = 0;
+  runs++;
+
+  // get fixed simulation properties
+  int np = getPropertyInteger ("NP");
+  int iterations = getPropertyInteger ("MaxIter");
+  nr_double_t f = getPropertyDouble ("F");
+  nr_double_t cr = getPropertyDouble ("CR");
+  nr_double_t minvar = getPropertyDouble ("MinCostVar");
+  int d = vars.size ();
+  if (d == 0) return 1;
+
+  // the child analyses save their results into a dataset of their own
+  results = new dataset ();
+  for (auto *a : *actions) setResults (a, results);
+
+  std::uniform_real_distribution<nr_double_t> uni (0.0, 1.0);
+  std::uniform_int_distribution<int> member (0, np - 1), dim (0, d - 1);
+
+  // create and evaluate the initial population
+  std::vector< std::vector<nr_double_t> > pop (np), trial (np);
+  std::vector<nr_double_t> cost, tcost;
+  for (int i = 0; i < np; i++) {
+    pop[i].resize (d);
+    trial[i].resize (d);
+    for (int j = 0; j < d; j++)
+      pop[i][j] = i ? uni (rnd) : position (j, vars[j].init);
+  }
+  evaluateAll (pop, cost);
+
+  int gen;
+  for (gen = 0; gen < iterations; gen++) {
+    // display progress bar if requested
+    if (progress) logprogressbar (gen, iterations, 40);
+
+    // stop if the costs hardly differ anymore
+    nr_double_t mean = 0.0, var = 0.0;
+    for (int i = 0; i < np; i++) mean += cost[i] / np;
+    for (int i = 0; i < np; i++) var += (cost[i] - mean) * (cost[i] - mean) / np;
+    if (var < minvar) break;
+
+    // create the trial members by mutation and crossover
+    for (int i = 0; i < np; i++) {
+      int a, b, c, k = dim (rnd);
+      do a = member (rnd); while (a == i);
+      do b = member (rnd); while (b == i || b == a);
+      do c = member (rnd); while (c == i || c == a || c == b);
+      for (int j = 0; j < d; j++) {
+	nr_double_t u = pop[i][j];
+	if (j == k || uni (rnd) < cr) {
+	  u = pop[a][j] + f * (pop[b][j] - pop[c][j]);
+	  // bounce back into the range of the variable
+	  if (u < 0.0)
+	    u = uni (rnd) * pop[i][j];
+	  else if (u > 1.0)
+	    u = pop[i][j] + uni (rnd) * (1.0 - pop[i][j]);
+	}
+	trial[i][j] = u;
+      }
+    }
+
+    // evaluate them and keep the better ones
+    evaluateAll (trial, tcost);
+    for (int i = 0; i < np; i++) {
+      if (tcost[i] <= cost[i]) {
+	pop[i] = trial[i];
+	cost[i] = tcost[i];
+      }
+    }
+  }
+  // clear progress bar
+  if (progress) logprogressclear (40);
+
+  // run the child analyses for the best member once more
+  int best = std::min_element (cost.begin (), cost.end ()) - cost.begin ();
+  nr_double_t c;
+  err |= evaluate (pop[best], c);
+  logprint (LOG_STATUS, "NOTIFY: %s: cost %g after %d generations and %d "
+	    "evaluations\n", getName (), c, gen, evaluations);
+  saveResults (pop[best]);
+
+  for (auto *a : *actions) setResults (a, data);
+  delete results;
+  results = NULL;
+  return err;
+}
+
+/* Evaluates the given candidates, using several processes if
+   possible.  A candidate which could not be evaluated gets the highest
+   cost. */
+void optimizer::evaluateAll (std::vector< std::vector<nr_double_t> > & x,
+			     std::vector<nr_double_t> & cost) {
+  // number of worker processes, zero means one per processor
+  int procs = getPropertyInteger ("Processes");
+  procs = threadpool::threads (procs);
+  if (procs > (int) x.size ()) procs = x.size ();
+
+  cost.assign (x.size (), COST_FAILED);
+#if HAVE_FORK
+  if (procs > 1 && evaluateParallel (x, cost, procs) == 0) return;
+#endif
+  for (size_t i = 0; i < x.size (); i++) {
+    nr_double_t c;
+    if (!evaluate (x[i], c)) cost[i] = c;
+  }
+}
+
+#if HAVE_FORK
+/* The parallel evaluation splits the candidates into contiguous
+   chunks.  Each chunk is evaluated by a forked process working on its
+   own copy of the netlist and environment, which writes the costs it
+   found into a temporary file.  The function returns -1 if the
+   processes could not be created or did not end properly, otherwise
+   zero. */
+int optimizer::evaluateParallel (std::vector< std::vector<nr_double_t> > & x,
+				 std::vector<nr_double_t> & cost, int procs) {
+  int c, size = x.size ();
+  std::vector<pid_t> pids (procs, -1);
+  std::vector<FILE *> files (procs, (FILE *) NULL);
+
+  // flush output streams before the processes share them
+  logflush ();
+  fflush (NULL);
+  for (c = 0; c < procs; c++) {
+    if ((files[c] = tmpfile ()) == NULL) break;
+    if ((pids[c] = fork ()) < 0) break;
+    if (pids[c] == 0) {
+      // child process: evaluate the chunk of candidates and save costs
+      int first = c * size / procs, last = (c + 1) * size / procs;
+      threadpool::share (procs);
+      for (int i = first; i < last; i++) {
+	nr_double_t v, k = COST_FAILED;
+	if (!evaluate (x[i], v)) k = v;
+	fwrite (&k, sizeof (nr_double_t), 1, files[c]);
+      }
+      logflush ();
+      fflush (NULL);
+      _exit (0);
+    }
+  }
+
+  // collect child processes
+  int failed = c < procs;
+  for (c = 0; c < procs; c++) {
+    int status = 0;
+    if (pids[c] > 0) {
+      waitpid (pids[c], &status, 0);
+      if (!WIFEXITED (status) || WEXITSTATUS (status) != 0) failed = 1;
+    }
+  }
+
+  // read the costs
+  for (c = 0; c < procs && !failed; c++) {
+    int first = c * size / procs, last = (c + 1) * size / procs;
+    rewind (files[c]);
+    for (int i = first; i < last; i++)
+      if (fread (&cost[i], sizeof (nr_double_t), 1, files[c]) != 1)
+	failed = 1;
+  }
+  for (c = 0; c < procs; c++) if (files[c]) fclose (files[c]);
+
+  if (failed) {
+    logprint (LOG_ERROR, "WARNING: %s: parallel evaluation failed, "
+	      "evaluating serially\n", getName ());
+    return -1;
+  }
+  evaluations += size;
+  return 0;
+}
+#endif /* HAVE_FORK */
+
+/* The function evaluates a candidate given by the positions of the
+   variables.  The variables are updated in the environment and
+   equation checker, then the child analyses are run.  Returns
+   non-zero on errors. */
+int optimizer::evaluate (std::vector<nr_double_t> & u, nr_double_t & cost) {
+  int err = 0;
+
+  for (int i = 0; i < (int) vars.size (); i++) {
+    const char * const n = vars[i].name.c_str ();
+    nr_double_t x = value (i, u[i]);
+    env->setDoubleConstant (n, x);
+    env->setDouble (n, x);
+    opcache::enter (n, x);
+  }
+  env->runSolver ();
+#if DEBUG
+  logprint (LOG_STATUS, "NOTIFY: %s: running netlist for candidate %d\n",
+	    getName (), evaluations);
+#endif
+  clearResults ();
+  for (auto *a : *actions) err |= a->solve ();
+  for (int i = 0; i < (int) vars.size (); i++) opcache::leave ();
+  err |= evaluateGoals (cost);
+  evaluations++;
+  return err;
+}
+
+/* This function solves the equations with the results of the child
+   analyses and sums up the costs of the goals.  The worst value of a
+   goal counts if it has several values.  The equation results are
+   removed afterwards.  Returns non-zero on errors. */
+int optimizer::evaluateGoals (nr_double_t & cost) {
+  int err = 0;
+  qucs::vector * v, * next;
+  eqn::checker * check = env->getChecker ();
+
+  // remember the results and equations being there before
+  std::set<void *> known;
+  for (v = results->getDependencies (); v != NULL;
+       v = (qucs::vector *) v->getNext ())
+    known.insert (v);
+  for (v = results->getVariables (); v != NULL;
+       v = (qucs::vector *) v->getNext ())
+    known.insert (v);
+  for (eqn::node * e = check->getEquations (); e != NULL; e = e->getNext ())
+    known.insert (e);
+
+  err |= env->equationSolver (results);
+
+  nr_double_t costobj = getPropertyDouble ("CostObj");
+  nr_double_t costcon = getPropertyDouble ("CostCon");
+  cost = 0.0;
+  for (auto & g : goals) {
+    if ((v = results->findVariable (g.name)) == NULL)
+      v = results->findDependency (g.name.c_str ());
+    if (v == NULL || v->getSize () <= 0) {
+      logprint (LOG_ERROR, "ERROR: %s: no such goal `%s' in the results\n",
+		getName (), g.name.c_str ());
+      err++;
+      continue;
+    }
+    nr_double_t lo = real (v->get (0)), hi = lo;
+    for (int i = 1; i < v->getSize (); i++) {
+      lo = std::min (lo, real (v->get (i)));
+      hi = std::max (hi, real (v->get (i)));
+    }
+    nr_double_t norm = std::max (std::fabs (g.value), 1.0);
+    switch (g.type) {
+    case GOAL_MIN:
+      cost += costobj * hi;
+      break;
+    case GOAL_MAX:
+      cost -= costobj * lo;
+      break;
+    case GOAL_LE:
+      if (hi > g.value) cost += costcon * (hi - g.value) / norm;
+      break;
+    case GOAL_GE:
+      if (lo < g.value) cost += costcon * (g.value - lo) / norm;
+      break;
+    case GOAL_EQ:
+      cost += costcon * std::max (hi - g.value, g.value - lo) / norm;
+      break;
+    }
+  }
+
+  // remove the equation results and the equations of the results
+  for (v = results->getDependencies (); v != NULL; v = next) {
+    next = (qucs::vector *) v->getNext ();
+    if (!known.count (v)) results->delDependency (v);
+  }
+  for (v = results->getVariables (); v != NULL; v = next) {
+    next = (qucs::vector *) v->getNext ();
+    if (!known.count (v)) results->delVariable (v);
+  }
+  eqn::node * n;
+  for (eqn::node * e = check->getEquations (); e != NULL; e = n) {
+    n = e->getNext ();
+    if (!known.count (e)) {
+      check->dropEquation (e);
+      delete e;
+    }
+  }
+  return err;
+}
+
+// Lets the given analysis and its children save into the dataset.
+void optimizer::setResults (analysis * a, dataset * d) {
+  a->setData (d);
+  if (a->getAnalysis () != nullptr)
+    for (auto *c : *a->getAnalysis ())
+      setResults (c, d);
+}
+
+/* The function removes the results of the previous candidate.  The
+   independent vectors are saved by the child analyses in their first
+   run only, thus these are kept. */
+void optimizer::clearResults (void) {
+  while (results->getVariables () != NULL)
+    results->delVariable (results->getVariables ());
+}
+
+/* This function saves the results of the child analyses for the best
+   candidate and the values of its variables into the output
+   dataset. */
+void optimizer::saveResults (std::vector<nr_double_t> & u) {
+  qucs::vector * v, * d;
+
+  for (v = results->getDependencies (); v != NULL;
+       v = (qucs::vector *) v->getNext ()) {
+    if (data->findDependency (v->getName ()) == NULL)
+      data->appendDependency (new qucs::vector (*v));
+  }
+  for (v = results->getVariables (); v != NULL;
+       v = (qucs::vector *) v->getNext ()) {
+    if ((d = data->findVariable (v->getName ())) == NULL)
+      data->appendVariable (new qucs::vector (*v));
+    else
+      for (int i = 0; i < v->getSize (); i++) d->add (v->get (i));
+  }
+
+  for (int i = 0; i < (int) vars.size (); i++) {
+    const char * const n = vars[i].name.c_str ();
+    if ((v = data->findDependency (n)) == NULL) {
+      v = new qucs::vector (n);
+      v->setOrigin (getName ());
+      data->appendDependency (v);
+    }
+    v->add (value (i, u[i]));
+  }
+}
+
+// properties
+PROP_REQ [] = {
+  { "Sim", PROP_STR, { PROP_NO_VAL, "DC1" }, PROP_NO_RANGE },
+  PROP_NO_PROP };
+PROP_OPT [] = {
+  { "MaxIter", PROP_INT, { 50, PROP_NO_STR }, PROP_MIN_VAL (1) },
+  { "NP", PROP_INT, { 20, PROP_NO_STR }, PROP_MIN_VAL (4) },
+  { "F", PROP_REAL, { 0.85, PROP_NO_STR }, PROP_RNGII (0, 2) },
+  { "CR", PROP_REAL, { 1, PROP_NO_STR }, PROP_RNGII (0, 1) },
+  { "Seed", PROP_INT, { 3, PROP_NO_STR }, PROP_POS_RANGE },
+  { "MinCostVar", PROP_REAL, { 1e-6, PROP_NO_STR }, PROP_POS_RANGE },
+  { "CostObj", PROP_REAL, { 10, PROP_NO_STR }, PROP_POS_RANGE },
+  { "CostCon", PROP_REAL, { 100, PROP_NO_STR }, PROP_POS_RANGE },
+  { "Processes", PROP_INT, { 0, PROP_NO_STR }, PROP_RNGII (0, 256) },
+  PROP_NO_PROP };
+struct define_t optimizer::anadef =
+  { "Opt", 0, PROP_ACTION, PROP_NO_SUBSTRATE, PROP_LINEAR, PROP_DEF };
+
+// properties of optimization variables
+static struct property_t varreq[] = {
+  { "Opt", PROP_STR, { PROP_NO_VAL, "Opt1" }, PROP_NO_RANGE },
+  { "Var", PROP_STR, { PROP_NO_VAL, "R1" }, PROP_NO_RANGE },
+  { "Init", PROP_REAL, { 1, PROP_NO_STR }, PROP_NO_RANGE },
+  { "Min", PROP_REAL, { 0, PROP_NO_STR }, PROP_NO_RANGE },
+  { "Max", PROP_REAL, { 10, PROP_NO_STR }, PROP_NO_RANGE },
+  PROP_NO_PROP };
+static struct property_t varopt[] = {
+  { "Scale", PROP_STR, { PROP_NO_VAL, "lin" }, PROP_RNG_STR2 ("lin", "log") },
+  { "Integer", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+  PROP_NO_PROP };
+struct define_t optimizer::vardef =
+  { "OptVar", 0, PROP_COMPONENT, PROP_NO_SUBSTRATE, PROP_LINEAR,
+    varreq, varopt };
+
+// properties of optimization goals
+static struct property_t goalreq[] = {
+  { "Opt", PROP_STR, { PROP_NO_VAL, "Opt1" }, PROP_NO_RANGE },
+  { "Var", PROP_STR, { PROP_NO_VAL, "V1" }, PROP_NO_RANGE },
+  { "Type", PROP_STR, { PROP_NO_VAL, "min" },
+    PROP_RNG_STR6 ("min", "max", "mon", "le", "ge", "eq") },
+  PROP_NO_PROP };
+static struct property_t goalopt[] = {
+  { "Value", PROP_REAL, { 0, PROP_NO_STR }, PROP_NO_RANGE },
+  PROP_NO_PROP };
+struct define_t optimizer::goaldef =
+  { "OptGoal", 0, PROP_COMPONENT, PROP_NO_SUBSTRATE, PROP_LINEAR,
+    goalreq, goalopt };
+
+} // namespace qucs
@@ -0,0 +1,97 @@
+/*
+ * optimizer.h - optimization class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __OPTIMIZER_H__
+#define __OPTIMIZER_H__
+
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+
+namespace qucs {
+
+class analysis;
+class dataset;
+class object;
+
+/* The optimizer varies the optimization variables ("OptVar"
+   definitions) of the netlist using differential evolution.  Each
+   candidate is evaluated by updating the variables in the environment
+   and running the child analyses on the netlist in memory.  The goals
+   ("OptGoal" definitions) are taken from the results after solving the
+   equations.  The candidates of a generation are evaluated by several
+   processes if possible. */
+class optimizer : public analysis
+{
+ public:
+  ACREATOR (optimizer);
+  optimizer (char *);
+  optimizer (optimizer &);
+  ~optimizer ();
+  int  initialize (void);
+  int  solve (void);
+  int  cleanup (void);
+  void addVariable (object *);
+  void addGoal (object *);
+
+  static struct define_t vardef;
+  static struct define_t goaldef;
+
+ private:
+  struct optvar_t {
+    std::string name;
+    nr_double_t init, lo, hi;
+    bool log, integer;
+  };
+  struct optgoal_t {
+    std::string name;
+    int type;
+    nr_double_t value;
+  };
+
+  nr_double_t value (int, nr_double_t);
+  nr_double_t position (int, nr_double_t);
+  int  evaluate (std::vector<nr_double_t> &, nr_double_t &);
+  int  evaluateGoals (nr_double_t &);
+  void evaluateAll (std::vector< std::vector<nr_double_t> > &,
+		    std::vector<nr_double_t> &);
+  int  evaluateParallel (std::vector< std::vector<nr_double_t> > &,
+			 std::vector<nr_double_t> &, int);
+  void setResults (analysis *, dataset *);
+  void clearResults (void);
+  void saveResults (std::vector<nr_double_t> &);
+
+  std::vector<object *> varobjs, goalobjs;
+  std::vector<optvar_t> vars;
+  std::vector<optgoal_t> goals;
+  std::vector<void *> eqns;
+  std::mt19937 rnd;
+  dataset * results;
+  int evaluations;
+};
+
+} // namespace qucs
+
+#endif /* __OPTIMIZER_H__ */
@@ -30,6 +30,17 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <string>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+#if HAVE_FORK
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
 #include "logging.h"
 #include "complex.h"
 #include "object.h"
@@ -40,9 +51,15 @@
 #include "ptrlist.h"
 #include "analysis.h"
 #include "variable.h"
+#include "strlist.h"
 #include "environment.h"
 #include "sweep.h"
 #include "parasweep.h"
+#include "nasolver.h"
+#include "dcsolver.h"
+#include "profile.h"
+#include "threadpool.h"
+#include "opcache.h"
 
 using namespace qucs::eqn;
 
@@ -114,13 +131,23 @@ int parasweep::initialize (void) {
   env->setDouble (n, v);
 
   // also run initialize functionality for all children
+  initChildren ();
+  return 0;
+}
+
+// Runs the initialize functionality for all children.
+void parasweep::initChildren (void) {
   if (actions != nullptr) {
     for (auto *a : *actions) {
-      a->initialize ();
+      profile::enter (a->getName (), a->getType ());
+      {
+        profile::phase p (PROFILE_SETUP);
+        a->initialize ();
+      }
+      profile::leave ();
       a->setProgress (false);
     }
   }
-  return 0;
 }
 
 /* Cleans the parameter sweep up. */
@@ -146,39 +173,198 @@ int parasweep::solve (void) {
   int err = 0;
   runs++;
 
-  // get fixed simulation properties
-  const char * const n = getPropertyString ("Param");
+  // number of worker processes, zero means one per processor
+  int procs = getPropertyInteger ("Processes");
+  procs = threadpool::threads (procs);
+  if (procs > swp->getSize ()) procs = swp->getSize ();
+
+  // trace the solution curve of a DC analysis
+  const char * const arc = getPropertyString ("Arclength");
+  if (arc && !strcmp (arc, "yes")) {
+    if ((err = solveArclength ()) >= 0) return err;
+    err = 0;
+  }
+
+#if HAVE_FORK
+  // run the parameter sweep in several processes
+  if (procs > 1 && (err = solveParallel (procs)) >= 0) return err;
+  err = 0;
+#endif
 
   // run the parameter sweep
   swp->reset ();
   for (int i = 0; i < swp->getSize (); i++) {
     // obtain next sweep point
     nr_double_t v = swp->next ();
+    if (isReproducible () && i % SWEEP_BLOCK == 0) resetSweep ();
     // display progress bar if requested
     if (progress) logprogressbar (i, swp->getSize (), 40);
-    // update environment and equation checker, then run solver
-    env->setDoubleConstant (n, v);
-    env->setDouble (n, v);
+    err |= solvePoint (v);
+    logflush ();
+  }
+  // clear progress bar
+  if (progress) logprogressclear (40);
+  return err;
+}
+
+/* In reproducible mode each block of sweep points starts afresh, the
+   children forget the previous points. */
+void parasweep::resetSweep (void) {
+  for (auto *a : *actions) a->resetSweep ();
+}
+
+/* The function runs the child analyses for the given value of the
+   swept parameter. */
+int parasweep::solvePoint (nr_double_t v) {
+  int err = 0;
+
+  const char * const n = var->getName ();
+
+  // update environment and equation checker, then run solver
+  env->setDoubleConstant (n, v);
+  env->setDouble (n, v);
+  {
+    profile::phase p (PROFILE_EQUATIONS);
     env->runSolver ();
-    // save results (swept parameter values)
-    if (runs == 1) saveResults ();
+  }
+  // save results (swept parameter values)
+  if (runs == 1) saveResults ();
 #if DEBUG
-    logprint (LOG_STATUS, "NOTIFY: %s: running netlist for %s = %g\n",
-	      getName (), n, v);
+  logprint (LOG_STATUS, "NOTIFY: %s: running netlist for %s = %g\n",
+	    getName (), n, v);
 #endif
-    for (auto *a : *actions) {
-      err |= a->solve ();
-      // assign variable dataset dependencies to last order analyses
+  opcache::enter (n, v);
+  for (auto *a : *actions) {
+    a->setSweepPoint (v);
+    profile::enter (a->getName (), a->getType ());
+    err |= a->solve ();
+    profile::leave ();
+    // assign variable dataset dependencies to last order analyses
+    ptrlist<analysis> * lastorder = subnet->findLastOrderChildren (this);
+    for (auto *dep : *lastorder)
+      data->assignDependency (dep->getName (), var->getName ());
+  }
+  opcache::leave ();
+  return err;
+}
+
+/* The linear sweep of a single DC analysis can be replaced by the
+   pseudo-arclength continuation of the DC solver.  The points are
+   saved as they are found, thus the swept parameter may not be
+   monotonic.  The function returns -1 if the sweep does not qualify,
+   otherwise the error state of the continuation. */
+int parasweep::solveArclength (void) {
+  dcsolver * dc = NULL;
+  if (actions->size () == 1)
+    dc = dynamic_cast<dcsolver *> (actions->front ());
+  if (dc == NULL || strcmp (getPropertyString ("Type"), "lin")) {
+    logprint (LOG_ERROR, "WARNING: %s: arclength continuation requires a "
+	      "linear sweep of a single DC analysis\n", getName ());
+    return -1;
+  }
+
+  const char * const n = var->getName ();
+  profile::enter (dc->getName (), dc->getType ());
+  int err = dc->solveArclength (n, getPropertyDouble ("Start"),
+				getPropertyDouble ("Stop"),
+				getPropertyInteger ("Points"), [&] () {
+      // save results (swept parameter values)
+      if (runs == 1) saveResults ();
       ptrlist<analysis> * lastorder = subnet->findLastOrderChildren (this);
       for (auto *dep : *lastorder)
-	data->assignDependency (dep->getName (), var->getName ());
+	data->assignDependency (dep->getName (), n);
+    });
+  profile::leave ();
+  return err;
+}
+
+#if HAVE_FORK
+/* The parallel parameter sweep splits the sweep points into
+   contiguous chunks.  Each chunk is solved by a forked process working
+   on its own copy of the netlist and environment.  The process writes
+   the data it added to the dataset into a temporary file and the
+   results are merged in chunk order, thus the output is the same as
+   for the serial sweep.  In reproducible mode the chunks consist of
+   whole blocks of sweep points, these are solved the same way by any
+   number of processes.  The function returns -1 if the processes
+   could not be created, otherwise the merged error state. */
+int parasweep::solveParallel (int procs) {
+  int i, c, err = 0, size = swp->getSize ();
+  int unit = isReproducible () ? SWEEP_BLOCK : 1;
+  int blocks = (size + unit - 1) / unit;
+  if (procs > blocks) procs = blocks;
+  if (procs <= 1) return -1;
+  std::vector<pid_t> pids (procs, -1);
+  std::vector<FILE *> files (procs, (FILE *) NULL);
+
+  // flush output streams before the processes share them
+  logflush ();
+  fflush (NULL);
+  for (c = 0; c < procs; c++) {
+    if ((files[c] = tmpfile ()) == NULL) break;
+    if ((pids[c] = fork ()) < 0) break;
+    if (pids[c] == 0) {
+      // child process: solve the chunk of sweep points and save data
+      int first = std::min (c * blocks / procs * unit, size);
+      int last = std::min ((c + 1) * blocks / procs * unit, size);
+      threadpool::share (procs);
+      std::map<std::string,int> sizes = data->getSizes ();
+      setProgress (false);
+      // the merge relies on the vectors being complete in memory
+      data->setStreaming (0);
+      swp->reset ();
+      for (i = 0; i < first; i++) swp->next ();
+      for (i = first; i < last; i++) {
+	nr_double_t v = swp->next ();
+	if (unit > 1 && i % unit == 0) resetSweep ();
+	err |= solvePoint (v);
+	logflush ();
+      }
+      data->writeAdded (files[c], sizes);
+      logflush ();
+      fflush (NULL);
+      _exit (err ? 1 : 0);
     }
   }
-  // clear progress bar
+
+  // collect child processes
+  int failed = c < procs;
+  for (c = 0; c < procs; c++) {
+    int status = 0;
+    if (pids[c] > 0) {
+      waitpid (pids[c], &status, 0);
+      if (!WIFEXITED (status) || WEXITSTATUS (status) > 1) failed = 1;
+      if (WIFEXITED (status) && WEXITSTATUS (status) == 1) err = 1;
+    }
+    if (progress) logprogressbar (c + 1, procs, 40);
+  }
   if (progress) logprogressclear (40);
-  return err;
+
+  // merge the results in sweep order
+  if (!failed) {
+    for (c = 0; c < procs; c++) {
+      rewind (files[c]);
+      if (data->mergeAdded (files[c], var->getName ())) {
+	logprint (LOG_ERROR, "ERROR: %s: unable to merge results of sweep "
+		  "process %d\n", getName (), c);
+	err = 1;
+      }
+    }
+    // assign variable dataset dependencies to last order analyses
+    ptrlist<analysis> * lastorder = subnet->findLastOrderChildren (this);
+    for (auto *dep : *lastorder)
+      data->assignDependency (dep->getName (), var->getName ());
+  }
+  else {
+    logprint (LOG_ERROR, "WARNING: %s: parallel sweep failed, running "
+	      "serial sweep\n", getName ());
+  }
+  for (c = 0; c < procs; c++) if (files[c]) fclose (files[c]);
+  return failed ? -1 : err;
 }
 
+#endif /* HAVE_FORK */
+
 /* This function saves the results of a single solve() functionality
    into the output dataset. */
 void parasweep::saveResults (void) {
@@ -204,6 +390,8 @@ PROP_OPT [] = {
   { "Stop", PROP_REAL, { 50, PROP_NO_STR }, PROP_NO_RANGE },
   { "Start", PROP_REAL, { 5, PROP_NO_STR }, PROP_NO_RANGE },
   { "Values", PROP_LIST, { 5, PROP_NO_STR }, PROP_NO_RANGE },
+  { "Processes", PROP_INT, { 1, PROP_NO_STR }, PROP_RNGII (0, 256) },
+  { "Arclength", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
   PROP_NO_PROP };
 struct define_t parasweep::anadef =
   { "SW", 0, PROP_ACTION, PROP_NO_SUBSTRATE, PROP_LINEAR, PROP_DEF };
@@ -25,6 +25,13 @@
 #ifndef __PARASWEEP_H__
 #define __PARASWEEP_H__
 
+#include <stdio.h>
+#include <string>
+#include <map>
+
+// Number of sweep points solved in a row in reproducible mode.
+#define SWEEP_BLOCK 16
+
 namespace qucs {
 
 class analysis;
@@ -42,8 +49,17 @@ class parasweep : public analysis
   int  solve (void);
   int  cleanup (void);
   void saveResults (void);
+  void resetSweep (void);
+
+ protected:
+  virtual int solvePoint (nr_double_t);
+  void initChildren (void);
 
  private:
+  int  solveArclength (void);
+  int  solveParallel (int);
+
+ protected:
   variable * var;
   sweep * swp;
   void * eqn;
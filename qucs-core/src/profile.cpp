@@ -0,0 +1,189 @@
+/*
+ * profile.cpp - timing and counter instrumentation implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+
+#include "logging.h"
+#include "complex.h"
+#include "object.h"
+#include "analysis.h"
+#include "profile.h"
+
+namespace qucs {
+
+bool profile::active = false;
+std::vector<profile::record_t *> profile::records;
+std::vector<int> profile::stack;
+std::vector<profile::wallclock::time_point> profile::wallstart;
+std::vector<std::clock_t> profile::cpustart;
+profile::phase * profile::running = NULL;
+profile::wallclock::time_point profile::phasewall;
+std::clock_t profile::phasecpu;
+
+static const char * phasenames[PROFILE_PHASES] = {
+  "parse", "check", "equations", "setup", "assembly", "factorization",
+  "devices", "output"
+};
+
+// indexed by the analysis type plus one
+static const char * typenames[] = {
+  "simulator", "sweep", "dc", "ac", "hb", "tr", "sp", "etr", "digital",
+  "pss"
+};
+
+static const char * counternames[PROFILE_COUNTERS] = {
+  "newton", "rejected", "factorizations", "allocations", "chord"
+};
+
+/* Starts recording, the time up to now is not accounted.  The
+   simulator itself is the outermost record. */
+void profile::enable (void) {
+  if (active) return;
+  active = true;
+  enter ("qucsator", ANALYSIS_UNKNOWN);
+}
+
+/* The helpers account the time elapsed since the last start to the
+   given phase of the current record and restart the phase clock. */
+void profile::start (void) {
+  phasewall = wallclock::now ();
+  phasecpu = std::clock ();
+}
+
+void profile::stop (int id) {
+  record_t * r = current ();
+  r->phasewall[id] +=
+    std::chrono::duration<double> (wallclock::now () - phasewall).count ();
+  r->phasecpu[id] += (double) (std::clock () - phasecpu) / CLOCKS_PER_SEC;
+}
+
+/* Makes the analysis of the given name and type the current record
+   until the matching leave().  The analyses are recorded once by name, running
+   the same analysis again accumulates into its record. */
+void profile::enter (const std::string & name, int type) {
+  if (!active) return;
+  if (running) stop (running->id);
+
+  int idx;
+  for (idx = 0; idx < (int) records.size (); idx++)
+    if (records[idx]->name == name) break;
+  if (idx == (int) records.size ()) {
+    record_t * r = new record_t ();
+    r->name = name;
+    int t = type + 1;
+    r->type = (t >= 0 && t < (int) (sizeof (typenames) / sizeof (char *))) ?
+      typenames[t] : "unknown";
+    r->runs = 0;
+    r->wall = r->cpu = 0.0;
+    for (int i = 0; i < PROFILE_PHASES; i++)
+      r->phasewall[i] = r->phasecpu[i] = 0.0;
+    for (int i = 0; i < PROFILE_COUNTERS; i++)
+      r->counters[i] = 0;
+    records.push_back (r);
+  }
+  records[idx]->runs++;
+  stack.push_back (idx);
+  wallstart.push_back (wallclock::now ());
+  cpustart.push_back (std::clock ());
+
+  if (running) start ();
+}
+
+/* Returns to the enclosing record. */
+void profile::leave (void) {
+  if (!active || stack.size () < 2) return;
+  if (running) stop (running->id);
+
+  record_t * r = current ();
+  r->wall +=
+    std::chrono::duration<double> (wallclock::now () - wallstart.back ())
+    .count ();
+  r->cpu += (double) (std::clock () - cpustart.back ()) / CLOCKS_PER_SEC;
+  stack.pop_back ();
+  wallstart.pop_back ();
+  cpustart.pop_back ();
+
+  if (running) start ();
+}
+
+profile::phase::phase (int p) : id (p), outer (running) {
+  if (!active) return;
+  if (outer) stop (outer->id);
+  running = this;
+  start ();
+}
+
+profile::phase::~phase () {
+  if (!active) return;
+  stop (id);
+  running = outer;
+  if (running) start ();
+}
+
+/* Writes the records into the given file in JSON format.  Returns
+   zero on success. */
+int profile::write (const char * file) {
+  if (!active) return 0;
+
+  FILE * f = fopen (file, "w");
+  if (f == NULL) {
+    logprint (LOG_ERROR, "cannot create file `%s'\n", file);
+    return -1;
+  }
+
+  // the simulator record runs until now
+  record_t * top = records[0];
+  top->wall =
+    std::chrono::duration<double> (wallclock::now () - wallstart[0]).count ();
+  top->cpu = (double) (std::clock () - cpustart[0]) / CLOCKS_PER_SEC;
+
+  fprintf (f, "{\n  \"analyses\": [");
+  for (size_t i = 0; i < records.size (); i++) {
+    record_t * r = records[i];
+    fprintf (f, "%s\n    {\n", i ? "," : "");
+    fprintf (f, "      \"name\": \"%s\",\n", r->name.c_str ());
+    fprintf (f, "      \"type\": \"%s\",\n", r->type.c_str ());
+    fprintf (f, "      \"runs\": %d,\n", r->runs);
+    fprintf (f, "      \"wall\": %.6f,\n", r->wall);
+    fprintf (f, "      \"cpu\": %.6f,\n", r->cpu);
+    fprintf (f, "      \"phases\": {");
+    for (int p = 0; p < PROFILE_PHASES; p++)
+      fprintf (f, "%s\n        \"%s\": { \"wall\": %.6f, \"cpu\": %.6f }",
+	       p ? "," : "", phasenames[p], r->phasewall[p], r->phasecpu[p]);
+    fprintf (f, "\n      },\n      \"counters\": {");
+    for (int c = 0; c < PROFILE_COUNTERS; c++)
+      fprintf (f, "%s\n        \"%s\": %ld", c ? "," : "", counternames[c],
+	       r->counters[c].load ());
+    fprintf (f, "\n      }\n    }");
+  }
+  fprintf (f, "\n  ]\n}\n");
+  fclose (f);
+  return 0;
+}
+
+} // namespace qucs
@@ -0,0 +1,127 @@
+/*
+ * profile.h - timing and counter instrumentation definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace qucs {
+
+// phases the run time is accounted to
+enum profile_phase {
+  PROFILE_PARSE = 0,
+  PROFILE_CHECK,
+  PROFILE_EQUATIONS,
+  PROFILE_SETUP,
+  PROFILE_ASSEMBLY,
+  PROFILE_FACTORIZATION,
+  PROFILE_DEVICES,
+  PROFILE_OUTPUT,
+  PROFILE_PHASES
+};
+
+// events counted
+enum profile_counter {
+  PROFILE_NEWTON = 0,
+  PROFILE_REJECTED,
+  PROFILE_FACTORIZATIONS,
+  PROFILE_ALLOCATIONS,
+  PROFILE_CHORD,
+  PROFILE_COUNTERS
+};
+
+/*! \class profile
+ * \brief wall and CPU time per phase and event counters of a run.
+ *
+ * The phases and counters are accounted to the innermost analysis
+ * being run, or to the simulator itself outside of all analyses.  The
+ * phase times are exclusive, a phase started within another one
+ * pauses the outer one.  Nothing is recorded unless enabled, phases
+ * must be timed by the main thread only while the counters may be
+ * incremented by any thread.
+ */
+class profile
+{
+ public:
+  static void enable (void);
+  static bool enabled (void) { return active; }
+
+  static void enter (const std::string &, int);
+  static void leave (void);
+
+  static void count (int counter, long n = 1) {
+    if (active) current ()->counters[counter] += n;
+  }
+
+  static int write (const char *);
+
+  /* Accounts the run time to a phase during its lifetime. */
+  class phase
+  {
+  public:
+    phase (int);
+    ~phase ();
+  private:
+    friend class profile;
+    int id;
+    phase * outer;
+  };
+
+ private:
+  typedef std::chrono::steady_clock wallclock;
+
+  struct record_t
+  {
+    std::string name;
+    std::string type;
+    int runs;
+    double wall, cpu;
+    double phasewall[PROFILE_PHASES];
+    double phasecpu[PROFILE_PHASES];
+    std::atomic<long> counters[PROFILE_COUNTERS];
+  };
+
+  static record_t * current (void) { return records[stack.back ()]; }
+  static void start (void);
+  static void stop (int);
+
+ private:
+  static bool active;
+  static std::vector<record_t *> records;
+  static std::vector<int> stack;
+  static std::vector<wallclock::time_point> wallstart;
+  static std::vector<std::clock_t> cpustart;
+  static phase * running;
+  static wallclock::time_point phasewall;
+  static std::clock_t phasecpu;
+};
+
+} // namespace qucs
+
+#endif /* __PROFILE_H__ */
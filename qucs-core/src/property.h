@@ -28,6 +28,9 @@
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <functional>
+
+#include "arena.h"
 
 namespace qucs {
 
@@ -60,6 +63,7 @@ class property
   std::string toString (void) const;
   bool isDefault (void) const { return def; }
   void setDefault (bool d) { def = d; }
+  int getType (void) const { return type; }
 
  private:
   bool def;
@@ -69,7 +73,38 @@ class property
   variable * var;
 };
 
-typedef std::unordered_map<std::string, property> properties;
+// the properties of an object live in the arena of the netlist
+typedef std::unordered_map<std::string, property, std::hash<std::string>,
+			   std::equal_to<std::string>,
+			   arena_allocator<std::pair<const std::string,
+						     property> > > properties;
+
+class object;
+
+/*! \class parameter
+ * \brief cached binding of an object property.
+ *
+ * A parameter names a property of an object.  The object resolves
+ * the name on first access and only again if properties have been
+ * added meanwhile.  Otherwise the value is read straight from the
+ * bound property.  Properties defined by variables (e.g. swept
+ * values) are evaluated on each access as before.
+ */
+class parameter
+{
+ public:
+  parameter (const char * n) : name (n), owner (NULL), gen (0),
+    scaled (false), prop (NULL) { }
+  const char * getName (void) const { return name; }
+
+ private:
+  friend class object;
+  const char * name;
+  const object * owner;
+  unsigned int gen;
+  bool scaled;
+  const property * prop;
+};
  
 } // namespace qucs
 
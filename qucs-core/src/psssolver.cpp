@@ -0,0 +1,288 @@
+/*
+ * psssolver.cpp - periodic steady-state solver class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+#include <algorithm>
+
+#include "compat.h"
+#include "object.h"
+#include "logging.h"
+#include "complex.h"
+#include "circuit.h"
+#include "net.h"
+#include "netdefs.h"
+#include "analysis.h"
+#include "psssolver.h"
+
+namespace qucs {
+
+// Constructor creates an unnamed instance of the psssolver class.
+psssolver::psssolver ()
+    : trsolver ()
+{
+    type = ANALYSIS_PSS;
+    setDescription ("periodic steady-state");
+    periodRuns = periods = 0;
+}
+
+// Constructor creates a named instance of the psssolver class.
+psssolver::psssolver (const std::string &n)
+    : trsolver (n)
+{
+    type = ANALYSIS_PSS;
+    setDescription ("periodic steady-state");
+    periodRuns = periods = 0;
+}
+
+// Destructor deletes the psssolver class object.
+psssolver::~psssolver ()
+{
+}
+
+/* The copy constructor creates a new instance of the psssolver class
+   based on the given psssolver object. */
+psssolver::psssolver (psssolver & o)
+    : trsolver (o)
+{
+    periodRuns = periods = 0;
+}
+
+/* Runs the transient analysis over one period, starting at the given
+   solution or at the initial DC solution if there is none.  The
+   solution at the end of the period is passed back. */
+int psssolver::period (tvector<nr_double_t> * start,
+                       tvector<nr_double_t> & end, bool save)
+{
+    startSolution = start;
+    recording = save;
+    runs = periodRuns - 1;
+    int error = trsolver::solve ();
+    startSolution = NULL;
+    recording = true;
+    periods++;
+    if (!error) end = *x;
+    return error;
+}
+
+/* Returns true if the given Newton step of the start solution is
+   within the tolerances of the Newton iterations.  The change over a
+   single period is no measure, it is small for slowly settling
+   circuits as well. */
+bool psssolver::isConverged (const tvector<nr_double_t> & dx,
+                             const tvector<nr_double_t> & start)
+{
+    nr_double_t reltol = getPropertyDouble ("reltol");
+    nr_double_t abstol = getPropertyDouble ("abstol");
+    nr_double_t vntol = getPropertyDouble ("vntol");
+    int N = start.size () - countVoltageSources ();
+    for (int i = 0; i < (int) start.size (); i++)
+    {
+        nr_double_t tol = reltol * fabs (start (i)) + (i < N ? vntol : abstol);
+        if (fabs (dx (i)) > tol) return false;
+    }
+    return true;
+}
+
+/* Computes the product of the given unit vector with the matrix of
+   the shooting Newton step, dPhi/dx0 - 1.  The sensitivity of the
+   period is obtained by finite differences. */
+int psssolver::applyJacobian (const tvector<nr_double_t> & start,
+                              const tvector<nr_double_t> & end,
+                              const tvector<nr_double_t> & v,
+                              tvector<nr_double_t> & w)
+{
+    /* The period is accurate to the truncation error only, thus the
+       perturbation must be far above the rounding errors. */
+    nr_double_t eps = 1e-4 * (1 + maxnorm (start));
+    tvector<nr_double_t> s = start + eps * v;
+    if (period (&s, w, false)) return -1;
+    w = (w - end) * (1 / eps) - v;
+    return 0;
+}
+
+/* Solves the shooting Newton step (dPhi/dx0 - 1) * dx = -r by GMRES.
+   Its Krylov subspace grows by one period per iteration, the loop
+   stops once the residual is reduced well below the one of the
+   Newton iteration. */
+int psssolver::shoot (tvector<nr_double_t> & dx,
+                      const tvector<nr_double_t> & start,
+                      const tvector<nr_double_t> & end,
+                      const tvector<nr_double_t> & r)
+{
+    int n = r.size (), m = std::min (n, PSS_KRYLOV_MAX), k, i, j;
+    nr_double_t beta = std::sqrt (norm (r));
+    tvector<nr_double_t> cs (m), sn (m), g (m + 1), y (m);
+    tmatrix<nr_double_t> H (m + 1, m);
+    std::vector<tvector<nr_double_t> > V;
+
+    dx = tvector<nr_double_t> (n);
+    if (beta == 0) return 0;
+    V.push_back (r * (-1 / beta));
+    g (0) = beta;
+
+    for (k = 0; k < m; k++)
+    {
+        tvector<nr_double_t> w;
+        if (applyJacobian (start, end, V[k], w)) return -1;
+
+        // orthogonalize by the modified Gram-Schmidt process
+        for (i = 0; i <= k; i++)
+        {
+            H (i, k) = scalar (w, V[i]);
+            w = w - H (i, k) * V[i];
+        }
+        H (k + 1, k) = std::sqrt (norm (w));
+
+        // apply the previous Givens rotations, then the new one
+        for (i = 0; i < k; i++)
+        {
+            nr_double_t h = cs (i) * H (i, k) + sn (i) * H (i + 1, k);
+            H (i + 1, k) = -sn (i) * H (i, k) + cs (i) * H (i + 1, k);
+            H (i, k) = h;
+        }
+        nr_double_t d = std::hypot (H (k, k), H (k + 1, k));
+        cs (k) = H (k, k) / d;
+        sn (k) = H (k + 1, k) / d;
+        nr_double_t h = H (k + 1, k);
+        H (k, k) = d;
+        H (k + 1, k) = 0;
+        g (k + 1) = -sn (k) * g (k);
+        g (k) = cs (k) * g (k);
+
+        if (fabs (g (k + 1)) < 1e-3 * beta || h == 0)
+        {
+            k++;
+            break;
+        }
+        V.push_back (w * (1 / h));
+    }
+
+    // solve the upper triangular system and update the solution
+    for (i = k - 1; i >= 0; i--)
+    {
+        y (i) = g (i);
+        for (j = i + 1; j < k; j++) y (i) -= H (i, j) * y (j);
+        y (i) /= H (i, i);
+    }
+    for (i = 0; i < k; i++) dx = dx + y (i) * V[i];
+    return 0;
+}
+
+/* This is the periodic steady-state netlist solver.  After a few
+   settling periods the shooting Newton iterations correct the
+   solution at the start of the period until the period ends in it.
+   The final period is saved like a transient analysis. */
+int psssolver::solve (void)
+{
+    nr_double_t T = getPropertyDouble ("Period");
+    int settle = getPropertyInteger ("Periods");
+    int maxShooting = getPropertyInteger ("MaxShooting");
+    tvector<nr_double_t> start, end, dx;
+    int iter;
+
+    runs++;
+    periodRuns = runs;
+    periods = 0;
+
+    // The transient analysis runs over a single period.
+    setProperty ("Type", "lin");
+    setProperty ("Start", 0.0);
+    setProperty ("Stop", T);
+    setProperty ("MixedSignal", "no");
+    setProperty ("Multirate", "no");
+
+    // Start from the initial DC solution and let the circuit settle.
+    if (period (NULL, end, false)) return -1;
+    for (int i = 1; i < settle; i++)
+    {
+        start = end;
+        if (period (&start, end, false)) return -1;
+    }
+    start = end;
+
+    // Shooting Newton iterations.
+    for (iter = 1;; iter++)
+    {
+        if (period (&start, end, false)) return -1;
+        if (shoot (dx, start, end, end - start)) return -1;
+        start = start + dx;
+        if (isConverged (dx, start)) break;
+        if (iter == maxShooting)
+        {
+            logprint (LOG_ERROR, "WARNING: %s: no periodic steady state after "
+                      "%d shooting iterations\n", getName (), iter);
+            break;
+        }
+    }
+    logprint (LOG_STATUS, "NOTIFY: %s: periodic steady state after %d "
+              "shooting iterations, %d periods\n", getName (), iter, periods);
+
+    // Save the steady-state period.
+    return period (&start, end, true);
+}
+
+// properties
+PROP_REQ [] =
+{
+    { "Period", PROP_REAL, { 1e-3, PROP_NO_STR }, PROP_POS_RANGEX },
+    { "Points", PROP_INT, { 101, PROP_NO_STR }, PROP_MIN_VAL (2) },
+    PROP_NO_PROP
+};
+PROP_OPT [] =
+{
+    { "Periods", PROP_INT, { 1, PROP_NO_STR }, PROP_RNGII (1, 10000) },
+    { "MaxShooting", PROP_INT, { 20, PROP_NO_STR }, PROP_RNGII (1, 1000) },
+    {
+        "IntegrationMethod", PROP_STR, { PROP_NO_VAL, "Trapezoidal" },
+        PROP_RNG_STR4 ("Euler", "Trapezoidal", "Gear", "AdamsMoulton")
+    },
+    { "Order", PROP_INT, { 2, PROP_NO_STR }, PROP_RNGII (1, 6) },
+    { "InitialStep", PROP_REAL, { 1e-9, PROP_NO_STR }, PROP_POS_RANGE },
+    { "MinStep", PROP_REAL, { 1e-16, PROP_NO_STR }, PROP_POS_RANGE },
+    { "MaxStep", PROP_REAL, { 0, PROP_NO_STR }, PROP_POS_RANGE },
+    { "MaxIter", PROP_INT, { 150, PROP_NO_STR }, PROP_RNGII (2, 10000) },
+    { "abstol", PROP_REAL, { 1e-12, PROP_NO_STR }, PROP_RNG_X01I },
+    { "vntol", PROP_REAL, { 1e-6, PROP_NO_STR }, PROP_RNG_X01I },
+    { "reltol", PROP_REAL, { 1e-3, PROP_NO_STR }, PROP_RNG_X01I },
+    { "LTEabstol", PROP_REAL, { 1e-6, PROP_NO_STR }, PROP_RNG_X01I },
+    { "LTEreltol", PROP_REAL, { 1e-3, PROP_NO_STR }, PROP_RNG_X01I },
+    { "LTEfactor", PROP_REAL, { 1, PROP_NO_STR }, PROP_RNGII (1, 16) },
+    { "Temp", PROP_REAL, { 26.85, PROP_NO_STR }, PROP_MIN_VAL (K) },
+    { "Solver", PROP_STR, { PROP_NO_VAL, "CroutLU" }, PROP_RNG_SOL },
+    { "relaxTSR", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+    { "initialDC", PROP_STR, { PROP_NO_VAL, "yes" }, PROP_RNG_YESNO },
+    { "Bypass", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+    { "Threads", PROP_INT, { 1, PROP_NO_STR }, PROP_RNGII (0, 256) },
+    PROP_NO_PROP
+};
+struct define_t psssolver::anadef =
+    { "PSS", 0, PROP_ACTION, PROP_NO_SUBSTRATE, PROP_LINEAR, PROP_DEF };
+
+} // namespace qucs
@@ -0,0 +1,73 @@
+/*
+ * psssolver.h - periodic steady-state solver class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __PSSSOLVER_H__
+#define __PSSSOLVER_H__
+
+#include "trsolver.h"
+
+// Maximum dimension of the Krylov subspace of the shooting Newton step.
+#define PSS_KRYLOV_MAX 32
+
+namespace qucs {
+
+/*! \class psssolver
+ * \brief periodic steady-state analysis by the shooting method.
+ *
+ * The steady state is the initial solution x0 which the transient
+ * analysis over one period T maps onto itself, Phi(x0) = x0.  It is
+ * found by Newton iterations on Phi(x0) - x0.  The linear equations
+ * of each iteration are solved by GMRES, the sensitivity matrix of
+ * Phi is never formed: its products with a vector are obtained from
+ * the transient analysis of a period starting at a perturbed x0.  The
+ * final period is saved like the results of a transient analysis.
+ */
+class psssolver : public trsolver
+{
+public:
+    ACREATOR (psssolver);
+    psssolver (const std::string &);
+    psssolver (psssolver &);
+    ~psssolver ();
+    int  solve (void);
+
+private:
+    int  period (tvector<nr_double_t> *, tvector<nr_double_t> &, bool);
+    int  shoot (tvector<nr_double_t> &, const tvector<nr_double_t> &,
+                const tvector<nr_double_t> &, const tvector<nr_double_t> &);
+    int  applyJacobian (const tvector<nr_double_t> &,
+                        const tvector<nr_double_t> &,
+                        const tvector<nr_double_t> &,
+                        tvector<nr_double_t> &);
+    bool isConverged (const tvector<nr_double_t> &,
+                      const tvector<nr_double_t> &);
+
+private:
+    int periodRuns;   // value of runs for the transient analyses
+    int periods;      // number of transient periods run so far
+};
+
+} // namespace qucs
+
+#endif /* __PSSSOLVER_H__ */
@@ -0,0 +1,399 @@
+/*
+ * reducer.cpp - model order reduction of linear subcircuits implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "logging.h"
+#include "complex.h"
+#include "object.h"
+#include "node.h"
+#include "circuit.h"
+#include "net.h"
+#include "tvector.h"
+#include "tmatrix.h"
+#include "tspmatrix.h"
+#include "eqnsys.h"
+#include "exception.h"
+#include "numstatus.h"
+#include "constants.h"
+#include "component_id.h"
+#include "romodel.h"
+#include "reducer.h"
+
+namespace qucs {
+
+// the entries of a stamped matrix by column and row
+typedef std::map<std::pair<int, int>, nr_double_t> stamps_t;
+
+// the reduced models by the contents of their subcircuits
+static std::mutex cachelock;
+static std::map<std::string, std::shared_ptr<romodel_t> > cache;
+
+reducer::reducer (net * n, const std::string & a) : subnet (n), name (a) {
+}
+
+reducer::~reducer () {
+  restore ();
+}
+
+/* Returns the name of the subcircuit instance the circuit belongs to,
+   the circuit name without its last part. */
+static std::string instance (circuit * c) {
+  if (c->getSubcircuit ().empty ()) return "";
+  std::string n = c->getName ();
+  size_t p = n.rfind ('.');
+  return p == std::string::npos ? "" : n.substr (0, p);
+}
+
+/* Returns the resistance, capacitance or inductance of the circuit.
+   Zero is returned if it is none of these or cannot be reduced. */
+static nr_double_t value (circuit * c) {
+  if (c->hasProperty ("Controlled")) return 0;
+  switch (c->getType ()) {
+  case CIR_RESISTOR: {
+    // the same temperature dependency as the resistor itself
+    nr_double_t DT = c->getPropertyDouble ("Temp") -
+      c->getPropertyDouble ("Tnom");
+    nr_double_t Tc1 = c->getPropertyDouble ("Tc1");
+    nr_double_t Tc2 = c->getPropertyDouble ("Tc2");
+    return c->getPropertyDouble ("R") * (1 + DT * (Tc1 + Tc2 * DT));
+  }
+  case CIR_CAPACITOR:
+    // initial conditions cannot be applied to the reduced model
+    return c->isPropertyGiven ("V") ? 0 : c->getPropertyDouble ("C");
+  case CIR_INDUCTOR:
+    return c->isPropertyGiven ("I") ? 0 : c->getPropertyDouble ("L");
+  }
+  return 0;
+}
+
+static void stamp (stamps_t & s, int r, int c, nr_double_t v) {
+  if (r >= 0 && c >= 0) s[std::make_pair (c, r)] += v;
+}
+
+static void stamp2 (stamps_t & s, int a, int b, nr_double_t v) {
+  stamp (s, a, a, +v); stamp (s, b, b, +v);
+  stamp (s, a, b, -v); stamp (s, b, a, -v);
+}
+
+/* Orthogonalizes the vector against the basis twice and appends it
+   normalized.  Returns false if it is dependent on the basis. */
+static bool orthonormalize (std::vector<std::vector<nr_double_t> > & V,
+			    std::vector<nr_double_t> & w) {
+  nr_double_t n0 = 0, n = 0;
+  for (nr_double_t x : w) n0 += x * x;
+  if (n0 == 0) return false;
+  for (int pass = 0; pass < 2; pass++) {
+    for (std::vector<nr_double_t> & v : V) {
+      nr_double_t d = 0;
+      for (size_t i = 0; i < w.size (); i++) d += v[i] * w[i];
+      for (size_t i = 0; i < w.size (); i++) w[i] -= d * v[i];
+    }
+  }
+  for (nr_double_t x : w) n += x * x;
+  if (n <= 1e-16 * n0) return false;
+  n = std::sqrt (n);
+  for (nr_double_t & x : w) x /= n;
+  V.push_back (w);
+  return true;
+}
+
+// Returns the matrix T' S T for the sparse matrix S.
+static std::vector<nr_double_t> congruence (const stamps_t & S,
+					    const tmatrix<nr_double_t> & T) {
+  int n = T.getRows (), m = T.getCols ();
+  tmatrix<nr_double_t> ST (n, m);
+  for (auto & e : S) {
+    int c = e.first.first, r = e.first.second;
+    for (int j = 0; j < m; j++) ST (r, j) += e.second * T (c, j);
+  }
+  std::vector<nr_double_t> res (m * m, 0);
+  for (int r = 0; r < n; r++)
+    for (int i = 0; i < m; i++) {
+      nr_double_t t = T (r, i);
+      if (t == 0) continue;
+      for (int j = 0; j < m; j++) res[i * m + j] += t * ST (r, j);
+    }
+  return res;
+}
+
+/* Reduces the network (G + sC) x = i whose first unknowns are the
+   internal ones, followed by the port voltages.  The internal unknowns
+   are replaced by the static solution X for the port voltages and the
+   block Krylov subspace of Gii^-1 Cii applied to the moments
+   Gii^-1 (Cii X + Cip) beyond it.  Returns NULL if the internal
+   conductances are singular. */
+static std::shared_ptr<romodel_t> project (const stamps_t & G,
+					   const stamps_t & C,
+					   int ni, int P) {
+  // sparse factors of the internal conductances
+  std::vector<int> ri, ci;
+  for (auto & e : G) {
+    if (e.first.first >= ni || e.first.second >= ni) continue;
+    ci.push_back (e.first.first);
+    ri.push_back (e.first.second);
+  }
+  tspmatrix<nr_double_t> A (ni, ni, ri.size (), ri.data (), ci.data ());
+  for (auto & e : G)
+    if (e.first.first < ni && e.first.second < ni)
+      A.set (e.first.second, e.first.first, e.second);
+  tvector<nr_double_t> x (ni), b (ni);
+  eqnsys<nr_double_t> eqns;
+  eqns.setAlgo (ALGO_LU_DECOMPOSITION_SPARSE);
+  eqns.passEquationSys (&A, &x, &b);
+  int mark = numstatus::mark ();
+  eqns.factorize ();
+  if (numstatus::raised (mark)) {
+    numstatus::release (mark);
+    return nullptr;
+  }
+
+  // static solution of the internal unknowns
+  tmatrix<nr_double_t> B (ni, P), X (ni, P);
+  for (auto & e : G) {
+    int c = e.first.first, r = e.first.second;
+    if (r < ni && c >= ni) B (r, c - ni) -= e.second;
+  }
+  eqns.solveMany (&B, &X);
+
+  // the block moments start with Gii^-1 (Cii X + Cip)
+  std::vector<std::vector<nr_double_t> > V, block;
+  tmatrix<nr_double_t> M (ni, P), W (ni, P);
+  for (auto & e : C) {
+    int c = e.first.first, r = e.first.second;
+    if (r >= ni) continue;
+    if (c < ni)
+      for (int p = 0; p < P; p++) M (r, p) += e.second * X (c, p);
+    else
+      M (r, c - ni) += e.second;
+  }
+  eqns.solveMany (&M, &W);
+  for (int p = 0; p < P; p++) {
+    std::vector<nr_double_t> w (ni);
+    for (int r = 0; r < ni; r++) w[r] = W (r, p);
+    block.push_back (w);
+  }
+
+  // block Arnoldi process with deflation of dependent vectors
+  for (int k = 0; k < REDUCER_MOMENTS && !block.empty (); k++) {
+    size_t first = V.size ();
+    for (std::vector<nr_double_t> & w : block) orthonormalize (V, w);
+    block.clear ();
+    int nb = V.size () - first;
+    if (k + 1 == REDUCER_MOMENTS || nb == 0) break;
+    tmatrix<nr_double_t> Mk (ni, nb), Wk (ni, nb);
+    for (auto & e : C) {
+      int c = e.first.first, r = e.first.second;
+      if (r >= ni || c >= ni) continue;
+      for (int j = 0; j < nb; j++) Mk (r, j) += e.second * V[first + j][c];
+    }
+    eqns.solveMany (&Mk, &Wk);
+    for (int j = 0; j < nb; j++) {
+      std::vector<nr_double_t> w (ni);
+      for (int r = 0; r < ni; r++) w[r] = Wk (r, j);
+      block.push_back (w);
+    }
+  }
+
+  // the congruence transformation with the ports first
+  int q = V.size (), n = ni + P, m = P + q;
+  tmatrix<nr_double_t> T (n, m);
+  for (int p = 0; p < P; p++) {
+    for (int r = 0; r < ni; r++) T (r, p) = X (r, p);
+    T (ni + p, p) = 1;
+  }
+  for (int k = 0; k < q; k++)
+    for (int r = 0; r < ni; r++) T (r, P + k) = V[k][r];
+
+  std::shared_ptr<romodel_t> rom = std::make_shared<romodel_t> ();
+  rom->ports = P;
+  rom->states = q;
+  rom->G = congruence (G, T);
+  rom->C = congruence (C, T);
+  return rom;
+}
+
+/* Replaces the suitable subcircuit instances of the netlist by their
+   reduced models and returns the number of replaced instances. */
+int reducer::reduce (void) {
+  std::map<std::string, std::vector<circuit *> > groups;
+  std::map<std::string, std::string> owner;
+
+  // the nodes used by a single instance only are internal ones
+  for (circuit * c = subnet->getRoot (); c != NULL;
+       c = (circuit *) c->getNext ()) {
+    std::string inst = instance (c);
+    if (!inst.empty ()) groups[inst].push_back (c);
+    for (int i = 0; i < c->getSize (); i++) {
+      std::string n = c->getNode (i)->getName ();
+      auto it = owner.find (n);
+      if (it == owner.end ())
+	owner[n] = inst;
+      else if (it->second != inst)
+	it->second = "";
+    }
+  }
+
+  int count = 0, before = 0, after = 0;
+  for (auto & g : groups) {
+    const std::string & inst = g.first;
+    std::vector<circuit *> & cs = g.second;
+    bool linear = true;
+    for (circuit * c : cs) if (value (c) == 0) linear = false;
+    if (!linear) continue;
+    std::sort (cs.begin (), cs.end (), [] (circuit * a, circuit * b) {
+	return strcmp (a->getName (), b->getName ()) < 0; });
+
+    // number the internal nodes, the inductor currents and the ports
+    std::map<std::string, int> index, port;
+    std::vector<std::string> ports;
+    int ni = 0;
+    for (circuit * c : cs) {
+      for (int i = 0; i < c->getSize (); i++) {
+	std::string n = c->getNode (i)->getName ();
+	if (n == "gnd" || index.count (n) || port.count (n)) continue;
+	if (owner[n] == inst)
+	  index[n] = ni++;
+	else {
+	  port[n] = ports.size ();
+	  ports.push_back (n);
+	}
+      }
+    }
+    for (circuit * c : cs) if (c->getType () == CIR_INDUCTOR) ni++;
+    int P = ports.size ();
+    if (P == 0 || P > REDUCER_PORTS || ni <= 2 * REDUCER_MOMENTS * P)
+      continue;
+
+    // the subcircuit contents, node names relative to the instance
+    std::string key = cs[0]->getSubcircuit ();
+    auto unknown = [&] (const std::string & n) {
+      if (n == "gnd") return -1;
+      auto it = index.find (n);
+      return it != index.end () ? it->second : ni + port[n];
+    };
+    for (circuit * c : cs) {
+      char txt[64];
+      key += ";" + std::string (c->getName () + inst.size ());
+      sprintf (txt, " %d %.17g", c->getType (), value (c));
+      key += txt;
+      for (int i = 0; i < c->getSize (); i++) {
+	std::string n = c->getNode (i)->getName ();
+	if (n == "gnd" || index.count (n))
+	  key += " " + (n == "gnd" ? n : n.substr (inst.size ()));
+	else
+	  key += " #" + std::to_string (port[n]);
+      }
+    }
+
+    std::shared_ptr<romodel_t> model;
+    bool cached;
+    {
+      std::lock_guard<std::mutex> lock (cachelock);
+      auto it = cache.find (key);
+      cached = it != cache.end ();
+      if (cached) model = it->second;
+    }
+    if (!cached) {
+      stamps_t G, C;
+      int branch = ni;
+      for (auto it = cs.rbegin (); it != cs.rend (); it++) {
+	circuit * c = *it;
+	int a = unknown (c->getNode (NODE_1)->getName ());
+	int b = unknown (c->getNode (NODE_2)->getName ());
+	nr_double_t v = value (c);
+	switch (c->getType ()) {
+	case CIR_RESISTOR:
+	  stamp2 (G, a, b, 1 / v);
+	  break;
+	case CIR_CAPACITOR:
+	  stamp2 (C, a, b, v);
+	  break;
+	case CIR_INDUCTOR:
+	  // the branch equation is negated to keep G + G' positive
+	  branch--;
+	  stamp (G, a, branch, +1); stamp (G, branch, a, -1);
+	  stamp (G, b, branch, -1); stamp (G, branch, b, +1);
+	  stamp (C, branch, branch, v);
+	  break;
+	}
+      }
+      model = project (G, C, ni, P);
+      std::lock_guard<std::mutex> lock (cachelock);
+      cache[key] = model;
+    }
+    if (!model) {
+      logprint (LOG_ERROR, "WARNING: %s: cannot reduce the singular "
+		"subcircuit `%s'\n", name.c_str (), inst.c_str ());
+      continue;
+    }
+
+    // swap the circuits of the instance for the reduced model
+    for (circuit * c : cs) {
+      subnet->removeCircuit (c, 0);
+      removed.push_back (c);
+    }
+    romodel * r = new romodel (model);
+    r->setName (inst);
+    for (int p = 0; p < P; p++) r->setNode (p, ports[p]);
+    for (int k = 0; k < model->states; k++)
+      r->setInternalNode (P + k, "x" + std::to_string (k));
+    // kept as original circuit by the solvers until restored
+    r->setOriginal (1);
+    subnet->insertCircuit (r);
+    inserted.push_back (r);
+
+    count++;
+    before += ni + P;
+    after += P + model->states;
+  }
+
+  if (count > 0)
+    logprint (LOG_STATUS, "NOTIFY: %s: reduced %d linear subcircuits from %d "
+	      "to %d unknowns\n", name.c_str (), count, before, after);
+  return count;
+}
+
+// Puts the reduced subcircuits back into the netlist.
+void reducer::restore (void) {
+  for (circuit * c : inserted) {
+    c->setOriginal (0);
+    subnet->removeCircuit (c);
+  }
+  for (circuit * c : removed) subnet->insertCircuit (c);
+  inserted.clear ();
+  removed.clear ();
+}
+
+} // namespace qucs
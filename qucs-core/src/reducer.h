@@ -0,0 +1,71 @@
+/*
+ * reducer.h - model order reduction of linear subcircuits definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __REDUCER_H__
+#define __REDUCER_H__
+
+#include <string>
+#include <vector>
+
+// largest number of ports of a reduced subcircuit
+#define REDUCER_PORTS   16
+
+// number of block moments matched at each port
+#define REDUCER_MOMENTS 4
+
+namespace qucs {
+
+class net;
+class circuit;
+
+/*! \class reducer
+ * \brief model order reduction of linear subcircuits.
+ *
+ * Instances of subcircuits consisting of resistors, capacitors and
+ * inductors only are replaced by a compact model for the duration of
+ * an analysis.  The internal unknowns of the instance are projected
+ * onto the static solution for its port voltages and a block Krylov
+ * subspace of the moments beyond it, as in the PRIMA algorithm.  The
+ * congruence transformation preserves passivity and the DC behaviour
+ * is exact.  Models are cached by the elements, node connections and
+ * values of the instance, hence equal instances share them.
+ */
+class reducer
+{
+ public:
+  reducer (net *, const std::string &);
+  ~reducer ();
+  int reduce (void);
+  void restore (void);
+
+ private:
+  net * subnet;
+  std::string name;
+  std::vector<circuit *> removed;
+  std::vector<circuit *> inserted;
+};
+
+} // namespace qucs
+
+#endif /* __REDUCER_H__ */
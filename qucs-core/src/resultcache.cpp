@@ -0,0 +1,252 @@
+/*
+ * resultcache.cpp - analysis result cache implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <set>
+
+#include "logging.h"
+#include "complex.h"
+#include "object.h"
+#include "vector.h"
+#include "strlist.h"
+#include "dataset.h"
+#include "ptrlist.h"
+#include "analysis.h"
+#include "equation.h"
+#include "netdefs.h"
+#include "resultcache.h"
+
+namespace qucs {
+
+std::string resultcache::directory;
+std::string resultcache::circuits;
+std::map<std::string, std::string> resultcache::files;
+std::map<std::string, resultcache::action_t> resultcache::actions;
+
+// FNV-1a hash of the given bytes continuing the given hash.
+static unsigned long long fnv (const char * p, size_t n,
+			       unsigned long long h = 14695981039346656037ULL) {
+  for (size_t i = 0; i < n; i++) {
+    h ^= (unsigned char) p[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+static std::string hex (unsigned long long h) {
+  char b[17];
+  snprintf (b, sizeof (b), "%016llx", h);
+  return b;
+}
+
+/* Returns the hash of the given text as hexadecimal string.  It is
+   the same on every host and build. */
+std::string resultcache::hash (const std::string & s) {
+  return hex (fnv (s.data (), s.size ()));
+}
+
+/* Records the contents of the given file, if it exists.  Files are
+   known by their name as given, the hash is taken once per run. */
+void resultcache::addFile (const std::string & name) {
+  struct stat st;
+  if (files.count (name) || stat (name.c_str (), &st) || !S_ISREG (st.st_mode))
+    return;
+  FILE * f = fopen (name.c_str (), "rb");
+  if (f == NULL) return;
+  unsigned long long h = fnv (NULL, 0);
+  char b[65536];
+  size_t n;
+  while ((n = fread (b, 1, sizeof (b), f)) > 0) h = fnv (b, n, h);
+  fclose (f);
+  files[name] = hex (h);
+}
+
+/* Appends the canonical text of the given netlist definition.  The
+   properties are sorted by name, values referring to files add the
+   file contents. */
+void resultcache::line (struct definition_t * def, std::string & s) {
+  s += def->type;
+  s += ":";
+  s += def->instance ? def->instance : "";
+  for (struct node_t * n = def->nodes; n != NULL; n = n->next) {
+    s += " ";
+    s += n->node;
+  }
+  std::vector<std::string> pairs;
+  for (struct pair_t * p = def->pairs; p != NULL; p = p->next) {
+    std::string v = std::string (" ") + p->key + "=";
+    for (struct value_t * val = p->value; val != NULL; val = val->next) {
+      if (val->ident) {
+	v += val->ident;
+	addFile (val->ident);
+      }
+      else {
+	char b[32];
+	snprintf (b, sizeof (b), "%.17g", val->value);
+	v += b;
+      }
+      if (val->scale) v += val->scale;
+      if (val->unit) v += val->unit;
+      if (val->next) v += ",";
+    }
+    pairs.push_back (v);
+  }
+  std::sort (pairs.begin (), pairs.end ());
+  for (std::string & p : pairs) s += p;
+  for (eqn::node * e = (eqn::node *) def->eqns; e != NULL; e = e->getNext ()) {
+    s += " ";
+    s += e->toString ();
+  }
+  if (def->sub) {
+    std::vector<std::string> lines;
+    for (struct definition_t * d = def->sub; d != NULL; d = d->next) {
+      lines.push_back ("");
+      line (d, lines.back ());
+    }
+    std::sort (lines.begin (), lines.end ());
+    s += " {\n";
+    for (std::string & l : lines) s += l + "\n";
+    s += "}";
+  }
+}
+
+/* Builds the canonical form of the given parsed netlist.  The
+   analyses are kept line by line along with the analyses they run,
+   everything else in sorted order. */
+void resultcache::netlist (struct definition_t * root) {
+  std::vector<std::string> lines;
+  circuits.clear ();
+  actions.clear ();
+  for (struct definition_t * def = root; def != NULL; def = def->next) {
+    std::string s;
+    line (def, s);
+    if (def->action && strcmp (def->type, "Eqn") && strcmp (def->type, "Def")) {
+      action_t & a = actions[def->instance];
+      a.line = s;
+      for (struct pair_t * p = def->pairs; p != NULL; p = p->next)
+	if (!strcmp (p->key, "Sim") && p->value && p->value->ident)
+	  a.children.push_back (p->value->ident);
+    }
+    else lines.push_back (s);
+  }
+  std::sort (lines.begin (), lines.end ());
+  for (std::string & l : lines) circuits += l + "\n";
+}
+
+/* Returns the hash identifying the results of the given analysis. */
+std::string resultcache::key (analysis * a) {
+  std::string s = circuits;
+  for (auto & f : files) s += f.first + "=" + f.second + "\n";
+  std::vector<std::string> todo (1, a->getName ());
+  std::set<std::string> done;
+  while (!todo.empty ()) {
+    std::string n = todo.back ();
+    todo.pop_back ();
+    if (!done.insert (n).second) continue;
+    action_t & act = actions[n];
+    s += act.line + "\n";
+    todo.insert (todo.end (), act.children.begin (), act.children.end ());
+  }
+  return hash (s);
+}
+
+/* Adds the cached results of the given analysis to the dataset.
+   Returns true if there are any, then the analysis need not run. */
+bool resultcache::fetch (analysis * a, dataset * out) {
+  if (!enabled () || actions.find (a->getName ()) == actions.end ())
+    return false;
+  std::string file = directory + "/" + key (a) + ".dat";
+  struct stat st;
+  if (stat (file.c_str (), &st)) return false;
+  dataset * d = dataset::load_binary (file.c_str ());
+  if (d == NULL) return false;
+  for (vector * v = d->getDependencies (); v != NULL; v = v->getNext ())
+    if (out->findDependency (v->getName ()) == NULL)
+      out->addDependency (new vector (*v));
+  for (vector * v = d->getVariables (); v != NULL; v = v->getNext ())
+    if (out->findVariable (v->getName ()) == NULL) {
+      vector * n = new vector (*v);
+      n->setOrigin (a->getName ());
+      out->addVariable (n);
+    }
+  delete d;
+  logprint (LOG_STATUS, "NOTIFY: %s: unchanged, results taken from the "
+	    "cache\n", a->getName ());
+  return true;
+}
+
+/* Stores the results of the given analysis and the analyses it runs
+   from the dataset into the cache. */
+void resultcache::store (analysis * a, dataset * out) {
+  if (!enabled () || actions.find (a->getName ()) == actions.end ())
+    return;
+  if (out->isStreaming ()) {
+    logprint (LOG_STATUS, "NOTIFY: %s: streaming results are not cached\n",
+	      a->getName ());
+    return;
+  }
+
+  // names of the analyses
+  std::set<std::string> names;
+  std::vector<analysis *> todo (1, a);
+  while (!todo.empty ()) {
+    analysis * n = todo.back ();
+    todo.pop_back ();
+    if (!names.insert (n->getName ()).second) continue;
+    if (n->getAnalysis ())
+      for (auto * c : *n->getAnalysis ()) todo.push_back (c);
+  }
+
+  // their results and the dependencies of them
+  dataset d;
+  std::set<std::string> deps;
+  for (vector * v = out->getVariables (); v != NULL; v = v->getNext ()) {
+    if (v->getOrigin () == NULL || !names.count (v->getOrigin ())) continue;
+    d.addVariable (new vector (*v));
+    if (v->getDependencies ())
+      for (int i = 0; i < v->getDependencies()->length (); i++)
+	deps.insert (v->getDependencies()->get (i));
+  }
+  for (const std::string & n : deps) {
+    vector * v = out->findDependency (n.c_str ());
+    if (v != NULL) d.addDependency (new vector (*v));
+  }
+
+  std::string file = directory + "/" + key (a) + ".dat";
+  std::string tmp = file + ".tmp";
+  d.setFile (tmp.c_str ());
+  d.setBinary (1);
+  d.print ();
+  if (rename (tmp.c_str (), file.c_str ()))
+    logprint (LOG_ERROR, "cannot write result cache `%s'\n", file.c_str ());
+}
+
+} // namespace qucs
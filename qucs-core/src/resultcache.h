@@ -0,0 +1,80 @@
+/*
+ * resultcache.h - analysis result cache definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __RESULTCACHE_H__
+#define __RESULTCACHE_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct definition_t;
+
+namespace qucs {
+
+class analysis;
+class dataset;
+
+/*! \class resultcache
+ * \brief results of unchanged analyses kept across runs.
+ *
+ * The parsed netlist is brought into a canonical form, the lines of
+ * the circuits, equations and subcircuit definitions sorted and their
+ * properties sorted by name.  An analysis is known by the hash of this
+ * canonical netlist, the contents of the files it refers to, the
+ * dynamically loaded modules and the lines of the analysis itself and
+ * of the analyses it runs.  Its results are stored as binary dataset
+ * under that hash in the cache directory and taken from there when a
+ * later run finds the same hash.
+ */
+class resultcache
+{
+ public:
+  static void enable (const std::string & dir) { directory = dir; }
+  static bool enabled (void) { return !directory.empty (); }
+
+  static void addFile (const std::string &);
+  static void netlist (struct definition_t *);
+  static bool fetch (analysis *, dataset *);
+  static void store (analysis *, dataset *);
+  static std::string hash (const std::string &);
+  static void line (struct definition_t *, std::string &);
+
+ private:
+  struct action_t {
+    std::string line;
+    std::vector<std::string> children;
+  };
+  static std::string key (analysis *);
+
+ private:
+  static std::string directory;
+  static std::string circuits;
+  static std::map<std::string, std::string> files;
+  static std::map<std::string, action_t> actions;
+};
+
+} // namespace qucs
+
+#endif /* __RESULTCACHE_H__ */
@@ -31,6 +31,7 @@
 #include <string.h>
 #include <assert.h>
 #include <vector>
+#include <algorithm>
 
 #include "logging.h"
 #include "complex.h"
@@ -99,9 +100,11 @@ void spline::vectors (qucs::vector y, qucs::vector t) {
 
   // create local copy of f(x)
   realloc (i);
+  std::vector<nr_double_t> g (i);
   for (i = 0; i <= n; i++) {
-    f0[i] = real (y_(i)); x[i] = real (t_(i));
+    f0[i] = real (y_(i)); g[i] = real (t_(i));
   }
+  setGrid (&g[0]);
 }
 
 // Pass interpolation datapoints as tvectors.
@@ -111,9 +114,8 @@ void spline::vectors (std::vector<nr_double_t> y, std::vector<nr_double_t> t) {
 
   // create local copy of f(x)
   realloc (i);
-  for (i = 0; i <= n; i++) {
-    f0[i] = y[i]; x[i] = t[i];
-  }
+  for (i = 0; i <= n; i++) f0[i] = y[i];
+  setGrid (&t[0]);
 }
 
 // Pass interpolation datapoints as tvectors.
@@ -123,9 +125,11 @@ void spline::vectors (tvector<nr_double_t> y, tvector<nr_double_t> t) {
 
   // create local copy of f(x)
   realloc (i);
+  std::vector<nr_double_t> g (i);
   for (i = 0; i <= n; i++) {
-    f0[i] = y_(i); x[i] = t_(i);
+    f0[i] = y_(i); g[i] = t_(i);
   }
+  setGrid (&g[0]);
 }
 
 // Pass interpolation datapoints as pointers.
@@ -135,9 +139,39 @@ void spline::vectors (nr_double_t * y, nr_double_t * t, int len) {
 
   // create local copy of f(x)
   realloc (i);
-  for (i = 0; i <= n; i++) {
-    f0[i] = y[i]; x[i] = t[i];
+  for (i = 0; i <= n; i++) f0[i] = y[i];
+  setGrid (t);
+}
+
+// Pass new function values on the unchanged grid.
+void spline::values (nr_double_t * y) {
+  assert (grid != NULL);
+  for (int i = 0; i <= n; i++) f0[i] = y[i];
+}
+
+/* Takes the grid of the given spline, the function values are passed
+   by values() afterwards. */
+void spline::shareGrid (const spline & s) {
+  assert (s.grid != NULL);
+  realloc (s.n + 1);
+  grid = s.grid;
+  x = &grid->x[0];
+}
+
+/* Sets the abscissae.  The factorisation of the equation system is
+   kept as long as the grid does not change, a grid shared with other
+   splines is replaced instead of being overwritten. */
+void spline::setGrid (const nr_double_t * t) {
+  if (grid != NULL && (int) grid->x.size () == n + 1 &&
+      std::equal (t, t + n + 1, grid->x.begin ())) {
+    x = &grid->x[0];
+    return;
   }
+  if (grid == NULL || grid.use_count () > 1)
+    grid = std::make_shared<spline_grid> ();
+  grid->x.assign (t, t + n + 1);
+  grid->factored = SPLINE_BC_UNKNOWN;
+  x = &grid->x[0];
 }
 
 // Reallocate vector data if necessary.
@@ -145,77 +179,89 @@ void spline::realloc (int size) {
   if (n != size - 1) {
     n = size - 1;
     delete[] f0;
+    delete[] f1;
+    delete[] f2;
+    delete[] f3;
     f0 = new nr_double_t[n+1];
-    delete[] x;
-    x  = new nr_double_t[n+1];
+    f1 = new nr_double_t[n+1];
+    f2 = new nr_double_t[n+1];
+    f3 = new nr_double_t[n+1];
+    grid.reset ();
+    x = NULL;
   }
-  delete[] f1;
-  delete[] f2;
-  delete[] f3;
 }
 
-// Construct cubic spline interpolation coefficients.
-void spline::construct (void) {
-
-  // calculate first derivative h = f'(x)
+/* Computes the interval widths and eliminates the tridiagonal
+   equation system of the first kind of cubic splines.  Both depend on
+   the grid only. */
+void spline::factor (void) {
+  spline_grid & g = *grid;
   int i;
-  nr_double_t * h  = new nr_double_t[n+1];
+  g.h.resize (n+1);
   for (i = 0; i < n; i++) {
-    h[i] = x[i+1] - x[i];
-    if (h[i] == 0.0) {
+    g.h[i] = x[i+1] - x[i];
+    if (g.h[i] == 0.0) {
       logprint (LOG_ERROR, "ERROR: Duplicate points in spline: %g, %g\n",
 		x[i], x[i+1]);
     }
   }
+  g.h[n] = 0;
 
-  // first kind of cubic splines
   if (boundary == SPLINE_BC_NATURAL || boundary == SPLINE_BC_CLAMPED) {
-
-    // setup right hand side
-    nr_double_t * b = new nr_double_t[n+1]; // b as in Ax = b
-    for (i = 1; i < n; i++) {
-      nr_double_t _n = f0[i+1] * h[i-1] - f0[i] * (h[i] + h[i-1]) +
-	f0[i-1] * h[i];
-      nr_double_t _d = h[i-1] * h[i];
-      b[i] = 3 * _n / _d;
-    }
+    nr_double_t * h = &g.h[0];
+    g.u.resize (n+1);
+    g.p.resize (n+1);
+    nr_double_t * u = &g.u[0];
+    nr_double_t * p = &g.p[0];
     if (boundary == SPLINE_BC_NATURAL) {
-      // natural boundary condition
-      b[0] = 0;
-      b[n] = 0;
-    } else if (boundary == SPLINE_BC_CLAMPED) {
-      // start and end derivatives given
-      b[0] = 3 * ((f0[1] - f0[0]) / h[0] - d0);
-      b[n] = 3 * (dn - (f0[n] - f0[n-1]) / h[n-1]);
+      u[0] = 0;
+      p[0] = 0;
+    } else {
+      u[0] = h[0] / (2 * h[0]);
+      p[0] = 2 * h[0];
+    }
+    for (i = 1; i < n; i++) {
+      p[i] = 2 * (h[i] + h[i-1]) - h[i-1] * u[i-1];
+      u[i] = h[i] / p[i];
     }
+    p[n] = h[n-1] * (2 - u[n-1]);
+    u[n] = 0;
+  }
+  g.factored = boundary;
+}
 
-    nr_double_t * u = new nr_double_t[n+1];
-    nr_double_t * z = b; // reuse storage
+// Construct cubic spline interpolation coefficients.
+void spline::construct (void) {
+  int i;
+  if (grid->factored != boundary) factor ();
+  const nr_double_t * h = &grid->h[0];
+
+  // first kind of cubic splines
+  if (boundary == SPLINE_BC_NATURAL || boundary == SPLINE_BC_CLAMPED) {
+    const nr_double_t * u = &grid->u[0];
+    const nr_double_t * p = &grid->p[0];
+
+    // forward substitution of the right hand side
+    nr_double_t * z = f2; // reuse storage
     if (boundary == SPLINE_BC_NATURAL) {
-      u[0] = 0;
       z[0] = 0;
-    } else if (boundary == SPLINE_BC_CLAMPED) {
-      u[0] = h[0] / (2 * h[0]);
-      z[0] = b[0] / (2 * h[0]);
+    } else {
+      z[0] = 3 * ((f0[1] - f0[0]) / h[0] - d0) / p[0];
     }
-
     for (i = 1; i < n; i++) {
-      nr_double_t p = 2 * (h[i] + h[i-1]) - h[i-1] * u[i-1]; // pivot
-      u[i] = h[i] / p;
-      z[i] = (b[i] - z[i-1] * h[i-1]) / p;
+      nr_double_t _n = f0[i+1] * h[i-1] - f0[i] * (h[i] + h[i-1]) +
+	f0[i-1] * h[i];
+      nr_double_t _d = h[i-1] * h[i];
+      z[i] = (3 * _n / _d - z[i-1] * h[i-1]) / p[i];
     }
     if (boundary == SPLINE_BC_NATURAL) {
       z[n] = 0;
-    } else if (boundary == SPLINE_BC_CLAMPED) {
-      nr_double_t p = h[n-1] * (2 - u[n-1]);
-      z[n] = (b[n] - z[n-1] * h[n-1]) / p;
+    } else {
+      nr_double_t b = 3 * (dn - (f0[n] - f0[n-1]) / h[n-1]);
+      z[n] = (b - z[n-1] * h[n-1]) / p[n];
     }
 
     // back substitution
-    f1 = u; // reuse storage
-    f2 = z;
-    f3 = h;
-    f2[n] = z[n];
     f3[n] = 0;
     for (i = n - 1; i >= 0; i--) {
       f2[i] = z[i] - u[i] * f2[i+1];
@@ -236,8 +282,7 @@ void spline::construct (void) {
   // second kind of cubic splines
   else if (boundary == SPLINE_BC_PERIODIC) {
     // non-trigdiagonal equations - periodic boundary condition
-    //std::vector<nr_double_t> z (n+1);
-    nr_double_t *z = new nr_double_t[n+1];
+    nr_double_t * z = f2; // reuse storage
     if (n == 2) {
       nr_double_t B = h[0] + h[1];
       nr_double_t A = 2 * B;
@@ -253,30 +298,24 @@ void spline::construct (void) {
       tridiag<nr_double_t> sys;
       std::vector<nr_double_t> o (n);
       std::vector<nr_double_t> d (n);
-      std::vector<nr_double_t> b(&z[1],&z[n]);
-      //b.setData (&z[1], n);
+      std::vector<nr_double_t> b (n);
       for (i = 0; i < n - 1; i++) {
         o[i] = h[i+1];
         d[i] = 2 * (h[i+1] + h[i]);
         b[i] = 3 * ((f0[i+2] - f0[i+1]) / h[i+1] - (f0[i+1] - f0[i]) / h[i]);
-        z[i+1] = b[i];
       }
       o[i] = h[0];
       d[i] = 2 * (h[0] + h[i]);
       b[i] = 3 * ((f0[1] - f0[i+1]) / h[0] - (f0[i+1] - f0[i]) / h[i]);
-      z[i+1] = b[i];
       sys.setDiagonal (&d);
       sys.setOffDiagonal (&o);
       sys.setRHS (&b);
       sys.setType (TRIDIAG_SYM_CYCLIC);
       sys.solve ();
+      for (i = 0; i < n; i++) z[i+1] = b[i];
       z[0] = z[n];
     }
 
-    f1 = new nr_double_t[n+1];
-    //f2 = &z.front (); // reuse storage
-    f2 = z;
-    f3 = h;
     for (i = n - 1; i >= 0; i--) {
       f1[i] = (f0[i+1] - f0[i]) / h[i] - h[i] * (z[i+1] + 2 * z[i]) / 3;
       f3[i] = (z[i+1] - z[i]) / (3 * h[i]);
@@ -308,42 +347,76 @@ nr_double_t * spline::upper_bound (nr_double_t * first, nr_double_t * last,
   return first;
 }
 
-// Evaluates the spline at the given position.
-poly spline::evaluate (nr_double_t t) {
-
+// Maps the given position into the period of periodic splines.
+nr_double_t spline::period (nr_double_t t) {
 #ifndef PERIOD_DISABLED
   if (boundary == SPLINE_BC_PERIODIC) {
     // extrapolation easy: periodically
-    nr_double_t period = x[n] - x[0];
-    while (t > x[n]) t -= period;
-    while (t < x[0]) t += period;
+    nr_double_t T = x[n] - x[0];
+    while (t > x[n]) t -= T;
+    while (t < x[0]) t += T;
   }
 #endif /* PERIOD_DISABLED */
+  return t;
+}
 
-  nr_double_t * here = upper_bound (x, x+n+1, t);
-  nr_double_t y0, y1, y2;
-  if (here == x) {
+/* Returns the index of the interval containing the given position, -1
+   below the first and n above the last point. */
+int spline::locate (nr_double_t t) {
+  return upper_bound (x, x+n+1, t) - x - 1;
+}
+
+// Computes value and first derivative in the given interval.
+void spline::value (int i, nr_double_t t, nr_double_t & y, nr_double_t & dy) {
+  if (i < 0) {
     nr_double_t dx = t - x[0];
-    y0 = f0[0] + dx * f1[0];
-    y1 = f1[0];
-    return poly (t, y0, y1);
+    y = f0[0] + dx * f1[0];
+    dy = f1[0];
   }
   else {
-    int i = here - x - 1;
     nr_double_t dx = t - x[i];
-    // value
-    y0 = f0[i] + dx * (f1[i] + dx * (f2[i] + dx * f3[i]));
-    // first derivative
-    y1 = f1[i] + dx * (2 * f2[i] + 3 * dx * f3[i]);
-    // second derivative
-    y2 = 2 * f2[i] + 6 * dx * f3[i];
-    return poly (t, y0, y1, y2);
+    y = f0[i] + dx * (f1[i] + dx * (f2[i] + dx * f3[i]));
+    dy = f1[i] + dx * (2 * f2[i] + 3 * dx * f3[i]);
+  }
+}
+
+// Evaluates the spline at the given position.
+poly spline::evaluate (nr_double_t t) {
+  t = period (t);
+  int i = locate (t);
+  nr_double_t y0, y1, y2;
+  value (i, t, y0, y1);
+  if (i < 0) return poly (t, y0, y1);
+  // second derivative
+  y2 = 2 * f2[i] + 6 * (t - x[i]) * f3[i];
+  return poly (t, y0, y1, y2);
+}
+
+/* Evaluates value and first derivative of the spline at the given
+   position without creating a polynomial. */
+void spline::evaluate (nr_double_t t, nr_double_t & y, nr_double_t & dy) {
+  t = period (t);
+  value (locate (t), t, y, dy);
+}
+
+/* Evaluates the spline at the given positions, the derivatives are
+   stored as well unless the pointer is NULL.  Ascending positions are
+   located by a single pass through the grid, others by a search. */
+void spline::evaluate (const nr_double_t * t, int len, nr_double_t * y,
+		       nr_double_t * dy) {
+  nr_double_t d;
+  for (int k = 0, i = -1; k < len; k++) {
+    nr_double_t v = period (t[k]);
+    if (k == 0 || (i >= 0 && v < x[i]))
+      i = locate (v);
+    else
+      while (i < n && x[i+1] <= v) i++;
+    value (i, v, y[k], dy ? dy[k] : d);
   }
 }
 
 // Destructor deletes an instance of the spline class.
 spline::~spline () {
-  if (x)  delete[] x;
   delete[] f0;
   delete[] f1;
   delete[] f2;
@@ -26,6 +26,7 @@
 #define __SPLINE_H__
 
 #include <vector>
+#include <memory>
 #include "tvector.h"
 
 namespace qucs {
@@ -41,6 +42,18 @@ enum spline_boundary_type {
 class vector;
 class poly;
 
+/* The abscissae of a spline and the factorisation of its equation
+   system, these depend on the grid only.  Splines of several vectors
+   on the same grid share them. */
+struct spline_grid
+{
+  std::vector<nr_double_t> x; // abscissae
+  std::vector<nr_double_t> h; // interval widths
+  std::vector<nr_double_t> u; // elimination factors
+  std::vector<nr_double_t> p; // pivots
+  int factored;               // boundary of the factorisation
+};
+
 class spline
 {
  public:
@@ -55,16 +68,30 @@ class spline
   void vectors (tvector<nr_double_t>, tvector<nr_double_t>);
   void vectors (std::vector<nr_double_t>, std::vector<nr_double_t>);
   void vectors (nr_double_t *, nr_double_t *, int);
+  void values (nr_double_t *);
+  void shareGrid (const spline &);
   void construct (void);
   poly evaluate (nr_double_t);
+  void evaluate (nr_double_t, nr_double_t &, nr_double_t &);
+  void evaluate (const nr_double_t *, int, nr_double_t *,
+		 nr_double_t * dy = NULL);
   void setBoundary (int b) { boundary = b; }
   void setDerivatives (nr_double_t l, nr_double_t r) { d0 = l; dn = r; }
+  void coefficients (int i, nr_double_t * c) {
+    c[0] = f0[i]; c[1] = f1[i]; c[2] = f2[i]; c[3] = f3[i];
+  }
 
  private:
   nr_double_t * upper_bound (nr_double_t *, nr_double_t *, nr_double_t);
   void realloc (int);
+  void setGrid (const nr_double_t *);
+  void factor (void);
+  nr_double_t period (nr_double_t);
+  int  locate (nr_double_t);
+  void value (int, nr_double_t, nr_double_t &, nr_double_t &);
 
  private:
+  std::shared_ptr<spline_grid> grid;
   nr_double_t * x;
   nr_double_t * f0;
   nr_double_t * f1;
@@ -0,0 +1,203 @@
+/*
+ * spmna.cpp - S-parameter MNA solver class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <cmath>
+#include <algorithm>
+
+#include "object.h"
+#include "complex.h"
+#include "circuit.h"
+#include "net.h"
+#include "netdefs.h"
+#include "analysis.h"
+#include "exception.h"
+#include "exceptionstack.h"
+#include "numstatus.h"
+#include "nasolver.h"
+#include "spmna.h"
+#include "threadpool.h"
+
+namespace qucs {
+
+/* The structure holds the MNA matrix of a single frequency point and
+   its S-parameters, either the sparse or the dense matrix is used. */
+struct spmnapoint_t {
+  spmnapoint_t () : As (NULL) { }
+  ~spmnapoint_t () { delete As; }
+  nr_double_t freq;
+  tspmatrix<nr_complex_t> * As;
+  tmatrix<nr_complex_t> A;
+  tmatrix<nr_complex_t> S;
+  exceptionstack errors;
+};
+
+// Constructor creates an S-parameter MNA solver for the named analysis.
+spmna::spmna (const std::string & n) : nasolver<nr_complex_t> (n) {
+  setDescription ("SP");
+  used = solved = 0;
+}
+
+// Destructor deletes the spmna class object.
+spmna::~spmna () {
+  for (spmnapoint_t * p : points) delete p;
+}
+
+/* Collects the S-parameter ports, initializes the AC models of the
+   circuits and creates the (sparse) MNA matrix. */
+void spmna::init (void) {
+  circuit * root = subnet->getRoot ();
+  ports.clear ();
+  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    if (c->getPort ()) ports.push_back (c);
+    c->setRealMNA (false);
+    c->initAC ();
+  }
+  eqnAlgo = ALGO_LU_DECOMPOSITION_SPARSE;
+  solve_pre ();
+
+  // rows of the port nodes in the solution vector, -1 for ground
+  rows.clear ();
+  impedances.clear ();
+  for (auto c : ports) {
+    rows.push_back (getNodeNr (c->getNode(NODE_1)->getName ()) - 1);
+    rows.push_back (getNodeNr (c->getNode(NODE_2)->getName ()) - 1);
+    impedances.push_back (c->getPropertyDouble ("Z"));
+  }
+  used = solved = 0;
+}
+
+// Releases the node list after the last frequency point.
+void spmna::finish (void) {
+  solve_post ();
+}
+
+/* Assembles the MNA matrix at the given frequency and appends it to
+   the current batch of frequency points. */
+void spmna::assemble (nr_double_t freq) {
+  circuit * root = subnet->getRoot ();
+  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    c->calcAC (freq);
+  }
+  convHelper = CONV_None;
+  updateMatrix = 1;
+  createMatrix ();
+
+  if (used == (int) points.size ()) points.push_back (new spmnapoint_t ());
+  spmnapoint_t * p = points[used++];
+  p->freq = freq;
+  if (As != NULL) {
+    // the sparsity pattern is the same for all the frequencies
+    if (p->As == NULL || p->As->getNnz () != As->getNnz ()) {
+      delete p->As;
+      p->As = new tspmatrix<nr_complex_t> (*As);
+    }
+    else std::copy (As->getData (), As->getData () + As->getNnz (),
+		    p->As->getData ());
+  }
+  else p->A = *A;
+}
+
+/* The function solves every n-th point of the given batch beginning
+   with the given one.  Each worker thread uses its own equation system
+   solver, the unit current excitations of all the ports form the right
+   hand sides of a single block substitution. */
+static void solve_points (std::vector<spmnapoint_t *> * points, int n,
+			  int first, int step, const std::vector<int> * rows,
+			  const std::vector<nr_double_t> * z) {
+  eqnsys<nr_complex_t> eqns;
+  int P = z->size ();
+  for (int k = first; k < n; k += step) {
+    spmnapoint_t * p = (*points)[k];
+    int N = p->As ? p->As->getRows () : p->A.getRows ();
+    tvector<nr_complex_t> x (N), b (N);
+    tmatrix<nr_complex_t> B (N, P), X (N, P);
+    p->S = tmatrix<nr_complex_t> (P);
+
+    eqns.setAlgo (ALGO_LU_DECOMPOSITION_SPARSE);
+    if (p->As)
+      eqns.passEquationSys (p->As, &x, &b);
+    else
+      eqns.passEquationSys (&p->A, &x, &b);
+    int mark = numstatus::mark ();
+    eqns.factorize ();
+    if (numstatus::raised (mark)) {
+      numstatus::report (mark);
+      p->errors.take (estack);
+      continue;
+    }
+
+    for (int j = 0; j < P; j++) {
+      int r1 = (*rows)[2 * j], r2 = (*rows)[2 * j + 1];
+      if (r1 >= 0) B (r1, j) += 1.0;
+      if (r2 >= 0) B (r2, j) -= 1.0;
+    }
+    eqns.solveMany (&B, &X);
+
+    // waves at the ports terminated by their impedances
+    for (int j = 0; j < P; j++) {
+      for (int i = 0; i < P; i++) {
+	int r1 = (*rows)[2 * i], r2 = (*rows)[2 * i + 1];
+	nr_complex_t v = 0.0;
+	if (r1 >= 0) v += X (r1, j);
+	if (r2 >= 0) v -= X (r2, j);
+	p->S (i, j) = 2.0 * v / std::sqrt ((*z)[i] * (*z)[j]);
+	if (i == j) p->S (i, j) -= 1.0;
+      }
+    }
+  }
+}
+
+/* Computes the S-parameter matrices of the assembled frequency points
+   using the given number of worker threads.  Returns the number of
+   points failed to solve, their S-parameters are zero then.  The
+   results are valid until the next point is assembled. */
+int spmna::solve (int threads) {
+  int n = used, errors = 0;
+  threads = std::max (1, std::min (threads, n));
+  if (threads == 1)
+    solve_points (&points, n, 0, 1, &rows, &impedances);
+  else {
+    threadpool::run (threads, [this, n, threads] (int k) {
+	solve_points (&points, n, k, threads, &rows, &impedances);
+      });
+  }
+  for (int k = 0; k < n; k++) {
+    estack.take (points[k]->errors);
+    if (checkErrors ()) errors++;
+  }
+  solved = n;
+  used = 0;
+  return errors;
+}
+
+// Returns the S-parameter of the given ports at the given point.
+nr_complex_t spmna::getS (int k, int i, int j) {
+  return points[k]->S (i, j);
+}
+
+} // namespace qucs
@@ -0,0 +1,80 @@
+/*
+ * spmna.h - S-parameter MNA solver class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __SPMNA_H__
+#define __SPMNA_H__
+
+#include <vector>
+
+#include "nasolver.h"
+
+// Number of frequency points per worker thread solved in one batch.
+#define SP_BATCH_SIZE 4
+
+namespace qucs {
+
+class circuit;
+struct spmnapoint_t;
+
+/*! \class spmna
+ * \brief computes the S-parameters of a linear network by nodal analysis.
+ *
+ * Instead of joining the S-parameter matrices of the circuits pairwise
+ * the network terminated by the port impedances is assembled into its
+ * (sparse) MNA matrix.  The matrix is factorized once per frequency,
+ * the excitations of all the ports are then solved as a single block
+ * of right hand sides.  With a unit current fed into port j the
+ * S-parameters are
+ *
+ *   S(i,j) = 2 * V(i) / sqrt (Z(i) * Z(j)) - delta(i,j)
+ *
+ * where V(i) denotes the voltage across port i and Z(i) its impedance.
+ * The matrices of a batch of frequency points are assembled in sweep
+ * order, they are factorized and solved concurrently.
+ */
+class spmna : public nasolver<nr_complex_t>
+{
+ public:
+  spmna (const std::string &);
+  ~spmna ();
+  void init (void);
+  void assemble (nr_double_t);
+  int  solve (int);
+  void finish (void);
+  int getPorts (void) { return ports.size (); }
+  circuit * getPort (int i) { return ports[i]; }
+  int getPoints (void) { return solved; }
+  nr_complex_t getS (int, int, int);
+
+ private:
+  std::vector<circuit *> ports;
+  std::vector<int> rows;
+  std::vector<nr_double_t> impedances;
+  std::vector<spmnapoint_t *> points;
+  int used, solved;
+};
+
+} // namespace qucs
+
+#endif /* __SPMNA_H__ */
@@ -29,6 +29,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include "logging.h"
 #include "complex.h"
@@ -37,6 +40,7 @@
 #include "circuit.h"
 #include "strlist.h"
 #include "vector.h"
+#include "matrix.h"
 #include "matvec.h"
 #include "dataset.h"
 #include "net.h"
@@ -46,6 +50,8 @@
 #include "netdefs.h"
 #include "characteristic.h"
 #include "spsolver.h"
+#include "spmna.h"
+#include "trace.h"
 #include "constants.h"
 #include "components/component_id.h"
 #include "components/tee.h"
@@ -53,14 +59,22 @@
 #include "components/itrafo.h"
 #include "components/cross.h"
 #include "components/ground.h"
+#include "threadpool.h"
 
 /* Evolved optimization flags. */
 #define USE_GROUNDS 1   // use extra grounds ?
 #define USE_CROSSES 1   // use additional cross connectors ?
-#define SORTED_LIST 1   // use sorted node list?
+#define SORTED_LIST 0   // use sorted node list (else the join queue)?
 
 #define TINYS (NR_TINY * 1.235) // 'tiny' value for singularities
 
+// Assumed fill-in per unknown of the sparse MNA factors.
+#define MNA_FILL 16
+
+/* Number of noise correlation entries per frequency point above which
+   the noise propagation runs on a second thread. */
+#define NOISE_PIPELINE 4096
+
 namespace qucs {
 
 // Constructor creates an unnamed instance of the spsolver class.
@@ -72,6 +86,9 @@ spsolver::spsolver () : analysis () {
   nlist = NULL;
   tees = crosses = opens = grounds = 0;
   gnd = NULL;
+  joinorder = 0;
+  dissection = 0;
+  noiseCost = 0;
 }
 
 // Constructor creates a named instance of the spsolver class.
@@ -83,6 +100,9 @@ spsolver::spsolver (char * n) : analysis (n) {
   nlist = NULL;
   tees = crosses = opens = grounds = 0;
   gnd = NULL;
+  joinorder = 0;
+  dissection = 0;
+  noiseCost = 0;
 }
 
 // Destructor deletes the spsolver class object.
@@ -103,18 +123,24 @@ spsolver::spsolver (spsolver & n) : analysis (n) {
   swp = n.swp ? new sweep (*n.swp) : NULL;
   nlist = n.nlist ? new nodelist (*n.nlist) : NULL;
   gnd = n.gnd;
+  joinorder = 0;
+  dissection = n.dissection;
+  noiseCost = 0;
 }
 
 /* This function joins two nodes of a single circuit (interconnected
    nodes) and returns the resulting circuit. */
-circuit * spsolver::interconnectJoin (node * n1, node * n2) {
+circuit * spsolver::interconnectJoin (node * n1, node * n2,
+				     circuit * result) {
 
   circuit * s = n1->getCircuit ();
-  circuit * result = new circuit (s->getSize () - 2);
   nr_complex_t p;
 
   // allocate S-parameter and noise corellation matrices
-  result->initSP (); if (noise) result->initNoiseSP ();
+  if (result == NULL) {
+    result = new circuit (s->getSize () - 2);
+    result->initSP (); if (noise) result->initNoiseSP ();
+  }
 
   // interconnected port numbers
   int k = n1->getPort (), l = n2->getPort ();
@@ -169,15 +195,18 @@ circuit * spsolver::interconnectJoin (node * n1, node * n2) {
 
 /* This function joins two nodes of two different circuits (connected
    nodes) and returns the resulting circuit. */
-circuit * spsolver::connectedJoin (node * n1, node * n2) {
+circuit * spsolver::connectedJoin (node * n1, node * n2,
+				  circuit * result) {
 
   circuit * s = n1->getCircuit ();
   circuit * t = n2->getCircuit ();
-  circuit * result = new circuit (s->getSize () + t->getSize () - 2);
   nr_complex_t p;
 
   // allocate S-parameter and noise corellation matrices
-  result->initSP (); if (noise) result->initNoiseSP ();
+  if (result == NULL) {
+    result = new circuit (s->getSize () + t->getSize () - 2);
+    result->initSP (); if (noise) result->initNoiseSP ();
+  }
 
   // connected port numbers
   int k = n1->getPort (), l = n2->getPort ();
@@ -271,6 +300,137 @@ circuit * spsolver::connectedJoin (node * n1, node * n2) {
   return result;
 }
 
+/* Returns the number of ports left by joining the given nodes. */
+static int joinedSize (const std::vector<node *> & nodes) {
+  int size = -nodes.size ();
+  for (std::size_t i = 0; i < nodes.size (); i++) {
+    circuit * c = nodes[i]->getCircuit ();
+    std::size_t k = 0;
+    while (nodes[k]->getCircuit () != c) k++;
+    if (k == i) size += c->getSize ();
+  }
+  return size;
+}
+
+/* Returns the circuits of the given nodes in order of appearance. */
+static std::vector<circuit *> joinedCircuits (const std::vector<node *> & nodes) {
+  std::vector<circuit *> cs;
+  for (auto n : nodes) {
+    circuit * c = n->getCircuit ();
+    if (std::find (cs.begin (), cs.end (), c) == cs.end ()) cs.push_back (c);
+  }
+  return cs;
+}
+
+/* The function computes the matrix M = (I - J S)^-1 J of the m nodes
+   joined by an ideal junction.  S holds the reflections of the joined
+   circuit ports, the waves leaving the junction are J = 2/m - I times
+   the incident ones.  The remaining ports of the joined circuits are
+   returned in the order of their first appearance. */
+void spsolver::junctionMatrices (const std::vector<node *> & nodes,
+				 matrix & M, std::vector<circuit *> & ec,
+				 std::vector<int> & ep) {
+  int m = nodes.size ();
+  std::vector<circuit *> cs = joinedCircuits (nodes);
+  ec.clear (); ep.clear ();
+  for (auto c : cs) {
+    for (int k = 0; k < c->getSize (); k++) {
+      node * n = c->getNode (k);
+      if (std::find (nodes.begin (), nodes.end (), n) != nodes.end ())
+	continue;
+      ec.push_back (c);
+      ep.push_back (k);
+    }
+  }
+
+  // reflections between the joined ports
+  matrix S (m, m);
+  for (int r = 0; r < m; r++) {
+    circuit * c = nodes[r]->getCircuit ();
+    for (int j = 0; j < m; j++) {
+      if (nodes[j]->getCircuit () == c)
+	S (r, j) = c->getS (nodes[r]->getPort (), nodes[j]->getPort ());
+    }
+  }
+
+  // avoid singularity when full reflective ports are joined
+  nr_double_t g = 2.0 / m, tiny = 1.0;
+  matrix A (m, m);
+  for (int pass = 0; pass < 2; pass++) {
+    for (int j = 0; j < m; j++) {
+      nr_complex_t sum = 0;
+      for (int r = 0; r < m; r++) sum += S (r, j);
+      for (int r = 0; r < m; r++)
+	A (r, j) = (r == j ? 1.0 : 0.0) - (g * sum - S (r, j)) * tiny;
+    }
+    if (det (A) != 0.0) break;
+    tiny = 1.0 - TINYS;
+  }
+  matrix B = inverse (A);
+  M = matrix (m, m);
+  for (int r = 0; r < m; r++) {
+    nr_complex_t sum = 0;
+    for (int j = 0; j < m; j++) sum += B (r, j);
+    for (int j = 0; j < m; j++) M (r, j) = (g * sum - B (r, j)) * tiny;
+  }
+}
+
+/* This function joins the nodes of the same name of any number of
+   circuits by an ideal junction and returns the resulting circuit.
+   Compared to inserted tees and crosses the intermediate circuits and
+   their extra ports are omitted. */
+circuit * spsolver::junctionJoin (const std::vector<node *> & nodes,
+				  circuit * result) {
+  std::vector<circuit *> ec;
+  std::vector<int> ep;
+  matrix M;
+  junctionMatrices (nodes, M, ec, ep);
+  int m = nodes.size (), e = ec.size ();
+
+  // allocate S-parameter and noise corellation matrices
+  if (result == NULL) {
+    result = new circuit (e);
+    result->initSP (); if (noise) result->initNoiseSP ();
+  }
+
+  // waves M S_JE into the joined ports for each remaining port
+  matrix W (m, e);
+  for (int j = 0; j < e; j++) {
+    for (int r = 0; r < m; r++) {
+      nr_complex_t p = 0;
+      for (int k = 0; k < m; k++) {
+	circuit * c = nodes[k]->getCircuit ();
+	if (c == ec[j]) p += M (r, k) * c->getS (nodes[k]->getPort (), ep[j]);
+      }
+      W (r, j) = p;
+    }
+  }
+
+  // compute S' = S_EE + S_EJ M S_JE
+  for (int j = 0; j < e; j++) {
+    result->setNode (j, ec[j]->getNode(ep[j])->getName ());
+    for (int i = 0; i < e; i++) {
+      nr_complex_t p = (ec[i] == ec[j]) ? ec[i]->getS (ep[i], ep[j]) : 0.0;
+      for (int k = 0; k < m; k++) {
+	if (nodes[k]->getCircuit () == ec[i])
+	  p += ec[i]->getS (ep[i], nodes[k]->getPort ()) * W (k, j);
+      }
+      result->setS (i, j, p);
+    }
+  }
+  return result;
+}
+
+/* Joins the given nodes by the specialized function for two nodes or
+   by an ideal junction else. */
+circuit * spsolver::join (const std::vector<node *> & nodes,
+			  circuit * result) {
+  if (nodes.size () > 2) return junctionJoin (nodes, result);
+  if (nodes[0]->getCircuit () != nodes[1]->getCircuit ())
+    return connectedJoin (nodes[0], nodes[1], result);
+  return interconnectJoin (nodes[0], nodes[1], result);
+}
+
 /* This function joins the two given nodes of a single circuit
    (interconnected nodes) and modifies the resulting circuit
    appropriately. */
@@ -444,6 +604,421 @@ void spsolver::noiseConnect (circuit * result, node * n1, node * n2) {
   }
 }
 
+/* The function joins the given nodes by an ideal junction and saves
+   the noise wave correlation matrix in the resulting circuit.  With
+   G = S_EJ M the correlation matrix is C' = C_EE + G C_JE + H G^H
+   where H = C_EJ + G C_JJ. */
+void spsolver::noiseJunction (circuit * result,
+			      const std::vector<node *> & nodes) {
+  std::vector<circuit *> ec;
+  std::vector<int> ep;
+  matrix M;
+  junctionMatrices (nodes, M, ec, ep);
+  int m = nodes.size (), e = ec.size ();
+
+  // gains G = S_EJ M from the joined ports to the remaining ones
+  matrix G (e, m);
+  for (int i = 0; i < e; i++) {
+    for (int r = 0; r < m; r++) {
+      nr_complex_t p = 0;
+      for (int k = 0; k < m; k++) {
+	if (nodes[k]->getCircuit () == ec[i])
+	  p += ec[i]->getS (ep[i], nodes[k]->getPort ()) * M (k, r);
+      }
+      G (i, r) = p;
+    }
+  }
+
+  // H = C_EJ + G C_JJ
+  matrix H (e, m);
+  for (int i = 0; i < e; i++) {
+    for (int r = 0; r < m; r++) {
+      circuit * c = nodes[r]->getCircuit ();
+      int l = nodes[r]->getPort ();
+      nr_complex_t p = (c == ec[i]) ? c->getN (ep[i], l) : 0.0;
+      for (int k = 0; k < m; k++) {
+	if (nodes[k]->getCircuit () == c)
+	  p += G (i, k) * c->getN (nodes[k]->getPort (), l);
+      }
+      H (i, r) = p;
+    }
+  }
+
+  // C' = C_EE + G C_JE + H G^H, hermitian
+  for (int j = 0; j < e; j++) {
+    for (int i = 0; i <= j; i++) {
+      nr_complex_t p = (ec[i] == ec[j]) ? ec[i]->getN (ep[i], ep[j]) : 0.0;
+      for (int k = 0; k < m; k++) {
+	circuit * c = nodes[k]->getCircuit ();
+	if (c == ec[j]) p += G (i, k) * c->getN (nodes[k]->getPort (), ep[j]);
+	p += H (i, k) * conj (G (j, k));
+      }
+      result->setN (i, j, p);
+      if (i != j) result->setN (j, i, conj (p));
+    }
+  }
+}
+
+/* Joins the noise correlation matrices of the given nodes, the
+   counterpart of join(). */
+void spsolver::noiseJoin (circuit * result,
+			  const std::vector<node *> & nodes) {
+  if (nodes.size () > 2)
+    noiseJunction (result, nodes);
+  else if (nodes[0]->getCircuit () != nodes[1]->getCircuit ())
+    noiseConnect (result, nodes[0], nodes[1]);
+  else
+    noiseInterconnect (result, nodes[0], nodes[1]);
+}
+
+/* The function registers the given circuit node with the join of all
+   the nodes having the same name. */
+void spsolver::addJoin (node * n) {
+  spjoin & j = joins[n->getName ()];
+  if (j.n.empty () && dissection) {
+    auto r = ranks.find (n->getName ());
+    if (r != ranks.end ()) j.rank = r->second;
+  }
+  j.n.push_back (n);
+  j.c.push_back (n->getCircuit ());
+  queueJoin (n->getName (), j);
+}
+
+/* Puts the given join into the queue of candidates if all of its
+   nodes are known.  The candidate is rated by the number of ports of
+   the circuit resulting from the join. */
+void spsolver::queueJoin (const std::string & name, spjoin & j) {
+  if ((int) j.n.size () < std::max (j.count, 2)) return;
+  spcandidate cand;
+  cand.ports = joinedSize (j.n);
+  cand.rank = j.rank;
+  cand.order = joinorder++;
+  cand.version = ++j.version;
+  cand.name = name;
+  candidates.push (cand);
+}
+
+/* This function creates the queue of join candidates from the current
+   list of circuits.  Signal ports are not part of any join. */
+void spsolver::initJoins (void) {
+  joins.clear ();
+  candidates = std::priority_queue<spcandidate> ();
+  joinorder = 0;
+  circuit * root = subnet->getRoot ();
+
+  // number of nodes of each join, queued once complete
+  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    if (c->getPort ()) continue;
+    for (int i = 0; i < c->getSize (); i++)
+      joins[c->getNode(i)->getName ()].count++;
+  }
+  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    if (c->getPort ()) continue;
+    for (int i = 0; i < c->getSize (); i++) addJoin (c->getNode (i));
+  }
+}
+
+/* The function takes the best valid candidate from the join queue and
+   returns its nodes.  Candidates outdated by previous joins are
+   skipped.  Returns zero if there is no candidate left. */
+int spsolver::nextJoin (std::vector<node *> & nodes) {
+  while (!candidates.empty ()) {
+    spcandidate cand = candidates.top ();
+    candidates.pop ();
+    auto it = joins.find (cand.name);
+    if (it == joins.end () || it->second.version != cand.version) continue;
+    nodes = it->second.n;
+    joins.erase (it);
+    return 1;
+  }
+  return 0;
+}
+
+/* After joining the candidate circuits into 'result' the joins of the
+   remaining nodes are moved to the resulting circuit and queued again
+   with their new port counts.  The candidates are compared by pointer
+   only since they may have been deleted already. */
+void spsolver::updateJoins (circuit * result,
+			    const std::vector<circuit *> & joined) {
+  for (int i = 0; i < result->getSize (); i++) {
+    node * n = result->getNode (i);
+    auto it = joins.find (n->getName ());
+    if (it == joins.end ()) continue;
+    spjoin & j = it->second;
+    for (std::size_t k = 0; k < j.c.size (); ) {
+      if (std::find (joined.begin (), joined.end (), j.c[k]) != joined.end ()) {
+	j.n.erase (j.n.begin () + k);
+	j.c.erase (j.c.begin () + k);
+      }
+      else k++;
+    }
+    j.n.push_back (n);
+    j.c.push_back (result);
+    queueJoin (n->getName (), j);
+  }
+}
+
+// Graph of the circuits used for the nested dissection.
+struct spgraph {
+  std::vector<std::vector<int> > edges; // edges of each vertex
+  std::vector<int> a, b;                // vertices of each edge
+  std::vector<int> rank;                // rank of each edge
+  std::vector<int> mark, side, seen;
+  int labels;
+};
+
+/* Returns the vertices of the part with the given label in
+   breadth-first order starting at the given vertex, followed by the
+   vertices of the part not reachable from it. */
+static std::vector<int> spgraph_bfs (spgraph & g, std::vector<int> & part,
+				     int start, int label) {
+  std::vector<int> order;
+  order.reserve (part.size ());
+  int stamp = ++g.labels;
+  order.push_back (start);
+  g.seen[start] = stamp;
+  for (std::size_t i = 0; i < order.size (); i++) {
+    int v = order[i];
+    for (int e : g.edges[v]) {
+      int w = (g.a[e] == v) ? g.b[e] : g.a[e];
+      if (g.mark[w] == label && g.seen[w] != stamp) {
+	g.seen[w] = stamp;
+	order.push_back (w);
+      }
+    }
+  }
+  for (int v : part) {
+    if (g.seen[v] != stamp) order.push_back (v);
+  }
+  return order;
+}
+
+/* Bisects the given part of the circuit graph recursively along its
+   breadth-first level structure.  Each edge gets the depth of the
+   smallest part containing both of its vertices as rank, such that
+   the parts are reduced before the edges separating them. */
+static void spgraph_dissect (spgraph & g, std::vector<int> & part,
+			     int depth) {
+  int label = ++g.labels;
+  for (int v : part) g.mark[v] = label;
+
+  // the remaining connections within small parts are joined first
+  if (part.size () <= 8) {
+    for (int v : part) {
+      for (int e : g.edges[v]) {
+	int w = (g.a[e] == v) ? g.b[e] : g.a[e];
+	if (g.mark[w] == label && g.rank[e] < 0) g.rank[e] = depth;
+      }
+    }
+    return;
+  }
+
+  // start at a pseudo-peripheral vertex
+  std::vector<int> order = spgraph_bfs (g, part, part[0], label);
+  order = spgraph_bfs (g, part, order[order.size () - 1], label);
+
+  // split into halves
+  std::size_t half = order.size () / 2;
+  std::vector<int> p1 (order.begin (), order.begin () + half);
+  std::vector<int> p2 (order.begin () + half, order.end ());
+  for (int v : p1) g.side[v] = 1;
+  for (int v : p2) g.side[v] = 2;
+  std::vector<int> separator;
+  for (int v : p1) {
+    for (int e : g.edges[v]) {
+      int w = (g.a[e] == v) ? g.b[e] : g.a[e];
+      if (g.mark[w] == label && g.side[w] == 2) separator.push_back (e);
+    }
+  }
+
+  spgraph_dissect (g, p1, depth + 1);
+  spgraph_dissect (g, p2, depth + 1);
+  for (int e : separator) g.rank[e] = depth;
+}
+
+/* The function computes a nested dissection ordering of the joins of
+   the current circuit list.  It is stored by node name since the
+   ordering depends on the topology only and thus can be applied at
+   each frequency. */
+void spsolver::dissectJoins (void) {
+  spgraph g;
+  std::unordered_map<circuit *, int> vertex;
+  std::unordered_map<std::string, int> edge;
+  std::vector<std::string> names;
+  circuit * root = subnet->getRoot ();
+
+  // collect vertices (circuits) and edges (connected nodes)
+  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    if (c->getPort ()) continue;
+    int v = vertex.size ();
+    vertex[c] = v;
+    g.edges.push_back (std::vector<int> ());
+    for (int i = 0; i < c->getSize (); i++) {
+      std::string name = c->getNode(i)->getName ();
+      auto it = edge.find (name);
+      if (it == edge.end ()) {
+	edge[name] = g.a.size ();
+	g.a.push_back (v);
+	g.b.push_back (-1);
+	names.push_back (name);
+      }
+      else if (g.b[it->second] < 0) {
+	g.b[it->second] = v;
+	g.edges[g.a[it->second]].push_back (it->second);
+	if (g.a[it->second] != v) g.edges[v].push_back (it->second);
+      }
+      else {
+	// further circuits at a junction connect to its first circuit
+	int a = g.a[it->second];
+	g.edges[a].push_back (g.a.size ());
+	if (a != v) g.edges[v].push_back (g.a.size ());
+	g.a.push_back (a);
+	g.b.push_back (v);
+	names.push_back (name);
+      }
+    }
+  }
+
+  int n = vertex.size ();
+  g.rank.assign (g.a.size (), -1);
+  g.mark.assign (n, 0);
+  g.side.assign (n, 0);
+  g.seen.assign (n, 0);
+  g.labels = 0;
+  std::vector<int> all (n);
+  for (int v = 0; v < n; v++) all[v] = v;
+  if (n > 0) spgraph_dissect (g, all, 0);
+
+  ranks.clear ();
+  int depth = 0;
+  for (std::size_t e = 0; e < g.a.size (); e++) {
+    if (g.rank[e] < 0) continue;
+    // a junction is reduced with its outermost separator
+    auto r = ranks.find (names[e]);
+    if (r == ranks.end () || g.rank[e] < r->second) ranks[names[e]] = g.rank[e];
+    if (g.rank[e] > depth) depth = g.rank[e];
+  }
+  logprint (LOG_STATUS, "NOTIFY: %s: nested dissection of %d circuits "
+	    "with %d levels\n", getName (), n, depth + 1);
+}
+
+/* The join sequence depends on the topology only.  It is recorded as
+   reduction plan at the first frequency point, the intermediate
+   circuits are kept by the plan and reused for the following points.
+   The function moves the joined circuits out of the netlist and
+   inserts the result. */
+void spsolver::moveJoin (const spstep & s) {
+  std::vector<circuit *> joined = joinedCircuits (s.n);
+  for (std::size_t i = 0; i < joined.size (); i++)
+    subnet->removeCircuit (joined[i], s.drop[i]);
+  subnet->insertCircuit (s.result);
+}
+
+/* Appends the given join to the reduction plan and applies it to the
+   netlist.  Plan circuits are marked original in order to survive
+   their removal from the netlist. */
+void spsolver::recordJoin (const std::vector<node *> & nodes,
+			   circuit * result) {
+  std::vector<circuit *> joined = joinedCircuits (nodes);
+  spstep s;
+  s.n = nodes;
+  s.result = result;
+  for (auto c : joined) s.drop.push_back (!planned.count (c));
+
+  // a spare result must not be overwritten before its last use as input
+  auto it = lastInput.find (result);
+  s.wait = it != lastInput.end () ? it->second : -1;
+  for (auto c : joined) lastInput[c] = plan.size ();
+  noiseCost += (nr_double_t) result->getSize () * result->getSize ();
+
+  result->setOriginal (1);
+  planned.insert (result);
+  plan.push_back (s);
+  moveJoin (s);
+
+  // joined plan circuits can hold the results of later joins
+  for (std::size_t i = 0; i < joined.size (); i++) {
+    circuit * c = joined[i];
+    if (!s.drop[i]) spares.insert (std::make_pair (c->getSize (), c));
+  }
+}
+
+/* Returns an unused plan circuit with the given number of ports or
+   NULL if there is none.  This keeps the memory held by the plan at
+   the size of the netlist which is live during the reduction. */
+circuit * spsolver::spareCircuit (int size) {
+  auto it = spares.find (size);
+  if (it == spares.end ()) return NULL;
+  circuit * c = it->second;
+  spares.erase (it);
+  return c;
+}
+
+/* Propagates the noise correlation matrices along the reduction plan
+   while the S-parameters are being joined by replayJoins().  Each
+   step waits for the S-parameters of its circuits. */
+void spsolver::replayNoise (void) {
+  int n = plan.size ();
+  for (int i = 0; i < n; i++) {
+    spstep & s = plan[i];
+    while (signalSteps.load (std::memory_order_acquire) <= i)
+      std::this_thread::yield ();
+    noiseJoin (s.result, s.n);
+    noiseSteps.store (i + 1, std::memory_order_release);
+  }
+}
+
+/* Reduces the netlist by replaying the recorded plan.  Only the
+   numeric joins are performed, into the already allocated matrices of
+   the plan circuits.  For large plans the noise correlation matrices
+   are propagated on a second thread, a step overwriting a reused plan
+   circuit waits for the noise step still reading it. */
+void spsolver::replayJoins (void) {
+  if (noise && noiseCost > NOISE_PIPELINE &&
+      threadpool::getThreads () > 1) {
+    int n = plan.size ();
+    signalSteps = noiseSteps = 0;
+    std::thread worker (&spsolver::replayNoise, this);
+    for (int i = 0; i < n; i++) {
+      spstep & s = plan[i];
+      while (noiseSteps.load (std::memory_order_acquire) <= s.wait)
+	std::this_thread::yield ();
+      join (s.n, s.result);
+      signalSteps.store (i + 1, std::memory_order_release);
+    }
+    worker.join ();
+    for (auto & s : plan) moveJoin (s);
+    return;
+  }
+  for (auto & s : plan) {
+    join (s.n, s.result);
+    if (noise) noiseJoin (s.result, s.n);
+    moveJoin (s);
+  }
+}
+
+/* Removes the remaining plan circuits from the reduced netlist such
+   that the original circuits can be restored. */
+void spsolver::releaseJoins (void) {
+  if (results.empty ()) {
+    circuit * root = subnet->getRoot ();
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+      if (planned.count (c)) results.push_back (c);
+  }
+  for (auto c : results) subnet->removeCircuit (c, 0);
+}
+
+// Destroys the reduction plan and its circuits.
+void spsolver::clearJoins (void) {
+  for (auto c : planned) delete c;
+  planned.clear ();
+  plan.clear ();
+  lastInput.clear ();
+  noiseCost = 0;
+  results.clear ();
+  spares.clear ();
+}
+
 /* Goes through the list of circuit objects and runs its frequency
    dependent calcSP() function. */
 void spsolver::calc (nr_double_t freq) {
@@ -457,7 +1032,8 @@ void spsolver::calc (nr_double_t freq) {
 /* Go through each registered circuit object in the list and find the
    connection which results in a new subnetwork with the smallest
    number of s-parameters to calculate. */
-void spsolver::reduce (void) {
+int spsolver::reduce (void) {
+  TRACE_SCOPE ("spsolver::reduce");
 
 #if SORTED_LIST
   node * n1, * n2;
@@ -467,49 +1043,20 @@ void spsolver::reduce (void) {
   cand1 = n1->getCircuit ();
   cand2 = n2->getCircuit ();
 #else /* !SORTED_LIST */
-  node * n1, * n2, * cand;
-  circuit * result, * c1, * c2, * cand1, * cand2;
-  int ports;
-  circuit * root = subnet->getRoot ();
-
-  // initialize local variables
-  result = c1 = c2 = cand1 = cand2 = NULL;
-  n1 = n2 = cand = NULL;
-  ports = 10000; // huge
-
-  // go through the circuit list
-  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
-
-    // skip signal ports
-    if (c->getPort ()) continue;
-
-    // and each node in the circuit
-    for (int i = 0; i < c->getSize (); i++) {
-
-      // find duplicate node
-      if ((cand = subnet->findConnectedCircuitNode (c->getNode (i))) != NULL) {
-
-	// save both candidates
-	c1 = c; c2 = cand->getCircuit ();
-	// connected
-	if (c1 != c2) {
-	  if (c1->getSize () + c2->getSize () - 2 < ports) {
-	    ports = c1->getSize () + c2->getSize () - 2;
-	    cand1 = c1; cand2 = c2; n1 = c1->getNode (i); n2 = cand;
-	  }
-	}
-	// interconnect
-	else {
-	  if (c1->getSize () - 2 < ports) {
-	    ports = c1->getSize () - 2;
-	    cand1 = c1; cand2 = c2; n1 = c1->getNode (i); n2 = cand;
-	  }
-	}
-      }
-    }
-  }
+  std::vector<node *> nodes;
+
+  // take the best connection from the join queue
+  if (!nextJoin (nodes)) return 0;
+  std::vector<circuit *> cands = joinedCircuits (nodes);
+  circuit * result = join (nodes, spareCircuit (joinedSize (nodes)));
+  if (noise) noiseJoin (result, nodes);
+  subnet->reducedCircuit (result);
+  recordJoin (nodes, result);
+  updateJoins (result, cands);
+  return nodes.size ();
 #endif /* !SORTED_LIST */
 
+#if SORTED_LIST
   // found a connection ?
   if (cand1 != NULL && cand2 != NULL) {
     // connected
@@ -521,11 +1068,9 @@ void spsolver::reduce (void) {
       result = connectedJoin (n1, n2);
       if (noise) noiseConnect (result, n1, n2);
       subnet->reducedCircuit (result);
-#if SORTED_LIST
       nlist->remove (cand1);
       nlist->remove (cand2);
       nlist->insert (result);
-#endif /* SORTED_LIST */
       subnet->removeCircuit (cand1);
       subnet->removeCircuit (cand2);
       subnet->insertCircuit (result);
@@ -540,15 +1085,15 @@ void spsolver::reduce (void) {
       result = interconnectJoin (n1, n2);
       if (noise) noiseInterconnect (result, n1, n2);
       subnet->reducedCircuit (result);
-#if SORTED_LIST
       nlist->remove (cand1);
       nlist->insert (result);
-#endif /* SORTED_LIST */
       subnet->removeCircuit (cand1);
       subnet->insertCircuit (result);
       result->setOriginal (0);
     }
   }
+  return 2;
+#endif /* SORTED_LIST */
 }
 
 /* Goes through the list of circuit objects and runs initializing
@@ -556,12 +1101,103 @@ void spsolver::reduce (void) {
 void spsolver::init (void) {
   circuit * root = subnet->getRoot ();
   for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    c->setRealMNA (false);
     if (c->isNonLinear ()) c->calcOperatingPoints ();
     c->initSP ();
     if (noise) c->initNoiseSP ();
   }
 }
 
+/* Estimates the cost of the network reduction by running the join
+   queue on the topology of the netlist only.  The returned value is
+   the number of S-parameters computed per frequency point. */
+nr_double_t spsolver::reductionCost (void) {
+  std::vector<circuit *> joined;
+  nr_double_t cost = 0;
+  std::vector<node *> nodes;
+
+  initJoins ();
+  while (nextJoin (nodes)) {
+    std::vector<circuit *> cands = joinedCircuits (nodes);
+    int size = joinedSize (nodes);
+
+    // a circuit without matrices carrying the remaining nodes
+    circuit * result = new circuit (size);
+    int k = 0;
+    for (auto c : cands) {
+      for (int i = 0; i < c->getSize (); i++) {
+	node * n = c->getNode (i);
+	if (std::find (nodes.begin (), nodes.end (), n) == nodes.end ())
+	  result->setNode (k++, n->getName ());
+      }
+    }
+    updateJoins (result, cands);
+    joined.push_back (result);
+    cost += (nr_double_t) size * size;
+  }
+  for (auto c : joined) delete c;
+  return cost;
+}
+
+/* Decides whether the S-parameters are computed by nodal analysis
+   instead of the network reduction.  The noise analysis is available
+   for the network reduction only. */
+int spsolver::useMNA (void) {
+  const char * const method = getPropertyString ("Method");
+  if (!strcmp (method, "reduction")) return 0;
+  if (noise) {
+    if (!strcmp (method, "MNA")) {
+      logprint (LOG_ERROR, "WARNING: %s: noise analysis requires the "
+		"network reduction\n", getName ());
+    }
+    return 0;
+  }
+  if (!strcmp (method, "MNA")) return 1;
+
+  // compare the estimated costs of both methods
+  nr_double_t unknowns = subnet->countNodes () / 2;
+  nr_double_t mna = MNA_FILL * unknowns * (subnet->getPorts () + 1);
+  return reductionCost () > mna;
+}
+
+/* Solves the netlist by nodal analysis for each requested frequency.
+   The inserted connections must have been dropped already. */
+int spsolver::solveMNA (void) {
+#if DEBUG
+  logprint (LOG_STATUS, "NOTIFY: %s: solving SP netlist by nodal analysis\n",
+	    getName ());
+#endif
+  spmna * mna = new spmna (getName ());
+  mna->setNet (subnet);
+  mna->init ();
+
+  // number of worker threads, zero means one per processor
+  int threads = threadpool::threads (getPropertyInteger ("Threads"));
+  threads = std::max (threads, 1);
+
+  /* The matrices of a batch of frequency points are assembled in sweep
+     order, the circuit characteristics are taken meanwhile.  The batch
+     is solved concurrently and the S-parameters are appended at once. */
+  int size = swp->getSize (), batch = threads * SP_BATCH_SIZE;
+  swp->reset ();
+  for (int i = 0; i < size; i += batch) {
+    int n = std::min (batch, size - i);
+    for (int k = 0; k < n; k++) {
+      nr_double_t freq = swp->next ();
+      if (progress) logprogressbar (i + k, size, 40);
+      mna->assemble (freq);
+      saveFrequency (freq);
+      if (saveCVs & SAVE_CVS) saveCharacteristics (freq);
+    }
+    mna->solve (threads);
+    saveResults (mna);
+  }
+  if (progress) logprogressclear (40);
+  mna->finish ();
+  delete mna;
+  return 0;
+}
+
 /* This is the netlist solver.  It prepares the circuit list for each
    requested frequency and solves it then. */
 int spsolver::solve (void) {
@@ -576,10 +1212,15 @@ int spsolver::solve (void) {
   // run additional noise analysis ?
   noise = !strcmp (getPropertyString ("Noise"), "yes") ? 1 : 0;
 
+  // order of the network reduction
+  dissection = !strcmp (getPropertyString ("Reduction"), "dissection");
+
   // create frequency sweep if necessary
   if (swp == NULL) {
     swp = createSweep ("frequency");
   }
+  setResultPoints (swp->getSize ());
+  spvars.clear ();
 
   init ();
   insertConnections ();
@@ -591,6 +1232,15 @@ int spsolver::solve (void) {
 #endif
   nlist = new nodelist (subnet);
   nlist->sort ();
+#else
+  // the ordering depends on the topology only
+  if (dissection) dissectJoins ();
+
+  // large networks may be cheaper to solve by nodal analysis
+  if (useMNA ()) {
+    dropConnections ();
+    return solveMNA ();
+  }
 #endif /* SORTED_LIST */
 
 #if DEBUG
@@ -611,12 +1261,27 @@ int spsolver::solve (void) {
 	      getName (), (double) freq);
 #endif
 
+#if !SORTED_LIST
+    // record the reduction plan once, then replay it
+    if (i == 0) {
+      initJoins ();
+      while (ports > subnet->getPorts ()) {
+	int joined = reduce ();
+	if (joined == 0) break;
+	ports -= joined;
+      }
+    }
+    else replayJoins ();
+#else /* SORTED_LIST */
     while (ports > subnet->getPorts ()) {
-      reduce ();
-      ports -= 2;
+      ports -= reduce ();
     }
+#endif /* SORTED_LIST */
 
     saveResults (freq);
+#if !SORTED_LIST
+    releaseJoins ();
+#endif
     subnet->getDroppedCircuits (nlist);
     subnet->deleteUnusedCircuits (nlist);
     if (saveCVs & SAVE_CVS) saveCharacteristics (freq);
@@ -625,17 +1290,22 @@ int spsolver::solve (void) {
   dropConnections ();
 #if SORTED_LIST
   delete nlist; nlist = NULL;
+#else
+  clearJoins ();
 #endif
   return 0;
 }
 
 /* The function goes through the list of circuit objects and creates
    tee and cross circuits if necessary.  It looks for nodes in the
-   circuit list connected to the given node. */
+   circuit list connected to the given node.  The network reduction
+   joins any number of nodes at once, the connectors are inserted at
+   nodes of signal ports only which are not part of any join. */
 void spsolver::insertConnectors (node * n) {
 
   int count = 0;
-  node * nodes[4], * _node;
+  node * nodes[4];
+  std::vector<node *> connected;
   const char * _name = n->getName ();
   circuit * root = subnet->getRoot ();
 
@@ -643,34 +1313,39 @@ void spsolver::insertConnectors (node * n) {
   if (!strcmp (_name, "gnd")) return;
 #endif /* USE_GROUNDS */
 
-  nodes[0] = n;
-
-  // go through list of circuit objects
+  // go through list of circuit objects and each node in a circuit
+  int port = n->getCircuit()->getPort ();
   for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
-    // and each node in a circuit
     for (int i = 0; i < c->getSize (); i++) {
-      _node = c->getNode (i);
-      if (!strcmp (_node->getName (), _name)) {
-	if (_node != n) {
+      node * _node = c->getNode (i);
+      if (_node != n && !strcmp (_node->getName (), _name)) {
+	connected.push_back (_node);
+	if (c->getPort ()) port = 1;
+      }
+    }
+  }
+#if !SORTED_LIST
+  if (!port) return;
+#endif /* !SORTED_LIST */
+
+  nodes[0] = n;
+  for (auto _node : connected) {
 
-	  // found a connected node
-	  nodes[++count] = _node;
+    // found a connected node
+    nodes[++count] = _node;
 #if USE_CROSSES
-	  if (count == 3) {
-	    // create an additional cross and assign its nodes
-	    insertCross (nodes, _name);
-	    count = 1;
-	  }
+    if (count == 3) {
+      // create an additional cross and assign its nodes
+      insertCross (nodes, _name);
+      count = 1;
+    }
 #else /* !USE_CROSSES */
-	  if (count == 2) {
-	    // create an additional tee and assign its nodes
-	    insertTee (nodes, _name);
-	    count = 1;
-	  }
-#endif /* !USE_CROSSES */
-	}
-      }
+    if (count == 2) {
+      // create an additional tee and assign its nodes
+      insertTee (nodes, _name);
+      count = 1;
     }
+#endif /* !USE_CROSSES */
   }
 #if USE_CROSSES
   /* if using crosses there can be a tee left here */
@@ -965,13 +1640,24 @@ void spsolver::dropDifferentialPort (circuit * c) {
   }
 }
 
+/* Adds the given frequency to the dependency of the output dataset
+   and returns the dependency. */
+vector * spsolver::saveFrequency (nr_double_t freq) {
+  vector * f;
+  if ((f = data->findDependency ("frequency")) == NULL) {
+    f = new vector ("frequency");
+    data->addDependency (f);
+  }
+  if (runs == 1) f->add (freq);
+  return f;
+}
+
 /* This function saves the results of a single solve() functionality
    (for the given frequency) into the output dataset. */
 void spsolver::saveResults (nr_double_t freq) {
 
   vector * f;
   node * sig_i, * sig_j;
-  char * n;
   int res_i, res_j;
   circuit * root = subnet->getRoot ();
 
@@ -980,11 +1666,7 @@ void spsolver::saveResults (nr_double_t freq) {
   nr_double_t z0 = circuit::z0;
 
   // add current frequency to the dependency of the output dataset
-  if ((f = data->findDependency ("frequency")) == NULL) {
-    f = new vector ("frequency");
-    data->addDependency (f);
-  }
-  if (runs == 1) f->add (freq);
+  f = saveFrequency (freq);
 
   // go through the list of remaining circuits
   for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
@@ -999,10 +1681,9 @@ void spsolver::saveResults (nr_double_t freq) {
 	  sig_j = subnet->findConnectedNode (c->getNode (j));
 	  res_i = sig_i->getCircuit()->getPropertyInteger ("Num");
 	  res_j = sig_j->getCircuit()->getPropertyInteger ("Num");
-	  n = createSP (res_i, res_j);
 
 	  // add variable data item to dataset
-	  saveVariable (n, c->getS (i, j), f);
+	  findSP (res_i, res_j, f)->add (c->getS (i, j));
 
 	  // if noise analysis is requested
 	  if (noise) {
@@ -1032,6 +1713,22 @@ void spsolver::saveResults (nr_double_t freq) {
   }
 }
 
+/* Saves the S-parameters of the batch of frequency points computed by
+   nodal analysis, all the values of a variable at once. */
+void spsolver::saveResults (spmna * mna) {
+  vector * f = data->findDependency ("frequency");
+  int n = mna->getPoints ();
+  std::vector<nr_complex_t> values (n);
+  for (int i = 0; i < mna->getPorts (); i++) {
+    int res_i = mna->getPort(i)->getPropertyInteger ("Num");
+    for (int j = 0; j < mna->getPorts (); j++) {
+      int res_j = mna->getPort(j)->getPropertyInteger ("Num");
+      for (int k = 0; k < n; k++) values[k] = mna->getS (k, i, j);
+      findSP (res_i, res_j, f)->add (values.data (), n);
+    }
+  }
+}
+
 /* This function takes the s-parameter matrix and noise wave
    correlation matrix and computes the noise parameters based upon
    these values.  Then it save the results into the dataset. */
@@ -1076,6 +1773,18 @@ char * spsolver::createSP (int i, int j) {
   return matvec::createMatrixString ("S", i - 1, j - 1);
 }
 
+/* Returns the dataset vector of the given S-parameter.  The vectors
+   are looked up once per analysis run and preallocated for its
+   frequency points, the variable names are not created per point. */
+vector * spsolver::findSP (int i, int j, vector * f) {
+  int key = i * (MAX_PORTS + 1) + j;
+  auto it = spvars.find (key);
+  if (it != spvars.end ()) return it->second;
+  vector * v = findVariable (createSP (i, j), f);
+  spvars[key] = v;
+  return v;
+}
+
 /* Create an appropriate variable name for characteristic values.  The
    caller is responsible to free() the returned string. */
 const char * spsolver::createCV (const std::string &c, const std::string &n) {
@@ -1115,6 +1824,11 @@ PROP_OPT [] = {
   { "Values", PROP_LIST, { 10, PROP_NO_STR }, PROP_POS_RANGE },
   { "saveCVs", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
   { "saveAll", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+  { "Reduction", PROP_STR, { PROP_NO_VAL, "greedy" },
+    PROP_RNG_STR2 ("greedy", "dissection") },
+  { "Method", PROP_STR, { PROP_NO_VAL, "auto" },
+    PROP_RNG_STR3 ("auto", "reduction", "MNA") },
+  { "Threads", PROP_INT, { 1, PROP_NO_STR }, PROP_RNGII (0, 256) },
   PROP_NO_PROP };
 struct define_t spsolver::anadef =
   { "SP", 0, PROP_ACTION, PROP_NO_SUBSTRATE, PROP_LINEAR, PROP_DEF };
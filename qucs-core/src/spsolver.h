@@ -25,7 +25,12 @@
 #ifndef __SPSOLVER_H__
 #define __SPSOLVER_H__
 
+#include <atomic>
 #include <string>
+#include <queue>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace qucs {
 
@@ -35,6 +40,8 @@ class node;
 class vector;
 class sweep;
 class nodelist;
+class spmna;
+class matrix;
 
 class spsolver : public analysis
 {
@@ -45,7 +52,7 @@ class spsolver : public analysis
   ~spsolver ();
   void calc (nr_double_t);
   void init (void);
-  void reduce (void);
+  int  reduce (void);
   int  solve (void);
   void insertConnections (void);
   void insertDifferentialPorts (void);
@@ -54,14 +61,21 @@ class spsolver : public analysis
   void insertConnectors (node *);
   void insertOpen (node *);
   void insertGround (node *);
-  circuit * interconnectJoin (node *, node *);
-  circuit * connectedJoin (node *, node *);
+  circuit * interconnectJoin (node *, node *, circuit * = NULL);
+  circuit * connectedJoin (node *, node *, circuit * = NULL);
+  circuit * junctionJoin (const std::vector<node *> &, circuit * = NULL);
+  circuit * join (const std::vector<node *> &, circuit * = NULL);
   void noiseConnect (circuit *, node *, node *);
   void noiseInterconnect (circuit *, node *, node *);
+  void noiseJunction (circuit *, const std::vector<node *> &);
+  void noiseJoin (circuit *, const std::vector<node *> &);
   void saveResults (nr_double_t);
+  void saveResults (spmna *);
+  vector * saveFrequency (nr_double_t);
   void saveNoiseResults (nr_complex_t[4], nr_complex_t[4],
 			 nr_double_t, vector *);
   char * createSP (int, int);
+  vector * findSP (int, int, vector *);
   const char * createCV (const std::string &c, const std::string &n);
   void saveCharacteristics (nr_double_t);
   void dropTee (circuit *);
@@ -70,8 +84,70 @@ class spsolver : public analysis
   void dropGround (circuit *);
   void dropDifferentialPort (circuit *);
   void dropConnections (void);
+  void initJoins (void);
+  void updateJoins (circuit *, const std::vector<circuit *> &);
+  int  nextJoin (std::vector<node *> &);
+  void dissectJoins (void);
+  void replayJoins (void);
+  void releaseJoins (void);
+  void clearJoins (void);
+  nr_double_t reductionCost (void);
+  int  useMNA (void);
+  int  solveMNA (void);
 
  private:
+  // the connected circuit nodes of the same name
+  struct spjoin {
+    spjoin () : count (0), rank (0), version (0) { }
+    std::vector<node *> n;
+    std::vector<circuit *> c;
+    int count;
+    int rank;
+    int version;
+  };
+  /* a queued join candidate, the best one is at the top of the queue;
+     ties go to the latest candidate which keeps the reduction at the
+     circuit grown last and independent of the order of the netlist */
+  struct spcandidate {
+    int rank, ports, order, version;
+    std::string name;
+    bool operator< (const spcandidate & o) const {
+      if (rank != o.rank) return rank < o.rank;
+      if (ports != o.ports) return ports > o.ports;
+      return order < o.order;
+    }
+  };
+  // a recorded join of the reduction plan
+  struct spstep {
+    std::vector<node *> n;  // the joined nodes
+    circuit * result;       // circuit receiving the joined matrices
+    std::vector<int> drop;  // move the joined circuits to the drop list ?
+    int wait;               // last earlier step using the result as input
+  };
+  void addJoin (node *);
+  void queueJoin (const std::string &, spjoin &);
+  void recordJoin (const std::vector<node *> &, circuit *);
+  void junctionMatrices (const std::vector<node *> &, matrix &,
+			 std::vector<circuit *> &, std::vector<int> &);
+  void moveJoin (const spstep &);
+  void replayNoise (void);
+  circuit * spareCircuit (int);
+
+  std::unordered_map<std::string, spjoin> joins;
+  std::priority_queue<spcandidate> candidates;
+  std::unordered_map<std::string, int> ranks;
+  int joinorder;
+  int dissection;
+  std::vector<spstep> plan;
+  std::unordered_set<circuit *> planned;
+  std::vector<circuit *> results;
+  std::unordered_multimap<int, circuit *> spares;
+  std::unordered_map<circuit *, int> lastInput;
+  std::unordered_map<int, vector *> spvars;
+  nr_double_t noiseCost;
+  std::atomic<int> signalSteps;
+  std::atomic<int> noiseSteps;
+
   int tees, crosses, grounds, opens;
   int noise;
   int saveCVs;
@@ -41,23 +41,30 @@ states<state_type_t>::states ()
 {
     nstates = 0;
     currentstate = 0;
+    stride = 0;
     stateval = NULL;
+    pool = NULL;
 }
 
 /* The copy constructor creates a new instance based on the given
-   states object. */
+   states object.  The copy always owns its state variables, even if
+   the given object is part of a pool. */
 template <class state_type_t>
 states<state_type_t>::states (const states & c)
 {
     nstates = c.nstates;
-    currentstate = c.currentstate;
+    currentstate = 0;
+    stride = nstates;
+    pool = NULL;
 
     // copy state variables if necessary
     if (nstates && c.stateval)
     {
-        int size = nstates * sizeof (state_type_t) * STATE_NUM;
-        stateval = (state_type_t *) malloc (size);
-        memcpy (stateval, c.stateval, size);
+        stateval = (state_type_t *)
+                   malloc (nstates * sizeof (state_type_t) * STATE_NUM);
+        for (int i = 0; i < STATE_NUM; i++)
+            for (int n = 0; n < nstates; n++)
+                stateval[i * stride + n] = c.stateval[c.slot (i) + n];
     }
     else stateval = NULL;
 }
@@ -66,7 +73,7 @@ states<state_type_t>::states (const states & c)
 template <class state_type_t>
 states<state_type_t>::~states ()
 {
-    free (stateval);
+    if (!pool) free (stateval);
 }
 
 /* The function allocates and initializes memory for the save-state
@@ -74,12 +81,19 @@ states<state_type_t>::~states ()
 template <class state_type_t>
 void states<state_type_t>::initStates (void)
 {
+    if (pool)
+    {
+        clearStates ();
+        return;
+    }
     free (stateval);
+    stateval = NULL;
     if (nstates)
     {
         stateval = (state_type_t *)
                    calloc (nstates, sizeof (state_type_t) * STATE_NUM);
     }
+    stride = nstates;
     currentstate = 0;
 }
 
@@ -88,8 +102,20 @@ template <class state_type_t>
 void states<state_type_t>::clearStates (void)
 {
     if (nstates && stateval)
-        memset (stateval, 0, nstates * sizeof (state_type_t) * STATE_NUM);
-    currentstate = 0;
+    {
+        for (int i = 0; i < STATE_NUM; i++)
+            memset (&stateval[i * stride], 0, nstates * sizeof (state_type_t));
+    }
+    if (!pool) currentstate = 0;
+}
+
+/* Returns the offset of the given history slot relative to the
+   current one. */
+template <class state_type_t>
+int states<state_type_t>::slot (int n) const
+{
+    int c = pool ? pool->currentstate : currentstate;
+    return ((n + c) & STATE_MASK) * stride;
 }
 
 /* The function returns a save-state variable at the given position.
@@ -98,8 +124,7 @@ void states<state_type_t>::clearStates (void)
 template <class state_type_t>
 state_type_t states<state_type_t>::getState (int state, int n)
 {
-    int i = (n + currentstate) & STATE_MASK;
-    return stateval[(state << STATE_SHIFT) + i];
+    return stateval[slot (n) + state];
 }
 
 /* This function applies the given value to a save-state variable.
@@ -108,14 +133,15 @@ state_type_t states<state_type_t>::getState (int state, int n)
 template <class state_type_t>
 void states<state_type_t>::setState (int state, state_type_t val, int n)
 {
-    int i = (n + currentstate) & STATE_MASK;
-    stateval[(state << STATE_SHIFT) + i] = val;
+    stateval[slot (n) + state] = val;
 }
 
-// Shifts one state forward.
+/* Shifts one state forward.  The states of a pool are shifted by the
+   pool itself. */
 template <class state_type_t>
 void states<state_type_t>::nextState (void)
 {
+    if (pool) return;
     if (--currentstate < 0) currentstate = STATE_NUM - 1;
 }
 
@@ -123,6 +149,7 @@ void states<state_type_t>::nextState (void)
 template <class state_type_t>
 void states<state_type_t>::prevState (void)
 {
+    if (pool) return;
     currentstate = (currentstate + 1) & STATE_MASK;
 }
 
@@ -131,12 +158,12 @@ void states<state_type_t>::prevState (void)
 template <class state_type_t>
 void states<state_type_t>::fillState (int state, state_type_t val)
 {
-    // get a pointer to the start of the state array
-    state_type_t * p = &stateval[state << STATE_SHIFT];
-    // fill each array member with the supplied value
-    for (int i = 0; i < STATE_NUM; i++)
+    // get a pointer to the state in the first slot
+    state_type_t * p = &stateval[state];
+    // fill each slot with the supplied value
+    for (int i = 0; i < STATE_NUM; i++, p += stride)
     {
-        *p++ = val;
+        *p = val;
     }
 }
 
@@ -166,4 +193,117 @@ void states<state_type_t>::inputState (int state, state_type_t * values)
     }
 }
 
+// Constructor creates an empty pool.
+template <class state_type_t>
+statepool<state_type_t>::statepool ()
+{
+    stateval = NULL;
+    nstates = 0;
+    currentstate = 0;
+}
+
+/* The copy constructor creates an empty pool, the objects can be part
+   of a single pool only. */
+template <class state_type_t>
+statepool<state_type_t>::statepool (const statepool &)
+{
+    stateval = NULL;
+    nstates = 0;
+    currentstate = 0;
+}
+
+// Destructor hands the states back to their objects.
+template <class state_type_t>
+statepool<state_type_t>::~statepool ()
+{
+    release ();
+}
+
+/* The function moves the state variables of the given objects into a
+   single buffer, each history slot holding the variables of all the
+   objects one after another.  The current values are kept. */
+template <class state_type_t>
+void statepool<state_type_t>::create (std::vector<states<state_type_t> *> & list)
+{
+    release ();
+    nstates = 0;
+    for (states<state_type_t> * s : list)
+    {
+        if (s->nstates && s->stateval && !s->pool)
+        {
+            objects.push_back (s);
+            nstates += s->nstates;
+        }
+    }
+    if (!nstates) return;
+
+    stateval = (state_type_t *)
+               malloc (nstates * sizeof (state_type_t) * STATE_NUM);
+    currentstate = 0;
+    int offset = 0;
+    for (states<state_type_t> * s : objects)
+    {
+        for (int i = 0; i < STATE_NUM; i++)
+            for (int n = 0; n < s->nstates; n++)
+                stateval[i * nstates + offset + n] = s->stateval[s->slot (i) + n];
+        free (s->stateval);
+        s->stateval = &stateval[offset];
+        s->stride = nstates;
+        s->pool = this;
+        offset += s->nstates;
+    }
+}
+
+/* The function copies the state variables back into storage owned by
+   each object and empties the pool. */
+template <class state_type_t>
+void statepool<state_type_t>::release (void)
+{
+    for (states<state_type_t> * s : objects)
+    {
+        state_type_t * p = (state_type_t *)
+                           malloc (s->nstates * sizeof (state_type_t) * STATE_NUM);
+        for (int i = 0; i < STATE_NUM; i++)
+            for (int n = 0; n < s->nstates; n++)
+                p[i * s->nstates + n] = s->stateval[s->slot (i) + n];
+        s->stateval = p;
+        s->stride = s->nstates;
+        s->currentstate = 0;
+        s->pool = NULL;
+    }
+    objects.clear ();
+    free (stateval);
+    stateval = NULL;
+    nstates = 0;
+    currentstate = 0;
+}
+
+// Shifts the states of all the objects one state forward.
+template <class state_type_t>
+void statepool<state_type_t>::nextState (void)
+{
+    if (--currentstate < 0) currentstate = STATE_NUM - 1;
+}
+
+// Shifts the states of all the objects one state backward.
+template <class state_type_t>
+void statepool<state_type_t>::prevState (void)
+{
+    currentstate = (currentstate + 1) & STATE_MASK;
+}
+
+/* This function applies the current values of all the state variables
+   through all history values. */
+template <class state_type_t>
+void statepool<state_type_t>::fillStates (void)
+{
+    if (!nstates) return;
+    state_type_t * c = &stateval[currentstate * nstates];
+    for (int i = 0; i < STATE_NUM; i++)
+    {
+        if (i != currentstate)
+            memcpy (&stateval[i * nstates], c, nstates * sizeof (state_type_t));
+    }
+}
+
 } // namespace qucs
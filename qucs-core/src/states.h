@@ -25,18 +25,27 @@
 #ifndef __STATES_H__
 #define __STATES_H__
 
+#include <vector>
+
 namespace qucs {
 
+template <class state_type_t> class statepool;
+
 /*! \class states
  * \brief template class for storing state variables.
  *
  * This class is used for storing sets of states for use
- * by the transient integrators.
+ * by the transient integrators.  The history values are stored in a
+ * contiguous block per history slot, the slots are rotated instead
+ * of copying the values.  The blocks may live in a pool shared with
+ * other state objects, which then advance together.
  *
  */
 template <class state_type_t>
 class states
 {
+  friend class statepool<state_type_t>;
+
  public:
   // constructor and destructor set
   states ();
@@ -55,14 +64,53 @@ class states
   void fillState (int, state_type_t);
   void saveState (int, state_type_t *);
   void inputState (int, state_type_t *);
+  bool isPooled (void) { return pool != NULL; }
 
  private:
-  // stateval: array for holding all the sets of states. Multiple sets of
-  // states are stored in one large array which is indexed appropriately
-  // to get the right state set and value
+  int slot (int) const;
+
+ private:
+  // stateval: array for holding all the sets of states. The history
+  // slots of all state variables are stored one after another, each
+  // slot taking stride values, in the pool starting at this object's
+  // variables
   state_type_t * stateval;
   int nstates; // the number of sets of states stored
   int currentstate;
+  int stride;
+  statepool<state_type_t> * pool;
+};
+
+/*! \class statepool
+ * \brief shared storage for the states of many objects.
+ *
+ * The pool keeps the history slots of the state variables of all the
+ * attached objects in one buffer, the slot of all the variables in a
+ * single contiguous block.  A single rotation of the slots advances
+ * all the objects at once.
+ *
+ */
+template <class state_type_t>
+class statepool
+{
+ public:
+  statepool ();
+  statepool (const statepool &);
+  ~statepool ();
+  void create (std::vector<states<state_type_t> *> &);
+  void release (void);
+  void nextState (void);
+  void prevState (void);
+  void fillStates (void);
+  int  getStates (void) { return nstates; }
+
+ private:
+  std::vector<states<state_type_t> *> objects;
+  state_type_t * stateval;
+  int nstates;
+  int currentstate;
+
+  friend class states<state_type_t>;
 };
 
 } // namespace qucs
@@ -0,0 +1,179 @@
+/*
+ * threadpool.cpp - shared worker threads implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if HAVE_FORK
+#include <pthread.h>
+#endif
+
+#include "logging.h"
+#include "threadpool.h"
+
+namespace qucs {
+
+// The tasks of a parallel loop.
+struct pooljob_t {
+  const std::function<void (int)> * func;
+  int tasks;  // number of tasks
+  int next;   // first task not taken yet
+  int done;   // number of tasks finished
+};
+
+// The state of the pool, guarded by the lock.
+static std::mutex lock;
+static std::condition_variable wakeup;
+static std::condition_variable finished;
+static std::vector<pooljob_t *> jobs;
+static std::vector<std::thread> * workers = NULL;
+static bool stopping = false;
+
+int threadpool::size = 0;
+
+/* Takes the next task of the given job and runs it with the lock
+   released.  A job is removed from the list once all its tasks are
+   taken.  Returns false if there was none left. */
+static bool runTask (std::unique_lock<std::mutex> & l, pooljob_t * j) {
+  if (j->next >= j->tasks) return false;
+  int k = j->next++;
+  if (j->next >= j->tasks)
+    jobs.erase (std::find (jobs.begin (), jobs.end (), j));
+  l.unlock ();
+  (*j->func) (k);
+  // messages of the task are written at its end
+  logflush ();
+  l.lock ();
+  if (++j->done == j->tasks) finished.notify_all ();
+  return true;
+}
+
+/* The worker threads take the tasks of the newest loops first, the
+   inner loops of nested ones. */
+static void work (void) {
+  std::unique_lock<std::mutex> l (lock);
+  for (;;) {
+    wakeup.wait (l, [] { return stopping || !jobs.empty (); });
+    if (stopping && jobs.empty ()) return;
+    runTask (l, jobs.back ());
+  }
+}
+
+#if HAVE_FORK
+/* A forked process has got the calling thread only, it continues with
+   no worker threads and starts its own ones when needed. */
+static void forkPrepare (void) { lock.lock (); }
+static void forkParent (void) { lock.unlock (); }
+static void forkChild (void) {
+  workers = new std::vector<std::thread> ();
+  lock.unlock ();
+}
+#endif
+
+// Ends the worker threads, the ones waiting for jobs at once.
+static void stopWorkers (void) {
+  std::unique_lock<std::mutex> l (lock);
+  if (workers == NULL) return;
+  stopping = true;
+  wakeup.notify_all ();
+  l.unlock ();
+  for (auto & t : *workers) t.join ();
+  l.lock ();
+  workers->clear ();
+  stopping = false;
+}
+
+// Ends the worker threads at program exit.
+static struct poolguard_t {
+  ~poolguard_t () { stopWorkers (); }
+} guard;
+
+/* Sets the number of threads, zero or less for one per processor.
+   The running workers end and the new ones start when needed. */
+void threadpool::setThreads (int n) {
+  stopWorkers ();
+  std::unique_lock<std::mutex> l (lock);
+  size = std::max (n, 0);
+}
+
+/* Returns the number of threads, the calling one included.  It is
+   looked up in the environment unless set. */
+int threadpool::getThreads (void) {
+  std::unique_lock<std::mutex> l (lock);
+  if (size <= 0) {
+    const char * env = getenv ("QUCS_THREADS");
+    size = env ? atoi (env) : 0;
+    if (size <= 0) size = std::thread::hardware_concurrency ();
+    size = std::max (size, 1);
+  }
+  return size;
+}
+
+/* Returns the given number of parallel parts requested by an analysis,
+   one per thread of the pool for zero or less. */
+int threadpool::threads (int n) {
+  return n > 0 ? n : getThreads ();
+}
+
+/* A process of a parallel sweep running with the given number of
+   processes keeps its share of the threads. */
+void threadpool::share (int n) {
+  int t = getThreads ();
+  setThreads (std::max (1, t / std::max (n, 1)));
+}
+
+/* Runs the given function for the task indices 0 to n - 1 and returns
+   once all of them are done.  The calling thread runs tasks as well
+   until none is left to be taken. */
+void threadpool::run (int n, const std::function<void (int)> & func) {
+  if (n <= 0) return;
+  if (n == 1 || getThreads () <= 1) {
+    for (int k = 0; k < n; k++) func (k);
+    return;
+  }
+  pooljob_t j = { &func, n, 0, 0 };
+  std::unique_lock<std::mutex> l (lock);
+  if (workers == NULL) {
+    workers = new std::vector<std::thread> ();
+#if HAVE_FORK
+    pthread_atfork (forkPrepare, forkParent, forkChild);
+#endif
+  }
+  while ((int) workers->size () < size - 1)
+    workers->push_back (std::thread (work));
+  jobs.push_back (&j);
+  wakeup.notify_all ();
+  while (runTask (l, &j)) ;
+  finished.wait (l, [&j] { return j.done == j.tasks; });
+}
+
+} // namespace qucs
@@ -0,0 +1,61 @@
+/*
+ * threadpool.h - shared worker threads definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+#include <functional>
+
+namespace qucs {
+
+/*! \class threadpool
+ * \brief worker threads shared by all the parallel loops.
+ *
+ * A parallel loop hands its tasks to the pool and runs them itself as
+ * well, idle workers take the remaining tasks of the loops waiting.
+ * Tasks may run parallel loops again, a task waiting for its inner
+ * loop keeps running the inner tasks, thus the number of running
+ * threads never exceeds the size of the pool.  The tasks are known by
+ * their index only, results kept by index and combined in index order
+ * afterwards do not depend on the number of threads.
+ *
+ * The size is given by the --threads option, else by the environment
+ * variable QUCS_THREADS, and defaults to one thread per processor.
+ */
+class threadpool
+{
+ public:
+  static void setThreads (int);
+  static int  getThreads (void);
+  static int  threads (int);
+  static void share (int);
+  static void run (int, const std::function<void (int)> &);
+
+ private:
+  static int size;
+};
+
+} // namespace qucs
+
+#endif /* __THREADPOOL_H__ */
@@ -34,6 +34,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <cmath>
+#include <utility>
+#include <algorithm>
 
 #include "compat.h"
 #include "logging.h"
@@ -99,6 +101,7 @@ tmatrix<nr_type_t>::operator=(const tmatrix<nr_type_t> & m) {
     rows = m.rows;
     cols = m.cols;
     delete[] data;
+    data = NULL;
     if (rows > 0 && cols > 0) {
       data = new nr_type_t[rows * cols];
       memcpy (data, m.data, sizeof (nr_type_t) * rows * cols);
@@ -107,6 +110,30 @@ tmatrix<nr_type_t>::operator=(const tmatrix<nr_type_t> & m) {
   return *this;
 }
 
+/* The move constructor takes over the element storage of the given
+   temporary tmatrix object which is left empty. */
+template <class nr_type_t>
+tmatrix<nr_type_t>::tmatrix (tmatrix && m) {
+  rows = m.rows;
+  cols = m.cols;
+  data = m.data;
+  m.rows = m.cols = 0;
+  m.data = NULL;
+}
+
+/* The move assignment swaps the element storage with the given
+   temporary tmatrix object. */
+template <class nr_type_t>
+tmatrix<nr_type_t>&
+tmatrix<nr_type_t>::operator=(tmatrix<nr_type_t> && m) {
+  if (&m != this) {
+    std::swap (rows, m.rows);
+    std::swap (cols, m.cols);
+    std::swap (data, m.data);
+  }
+  return *this;
+}
+
 // Destructor deletes a tmatrix object.
 template <class nr_type_t>
 tmatrix<nr_type_t>::~tmatrix () {
@@ -115,7 +142,7 @@ tmatrix<nr_type_t>::~tmatrix () {
 
 // Returns the tmatrix element at the given row and column.
 template <class nr_type_t>
-nr_type_t tmatrix<nr_type_t>::get (int r, int c) {
+nr_type_t tmatrix<nr_type_t>::get (int r, int c) const {
   assert (r >= 0 && r < rows && c >= 0 && c < cols);
   return data[r * cols + c];
 }
@@ -177,12 +204,7 @@ void tmatrix<nr_type_t>::setCol (int c, tvector<nr_type_t> v) {
 template <class nr_type_t>
 void tmatrix<nr_type_t>::exchangeRows (int r1, int r2) {
   assert (r1 >= 0 && r2 >= 0 && r1 < rows && r2 < rows);
-  nr_type_t * s = new nr_type_t[cols];
-  int len = sizeof (nr_type_t) * cols;
-  memcpy (s, &data[r1 * cols], len);
-  memcpy (&data[r1 * cols], &data[r2 * cols], len);
-  memcpy (&data[r2 * cols], s, len);
-  delete[] s;
+  std::swap_ranges (&data[r1 * cols], &data[r1 * cols] + cols, &data[r2 * cols]);
 }
 
 // The function swaps the given columns with each other.
@@ -199,7 +221,7 @@ void tmatrix<nr_type_t>::exchangeCols (int c1, int c2) {
 
 // Compute inverse matrix of the given matrix by Gauss-Jordan elimination.
 template <class nr_type_t>
-tmatrix<nr_type_t> inverse (tmatrix<nr_type_t> a) {
+tmatrix<nr_type_t> inverse (const tmatrix<nr_type_t> & a) {
   nr_double_t MaxPivot;
   nr_type_t f;
   tmatrix<nr_type_t> b;
@@ -257,9 +279,9 @@ tmatrix<nr_type_t> teye (int n) {
 
 // Intrinsic matrix addition.
 template <class nr_type_t>
-tmatrix<nr_type_t> tmatrix<nr_type_t>::operator += (tmatrix<nr_type_t> a) {
+tmatrix<nr_type_t>& tmatrix<nr_type_t>::operator += (const tmatrix<nr_type_t> & a) {
   assert (a.getRows () == rows && a.getCols () == cols);
-  nr_type_t * src = a.getData ();
+  const nr_type_t * src = a.data;
   nr_type_t * dst = data;
   for (int i = 0; i < rows * cols; i++) *dst++ += *src++;
   return *this;
@@ -267,25 +289,35 @@ tmatrix<nr_type_t> tmatrix<nr_type_t>::operator += (tmatrix<nr_type_t> a) {
 
 // Intrinsic matrix substraction.
 template <class nr_type_t>
-tmatrix<nr_type_t> tmatrix<nr_type_t>::operator -= (tmatrix<nr_type_t> a) {
+tmatrix<nr_type_t>& tmatrix<nr_type_t>::operator -= (const tmatrix<nr_type_t> & a) {
   assert (a.getRows () == rows && a.getCols () == cols);
-  nr_type_t * src = a.getData ();
+  const nr_type_t * src = a.data;
   nr_type_t * dst = data;
   for (int i = 0; i < rows * cols; i++) *dst++ -= *src++;
   return *this;
 }
 
-// Matrix multiplication.
+/* Matrix multiplication.  The product is accumulated in blocks of
+   TMATRIX_BLOCK by TMATRIX_BLOCK elements of b, which stay in the cache
+   while all rows of a pass by.  The innermost loop runs along the rows
+   of b and the result and can be vectorized by the compiler. */
 template <class nr_type_t>
-tmatrix<nr_type_t> operator * (tmatrix<nr_type_t> a, tmatrix<nr_type_t> b) {
+tmatrix<nr_type_t> operator * (const tmatrix<nr_type_t> & a, const tmatrix<nr_type_t> & b) {
   assert (a.getCols () == b.getRows ());
-  int r, c, i, n = a.getCols ();
-  nr_type_t z;
-  tmatrix<nr_type_t> res (a.getRows (), b.getCols ());
-  for (r = 0; r < a.getRows (); r++) {
-    for (c = 0; c < b.getCols (); c++) {
-      for (i = 0, z = 0; i < n; i++) z += a.get (r, i) * b.get (i, c);
-      res.set (r, c, z);
+  int r, c, i, n = a.getCols (), m = b.getCols ();
+  tmatrix<nr_type_t> res (a.getRows (), m);
+  for (int ib = 0; ib < n; ib += TMATRIX_BLOCK) {
+    int ie = std::min (ib + TMATRIX_BLOCK, n);
+    for (int cb = 0; cb < m; cb += TMATRIX_BLOCK) {
+      int ce = std::min (cb + TMATRIX_BLOCK, m);
+      for (r = 0; r < a.getRows (); r++) {
+	nr_type_t * z = &res.data[r * m];
+	for (i = ib; i < ie; i++) {
+	  nr_type_t f = a.data[r * n + i];
+	  const nr_type_t * y = &b.data[i * m];
+	  for (c = cb; c < ce; c++) z[c] += f * y[c];
+	}
+      }
     }
   }
   return res;
@@ -293,7 +325,7 @@ tmatrix<nr_type_t> operator * (tmatrix<nr_type_t> a, tmatrix<nr_type_t> b) {
 
 // Multiplication of matrix and vector.
 template <class nr_type_t>
-tvector<nr_type_t> operator * (tmatrix<nr_type_t> a, tvector<nr_type_t> b) {
+tvector<nr_type_t> operator * (const tmatrix<nr_type_t> & a, const tvector<nr_type_t> & b) {
   assert (a.getCols () == b.size ());
   int r, c, n = a.getCols ();
   nr_type_t z;
@@ -308,7 +340,7 @@ tvector<nr_type_t> operator * (tmatrix<nr_type_t> a, tvector<nr_type_t> b) {
 
 // Multiplication of vector (transposed) and matrix.
 template <class nr_type_t>
-tvector<nr_type_t> operator * (tvector<nr_type_t> a, tmatrix<nr_type_t> b) {
+tvector<nr_type_t> operator * (const tvector<nr_type_t> & a, const tmatrix<nr_type_t> & b) {
   assert (a.size () == b.getRows ());
   int r, c, n = b.getRows ();
   nr_type_t z;
@@ -27,6 +27,11 @@
 
 #include <assert.h>
 
+/* Number of rows and columns the blocked matrix kernels work on at
+   once, chosen such that a block of complex values fits into the L1
+   cache. */
+#define TMATRIX_BLOCK 64
+
 namespace qucs {
 
 template <class nr_type_t>
@@ -34,15 +39,15 @@ class tmatrix;
 
 // Forward declarations of friend functions.
 template <class nr_type_t>
-tmatrix<nr_type_t> inverse (tmatrix<nr_type_t>);
+tmatrix<nr_type_t> inverse (const tmatrix<nr_type_t> &);
 template <class nr_type_t>
 tmatrix<nr_type_t> teye (int);
 template <class nr_type_t>
-tmatrix<nr_type_t> operator * (tmatrix<nr_type_t>, tmatrix<nr_type_t>);
+tmatrix<nr_type_t> operator * (const tmatrix<nr_type_t> &, const tmatrix<nr_type_t> &);
 template <class nr_type_t>
-tvector<nr_type_t> operator * (tmatrix<nr_type_t>, tvector<nr_type_t>);
+tvector<nr_type_t> operator * (const tmatrix<nr_type_t> &, const tvector<nr_type_t> &);
 template <class nr_type_t>
-tvector<nr_type_t> operator * (tvector<nr_type_t>, tmatrix<nr_type_t>);
+tvector<nr_type_t> operator * (const tvector<nr_type_t> &, const tmatrix<nr_type_t> &);
 
 template <class nr_type_t>
 class tmatrix
@@ -52,13 +57,15 @@ class tmatrix
   tmatrix (int);
   tmatrix (int, int);
   tmatrix (const tmatrix &);
+  tmatrix (tmatrix &&);
   const tmatrix& operator = (const tmatrix &);
+  tmatrix& operator = (tmatrix &&);
   ~tmatrix ();
-  nr_type_t get (int, int);
+  nr_type_t get (int, int) const;
   void set (int, int, nr_type_t);
   void set (nr_type_t);
-  int  getCols (void) { return cols; }
-  int  getRows (void) { return rows; }
+  int  getCols (void) const { return cols; }
+  int  getRows (void) const { return rows; }
   nr_type_t * getData (void) { return data; }
   tvector<nr_type_t> getRow (int);
   void setRow (int, tvector<nr_type_t>);
@@ -72,16 +79,16 @@ class tmatrix
 
   // some basic matrix operations
 #ifndef _MSC_VER
-  friend tmatrix inverse<> (tmatrix);
+  friend tmatrix inverse<> (const tmatrix &);
   friend tmatrix teye<nr_type_t> (int);
-  friend tmatrix operator *<> (tmatrix, tmatrix);
-  friend tvector<nr_type_t> operator *<> (tmatrix, tvector<nr_type_t>);
-  friend tvector<nr_type_t> operator *<> (tvector<nr_type_t>, tmatrix);
+  friend tmatrix operator *<> (const tmatrix &, const tmatrix &);
+  friend tvector<nr_type_t> operator *<> (const tmatrix &, const tvector<nr_type_t> &);
+  friend tvector<nr_type_t> operator *<> (const tvector<nr_type_t> &, const tmatrix &);
 #endif
 
   // intrinsic operators
-  tmatrix operator += (tmatrix);
-  tmatrix operator -= (tmatrix);
+  tmatrix& operator += (const tmatrix &);
+  tmatrix& operator -= (const tmatrix &);
 
   // easy accessor operators
   nr_type_t  operator () (int r, int c) const {
@@ -0,0 +1,210 @@
+/*
+ * tokenizer.cpp - fast line and field scanner implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "tokenizer.h"
+
+// Largest number of digits kept by the mantissa.
+#define TOKENIZER_DIGITS 19
+
+namespace qucs {
+
+// The powers of ten which are exact doubles.
+static const double tokenizer_pow10[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Constructor creates a tokenizer for the given contents.
+tokenizer::tokenizer (const char * contents, long size) {
+  data = contents;
+  end = contents + (size > 0 ? size : 0);
+  bol = eol = p = nol = data;
+  line = 0;
+}
+
+/* Moves the cursor to the beginning of the next line.  A carriage
+   return before the line feed does not belong to the line.  Returns
+   false at the end of the contents. */
+bool tokenizer::next (void) {
+  if (nol >= end) return false;
+  bol = p = nol;
+  if ((eol = (const char *) memchr (bol, '\n', end - bol)) == NULL)
+    nol = eol = end;
+  else
+    nol = eol + 1;
+  if (eol > bol && eol[-1] == '\r') eol--;
+  line++;
+  return true;
+}
+
+// Ends the current line at the given character, e.g. of a comment.
+void tokenizer::cut (char c) {
+  const char * e = (const char *) memchr (p, c, eol - p);
+  if (e != NULL) eol = e;
+}
+
+// Skips the given characters at the cursor.
+void tokenizer::skip (const char * chars) {
+  while (p < eol && *p && strchr (chars, *p)) p++;
+}
+
+/* Returns true if the cursor is at the end of the line or at one of
+   the given characters. */
+bool tokenizer::delimited (const char * chars) {
+  return p >= eol || (*p && strchr (chars, *p));
+}
+
+/* Reads the number at the cursor into the given value.  It has the
+   syntax of the scanners, i.e. an optional sign, the digits, the
+   optional fraction with at least one digit and the optional
+   exponent.  Unless TOKENIZER_LEADING is given the fraction may
+   start the number.  Returns false, leaving the cursor, if there is
+   no number.  The caller decides which characters may follow. */
+bool tokenizer::number (nr_double_t & val, int flags) {
+  const char * s = p;
+  unsigned long long m = 0;
+  int digits = 0, fraction = 0, kept = 0, exp = 0, e = 0;
+  bool negative = false, exact = true;
+
+  if (s < eol && (*s == '+' || *s == '-')) negative = *s++ == '-';
+  for (; s < eol && isdigit ((unsigned char) *s); s++, digits++) {
+    if (kept < TOKENIZER_DIGITS) {
+      m = m * 10 + (*s - '0');
+      if (m) kept++;
+    }
+    else {
+      exp++;
+      if (*s != '0') exact = false;
+    }
+  }
+  if (s < eol && *s == '.') {
+    if (!digits && (flags & TOKENIZER_LEADING)) return false;
+    for (s++; s < eol && isdigit ((unsigned char) *s); s++, fraction++) {
+      if (kept < TOKENIZER_DIGITS) {
+	m = m * 10 + (*s - '0');
+	if (m) kept++;
+	exp--;
+      }
+      else if (*s != '0') exact = false;
+    }
+    if (!fraction) return false;
+  }
+  else if (!digits) return false;
+  if (s < eol && (*s == 'e' || *s == 'E')) {
+    bool minus = false;
+    s++;
+    if (s < eol && (*s == '+' || *s == '-')) minus = *s++ == '-';
+    if (s == eol || !isdigit ((unsigned char) *s)) return false;
+    for (; s < eol && isdigit ((unsigned char) *s); s++)
+      if (e < 100000) e = e * 10 + (*s - '0');
+    exp += minus ? -e : e;
+  }
+
+  /* Mantissas and powers of ten which are exact doubles give the
+     correctly rounded value with a single operation, the others are
+     left to strtod(). */
+  if (exact && m <= (1ULL << 53) && exp >= -22 && exp <= 22) {
+    val = (nr_double_t) m;
+    if (exp < 0)
+      val /= tokenizer_pow10[-exp];
+    else
+      val *= tokenizer_pow10[exp];
+  }
+  else if (m == 0 && exact) {
+    val = 0;
+  }
+  else {
+    // the contents are not terminated after the number
+    std::string str (p, s - p);
+    val = strtod (str.c_str (), NULL);
+    negative = false;
+  }
+  if (negative) val = -val;
+  p = s;
+  return true;
+}
+
+/* Moves the cursor past the given text if the line continues with it.
+   Returns false otherwise. */
+bool tokenizer::literal (const char * text) {
+  size_t len = strlen (text);
+  if ((size_t) (eol - p) < len || memcmp (p, text, len)) return false;
+  p += len;
+  return true;
+}
+
+/* Moves the cursor past the given keyword if it starts the line.  The
+   keyword has to be followed by anything but the characters of
+   identifiers. */
+bool tokenizer::keyword (const char * text) {
+  if (p != bol || !literal (text)) return false;
+  if (p < eol && (isalnum ((unsigned char) *p) || *p == '_' || *p == '.')) {
+    p = bol;
+    return false;
+  }
+  return true;
+}
+
+/* Returns the number of letters, digits and of the given characters
+   at the cursor. */
+int tokenizer::span (const char * chars) {
+  const char * s = p;
+  while (s < eol && (isalnum ((unsigned char) *s) || (*s && strchr (chars, *s))))
+    s++;
+  return s - p;
+}
+
+// Returns the given number of characters at the cursor and moves on.
+std::string tokenizer::take (int n) {
+  std::string str (p, n);
+  p += n;
+  return str;
+}
+
+/* Moves the cursor to the next occurrence of the given character,
+   going through the following lines if necessary.  Returns false at
+   the end of the contents. */
+bool tokenizer::find (char c) {
+  for (;;) {
+    const char * s = (const char *) memchr (p, c, eol - p);
+    if (s != NULL) {
+      p = s;
+      return true;
+    }
+    if (!next ()) {
+      p = eol;
+      return false;
+    }
+  }
+}
+
+} // namespace qucs
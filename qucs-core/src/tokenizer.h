@@ -0,0 +1,77 @@
+/*
+ * tokenizer.h - fast line and field scanner definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __TOKENIZER_H__
+#define __TOKENIZER_H__
+
+#include <string>
+
+// Syntax flags of tokenizer::number().
+#define TOKENIZER_LEADING 1 // a digit has to precede the decimal point
+
+namespace qucs {
+
+/*! \class tokenizer
+ * \brief line by line scanner of the data file contents.
+ *
+ * The fast readers of the data file importers go through the contents
+ * of a file once with it instead of the flex scanners.  The cursor
+ * moves along the current line, it never runs beyond its end without
+ * being told to.  Numbers have the syntax of the scanners and are
+ * converted in place, most of them without strtod().  Nothing is
+ * allocated unless asked for.
+ */
+class tokenizer
+{
+ public:
+  tokenizer (const char *, long);
+  bool next (void);
+  void cut (char);
+  int  getLine (void) { return line; }
+  const char * getCursor (void) { return p; }
+  const char * getBegin (void) { return bol; }
+  const char * getEnd (void) { return eol; }
+  bool atEnd (void) { return p >= eol; }
+  bool atBegin (void) { return p == bol; }
+  void advance (int n) { p += n; }
+  void skip (const char * = " \t");
+  bool delimited (const char *);
+  bool number (nr_double_t &, int flags = 0);
+  bool literal (const char *);
+  bool keyword (const char *);
+  int  span (const char *);
+  std::string take (int);
+  bool find (char);
+
+ private:
+  const char * data, * end; // the contents
+  const char * bol, * eol;  // beginning and end of the current line
+  const char * p;           // the cursor
+  const char * nol;         // beginning of the next line
+  int line;
+};
+
+} // namespace qucs
+
+#endif /* __TOKENIZER_H__ */
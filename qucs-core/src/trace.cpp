@@ -0,0 +1,133 @@
+/*
+ * trace.cpp - hot path trace scope implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "logging.h"
+#include "trace.h"
+
+namespace qucs {
+
+typedef std::chrono::steady_clock traceclock;
+
+// one complete event, times in microseconds since the start
+struct traceevent_t {
+  const char * name;
+  double ts, dur;
+};
+
+// events of one thread
+struct tracebuffer_t {
+  int tid;
+  std::vector<traceevent_t> events;
+};
+
+bool trace::active = false;
+
+static std::string tracefile;
+static traceclock::time_point origin;
+static trace_hook_t beginhook = NULL, endhook = NULL;
+
+// the buffers outlive their threads until written
+static std::mutex bufferlock;
+static std::vector<tracebuffer_t *> buffers;
+
+static tracebuffer_t * buffer (void) {
+  static thread_local tracebuffer_t * own = NULL;
+  if (own == NULL) {
+    own = new tracebuffer_t ();
+    std::lock_guard<std::mutex> lock (bufferlock);
+    own->tid = (int) buffers.size () + 1;
+    own->events.reserve (4096);
+    buffers.push_back (own);
+  }
+  return own;
+}
+
+/* Starts recording into the given file, a NULL or empty file name
+   records for the hooks only. */
+void trace::start (const char * file) {
+  tracefile = file ? file : "";
+  origin = traceclock::now ();
+  active = !tracefile.empty () || beginhook || endhook;
+}
+
+/* Passes each scope to the given functions as well. */
+void trace::hook (trace_hook_t begin, trace_hook_t end) {
+  beginhook = begin;
+  endhook = end;
+  active = !tracefile.empty () || beginhook || endhook;
+}
+
+void trace::scope::begin (void) {
+  if (beginhook) beginhook (name);
+  at = traceclock::now ();
+}
+
+void trace::scope::end (void) {
+  traceclock::time_point now = traceclock::now ();
+  if (endhook) endhook (name);
+  if (tracefile.empty ()) return;
+  typedef std::chrono::duration<double, std::micro> us;
+  traceevent_t e;
+  e.name = name;
+  e.ts = us (at - origin).count ();
+  e.dur = us (now - at).count ();
+  buffer ()->events.push_back (e);
+}
+
+/* Writes the recorded events, must be called when no other thread is
+   tracing anymore.  Returns zero on success. */
+int trace::write (void) {
+  if (tracefile.empty ()) return 0;
+
+  FILE * f = fopen (tracefile.c_str (), "w");
+  if (f == NULL) {
+    logprint (LOG_ERROR, "cannot create file `%s'\n", tracefile.c_str ());
+    return -1;
+  }
+  fprintf (f, "{\"traceEvents\":[\n");
+  int n = 0;
+  for (tracebuffer_t * b : buffers) {
+    fprintf (f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+	     "\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}", n++ ? ",\n" : "",
+	     b->tid, b->tid == 1 ? "main" : "worker", b->tid);
+    for (traceevent_t & e : b->events)
+      fprintf (f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+	       "\"ts\":%.3f,\"dur\":%.3f}", e.name, b->tid, e.ts, e.dur);
+    b->events.clear ();
+  }
+  fprintf (f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+  fclose (f);
+  return 0;
+}
+
+} // namespace qucs
@@ -0,0 +1,87 @@
+/*
+ * trace.h - hot path trace scope definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <chrono>
+
+namespace qucs {
+
+// external profiler receiving the scopes (Tracy, ETW, ITT etc.)
+typedef void (* trace_hook_t) (const char *);
+
+/*! \class trace
+ * \brief timeline of the hot loops in Chrome trace format.
+ *
+ * The scopes are compiled in by ENABLE_TRACE (configure --enable-trace,
+ * cmake -DENABLE_TRACE=ON) only and cost a flag test each unless
+ * tracing is started.  Each thread records its scopes into a buffer of
+ * its own, the buffers are written at the end of the run into a JSON
+ * file loadable by chrome://tracing or Perfetto.  Instead of or in
+ * addition to the file the scopes can be passed to the begin and end
+ * hooks of an external profiler.
+ */
+class trace
+{
+ public:
+  static void start (const char *);
+  static void hook (trace_hook_t begin, trace_hook_t end);
+  static bool enabled (void) { return active; }
+  static int write (void);
+
+  /* Records its lifetime as a complete event of the given name, which
+     must be a string literal. */
+  class scope
+  {
+  public:
+    scope (const char * n) : name (n) {
+      if (active) begin ();
+    }
+    ~scope () {
+      if (active) end ();
+    }
+  private:
+    void begin (void);
+    void end (void);
+    const char * name;
+    std::chrono::steady_clock::time_point at;
+  };
+
+ private:
+  static bool active;
+};
+
+} // namespace qucs
+
+#if ENABLE_TRACE
+# define TRACE_CONCAT_(a, b) a##b
+# define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+# define TRACE_SCOPE(name) \
+  qucs::trace::scope TRACE_CONCAT(__trace, __LINE__) (name)
+#else
+# define TRACE_SCOPE(name)
+#endif
+
+#endif /* __TRACE_H__ */
@@ -42,9 +42,6 @@
 #define COEFFDEBUG 0
 #define FIXEDCOEFF 0
 
-// Defines where the equivalent admittance coefficient is going to be stored.
-#define COEFF_G 0
-
 namespace qucs {
 
 using namespace transient;
@@ -243,87 +240,10 @@ void transient::calcPredictorCoeff (int Method, int order,
   }
 }
 
-// Loads the equivalent conductance.
-void transient::getConductance (integrator * c, nr_double_t cap,
-				nr_double_t& geq) {
-  nr_double_t * coeff = c->getCoefficients ();
-  geq = cap * coeff[COEFF_G];
-}
-
-// This is the implicit Euler integrator.
-void transient::integrateEuler (integrator * c, int qstate, nr_double_t cap,
-				nr_double_t& geq, nr_double_t& ceq) {
-  nr_double_t * coeff = c->getCoefficients ();
-  int cstate = qstate + 1;
-  nr_double_t cur;
-  geq = cap * coeff[COEFF_G];
-  ceq = c->getState (qstate, 1) * coeff[1];
-  cur = c->getState (qstate) * coeff[COEFF_G] + ceq;
-  c->setState (cstate, cur);
-}
-
-// Trapezoidal integrator.
-void transient::integrateBilinear (integrator * c, int qstate, nr_double_t cap,
-				   nr_double_t& geq, nr_double_t& ceq) {
-  nr_double_t * coeff = c->getCoefficients ();
-  int cstate = qstate + 1;
-  nr_double_t cur;
-  geq = cap * coeff[COEFF_G];
-  ceq = c->getState (qstate, 1) * coeff[1] - c->getState (cstate, 1);
-  cur = c->getState (qstate) * coeff[COEFF_G] + ceq;
-  c->setState (cstate, cur);
-}
-
-// Integrator using the Gear coefficients.
-void transient::integrateGear (integrator * c, int qstate, nr_double_t cap,
-			       nr_double_t& geq, nr_double_t& ceq) {
-  nr_double_t * coeff = c->getCoefficients ();
-  int i, cstate = qstate + 1;
-  nr_double_t cur;
-  geq = cap * coeff[COEFF_G];
-  for (ceq = 0, i = 1; i <= c->getOrder (); i++) {
-    ceq += c->getState (qstate, i) * coeff[i];
-  }
-  cur = c->getState (qstate) * coeff[COEFF_G] + ceq;
-  c->setState (cstate, cur);
-}
-
-// Integrator using the Adams-Moulton coefficients.
-void transient::integrateMoulton (integrator * c, int qstate, nr_double_t cap,
-				  nr_double_t& geq, nr_double_t& ceq) {
-  nr_double_t * coeff = c->getCoefficients ();
-  int i, cstate = qstate + 1;
-  nr_double_t cur;
-  geq = cap * coeff[COEFF_G];
-  ceq = c->getState (qstate, 1) * coeff[1];
-  for (i = 2; i <= c->getOrder (); i++) {
-    ceq += c->getState (cstate, i - 1) * coeff[i];
-  }
-  cur = c->getState (qstate) * coeff[COEFF_G] + ceq;
-  c->setState (cstate, cur);
-}
-
-/* The function applies the appropriate integration function to the
-   given circuit object. */
+/* The function applies the appropriate integration method to the
+   given circuit object, selecting its integration kernel. */
 void transient::setIntegrationMethod (circuit * c, int Method) {
-  switch (Method) {
-  case INTEGRATOR_GEAR:
-    c->setIntegration (integrateGear);
-    break;
-  case INTEGRATOR_TRAPEZOIDAL:
-    c->setIntegration (integrateBilinear);
-    break;
-  case INTEGRATOR_EULER:
-    c->setIntegration (integrateEuler);
-    break;
-  case INTEGRATOR_ADAMSMOULTON:
-    c->setIntegration (integrateMoulton);
-    break;
-  default:
-    c->setIntegration (NULL);
-    break;
-  }
-  c->setConductance (getConductance);
+  c->setIntegration (Method);
 }
 
 /* Returns an appropriate integrator type identifier and the maximum
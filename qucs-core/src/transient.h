@@ -43,15 +43,6 @@ namespace transient {
 
   void calcCorrectorCoeff (int, int, nr_double_t *, nr_double_t *);
   void calcPredictorCoeff (int, int, nr_double_t *, nr_double_t *);
-  void getConductance (integrator *, nr_double_t, nr_double_t&);
-  void integrateEuler (integrator *, int, nr_double_t, nr_double_t&,
-		       nr_double_t&);
-  void integrateBilinear (integrator *, int, nr_double_t, nr_double_t&,
-			  nr_double_t&);
-  void integrateGear (integrator *, int, nr_double_t, nr_double_t&,
-		      nr_double_t&);
-  void integrateMoulton (integrator *, int, nr_double_t, nr_double_t&,
-			 nr_double_t&);
   void setIntegrationMethod (circuit *, int);
   int  correctorType (const char * const, int&);
   int  correctorType (int, int);
@@ -30,6 +30,8 @@
 #include <string.h>
 #include <float.h>
 #include <algorithm>
+#include <map>
+#include <set>
 
 #include "compat.h"
 #include "object.h"
@@ -43,12 +45,21 @@
 #include "nasolver.h"
 #include "history.h"
 #include "trsolver.h"
+#include "reducer.h"
+#include "checkpoint.h"
 #include "transient.h"
 #include "exception.h"
 #include "exceptionstack.h"
+#include "profile.h"
+#include "trace.h"
+#include "opcache.h"
+#include "components/component_id.h"
+#include "components/vdc.h"
 
 #define STEPDEBUG   0 // set to zero for release
 #define BREAKPOINTS 0 // exact breakpoint calculation
+#define TR_HISTORY_MAX 65536 // initial history size limit
+#define TR_DIGITAL_MAX 16 // initial DC analyses for the logic states
 
 #define dState 0 // delta T state
 #define sState 1 // solution state
@@ -71,6 +82,15 @@ trsolver::trsolver ()
     tHistory = NULL;
     relaxTSR = false;
     initialDC = true;
+    mixed = false;
+    multirate = false;
+    block = -1;
+    breakNext = 0;
+    startSolution = NULL;
+    recording = true;
+    interpolate = false;
+    stepCount = 0;
+    stepBreak = false;
 }
 
 // Constructor creates a named instance of the trsolver class.
@@ -84,6 +104,15 @@ trsolver::trsolver (const std::string &n)
     tHistory = NULL;
     relaxTSR = false;
     initialDC = true;
+    mixed = false;
+    multirate = false;
+    block = -1;
+    breakNext = 0;
+    startSolution = NULL;
+    recording = true;
+    interpolate = false;
+    stepCount = 0;
+    stepBreak = false;
 }
 
 // Destructor deletes the trsolver class object.
@@ -110,6 +139,15 @@ trsolver::trsolver (trsolver & o)
     tHistory = o.tHistory ? new history (*o.tHistory) : NULL;
     relaxTSR = o.relaxTSR;
     initialDC = o.initialDC;
+    mixed = o.mixed;
+    multirate = o.multirate;
+    block = -1;
+    breakNext = 0;
+    startSolution = NULL;
+    recording = o.recording;
+    interpolate = o.interpolate;
+    stepCount = 0;
+    stepBreak = false;
 }
 
 // This function creates the time sweep if necessary.
@@ -117,6 +155,7 @@ void trsolver::initSteps (void)
 {
     delete swp;
     swp = createSweep ("time");
+    setResultPoints (swp->getSize ());
 }
 
 // Performs the initial DC analysis.
@@ -129,7 +168,12 @@ int trsolver::dcAnalysis (void)
     initDC ();
     setCalculation ((calculate_func_t) &calcDC);
     solve_pre ();
+    if (mixed) indexDigital ();
     applyNodeset ();
+    // start at the operating point of the DC analysis if there is one,
+    // the logic gates of mixed circuits are taken out however
+    const nasolution<nr_double_t> * op = mixed ? NULL : opcache::find ();
+    if (op != NULL) applySolution (*op);
 
     // Run the DC solver once.
     try_running ()
@@ -156,6 +200,8 @@ int trsolver::dcAnalysis (void)
 
     // Save the DC solution.
     storeSolution ();
+    if (!error && !mixed) opcache::store (nasolver<nr_double_t>::solution);
+    if (mixed) sampleDigital ();
 
     // Cleanup nodal analysis solver.
     solve_post ();
@@ -178,6 +224,21 @@ int trsolver::solve (void)
     const char * const solver = getPropertyString ("Solver");
     relaxTSR = !strcmp (getPropertyString ("relaxTSR"), "yes") ? true : false;
     initialDC = !strcmp (getPropertyString ("initialDC"), "yes") ? true : false;
+    mixed = !strcmp (getPropertyString ("MixedSignal"), "yes") ? true : false;
+    multirate = !strcmp (getPropertyString ("Multirate"), "yes") ? true : false;
+    interpolate = !strcmp (getPropertyString ("Interpolate"), "yes") ? true : false;
+    // Decoupled blocks merge their results at the same output times.
+    if (block >= 0) interpolate = false;
+
+    // Replace large linear subcircuits by reduced models, once for all
+    // the blocks.
+    reducer mor (subnet, getName ());
+    if (!strcmp (getPropertyString ("Reduce"), "yes") && block < 0)
+        mor.reduce ();
+
+    // Solve decoupled subcircuits separately with their own time steps.
+    if (multirate && !mixed && block < 0 && splitBlocks () > 1)
+        return solveBlocks ();
 
     runs++;
     saveCurrent = current = 0;
@@ -197,13 +258,47 @@ int trsolver::solve (void)
         eqnAlgo = ALGO_QR_DECOMPOSITION_LS;
     else if (!strcmp (solver, "GolubSVD"))
         eqnAlgo = ALGO_SV_DECOMPOSITION;
+    else if (!strcmp (solver, "SparseLU"))
+        eqnAlgo = ALGO_LU_DECOMPOSITION_SPARSE;
+    else if (!strcmp (solver, "BiCGStab"))
+        eqnAlgo = ALGO_BICGSTAB;
+    else if (!strcmp (solver, "GMRES"))
+        eqnAlgo = ALGO_GMRES;
+
+    // Take the logic gates out of the netlist.
+    if (mixed && initDigital ())
+    {
+        deinitDigital ();
+        return -1;
+    }
 
-    // Perform initial DC analysis.
-    if (initialDC)
+    /* Perform initial DC analysis, until it agrees with the logic states.
+       It is not needed if the start solution is given. */
+    if (initialDC && startSolution == NULL)
     {
-        error = dcAnalysis ();
-        if (error)
-            return -1;
+        for (int n = 0;; n++)
+        {
+            error = dcAnalysis ();
+            if (error)
+            {
+                deinitDigital ();
+                return -1;
+            }
+            if (!mixed || !(error = settleDigital ()))
+                break;
+            if (error < 0)
+            {
+                deinitDigital ();
+                return -1;
+            }
+            if (n == TR_DIGITAL_MAX)
+            {
+                logprint (LOG_ERROR, "WARNING: %s: no consistent initial logic "
+                          "state\n", getName ());
+                break;
+            }
+        }
+        error = 0;
     }
 
     // Initialize transient analysis.
@@ -211,16 +306,30 @@ int trsolver::solve (void)
     initTR ();
     setCalculation ((calculate_func_t) &calcTR);
     solve_pre ();
+    if (mixed) indexDigital ();
 
     // Create time sweep if necessary.
     initSteps ();
     swp->reset ();
+    nr_double_t stopTime = swp->get (swp->getSize () - 1);
+    stepCount = 0;
+    stepBreak = false;
 
     // Recall the DC solution.
     recallSolution ();
 
-    // Apply the nodesets and adjust previous solutions.
-    applyNodeset (false);
+    // Apply the start solution or the nodesets and adjust previous solutions.
+    if (startSolution != NULL)
+    {
+        *x = *startSolution;
+        *xprev = *x;
+        saveSolution ();
+        restartNR ();
+    }
+    else
+    {
+        applyNodeset (false);
+    }
     fillSolution (x);
 
     // Tell integrators to be initialized.
@@ -232,8 +341,31 @@ int trsolver::solve (void)
     fillState (dState, delta);
     adjustOrder (1);
 
+    // Continue from the checkpoint of a previous run if requested.
+    checkpoint cp (getName ());
+    bool checkpointing = canCheckpoint ();
+    int first = 0;
+    if (checkpointing && checkpoint::resumes ())
+    {
+        error = loadCheckpoint (cp, first, running, saveCurrent, convError);
+        if (error < -1)
+        {
+            logprint (LOG_ERROR, "ERROR: %s: broken checkpoint, remove it "
+                      "to start over\n", getName ());
+            deinitTR ();
+            return -1;
+        }
+        if (error == 0)
+        {
+            for (int i = 0; i < first; i++) swp->next ();
+            logprint (LOG_STATUS, "NOTIFY: %s: resuming at t = %g\n",
+                      getName (), (double) saveCurrent);
+        }
+        error = 0;
+    }
+
     // Start to sweep through time.
-    for (int i = 0; i < swp->getSize (); i++)
+    for (int i = first; i < swp->getSize (); i++)
     {
         time = swp->next ();
         if (progress) logprogressbar (i, swp->getSize (), 40);
@@ -243,6 +375,8 @@ int trsolver::solve (void)
                   getName (), (double) time);
 #endif
 
+        // Interpolating steps may already have passed the time point.
+        if (!interpolate || running <= 1 || saveCurrent < time)
         do // while (saveCurrent < time), i.e. until a requested breakpoint is hit
         {
 #if STEPDEBUG
@@ -276,7 +410,12 @@ int trsolver::solve (void)
             // process until a certain error tolerance has been reached.
             try_running () // #defined as:    do {
             {
-                error += corrector ();
+                // A given start solution is the one at time zero, the
+                // integrators are merely initialized from it.
+                if (startSolution != NULL && running == 0)
+                    calculate ();
+                else
+                    error += corrector ();
             }
             catch_exception () // #defined as:   } while (0); if (estack.top ()) switch (estack.top()->getCode ())
             {
@@ -300,6 +439,7 @@ int trsolver::solve (void)
                 // Update statistics.
                 statRejected++;
                 statConvergence++;
+                profile::count (PROFILE_REJECTED);
                 rejected++; // mark the previous step size choice as rejected
                 converged = 0;
                 error = 0;
@@ -319,17 +459,22 @@ int trsolver::solve (void)
                 break;
             }
             // return if any errors occured other than convergence failure
-            if (error) return -1;
+            if (error)
+            {
+                deinitDigital ();
+                return -1;
+            }
 
             // if the step was rejected, the solution loop is restarted here
             if (rejected) continue;
 
             // check whether Jacobian matrix is still non-singular
-            if (!A->isFinite ())
+            if (!isFiniteMatrix ())
             {
                 logprint (LOG_ERROR, "ERROR: %s: Jacobian singular at t = %.3e, "
                           "aborting %s analysis\n", getName (), (double) current,
                           getDescription ().c_str());
+                deinitDigital ();
                 return -1;
             }
 
@@ -340,7 +485,8 @@ int trsolver::solve (void)
             // Now advance in time or not...
             if (running > 1)
             {
-                adjustDelta (time);
+                adjustDelta (std::min (interpolate ? stopTime : time,
+                                       nextBreakpoint ()));
                 adjustOrder ();
             }
             else
@@ -355,6 +501,28 @@ int trsolver::solve (void)
             running++;
             converged++;
 
+            // Let the logic gates follow the accepted solution.
+            if (mixed && !rejected && updateDigital (saveCurrent))
+            {
+                deinitDigital ();
+                return -1;
+            }
+
+            /* Restart with small steps behind source edges, the step size
+               estimated before the edge is meaningless. */
+            bool passed = !rejected && passBreakpoints (saveCurrent);
+            if (interpolate && !rejected) recordStep (saveCurrent, passed);
+            if (passed)
+            {
+                nr_double_t h = (nextBreakpoint () - saveCurrent) / 10;
+                if (delta > h)
+                {
+                    delta = std::max (h, deltaMin);
+                    current = saveCurrent + delta;
+                    stepDelta = -1;
+                }
+            }
+
             // Tell integrators to be running.
             setMode (MODE_NONE);
 
@@ -376,50 +544,77 @@ int trsolver::solve (void)
                   (double) saveCurrent, (double) delta);
 #endif
 
+        if (recording)
+        {
 #if BREAKPOINTS
-        saveAllResults (saveCurrent);
+            saveAllResults (saveCurrent);
 #else
-        saveAllResults (time);
+            if (interpolate)
+                saveInterpolated (time);
+            else
+                saveAllResults (time);
 #endif
+        }
+
+        // Keep the state for a later run to continue from.
+        if (checkpointing && i + 1 < swp->getSize () && cp.due ())
+            saveCheckpoint (cp, i + 1, running, saveCurrent, convError);
     } // for (int i = 0; i < swp->getSize (); i++)
+    if (checkpointing) cp.remove ();
 
     solve_post ();
     if (progress) logprogressclear (40);
-    logprint (LOG_STATUS, "NOTIFY: %s: average time-step %g, %d rejections\n",
-              getName (), (double) (saveCurrent / statSteps), statRejected);
-    logprint (LOG_STATUS, "NOTIFY: %s: average NR-iterations %g, "
-              "%d non-convergences\n", getName (),
-              (double) statIterations / statSteps, statConvergence);
+    if (recording)
+    {
+        logprint (LOG_STATUS, "NOTIFY: %s: average time-step %g, %d rejections\n",
+                  getName (), (double) (saveCurrent / statSteps), statRejected);
+        logprint (LOG_STATUS, "NOTIFY: %s: average NR-iterations %g, "
+                  "%d non-convergences\n", getName (),
+                  (double) statIterations / statSteps, statConvergence);
+    }
 
     // cleanup
     deinitTR ();
+    deinitDigital ();
     return 0;
 }
 
 // The function initializes the history.
 void trsolver::initHistory (nr_double_t t)
 {
-    // initialize time vector
+    // find maximum required age for all circuits
+    nr_double_t age = 0.0;
+    circuit * root = subnet->getRoot ();
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        if (c->hasHistory () && c->getHistoryAge () > age)
+        {
+            age = c->getHistoryAge ();
+        }
+    }
+    // initialize time vector, sized for the expected number of steps
     tHistory = new history ();
+    tHistory->reserve (historySize (age));
     tHistory->push_back(t);
     tHistory->self ();
+    tHistory->setAge (age);
     // initialize circuit histories
-    nr_double_t age = 0.0;
-    circuit * root = subnet->getRoot ();
     for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
     {
         if (c->hasHistory ())
         {
             c->applyHistory (tHistory);
             saveHistory (c);
-            if (c->getHistoryAge () > age)
-            {
-                age = c->getHistoryAge ();
-            }
         }
     }
-    // set maximum required age for all circuits
-    tHistory->setAge (age);
+}
+
+/* Estimates the number of time steps the history must hold to cover
+   the given age.  The buffers still grow if the steps get smaller. */
+int trsolver::historySize (nr_double_t age)
+{
+    nr_double_t n = age / std::max (delta, deltaMin);
+    return (int) std::min (n, (nr_double_t) TR_HISTORY_MAX) + 4;
 }
 
 /* The following function updates the histories for the circuits which
@@ -488,13 +683,20 @@ int trsolver::predictor (void)
         break;
     default:
         *x = *SOL (1);  // This is too a simple predictor...
+        *SOL (0) = *x;
         break;
     }
     saveSolution ();
-    *SOL (0) = *x;
     return error;
 }
 
+/* The function fills the given array with the data of the solution
+   vectors, the current one first. */
+void trsolver::solutionData (nr_double_t ** s)
+{
+    for (int o = 0; o < 8; o++) s[o] = SOL(o)->getData ();
+}
+
 // Stores the given vector into all the solution vectors.
 void trsolver::fillSolution (tvector<nr_double_t> * s)
 {
@@ -502,25 +704,32 @@ void trsolver::fillSolution (tvector<nr_double_t> * s)
 }
 
 /* The function predicts the successive solution vector using the
-   explicit Adams-Bashford integration formula. */
+   explicit Adams-Bashford integration formula.  The prediction is
+   saved into the current solution as well.  This and the other
+   predictors run once through the unknowns, with the solution vectors
+   and previous time-steps looked up before. */
 void trsolver::predictBashford (void)
 {
     int N = countNodes ();
     int M = countVoltageSources ();
-    nr_double_t xn, dd, hn;
+    nr_double_t xn, dd, * s[8], hn[8];
+    nr_double_t * p = x->getData ();
+
+    solutionData (s);
+    for (int o = 1; o <= predOrder; o++)
+        hn[o] = getState (dState, o);          // previous time-step
 
     // go through each solution
     for (int r = 0; r < N + M; r++)
     {
-        xn = predCoeff[0] * SOL(1)->get (r); // a0 coefficient
+        xn = predCoeff[0] * s[1][r];         // a0 coefficient
         for (int o = 1; o <= predOrder; o++)
         {
-            hn = getState (dState, o);         // previous time-step
             // divided differences
-            dd = (SOL(o)->get (r) - SOL(o + 1)->get (r)) / hn;
+            dd = (s[o][r] - s[o + 1][r]) / hn[o];
             xn += predCoeff[o] * dd;           // b0, b1, ... coefficients
         }
-        x->set (r, xn);                      // save prediction
+        p[r] = s[0][r] = xn;                 // save prediction
     }
 }
 
@@ -531,15 +740,17 @@ void trsolver::predictEuler (void)
 {
     int N = countNodes ();
     int M = countVoltageSources ();
-    nr_double_t xn, dd, hn;
+    nr_double_t xn, dd, * s[8];
+    nr_double_t * p = x->getData ();
+    nr_double_t hn = getState (dState, 1);
 
+    solutionData (s);
     for (int r = 0; r < N + M; r++)
     {
-        xn = predCoeff[0] * SOL(1)->get (r);
-        hn = getState (dState, 1);
-        dd = (SOL(1)->get (r) - SOL(2)->get (r)) / hn;
+        xn = predCoeff[0] * s[1][r];
+        dd = (s[1][r] - s[2][r]) / hn;
         xn += predCoeff[1] * dd;
-        x->set (r, xn);
+        p[r] = s[0][r] = xn;
     }
 }
 
@@ -549,8 +760,10 @@ void trsolver::predictGear (void)
 {
     int N = countNodes ();
     int M = countVoltageSources ();
-    nr_double_t xn;
+    nr_double_t xn, * s[8];
+    nr_double_t * p = x->getData ();
 
+    solutionData (s);
     // go through each solution
     for (int r = 0; r < N + M; r++)
     {
@@ -558,9 +771,9 @@ void trsolver::predictGear (void)
         for (int o = 0; o <= predOrder; o++)
         {
             // a0, a1, ... coefficients
-            xn += predCoeff[o] * SOL(o + 1)->get (r);
+            xn += predCoeff[o] * s[o + 1][r];
         }
-        x->set (r, xn); // save prediction
+        p[r] = s[0][r] = xn; // save prediction
     }
 }
 
@@ -568,6 +781,7 @@ void trsolver::predictGear (void)
    process until a certain error tolerance has been reached. */
 int trsolver::corrector (void)
 {
+    TRACE_SCOPE ("trsolver::corrector");
     int error = 0;
     error += solve_nonlinear ();
     return error;
@@ -582,6 +796,7 @@ void trsolver::nextStates (void)
         // for each circuit get the next state
         c->nextState ();
     }
+    pool.nextState ();
 
     *SOL (0) = *x; // save current solution
     nextState ();
@@ -597,9 +812,11 @@ void trsolver::fillStates (void)
     circuit * root = subnet->getRoot ();
     for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
     {
+        if (c->isPooled ()) continue;
         for (int s = 0; s < c->getStates (); s++)
             c->fillState (s, c->getState (s));
     }
+    pool.fillStates ();
 }
 
 // The function modifies the circuit lists integrator mode.
@@ -627,6 +844,10 @@ void trsolver::adjustDelta (nr_double_t t)
     if (delta > deltaMax) delta = deltaMax;
     if (delta < deltaMin) delta = deltaMin;
 
+    /* The truncation error decides about the current step, shorter
+       steps in order to hit a breakpoint do not reject it. */
+    nr_double_t lte = delta;
+
     // delta correction in order to hit exact breakpoint
     int good = 0;
     if (!relaxTSR)   // relaxed step raster?
@@ -636,8 +857,8 @@ void trsolver::adjustDelta (nr_double_t t)
             // check next breakpoint
             if (stepDelta > 0.0)
             {
-                // restore last valid delta
-                delta = stepDelta;
+                // restore last valid delta unless the error requires less
+                delta = std::min (delta, stepDelta);
                 stepDelta = -1.0;
             }
             else
@@ -674,7 +895,7 @@ void trsolver::adjustDelta (nr_double_t t)
     }
 
     // usual delta correction
-    if (delta > 0.9 * deltaOld || good)   // accept current delta
+    if (lte > 0.9 * deltaOld || good)   // accept current delta
     {
         nextStates ();
         rejected = 0;
@@ -688,6 +909,7 @@ void trsolver::adjustDelta (nr_double_t t)
     {
         rejected++;
         statRejected++;
+        profile::count (PROFILE_REJECTED);
 #if STEPDEBUG
         logprint (LOG_STATUS,
                   "DEBUG: delta rejected at t = %.3e, h = %.3e\n",
@@ -702,6 +924,68 @@ void trsolver::adjustDelta (nr_double_t t)
     }
 }
 
+/* Keeps the solution of the step accepted at the given time for the
+   interpolation of the results.  A step passing a breakpoint ends the
+   piece of the waveform the following steps are interpolated on. */
+void trsolver::recordStep (nr_double_t t, bool passed)
+{
+    if (stepBreak)
+    {
+        stepTimes[0] = stepTimes[stepCount - 1];
+        stepSolutions[0] = stepSolutions[stepCount - 1];
+        stepCount = 1;
+    }
+    if (stepCount == 3)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            stepTimes[i] = stepTimes[i + 1];
+            std::swap (stepSolutions[i], stepSolutions[i + 1]);
+        }
+        stepCount = 2;
+    }
+    stepTimes[stepCount] = t;
+    stepSolutions[stepCount] = *x;
+    stepCount++;
+    stepBreak = passed;
+}
+
+/* Saves the results at the given time interpolated through the last
+   accepted steps, quadratically if there are three of them.  The
+   solution is put into the circuits for the probes and restored
+   afterwards. */
+void trsolver::saveInterpolated (nr_double_t t)
+{
+    if (stepCount < 2)
+    {
+        saveAllResults (t);
+        return;
+    }
+    nr_double_t w[3];
+    for (int i = 0; i < stepCount; i++)
+    {
+        w[i] = 1;
+        for (int k = 0; k < stepCount; k++)
+        {
+            if (k == i) continue;
+            w[i] *= (t - stepTimes[k]) / (stepTimes[i] - stepTimes[k]);
+        }
+    }
+    tvector<nr_double_t> xs = *x;
+    nr_double_t * p = x->getData ();
+    for (std::size_t r = 0; r < x->size (); r++)
+    {
+        nr_double_t v = 0;
+        for (int i = 0; i < stepCount; i++)
+            v += w[i] * stepSolutions[i].get (r);
+        p[r] = v;
+    }
+    saveSolution ();
+    saveAllResults (t);
+    *x = xs;
+    saveSolution ();
+}
+
 /* The function can be used to increase the current order of the
    integration method or to reduce it. */
 void trsolver::adjustOrder (int reduce)
@@ -735,22 +1019,28 @@ void trsolver::adjustOrder (int reduce)
    function. */
 void trsolver::calcDC (trsolver * self)
 {
-    circuit * root = self->getNet()->getRoot ();
-    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
-    {
-        c->calcDC ();
-    }
+    TRACE_SCOPE ("circuit::calcDC");
+    self->evaluate (&calcCircuitDC);
+}
+
+// Runs the calcDC() function of a single circuit object.
+void trsolver::calcCircuitDC (circuit * c, nasolver<nr_double_t> *)
+{
+    c->calcDC ();
 }
 
 /* Goes through the list of circuit objects and runs its calcTR()
    function. */
 void trsolver::calcTR (trsolver * self)
 {
-    circuit * root = self->getNet()->getRoot ();
-    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
-    {
-        c->calcTR (self->current);
-    }
+    TRACE_SCOPE ("circuit::calcTR");
+    self->evaluate (&calcCircuitTR);
+}
+
+// Runs the calcTR() function of a single circuit object.
+void trsolver::calcCircuitTR (circuit * c, nasolver<nr_double_t> * self)
+{
+    c->calcTR (static_cast<trsolver *> (self)->current);
 }
 
 /* Goes through the list of circuit objects and runs its initDC()
@@ -760,6 +1050,7 @@ void trsolver::initDC (void)
     circuit * root = subnet->getRoot ();
     for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
     {
+        c->setRealMNA (true);
         c->initDC ();
     }
 }
@@ -784,7 +1075,9 @@ void trsolver::initTR (void)
     delta = getPropertyDouble ("InitialStep");
     deltaMin = getPropertyDouble ("MinStep");
     deltaMax = getPropertyDouble ("MaxStep");
-    if (deltaMax == 0.0)
+    if (deltaMax == 0.0 && interpolate)
+        deltaMax = stop / 200;
+    else if (deltaMax == 0.0)
         deltaMax = std::min ((stop - start) / (points - 1), stop / 200);
     if (deltaMin == 0.0)
         deltaMin = NR_TINY * 10 * deltaMax;
@@ -819,18 +1112,28 @@ void trsolver::initTR (void)
         setState (sState, (nr_double_t) i, i);
     }
 
-    // tell circuits about the transient analysis
+    // tell circuits about the transient analysis, the sources register
+    // the edges of their waveforms
+    subnet->clearBreakpoints (stop);
     circuit *c, * root = subnet->getRoot ();
     for (c = root; c != NULL; c = (circuit *) c->getNext ())
         initCircuitTR (c);
     // also initialize created circuits
     for (c = root; c != NULL; c = (circuit *) c->getPrev ())
         initCircuitTR (c);
+    poolStates ();
+
+    std::vector<nr_double_t> & b = subnet->getBreakpoints ();
+    std::sort (b.begin (), b.end ());
+    b.erase (std::unique (b.begin (), b.end ()), b.end ());
+    breakNext = 0;
 }
 
 // This function cleans up some memory used by the transient analysis.
 void trsolver::deinitTR (void)
 {
+    // hand the states back to the circuits
+    pool.release ();
     // cleanup solutions
     for (int i = 0; i < 8; i++)
     {
@@ -848,6 +1151,7 @@ void trsolver::deinitTR (void)
 // The function initialize a single circuit.
 void trsolver::initCircuitTR (circuit * c)
 {
+    c->setRealMNA (true);
     c->initTR ();
     c->initStates ();
     c->setCoefficients (corrCoeff);
@@ -855,6 +1159,21 @@ void trsolver::initCircuitTR (circuit * c)
     setIntegrationMethod (c, corrType);
 }
 
+/* The function moves the states of all the circuits into one pool.
+   The history slots are then rotated once per time step for all the
+   circuits, the values stay in place. */
+void trsolver::poolStates (void)
+{
+    std::vector<states<nr_double_t> *> list;
+    circuit *c, * root = subnet->getRoot ();
+    for (c = root; c != NULL; c = (circuit *) c->getNext ())
+        list.push_back (c);
+    for (c = root ? (circuit *) root->getPrev () : NULL; c != NULL;
+         c = (circuit *) c->getPrev ())
+        list.push_back (c);
+    pool.create (list);
+}
+
 /* This function saves the results of a single solve() functionality
    (for the given timestamp) into the output dataset. */
 void trsolver::saveAllResults (nr_double_t time)
@@ -866,13 +1185,373 @@ void trsolver::saveAllResults (nr_double_t time)
       t = new qucs::vector ("time");
         data->addDependency (t);
     }
-    if (runs == 1) t->add (time);
+    if (runs == 1 && block <= 0) t->add (time);
     saveResults ("Vt", "It", 0, t);
+    if (mixed) saveDigital (t);
+}
+
+/* The function takes the logic gates out of the netlist and into the
+   event-driven simulation.  Logic nodes connected to other circuits
+   get a voltage source if a gate drives them, otherwise their voltage
+   is sensed at the switching threshold of the gates. */
+int trsolver::initDigital (void)
+{
+    circuit * c, * n, * root = subnet->getRoot ();
+    std::set<std::string> analog;
+    std::map<std::string, nr_double_t> thresholds;
+
+    digital.clear ();
+    digital.setName (getName ());
+    senses.clear ();
+    drivers.clear ();
+    digitalNodes.clear ();
+
+    for (c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        if (c->getType () == CIR_GROUND)
+            digital.addGround (c->getNode (0)->getName ());
+        if (!digisim::isGate (c))
+        {
+            for (int i = 0; i < c->getSize (); i++)
+                analog.insert (c->getNode (i)->getName ());
+            continue;
+        }
+        digital.addGate (c);
+        for (int i = 1; i < c->getSize (); i++)
+            thresholds.insert ({ c->getNode (i)->getName (),
+                                 c->getPropertyDouble ("V") / 2 });
+    }
+    if (!digital.getGates ())
+    {
+        mixed = false;
+        return 0;
+    }
+    if (digital.setup ())
+        return -1;
+
+    for (int k = 1; k < digital.getNodes (); k++)
+    {
+        const std::string & name = digital.getName (k);
+        if (!analog.count (name))
+        {
+            // nodes at top level only, like saveResults()
+            if (name.find ('.') == std::string::npos)
+                digitalNodes.push_back (k);
+            if (!digital.isDriven (k))
+                logprint (LOG_ERROR, "WARNING: %s: logic node `%s' is not "
+                          "driven, assuming low\n", getName (), name.c_str ());
+        }
+        else if (digital.isDriven (k))
+        {
+            trdriver_t d;
+            d.c = new vdc ();
+            subnet->insertedCircuit (d.c);
+            d.c->setNode (0, name);
+            d.c->setNode (1, "gnd");
+            d.c->addProperty ("U", 0.0);
+            d.c->setOriginal (0);
+            d.c->setInternalVoltageSource (true);
+            d.node = k;
+            d.level = digital.getLevel (k);
+            d.value = -1;
+            drivers.push_back (d);
+        }
+        else
+        {
+            trsense_t s;
+            s.node = k;
+            s.r = -1;
+            s.threshold = thresholds[name];
+            s.v = s.t = 0;
+            s.value = 0;
+            senses.push_back (s);
+        }
+    }
+
+    // swap the gates for the drivers
+    for (c = root; c != NULL; c = n)
+    {
+        n = (circuit *) c->getNext ();
+        if (digisim::isGate (c))
+            subnet->removeCircuit (c);
+    }
+    for (auto & d : drivers)
+        subnet->insertCircuit (d.c);
+
+    logprint (LOG_STATUS, "NOTIFY: %s: running %d logic gates event-driven, "
+              "%d analog inputs and %d analog outputs\n", getName (),
+              digital.getGates (), (int) senses.size (), (int) drivers.size ());
+    if (digital.initial ())
+        return -1;
+    applyDigital ();
+    return 0;
+}
+
+// Puts the logic gates back into the netlist.
+void trsolver::deinitDigital (void)
+{
+    pool.release ();
+    if (!mixed) return;
+    subnet->getDroppedCircuits ();
+    subnet->deleteUnusedCircuits ();
+    drivers.clear ();
+}
+
+// Finds the sensed logic nodes in the solution vector.
+void trsolver::indexDigital (void)
+{
+    for (auto & s : senses)
+        s.r = getNodeNr (digital.getName (s.node)) - 1;
+}
+
+// Reads the voltages of the sensed logic nodes.
+void trsolver::sampleDigital (void)
+{
+    for (auto & s : senses)
+        s.v = s.r >= 0 ? x->get (s.r) : 0;
+}
+
+/* Applies the sensed voltages of the initial DC solution to the logic
+   inputs and restarts the logic simulation.  Returns the number of
+   changed drivers, thus non-zero if the DC solution must be redone,
+   or -1 on errors. */
+int trsolver::settleDigital (void)
+{
+    int changes = 0;
+    for (auto & s : senses)
+    {
+        int value = s.v > s.threshold;
+        s.t = 0;
+        if (value != s.value)
+        {
+            s.value = value;
+            digital.setValue (s.node, value);
+            changes++;
+        }
+    }
+    if (!changes)
+        return 0;
+    if (digital.initial ())
+        return -1;
+    return applyDigital ();
+}
+
+/* Sets the voltage sources for the current logic values, during the
+   transient analysis their right hand side is changed as well.
+   Returns the number of changed sources. */
+int trsolver::applyDigital (bool stamp)
+{
+    int changes = 0;
+    for (auto & d : drivers)
+    {
+        int value = digital.getValue (d.node);
+        if (value != d.value)
+        {
+            nr_double_t u = value ? d.level : 0;
+            d.value = value;
+            d.c->setProperty ("U", u);
+            if (stamp) d.c->setE (VSRC_1, u);
+            changes++;
+        }
+    }
+    return changes;
+}
+
+/* Advances the logic simulation to the given time of the accepted
+   solution.  Threshold crossings of the sensed voltages become events
+   at the linearly interpolated crossing time.  Output changes due in
+   the past take effect in the next time step. */
+int trsolver::updateDigital (nr_double_t t)
+{
+    for (auto & s : senses)
+    {
+        nr_double_t v = s.r >= 0 ? x->get (s.r) : 0;
+        int value = v > s.threshold;
+        if (value != s.value)
+        {
+            nr_double_t tc = s.t;
+            if (t > s.t) tc += (t - s.t) * (s.threshold - s.v) / (v - s.v);
+            digital.force (digital.ticks (tc), s.node, value);
+            s.value = value;
+        }
+        s.v = v;
+        s.t = t;
+    }
+
+    digisim::digitime_t te, now = digital.ticks (t);
+    while ((te = digital.next ()) <= now)
+    {
+        if (digital.step (te))
+            return -1;
+    }
+
+    // the outputs jump, restart the integration
+    if (applyDigital (true))
+        adjustOrder (1);
+    return 0;
+}
+
+/* Partitions the netlist into parts which share no node except ground
+   and returns the number of parts. */
+int trsolver::splitBlocks (void)
+{
+    circuit * c, * root = subnet->getRoot ();
+    std::map<std::string, int> index;
+    std::set<std::string> ground;
+    std::vector<int> parent;
+    blocks.clear ();
+
+    // the nodesets apply to the whole netlist
+    if (subnet->getNodeset ())
+        return 1;
+
+    for (c = root; c != NULL; c = (circuit *) c->getNext ())
+        if (c->getType () == CIR_GROUND)
+            ground.insert (c->getNode (0)->getName ());
+
+    auto find = [&parent] (int n)
+    {
+        while (parent[n] != n) n = parent[n] = parent[parent[n]];
+        return n;
+    };
+    auto first = [&] (circuit * c)
+    {
+        int r = -1;
+        for (int i = 0; i < c->getSize (); i++)
+        {
+            std::string n = c->getNode (i)->getName ();
+            if (ground.count (n)) continue;
+            auto it = index.find (n);
+            if (it == index.end ())
+            {
+                it = index.insert ({ n, (int) parent.size () }).first;
+                parent.push_back (it->second);
+            }
+            if (r < 0)
+                r = find (it->second);
+            else
+                parent[find (it->second)] = r;
+        }
+        return r;
+    };
+
+    // join the nodes of each circuit
+    for (c = root; c != NULL; c = (circuit *) c->getNext ())
+        if (c->getType () != CIR_GROUND) first (c);
+
+    // collect the circuits of each part, grounded ones go with the first
+    std::vector<int> part (parent.size (), -1);
+    for (c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        if (c->getType () == CIR_GROUND) continue;
+        int r = first (c), k = 0;
+        if (r >= 0)
+        {
+            if (part[r] < 0)
+            {
+                part[r] = blocks.size ();
+                blocks.push_back (std::vector<circuit *> ());
+            }
+            k = part[r];
+        }
+        if (blocks.empty ()) blocks.push_back (std::vector<circuit *> ());
+        blocks[k].push_back (c);
+    }
+    return blocks.size ();
+}
+
+/* Solves the parts of the netlist one after the other.  Meanwhile the
+   circuits of the other parts are taken out of the netlist, inserted
+   ones are marked as original in order to keep them until they are
+   put back. */
+int trsolver::solveBlocks (void)
+{
+    std::vector<std::vector<circuit *> > parts;
+    parts.swap (blocks);
+    logprint (LOG_STATUS, "NOTIFY: %s: solving %d decoupled subcircuits\n",
+              getName (), (int) parts.size ());
+
+    int error = 0;
+    for (unsigned int k = 0; k < parts.size () && !error; k++)
+    {
+        std::set<circuit *> keep (parts[k].begin (), parts[k].end ());
+        std::vector<circuit *> inserted;
+        circuit * c, * n;
+        for (c = subnet->getRoot (); c != NULL; c = n)
+        {
+            n = (circuit *) c->getNext ();
+            if (c->getType () == CIR_GROUND || keep.count (c)) continue;
+            if (!c->isOriginal ())
+            {
+                inserted.push_back (c);
+                c->setOriginal (1);
+            }
+            subnet->removeCircuit (c);
+        }
+
+        // the results of all parts belong to the same run
+        if (k > 0) runs--;
+        block = k;
+        error = solve ();
+        block = -1;
+
+        subnet->getDroppedCircuits ();
+        for (circuit * i : inserted) i->setOriginal (0);
+    }
+    return error;
+}
+
+/* Returns the time of the next breakpoint, this is the next edge of
+   the sources or the next logic event. */
+nr_double_t trsolver::nextBreakpoint (void)
+{
+    std::vector<nr_double_t> & b = subnet->getBreakpoints ();
+    nr_double_t t = std::numeric_limits<nr_double_t>::max ();
+    if (breakNext < (int) b.size ())
+        t = b[breakNext];
+    if (mixed)
+        t = std::min (t, nextDigital ());
+    return t;
+}
+
+/* Skips the breakpoints up to the given time of the accepted solution.
+   Returns non-zero if the solution is at a breakpoint. */
+int trsolver::passBreakpoints (nr_double_t t)
+{
+    std::vector<nr_double_t> & b = subnet->getBreakpoints ();
+    int hit = 0;
+    while (breakNext < (int) b.size () && b[breakNext] <= t + deltaMin)
+    {
+        if (b[breakNext] >= t - deltaMin)
+            hit = 1;
+        breakNext++;
+    }
+    return hit;
+}
+
+// Returns the time of the next logic event.
+nr_double_t trsolver::nextDigital (void)
+{
+    digisim::digitime_t te = digital.next ();
+    if (te == DIGI_NEVER)
+        return std::numeric_limits<nr_double_t>::max ();
+    return digital.seconds (te);
+}
+
+// Saves the voltages of the logic nodes not in the nodal analysis.
+void trsolver::saveDigital (qucs::vector * t)
+{
+    for (int k : digitalNodes)
+        saveVariable (digital.getName (k) + ".Vt",
+                      digital.getValue (k) ? digital.getLevel (k) : 0.0, t);
 }
 
 /* This function is meant to adapt the current time-step the transient
    analysis advanced.  For the computation of the new time-step the
-   truncation error depending on the integration method is used. */
+   truncation error depending on the integration method is used.  The
+   step-size grows monotonically with the tolerance to error ratio,
+   thus only the smallest ratio is searched for and turned into the
+   step-size. */
 nr_double_t trsolver::checkDelta (void)
 {
     nr_double_t LTEreltol = getPropertyDouble ("LTEreltol");
@@ -881,34 +1560,47 @@ nr_double_t trsolver::checkDelta (void)
     nr_double_t dif, rel, tol, lte, q, n =  std::numeric_limits<nr_double_t>::max();
     int N = countNodes ();
     int M = countVoltageSources ();
+    nr_double_t * p = x->getData (), * s = SOL(0)->getData ();
 
     // cec = corrector error constant
     nr_double_t cec = getCorrectorError (corrType, corrOrder);
     // pec = predictor error constant
     nr_double_t pec = getPredictorError (predType, predOrder);
+    nr_double_t ratio = std::numeric_limits<nr_double_t>::max();
+
+    // mark the branch currents of real voltage sources
+    std::vector<char> vsource (M, 0);
+    circuit * root = subnet->getRoot ();
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        if (!c->isVSource ()) continue;
+        for (int i = 0; i < c->getVoltageSources (); i++)
+            vsource[c->getVoltageSource () + i] = 1;
+    }
 
     // go through each solution
     for (int r = 0; r < N + M; r++)
     {
 
         // skip real voltage sources
-        if (r >= N)
-        {
-            if (findVoltageSource(r - N)->isVSource ())
-                continue;
-        }
+        if (r >= N && vsource[r - N])
+            continue;
 
-        dif = x->get (r) - SOL(0)->get (r);
+        dif = p[r] - s[r];
         if (std::isfinite (dif) && dif != 0)
         {
             // use Milne' estimate for the local truncation error
-            rel = MAX (fabs (x->get (r)), fabs (SOL(0)->get (r)));
+            rel = MAX (fabs (p[r]), fabs (s[r]));
             tol = LTEreltol * rel + LTEabstol;
             lte = LTEfactor * (cec / (pec - cec)) * dif;
-            q =  delta * exp (log (fabs (tol / lte)) / (corrOrder + 1));
-            n = std::min (n, q);
+            ratio = std::min (ratio, fabs (tol / lte));
         }
     }
+    if (ratio < std::numeric_limits<nr_double_t>::max())
+    {
+        q =  delta * exp (log (ratio) / (corrOrder + 1));
+        n = std::min (n, q);
+    }
 #if STEPDEBUG
     logprint (LOG_STATUS, "DEBUG: delta according to local truncation "
               "error h = %.3e\n", (double) n);
@@ -917,6 +1609,279 @@ nr_double_t trsolver::checkDelta (void)
     return delta;
 }
 
+/* Returns true if checkpoints of the analysis are enabled and
+   possible.  The state of the logic gates and of the multirate blocks
+   is not kept, neither are the spooled values of a streaming
+   dataset. */
+bool trsolver::canCheckpoint (void)
+{
+    if (!checkpoint::enabled () || runs != 1 || block >= 0 ||
+            startSolution != NULL || !recording)
+        return false;
+    if (mixed || data->isStreaming ())
+    {
+        logprint (LOG_STATUS, "NOTIFY: %s: no checkpoints with mixed-signal "
+                  "or streaming results\n", getName ());
+        return false;
+    }
+    return true;
+}
+
+/* The function returns the key of the checkpoint.  It consists of the
+   number of unknowns and a hash of the circuit list. */
+std::string trsolver::checkpointKey (void)
+{
+    std::string list;
+    circuit * root = subnet->getRoot ();
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        list += c->getName ();
+        list += ":" + std::to_string (c->getStates ()) + ";";
+    }
+    return std::string ("transient ") + getName () + " " +
+           std::to_string (countNodes ()) + " " +
+           std::to_string (countVoltageSources ()) + " " +
+           std::to_string (std::hash<std::string> () (list));
+}
+
+// Writes the values of the given dataset vector into the checkpoint.
+static void putVector (checkpoint & cp, qucs::vector * v)
+{
+    int n = v->getSize ();
+    std::vector<nr_double_t> d (2 * n);
+    for (int k = 0; k < n; k++)
+    {
+        nr_complex_t z = v->get (k);
+        d[2 * k] = real (z);
+        d[2 * k + 1] = imag (z);
+    }
+    cp.put ((int) n);
+    cp.put (d.data (), 2 * n);
+}
+
+// Appends values from the checkpoint to the given dataset vector.
+static void getVector (checkpoint & cp, qucs::vector * v)
+{
+    int n = 0;
+    cp.get (n);
+    if (!cp.good () || n < 0) return;
+    std::vector<nr_double_t> d (2 * n);
+    cp.get (d.data (), 2 * n);
+    for (int k = 0; cp.good () && k < n; k++)
+        v->add (nr_complex_t (d[2 * k], d[2 * k + 1]));
+}
+
+/* The function writes the state of the analysis after the given number
+   of requested time points into the checkpoint: the time-step control,
+   the solution history, the states and histories of the circuits and
+   the results saved so far.  Returns zero on success. */
+int trsolver::saveCheckpoint (checkpoint & cp, int next, int running,
+                              nr_double_t saveCurrent, int convError)
+{
+    int s, N = countNodes (), M = countVoltageSources ();
+    nr_double_t v[8];
+    circuit * c, * root = subnet->getRoot ();
+    if (cp.create (checkpointKey ())) return -1;
+
+    // time-step and order control
+    cp.put (next); cp.put (running); cp.put (rejected); cp.put (converged);
+    cp.put (corrType); cp.put (corrOrder); cp.put (predType);
+    cp.put (predOrder); cp.put (convHelper); cp.put (convError);
+    cp.put (breakNext); cp.put (statSteps); cp.put (statRejected);
+    cp.put (statIterations); cp.put (statConvergence);
+    cp.put (current); cp.put (saveCurrent); cp.put (delta);
+    cp.put (deltaOld); cp.put (stepDelta);
+
+    // previous time-steps and solutions
+    for (s = 0; s < getStates (); s++)
+    {
+        saveState (s, v);
+        cp.put (v, 8);
+    }
+    for (s = 0; s < 8; s++) cp.put (SOL(s)->getData (), N + M);
+    cp.put (x->getData (), N + M);
+
+    // circuit states
+    for (c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        for (s = 0; s < c->getStates (); s++)
+        {
+            c->saveState (s, v);
+            cp.put (v, 8);
+        }
+    }
+
+    // circuit histories sharing the time values
+    cp.put (tHistory != NULL ? 1 : 0);
+    if (tHistory != NULL)
+    {
+        int k, n = tHistory->size ();
+        std::vector<nr_double_t> d (n);
+        for (k = 0; k < n; k++) d[k] = tHistory->getTfromidx (k);
+        cp.put (tHistory->getAge ());
+        cp.put (d.data (), n);
+        for (c = root; c != NULL; c = (circuit *) c->getNext ())
+        {
+            if (!c->hasHistory ()) continue;
+            int l = c->getHistory (0)->leftidx ();
+            cp.put (l);
+            for (int h = 0; h < c->getHistories (); h++)
+            {
+                for (k = l; k < n; k++)
+                    d[k - l] = c->getHistory (h)->getValfromidx (k);
+                cp.put (d.data (), n - l);
+            }
+        }
+    }
+
+    // results of this analysis
+    qucs::vector * t = data->findDependency ("time");
+    std::vector<qucs::vector *> results;
+    for (qucs::vector * r = data->getVariables (); r != NULL; r = r->getNext ())
+    {
+        if (r->getOrigin () != NULL && !strcmp (r->getOrigin (), getName ()))
+            results.push_back (r);
+    }
+    cp.put (t != NULL ? 1 : 0);
+    if (t != NULL) putVector (cp, t);
+    cp.put ((int) results.size ());
+    for (qucs::vector * r : results)
+    {
+        cp.put (std::string (r->getName ()));
+        putVector (cp, r);
+    }
+    return cp.commit ();
+}
+
+/* Reads the state written by saveCheckpoint() back.  Returns zero on
+   success, -1 if there is no matching checkpoint and -2 if it could
+   not be read completely. */
+int trsolver::loadCheckpoint (checkpoint & cp, int & next, int & running,
+                              nr_double_t & saveCurrent, int & convError)
+{
+    int s, n, N = countNodes (), M = countVoltageSources ();
+    nr_double_t v[8];
+    circuit * c, * root = subnet->getRoot ();
+    if (cp.open (checkpointKey ())) return -1;
+
+    // time-step and order control
+    cp.get (next); cp.get (running); cp.get (rejected); cp.get (converged);
+    cp.get (corrType); cp.get (corrOrder); cp.get (predType);
+    cp.get (predOrder); cp.get (convHelper); cp.get (convError);
+    cp.get (breakNext); cp.get (statSteps); cp.get (statRejected);
+    cp.get (statIterations); cp.get (statConvergence);
+    cp.get (current); cp.get (saveCurrent); cp.get (delta);
+    cp.get (deltaOld); cp.get (stepDelta);
+
+    // previous time-steps and solutions
+    for (s = 0; s < getStates (); s++)
+    {
+        cp.get (v, 8);
+        inputState (s, v);
+    }
+    for (s = 0; s < 8; s++) cp.get (SOL(s)->getData (), N + M);
+    cp.get (x->getData (), N + M);
+    *xprev = *x;
+    saveState (dState, deltas);
+
+    // circuit states, the integrators keep running
+    for (c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        for (s = 0; s < c->getStates (); s++)
+        {
+            cp.get (v, 8);
+            c->inputState (s, v);
+        }
+        c->setOrder (corrOrder);
+        setIntegrationMethod (c, corrType);
+    }
+    setMode (MODE_NONE);
+
+    /* The histories are built up by appending the time values one by
+       one, each circuit joins at its oldest value. */
+    cp.get (n);
+    if (cp.good () && n)
+    {
+        nr_double_t age;
+        std::vector<nr_double_t> d;
+        std::vector<circuit *> circuits;
+        std::vector<int> left;
+        std::vector<std::vector<nr_double_t> > values;
+        cp.get (age);
+        cp.get (n);
+        if (!cp.good () || n <= 0) return -2;
+        d.resize (n);
+        cp.get (d.data (), n);
+        for (c = root; cp.good () && c != NULL; c = (circuit *) c->getNext ())
+        {
+            if (!c->hasHistory ()) continue;
+            int l = -1;
+            cp.get (l);
+            if (!cp.good () || l < 0 || l >= n) return -2;
+            circuits.push_back (c);
+            left.push_back (l);
+            for (int h = 0; h < c->getHistories (); h++)
+            {
+                values.push_back (std::vector<nr_double_t> (n - l));
+                cp.get (values.back ().data (), n - l);
+            }
+        }
+        if (!cp.good ()) return -2;
+        tHistory = new history ();
+        tHistory->reserve (historySize (age));
+        tHistory->push_back (d[0]);
+        tHistory->self ();
+        tHistory->setAge (age);
+        for (int k = 0; k < n; k++)
+        {
+            if (k > 0) tHistory->push_back (d[k]);
+            int h = 0;
+            for (size_t i = 0; i < circuits.size (); i++)
+            {
+                c = circuits[i];
+                if (k == left[i]) c->applyHistory (tHistory);
+                for (int j = 0; j < c->getHistories (); j++, h++)
+                    if (k >= left[i])
+                        c->appendHistory (j, values[h][k - left[i]]);
+            }
+        }
+    }
+
+    // results of this analysis
+    cp.get (n);
+    if (cp.good () && n)
+    {
+        qucs::vector * t = data->findDependency ("time");
+        if (t == NULL)
+        {
+            t = new qucs::vector ("time");
+            data->addDependency (t);
+        }
+        getVector (cp, t);
+    }
+    cp.get (n);
+    for (int i = 0; cp.good () && i < n; i++)
+    {
+        std::string name;
+        cp.get (name);
+        if (!cp.good ()) break;
+        qucs::vector * r = data->findVariable (name);
+        if (r == NULL)
+        {
+            r = new qucs::vector (name);
+            strlist * deps = new strlist ();
+            deps->add ("time");
+            r->setDependencies (deps);
+            r->setOrigin (getName ());
+            data->addVariable (r);
+        }
+        getVector (cp, r);
+    }
+    bool ok = cp.good ();
+    cp.close ();
+    return ok ? 0 : -2;
+}
+
 // The function updates the integration coefficients.
 void trsolver::updateCoefficients (nr_double_t delta)
 {
@@ -959,6 +1924,15 @@ PROP_OPT [] =
     { "Solver", PROP_STR, { PROP_NO_VAL, "CroutLU" }, PROP_RNG_SOL },
     { "relaxTSR", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
     { "initialDC", PROP_STR, { PROP_NO_VAL, "yes" }, PROP_RNG_YESNO },
+    { "Bypass", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+    { "Newton", PROP_STR, { PROP_NO_VAL, "full" },
+      PROP_RNG_STR3 ("full", "chord", "Broyden") },
+    { "Threads", PROP_INT, { 1, PROP_NO_STR }, PROP_RNGII (0, 256) },
+    { "MixedSignal", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+    { "Multirate", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+    { "Reduce", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+    { "Interpolate", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+    { "Save", PROP_STR, { PROP_NO_VAL, "" }, PROP_NO_RANGE },
     PROP_NO_PROP
 };
 struct define_t trsolver::anadef =
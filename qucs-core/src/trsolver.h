@@ -27,12 +27,14 @@
 
 #include "nasolver.h"
 #include "states.h"
+#include "digisim.h"
 
 namespace qucs {
 
 class sweep;
 class circuit;
 class history;
+class checkpoint;
 
 class trsolver : public nasolver<nr_double_t>, public states<nr_double_t>
 {
@@ -53,21 +55,45 @@ public:
     void initTR (void);
     void deinitTR (void);
     static void calcTR (trsolver *);
+    static void calcCircuitTR (circuit *, nasolver<nr_double_t> *);
     void initDC (void);
     static void calcDC (trsolver *);
+    static void calcCircuitDC (circuit *, nasolver<nr_double_t> *);
     void initSteps (void);
     void saveAllResults (nr_double_t);
+    void recordStep (nr_double_t, bool);
+    void saveInterpolated (nr_double_t);
     nr_double_t checkDelta (void);
     void updateCoefficients (nr_double_t);
     void initHistory (nr_double_t);
     void updateHistory (nr_double_t);
+    int  historySize (nr_double_t);
     void saveHistory (circuit *);
     void predictBashford (void);
     void predictEuler (void);
     void predictGear (void);
+    void solutionData (nr_double_t **);
     void initCircuitTR (circuit *);
+    void poolStates (void);
     void fillSolution (tvector<nr_double_t> *);
     int  dcAnalysis (void);
+    int  initDigital (void);
+    void deinitDigital (void);
+    void indexDigital (void);
+    void sampleDigital (void);
+    int  settleDigital (void);
+    int  applyDigital (bool stamp = false);
+    int  updateDigital (nr_double_t);
+    nr_double_t nextDigital (void);
+    void saveDigital (qucs::vector *);
+    nr_double_t nextBreakpoint (void);
+    int  passBreakpoints (nr_double_t);
+    int  splitBlocks (void);
+    int  solveBlocks (void);
+    bool canCheckpoint (void);
+    std::string checkpointKey (void);
+    int  saveCheckpoint (checkpoint &, int, int, nr_double_t, int);
+    int  loadCheckpoint (checkpoint &, int&, int&, nr_double_t&, int&);
 
 protected:
     sweep * swp;
@@ -96,10 +122,59 @@ protected:
     int statIterations;
     int statConvergence;
     history * tHistory;
+    statepool<nr_double_t> pool; // the states of all the circuits
     bool relaxTSR;
     bool initialDC;
     int ohm;
 
+    /* Logic gates of the mixed-signal partition.  They are removed from
+       the netlist and run event-driven.  Nodes connected to analog
+       circuits are sensed at the threshold of the gates or driven by
+       voltage sources. */
+    struct trsense_t
+    {
+        int node;
+        int r;
+        nr_double_t threshold;
+        nr_double_t v, t;
+        int value;
+    };
+    struct trdriver_t
+    {
+        circuit * c;
+        int node;
+        nr_double_t level;
+        int value;
+    };
+    int breakNext;    // next entry of the breakpoint table
+    bool mixed;
+    digisim digital;
+    std::vector<trsense_t> senses;
+    std::vector<trdriver_t> drivers;
+    std::vector<int> digitalNodes;
+
+    /* Parts of the netlist sharing no node except ground.  In the
+       multirate mode they are solved one after the other, each one with
+       its own time steps. */
+    bool multirate;
+    int block;
+    std::vector<std::vector<circuit *> > blocks;
+
+    /* Solution to start from instead of the initial DC analysis, and
+       whether the results are saved into the dataset.  Both are used by
+       the periodic steady-state analysis running single periods. */
+    tvector<nr_double_t> * startSolution;
+    bool recording;
+
+    /* The last accepted steps, the newest one last.  With the output
+       interpolated the steps do not land on the requested times, the
+       results there are interpolated through these points instead. */
+    bool interpolate;
+    int stepCount;
+    bool stepBreak;
+    nr_double_t stepTimes[3];
+    tvector<nr_double_t> stepSolutions[3];
+
 };
 
 } // namespace qucs
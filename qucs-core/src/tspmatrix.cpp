@@ -0,0 +1,205 @@
+/*
+ * tspmatrix.cpp - sparse matrix template class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#else
+// BUG
+#include "qucs_typedefs.h"
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <algorithm>
+
+#include "compat.h"
+#include "logging.h"
+#include "complex.h"
+#include "tspmatrix.h"
+
+namespace qucs {
+
+// Constructor creates an unnamed instance of the tspmatrix class.
+template <class nr_type_t>
+tspmatrix<nr_type_t>::tspmatrix () {
+  rows = cols = nnz = 0;
+  colptr = rowidx = NULL;
+  data = NULL;
+}
+
+/* Constructor creates an instance of the tspmatrix class with the
+   given number of rows and columns.  The pattern is given by the list
+   of (row, column) pairs; duplicate entries are merged.  All entries
+   are initially zero. */
+template <class nr_type_t>
+tspmatrix<nr_type_t>::tspmatrix (int r, int c, int n,
+				 const int * ri, const int * ci) {
+  int i, k, p;
+  rows = r;
+  cols = c;
+
+  // count entries per column
+  colptr = new int[cols + 1];
+  memset (colptr, 0, sizeof (int) * (cols + 1));
+  for (i = 0; i < n; i++) {
+    assert (ri[i] >= 0 && ri[i] < rows && ci[i] >= 0 && ci[i] < cols);
+    colptr[ci[i] + 1]++;
+  }
+  for (k = 0; k < cols; k++) colptr[k + 1] += colptr[k];
+
+  // distribute row indices into the columns
+  int * pos = new int[cols];
+  int * idx = new int[n > 0 ? n : 1];
+  memcpy (pos, colptr, sizeof (int) * cols);
+  for (i = 0; i < n; i++) idx[pos[ci[i]]++] = ri[i];
+
+  // sort each column and remove duplicate entries
+  for (nnz = 0, p = 0, k = 0; k < cols; k++) {
+    int * beg = idx + p, * end = idx + colptr[k + 1];
+    p = colptr[k + 1];
+    std::sort (beg, end);
+    colptr[k] = nnz;
+    for (; beg < end; beg++) {
+      if (nnz > colptr[k] && *beg == idx[nnz - 1]) continue;
+      idx[nnz++] = *beg;
+    }
+  }
+  colptr[cols] = nnz;
+  delete[] pos;
+
+  rowidx = new int[nnz > 0 ? nnz : 1];
+  memcpy (rowidx, idx, sizeof (int) * nnz);
+  delete[] idx;
+  data = new nr_type_t[nnz > 0 ? nnz : 1];
+  for (i = 0; i < nnz; i++) data[i] = 0.0;
+}
+
+/* The copy constructor creates a new instance based on the given
+   tspmatrix object. */
+template <class nr_type_t>
+tspmatrix<nr_type_t>::tspmatrix (const tspmatrix & m) {
+  rows = cols = nnz = 0;
+  colptr = rowidx = NULL;
+  data = NULL;
+  *this = m;
+}
+
+/* The assignment copy constructor creates a new instance based on the
+   given tspmatrix object. */
+template <class nr_type_t>
+const tspmatrix<nr_type_t>&
+tspmatrix<nr_type_t>::operator=(const tspmatrix<nr_type_t> & m) {
+  if (&m != this) {
+    delete[] colptr;
+    delete[] rowidx;
+    delete[] data;
+    rows = m.rows;
+    cols = m.cols;
+    nnz = m.nnz;
+    colptr = rowidx = NULL;
+    data = NULL;
+    if (m.colptr) {
+      colptr = new int[cols + 1];
+      memcpy (colptr, m.colptr, sizeof (int) * (cols + 1));
+      rowidx = new int[nnz > 0 ? nnz : 1];
+      memcpy (rowidx, m.rowidx, sizeof (int) * nnz);
+      data = new nr_type_t[nnz > 0 ? nnz : 1];
+      for (int i = 0; i < nnz; i++) data[i] = m.data[i];
+    }
+  }
+  return *this;
+}
+
+// Destructor deletes a tspmatrix object.
+template <class nr_type_t>
+tspmatrix<nr_type_t>::~tspmatrix () {
+  delete[] colptr;
+  delete[] rowidx;
+  delete[] data;
+}
+
+/* Returns the slot of the given row and column in the data array or
+   -1 if the entry is not part of the sparsity pattern. */
+template <class nr_type_t>
+int tspmatrix<nr_type_t>::find (int r, int c) {
+  assert (r >= 0 && r < rows && c >= 0 && c < cols);
+  int * beg = rowidx + colptr[c], * end = rowidx + colptr[c + 1];
+  int * it = std::lower_bound (beg, end, r);
+  if (it != end && *it == r) return it - rowidx;
+  return -1;
+}
+
+/* Returns the tspmatrix element at the given row and column.  Entries
+   outside the sparsity pattern are zero. */
+template <class nr_type_t>
+nr_type_t tspmatrix<nr_type_t>::get (int r, int c) {
+  int s = find (r, c);
+  return s >= 0 ? data[s] : 0.0;
+}
+
+/* Sets the tspmatrix element at the given row and column.  The entry
+   must be part of the sparsity pattern. */
+template <class nr_type_t>
+void tspmatrix<nr_type_t>::set (int r, int c, nr_type_t z) {
+  int s = find (r, c);
+  assert (s >= 0);
+  data[s] = z;
+}
+
+// Sets all the tspmatrix elements to the given value.
+template <class nr_type_t>
+void tspmatrix<nr_type_t>::set (nr_type_t z) {
+  for (int i = 0; i < nnz; i++) data[i] = z;
+}
+
+// Checks validity of matrix.
+template <class nr_type_t>
+int tspmatrix<nr_type_t>::isFinite (void) {
+  for (int i = 0; i < nnz; i++)
+    if (!std::isfinite (real (data[i]))) return 0;
+  return 1;
+}
+
+#ifdef DEBUG
+// Debug function: Prints the non-zero matrix entries.
+template <class nr_type_t>
+void tspmatrix<nr_type_t>::print (bool realonly) {
+  for (int c = 0; c < cols; c++) {
+    for (int p = colptr[c]; p < colptr[c + 1]; p++) {
+      if (realonly) {
+	fprintf (stderr, "(%d,%d) %+.2e\n", rowidx[p], c,
+		 (double) real (data[p]));
+      } else {
+	fprintf (stderr, "(%d,%d) %+.2e%+.2ei\n", rowidx[p], c,
+		 (double) real (data[p]), (double) imag (data[p]));
+      }
+    }
+  }
+}
+#endif /* DEBUG */
+
+} // namespace qucs
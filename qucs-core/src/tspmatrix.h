@@ -0,0 +1,79 @@
+/*
+ * tspmatrix.h - sparse matrix template class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __TSPMATRIX_H__
+#define __TSPMATRIX_H__
+
+#include <assert.h>
+
+namespace qucs {
+
+/* The sparse matrix stores its non-zero entries in compressed column
+   form.  The pattern is fixed at construction time, the position of an
+   entry in the data array (its slot) can be looked up once and then be
+   used for fast repeated access. */
+template <class nr_type_t>
+class tspmatrix
+{
+ public:
+  tspmatrix ();
+  tspmatrix (int, int, int, const int *, const int *);
+  tspmatrix (const tspmatrix &);
+  const tspmatrix& operator = (const tspmatrix &);
+  ~tspmatrix ();
+  nr_type_t get (int, int);
+  void set (int, int, nr_type_t);
+  void set (nr_type_t);
+  int  find (int, int);
+  int  getCols (void) { return cols; }
+  int  getRows (void) { return rows; }
+  int  getNnz (void) { return nnz; }
+  int * getColPtr (void) { return colptr; }
+  int * getRowIdx (void) { return rowidx; }
+  nr_type_t * getData (void) { return data; }
+  int  isFinite (void);
+  void print (bool realonly = false);
+
+  // easy accessor operators for slots
+  nr_type_t  operator () (int s) const {
+    assert (s >= 0 && s < nnz);
+    return data[s]; }
+  nr_type_t& operator () (int s) {
+    assert (s >= 0 && s < nnz);
+    return data[s]; }
+
+ private:
+  int cols;
+  int rows;
+  int nnz;
+  int * colptr;
+  int * rowidx;
+  nr_type_t * data;
+};
+
+} // namespace qucs
+
+#include "tspmatrix.cpp"
+
+#endif /* __TSPMATRIX_H__ */
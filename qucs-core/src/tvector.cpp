@@ -40,7 +40,7 @@ namespace qucs {
 
 // Returns the tvector element at the given position.
 template <class nr_type_t>
-nr_type_t tvector<nr_type_t>::get (int i) {
+nr_type_t tvector<nr_type_t>::get (int i) const {
   return data.at(i);
 }
 
@@ -82,8 +82,8 @@ int tvector<nr_type_t>::contains (nr_type_t val, nr_double_t eps) {
 
 // Copies the specified elements from the given tvector.
 template <class nr_type_t>
-void tvector<nr_type_t>::set (tvector<nr_type_t> a, int start, int stop) {
-  for (int i = start; i < stop; i++) (*data)[i] = a.get (i);
+void tvector<nr_type_t>::set (const tvector<nr_type_t> & a, int start, int stop) {
+  for (int i = start; i < stop; i++) data[i] = a.get (i);
 }
 
 // The function swaps the given rows with each other.
@@ -97,57 +97,51 @@ void tvector<nr_type_t>::exchangeRows (int r1, int r2) {
 
 // Addition.
 template <class nr_type_t>
-tvector<nr_type_t> operator + (tvector<nr_type_t> a, tvector<nr_type_t> b) {
+tvector<nr_type_t> operator + (const tvector<nr_type_t> & a, const tvector<nr_type_t> & b) {
   assert (a.size () == b.size ());
   int n = a.size ();
   tvector<nr_type_t> res (n);
-  for (int i = 0; i < n; i++) res.set (i, a.get (i) + b.get (i));
+  for (int i = 0; i < n; i++) res[i] = a[i] + b[i];
   return res;
 }
 
 // Intrinsic vector addition.
 template <class nr_type_t>
-tvector<nr_type_t> tvector<nr_type_t>::operator += (tvector<nr_type_t> a) {
-  assert (a.getSize () == (int)data.size ());
-  std::vector<nr_type_t> * src = a.getData ();
-  std::vector<nr_type_t> * dst = data;
-  for (int i = 0; i < (int)data.size (); i++) (*dst)[i] += (*src)[i];
+tvector<nr_type_t> & tvector<nr_type_t>::operator += (const tvector<nr_type_t> & a) {
+  assert (a.size () == data.size ());
+  for (int i = 0; i < (int)data.size (); i++) data[i] += a[i];
   return *this;
 }
 
 // Subtraction.
 template <class nr_type_t>
-tvector<nr_type_t> operator - (tvector<nr_type_t> a, tvector<nr_type_t> b) {
+tvector<nr_type_t> operator - (const tvector<nr_type_t> & a, const tvector<nr_type_t> & b) {
   assert (a.size () == b.size ());
   int n = a.size ();
   tvector<nr_type_t> res (n);
-  for (int i = 0; i < n; i++) res.set (i, a.get (i) - b.get (i));
+  for (int i = 0; i < n; i++) res[i] = a[i] - b[i];
   return res;
 }
 
 // Intrinsic vector subtraction.
 template <class nr_type_t>
-tvector<nr_type_t> tvector<nr_type_t>::operator -= (tvector<nr_type_t> a) {
-  assert (a.size () == (int)data.size ());
-  std::vector<nr_type_t> * src = a.getData ();
-  std::vector<nr_type_t> * dst = data;
-  for (int i = 0; i < (int)data.size (); i++) (*dst)[i] -= (*src)[i];
+tvector<nr_type_t> & tvector<nr_type_t>::operator -= (const tvector<nr_type_t> & a) {
+  assert (a.size () == data.size ());
+  for (int i = 0; i < (int)data.size (); i++) data[i] -= a[i];
   return *this;
 }
 
 // Intrinsic scalar multiplication.
 template <class nr_type_t>
-tvector<nr_type_t> tvector<nr_type_t>::operator *= (nr_double_t s) {
-  std::vector<nr_type_t> * dst = data;
-  for (int i = 0; i < (int)data.size (); i++) (*dst)[i] *= s;
+tvector<nr_type_t> & tvector<nr_type_t>::operator *= (nr_double_t s) {
+  for (int i = 0; i < (int)data.size (); i++) data[i] *= s;
   return *this;
 }
 
 // Intrinsic scalar division.
 template <class nr_type_t>
-tvector<nr_type_t> tvector<nr_type_t>::operator /= (nr_double_t s) {
-  std::vector<nr_type_t> * dst = data;
-  for (int i = 0; i < (int)data.size (); i++) (*dst)[i] /= s;
+tvector<nr_type_t> & tvector<nr_type_t>::operator /= (nr_double_t s) {
+  for (int i = 0; i < (int)data.size (); i++) data[i] /= s;
   return *this;
 }
 
@@ -155,47 +149,48 @@ tvector<nr_type_t> tvector<nr_type_t>::operator /= (nr_double_t s) {
 template <class nr_type_t>
 tvector<nr_type_t> operator * (nr_double_t s, tvector<nr_type_t> a) {
   int n = a.size ();
-  tvector<nr_type_t> res (n);
-  for (int i = 0; i < n; i++) res.set (i, s * a.get (i));
-  return res;
+  for (int i = 0; i < n; i++) a[i] = s * a[i];
+  return a;
 }
 
 template <class nr_type_t>
 tvector<nr_type_t> operator * (tvector<nr_type_t> a, nr_double_t s) {
-  return s * a;
+  int n = a.size ();
+  for (int i = 0; i < n; i++) a[i] = s * a[i];
+  return a;
 }
 
 // Vector multiplication (element by element).
 template <class nr_type_t>
-tvector<nr_type_t> operator * (tvector<nr_type_t> a, tvector<nr_type_t> b) {
+tvector<nr_type_t> operator * (const tvector<nr_type_t> & a, const tvector<nr_type_t> & b) {
   assert (a.size () == b.size ());
   int n = a.size ();
   tvector<nr_type_t> res (n);
-  for (int i = 0; i < n; i++) res.set (i, a.get (i) * b.get (i));
+  for (int i = 0; i < n; i++) res[i] = a[i] * b[i];
   return res;
 }
 
 // Computes the scalar product of two vectors.
 template <class nr_type_t>
-nr_type_t scalar (tvector<nr_type_t> a, tvector<nr_type_t> b) {
+nr_type_t scalar (const tvector<nr_type_t> & a, const tvector<nr_type_t> & b) {
   assert (a.size () == b.size ());
   nr_type_t n = 0;
-  for (int i = 0; i < a.size (); i++) n += a.get (i) * b.get (i);
+  for (int i = 0; i < (int)a.size (); i++) n += a[i] * b[i];
   return n;
 }
 
 // Constant assignment operation.
 template <class nr_type_t>
-tvector<nr_type_t> tvector<nr_type_t>::operator = (const nr_type_t val) {
-  for (int i = 0; i < (int)data.size (); i++) (*data)[i] = val;
+tvector<nr_type_t> & tvector<nr_type_t>::operator = (const nr_type_t val) {
+  for (int i = 0; i < (int)data.size (); i++) data[i] = val;
   return *this;
 }
 
 // Returns the sum of the vector elements.
 template <class nr_type_t>
-nr_type_t sum (tvector<nr_type_t> a) {
+nr_type_t sum (const tvector<nr_type_t> & a) {
   nr_type_t res = 0;
-  for (int i = 0; i < a.size (); i++) res += a.get (i);
+  for (int i = 0; i < (int)a.size (); i++) res += a[i];
   return res;
 }
 
@@ -203,26 +198,25 @@ nr_type_t sum (tvector<nr_type_t> a) {
 template <class nr_type_t>
 tvector<nr_type_t> operator - (tvector<nr_type_t> a) {
   int n = a.size ();
-  tvector<nr_type_t> res (n);
-  for (int i = 0; i < n; i++) res.set (i, -a.get (i));
-  return res;
+  for (int i = 0; i < n; i++) a[i] = -a[i];
+  return a;
 }
 
 // Vector less comparison.
 template <class nr_type_t>
-bool operator < (tvector<nr_type_t> a, tvector<nr_type_t> b) {
+bool operator < (const tvector<nr_type_t> & a, const tvector<nr_type_t> & b) {
   assert (a.size () == b.size ());
   int n = a.size ();
-  for (int i = 0; i < n; i++) if (a.get (i) >= b.get (i)) return false;
+  for (int i = 0; i < n; i++) if (a[i] >= b[i]) return false;
   return true;
 }
 
 // Vector greater comparison.
 template <class nr_type_t>
-bool operator > (tvector<nr_type_t> a, tvector<nr_type_t> b) {
+bool operator > (const tvector<nr_type_t> & a, const tvector<nr_type_t> & b) {
   assert (a.size () == b.size ());
   int n = a.size ();
-  for (int i = 0; i < n; i++) if (a.get (i) <= b.get (i)) return false;
+  for (int i = 0; i < n; i++) if (a[i] <= b[i]) return false;
   return true;
 }
 
@@ -230,27 +224,28 @@ bool operator > (tvector<nr_type_t> a, tvector<nr_type_t> b) {
 template <class nr_type_t>
 tvector<nr_type_t> operator + (nr_type_t s, tvector<nr_type_t> a) {
   int n = a.size ();
-  tvector<nr_type_t> res (n);
-  for (int i = 0; i < n; i++) res.set (i, s + a.get (i));
-  return res;
+  for (int i = 0; i < n; i++) a[i] = s + a[i];
+  return a;
 }
 
 template <class nr_type_t>
 tvector<nr_type_t> operator + (tvector<nr_type_t> a, nr_type_t s) {
-  return s + a;
+  int n = a.size ();
+  for (int i = 0; i < n; i++) a[i] = s + a[i];
+  return a;
 }
 
 // Mean square norm.
 template <class nr_type_t>
-nr_double_t norm (tvector<nr_type_t> a) {
+nr_double_t norm (const tvector<nr_type_t> & a) {
 #if 0
   nr_double_t k = 0;
   for (int i = 0; i < a.size (); i++) k += norm (a.get (i));
   return n;
 #else
   nr_double_t scale = 0, n = 1, x, ax;
-  for (int i = 0; i < a.size (); i++) {
-    if ((x = real (a (i))) != 0) {
+  for (int i = 0; i < (int)a.size (); i++) {
+    if ((x = real (a[i])) != 0) {
       ax = fabs (x);
       if (scale < ax) {
 	x = scale / ax;
@@ -262,7 +257,7 @@ nr_double_t norm (tvector<nr_type_t> a) {
 	n += x * x;
       }
     }
-    if ((x = imag (a (i))) != 0) {
+    if ((x = imag (a[i])) != 0) {
       ax = fabs (x);
       if (scale < ax) {
 	x = scale / ax;
@@ -281,10 +276,10 @@ nr_double_t norm (tvector<nr_type_t> a) {
 
 // Maximum norm.
 template <class nr_type_t>
-nr_double_t maxnorm (tvector<nr_type_t> a) {
+nr_double_t maxnorm (const tvector<nr_type_t> & a) {
   nr_double_t nMax = 0, n;
-  for (int i = 0; i < a.size (); i++) {
-    n = norm (a.get (i));
+  for (int i = 0; i < (int)a.size (); i++) {
+    n = norm (a[i]);
     if (n > nMax) nMax = n;
   }
   return nMax;
@@ -294,16 +289,15 @@ nr_double_t maxnorm (tvector<nr_type_t> a) {
 template <class nr_type_t>
 tvector<nr_type_t> conj (tvector<nr_type_t> a) {
   int n = a.size ();
-  tvector<nr_type_t> res (n);
-  for (int i = 0; i < n; i++) res.set (i, conj (a.get (i)));
-  return res;
+  for (int i = 0; i < n; i++) a[i] = conj (a[i]);
+  return a;
 }
 
 // Checks validity of vector.
 template <class nr_type_t>
 int tvector<nr_type_t>::isFinite (void) {
   for (int i = 0; i < (int)data.size (); i++)
-    if (!std::isfinite (real ((*data)[i]))) return 0;
+    if (!std::isfinite (real (data[i]))) return 0;
   return 1;
 }
 
@@ -311,7 +305,7 @@ int tvector<nr_type_t>::isFinite (void) {
 template <class nr_type_t>
 void tvector<nr_type_t>::reorder (int * idx) {
   tvector<nr_type_t> old = *this;
-  for (int i = 0; i < (int)data.size (); i++) (*data)[i] = old.get (idx[i]);
+  for (int i = 0; i < (int)data.size (); i++) data[i] = old.get (idx[i]);
 }
 
 #ifdef DEBUG
@@ -39,35 +39,35 @@ class tvector;
 
 // Forward declarations of friend functions.
 template <class nr_type_t>
-nr_type_t   scalar (tvector<nr_type_t>, tvector<nr_type_t>);
+nr_type_t   scalar (const tvector<nr_type_t> &, const tvector<nr_type_t> &);
 template <class nr_type_t>
-nr_double_t maxnorm (tvector<nr_type_t>);
+nr_double_t maxnorm (const tvector<nr_type_t> &);
 template <class nr_type_t>
-nr_double_t norm (tvector<nr_type_t>);
+nr_double_t norm (const tvector<nr_type_t> &);
 template <class nr_type_t>
-nr_type_t   sum (tvector<nr_type_t>);
+nr_type_t   sum (const tvector<nr_type_t> &);
 template <class nr_type_t>
 tvector<nr_type_t> conj (tvector<nr_type_t>);
 template <class nr_type_t>
-tvector<nr_type_t> operator + (tvector<nr_type_t>, tvector<nr_type_t>);
+tvector<nr_type_t> operator + (const tvector<nr_type_t> &, const tvector<nr_type_t> &);
 template <class nr_type_t>
 tvector<nr_type_t> operator + (tvector<nr_type_t>, nr_type_t);
 template <class nr_type_t>
 tvector<nr_type_t> operator + (nr_type_t, tvector<nr_type_t>);
 template <class nr_type_t>
-tvector<nr_type_t> operator - (tvector<nr_type_t>, tvector<nr_type_t>);
+tvector<nr_type_t> operator - (const tvector<nr_type_t> &, const tvector<nr_type_t> &);
 template <class nr_type_t>
 tvector<nr_type_t> operator * (tvector<nr_type_t>, nr_double_t);
 template <class nr_type_t>
 tvector<nr_type_t> operator * (nr_double_t, tvector<nr_type_t>);
 template <class nr_type_t>
-tvector<nr_type_t> operator * (tvector<nr_type_t>, tvector<nr_type_t>);
+tvector<nr_type_t> operator * (const tvector<nr_type_t> &, const tvector<nr_type_t> &);
 template <class nr_type_t>
 tvector<nr_type_t> operator - (tvector<nr_type_t>);
 template <class nr_type_t>
-bool operator < (tvector<nr_type_t>, tvector<nr_type_t>);
+bool operator < (const tvector<nr_type_t> &, const tvector<nr_type_t> &);
 template <class nr_type_t>
-bool operator > (tvector<nr_type_t>, tvector<nr_type_t>);
+bool operator > (const tvector<nr_type_t> &, const tvector<nr_type_t> &);
 
 template <class nr_type_t>
 class tvector
@@ -76,12 +76,15 @@ class tvector
   tvector () = default;
   tvector (const std::size_t i) : data(i) {};
   tvector (const tvector &) = default;
+  tvector (tvector &&) = default;
+  tvector & operator = (const tvector &) = default;
+  tvector & operator = (tvector &&) = default;
   ~tvector () = default;
-  nr_type_t get (int);
+  nr_type_t get (int) const;
   void set (int, nr_type_t);
   void set (nr_type_t);
   void set (nr_type_t, int, int);
-  void set (tvector, int, int);
+  void set (const tvector &, int, int);
   std::size_t  size (void) const { return data.size (); }
   nr_type_t * getData (void) { return data.data(); }
   void clear (void);
@@ -93,11 +96,11 @@ class tvector
 
   // some basic vector operations
 #ifndef _MSC_VER
-  friend tvector operator +<> (tvector, tvector);
-  friend tvector operator -<> (tvector, tvector);
+  friend tvector operator +<> (const tvector &, const tvector &);
+  friend tvector operator -<> (const tvector &, const tvector &);
   friend tvector operator *<> (tvector, nr_double_t);
   friend tvector operator *<> (nr_double_t, tvector);
-  friend tvector operator *<> (tvector, tvector);
+  friend tvector operator *<> (const tvector &, const tvector &);
   friend tvector operator -<> (tvector);
   friend tvector operator +<> (tvector, nr_type_t);
   friend tvector operator +<> (nr_type_t, tvector);
@@ -105,27 +108,27 @@ class tvector
 
   // other operations
 #ifndef _MSC_VER
-  friend nr_double_t norm<> (tvector);
-  friend nr_double_t maxnorm<> (tvector);
-  friend nr_type_t   sum<> (tvector);
-  friend nr_type_t   scalar<> (tvector, tvector);
+  friend nr_double_t norm<> (const tvector &);
+  friend nr_double_t maxnorm<> (const tvector &);
+  friend nr_type_t   sum<> (const tvector &);
+  friend nr_type_t   scalar<> (const tvector &, const tvector &);
   friend tvector     conj<> (tvector);
 #endif
 
   // comparisons
 #ifndef _MSC_VER
-  friend bool operator < <> (tvector, tvector);
-  friend bool operator > <> (tvector, tvector);
+  friend bool operator < <> (const tvector &, const tvector &);
+  friend bool operator > <> (const tvector &, const tvector &);
 #endif
 
   // intrinsic operators
-  tvector operator += (tvector);
-  tvector operator -= (tvector);
-  tvector operator *= (nr_double_t);
-  tvector operator /= (nr_double_t);
+  tvector & operator += (const tvector &);
+  tvector & operator -= (const tvector &);
+  tvector & operator *= (nr_double_t);
+  tvector & operator /= (nr_double_t);
 
   // assignment operators
-  tvector operator = (const nr_type_t);
+  tvector & operator = (const nr_type_t);
 
   // easy accessor operators
   nr_type_t  operator () (int i) const {
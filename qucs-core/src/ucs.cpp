@@ -40,13 +40,24 @@
 #include "component.h"
 #include "components.h"
 #include "net.h"
+#include "analysis.h"
 #include "input.h"
 #include "dataset.h"
+#include "dtoa.h"
 #include "equation.h"
 #include "environment.h"
 #include "exceptionstack.h"
+#include "numstatus.h"
 #include "check_netlist.h"
 #include "module.h"
+#include "profile.h"
+#include "convreport.h"
+#include "checkpoint.h"
+#include "resultcache.h"
+#include "eco.h"
+#include "trace.h"
+#include "filecache.h"
+#include "threadpool.h"
 
 #if HAVE_UNISTD_H
 #include <unistd.h>
@@ -54,20 +65,167 @@
 
 using namespace qucs;
 
+// options applying to each simulation
+struct runopts_t {
+  int stream;
+  int chunk;
+  int jobs;
+  int binary;
+  int digits;
+  int profiling;
+};
+
+/* Runs the analyses of the given netlist, evaluates the equations and
+   writes the output dataset.  Returns non-zero on errors. */
+static int analyse (net * subnet, environment * root, char * outfile,
+		    runopts_t & opts) {
+  int ret = 0;
+
+  // attach a ground to the netlist
+  circuit * gnd = new ground ();
+  gnd->setNode (0, "gnd");
+  gnd->setName ("GND");
+  subnet->insertCircuit (gnd);
+
+  // analyse the netlist
+  int err = 0;
+  dataset * out = new dataset ();
+  // a streaming binary dataset spools straight into the output file
+  out->setFile (outfile);
+  out->setBinary (opts.binary);
+  out->setPrecision (opts.digits);
+  if (opts.stream) out->setStreaming (opts.chunk);
+  subnet->setJobs (opts.jobs);
+  out = subnet->runAnalysis (err, out);
+  ret |= err;
+
+  // the snapshot for the next run in ECO mode
+  if (eco::enabled () && !err) eco::save ();
+
+  // user equations may refer to any result, thus need them in memory
+  if (out->isStreaming ()) {
+    eqn::node * eqn = root->getChecker()->getEquations ();
+    for (; eqn != NULL; eqn = eqn->getNext ()) {
+      char * type = eqn->getInstance ();
+      if (type == NULL || strcmp (type, "#predefined")) {
+	out->restore ();
+	break;
+      }
+    }
+  }
+
+  // evaluate output dataset
+  {
+    profile::phase p (PROFILE_EQUATIONS);
+    ret |= root->equationSolver (out);
+  }
+  {
+    profile::phase p (PROFILE_OUTPUT);
+    out->print ();
+  }
+
+  // the instrumentation is kept next to the output dataset
+  std::string base = outfile ? std::string (outfile) : "qucsator";
+  if (opts.profiling)
+    profile::write ((base + ".profile.json").c_str ());
+  if (convreport::enabled ())
+    convreport::write ((base + ".convergence.json").c_str ());
+
+  delete out;
+  return ret;
+}
+
+/* Parses the given netlist, runs its analyses and writes the output
+   dataset.  Returns non-zero on errors. */
+static int simulate (char * infile, char * outfile, runopts_t & opts) {
+  net * subnet;
+  input * in;
+  environment * root;
+  int ret = 0;
+
+  // create root environment
+  root = new environment (std::string("root"));
+
+  // create netlist object and input
+  subnet = new net ("subnet");
+  in = infile ? new input (infile) : new input ();
+
+  // pass root environment to netlist object and input
+  subnet->setEnv (root);
+  in->setEnv (root);
+
+  // get input netlist
+  if (in->netlist (subnet) != 0) {
+    if (netlist_check) {
+      logprint (LOG_STATUS, "checker notice, netlist check FAILED\n");
+    }
+    // drop what has been parsed for the next netlist
+    netlist_destroy ();
+    ret = -1;
+  }
+  else if (netlist_check) {
+    logprint (LOG_STATUS, "checker notice, netlist OK\n");
+  }
+  else {
+    ret = analyse (subnet, root, outfile, opts);
+  }
+  numstatus::report ();
+  estack.print ("uncaught");
+
+  delete subnet;
+  delete in;
+  delete root;
+  netlist_destroy_env ();
+  return ret;
+}
+
+/* The server mode keeps the modules and the data files read by the
+   components loaded from one simulation to the next.  It reads one
+   request per line from the standard input, the fields being
+   separated by tabs:
+
+     run NETLIST DATASET
+     quit
+
+   Each run is answered by the line "done STATUS" on the standard
+   output once the dataset has been written. */
+static int serve (runopts_t & opts) {
+  char line[4096], infile[2048], outfile[2048];
+  filecache::retain (true);
+  while (fgets (line, sizeof (line), stdin) != NULL) {
+    if (!strncmp (line, "quit", 4)) break;
+    if (sscanf (line, "run\t%2047[^\t]\t%2047[^\t\r\n]",
+		infile, outfile) == 2) {
+      int ret = simulate (infile, outfile, opts);
+      logflush ();
+      fprintf (stdout, "done %d\n", ret);
+    }
+    else if (strspn (line, " \t\r\n") < strlen (line)) {
+      fprintf (stdout, "error invalid request\n");
+    }
+    fflush (stdout);
+  }
+  filecache::retain (false);
+  return 0;
+}
+
 /*! \todo replace environement name root by "/" in order to be filesystem compatible */
 int main (int argc, char ** argv) {
 
   char * infile = NULL;
   char * outfile = NULL;
   char * projPath = NULL;
-  net * subnet;
-  input * in;
-  circuit * gnd;
-  dataset * out;
-  environment * root;
+  runopts_t opts = { 0, DATASET_CHUNK, 1, 0, 0, 0 };
   int listing = 0;
   int ret = 0;
   int dynamicLoad = 0;
+  int server = 0;
+  int checkpoints = 0;
+  int resume = 0;
+  int reproducible = 0;
+  int incremental = 0;
+  char * tracefile = NULL;
+  char * cachedir = NULL;
 
   std::list<std::string> vamodules;
 
@@ -101,8 +259,39 @@ int main (int argc, char ** argv) {
 	"  -i FILENAME    use file as input netlist (default stdin)\n"
 	"  -o FILENAME    use file as output dataset (default stdout)\n"
 	"  -b, --bar      enable textual progress bar\n"
+	"  -q, --quiet    print errors and warnings only\n"
 	"  -g, --gui      special progress bar used by gui\n"
 	"  -c, --check    check the input netlist and exit\n"
+	"  -s, --stream   keep long results in a spool file during analysis\n"
+	"  -k, --chunk N  values of a result kept in memory when streaming\n"
+	"  -B, --binary   write the output dataset in the binary format\n"
+	"  -z, --compress pack the values of the binary output dataset\n"
+	"  -d, --digits N significant digits of the text output dataset\n"
+	"                 (0 means the shortest exact ones, default 0)\n"
+	"  -T, --templates  share the environment of identical subcircuit instances\n"
+	"  -j, --jobs N   solve independent analyses in up to N processes\n"
+	"                 (0 means one per processor, default 1)\n"
+	"  -w, --threads N  run the parallel loops of the analyses on N threads\n"
+	"                 (default $QUCS_THREADS, else one per processor)\n"
+	"  -x, --reproducible  give the same results for any number of\n"
+	"                 threads and processes (default $QUCS_REPRODUCIBLE)\n"
+	"  -P, --profile  write time per phase and counters of each analysis\n"
+	"                 into FILENAME.profile.json of the output dataset\n"
+	"  -C, --convergence  write the Newton iterations of failed solves\n"
+	"                 into FILENAME.convergence.json of the output dataset\n"
+	"  -t, --trace FILENAME  write a Chrome trace of the solver loops\n"
+	"                 (default $QUCS_TRACE, needs --enable-trace)\n"
+	"  -K, --checkpoint [N]  write the state of transient and HB analyses\n"
+	"                 every N seconds (default 600) next to the output dataset\n"
+	"  -r, --resume   continue from the checkpoints of a previous run\n"
+	"  -R, --cache DIR  take the results of unchanged analyses from DIR\n"
+	"                 and keep new ones there (default $QUCS_CACHE)\n"
+	"  -E, --eco      re-simulate incrementally: start at the solution of\n"
+	"                 the previous run kept next to the output dataset; all\n"
+	"                 analyses re-run after a circuit edit, analyses only\n"
+	"                 edited themselves are cached in FILENAME.eco.d (or -R)\n"
+	"  -S, --server   run the netlists requested on stdin by lines of\n"
+	"                 \"run<TAB>NETLIST<TAB>DATASET\", answer \"done STATUS\"\n"
 #if DEBUG
     "  -l, --listing  emit C-code for available definitions\n"
 #endif
@@ -121,12 +310,70 @@ int main (int argc, char ** argv) {
     else if (!strcmp (argv[i], "-b") || !strcmp (argv[i], "--bar")) {
       progressbar_enable = 1;
     }
+    else if (!strcmp (argv[i], "-q") || !strcmp (argv[i], "--quiet")) {
+      logsetlevel (LOG_ERROR);
+    }
     else if (!strcmp (argv[i], "-g") || !strcmp (argv[i], "--gui")) {
       progressbar_gui = 1;
     }
     else if (!strcmp (argv[i], "-c") || !strcmp (argv[i], "--check")) {
       netlist_check = 1;
     }
+    else if (!strcmp (argv[i], "-s") || !strcmp (argv[i], "--stream")) {
+      opts.stream = 1;
+    }
+    else if (!strcmp (argv[i], "-k") || !strcmp (argv[i], "--chunk")) {
+      if (i + 1 < argc) opts.chunk = atoi (argv[++i]);
+      if (opts.chunk <= 0) opts.chunk = DATASET_CHUNK;
+    }
+    else if (!strcmp (argv[i], "-B") || !strcmp (argv[i], "--binary")) {
+      opts.binary = 1;
+    }
+    else if (!strcmp (argv[i], "-z") || !strcmp (argv[i], "--compress")) {
+      opts.binary = 2;
+    }
+    else if (!strcmp (argv[i], "-d") || !strcmp (argv[i], "--digits")) {
+      if (i + 1 < argc) opts.digits = atoi (argv[++i]);
+      if (opts.digits < 0 || opts.digits > DTOA_DIGITS) opts.digits = 0;
+    }
+    else if (!strcmp (argv[i], "-T") || !strcmp (argv[i], "--templates")) {
+      netlist_templates = 1;
+    }
+    else if (!strcmp (argv[i], "-j") || !strcmp (argv[i], "--jobs")) {
+      if (i + 1 < argc) opts.jobs = atoi (argv[++i]);
+      if (opts.jobs <= 0) opts.jobs = threadpool::threads (0);
+    }
+    else if (!strcmp (argv[i], "-w") || !strcmp (argv[i], "--threads")) {
+      if (i + 1 < argc) threadpool::setThreads (atoi (argv[++i]));
+    }
+    else if (!strcmp (argv[i], "-x") || !strcmp (argv[i], "--reproducible")) {
+      reproducible = 1;
+    }
+    else if (!strcmp (argv[i], "-P") || !strcmp (argv[i], "--profile")) {
+      opts.profiling = 1;
+    }
+    else if (!strcmp (argv[i], "-C") || !strcmp (argv[i], "--convergence")) {
+      convreport::enable ();
+    }
+    else if (!strcmp (argv[i], "-K") || !strcmp (argv[i], "--checkpoint")) {
+      checkpoints = CHECKPOINT_INTERVAL;
+      if (i + 1 < argc && atoi (argv[i + 1]) > 0) checkpoints = atoi (argv[++i]);
+    }
+    else if (!strcmp (argv[i], "-r") || !strcmp (argv[i], "--resume")) {
+      resume = 1;
+    }
+    else if (!strcmp (argv[i], "-R") || !strcmp (argv[i], "--cache")) {
+      if (i + 1 < argc) cachedir = argv[++i];
+    }
+    else if (!strcmp (argv[i], "-E") || !strcmp (argv[i], "--eco")) {
+      incremental = 1;
+    }
+    else if (!strcmp (argv[i], "-t") || !strcmp (argv[i], "--trace")) {
+      if (i + 1 < argc) tracefile = argv[++i];
+    }
+    else if (!strcmp (argv[i], "-S") || !strcmp (argv[i], "--server")) {
+      server = 1;
+    }
     else if (!strcmp (argv[i], "-l") || !strcmp (argv[i], "--listing")) {
       listing = 1;
     }
@@ -144,6 +391,35 @@ int main (int argc, char ** argv) {
     }
   }
 
+  if (opts.profiling) profile::enable ();
+  if (checkpoints || resume) {
+    checkpoint::enable (outfile ? outfile : "qucsator",
+			checkpoints ? checkpoints : CHECKPOINT_INTERVAL);
+    if (resume) checkpoint::resume ();
+  }
+  if (tracefile == NULL) tracefile = getenv ("QUCS_TRACE");
+  if (cachedir == NULL) cachedir = getenv ("QUCS_CACHE");
+  if (getenv ("QUCS_REPRODUCIBLE") && atoi (getenv ("QUCS_REPRODUCIBLE")))
+    reproducible = 1;
+  if (reproducible) {
+    // random numbers of the equations from a fixed seed
+    analysis::setReproducible (true);
+    ::srand (1);
+  }
+  if (incremental && !server) {
+    eco::enable (outfile ? outfile : "qucsator");
+    if (cachedir == NULL || !*cachedir) resultcache::enable (eco::directory ());
+  }
+  if (cachedir != NULL && *cachedir) resultcache::enable (cachedir);
+  if (tracefile != NULL) {
+#if ENABLE_TRACE
+    trace::start (tracefile);
+#else
+    logprint (LOG_STATUS, "warning: tracing not compiled in, "
+	      "configure with --enable-trace\n");
+#endif
+  }
+
   // create static modules
   module::registerModules ();
 
@@ -161,7 +437,7 @@ int main (int argc, char ** argv) {
     module::registerDynamicModules (projPath, vamodules);
   }
 
-  else { //no argument, look into netlist
+  else if (!server) { //no argument, look into netlist
 
     std::string sLine = "";
     std::ifstream file;
@@ -217,58 +493,17 @@ int main (int argc, char ** argv) {
   }
 
 
-  // create root environment
-  root = new environment (std::string("root"));
+  if (server)
+    ret = serve (opts);
+  else
+    ret = simulate (infile, outfile, opts);
 
-  // create netlist object and input
-  subnet = new net ("subnet");
-  in = infile ? new input (infile) : new input ();
-
-  // pass root environment to netlist object and input
-  subnet->setEnv (root);
-  in->setEnv (root);
-
-  // get input netlist
-  if (in->netlist (subnet) != 0) {
-    if (netlist_check) {
-      logprint (LOG_STATUS, "checker notice, netlist check FAILED\n");
-    }
-    return -1;
-  }
-  if (netlist_check) {
-    logprint (LOG_STATUS, "checker notice, netlist OK\n");
-    return 0;
-  }
-
-  // attach a ground to the netlist
-  gnd = new ground ();
-  gnd->setNode (0, "gnd");
-  gnd->setName ("GND");
-  subnet->insertCircuit (gnd);
-
-  // analyse the netlist
-  int err = 0;
-  out = subnet->runAnalysis (err);
-  ret |= err;
-
-  // evaluate output dataset
-  ret |= root->equationSolver (out);
-  out->setFile (outfile);
-  out->print ();
-
-  estack.print ("uncaught");
-
-  delete subnet;
-  delete in;
-  delete out;
-  delete root;
+  trace::write ();
 
   // delete static modules and dynamic modules
   module::unregisterModules ();
 
   // close all the dynamic libs if any opened
   module::closeDynamicLibs();
-
-  netlist_destroy_env ();
   return ret;
 }
@@ -0,0 +1,594 @@
+/*
+ * vectfit.cpp - rational approximation by vector fitting implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+
+#include "complex.h"
+#include "matrix.h"
+#include "constants.h"
+#include "vectfit.h"
+
+namespace qucs {
+
+typedef std::vector<nr_double_t> dense;
+
+vectfit::vectfit () : ports (0), rms (0), scaling (1) {
+}
+
+// Returns the number of real unknowns of the given poles.
+static int order (const std::vector<nr_complex_t> & p) {
+  int n = 0;
+  for (const nr_complex_t & k : p) n += imag (k) != 0 ? 2 : 1;
+  return n;
+}
+
+/* Computes the real basis functions of the given poles at the given
+   (normalized) frequency.  A pair of complex poles is represented by
+   1/(s-p) + 1/(s-p*) and j/(s-p) - j/(s-p*), such that its real
+   coefficients are the real and imaginary part of its residue. */
+static void basis (const std::vector<nr_complex_t> & p, nr_complex_t s,
+		   nr_complex_t * phi) {
+  int n = 0;
+  for (const nr_complex_t & k : p) {
+    if (imag (k) == 0) {
+      phi[n++] = 1.0 / (s - k);
+    } else {
+      nr_complex_t a = 1.0 / (s - k), b = 1.0 / (s - conj (k));
+      phi[n++] = a + b;
+      phi[n++] = nr_complex_t (0, 1) * (a - b);
+    }
+  }
+}
+
+/* Reduces the given row-major matrix to upper triangular form using
+   Householder reflections.  Columns beyond the unknowns are the right
+   hand sides and get transformed along. */
+static void triangularize (dense & a, int rows, int cols) {
+  int n = std::min (rows, cols);
+  for (int k = 0; k < n; k++) {
+    nr_double_t norm = 0, vv = 0, alpha;
+    for (int i = k; i < rows; i++) norm += a[i * cols + k] * a[i * cols + k];
+    if (norm == 0) continue;
+    norm = std::sqrt (norm);
+    alpha = a[k * cols + k] > 0 ? -norm : norm;
+    a[k * cols + k] -= alpha;
+    for (int i = k; i < rows; i++) vv += a[i * cols + k] * a[i * cols + k];
+    for (int j = k + 1; j < cols; j++) {
+      nr_double_t dot = 0;
+      for (int i = k; i < rows; i++) dot += a[i * cols + k] * a[i * cols + j];
+      dot *= 2 / vv;
+      for (int i = k; i < rows; i++) a[i * cols + j] -= dot * a[i * cols + k];
+    }
+    a[k * cols + k] = alpha;
+    for (int i = k + 1; i < rows; i++) a[i * cols + k] = 0;
+  }
+}
+
+/* Solves the least squares problem for the first n columns of the
+   given row-major matrix and the right hand side in column n.  The
+   columns are scaled to unit length beforehand. */
+static void lsq (dense & a, int rows, int cols, int n, nr_double_t * x) {
+  std::vector<nr_double_t> scale (n, 1);
+  for (int j = 0; j < n; j++) {
+    nr_double_t norm = 0;
+    for (int i = 0; i < rows; i++) norm += a[i * cols + j] * a[i * cols + j];
+    if (norm > 0) {
+      scale[j] = 1 / std::sqrt (norm);
+      for (int i = 0; i < rows; i++) a[i * cols + j] *= scale[j];
+    }
+  }
+  triangularize (a, rows, cols);
+  for (int i = std::min (n, rows) - 1; i >= 0; i--) {
+    nr_double_t v = a[i * cols + n];
+    for (int j = i + 1; j < n; j++) v -= a[i * cols + j] * x[j];
+    x[i] = a[i * cols + i] != 0 ? v / a[i * cols + i] : 0;
+  }
+  for (int j = 0; j < n; j++) x[j] *= scale[j];
+}
+
+/* Reduces the general matrix (indices starting at 1) to upper
+   Hessenberg form by elimination with pivoting. */
+static void hessenberg (std::vector<dense> & a, int n) {
+  for (int m = 2; m < n; m++) {
+    nr_double_t x = 0;
+    int i = m;
+    for (int j = m; j <= n; j++) {
+      if (std::fabs (a[j][m - 1]) > std::fabs (x)) {
+	x = a[j][m - 1];
+	i = j;
+      }
+    }
+    if (i != m) {
+      for (int j = m - 1; j <= n; j++) std::swap (a[i][j], a[m][j]);
+      for (int j = 1; j <= n; j++) std::swap (a[j][i], a[j][m]);
+    }
+    if (x != 0) {
+      for (i = m + 1; i <= n; i++) {
+	nr_double_t y = a[i][m - 1];
+	if (y != 0) {
+	  y /= x;
+	  a[i][m - 1] = y;
+	  for (int j = m; j <= n; j++) a[i][j] -= y * a[m][j];
+	  for (int j = 1; j <= n; j++) a[j][m] += y * a[j][i];
+	}
+      }
+    }
+  }
+  for (int i = 3; i <= n; i++)
+    for (int j = 1; j < i - 1; j++) a[i][j] = 0;
+}
+
+/* Computes the eigenvalues of the upper Hessenberg matrix (indices
+   starting at 1) by the shifted QR algorithm.  Returns zero on
+   success. */
+static int eigenvalues (std::vector<dense> & a, int n, nr_double_t * wr,
+			nr_double_t * wi) {
+  int nn, m, l, k, j, its, i, mmin;
+  nr_double_t z = 0, y, x, w, v, u, t, s, r = 0, q = 0, p = 0, anorm = 0;
+
+  for (i = 1; i <= n; i++)
+    for (j = std::max (i - 1, 1); j <= n; j++) anorm += std::fabs (a[i][j]);
+  nn = n;
+  t = 0;
+  while (nn >= 1) {
+    its = 0;
+    do {
+      for (l = nn; l >= 2; l--) {
+	s = std::fabs (a[l - 1][l - 1]) + std::fabs (a[l][l]);
+	if (s == 0) s = anorm;
+	if (std::fabs (a[l][l - 1]) + s == s) {
+	  a[l][l - 1] = 0;
+	  break;
+	}
+      }
+      x = a[nn][nn];
+      if (l == nn) {
+	wr[nn] = x + t;
+	wi[nn--] = 0;
+      } else {
+	y = a[nn - 1][nn - 1];
+	w = a[nn][nn - 1] * a[nn - 1][nn];
+	if (l == nn - 1) {
+	  p = 0.5 * (y - x);
+	  q = p * p + w;
+	  z = std::sqrt (std::fabs (q));
+	  x += t;
+	  if (q >= 0) {
+	    z = p + (p >= 0 ? std::fabs (z) : -std::fabs (z));
+	    wr[nn - 1] = wr[nn] = x + z;
+	    if (z != 0) wr[nn] = x - w / z;
+	    wi[nn - 1] = wi[nn] = 0;
+	  } else {
+	    wr[nn - 1] = wr[nn] = x + p;
+	    wi[nn - 1] = -(wi[nn] = z);
+	  }
+	  nn -= 2;
+	} else {
+	  if (its == 30) return -1;
+	  if (its == 10 || its == 20) {
+	    t += x;
+	    for (i = 1; i <= nn; i++) a[i][i] -= x;
+	    s = std::fabs (a[nn][nn - 1]) + std::fabs (a[nn - 1][nn - 2]);
+	    y = x = 0.75 * s;
+	    w = -0.4375 * s * s;
+	  }
+	  ++its;
+	  for (m = nn - 2; m >= l; m--) {
+	    z = a[m][m];
+	    r = x - z;
+	    s = y - z;
+	    p = (r * s - w) / a[m + 1][m] + a[m][m + 1];
+	    q = a[m + 1][m + 1] - z - r - s;
+	    r = a[m + 2][m + 1];
+	    s = std::fabs (p) + std::fabs (q) + std::fabs (r);
+	    p /= s;
+	    q /= s;
+	    r /= s;
+	    if (m == l) break;
+	    u = std::fabs (a[m][m - 1]) * (std::fabs (q) + std::fabs (r));
+	    v = std::fabs (p) * (std::fabs (a[m - 1][m - 1]) + std::fabs (z) +
+				 std::fabs (a[m + 1][m + 1]));
+	    if (u + v == v) break;
+	  }
+	  for (i = m + 2; i <= nn; i++) {
+	    a[i][i - 2] = 0;
+	    if (i != m + 2) a[i][i - 3] = 0;
+	  }
+	  for (k = m; k <= nn - 1; k++) {
+	    if (k != m) {
+	      p = a[k][k - 1];
+	      q = a[k + 1][k - 1];
+	      r = 0;
+	      if (k != nn - 1) r = a[k + 2][k - 1];
+	      if ((x = std::fabs (p) + std::fabs (q) + std::fabs (r)) != 0) {
+		p /= x;
+		q /= x;
+		r /= x;
+	      }
+	    }
+	    s = std::sqrt (p * p + q * q + r * r);
+	    if (p < 0) s = -s;
+	    if (s != 0) {
+	      if (k == m) {
+		if (l != m) a[k][k - 1] = -a[k][k - 1];
+	      } else
+		a[k][k - 1] = -s * x;
+	      p += s;
+	      x = p / s;
+	      y = q / s;
+	      z = r / s;
+	      q /= p;
+	      r /= p;
+	      for (j = k; j <= nn; j++) {
+		p = a[k][j] + q * a[k + 1][j];
+		if (k != nn - 1) {
+		  p += r * a[k + 2][j];
+		  a[k + 2][j] -= p * z;
+		}
+		a[k + 1][j] -= p * y;
+		a[k][j] -= p * x;
+	      }
+	      mmin = nn < k + 3 ? nn : k + 3;
+	      for (i = l; i <= mmin; i++) {
+		p = x * a[i][k] + y * a[i][k + 1];
+		if (k != nn - 1) {
+		  p += z * a[i][k + 2];
+		  a[i][k + 2] -= p * r;
+		}
+		a[i][k + 1] -= p * q;
+		a[i][k] -= p;
+	      }
+	    }
+	  }
+	}
+      }
+    } while (l < nn - 1);
+  }
+  return 0;
+}
+
+/* Relocates the given poles once.  The weighting function sigma(s) =
+   1 + sum c~n phin(s) is fitted such that sigma(s) H(s) is a rational
+   function with the given poles, the zeros of sigma become the new
+   poles.  The unknowns of the individual entries are eliminated by a
+   QR decomposition each.  Returns zero on success. */
+int vectfit::iterate (const std::vector<nr_complex_t> & p,
+		      std::vector<nr_complex_t> & res) {
+  int N = order (p), M = (int) s.size (), E = ports * ports;
+  int rows = 2 * M, cols = 2 * N + 2;
+  dense a (rows * cols), st (E * N * (N + 1));
+  std::vector<nr_complex_t> phi (N);
+
+  for (int e = 0; e < E; e++) {
+    int r = e / ports, c = e % ports;
+    for (int m = 0; m < M; m++) {
+      nr_complex_t f = samples[m] (r, c);
+      nr_double_t * re = &a[(2 * m) * cols], * im = &a[(2 * m + 1) * cols];
+      basis (p, s[m], phi.data ());
+      for (int n = 0; n < N; n++) {
+	re[n] = real (phi[n]);
+	im[n] = imag (phi[n]);
+	re[N + 1 + n] = -real (f * phi[n]);
+	im[N + 1 + n] = -imag (f * phi[n]);
+      }
+      re[N] = 1;
+      im[N] = 0;
+      re[2 * N + 1] = real (f);
+      im[2 * N + 1] = imag (f);
+    }
+    triangularize (a, rows, cols);
+    // equations of the weighting function only
+    for (int i = 0; i < N; i++)
+      for (int j = 0; j <= N; j++)
+	st[(e * N + i) * (N + 1) + j] = a[(N + 1 + i) * cols + N + 1 + j];
+  }
+  std::vector<nr_double_t> ct (N);
+  lsq (st, E * N, N + 1, N, ct.data ());
+
+  // the zeros of sigma are the eigenvalues of A - b c~^T
+  std::vector<dense> h (N + 1, dense (N + 1, 0));
+  std::vector<nr_double_t> b (N + 1, 0), wr (N + 1), wi (N + 1);
+  for (int k = 0, n = 1; k < (int) p.size (); k++) {
+    if (imag (p[k]) == 0) {
+      h[n][n] = real (p[k]);
+      b[n++] = 1;
+    } else {
+      h[n][n] = h[n + 1][n + 1] = real (p[k]);
+      h[n][n + 1] = imag (p[k]);
+      h[n + 1][n] = -imag (p[k]);
+      b[n] = 2;
+      n += 2;
+    }
+  }
+  for (int i = 1; i <= N; i++)
+    for (int j = 1; j <= N; j++) h[i][j] -= b[i] * ct[j - 1];
+  hessenberg (h, N);
+  if (eigenvalues (h, N, wr.data (), wi.data ())) return -1;
+
+  // keep the upper of each pair, flip unstable poles
+  res.clear ();
+  for (int n = 1; n <= N; n++) {
+    if (wi[n] < 0) continue;
+    nr_double_t re = -std::fabs (wr[n]);
+    if (re == 0) re = -1e-6;
+    res.push_back (nr_complex_t (re, wi[n]));
+  }
+  return 0;
+}
+
+/* Computes the residues and the constant term for the given poles and
+   converts the model to physical frequencies.  Returns the RMS error
+   of the model. */
+nr_double_t vectfit::residue (const std::vector<nr_complex_t> & p) {
+  int N = order (p), M = (int) s.size (), E = ports * ports;
+  int rows = 2 * M, cols = N + 2;
+  dense a (rows * cols);
+  std::vector<nr_complex_t> phi (N);
+  std::vector<nr_double_t> x (N + 1);
+
+  poles.resize (p.size ());
+  for (int k = 0; k < (int) p.size (); k++) poles[k] = p[k] * scaling;
+  residues.assign (p.size (), matrix (ports));
+  D = matrix (ports);
+
+  for (int e = 0; e < E; e++) {
+    int r = e / ports, c = e % ports;
+    for (int m = 0; m < M; m++) {
+      nr_complex_t f = samples[m] (r, c);
+      nr_double_t * re = &a[(2 * m) * cols], * im = &a[(2 * m + 1) * cols];
+      basis (p, s[m], phi.data ());
+      for (int n = 0; n < N; n++) {
+	re[n] = real (phi[n]);
+	im[n] = imag (phi[n]);
+      }
+      re[N] = 1;
+      im[N] = 0;
+      re[N + 1] = real (f);
+      im[N + 1] = imag (f);
+    }
+    lsq (a, rows, cols, N + 1, x.data ());
+    for (int k = 0, n = 0; k < (int) p.size (); k++) {
+      if (imag (p[k]) == 0) {
+	residues[k] (r, c) = x[n++] * scaling;
+      } else {
+	residues[k] (r, c) = nr_complex_t (x[n], x[n + 1]) * scaling;
+	n += 2;
+      }
+    }
+    D (r, c) = x[N];
+  }
+
+  nr_double_t err = 0;
+  for (int m = 0; m < M; m++) {
+    matrix h = evaluate (s[m] * scaling);
+    for (int e = 0; e < E; e++)
+      err += norm (h (e / ports, e % ports) - samples[m] (e / ports, e % ports));
+  }
+  return rms = std::sqrt (err / (M * E));
+}
+
+/* Fits the model to the given matrices sampled at the given
+   frequencies.  A pole count of zero selects the smallest number of
+   poles reaching VECTFIT_TOLERANCE.  Returns zero on success. */
+int vectfit::fit (const std::vector<nr_double_t> & freq,
+		  const std::vector<matrix> & data, int npoles, int iterations) {
+  int M = (int) freq.size ();
+  if (M < 2 || (int) data.size () != M) return -1;
+  ports = data[0].getRows ();
+  samples = data;
+
+  // normalize the frequencies to the largest one
+  nr_double_t fmax = *std::max_element (freq.begin (), freq.end ());
+  if (fmax <= 0) return -1;
+  scaling = 2 * pi * fmax;
+  s.resize (M);
+  for (int m = 0; m < M; m++) s[m] = nr_complex_t (0, freq[m] / fmax);
+  nr_double_t lo = 1;
+  for (int m = 0; m < M; m++)
+    if (freq[m] > 0) lo = std::min (lo, freq[m] / fmax);
+
+  // the unknowns per entry must not outnumber the equations
+  int most = std::min (VECTFIT_MAXPOLES, M - 1);
+  int first = npoles > 0 ? std::min (npoles, most) : std::min (2, most);
+  int last = npoles > 0 ? first : most;
+  if (first < 1) return -1;
+
+  std::vector<nr_complex_t> bpoles;
+  std::vector<matrix> bresidues;
+  matrix bD;
+  nr_double_t brms = -1;
+  for (int N = first; N <= last; N += 2) {
+    // initial complex pairs with weak damping spread over the band
+    std::vector<nr_complex_t> p, q;
+    int pairs = N / 2;
+    for (int k = 0; k < pairs; k++) {
+      nr_double_t b = pairs > 1 ? lo + (1 - lo) * k / (pairs - 1) : (lo + 1) / 2;
+      p.push_back (nr_complex_t (-b / 100, b));
+    }
+    if (N % 2) p.push_back (nr_complex_t (-1, 0));
+
+    for (int i = 0; i < iterations; i++) {
+      if (iterate (p, q)) break;
+      p = q;
+    }
+    nr_double_t err = residue (p);
+    if (brms < 0 || err < brms) {
+      bpoles = poles;
+      bresidues = residues;
+      bD = D;
+      brms = err;
+    }
+    if (brms < VECTFIT_TOLERANCE) break;
+  }
+  poles = bpoles;
+  residues = bresidues;
+  D = bD;
+  rms = brms;
+  return std::isfinite (rms) ? 0 : -1;
+}
+
+/* Evaluates the model at the given complex frequency. */
+matrix vectfit::evaluate (nr_complex_t sv) const {
+  matrix h = D;
+  for (int k = 0; k < (int) poles.size (); k++) {
+    nr_complex_t a = 1.0 / (sv - poles[k]), b = 1.0 / (sv - conj (poles[k]));
+    bool pair = isPair (k);
+    for (int r = 0; r < ports; r++)
+      for (int c = 0; c < ports; c++) {
+	nr_complex_t R = residues[k] (r, c);
+	h (r, c) += pair ? R * a + conj (R) * b : R * a;
+      }
+  }
+  return h;
+}
+
+/* Evaluates the model at the given frequency. */
+matrix vectfit::response (nr_double_t f) const {
+  return evaluate (nr_complex_t (0, 2 * pi * f));
+}
+
+// Returns the largest singular value of the given matrix.
+static nr_double_t sigma (const matrix & h) {
+  matrix g = adjoint (h) * h;
+  int n = g.getRows ();
+  matrix v (n, 1);
+  for (int i = 0; i < n; i++) v (i, 0) = 1 + 0.1 * i;
+  nr_double_t l = 0;
+  for (int i = 0; i < 50; i++) {
+    matrix w = g * v;
+    nr_double_t len = 0;
+    for (int r = 0; r < n; r++) len += norm (w (r, 0));
+    len = std::sqrt (len);
+    if (len == 0) return 0;
+    l = len;
+    v = w / len;
+  }
+  return std::sqrt (l);
+}
+
+/* Returns the largest gain of the model, i.e. the largest singular
+   value at the given frequencies, at DC and at infinity.  A gain
+   larger than one means the model is not passive. */
+nr_double_t vectfit::gain (const std::vector<nr_double_t> & freq) const {
+  nr_double_t g = std::max (sigma (D), sigma (evaluate (0)));
+  for (nr_double_t f : freq) g = std::max (g, sigma (response (f)));
+  return g;
+}
+
+/* Scales the model by the given factor. */
+void vectfit::scale (nr_double_t f) {
+  for (matrix & r : residues) r = r * f;
+  D = D * f;
+}
+
+/* Computes the recursive convolution coefficients of the pole p for
+   the step h.  With the incident wave being linear in between, the
+   state x' = p x + a evolves as x(t+h) = alpha x(t) + b1 a(t) + b0
+   a(t+h). */
+void vectfit::recursion (nr_complex_t p, nr_double_t h, nr_complex_t & alpha,
+			nr_complex_t & b0, nr_complex_t & b1) {
+  nr_complex_t z = p * h, i0;
+  alpha = std::exp (z);
+  if (abs (z) < 1e-3) {
+    i0 = h * (1.0 + z / 2.0 + z * z / 6.0);
+    b0 = h * (0.5 + z / 6.0 + z * z / 24.0);
+  } else {
+    i0 = (alpha - 1.0) / p;
+    b0 = ((alpha - 1.0) / z - 1.0) / p;
+  }
+  b1 = i0 - b0;
+}
+
+/* Saves the model into the given file, the key identifies the data it
+   has been fitted to.  Returns zero on success. */
+int vectfit::save (const char * file, const std::string & key) const {
+  FILE * f = fopen (file, "w");
+  if (f == NULL) return -1;
+  fprintf (f, "# qucsator vector fitting model\n%s\n%d %d %.17g\n",
+	   key.c_str (), ports, getPoles (), (double) rms);
+  for (int k = 0; k < getPoles (); k++) {
+    fprintf (f, "%.17g %.17g\n", (double) real (poles[k]),
+	     (double) imag (poles[k]));
+    for (int r = 0; r < ports; r++)
+      for (int c = 0; c < ports; c++)
+	fprintf (f, "%.17g %.17g\n", (double) real (residues[k] (r, c)),
+		 (double) imag (residues[k] (r, c)));
+  }
+  for (int r = 0; r < ports; r++)
+    for (int c = 0; c < ports; c++)
+      fprintf (f, "%.17g %.17g\n", (double) real (D (r, c)),
+	       (double) imag (D (r, c)));
+  int ret = ferror (f) ? -1 : 0;
+  fclose (f);
+  return ret;
+}
+
+// Reads a complex value from the given file.
+static bool scan (FILE * f, nr_complex_t & z) {
+  double re, im;
+  if (fscanf (f, "%lg %lg", &re, &im) != 2) return false;
+  z = nr_complex_t (re, im);
+  return true;
+}
+
+/* Loads a model saved under the given key.  Returns zero on success,
+   non-zero if there is no such file or it belongs to other data. */
+int vectfit::load (const char * file, const std::string & key) {
+  FILE * f = fopen (file, "r");
+  if (f == NULL) return -1;
+  char line[256];
+  int np, nk, ret = -1;
+  double err;
+  if (fgets (line, sizeof (line), f) && fgets (line, sizeof (line), f)) {
+    line[strcspn (line, "\r\n")] = '\0';
+    if (key == line && fscanf (f, "%d %d %lg", &np, &nk, &err) == 3 &&
+	np > 0 && nk >= 0) {
+      ports = np;
+      rms = err;
+      poles.resize (nk);
+      residues.assign (nk, matrix (np));
+      D = matrix (np);
+      bool ok = true;
+      for (int k = 0; ok && k < nk; k++) {
+	ok = scan (f, poles[k]);
+	for (int r = 0; ok && r < np; r++)
+	  for (int c = 0; ok && c < np; c++) ok = scan (f, residues[k] (r, c));
+      }
+      for (int r = 0; ok && r < np; r++)
+	for (int c = 0; ok && c < np; c++) ok = scan (f, D (r, c));
+      if (ok) ret = 0;
+    }
+  }
+  fclose (f);
+  return ret;
+}
+
+} // namespace qucs
@@ -0,0 +1,96 @@
+/*
+ * vectfit.h - rational approximation by vector fitting definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __VECTFIT_H__
+#define __VECTFIT_H__
+
+#include <string>
+#include <vector>
+
+namespace qucs {
+
+// pole relocation iterations
+#define VECTFIT_ITERATIONS 8
+
+// largest number of poles tried by the automatic order selection
+#define VECTFIT_MAXPOLES   40
+
+// RMS error accepted by the automatic order selection
+#define VECTFIT_TOLERANCE  1e-3
+
+/*! \class vectfit
+ * \brief pole-residue model of sampled matrix transfer functions.
+ *
+ * The samples H(j2πf) of a square matrix function are approximated by
+ *
+ *   H(s) = D + Σk Rk / (s - pk)
+ *
+ * using the vector fitting method of Gustavsen and Semlyen.  All the
+ * entries share the same stable poles, complex poles come in conjugate
+ * pairs.  The poles and residues of such a pair are stored once, with
+ * the pole in the upper half plane.
+ */
+class vectfit
+{
+ public:
+  vectfit ();
+
+  int fit (const std::vector<nr_double_t> &, const std::vector<matrix> &,
+	   int, int iterations = VECTFIT_ITERATIONS);
+  matrix evaluate (nr_complex_t) const;
+  matrix response (nr_double_t) const;
+  nr_double_t gain (const std::vector<nr_double_t> &) const;
+  void scale (nr_double_t);
+
+  int getPorts (void) const { return ports; }
+  int getPoles (void) const { return (int) poles.size (); }
+  bool isPair (int k) const { return imag (poles[k]) != 0; }
+  nr_double_t getError (void) const { return rms; }
+
+  static void recursion (nr_complex_t, nr_double_t, nr_complex_t &,
+			 nr_complex_t &, nr_complex_t &);
+
+  int save (const char *, const std::string &) const;
+  int load (const char *, const std::string &);
+
+ public:
+  std::vector<nr_complex_t> poles;
+  std::vector<matrix> residues;
+  matrix D;
+
+ private:
+  int iterate (const std::vector<nr_complex_t> &, std::vector<nr_complex_t> &);
+  nr_double_t residue (const std::vector<nr_complex_t> &);
+
+ private:
+  int ports;
+  nr_double_t rms;
+  nr_double_t scaling;
+  std::vector<nr_complex_t> s;
+  std::vector<matrix> samples;
+};
+
+} // namespace qucs
+
+#endif /* __VECTFIT_H__ */
@@ -27,7 +27,12 @@
 # include <config.h>
 #endif
 
+#include <algorithm>
 #include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -46,6 +51,158 @@
 
 namespace qucs {
 
+/* Plain complex product used by the element-wise kernels.  Unlike the
+   library operator it carries no C99 Annex G recovery branches in the
+   common case and thus lets the compiler vectorise the loop. */
+static inline nr_complex_t cmul (const nr_complex_t a, const nr_complex_t b) {
+  nr_double_t r = real (a) * real (b) - imag (a) * imag (b);
+  nr_double_t i = real (a) * imag (b) + imag (a) * real (b);
+  if (std::isnan (r) && std::isnan (i)) return a * b;
+  return nr_complex_t (r, i);
+}
+
+/* Number of values the split kernels below work on at once. */
+#define VECTOR_SPLIT_BLOCK 256
+
+/* The split kernels de-interleave a block of complex values into
+   separate arrays of real and imaginary parts, evaluate the function
+   on these plain real arrays and interleave the results back.  The
+   loops then only contain real operations the compiler is able to
+   vectorise, while the vector keeps its usual storage.  The formulas
+   are the ones of the complex functions in math/complex.cpp. */
+static inline void split (const nr_complex_t * z, int n,
+			  nr_double_t * re, nr_double_t * im) {
+  const nr_double_t * p = reinterpret_cast<const nr_double_t *> (z);
+  for (int i = 0; i < n; i++) {
+    re[i] = p[2 * i];
+    im[i] = p[2 * i + 1];
+  }
+}
+
+static inline void merge (nr_complex_t * z, int n,
+			  const nr_double_t * re, const nr_double_t * im) {
+  nr_double_t * p = reinterpret_cast<nr_double_t *> (z);
+  for (int i = 0; i < n; i++) {
+    p[2 * i] = re[i];
+    p[2 * i + 1] = im[i];
+  }
+}
+
+// Computes exp(z) of each complex value in place.
+static void split_exp (nr_complex_t * z, int len) {
+  nr_double_t re[VECTOR_SPLIT_BLOCK], im[VECTOR_SPLIT_BLOCK];
+  for (int b = 0; b < len; b += VECTOR_SPLIT_BLOCK) {
+    int n = std::min (len - b, VECTOR_SPLIT_BLOCK);
+    split (z + b, n, re, im);
+    for (int i = 0; i < n; i++) {
+      nr_double_t mag = std::exp (re[i]);
+      re[i] = mag * std::cos (im[i]);
+      im[i] = mag * std::sin (im[i]);
+    }
+    merge (z + b, n, re, im);
+  }
+}
+
+// Computes log(z) of each complex value in place, scaled by the given
+// factor (e.g. log10e for decimal logarithms).
+static void split_log (nr_complex_t * z, int len, nr_double_t scale) {
+  nr_double_t re[VECTOR_SPLIT_BLOCK], im[VECTOR_SPLIT_BLOCK];
+  for (int b = 0; b < len; b += VECTOR_SPLIT_BLOCK) {
+    int n = std::min (len - b, VECTOR_SPLIT_BLOCK);
+    split (z + b, n, re, im);
+    for (int i = 0; i < n; i++) {
+      nr_double_t phi = std::atan2 (im[i], re[i]);
+      re[i] = std::log (std::hypot (re[i], im[i]));
+      im[i] = phi;
+    }
+    if (scale != 1.0) {
+      for (int i = 0; i < n; i++) {
+	re[i] *= scale;
+	im[i] *= scale;
+      }
+    }
+    merge (z + b, n, re, im);
+  }
+}
+
+// Replaces each complex value by its magnitude (polar = false) or by
+// its argument (polar = true), both as real numbers.
+static void split_polar (nr_complex_t * z, int len, bool polar) {
+  nr_double_t re[VECTOR_SPLIT_BLOCK], im[VECTOR_SPLIT_BLOCK];
+  for (int b = 0; b < len; b += VECTOR_SPLIT_BLOCK) {
+    int n = std::min (len - b, VECTOR_SPLIT_BLOCK);
+    split (z + b, n, re, im);
+    if (polar) {
+      for (int i = 0; i < n; i++) re[i] = std::atan2 (im[i], re[i]);
+    } else {
+      for (int i = 0; i < n; i++) re[i] = std::hypot (re[i], im[i]);
+    }
+    for (int i = 0; i < n; i++) im[i] = 0.0;
+    merge (z + b, n, re, im);
+  }
+}
+
+/* Dependency set shared by the vectors with equal dependencies.  The
+   results of a sweep have the same few sets, so the names are kept
+   once per set instead of once per vector. */
+struct depset_t {
+  strlist * deps;
+  int refs;
+  std::string key;
+};
+
+// The interned dependency sets by their names, each ended by a newline.
+static std::unordered_map<std::string, depset_t *> & vector_depsets (void) {
+  static std::unordered_map<std::string, depset_t *> * sets =
+    new std::unordered_map<std::string, depset_t *> ();
+  return *sets;
+}
+
+static std::mutex vector_depsets_lock;
+
+/* Returns the interned set equal to the given list which is taken
+   over, i.e. deleted if there is such a set already. */
+static depset_t * vector_intern (strlist * s) {
+  if (s == NULL) return NULL;
+  std::string key;
+  for (strlistiterator it (s); *it; ++it) {
+    key += *it;
+    key += '\n';
+  }
+  std::lock_guard<std::mutex> lock (vector_depsets_lock);
+  depset_t *& d = vector_depsets()[key];
+  if (d != NULL) {
+    delete s;
+  }
+  else {
+    d = new depset_t;
+    d->deps = s;
+    d->refs = 0;
+    d->key = key;
+  }
+  d->refs++;
+  return d;
+}
+
+// Returns another reference to the given set.
+static depset_t * vector_share (depset_t * d) {
+  if (d == NULL) return NULL;
+  std::lock_guard<std::mutex> lock (vector_depsets_lock);
+  d->refs++;
+  return d;
+}
+
+// Drops a reference to the given set, deletes it if it was the last.
+static void vector_release (depset_t * d) {
+  if (d == NULL) return;
+  std::lock_guard<std::mutex> lock (vector_depsets_lock);
+  if (--d->refs == 0) {
+    vector_depsets().erase (d->key);
+    delete d->deps;
+    delete d;
+  }
+}
+
 // Constructor creates an unnamed instance of the vector class.
 vector::vector () : object () {
   capacity = size = 0;
@@ -113,7 +270,7 @@ vector::vector (const vector & v) : object (v) {
   capacity = v.capacity;
   data = (nr_complex_t *) malloc (sizeof (nr_complex_t) * capacity);
   memcpy (data, v.data, sizeof (nr_complex_t) * size);
-  dependencies = v.dependencies ? new strlist (*v.dependencies) : NULL;
+  dependencies = vector_share (v.dependencies);
   origin = v.origin ? strdup (v.origin) : NULL;
   requested = v.requested;
   next = v.next;
@@ -136,22 +293,62 @@ const vector& vector::operator=(const vector & v) {
   return *this;
 }
 
+/* The move constructor takes over the data and properties of the
+   given temporary vector which is left empty. */
+vector::vector (vector && v) : object (std::move (v)) {
+  size = v.size;
+  capacity = v.capacity;
+  data = v.data;
+  dependencies = v.dependencies;
+  origin = v.origin;
+  requested = v.requested;
+  next = v.next;
+  prev = v.prev;
+  v.size = v.capacity = 0;
+  v.data = NULL;
+  v.dependencies = NULL;
+  v.origin = NULL;
+}
+
+/* The move assignment takes over the data of the given temporary
+   vector.  Like the copy assignment it leaves any other properties
+   untouched. */
+vector& vector::operator=(vector && v) {
+  if (&v != this) {
+    std::swap (size, v.size);
+    std::swap (capacity, v.capacity);
+    std::swap (data, v.data);
+  }
+  return *this;
+}
+
 // Destructor deletes a vector object.
 vector::~vector () {
   free (data);
-  delete dependencies;
+  vector_release (dependencies);
   free (origin);
 }
 
-// Returns data dependencies.
+/* Returns data dependencies.  The list is shared with the other
+   vectors of the same dependencies and must not be modified, a new
+   one has to be set instead. */
 strlist * vector::getDependencies (void) {
-  return dependencies;
+  return dependencies ? dependencies->deps : NULL;
 }
 
-// Sets the data dependencies.
+/* Sets the data dependencies.  The given list is taken over and may
+   be deleted right away in favour of an equal one. */
 void vector::setDependencies (strlist * s) {
-  delete dependencies;
-  dependencies = s;
+  depset_t * d = vector_intern (s);
+  vector_release (dependencies);
+  dependencies = d;
+}
+
+// Lets the vector share the data dependencies of the given vector.
+void vector::shareDependencies (vector * v) {
+  depset_t * d = vector_share (v->dependencies);
+  vector_release (dependencies);
+  dependencies = d;
 }
 
 /* The function appends a new complex data item to the end of the
@@ -184,6 +381,36 @@ void vector::add (vector * v) {
   }
 }
 
+/* This function appends the given number of data items to the
+   vector, growing its capacity once. */
+void vector::add (const nr_complex_t * c, int n) {
+  if (n <= 0) return;
+  if (data == NULL) {
+    size = 0; capacity = std::max (n, 64);
+    data = (nr_complex_t *) malloc (sizeof (nr_complex_t) * capacity);
+  }
+  else if (size + n > capacity) {
+    capacity = std::max (2 * capacity, size + n);
+    data = (nr_complex_t *) realloc (data, sizeof (nr_complex_t) * capacity);
+  }
+  for (int i = 0; i < n; i++) data[size++] = c[i];
+}
+
+/* The function makes room for at least the given number of data items
+   without changing the size of the vector.  A growing capacity at least
+   doubles, thus repeated calls are cheap. */
+void vector::reserve (int n) {
+  if (data != NULL && n <= capacity) return;
+  if (data == NULL) {
+    size = 0; capacity = std::max (n, 64);
+    data = (nr_complex_t *) malloc (sizeof (nr_complex_t) * capacity);
+  }
+  else {
+    capacity = std::max (2 * capacity, n);
+    data = (nr_complex_t *) realloc (data, sizeof (nr_complex_t) * capacity);
+  }
+}
+
 // Returns the complex data item at the given position.
 nr_complex_t vector::get (int i) {
   return data[i];
@@ -197,6 +424,12 @@ void vector::set (const nr_complex_t z, int i) {
   data[i] = nr_complex_t (z);
 }
 
+/* The function drops all values of the vector but keeps the allocated
+   memory for new ones. */
+void vector::clear (void) {
+  size = 0;
+}
+
 // The function returns the current size of the vector.
 int vector::getSize (void) const {
   return size;
@@ -335,46 +568,44 @@ vector sinc (vector v) {
 }
 
 vector abs (vector v) {
-  vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result.set (abs (v.get (i)), i);
-  return result;
+  split_polar (v.getData (), v.getSize (), false);
+  return v;
 }
 
 vector norm (vector v) {
-  vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result.set (norm (v.get (i)), i);
-  return result;
+  nr_complex_t * d = v.getData ();
+  for (int i = 0; i < v.getSize (); i++) d[i] = std::norm (d[i]);
+  return v;
 }
 
 vector arg (vector v) {
-  vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result.set (arg (v.get (i)), i);
-  return result;
+  split_polar (v.getData (), v.getSize (), true);
+  return v;
 }
 
 vector real (vector v) {
-  vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result.set (real (v.get (i)), i);
-  return result;
+  nr_complex_t * d = v.getData ();
+  for (int i = 0; i < v.getSize (); i++) d[i] = real (d[i]);
+  return v;
 }
 
 vector imag (vector v) {
-  vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result.set (imag (v.get (i)), i);
-  return result;
+  nr_complex_t * d = v.getData ();
+  for (int i = 0; i < v.getSize (); i++) d[i] = imag (d[i]);
+  return v;
 }
 
 vector conj (vector v) {
-  vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result.set (conj (v.get (i)), i);
-  return result;
+  nr_complex_t * d = v.getData ();
+  for (int i = 0; i < v.getSize (); i++) d[i] = std::conj (d[i]);
+  return v;
 }
 
 vector dB (vector v) {
-  vector result (v);
+  nr_complex_t * d = v.getData ();
   for (int i = 0; i < v.getSize (); i++)
-    result.set (10.0 * std::log10 (norm (v.get (i))), i);
-  return result;
+    d[i] = 10.0 * std::log10 (std::norm (d[i]));
+  return v;
 }
 
 vector sqrt (vector v) {
@@ -384,9 +615,8 @@ vector sqrt (vector v) {
 }
 
 vector exp (vector v) {
-  vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result.set (exp (v.get (i)), i);
-  return result;
+  split_exp (v.getData (), v.getSize ());
+  return v;
 }
 
 vector limexp (vector v) {
@@ -396,15 +626,13 @@ vector limexp (vector v) {
 }
 
 vector log (vector v) {
-  vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result.set (log (v.get (i)), i);
-  return result;
+  split_log (v.getData (), v.getSize (), 1.0);
+  return v;
 }
 
 vector log10 (vector v) {
-  vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result.set (log10 (v.get (i)), i);
-  return result;
+  split_log (v.getData (), v.getSize (), log10e);
+  return v;
 }
 
 vector log2 (vector v) {
@@ -635,29 +863,34 @@ vector diff (vector var, vector dep, int n) {
   return result;
 }
 
-vector vector::operator=(const nr_complex_t c) {
+vector& vector::operator=(const nr_complex_t c) {
   for (int i = 0; i < size; i++) data[i] = c;
   return *this;
 }
 
-vector vector::operator=(const nr_double_t d) {
+vector& vector::operator=(const nr_double_t d) {
   for (int i = 0; i < size; i++) data[i] = d;
   return *this;
 }
 
-vector vector::operator+=(vector v) {
+vector& vector::operator+=(const vector & v) {
   int i, n, len = v.getSize ();
   assert (size % len == 0);
-  for (i = n = 0; i < size; i++) { data[i] += v (n); if (++n >= len) n = 0; }
+  const nr_complex_t * b = v.data;
+  // the shorter vector repeats, so work through contiguous blocks
+  for (i = 0; i < size; i += len) {
+    nr_complex_t * a = data + i;
+    for (n = 0; n < len; n++) a[n] += b[n];
+  }
   return *this;
 }
 
-vector vector::operator+=(const nr_complex_t c) {
+vector& vector::operator+=(const nr_complex_t c) {
   for (int i = 0; i < size; i++) data[i] += c;
   return *this;
 }
 
-vector vector::operator+=(const nr_double_t d) {
+vector& vector::operator+=(const nr_double_t d) {
   for (int i = 0; i < size; i++) data[i] += d;
   return *this;
 }
@@ -701,19 +934,24 @@ vector vector::operator-() {
   return result;
 }
 
-vector vector::operator-=(vector v) {
+vector& vector::operator-=(const vector & v) {
   int i, n, len = v.getSize ();
   assert (size % len == 0);
-  for (i = n = 0; i < size; i++) { data[i] -= v (n); if (++n >= len) n = 0; }
+  const nr_complex_t * b = v.data;
+  // the shorter vector repeats, so work through contiguous blocks
+  for (i = 0; i < size; i += len) {
+    nr_complex_t * a = data + i;
+    for (n = 0; n < len; n++) a[n] -= b[n];
+  }
   return *this;
 }
 
-vector vector::operator-=(const nr_complex_t c) {
+vector& vector::operator-=(const nr_complex_t c) {
   for (int i = 0; i < size; i++) data[i] -= c;
   return *this;
 }
 
-vector vector::operator-=(const nr_double_t d) {
+vector& vector::operator-=(const nr_double_t d) {
   for (int i = 0; i < size; i++) data[i] -= d;
   return *this;
 }
@@ -755,19 +993,24 @@ vector operator-(const nr_double_t d, vector v) {
   return result;
 }
 
-vector vector::operator*=(vector v) {
+vector& vector::operator*=(const vector & v) {
   int i, n, len = v.getSize ();
   assert (size % len == 0);
-  for (i = n = 0; i < size; i++) { data[i] *= v (n); if (++n >= len) n = 0; }
+  const nr_complex_t * b = v.data;
+  // the shorter vector repeats, so work through contiguous blocks
+  for (i = 0; i < size; i += len) {
+    nr_complex_t * a = data + i;
+    for (n = 0; n < len; n++) a[n] = cmul (a[n], b[n]);
+  }
   return *this;
 }
 
-vector vector::operator*=(const nr_complex_t c) {
+vector& vector::operator*=(const nr_complex_t c) {
   for (int i = 0; i < size; i++) data[i] *= c;
   return *this;
 }
 
-vector vector::operator*=(const nr_double_t d) {
+vector& vector::operator*=(const nr_double_t d) {
   for (int i = 0; i < size; i++) data[i] *= d;
   return *this;
 }
@@ -805,19 +1048,24 @@ vector operator*(const nr_double_t d, vector v) {
   return v * d;
 }
 
-vector vector::operator/=(vector v) {
+vector& vector::operator/=(const vector & v) {
   int i, n, len = v.getSize ();
   assert (size % len == 0);
-  for (i = n = 0; i < size; i++) { data[i] /= v (n); if (++n >= len) n = 0; }
+  const nr_complex_t * b = v.data;
+  // the shorter vector repeats, so work through contiguous blocks
+  for (i = 0; i < size; i += len) {
+    nr_complex_t * a = data + i;
+    for (n = 0; n < len; n++) a[n] /= b[n];
+  }
   return *this;
 }
 
-vector vector::operator/=(const nr_complex_t c) {
+vector& vector::operator/=(const nr_complex_t c) {
   for (int i = 0; i < size; i++) data[i] /= c;
   return *this;
 }
 
-vector vector::operator/=(const nr_double_t d) {
+vector& vector::operator/=(const nr_double_t d) {
   for (int i = 0; i < size; i++) data[i] /= d;
   return *this;
 }
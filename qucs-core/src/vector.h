@@ -40,6 +40,7 @@ namespace qucs {
 
 class strlist;
 class vector;
+struct depset_t;
 
 qucs::vector linspace (nr_double_t, nr_double_t, int);
 qucs::vector logspace (nr_double_t, nr_double_t, int);
@@ -64,10 +65,14 @@ class vector : public object
   vector (int, nr_complex_t);
   vector (const std::string &, int);
   vector (const vector &);
+  vector (vector &&);
   const vector& operator = (const vector &);
+  vector& operator = (vector &&);
   ~vector ();
   void add (nr_complex_t);
   void add (vector *);
+  void add (const nr_complex_t *, int);
+  void reserve (int);
   nr_complex_t get (int);
   void set (nr_double_t, int);
   void set (const nr_complex_t, int);
@@ -76,8 +81,10 @@ class vector : public object
   int getRequested (void) { return requested; }
   void setRequested (int n) { requested = n; }
   void reverse (void);
+  void clear (void);
   strlist * getDependencies (void);
   void setDependencies (strlist *);
+  void shareDependencies (vector *);
   void setOrigin (const char *);
   char * getOrigin (void);
   int contains (nr_complex_t, nr_double_t eps = std::numeric_limits<nr_double_t>::epsilon());
@@ -214,30 +221,33 @@ class vector : public object
 
   // assignment operations
   vector operator  - ();
-  vector operator  = (const nr_complex_t);
-  vector operator  = (const nr_double_t);
-  vector operator += (vector);
-  vector operator += (const nr_complex_t);
-  vector operator += (const nr_double_t);
-  vector operator -= (vector);
-  vector operator -= (const nr_complex_t);
-  vector operator -= (const nr_double_t);
-  vector operator *= (vector);
-  vector operator *= (const nr_complex_t);
-  vector operator *= (const nr_double_t);
-  vector operator /= (vector);
-  vector operator /= (const nr_complex_t);
-  vector operator /= (const nr_double_t);
+  vector& operator  = (const nr_complex_t);
+  vector& operator  = (const nr_double_t);
+  vector& operator += (const vector &);
+  vector& operator += (const nr_complex_t);
+  vector& operator += (const nr_double_t);
+  vector& operator -= (const vector &);
+  vector& operator -= (const nr_complex_t);
+  vector& operator -= (const nr_double_t);
+  vector& operator *= (const vector &);
+  vector& operator *= (const nr_complex_t);
+  vector& operator *= (const nr_double_t);
+  vector& operator /= (const vector &);
+  vector& operator /= (const nr_complex_t);
+  vector& operator /= (const nr_double_t);
 
   // easy accessor operators
   nr_complex_t  operator () (int i) const { return data[i]; }
   nr_complex_t& operator () (int i) { return data[i]; }
 
+  // direct access to the contiguous values
+  nr_complex_t * getData (void) { return data; }
+
  private:
   int requested;
   int size;
   int capacity;
-  strlist * dependencies;
+  depset_t * dependencies; // interned, shared by equal sets
   nr_complex_t * data;
   char * origin;
 };
@@ -0,0 +1,114 @@
+/*
+ * Acsolver.cpp - Unit test for the AC noise analysis
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <cmath>
+#include <string>
+
+#include "qucs_typedefs.h"
+#include "netdefs.h"
+#include "components.h"
+#include "dataset.h"
+#include "environment.h"
+#include "equation.h"
+#include "net.h"
+#include "input.h"
+#include "acsolver.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+using namespace qucs;
+
+/* Runs the noise analysis of a resistor in parallel to a lossy
+   capacitor, the latter is noiseless at 0 Hz only.  Returns the given
+   noise voltages, computed by the adjoint noise analysis if requested. */
+static vector noiseVoltages (bool adjoint, const char * name) {
+  environment * root = new environment (std::string ("root"));
+  eqn::checker * checkee = new eqn::checker ();
+  root->setChecker (checkee);
+  root->setSolver (new eqn::solver (checkee));
+  net * subnet = new net ("subnet");
+  subnet->setEnv (root);
+
+  circuit * r = new resistor ();
+  r->setName ("R1");
+  r->setNode (0, "n1");
+  r->setNode (1, "gnd");
+  r->addProperty ("R", 1e3);
+  input::assignDefaultProperties (r, resistor::definition ());
+  subnet->insertCircuit (r);
+
+  circuit * c = new capq ();
+  c->setName ("C1");
+  c->setNode (0, "n1");
+  c->setNode (1, "gnd");
+  c->addProperty ("C", 1e-12);
+  c->addProperty ("Q", 10.0);
+  c->addProperty ("f", 1e8);
+  c->addProperty ("Mode", "Constant");
+  input::assignDefaultProperties (c, capq::definition ());
+  subnet->insertCircuit (c);
+
+  circuit * gnd = new ground ();
+  gnd->setName ("GND");
+  gnd->setNode (0, "gnd");
+  subnet->insertCircuit (gnd);
+
+  analysis * a = new acsolver ();
+  a->setName ("AC1");
+  a->addProperty ("Type", "lin");
+  a->addProperty ("Start", 0.0);
+  a->addProperty ("Stop", 2e8);
+  a->addProperty ("Points", 3.0);
+  a->addProperty ("Noise", "yes");
+  if (adjoint) a->addProperty ("NoiseNode", "n1");
+  input::assignDefaultProperties (a, acsolver::definition ());
+  a->setEnv (root);
+  subnet->insertAnalysis (a);
+
+  int err = 0;
+  dataset * out = subnet->runAnalysis (err, NULL);
+  EXPECT_EQ (0, err);
+  vector * v = out->findVariable (name);
+  vector vn = v ? *v : vector ();
+  delete out;
+  delete subnet;
+  delete root;
+  return vn;
+}
+
+TEST(acsolver, adjointNoiseMatchesFullNoise) {
+  vector full = noiseVoltages (false, "n1.vn");
+  vector adjoint = noiseVoltages (true, "n1.vn");
+  ASSERT_EQ (3, full.getSize ());
+  ASSERT_EQ (full.getSize (), adjoint.getSize ());
+  for (int i = 0; i < full.getSize (); i++) {
+    nr_double_t vn = real (full (i));
+    EXPECT_NEAR (vn, real (adjoint (i)), 1e-9 * vn);
+  }
+
+  // the contribution of the capacitor is kept past the first frequency
+  vector cap = noiseVoltages (true, "C1.vn");
+  ASSERT_EQ (3, cap.getSize ());
+  EXPECT_EQ (0, real (cap (0)));
+  EXPECT_GT (real (cap (1)), 0);
+  EXPECT_GT (real (cap (2)), 0);
+}
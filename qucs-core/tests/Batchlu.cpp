@@ -0,0 +1,83 @@
+/*
+ * Batchlu.cpp - Unit test for batchlu class
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <cstddef>
+
+#include "qucs_typedefs.h"
+#include "real.h"
+#include "complex.h"
+#include "tvector.h"
+#include "tmatrix.h"
+#include "eqnsys.h"
+#include "batchlu.h"
+
+#include "testDefine.h"   // constants used on tests
+#include "gtest/gtest.h"  // Google Test
+
+// MNA like matrix of a frequency point, a ladder with capacitances and
+// a voltage source (zero diagonal), with some dense couplings
+static qucs::tmatrix<nr_complex_t> point (int n, nr_double_t f) {
+  qucs::tmatrix<nr_complex_t> A (n + 1);
+  unsigned int seed = 12345;
+  for (int i = 0; i < n; i++) {
+    A (i, i) = nr_complex_t (2, f);
+    if (i > 0) A (i, i - 1) = A (i - 1, i) = nr_complex_t (-1, -0.5 * f);
+    for (int k = 0; k < 3; k++) {
+      seed = seed * 1103515245 + 12345;
+      int j = (seed >> 8) % n;
+      if (j != i) A (i, j) += nr_complex_t (0, 0.01 * f);
+    }
+  }
+  A (0, n) = A (n, 0) = 1;
+  return A;
+}
+
+TEST (batchlu, crout) {
+  int n = 150;   // more than one block of columns
+  qucs::batchlu lu (n + 1);
+  qucs::tvector<nr_complex_t> b (n + 1), x (n + 1), y (n + 1);
+  b (n) = 1;
+  b (n / 2) = nr_complex_t (0, 1);
+
+  // three systems set, the second one singular
+  qucs::tmatrix<nr_complex_t> A[3];
+  for (int l = 0; l < 3; l++) {
+    A[l] = point (n, 0.1 * (l + 1));
+    if (l == 1)
+      for (int c = 0; c <= n; c++) A[l] (n / 3, c) = 0;
+    lu.setMatrix (l, A[l].getData ());
+    lu.setVector (l, b.getData ());
+  }
+  EXPECT_EQ (lu.factorize (3), 5);
+  lu.substitute ();
+
+  qucs::eqnsys<nr_complex_t> eqns;
+  eqns.setAlgo (ALGO_LU_DECOMPOSITION_CROUT);
+  for (int l = 0; l < 3; l += 2) {
+    qucs::tmatrix<nr_complex_t> M = A[l];
+    eqns.passEquationSys (&M, &y, &b);
+    eqns.solve ();
+    lu.getVector (l, x.getData ());
+    for (int i = 0; i <= n; i++)
+      EXPECT_NEAR (abs (x (i) - y (i)), 0, tol);
+  }
+}
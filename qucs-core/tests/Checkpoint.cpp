@@ -0,0 +1,67 @@
+/*
+ * Checkpoint.cpp - Unit test for checkpoint class
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <cstdio>
+#include <string>
+
+#include "qucs_typedefs.h"
+#include "checkpoint.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+TEST(checkpoint, roundTripAndKey) {
+  qucs::checkpoint::enable ("checkpoint.test", 1);
+  qucs::checkpoint cp ("TR1");
+  nr_double_t v[3] = { 1.5, -2e-9, 3e12 };
+
+  ASSERT_EQ (cp.create ("key 1"), 0);
+  cp.put (42);
+  cp.put (v, 3);
+  cp.put (std::string ("V1.It"));
+  ASSERT_EQ (cp.commit (), 0);
+
+  qucs::checkpoint other ("TR1");
+  EXPECT_NE (other.open ("key 2"), 0);
+  ASSERT_EQ (other.open ("key 1"), 0);
+  int n = 0;
+  nr_double_t w[3];
+  std::string s;
+  other.get (n);
+  other.get (w, 3);
+  other.get (s);
+  EXPECT_TRUE (other.good ());
+  EXPECT_EQ (n, 42);
+  for (int i = 0; i < 3; i++) EXPECT_EQ (w[i], v[i]);
+  EXPECT_EQ (s, "V1.It");
+
+  // reading beyond the end or a different count fails
+  other.get (n);
+  EXPECT_FALSE (other.good ());
+  ASSERT_EQ (other.open ("key 1"), 0);
+  other.get (n);
+  other.get (w, 2);
+  EXPECT_FALSE (other.good ());
+
+  other.remove ();
+  EXPECT_NE (other.open ("key 1"), 0);
+  qucs::checkpoint::enable ("", 0);
+}
@@ -0,0 +1,89 @@
+/*
+ * Device.cpp - Unit test for the device helper functions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "qucs_typedefs.h"
+#include "constants.h"
+#include "devices/device.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+using namespace qucs::device;
+
+// junction voltages covering the reverse, small and forward regions
+static std::vector<nr_double_t> voltages (void) {
+  std::vector<nr_double_t> u;
+  for (int i = -300; i <= 300; i++) u.push_back (i * 0.01);
+  u.push_back (100);
+  return u;
+}
+
+TEST(device, exponentialMatchesCurrentAndConductance) {
+  for (nr_double_t u : voltages ()) {
+    nr_double_t I, g;
+    pnExponential (u, 1e-14, 0.0259, I, g);
+    EXPECT_EQ (I, pnCurrent (u, 1e-14, 0.0259));
+    EXPECT_EQ (g, pnConductance (u, 1e-14, 0.0259));
+  }
+}
+
+TEST(device, depletionMatchesChargeAndCapacitance) {
+  for (nr_double_t u : voltages ()) {
+    nr_double_t Q, C;
+    pnDepletion (u, 1e-12, 0.75, 0.33, 0.5, Q, C);
+    EXPECT_EQ (C, pnCapacitance (u, 1e-12, 0.75, 0.33, 0.5));
+    nr_double_t q = pnCharge (u, 1e-12, 0.75, 0.33, 0.5);
+    EXPECT_NEAR (Q, q, 1e-13 * std::fabs (q) + 1e-30);
+    pnDepletion (u, 1e-12, 0.75, 0.5, Q, C);
+    EXPECT_EQ (C, pnCapacitance (u, 1e-12, 0.75, 0.5));
+    q = pnCharge (u, 1e-12, 0.75, 0.5);
+    EXPECT_NEAR (Q, q, 1e-13 * std::fabs (q) + 1e-30);
+  }
+}
+
+TEST(device, batchedJunctionsMatchSingle) {
+  std::vector<nr_double_t> u = voltages ();
+  int n = (int) u.size ();
+  std::vector<nr_double_t> Is (n), Ut (n), I (n), g (n);
+  for (int i = 0; i < n; i++) {
+    Is[i] = 1e-15 * (1 + i % 7);
+    Ut[i] = 0.0259 * (1 + 0.1 * (i % 3));
+  }
+
+  pnJunctionBIP (n, u.data (), Is.data (), Ut.data (), I.data (), g.data ());
+  for (int i = 0; i < n; i++) {
+    nr_double_t Ie, ge;
+    pnJunctionBIP (u[i], Is[i], Ut[i], Ie, ge);
+    EXPECT_EQ (I[i], Ie);
+    EXPECT_EQ (g[i], ge);
+  }
+
+  pnJunctionMOS (n, u.data (), Is.data (), Ut.data (), I.data (), g.data ());
+  for (int i = 0; i < n; i++) {
+    nr_double_t Ie, ge;
+    pnJunctionMOS (u[i], Is[i], Ut[i], Ie, ge);
+    EXPECT_EQ (I[i], Ie);
+    EXPECT_EQ (g[i], ge);
+  }
+}
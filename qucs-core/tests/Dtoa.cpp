@@ -0,0 +1,80 @@
+/*
+ * Dtoa.cpp - Unit test for the decimal representation of doubles
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "dtoa.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+TEST(dtoa, formatsShortest) {
+  char buf[DTOA_MAXLEN];
+  EXPECT_EQ (qucs::dtoa (0.0, buf), 8);
+  EXPECT_STREQ (buf, "+0.0e+00");
+  qucs::dtoa (-0.25, buf);
+  EXPECT_STREQ (buf, "-2.5e-01");
+  qucs::dtoa (0.1, buf);
+  EXPECT_STREQ (buf, "+1.0e-01");
+  qucs::dtoa (1e-9 * 3, buf);
+  EXPECT_STREQ (buf, "+3.0000000000000004e-09");
+  qucs::dtoa (5e-324, buf);
+  EXPECT_STREQ (buf, "+5.0e-324");
+  qucs::dtoa (1.7976931348623157e308, buf);
+  EXPECT_STREQ (buf, "+1.7976931348623157e+308");
+  qucs::dtoa (-INFINITY, buf);
+  EXPECT_STREQ (buf, "-inf");
+}
+
+TEST(dtoa, roundsToDigits) {
+  char buf[DTOA_MAXLEN];
+  qucs::dtoa (123.456, buf, 4);
+  EXPECT_STREQ (buf, "+1.235e+02");
+  qucs::dtoa (9.9996, buf, 4);
+  EXPECT_STREQ (buf, "+1.0e+01");
+  qucs::dtoa (0.5, buf, 3);
+  EXPECT_STREQ (buf, "+5.0e-01");
+}
+
+TEST(dtoa, readsBackExactly) {
+  std::mt19937_64 rng (1);
+  char buf[DTOA_MAXLEN], ref[40];
+  for (int i = 0; i < 100000; i++) {
+    uint64_t u = rng ();
+    double x;
+    memcpy (&x, &u, sizeof (x));
+    if (!std::isfinite (x)) continue;
+    int len = qucs::dtoa (x, buf);
+    ASSERT_EQ (strtod (buf, NULL), x) << buf;
+    ASSERT_EQ ((int) strlen (buf), len);
+    // never longer than the shortest correctly rounded representation
+    snprintf (ref, sizeof (ref), "%+.16e", x);
+    if (strtod (ref, NULL) == x) {
+      unsigned long long d;
+      int e;
+      qucs::dtoa_shortest (std::fabs (x), d, e);
+      EXPECT_LT (d, 100000000000000000ULL) << buf;
+    }
+  }
+}
@@ -0,0 +1,401 @@
+/*
+ * Eqnsys.cpp - Unit tests for the equation system solver
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "qucs_typedefs.h"
+#include "real.h"
+#include "complex.h"
+#include "tvector.h"
+#include "tmatrix.h"
+#include "tspmatrix.h"
+#include "eqnsys.h"
+#include "exception.h"
+#include "exceptionstack.h"
+#include "numstatus.h"
+
+#include "testDefine.h"   // constants used on tests
+#include "gtest/gtest.h"  // Google Test
+
+// MNA like matrix: resistor ladder with one voltage source (zero diagonal)
+static qucs::tmatrix<nr_double_t> ladder (int n, nr_double_t scale) {
+  qucs::tmatrix<nr_double_t> A (n + 1);
+  for (int i = 0; i < n; i++) {
+    A (i, i) = 2 * scale;
+    if (i > 0) A (i, i - 1) = A (i - 1, i) = -scale;
+  }
+  A (0, n) = A (n, 0) = 1;
+  return A;
+}
+
+TEST (eqnsys, sparse_lu) {
+  int n = 20;
+  qucs::tvector<nr_double_t> b (n + 1), xs (n + 1), xd (n + 1);
+  b (n) = 1;
+  qucs::eqnsys<nr_double_t> sparse, dense;
+  sparse.setAlgo (ALGO_LU_DECOMPOSITION_SPARSE);
+  dense.setAlgo (ALGO_LU_DECOMPOSITION_CROUT);
+
+  // second run re-uses the pivot sequence of the first one
+  for (int run = 1; run <= 2; run++) {
+    qucs::tmatrix<nr_double_t> As = ladder (n, run);
+    qucs::tmatrix<nr_double_t> Ad = As;
+    sparse.passEquationSys (&As, &xs, &b);
+    sparse.solve ();
+    dense.passEquationSys (&Ad, &xd, &b);
+    dense.solve ();
+    for (int i = 0; i <= n; i++)
+      EXPECT_NEAR (xd (i), xs (i), tol);
+  }
+}
+
+// unchanged matrices keep their factors, changed entries refactorize
+TEST (eqnsys, lu_reuse) {
+  int n = 20;
+  qucs::tvector<nr_double_t> b (n + 1), xs (n + 1), xd (n + 1);
+  b (n) = 1;
+  b (n / 2) = 1;
+  qucs::eqnsys<nr_double_t> sparse, dense;
+  sparse.setAlgo (ALGO_LU_DECOMPOSITION_SPARSE);
+  dense.setAlgo (ALGO_LU_DECOMPOSITION_CROUT);
+
+  nr_double_t g[] = { 0, 0, 1, 1, 1, 3, 0.5, 0.5 };
+  for (int run = 0; run < 8; run++) {
+    qucs::tmatrix<nr_double_t> As = ladder (n, 1);
+    As (n / 2, n / 2) += g[run];
+    As (3, 3) += g[run] * g[run];
+    qucs::tmatrix<nr_double_t> Ad = As;
+    qucs::tmatrix<nr_double_t> A = As;
+    sparse.passEquationSys (&As, &xs, &b);
+    sparse.solve ();
+    dense.passEquationSys (&Ad, &xd, &b);
+    dense.solve ();
+    qucs::tvector<nr_double_t> rs = A * xs - b;
+    qucs::tvector<nr_double_t> rd = A * xd - b;
+    for (int i = 0; i <= n; i++) {
+      EXPECT_NEAR (0, rs (i), tol);
+      EXPECT_NEAR (0, rd (i), tol);
+    }
+  }
+}
+
+// the symbolic analysis of one system is taken over by another one
+TEST (eqnsys, sparse_ordering) {
+  int n = 20;
+  qucs::tvector<nr_double_t> b (n + 1), xa (n + 1), xb (n + 1), xc (n + 1);
+  b (n) = 1;
+  qucs::eqnsys<nr_double_t> first, second, other;
+  first.setAlgo (ALGO_LU_DECOMPOSITION_SPARSE);
+  second.setAlgo (ALGO_LU_DECOMPOSITION_SPARSE);
+  other.setAlgo (ALGO_LU_DECOMPOSITION_SPARSE);
+  std::vector<int> Ap, Ai, Q, Vol;
+  EXPECT_FALSE (first.getOrdering (Ap, Ai, Q, Vol));
+
+  qucs::tmatrix<nr_double_t> A = ladder (n, 1);
+  first.passEquationSys (&A, &xa, &b);
+  first.solve ();
+  ASSERT_TRUE (first.getOrdering (Ap, Ai, Q, Vol));
+  EXPECT_EQ (n + 1, (int) Q.size ());
+
+  // same pattern, other values and any column ordering
+  std::reverse (Q.begin (), Q.end ());
+  qucs::tmatrix<nr_double_t> B = ladder (n, 2);
+  qucs::tmatrix<nr_double_t> Bd = B;
+  second.setOrdering (Ap, Ai, Q, Vol);
+  second.passEquationSys (&B, &xb, &b);
+  second.solve ();
+  std::vector<int> Bp, Bi, BQ, BVol;
+  ASSERT_TRUE (second.getOrdering (Bp, Bi, BQ, BVol));
+  EXPECT_EQ (Q, BQ);
+  qucs::tvector<nr_double_t> r = Bd * xb - b;
+  for (int i = 0; i <= n; i++) EXPECT_NEAR (0, r (i), tol);
+
+  // a pattern not covered orders anew
+  qucs::tmatrix<nr_double_t> C = ladder (n, 1);
+  C (0, n / 2) = C (n / 2, 0) = -0.5;
+  qucs::tmatrix<nr_double_t> Cd = C;
+  other.setOrdering (Ap, Ai, Q, Vol);
+  other.passEquationSys (&C, &xc, &b);
+  other.solve ();
+  ASSERT_TRUE (other.getOrdering (Bp, Bi, BQ, BVol));
+  EXPECT_NE (Q, BQ);
+  r = Cd * xc - b;
+  for (int i = 0; i <= n; i++) EXPECT_NEAR (0, r (i), tol);
+}
+
+TEST (eqnsys, sparse_lu_complex) {
+  int n = 8;
+  qucs::tmatrix<nr_complex_t> A (n);
+  qucs::tvector<nr_complex_t> b (n), x (n);
+  for (int i = 0; i < n; i++) {
+    A (i, i) = nr_complex_t (1, i);
+    A (i, (i + 3) % n) = nr_complex_t (0, 1);
+    b (i) = i + 1;
+  }
+  qucs::tmatrix<nr_complex_t> M = A;
+  qucs::eqnsys<nr_complex_t> eqns;
+  eqns.setAlgo (ALGO_LU_DECOMPOSITION_SPARSE);
+  eqns.passEquationSys (&M, &x, &b);
+  eqns.solve ();
+  qucs::tvector<nr_complex_t> r = A * x - b;
+  for (int i = 0; i < n; i++)
+    EXPECT_NEAR (0, std::abs (r (i)), tol);
+}
+
+TEST (eqnsys, sparse_matrix) {
+  int n = 20;
+  std::vector<int> r, c;
+  for (int i = 0; i < n; i++) {
+    r.push_back (i); c.push_back (i);
+    if (i > 0) {
+      r.push_back (i); c.push_back (i - 1);
+      r.push_back (i - 1); c.push_back (i);
+    }
+  }
+  // duplicates are merged
+  r.push_back (0); c.push_back (n);
+  r.push_back (n); c.push_back (0);
+  r.push_back (n); c.push_back (0);
+  qucs::tspmatrix<nr_double_t> S (n + 1, n + 1, r.size (), &r[0], &c[0]);
+  EXPECT_EQ (3 * n - 2 + 2, S.getNnz ());
+  EXPECT_EQ (-1, S.find (n, n));
+
+  qucs::tmatrix<nr_double_t> Ad = ladder (n, 1);
+  for (int k = 0; k <= n; k++)
+    for (int i = 0; i <= n; i++)
+      if (Ad (i, k) != 0.0) S.set (i, k, Ad (i, k));
+  EXPECT_EQ (Ad (n, 0), S.get (n, 0));
+  EXPECT_EQ (0, S.get (n, n));
+
+  qucs::tvector<nr_double_t> b (n + 1), xs (n + 1), xd (n + 1);
+  b (0) = 1;
+  qucs::eqnsys<nr_double_t> sparse, dense;
+  sparse.setAlgo (ALGO_LU_DECOMPOSITION_SPARSE);
+  sparse.passEquationSys (&S, &xs, &b);
+  sparse.solve ();
+  dense.setAlgo (ALGO_LU_DECOMPOSITION_CROUT);
+  dense.passEquationSys (&Ad, &xd, &b);
+  dense.solve ();
+  for (int i = 0; i <= n; i++)
+    EXPECT_NEAR (xd (i), xs (i), tol);
+}
+
+// one sparse factorization solves all the right hand sides at once
+TEST (eqnsys, sparse_solve_many) {
+  int n = 20, K = 5;
+  qucs::tmatrix<nr_complex_t> A (n + 1), B (n + 1, K), X (n + 1, K);
+  qucs::tmatrix<nr_double_t> L = ladder (n, 1);
+  for (int r = 0; r <= n; r++)
+    for (int c = 0; c <= n; c++)
+      A (r, c) = L (r, c) != 0.0 ? nr_complex_t (L (r, c), r == c ? 0.1 : 0) : 0;
+  for (int k = 0; k < K; k++) {
+    B (k * 3, k) = 1;
+    B (n, k) = nr_complex_t (0, k);
+  }
+  qucs::tmatrix<nr_complex_t> M = A;
+  qucs::tvector<nr_complex_t> b (n + 1), x (n + 1);
+  qucs::eqnsys<nr_complex_t> eqns;
+  eqns.setAlgo (ALGO_LU_DECOMPOSITION_SPARSE);
+  eqns.passEquationSys (&M, &x, &b);
+  eqns.factorize ();
+  eqns.solveMany (&B, &X);
+  qucs::tmatrix<nr_complex_t> R = A * X;
+  for (int r = 0; r <= n; r++)
+    for (int k = 0; k < K; k++)
+      EXPECT_NEAR (0, std::abs (R (r, k) - B (r, k)), tol);
+}
+
+// singular systems raise failures in the status of the thread only
+TEST (eqnsys, singular_status) {
+  qucs::tmatrix<nr_double_t> A (3);
+  A (0, 0) = 1; A (1, 1) = 1; // third row empty
+  qucs::tvector<nr_double_t> x (3), b (3);
+  qucs::eqnsys<nr_double_t> eqns;
+  eqns.setAlgo (ALGO_LU_DECOMPOSITION_SPARSE);
+  eqns.passEquationSys (&A, &x, &b);
+  int mark = qucs::numstatus::mark ();
+  eqns.solve ();
+  EXPECT_TRUE (qucs::numstatus::raised (mark));
+  EXPECT_EQ (qucs::numstatus::top ()->code, qucs::EXCEPTION_SINGULAR);
+  EXPECT_EQ (qucs::numstatus::top ()->data, 2);
+  EXPECT_TRUE (qucs::estack.top () == NULL);
+
+  // reported failures end up on the exception stack
+  qucs::numstatus::report (mark);
+  EXPECT_FALSE (qucs::numstatus::raised (mark));
+  ASSERT_TRUE (qucs::estack.top () != NULL);
+  EXPECT_EQ (qucs::estack.top ()->getCode (), qucs::EXCEPTION_SINGULAR);
+  qucs::estack.pop ();
+  EXPECT_TRUE (qucs::estack.top () == NULL);
+}
+
+/* MNA like matrix of an m x m resistor grid, each node with a
+   conductance to ground, and one voltage source at the first node.
+   Unlike the ladder the incomplete LU factors are not exact. */
+static qucs::tmatrix<nr_double_t> grid (int m) {
+  int n = m * m;
+  qucs::tmatrix<nr_double_t> A (n + 1);
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < m; j++) {
+      int k = i * m + j;
+      A (k, k) += 0.1;
+      if (j + 1 < m) {
+	A (k, k) += 1; A (k + 1, k + 1) += 1;
+	A (k, k + 1) -= 1; A (k + 1, k) -= 1;
+      }
+      if (i + 1 < m) {
+	A (k, k) += 1; A (k + m, k + m) += 1;
+	A (k, k + m) -= 1; A (k + m, k) -= 1;
+      }
+    }
+  }
+  A (0, n) = A (n, 0) = 1;
+  return A;
+}
+
+// the Krylov solvers match the LU decomposition
+TEST (eqnsys, krylov) {
+  int m = 8, n = m * m;
+  int algos[] = { ALGO_BICGSTAB, ALGO_GMRES };
+  for (int algo : algos) {
+    qucs::tvector<nr_double_t> b (n + 1), xk (n + 1), xd (n + 1);
+    b (n) = 1;
+    b (n / 2) = 0.5;
+    qucs::tmatrix<nr_double_t> Ak = grid (m), Ad = grid (m);
+    qucs::eqnsys<nr_double_t> krylov, dense;
+    krylov.setAlgo (algo);
+    krylov.setKrylov (1e-12, 0);
+    krylov.passEquationSys (&Ak, &xk, &b);
+    krylov.solve ();
+    dense.setAlgo (ALGO_LU_DECOMPOSITION);
+    dense.passEquationSys (&Ad, &xd, &b);
+    dense.solve ();
+    EXPECT_EQ (1, krylov.getKrylovSolves ());
+    EXPECT_EQ (0, krylov.getKrylovFallbacks ());
+    EXPECT_GT (krylov.getKrylovIterations (), 1);
+    EXPECT_LE (krylov.getKrylovResidual (), 1e-12);
+    for (int i = 0; i <= n; i++)
+      EXPECT_NEAR (xd (i), xk (i), tol);
+  }
+}
+
+/* The cyclic permutation has no diagonal, its incomplete LU factors
+   are useless.  The Krylov solvers break down or stagnate and fall
+   back to the sparse LU decomposition. */
+TEST (eqnsys, krylov_fallback) {
+  int n = 64;
+  int algos[] = { ALGO_BICGSTAB, ALGO_GMRES };
+  for (int algo : algos) {
+    qucs::tmatrix<nr_double_t> A (n), Ak (n);
+    for (int i = 0; i < n; i++) A (i, (i + 1) % n) = 1 + 0.01 * i;
+    Ak = A;
+    qucs::tvector<nr_double_t> b (n), x (n);
+    for (int i = 0; i < n; i++) b (i) = 1 + i % 3;
+    qucs::eqnsys<nr_double_t> krylov;
+    krylov.setAlgo (algo);
+    krylov.setKrylov (1e-12, 0);
+    krylov.passEquationSys (&Ak, &x, &b);
+    krylov.solve ();
+    EXPECT_EQ (1, krylov.getKrylovFallbacks ());
+    qucs::tvector<nr_double_t> r = A * x - b;
+    for (int i = 0; i < n; i++)
+      EXPECT_NEAR (0, r (i), tol);
+  }
+}
+
+/* The mixed precision LU refines its single precision solution to
+   double precision residuals, the A matrix being left untouched. */
+TEST (eqnsys, mixed_lu) {
+  int m = 8, n = m * m;
+  qucs::tmatrix<nr_double_t> A = grid (m), Am = A, Ad = A;
+  qucs::tvector<nr_double_t> b (n + 1), xm (n + 1), xd (n + 1);
+  for (int i = 0; i <= n; i++) b (i) = 1.0 / (1 + i);
+  qucs::eqnsys<nr_double_t> mixed, dense;
+  mixed.setAlgo (ALGO_LU_DECOMPOSITION_MIXED);
+  mixed.passEquationSys (&Am, &xm, &b);
+  mixed.solve ();
+  dense.setAlgo (ALGO_LU_DECOMPOSITION);
+  dense.passEquationSys (&Ad, &xd, &b);
+  dense.solve ();
+
+  nr_double_t anorm = 0, xnorm = 0;
+  for (int i = 0; i <= n; i++) {
+    nr_double_t s = 0;
+    for (int c = 0; c <= n; c++) s += std::fabs (A (i, c));
+    anorm = std::max (anorm, s);
+    xnorm = std::max (xnorm, std::fabs (xm (i)));
+  }
+  qucs::tvector<nr_double_t> rm = A * xm - b, rd = A * xd - b;
+  nr_double_t eps = std::numeric_limits<nr_double_t>::epsilon ();
+  for (int i = 0; i <= n; i++) {
+    EXPECT_LE (std::fabs (rm (i)), (n + 1) * eps * anorm * xnorm);
+    EXPECT_LE (std::fabs (rm (i)), 4 * std::max (std::fabs (rd (i)),
+						 eps * anorm * xnorm));
+    EXPECT_NEAR (xd (i), xm (i), 1e-12 * xnorm);
+  }
+  // refined, not decomposed in double precision
+  for (int r = 0; r <= n; r++)
+    for (int c = 0; c <= n; c++)
+      EXPECT_EQ (A (r, c), Am (r, c));
+}
+
+/* The single precision factors of an ill-conditioned matrix cannot be
+   refined, the system is decomposed in double precision instead. */
+TEST (eqnsys, mixed_lu_fallback) {
+  int n = 10;
+  qucs::tmatrix<nr_double_t> A (n);
+  qucs::tvector<nr_double_t> b (n), xm (n), xd (n);
+  for (int r = 0; r < n; r++) {
+    b (r) = 1;
+    for (int c = 0; c < n; c++) A (r, c) = 1.0 / (r + c + 1); // Hilbert
+  }
+  qucs::tmatrix<nr_double_t> Am = A, Ad = A;
+  qucs::eqnsys<nr_double_t> mixed, dense;
+  mixed.setAlgo (ALGO_LU_DECOMPOSITION_MIXED);
+  mixed.passEquationSys (&Am, &xm, &b);
+  mixed.solve ();
+  dense.setAlgo (ALGO_LU_DECOMPOSITION_CROUT);
+  dense.passEquationSys (&Ad, &xd, &b);
+  dense.solve ();
+
+  // the A matrix holds the double precision factors
+  bool decomposed = false;
+  for (int r = 0; r < n; r++)
+    for (int c = 0; c < n; c++)
+      if (Am (r, c) != A (r, c)) decomposed = true;
+  EXPECT_TRUE (decomposed);
+  for (int i = 0; i < n; i++)
+    EXPECT_NEAR (xd (i), xm (i), 1e-12 * std::fabs (xd (i)));
+
+  // a second right hand side re-uses them
+  qucs::tvector<nr_double_t> b2 (n), xm2 (n), xd2 (n);
+  b2 (0) = 1;
+  mixed.passEquationSys ((qucs::tmatrix<nr_double_t> *) NULL, &xm2, &b2);
+  mixed.solve ();
+  dense.passEquationSys ((qucs::tmatrix<nr_double_t> *) NULL, &xd2, &b2);
+  dense.solve ();
+  for (int i = 0; i < n; i++)
+    EXPECT_NEAR (xd2 (i), xm2 (i), 1e-12 * std::fabs (xd2 (i)));
+}
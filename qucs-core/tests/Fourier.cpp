@@ -44,3 +44,26 @@ TEST (fourier, fft) {
     else
       EXPECT_EQ ( 0 , vdif.get(k).real() );
 }
+
+TEST (fourier, fft_mixed_radix) {
+  // fft of non-binary sizes compared to the dft
+  int sizes[] = { 3, 6, 12, 15, 20, 49 };
+  for (int n : sizes) {
+    qucs::vector vec = qucs::vector (n);
+    for (int k = 0; k < n; k++)
+      vec.set (nr_complex_t (k % 5, 1 - k % 3), k);
+    qucs::vector vdft = qucs::fourier::dft_1d (vec);
+
+    nr_double_t * data = new nr_double_t[2 * n];
+    for (int k = 0; k < n; k++) {
+      data[2 * k] = real (vec.get (k));
+      data[2 * k + 1] = imag (vec.get (k));
+    }
+    qucs::fourier::_fft_1d (data, n);
+    for (int k = 0; k < n; k++) {
+      EXPECT_NEAR (real (vdft.get (k)), data[2 * k], 1e-9);
+      EXPECT_NEAR (imag (vdft.get (k)), data[2 * k + 1], 1e-9);
+    }
+    delete[] data;
+  }
+}
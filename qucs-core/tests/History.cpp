@@ -0,0 +1,65 @@
+/*
+ * History.cpp - Unit test for history class
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "qucs_typedefs.h"
+#include "history.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+TEST (history, ringbuffer) {
+  // a time history shared by a value history with a delay of 1
+  qucs::history th, vh;
+  th.reserve (32);
+  th.push_back (0.0);
+  th.self ();
+  th.setAge (1.0);
+  vh.setAge (1.0);
+  vh.apply (th);
+  vh.push_back (0.0);
+
+  std::size_t capacity = 0;
+  for (int i = 1; i <= 1000; i++) {
+    nr_double_t t = i * 0.1;
+    th.push_back (t);
+    vh.push_back (2 * t);
+    th.drop ();
+    if (i == 100) capacity = th.size ();
+    // the history is bounded by its age
+    EXPECT_LE (th.duration (), 1.0 + 0.25);
+    EXPECT_DOUBLE_EQ (th.last (), t);
+  }
+  EXPECT_EQ (th.size (), capacity);
+
+  // lookups in time and by index
+  EXPECT_NEAR (vh.nearest (99.55, false), 199.0, 0.21);
+  EXPECT_NEAR (vh.nearest (99.55), 199.1, 1e-9);
+  int n = th.size ();
+  EXPECT_DOUBLE_EQ (vh.getTfromidx (n - 1), 100.0);
+  EXPECT_DOUBLE_EQ (vh.getValfromidx (n - 1), 200.0);
+
+  // dropping most recent values keeps times and values aligned
+  vh.truncate (99.75);
+  EXPECT_DOUBLE_EQ (th.last (), 99.7);
+  n = th.size ();
+  EXPECT_DOUBLE_EQ (vh.getValfromidx (n - 1), 199.4);
+  th.push_back (99.8);
+  vh.push_back (199.6);
+  EXPECT_DOUBLE_EQ (vh.getValfromidx (th.size () - 1), 199.6);
+}
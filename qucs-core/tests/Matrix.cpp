@@ -32,3 +32,14 @@ TEST (matrix, getCols) {
     EXPECT_EQ ( 3 , data.getCols() );
 }
 
+
+TEST (matrix, move) {
+    qucs::matrix a = qucs::eye(3,3) * 2.0;
+    qucs::matrix b (std::move (a));
+    EXPECT_EQ ( 0 , a.getRows() );
+    EXPECT_EQ ( 3 , b.getRows() );
+    EXPECT_EQ ( 2.0 , real (b (1,1)) );
+    a = qucs::transpose (b);
+    EXPECT_EQ ( 3 , a.getCols() );
+    EXPECT_EQ ( 2.0 , real (a (2,2)) );
+}
@@ -0,0 +1,54 @@
+/*
+ * Object.cpp - Unit test for object class property bindings
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "qucs_typedefs.h"
+#include "object.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+TEST (object, parameter) {
+  qucs::object o ("o");
+  qucs::parameter pIs ("Is"), pN ("N");
+  o.addProperty ("Is", 1e-15);
+  EXPECT_EQ (o.getPropertyDouble (pIs), 1e-15);
+  EXPECT_EQ (o.getPropertyDouble (pN), 0.0);
+
+  // bindings follow value changes and added properties
+  o.setProperty ("Is", 2e-15);
+  o.addProperty ("N", 1.5);
+  EXPECT_EQ (o.getPropertyDouble (pIs), 2e-15);
+  EXPECT_EQ (o.getPropertyDouble (pN), 1.5);
+
+  // scaled lookup prefers the scalability property
+  EXPECT_EQ (o.getScaledProperty (pIs), 2e-15);
+  o.setScaledProperty ("Is", 4e-15);
+  EXPECT_EQ (o.getScaledProperty (pIs), 4e-15);
+  EXPECT_EQ (o.getPropertyDouble (pIs), 2e-15);
+
+  // copies and assignments rebind to their own properties
+  qucs::object c (o);
+  c.setProperty ("N", 2.0);
+  EXPECT_EQ (c.getPropertyDouble (pN), 2.0);
+  EXPECT_EQ (o.getPropertyDouble (pN), 1.5);
+  o = c;
+  o.setProperty ("N", 3.0);
+  EXPECT_EQ (o.getPropertyDouble (pN), 3.0);
+  EXPECT_EQ (c.getPropertyDouble (pN), 2.0);
+}
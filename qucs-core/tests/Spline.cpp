@@ -21,6 +21,8 @@
  */
 
 #include <iostream>
+#include <vector>
+#include <cmath>
 
 #include "qucs_typedefs.h"
 #include "real.h"
@@ -66,3 +68,78 @@ TEST(spline, issue676) {
   rsp->qucs::spline::~spline();
 }
 
+
+static void sampleGrid (int n, std::vector<nr_double_t> & x,
+			std::vector<nr_double_t> & y, nr_double_t f) {
+  x.resize (n);
+  y.resize (n);
+  for (int i = 0; i < n; i++) {
+    x[i] = i + 0.25 * (i % 3);
+    y[i] = std::sin (f * x[i]);
+  }
+}
+
+// batched evaluation gives the same values as the single one
+TEST(spline, batch) {
+  std::vector<nr_double_t> x, y;
+  sampleGrid (20, x, y, 0.3);
+  qucs::spline sp (qucs::SPLINE_BC_NATURAL);
+  sp.vectors (&y[0], &x[0], 20);
+  sp.construct ();
+
+  // ascending positions, beyond both ends and on grid points
+  std::vector<nr_double_t> t, v (40), d (40);
+  for (int k = 0; k < 40; k++) t.push_back (-2 + k * 0.6);
+  t[10] = x[5];
+  t[11] = x[5];
+  t[30] = 5; // out of order
+  sp.evaluate (&t[0], 40, &v[0], &d[0]);
+  for (int k = 0; k < 40; k++) {
+    qucs::poly p = sp.evaluate (t[k]);
+    nr_double_t y0, y1;
+    sp.evaluate (t[k], y0, y1);
+    EXPECT_EQ (v[k], p.f0);
+    EXPECT_EQ (d[k], p.f1);
+    EXPECT_EQ (y0, p.f0);
+    EXPECT_EQ (y1, p.f1);
+  }
+}
+
+// splines sharing a grid equal the separately constructed ones
+TEST(spline, sharedGrid) {
+  std::vector<nr_double_t> x, y, z;
+  sampleGrid (12, x, y, 0.5);
+  sampleGrid (12, x, z, 0.2);
+  qucs::spline a (qucs::SPLINE_BC_NATURAL), b (qucs::SPLINE_BC_NATURAL);
+  qucs::spline c (qucs::SPLINE_BC_NATURAL);
+  a.vectors (&y[0], &x[0], 12);
+  a.construct ();
+  b.shareGrid (a);
+  b.values (&z[0]);
+  b.construct ();
+  c.vectors (&z[0], &x[0], 12);
+  c.construct ();
+  // new values on the grid of an existing spline
+  a.values (&z[0]);
+  a.construct ();
+  for (nr_double_t t = -1; t < 14; t += 0.37) {
+    EXPECT_EQ (b.evaluate (t).f0, c.evaluate (t).f0);
+    EXPECT_EQ (a.evaluate (t).f0, c.evaluate (t).f0);
+  }
+}
+
+// periodic splines through more than three points
+TEST(spline, periodic) {
+  int n = 33;
+  std::vector<nr_double_t> x (n), y (n);
+  for (int i = 0; i < n; i++) {
+    x[i] = i * 2 * M_PI / (n - 1);
+    y[i] = std::sin (x[i]);
+  }
+  y[n - 1] = y[0];
+  qucs::spline sp (qucs::SPLINE_BC_PERIODIC);
+  sp.vectors (&y[0], &x[0], n);
+  sp.construct ();
+  for (nr_double_t t = 0.1; t < 12; t += 0.5)
+    EXPECT_NEAR (sp.evaluate (t).f0, std::sin (t), 1e-4);
+}
@@ -0,0 +1,59 @@
+/*
+ * Threadpool.cpp - Unit test for threadpool class
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <vector>
+
+#include "qucs_typedefs.h"
+#include "threadpool.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+TEST(threadpool, nestedLoops) {
+  qucs::threadpool::setThreads (4);
+  EXPECT_EQ (qucs::threadpool::getThreads (), 4);
+  EXPECT_EQ (qucs::threadpool::threads (0), 4);
+  EXPECT_EQ (qucs::threadpool::threads (7), 7);
+
+  // an outer loop of inner loops, each task writes its own slot
+  std::vector<std::vector<int> > r (16, std::vector<int> (100, 0));
+  qucs::threadpool::run (16, [&r] (int i) {
+    qucs::threadpool::run (100, [&r, i] (int k) { r[i][k] = i * k; });
+  });
+  for (int i = 0; i < 16; i++)
+    for (int k = 0; k < 100; k++) EXPECT_EQ (r[i][k], i * k);
+}
+
+TEST(threadpool, deterministicSum) {
+  // partial sums by index, combined in index order
+  std::vector<nr_double_t> sums[2];
+  for (int t = 0; t < 2; t++) {
+    qucs::threadpool::setThreads (t ? 3 : 1);
+    sums[t].assign (37, 0);
+    qucs::threadpool::run (37, [&sums, t] (int k) {
+      for (int i = 0; i < 1000; i++) sums[t][k] += 1.0 / (k * 1000 + i + 1);
+    });
+  }
+  nr_double_t a = 0, b = 0;
+  for (int k = 0; k < 37; k++) { a += sums[0][k]; b += sums[1][k]; }
+  EXPECT_EQ (a, b);
+  qucs::threadpool::setThreads (0);
+}
@@ -0,0 +1,123 @@
+/*
+ * Tokenizer.cpp - Unit test for tokenizer class
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "qucs_typedefs.h"
+#include "tokenizer.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+// reads the number of the given text and checks the cursor
+static bool read (const char * text, nr_double_t & val, int flags = 0) {
+  qucs::tokenizer t (text, strlen (text));
+  t.next ();
+  if (!t.number (val, flags)) {
+    EXPECT_TRUE (t.atBegin ()) << text;
+    return false;
+  }
+  return true;
+}
+
+TEST(tokenizer, readsNumbers) {
+  nr_double_t val;
+  EXPECT_TRUE (read ("1", val));
+  EXPECT_EQ (val, 1.0);
+  EXPECT_TRUE (read ("-2.5e-3", val));
+  EXPECT_EQ (val, -2.5e-3);
+  EXPECT_TRUE (read ("+.5", val));
+  EXPECT_EQ (val, 0.5);
+  EXPECT_TRUE (read ("1E+9", val));
+  EXPECT_EQ (val, 1e9);
+  EXPECT_TRUE (read ("0.000", val));
+  EXPECT_EQ (val, 0.0);
+  EXPECT_TRUE (read ("1.7976931348623157e308", val));
+  EXPECT_EQ (val, 1.7976931348623157e308);
+  EXPECT_TRUE (read ("12345678901234567890123", val));
+  EXPECT_EQ (val, 12345678901234567890123.0);
+}
+
+TEST(tokenizer, rejectsSyntax) {
+  nr_double_t val;
+  EXPECT_FALSE (read ("", val));
+  EXPECT_FALSE (read ("-", val));
+  EXPECT_FALSE (read ("1.", val));
+  EXPECT_FALSE (read ("1e", val));
+  EXPECT_FALSE (read ("1e+", val));
+  EXPECT_FALSE (read ("e1", val));
+  EXPECT_FALSE (read (".5", val, TOKENIZER_LEADING));
+  EXPECT_TRUE (read ("0.5", val, TOKENIZER_LEADING));
+}
+
+TEST(tokenizer, readsExactly) {
+  std::mt19937_64 rng (1);
+  char buf[40];
+  for (int i = 0; i < 100000; i++) {
+    uint64_t u = rng ();
+    double x;
+    memcpy (&x, &u, sizeof (x));
+    if (!std::isfinite (x)) continue;
+    snprintf (buf, sizeof (buf), "%.*e", (int) (u % 18), x);
+    nr_double_t val;
+    ASSERT_TRUE (read (buf, val)) << buf;
+    ASSERT_EQ (val, strtod (buf, NULL)) << buf;
+    // short decimals take the fast path
+    snprintf (buf, sizeof (buf), "%.*f", (int) (u % 7), (u >> 20) % 100000 * 1e-3);
+    ASSERT_TRUE (read (buf, val)) << buf;
+    ASSERT_EQ (val, strtod (buf, NULL)) << buf;
+  }
+}
+
+TEST(tokenizer, splitsLines) {
+  const char * text = "a 1\r\n# b\n\nkey.x 2\nkey 3";
+  qucs::tokenizer t (text, strlen (text));
+  nr_double_t val;
+  ASSERT_TRUE (t.next ());
+  EXPECT_EQ (t.getEnd () - t.getBegin (), 3);
+  EXPECT_TRUE (t.literal ("a"));
+  t.skip ();
+  EXPECT_TRUE (t.number (val));
+  EXPECT_TRUE (t.atEnd ());
+  ASSERT_TRUE (t.next ());
+  t.cut ('#');
+  EXPECT_TRUE (t.atEnd ());
+  ASSERT_TRUE (t.next ());
+  EXPECT_TRUE (t.atEnd ());
+  ASSERT_TRUE (t.next ());
+  EXPECT_FALSE (t.keyword ("key"));
+  EXPECT_EQ (t.span ("."), 5);
+  ASSERT_TRUE (t.next ());
+  EXPECT_TRUE (t.keyword ("key"));
+  EXPECT_TRUE (t.delimited (" "));
+  EXPECT_EQ (t.getLine (), 5);
+  EXPECT_FALSE (t.next ());
+  // finds characters through the lines
+  qucs::tokenizer f (text, strlen (text));
+  f.next ();
+  EXPECT_TRUE (f.find ('3'));
+  EXPECT_EQ (f.getLine (), 5);
+  EXPECT_FALSE (f.find ('z'));
+}
@@ -0,0 +1,95 @@
+/*
+ * Vectfit.cpp - Unit test for vectfit class
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <cstdio>
+#include <vector>
+
+#include "qucs_typedefs.h"
+#include "complex.h"
+#include "matrix.h"
+#include "constants.h"
+#include "vectfit.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+// a passive twoport with a resonance at 1GHz and a real pole
+static qucs::matrix twoport (nr_double_t f) {
+  nr_complex_t s (0, 2 * qucs::pi * f);
+  nr_complex_t p (-1e8, 2 * qucs::pi * 1e9), r (3e8, 1e8);
+  nr_complex_t res = r / (s - p) + std::conj (r) / (s - std::conj (p));
+  nr_complex_t low = 2e9 / (s + 4e9);
+  qucs::matrix m (2);
+  m (0, 0) = 0.1 + 0.1 * res;
+  m (1, 1) = 0.1 + 0.1 * res;
+  m (0, 1) = m (1, 0) = 0.1 * res + 0.2 * low;
+  return m;
+}
+
+static void sample (std::vector<nr_double_t> & freq,
+		    std::vector<qucs::matrix> & data) {
+  for (int i = 0; i <= 200; i++) {
+    freq.push_back (i * 1e7);
+    data.push_back (twoport (freq.back ()));
+  }
+}
+
+TEST(vectfit, recoversRationalFunction) {
+  std::vector<nr_double_t> freq;
+  std::vector<qucs::matrix> data;
+  sample (freq, data);
+
+  qucs::vectfit vf;
+  ASSERT_EQ (vf.fit (freq, data, 4), 0);
+  EXPECT_LT (vf.getError (), 1e-6);
+  for (int k = 0; k < vf.getPoles (); k++)
+    EXPECT_LT (real (vf.poles[k]), 0);
+
+  // between the samples and beyond the band
+  for (nr_double_t f : { 1.234e9, 5e8, 3e9 }) {
+    qucs::matrix h = vf.response (f), e = twoport (f);
+    for (int r = 0; r < 2; r++)
+      for (int c = 0; c < 2; c++)
+	EXPECT_NEAR (abs (h (r, c) - e (r, c)), 0, 1e-5);
+  }
+}
+
+TEST(vectfit, selectsOrderAndCaches) {
+  std::vector<nr_double_t> freq;
+  std::vector<qucs::matrix> data;
+  sample (freq, data);
+
+  qucs::vectfit vf;
+  ASSERT_EQ (vf.fit (freq, data, 0), 0);
+  EXPECT_LT (vf.getError (), VECTFIT_TOLERANCE);
+  EXPECT_LE (vf.getPoles (), 4);
+  EXPECT_LT (vf.gain (freq), 1);
+
+  const char * file = "vectfit.test.vfit";
+  ASSERT_EQ (vf.save (file, "key 1"), 0);
+  qucs::vectfit other;
+  EXPECT_NE (other.load (file, "key 2"), 0);
+  ASSERT_EQ (other.load (file, "key 1"), 0);
+  EXPECT_EQ (other.getPoles (), vf.getPoles ());
+  qucs::matrix a = vf.response (7e8), b = other.response (7e8);
+  EXPECT_NEAR (abs (a (0, 1) - b (0, 1)), 0, 1e-12);
+  std::remove (file);
+}
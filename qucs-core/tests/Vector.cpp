@@ -22,6 +22,7 @@
 
 #include "qucs_typedefs.h"
 #include "object.h"
+#include "strlist.h"
 #include "vector.h"
 
 #include "gtest/gtest.h"  // Google Test
@@ -33,3 +34,47 @@ TEST (vector, sum) {
     vec.set(1, k);
   EXPECT_EQ ( 3.0 , qucs::sum(vec) );
 }
+
+TEST (vector, moveAssign) {
+  qucs::vector vec = qucs::vector("v", 2);
+  vec = qucs::vector(3, 1.0) * 2.0;
+  EXPECT_STREQ ( "v" , vec.getName() );
+  EXPECT_EQ ( 3 , vec.getSize() );
+  EXPECT_EQ ( 6.0 , real (qucs::sum(vec)) );
+}
+
+TEST (vector, reserveAndAppend) {
+  qucs::vector vec = qucs::vector("v");
+  vec.reserve (100);
+  EXPECT_EQ ( 0 , vec.getSize() );
+  nr_complex_t values[3] = { 1.0, 2.0, 3.0 };
+  vec.add (values, 3);
+  vec.add (4.0);
+  for (int k = 0; k < 50; k++)
+    vec.add (values, 3);
+  EXPECT_EQ ( 154 , vec.getSize() );
+  EXPECT_EQ ( 4.0 , real (vec.get (3)) );
+  EXPECT_EQ ( 310.0 , real (qucs::sum(vec)) );
+}
+
+TEST (vector, sharedDependencies) {
+  qucs::vector a ("a"), b ("b");
+  qucs::strlist * deps = new qucs::strlist ();
+  deps->append ("x");
+  deps->append ("y");
+  a.setDependencies (deps);
+  b.setDependencies (new qucs::strlist (*deps));
+  EXPECT_EQ ( a.getDependencies() , b.getDependencies() );
+  qucs::vector c (a);
+  EXPECT_EQ ( a.getDependencies() , c.getDependencies() );
+  qucs::strlist * other = new qucs::strlist ();
+  other->append ("x");
+  b.setDependencies (other);
+  EXPECT_NE ( a.getDependencies() , b.getDependencies() );
+  EXPECT_EQ ( 1 , b.getDependencies()->length() );
+  EXPECT_EQ ( 2 , c.getDependencies()->length() );
+  b.shareDependencies (&a);
+  EXPECT_STREQ ( "y" , b.getDependencies()->get(1) );
+  b.setDependencies (NULL);
+  EXPECT_EQ ( NULL , b.getDependencies() );
+}
@@ -0,0 +1,303 @@
+#!/usr/bin/env python3
+#
+# bench.py - regression benchmarks of the qucsator solvers
+#
+# Copyright (C) 2026 Qucs Team
+#
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2, or (at your option)
+# any later version.
+#
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this package; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+# Boston, MA 02110-1301, USA.
+#
+
+"""Regression benchmarks of the qucsator solvers.
+
+Generates netlists scaled by --scale, runs qucsator with --profile on
+each and reports the run time, peak memory and solver throughput.  The
+results are compared against a baseline file, a benchmark slower or
+larger than the baseline by more than --threshold fails the run.  The
+first run, or one with --update, writes the baseline.  Baselines are
+machine specific and kept in the build directory.
+
+  bench.py --qucsator src/qucsator [--scale 1] [--repeat 3]
+           [--threshold 0.2] [--baseline bench-baseline.json]
+           [--update] [--only NAME,...] [--workdir bench]
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import time
+
+# -------------------------------------------------------------------------
+# netlist generators, each returns the netlist text for the given scale
+
+def rcmesh(scale, analysis):
+    """Square mesh of resistors with a capacitor at each node."""
+    n = 40 * scale
+    lines = ["# RC mesh %dx%d" % (n, n)]
+    node = lambda i, j: "n%d_%d" % (i, j)
+    for i in range(n):
+        for j in range(n):
+            if j + 1 < n:
+                lines.append('R:Rh%d_%d %s %s R="%d Ohm"'
+                             % (i, j, node(i, j), node(i, j + 1), 10 + (i + j) % 7))
+            if i + 1 < n:
+                lines.append('R:Rv%d_%d %s %s R="%d Ohm"'
+                             % (i, j, node(i, j), node(i + 1, j), 10 + (i * j) % 5))
+            lines.append('C:C%d_%d %s gnd C="1 pF"' % (i, j, node(i, j)))
+    lines.append('R:Rload %s gnd R="1 kOhm"' % node(n - 1, n - 1))
+    if analysis == "DC":
+        lines.append('Vdc:V1 %s gnd U="1 V"' % node(0, 0))
+        lines.append('.DC:DC1 saveOPs="no"')
+    else:
+        lines.append('Vac:V1 %s gnd U="1 V" f="1 MHz"' % node(0, 0))
+        lines.append('.AC:AC1 Type="log" Start="1 kHz" Stop="10 GHz" '
+                     'Points="%d" Noise="no"' % 51)
+    return "\n".join(lines) + "\n"
+
+def rcmesh_dc(scale):
+    return rcmesh(scale, "DC")
+
+def rcmesh_ac(scale):
+    return rcmesh(scale, "AC")
+
+def msfilter_sp(scale):
+    """Bank of stepped impedance microstrip lowpass filters."""
+    banks = 4 * scale
+    lines = ['SUBST:Sub1 er="3.66" h="0.508 mm" t="35 um" tand="0.004" '
+             'rho="0.022e-6" D="0.15e-6"']
+    for b in range(banks):
+        prev = "p%d_in" % b
+        lines.append('Pac:P%d %s gnd Num="%d" Z="50 Ohm"' % (2 * b + 1, prev, 2 * b + 1))
+        for s in range(9):
+            nxt = "p%d_%d" % (b, s) if s < 8 else "p%d_out" % b
+            w = "0.2 mm" if s % 2 else "3.5 mm"
+            l = "%.2f mm" % (4.0 + 0.3 * b + 0.1 * s)
+            lines.append('MLIN:ML%d_%d %s %s Subst="Sub1" W="%s" L="%s" '
+                         'Model="Hammerstad" DispModel="Kirschning"'
+                         % (b, s, prev, nxt, w, l))
+            prev = nxt
+        lines.append('Pac:P%d %s gnd Num="%d" Z="50 Ohm"' % (2 * b + 2, prev, 2 * b + 2))
+    lines.append('.SP:SP1 Type="lin" Start="10 MHz" Stop="10 GHz" '
+                 'Points="%d" Noise="no"' % 1001)
+    return "\n".join(lines) + "\n"
+
+def ring_tr(scale):
+    """CMOS ring oscillator."""
+    stages = 2 * (10 * scale) + 1
+    lines = ['Vdc:VDD vdd gnd U="3.3 V"']
+    for s in range(stages):
+        i, o = "r%d" % s, "r%d" % ((s + 1) % stages)
+        lines.append('MOSFET:MN%d %s %s gnd gnd Type="nfet" Vt0="0.7" Kp="1e-4" '
+                     'W="10 um" L="1 um" Lambda="0.02" Is="1e-14" N="1" '
+                     'Gamma="0" Phi="0.6" Cgso="4e-10" Cgdo="2e-10"'
+                     % (s, o, i))
+        lines.append('MOSFET:MP%d %s %s vdd vdd Type="pfet" Vt0="-0.7" Kp="5e-5" '
+                     'W="20 um" L="1 um" Lambda="0.02" Is="1e-14" N="1" '
+                     'Gamma="0" Phi="0.6" Cgso="4e-10" Cgdo="2e-10"'
+                     % (s, o, i))
+        lines.append('C:CL%d %s gnd C="20 fF"' % (s, o))
+    lines.append('Ipulse:Ikick gnd r0 I1="0" I2="100 uA" T1="1 ns" T2="2 ns"')
+    lines.append('.TR:TR1 Type="lin" Start="0" Stop="200 ns" Points="2001" '
+                 'IntegrationMethod="Trapezoidal" Order="2" MaxIter="150" '
+                 'initialDC="yes"')
+    return "\n".join(lines) + "\n"
+
+def buck_tr(scale):
+    """Interleaved buck converters switched by a MOSFET and a diode."""
+    phases = 2 * scale
+    lines = ['Vdc:VIN vin gnd U="12 V"',
+             'C:COUT out gnd C="100 uF"',
+             'R:RLOAD out gnd R="2 Ohm"']
+    period = 10e-6
+    for p in range(phases):
+        delay = period * p / phases
+        lines.append('Vpulse:VG%d g%d gnd U1="0" U2="15 V" T1="%g" T2="%g" '
+                     'Tr="20 ns" Tf="20 ns"' % (p, p, delay, delay + 0.4 * period))
+        lines.append('MOSFET:MS%d vin g%d sw%d sw%d Type="nfet" Vt0="2" '
+                     'Kp="1" W="100 um" L="1 um" Lambda="0" Is="1e-14" N="1" '
+                     'Gamma="0" Phi="0.6"' % (p, p, p, p))
+        lines.append('Diode:D%d gnd sw%d Is="1e-9" N="1" M="0.5" Cj0="100 pF" '
+                     'Vj="0.7"' % (p, p))
+        lines.append('L:L%d sw%d out L="%d uH" I="0"' % (p, p, 20 * phases))
+    lines.append('.TR:TR1 Type="lin" Start="0" Stop="1 ms" Points="5001" '
+                 'IntegrationMethod="Trapezoidal" Order="2" MaxIter="150" '
+                 'initialDC="yes" MaxStep="100 ns"')
+    return "\n".join(lines) + "\n"
+
+def mixer_hb(scale):
+    """Two-tone diode ring mixer."""
+    lines = ['Vac:VLO lo1 gnd U="2 V" f="1 GHz"',
+             'R:RLO lo1 lo R="50 Ohm"',
+             'Vac:VRF rf1 gnd U="0.1 V" f="1.1 GHz"',
+             'R:RRF rf1 rf R="50 Ohm"']
+    diodes = [("lo", "a"), ("a", "rf"), ("rf", "b"), ("b", "lo")]
+    for k, (p, n) in enumerate(diodes):
+        lines.append('Diode:D%d %s %s Is="1e-12" N="1.05" M="0.5" Cj0="0.2 pF" '
+                     'Vj="0.6" Rs="3 Ohm"' % (k, p, n))
+    lines += ['R:RA a if R="25 Ohm"',
+              'R:RB b if R="25 Ohm"',
+              'C:CIF if gnd C="10 pF"',
+              'R:RIF if gnd R="50 Ohm"',
+              '.HB:HB1 n="%d" MaxIter="150"' % (4 + 2 * scale)]
+    return "\n".join(lines) + "\n"
+
+def eqn_post(scale):
+    """AC analysis of an RC ladder with heavy equation postprocessing."""
+    nodes = 20 * scale
+    lines = ['Vac:V1 n0 gnd U="1 V" f="1 kHz"']
+    for i in range(nodes):
+        lines.append('R:R%d n%d n%d R="1 kOhm"' % (i, i, i + 1))
+        lines.append('C:C%d n%d gnd C="%d nF"' % (i, i + 1, 1 + i % 10))
+    lines.append('.AC:AC1 Type="log" Start="1 Hz" Stop="100 MHz" Points="%d" '
+                 'Noise="no"' % 10001)
+    eqns = []
+    for i in range(1, nodes + 1):
+        eqns.append('g%d="dB(n%d.v/n0.v)"' % (i, i))
+        eqns.append('p%d="phase(n%d.v)"' % (i, i))
+        eqns.append('m%d="max(abs(n%d.v))"' % (i, i))
+        eqns.append('d%d="diff(p%d,acfrequency)"' % (i, i))
+    lines.append('Eqn:Eqn1 %s Export="yes"' % " ".join(eqns))
+    return "\n".join(lines) + "\n"
+
+BENCHMARKS = [
+    ("rcmesh_dc", rcmesh_dc),
+    ("rcmesh_ac", rcmesh_ac),
+    ("msfilter_sp", msfilter_sp),
+    ("ring_tr", ring_tr),
+    ("buck_tr", buck_tr),
+    ("mixer_hb", mixer_hb),
+    ("eqn_post", eqn_post),
+]
+
+# -------------------------------------------------------------------------
+
+def run(qucsator, netlist, dataset):
+    """Runs qucsator once, returns wall time, peak memory (MiB) and the
+    exit status."""
+    log = open(dataset + ".log", "w")
+    start = time.time()
+    proc = subprocess.Popen([qucsator, "--profile", "-i", netlist,
+                             "-o", dataset], stdout=log, stderr=log)
+    _, status, usage = os.wait4(proc.pid, 0)
+    wall = time.time() - start
+    log.close()
+    rss = usage.ru_maxrss / 1024.0
+    if sys.platform == "darwin":
+        rss /= 1024.0
+    return wall, rss, os.WEXITSTATUS(status) if os.WIFEXITED(status) else -1
+
+def summarize(profile):
+    """Sums the counters and the CPU time of all analyses."""
+    total = {"newton": 0, "factorizations": 0, "rejected": 0}
+    cpu = 0.0
+    for a in profile.get("analyses", []):
+        for k in total:
+            total[k] += a["counters"].get(k, 0)
+        if a["type"] == "simulator":
+            cpu = a["cpu"]
+    return total, cpu
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--qucsator", default="qucsator")
+    parser.add_argument("--scale", type=int, default=1)
+    parser.add_argument("--repeat", type=int, default=3)
+    parser.add_argument("--threshold", type=float, default=0.2)
+    parser.add_argument("--baseline", default="bench-baseline.json")
+    parser.add_argument("--update", action="store_true")
+    parser.add_argument("--only", default="")
+    parser.add_argument("--workdir", default="bench")
+    args = parser.parse_args()
+
+    only = [n for n in args.only.split(",") if n]
+    if not os.path.isdir(args.workdir):
+        os.makedirs(args.workdir)
+
+    baseline = {}
+    if os.path.exists(args.baseline) and not args.update:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+    key = "scale%d" % args.scale
+    reference = baseline.get(key, {})
+
+    results = {}
+    failed = []
+    print("%-12s %9s %9s %9s %10s %10s  %s"
+          % ("benchmark", "wall/s", "cpu/s", "mem/MiB", "newton/s",
+             "factor/s", "status"))
+    for name, generate in BENCHMARKS:
+        if only and name not in only:
+            continue
+        netlist = os.path.join(args.workdir, name + ".net")
+        dataset = os.path.join(args.workdir, name + ".dat")
+        with open(netlist, "w") as f:
+            f.write(generate(args.scale))
+
+        # the fastest of the runs is least disturbed by the machine load
+        best = None
+        for _ in range(max(args.repeat, 1)):
+            wall, rss, status = run(args.qucsator, netlist, dataset)
+            if status != 0:
+                best = None
+                break
+            if best is None or wall < best[0]:
+                best = (wall, rss)
+        if best is None:
+            print("%-12s %9s %9s %9s %10s %10s  FAILED (exit %d, see %s.log)"
+                  % (name, "-", "-", "-", "-", "-", status, dataset))
+            failed.append(name)
+            continue
+
+        wall, rss = best
+        with open(dataset + ".profile.json") as f:
+            counters, cpu = summarize(json.load(f))
+        results[name] = {"wall": wall, "cpu": cpu, "memory": rss,
+                         "newton": counters["newton"],
+                         "factorizations": counters["factorizations"]}
+
+        verdict = "ok"
+        ref = reference.get(name)
+        if ref:
+            slower = wall / ref["wall"] - 1.0
+            larger = rss / ref["memory"] - 1.0
+            verdict = "%+.0f%% time %+.0f%% memory" % (100 * slower, 100 * larger)
+            if slower > args.threshold or larger > args.threshold:
+                verdict += " REGRESSION"
+                failed.append(name)
+        else:
+            verdict = "new baseline"
+        print("%-12s %9.3f %9.3f %9.1f %10.0f %10.0f  %s"
+              % (name, wall, cpu, rss, counters["newton"] / wall,
+                 counters["factorizations"] / wall, verdict))
+
+    # keep the baseline of benchmarks run for the first time
+    update = args.update or any(n not in reference for n in results)
+    if update:
+        for n, r in results.items():
+            if args.update or n not in reference:
+                reference[n] = r
+        baseline[key] = reference
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+
+    if failed:
+        print("failed: %s" % ", ".join(failed))
+        return 1
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
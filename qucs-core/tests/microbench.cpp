@@ -0,0 +1,416 @@
+/*
+ * microbench.cpp - Micro-benchmarks of the math kernels and data structures
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+/* Usage: libqucsBench [--min-time SECONDS] [FILTER...]
+
+   Runs every benchmark whose name contains one of the filters, all of
+   them without filters.  Each benchmark is repeated until it ran for
+   the minimum time (0.5 seconds by default) and reported as
+
+     name/argument   time per iteration   iterations   items per second
+
+   where the items are the natural unit of the kernel (points
+   transformed, unknowns solved, values written etc.). */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+
+#include "qucs_typedefs.h"
+#include "real.h"
+#include "complex.h"
+#include "object.h"
+#include "vector.h"
+#include "strlist.h"
+#include "dataset.h"
+#include "matrix.h"
+#include "fourier.h"
+#include "poly.h"
+#include "spline.h"
+#include "interpolator.h"
+#include "tvector.h"
+#include "tmatrix.h"
+#include "eqnsys.h"
+
+// keeps the compiler from dropping the benchmarked computations
+static volatile nr_double_t sink;
+
+// A benchmark runs the kernel the given number of iterations for the
+// argument (usually the problem size) and returns the items processed
+// per iteration.
+typedef long (* benchfunc_t) (int, long);
+
+struct bench_t {
+  const char * name;
+  benchfunc_t func;
+  int args[6];  // zero terminated
+};
+
+/* ------------------------------------------------------------------ */
+
+static long fft_1d (int n, long iters) {
+  nr_double_t * data = new nr_double_t[2 * n];
+  for (int i = 0; i < 2 * n; i++) data[i] = (i % 7) - 3;
+  for (long it = 0; it < iters; it++) {
+    qucs::fourier::_fft_1d (data, n, (it & 1) ? -1 : 1);
+    sink = data[0];
+  }
+  delete[] data;
+  return n;
+}
+
+// square n x n transform
+static long fft_nd (int n, long iters) {
+  int dims[2] = { n, n };
+  nr_double_t * data = new nr_double_t[2 * n * n];
+  for (int i = 0; i < 2 * n * n; i++) data[i] = (i % 5) - 2;
+  for (long it = 0; it < iters; it++) {
+    qucs::fourier::_fft_nd (data, dims, 2, (it & 1) ? -1 : 1);
+    sink = data[0];
+  }
+  delete[] data;
+  return n * n;
+}
+
+/* Diagonally dominant matrix with the structure of a resistor ladder
+   plus a few long range couplings, solvable by all algorithms. */
+static qucs::tmatrix<nr_double_t> system (int n) {
+  qucs::tmatrix<nr_double_t> A (n);
+  for (int i = 0; i < n; i++) {
+    A (i, i) = 4 + (i % 3);
+    if (i > 0) A (i, i - 1) = A (i - 1, i) = -1;
+    if (i >= 7) A (i, i - 7) = -0.5;
+  }
+  return A;
+}
+
+static long solve (int algo, int n, long iters) {
+  qucs::tmatrix<nr_double_t> A = system (n);
+  qucs::tvector<nr_double_t> x (n), b (n);
+  for (int i = 0; i < n; i++) b (i) = 1 + (i % 2);
+  qucs::eqnsys<nr_double_t> eqns;
+  eqns.setAlgo (algo);
+  for (long it = 0; it < iters; it++) {
+    // the factorizing algorithms work in place
+    qucs::tmatrix<nr_double_t> M = A;
+    eqns.passEquationSys (&M, &x, &b);
+    eqns.solve ();
+    sink = x (0);
+  }
+  return n;
+}
+
+#define EQNSYS_BENCH(algo) \
+  static long eqnsys_##algo (int n, long iters) { \
+    return solve (ALGO_##algo, n, iters); \
+  }
+
+EQNSYS_BENCH (GAUSS)
+EQNSYS_BENCH (GAUSS_JORDAN)
+EQNSYS_BENCH (LU_DECOMPOSITION_CROUT)
+EQNSYS_BENCH (LU_DECOMPOSITION_DOOLITTLE)
+EQNSYS_BENCH (LU_DECOMPOSITION_SPARSE)
+EQNSYS_BENCH (JACOBI)
+EQNSYS_BENCH (GAUSS_SEIDEL)
+EQNSYS_BENCH (SOR)
+EQNSYS_BENCH (QR_DECOMPOSITION)
+EQNSYS_BENCH (SV_DECOMPOSITION)
+EQNSYS_BENCH (BICGSTAB)
+
+// n-port S-parameter like matrix
+static qucs::matrix smatrix (int n) {
+  qucs::matrix s (n);
+  for (int r = 0; r < n; r++)
+    for (int c = 0; c < n; c++)
+      s (r, c) = nr_complex_t (r == c ? 0.1 : 0.4 / n, 0.01 * (r - c));
+  return s;
+}
+
+static long matrix_stos (int n, long iters) {
+  qucs::matrix s = smatrix (n);
+  for (long it = 0; it < iters; it++)
+    sink = real (qucs::stos (s, 50.0, 75.0) (0, 0));
+  return n * n;
+}
+
+static long matrix_ytos (int n, long iters) {
+  qucs::matrix y = smatrix (n);
+  for (long it = 0; it < iters; it++)
+    sink = real (qucs::ytos (y) (0, 0));
+  return n * n;
+}
+
+static long matrix_inverse (int n, long iters) {
+  qucs::matrix s = smatrix (n);
+  for (long it = 0; it < iters; it++)
+    sink = real (qucs::inverse (s) (0, 0));
+  return n * n;
+}
+
+static void samples (int n, nr_double_t * x, nr_double_t * y) {
+  for (int i = 0; i < n; i++) {
+    x[i] = i + 0.25 * (i % 3);
+    y[i] = std::sin (0.1 * i);
+  }
+}
+
+static long spline_construct (int n, long iters) {
+  nr_double_t * x = new nr_double_t[n];
+  nr_double_t * y = new nr_double_t[n];
+  samples (n, x, y);
+  for (long it = 0; it < iters; it++) {
+    qucs::spline sp (qucs::SPLINE_BC_NATURAL);
+    sp.vectors (y, x, n);
+    sp.construct ();
+  }
+  delete[] x;
+  delete[] y;
+  return n;
+}
+
+// evaluates at n points per iteration, spread over the whole range
+static long spline_evaluate (int n, long iters) {
+  nr_double_t * x = new nr_double_t[n];
+  nr_double_t * y = new nr_double_t[n];
+  samples (n, x, y);
+  qucs::spline sp (qucs::SPLINE_BC_NATURAL);
+  sp.vectors (y, x, n);
+  sp.construct ();
+  for (long it = 0; it < iters; it++)
+    for (int i = 0; i < n; i++)
+      sink = sp.evaluate ((i * 7919 % n) + 0.5).f0;
+  delete[] x;
+  delete[] y;
+  return n;
+}
+
+// evaluates at n ascending points per iteration in a single pass
+static long spline_evaluate_batch (int n, long iters) {
+  nr_double_t * x = new nr_double_t[n];
+  nr_double_t * y = new nr_double_t[n];
+  nr_double_t * t = new nr_double_t[n];
+  nr_double_t * v = new nr_double_t[n];
+  samples (n, x, y);
+  for (int i = 0; i < n; i++) t[i] = i + 0.5;
+  qucs::spline sp (qucs::SPLINE_BC_NATURAL);
+  sp.vectors (y, x, n);
+  sp.construct ();
+  for (long it = 0; it < iters; it++) {
+    sp.evaluate (t, n, v);
+    sink = v[n - 1];
+  }
+  delete[] x;
+  delete[] y;
+  delete[] t;
+  delete[] v;
+  return n;
+}
+
+/* Interpolation at n random points, dominated by the search of the
+   interval (interpolator::findIndex) for the linear interpolation. */
+static long interpolate (int n, long iters, int type, int complex) {
+  nr_double_t * x = new nr_double_t[n];
+  nr_double_t * y = new nr_double_t[n];
+  nr_complex_t * z = new nr_complex_t[n];
+  samples (n, x, y);
+  for (int i = 0; i < n; i++) z[i] = nr_complex_t (y[i], -y[i]);
+  qucs::interpolator inter;
+  if (complex)
+    inter.vectors (z, x, n);
+  else
+    inter.vectors (y, x, n);
+  inter.prepare (type, REPEAT_NO);
+  for (long it = 0; it < iters; it++)
+    for (int i = 0; i < n; i++) {
+      nr_double_t t = (i * 7919 % n) + 0.5;
+      sink = complex ? real (inter.cinterpolate (t)) : inter.rinterpolate (t);
+    }
+  delete[] x;
+  delete[] y;
+  delete[] z;
+  return n;
+}
+
+static long interpolator_rlinear (int n, long iters) {
+  return interpolate (n, iters, INTERPOL_LINEAR, 0);
+}
+
+static long interpolator_clinear (int n, long iters) {
+  return interpolate (n, iters, INTERPOL_LINEAR, 1);
+}
+
+static long interpolator_cspline (int n, long iters) {
+  return interpolate (n, iters, INTERPOL_CUBIC, 1);
+}
+
+// appends n values one by one, as the solvers save their results
+static long vector_add (int n, long iters) {
+  for (long it = 0; it < iters; it++) {
+    qucs::vector v;
+    for (int i = 0; i < n; i++)
+      v.add (nr_complex_t (i, -i));
+    sink = v.getSize ();
+  }
+  return n;
+}
+
+/* Dataset of an AC like analysis: a frequency dependency of n points
+   and 20 complex variables. */
+static qucs::dataset * acdataset (int n) {
+  qucs::dataset * data = new qucs::dataset ();
+  qucs::vector * f = new qucs::vector ("frequency", n);
+  for (int i = 0; i < n; i++) f->set (1e3 * (i + 1), i);
+  data->addDependency (f);
+  for (int k = 0; k < 20; k++) {
+    qucs::vector * v = new qucs::vector ("n" + std::to_string (k) + ".v", n);
+    qucs::strlist * deps = new qucs::strlist ();
+    deps->add ("frequency");
+    v->setDependencies (deps);
+    for (int i = 0; i < n; i++)
+      v->set (nr_complex_t (1.0 / (i + k + 1), -0.5 / (i + 1)), i);
+    data->addVariable (v);
+  }
+  return data;
+}
+
+static std::string tmpname (void) {
+  return "microbench." + std::to_string (getpid ()) + ".dat";
+}
+
+static long dataset_print (int n, long iters) {
+  std::string file = tmpname ();
+  qucs::dataset * data = acdataset (n);
+  data->setFile (file.c_str ());
+  for (long it = 0; it < iters; it++)
+    data->print ();
+  delete data;
+  unlink (file.c_str ());
+  return 21 * n;
+}
+
+static long dataset_load (int n, long iters) {
+  std::string file = tmpname ();
+  qucs::dataset * data = acdataset (n);
+  data->setFile (file.c_str ());
+  data->print ();
+  delete data;
+  for (long it = 0; it < iters; it++) {
+    data = qucs::dataset::load (file.c_str ());
+    sink = data ? data->countVariables () : 0;
+    delete data;
+  }
+  unlink (file.c_str ());
+  return 21 * n;
+}
+
+/* ------------------------------------------------------------------ */
+
+static bench_t benchmarks[] = {
+  { "fourier::_fft_1d",          fft_1d,  { 64, 1000, 1024, 16384, 1 << 20, 0 } },
+  { "fourier::_fft_nd",          fft_nd,  { 16, 64, 256, 0 } },
+  { "eqnsys/GAUSS",              eqnsys_GAUSS, { 10, 50, 200, 0 } },
+  { "eqnsys/GAUSS_JORDAN",       eqnsys_GAUSS_JORDAN, { 10, 50, 200, 0 } },
+  { "eqnsys/LU_CROUT",           eqnsys_LU_DECOMPOSITION_CROUT,
+    { 10, 50, 200, 800, 0 } },
+  { "eqnsys/LU_DOOLITTLE",       eqnsys_LU_DECOMPOSITION_DOOLITTLE,
+    { 10, 50, 200, 800, 0 } },
+  { "eqnsys/LU_SPARSE",          eqnsys_LU_DECOMPOSITION_SPARSE,
+    { 10, 50, 200, 800, 0 } },
+  { "eqnsys/JACOBI",             eqnsys_JACOBI, { 10, 50, 200, 0 } },
+  { "eqnsys/GAUSS_SEIDEL",       eqnsys_GAUSS_SEIDEL, { 10, 50, 200, 0 } },
+  { "eqnsys/SOR",                eqnsys_SOR, { 10, 50, 200, 0 } },
+  { "eqnsys/QR",                 eqnsys_QR_DECOMPOSITION, { 10, 50, 200, 0 } },
+  { "eqnsys/SVD",                eqnsys_SV_DECOMPOSITION, { 10, 50, 0 } },
+  { "eqnsys/BICGSTAB",           eqnsys_BICGSTAB, { 10, 50, 200, 800, 0 } },
+  { "matrix::stos",              matrix_stos, { 2, 4, 16, 64, 0 } },
+  { "matrix::ytos",              matrix_ytos, { 2, 4, 16, 64, 0 } },
+  { "matrix::inverse",           matrix_inverse, { 2, 4, 16, 64, 0 } },
+  { "spline::construct",         spline_construct, { 16, 1024, 65536, 0 } },
+  { "spline::evaluate",          spline_evaluate, { 16, 1024, 65536, 0 } },
+  { "spline::evaluate batch",    spline_evaluate_batch, { 16, 1024, 65536, 0 } },
+  { "interpolator::rlinear",     interpolator_rlinear, { 16, 1024, 65536, 0 } },
+  { "interpolator::cinterpolate", interpolator_clinear, { 16, 1024, 65536, 0 } },
+  { "interpolator::cspline",     interpolator_cspline, { 16, 1024, 65536, 0 } },
+  { "vector::add",               vector_add, { 100, 10000, 1000000, 0 } },
+  { "dataset::print",            dataset_print, { 100, 10000, 100000, 0 } },
+  { "dataset::load",             dataset_load, { 100, 10000, 100000, 0 } },
+  { NULL, NULL, { 0 } }
+};
+
+typedef std::chrono::steady_clock benchclock;
+
+static double elapsed (benchclock::time_point start) {
+  return std::chrono::duration<double> (benchclock::now () - start).count ();
+}
+
+/* Runs the benchmark with doubling iteration counts until the run
+   lasts the minimum time, then prints its timing. */
+static void run (bench_t * b, int arg, double mintime) {
+  long iters = 1, items = 0;
+  double t = 0;
+  for (;;) {
+    benchclock::time_point start = benchclock::now ();
+    items = b->func (arg, iters);
+    t = elapsed (start);
+    if (t >= mintime || iters >= (1L << 40)) break;
+    // aim a little above the minimum time, at most ten times longer
+    double scale = t > 0 ? 1.4 * mintime / t : 10;
+    iters = (long) (iters * (scale > 10 ? 10 : scale < 2 ? 2 : scale));
+  }
+  char name[256];
+  snprintf (name, sizeof (name), "%s/%d", b->name, arg);
+  double per = t / iters;
+  const char * unit = "s";
+  if (per < 1e-6)      { per *= 1e9; unit = "ns"; }
+  else if (per < 1e-3) { per *= 1e6; unit = "us"; }
+  else if (per < 1)    { per *= 1e3; unit = "ms"; }
+  printf ("%-38s %10.3f %-2s %12ld %14.4g items/s\n",
+	  name, per, unit, iters, (double) items * iters / t);
+  fflush (stdout);
+}
+
+static int selected (const char * name, int argc, char ** argv, int first) {
+  if (first >= argc) return 1;
+  for (int i = first; i < argc; i++)
+    if (strstr (name, argv[i])) return 1;
+  return 0;
+}
+
+int main (int argc, char ** argv) {
+  double mintime = 0.5;
+  int first = 1;
+  if (argc > 2 && !strcmp (argv[1], "--min-time")) {
+    mintime = atof (argv[2]);
+    first = 3;
+  }
+  printf ("%-38s %13s %12s %20s\n", "benchmark", "time", "iterations",
+	  "throughput");
+  for (bench_t * b = benchmarks; b->name; b++) {
+    if (!selected (b->name, argc, argv, first)) continue;
+    for (int i = 0; b->args[i]; i++)
+      run (b, b->args[i], mintime);
+  }
+  return 0;
+}
@@ -73,6 +73,31 @@ int QUCS_Att::Calc(tagATT *ATT)
     }
 }
 
+// S-parameters of the calculated attenuator between Zin and Zout,
+// out of the chain matrices of its resistors
+twoport::sparam QUCS_Att::Response(tagATT *ATT)
+{
+  using namespace twoport;
+  abcd m = through();
+
+  switch(ATT->Topology)
+    {
+    case PI_TYPE:
+      m = cascade(shunt(1 / ATT->R1), series(ATT->R2));
+      m = cascade(m, shunt(1 / ATT->R3));
+      break;
+    case TEE_TYPE:
+      m = cascade(series(ATT->R1), shunt(1 / ATT->R2));
+      m = cascade(m, series(ATT->R3));
+      break;
+    case BRIDGE_TYPE:
+      m = cascade(series(ATT->Zin), shunt(1 / ATT->R2));
+      m = cascade(m, series(ATT->Zout));
+      m = parallel(m, series(ATT->R1));
+      break;
+    }
+  return atos(m, ATT->Zin, ATT->Zout);
+}
 
 QString* QUCS_Att::createSchematic(tagATT *ATT)
 {
@@ -19,6 +19,8 @@
 
 #include <cmath>
 
+#include "../qucs/twoport.h"
+
 struct tagATT
 {
   int Topology;
@@ -41,6 +43,7 @@ class QUCS_Att
 
   int Calc(tagATT*);
   static QString* createSchematic(tagATT*);
+  static twoport::sparam Response(tagATT*);
 
 
 };
@@ -116,6 +116,8 @@ QucsAttenuator::QucsAttenuator()
   inGrid->addWidget(lineEdit_Attvalue, 1,1);
   QLabel *Label1 = new QLabel(tr("dB"), InputGroup);
   inGrid->addWidget(Label1, 1,2);
+  connect(lineEdit_Attvalue, SIGNAL(textChanged(const QString&)), this,
+      SLOT(slotPreview()) );
 
   LabelImp1 = new QLabel(tr("Zin:"), InputGroup);
   inGrid->addWidget(LabelImp1, 2,0);
@@ -123,6 +125,8 @@ QucsAttenuator::QucsAttenuator()
   lineEdit_Zin->setValidator(DoubleVal);
   connect(lineEdit_Zin, SIGNAL(textChanged(const QString&)), this,
       SLOT(slotSetText_Zin(const QString&)) );
+  connect(lineEdit_Zin, SIGNAL(textChanged(const QString&)), this,
+      SLOT(slotPreview()) );
 
   inGrid->addWidget(lineEdit_Zin, 2,1);
   QLabel *Label2 = new QLabel(tr("Ohm"), InputGroup);
@@ -134,6 +138,8 @@ QucsAttenuator::QucsAttenuator()
   lineEdit_Zout->setValidator(DoubleVal);
   connect(lineEdit_Zout, SIGNAL(textChanged(const QString&)), this,
       SLOT(slotSetText_Zout(const QString&)) );
+  connect(lineEdit_Zout, SIGNAL(textChanged(const QString&)), this,
+      SLOT(slotPreview()) );
   inGrid->addWidget(lineEdit_Zout, 3,1);
   QLabel *Label3 = new QLabel(tr("Ohm"), InputGroup);
   inGrid->addWidget(Label3, 3,2);
@@ -188,7 +194,13 @@ QucsAttenuator::QucsAttenuator()
   vbox->addLayout(hbox);
   vbox->addWidget(LabelResult);
 
+  // response of the attenuator, updated as the input changes
+  LabelPreview = new QLabel();
+  LabelPreview->setAlignment(Qt::AlignHCenter);
+  vbox->addWidget(LabelPreview);
+
   centralWidget->setLayout(vbox);
+  slotPreview();
 
 }
 
@@ -288,6 +300,7 @@ void QucsAttenuator::slotTopologyChanged()
       lineEdit_Zout->setText( lineEdit_Zin->text() );
       break;
     }
+    slotPreview();
     adjustSize();
 }
 
@@ -328,3 +341,30 @@ void QucsAttenuator::slotCalculate()
     }
     adjustSize();
 }
+
+// Shows the S-parameters of the attenuator for the current input,
+// computed directly without simulation
+void QucsAttenuator::slotPreview()
+{
+    QUCS_Att qatt;
+    struct tagATT Values;
+
+    Values.Topology = ComboTopology->currentIndex();
+    Values.Attenuation = lineEdit_Attvalue->text().toDouble();
+    Values.Zin = lineEdit_Zin->text().toDouble();
+    Values.Zout = lineEdit_Zout->text().toDouble();
+
+    if(Values.Zin <= 0 || Values.Zout <= 0 || Values.Attenuation <= 0 ||
+       qatt.Calc(&Values) == -1)
+    {
+      LabelPreview->setText(tr("Response:")+" --");
+      return;
+    }
+
+    twoport::sparam S = QUCS_Att::Response(&Values);
+    LabelPreview->setText(tr("Response:")+
+      QString(" S21 = %1 dB, S11 = %2 dB, S22 = %3 dB")
+        .arg(twoport::dB(S.s21), 0, 'f', 2)
+        .arg(qMax(twoport::dB(S.s11), -99.99), 0, 'f', 2)
+        .arg(qMax(twoport::dB(S.s22), -99.99), 0, 'f', 2));
+}
@@ -49,6 +49,7 @@ class QucsAttenuator : public QMainWindow
   void slotHelpAboutQt();
   void slotTopologyChanged();
   void slotCalculate();
+  void slotPreview();
   void slotQuit();
   void slotSetText_Zin(const QString &);
   void slotSetText_Zout(const QString &);
@@ -57,7 +58,7 @@ class QucsAttenuator : public QMainWindow
   QComboBox *ComboTopology;
   QLabel *LabelTopology, *LabelAtten, *LabelImp1, *LabelImp2;
   QLabel *LabelR1, *LabelR2, *LabelR3, *pixTopology, *LabelResult;
-  QLabel *LabelR3_Ohm;
+  QLabel *LabelR3_Ohm, *LabelPreview;
   QLineEdit *lineEdit_Attvalue, *lineEdit_Zin, *lineEdit_Zout;
   QLineEdit *lineEdit_R1, *lineEdit_R2, *lineEdit_R3, *lineEdit_Results;
   QPushButton *Calculate;
@@ -0,0 +1,454 @@
+/***************************************************************************
+                               qf_batch.cpp
+                             ----------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+// Batch synthesis over a grid of filters, orders, ripples and forms,
+// each one followed by a Monte-Carlo analysis of its component
+// tolerances.  The response of the ladders is computed out of their
+// chain matrix, so no schematic and no simulator run is needed.
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include "qf_common.h"
+#include "qf_poly.h"
+#include "qf_comp.h"
+#include "qf_capacity.h"
+#include "qf_filter.h"
+#include "qf_tform.h"
+#include "qf_api.h"
+#include "qf_batch.h"
+
+// Number of frequencies checked in pass- and stopband
+const unsigned	QF_BATCH_PASS = 32;
+const unsigned	QF_BATCH_STOP = 16;
+
+// A grid point as seen by the worker threads
+
+struct qf_batch_job {
+  qf_batch_pt*		pt;
+  const qf_batch_opt*	opt;
+  unsigned		idx;
+};
+
+// Impedance of a branch at w
+
+static Cplx branch_z (const qf_ldr& b, qf_double_t w) {
+
+  Cplx	jw (0, w);
+
+  switch (b. type) {
+    case QF_LDR_IND:  return jw * b. L;
+    case QF_LDR_CAP:  return 1.0 / (jw * b. C);
+    case QF_LDR_RES:  return Cplx (b. R, 0);
+    case QF_LDR_SLC:  return jw * b. L + 1.0 / (jw * b. C);
+    case QF_LDR_PLC:  return 1.0 / (jw * b. C + 1.0 / (jw * b. L));
+    case QF_LDR_PSLC: {
+      Cplx z1 = jw * b. L + 1.0 / (jw * b. C);
+      Cplx z2 = jw * b. L2 + 1.0 / (jw * b. C2);
+      return z1 * z2 / (z1 + z2);
+    }
+  }
+  return Cplx (0, 0);
+}
+
+// The chain matrix of the ladder gives its transmission coefficient
+
+Cplx qf_ladder_s21 (const vector <qf_ldr>& ldr, qf_double_t r1,
+		    qf_double_t r2, qf_double_t w) {
+
+  Cplx	a (1, 0), b (0, 0), c (0, 0), d (1, 0);
+
+  for (unsigned i = 0; i < ldr. size (); i ++) {
+    Cplx z = branch_z (ldr [i], w);
+    if (ldr [i]. gnd) {
+      Cplx y = 1.0 / z;
+      a += b * y;
+      c += d * y;
+    }
+    else {
+      b += a * z;
+      d += c * z;
+    }
+  }
+  return 2 * sqrt (r1 * r2) / (a * r2 + b + c * r1 * r2 + d * r1);
+}
+
+// Translates the component list of a transform into a ladder
+
+static bool get_ladder (qf_tform* T, vector <qf_ldr>& ldr) {
+
+  qf_lcmp*  l = T -> cmps ();
+  qf_cmp*   cmp;
+
+  if (l -> isvoid ()) return false;
+  l -> init ();
+  while ((cmp = l -> next ()) != NULL) {
+    qf_ldr  b = {0, cmp -> gnd, 0, 0, 0, 0, 0};
+
+    if (cmp -> name == "IND" || cmp -> name == "CAP" ||
+	cmp -> name == "RES") {
+      qf_cmp1* c = dynamic_cast <qf_cmp1*> (cmp);
+      if (cmp -> name == "IND") {b. type = QF_LDR_IND; b. L = c -> val;}
+      if (cmp -> name == "CAP") {b. type = QF_LDR_CAP; b. C = c -> val;}
+      if (cmp -> name == "RES") {b. type = QF_LDR_RES; b. R = c -> val;}
+    }
+    else if (cmp -> name == "SLC" || cmp -> name == "PLC" ||
+	     cmp -> name == "PSLC") {
+      qf_cmplc* c = dynamic_cast <qf_cmplc*> (cmp);
+      b. L = c -> vL;
+      b. C = c -> vC;
+      if (cmp -> name == "SLC") b. type = QF_LDR_SLC;
+      if (cmp -> name == "PLC") b. type = QF_LDR_PLC;
+      if (cmp -> name == "PSLC") {
+	qf_pslc* p = dynamic_cast <qf_pslc*> (cmp);
+	b. type = QF_LDR_PSLC;
+	b. L2 = p -> vL2;
+	b. C2 = p -> vC2;
+      }
+    }
+    else
+      return false;
+    ldr. push_back (b);
+  }
+  return ldr. size () > 0;
+}
+
+// Geometrically spaced frequencies in [a, b]
+
+static void span (Rvector& v, qf_double_t a, qf_double_t b, unsigned n) {
+
+  for (unsigned i = 0; i < n; i ++)
+    v. push_back (a * pow (b / a, (qf_double_t) i / (n - 1)));
+}
+
+// Frequencies of pass- and stopband according to the transform.
+// Returns false for the transforms not handled here.
+
+static bool get_bands (qf_spec& s, Rvector& pass, Rvector& stop) {
+
+  unsigned    id = qf_tform_apis [s. tform] -> id;
+  qf_double_t w0 = sqrt (s. bw * s. bw / 4 + s. fc * s. fc);
+  qf_double_t w1 = w0 - s. bw / 2, w2 = w0 + s. bw / 2;
+  qf_double_t lo = 0, hi = 0;
+
+  if (s. fs > 0) {
+    lo = min (s. fs, s. fc * s. fc / s. fs);
+    hi = max (s. fs, s. fc * s. fc / s. fs);
+  }
+
+  switch (id) {
+    case QF_LOWPASS:
+      span (pass, s. fc / 100, s. fc, QF_BATCH_PASS);
+      if (s. fs > s. fc) span (stop, s. fs, 4 * s. fs, QF_BATCH_STOP);
+      return true;
+    case QF_HIGHPASS:
+      span (pass, s. fc, 100 * s. fc, QF_BATCH_PASS);
+      if (s. fs > 0 && s. fs < s. fc) span (stop, s. fs / 4, s. fs,
+					    QF_BATCH_STOP);
+      return true;
+    case QF_BANDPASS:
+      span (pass, w1, w2, QF_BATCH_PASS);
+      if (s. fs > 0) {
+	span (stop, lo / 4, lo, QF_BATCH_STOP / 2);
+	span (stop, hi, 4 * hi, QF_BATCH_STOP / 2);
+      }
+      return true;
+    case QF_BANDSTOP:
+      span (pass, w1 / 100, w1, QF_BATCH_PASS / 2);
+      span (pass, w2, 100 * w2, QF_BATCH_PASS / 2);
+      if (s. fs > 0) span (stop, lo, hi, QF_BATCH_STOP);
+      return true;
+  }
+  return false;
+}
+
+// Worst insertion loss in the passband and worst attenuation in the
+// stopband
+
+static void response (const vector <qf_ldr>& ldr, qf_spec& s,
+		      Rvector& pass, Rvector& stop,
+		      qf_double_t& loss, qf_double_t& atten) {
+
+  loss = 0;
+  atten = numeric_limits <qf_double_t>::max ();
+  for (unsigned i = 0; i < pass. size (); i ++)
+    loss = max (loss, -20 * log10 (abs (qf_ladder_s21 (ldr, s. r1, s. r2,
+							pass [i]))));
+  for (unsigned i = 0; i < stop. size (); i ++)
+    atten = min (atten, -20 * log10 (abs (qf_ladder_s21 (ldr, s. r1, s. r2,
+							  stop [i]))));
+}
+
+// Small random generator (xorshift) giving the same samples whatever
+// the number of threads is
+
+static qf_double_t rnd (unsigned& x) {
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return (qf_double_t) x / 4294967296.0;
+}
+
+// Synthesis and tolerance analysis of one grid point
+
+static void run (qf_batch_job& job) {
+
+  qf_batch_pt&	      p = * job. pt;
+  const qf_batch_opt& o = * job. opt;
+  vector <qf_ldr>     ldr;
+  Rvector	      pass, stop;
+
+  p. ok = false;
+  p. ncmp = 0;
+  p. loss = p. atten = p. yield = 0;
+
+  if (! get_bands (p. spec, pass, stop)) return;
+
+  qf_tform* T = qf_tform_apis [p. spec. tform] -> cons (& p. spec);
+  bool	    ok = get_ladder (T, ldr);
+  delete T;
+  if (! ok) return;
+
+  p. ok = true;
+  p. ncmp = ldr. size ();
+  response (ldr, p. spec, pass, stop, p. loss, p. atten);
+  if (stop. empty ()) p. atten = 0;
+
+  // Limits for the samples
+  qf_double_t lmax = p. loss + o. margin;
+  qf_double_t amin = p. spec. amax > 0 ? p. spec. amax : p. atten - o. margin;
+
+  unsigned    seed = o. seed + 2654435761u * (job. idx + 1);
+  unsigned    good = 0;
+  if (seed == 0) seed = 1;
+
+  for (unsigned n = 0; n < o. samples; n ++) {
+    vector <qf_ldr> smp = ldr;
+    for (unsigned i = 0; i < smp. size (); i ++) {
+      smp [i]. L  *= 1 + o. tol * (2 * rnd (seed) - 1);
+      smp [i]. C  *= 1 + o. tol * (2 * rnd (seed) - 1);
+      smp [i]. R  *= 1 + o. tol * (2 * rnd (seed) - 1);
+      smp [i]. L2 *= 1 + o. tol * (2 * rnd (seed) - 1);
+      smp [i]. C2 *= 1 + o. tol * (2 * rnd (seed) - 1);
+    }
+
+    qf_double_t loss, atten;
+    response (smp, p. spec, pass, stop, loss, atten);
+    if (loss <= lmax && (stop. empty () || atten >= amin)) good ++;
+  }
+  if (o. samples > 0) p. yield = (qf_double_t) good / o. samples;
+}
+
+void qf_batch (vector <qf_batch_pt>& pts, const qf_batch_opt& opt,
+	       int threads) {
+
+  QList <qf_batch_job> jobs;
+
+  for (unsigned i = 0; i < pts. size (); i ++) {
+    qf_batch_job  j = {& pts [i], & opt, i};
+    jobs. append (j);
+  }
+
+  if (threads > 1) {
+    QThreadPool::globalInstance () -> setMaxThreadCount (threads);
+    QtConcurrent::blockingMap (jobs, run);
+  }
+  else
+    for (int i = 0; i < jobs. size (); i ++) run (jobs [i]);
+}
+
+// Command line
+
+static void usage (void) {
+
+  fprintf (stderr,
+    "Usage: qucsfilter -b [key=value] ...\n\n"
+    "  tform=<name>          transformation (Lowpass)\n"
+    "  filter=<name,...>     filter types (all)\n"
+    "  ord=<n,...|min:max>   orders (3:9)\n"
+    "  ripple=<dB,...>       passband ripples (1)\n"
+    "  dual=<no,yes>         forms of the ladder (no)\n"
+    "  fc, fs, bw=<Hz>       cutoff, stopband and bandwidth\n"
+    "  atten=<dB>            stopband attenuation\n"
+    "  angle=<deg>           Cauer filter angle\n"
+    "  r1, r2=<Ohm>          input and output impedance (50)\n"
+    "  samples=<n>           Monte-Carlo samples per filter (1000)\n"
+    "  tol=<x>               relative component tolerance (0.05)\n"
+    "  margin=<dB>           allowed passband degradation (0.5)\n"
+    "  seed=<n>              random seed (1)\n"
+    "  threads=<n>           number of threads\n");
+}
+
+// Index of the api with the given name, -1 if none
+
+static int find_filter (const QString& name) {
+
+  for (int i = 0; qf_filter_apis [i] != NULL; i ++)
+    if (qf_filter_apis [i] -> name. toLower () == name. toLower ()) return i;
+  return -1;
+}
+
+static int find_tform (const QString& name) {
+
+  for (int i = 0; qf_tform_apis [i] != NULL; i ++)
+    if (qf_tform_apis [i] -> name. toLower () == name. toLower ()) return i;
+  return -1;
+}
+
+// Is the given order possible for the filter?
+
+static bool order_ok (qf_filter_api* f, unsigned o) {
+
+  bool	ok = ! f -> only_some_orders;
+
+  if (f -> f_ord_list != NULL)
+    for (unsigned i = 0; f -> f_ord_list [i] != 0; i ++)
+      if ((unsigned) f -> f_ord_list [i] == o) ok = ! ok;
+  return ok;
+}
+
+int qf_batch_main (int argc, char* argv []) {
+
+  QStringList	filters, ripples ("1"), duals ("no");
+  QString	tform = "Lowpass", ords = "3:9";
+  qf_spec	base;
+  qf_batch_opt	opt = {1000, 0.05, 0.5, 1};
+  int		threads = QThread::idealThreadCount ();
+
+  memset (& base, 0, sizeof (base));
+  base. fc = 1e9;
+  base. r1 = base. r2 = 50;
+  base. ang = 45;
+  base. subord = ' ';
+
+  for (int i = 1; i < argc; i ++) {
+    QString arg = argv [i];
+    int	    eq = arg. indexOf ('=');
+
+    if (eq <= 0) {usage (); return 1;}
+    QString key = arg. left (eq), val = arg. mid (eq + 1);
+    if (key == "tform")		tform = val;
+    else if (key == "filter")	filters = val. split (',');
+    else if (key == "ord")	ords = val;
+    else if (key == "ripple")	ripples = val. split (',');
+    else if (key == "dual")	duals = val. split (',');
+    else if (key == "fc")	base. fc = val. toDouble ();
+    else if (key == "fs")	base. fs = val. toDouble ();
+    else if (key == "bw")	base. bw = val. toDouble ();
+    else if (key == "atten")	base. amax = val. toDouble ();
+    else if (key == "angle")	base. ang = val. toDouble ();
+    else if (key == "r1")	base. r1 = val. toDouble ();
+    else if (key == "r2")	base. r2 = val. toDouble ();
+    else if (key == "samples")	opt. samples = val. toUInt ();
+    else if (key == "tol")	opt. tol = val. toDouble ();
+    else if (key == "margin")	opt. margin = val. toDouble ();
+    else if (key == "seed")	opt. seed = val. toUInt ();
+    else if (key == "threads")	threads = val. toInt ();
+    else {usage (); return 1;}
+  }
+
+  // Frequencies are given in Hz, angle in degrees
+  base. fc *= 2 * pi;
+  base. fs *= 2 * pi;
+  base. bw *= 2 * pi;
+  base. ang *= pi / 180;
+
+  int t = find_tform (tform);
+  if (t < 0) {
+    fprintf (stderr, "unknown transformation `%s'\n", qPrintable (tform));
+    return 1;
+  }
+  base. tform = t;
+
+  if (filters. isEmpty ())
+    for (int i = 0; qf_filter_apis [i] != NULL; i ++)
+      filters << qf_filter_apis [i] -> name;
+
+  Rvector  orders;
+  if (ords. contains (':')) {
+    for (int o = ords. section (':', 0, 0). toInt ();
+	 o <= ords. section (':', 1, 1). toInt (); o ++)
+      orders. push_back (o);
+  }
+  else {
+    QStringList l = ords. split (',');
+    for (QStringList::Iterator it = l. begin (); it != l. end (); ++ it)
+      orders. push_back ((* it). toInt ());
+  }
+
+  // The grid of all possible filters
+  vector <qf_batch_pt>	pts;
+  for (QStringList::Iterator f = filters. begin (); f != filters. end (); ++ f) {
+    int	idx = find_filter (* f);
+    if (idx < 0) {
+      fprintf (stderr, "unknown filter `%s'\n", qPrintable (* f));
+      return 1;
+    }
+    qf_filter_api* fapi = qf_filter_apis [idx];
+    if (fapi -> forbid_tform & qf_tform_apis [t] -> id) continue;
+
+    for (unsigned o = 0; o < orders. size (); o ++) {
+      unsigned ord = (unsigned) orders [o];
+      if (ord < 1 || ord > QF_MAX_ORD || ! order_ok (fapi, ord)) continue;
+
+      for (QStringList::Iterator r = ripples. begin ();
+	   r != ripples. end (); ++ r) {
+	for (QStringList::Iterator d = duals. begin ();
+	     d != duals. end (); ++ d) {
+	  qf_batch_pt  p;
+	  p. spec = base;
+	  p. spec. filter = idx;
+	  p. spec. ord_given = true;
+	  p. spec. ord = ord;
+	  p. spec. subord = ((ord % 2) == 0 && (fapi -> even & CAN_SUBORDER)) ?
+	    'b' : ' ';
+	  p. spec. amin = (* r). toDouble ();
+	  p. spec. dual = (* d == "yes");
+
+	  if (qf_tform_apis [t] -> valid != NULL &&
+	      ! qf_tform_apis [t] -> valid (& p. spec)) continue;
+	  if (fapi -> valid != NULL && ! fapi -> valid (& p. spec)) continue;
+	  pts. push_back (p);
+	}
+      }
+    }
+  }
+
+  qf_batch (pts, opt, threads);
+
+  printf ("filter,tform,order,ripple,dual,ok,branches,loss,atten,yield\n");
+  for (unsigned i = 0; i < pts. size (); i ++) {
+    qf_batch_pt& p = pts [i];
+    printf ("%s,%s,%u,%g,%s,%s,%u,%g,%g,%g\n",
+	    qPrintable (qf_filter_apis [p. spec. filter] -> name),
+	    qPrintable (qf_tform_apis [p. spec. tform] -> name),
+	    p. spec. ord, p. spec. amin, p. spec. dual ? "yes" : "no",
+	    p. ok ? "yes" : "no", p. ncmp, p. loss, p. atten, p. yield);
+  }
+  return 0;
+}
@@ -0,0 +1,70 @@
+/***************************************************************************
+                               qf_batch.h
+                             ----------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+# ifndef _QF_BATCH_H
+# define _QF_BATCH_H
+
+// Batch synthesis of filters and Monte-Carlo tolerance analysis.
+// The ladders are evaluated directly out of their component list,
+// without creating a schematic and running the simulator.
+
+// One branch of a synthesized ladder
+
+struct qf_ldr {
+  int		type;	      // One of the QF_LDR_ types below
+  bool		gnd;	      // Shunt branch to ground, else series
+  qf_double_t	L, C, R;
+  qf_double_t	L2, C2;	      // Second series LC of a PSLC
+};
+
+enum {
+  QF_LDR_IND, QF_LDR_CAP, QF_LDR_RES,
+  QF_LDR_SLC, QF_LDR_PLC, QF_LDR_PSLC
+};
+
+// One point of the synthesis grid and its results
+
+struct qf_batch_pt {
+  qf_spec	spec;	      // Filter specification
+  bool		ok;	      // Synthesis succeeded
+  unsigned	ncmp;	      // Number of ladder branches
+  qf_double_t	loss;	      // Worst passband insertion loss (dB)
+  qf_double_t	atten;	      // Worst stopband attenuation (dB)
+  qf_double_t	yield;	      // Part of the samples meeting the limits
+};
+
+// Monte-Carlo options
+
+struct qf_batch_opt {
+  unsigned	samples;      // Number of samples per grid point
+  qf_double_t	tol;	      // Relative component tolerance
+  qf_double_t	margin;	      // Allowed passband degradation (dB)
+  unsigned	seed;	      // Random seed
+};
+
+// Synthesizes every grid point and runs its tolerance analysis,
+// the points are distributed among the given number of threads
+void		qf_batch      (vector <qf_batch_pt>&, const qf_batch_opt&,
+			       int);
+
+// Transmission coefficient of a ladder between r1 and r2 at w
+Cplx		qf_ladder_s21 (const vector <qf_ldr>&, qf_double_t,
+			       qf_double_t, qf_double_t);
+
+// Command line interface, returns the exit code
+int		qf_batch_main (int, char* []);
+
+# endif	// _QF_BATCH_H
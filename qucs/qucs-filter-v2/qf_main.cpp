@@ -2,6 +2,8 @@
 # include <config.h>
 #endif
 
+#include <string.h>
+
 #include <QBuffer>
 #include <Q3TextStream>
 #include <QObject>
@@ -22,6 +24,7 @@
 #include "qf_tform.h"
 #include "qf_box.h"
 #include "qf_settings.h"
+#include "qf_batch.h"
 //Added by qt3to4:
 #include <QTranslator>
 
@@ -34,6 +37,10 @@ void compute_lumped (qf_spec* spec_p, Q3TextStream& out) {
 
 int main (int argc, char * argv []) {
 
+  // batch synthesis without the GUI
+  if (argc > 1 && ! strcmp (argv [1], "-b"))
+    return qf_batch_main (argc - 1, argv + 1);
+
   QApplication app (argc, argv);
 
   // apply default settings
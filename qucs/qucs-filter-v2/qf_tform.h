@@ -22,12 +22,12 @@ class qf_tform {
   qf_lcmp	      lcmp;
   virtual qf_double_t th	(void) = 0;
 
-  virtual 	      ~qf_tform (void) {}
-
 		      qf_tform	(qf_spec* Ts) : Tspec (Ts) {};
   public:
+  virtual 	      ~qf_tform (void) {}
 
   virtual void	      dump	(Q3TextStream&) = 0;
+  qf_lcmp*	      cmps	(void) {return & lcmp;}	// Components
 };
 
 // A common static function to dispatch denormalization
@@ -0,0 +1,181 @@
+/***************************************************************************
+                               libindex.cpp
+                              --------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QHash>
+#include <QStringList>
+
+#include "libindex.h"
+#include "qucslib.h"
+#include "qucslib_common.h"
+
+
+LibIndex::LibIndex()
+{
+  Loaded = false;
+}
+
+// ---------------------------------------------------
+// Brings the index up to date with the user and the system libraries.
+// Only libraries that are new or whose file has changed are read.
+void LibIndex::update()
+{
+  if(!Loaded)  load();
+
+  QHash<QString, int> old;
+  for(int i = 0; i < Libs.size(); i++)
+    old.insert(Libs.at(i).File, i);
+
+  QStringList Paths;
+  // user libraries (absolute path)
+  foreach(QString s, UserLibDir.entryList(QStringList("*.lib"),
+                                          QDir::Files, QDir::Name))
+    Paths.append(UserLibDir.absoluteFilePath(s));
+  // system libraries (relative path)
+  foreach(QString s, SysLibDir.entryList(QStringList("*.lib"),
+                                         QDir::Files, QDir::Name))
+    Paths.append(s);
+
+  bool changed = false;
+  QVector<Lib> Current;
+  foreach(QString p, Paths) {
+    p.chop(4); // remove extension
+    Lib lib;
+    lib.Path = p;
+    lib.File = getLibAbsPath(p);
+    QFileInfo Info(lib.File);
+    lib.Modified = Info.lastModified();
+    lib.Size = Info.size();
+
+    QHash<QString, int>::const_iterator it = old.constFind(lib.File);
+    if(it != old.constEnd()) {
+      const Lib& o = Libs.at(it.value());
+      if((o.Modified == lib.Modified) && (o.Size == lib.Size)) {
+        Current.append(o);
+        Current.last().Path = p;
+        continue;
+      }
+    }
+
+    changed = true;
+    if(scan(lib))  Current.append(lib);
+  }
+
+  if(Current.size() != Libs.size())  changed = true;
+  Libs = Current;
+  if(changed)  save();
+}
+
+// ---------------------------------------------------
+// Reads the definition of a component from the library file. Returns
+// an empty string if it is not there (anymore).
+QString LibIndex::definition(const QString& libPath, qint64 Offset,
+                             qint64 Length)
+{
+  QFile File(getLibAbsPath(libPath));
+  if(!File.open(QIODevice::ReadOnly))  return QString();
+  if(!File.seek(Offset))  return QString();
+
+  QString s = QString::fromLocal8Bit(File.read(Length));
+  if(!s.startsWith("<Component ") || !s.endsWith("</Component>"))
+    return QString();
+  return s;
+}
+
+// ---------------------------------------------------
+// Finds the name of the library and the components in its file.
+bool LibIndex::scan(Lib& lib)
+{
+  QFile File(lib.File);
+  if(!File.open(QIODevice::ReadOnly))  return false;
+  QByteArray Data = File.readAll();
+  File.close();
+
+  int Start, End, NameStart, NameEnd;
+  Start = Data.indexOf("<Qucs Library ");
+  if(Start < 0)  return false;
+  End = Data.indexOf('>', Start);
+  if(End < 0)  return false;
+  lib.Name = QString::fromLocal8Bit(Data.mid(Start, End-Start)).section('"', 1, 1);
+
+  lib.Comps.clear();
+  while((Start=Data.indexOf("\n<Component ", Start)) > 0) {
+    Start++;
+    NameStart = Start + 11;
+    NameEnd = Data.indexOf('>', NameStart);
+    if(NameEnd < 0)  break;
+
+    End = Data.indexOf("\n</Component>", NameEnd);
+    if(End < 0)  break;
+    End += 13;
+
+    Comp c;
+    c.Name = QString::fromLocal8Bit(Data.mid(NameStart, NameEnd-NameStart));
+    c.Offset = Start;
+    c.Length = End - Start;
+    lib.Comps.append(c);
+    Start = End;
+  }
+  return true;
+}
+
+// ---------------------------------------------------
+void LibIndex::load()
+{
+  Loaded = true;
+  Libs.clear();
+
+  QFile File(QucsSettings.QucsHomeDir.filePath("qucslib.idx"));
+  if(!File.open(QIODevice::ReadOnly))  return;
+
+  QDataStream Stream(&File);
+  Stream.setVersion(QDataStream::Qt_4_6);
+  qint32 Version, n, m;
+  Stream >> Version;
+  if(Version != LIBINDEX_VERSION)  return;
+
+  Stream >> n;
+  for(int i = 0; i < n && Stream.status() == QDataStream::Ok; i++) {
+    Lib lib;
+    Stream >> lib.File >> lib.Name >> lib.Modified >> lib.Size >> m;
+    for(int k = 0; k < m && Stream.status() == QDataStream::Ok; k++) {
+      Comp c;
+      Stream >> c.Name >> c.Offset >> c.Length;
+      lib.Comps.append(c);
+    }
+    Libs.append(lib);
+  }
+  if(Stream.status() != QDataStream::Ok)  Libs.clear();
+}
+
+// ---------------------------------------------------
+void LibIndex::save() const
+{
+  QFile File(QucsSettings.QucsHomeDir.filePath("qucslib.idx"));
+  if(!File.open(QIODevice::WriteOnly))  return;
+
+  QDataStream Stream(&File);
+  Stream.setVersion(QDataStream::Qt_4_6);
+  Stream << qint32(LIBINDEX_VERSION) << qint32(Libs.size());
+  foreach(const Lib& lib, Libs) {
+    Stream << lib.File << lib.Name << lib.Modified << lib.Size
+           << qint32(lib.Comps.size());
+    foreach(const Comp& c, lib.Comps)
+      Stream << c.Name << c.Offset << c.Length;
+  }
+}
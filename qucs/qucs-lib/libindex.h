@@ -0,0 +1,68 @@
+/***************************************************************************
+                                libindex.h
+                               ------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef LIBINDEX_H
+#define LIBINDEX_H
+
+#include <QString>
+#include <QVector>
+#include <QDateTime>
+
+// increase if the format of the index file changes
+#define LIBINDEX_VERSION  1
+
+/*!
+ * \class LibIndex
+ * \brief names and positions of the components in all library files
+ *
+ * The search for components looks through the names kept here instead
+ * of reading every library again. The definition of a component is
+ * read from its library file only when it is shown. The index is
+ * saved in "qucslib.idx" in the Qucs home directory, a library is read
+ * again only if its file has changed since.
+ */
+class LibIndex {
+public:
+  struct Comp {
+    QString Name;
+    qint64  Offset;   // of "<Component " in the file
+    qint64  Length;   // up to and including "</Component>"
+  };
+  struct Lib {
+    QString   Path;   // as used by "getLibAbsPath()"
+    QString   File;   // absolute path of the library file
+    QString   Name;
+    QDateTime Modified;
+    qint64    Size;
+    QVector<Comp> Comps;
+  };
+
+  LibIndex();
+
+  void update();
+  const QVector<Lib>& libraries() const { return Libs; }
+  static QString definition(const QString&, qint64, qint64);
+
+private:
+  bool scan(Lib&);
+  void load();
+  void save() const;
+
+  QVector<Lib> Libs;
+  bool Loaded;
+};
+
+#endif
@@ -54,6 +54,8 @@ struct compInfoStruct
   QString libName; // the name of the library where the component is defined
   QString libPath; // the library path (absolute for  user libs, relative for system libs)
   QString compDef; // the component definition string
+  qint64 compOffset; // where to read the definition if not yet read (search results)
+  qint64 compLength;
 };
 
 struct libInfoStruct // a struct is not really needed but useful if we need to add further data...
@@ -399,8 +401,6 @@ void QucsLib::slotSelectLibrary(int Index)
 // ----------------------------------------------------
 void QucsLib::slotSearchComponent(const QString &searchText)
 {
-  QList<QPair<QString, bool> > LibFiles;
-  QString libPath;
   compInfoStruct lineCompInfo;
   QVariant v;
 
@@ -414,72 +414,25 @@ void QucsLib::slotSearchComponent(const QString &searchText)
     // insert "Search results" at the beginning, so that it is visible
     Library->insertItem(-1, tr("Search results"));
     Library->setCurrentIndex(0);
+    CompIndex.update(); // read the libraries changed since the last search
   }
 
   if(searchText.isEmpty()) {
     return;
   }
 
-  bool findComponent = false;
-
-  // user libraries
-  QStringList UserLibFiles = UserLibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
-  foreach(QString s, UserLibFiles) // build list with full path
-    LibFiles.append(qMakePair(UserLibDir.absoluteFilePath(s), false));
-
-  // system libraries
-  QStringList SysLibFiles = SysLibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
-  foreach(QString s, SysLibFiles) // build list with relative path
-    LibFiles.append(qMakePair(s, true));
-
-  QFile File;
-  QTextStream ReadWhole;
-  QString LibraryString, LibName, CompName;
-  int Start, End, NameStart, NameEnd;
-  for(auto it = LibFiles.begin(); it != LibFiles.end(); it++) { // all library files
-    QString libPath = (*it).first;
-    libPath.chop(4); // remove extension
-    File.setFileName(getLibAbsPath(libPath));
-    if(!File.open(QIODevice::ReadOnly))  continue;
-
-    ReadWhole.setDevice(&File);
-    LibraryString = ReadWhole.readAll();
-    File.close();
-
-    Start = LibraryString.indexOf("<Qucs Library ");
-    if(Start < 0)  continue;
-    End = LibraryString.indexOf('>', Start);
-    if(End < 0)  continue;
-    LibName = LibraryString.mid(Start, End-Start).section('"', 1, 1);
-
-    // check all components of the current library
-    while((Start=LibraryString.indexOf("\n<Component ", Start)) > 0) {
-      Start++;
-      NameStart = Start + 11;
-      NameEnd = LibraryString.indexOf('>', NameStart);
-      if(NameEnd < 0)  continue;
-      CompName = LibraryString.mid(NameStart, NameEnd-NameStart);
-
-      End = LibraryString.indexOf("\n</Component>", NameEnd);
-      if(End < 0)  continue;
-      End += 13;
-
+  foreach(const LibIndex::Lib& lib, CompIndex.libraries())
+    foreach(const LibIndex::Comp& c, lib.Comps) {
       // does search criterion match ?
-      if(CompName.indexOf(searchText, 0, Qt::CaseInsensitive) >= 0) {
-        if(!findComponent) {
-	  CompList->clear();
-        }
-        findComponent = true;
-        QListWidgetItem *CompItem = new QListWidgetItem(CompName);
-
-        lineCompInfo = compInfoStruct{LibName, libPath, LibraryString.mid(Start, End-Start)};
-        v.setValue(lineCompInfo);
-        CompItem->setData(Qt::UserRole, v);
-        CompList->addItem(CompItem);
-      }
-      Start = End;
+      if(c.Name.indexOf(searchText, 0, Qt::CaseInsensitive) < 0)  continue;
+
+      QListWidgetItem *CompItem = new QListWidgetItem(c.Name);
+      // the definition is read when the component is shown
+      lineCompInfo = compInfoStruct{lib.Name, lib.Path, QString(), c.Offset, c.Length};
+      v.setValue(lineCompInfo);
+      CompItem->setData(Qt::UserRole, v);
+      CompList->addItem(CompItem);
     }
-  }
 }
 
 
@@ -509,6 +462,18 @@ void QucsLib::slotShowComponent(QListWidgetItem *Item)
     // get component info
     v = Item->data(Qt::UserRole);
     lineCompInfo = v.value<compInfoStruct>();
+    if(lineCompInfo.compDef.isEmpty() && lineCompInfo.compLength > 0)
+    {
+        lineCompInfo.compDef = LibIndex::definition(lineCompInfo.libPath,
+                             lineCompInfo.compOffset, lineCompInfo.compLength);
+        if(lineCompInfo.compDef.isEmpty())
+        {
+            QMessageBox::critical(this, tr("Error"), tr("Library is corrupt."));
+            return;
+        }
+        v.setValue(lineCompInfo);
+        Item->setData(Qt::UserRole, v);
+    }
 
     CompDescr->setText("Name: " + Item->text());
     CompDescr->append("Library: " + lineCompInfo.libName);
@@ -30,6 +30,7 @@
 #include <QComboBox>
 
 #include "symbolwidget.h"
+#include "libindex.h"
 
 
 // Application settings.
@@ -81,6 +82,7 @@ private:
   QTextEdit    *CompDescr;
   QVBoxLayout  *all;
   QLineEdit *CompSearch;
+  LibIndex   CompIndex;   // components of all libraries for the search
 };
 
 #endif /* QUCSLIB_H */
@@ -28,6 +28,9 @@
 #include "../qucs/qucs.h"
 #include "../qucs/misc.h"
 #include "../qucs-filter/material_props.h"
+#include "../qucs/twoport.h"
+
+#include <vector>
 
 
 
@@ -271,6 +274,9 @@ QucsPowerCombiningTool::QucsPowerCombiningTool()
    sz = imgWidget->size();
    imgWidget->setFixedSize(.6*sz);
    imgLayout->addWidget(imgWidget);
+   // Response of the network, calculated as the specifications change
+   PreviewLabel = new QLabel();
+   imgLayout->addWidget(PreviewLabel);
    ImagegroupBox->setLayout(imgLayout);
    imgLayout->setAlignment(imgWidget, Qt::AlignHCenter);
 
@@ -290,6 +296,12 @@ QucsPowerCombiningTool::QucsPowerCombiningTool()
   connect(MicrostripradioButton, SIGNAL(clicked()), SLOT(on_MicrostripradioButton_clicked()));
   connect(LumpedElementsradioButton, SIGNAL(clicked()), SLOT(on_LCRadioButton_clicked()));
   connect(IdealTLradioButton, SIGNAL(clicked()), SLOT(on_IdealTLRadioButton_clicked()));
+  connect(RefImplineEdit, SIGNAL(textChanged(const QString&)), SLOT(UpdatePreview()));
+  connect(FreqlineEdit, SIGNAL(textChanged(const QString&)), SLOT(UpdatePreview()));
+  connect(FreqScaleCombo, SIGNAL(currentIndexChanged(int)), SLOT(UpdatePreview()));
+  connect(K1lineEdit, SIGNAL(textChanged(const QString&)), SLOT(UpdatePreview()));
+  connect(AlphalineEdit, SIGNAL(textChanged(const QString&)), SLOT(UpdatePreview()));
+  UpdatePreview();
 }
 
 //------------------------------------------------
@@ -486,6 +498,7 @@ void QucsPowerCombiningTool::on_TopoCombo_currentIndexChanged(int index)
         BranchesCombo->setEditable(true);//Let the user to specify an arbitrary number of outputs (power of 2)
         BranchesCombo->setEnabled(true);
     }
+    UpdatePreview();
 }
 
 //---------------------------------------------------------------
@@ -758,6 +771,157 @@ int QucsPowerCombiningTool::Wilkinson(double Z0, double Freq, double K, bool SP_
 
 }
 
+//-----------------------------------------------------------------------------------
+// Nodal analysis of the small networks previewed by the tool. The nodes are numbered
+// from 0 and -1 is the ground node.
+typedef std::vector< std::vector<twoport::cplx> > CMatrix;
+
+// Adds an admittance between two nodes
+static void addAdmittance(CMatrix &Y, int n1, int n2, twoport::cplx y)
+{
+    if (n1 >= 0) Y[n1][n1] += y;
+    if (n2 >= 0) Y[n2][n2] += y;
+    if (n1 >= 0 && n2 >= 0)
+    {
+        Y[n1][n2] -= y;
+        Y[n2][n1] -= y;
+    }
+}
+
+// Adds a two-port given by its chain matrix between two nodes and ground
+static void addTwoPort(CMatrix &Y, int n1, int n2, const twoport::abcd &m)
+{
+    twoport::yparam y = twoport::atoy(m);
+    Y[n1][n1] += y.y11;
+    Y[n1][n2] += y.y12;
+    Y[n2][n1] += y.y21;
+    Y[n2][n2] += y.y22;
+}
+
+// S-parameters between the port nodes, all of them referred to Z0. Every port is
+// driven in turn by an incident wave of 1V through Z0, so S[j][k] = V[j] - delta(j,k)
+static CMatrix nodalSparameters(CMatrix Y, const std::vector<int> &ports, double Z0)
+{
+    int N = Y.size(), P = ports.size();
+    for (int k = 0; k < P; k++) Y[ports[k]][ports[k]] += 1./Z0;
+
+    // Right hand sides: Norton equivalent current of each port
+    CMatrix X(N, std::vector<twoport::cplx>(P, 0.));
+    for (int k = 0; k < P; k++) X[ports[k]][k] = 2./Z0;
+
+    // Gaussian elimination with partial pivoting
+    for (int c = 0; c < N; c++)
+    {
+        int piv = c;
+        for (int r = c+1; r < N; r++)
+            if (std::abs(Y[r][c]) > std::abs(Y[piv][c])) piv = r;
+        std::swap(Y[c], Y[piv]);
+        std::swap(X[c], X[piv]);
+        for (int r = 0; r < N; r++)
+        {
+            if (r == c || Y[r][c] == 0.) continue;
+            twoport::cplx f = Y[r][c]/Y[c][c];
+            for (int i = c; i < N; i++) Y[r][i] -= f*Y[c][i];
+            for (int k = 0; k < P; k++) X[r][k] -= f*X[c][k];
+        }
+    }
+
+    CMatrix S(P, std::vector<twoport::cplx>(P, 0.));
+    for (int j = 0; j < P; j++)
+        for (int k = 0; k < P; k++)
+            S[j][k] = X[ports[j]][k]/Y[ports[j]][ports[j]] - ((j == k) ? 1. : 0.);
+    return S;
+}
+
+// Chain matrix of a line of impedance Z, a quarter wavelength long at w0, or of its
+// CLC equivalent. The attenuation of the line is given in Np
+static twoport::abcd quarterWave(double Z, double w, double w0, double att, bool LumpedElements)
+{
+    if (LumpedElements)
+    {
+        twoport::abcd m = twoport::cascade(twoport::shunt(twoport::cplx(0, w/(Z*w0))),
+                                           twoport::series(twoport::cplx(0, w*Z/w0)));
+        return twoport::cascade(m, twoport::shunt(twoport::cplx(0, w/(Z*w0))));
+    }
+    return twoport::line(Z, twoport::cplx(att, 0.5*pi*w/w0));
+}
+
+//-----------------------------------------------------
+// This function calculates the response of the 2Way Wilkinson divider around the
+// design frequency and returns it as a table. The microstrip lines are taken as
+// ideal lines of the same electrical length
+QString QucsPowerCombiningTool::WilkinsonResponse(double Z0, double Freq, double K, bool microcheck, double Alpha, bool LumpedElements)
+{
+    QString wilkstr = CalculateWilkinson(Z0, K);
+    double Z2 = wilkstr.section(';', 0, 0).toDouble();
+    double Z3 = wilkstr.section(';', 1, 1).toDouble();
+    double R =  wilkstr.section(';', 2, 2).toDouble();
+    double R2 =  wilkstr.section(';', 3, 3).toDouble();
+    double R3 =  wilkstr.section(';', 4, 4).toDouble();
+    double lambda4 = SPEED_OF_LIGHT/(4*Freq);
+    double alpha = (microcheck) ? 0 : Alpha/(20.*log10(exp(1.)));//Np/m
+    double w0 = 2*pi*Freq;
+
+    // Nodes: input port, junction, isolation resistor terminals and output ports
+    int N = 0;
+    int P1 = N++;
+    int J = (LumpedElements) ? P1 : N++;//The CLC equivalent has no Z0 line at the input
+    int A = N++, B = N++;
+    int P2 = (K != 1) ? N++ : A;
+    int P3 = (K != 1) ? N++ : B;
+
+    QString table = "<table><tr><th>f</th><th>S11</th><th>S21</th><th>S31</th><th>S23</th></tr>";
+    for (int i = 0; i < 5; i++)
+    {
+        double f = Freq*(0.5 + 0.25*i);
+        double w = 2*pi*f;
+        CMatrix Y(N, std::vector<twoport::cplx>(N, 0.));
+
+        if (J != P1) addTwoPort(Y, P1, J, quarterWave(Z0, w, w0, alpha*lambda4, LumpedElements));
+        addTwoPort(Y, J, A, quarterWave(Z2, w, w0, alpha*lambda4, LumpedElements));
+        addTwoPort(Y, J, B, quarterWave(Z3, w, w0, alpha*lambda4, LumpedElements));
+        addAdmittance(Y, A, B, 1./R);
+        if (K != 1)
+        {
+            addTwoPort(Y, A, P2, quarterWave(sqrt(Z0*R2), w, w0, alpha*lambda4, LumpedElements));
+            addTwoPort(Y, B, P3, quarterWave(sqrt(Z0*R3), w, w0, alpha*lambda4, LumpedElements));
+        }
+
+        std::vector<int> ports;
+        ports.push_back(P1);
+        ports.push_back(P2);
+        ports.push_back(P3);
+        CMatrix S = nodalSparameters(Y, ports, Z0);
+
+        table += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td></tr>")
+                 .arg(QString::number(f/getScaleFreq(), 'g', 4) + " " + FreqScaleCombo->currentText())
+                 .arg(qMax(twoport::dB(S[0][0]), -99.), 0, 'f', 1)
+                 .arg(qMax(twoport::dB(S[1][0]), -99.), 0, 'f', 2)
+                 .arg(qMax(twoport::dB(S[2][0]), -99.), 0, 'f', 2)
+                 .arg(qMax(twoport::dB(S[1][2]), -99.), 0, 'f', 1);
+    }
+    table += "</table>";
+    return table;
+}
+
+//-----------------------------------------------------
+// Updates the response shown below the picture of the network
+void QucsPowerCombiningTool::UpdatePreview()
+{
+    double Z0 = RefImplineEdit->text().toDouble();
+    double K = pow(10, K1lineEdit->text().toDouble()/20.);
+    double Freq = FreqlineEdit->text().toDouble()*getScaleFreq();
+    double alpha = AlphalineEdit->text().toDouble();
+
+    if ((TopoCombo->currentIndex() != 0) || (Z0 <= 0) || (Freq <= 0))
+    {
+        PreviewLabel->setText(tr("No preview available"));
+        return;
+    }
+    PreviewLabel->setText(WilkinsonResponse(Z0, Freq, K, MicrostripradioButton->isChecked(),
+                                            alpha, LumpedElementsradioButton->isChecked()));
+}
+
 //-----------------------------------------------------------------------------------
 // This function calculates a multistage lambda/4 matching using the Chebyshev weigthing.
 // See Microwave Engineering. David Pozar. John Wiley and Sons. 4th Edition. Pg 256-261
@@ -1922,6 +2086,7 @@ void QucsPowerCombiningTool::on_MicrostripradioButton_clicked()
       AlphaLabel->setVisible(true);
       AlphalineEdit->setVisible(true);
       AlphadBLabel->setVisible(true);
+      UpdatePreview();
 }
 
 void QucsPowerCombiningTool::on_IdealTLRadioButton_clicked()
@@ -1931,6 +2096,7 @@ void QucsPowerCombiningTool::on_IdealTLRadioButton_clicked()
       AlphaLabel->setVisible(false);
       AlphalineEdit->setVisible(false);
       AlphadBLabel->setVisible(false);
+      UpdatePreview();
 }
 
 void QucsPowerCombiningTool::on_LCRadioButton_clicked()
@@ -1941,7 +2107,7 @@ void QucsPowerCombiningTool::on_LCRadioButton_clicked()
       //Hide the length unit combo
       UnitsCombo->setVisible(false);
       UnitsLabel->setVisible(false);
-     
+      UpdatePreview();
 }
 
 //Rounds a double number using the minimum number of decimal places
@@ -82,6 +82,7 @@ public:
      QStatusBar *statusBar;
      QGridLayout *gboxImage;
      QSvgWidget *imgWidget;
+     QLabel *PreviewLabel;
 
 private slots:
      void on_TopoCombo_currentIndexChanged(int index);
@@ -89,6 +90,7 @@ private slots:
      void on_MicrostripradioButton_clicked();
      void on_LCRadioButton_clicked();
      void on_IdealTLRadioButton_clicked();
+     void UpdatePreview();
 
 private:
     double getScaleFreq();
@@ -98,6 +100,7 @@ private:
     QString num2str(double);
     void UpdateImage();
     QString CalculateWilkinson(double Z0, double K);
+    QString WilkinsonResponse(double Z0, double Freq, double K, bool microcheck, double Alpha, bool LumpedElements);
     int Wilkinson(double Z0, double Freq, double K, bool SP_block, bool microcheck, tSubstrate Substrate, double Alpha, bool LumpedElements);
     int MultistageWilkinson(double Z0, double Freq, int NStages, bool SP_block, bool microcheck, tSubstrate Substrate, double Alpha, bool LumpedElements);
     int Tee(double Z0, double Freq, double K, bool SP_block, bool microcheck, tSubstrate Substrate, double Alpha);
@@ -20,6 +20,7 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <QApplication>
 #include <QString>
@@ -33,6 +34,7 @@
 #include <QSettings>
 
 #include "qucstrans.h"
+#include "transbatch.h"
 
 tQucsSettings QucsSettings;
 
@@ -97,6 +99,10 @@ bool saveApplSettings(QucsTranscalc *qucs)
 
 int main(int argc, char *argv[])
 {
+  // calculate the lines of a file without the GUI
+  if (argc > 1 && !strcmp (argv[1], "-b"))
+    return transBatch (argc - 1, argv + 1);
+
   QApplication a(argc, argv);
 
   // apply default settings
@@ -276,6 +276,41 @@ struct TransUnit TransUnits[] = {
   { "Angle",      TRANS_ANGLES },
 };
 
+// Names of the extraneous results of the transmission line types.
+const char * TransResultNames[MAX_TRANS_TYPES][MAX_TRANS_RESULTS] = {
+  { QT_TRANSLATE_NOOP("QucsTranscalc", "ErEff"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Conductor Losses"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Dielectric Losses"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Skin Depth") },
+  { QT_TRANSLATE_NOOP("QucsTranscalc", "ErEff"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Conductor Losses"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Dielectric Losses"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Skin Depth") },
+  { QT_TRANSLATE_NOOP("QucsTranscalc", "ErEff"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Conductor Losses"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Dielectric Losses"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Skin Depth") },
+  { QT_TRANSLATE_NOOP("QucsTranscalc", "ErEff"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Conductor Losses"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Dielectric Losses"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "TE-Modes"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "TM-Modes") },
+  { QT_TRANSLATE_NOOP("QucsTranscalc", "Conductor Losses"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Dielectric Losses"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "TE-Modes"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "TM-Modes") },
+  { QT_TRANSLATE_NOOP("QucsTranscalc", "ErEff Even"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "ErEff Odd"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Conductor Losses Even"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Conductor Losses Odd"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Dielectric Losses Even"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Dielectric Losses Odd"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Skin Depth") },
+  { QT_TRANSLATE_NOOP("QucsTranscalc", "Conductor Losses"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Dielectric Losses"),
+    QT_TRANSLATE_NOOP("QucsTranscalc", "Skin Depth") },
+};
+
 /* Constructor setups the GUI. */
 QucsTranscalc::QucsTranscalc() {
   QWidget *centralWidget = new QWidget(this);  
@@ -477,50 +512,9 @@ QucsTranscalc::~QucsTranscalc()
    structures. */
 void QucsTranscalc::setupTranslations () {
   // calculated results
-  int i = 0;//Microstrip
-  TransLineTypes[i].result[0].name = new QString(tr("ErEff"));
-  TransLineTypes[i].result[1].name = new QString(tr("Conductor Losses"));
-  TransLineTypes[i].result[2].name = new QString(tr("Dielectric Losses"));
-  TransLineTypes[i].result[3].name = new QString(tr("Skin Depth"));
-
-  i++;//CPW
-  TransLineTypes[i].result[0].name = new QString(tr("ErEff"));
-  TransLineTypes[i].result[1].name = new QString(tr("Conductor Losses"));
-  TransLineTypes[i].result[2].name = new QString(tr("Dielectric Losses"));
-  TransLineTypes[i].result[3].name = new QString(tr("Skin Depth"));
-
-  i++;//GCPW
-  TransLineTypes[i].result[0].name = new QString(tr("ErEff"));
-  TransLineTypes[i].result[1].name = new QString(tr("Conductor Losses"));
-  TransLineTypes[i].result[2].name = new QString(tr("Dielectric Losses"));
-  TransLineTypes[i].result[3].name = new QString(tr("Skin Depth"));
-
-  i++;//Rectangular waveguide
-  TransLineTypes[i].result[0].name = new QString(tr("ErEff"));
-  TransLineTypes[i].result[1].name = new QString(tr("Conductor Losses"));
-  TransLineTypes[i].result[2].name = new QString(tr("Dielectric Losses"));
-  TransLineTypes[i].result[3].name = new QString(tr("TE-Modes"));
-  TransLineTypes[i].result[4].name = new QString(tr("TM-Modes"));
-
-  i++;//Coaxial line
-  TransLineTypes[i].result[0].name = new QString(tr("Conductor Losses"));
-  TransLineTypes[i].result[1].name = new QString(tr("Dielectric Losses"));
-  TransLineTypes[i].result[2].name = new QString(tr("TE-Modes"));
-  TransLineTypes[i].result[3].name = new QString(tr("TM-Modes"));
-
-  i++;//Coupled microstripx
-  TransLineTypes[i].result[0].name = new QString(tr("ErEff Even"));
-  TransLineTypes[i].result[1].name = new QString(tr("ErEff Odd"));
-  TransLineTypes[i].result[2].name = new QString(tr("Conductor Losses Even"));
-  TransLineTypes[i].result[3].name = new QString(tr("Conductor Losses Odd"));
-  TransLineTypes[i].result[4].name = new QString(tr("Dielectric Losses Even"));
-  TransLineTypes[i].result[5].name = new QString(tr("Dielectric Losses Odd"));
-  TransLineTypes[i].result[6].name = new QString(tr("Skin Depth"));
-
-  i++;//Stripline
-  TransLineTypes[i].result[0].name = new QString(tr("Conductor Losses"));
-  TransLineTypes[i].result[1].name = new QString(tr("Dielectric Losses"));
-  TransLineTypes[i].result[2].name = new QString(tr("Skin Depth"));
+  for (int i = 0; i < MAX_TRANS_TYPES; i++)
+    for (int j = 0; j < MAX_TRANS_RESULTS && TransResultNames[i][j]; j++)
+      TransLineTypes[i].result[j].name = new QString(tr(TransResultNames[i][j]));
 
   // extra tool tips
   struct TransType * t = TransLineTypes;
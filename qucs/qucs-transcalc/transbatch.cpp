@@ -0,0 +1,341 @@
+/***************************************************************************
+                              transbatch.cpp
+                             ----------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Usage:  qucstrans -b <type> [-s] [-w <property>] [-j <threads>]
+                     [-o <output.csv>] <input.csv>
+
+   The first line of the input names the given properties, each one
+   optionally followed by its unit in brackets, e.g. "W[mm]".  Every
+   further line describes one transmission line, the properties not
+   given keep their default values.  The lines are analyzed, or
+   synthesized with "-s", and written with all their properties and
+   results.  They are distributed among several threads, each one with
+   its own transmission line instance. */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include "qucstrans.h"
+#include "transbatch.h"
+#include "transline.h"
+#include "microstrip.h"
+#include "coplanar.h"
+#include "coax.h"
+#include "rectwaveguide.h"
+#include "c_microstrip.h"
+#include "stripline.h"
+
+extern struct TransType TransLineTypes[];
+extern const char * TransResultNames[MAX_TRANS_TYPES][MAX_TRANS_RESULTS];
+
+// Rows calculated by one thread.
+struct TransBatchJob {
+  int mode;
+  bool synthesize;
+  std::vector<transvalues> * rows;
+  std::vector<int> * status;
+  int from, to;
+};
+
+// Creates a transmission line instance of the given type.
+static transline * createLine (int mode)
+{
+  switch (mode) {
+  case ModeMicrostrip:        return new microstrip ();
+  case ModeCoplanar:          return new coplanar ();
+  case ModeGroundedCoplanar:  return new groundedCoplanar ();
+  case ModeRectangular:       return new rectwaveguide ();
+  case ModeCoaxial:           return new coax ();
+  case ModeCoupledMicrostrip: return new c_microstrip ();
+  case ModeStripline:         return new stripline ();
+  }
+  return NULL;
+}
+
+// Calculates the rows of a job, used by QtConcurrent.
+static void calcRows (const TransBatchJob & job)
+{
+  transline * line = createLine (job.mode);
+  for (int i = job.from; i < job.to; i++) {
+    line->setValues (& (*job.rows)[i]);
+    if (job.synthesize)
+      (*job.status)[i] = line->synthesize ();
+    else
+      line->analyze ();
+  }
+  delete line;
+}
+
+// Returns the property of the transmission line type with the given name.
+static struct TransValue * findProperty (int idx, const QString & name)
+{
+  for (int box = 0; box < MAX_TRANS_BOXES; box++) {
+    struct TransValue * val = TransLineTypes[idx].array[box].item;
+    for (; val->name; val++)
+      if (name == val->name) return val;
+  }
+  return NULL;
+}
+
+// Quotes a CSV cell if necessary.
+static QString csvCell (const QString & s)
+{
+  if (!s.contains (',') && !s.contains ('"')) return s;
+  QString q = s;
+  q.replace ("\"", "\"\"");
+  return "\"" + q + "\"";
+}
+
+// Splits a CSV line into its cells.
+static QStringList csvSplit (const QString & line)
+{
+  QStringList cells;
+  QString cell;
+  bool quoted = false;
+  for (int i = 0; i < line.length (); i++) {
+    QChar c = line.at (i);
+    if (quoted) {
+      if (c == '"') {
+        if (i+1 < line.length () && line.at (i+1) == '"') {
+          cell += c;
+          i++;
+        }
+        else quoted = false;
+      }
+      else cell += c;
+    }
+    else if (c == '"') quoted = true;
+    else if (c == ',') {
+      cells.append (cell.trimmed ());
+      cell.clear ();
+    }
+    else cell += c;
+  }
+  cells.append (cell.trimmed ());
+  return cells;
+}
+
+static int usage ()
+{
+  fprintf (stderr,
+    "Usage: qucstrans -b <type> [-s] [-w <property>] [-j <threads>]\n"
+    "                 [-o <output.csv>] <input.csv>\n\n"
+    "  -s             synthesize instead of analyze\n"
+    "  -w <property>  physical property to be synthesized\n"
+    "  -j <threads>   number of threads\n"
+    "  -o <file>      output file (default: standard output)\n\n"
+    "Types:");
+  for (int i = 0; TransLineTypes[i].type != ModeNone; i++)
+    fprintf (stderr, " %s", TransLineTypes[i].description);
+  fprintf (stderr, "\n");
+  return 1;
+}
+
+int transBatch (int argc, char * argv[])
+{
+  if (argc < 3) return usage ();
+
+  // find the transmission line type
+  int idx;
+  for (idx = 0; TransLineTypes[idx].type != ModeNone; idx++)
+    if (!strcasecmp (argv[1], TransLineTypes[idx].description)) break;
+  if (TransLineTypes[idx].type == ModeNone) {
+    fprintf (stderr, "unknown transmission line type `%s'\n", argv[1]);
+    return usage ();
+  }
+
+  bool synthesize = false;
+  int threads = QThread::idealThreadCount ();
+  QString selected, input, output;
+  for (int i = 2; i < argc; i++) {
+    if (!strcmp (argv[i], "-s")) synthesize = true;
+    else if (!strcmp (argv[i], "-w") && i+1 < argc) selected = argv[++i];
+    else if (!strcmp (argv[i], "-j") && i+1 < argc) threads = atoi (argv[++i]);
+    else if (!strcmp (argv[i], "-o") && i+1 < argc) output = argv[++i];
+    else if (argv[i][0] == '-' && argv[i][1]) return usage ();
+    else input = argv[i];
+  }
+  if (input.isEmpty ()) return usage ();
+  if (threads < 1) threads = 1;
+
+  // the physical property selected by default
+  if (selected.isEmpty ()) {
+    for (int i = 0; i < 4; i++)
+      if (TransLineTypes[idx].radio[i] == 1)
+        selected = TransLineTypes[idx].array[TRANS_PHYSICAL].item[i].name;
+  }
+
+  QFile in;
+  if (input == "-") in.open (stdin, QIODevice::ReadOnly);
+  else {
+    in.setFileName (input);
+    if (!in.open (QIODevice::ReadOnly)) {
+      fprintf (stderr, "cannot open file `%s'\n", qPrintable (input));
+      return 1;
+    }
+  }
+  QTextStream stream (&in);
+
+  // the default values of all properties
+  transvalues defaults;
+  defaults.selected = selected.toStdString ();
+  for (int box = 0; box < MAX_TRANS_BOXES; box++) {
+    struct TransValue * val = TransLineTypes[idx].array[box].item;
+    for (; val->name; val++) {
+      defaults.value[val->name] = val->value;
+      defaults.unit[val->name] = val->units[0];
+    }
+  }
+
+  // header line with the properties and their units
+  QStringList header;
+  int n = 0;
+  while (!stream.atEnd () && header.isEmpty ()) {
+    QString line = stream.readLine ().trimmed ();
+    n++;
+    if (!line.isEmpty ()) header = csvSplit (line);
+  }
+  QStringList names;
+  for (int c = 0; c < header.size (); c++) {
+    QString name = header.at (c), unit;
+    int b = name.indexOf ('[');
+    if (b >= 0) {
+      unit = name.mid (b+1).remove (']').trimmed ();
+      name = name.left (b).trimmed ();
+    }
+    struct TransValue * val = findProperty (idx, name);
+    if (!val) {
+      fprintf (stderr, "unknown property `%s'\n", qPrintable (name));
+      return 1;
+    }
+    if (!unit.isEmpty ()) {
+      bool found = false;
+      for (int i = 0; val->units[i]; i++)
+        if (unit == val->units[i]) {
+          defaults.unit[val->name] = val->units[i];
+          found = true;
+        }
+      if (!found) {
+        fprintf (stderr, "unknown unit `%s' of property `%s'\n",
+                 qPrintable (unit), val->name);
+        return 1;
+      }
+    }
+    names.append (val->name);
+  }
+
+  // the transmission lines to be calculated
+  std::vector<transvalues> rows;
+  while (!stream.atEnd ()) {
+    QString line = stream.readLine ().trimmed ();
+    n++;
+    if (line.isEmpty ()) continue;
+    QStringList cells = csvSplit (line);
+    transvalues row = defaults;
+    for (int c = 0; c < names.size () && c < cells.size (); c++) {
+      if (cells.at (c).isEmpty ()) continue;
+      bool ok;
+      double value = cells.at (c).toDouble (&ok);
+      if (!ok) {
+        fprintf (stderr, "line %d: invalid value `%s'\n", n,
+                 qPrintable (cells.at (c)));
+        return 1;
+      }
+      row.value[names.at (c).toStdString ()] = value;
+    }
+    rows.push_back (row);
+  }
+  in.close ();
+
+  // calculate them in blocks, one per thread
+  std::vector<int> status (rows.size (), 0);
+  int count = rows.size ();
+  int jobs = qMin (threads, qMax (count, 1));
+  QList<TransBatchJob> list;
+  for (int j = 0; j < jobs; j++) {
+    TransBatchJob job = { TransLineTypes[idx].type, synthesize, &rows,
+                          &status, j * count / jobs, (j+1) * count / jobs };
+    list.append (job);
+  }
+  if (jobs > 1) {
+    QThreadPool::globalInstance ()->setMaxThreadCount (jobs);
+    QtConcurrent::blockingMap (list, calcRows);
+  }
+  else if (!list.isEmpty ()) calcRows (list.first ());
+
+  QFile out;
+  if (output.isEmpty ()) out.open (stdout, QIODevice::WriteOnly);
+  else {
+    out.setFileName (output);
+    if (!out.open (QIODevice::WriteOnly)) {
+      fprintf (stderr, "cannot create file `%s'\n", qPrintable (output));
+      return 1;
+    }
+  }
+  QTextStream ostream (&out);
+
+  // all properties with their units followed by the results
+  QStringList props;
+  QStringList cells;
+  for (int box = 0; box < MAX_TRANS_BOXES; box++) {
+    struct TransValue * val = TransLineTypes[idx].array[box].item;
+    for (; val->name; val++) {
+      props.append (val->name);
+      QString unit = defaults.unit[val->name].c_str ();
+      if (unit == "NA") cells.append (val->name);
+      else cells.append (QString (val->name) + "[" + unit + "]");
+    }
+  }
+  int results = 0;
+  while (results < MAX_TRANS_RESULTS && TransResultNames[idx][results])
+    cells.append (TransResultNames[idx][results++]);
+  ostream << cells.join (",") << "\n";
+
+  int failed = 0;
+  for (int i = 0; i < count; i++) {
+    if (status[i]) {
+      fprintf (stderr, "row %d: failed to converge\n", i+1);
+      failed++;
+    }
+    cells.clear ();
+    foreach (const QString & p, props)
+      cells.append (QString::number (rows[i].value[p.toStdString ()], 'g', 12));
+    for (int r = 0; r < results; r++) {
+      QString s;
+      if (r < (int) rows[i].result.size ())
+        s = QString (rows[i].result[r].c_str ()).trimmed ();
+      cells.append (csvCell (s));
+    }
+    ostream << cells.join (",") << "\n";
+  }
+  ostream.flush ();
+  out.close ();
+  return failed ? 1 : 0;
+}
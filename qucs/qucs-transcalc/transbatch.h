@@ -0,0 +1,25 @@
+/***************************************************************************
+                               transbatch.h
+                              --------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef TRANSBATCH_H
+#define TRANSBATCH_H
+
+/* Calculates the transmission lines given by the rows of a CSV file
+   without the GUI, the arguments are the ones following "-b" on the
+   command line.  Returns the exit code of the program. */
+int transBatch (int argc, char * argv[]);
+
+#endif /* TRANSBATCH_H */
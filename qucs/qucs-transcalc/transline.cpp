@@ -58,6 +58,7 @@ static double conv_ang[2][2] = {
 /* Constructor creates a transmission line instance. */
 transline::transline () {
   app = 0;
+  values = 0;
   mur = 1.0;
 }
 
@@ -70,9 +71,18 @@ void transline::setApplication (QucsTranscalc * a) {
   app = a;
 }
 
+/* Sets the property values used instead of the application. */
+void transline::setValues (transvalues * v) {
+  values = v;
+}
+
 /* Sets a named property to the given value, access through the
    application. */
 void transline::setProperty (const char * prop, double value) {
+  if (values) {
+    values->value[prop] = value;
+    return;
+  }
   app->setProperty (prop, value);
 }
 
@@ -97,21 +107,33 @@ void transline::setProperty (const char * prop, double value, int type,
 void transline::setResult (int line, double value, const char * unit) {
   char text[256];
   sprintf (text, "%g %s", value, unit);
-  app->setResult (line, text);
+  setResult (line, text);
 }
 
 /* Puts the text into the given result line. */
 void transline::setResult (int line, const char * text) {
+  if (values) {
+    if ((int) values->result.size () <= line)
+      values->result.resize (line + 1);
+    values->result[line] = text;
+    return;
+  }
   app->setResult (line, text);
 }
 
 /* Returns a named property value. */
 double transline::getProperty (const char * prop) {
+  if (values) {
+    std::map<std::string, double>::iterator it = values->value.find (prop);
+    return it != values->value.end () ? it->second : 0;
+  }
   return app->getProperty (prop);
 }
 
 /* Returns a named property selection. */
 bool transline::isSelected (const char * prop) {
+  if (values)
+    return values->selected == prop;
   return app->isSelected (prop);
 }
 
@@ -149,6 +171,10 @@ double transline::convertProperty (const char * prop, double value, int type,
 
 /* Returns the unit of the given property. */
 char * transline::getUnit (const char * prop) {
+  if (values) {
+    std::map<std::string, std::string>::iterator it = values->unit.find (prop);
+    return (char *) (it != values->unit.end () ? it->second.c_str () : "NA");
+  }
   return app->getUnit (prop);
 }
 
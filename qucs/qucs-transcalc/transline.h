@@ -23,8 +23,21 @@
 #ifndef __TRANSLINE_H
 #define __TRANSLINE_H
 
+#include <map>
+#include <string>
+#include <vector>
+
 class QucsTranscalc;
 
+/* The property values and units of a transmission line computed
+   without the application (see transbatch.cpp), and the results. */
+struct transvalues {
+  std::map<std::string, double> value;
+  std::map<std::string, std::string> unit;
+  std::string selected;		/* physical property to be synthesized */
+  std::vector<std::string> result;
+};
+
 
 class transline {
  public:
@@ -32,6 +45,7 @@ class transline {
   virtual ~transline ();
 
   void   setApplication (QucsTranscalc *);
+  void   setValues (transvalues *);
   void   setProperty (const char *, double);
   void   setProperty (const char *, double, int, int);
   double getProperty (const char *);
@@ -55,6 +69,7 @@ class transline {
 
  private:
   QucsTranscalc * app;
+  transvalues * values;
 };
 
 #endif /* __TRANSLINE_H */
@@ -55,6 +55,24 @@ AC_Sim::AC_Sim()
   Props.append(new Property("Noise", "no", false,
 			QObject::tr("calculate noise voltages")+
 			" [yes, no]"));
+  Props.append(new Property("Threads", "1", false,
+			QObject::tr("number of worker threads (0 = one per processor)")));
+  Props.append(new Property("Reduce", "no", false,
+			QObject::tr("replace large linear subcircuits by reduced models")+" [no, yes]"));
+  Props.append(new Property("FastSweep", "no", false,
+			QObject::tr("evaluate long sweeps of linear circuits by a reduced model")+" [no, yes]"));
+  Props.append(new Property("FastTol", "1e-6", false,
+			QObject::tr("relative residual accepted by the fast sweep")));
+  Props.append(new Property("Sensitivity", "", false,
+			QObject::tr("nodes and voltage sources to compute parameter sensitivities of")));
+  Props.append(new Property("Save", "", false,
+			QObject::tr("outputs to save, e.g. \"out,X1.*,**.Vt\" (empty = all)")));
+  Props.append(new Property("Adaptive", "no", false,
+			QObject::tr("refine the sweep where the results are not resolved")+" [no, yes]"));
+  Props.append(new Property("AdaptTol", "1e-3", false,
+			QObject::tr("relative tolerance of the adaptive sweep")));
+  Props.append(new Property("AdaptPoints", "10000", false,
+			QObject::tr("largest number of points of the adaptive sweep")));
 }
 
 AC_Sim::~AC_Sim()
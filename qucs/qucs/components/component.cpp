@@ -28,8 +28,12 @@
 
 #include <QPen>
 #include <QString>
+#include <QStringList>
 #include <QMessageBox>
 #include <QPainter>
+#include <QPainterPath>
+#include <QHash>
+#include <QVector>
 #include <QDebug>
 
 /*!
@@ -182,6 +186,150 @@ bool Component::getSelected(int x_, int y_)
   return false;
 }
 
+// -------------------------------------------------------
+// The lines, arcs, rectangles and ellipses of a symbol as painter paths,
+// one per pen (and brush) in the order they are painted. They are shared
+// by all components with the same geometry, e.g. all resistors rotated
+// the same way.
+struct SymbolPart {
+  QPen   Pen;
+  QBrush Brush;
+  QPainterPath Path;
+};
+
+struct SymbolShape {
+  QVector<int> Key;   // geometry the paths have been built from
+  QList<SymbolPart> Parts;
+};
+
+// at most that many different symbols are kept
+#define SYMBOL_SHAPES_MAX  4096
+
+static QHash<uint, QList<SymbolShape*> > SymbolShapes;
+static int SymbolShapesCount = 0;
+
+static void symbolKeyPen(QVector<int>& key, const QPen& pen)
+{
+  key << int(pen.color().rgba()) << int(pen.style()) << pen.width()
+      << int(pen.capStyle()) << int(pen.joinStyle());
+}
+
+static void symbolKeyBrush(QVector<int>& key, const QBrush& brush)
+{
+  key << int(brush.color().rgba()) << int(brush.style());
+}
+
+// Returns the painter paths for the geometry of the given component,
+// building them if no component with the same geometry has been painted.
+static SymbolShape* symbolShape(Component *c)
+{
+  QVector<int> key;
+  foreach(Line *pl, c->Lines) {
+    key << 1 << pl->x1 << pl->y1 << pl->x2 << pl->y2;
+    symbolKeyPen(key, pl->style);
+  }
+  foreach(struct Arc *pa, c->Arcs) {
+    key << 2 << pa->x << pa->y << pa->w << pa->h << pa->angle << pa->arclen;
+    symbolKeyPen(key, pa->style);
+  }
+  foreach(Area *pa, c->Rects) {
+    key << 3 << pa->x << pa->y << pa->w << pa->h;
+    symbolKeyPen(key, pa->Pen);
+    symbolKeyBrush(key, pa->Brush);
+  }
+  foreach(Area *pa, c->Ellips) {
+    key << 4 << pa->x << pa->y << pa->w << pa->h;
+    symbolKeyPen(key, pa->Pen);
+    symbolKeyBrush(key, pa->Brush);
+  }
+
+  uint h = 2166136261u;   // FNV-1a
+  foreach(int k, key)
+    h = (h ^ uint(k)) * 16777619u;
+
+  QHash<uint, QList<SymbolShape*> >::const_iterator it =
+    SymbolShapes.constFind(h);
+  if(it != SymbolShapes.constEnd())
+    foreach(SymbolShape *s, it.value())
+      if(s->Key == key)  return s;
+
+  if(SymbolShapesCount >= SYMBOL_SHAPES_MAX) {   // start over
+    foreach(const QList<SymbolShape*>& list, SymbolShapes)
+      qDeleteAll(list);
+    SymbolShapes.clear();
+    SymbolShapesCount = 0;
+  }
+
+  // Strokes with the same pen go into one path. Filled shapes get a path
+  // of their own, as overlapping subpaths of different directions would
+  // leave holes.
+  SymbolShape *s = new SymbolShape;
+  s->Key = key;
+  foreach(Line *pl, c->Lines) {
+    if(s->Parts.isEmpty() || s->Parts.last().Pen != pl->style ||
+       s->Parts.last().Brush.style() != Qt::NoBrush) {
+      SymbolPart sp;
+      sp.Pen = pl->style;
+      s->Parts.append(sp);
+    }
+    s->Parts.last().Path.moveTo(pl->x1, pl->y1);
+    s->Parts.last().Path.lineTo(pl->x2, pl->y2);
+  }
+  foreach(struct Arc *pa, c->Arcs) {
+    if(s->Parts.isEmpty() || s->Parts.last().Pen != pa->style ||
+       s->Parts.last().Brush.style() != Qt::NoBrush) {
+      SymbolPart sp;
+      sp.Pen = pa->style;
+      s->Parts.append(sp);
+    }
+    QRectF r(pa->x, pa->y, pa->w, pa->h);
+    s->Parts.last().Path.arcMoveTo(r, qreal(pa->angle) / 16.0);
+    s->Parts.last().Path.arcTo(r, qreal(pa->angle) / 16.0,
+                               qreal(pa->arclen) / 16.0);
+  }
+  for(int i = 0; i < 2; i++)
+    foreach(Area *pa, i ? c->Ellips : c->Rects) {
+      if(s->Parts.isEmpty() || s->Parts.last().Pen != pa->Pen ||
+         s->Parts.last().Brush.style() != Qt::NoBrush ||
+         pa->Brush.style() != Qt::NoBrush) {
+        SymbolPart sp;
+        sp.Pen = pa->Pen;
+        sp.Brush = pa->Brush;
+        s->Parts.append(sp);
+      }
+      QRectF r(pa->x, pa->y, pa->w, pa->h);
+      if(i)  s->Parts.last().Path.addEllipse(r);
+      else   s->Parts.last().Path.addRect(r);
+    }
+
+  // pen widths stay in device pixels as the paths are scaled
+  for(int i = 0; i < s->Parts.size(); i++)
+    s->Parts[i].Pen.setCosmetic(true);
+
+  SymbolShapes[h].append(s);
+  SymbolShapesCount++;
+  return s;
+}
+
+// -------------------------------------------------------
+// Paints the lines, arcs, rectangles and ellipses of the symbol.
+void Component::paintSymbol(ViewPainter *p)
+{
+  SymbolShape *s = symbolShape(this);
+
+  p->Painter->save();
+  p->Painter->setWorldMatrixEnabled(true);
+  p->Painter->setWorldMatrix(QMatrix(p->Scale, 0, 0, p->Scale,
+                                     p->DX + float(cx) * p->Scale,
+                                     p->DY + float(cy) * p->Scale));
+  foreach(const SymbolPart& sp, s->Parts) {
+    p->Painter->setPen(sp.Pen);
+    p->Painter->setBrush(sp.Brush);
+    p->Painter->drawPath(sp.Path);
+  }
+  p->Painter->restore();
+}
+
 // -------------------------------------------------------
 void Component::paint(ViewPainter *p)
 {
@@ -220,31 +368,8 @@ void Component::paint(ViewPainter *p)
   }
   else {    // normal components go here
 
-    // paint all lines
-    foreach(Line *p1, Lines) {
-      p->Painter->setPen(p1->style);
-      p->drawLine(cx+p1->x1, cy+p1->y1, cx+p1->x2, cy+p1->y2);
-    }
-
-    // paint all arcs
-    foreach(Arc *p3, Arcs) {
-      p->Painter->setPen(p3->style);
-      p->drawArc(cx+p3->x, cy+p3->y, p3->w, p3->h, p3->angle, p3->arclen);
-    }
-
-    // paint all rectangles
-    foreach(Area *pa, Rects) {
-      p->Painter->setPen(pa->Pen);
-      p->Painter->setBrush(pa->Brush);
-      p->drawRect(cx+pa->x, cy+pa->y, pa->w, pa->h);
-    }
-
-    // paint all ellipses
-    foreach(Area *pa, Ellips) {
-      p->Painter->setPen(pa->Pen);
-      p->Painter->setBrush(pa->Brush);
-      p->drawEllipse(cx+pa->x, cy+pa->y, pa->w, pa->h);
-    }
+    // paint all lines, arcs, rectangles and ellipses
+    paintSymbol(p);
     p->Painter->setBrush(Qt::NoBrush);
 
     newFont.setWeight(QFont::Light);
@@ -798,11 +923,16 @@ Component* Schematic::loadComponent(const QString& _s, Component* c) const
   }
   s = s.mid(1, s.length()-2);   // cut off start and end character
 
-  QString label=s.section(' ',1,1);
+  // split the line only once instead of searching each field from its
+  // start; the fields up to the rotation never contain quotes
+  QStringList Fields = s.left(s.indexOf('"')).split(' ');
+  QStringList Quoted = s.split('"');
+
+  QString label=Fields.value(1);
   c->setName(label);
 
   QString n;
-  n  = s.section(' ',2,2);      // isActive
+  n  = Fields.value(2);      // isActive
   tmp = n.toInt(&ok);
   if(!ok){
     return NULL;
@@ -815,31 +945,31 @@ Component* Schematic::loadComponent(const QString& _s, Component* c) const
     // use default, e.g. never show name for GND (bug?)
   }
 
-  n  = s.section(' ',3,3);    // cx
+  n  = Fields.value(3);    // cx
   c->cx = n.toInt(&ok);
   if(!ok) return NULL;
 
-  n  = s.section(' ',4,4);    // cy
+  n  = Fields.value(4);    // cy
   c->cy = n.toInt(&ok);
   if(!ok) return NULL;
 
-  n  = s.section(' ',5,5);    // tx
+  n  = Fields.value(5);    // tx
   ttx = n.toInt(&ok);
   if(!ok) return NULL;
 
-  n  = s.section(' ',6,6);    // ty
+  n  = Fields.value(6);    // ty
   tty = n.toInt(&ok);
   if(!ok) return NULL;
 
   if(c->obsolete_model_hack().at(0) != '.') {  // is simulation component (dc, ac, ...) ?
 
-    n  = s.section(' ',7,7);    // mirroredX
+    n  = Fields.value(7);    // mirroredX
     if(n.toInt(&ok) == 1){
       c->mirrorX();
     }
     if(!ok) return NULL;
 
-    n  = s.section(' ',8,8);    // rotated
+    n  = Fields.value(8);    // rotated
     tmp = n.toInt(&ok);
     if(!ok) return NULL;
     if(c->rotated > tmp)  // neccessary because of historical flaw in ...
@@ -878,7 +1008,7 @@ Component* Schematic::loadComponent(const QString& _s, Component* c) const
   Property *p1;
   for(p1 = c->Props.first(); p1 != 0; p1 = c->Props.next()) {
     z++;
-    n = s.section('"',z,z);    // property value
+    n = Quoted.value(z);    // property value
     z++;
     //qDebug() << "LOAD: " << p1->Description;
 
@@ -955,7 +1085,7 @@ Component* Schematic::loadComponent(const QString& _s, Component* c) const
       }
     p1->Value = n;
 
-    n  = s.section('"',z,z);    // display
+    n  = Quoted.value(z);    // display
     p1->display = (n.at(1) == '1');
   }
 
@@ -1298,6 +1428,52 @@ void Component::copyComponent(Component *pc)
   Texts  = pc->Texts;
 }
 
+// ---------------------------------------------------------------------
+// Creates an unconnected copy of this component with its current
+// properties and symbol, without parsing a component line and without
+// creating the symbol again.
+Component* Component::clone()
+{
+  Component *c = newOne();
+
+  c->Props.clear();
+  for(Property *p = Props.first(); p != 0; p = Props.next())
+    c->Props.append(new Property(*p));
+
+  qDeleteAll(c->Lines);   c->Lines.clear();
+  qDeleteAll(c->Arcs);    c->Arcs.clear();
+  qDeleteAll(c->Rects);   c->Rects.clear();
+  qDeleteAll(c->Ellips);  c->Ellips.clear();
+  qDeleteAll(c->Ports);   c->Ports.clear();
+  qDeleteAll(c->Texts);   c->Texts.clear();
+  foreach(Line *p, Lines)  c->Lines.append(new Line(*p));
+  foreach(struct Arc *p, Arcs)  c->Arcs.append(new struct Arc(*p));
+  foreach(Area *p, Rects)  c->Rects.append(new Area(*p));
+  foreach(Area *p, Ellips)  c->Ellips.append(new Area(*p));
+  foreach(Port *p, Ports) {
+    Port *pp = new Port(*p);
+    pp->Connection = 0;
+    c->Ports.append(pp);
+  }
+  foreach(Text *p, Texts)  c->Texts.append(new Text(*p));
+
+  c->Type = Type;
+  c->cx = cx;  c->cy = cy;
+  c->x1 = x1;  c->y1 = y1;
+  c->x2 = x2;  c->y2 = y2;
+  c->tx = tx;  c->ty = ty;
+  c->Model = Model;
+  c->Name  = Name;
+  c->Description = Description;
+  c->showName  = showName;
+  c->isActive  = isActive;
+  c->rotated   = rotated;
+  c->mirroredX = mirroredX;
+  c->isSelected = false;
+  c->containingSchematic = containingSchematic;
+  return c;
+}
+
 
 // ***********************************************************************
 // ********                                                       ********
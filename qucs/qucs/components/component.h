@@ -34,11 +34,13 @@ public:
   virtual ~Component() {};
 
   virtual Component* newOne();
+  virtual Component* clone();   // zero if it has to be loaded from text
   virtual void recreate(Schematic*) {};
   QString getNetlist();
   QString get_VHDL_Code(int);
   QString get_Verilog_Code(int);
   void    paint(ViewPainter*);
+  void    paintSymbol(ViewPainter*);
   void    paintScheme(Schematic*);
   void    print(ViewPainter*, float);
   void    setCenter(int, int, bool relative=false);
@@ -126,6 +128,8 @@ protected:
   void copyComponent(Component*);
   Property * getProperty(const QString&);
   Schematic* containingSchematic;
+
+  friend class SymbolCache;
 };
 
 
@@ -64,7 +64,21 @@ DC_Sim::DC_Sim()
 	" [none, gMinStepping, SteepestDescent, LineSearch, Attenuation, SourceStepping]"));
   Props.append(new Property("Solver", "CroutLU", false,
 	QObject::tr("method for solving the circuit matrix")+
-	" [CroutLU, DoolittleLU, HouseholderQR, HouseholderLQ, GolubSVD]"));
+	" [CroutLU, DoolittleLU, HouseholderQR, HouseholderLQ, GolubSVD, SparseLU, BiCGStab, GMRES]"));
+  Props.append(new Property("Bypass", "no", false,
+	QObject::tr("bypass unchanged non-linear device evaluations")+
+	" [no, yes]"));
+  Props.append(new Property("Newton", "full", false,
+	QObject::tr("Newton variant of the non-linear iterations")+
+	" [full, chord, Broyden]"));
+  Props.append(new Property("Threads", "1", false,
+	QObject::tr("number of worker threads (0 = one per processor)")));
+  Props.append(new Property("Reduce", "no", false,
+	QObject::tr("replace large linear subcircuits by reduced models")+" [no, yes]"));
+  Props.append(new Property("Sensitivity", "", false,
+	QObject::tr("nodes and voltage sources to compute parameter sensitivities of")));
+  Props.append(new Property("Save", "", false,
+	QObject::tr("outputs to save, e.g. \"out,X1.*,**.Vt\" (empty = all)")));
 }
 
 DC_Sim::~DC_Sim()
@@ -50,6 +50,20 @@ HB_Sim::HB_Sim()
 		QObject::tr("relative tolerance for convergence")));
   Props.append(new Property("MaxIter", "150", false,
 		QObject::tr("maximum number of iterations until error")));
+  Props.append(new Property("Threads", "1", false,
+		QObject::tr("number of worker threads (0 = one per processor)")));
+  Props.append(new Property("Solver", "LU", false,
+		QObject::tr("method for solving the Newton steps")+
+		" [LU, GMRES, MixedLU]"));
+  Props.append(new Property("Truncation", "box", false,
+		QObject::tr("mixing products kept for several tones")+
+		" [box, diamond, user]"));
+  Props.append(new Property("MaxOrder", "0", false,
+		QObject::tr("maximum order of the diamond (0 = number of harmonics)")));
+  Props.append(new Property("JacobianSteps", "1", false,
+		QObject::tr("number of Newton steps using the same Jacobian")));
+  Props.append(new Property("MemoryLimit", "0", false,
+		QObject::tr("memory in MB above which GMRES replaces the direct solver (0 = no limit)")));
 }
 
 HB_Sim::~HB_Sim()
@@ -19,6 +19,7 @@
 #include "qucs.h"
 #include "schematic.h"
 #include "misc.h"
+#include "symbolcache.h"
 
 #include <limits.h>
 
@@ -170,31 +171,50 @@ int LibComp::loadSection(const QString& Name, QString& Section,
 
 // ---------------------------------------------------------------------
 // Loads the symbol for the subcircuit from the schematic file and
-// returns the number of painting elements.
+// returns the number of painting elements. Symbols already read for
+// another instance are reused as long as the library is not modified.
 int LibComp::loadSymbol()
 {
-  int z, Result;
-  QString FileString, Line;
-  z = loadSection("Symbol", FileString);
-  if(z < 0) {
-    if(z != -7)  return z;
+  QDir Directory(QucsSettings.LibDir);
+  QString LibFile = Directory.absoluteFilePath(Props.first()->Value + ".lib");
+  QString CompName = Props.next()->Value;
+
+  int z;
+  if(SymbolCache::restore(this, LibFile, CompName, 2, z))
+    return z;
+
+  QStringList IDs;
+  QString Line;
+  z = readSymbol(IDs);
+  if(z != -7) {
+    SymbolCache::store(this, LibFile, CompName, z, IDs);
+    return z;
+  }
 
-    // If library component not defined as subcircuit, then load
-    // new component and transfer data to this component.
-    z = loadSection("Model", Line);
-    if(z < 0)  return z;
+  // If library component not defined as subcircuit, then load
+  // new component and transfer data to this component.
+  z = loadSection("Model", Line);
+  if(z < 0)  return z;
 
-    Component *pc = getComponentFromName(Line);
-    if(pc == 0)  return -20;
+  Component *pc = getComponentFromName(Line);
+  if(pc == 0)  return -20;
 
-    copyComponent(pc);
+  copyComponent(pc);
 
-    pc->Props.setAutoDelete(false);
-    delete pc;
+  pc->Props.setAutoDelete(false);
+  delete pc;
 
-    return 1;
-  }
+  return 1;
+}
 
+// ---------------------------------------------------------------------
+// Reads the symbol from the library file and collects its ".ID" lines.
+int LibComp::readSymbol(QStringList& IDs)
+{
+  int z, Result;
+  QString FileString, Line;
+  z = loadSection("Symbol", FileString);
+  if(z < 0)  return z;
 
   z  = 0;
   x1 = y1 = INT_MAX;
@@ -208,6 +228,7 @@ int LibComp::loadSymbol()
     if(Line.at(0) != '<') return -11;
     if(Line.at(Line.length()-1) != '>') return -12;
     Line = Line.mid(1, Line.length()-2); // cut off start and end character
+    if(Line.startsWith(".ID "))  IDs.append(Line);
     Result = analyseLine(Line, 2);
     if(Result < 0) return -13;   // line format error
     z += Result;
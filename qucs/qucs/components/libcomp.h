@@ -41,6 +41,7 @@ protected:
 
 private:
   int  loadSymbol();
+  int  readSymbol(QStringList&);
   int  loadSection(const QString&, QString&, QStringList* i=0);
   QString createType();
 };
@@ -14,10 +14,9 @@
  *   (at your option) any later version.                                   *
  *                                                                         *
  ***************************************************************************/
-#include <QDir>
 #include <QFile>
+#include <QHash>
 #include <QTextStream>
-#include <QRegExp>
 #include <QString>
 #include <QStringList>
 
@@ -62,239 +61,85 @@ Element* Optimize_Sim::info(QString& Name, char* &BitmapFile, bool getNewOne)
 }
 
 // -------------------------------------------------------
+// The optimization is run by the simulator itself. The properties
+// become an ".Opt" action, its variables and goals become "OptVar"
+// and "OptGoal" definitions referring to it.
 QString Optimize_Sim::netlist()
 {
-  QString s = "#\n";
-  if (createASCOFiles()) {
-    s += "# ASCO configuration file(s) created\n";
-  } else {
-    s += "# Failed to create ASCO configuration file(s)\n";
-  }
-  s += "#\n\n";
-  return s;
-}
+  static const char *keys[] = { "MaxIter", "NP", "F", "CR", "Seed",
+                                "MinCostVar", "CostObj", "CostCon", 0 };
+  static const int fields[] = { 1, 3, 4, 5, 6, 7, 8, 9 };
 
- 
-// -----------------------------------------------------------
-bool Optimize_Sim::createASCOFiles()
-{
-  Property* pp;
-  QFile afile(QucsSettings.QucsHomeDir.filePath("asco_netlist.cfg"));
-  if(afile.open(QIODevice::WriteOnly)) {
-    QTextStream stream(&afile);
-    stream << "*\n";
-    stream << "* ASCO configuration file for '" << Name << "'\n";
-    stream << "*\n\n";
-
-    stream << "#Optimization Flow#\n";
-    stream << "Alter:no\n";
-    stream << "MonteCarlo:no\n";
-    stream << "AlterMC cost:0.00\n";
-    stream << "ExecuteRF:no\n";
-    stream << "#\n\n";
-
-    stream << "#DE#\n";
-    pp = Props.at(1);
-    QString val;
-    val = pp->Value.section('|',0,0);
-    stream << "choice of method:" << val << "\n";
-    val = pp->Value.section('|',1,1);
-    stream << "maximum no. of iterations:" << val << "\n";
-    val = pp->Value.section('|',2,2);
-    stream << "Output refresh cycle:" << val << "\n";
-    val = pp->Value.section('|',3,3);
-    stream << "No. of parents NP:" << val << "\n";
-    val= pp->Value.section('|',4,4);
-    stream << "Constant F:" << val << "\n";
-    val = pp->Value.section('|',5,5);
-    stream << "Crossing Over factor CR:" << val << "\n";
-    val = pp->Value.section('|',6,6);
-    stream << "Seed for pseudo random number generator:" << val << "\n";
-    val = pp->Value.section('|',7,7);
-    stream << "Minimum Cost Variance:" << val << "\n";
-    val = pp->Value.section('|',8,8);
-    stream << "Cost objectives:" << val << "\n";
-    val = pp->Value.section('|',9,9);
-    stream << "Cost constraints:" << val << "\n";
-    stream << "#\n\n";
-
-    stream << "# Parameters #\n";
-    int i=1;
-    for(pp = Props.at(2); pp != 0; pp = Props.next(), i++) {
-      if(pp->Name == "Var") {
-	stream << "Parameter " << i << ":";
-	val = pp->Value.section('|',0,0);
-	stream << "#" << val << "#" << ":";
-	val = pp->Value.section('|',2,2);
-	stream << val << ":";
-	val = pp->Value.section('|',3,3);
-	stream << val << ":";
-	val = pp->Value.section('|',4,4);
-	stream << val << ":";
-	val = pp->Value.section('|',5,5);
-	stream << val << ":";
-	val = pp->Value.section('|',1,1);
-	stream << ((val == "yes") ? "OPT" : "---") << "\n";
-      }
-    }
-    stream << "#\n\n";
-
-    stream << "# Measurements #\n";
-    for(pp = Props.at(2); pp != 0; pp = Props.next(), i++) {
-      if(pp->Name == "Goal") {
-	val = pp->Value.section('|',1,1);
-	QString Type, Value;
-	Value = pp->Value.section('|',2,2);
-	if (val == "MIN" || val == "MAX" || val == "MON") {
-	  Value = "---";
-	}
-	Type = val;
-	val = pp->Value.section('|',0,0);
-	stream << val <<  ":"
-	       << "---" << ":"
-	       << Type << ":" << Value << "\n";
-      }
-    }
-    stream << "#\n\n";
-
-    stream << "# Post Processing #\n";
-    stream << "#\n\n";
-
-    afile.close();
-  } else return false;
-
-  QDir ExtractDir(QucsSettings.QucsHomeDir);
-  if(!ExtractDir.cd("extract")) {
-    if(!ExtractDir.mkdir("extract"))
-      return false;
-    if(!ExtractDir.cd("extract"))
-      return false;
-  }      
+  Property *pp = Props.at(1);
+  QString s = Model+":"+Name+" Sim=\""+Props.at(0)->Value+"\"";
+  for(int i=0; keys[i]; i++)
+    s += QString(" ") + keys[i] + "=\"" +
+         pp->Value.section('|',fields[i],fields[i]) + "\"";
+  s += '\n';
 
   for(pp = Props.at(2); pp != 0; pp = Props.next()) {
-    if(pp->Name == "Goal") {
-      QString VarName = pp->Value.section('|',0,0);
-      QFile efile(ExtractDir.filePath(VarName));
-      if(efile.open(QIODevice::WriteOnly)) {
-    QTextStream stream(&efile);
-	stream << "# Info #\n";
-	stream << "#\n\n";
-	stream << "# Commands #\n";
-	stream << "#\n\n";
-	stream << "# Post Processing #\n";
-	stream << "MEASURE_VAR:#SYMBOL#:SEARCH_FOR:'<indep " << VarName
-	       << " ':S_COL:01:P_LINE:01:P_COL:01:31" << "\n";
-	stream << "#\n\n";
-	efile.close();
-      }
-      else return false;
+    if(pp->Name == "Var") {
+      QString Var  = pp->Value.section('|',0,0);
+      QString Init = pp->Value.section('|',2,2);
+      QString Min  = pp->Value.section('|',3,3);
+      QString Max  = pp->Value.section('|',4,4);
+      QString Type = pp->Value.section('|',5,5);
+      if(pp->Value.section('|',1,1) != "yes")
+        Min = Max = Init;   // inactive variables keep their value
+      s += "OptVar:" + Name + "_" + Var + " Opt=\"" + Name +
+           "\" Var=\"" + Var + "\" Init=\"" + Init + "\" Min=\"" + Min +
+           "\" Max=\"" + Max + "\" Scale=\"" +
+           (Type.startsWith("LOG") ? "log" : "lin") + "\" Integer=\"" +
+           (Type.endsWith("INT") ? "yes" : "no") + "\"\n";
+    }
+    else if(pp->Name == "Goal") {
+      QString Var = pp->Value.section('|',0,0);
+      s += "OptGoal:" + Name + "_" + Var + " Opt=\"" + Name +
+           "\" Var=\"" + Var + "\" Type=\"" +
+           pp->Value.section('|',1,1).toLower() + "\" Value=\"" +
+           pp->Value.section('|',2,2) + "\"\n";
     }
   }
-  return true;
+  return s;
 }
 
 // -----------------------------------------------------------
 /*!
- * \brief Optimize_Sim::createASCOnetlist create ASCO netlist out or input
- *  input netlist.
- * \return true if asco_netlist.txt created, false otherwise
+ * \brief Optimize_Sim::loadResults take over the optimized values
+ *  of the variables as their initial values.
+ * \param DataSet is the name of the data set with the results, where
+ *  each variable is a dependency holding its optimum
+ * \return true if a value has changed, false otherwise
  */
-bool Optimize_Sim::createASCOnetlist()
+bool Optimize_Sim::loadResults(const QString& DataSet)
 {
-  Property* pp;
-  QStringList vars;
-  for(pp = Props.at(2); pp != 0; pp = Props.next()) {
-    if(pp->Name == "Var") {
-      vars += pp->Value.section('|',0,0);
-    }
-  }
-
-  QFile infile(QucsSettings.QucsHomeDir.filePath("netlist.txt"));
-  QFile outfile(QucsSettings.QucsHomeDir.filePath("asco_netlist.txt"));
+  QFile infile(DataSet);
   if(!infile.open(QIODevice::ReadOnly)) return false;
-  if(!outfile.open(QIODevice::WriteOnly)) return false;
   QTextStream instream(&infile);
-  QTextStream outstream(&outfile);
+  QHash<QString, QString> values;
   QString Line;
   while(!instream.atEnd()) {
-    Line = instream.readLine();
-    for(QStringList::Iterator it = vars.begin(); it != vars.end(); ++it ) {
-      if(Line.contains("Eqn:"))
-      {
-          QStringList splitLine = Line.split("\"");
-
-          for(int i=1;i<splitLine.size()-3;i+=2)
-          {
-              if(splitLine[i].compare("yes")!=0 && splitLine[i].compare("no")!=0) //ignore last piece between quotes
-              {
-                  splitLine[i].replace(*it, "#"+*it+"#");
-              }
-          }
-          Line = splitLine.join("\"");
-
-      }
-      else
-      {
-          QRegExp reg = QRegExp("=\"(" + *it + ")\"");
-          Line.replace(reg, "=\"#\\1#\"");
-      }
-
-    }
-    outstream << Line << "\n";
+    Line = instream.readLine().trimmed();
+    if(!Line.startsWith("<indep ") || !Line.endsWith(" 1>"))  continue;
+    QString Var = Line.section(' ',1,1);
+    if(instream.atEnd()) break;
+    values.insert(Var, instream.readLine().trimmed());
   }
-  outfile.close();
   infile.close();
-  return true;
-}
 
-// -----------------------------------------------------------
-bool Optimize_Sim::loadASCOout()
-{
   bool changed = false;
   Property* pp;
-  QStringList vars;
   for(pp = Props.at(2); pp != 0; pp = Props.next()) {
-    if(pp->Name == "Var") {
-      vars += pp->Value.section('|',0,0);
-    }
-  }
-
-  QFile infile(QucsSettings.QucsHomeDir.filePath("asco_out.log"));
-  if(!infile.open(QIODevice::ReadOnly)) return false;
-  QTextStream instream(&infile);
-  QString Line;
-  // we need just the last line with the final result
-  while(!instream.atEnd()) Line = instream.readLine();
-  infile.close();
-
-  QStringList entries = Line.split(':');
-  QStringList::Iterator it;
-  for(it = entries.begin(); it != entries.end(); ++it ) {
-    QString Name = *it;
-    Name = Name.trimmed();
-    if(vars.contains(Name)) {
-      for(pp = Props.at(2); pp != 0; pp = Props.next()) {
-	if(pp->Name == "Var") {
-	  QString val[6];
-	  val[0] = pp->Value.section('|',0,0); // variable name
-	  if(val[0]==Name) {
-	    val[1] = pp->Value.section('|',1,1);
-	    val[2] = pp->Value.section('|',2,2);
-	    val[3] = pp->Value.section('|',3,3);
-	    val[4] = pp->Value.section('|',4,4);
-	    val[5] = pp->Value.section('|',5,5);
-	    ++it; // field after variable name is its value
-	    QString Value = *it;
-	    Value = Value.trimmed();
-	    val[2] = Value;
-	    pp->Value = val[0] + "|" + val[1] + "|" + val[2] + "|" +
-	      val[3] + "|" + val[4] + "|" + val[5];
-	    changed = true;
-	    break;
-	  }
-	}
-      }
-    }
+    if(pp->Name != "Var")  continue;
+    QString Var = pp->Value.section('|',0,0);
+    if(!values.contains(Var) || pp->Value.section('|',1,1) != "yes")
+      continue;
+    QStringList val = pp->Value.split('|');
+    while(val.size() < 6)  val.append("");
+    if(val[2] == values.value(Var))  continue;
+    val[2] = values.value(Var);
+    pp->Value = val.join("|");
+    changed = true;
   }
   return changed;
 }
@@ -51,6 +51,11 @@ Param_Sweep::Param_Sweep()
 		QObject::tr("stop value for sweep")));
   Props.append(new Property("Points", "20", true,
 		QObject::tr("number of simulation steps")));
+  Props.append(new Property("Processes", "1", false,
+		QObject::tr("number of worker processes (0 = one per processor)")));
+  Props.append(new Property("Arclength", "no", false,
+		QObject::tr("trace a DC sweep by arclength continuation")+
+		" [yes, no]"));
 }
 
 Param_Sweep::~Param_Sweep()
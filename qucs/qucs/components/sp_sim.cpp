@@ -64,6 +64,14 @@ SP_Sim::SP_Sim()
   Props.append(new Property("saveAll", "no", false,
 	QObject::tr("save subcircuit characteristic values into dataset")+
 	" [yes, no]"));
+  Props.append(new Property("Reduction", "greedy", false,
+	QObject::tr("order of the network reduction")+
+	" [greedy, dissection]"));
+  Props.append(new Property("Method", "auto", false,
+	QObject::tr("network reduction or nodal analysis")+
+	" [auto, reduction, MNA]"));
+  Props.append(new Property("Threads", "1", false,
+	QObject::tr("number of worker threads (0 = one per processor)")));
 }
 
 SP_Sim::~SP_Sim()
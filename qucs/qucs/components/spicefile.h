@@ -34,6 +34,7 @@ public:
   SpiceFile();
  ~SpiceFile() {};
   Component* newOne();
+  Component* clone() { return 0; }  // keeps the state of its netlist
   static Element* info(QString&, char* &, bool getNewOne=false);
 
   bool withSim;
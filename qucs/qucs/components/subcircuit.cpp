@@ -19,6 +19,7 @@
 #include "qucs.h"
 #include "schematic.h"
 #include "misc.h"
+#include "symbolcache.h"
 
 #include <QTextStream>
 #include <QFileInfo>
@@ -133,8 +134,23 @@ void Subcircuit::remakeSymbol(int No)
 
 // ---------------------------------------------------------------------
 // Loads the symbol for the subcircuit from the schematic file and
-// returns the number of painting elements.
+// returns the number of painting elements. The file is read only once
+// for all instances unless it has been modified.
 int Subcircuit::loadSymbol(const QString& DocName)
+{
+  int z;
+  if(SymbolCache::restore(this, DocName, QString(), 1, z))
+    return z;
+
+  QStringList IDs;
+  z = readSymbol(DocName, IDs);
+  SymbolCache::store(this, DocName, QString(), z, IDs);
+  return z;
+}
+
+// ---------------------------------------------------------------------
+// Reads the symbol from the schematic file and collects its ".ID" lines.
+int Subcircuit::readSymbol(const QString& DocName, QStringList& IDs)
 {
   QFile file(DocName);
   if(!file.open(QIODevice::ReadOnly))
@@ -189,6 +205,7 @@ int Subcircuit::loadSymbol(const QString& DocName)
     if(Line.at(0) != '<') return -5;
     if(Line.at(Line.length()-1) != '>') return -6;
     Line = Line.mid(1, Line.length()-2); // cut off start and end character
+    if(Line.startsWith(".ID "))  IDs.append(Line);
     Result = analyseLine(Line, 1);
     if(Result < 0) return -7;   // line format error
     z += Result;
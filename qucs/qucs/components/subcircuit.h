@@ -37,6 +37,7 @@ protected:
   void createSymbol();
   void remakeSymbol(int No);
   int  loadSymbol(const QString&);
+  int  readSymbol(const QString&, QStringList&);
 };
 
 #endif
@@ -0,0 +1,119 @@
+/***************************************************************************
+                               symbolcache.cpp
+                              -----------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "symbolcache.h"
+#include "component.h"
+
+#include <QFileInfo>
+
+QHash<QString, SymbolCache::Symbol *> SymbolCache::Symbols;
+
+SymbolCache::Symbol::~Symbol()
+{
+  qDeleteAll(Lines);
+  qDeleteAll(Arcs);
+  qDeleteAll(Rects);
+  qDeleteAll(Ellips);
+  qDeleteAll(Ports);
+  qDeleteAll(Texts);
+}
+
+// ---------------------------------------------------------------------
+// Symbols are kept per file, independent of the way it is referred to.
+QString SymbolCache::key(const QString& File, const QString& Name)
+{
+  QString Path = QFileInfo(File).canonicalFilePath();
+  if(Path.isEmpty())  return Path;
+  return Path + '\n' + Name;
+}
+
+// ---------------------------------------------------------------------
+bool SymbolCache::restore(Component *c, const QString& File,
+                          const QString& Name, int numProps, int& Result)
+{
+  QString Key = key(File, Name);
+  if(Key.isEmpty())  return false;
+
+  Symbol *s = Symbols.value(Key);
+  if(!s)  return false;
+  QFileInfo Info(File);
+  if(s->Modified != Info.lastModified() || s->Size != Info.size()) {
+    Symbols.remove(Key);   // file has been changed
+    delete s;
+    return false;
+  }
+
+  // each instance rotates and mirrors its own copy of the painting
+  foreach(Line *p, s->Lines)  c->Lines.append(new Line(*p));
+  foreach(struct Arc *p, s->Arcs)  c->Arcs.append(new struct Arc(*p));
+  foreach(Area *p, s->Rects)  c->Rects.append(new Area(*p));
+  foreach(Area *p, s->Ellips)  c->Ellips.append(new Area(*p));
+  foreach(Port *p, s->Ports)  c->Ports.append(new Port(*p));
+  foreach(Text *p, s->Texts)  c->Texts.append(new Text(*p));
+  c->x1 = s->x1;  c->y1 = s->y1;
+  c->x2 = s->x2;  c->y2 = s->y2;
+  c->tx = s->tx;  c->ty = s->ty;
+
+  foreach(const QString& Row, s->IDs)
+    c->analyseLine(Row, numProps);
+
+  Result = s->Result;
+  return true;
+}
+
+// ---------------------------------------------------------------------
+void SymbolCache::store(Component *c, const QString& File,
+                        const QString& Name, int Result,
+                        const QStringList& IDs)
+{
+  QString Key = key(File, Name);
+  if(Key.isEmpty())  return;
+
+  QFileInfo Info(File);
+  Symbol *s = new Symbol;
+  s->Modified = Info.lastModified();
+  s->Size = Info.size();
+  s->Result = Result;
+  foreach(Line *p, c->Lines)  s->Lines.append(new Line(*p));
+  foreach(struct Arc *p, c->Arcs)  s->Arcs.append(new struct Arc(*p));
+  foreach(Area *p, c->Rects)  s->Rects.append(new Area(*p));
+  foreach(Area *p, c->Ellips)  s->Ellips.append(new Area(*p));
+  foreach(Port *p, c->Ports)  s->Ports.append(new Port(*p));
+  foreach(Text *p, c->Texts)  s->Texts.append(new Text(*p));
+  s->x1 = c->x1;  s->y1 = c->y1;
+  s->x2 = c->x2;  s->y2 = c->y2;
+  s->tx = c->tx;  s->ty = c->ty;
+  s->IDs = IDs;
+
+  delete Symbols.take(Key);
+  Symbols.insert(Key, s);
+}
+
+// ---------------------------------------------------------------------
+void SymbolCache::forget(const QString& File)
+{
+  QString Prefix = key(File, QString());
+  if(Prefix.isEmpty())  return;
+
+  QMutableHashIterator<QString, Symbol *> it(Symbols);
+  while(it.hasNext()) {
+    it.next();
+    if(it.key().startsWith(Prefix)) {
+      delete it.value();
+      it.remove();
+    }
+  }
+}
@@ -0,0 +1,69 @@
+/***************************************************************************
+                               symbolcache.h
+                              ---------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SYMBOLCACHE_H
+#define SYMBOLCACHE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+
+class Component;
+struct Line;
+struct Arc;
+struct Area;
+struct Port;
+struct Text;
+
+// Keeps the symbols read from schematic and library files, so that all
+// instances of a subcircuit or library component get their symbol
+// without reading the file again as long as it is not modified.
+class SymbolCache {
+public:
+  // Gives the component the symbol "Name" cached for "File" together
+  // with the result of loading it. Returns false if there is none or
+  // the file has changed since.
+  static bool restore(Component*, const QString& File, const QString& Name,
+                      int numProps, int& Result);
+  // Remembers the symbol just loaded into the component. The ".ID"
+  // lines are applied again to each instance as they set its
+  // properties.
+  static void store(Component*, const QString& File, const QString& Name,
+                    int Result, const QStringList& IDs);
+  // Drops the symbols of the given file, e.g. as it is being saved.
+  static void forget(const QString& File);
+
+private:
+  struct Symbol {
+    QDateTime Modified;
+    qint64 Size;
+    int Result;
+    QList<Line *> Lines;
+    QList<struct Arc *> Arcs;
+    QList<Area *> Rects;
+    QList<Area *> Ellips;
+    QList<Port *> Ports;
+    QList<Text *> Texts;
+    int x1, y1, x2, y2, tx, ty;
+    QStringList IDs;
+    ~Symbol();
+  };
+  static QString key(const QString& File, const QString& Name);
+  static QHash<QString, Symbol *> Symbols;
+};
+
+#endif
@@ -74,13 +74,31 @@ TR_Sim::TR_Sim()
 	QObject::tr("overestimation of local truncation error")));
   Props.append(new Property("Solver", "CroutLU", false,
 	QObject::tr("method for solving the circuit matrix")+
-	" [CroutLU, DoolittleLU, HouseholderQR, HouseholderLQ, GolubSVD]"));
+	" [CroutLU, DoolittleLU, HouseholderQR, HouseholderLQ, GolubSVD, SparseLU, BiCGStab, GMRES]"));
   Props.append(new Property("relaxTSR", "no", false,
 	QObject::tr("relax time step raster")+" [no, yes]"));
   Props.append(new Property("initialDC", "yes", false,
 	QObject::tr("perform an initial DC analysis")+" [yes, no]"));
   Props.append(new Property("MaxStep", "0", false,
 	QObject::tr("maximum step size in seconds")));
+  Props.append(new Property("Bypass", "no", false,
+	QObject::tr("bypass unchanged non-linear device evaluations")+
+	" [no, yes]"));
+  Props.append(new Property("Newton", "full", false,
+	QObject::tr("Newton variant of the non-linear iterations")+
+	" [full, chord, Broyden]"));
+  Props.append(new Property("Threads", "1", false,
+	QObject::tr("number of worker threads (0 = one per processor)")));
+  Props.append(new Property("MixedSignal", "no", false,
+	QObject::tr("run logic gates event-driven")+" [no, yes]"));
+  Props.append(new Property("Multirate", "no", false,
+	QObject::tr("solve decoupled subcircuits with their own time steps")+" [no, yes]"));
+  Props.append(new Property("Reduce", "no", false,
+	QObject::tr("replace large linear subcircuits by reduced models")+" [no, yes]"));
+  Props.append(new Property("Save", "", false,
+	QObject::tr("outputs to save, e.g. \"out,X1.*,**.Vt\" (empty = all)")));
+  Props.append(new Property("Interpolate", "no", false,
+	QObject::tr("interpolate the results instead of stepping onto each time point")+" [no, yes]"));
 }
 
 TR_Sim::~TR_Sim()
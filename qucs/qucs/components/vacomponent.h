@@ -37,6 +37,7 @@ class vacomponent : public Component
     vacomponent(QString filename);
     ~vacomponent() { };
     virtual Component* newOne(QString filename);
+    Component* clone() { return 0; }  // newOne() needs the file name
     static Element* info(QString&, QString &,
                          bool getNewOne=false, QString filename="");
   protected:
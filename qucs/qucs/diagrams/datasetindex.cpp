@@ -0,0 +1,475 @@
+/***************************************************************************
+                             datasetindex.cpp
+                            ------------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+
+#include "datasetindex.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtAlgorithms>
+#include <QStringList>
+#include <QVector>
+#include <QtConcurrentRun>
+
+namespace {
+
+// maximum number of dataset files kept in memory
+const int CacheSize = 8;
+
+struct CacheEntry {
+  QDateTime modified;
+  qint64    size;
+  QFuture<QSharedPointer<const DataSetIndex> > index;
+};
+
+QMutex CacheMutex;
+QHash<QString, CacheEntry> Cache;
+QStringList CacheOrder;  // least recently used first
+
+// The binary dataset format of qucsator, see qucs-core/src/dataset.cpp:
+// a header (magic string, version, reserved word, position of the
+// index or zero while being written) followed by declaration ('V'),
+// data ('D'), packed data ('P') and index ('I') records in native byte
+// order.
+const char BinMagic[] = "QucsData";
+const int  BinHeader = 24;
+const quint32 BinDecl = 'V', BinData = 'D', BinPacked = 'P', BinIndex = 'I';
+const int BinComplex = 1, BinPack = 2;  // flags of data records
+
+// Bounds checked reading of the file contents.
+struct BinCursor {
+  const QByteArray& Data;
+  qint64 Pos;
+  bool   Fail;
+  BinCursor(const QByteArray& d, qint64 p) : Data(d), Pos(p), Fail(false) {}
+  bool left(qint64 n) {
+    if(Fail || Pos < 0 || Data.size() - Pos < n)  Fail = true;
+    return !Fail;
+  }
+  quint32 u32() {
+    quint32 n = 0;
+    if(left(4)) { memcpy(&n, Data.constData()+Pos, 4);  Pos += 4; }
+    return n;
+  }
+  quint64 u64() {
+    quint64 n = 0;
+    if(left(8)) { memcpy(&n, Data.constData()+Pos, 8);  Pos += 8; }
+    return n;
+  }
+  QByteArray str() {
+    quint32 n = u32();
+    if(!left(n))  return QByteArray();
+    Pos += n;
+    return Data.mid(Pos-n, n);
+  }
+};
+
+struct BinChunk {
+  qint64 Pos;
+  int    Count;
+  int    Flags;
+};
+
+struct BinVector {
+  QByteArray Name;
+  QList<QByteArray> Deps;
+  bool  Indep;
+  QList<BinChunk> Chunks;
+  int   Count;   // values in all chunks
+};
+
+// Reads a declaration record, returns false if it is incomplete.
+bool binDecl(BinCursor& c, quint32& id, BinVector& v)
+{
+  if(c.u32() != BinDecl)  return false;
+  id = c.u32();
+  v.Indep = (c.u32() == 0);
+  v.Name = c.str();
+  quint32 n = c.u32();
+  for(quint32 i = 0; (i < n) && !c.Fail; i++)
+    v.Deps.append(c.str());
+  v.Count = 0;
+  return !c.Fail;
+}
+
+void binChunk(BinVector& v, qint64 pos, int count, int flags)
+{
+  BinChunk k = { pos, count, flags };
+  v.Chunks.append(k);
+  v.Count += count;
+}
+
+// Collects the vectors from the index or, for a file still being
+// written, from the records up to the first incomplete one.  Returns
+// false if the file is corrupt.
+bool binVectors(const QByteArray& Data, QList<BinVector>& Vecs, bool& complete)
+{
+  BinCursor c(Data, 8);
+  c.u32();  // version
+  c.u32();
+  quint64 index = c.u64();
+  if(c.Fail)  return false;
+
+  complete = (index != 0);
+  if(complete) {
+    c.Pos = index;
+    if(c.u32() != BinIndex)  return false;
+    quint32 n = c.u32();
+    for(quint32 i = 0; (i < n) && !c.Fail; i++) {
+      BinVector v;
+      quint32 id = c.u32(), nid;
+      BinCursor d(Data, c.u64());
+      if(!binDecl(d, nid, v) || (nid != id))  return false;
+      quint32 chunks = c.u32();
+      for(quint32 k = 0; (k < chunks) && !c.Fail; k++) {
+        qint64 pos = c.u64();
+        int count = c.u32();
+        binChunk(v, pos, count, c.u32());
+      }
+      Vecs.append(v);
+    }
+    return !c.Fail;
+  }
+
+  QHash<quint32, int> Ids;
+  while(c.Pos < Data.size()) {
+    BinCursor d(Data, c.Pos);
+    quint32 tag = c.u32(), id, n;
+    if(tag == BinDecl) {
+      BinVector v;
+      if(!binDecl(d, id, v))  return true;
+      c.Pos = d.Pos;
+      Ids.insert(id, Vecs.size());
+      Vecs.append(v);
+    }
+    else if(tag == BinData) {
+      id = c.u32();
+      int count = c.u32();
+      int flags = c.u32();
+      qint64 pos = c.Pos;
+      qint64 bytes = qint64(count) * ((flags & BinComplex) ? 16 : 8);
+      if(!c.left(bytes))  return true;
+      c.Pos += bytes;
+      if(!Ids.contains(id))  return false;
+      binChunk(Vecs[Ids.value(id)], pos, count, flags);
+    }
+    else if(tag == BinPacked) {
+      id = c.u32();
+      int count = c.u32();
+      int flags = c.u32();
+      quint32 bytes = c.u32();
+      qint64 pos = c.Pos;
+      if(!c.left(bytes))  return true;
+      c.Pos += bytes;
+      if(!Ids.contains(id))  return false;
+      binChunk(Vecs[Ids.value(id)], pos, count, flags);
+    }
+    else if(tag == BinIndex) {  // outdated index of a file being written
+      n = c.u32();
+      for(quint32 i = 0; (i < n) && !c.Fail; i++) {
+        c.u32();  c.u64();
+        quint32 chunks = c.u32();
+        if(c.left(16 * qint64(chunks)))  c.Pos += 16 * qint64(chunks);
+      }
+      if(c.Fail)  return true;
+    }
+    else  return c.Fail;
+  }
+  return true;
+}
+
+// Prediction of a packed value from the two previous ones.
+double binPredict(int k, double a, double b)
+{
+  if(k == 0)  return 0.0;
+  if(k == 1)  return a;
+  double p = 2*a - b;
+  return std::isfinite(p) ? p : a;
+}
+
+// Unpacks a column of a packed data record, see binPack() in
+// qucs-core/src/dataset.cpp.  Returns the position behind it or NULL
+// if the record is truncated.
+const uchar* binUnpack(const uchar *p, const uchar *end,
+                       double *x, int n, int stride)
+{
+  double a = 0.0, b = 0.0;
+  int ctrl = 0;
+  for(int k = 0; k < n; k++) {
+    if(!(k & 1)) {
+      if(p >= end)  return NULL;
+      ctrl = *p++;
+    }
+    int len = (k & 1) ? (ctrl >> 4) : (ctrl & 15);
+    if((len > 8) || (end - p < len))  return NULL;
+    quint64 u = 0, q;
+    for(int i = 0; i < len; i++)  u |= quint64(p[i]) << (8*i);
+    p += len;
+    double d = binPredict(k, a, b);
+    memcpy(&q, &d, 8);
+    u ^= q;
+    memcpy(&d, &u, 8);
+    x[k*stride] = d;
+    b = a;
+    a = d;
+  }
+  return p;
+}
+
+// Appends the given number of values of the vector as lines in the
+// format of qucsator.
+void printValues(QByteArray& Text, const QByteArray& Data,
+                 const BinVector& v, int count)
+{
+  char buf[80];
+  foreach(const BinChunk& k, v.Chunks) {
+    int cols = (k.Flags & BinComplex) ? 2 : 1;
+    QVector<double> Values(2*k.Count, 0.0);
+    const char *p = Data.constData() + k.Pos;
+    if(k.Flags & BinPack) {
+      const uchar *q = (const uchar*) p;
+      const uchar *end = (const uchar*) Data.constData() + Data.size();
+      for(int c = 0; (c < cols) && q; c++)
+        q = binUnpack(q, end, Values.data() + c, k.Count, 2);
+      if(!q)  Values.fill(0.0);
+    }
+    else
+      for(int i = 0; i < k.Count; i++, p += 8*cols)
+        memcpy(Values.data() + 2*i, p, 8*cols);
+    for(int i = 0; (i < k.Count) && (count > 0); i++, count--) {
+      const double *d = Values.constData() + 2*i;
+      if(d[1] == 0.0)
+        qsnprintf(buf, sizeof(buf), "  %+.20e\n", d[0]);
+      else
+        qsnprintf(buf, sizeof(buf), "  %+.20e%cj%.20e\n", d[0],
+                  (d[1] >= 0.0) ? '+' : '-', (d[1] >= 0.0) ? d[1] : -d[1]);
+      Text += buf;
+    }
+  }
+}
+
+// Orders positions by the names at these positions.
+struct NameLess {
+  const QStringList& Names;
+  NameLess(const QStringList& n) : Names(n) {}
+  bool operator()(int a, int b) const { return Names.at(a) < Names.at(b); }
+};
+
+}
+
+// --------------------------------------------------------------------------
+// Returns the cache entry of the file, starts building its index if the
+// file is not yet cached or has changed meanwhile.
+QFuture<QSharedPointer<const DataSetIndex> >
+  DataSetIndex::lookup(const QString& fileName)
+{
+  QFileInfo Info(fileName);
+  QString Key = Info.absoluteFilePath();
+  QDateTime modified = Info.lastModified();
+  qint64 size = Info.size();
+
+  QMutexLocker Lock(&CacheMutex);
+  CacheOrder.removeOne(Key);
+  CacheOrder.append(Key);
+
+  QHash<QString, CacheEntry>::const_iterator it = Cache.constFind(Key);
+  if(it != Cache.constEnd())
+    if(it->modified == modified && it->size == size)
+      return it->index;
+
+  CacheEntry e;
+  e.modified = modified;
+  e.size = size;
+  e.index = QtConcurrent::run(load, fileName);
+  Cache.insert(Key, e);
+
+  while(CacheOrder.size() > CacheSize)
+    Cache.remove(CacheOrder.takeFirst());
+  return e.index;
+}
+
+// --------------------------------------------------------------------------
+QSharedPointer<const DataSetIndex> DataSetIndex::get(const QString& fileName)
+{
+  return lookup(fileName).result();
+}
+
+// --------------------------------------------------------------------------
+void DataSetIndex::prefetch(const QString& fileName)
+{
+  lookup(fileName);
+}
+
+// --------------------------------------------------------------------------
+bool DataSetIndex::isReady(const QString& fileName)
+{
+  return lookup(fileName).isFinished();
+}
+
+// --------------------------------------------------------------------------
+bool DataSetIndex::isBinary(const QByteArray& Data)
+{
+  return (Data.size() >= BinHeader) && (memcmp(Data.constData(), BinMagic, 8) == 0);
+}
+
+// --------------------------------------------------------------------------
+// The vectors of a file still being written are cut down to the values
+// all of them have got so far, i.e. independent vectors to the size of
+// the shortest vector depending on them only.  Vectors depending on more
+// than one variable are left out until they fit their dependencies.
+QByteArray DataSetIndex::toText(const QByteArray& Data)
+{
+  QList<BinVector> Vecs;
+  bool complete;
+  if(!isBinary(Data) || !binVectors(Data, Vecs, complete))
+    return QByteArray();
+
+  QHash<QByteArray, int> Size;   // values shown of independent vectors
+  foreach(const BinVector& v, Vecs)
+    if(v.Indep)  Size.insert(v.Name, v.Count);
+  if(!complete)
+    foreach(const BinVector& v, Vecs)
+      if(!v.Indep && (v.Deps.size() == 1) && Size.contains(v.Deps.first()))
+        Size[v.Deps.first()] = qMin(Size.value(v.Deps.first()), v.Count);
+
+  QByteArray Text("<Qucs Dataset " PACKAGE_VERSION ">\n");
+  foreach(const BinVector& v, Vecs) {
+    int count = v.Count;
+    if(v.Indep)
+      count = Size.value(v.Name);
+    else if(!complete) {
+      qint64 n = 1;
+      foreach(const QByteArray& dep, v.Deps)
+        n *= Size.value(dep, 0);
+      if(v.Deps.size() == 1)  count = int(n);
+      else if(n != count)  continue;   // not yet complete
+    }
+
+    if(v.Indep)
+      Text += "<indep " + v.Name + " " + QByteArray::number(count) + ">\n";
+    else {
+      Text += "<dep " + v.Name;
+      foreach(const QByteArray& dep, v.Deps)
+        Text += " " + dep;
+      Text += ">\n";
+    }
+    printValues(Text, Data, v, count);
+    Text += v.Indep ? "</indep>\n" : "</dep>\n";
+  }
+  return Text;
+}
+
+// --------------------------------------------------------------------------
+// Runs on a worker thread.
+QSharedPointer<const DataSetIndex> DataSetIndex::load(const QString& fileName)
+{
+  QSharedPointer<DataSetIndex> Index(new DataSetIndex);
+  QFile file(fileName);
+  if(file.open(QIODevice::ReadOnly)) {
+    // To strongly speed up the file read operation the whole file is
+    // read into the memory in one piece.
+    Index->Content = file.readAll();
+    file.close();
+    if(isBinary(Index->Content))
+      Index->Content = toText(Index->Content);
+    Index->build();
+  }
+  return Index;
+}
+
+// --------------------------------------------------------------------------
+// Records the position of each "<dep name ...>" and "<indep name ...>"
+// header.  The values never contain a '<', so the scan can jump from
+// tag to tag.
+void DataSetIndex::build()
+{
+  if(Content.isEmpty())  return;
+  char Last = Content.at(Content.size()-1);
+  if(Last > ' ')  if(Last != '>')  return;  // file not completely written
+
+  const char *Begin = Content.constData();
+  const char *End = Begin + Content.size();
+  const char *p = Begin;
+  while((p = (const char*)memchr(p, '<', End-p))) {
+    p++;
+    bool isIndep;
+    if(strncmp(p, "dep ", 4) == 0) {
+      isIndep = false;
+      p += 4;
+    }
+    else if(strncmp(p, "indep ", 6) == 0) {
+      isIndep = true;
+      p += 6;
+    }
+    else continue;
+
+    const char *pName = p;
+    while((p < End) && (*p > ' ') && (*p != '>'))  p++;
+    if((p >= End) || (*p != ' '))  continue;
+    QString Name = QString::fromLatin1(pName, p-pName);
+
+    p++;
+    const char *pEnd = (const char*)memchr(p, '>', End-p);
+    if(!pEnd)  break;   // file corrupt
+
+    Entry e;
+    e.indep  = isIndep;
+    e.line   = p - Begin;
+    e.length = pEnd - p;
+    e.data   = pEnd + 1 - Begin;
+    QHash<QString, Entry>& Lookup = isIndep ? Indeps : Deps;
+    if(!Lookup.contains(Name))
+      Lookup.insert(Name, e);
+    Names.append(Name);
+    Vars.append(e);
+    p = pEnd + 1;
+  }
+
+  NameOrder.resize(Names.size());
+  for(int i = 0; i < NameOrder.size(); i++)  NameOrder[i] = i;
+  qStableSort(NameOrder.begin(), NameOrder.end(), NameLess(Names));
+  valid = true;
+}
+
+// --------------------------------------------------------------------------
+const DataSetIndex::Entry* DataSetIndex::find(const QString& Var) const
+{
+  QHash<QString, Entry>::const_iterator d = Deps.constFind(Var);
+  QHash<QString, Entry>::const_iterator i = Indeps.constFind(Var);
+  if(d == Deps.constEnd())
+    return (i == Indeps.constEnd()) ? 0 : &(*i);
+  if(i == Indeps.constEnd())
+    return &(*d);
+  return (i->line < d->line) ? &(*i) : &(*d);  // the first one in the file
+}
+
+// --------------------------------------------------------------------------
+const DataSetIndex::Entry* DataSetIndex::findIndep(const QString& Var) const
+{
+  QHash<QString, Entry>::const_iterator i = Indeps.constFind(Var);
+  return (i == Indeps.constEnd()) ? 0 : &(*i);
+}
+
+// vim:ts=8:sw=2:noet
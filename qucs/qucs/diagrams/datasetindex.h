@@ -0,0 +1,99 @@
+/***************************************************************************
+                              datasetindex.h
+                             ----------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef DATASETINDEX_H
+#define DATASETINDEX_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFuture>
+#include <QHash>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/*!
+ * Index of the variables of a dataset file.
+ *
+ * The file is read into memory in one piece and scanned once for the
+ * variable headers.  Binary datasets (qucsator -B) are converted into
+ * the text format first; those still being written by a running
+ * simulation are read up to the last complete record.  The resulting
+ * index is read-only and thus can be shared by all graphs (and
+ * threads) using the dataset.  Indices are built on a worker thread
+ * and kept in a cache keyed by file name, which is invalidated as soon
+ * as the modification time or the size of the file changes.  Besides
+ * the lookup by name, the index lists all variables in the order of
+ * the file and of their names, e.g. for the variable browser of the
+ * diagram dialog.
+ */
+class DataSetIndex {
+public:
+  struct Entry {
+    bool indep;   // independent variable ?
+    int  line;    // offset of the header text behind the variable name
+    int  length;  // length of the header text
+    int  data;    // offset of the first value
+  };
+
+  //! Returns the (possibly cached) index of the file, waits if necessary.
+  static QSharedPointer<const DataSetIndex> get(const QString& fileName);
+  //! Starts building the index of the file in the background.
+  static void prefetch(const QString& fileName);
+  //! Returns true if get() would not block.
+  static bool isReady(const QString& fileName);
+  //! Returns true if the contents are in the binary dataset format.
+  static bool isBinary(const QByteArray&);
+  //! Returns the binary dataset contents in the text format.
+  static QByteArray toText(const QByteArray&);
+
+  bool isValid() const { return valid; }
+  const char* data() const { return Content.constData(); }
+  //! Returns the first variable of the given name or NULL.
+  const Entry* find(const QString&) const;
+  //! Returns the independent variable of the given name or NULL.
+  const Entry* findIndep(const QString&) const;
+  //! Returns the header text of a variable.
+  QString line(const Entry* e) const {
+    return QString::fromLatin1(Content.constData() + e->line, e->length);
+  }
+
+  //! Number of variable headers, in the order of the file.
+  int count() const { return Names.size(); }
+  const QString& name(int i) const { return Names.at(i); }
+  const Entry& entry(int i) const { return Vars.at(i); }
+  //! Returns the position of the i-th variable in the order of the names.
+  int byName(int i) const { return NameOrder.at(i); }
+
+private:
+  DataSetIndex() : valid(false) {}
+  static QFuture<QSharedPointer<const DataSetIndex> > lookup(const QString&);
+  static QSharedPointer<const DataSetIndex> load(const QString&);
+  void build();
+
+  QByteArray Content;
+  QHash<QString, Entry> Deps;
+  QHash<QString, Entry> Indeps;
+  QStringList Names;        // all headers in the order of the file
+  QVector<Entry> Vars;
+  QVector<int> NameOrder;   // positions sorted by name
+  bool valid;
+};
+
+#endif
+
+// vim:ts=8:sw=2:noet
@@ -0,0 +1,167 @@
+/***************************************************************************
+                            datasetvarmodel.cpp
+                           ---------------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "datasetvarmodel.h"
+
+#include <QtAlgorithms>
+
+namespace {
+
+// rows handed to the view at once
+const int FetchSize = 256;
+
+// Orders variables by the text of a column.
+struct ColumnLess {
+  const DataSetVarModel *Model;
+  int  Column;
+  bool Descending;
+  bool operator()(int a, int b) const {
+    int c = QString::compare(Model->text(a, Column), Model->text(b, Column));
+    return Descending ? (c > 0) : (c < 0);
+  }
+};
+
+}
+
+// --------------------------------------------------------------------------
+DataSetVarModel::DataSetVarModel(QObject *parent)
+  : QAbstractTableModel(parent),
+    SortColumn(0), SortOrder(Qt::AscendingOrder), Fetched(0)
+{
+}
+
+// --------------------------------------------------------------------------
+void DataSetVarModel::setIndex(QSharedPointer<const DataSetIndex> i)
+{
+  Index = i;
+  update();
+}
+
+// --------------------------------------------------------------------------
+void DataSetVarModel::setFilter(const QString& s)
+{
+  if(s == Filter)  return;
+  Filter = s;
+  update();
+}
+
+// --------------------------------------------------------------------------
+QString DataSetVarModel::name(const QModelIndex& i) const
+{
+  if(!i.isValid() || (i.row() >= Fetched))  return QString();
+  return Index->name(Rows.at(i.row()));
+}
+
+// --------------------------------------------------------------------------
+// Collects the variables shown in the order of the sort column.
+void DataSetVarModel::update()
+{
+  beginResetModel();
+  Rows.clear();
+  int n = Index ? Index->count() : 0;
+  for(int k = 0; k < n; k++) {
+    int i = k;
+    if(SortColumn == 0)
+      i = Index->byName((SortOrder == Qt::AscendingOrder) ? k : n-1-k);
+    const QString& Var = Index->name(i);
+    if(Var.startsWith('_'))  continue;
+    if(!Filter.isEmpty())
+      if(!Var.contains(Filter, Qt::CaseInsensitive))  continue;
+    Rows.append(i);
+  }
+
+  if(SortColumn > 0) {
+    ColumnLess Less = { this, SortColumn, SortOrder == Qt::DescendingOrder };
+    qStableSort(Rows.begin(), Rows.end(), Less);
+  }
+  Fetched = qMin(Rows.size(), FetchSize);
+  endResetModel();
+}
+
+// --------------------------------------------------------------------------
+QString DataSetVarModel::text(int var, int column) const
+{
+  const DataSetIndex::Entry& e = Index->entry(var);
+  switch(column) {
+    case 0:  return Index->name(var);
+    case 1:  return e.indep ? "indep" : "dep";
+    default: return Index->line(&e);  // size or dependencies
+  }
+}
+
+// --------------------------------------------------------------------------
+int DataSetVarModel::rowCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : Fetched;
+}
+
+// --------------------------------------------------------------------------
+int DataSetVarModel::columnCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : 3;
+}
+
+// --------------------------------------------------------------------------
+QVariant DataSetVarModel::data(const QModelIndex& i, int role) const
+{
+  if(role != Qt::DisplayRole)  return QVariant();
+  if(!i.isValid() || (i.row() >= Fetched))  return QVariant();
+  return text(Rows.at(i.row()), i.column());
+}
+
+// --------------------------------------------------------------------------
+QVariant DataSetVarModel::headerData(int section, Qt::Orientation o,
+                                     int role) const
+{
+  if((role != Qt::DisplayRole) || (o != Qt::Horizontal))
+    return QVariant();
+  switch(section) {
+    case 0:  return tr("Name");
+    case 1:  return tr("Type");
+    default: return tr("Size");
+  }
+}
+
+// --------------------------------------------------------------------------
+void DataSetVarModel::sort(int column, Qt::SortOrder order)
+{
+  SortColumn = column;
+  SortOrder = order;
+  update();
+}
+
+// --------------------------------------------------------------------------
+bool DataSetVarModel::canFetchMore(const QModelIndex& parent) const
+{
+  return !parent.isValid() && (Fetched < Rows.size());
+}
+
+// --------------------------------------------------------------------------
+void DataSetVarModel::fetchMore(const QModelIndex& parent)
+{
+  if(parent.isValid())  return;
+  int n = qMin(Rows.size() - Fetched, FetchSize);
+  if(n <= 0)  return;
+  beginInsertRows(QModelIndex(), Fetched, Fetched+n-1);
+  Fetched += n;
+  endInsertRows();
+}
+
+// vim:ts=8:sw=2:noet
@@ -0,0 +1,70 @@
+/***************************************************************************
+                             datasetvarmodel.h
+                            -------------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef DATASETVARMODEL_H
+#define DATASETVARMODEL_H
+
+#include "datasetindex.h"
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+/*!
+ * Table of the variables of a dataset (name, type and size) on top of
+ * its shared DataSetIndex.
+ *
+ * The model keeps nothing but the positions of the variables shown, the
+ * cell texts are taken from the index when the view asks for them.  The
+ * rows are handed to the view in portions (fetchMore()), so the view
+ * only lays out what is scrolled to.  Sorting by name uses the order
+ * stored in the index, filtering is a single scan over the names.
+ * Variables beginning with '_' are internal and never shown.
+ */
+class DataSetVarModel : public QAbstractTableModel {
+Q_OBJECT
+public:
+  DataSetVarModel(QObject *parent=0);
+
+  void setIndex(QSharedPointer<const DataSetIndex>);
+  //! Shows the variables containing the text only (case insensitive).
+  void setFilter(const QString&);
+  //! Returns the variable name of the row.
+  QString name(const QModelIndex&) const;
+  //! Returns the text of a column for the variable at the index position.
+  QString text(int var, int column) const;
+
+  int rowCount(const QModelIndex& parent=QModelIndex()) const;
+  int columnCount(const QModelIndex& parent=QModelIndex()) const;
+  QVariant data(const QModelIndex&, int role=Qt::DisplayRole) const;
+  QVariant headerData(int, Qt::Orientation, int role=Qt::DisplayRole) const;
+  void sort(int column, Qt::SortOrder order=Qt::AscendingOrder);
+  bool canFetchMore(const QModelIndex&) const;
+  void fetchMore(const QModelIndex&);
+
+private:
+  void update();
+
+  QSharedPointer<const DataSetIndex> Index;
+  QString Filter;
+  int SortColumn;
+  Qt::SortOrder SortOrder;
+  QVector<int> Rows;   // positions in the index of the variables shown
+  int Fetched;         // rows handed to the view so far
+};
+
+#endif
+
+// vim:ts=8:sw=2:noet
@@ -28,7 +28,9 @@
 # include <config.h>
 #endif
 #include <stdlib.h>
+#include <string.h>
 #include <cmath>
+#include <algorithm>
 #include <float.h>
 #if HAVE_IEEEFP_H
 # include <ieeefp.h>
@@ -36,6 +38,7 @@
 #include <locale.h>
 
 #include "diagram.h"
+#include "datasetindex.h"
 #include "qucs.h"
 #include "mnemo.h"
 #include "schematic.h"
@@ -50,6 +53,32 @@
 #include <QPainter>
 #include <QDebug>
 #include <QString>
+#include <QThread>
+#include <QCoreApplication>
+#include <QtConcurrentMap>
+
+/* WORK-AROUND: A bug in SCIM (libscim) which Qt is linked to causes
+   to change the locale to the default.  As setlocale() must not be
+   called while other threads parse numbers, graphs are loaded on
+   worker threads only after the GUI thread has fixed the locale. */
+static void fixNumericLocale()
+{
+  QCoreApplication *app = QCoreApplication::instance();
+  if(!app || QThread::currentThread() == app->thread())
+    setlocale (LC_NUMERIC, "C");
+}
+
+namespace {
+
+// Loads the data of a graph, used by QtConcurrent.
+struct GraphLoader {
+  typedef int result_type;
+  GraphLoader(const QString& s) : DataSet(s) {}
+  int operator()(Graph *pg) const { return pg->loadDatFile(DataSet); }
+  QString DataSet;
+};
+
+}
 
 Diagram::Diagram(int _cx, int _cy)
 {
@@ -513,6 +542,15 @@ void Diagram::calcData(Graph *g)
   if(xAxis.autoScale)  if(yAxis.autoScale)  if(zAxis.autoScale)
     Counter = -50000;
 
+  // Draw large graphs of cartesian diagrams with a decimated number of
+  // samples, a few per pixel column of the visible x range.
+  int Level = 0;
+  std::vector<int> Samples;
+  if(Name == "Rect")  if(g->Style <= GRAPHSTYLE_LONGDASH)
+    Level = g->lodLevel(xAxis.low, xAxis.up, x2);
+  if(Level > 0)
+    Size = ((2*(4*x2 + (2 << Level) + 2) + 1) * g->countY) + 10;
+
   double Dummy = 0.0;  // not used
   double *py = &Dummy;
 
@@ -536,18 +574,34 @@ void Diagram::calcData(Graph *g)
 
       for(i=g->countY; i>0; i--) {  // every branch of curves
 	px = g->axis(0)->Points;
-	calcCoordinateP(px, pz, py, p, pa);
-	++px;
-	pz += 2;
-	++p;
-	for(z=g->axis(0)->count-1; z>0; z--) {  // every point
-	  FIT_MEMORY_SIZE;  // need to enlarge memory block ?
+	if(Level > 0) {   // decimated graph
+	  g->lodSamples(Level, g->countY-i, xAxis.low, xAxis.up, Samples);
+	  std::vector<int>::const_iterator s = Samples.begin();
+	  calcCoordinateP(px+*s, pz+2*(*s), py, p, pa);
+	  ++p;
+	  for(++s; s != Samples.end(); ++s) {  // every remaining sample
+	    FIT_MEMORY_SIZE;  // need to enlarge memory block ?
+	    calcCoordinateP(px+*s, pz+2*(*s), py, p, pa);
+	    ++p;
+	    if(Counter >= 2)   // clipping only if an axis is manual
+	      clip(p);
+	  }
+	  pz += 2*g->axis(0)->count;
+	}
+	else {
 	  calcCoordinateP(px, pz, py, p, pa);
 	  ++px;
 	  pz += 2;
 	  ++p;
-	  if(Counter >= 2)   // clipping only if an axis is manual
-	    clip(p);
+	  for(z=g->axis(0)->count-1; z>0; z--) {  // every point
+	    FIT_MEMORY_SIZE;  // need to enlarge memory block ?
+	    calcCoordinateP(px, pz, py, p, pa);
+	    ++px;
+	    pz += 2;
+	    ++p;
+	    if(Counter >= 2)   // clipping only if an axis is manual
+	      clip(p);
+	  }
 	}
 	if((p-3)->isStrokeEnd() && !(p-3)->isBranchEnd())
 	  p -= 3;  // no single point after "no stroke"
@@ -707,10 +761,26 @@ void Diagram::loadGraphData(const QString& defaultDataSet)
   yAxis.min = zAxis.min = xAxis.min =  DBL_MAX;
   yAxis.max = zAxis.max = xAxis.max = -DBL_MAX;
 
+  // The graphs are parsed concurrently, each one writes its own memory
+  // only.  The datasets are indexed before, thus the workers do not wait
+  // for each other.
+  QList<int> Loaded;
+  if(Graphs.size() > 1) {
+    fixNumericLocale();
+    foreach(Graph *pg, Graphs)
+      DataSetIndex::get(pg->dataSetFile(defaultDataSet));
+    Loaded = QtConcurrent::blockingMapped<QList<int> >(Graphs,
+                                    GraphLoader(defaultDataSet));
+  }
+  else
+    foreach(Graph *pg, Graphs)
+      Loaded.append(pg->loadDatFile(defaultDataSet));
+
   int No=0;
-  foreach(Graph *pg, Graphs) {
+  for(int i = 0; i < Graphs.size(); i++) {
+    Graph *pg = Graphs.at(i);
     qDebug() << "load GraphData load" << defaultDataSet << pg->Var;
-    if(pg->loadDatFile(defaultDataSet) != 1)   // load data, determine max/min values
+    if(Loaded.at(i) != 1)   // data loaded, determine max/min values
       No++;
     getAxisLimits(pg);
   }
@@ -795,6 +865,21 @@ void Diagram::updateGraphData()
   }
 }
 
+// --------------------------------------------------------------------------
+/*!
+   Returns the dataset file the graph variable is read from.  Variables
+   of the form "name:var" refer to the dataset "name.dat" next to the
+   default dataset.
+*/
+QString Graph::dataSetFile(const QString& defaultDataSet) const
+{
+  int pos = Var.indexOf(':');
+  if(pos <= 0)  return defaultDataSet;
+
+  QFileInfo Info(defaultDataSet);
+  return Info.path()+QDir::separator() + Var.left(pos)+".dat";
+}
+
 // --------------------------------------------------------------------------
 /*!
  * does not (yet) load a dat file. only part of it.
@@ -805,29 +890,21 @@ void Diagram::updateGraphData()
 int Graph::loadDatFile(const QString& fileName)
 {
   Graph* g = this;
-  QFile file;
   QString Variable;
-  QFileInfo Info(fileName);
+  QFileInfo Info(dataSetFile(fileName));
 
   int pos = g->Var.indexOf(':');
 //  if(g->Var.right(3) == "].X")  // e.g. stdl[8:0].X
 //    if(pos > g->Var.indexOf('['))
 //      pos = -1;
 
-  /* WORK-AROUND: A bug in SCIM (libscim) which Qt is linked to causes
-     to change the locale to the default. */
-  setlocale (LC_NUMERIC, "C");
+  fixNumericLocale();
 
-  if(pos <= 0) {
-    file.setFileName(fileName);
+  if(pos <= 0)
     Variable = g->Var;
-  }
-  else {
-    file.setFileName(Info.path()+QDir::separator() + g->Var.left(pos)+".dat");
+  else
     Variable = g->Var.mid(pos+1);
-  }
 
-  Info.setFile(file);
   if(g->lastLoaded.isValid())
     if(g->lastLoaded > Info.lastModified())
       return 1;    // dataset unchanged -> no update neccessary
@@ -835,6 +912,8 @@ int Graph::loadDatFile(const QString& fileName)
   g->countY = 0;
   g->mutable_axes().clear(); // HACK
   if(g->cPointsY) { delete[] g->cPointsY;  g->cPointsY = 0; }
+  g->Transitions.clear();
+  g->clearLOD();
   if(Variable.isEmpty()) return 0;
 
 #if 0 // FIXME encapsulation. implement digital waves later.
@@ -844,48 +923,24 @@ int Graph::loadDatFile(const QString& fileName)
 #endif
 
 
-  if(!file.open(QIODevice::ReadOnly))  return 0;
-
   // *****************************************************************
-  // To strongly speed up the file read operation the whole file is
-  // read into the memory in one piece.
-  QByteArray FileContent;
-  FileContent = file.readAll();
-  file.close();
-  char *FileString = FileContent.data();
-  if(!FileString)  return 0;
-  char *pPos = FileString+FileContent.size()-1;
-  if(*pPos > ' ')  if(*pPos != '>')  return 0;
-  *pPos = 0;
-
+  // The dataset is read and indexed once (on a worker thread) and
+  // shared by all graphs using it.
+  QSharedPointer<const DataSetIndex> Data =
+    DataSetIndex::get(Info.filePath());
+  if(!Data->isValid())  return 0;
 
   // *****************************************************************
   // look for variable name in data file  ****************************
-  bool isIndep = false;
-  Variable = "dep "+Variable+" ";
-  // "pFile" is used through-out the whole function and must NOT used
-  // for other purposes!
-  char *pFile = strstr(FileString, Variable.toLatin1());
-  while(pFile) {
-    if(*(pFile-1) == '<')     // is dependent variable ?
-      break;
-    else if(strncmp(pFile-3, "<in", 3) == 0) {  // is independent variable ?
-      isIndep = true;
-      break;
-    }
-    pFile = strstr(pFile+4, Variable.toLatin1());
-  }
-
-  if(!pFile)  return 0;   // data not found
+  const DataSetIndex::Entry *pVar = Data->find(Variable);
+  if(!pVar)  return 0;   // data not found
+  bool isIndep = pVar->indep;
 
   QString Line, tmp;
-  pFile += Variable.length();
-  pPos = strchr(pFile, '>');
-  if(!pPos)  return 0;   // file corrupt
-  *pPos = 0;
-  Line = QString(pFile);
-  *pPos = '>';
-  pFile = pPos+1;
+  Line = Data->line(pVar);
+  // "pFile" is used through-out the whole function and must NOT used
+  // for other purposes!
+  const char *pFile = Data->data() + pVar->data;
   if(!isIndep) {
     pos = 0;
     tmp = Line.section(' ', pos, pos);
@@ -935,7 +990,7 @@ int Graph::loadDatFile(const QString& fileName)
       }
       else if(pD == bLast)  pa = &yAxis;   // y axis for Rect3D
 #endif
-      counting = loadIndepVarData(pD->Var, FileString, mutable_axis(ii));
+      counting = loadIndepVarData(pD->Var, *Data, mutable_axis(ii));
       if(counting <= 0)  return 0;
 
       g->countY *= counting;
@@ -956,10 +1011,11 @@ int Graph::loadDatFile(const QString& fileName)
 #endif
 
   char *pEnd;
+  const char *pPos;
   double x, y;
   pPos = pFile;
 
-if(Variable.right(3) != ".X ") { // not "digital"
+if(Variable.right(2) != ".X") { // not "digital"
 
   for(int z=counting; z>0; z--) {
     pEnd = 0;
@@ -973,10 +1029,10 @@ if(Variable.right(3) != ".X ") { // not "digital"
         delete[] g->cPointsY;  g->cPointsY = 0;
         return 0;
       }
-      *pPos = *pEnd;  // overwrite 'j' with sign
+      char Sign = *pEnd;
       pEnd = 0;
-      y = strtod(pPos, &pEnd); // imaginary part
-      *pPos = 'j';   // write back old character
+      y = strtod(pPos+1, &pEnd); // imaginary part (dataset is read-only)
+      if(Sign == '-')  y = -y;
       pPos = pEnd;
     }
     *(p++) = x;
@@ -1009,31 +1065,35 @@ if(Variable.right(3) != ".X ") { // not "digital"
 
 } else {  // of "if not digital"
 
-  char *pc = (char*)p;
-  pEnd = pc + 2*(counting-1)*sizeof(double);
-  // for digital variables (e.g. 100ZX0):
-  for(int z=counting; z>0; z--) {
+  // for digital variables (e.g. 100ZX0): the vectors are collected first
+  // and copied at once, "Transitions" gets the first sample of each run
+  // of equal values
+  QByteArray Bits;
+  Bits.reserve(2*counting);
+  int last = -1;   // start of the previous vector
+  for(int z=0; z<counting; z++) {
 
     while((*pPos) && (*pPos <= ' '))  pPos++; // find start of next bit vector
     if(*pPos == 0) {
       delete[] g->cPointsY;  g->cPointsY = 0;
+      g->Transitions.clear();
       return 0;
     }
 
-    while(*pPos > ' ') {    // copy bit vector
-      *(pc++) = *(pPos++);
-      if(pEnd <= pc) {
-        counting = pc - (char*)g->cPointsY;
-        pc = (char*)realloc(g->cPointsY, counting+1024);
-        pEnd = pc;
-        g->cPointsY = (double*)pEnd;
-        pc += counting;
-        pEnd += counting+1020;
-      }
-    }
-    *(pc++) = 0;   // terminate each vector with NULL
+    const char *pStart = pPos;
+    while(*pPos > ' ')  pPos++;
+    int start = Bits.size();
+    Bits.append(pStart, pPos - pStart);
+    Bits.append('\0');   // terminate each vector with NULL
+    if(last < 0 || strcmp(Bits.constData()+last, Bits.constData()+start) != 0)
+      g->Transitions.push_back(z);
+    last = start;
   }
 
+  delete[] g->cPointsY;
+  g->cPointsY = new double[Bits.size()/sizeof(double) + 1];
+  memcpy(g->cPointsY, Bits.constData(), Bits.size());
+
 }  // of "if not digital"
 
   lastLoaded = QDateTime::currentDateTime();
@@ -1044,50 +1104,24 @@ if(Variable.right(3) != ".X ") { // not "digital"
    Reads the data of an independent variable. Returns the number of points.
 */
 int Graph::loadIndepVarData(const QString& Variable,
-			      char *FileString, DataX* pD)
+			      const DataSetIndex& Data, DataX* pD)
 {
-  bool isIndep = false;
-  QString Line, tmp;
+  QString Line;
+
+  fixNumericLocale();
 
-  /* WORK-AROUND: A bug in SCIM (libscim) which Qt is linked to causes
-     to change the locale to the default. */
-  setlocale (LC_NUMERIC, "C");
+  const DataSetIndex::Entry *pVar = Data.find(Variable);
+  if(!pVar)  return -1;   // data not found
 
-  Line = "dep "+Variable+" ";
+  Line = Data.line(pVar);
   // "pFile" is used through-out the whole function and must NOT used
   // for other purposes!
-  char *pFile = strstr(FileString, Line.toLatin1());
-  while(pFile) {
-    if(*(pFile-1) == '<')     // is dependent variable ?
-      break;
-    else if(strncmp(pFile-3, "<in", 3) == 0) {  // is independent variable ?
-      isIndep = true;
-      break;
-    }
-    pFile = strstr(pFile+4, Line.toLatin1());
-  }
-
-  if(!pFile)  return -1;   // data not found
-
-  pFile += Line.length();
-  char *pPos = strchr(pFile, '>');
-  if(!pPos)  return -1;   // file corrupt
-  *pPos = 0;
-  Line = QString(pFile);
-  *pPos = '>';
-  pFile = pPos+1;
-  char *pEnd;
-  if(!isIndep) {           // dependent variable can also be used...
+  const char *pFile = Data.data() + pVar->data;
+  if(!pVar->indep) {       // dependent variable can also be used...
     if(Line.indexOf(' ') >= 0)  return -1; // ...if only one dependency
-    Line = "<indep "+Line+" ";
-    pPos = strstr(FileString, Line.toLatin1());
-    if(!pPos)  return -1;
-    pPos += Line.length();
-    pEnd = strchr(pPos, '>');
-    if(!pEnd)  return -1;   // file corrupt
-    *pEnd = 0;
-    Line = QString(pPos);
-    *pEnd = '>';
+    pVar = Data.findIndep(Line);
+    if(!pVar)  return -1;
+    Line = Data.line(pVar);
   }
 
 
@@ -1102,7 +1136,8 @@ int Graph::loadIndepVarData(const QString& Variable,
 
 
   double x;
-  pPos = pFile;
+  char *pEnd;
+  const char *pPos = pFile;
   // find first position containing no whitespace
   while((*pPos) && (*pPos <= ' '))  pPos++;
 
@@ -2117,26 +2152,19 @@ void Diagram::findaxisA(Graph *g)
 //will determine the value of the graph for one frequency
 bool Diagram::findmatch(Graph *g , int m)
 {
-  double *px;
-  double *pz = g->cPointsY + 2*m*g->axis(0)->count;
-  int z;
   if(freq <= (double*) 0)
   {
     freq=0;
     sfreq = "0 Hz";
     return false;
   } 
-	px = g->axis(0)->Points;
-	for(z=g->axis(0)->count; z>0; z--) {  // every point
-	  if(*px == freq[nfreqa])
-	  {
-	    g->gy = pz;//save value
-	    return true;
-	  }
-	  ++px;
-	  pz += 2;
-	}
-  return false;
+  // the AC frequencies are sorted, bisect them instead of a linear scan
+  DataX const *pD = g->axis(0);
+  double *end = pD->Points + pD->count;
+  double *px = std::lower_bound(pD->Points, end, freq[nfreqa]);
+  if(px == end || *px != freq[nfreqa])  return false;
+  g->gy = g->cPointsY + 2*(m*pD->count + (px - pD->Points));//save value
+  return true;
 
 }
 
@@ -2144,15 +2172,29 @@ bool Diagram::findmatch(Graph *g , int m)
 //  if there isn't any value that match will find the closest number and replace
 void Diagram::findfreq(Graph *g)
 {
+  // same request on unchanged data, keep the frequencies found last time
+  if(freq!=nullptr && g==freqGraph && g->lastLoaded==freqLoaded &&
+     (sfreq==freqRequest || sfreq==freqResult))
+  {
+    sfreq = freqResult;
+    nfreqa = nfreqt;
+    return;
+  }
+  freqGraph = g;
+  freqLoaded = g->lastLoaded;
+  freqRequest = sfreq;
+  freqResult.clear();
+
   if(freq!=nullptr) delete[] freq;
   freq= nullptr;
   int z = QString::compare(g->axis(0)->Var,"acfrequency",Qt::CaseInsensitive);//meaning that only work in AC 
   if(z != 0)
   {
     nfreqt=1;
-    freq = new double;
+    freq = new double[1];
     freq[0] = 0;
     sfreq = "0 Hz;";
+    freqResult = sfreq;
     return;
   }
   double scale = 1.0;
@@ -2166,6 +2208,7 @@ void Diagram::findfreq(Graph *g)
   int s;
   n=sfreq.count(';')+1;
   freq= new double[n];
+  nfreqt=0;
 
   do{
     n = sfreq.indexOf(";",m,Qt::CaseInsensitive);
@@ -2195,7 +2238,6 @@ void Diagram::findfreq(Graph *g)
     }
 
     double *px,f=0;
-    int i,z;
     double d,dmin=DBL_MAX;
     num = value.mid(0,a);
     freqnum = num.toDouble(&ok) * scale;
@@ -2216,20 +2258,20 @@ void Diagram::findfreq(Graph *g)
 	goto end;
     }
 
-    for(i=g->countY; i>0; i--) {  // every branch of curves
-      px = g->axis(0)->Points;
-      for(z=g->axis(0)->count; z>0; z--) {  // every point
-	if(*px > 0)
-	{
-	  d=fabs(freqnum - *px);
-	  if(d<dmin) 
-	  {
-	    dmin=d;
-	    f= *px; 
-	  }
-	}
-	++px;
-      }
+    // closest positive frequency of the sorted axis, the lower one on ties
+    px = g->axis(0)->Points;
+    double *first = std::upper_bound(px, px + g->axis(0)->count, 0.0);
+    double *last = px + g->axis(0)->count;
+    double *pf = std::lower_bound(first, last, freqnum);
+    if(pf != last)
+    {
+      dmin = fabs(*pf - freqnum);
+      f = *pf;
+    }
+    if(pf != first)
+    {
+      d = fabs(freqnum - *(pf-1));
+      if(d <= dmin)  f = *(pf-1);
     }
     freqnum = f;
     for(s=0;s<nfreqt;s++)
@@ -2263,6 +2305,7 @@ end:
     nfreqt=1;
     freq[0] = 0;
     sfreq = "0 Hz;";
+    freqResult = sfreq;
     return;   
   }
   nfreqa=0;
@@ -2298,6 +2341,7 @@ end:
     sfreq.append(value);
     nfreqa++;
   }
+  freqResult = sfreq;
 
   
 
@@ -102,7 +102,13 @@ public:
   bool findmatch(Graph* , int);
   void findfreq(Graph*);
   void setlimitsphasor(Axis* ,Axis*);
-  double wavevalX(int) const;*/
+  double wavevalX(int) const;
+
+  // last result of findfreq(), reused while neither the requested
+  // frequencies nor the data of the graph change
+  Graph *freqGraph = nullptr;
+  QDateTime freqLoaded;
+  QString freqRequest, freqResult;*/
 
   QString Name; // identity of diagram type (e.g. Polar), used for saving etc.
   QPen    GridPen;
@@ -24,6 +24,7 @@
 #include "schematic.h"
 #include "rect3ddiagram.h"
 #include "misc.h"
+#include "datasetvarmodel.h"
 
 #include <cmath>
 #include <assert.h>
@@ -39,7 +40,7 @@
 #include <QSlider>
 #include <QComboBox>
 #include <QListWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QPainter>
 #include <QVBoxLayout>
 #include <QGroupBox>
@@ -284,31 +285,30 @@ DiagramDialog::DiagramDialog(Diagram *d, QWidget *parent, Graph *currentGraph)
   DataGroupLayout->addWidget(ChooseData);
   ChooseData->setMinimumWidth(300); // will force also min width of table below
 
-  // todo: replace by QTableWidget
-  // see https://gist.github.com/ClemensFMN/8955411
-
     Name=Diag->Name;
     connect(ChooseData, SIGNAL(activated(int)), SLOT(slotReadVars(int)));
-    ChooseVars = new QTableWidget(1, 3);
+    VarFilter = new QLineEdit();
+    VarFilter->setPlaceholderText(tr("Filter Variables"));
+    DataGroupLayout->addWidget(VarFilter);
+    connect(VarFilter, SIGNAL(textChanged(const QString&)),
+            SLOT(slotFilterVars(const QString&)));
+
+    // the model takes the variables from the dataset index on demand
+    VarModel = new DataSetVarModel(this);
+    ChooseVars = new QTableView();
+    ChooseVars->setModel(VarModel);
     ChooseVars->verticalHeader()->setVisible(false);
     ChooseVars->horizontalHeader()->setStretchLastSection(true);
     ChooseVars->horizontalHeader()->setResizeMode(QHeaderView::ResizeToContents);
-    // make sure sorting is disabled before inserting items
-    ChooseVars->setSortingEnabled(false);
     ChooseVars->horizontalHeader()->setSortIndicatorShown(true);
     ChooseVars->horizontalHeader()->setSortIndicator(0, Qt::AscendingOrder);
+    ChooseVars->setSortingEnabled(true);
 
     ChooseVars->setSelectionBehavior(QAbstractItemView::SelectRows);
-    //ChooseVars->selectRow(0);
+    ChooseVars->setEditTriggers(QAbstractItemView::NoEditTriggers);
     DataGroupLayout->addWidget(ChooseVars);
-    //ChooseVars->addColumn(tr("Name"));
-    //ChooseVars->addColumn(tr("Type"));
-    //ChooseVars->addColumn(tr("Size"));
-    QStringList headers;
-    headers << tr("Name") << tr("Type") << tr("Size");
-    ChooseVars->setHorizontalHeaderLabels(headers);
 
-    connect(ChooseVars, SIGNAL(itemDoubleClicked(QTableWidgetItem*)), SLOT(slotTakeVar(QTableWidgetItem*)));
+    connect(ChooseVars, SIGNAL(doubleClicked(const QModelIndex&)), SLOT(slotTakeVar(const QModelIndex&)));
 
   QGroupBox *GraphGroup = new QGroupBox(tr("Graph"));
   Box1Layout->addWidget(GraphGroup);
@@ -747,88 +747,30 @@ void DiagramDialog::slotReadVars(int)
   QFileInfo Info(defaultDataSet);
   QString DocName = ChooseData->currentText()+".dat";
 
-  QFile file(Info.path() + QDir::separator() + DocName);
-  if(!file.open(QIODevice::ReadOnly)) {
-    return;
-  }
-
-  QString Line, tmp, Var;
-  int varNumber = 0;
-  // reading the file as a whole improves speed very much, also using
-  // a QByteArray rather than a QString
-  QByteArray FileString = file.readAll();
-  file.close();
-
-  // make sure sorting is disabled before inserting items
-  ChooseVars->setSortingEnabled(false);
-  ChooseVars->clearContents();
-  int i=0, j=0;
-  i = FileString.indexOf('<')+1;
-  if(i > 0)
-  do {
-    j = FileString.indexOf('>', i);
-    for(int k=0;k<j-i;k++) Line[k]=FileString[k+i];
-    Line.truncate(j-i);
-    i = FileString.indexOf('<', j)+1;
-
-    Var = Line.section(' ', 1, 1).remove('>');
-    if(Var.length()>0)
-      if(Var.at(0) == '_')  continue;
-
-
-    if(Line.left(3) == "dep") {
-      tmp = Line.section(' ', 2);
-      //new Q3ListViewItem(ChooseVars, Var, "dep", tmp.remove('>'));
-      qDebug() << varNumber << Var << tmp.remove('>');
-      ChooseVars->setRowCount(varNumber+1);
-      QTableWidgetItem *cell = new QTableWidgetItem(Var);
-      cell->setFlags(cell->flags() ^ Qt::ItemIsEditable);
-      ChooseVars->setItem(varNumber, 0, cell);
-      cell = new QTableWidgetItem("dep");
-      cell->setFlags(cell->flags() ^ Qt::ItemIsEditable);
-      ChooseVars->setItem(varNumber, 1, cell);
-      cell = new QTableWidgetItem(tmp.remove('>'));
-      cell->setFlags(cell->flags() ^ Qt::ItemIsEditable);
-      ChooseVars->setItem(varNumber, 2, cell);
-      varNumber++;
-    }
-    else if(Line.left(5) == "indep") {
-      tmp = Line.section(' ', 2, 2);
-      //new Q3ListViewItem(ChooseVars, Var, "indep", tmp.remove('>'));
-      qDebug() << varNumber << Var << tmp.remove('>');
-      ChooseVars->setRowCount(varNumber+1);
-      QTableWidgetItem *cell = new QTableWidgetItem(Var);
-      cell->setFlags(cell->flags() ^ Qt::ItemIsEditable);
-      ChooseVars->setItem(varNumber, 0, cell);
-      cell = new QTableWidgetItem("indep");
-      cell->setFlags(cell->flags() ^ Qt::ItemIsEditable);
-      ChooseVars->setItem(varNumber, 1, cell);
-      cell = new QTableWidgetItem(tmp.remove('>'));
-      cell->setFlags(cell->flags() ^ Qt::ItemIsEditable);
-      ChooseVars->setItem(varNumber, 2, cell);
-      varNumber++;
+  // The index is shared with the graphs, usually it is already built
+  // while loading the schematic.
+  VarModel->setIndex(DataSetIndex::get(Info.path() + QDir::separator() + DocName));
+}
 
-    }
-  } while(i > 0);
-  // sorting should be enabled only after adding items
-  ChooseVars->setSortingEnabled(true);
+// --------------------------------------------------------------------------
+void DiagramDialog::slotFilterVars(const QString& s)
+{
+  VarModel->setFilter(s);
 }
 
 // ------------------------------------------------------------------------
 // Inserts the double-clicked variable into the Graph Input Line at the
 // cursor position. If the Graph Input is empty, then the variable is
 // also inserted as graph.
-void DiagramDialog::slotTakeVar(QTableWidgetItem* Item)
+void DiagramDialog::slotTakeVar(const QModelIndex& Item)
 {
+  QString s1 = VarModel->name(Item);
+  if(s1.isEmpty())  return;
+
   GraphInput->blockSignals(true);
   if(toTake) GraphInput->setText("");
 
   GraphInput->cursorPosition();
-  //QString s="";
-  //QString s1 = Item->text();
-  QString s1;
-  int row = Item->row();
-  s1 = ChooseVars->item(row, 0)->text();
 
   QFileInfo Info(defaultDataSet);
   if(ChooseData->currentText() != Info.completeBaseName())
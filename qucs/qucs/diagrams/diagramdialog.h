@@ -34,9 +34,10 @@ class QDoubleValidator;
 class QIntValidator;
 class QRegExpValidator;
 class QSlider;
-class QTableWidgetItem;
 class QListWidgetItem;
-class QTableWidget;
+class QTableView;
+class QModelIndex;
+class DataSetVarModel;
 class QListWidget;
 
 
@@ -52,7 +53,8 @@ public:
 
 private slots:
   void slotReadVars(int);
-  void slotTakeVar(QTableWidgetItem *item);
+  void slotFilterVars(const QString&);
+  void slotTakeVar(const QModelIndex&);
 //  void slotSelectGraph(int index);
   void slotSelectGraph(QListWidgetItem*);
   void slotNewGraph();
@@ -106,7 +108,9 @@ private:
   QRegExpValidator *Validator;
 
   QComboBox *ChooseData;
-  QTableWidget *ChooseVars;
+  QLineEdit  *VarFilter;
+  QTableView *ChooseVars;
+  DataSetVarModel *VarModel;
   QListWidget  *GraphList;
 
   QVBoxLayout *all;   // the mother of all widgets
@@ -17,7 +17,10 @@
 #include "graph.h"
 
 #include <stdlib.h>
+#include <cmath>
 #include <iostream>
+#include <algorithm>
+#include <functional>
 
 #include <QPainter>
 #include <QDebug>
@@ -41,6 +44,9 @@ Graph::Graph(Diagram const* d, const QString& _Line) :
 
   cPointsY = 0;
   gy=NULL;
+  LODData = 0;
+  LODCount = LODBranches = 0;
+  StrokesValid = false;
 }
 
 Graph::~Graph()
@@ -57,6 +63,143 @@ void Graph::createMarkerText() const
   }
 }
 
+// ---------------------------------------------------------------------
+// Graphs with less samples are always drawn completely.
+#define LOD_MIN_SAMPLES  4096
+
+// The value the y axis limits are determined from.
+static inline double lodValue(const double* y)
+{
+  if(fabs(y[1]) >= 1e-250)  return sqrt(y[0]*y[0] + y[1]*y[1]);
+  return y[0];
+}
+
+// Stores "i" in "min"/"max" if it is the smaller/greater sample.
+static inline void lodMinMax(const double* y, int i, int& min, int& max)
+{
+  double v = lodValue(y+2*i);
+  if(!std::isfinite(v))  return;
+  double vmin = lodValue(y+2*min), vmax = lodValue(y+2*max);
+  if(!std::isfinite(vmin) || v < vmin)  min = i;
+  if(!std::isfinite(vmax) || v > vmax)  max = i;
+}
+
+/*!
+   Builds the min/max decimation pyramid of the graph data.  The first
+   level combines two samples per bucket, every further level two
+   buckets of the level below.  The pyramid is only built if the first
+   axis is sorted, i.e. a screen column covers a contiguous sample range.
+*/
+void Graph::buildLOD()
+{
+  LOD.clear();
+  LODData = cPointsY;
+  LODBranches = countY;
+  LODCount = count(0);
+  if(!cPointsY || LODCount < LOD_MIN_SAMPLES)  return;
+
+  const double *px = axis(0)->Points;
+  for(int i=1; i<LODCount; i++)
+    if(!(px[i-1] <= px[i]))  return;   // not sorted (or NaN)
+
+  int n = LODCount >> 1;
+  std::vector<int> Level(2*n*LODBranches);
+  for(int b=0; b<LODBranches; b++) {
+    const double *py = cPointsY + 2*b*LODCount;
+    int *pi = &Level[2*b*n];
+    for(int z=0; z<n; z++, pi+=2) {
+      pi[0] = pi[1] = 2*z;
+      lodMinMax(py, 2*z+1, pi[0], pi[1]);
+    }
+  }
+  LOD.push_back(Level);
+
+  while((n >> 1) >= 64) {   // coarser levels down to 64 buckets
+    int m = n >> 1;
+    std::vector<int> Next(2*m*LODBranches);
+    const std::vector<int>& Prev = LOD.back();
+    for(int b=0; b<LODBranches; b++) {
+      const double *py = cPointsY + 2*b*LODCount;
+      const int *pp = &Prev[2*b*n];
+      int *pi = &Next[2*b*m];
+      for(int z=0; z<m; z++, pi+=2, pp+=4) {
+        pi[0] = pp[0];
+        pi[1] = pp[1];
+        lodMinMax(py, pp[2], pi[0], pi[1]);
+        lodMinMax(py, pp[3], pi[0], pi[1]);
+      }
+    }
+    LOD.push_back(Next);
+    n = m;
+  }
+}
+
+// Determines the samples of the sorted first axis visible between "low"
+// and "up", including one sample beyond each limit.
+void Graph::lodRange(double low, double up, int& first, int& last) const
+{
+  const double *px = axis(0)->Points;
+  if(low > up)  std::swap(low, up);
+  first = int(std::lower_bound(px, px+LODCount, low) - px) - 1;
+  last  = int(std::upper_bound(px, px+LODCount, up) - px);
+  if(first < 0)  first = 0;
+  if(last >= LODCount)  last = LODCount-1;
+}
+
+/*!
+   Returns the pyramid level to draw the graph with, if the x axis range
+   "low" to "up" is mapped onto "width" pixels, or zero if all samples
+   are to be drawn.
+*/
+int Graph::lodLevel(double low, double up, int width)
+{
+  if(LODData != cPointsY || LODCount != (int)count(0) || LODBranches != countY)
+    buildLOD();
+  if(LOD.empty() || width <= 0)  return 0;
+
+  int first, last;
+  lodRange(low, up, first, last);
+  int perPixel = (last - first + 1) / width;
+
+  // at least two buckets per pixel column, each giving two points
+  int level = 0;
+  while((level < int(LOD.size())) && ((4 << level) <= perPixel))
+    level++;
+  return (level < 2) ? 0 : level;
+}
+
+/*!
+   Gives the ascending indices of the samples of a branch to draw at the
+   given level.  Inside the visible range every full bucket contributes
+   its minimum and maximum sample, the partial buckets at the limits are
+   taken completely.
+*/
+void Graph::lodSamples(int level, int branch, double low, double up,
+                       std::vector<int>& samples) const
+{
+  int first, last;
+  lodRange(low, up, first, last);
+  samples.clear();
+  samples.push_back(first);
+
+  int Bucket = 1 << level;
+  int Buckets = LODCount >> level;
+  int b0 = (first + Bucket) >> level;  // first bucket behind "first"
+  int b1 = std::min(last >> level, Buckets);
+  int z = first + 1;
+  if(b0 < b1) {
+    for(; z < b0*Bucket; z++)  samples.push_back(z);
+    const int *pi = &LOD[level-1][2*(branch*Buckets + b0)];
+    for(int b=b0; b<b1; b++, pi+=2) {
+      samples.push_back(std::min(pi[0], pi[1]));
+      if(pi[0] != pi[1])  samples.push_back(std::max(pi[0], pi[1]));
+    }
+    z = b1*Bucket;
+  }
+  for(; z < last; z++)  samples.push_back(z);
+  if(last > first)  samples.push_back(last);
+}
+
 // ---------------------------------------------------------------------
 void Graph::paint(ViewPainter *p, int x0, int y0)
 {
@@ -340,6 +483,61 @@ Graph* Graph::sameNewOne()
   return pg;
 }
 
+// --------------------------------------------------------------
+/*!
+ * Returns whether the points are sorted, see "Order".
+ */
+int DataX::order() const
+{
+  if(Order)  return Order;
+  bool up = true, down = true;
+  for(int i=1; (i<count) && (up || down); i++) {
+    up   = up   && (Points[i-1] <= Points[i]);
+    down = down && (Points[i-1] >= Points[i]);
+  }
+  Order = up ? 1 : (down ? -1 : 2);
+  return Order;
+}
+
+/*!
+ * Returns the index of the point nearest to x.  Sorted points are
+ * searched by bisection, others are walked up to the first local
+ * minimum of the distance.  Of equally distant points the later one
+ * is taken in both cases.
+ */
+int DataX::nearest(double x) const
+{
+  if(count <= 1)  return 0;
+  if(order() == 2 || std::isnan(x)) {
+    int i = 0;
+    while((i < count-1) && !(fabs(x-Points[i]) < fabs(x-Points[i+1])))  i++;
+    return i;
+  }
+
+  // the first point beyond x and the one before it
+  const double *begin = Points, *end = Points + count, *p;
+  if(order() > 0)  p = std::upper_bound(begin, end, x);
+  else  p = std::upper_bound(begin, end, x, std::greater<double>());
+  int i = p - Points;
+  if((i > 0) && ((i == count) || (fabs(x-Points[i-1]) < fabs(x-Points[i]))))
+    return i-1;
+  while((i < count-1) && (Points[i+1] == Points[i]))  i++;
+  return i;
+}
+
+/*!
+ * Returns the index of the first point not below x or the last one.
+ */
+int DataX::lowerBound(double x) const
+{
+  int i = 0;
+  if(order() == 1)
+    i = std::lower_bound(Points, Points + count, x) - Points;
+  else
+    while((i < count) && !(x <= Points[i]))  i++;
+  return (i < count) ? i : count-1;
+}
+
 /*!
  * find a sample point close to VarPos, snap to it, and return data at VarPos
  */
@@ -351,16 +549,10 @@ std::pair<double,double> Graph::findSample(std::vector<double>& VarPos) const
   unsigned m=1;
 
   for(unsigned ii=0; (pD=axis(ii)); ++ii) {
-    double* pp = pD->Points;
-    double v = VarPos[nVarPos];
-    for(unsigned i=pD->count; i>1; i--) {  // find appropiate marker position
-      if(fabs(v-(*pp)) < fabs(v-(*(pp+1)))) break;
-      pp++;
-      n += m;
-    }
-
+    int i = pD->nearest(VarPos[nVarPos]);  // find appropiate marker position
+    n += m*i;
     m *= pD->count;
-    VarPos[nVarPos++] = *pp;
+    VarPos[nVarPos++] = pD->Points[i];
   }
 
   return std::pair<double,double>(cPointsY[2*n], cPointsY[2*n+1]);
@@ -26,8 +26,10 @@
 #include <QColor>
 #include <Q3PtrList>
 #include <QDateTime>
+#include <QPolygonF>
 
 #include <assert.h>
+#include <vector>
 
 typedef enum{
   GRAPHSTYLE_INVALID = -1,
@@ -53,11 +55,13 @@ inline graphstyle_t toGraphStyle(int x){
 
 class Diagram;
 class ViewPainter;
+class DataSetIndex;
 
 
 struct DataX {
   DataX(const QString& Var_, double *Points_=0, int count_=0)
-       : Var(Var_), Points(Points_), count(count_), Min(INFINITY), Max(-INFINITY) {};
+       : Var(Var_), Points(Points_), count(count_), Min(INFINITY), Max(-INFINITY),
+         Order(0) {};
  ~DataX() { if(Points) delete[] Points; };
   QString Var;
   double *Points;
@@ -66,12 +70,18 @@ struct DataX {
 public:
   const double& min()const {return Min;}
   const double& max()const {return Max;}
+  int nearest(double) const;
+  int lowerBound(double) const;
+  int order() const;
 public: // only called from Graph. cleanup later.
   const double& min(const double& x){if (Min<x) Min=x; return Min;}
   const double& max(const double& x){if (Max>x) Max=x; return Max;}
 private:
   double Min;
   double Max;
+  // 1 if the points ascend, -1 if they descend, 2 if neither and 0 if
+  // not yet known; "Points" are filled once after the allocation
+  mutable int Order;
 };
 
 struct Axis;
@@ -123,7 +133,8 @@ public:
   typedef container::const_iterator const_iterator;
 
   int loadDatFile(const QString& filename);
-  int loadIndepVarData(const QString&, char* datfilecontent, DataX* where);
+  int loadIndepVarData(const QString&, const DataSetIndex&, DataX* where);
+  QString dataSetFile(const QString& defaultDataSet) const;
 
   void    paint(ViewPainter*, int, int);
   void    paintLines(ViewPainter*, int, int);
@@ -144,10 +155,10 @@ public:
   bool isEmpty() const { return !cPointsX.size(); }
   QVector<DataX*>& mutable_axes(){return cPointsX;} // HACK
 
-  void clear(){ScrPoints.resize(0);}
-  void resizeScrPoints(size_t s){assert(s>=ScrPoints.size()); ScrPoints.resize(s);}
-  iterator begin(){return ScrPoints.begin();}
-  iterator end(){return ScrPoints.end();}
+  void clear(){ScrPoints.resize(0); StrokesValid=false;}
+  void resizeScrPoints(size_t s){assert(s>=ScrPoints.size()); ScrPoints.resize(s); StrokesValid=false;}
+  iterator begin(){StrokesValid=false; return ScrPoints.begin();}
+  iterator end(){StrokesValid=false; return ScrPoints.end();}
   const_iterator begin() const{return ScrPoints.begin();}
   const_iterator end() const{return ScrPoints.end();}
 
@@ -161,6 +172,8 @@ public:
   graphstyle_t Style;
   QList<Marker *> Markers;
   double *gy;
+  // digital data (".X"): first sample of every run of equal values
+  std::vector<int> Transitions;
 
   // for tabular diagram
   int  Precision;   // number of digits to show
@@ -172,6 +185,23 @@ private: // painting
   void drawCircleSymbols(int, int, ViewPainter*) const;
   void drawArrowSymbols(int, int, ViewPainter*) const;
   void drawvect(int, int, ViewPainter*) const;
+  void buildStrokes() const;
+  // the strokes of "ScrPoints", built again after they have changed
+  mutable QList<QPolygonF> Strokes;
+  mutable bool StrokesValid;
+public: // level of detail
+  int  lodLevel(double low, double up, int width);
+  void lodSamples(int level, int branch, double low, double up,
+                  std::vector<int>& samples) const;
+  void clearLOD() { LOD.clear(); LODData = 0; }
+private:
+  void buildLOD();
+  void lodRange(double low, double up, int& first, int& last) const;
+  // LOD[k-1] holds the indices of the minimum and the maximum sample of
+  // each bucket of 2^k samples of every branch
+  std::vector<std::vector<int> > LOD;
+  double const* LODData;  // the graph data the pyramid was built for
+  int LODCount, LODBranches;
 public: // marker related
   void createMarkerText() const;
   std::pair<double,double> findSample(std::vector<double>&) const;
@@ -49,6 +49,7 @@ static double default_Z0=50;
 Marker::Marker(Graph *pg_, int branchNo, int cx_, int cy_) :
   Element(),
   pGraph(pg_),
+  Cursor(-1),
   Precision(3),
   numMode(0),
   Z0(default_Z0) // BUG: see declaration.
@@ -327,18 +328,16 @@ void Marker::getTextSize()
 // ---------------------------------------------------------------------
 bool Marker::moveLeftRight(bool left)
 {
-  int n;
   double *px;
 
   DataX const *pD = pGraph->axis(0);
   px = pD->Points;
   if(!px) return false;
 
-    for(n=0; n<pD->count; n++) {
-      if(VarPos[0] <= *px) break;
-      px++;
-    }
-    if(n == pD->count) px--;
+    // the position of the previous step unless the marker was moved
+    if((Cursor < 0) || (Cursor >= pD->count) || (px[Cursor] != VarPos[0]))
+      Cursor = pD->lowerBound(VarPos[0]);
+    px += Cursor;
 
     if(left) {
       if(px <= pD->Points) return false;
@@ -349,6 +348,7 @@ bool Marker::moveLeftRight(bool left)
       px++;  // one position to the right
     }
     VarPos[0] = *px;
+    Cursor = px - pD->Points;
 
   createText();
 
@@ -358,7 +358,7 @@ bool Marker::moveLeftRight(bool left)
 // ---------------------------------------------------------------------
 bool Marker::moveUpDown(bool up)
 {
-  int n, i=0;
+  int i=0;
   double *px;
 
   DataX const *pD = pGraph->axis(0);
@@ -370,10 +370,7 @@ bool Marker::moveUpDown(bool up)
       if(!pD) return false;
       px = pD->Points;
       if(!px) return false;
-      for(n=1; n<pD->count; n++) {  // go through all data points
-        if(fabs(VarPos[i]-(*px)) < fabs(VarPos[i]-(*(px+1)))) break;
-        px++;
-      }
+      px += pD->nearest(VarPos[i]);
 
     } while(px >= (pD->Points + pD->count - 1));  // go to next dimension ?
 
@@ -390,10 +387,7 @@ bool Marker::moveUpDown(bool up)
       if(!pD) return false;
       px = pD->Points;
       if(!px) return false;
-      for(n=0; n<pD->count; n++) {
-        if(fabs(VarPos[i]-(*px)) < fabs(VarPos[i]-(*(px+1)))) break;
-        px++;
-      }
+      px += pD->nearest(VarPos[i]);
 
     } while(px <= pD->Points);  // go to next dimension ?
 
@@ -75,6 +75,7 @@ public: // power matching stuff. some sort of VarPos (ab?)use
 
 private:
   std::vector<double> VarPos;   // values the marker is pointing to
+  int    Cursor;      // index of VarPos[0] in the x axis, -1 if unknown
   double VarDep[2];   // dependent value
   float  fCX, fCY;  // coordinates for the line from graph to marker body
 
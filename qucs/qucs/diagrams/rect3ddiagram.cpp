@@ -29,6 +29,7 @@
 #include <cmath>
 #include <float.h>
 #include <limits.h>
+#include <algorithm>
 #if HAVE_IEEEFP_H
 # include <ieeefp.h>
 #endif
@@ -46,6 +47,8 @@ Rect3DDiagram::Rect3DDiagram(int _cx, int _cy) : Diagram(_cx, _cy)
   x3 = 207;    // with some distance for right axes text
 
   Mem = pMem = 0;  // auxiliary buffer for hidden lines
+  BoundsLeft  = INT_MAX;
+  BoundsRight = INT_MIN;
 
   Name = "Rect3D"; // BUG
   // symbolic diagram painting
@@ -242,20 +245,27 @@ void Rect3DDiagram::calcCoordinate3D(double x, double y, double zr, double zi,
 // --------------------------------------------------------------
 bool Rect3DDiagram::isHidden(int x, int y, tBound *Bounds, char *zBuffer)
 {
+  // points outside the diagram area can neither be hidden nor hide
+  if(x < 0 || x > x2 || y < 0 || y > y2)  return false;
+
   // remember the boundings of the polygon
   if( (Bounds+x)->max < y )  (Bounds+x)->max = y;
   if( (Bounds+x)->min > y )  (Bounds+x)->min = y;
+  if(BoundsLeft  > x)  BoundsLeft  = x;
+  if(BoundsRight < x)  BoundsRight = x;
 
   // diagram area already used ?
   return ( *(zBuffer + (y>>3) + x * ((y2+7)>>3)) & (1 << (y & 7)) ) != 0;
 }
 
 // --------------------------------------------------------------
-// Enlarge memory block if neccessary.
+// Enlarge memory block if neccessary. It grows by half its size, so
+// the points of many hidden line segments do not realloc it each time.
 void Rect3DDiagram::enlargeMemoryBlock(tPoint3D* &MemEnd)
 {
   if(pMem >= MemEnd) {
-    int Size = MemEnd - Mem + 256;
+    int Size = MemEnd - Mem;
+    Size += Size/2 + 256;
     MemEnd = Mem;
     Mem  = (tPoint3D*)realloc(Mem, Size*sizeof(tPoint3D));
     pMem += Mem - MemEnd;
@@ -368,16 +378,40 @@ void Rect3DDiagram::calcLine(tPoint3D* &p, tPoint3D* &MemEnd,
 }
 
 // --------------------------------------------------------------
-// Compare functions for GNU qsort routine.
-int Rect3DDiagram::comparePoint3D(const void *Point1, const void *Point2)
+// Compare functions for sorting the points.
+bool Rect3DDiagram::comparePoint3D(const tPoint3D& Point1, const tPoint3D& Point2)
+{
+  return Point1.No < Point2.No;
+}
+bool Rect3DDiagram::comparePointZ(const tPointZ& Point1, const tPointZ& Point2)
 {
-  return ((tPoint3D*)Point1)->No - ((tPoint3D*)Point2)->No;
+  return Point1.z > Point2.z;
 }
-int Rect3DDiagram::comparePointZ(const void *Point1, const void *Point2)
+
+// --------------------------------------------------------------
+// Marks the area of the current polygon (stored in "*Bounds") as used
+// and resets the bounding buffer. Only the columns touched by the
+// polygon are worked on, filling whole bytes of the column if possible.
+void Rect3DDiagram::markPolygon(tBound *Bounds, char *zBuffer)
 {
-  if((((tPointZ*)Point2)->z - ((tPointZ*)Point1)->z) < 0.0f)
-    return -1;
-  return 1;
+  int Stride = (y2+7)>>3;
+  for(int i=BoundsLeft; i<=BoundsRight; i++) {
+    tBound *b = Bounds+i;
+    if(i < x2 && b->max > INT_MIN) {
+      char *pc = zBuffer + i * Stride;
+      int j = b->min;
+      for( ; (j & 7) && j<=b->max; j++)
+        *(pc + (j>>3)) |= (1 << (j & 7));
+      for( ; j+7<=b->max; j+=8)
+        *(pc + (j>>3)) = char(0xFF);
+      for( ; j<=b->max; j++)
+        *(pc + (j>>3)) |= (1 << (j & 7));
+    }
+    b->max = INT_MIN;
+    b->min = INT_MAX;
+  }
+  BoundsLeft  = INT_MAX;
+  BoundsRight = INT_MIN;
 }
 
 // --------------------------------------------------------------
@@ -394,17 +428,13 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
     if(g->cPointsY)
       Size += g->axis(0)->count * g->countY;
 
+  // Each point is stored twice (mesh and cross grid), the points
+  // splitting line segments into visible and hidden parts are added
+  // later on by enlarging "Mem". Points outside the diagram area are
+  // never hidden, so they do not add any.
   // "Mem" should be the last malloc to simplify realloc
-  // multiplicator 'malloc_8xsize' added
-  // 'malloc_8xsize' increases the requested size in the 2 malloc lines below
-  // this comment section.
-  // And it is added to the calculation of 'MemEnd'.
-  // Main reason are the segments drawn to points outside the diagram.
-  // It is assumed to be a memory issue.
-  // Note: As of today the memory calculation is still not 100% clean.
-  int malloc_8xsize=8;
-  tPointZ *zMem = (tPointZ*)malloc( malloc_8xsize*(Size+2)*sizeof(tPointZ) );
-  Mem  = (tPoint3D*)malloc( malloc_8xsize*2*(Size+2)*sizeof(tPoint3D) );
+  tPointZ *zMem = (tPointZ*)malloc( (Size+2)*sizeof(tPointZ) );
+  Mem  = (tPoint3D*)malloc( (2*Size+256)*sizeof(tPoint3D) );
 
   pMem = Mem;
   tPointZ *zp = zMem, *zp_tmp;
@@ -518,7 +548,7 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
   // Sort z-coordinates (greatest first).
   // After this the polygons that have the smallest distance to the
   // viewer are on top of the list and thus, will be processed first.
-  qsort(zMem, Size, sizeof(tPointZ), comparePointZ);
+  std::sort(zMem, zMem+Size, comparePointZ);
 
 #if 0
   qDebug("--------------------------- z sorting");
@@ -528,9 +558,15 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
 
 
   // ..........................................
-  char *pc;
-  // malloc_8xsize added (see comment before malloc_8xsize declaration)
-  tPoint3D *MemEnd = Mem + malloc_8xsize*2*Size - 5;   // limit of buffer
+  tPoint3D *MemEnd = Mem + 2*Size+256 - 5;   // limit of buffer
+
+  // reset the polygon bounding buffer
+  for(i=x2; i>=0; i--) {
+    (Bounds+i)->max = INT_MIN;
+    (Bounds+i)->min = INT_MAX;
+  }
+  BoundsLeft  = INT_MAX;
+  BoundsRight = INT_MIN;
 
   zp = zMem;
   foreach(Graph *g, Graphs) {
@@ -542,12 +578,6 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
     // look for hidden lines ...
     for(int No = g->countY/dy * (dx-1)*(dy-1); No>0; No--) {
 
-      // reset the polygon bounding buffer
-      for(i=x2; i>=0; i--) {
-        (Bounds+i)->max = INT_MIN;
-        (Bounds+i)->min = INT_MAX;
-      }
-
       // work on all 4 lines of polygon
       p = Mem + zp->No;  // polygon corner coordinates
       calcLine(p, MemEnd, Bounds, zBuffer);
@@ -561,13 +591,8 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
       p += dy;
       calcLine(p, MemEnd, Bounds, zBuffer);
 
-      // mark the area of the polygon (stored in "*Bounds") as used
-      for(i=x2-1; i>=0; i--)  // all x coordinates
-        if( (Bounds+i)->max > INT_MIN) {
-          pc = zBuffer + i * ((y2+7)>>3);
-          for(j=(Bounds+i)->min; j<=(Bounds+i)->max; j++) // all y coordinates
-            *(pc + (j>>3)) |= (1 << (j & 7));
-        }
+      // mark the area of the polygon as used
+      markPolygon(Bounds, zBuffer);
 
       zp++;   // next polygon
     }
@@ -582,8 +607,9 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
 
   free(zMem);
 
-  // sort "No" (least one first)
-  qsort(Mem, pMem - Mem, sizeof(tPoint3D), comparePoint3D);
+  // sort "No" (least one first), the points splitting a line segment
+  // must stay in the order they were found
+  std::stable_sort(Mem, pMem, comparePoint3D);
 
 #if 0
   qDebug("--------------------------- last sorting %d", pMem-Mem);
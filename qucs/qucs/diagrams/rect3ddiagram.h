@@ -69,9 +69,10 @@ private:
   double calcY_2D(double, double, double) const;
   double calcZ_2D(double, double, double) const;
 
-  static int comparePoint3D(const void*, const void*);
-  static int comparePointZ(const void*, const void*);
+  static bool comparePoint3D(const tPoint3D&, const tPoint3D&);
+  static bool comparePointZ(const tPointZ&, const tPointZ&);
   bool isHidden(int, int, tBound*, char*);
+  void markPolygon(tBound*, char*);
   void enlargeMemoryBlock(tPoint3D* &);
   void calcLine(tPoint3D* &, tPoint3D* &, tBound*, char*);
   void calcCoordinate3D(double, double, double, double, tPoint3D*, tPointZ*);
@@ -81,6 +82,7 @@ private:
   float  xorig, yorig; // where is the 3D origin with respect to cx/cy
   double cxx, cxy, cxz, cyx, cyy, cyz, czx, czy, czz; // coefficients 3D -> 2D
   double scaleX, scaleY;
+  int BoundsLeft, BoundsRight; // columns touched by the current polygon
 };
 
 #endif
@@ -175,9 +175,16 @@ int TabDiagram::calcDiagram()
   int NumAll=0;   // how many numbers per column
   int NumLeft=0;  // how many numbers could not be written
 
-  double *py, *px;
+  double *py;
   int counting, invisibleCount=0;
-  int startWriting, lastCount = 1;
+
+  // Only the rows in the visible area are formatted. They are found
+  // directly from the scroll position, so the time needed does not
+  // depend on the number of data points.
+  int top = y2-tHeight-5;   // position of first row
+  int rows = 0;             // number of rows fitting into the diagram
+  if(top >= tHeight)  rows = (top-tHeight) / tHeight + 1;
+  int first = int(xAxis.limit_min + 0.5);  // first visible row
 
   // any graph with data ?
   while(g->isEmpty()) {
@@ -197,6 +204,7 @@ int TabDiagram::calcDiagram()
       if(invisibleCount < int(xAxis.limit_min + 0.5))
 	xAxis.limit_min = double(invisibleCount); // adjust limit of scroll bar
     }
+    first = int(xAxis.limit_min + 0.5);
     
     for(int h = g->numAxes(); h>0;){
 		DataX const *pD = g->axis(--h); // BUG
@@ -204,34 +212,28 @@ int TabDiagram::calcDiagram()
       Str = pD->Var;
       colWidth = checkColumnWidth(Str, metrics, colWidth, x, y2);
       if(colWidth < 0)  goto funcEnd;
-      startWriting = int(xAxis.limit_min + 0.5);  // when to reach visible area
       
       Texts.append(new Text(x-4, y2-2, Str)); // independent variable
       if(pD->count != 0) {
-	y = y2-tHeight-5;
 	counting /= pD->count;   // how many rows to be skipped
-	for(int z1=0; z1<lastCount; z1++) {
-	  px = pD->Points;
-	  for(int z=pD->count; z>0; z--) {
-	    if(startWriting <= 0) { // reached visible area ?
-	      y += tHeight*startWriting;
-	      startWriting = 0;
-	      if(y < tHeight) break;  // no room for more rows ?
-	      Str = misc::StringNum(*px, 'g', g->Precision);
-	      colWidth = checkColumnWidth(Str, metrics, colWidth, x, y);
-	      if(colWidth < 0)  goto funcEnd;
-	      
-	      Texts.append(new Text( x, y, Str));
-	      y -= tHeight*counting;
-	    }
-	    else startWriting -= counting;
-	    px++;
+	if(counting < 1)  counting = 1;
+	// values whose rows start within the visible area
+	for(int b = (first+counting-1) / counting;
+	    (b*counting < first+rows) && (b*counting < NumAll); b++) {
+	  y = top - tHeight*(b*counting - first);
+	  Str = misc::StringNum(pD->Points[b % pD->count], 'g', g->Precision);
+	  colWidth = checkColumnWidth(Str, metrics, colWidth, x, y);
+	  if(colWidth < 0)  goto funcEnd;
+
+	  Texts.append(new Text( x, y, Str));
+	}
+	if(pD == g->axis(0)) {  // separate the sweeps, only paint one time
+	  int n = counting * pD->count;
+	  for(int b = first/n + 1; (b*n < first+rows) && (b*n <= NumAll); b++) {
+	    y = top - tHeight*(b*n - first);
+	    Lines.append(new Line(0, y+1, x2, y+1, QPen(Qt::black,0)));
 	  }
-	  if(pD == g->axis(0))   // only paint one time
-	    if(y >= tHeight) if(y < y2-tHeight-5)
-	      Lines.append(new Line(0, y+1, x2, y+1, QPen(Qt::black,0)));
 	}
-	lastCount *= pD->count;
       }
       x += colWidth+15;
       Lines.append(new Line(x-8, y2, x-8, 0, QPen(Qt::black,0)));
@@ -253,8 +255,6 @@ int TabDiagram::calcDiagram()
     Texts.append(new Text(x, y2-2, Str));  // dependent variable
 
 
-    startWriting = int(xAxis.limit_min + 0.5); // when to reach visible area
-    py = g->cPointsY - 2;
     if(g->axis(0)) {
 
       if (!g->cPointsY) {   // no data points
@@ -267,10 +267,9 @@ int TabDiagram::calcDiagram()
         int z=g->axis(0)->count * g->countY;
         if(z > NumAll)  NumAll = z;
 
-        if(g->Var.right(2) != ".X")
-          for(; z>0; z--) {
-            py += 2;
-            if(startWriting-- > 0) continue; // reached visible area ?
+        if(g->Var.right(2) != ".X") {
+          py = g->cPointsY + 2*first;  // first visible value
+          for(z -= first; z>0; z--) {
             if(y < tHeight) break;           // no room for more rows ?
             switch(g->numMode) {
               case 0: Str = misc::complexRect(*py, *(py+1), g->Precision); break;
@@ -282,16 +281,18 @@ int TabDiagram::calcDiagram()
             if(colWidth < 0)  goto funcEnd;
 
             Texts.append(new Text(x, y, Str));
+            py += 2;
             y -= tHeight;
           }
+        }
 
         else {  // digital data
+          // the strings differ in length, so skip them one by one
           char *pcy = (char*)g->cPointsY;
+          int skip = first;
+          for(; z>0 && skip>0; z--, skip--)
+            pcy += strlen(pcy) + 1;
           for(; z>0; z--) {
-            if(startWriting-- > 0) {  // reached visible area ?
-              pcy += strlen(pcy) + 1;
-              continue;
-            }
             if(y < tHeight) break;           // no room for more rows ?
             Str = QString(pcy);
 
@@ -304,6 +305,7 @@ int TabDiagram::calcDiagram()
           }
         }
 
+        if(z < 0)  z = 0;
         if(z > NumLeft)  NumLeft = z;
       }  // of "if(sameDeps)"
       else {
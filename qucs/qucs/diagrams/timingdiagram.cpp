@@ -25,6 +25,7 @@
 #include "misc.h"
 
 #include <cmath>
+#include <algorithm>
 #include <QPolygon>
 #include <QPainter>
 
@@ -364,8 +365,14 @@ if(!firstGraph->isEmpty()) {
           yLast = 1 + ((tHeight - 6) >> 1);
       }
 
-      z = g->axis(0)->count - z;
-      for( ; z>0; z--) {
+      // runs of equal values are drawn with a single line, the first
+      // one ending after the visible start is bisected
+      int s = z;   // current sample
+      int Count = g->axis(0)->count;
+      std::vector<int>::const_iterator run =
+        std::upper_bound(g->Transitions.begin(), g->Transitions.end(), s);
+      z = Count - z;
+      while(z > 0) {
 
         switch(*pcx) {
           case '0':  // low
@@ -381,8 +388,14 @@ if(!firstGraph->isEmpty()) {
         if(yLast != yNow)
           Lines.append(new Line(x, y-yLast, x, y-yNow, Pen));
         if(x+TimeStepWidth >= x2) break;
-        if((*pcx & 254) == '0')
-          Lines.append(new Line(x, y-yNow, x+TimeStepWidth, y-yNow, Pen));
+        int n = 1;   // number of samples drawn
+        if((*pcx & 254) == '0') {
+          int next = s + 1;
+          if(run != g->Transitions.end())  next = *run;
+          else if(!g->Transitions.empty())  next = Count;
+          while((n < next-s) && (x + (n+1)*TimeStepWidth < x2))  n++;
+          Lines.append(new Line(x, y-yNow, x+n*TimeStepWidth, y-yNow, Pen));
+        }
         else {
           Texts.append(new Text(x+(TimeStepWidth>>1)-3, y, QString(pcx)));
           Lines.append(new Line(x+3, y-1, x+TimeStepWidth-3, y-1, Pen));
@@ -394,8 +407,11 @@ if(!firstGraph->isEmpty()) {
         }
 
         yLast = yNow;
-        x += TimeStepWidth;
-        pcx += 2;
+        x += n*TimeStepWidth;
+        pcx += 2*n;
+        s += n;
+        z -= n;
+        while((run != g->Transitions.end()) && (*run <= s))  ++run;
       }
 
     }
@@ -169,10 +169,10 @@ int TruthDiagram::calcDiagram()
       if(sameDependencies(g, firstGraph)) {
 
         if(g->Var.right(2) != ".X") {  // not a digital variable ?
-          double *pdy = g->cPointsY - 2;
-          for(z = NumAll; z>0; z--) {
+          if(startWriting > NumAll)  startWriting = NumAll;
+          double *pdy = g->cPointsY + 2*(startWriting-1); // jump to visible area
+          for(z = NumAll - startWriting; z>0; z--) {
             pdy += 2;
-            if(startWriting-- > 0) continue; // reached visible area ?
             if(y < tHeight) break;           // no room for more rows ?
             Str = QString::number(sqrt((*pdy)*(*pdy) + (*(pdy+1))*(*(pdy+1))));
 
@@ -194,11 +194,9 @@ int TruthDiagram::calcDiagram()
             goto funcEnd;
           }
 
-          for(z = NumAll; z>0; z--) {
-            if(startWriting-- > 0) {   // reached visible area ?
-              py += counting + 1;
-              continue;
-            }
+          if(startWriting > NumAll)  startWriting = NumAll;
+          py += startWriting * (counting + 1);  // jump to visible area
+          for(z = NumAll - startWriting; z>0; z--) {
             if(y < tHeight) break;    // no room for more rows ?
 
             zi = 0;
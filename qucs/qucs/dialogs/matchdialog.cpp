@@ -38,18 +38,91 @@
 #include <QApplication>
 #include <QClipboard>
 #include <QComboBox>
+#include <QFileDialog>
 #include <QGroupBox>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMessageBox>
+#include <QPainter>
 #include <QPushButton>
 #include <QRadioButton>
+#include <QTreeWidget>
 #include <QVBoxLayout>
+#include <QtConcurrentMap>
+#include <algorithm>
+
+// Plot of the broadband response of a matching network: S11 and S21 in dB
+// over the sweep, the design frequency in the middle.
+class MatchResponsePlot : public QWidget {
+public:
+  MatchResponsePlot(QWidget *parent = 0) : QWidget(parent) {
+    setMinimumSize(300, 150);
+  }
+  void setResponse(const MatchResponse &r) {
+    Response = r;
+    update();
+  }
+
+protected:
+  void paintEvent(QPaintEvent *) {
+    QPainter p(this);
+    p.fillRect(rect(), Qt::white);
+    QRect area = rect().adjusted(35, 8, -10, -20);
+    const int Range = 40; // dB shown below zero
+    for (int dB = 0; dB >= -Range; dB -= 10) {
+      int y = area.top() - dB * area.height() / Range;
+      p.setPen(Qt::lightGray);
+      p.drawLine(area.left(), y, area.right(), y);
+      p.setPen(Qt::black);
+      p.drawText(0, y - 6, 30, 12, Qt::AlignRight | Qt::AlignVCenter,
+                 QString::number(dB));
+    }
+    p.setPen(Qt::lightGray);
+    p.drawLine(area.center().x(), area.top(), area.center().x(),
+               area.bottom());
+    p.setPen(Qt::black);
+    p.drawRect(area);
+
+    int n = Response.freq.size();
+    if (!Response.valid || n < 2)
+      return;
+    int y = area.bottom() + 4;
+    p.drawText(area.left(), y, 80, 14, Qt::AlignLeft,
+               misc::num2str(Response.freq.first(), 3, "Hz"));
+    p.drawText(area.center().x() - 40, y, 80, 14, Qt::AlignHCenter,
+               misc::num2str(Response.freq[n / 2], 3, "Hz"));
+    p.drawText(area.right() - 80, y, 80, 14, Qt::AlignRight,
+               misc::num2str(Response.freq.last(), 3, "Hz"));
+
+    // the frequencies are spaced logarithmically
+    p.setClipRect(area);
+    const QVector<double> *curves[2] = {&Response.S11dB, &Response.S21dB};
+    QColor colors[2] = {Qt::blue, Qt::red};
+    for (int c = 0; c < 2; c++) {
+      QPolygonF line;
+      for (int i = 0; i < n; i++) {
+        double v = std::max(curves[c]->at(i), -2.0 * Range);
+        line << QPointF(area.left() + double(i) * area.width() / (n - 1),
+                        area.top() - v * area.height() / Range);
+      }
+      p.setPen(QPen(colors[c], 2));
+      p.drawPolyline(line);
+    }
+    p.setPen(colors[0]);
+    p.drawText(area.right() - 70, area.top() + 2, 30, 14, Qt::AlignLeft, "S11");
+    p.setPen(colors[1]);
+    p.drawText(area.right() - 35, area.top() + 2, 30, 14, Qt::AlignLeft, "S21");
+  }
+
+private:
+  MatchResponse Response;
+};
 
 MatchDialog::MatchDialog(QWidget *parent) : QDialog(parent) {
   setWindowTitle(tr("Create Matching Circuit"));
   DoubleVal = new QDoubleValidator(this);
+  Quiet = false;
 
   all = new QHBoxLayout(this);
 //  all->setSizeConstraint(QLayout::SetFixedSize);
@@ -393,15 +466,61 @@ MatchDialog::MatchDialog(QWidget *parent) : QDialog(parent) {
   h2->addStretch(5);
   SParLayout->addLayout(h2);
 
+  // The S parameters can be taken from a Touchstone file, its load is also
+  // used for the evaluation of the topologies
+  QHBoxLayout *h9 = new QHBoxLayout();
+  h9->setSpacing(3);
+  h9->addWidget(new QLabel(tr("Touchstone file:")));
+  TouchstoneEdit = new QLineEdit();
+  TouchstoneEdit->setReadOnly(true);
+  h9->addWidget(TouchstoneEdit);
+  QPushButton *buttBrowse = new QPushButton(tr("Browse"));
+  QPushButton *buttClear = new QPushButton(tr("Clear"));
+  h9->addWidget(buttBrowse);
+  h9->addWidget(buttClear);
+  SParLayout->addLayout(h9);
+  connect(buttBrowse, SIGNAL(clicked()), SLOT(slotBrowseTouchstone()));
+  connect(buttClear, SIGNAL(clicked()), TouchstoneEdit, SLOT(clear()));
+  connect(FrequencyEdit, SIGNAL(textChanged(const QString &)),
+          SLOT(slotTouchstoneTargets()));
+  connect(UnitCombo, SIGNAL(activated(int)), SLOT(slotTouchstoneTargets()));
+
+  // ...........................................................
+  // Broadband response of the networks of every topology, evaluated in the
+  // background
+  ResponseBox = new QGroupBox(tr("Broadband Response"));
+  matchFrame->addWidget(ResponseBox);
+  QVBoxLayout *ResponseLayout = new QVBoxLayout();
+  ResponseBox->setLayout(ResponseLayout);
+  CandidateList = new QTreeWidget();
+  CandidateList->setRootIsDecorated(false);
+  CandidateList->setHeaderLabels(QStringList() << tr("Method")
+                                               << tr("S11 at f0")
+                                               << tr("Worst S11")
+                                               << tr("Bandwidth"));
+  ResponseLayout->addWidget(CandidateList);
+  ResponsePlot = new MatchResponsePlot();
+  ResponseLayout->addWidget(ResponsePlot);
+  ResponseBox->setVisible(false);
+  connect(CandidateList,
+          SIGNAL(currentItemChanged(QTreeWidgetItem *, QTreeWidgetItem *)),
+          SLOT(slotSelectCandidate(QTreeWidgetItem *)));
+
+  EvalWatcher = new QFutureWatcher<MatchResponse>(this);
+  connect(EvalWatcher, SIGNAL(finished()), SLOT(slotEvaluated()));
+
   // ...........................................................
   QHBoxLayout *h0 = new QHBoxLayout();
   h0->setSpacing(5);
   matchFrame->addLayout(h0);
   h0->addStretch(5);
+  QPushButton *buttEvaluate = new QPushButton(tr("Evaluate"));
   QPushButton *buttCreate = new QPushButton(tr("Create"));
   QPushButton *buttCancel = new QPushButton(tr("Cancel"));
+  h0->addWidget(buttEvaluate);
   h0->addWidget(buttCreate);
   h0->addWidget(buttCancel);
+  connect(buttEvaluate, SIGNAL(clicked()), SLOT(slotButtEvaluate()));
   connect(buttCreate, SIGNAL(clicked()), SLOT(slotButtCreate()));
   connect(buttCancel, SIGNAL(clicked()), SLOT(reject()));
 
@@ -410,6 +529,8 @@ MatchDialog::MatchDialog(QWidget *parent) : QDialog(parent) {
 }
 
 MatchDialog::~MatchDialog() {
+  EvalWatcher->cancel();
+  EvalWatcher->waitForFinished();
   delete all;
   delete DoubleVal;
 }
@@ -744,6 +865,220 @@ void MatchDialog::slotButtCreate() {
   accept();
 }
 
+// -----------------------------------------------------------------------
+// Is called if the "Evaluate"-button is pressed. The networks of all the
+// topologies are synthesized with the current settings and their broadband
+// responses are computed on worker threads.
+void MatchDialog::slotButtEvaluate() {
+  EvalWatcher->cancel();
+  EvalWatcher->waitForFinished();
+
+  double Z1 = Ref1Edit->text().toDouble(); // Port 1 impedance
+  double Z2 = Ref2Edit->text().toDouble(); // Port 2 impedance
+  double Freq = FrequencyEdit->text().toDouble() *
+                pow(10.0, 3.0 * UnitCombo->currentIndex());
+  if (Freq <= 0.0 || Z1 <= 0.0)
+    return;
+
+  // S matrix
+  double S11real = S11magEdit->text().toDouble();
+  double S11imag = S11degEdit->text().toDouble();
+  double S12real = S12magEdit->text().toDouble();
+  double S12imag = S12degEdit->text().toDouble();
+  double S21real = S21magEdit->text().toDouble();
+  double S21imag = S21degEdit->text().toDouble();
+  double S22real = S22magEdit->text().toDouble();
+  double S22imag = S22degEdit->text().toDouble();
+  if (FormatCombo->currentIndex()) { // are they polar ?
+    p2c(S11real, S11imag);
+    p2c(S12real, S12imag);
+    p2c(S21real, S21imag);
+    p2c(S22real, S22imag);
+  }
+
+  bool BalancedStubs = BalancedCheck->isChecked();
+  bool open_short = OpenRadioButton->isChecked();
+  int order = OrderEdit->text().toInt() + 1;
+  double gamma_MAX = MaxRippleEdit->text().toDouble();
+  bool twoPort = TwoCheck->isChecked();
+
+  // the load (or device) the networks are terminated with
+  QVector<double> freq = MatchEvaluator::sweep(Freq);
+  QSharedPointer<const MatchLoad> load;
+  if (!TouchstoneEdit->text().isEmpty())
+    load = MatchEvaluator::touchstoneLoad(TouchstoneEdit->text(), freq);
+  if (!load || load->twoPort != twoPort) {
+    if (twoPort) {
+      MatchComplex S[4] = {MatchComplex(S11real, S11imag),
+                           MatchComplex(S21real, S21imag),
+                           MatchComplex(S12real, S12imag),
+                           MatchComplex(S22real, S22imag)};
+      load = MatchEvaluator::deviceLoad(S, Z1, freq);
+    } else {
+      double RL = S11real, XL = S11imag;
+      r2z(RL, XL, Z1);
+      load = MatchEvaluator::lumpedLoad(RL, XL, Z1, Freq, freq);
+    }
+  }
+
+  // determinant of S-parameter matrix
+  double DetReal = S11real * S22real - S11imag * S22imag - S12real * S21real +
+                   S12imag * S21imag;
+  double DetImag = S11real * S22imag + S11imag * S22real - S12real * S21imag -
+                   S12imag * S21real;
+
+  Candidates.clear();
+  Quiet = true; // the topologies not possible are just marked as such
+  for (int i = 0; i < TopoCombo->count(); i++) {
+    MatchCandidate c;
+    c.topology = i;
+    c.name = TopoCombo->itemText(i);
+    c.Z1 = Z1;
+    c.Z2 = twoPort ? Z2 : Z1;
+    c.Freq = Freq;
+    c.freq = freq;
+    c.load = load;
+    if (twoPort) {
+      QString InputLadderCode =
+          calcBiMatch(S11real, S11imag, S22real, S22imag, DetReal, DetImag, Z1,
+                      Freq, open_short, gamma_MAX, order, BalancedStubs, i);
+      QString OutputLadderCode =
+          calcBiMatch(S22real, S22imag, S11real, S11imag, DetReal, DetImag, Z2,
+                      Freq, open_short, gamma_MAX, order, BalancedStubs, i);
+      if (!InputLadderCode.isEmpty() && !OutputLadderCode.isEmpty())
+        c.laddercode = InputLadderCode + QString("DEV:0") +
+                       flipLadderCode(OutputLadderCode);
+    } else {
+      c.laddercode = synthesize(i, S11real, S11imag, Z1, Freq, open_short,
+                                order, order - 1, gamma_MAX, BalancedStubs);
+    }
+    Candidates.append(c);
+  }
+  Quiet = false;
+
+  CandidateList->clear();
+  Responses.clear();
+  ResponsePlot->setResponse(MatchResponse());
+  ResponseBox->setVisible(true);
+  EvalWatcher->setFuture(
+      QtConcurrent::mapped(Candidates, MatchEvaluator::evaluate));
+}
+
+// -----------------------------------------------------------------------
+// Is called when the evaluation of the topologies is done. It lists their
+// figures of merit, the current topology is selected.
+void MatchDialog::slotEvaluated() {
+  if (EvalWatcher->isCanceled())
+    return;
+  Responses = EvalWatcher->future().results();
+
+  CandidateList->blockSignals(true);
+  QTreeWidgetItem *current = 0;
+  foreach (const MatchResponse &r, Responses) {
+    QTreeWidgetItem *item = new QTreeWidgetItem(CandidateList);
+    item->setText(0, r.name);
+    item->setData(0, Qt::UserRole, r.topology);
+    if (r.valid) {
+      item->setText(1, QString("%1 dB").arg(r.S11center, 0, 'f', 1));
+      item->setText(2, QString("%1 dB").arg(r.S11worst, 0, 'f', 1));
+      item->setText(3, QString("%1 %").arg(100.0 * r.bandwidth, 0, 'f', 1));
+    } else {
+      item->setText(1, tr("not possible"));
+    }
+    if (r.topology == TopoCombo->currentIndex())
+      current = item;
+  }
+  CandidateList->blockSignals(false);
+  for (int i = 0; i < CandidateList->columnCount(); i++)
+    CandidateList->resizeColumnToContents(i);
+  if (current)
+    CandidateList->setCurrentItem(current);
+}
+
+// -----------------------------------------------------------------------
+// Is called when a topology of the evaluation is selected. It shows its
+// response and makes it the one to be created.
+void MatchDialog::slotSelectCandidate(QTreeWidgetItem *item) {
+  if (!item)
+    return;
+  int topology = item->data(0, Qt::UserRole).toInt();
+  foreach (const MatchResponse &r, Responses)
+    if (r.topology == topology)
+      ResponsePlot->setResponse(r);
+
+  if (TopoCombo->currentIndex() != topology) {
+    bool open_short = OpenRadioButton->isChecked();
+    TopoCombo->setCurrentIndex(topology);
+    slotChangeMode_TopoCombo();
+    OpenRadioButton->setChecked(open_short); // keep the evaluated stubs
+    ShortRadioButton->setChecked(!open_short);
+  }
+}
+
+// -----------------------------------------------------------------------
+// Is called if the "Browse"-button of the Touchstone file is pressed.
+void MatchDialog::slotBrowseTouchstone() {
+  QString s = QFileDialog::getOpenFileName(
+      this, tr("Enter a Touchstone file"), TouchstoneEdit->text(),
+      tr("Touchstone files") + " (*.s1p *.S1P *.s2p *.S2P);;" +
+          tr("Any File") + " (*)");
+  if (s.isEmpty())
+    return;
+  TouchstoneEdit->setText(s);
+  slotTouchstoneTargets();
+}
+
+// -----------------------------------------------------------------------
+// Sets the S parameters to be matched to the ones of the Touchstone file at
+// the design frequency, referred to the port 1 impedance. The file is read
+// once, the interpolated load is taken from the cache of the evaluator.
+void MatchDialog::slotTouchstoneTargets() {
+  QString file = TouchstoneEdit->text();
+  double Freq = FrequencyEdit->text().toDouble() *
+                pow(10.0, 3.0 * UnitCombo->currentIndex());
+  double Z1 = Ref1Edit->text().toDouble();
+  if (file.isEmpty() || Freq <= 0.0 || Z1 <= 0.0)
+    return;
+
+  QVector<double> freq = MatchEvaluator::sweep(Freq);
+  QSharedPointer<const MatchLoad> load =
+      MatchEvaluator::touchstoneLoad(file, freq);
+  if (!load || (!TwoCheck->isEnabled() &&
+                load->twoPort != TwoCheck->isChecked())) {
+    QMessageBox::critical(
+        this, tr("Error"),
+        tr("Cannot read S parameters of the expected number of ports "
+           "from \"%1\"!")
+            .arg(file));
+    TouchstoneEdit->clear();
+    return;
+  }
+  if (TwoCheck->isEnabled())
+    TwoCheck->setChecked(load->twoPort);
+
+  int m = freq.size() / 2; // the design frequency
+  MatchComplex S[4];
+  for (int p = 0; p < (load->twoPort ? 4 : 1); p++)
+    S[p] = load->S[p][m];
+  MatchEvaluator::renormalize(S, load->twoPort, load->Z0, Z1);
+
+  double Real[4], Imag[4];
+  for (int p = 0; p < 4; p++) {
+    Real[p] = S[p].real();
+    Imag[p] = S[p].imag();
+    if (FormatCombo->currentIndex()) // entries in polar format
+      c2p(Real[p], Imag[p]);
+  }
+  setS11LineEdits(Real[0], Imag[0]);
+  if (load->twoPort) {
+    setS21LineEdits(Real[1], Imag[1]);
+    setS12LineEdits(Real[2], Imag[2]);
+    setS22LineEdits(Real[3], Imag[3]);
+  } else {
+    slotReflexionChanged(""); // calculate impedance
+  }
+}
+
 // -----------------------------------------------------------------------
 // transform real/imag into mag/deg (cartesian to polar)
 void MatchDialog::c2p(double &Real, double &Imag) {
@@ -785,10 +1120,11 @@ QString MatchDialog::calcMatchingLC(double r_real, double r_imag, double Z0,
 
   if (Zreal < 0.0) {
     if (Zreal < -1e-13) {
-      QMessageBox::critical(
-          0, tr("Error"),
-          tr("Real part of impedance must be greater zero,\nbut is %1 !")
-              .arg(Zreal));
+      if (!Quiet)
+        QMessageBox::critical(
+            0, tr("Error"),
+            tr("Real part of impedance must be greater zero,\nbut is %1 !")
+                .arg(Zreal));
       return QString(""); // matching not possible
     }
 
@@ -844,44 +1180,58 @@ QString MatchDialog::calcMatchingLC(double r_real, double r_imag, double Z0,
 }
 
 // -----------------------------------------------------------------------
-// This function calls the specific matching network function so as to get the
-// desired matching topology Returns true if the synthesis worked as expected or
-// false if it wasn't
-bool MatchDialog::calcMatchingCircuit(double S11real, double S11imag, double Z0,
-                                      double Freq, bool micro_syn,
-                                      bool SP_Block, bool open_short,
-                                      tSubstrate Substrate, int order,
-                                      double gamma_MAX, bool BalancedStubs) {
+// This function calls the specific matching network function of the given
+// topology and returns its circuit description code. The cascaded LC
+// sections are given their number separately.
+QString MatchDialog::synthesize(int topology, double r_real, double r_imag,
+                                double Z0, double Freq, bool open_short,
+                                int order, int sections, double gamma_MAX,
+                                bool BalancedStubs) {
   QString laddercode;
-  switch (TopoCombo->currentIndex()) {
+  switch (topology) {
   case 0: // LC
-    laddercode = calcMatchingLC(S11real, S11imag, Z0,
+    laddercode = calcMatchingLC(r_real, r_imag, Z0,
                                 Freq); // It calculates the LC matching circuit.
     break;
   case 1: // Single stub
     laddercode =
-        calcSingleStub(S11real, S11imag, Z0, Freq, open_short, BalancedStubs);
+        calcSingleStub(r_real, r_imag, Z0, Freq, open_short, BalancedStubs);
     break;
   case 2: // Double stub
     laddercode =
-        calcDoubleStub(S11real, S11imag, Z0, Freq, open_short, BalancedStubs);
+        calcDoubleStub(r_real, r_imag, Z0, Freq, open_short, BalancedStubs);
     break;
   case 3: // Quarter wave cascaded sections
     (BinRadio->isChecked())
-        ? laddercode = calcBinomialLines(S11real, S11imag, Z0, order, Freq)
+        ? laddercode = calcBinomialLines(r_real, r_imag, Z0, order, Freq)
         : laddercode =
-              calcChebyLines(S11real, S11imag, Z0, gamma_MAX, order, Freq);
+              calcChebyLines(r_real, r_imag, Z0, gamma_MAX, order, Freq);
     break;
   case 4: // Cascaded LC sections
     laddercode =
-        calcMatchingCascadedLCSections(S11real, S11imag, Z0, Freq, order - 1);
+        calcMatchingCascadedLCSections(r_real, r_imag, Z0, Freq, sections);
     break;
   case 5: // Lambda/8 + Lambda/4 impedance transformer
           // Reference: Inder J. Bahl. "Fundamentals of RF and microwave
           // transistor amplifiers". John Wiley and Sons. 2009. Pages 159-160
-    laddercode = calcMatchingLambda8Lambda4(S11real, S11imag, Z0, Freq);
+    laddercode = calcMatchingLambda8Lambda4(r_real, r_imag, Z0, Freq);
     break;
   }
+  return laddercode;
+}
+
+// -----------------------------------------------------------------------
+// This function calls the specific matching network function so as to get the
+// desired matching topology Returns true if the synthesis worked as expected or
+// false if it wasn't
+bool MatchDialog::calcMatchingCircuit(double S11real, double S11imag, double Z0,
+                                      double Freq, bool micro_syn,
+                                      bool SP_Block, bool open_short,
+                                      tSubstrate Substrate, int order,
+                                      double gamma_MAX, bool BalancedStubs) {
+  QString laddercode =
+      synthesize(TopoCombo->currentIndex(), S11real, S11imag, Z0, Freq,
+                 open_short, order, order - 1, gamma_MAX, BalancedStubs);
 
   if (laddercode.isEmpty())
     return false;
@@ -913,7 +1263,7 @@ QString MatchDialog::calcBiMatch(double S11real, double S11imag, double S22real,
                                  double S22imag, double DetReal, double DetImag,
                                  double Z0, double Freq, bool open_short,
                                  double gamma_MAX, int order,
-                                 bool BalancedStubs) {
+                                 bool BalancedStubs, int topology) {
   double B = 1.0 + S11real * S11real + S11imag * S11imag - S22real * S22real -
              S22imag * S22imag - DetReal * DetReal - DetImag * DetImag;
   double Creal = S11real - S22real * DetReal - S22imag * DetImag;
@@ -933,38 +1283,10 @@ QString MatchDialog::calcBiMatch(double S11real, double S11imag, double S22real,
     Rreal *= Creal;
   }
 
-  QString laddercode;
-
-  switch (TopoCombo->currentIndex()) // Matches both the input and the output
-                                     // port to external sources (typically, 50
-                                     // Ohms)
-  {
-  case 0: // LC
-    laddercode = calcMatchingLC(Rreal, -Rimag, Z0, Freq);
-    break;
-  case 1: // Single stub
-    laddercode =
-        calcSingleStub(Rreal, -Rimag, Z0, Freq, open_short, BalancedStubs);
-    break;
-  case 2: // Double stub
-    laddercode =
-        calcDoubleStub(Rreal, -Rimag, Z0, Freq, open_short, BalancedStubs);
-    break;
-  case 3: // Quarter wave cascaded sections
-    (BinRadio->isChecked())
-        ? laddercode = calcBinomialLines(Rreal, -Rimag, Z0, order, Freq)
-        : laddercode =
-              calcChebyLines(Rreal, -Rimag, Z0, gamma_MAX, order, Freq);
-    break;
-  case 4: // Cascaded LC sections
-    laddercode = calcMatchingCascadedLCSections(Rreal, -Rimag, Z0, Freq, order);
-    break;
-  case 5: // Lambda/8 + Lambda/4 transformer
-    laddercode = calcMatchingLambda8Lambda4(Rreal, -Rimag, Z0, Freq);
-    break;
-  }
-
-  return laddercode;
+  // Matches both the input and the output port to external sources
+  // (typically, 50 Ohms)
+  return synthesize(topology, Rreal, -Rimag, Z0, Freq, open_short, order,
+                    order, gamma_MAX, BalancedStubs);
 }
 
 // -----------------------------------------------------------------------
@@ -981,14 +1303,16 @@ bool MatchDialog::calc2PortMatch(double S11real, double S11imag, double S22real,
   // The result is a string which gives the structure of the matching network
   QString InputLadderCode =
       calcBiMatch(S11real, S11imag, S22real, S22imag, DetReal, DetImag, Z1,
-                  Freq, open_short, gamma_MAX, order, BalancedStubs);
+                  Freq, open_short, gamma_MAX, order, BalancedStubs,
+                  TopoCombo->currentIndex());
   if (InputLadderCode.isEmpty())
     return false; // Synthesis error
 
   // Output port network
   QString OutputLadderCode =
       calcBiMatch(S22real, S22imag, S11real, S11imag, DetReal, DetImag, Z2,
-                  Freq, open_short, gamma_MAX, order, BalancedStubs);
+                  Freq, open_short, gamma_MAX, order, BalancedStubs,
+                  TopoCombo->currentIndex());
   if (OutputLadderCode.isEmpty())
     return false; // Synthesis error
   else
@@ -1275,8 +1599,9 @@ QString MatchDialog::calcDoubleStub(double r_real, double r_imag, double Z0,
   {
     QString str = QString(
         "It is not possible to match this load using the double stub method");
-    QMessageBox::warning(0, QObject::trUtf8("Error"),
-                         QObject::trUtf8(str.toUtf8()));
+    if (!Quiet)
+      QMessageBox::warning(0, QObject::trUtf8("Error"),
+                           QObject::trUtf8(str.toUtf8()));
     return QString("");
   }
 
@@ -1369,16 +1694,18 @@ QString MatchDialog::calcBinomialLines(double r_real, double r_imag, double Z0,
   double RL = r_real, XL = r_imag;
   r2z(RL, XL, Z0);
   if (RL == 0) {
-    QMessageBox::warning(
-        0, QObject::tr("Error"),
-        QObject::tr("The load has not resistive part. It cannot be matched "
-                    "using the quarter wavelength method"));
+    if (!Quiet)
+      QMessageBox::warning(
+          0, QObject::tr("Error"),
+          QObject::tr("The load has not resistive part. It cannot be matched "
+                      "using the quarter wavelength method"));
     return NULL;
   }
   if (XL != 0) {
-    QMessageBox::warning(0, QObject::tr("Warning"),
-                         QObject::tr("Reactive loads cannot be matched. Only "
-                                     "the real part will be matched"));
+    if (!Quiet)
+      QMessageBox::warning(0, QObject::tr("Warning"),
+                           QObject::tr("Reactive loads cannot be matched. Only "
+                                       "the real part will be matched"));
   }
   double l4 = SPEED_OF_LIGHT / (4. * Freq);
   double Ci, Zi, Zaux = Z0;
@@ -1403,9 +1730,10 @@ QString MatchDialog::calcChebyLines(double r_real, double r_imag, double Z0,
              // sections. Probably, it makes no sense to use a higher number of
              // sections because of the losses
   {
-    QMessageBox::warning(
-        0, QObject::tr("Error"),
-        QObject::tr("Chebyshev weighting for N>7 is not available"));
+    if (!Quiet)
+      QMessageBox::warning(
+          0, QObject::tr("Error"),
+          QObject::tr("Chebyshev weighting for N>7 is not available"));
     return QString("");
   }
   QString laddercode;
@@ -1499,16 +1827,18 @@ QString MatchDialog::calcMatchingCascadedLCSections(double r_real,
   QString s = "";
 
   if (RL == 0) {
-    QMessageBox::warning(
-        0, QObject::tr("Error"),
-        QObject::tr("The load is reactive. It cannot be matched "
-                    "using the quarter wavelength method"));
+    if (!Quiet)
+      QMessageBox::warning(
+          0, QObject::tr("Error"),
+          QObject::tr("The load is reactive. It cannot be matched "
+                      "using the quarter wavelength method"));
     return NULL;
   }
   if (XL != 0) {
-    QMessageBox::warning(0, QObject::tr("Warning"),
-                         QObject::tr("Reactive loads cannot be matched. Only "
-                                     "the real part will be matched"));
+    if (!Quiet)
+      QMessageBox::warning(0, QObject::tr("Warning"),
+                           QObject::tr("Reactive loads cannot be matched. Only "
+                                       "the real part will be matched"));
   }
 
   if (RL > RS)//The design equations were tailored for the RS > RL case. In case of RL > RS, the ports impedance are swapped
@@ -31,8 +31,12 @@
 #include <QCheckBox>
 #include <QDebug>
 #include <QDialog>
+#include <QFutureWatcher>
+#include <QList>
 #include <cmath>
 
+#include "matchevaluator.h"
+
 class Element;
 class QLabel;
 class QLineEdit;
@@ -42,6 +46,9 @@ class QRadioButton;
 class QHBoxLayout;
 class QVBoxLayout;
 class QDoubleValidator;
+class QTreeWidget;
+class QTreeWidgetItem;
+class MatchResponsePlot;
 
 struct tSubstrate {
   double er;
@@ -94,6 +101,8 @@ public:
   //-------------------------------------------------------------------------------------------------------
   // These functions calculate the specified matching network and and generate
   // the circuit description code
+  QString synthesize(int, double, double, double, double, bool, int, int,
+                     double, bool);
   QString calcMatchingLC(double, double, double, double);
   QString calcMatchingCascadedLCSections(double, double, double, double, int);
   QString calcSingleStub(double, double, double, double, bool, bool);
@@ -104,7 +113,7 @@ public:
   //--------------------------------------------------------------------------------------------------------
 
   QString calcBiMatch(double, double, double, double, double, double, double,
-                      double, bool, double, int, bool);
+                      double, bool, double, int, bool, int);
   bool calc2PortMatch(double, double, double, double, double, double, double,
                       double, double, bool, bool, bool, tSubstrate, int, double,
                       bool);
@@ -122,6 +131,11 @@ public:
 
 public slots:
   void slotButtCreate();
+  void slotButtEvaluate();
+  void slotEvaluated();
+  void slotSelectCandidate(QTreeWidgetItem *);
+  void slotBrowseTouchstone();
+  void slotTouchstoneTargets();
   void slotImpedanceChanged(const QString &);
   void slotReflexionChanged(const QString &);
   void slotSetTwoPort(bool);
@@ -156,6 +170,16 @@ private:
   QRadioButton *OpenRadioButton, *ShortRadioButton, *BinRadio, *ChebyRadio;
   QGroupBox *SubstrateBox, *Weighting_groupBox, *MethodBox;
 
+  // targets read from a Touchstone file and evaluation of the topologies
+  QLineEdit *TouchstoneEdit;
+  QGroupBox *ResponseBox;
+  QTreeWidget *CandidateList;
+  MatchResponsePlot *ResponsePlot;
+  QFutureWatcher<MatchResponse> *EvalWatcher;
+  QList<MatchCandidate> Candidates;
+  QList<MatchResponse> Responses;
+  bool Quiet; // no message boxes while synthesizing the candidates
+
   double tmpS21mag, tmpS21deg;
 
   void set2PortWidgetsVisible(bool);
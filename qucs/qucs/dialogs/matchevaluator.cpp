@@ -0,0 +1,388 @@
+/***************************************************************************
+                             matchevaluator.cpp
+                            --------------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "matchevaluator.h"
+#include "matchdialog.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegExp>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double Pi = 3.14159265358979323846;
+
+// S-parameters of a Touchstone file as read.
+struct Touchstone {
+  int ports;
+  double Z0;
+  QVector<double> freq;
+  QVector<MatchComplex> S[4];
+};
+
+// maximum number of Touchstone files kept in memory
+const int CacheSize = 4;
+
+struct CacheEntry {
+  QDateTime modified;
+  qint64 size;
+  QSharedPointer<const Touchstone> data;
+  QVector<double> freq;                 // sweep of the interpolated load
+  QSharedPointer<const MatchLoad> load;
+};
+
+QMutex CacheMutex;
+QHash<QString, CacheEntry> Cache;
+QStringList CacheOrder; // least recently used first
+
+// Element of the ladder code: tag and up to two values.
+struct LadderElement {
+  QString tag;
+  double value, value2;
+};
+
+// Chain (ABCD) matrix of the cascaded elements.
+struct Chain {
+  MatchComplex A, B, C, D;
+  Chain() : A(1), B(0), C(0), D(1) {}
+  void cascade(MatchComplex a, MatchComplex b, MatchComplex c,
+               MatchComplex d) {
+    MatchComplex A_ = A * a + B * c, B_ = A * b + B * d;
+    MatchComplex C_ = C * a + D * c, D_ = C * b + D * d;
+    A = A_, B = B_, C = C_, D = D_;
+  }
+  void series(MatchComplex Z) { cascade(1.0, Z, 0.0, 1.0); }
+  void shunt(MatchComplex Y) { cascade(1.0, 0.0, Y, 1.0); }
+  void line(double Z, double theta) {
+    const MatchComplex j(0, 1);
+    cascade(cos(theta), j * Z * sin(theta), j * sin(theta) / Z, cos(theta));
+  }
+  // two-port given by its S-parameters
+  void device(MatchComplex S11, MatchComplex S21, MatchComplex S12,
+              MatchComplex S22, double Z0) {
+    MatchComplex d = 2.0 * S21, s = S12 * S21;
+    cascade(((1.0 + S11) * (1.0 - S22) + s) / d,
+            Z0 * ((1.0 + S11) * (1.0 + S22) - s) / d,
+            ((1.0 - S11) * (1.0 - S22) - s) / d / Z0,
+            ((1.0 - S11) * (1.0 + S22) + s) / d);
+  }
+};
+
+double dB(MatchComplex z) { return 20.0 * log10(std::max(std::abs(z), 1e-15)); }
+
+// Returns the value pair of the given Touchstone data format.
+MatchComplex toComplex(double a, double b, const QString &format) {
+  if (format == "RI")
+    return MatchComplex(a, b);
+  if (format == "DB")
+    a = pow(10.0, a / 20.0);
+  return std::polar(a, b * Pi / 180.0);
+}
+
+// Reads the S-parameters of an one- or two-port Touchstone file, noise
+// parameters following the S-parameters are ignored.
+QSharedPointer<const Touchstone> readTouchstone(const QString &fileName) {
+  QString suffix = QFileInfo(fileName).suffix().toLower();
+  int ports = suffix == "s1p" ? 1 : suffix == "s2p" ? 2 : 0;
+  QFile File(fileName);
+  if (!ports || !File.open(QIODevice::ReadOnly))
+    return QSharedPointer<const Touchstone>();
+
+  QSharedPointer<Touchstone> t(new Touchstone);
+  t->ports = ports;
+  t->Z0 = 50.0;
+  double unit = 1e9;
+  QString format = "MA";
+  int columns = 1 + 2 * ports * ports;
+  QVector<double> row;
+  bool noise = false;
+
+  QTextStream Stream(&File);
+  while (!Stream.atEnd() && !noise) {
+    QString Line = Stream.readLine();
+    int comment = Line.indexOf('!');
+    if (comment >= 0)
+      Line.truncate(comment);
+    Line = Line.trimmed();
+    if (Line.isEmpty())
+      continue;
+    if (Line.startsWith('#')) { // option line
+      QStringList opts = Line.mid(1).toUpper().split(
+          QRegExp("\\s+"), QString::SkipEmptyParts);
+      for (int i = 0; i < opts.size(); i++) {
+        const QString &o = opts.at(i);
+        if (o == "HZ")
+          unit = 1;
+        else if (o == "KHZ")
+          unit = 1e3;
+        else if (o == "MHZ")
+          unit = 1e6;
+        else if (o == "GHZ")
+          unit = 1e9;
+        else if (o == "MA" || o == "DB" || o == "RI")
+          format = o;
+        else if (o == "R" && i + 1 < opts.size())
+          t->Z0 = opts.at(++i).toDouble();
+        else if (o == "Y" || o == "Z" || o == "G" || o == "H")
+          return QSharedPointer<const Touchstone>(); // S-parameters only
+      }
+      continue;
+    }
+    QStringList values = Line.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+    for (int i = 0; i < values.size() && !noise; i++) {
+      bool ok;
+      double x = values.at(i).toDouble(&ok);
+      if (!ok)
+        return QSharedPointer<const Touchstone>();
+      // the noise parameters start again at a lower frequency
+      if (row.isEmpty() && !t->freq.isEmpty() && x * unit <= t->freq.last()) {
+        noise = true;
+        break;
+      }
+      row.append(x);
+      if (row.size() < columns)
+        continue;
+      t->freq.append(row.at(0) * unit);
+      for (int k = 0; k < ports * ports; k++)
+        t->S[k].append(toComplex(row.at(1 + 2 * k), row.at(2 + 2 * k), format));
+      row.clear();
+    }
+  }
+  if (t->freq.isEmpty())
+    return QSharedPointer<const Touchstone>();
+  return t;
+}
+
+// Interpolates the S-parameters linearly to the given frequencies, they
+// are kept constant outside of the frequency range of the file.
+QSharedPointer<const MatchLoad> interpolate(const Touchstone &t,
+                                            const QVector<double> &freq) {
+  QSharedPointer<MatchLoad> load(new MatchLoad);
+  load->twoPort = t.ports == 2;
+  load->Z0 = t.Z0;
+  int n = t.freq.size();
+  for (int i = 0; i < freq.size(); i++) {
+    int k = std::lower_bound(t.freq.constBegin(), t.freq.constEnd(), freq[i]) -
+            t.freq.constBegin();
+    int a = std::max(0, std::min(k - 1, n - 1)), b = std::min(k, n - 1);
+    double s = 0;
+    if (a != b)
+      s = std::max(0.0, std::min(1.0, (freq[i] - t.freq[a]) /
+                                          (t.freq[b] - t.freq[a])));
+    for (int p = 0; p < t.ports * t.ports; p++)
+      load->S[p].append(t.S[p][a] + s * (t.S[p][b] - t.S[p][a]));
+  }
+  return load;
+}
+
+} // namespace
+
+// --------------------------------------------------------------------------
+// Returns the frequencies of the sweep, logarithmically spaced from one
+// octave below to one octave above the design frequency which is the
+// one in the middle.
+QVector<double> MatchEvaluator::sweep(double Freq, int points) {
+  points = std::max(points | 1, 3);
+  QVector<double> freq(points);
+  for (int i = 0; i < points; i++)
+    freq[i] = Freq * pow(2.0, 2.0 * i / (points - 1) - 1.0);
+  return freq;
+}
+
+// --------------------------------------------------------------------------
+// Returns the load the schematic is created with: the given impedance
+// at the design frequency as resistor in series with an inductor or a
+// capacitor.
+QSharedPointer<const MatchLoad>
+MatchEvaluator::lumpedLoad(double RL, double XL, double Z0, double Freq,
+                           const QVector<double> &freq) {
+  QSharedPointer<MatchLoad> load(new MatchLoad);
+  load->twoPort = false;
+  load->Z0 = Z0;
+  for (int i = 0; i < freq.size(); i++) {
+    double X = XL > 0 ? XL * freq[i] / Freq : XL * Freq / freq[i];
+    MatchComplex ZL(RL, X);
+    load->S[0].append((ZL - Z0) / (ZL + Z0));
+  }
+  return load;
+}
+
+// --------------------------------------------------------------------------
+// Returns the device given by its S-parameters at the design frequency,
+// these are taken for the whole sweep.
+QSharedPointer<const MatchLoad>
+MatchEvaluator::deviceLoad(const MatchComplex S[4], double Z0,
+                           const QVector<double> &freq) {
+  QSharedPointer<MatchLoad> load(new MatchLoad);
+  load->twoPort = true;
+  load->Z0 = Z0;
+  for (int p = 0; p < 4; p++)
+    load->S[p].fill(S[p], freq.size());
+  return load;
+}
+
+// --------------------------------------------------------------------------
+// Converts the S-parameters from the reference impedance Z0 to Z, those
+// of a two-port by way of its chain matrix.
+void MatchEvaluator::renormalize(MatchComplex S[4], bool twoPort, double Z0,
+                                 double Z) {
+  if (!twoPort) {
+    if (std::abs(1.0 - S[0]) > 1e-12) {
+      MatchComplex ZL = Z0 * (1.0 + S[0]) / (1.0 - S[0]);
+      S[0] = (ZL - Z) / (ZL + Z);
+    }
+    return;
+  }
+  Chain M;
+  M.device(S[0], S[1], S[2], S[3], Z0);
+  MatchComplex d = M.A + M.B / Z + M.C * Z + M.D;
+  S[0] = (M.A + M.B / Z - M.C * Z - M.D) / d;
+  S[1] = 2.0 / d;
+  S[2] = 2.0 * (M.A * M.D - M.B * M.C) / d;
+  S[3] = (-M.A + M.B / Z - M.C * Z + M.D) / d;
+}
+
+// --------------------------------------------------------------------------
+// Returns the load or device of the Touchstone file interpolated to the
+// given frequencies, or a null pointer if the file cannot be read.  The
+// file is read and interpolated again only if it has changed.
+QSharedPointer<const MatchLoad>
+MatchEvaluator::touchstoneLoad(const QString &fileName,
+                               const QVector<double> &freq) {
+  QFileInfo Info(fileName);
+  QString Key = Info.absoluteFilePath();
+  QDateTime modified = Info.lastModified();
+  qint64 size = Info.size();
+
+  QMutexLocker Lock(&CacheMutex);
+  CacheOrder.removeOne(Key);
+  CacheOrder.append(Key);
+
+  QHash<QString, CacheEntry>::iterator it = Cache.find(Key);
+  if (it == Cache.end() || it->modified != modified || it->size != size) {
+    CacheEntry e;
+    e.modified = modified;
+    e.size = size;
+    e.data = readTouchstone(fileName);
+    it = Cache.insert(Key, e);
+  }
+  if (it->data && (!it->load || it->freq != freq)) {
+    it->freq = freq;
+    it->load = interpolate(*it->data, freq);
+  }
+  QSharedPointer<const MatchLoad> load = it->load;
+
+  while (CacheOrder.size() > CacheSize)
+    Cache.remove(CacheOrder.takeFirst());
+  return load;
+}
+
+// --------------------------------------------------------------------------
+// Cascades the elements of the ladder code at each frequency of the
+// sweep and returns the reflection at port 1 and the transmission into
+// the load (port 2).  Transmission lines are ideal ones with the speed
+// of light the synthesis is done with.
+MatchResponse MatchEvaluator::evaluate(const MatchCandidate &c) {
+  MatchResponse r;
+  r.topology = c.topology;
+  r.name = c.name;
+  r.freq = c.freq;
+  if (!c.load || c.laddercode.isEmpty() || c.freq.isEmpty())
+    return r;
+
+  QVector<LadderElement> elements;
+  QStringList tokens = c.laddercode.split(";", QString::SkipEmptyParts);
+  foreach (const QString &token, tokens) {
+    LadderElement e;
+    int colon = token.indexOf(":");
+    e.tag = token.mid(0, colon);
+    QStringList values = token.mid(colon + 1).split("#");
+    e.value = values.at(0).toDouble();
+    e.value2 = values.size() > 1 ? values.at(1).toDouble() : 0;
+    if (e.tag == "DEV" && !c.load->twoPort)
+      return r;
+    elements.append(e);
+  }
+
+  const MatchComplex j(0, 1);
+  int n = c.freq.size();
+  r.S11dB.resize(n);
+  r.S21dB.resize(n);
+  for (int k = 0; k < n; k++) {
+    double w = 2 * Pi * c.freq[k], beta = w / SPEED_OF_LIGHT;
+    Chain M;
+    foreach (const LadderElement &e, elements) {
+      if (e.tag == "LS")
+        M.series(j * w * e.value);
+      else if (e.tag == "CS")
+        M.series(1.0 / (j * w * e.value));
+      else if (e.tag == "LP")
+        M.shunt(1.0 / (j * w * e.value));
+      else if (e.tag == "CP")
+        M.shunt(j * w * e.value);
+      else if (e.tag == "TL")
+        M.line(e.value, beta * e.value2);
+      else if (e.tag == "OU" || e.tag == "OL") // open stub
+        M.shunt(j * tan(beta * e.value2) / e.value);
+      else if (e.tag == "SU" || e.tag == "SL") // short circuited stub
+        M.shunt(1.0 / (j * e.value * tan(beta * e.value2)));
+      else if (e.tag == "DEV")
+        M.device(c.load->S[0][k], c.load->S[1][k], c.load->S[2][k],
+                 c.load->S[3][k], c.load->Z0);
+    }
+
+    double Zs = c.Z1;
+    MatchComplex ZL = c.Z2;
+    if (!c.load->twoPort) {
+      MatchComplex S = c.load->S[0][k];
+      ZL = std::abs(1.0 - S) > 1e-12 ? c.load->Z0 * (1.0 + S) / (1.0 - S)
+                                     : MatchComplex(1e12);
+    }
+    MatchComplex V = M.A * ZL + M.B, I = M.C * ZL + M.D;
+    MatchComplex S11 = (V - Zs * I) / (V + Zs * I);
+    MatchComplex S21 = 2.0 * sqrt(Zs * std::max(ZL.real(), 0.0)) / (V + Zs * I);
+    r.S11dB[k] = dB(S11);
+    r.S21dB[k] = dB(S21);
+    if (!std::isfinite(r.S11dB[k]) || !std::isfinite(r.S21dB[k]))
+      return r;
+  }
+
+  int m = n / 2;
+  r.S11center = r.S11dB[m];
+  r.S11worst = *std::max_element(r.S11dB.constBegin(), r.S11dB.constEnd());
+  if (r.S11center <= -10.0) {
+    int lo = m, hi = m;
+    while (lo > 0 && r.S11dB[lo - 1] <= -10.0)
+      lo--;
+    while (hi < n - 1 && r.S11dB[hi + 1] <= -10.0)
+      hi++;
+    r.bandwidth = (c.freq[hi] - c.freq[lo]) / c.Freq;
+  }
+  r.valid = true;
+  return r;
+}
@@ -0,0 +1,95 @@
+/***************************************************************************
+                              matchevaluator.h
+                             ------------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef MATCHEVALUATOR_H
+#define MATCHEVALUATOR_H
+
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include <complex>
+
+typedef std::complex<double> MatchComplex;
+
+/*!
+ * S-parameters of the load (one-port) or of the device (two-port) to
+ * be matched, sampled at the frequencies of the sweep.  The samples
+ * are read-only once created and thus shared by the evaluations
+ * running in parallel.
+ */
+struct MatchLoad {
+  bool twoPort;
+  double Z0;                    // reference impedance of the S-parameters
+  QVector<MatchComplex> S[4];   // S11, S21, S12, S22 (S11 only if one-port)
+};
+
+/*!
+ * A matching network to be evaluated: the ladder code of the
+ * synthesis (see MatchDialog::SchematicParser) between port 1 and the
+ * load, or of both networks with the device ("DEV") in between.
+ */
+struct MatchCandidate {
+  int topology;
+  QString name;
+  QString laddercode;
+  double Z1, Z2;                // port impedances
+  double Freq;                  // design frequency
+  QVector<double> freq;         // frequencies of the sweep
+  QSharedPointer<const MatchLoad> load;
+};
+
+//! Broadband response of a matching network.
+struct MatchResponse {
+  int topology;
+  QString name;
+  bool valid;
+  QVector<double> freq;
+  QVector<double> S11dB, S21dB;
+  double S11center;             // at the design frequency
+  double S11worst;              // largest reflection of the sweep
+  double bandwidth;             // relative bandwidth of S11 < -10 dB
+  MatchResponse()
+      : topology(-1), valid(false), S11center(0), S11worst(0), bandwidth(0) {}
+};
+
+/*!
+ * In-process evaluation of the synthesized matching networks.
+ *
+ * The ladder is cascaded as chain (ABCD) matrices of ideal lumped
+ * elements and TEM lines, terminated by the load or, for two-port
+ * matching, by the device and port 2.  There is no netlist and no
+ * simulator involved, so the candidates of all topologies are
+ * evaluated at once on worker threads.  Loads read from Touchstone
+ * files are interpolated to the sweep once and kept in a cache keyed
+ * by file name and sweep, which is invalidated as soon as the
+ * modification time or the size of the file changes.
+ */
+class MatchEvaluator {
+public:
+  static QVector<double> sweep(double Freq, int points = 201);
+  static QSharedPointer<const MatchLoad>
+  lumpedLoad(double RL, double XL, double Z0, double Freq,
+             const QVector<double> &freq);
+  static QSharedPointer<const MatchLoad>
+  deviceLoad(const MatchComplex S[4], double Z0, const QVector<double> &freq);
+  static void renormalize(MatchComplex S[4], bool twoPort, double Z0,
+                          double Z);
+  static QSharedPointer<const MatchLoad>
+  touchstoneLoad(const QString &fileName, const QVector<double> &freq);
+  static MatchResponse evaluate(const MatchCandidate &);
+};
+
+#endif
@@ -40,6 +40,8 @@ using namespace std;
 #include <QMessageBox>
 
 #include "simmessage.h"
+#include "simqueue.h"
+#include "diagrams/datasetindex.h"
 #include "module.h"
 #include "qucs.h"
 #include "textdoc.h"
@@ -75,6 +77,17 @@ SimMessage::SimMessage(QWidget *w, QWidget *parent)
   SimOpenDpl = Doc->SimOpenDpl; // ...could be closed during the simulation.
   SimRunScript = Doc->SimRunScript;
 
+  // own netlist and results, as several simulations may run at once
+  Id = SimQueue::nextId();
+  Priority = (showBias == 0) ? 1 : 0;  // dc bias is waited for
+  Exclusive = false;
+  NetlistName = QucsSettings.QucsHomeDir.filePath(
+                  QString("netlist%1.txt").arg(Id));
+  ResultName = DataSet + QString(".%1.tmp").arg(Id);
+  LastState = QProcess::NotRunning;
+  Live = false;
+  connect(&LiveTimer, SIGNAL(timeout()), SLOT(slotLiveResults()));
+
   all = new QVBoxLayout(this);
   all->setSpacing(5);
   all->setMargin(5);
@@ -137,7 +150,10 @@ SimMessage::SimMessage(QWidget *w, QWidget *parent)
  */
 SimMessage::~SimMessage()
 {
+  SimQueue::remove(this);
   if(SimProcess.state()==QProcess::Running)  SimProcess.kill();
+  QFile::remove(NetlistName);
+  QFile::remove(ResultName);
   delete all;
 }
 
@@ -163,7 +179,7 @@ bool SimMessage::startProcess()
 
   Collect.clear();  // clear list for NodeSets, SPICE components etc.
   ProgText->appendPlainText(tr("creating netlist... "));
-  NetlistFile.setFileName(QucsSettings.QucsHomeDir.filePath("netlist.txt"));
+  NetlistFile.setFileName(NetlistName);
    if(!NetlistFile.open(QIODevice::WriteOnly)) {
     ErrText->appendPlainText(tr("ERROR: Cannot write netlist file!"));
     FinishSimulation(-1);
@@ -361,6 +377,7 @@ void SimMessage::startSimulator()
   if(QucsApp::isTextDocument(DocWidget)) {
 
     TextDoc * Doc = (TextDoc*)DocWidget;
+    Exclusive = true;  // VHDL work directory
 
     // Take VHDL file in memory as it could contain unsaved changes.
     Stream << Doc->toPlainText();
@@ -390,8 +407,8 @@ void SimMessage::startSimulator()
       }
 #endif
       Program = pathName(QucsSettings.BinDir + QucsDigi);
-      Arguments  << QucsSettings.QucsHomeDir.filePath("netlist.txt")
-                 << DataSet << SimTime << pathName(SimPath)
+      Arguments  << NetlistName
+                 << ResultName << SimTime << pathName(SimPath)
                  << pathName(QucsSettings.BinDir) << libs;
     }
     // Module.
@@ -427,7 +444,7 @@ void SimMessage::startSimulator()
       destFile.write(text.toAscii(), text.length());
       destFile.close();
       Program = pathName(QucsSettings.BinDir + QucsDigiLib);
-      Arguments << QucsSettings.QucsHomeDir.filePath("netlist.txt")
+      Arguments << NetlistName
                 << pathName(SimPath)
                 << entity
                 << lib;
@@ -522,29 +539,26 @@ void SimMessage::startSimulator()
           }
       } // vaComponents not empty
 
-      if((SimOpt = findOptimization((Schematic*)DocWidget))) {
-	    ((Optimize_Sim*)SimOpt)->createASCOnetlist();
-
-        Program = QucsSettings.AscoBinDir.canonicalPath();
-        Program = QDir::toNativeSeparators(Program+"/"+"asco"+QString(executableSuffix));
-        // pass full path of simulator to ASCO so it does not be to be in PATH
-        // and QUCSATOR environment variable is honored
-        Arguments << "-qucs" << QucsSettings.QucsHomeDir.filePath("asco_netlist.txt")
-                  << "-o" << "asco_out"
-                  << "-s" << "\"" + QDir::toNativeSeparators(QucsSettings.Qucsator) + "\"";
-      }
-      else {
-        Program = QucsSettings.Qucsator;
-        Arguments << "-b" << "-g" << "-i"
-                  << QucsSettings.QucsHomeDir.filePath("netlist.txt")
-                  << "-o" << DataSet;
+      // an optimization is run by the simulator, too
+      SimOpt = findOptimization((Schematic*)DocWidget);
+
+      Program = QucsSettings.Qucsator;
+      Arguments << "-b" << "-g" << "-i"
+                << NetlistName
+                << "-o" << ResultName;
+      if(QucsSettings.LiveResults) {
+        // binary results spooled in small chunks can be read early
+        Live = true;
+        Arguments << "-s" << "-B"
+                  << "-k" << QString::number(SIM_LIVE_CHUNK);
       }
     }
     else {
+      Exclusive = true;  // digital work files
       if (isVerilog) {
           Program = QDir::toNativeSeparators(QucsSettings.BinDir + QucsVeri);
-          Arguments << QDir::toNativeSeparators(QucsSettings.QucsHomeDir.filePath("netlist.txt"))
-                    << DataSet
+          Arguments << QDir::toNativeSeparators(NetlistName)
+                    << ResultName
                     << SimTime
                     << QDir::toNativeSeparators(SimPath)
                     << QDir::toNativeSeparators(QucsSettings.BinDir)
@@ -553,15 +567,15 @@ void SimMessage::startSimulator()
 /// \todo \bug error: unrecognized command line option '-Wl'
 #ifdef __MINGW32__
     Program = QDir::toNativeSeparators(pathName(QucsSettings.BinDir + QucsDigi));
-    Arguments << QDir::toNativeSeparators(QucsSettings.QucsHomeDir.filePath("netlist.txt"))
-              << DataSet
+    Arguments << QDir::toNativeSeparators(NetlistName)
+              << ResultName
               << SimTime
               << QDir::toNativeSeparators(SimPath)
               << QDir::toNativeSeparators(QucsSettings.BinDir) << "-Wall" << "-c";
 #else
     Program = QDir::toNativeSeparators(pathName(QucsSettings.BinDir + QucsDigi));
-    Arguments << QucsSettings.QucsHomeDir.filePath("netlist.txt")
-              << DataSet << SimTime << pathName(SimPath)
+    Arguments << NetlistName
+              << ResultName << SimTime << pathName(SimPath)
 		      << pathName(QucsSettings.BinDir) << "-Wall" << "-c";
 
 #endif
@@ -591,10 +605,38 @@ void SimMessage::startSimulator()
 #endif
 
   SimProcess.setProcessEnvironment(env);
+  SimArguments = Arguments;
 
-  qDebug() << "Command :" << Program << Arguments.join(" ");
-  SimProcess.start(Program, Arguments); // launch the program
+  if(!SimQueue::enqueue(this))
+    ProgText->appendPlainText(tr("waiting for other simulations to end..."));
+}
+
+/*!
+ * \brief SimMessage::launch starts the simulator when the queue has
+ *  a free place for this simulation.
+ */
+void SimMessage::launch()
+{
+  qDebug() << "Command :" << Program << SimArguments.join(" ");
+  SimProcess.start(Program, SimArguments); // launch the program
 
+  if(Live) {
+    LiveSize = -1;
+    LiveTimer.start(SIM_LIVE_INTERVAL);
+  }
+}
+
+/*!
+ * \brief Tells the diagrams about new results of the running simulation.
+ *
+ *  Called every SIM_LIVE_INTERVAL ms, which limits the redrawing.
+ */
+void SimMessage::slotLiveResults()
+{
+  QFileInfo Info(ResultName);
+  if(!Info.exists() || Info.size() == LiveSize)  return;
+  LiveSize = Info.size();
+  emit liveResults(this);
 }
 
 // ------------------------------------------------------------------------
@@ -683,7 +725,6 @@ void SimMessage::slotDisplayErr()
  */
 void SimMessage::slotStateChanged(QProcess::ProcessState newState)
 {
-  static QProcess::ProcessState oldState;
   qDebug() << "SimMessage::slotStateChanged() : newState = " << newState 
            << " " << SimProcess.error();
   switch(newState){
@@ -691,7 +732,7 @@ void SimMessage::slotStateChanged(QProcess::ProcessState newState)
       switch(SimProcess.error()){
         case QProcess::FailedToStart: // does not happen (?)
         case QProcess::UnknownError: // getting here instead
-          switch(oldState){
+          switch(LastState){
             case QProcess::Starting: // failed to start.
               ErrText->insertPlainText(tr("ERROR: Cannot start ") + Program +
                   " (" + SimProcess.errorString() + ")\n");
@@ -722,7 +763,7 @@ void SimMessage::slotStateChanged(QProcess::ProcessState newState)
     case QProcess::Running:
     break;
   }
-  oldState = newState;
+  LastState = newState;
 }
 
 /*!
@@ -763,6 +804,9 @@ void SimMessage::slotSimEnded(int exitCode, QProcess::ExitStatus exitStatus )
  */
 void SimMessage::FinishSimulation(int Status)
 {
+  SimQueue::remove(this);  // let the next simulation start
+  LiveTimer.stop();
+
   Abort->setText(tr("Close window"));
   Display->setDisabled(false);
   SimProgress->setValue(100);  // progress bar to 100%
@@ -796,21 +840,41 @@ void SimMessage::FinishSimulation(int Status)
     file.close();
   }
 
-  if(Status == 0) {
-    if(SimOpt) { // save optimization data
-      QFile ifile(QucsSettings.QucsHomeDir.filePath("asco_out.dat"));
-      QFile ofile(DataSet);
-      if(ifile.open(QIODevice::ReadOnly)) {
-	if(ofile.open(QIODevice::WriteOnly)) {
-	  QByteArray data = ifile.readAll();
-	  ofile.write(data);
-	  ofile.close();
-	}
-	ifile.close();
+  // put the new results in place at once, unless a simulation of the
+  // same data set started later has already done so
+  bool Taken = false;
+  if(QFile::exists(ResultName)) {
+    if(Status == 0 && SimQueue::takeResults(this)) {
+      Taken = true;
+      if(Live) {  // the data set stays in the text format
+        QFile file(ResultName);
+        if(file.open(QIODevice::ReadOnly)) {
+          QByteArray Data = file.readAll();
+          file.close();
+          if(DataSetIndex::isBinary(Data) && file.open(QIODevice::WriteOnly)) {
+            file.write(DataSetIndex::toText(Data));
+            file.close();
+          }
+        }
       }
-      if(((Optimize_Sim*)SimOpt)->loadASCOout())
-	((Schematic*)DocWidget)->setChanged(true,true);
+      QFile::remove(DataSet);
+      QFile::rename(ResultName, DataSet);
     }
+    else
+      QFile::remove(ResultName);
+  }
+
+  // keep the netlist for "show last netlist"
+  if(QFile::exists(NetlistName)) {
+    QString last = QucsSettings.QucsHomeDir.filePath("netlist.txt");
+    QFile::remove(last);
+    QFile::rename(NetlistName, last);
+  }
+
+  // the optimized values become the initial values of the variables
+  if(Taken && SimOpt) {
+    if(((Optimize_Sim*)SimOpt)->loadResults(DataSet))
+      ((Schematic*)DocWidget)->setChanged(true,true);
   }
 
   emit SimulationEnded(Status, this);
@@ -838,6 +902,10 @@ void SimMessage::AbortSim()
 {
   ErrText->appendPlainText(tr("Simulation aborted by the user!"));
   simKilled = true;
+  if(SimQueue::remove(this)) {  // still waiting ?
+    FinishSimulation(-1);
+    return;
+  }
   SimProcess.kill();
 }
 // vim:ts=8:sw=2:et
@@ -21,6 +21,7 @@
 #include <QDialog>
 #include <QProcess>
 #include <QStringList>
+#include <QTimer>
 #include <QFile>
 #include <QTextStream>
 #include <QVBoxLayout>
@@ -37,6 +38,11 @@ class Schematic;
 
 // #define SPEEDUP_PROGRESSBAR
 
+// results of a running simulation: values written at once, and the
+// time in ms between looking for new ones
+#define SIM_LIVE_CHUNK    256
+#define SIM_LIVE_INTERVAL 1000
+
 
 class SimMessage : public QDialog  {
 Q_OBJECT
@@ -45,10 +51,12 @@ public:
  ~SimMessage();
 
   bool startProcess();
+  void launch();
 
 signals:
   void SimulationEnded(int, SimMessage*);
   void displayDataPage(QString&, QString&);
+  void liveResults(SimMessage*);
 
 public slots:
   void slotClose();
@@ -64,6 +72,7 @@ private slots:
 
   void slotReadSpiceNetlist();
   void slotFinishSpiceNetlist(int status);
+  void slotLiveResults();
 
 /* #ifdef SPEEDUP_PROGRESSBAR
   void slotUpdateProgressBar();
@@ -86,7 +95,16 @@ public:
   bool SimRunScript;
   QString DocName, DataSet, DataDisplay, Script;
 
+  int     Id;         // number in the order the simulations were started
+  int     Priority;   // waiting simulations with higher one start first
+  bool    Exclusive;  // uses files shared by all simulations, runs alone
+  QString NetlistName, ResultName;  // files of this simulation only
+  bool    Live;       // results shown while the simulation is running
+  QTimer  LiveTimer;
+  qint64  LiveSize;   // size of the results shown last
+
   QProcess       SimProcess;
+  QProcess::ProcessState LastState;
   QPlainTextEdit *ProgText, *ErrText;
   bool           wasLF;   // linefeed for "ProgText"
   bool           simKilled; // true if simulation was aborted by the user
@@ -104,6 +122,7 @@ public:
   QVBoxLayout  *all;
 protected:
   QString Program;
+  QStringList SimArguments;
 };
 
 #endif
@@ -0,0 +1,85 @@
+/***************************************************************************
+                               simqueue.cpp
+                              --------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "simqueue.h"
+#include "simmessage.h"
+#include "qucs.h"
+
+QList<SimMessage*> SimQueue::Waiting;
+QList<SimMessage*> SimQueue::Running;
+QHash<QString, int> SimQueue::Results;
+int SimQueue::Count = 0;
+
+// ---------------------------------------------------
+// Returns the number for a new simulation, later ones get higher numbers.
+int SimQueue::nextId()
+{
+  return ++Count;
+}
+
+// ---------------------------------------------------
+// Puts the simulation into the queue and starts it if possible.
+// Returns true, if the simulation is running now.
+bool SimQueue::enqueue(SimMessage *sim)
+{
+  int i;
+  for(i = 0; i < Waiting.size(); i++)
+    if(Waiting.at(i)->Priority < sim->Priority)  break;
+  Waiting.insert(i, sim);
+
+  startNext();
+  return Running.contains(sim);
+}
+
+// ---------------------------------------------------
+// Takes the simulation out of the queue when it has ended or has been
+// aborted. Returns true, if it has still been waiting.
+bool SimQueue::remove(SimMessage *sim)
+{
+  if(Waiting.removeAll(sim))  return true;
+  if(Running.removeAll(sim))  startNext();
+  return false;
+}
+
+// ---------------------------------------------------
+// Returns true, if the results of the simulation are to replace the
+// dataset, i.e. no simulation started later has already done so.
+bool SimQueue::takeResults(SimMessage *sim)
+{
+  QHash<QString, int>::iterator it = Results.find(sim->DataSet);
+  if(it != Results.end() && it.value() > sim->Id)  return false;
+  Results.insert(sim->DataSet, sim->Id);
+  return true;
+}
+
+// ---------------------------------------------------
+void SimQueue::startNext()
+{
+  int max = QucsSettings.maxSimJobs;
+  if(max < 1)  max = 1;
+
+  while(!Waiting.isEmpty()) {
+    SimMessage *sim = Waiting.first();
+    if(!Running.isEmpty()) {
+      if(sim->Exclusive || Running.first()->Exclusive)  break;
+      if(Running.size() >= max)  break;
+    }
+
+    Waiting.removeFirst();
+    Running.append(sim);
+    sim->launch();
+  }
+}
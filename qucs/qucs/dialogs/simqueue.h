@@ -0,0 +1,51 @@
+/***************************************************************************
+                                simqueue.h
+                               ------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SIMQUEUE_H
+#define SIMQUEUE_H
+
+#include <QList>
+#include <QHash>
+#include <QString>
+
+class SimMessage;
+
+/*!
+ * \class SimQueue
+ * \brief simulations waiting for and running in the simulator processes
+ *
+ * Every simulation writes its own netlist and results, so up to
+ * "QucsSettings.maxSimJobs" of them run at the same time. The waiting
+ * ones are started by priority, and in the order they were put into
+ * the queue otherwise. Simulations using files shared by all of them
+ * (digital simulations) run alone.
+ */
+class SimQueue {
+public:
+  static int  nextId();
+  static bool enqueue(SimMessage*);
+  static bool remove(SimMessage*);
+  static bool takeResults(SimMessage*);
+
+private:
+  static void startNext();
+
+  static QList<SimMessage*> Waiting, Running;
+  static QHash<QString, int> Results;   // last simulation per dataset
+  static int Count;
+};
+
+#endif
@@ -25,12 +25,16 @@
 #include "dialogs/exportdialog.h"
 
 #include <QtSvg>
+#include <QPrinter>
 
 
 ImageWriter::ImageWriter(QString lastfile)
 {
   onlyDiagram = false;
   lastExportFilename = lastfile;
+  pagesCount = pagesDpi = pagesStatus = 0;
+  pdfPrinter = 0;
+  pdfPainter = 0;
 }
 
 ImageWriter::~ImageWriter()
@@ -120,6 +124,158 @@ ImageWriter::noGuiPrint(QWidget *doc, QString printFile, QString color)
   }
 }
 
+/*!
+ * \brief ImageWriter::beginPages starts a headless export of several pages
+ *
+ * Every page added by addPage() is rendered right away, so the schematic
+ * can be freed before the next one is loaded. A PDF file receives all
+ * pages, each one fit to the paper, PNG and SVG pages go to numbered files
+ * ("name-1.png", "name-2.png", ...).
+ */
+bool ImageWriter::beginPages(QString printFile, QString color,
+                             QString page, int dpi, QString orientation)
+{
+  pagesFile = printFile;
+  pagesColor = color;
+  pagesDpi = dpi > 0 ? dpi : 96;
+  pagesCount = pagesStatus = 0;
+
+  if (printFile.endsWith(".pdf")) {
+    pdfPrinter = new QPrinter(QPrinter::HighResolution);
+    pdfPrinter->setOutputFormat(QPrinter::PdfFormat);
+    pdfPrinter->setOutputFileName(printFile);
+    if (page == "A3") {
+      pdfPrinter->setPaperSize(QPrinter::A3);
+    } else if (page == "B4") {
+      pdfPrinter->setPaperSize(QPrinter::B4);
+    } else if (page == "B5") {
+      pdfPrinter->setPaperSize(QPrinter::B5);
+    } else {
+      pdfPrinter->setPaperSize(QPrinter::A4);
+    }
+    pdfPrinter->setResolution(pagesDpi);
+    pdfPrinter->setColorMode(color == "BW" ? QPrinter::GrayScale : QPrinter::Color);
+    pdfPrinter->setOrientation(orientation == "landscape" ?
+                               QPrinter::Landscape : QPrinter::Portrait);
+    pdfPainter = new QPainter(pdfPrinter);
+    if (!pdfPainter->isActive()) {
+      fprintf(stderr, "Error: Could not write %s\n", printFile.toLatin1().data());
+      endPages();
+      return false;
+    }
+  } else if (!printFile.endsWith(".png") && !printFile.endsWith(".svg")) {
+    fprintf(stderr, "Unsupported format of output file for several pages.\n"
+        "Use PNG, SVG or PDF format!\n");
+    return false;
+  }
+  return true;
+}
+
+/*!
+ * \brief ImageWriter::addPage renders the schematic or only one of its
+ *  diagrams as the next page
+ */
+void ImageWriter::addPage(Schematic *sch, Diagram *pd)
+{
+  const int border = 30;
+  int w, h, xmin, ymin;
+  getPageBounds(sch, pd, w, h, xmin, ymin);
+  w += border;
+  h += border;
+  pagesCount++;
+
+  if (pdfPainter) {
+    if (pagesCount > 1)
+      pdfPrinter->newPage();
+    // schematic coordinates are screen pixels, fit them to the paper
+    QRect paper = pdfPrinter->pageRect();
+    float ratio = float(pagesDpi) / 96.0;
+    float scal = std::min(float(paper.width()) / (w * ratio),
+                          float(paper.height()) / (h * ratio));
+    ViewPainter vp;
+    vp.init(pdfPainter, scal * ratio, 0, 0,
+            (xmin - border/2) * scal * ratio, (ymin - border/2) * scal * ratio,
+            scal, ratio);
+    paintPage(&vp, sch, pd, false);
+    return;
+  }
+
+  QString name = pagesFile;
+  name.insert(name.lastIndexOf('.'), QString("-%1").arg(pagesCount));
+
+  if (pagesFile.endsWith(".svg")) {
+    QSvgGenerator svg;
+    svg.setFileName(name);
+    svg.setSize(QSize(w, h));
+    svg.setViewBox(QRectF(0, 0, w, h));
+    QPainter p(&svg);
+    p.fillRect(0, 0, w, h, Qt::white);
+    ViewPainter vp(&p);
+    vp.init(&p, 1.0, 0, 0, xmin-border/2, ymin-border/2, 1.0, 1.0);
+    paintPage(&vp, sch, pd, true);
+  } else {
+    QImage img(w, h, pagesColor == "BW" ? QImage::Format_Mono : QImage::Format_RGB888);
+    QPainter p(&img);
+    p.fillRect(0, 0, w, h, Qt::white);
+    ViewPainter vp(&p);
+    vp.init(&p, 1.0, 0, 0, xmin-border/2, ymin-border/2, 1.0, 1.0);
+    paintPage(&vp, sch, pd, true);
+    p.end();
+    if (!img.save(name)) {
+      fprintf(stderr, "Error: Could not write %s\n", name.toLatin1().data());
+      pagesStatus = -1;
+    }
+  }
+}
+
+/*!
+ * \brief ImageWriter::endPages finishes the export
+ * \return number of pages written or -1 on errors
+ */
+int ImageWriter::endPages()
+{
+  delete pdfPainter;   // closes the PDF file
+  delete pdfPrinter;
+  pdfPainter = 0;
+  pdfPrinter = 0;
+  return pagesStatus < 0 ? -1 : pagesCount;
+}
+
+void ImageWriter::getPageBounds(Schematic *sch, Diagram *pd,
+                                int &w, int &h, int &xmin, int &ymin)
+{
+  if (!pd) {
+    getSchWidthAndHeight(sch, w, h, xmin, ymin);
+    return;
+  }
+  int xmax = INT_MIN, ymax = INT_MIN;
+  xmin = ymin = INT_MAX;
+  int x1, y1, x2, y2;
+  pd->Bounding(x1, y1, x2, y2);
+  updateMinMax(xmin, xmax, ymin, ymax, x1, x2, y1, y2);
+  foreach (Graph *pg, pd->Graphs) {
+    foreach (Marker *pm, pg->Markers) {
+      pm->Bounding(x1, y1, x2, y2);
+      updateMinMax(xmin, xmax, ymin, ymax, x1, x2, y1, y2);
+    }
+  }
+  w = xmax - xmin;
+  h = ymax - ymin;
+}
+
+void ImageWriter::paintPage(ViewPainter *vp, Schematic *sch, Diagram *pd,
+                            bool toImage)
+{
+  if (!pd) {
+    sch->paintSchToViewpainter(vp, true, toImage, 96, pagesDpi);
+    return;
+  }
+  bool selected = pd->isSelected;
+  pd->isSelected = false;
+  pd->paint(vp);
+  pd->isSelected = selected;
+}
+
 QString ImageWriter::getLastSavedFile()
 {
     return lastExportFilename;
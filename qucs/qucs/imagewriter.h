@@ -26,6 +26,10 @@
 #include <QString>
 
 class QWidget;
+class QPrinter;
+class QPainter;
+class Schematic;
+class Diagram;
 
 class ImageWriter
 {
@@ -38,10 +42,25 @@ public:
   QString getLastSavedFile();
 
   void setDiagram(bool diagram) { onlyDiagram = diagram; };
+
+  // headless export of several pages in one pass, see doPrint()
+  bool beginPages(QString printFile, QString color,
+                  QString page, int dpi, QString orientation);
+  void addPage(Schematic *, Diagram *pd = 0);
+  int  endPages();
 private:
   bool onlyDiagram;
   QString lastExportFilename;
 
+  // state of beginPages() ... endPages()
+  QString pagesFile, pagesColor;
+  int pagesCount, pagesDpi, pagesStatus;
+  QPrinter *pdfPrinter;
+  QPainter *pdfPainter;
+
+  void getPageBounds(Schematic *, Diagram *, int &w, int &h, int &xmin, int &ymin);
+  void paintPage(ViewPainter *, Schematic *, Diagram *, bool toImage);
+
   void getSchWidthAndHeight(Schematic *sch, int &w, int &h, int &xmin, int &ymin);
   void getSelAreaWidthAndHeight(Schematic *sch, int &wsel, int& hsel, int& xmin_sel_, int& ymin_sel_);
   void updateMinMax(int &xmin, int &xmax, int &ymin, int &ymax, int x1, int x2, int y1m, int y2);
@@ -39,6 +39,10 @@
 #include <QRegExp>
 #include <QtSvg>
 #include <QDebug>
+#include <QThread>
+#include <QProcess>
+#include <QDir>
+#include <QFileInfo>
 
 #include "qucs.h"
 #include "node.h"
@@ -113,8 +117,12 @@ Schematic *openSchematic(QString schematic)
     return NULL;
   }
 
-  // populate Modules list
-  Module::registerModules ();
+  // populate Modules list, once for all documents of a batch
+  static bool registered = false;
+  if (!registered) {
+    Module::registerModules ();
+    registered = true;
+  }
 
   // new schematic from file
   Schematic *sch = new Schematic(0, schematic);
@@ -143,7 +151,8 @@ int doNetlist(QString schematic, QString netlist)
 
   QStringList Collect;
 
-  QPlainTextEdit *ErrText = new QPlainTextEdit();  //dummy
+  static QPlainTextEdit *ErrText = new QPlainTextEdit();  //dummy
+  ErrText->clear();
   QFile NetlistFile;
   QTextStream   Stream;
 
@@ -188,6 +197,105 @@ int doNetlist(QString schematic, QString netlist)
   return 0;
 }
 
+/*!
+ * \brief doNetlists netlists several schematics into the directory
+ *  'outdir', each one as <name>.net.
+ *
+ * Within a process the schematics share the symbol cache and the netlists
+ * of unchanged subcircuits. With jobs > 1 the list is split into that many
+ * consecutive parts, each netlisted by a child process of its own.
+ */
+int doNetlists(QStringList schematics, QString outdir, int jobs)
+{
+  if (!QDir().mkpath(outdir)) {
+    fprintf(stderr, "Error: Could not create directory %s\n",
+            outdir.toLatin1().data());
+    return 1;
+  }
+
+  int status = 0;
+  int n = schematics.count();
+  jobs = qMin(jobs, n);
+  if (jobs > 1) {
+    QList<QProcess *> Workers;
+    for (int j = 0; j < jobs; j++) {
+      QStringList args;
+      args << "-n";
+      for (int i = j*n/jobs; i < (j+1)*n/jobs; i++)
+        args << "-i" << schematics[i];
+      args << "-o" << outdir;
+      QProcess *Worker = new QProcess();
+      Worker->setProcessChannelMode(QProcess::ForwardedChannels);
+      Worker->start(QCoreApplication::applicationFilePath(), args);
+      Workers.append(Worker);
+    }
+    foreach (QProcess *Worker, Workers) {
+      Worker->waitForFinished(-1);
+      if (Worker->exitStatus() != QProcess::NormalExit || Worker->exitCode() != 0)
+        status = 1;
+      delete Worker;
+    }
+    return status;
+  }
+
+  foreach (QString schematic, schematics) {
+    QString netlist = QDir(outdir).filePath(
+        QFileInfo(schematic).completeBaseName() + ".net");
+    if (doNetlist(schematic, netlist) != 0) {
+      fprintf(stderr, "Error: Netlisting %s failed\n", schematic.toLatin1().data());
+      status = 1;
+    }
+  }
+  return status;
+}
+
+/*!
+ * \brief doPrintPages exports several schematics, or each of their diagrams
+ *  on a page of its own, in one pass. The schematics are loaded one at a
+ *  time and share the symbol cache.
+ */
+int doPrintPages(QStringList schematics, QString printFile,
+    QString page, int dpi, QString color, QString orientation, bool diagrams)
+{
+  ImageWriter *Writer = new ImageWriter("");
+  if (!Writer->beginPages(printFile, color, page, dpi, orientation)) {
+    delete Writer;
+    return 1;
+  }
+
+  int status = 0;
+  foreach (QString schematic, schematics) {
+    Schematic *sch = openSchematic(schematic);
+    if (sch == NULL) {
+      status = 1;
+      continue;
+    }
+
+    sch->Nodes = &(sch->DocNodes);
+    sch->Wires = &(sch->DocWires);
+    sch->Diagrams = &(sch->DocDiags);
+    sch->Paintings = &(sch->DocPaints);
+    sch->Components = &(sch->DocComps);
+    sch->reloadGraphs();
+
+    if (diagrams) {
+      for(Diagram *pd = sch->Diagrams->first(); pd != 0; pd = sch->Diagrams->next())
+        Writer->addPage(sch, pd);
+    } else {
+      Writer->addPage(sch);
+    }
+    delete sch;
+  }
+
+  int pages = Writer->endPages();
+  delete Writer;
+  if (pages < 0) {
+    return 1;
+  }
+  qDebug() << "*** printed" << pages << "pages to :" << printFile;
+  return status;
+}
+
 int doPrint(QString schematic, QString printFile,
     QString page, int dpi, QString color, QString orientation)
 {
@@ -514,6 +622,9 @@ int main(int argc, char *argv[])
   QucsSettings.font = QFont("Helvetica", 12);
   QucsSettings.largeFontSize = 16.0;
   QucsSettings.maxUndo = 20;
+  QucsSettings.maxUndoMemory = 64;
+  QucsSettings.maxHighlightSize = 16;
+  QucsSettings.maxSimJobs = qMax(1, QThread::idealThreadCount());
   QucsSettings.NodeWiring = 0;
   QucsSettings.Editor = "qucs";
 
@@ -675,11 +786,13 @@ int main(int argc, char *argv[])
   // work properly !???!
   setlocale (LC_NUMERIC, "C");
 
-  QString inputfile;
+  QStringList inputfiles;
   QString outputfile;
 
   bool netlist_flag = false;
   bool print_flag = false;
+  bool diagrams_flag = false;
+  int jobs = 1;
   QString page = "A4";
   int dpi = 96;
   QString color = "RGB";
@@ -691,17 +804,22 @@ int main(int argc, char *argv[])
       fprintf(stdout,
   "Usage: %s [-hv] \n"
   "       qucs -n -i FILENAME -o FILENAME\n"
+  "       qucs -n [-j NUMBER] -i FILENAME -i FILENAME ... -o DIRECTORY\n"
   "       qucs -p -i FILENAME -o FILENAME.[pdf|png|svg|eps] \n\n"
   "  -h, --help     display this help and exit\n"
   "  -v, --version  display version information and exit\n"
-  "  -n, --netlist  convert Qucs schematic into netlist\n"
+  "  -n, --netlist  convert Qucs schematic into netlist, several schematics\n"
+  "                 are written as DIRECTORY/NAME.net\n"
+  "  -j, --jobs NUMBER  netlist in that many processes (0 for all cores)\n"
   "  -p, --print    print Qucs schematic to file (eps needs inkscape)\n"
   "  -q, --quit     exit\n"
   "    --page [A4|A3|B4|B5]         set print page size (default A4)\n"
   "    --dpi NUMBER                 set dpi value (default 96)\n"
   "    --color [RGB|RGB]            set color mode (default RGB)\n"
   "    --orin [portraid|landscape]  set orientation (default portraid)\n"
-  "  -i FILENAME    use file as input schematic\n"
+  "    --diagrams                   print each diagram on a page of its own\n"
+  "  -i FILENAME    use file as input schematic, repeat it to print several\n"
+  "                 schematics into one PDF or numbered PNG/SVG files\n"
   "  -o FILENAME    use file as output netlist\n"
   "  -icons         create component icons under ./bitmaps_generated\n"
   "  -doc           dump data for documentation:\n"
@@ -738,6 +856,13 @@ int main(int argc, char *argv[])
     else if (!strcmp(argv[i], "--orin")) {
       orientation = argv[++i];
     }
+    else if (!strcmp(argv[i], "-j") || !strcmp(argv[i], "--jobs")) {
+      jobs = QString(argv[++i]).toInt();
+      if (jobs < 1) jobs = QThread::idealThreadCount();
+    }
+    else if (!strcmp(argv[i], "--diagrams")) {
+      diagrams_flag = true;
+    }
     else if (!strcmp(argv[i], "-a")) {
       attach(argv[++i]);
     }
@@ -745,7 +870,7 @@ int main(int argc, char *argv[])
 	exit(0);
     }
     else if (!strcmp(argv[i], "-i")) {
-      inputfile = argv[++i];
+      inputfiles << argv[++i];
     }
     else if (!strcmp(argv[i], "-o")) {
       outputfile = argv[++i];
@@ -773,7 +898,7 @@ int main(int argc, char *argv[])
     fprintf(stderr, "Error: --print and --netlist cannot be used together\n");
     return -1;
   } else if (netlist_flag or print_flag) {
-    if (inputfile.isEmpty()) {
+    if (inputfiles.isEmpty()) {
       fprintf(stderr, "Error: Expected input file.\n");
       return -1;
     }
@@ -782,10 +907,15 @@ int main(int argc, char *argv[])
       return -1;
     }
     // create netlist from schematic
-    if (netlist_flag) {
-      return doNetlist(inputfile, outputfile);
+    if (netlist_flag && (inputfiles.count() > 1 || QFileInfo(outputfile).isDir())) {
+      return doNetlists(inputfiles, outputfile, jobs);
+    } else if (netlist_flag) {
+      return doNetlist(inputfiles.first(), outputfile);
+    } else if (print_flag && (diagrams_flag || inputfiles.count() > 1)) {
+      return doPrintPages(inputfiles, outputfile,
+          page, dpi, color, orientation, diagrams_flag);
     } else if (print_flag) {
-      return doPrint(inputfile, outputfile,
+      return doPrint(inputfiles.first(), outputfile,
           page, dpi, color, orientation);
     }
   }
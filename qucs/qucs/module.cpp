@@ -29,6 +29,7 @@
 
 // Global category and component lists.
 QHash<QString, Module *> Module::Modules;
+QList<Module *> Module::Unresolved;
 QList<Category *> Category::Categories;
 
 QMap<QString, QString> Module::vaComponents;
@@ -53,29 +54,44 @@ void Module::registerModule (QString category, pInfoFunc info) {
 }
 
 // Component registration using a category name and the appropriate
-// function returning a components instance object.
+// function returning a components instance object.  The component is
+// put into the component hash only when first looked up, since its
+// "Model" property is known from an instance only.
 void Module::registerComponent (QString category, pInfoFunc info) {
   Module * m = new Module ();
   m->info = info;
   m->category = category;
 
-  // instantiation of the component once in order to obtain "Model"
-  // property of the component
-  QString Name, Model;
-  char * File;
-  Component * c = (Component *) info (Name, File, true);
-  Model = c->obsolete_model_hack();
-  delete c;
-
-  // put into category and the component hash
+  // put into category, the component hash is filled on demand
   intoCategory (m);
-  if (!Modules.contains (Model))
-    Modules.insert (Model, m);
+  Unresolved.append (m);
+}
+
+// Instantiates the registered components not yet in the component
+// hash once in order to obtain their "Model" property.  This happens
+// in order of registration until the given model is found, or for all
+// of them if there is no model given.
+void Module::resolveModels (const QString & Model) {
+  while (!Unresolved.isEmpty ()) {
+    Module * m = Unresolved.takeFirst ();
+    QString Name, Type;
+    char * File;
+    Component * c = (Component *) m->info (Name, File, true);
+    Type = c->obsolete_model_hack();
+    delete c;
+
+    if (!Modules.contains (Type))
+      Modules.insert (Type, m);
+    if (!Model.isEmpty () && Type == Model)
+      return;
+  }
 }
 
 // Returns instantiated component based on the given "Model" name.  If
 // there is no such component registers the function returns NULL.
 Component * Module::getComponent (QString Model) {
+  if (!Modules.contains (Model))
+    resolveModels (Model);
   if ( Modules.contains(Model)) {
     Module *m = Modules.find(Model).value();
     QString Name;
@@ -94,6 +110,8 @@ void Module::registerDynamicComponents()
 {
     qDebug() << "Module::registerDynamicComponents()";
 
+  // built-in components take precedence over equally named ones
+  resolveModels ();
 
   // vaComponents is populated in QucsApp::slotLoadModule
 
@@ -448,6 +466,7 @@ void Module::unregisterModules (void) {
     delete it.value();
   }
   Modules.clear ();
+  Unresolved.clear ();
 }
 
 // Constructor creates instance of module object.
@@ -38,10 +38,12 @@ class Module
   static void registerComponent (QString, pInfoFunc);
   static void intoCategory (Module *);
   static Component * getComponent (QString);
+  static void resolveModels (const QString & Model = QString());
   static void registerDynamicComponents(void);
 
  public:
   static QHash<QString, Module *> Modules;
+  static QList<Module *> Unresolved;  // components not yet in Modules
   static QMap<QString, QString> vaComponents;
 
  public:
@@ -178,6 +178,8 @@ void MouseActions::editLabel(Schematic *Doc, WireLabel *pl)
 // Reinserts all elements (moved by the user) back into the schematic.
 void MouseActions::endElementMoving(Schematic *Doc, Q3PtrList<Element> *movElements)
 {
+  Doc->clearMovingPreview();
+
   Element *pe;
   for(pe = movElements->first(); pe!=0; pe = movElements->next()) {
 //    pe->isSelected = false;  // deselect first (maybe afterwards pe == NULL)
@@ -425,6 +427,34 @@ void MouseActions::MMoveResizePainting(Schematic *Doc, QMouseEvent *Event)
   ((Painting*)focusElement)->MouseResizeMoving(MAx1, MAy1, Doc);
 }
 
+// -----------------------------------------------------------
+// Elements keeping their shape while dragged, their outline is taken
+// once and only shifted afterwards. Wires connected to elements not
+// moving are stretched instead.
+static bool movesRigidly(Element *pe)
+{
+  switch(pe->Type) {
+    case isComponent:
+    case isAnalogComponent:
+    case isDigitalComponent:
+    case isDiagram:
+    case isPainting:
+      return true;
+    case isWire:
+      return ((uintptr_t)((Wire*)pe)->Port1) > 3 &&
+             ((uintptr_t)((Wire*)pe)->Port2) > 3;
+  }
+  return false;
+}
+
+static void paintMovingScheme(Schematic *Doc, Element *pe)
+{
+  if(pe->Type == isWire)
+    Doc->PostPaintEvent(_Line, pe->x1, pe->y1, pe->x2, pe->y2);
+  else
+    pe->paintScheme(Doc);
+}
+
 // -----------------------------------------------------------
 // Moves components by keeping the mouse button pressed.
 void MouseActions::MMoveMoving(Schematic *Doc, QMouseEvent *Event)
@@ -467,9 +497,17 @@ void MouseActions::MMoveMoving(Schematic *Doc, QMouseEvent *Event)
     }
     else pe->setCenter(MAx1, MAy1, true);
 
-  pe->paintScheme(Doc);
+    if(!movesRigidly(pe)) paintMovingScheme(Doc, pe);
   }
 
+  // the shape of most elements does not change while dragging
+  Doc->beginMovingPreview();
+  for(Element *pe=movingElements.first(); pe!=0; pe=movingElements.next())
+    if(movesRigidly(pe)) paintMovingScheme(Doc, pe);
+  Doc->endMovingPreview();
+  MApx = MAx3;
+  MApy = MAy3;
+
   drawn = true;
   MAx1 = MAx2;
   MAy1 = MAy2;
@@ -488,7 +526,8 @@ void MouseActions::MMoveMoving2(Schematic *Doc, QMouseEvent *Event)
   MAy2 = DOC_Y_POS(Event->pos().y());
 
   Element *pe;
-  if(drawn) // erase old scheme
+  bool preview = Doc->hasMovingPreview();
+  if(drawn && !preview) // erase old scheme
     for(pe = movingElements.first(); pe != 0; pe = movingElements.next())
       pe->paintScheme(Doc);
 //      if(pe->Type == isWire)  if(((Wire*)pe)->Label)
@@ -504,6 +543,13 @@ void MouseActions::MMoveMoving2(Schematic *Doc, QMouseEvent *Event)
 
   moveElements(&movingElements, MAx1, MAy1);  // moves elements by MAx1/MAy1
 
+  if(preview) {
+    // shift the outline taken at first and redraw the stretched wires only
+    Doc->moveMovingPreview(MAx3-MApx, MAy3-MApy);
+    for(pe = movingElements.first(); pe != 0; pe = movingElements.next())
+      if(!movesRigidly(pe)) paintMovingScheme(Doc, pe);
+  }
+  else
   // paint afterwards to avoid conflict between wire and label painting
   for(pe = movingElements.first(); pe != 0; pe = movingElements.next())
     pe->paintScheme(Doc);
@@ -48,6 +48,7 @@ public:
   QMouseEvent *focusMEvent;
 
   int  MAx1, MAy1,MAx2, MAy2, MAx3, MAy3;  // cache for mouse movements
+  int  MApx, MApy;  // movement when the outline of the selection was taken
   Q3PtrList<Element> movingElements;
   int movingRotated;
 
@@ -45,6 +45,15 @@ function dataSet = loadQucsDataSet(dataSetFile)
 	    return;
     end
 
+    % binary datasets (qucsator -B) are recognized by their magic string
+    magic = fread(fid, [1 8], 'char=>char');
+    if strcmp(magic, 'QucsData')
+        dataSet = loadQucsBinaryDataSet(fid, dataSetFile);
+        fclose(fid);
+        return;
+    end
+    frewind(fid);
+
     error = 0;
     idata = 0;
     idx = 0;
@@ -127,3 +136,114 @@ function dataSet = loadQucsDataSet(dataSetFile)
     fclose(fid);
 
 end
+
+function dataSet = loadQucsBinaryDataSet(fid, dataSetFile)
+% Reads a binary dataset by means of its index, the values of each data
+% record are read at once without parsing any text.
+
+    dataSet = [];
+    fseek(fid, 16, 'bof');
+    index = fread(fid, 1, 'uint64');
+    if isempty(index) || index == 0
+        fprintf(1,'Incomplete data set %s\n',dataSetFile);
+        return;
+    end
+
+    % the index: tag, number of vectors and for each of them its id,
+    % declaration and data records in print order
+    fseek(fid, index, 'bof');
+    head = fread(fid, 2, 'uint32');
+    count = head(2);
+    decl = zeros(1, count);
+    chunks = cell(1, count);
+    for idx = 1:count
+        fread(fid, 1, 'uint32');
+        decl(idx) = fread(fid, 1, 'uint64');
+        n = fread(fid, 1, 'uint32');
+        chunks{idx} = zeros(n, 3);
+        for c = 1:n
+            chunks{idx}(c,1) = fread(fid, 1, 'uint64');
+            chunks{idx}(c,2:3) = fread(fid, 2, 'uint32')';
+        end
+    end
+
+    for idx = 1:count
+        % the declaration: tag, id, kind, name and dependencies
+        fseek(fid, decl(idx) + 8, 'bof');
+        dep = fread(fid, 1, 'uint32');
+        name = readBinaryString(fid);
+        nameDep = '-';
+        ndeps = fread(fid, 1, 'uint32');
+        for d = 1:ndeps
+            depname = readBinaryString(fid);
+            if d == 1
+                nameDep = depname;
+            end
+        end
+
+        data = [];
+        for c = 1:size(chunks{idx}, 1)
+            fseek(fid, chunks{idx}(c,1), 'bof');
+            len = chunks{idx}(c,2);
+            flags = chunks{idx}(c,3);
+            if bitand(flags, 2)
+                % packed real parts followed by the imaginary parts
+                val = unpackBinaryColumn(fid, len);
+                if bitand(flags, 1)
+                    val = complex(val, unpackBinaryColumn(fid, len));
+                end
+                data = [data val];
+            elseif bitand(flags, 1)
+                val = fread(fid, [2 len], 'double');
+                data = [data complex(val(1,:), val(2,:))];
+            else
+                data = [data fread(fid, [1 len], 'double')];
+            end
+        end
+
+        dataSet(idx).name = name;
+        dataSet(idx).nameDep = nameDep;
+        dataSet(idx).dep = dep;
+        dataSet(idx).data = data;
+        dataSet(idx).len = length(data);
+    end
+
+end
+
+function x = unpackBinaryColumn(fid, len)
+% Reads a column of packed doubles, see binPack() in
+% qucs-core/src/dataset.cpp: each value is XORed with its prediction
+% from the two previous ones and stored without leading zero bytes.
+    x = zeros(1, len);
+    a = 0;
+    b = 0;
+    for k = 1:len
+        if mod(k, 2) == 1
+            ctrl = fread(fid, 1, 'uint8');
+            n = bitand(ctrl, 15);
+        else
+            n = bitshift(ctrl, -4);
+        end
+        bits = uint64(0);
+        bytes = fread(fid, [1 n], 'uint8');
+        for i = 1:n
+            bits = bitor(bits, bitshift(uint64(bytes(i)), 8*(i-1)));
+        end
+        if k == 1
+            p = 0;
+        elseif k == 2 || ~isfinite(2*a - b)
+            p = a;
+        else
+            p = 2*a - b;
+        end
+        x(k) = typecast(bitxor(bits, typecast(p, 'uint64')), 'double');
+        b = a;
+        a = x(k);
+    end
+end
+
+function s = readBinaryString(fid)
+% Reads a string stored as 32 bit length followed by the characters.
+    len = fread(fid, 1, 'uint32');
+    s = fread(fid, [1 len], 'char=>char');
+end
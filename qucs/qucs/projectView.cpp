@@ -29,6 +29,8 @@
 #include <QDir>
 #include <QStandardItemModel>
 #include <QFileSystemWatcher>
+#include <QTimer>
+#include <QtConcurrentRun>
 #include <QDebug>
 
 ProjectView::ProjectView(QWidget *parent)
@@ -37,10 +39,22 @@ ProjectView::ProjectView(QWidget *parent)
   m_projPath = QString();
   m_projName = QString();
   m_valid = false;
+  m_generation = 0;
+  m_rescan = false;
+  m_expand = false;
   m_model = new QStandardItemModel(8, 2, this);
   watcher = new QFileSystemWatcher(this);
   connect(watcher, SIGNAL(directoryChanged(const QString&)), SLOT(dirChanged(const QString&)));
 
+  // coalesce the bursts of changes, e.g. of a running simulation
+  m_refreshTimer = new QTimer(this);
+  m_refreshTimer->setSingleShot(true);
+  m_refreshTimer->setInterval(200);
+  connect(m_refreshTimer, SIGNAL(timeout()), SLOT(refresh()));
+
+  m_scan = new QFutureWatcher<ProjectScan>(this);
+  connect(m_scan, SIGNAL(finished()), SLOT(scanFinished()));
+
   init();
 
   this->setModel(m_model);
@@ -49,6 +63,7 @@ ProjectView::ProjectView(QWidget *parent)
 
 ProjectView::~ProjectView()
 {
+  m_scan->waitForFinished();
   delete m_model;
   delete watcher;
 }
@@ -59,10 +74,12 @@ ProjectView::setProjPath(const QString &path)
   // check if path exist
   m_valid = !path.isEmpty() && QDir(path).exists();
 
+  if (!m_projPath.isEmpty()) {
+    watcher->removePath(m_projPath); // stop watching the previous directry
+  }
+  clearFiles();
+
   if (m_valid) {
-    if (!m_projPath.isEmpty()) {
-      watcher->removePath(m_projPath); // stop watching the previous directry
-    }
     m_projPath = path; // full path
     watcher->addPath(path); // start watching the current directory
     m_projName = QDir(m_projPath).dirName(); // only project directory name
@@ -71,14 +88,12 @@ ProjectView::setProjPath(const QString &path)
     } else { // should not happen
       qWarning() << "ProjectView::setProjPath() : path does not end in '_prj' (" << m_projName << ")";
     }
+  } else {
+    m_projPath = QString();
   }
+  // the sections are expanded as soon as the files are known
+  m_expand = true;
   refresh();
-  // expand only the Schematics section, to show all the schematic files
-  for (int i=0; i<m_model->rowCount(); i++) {
-    setExpanded(m_model->index(i, 0), i==6);
-  }
-  // make sure the whole schematics name are shown
-  resizeColumnToContents(0);
 }
 
 // initialize the view
@@ -86,6 +101,9 @@ void
 ProjectView::init()
 {
   m_model->clear();
+  m_generation++;
+  m_files.clear();
+  m_items.clear();
 
   APPEND_ROW(m_model, tr("Datasets")     );
   APPEND_ROW(m_model, tr("Data Displays"));
@@ -101,79 +119,181 @@ ProjectView::init()
   }
 }
 
-// refresh the view using the current projectPath
+// refresh the view using the current projectPath, the directory is
+// scanned in the background and only new and changed files are read
 void
 ProjectView::refresh()
 {
-  // put all files into "Content"-ListView
-  QDir workPath(m_projPath);
-  QStringList files = workPath.entryList(QStringList() << "*", QDir::Files, QDir::Name);
-  QStringList::iterator it;
-  QString extName, fileName;
-  QList<QStandardItem *> columnData;
-
   // update project name in header as it may have changed
   QStringList header;
   header << tr("Content of %1").arg(m_projName) << tr("Note");
   m_model->setHorizontalHeaderLabels(header);
 
-  for (int i=0; i<m_model->rowCount(); i++) {
-    // delete_childrens
-    m_model->item(i, 0)->removeRows(0, m_model->item(i, 0)->rowCount());
+  if (!m_valid) {
+    return;
   }
+  if (m_scan->isRunning()) {
+    m_rescan = true; // scan again once the current scan is done
+    return;
+  }
+  m_rescan = false;
+  m_scan->setFuture(QtConcurrent::run(scan, m_projPath, m_files, m_generation,
+                                      QucsSettings.ShowDescriptionProjectTree));
+}
 
-#define APPEND_CHILD(category, data) \
-  m_model->item(category, 0)->appendRow(data);
-
-  for(it = files.begin(); it != files.end(); ++it) {
-    fileName = (*it).toAscii();
-    extName = QFileInfo(workPath.filePath(fileName)).suffix();
+// Compares the files of the directory with the known ones and reads the
+// new and changed ones. Runs on a worker thread.
+ProjectScan
+ProjectView::scan(const QString &path, QHash<QString, ProjectFile> known,
+                  int generation, bool description)
+{
+  ProjectScan result;
+  result.generation = generation;
 
-    columnData.clear();
-    QStandardItem * d = new QStandardItem(fileName);
-    if (QucsSettings.ShowDescriptionProjectTree)
-    { // In case of the ShowDescriptionProjectTree property is set, 
-      // it reads the schematic header looking for the message to be displayed
-      // and the variable which sets the visibility of the frame
-       QString description = ReadDescription(workPath.absoluteFilePath(fileName));
-       d->setToolTip(description);
+  QDir workPath(path);
+  QFileInfoList files = workPath.entryInfoList(QStringList() << "*", QDir::Files, QDir::Name);
+  foreach (const QFileInfo &info, files) {
+    QHash<QString, ProjectFile>::iterator it = known.find(info.fileName());
+    if (it != known.end()) {
+      bool unchanged = it->modified == info.lastModified() && it->size == info.size();
+      known.erase(it);
+      if (unchanged) continue;
     }
-    columnData.append(d);
 
+    ProjectFile f;
+    f.name = info.fileName();
+    f.modified = info.lastModified();
+    f.size = info.size();
+
+    QString extName = info.suffix();
     if(extName == "dat") {
-      APPEND_CHILD(0, columnData);
+      f.category = 0;
     }
     else if(extName == "dpl") {
-      APPEND_CHILD(1, columnData);
+      f.category = 1;
     }
     else if(extName == "v") {
-      APPEND_CHILD(2, columnData);
+      f.category = 2;
     }
     else if(extName == "va") {
-      APPEND_CHILD(3, columnData);
+      f.category = 3;
     }
     else if((extName == "vhdl") || (extName == "vhd")) {
-      APPEND_CHILD(4, columnData);
+      f.category = 4;
     }
     else if((extName == "m") || (extName == "oct")) {
-      APPEND_CHILD(5, columnData);
+      f.category = 5;
     }
     else if(extName == "sch") {
       // test if it's a valid schematic file
-      int n = Schematic::testFile(workPath.filePath(fileName));
-      if(n >= 0) {
-        if(n > 0) { // is a subcircuit
-          columnData.append(new QStandardItem(QString::number(n)+tr("-port")));
-        }
-        APPEND_CHILD(6, columnData);
+      int n = Schematic::testFile(info.absoluteFilePath());
+      f.category = (n >= 0) ? 6 : -1;
+      if(n > 0) { // is a subcircuit
+        f.note = QString::number(n)+tr("-port");
       }
     }
     else {
-      APPEND_CHILD(7, columnData);
+      f.category = 7;
     }
+
+    if (description && f.category >= 0)
+    { // In case of the ShowDescriptionProjectTree property is set,
+      // it reads the schematic header looking for the message to be displayed
+      // and the variable which sets the visibility of the frame
+      f.description = ReadDescription(info.absoluteFilePath());
+    }
+    result.changed.append(f);
+  }
+  result.removed = known.keys();
+  return result;
+}
+
+// applies the changes found by the scan to the model
+void
+ProjectView::scanFinished()
+{
+  ProjectScan s = m_scan->result();
+  if (s.generation != m_generation) {
+    refresh(); // the project has changed meanwhile
+    return;
   }
 
-  resizeColumnToContents(0);
+  foreach (const QString &name, s.removed) {
+    removeFile(name);
+  }
+  foreach (const ProjectFile &f, s.changed) {
+    removeFile(f.name);
+    insertFile(f);
+  }
+
+  if (m_expand) {
+    m_expand = false;
+    // expand only the Schematics section, to show all the schematic files
+    for (int i=0; i<m_model->rowCount(); i++) {
+      setExpanded(m_model->index(i, 0), i==6);
+    }
+  }
+  // make sure the whole schematics name are shown
+  if (!s.removed.isEmpty() || !s.changed.isEmpty()) {
+    resizeColumnToContents(0);
+  }
+
+  if (m_rescan) {
+    refresh();
+  }
+}
+
+// removes all files from the view
+void
+ProjectView::clearFiles()
+{
+  m_generation++;
+  m_files.clear();
+  m_items.clear();
+  for (int i=0; i<m_model->rowCount(); i++) {
+    // delete_childrens
+    m_model->item(i, 0)->removeRows(0, m_model->item(i, 0)->rowCount());
+  }
+}
+
+void
+ProjectView::removeFile(const QString &name)
+{
+  m_files.remove(name);
+  QStandardItem *item = m_items.take(name);
+  if (item) {
+    item->parent()->removeRow(item->row());
+  }
+}
+
+// inserts the file into its section, which is kept sorted by name
+void
+ProjectView::insertFile(const ProjectFile &f)
+{
+  m_files.insert(f.name, f);
+  if (f.category < 0) {
+    return;
+  }
+
+  QList<QStandardItem *> columnData;
+  QStandardItem * d = new QStandardItem(f.name);
+  if (!f.description.isEmpty()) {
+    d->setToolTip(f.description);
+  }
+  columnData.append(d);
+  if (!f.note.isEmpty()) {
+    columnData.append(new QStandardItem(f.note));
+  }
+
+  QStandardItem *parent = m_model->item(f.category, 0);
+  int lo = 0, hi = parent->rowCount();
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (parent->child(mid, 0)->text() < f.name) lo = mid + 1;
+    else hi = mid;
+  }
+  parent->insertRow(lo, columnData);
+  m_items.insert(f.name, d);
 }
 
 QStringList
@@ -193,7 +313,7 @@ void ProjectView::dirChanged(const QString &path)
 {
   Q_UNUSED(path);
   //qDebug() << "watcher:" << path;
-  refresh();
+  m_refreshTimer->start();
 }
 
 // This function reads the text inside the <description></description> tags from the given file location
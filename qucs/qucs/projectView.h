@@ -26,6 +26,9 @@
 
 #include <QTreeView>
 #include <QString>
+#include <QDateTime>
+#include <QHash>
+#include <QFutureWatcher>
 #include "qucs.h"
 
 #define APPEND_ROW(parent, data) \
@@ -36,7 +39,26 @@
 })
 
 class QStandardItemModel;
+class QStandardItem;
 class QFileSystemWatcher;
+class QTimer;
+
+// a file of the project as shown in the view
+struct ProjectFile {
+  QString name;
+  QDateTime modified;
+  qint64 size;
+  int category;    // row of the section, -1 if not shown
+  QString note;    // second column, e.g. the ports of a subcircuit
+  QString description;
+};
+
+// changes of the project directory found by a scan
+struct ProjectScan {
+  int generation;  // of the files the scan compared to
+  QList<ProjectFile> changed;
+  QStringList removed;
+};
 
 class ProjectView : public QTreeView
 {
@@ -50,20 +72,36 @@ public:
   //data related
   void setProjPath(const QString &);
   void init();
-  void refresh();
   QStringList exportSchematic();
 private:
   QStandardItemModel *m_model;
   QFileSystemWatcher *watcher;
+  QTimer *m_refreshTimer;
 
   bool m_valid;
   QString m_projPath;
   QString m_projName;
 
-  QString ReadDescription(QString);
+  // files currently shown, the scan only reads the new and changed ones
+  QHash<QString, ProjectFile> m_files;
+  QHash<QString, QStandardItem*> m_items;
+  QFutureWatcher<ProjectScan> *m_scan;
+  int m_generation;
+  bool m_rescan;
+  bool m_expand;
+
+  static ProjectScan scan(const QString&, QHash<QString, ProjectFile>, int, bool);
+  static QString ReadDescription(QString);
+  void clearFiles();
+  void removeFile(const QString&);
+  void insertFile(const ProjectFile&);
 
 public slots:
+  void refresh();
   void dirChanged(const QString&);
+
+private slots:
+  void scanFinished();
 };
 
 #endif /* PROJECTVIEW_H_ */
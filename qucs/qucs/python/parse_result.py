@@ -1,9 +1,18 @@
 import re
+import mmap
+import struct
 import numpy as np
 
+# binary datasets written by qucsator -B start with this string
+BINARY_MAGIC = b'QucsData'
+
 
 def parse_file(name):
 
+    with open(name, 'rb') as f:
+        if f.read(len(BINARY_MAGIC)) == BINARY_MAGIC:
+            return parse_binary_file(name)
+
     file = open(name)
 
     # the dict this function returns
@@ -79,3 +88,105 @@ def parse_file(name):
             data[key] = np.reshape(temp_data, shape).squeeze()
 
     return data
+
+
+def unpack_column(buf, pos, n):
+    """Unpacks a column of n packed doubles at the given position of a
+    binary dataset, see binPack() in qucs-core/src/dataset.cpp.
+    Returns the values and the position behind them."""
+
+    values = np.zeros(n)
+    a = b = 0.0
+    ctrl = 0
+    for k in range(n):
+        if k & 1 == 0:
+            ctrl = buf[pos]
+            pos += 1
+        length = ctrl >> 4 if k & 1 else ctrl & 15
+        bits = int.from_bytes(buf[pos:pos + length], 'little')
+        pos += length
+        if k == 0:
+            p = 0.0
+        elif k == 1 or not np.isfinite(2 * a - b):
+            p = a
+        else:
+            p = 2 * a - b
+        bits ^= struct.unpack('=Q', struct.pack('=d', p))[0]
+        values[k] = struct.unpack('=d', struct.pack('=Q', bits))[0]
+        b, a = a, values[k]
+    return values, pos
+
+
+def parse_binary_file(name):
+    """Loads a binary dataset.  The values are not parsed but memory
+    mapped from the file, each array is a view into the mapping unless
+    the vector has been written in several parts or packed.  Purely
+    real vectors stay real.  The returned dict is laid out like the one
+    of parse_file()."""
+
+    with open(name, 'rb') as f:
+        buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+    def u32(pos):
+        return struct.unpack_from('=I', buf, pos)[0]
+
+    def string(pos):
+        n = u32(pos)
+        return buf[pos + 4:pos + 4 + n].decode(), pos + 4 + n
+
+    # the header holds the position of the index
+    index = struct.unpack_from('=Q', buf, 16)[0]
+    if index == 0:
+        raise ValueError('incomplete binary dataset ' + name)
+
+    data = {}
+    variables = {}
+    dependencies = {}
+    count = u32(index + 4)
+    pos = index + 8
+    for k in range(count):
+        decl, nchunks = struct.unpack_from('=QI', buf, pos + 4)
+        pos += 16
+        parts = []
+        for c in range(nchunks):
+            offset, size, flags = struct.unpack_from('=QII', buf, pos)
+            pos += 16
+            if flags & 2:
+                # packed real parts followed by the imaginary parts
+                values, p = unpack_column(buf, offset, size)
+                if flags & 1:
+                    values = values + 1j * unpack_column(buf, p, size)[0]
+                parts.append(values)
+            else:
+                dtype = np.complex128 if flags & 1 else np.float64
+                parts.append(np.frombuffer(buf, dtype, size, offset))
+
+        # the declaration: tag, id, kind, name and dependencies
+        kind = u32(decl + 8)
+        vname, p = string(decl + 12)
+        deps = []
+        p += 4
+        for d in range(u32(p - 4)):
+            dep, p = string(p)
+            deps.append(dep)
+        if len(parts) == 1:
+            values = parts[0]
+        elif parts:
+            # real parts get promoted if the vector turned complex
+            values = np.concatenate(parts)
+        else:
+            values = np.zeros(0)
+        data[vname] = values
+        variables[vname] = 'dep' if kind else 'indep'
+        dependencies[vname] = deps
+
+    data['variables'] = variables
+
+    # a dependent variable on N > 1 independent variables becomes an
+    # N-dimensional view, the first dependency varying fastest
+    for key in variables:
+        if variables[key] == 'dep' and len(dependencies[key]) > 1:
+            shape = [len(data[d]) for d in dependencies[key] if d in data]
+            data[key] = np.reshape(data[key], shape[::-1]).squeeze()
+
+    return data
@@ -41,6 +41,7 @@
 #include <QUrl>
 #include <QSettings>
 #include <QVariant>
+#include <QPixmapCache>
 #include <QDebug>
 
 #include "qucs.h"
@@ -589,6 +590,21 @@ void QucsApp::fillComboBox (bool setAll)
   }
 }
 
+// ------------------------------------------------------------------
+// Returns the icon of a component palette entry.  The bitmaps are
+// decoded when their category is first shown and kept for the next
+// time.
+static QPixmap paletteIcon(const char *File)
+{
+  QString Key = ":/bitmaps/" + QString(File) + ".png";
+  QPixmap Icon;
+  if(!QPixmapCache::find(Key, &Icon)) {
+    Icon = QPixmap(Key);
+    QPixmapCache::insert(Key, Icon);
+  }
+  return Icon;
+}
+
 // ----------------------------------------------------------
 // Whenever the Component Library ComboBox is changed, this slot fills the
 // Component IconView with the appropriate components.
@@ -678,7 +694,7 @@ void QucsApp::slotSetCompView (int index)
       if (Infos) {
         /// \todo warning: expression result unused, can we rewrite this?
         (void) *((*it)->info) (Name, File, false);
-        QListWidgetItem *icon = new QListWidgetItem(QPixmap(":/bitmaps/" + QString (File) + ".png"), Name);
+        QListWidgetItem *icon = new QListWidgetItem(paletteIcon(File), Name);
         icon->setToolTip(Name);
         iconCompInfo = iconCompInfoStruct{catIdx, compIdx};
         v.setValue(iconCompInfo);
@@ -734,7 +750,7 @@ void QucsApp::slotSearchComponent(const QString &searchText)
 
           if((Name.indexOf(searchText, 0, Qt::CaseInsensitive)) != -1) {
             //match
-            QListWidgetItem *icon = new QListWidgetItem(QPixmap(":/bitmaps/" + QString (File) + ".png"), Name);
+            QListWidgetItem *icon = new QListWidgetItem(paletteIcon(File), Name);
             icon->setToolTip(it + ": " + Name);
             // add component category and module indexes to the icon
             iconCompInfo = iconCompInfoStruct{catIdx, compIdx};
@@ -2131,6 +2147,8 @@ void QucsApp::slotSimulate()
 		SLOT(slotAfterSimulation(int, SimMessage*)));
   connect(sim, SIGNAL(displayDataPage(QString&, QString&)),
 		this, SLOT(slotChangePage(QString&, QString&)));
+  connect(sim, SIGNAL(liveResults(SimMessage*)),
+		this, SLOT(slotLiveResults(SimMessage*)));
 
   sim->show();
   if(!sim->startProcess()) return;
@@ -2183,7 +2201,7 @@ void QucsApp::slotAfterSimulation(int Status, SimMessage *sim)
     else
       if(w) if(!isTextDocument (sim->DocWidget))
 	// load recent simulation data (if document is still open)
-	((Schematic*)sim->DocWidget)->reloadGraphs();
+	((Schematic*)sim->DocWidget)->reloadGraphs(true);
   }
 
   if(!isTextDocument (sim->DocWidget))
@@ -2191,6 +2209,25 @@ void QucsApp::slotAfterSimulation(int Status, SimMessage *sim)
 
 }
 
+// ------------------------------------------------------------------------
+// Is called while the simulation is running and has written new results.
+// Redraws the diagrams of all open pages showing its data set.
+void QucsApp::slotLiveResults(SimMessage *sim)
+{
+  QString DataSet = QFileInfo(sim->DataSet).absoluteFilePath();
+
+  int i=0;
+  QWidget *w;
+  while((w=DocumentTab->widget(i++)) != 0) {
+    if(isTextDocument(w))  continue;
+    Schematic *Doc = (Schematic*)w;
+    QFileInfo Info(Doc->DocName);
+    if(QFileInfo(Info.path()+QDir::separator()+Doc->DataSet).absoluteFilePath()
+       == DataSet)
+      Doc->reloadGraphs(true, sim->ResultName);
+  }
+}
+
 // ------------------------------------------------------------------------
 void QucsApp::slotDCbias()
 {
@@ -2250,7 +2287,7 @@ void QucsApp::slotChangePage(QString& DocName, QString& DataDisplay)
 
   if(DocumentTab->currentWidget() == w)      // if page not ...
     if(!isTextDocument (w))
-      ((Schematic*)w)->reloadGraphs();  // ... changes, reload here !
+      ((Schematic*)w)->reloadGraphs(true);  // ... changes, reload here !
 
   TabView->setCurrentIndex(2);   // switch to "Component"-Tab
   if (Name.right(4) == ".dpl") {
@@ -2898,6 +2935,9 @@ bool loadSettings()
     if(settings.contains("font"))QucsSettings.font.fromString(settings.value("font").toString());
     if(settings.contains("LargeFontSize"))QucsSettings.largeFontSize=settings.value("LargeFontSize").toDouble(); // use toDouble() as it can interpret the string according to the current locale
     if(settings.contains("maxUndo"))QucsSettings.maxUndo=settings.value("maxUndo").toInt();
+    if(settings.contains("maxUndoMemory"))QucsSettings.maxUndoMemory=settings.value("maxUndoMemory").toInt();
+    if(settings.contains("maxHighlightSize"))QucsSettings.maxHighlightSize=settings.value("maxHighlightSize").toInt();
+    if(settings.contains("maxSimJobs"))QucsSettings.maxSimJobs=settings.value("maxSimJobs").toInt();
     if(settings.contains("NodeWiring"))QucsSettings.NodeWiring=settings.value("NodeWiring").toInt();
     if(settings.contains("BGColor"))QucsSettings.BGColor.setNamedColor(settings.value("BGColor").toString());
     if(settings.contains("Editor"))QucsSettings.Editor=settings.value("Editor").toString();
@@ -2947,6 +2987,9 @@ bool loadSettings()
     if (settings.contains("TextAntiAliasing")) QucsSettings.TextAntiAliasing = settings.value("TextAntiAliasing").toBool();
     else QucsSettings.TextAntiAliasing = false;
 
+    if (settings.contains("LiveResults")) QucsSettings.LiveResults = settings.value("LiveResults").toBool();
+    else QucsSettings.LiveResults = true;
+
     if(settings.contains("Editor")) QucsSettings.Editor = settings.value("Editor").toString();
 
     if(settings.contains("ShowDescription")) QucsSettings.ShowDescriptionProjectTree = settings.value("ShowDescription").toBool();
@@ -3107,6 +3150,9 @@ bool saveApplSettings()
     // store LargeFontSize as a string, so it will be also human-readable in the settings file (will be a @Variant() otherwise)
     settings.setValue("LargeFontSize", QString::number(QucsSettings.largeFontSize));
     settings.setValue("maxUndo", QucsSettings.maxUndo);
+    settings.setValue("maxUndoMemory", QucsSettings.maxUndoMemory);
+    settings.setValue("maxHighlightSize", QucsSettings.maxHighlightSize);
+    settings.setValue("maxSimJobs", QucsSettings.maxSimJobs);
     settings.setValue("NodeWiring", QucsSettings.NodeWiring);
     settings.setValue("BGColor", QucsSettings.BGColor.name());
     settings.setValue("Editor", QucsSettings.Editor);
@@ -3136,6 +3182,7 @@ bool saveApplSettings()
     settings.setValue("IgnoreVersion", QucsSettings.IgnoreFutureVersion);
     settings.setValue("GraphAntiAliasing", QucsSettings.GraphAntiAliasing);
     settings.setValue("TextAntiAliasing", QucsSettings.TextAntiAliasing);
+    settings.setValue("LiveResults", QucsSettings.LiveResults);
     settings.setValue("Editor", QucsSettings.Editor);
     settings.setValue("ShowDescription", QucsSettings.ShowDescriptionProjectTree);
 
@@ -85,6 +85,9 @@ struct tQucsSettings {
     Attribute, Directive, Task;
 
   unsigned int maxUndo;    // size of undo stack
+  unsigned int maxUndoMemory; // memory of undo stack in MB
+  unsigned int maxHighlightSize; // largest highlighted text document in MB
+  unsigned int maxSimJobs; // simulations running at the same time
   QString Editor;
   QString Qucsator;
   QString Qucsconv;
@@ -118,6 +121,7 @@ struct tQucsSettings {
   bool GraphAntiAliasing;
   bool TextAntiAliasing;
   bool ShowDescriptionProjectTree;
+  bool LiveResults;   // show results of running simulations
 };
 
 // extern because nearly everywhere used
@@ -250,6 +254,7 @@ private slots:
   void slotChangeView(QWidget*);
   void slotSimulate();
   void slotAfterSimulation(int, SimMessage*);
+  void slotLiveResults(SimMessage*);
   void slotDCbias();
   void slotChangePage(QString&, QString&);
   void slotHideEdit();
@@ -398,7 +403,8 @@ public:
           *distrHor, *distrVert, *selectAll, *callLib, *callMatch, *changeProps,
           *addToProj, *editFind, *insEntity, *selectMarker, *callPowerComb,
           *createLib, *importData, *graph2csv, *createPkg, *extractPkg,
-          *callAtt, *callRes, *centerHor, *centerVert, *loadModule, *buildModule;
+          *callAtt, *callRes, *centerHor, *centerVert, *loadModule, *buildModule,
+          *buildAllModules;
 
 public slots:
   void slotEditRotate(bool);  // rotate the selected items
@@ -468,6 +474,7 @@ private slots:
   void slotClearRecentFiles();
   void slotLoadModule();
   void slotBuildModule();
+  void slotBuildAllModules();
 
 private:
   void showHTML(const QString&);
@@ -61,6 +61,7 @@
 #include "dialogs/aboutdialog.h"
 #include "module.h"
 #include "misc.h"
+#include "vabuilder.h"
 
 // for editing component name on schematic
 QRegExp  Expr_CompProp;
@@ -1467,101 +1468,63 @@ void QucsApp::slotBuildModule()
     messageDock->builderTabs->setTabIcon(1,QPixmap());
 
 
-    QString make;
-
-#ifdef __MINGW32__
-    make = "mingw32-make.exe";    // must be on the path!
-#else
-    make = "make";                // must be on the path!
-#endif
-
-    QDir prefix = QDir(QucsSettings.BinDir+"../");
-
-    QDir include = QDir(QucsSettings.BinDir+"../include/qucs-core");
-
     QString workDir = QucsSettings.QucsWorkDir.absolutePath();
 
-    // need to cd into project to make sure output is droped there?
-    // need to cd - into previous location?
-    QDir::setCurrent(workDir);
-
-    QProcess *builder = new QProcess();
-    builder->setProcessChannelMode(QProcess::MergedChannels);
     // get current va document
     QucsDoc *Doc = getDoc();
     QString vaModule = Doc->fileBase(Doc->DocName);
 
-    QString admsXml = QucsSettings.AdmsXmlBinDir.canonicalPath();
-
-#ifdef __MINGW32__
-    admsXml = QDir::toNativeSeparators(admsXml+"/"+"admsXml.exe");
-#else
-    admsXml = QDir::toNativeSeparators(admsXml+"/"+"admsXml");
-#endif
-
-    // admsXml emmits C++
-    QStringList Arguments;
-    Arguments << "-f" <<  QDir::toNativeSeparators(include.absoluteFilePath("va2cpp.makefile"))
-              << QString("ADMSXML=%1").arg(admsXml)
-              << QString("PREFIX=%1").arg(QDir::toNativeSeparators(prefix.absolutePath()))
-              << QString("MODEL=%1").arg(vaModule);
-
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    builder->setProcessEnvironment(env);
-
-    // prepend command to log
-    QString cmdString = QString("%1 %2\n").arg(make, Arguments.join(" "));
-    messageDock->admsOutput->appendPlainText(cmdString);
-
-    qDebug() << "Command :" << make << Arguments.join(" ");
-    builder->start(make, Arguments);
-
-    // admsXml seems to communicate all via stdout, or is it because of make?
-    QString vaStatus;
-    if (!builder->waitForFinished()) {
-        vaStatus = builder->errorString();
-        qDebug() << "Make failed:" << vaStatus;
-    }
-    else {
-        vaStatus = builder->readAll();
-        qDebug() << "Make stdout"  << vaStatus;
-    }
+    // admsXml and the C++ compiler run unless the library is cached
+    VaBuilder builder(workDir);
+    VaBuilder::Result res = builder.build(vaModule);
 
-    //build libs
-    qDebug() << "\nbuild libs\n";
+    // push make output to message dock
+    messageDock->admsOutput->appendPlainText(res.admsLog);
+    messageDock->cppOutput->appendPlainText(res.cppLog);
 
-    Arguments.clear();
+    // shot the message docks
+    messageDock->msgDock->show();
 
-    Arguments << "-f" <<  QDir::toNativeSeparators(include.absoluteFilePath("cpp2lib.makefile"))
-              << QString("PREFIX=\"%1\"").arg(QDir::toNativeSeparators(prefix.absolutePath()))
-              << QString("PROJDIR=\"%1\"").arg(QDir::toNativeSeparators(workDir))
-              << QString("MODEL=%1").arg(vaModule);
+}
 
-    // prepend command to log
-    cmdString = QString("%1 %2\n").arg(make, Arguments.join(" "));
-    messageDock->cppOutput->appendPlainText(cmdString);
+/*!
+ * \brief QucsApp::slotBuildAllModules builds all Verilog-A modules of the
+ * project
+ *
+ * The modules are built in parallel, those built before by any project
+ * are taken from the library cache.
+ */
+void QucsApp::slotBuildAllModules()
+{
+    messageDock->reset();
 
-    builder->start(make, Arguments);
+    messageDock->builderTabs->setTabIcon(0,QPixmap());
+    messageDock->builderTabs->setTabIcon(1,QPixmap());
 
-    QString cppStatus;
+    QString workDir = QucsSettings.QucsWorkDir.absolutePath();
 
-    if (!builder->waitForFinished()) {
-        cppStatus = builder->errorString();
-        qDebug() << "Make failed:" << cppStatus;
-    }
-    else {
-        cppStatus = builder->readAll();
-        qDebug() << "Make output:" << cppStatus;
+    QStringList modules;
+    foreach (const QString &file,
+             QDir(workDir).entryList(QStringList("*.va"), QDir::Files))
+      modules.append(QFileInfo(file).completeBaseName());
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    VaBuilder builder(workDir);
+    QList<VaBuilder::Result> results = builder.buildAll(modules);
+    QApplication::restoreOverrideCursor();
+
+    QStringList failed;
+    foreach (const VaBuilder::Result &res, results) {
+      messageDock->admsOutput->appendPlainText(res.admsLog);
+      messageDock->cppOutput->appendPlainText(res.cppLog);
+      if (!res.ok)
+        failed.append(res.module);
     }
-    delete builder;
-
-    // push make output to message dock
-    messageDock->admsOutput->appendPlainText(vaStatus);
-    messageDock->cppOutput->appendPlainText(cppStatus);
-
-    // shot the message docks
     messageDock->msgDock->show();
 
+    if (!failed.isEmpty())
+      QMessageBox::critical(this, tr("Error"),
+        tr("Cannot build the Verilog-A modules:\n%1").arg(failed.join(", ")));
 }
 
 // ----------------------------------------------------------
@@ -397,6 +397,12 @@ void QucsApp::initActions()
   buildModule->setWhatsThis(tr("Build Verilog-A module\nRuns amdsXml and C++ compiler"));
   connect(buildModule, SIGNAL(triggered()), SLOT(slotBuildModule()));
 
+  buildAllModules = new QAction(tr("Build all Verilog-A modules"), this);
+  buildAllModules->setStatusTip(tr("Build all Verilog-A modules of the project"));
+  buildAllModules->setWhatsThis(
+	tr("Build all Verilog-A modules\nBuilds all Verilog-A modules of the project in parallel, reusing the cached ones"));
+  connect(buildAllModules, SIGNAL(triggered()), SLOT(slotBuildAllModules()));
+
   loadModule = new QAction(tr("Load Verilog-A module..."), this);
   loadModule->setStatusTip(tr("Select Verilog-A symbols to be loaded"));
   loadModule->setWhatsThis(tr("Load Verilog-A module\nLet the user select and load symbols"));
@@ -804,6 +810,7 @@ void QucsApp::initMenuBar()
   projMenu->addSeparator();
   // TODO only enable if document is VA file
   projMenu->addAction(buildModule);
+  projMenu->addAction(buildAllModules);
   projMenu->addAction(loadModule);
 
   toolMenu = new QMenu(tr("&Tools"));  // menuBar entry toolMenu
@@ -40,6 +40,7 @@
 #include <QDebug>
 #include <QApplication>
 #include <QClipboard>
+#include <QTimer>
 
 #include "qucs.h"
 #include "schematic.h"
@@ -48,6 +49,7 @@
 #include "viewpainter.h"
 #include "mouseactions.h"
 #include "diagrams/diagrams.h"
+#include "diagrams/datasetindex.h"
 #include "paintings/paintings.h"
 #include "components/vhdlfile.h"
 #include "components/verilogfile.h"
@@ -65,6 +67,10 @@ Schematic::Schematic(QucsApp *App_, const QString& Name_)
     : QucsDoc(App_, Name_)
 {
   symbolMode = false;
+  MovingPreviewStart = MovingDX = MovingDY = 0;
+  MovingCacheValid = false;
+  MovingCacheX = MovingCacheY = 0;
+  MovingCacheScale = 0.0;
 
   // ...........................................................
   GridX  = GridY  = 10;
@@ -87,9 +93,9 @@ Schematic::Schematic(QucsApp *App_, const QString& Name_)
 
   // The 'i' means state for being unchanged.
   undoActionIdx = 0;
-  undoAction.append(new QString(" i\n</>\n</>\n</>\n</>\n"));
+  undoAction.append(" i\n</>\n</>\n</>\n</>\n");
   undoSymbolIdx = 0;
-  undoSymbol.append(new QString(" i\n</>\n</>\n</>\n</>\n"));
+  undoSymbol.append(" i\n</>\n</>\n</>\n</>\n");
 
   isVerilog = false;
   creatingLib = false;
@@ -221,7 +227,7 @@ void Schematic::becomeCurrent(bool update)
     emit signalUndoState(undoActionIdx != 0);
     emit signalRedoState(undoActionIdx != undoAction.size()-1);
     if(update)
-      reloadGraphs();   // load recent simulation data
+      reloadGraphs(true);   // load recent simulation data
   }
 }
 
@@ -240,6 +246,17 @@ void Schematic::setName (const QString& Name_)
     DataDisplay = base + ".sch";
 }
 
+// ---------------------------------------------------
+// Returns whether the undo stack holds more states than allowed or takes
+// more memory than allowed. The current state is always kept.
+static bool undoLimitExceeded(const UndoStack& stack)
+{
+  if(static_cast<unsigned int>(stack.size()) > QucsSettings.maxUndo)
+    return true;
+  return (stack.size() > 1) &&
+         (stack.memory() > qint64(QucsSettings.maxUndoMemory) << 20);
+}
+
 // ---------------------------------------------------
 // Sets the document to be changed or not to be changed.
 void Schematic::setChanged(bool c, bool fillStack, char Op)
@@ -258,20 +275,17 @@ void Schematic::setChanged(bool c, bool fillStack, char Op)
 
   // ................................................
   if(symbolMode) {  // for symbol edit mode
-    while(undoSymbol.size() > undoSymbolIdx + 1) {
-      delete undoSymbol.last();
-      undoSymbol.pop_back();
-    }
+    while(undoSymbol.size() > undoSymbolIdx + 1)
+      undoSymbol.removeLast();
 
-    undoSymbol.append(new QString(createSymbolUndoString(Op)));
+    undoSymbol.append(createSymbolUndoString(Op));
     undoSymbolIdx++;
 
     emit signalUndoState(true);
     emit signalRedoState(false);
 
-    while(static_cast<unsigned int>(undoSymbol.size()) > QucsSettings.maxUndo) { // "while..." because
-      delete undoSymbol.first();
-      undoSymbol.pop_front();
+    while(undoLimitExceeded(undoSymbol)) {
+      undoSymbol.removeFirst();
       undoSymbolIdx--;
     }
     return;
@@ -279,29 +293,25 @@ void Schematic::setChanged(bool c, bool fillStack, char Op)
 
   // ................................................
   // for schematic edit mode
-  while(undoAction.size() > undoActionIdx + 1) {
-    delete undoAction.last();
-    undoAction.pop_back();
-  }
+  while(undoAction.size() > undoActionIdx + 1)
+    undoAction.removeLast();
 
   if(Op == 'm') {   // only one for move marker
-    if (undoAction.at(undoActionIdx)->at(0) == Op) {
-      delete undoAction.last();
-      undoAction.pop_back();
+    if (undoAction.operation(undoActionIdx) == Op) {
+      undoAction.removeLast();
       undoActionIdx--;
     }
   }
 
-  undoAction.append(new QString(createUndoString(Op)));
+  undoAction.append(createUndoString(Op));
   undoActionIdx++;
 
   emit signalUndoState(true);
   emit signalRedoState(false);
 
-  while(static_cast<unsigned int>(undoAction.size()) > QucsSettings.maxUndo) { // "while..." because
-    delete undoAction.first(); // "maxUndo" could be decreased meanwhile
-    undoAction.pop_front();
-    undoActionIdx--;
+  while(undoLimitExceeded(undoAction)) { // "while..." because
+    undoAction.removeFirst();            // the limits could be decreased
+    undoActionIdx--;                     // meanwhile
   }
   return;
 }
@@ -391,43 +401,207 @@ void Schematic::paintFrame(ViewPainter *p)
   p->Painter->drawText(x1_+d, y1_+(d>>1), 0, 0, Qt::TextDontClip, Frame_Text0);
 }
 
+// -----------------------------------------------------------
+// Returns whether the rectangle (x1, y1)-(x2, y2) lies outside the area
+// (ax1, ay1)-(ax2, ay2).
+static inline bool outsideArea(int x1, int y1, int x2, int y2,
+                               int ax1, int ay1, int ax2, int ay2)
+{
+  return (x2 < ax1) || (x1 > ax2) || (y2 < ay1) || (y1 > ay2);
+}
+
 // -----------------------------------------------------------
 // Is called when the content (schematic or data display) has to be drawn.
-void Schematic::drawContents(QPainter *p, int, int, int, int)
+// Only the elements touching the area to be repainted (given in contents
+// coordinates) are drawn.
+void Schematic::drawContents(QPainter *p, int cX, int cY, int cW, int cH)
 {
   ViewPainter Painter;
 
   Painter.init(p, Scale, -ViewX1, -ViewY1, contentsX(), contentsY());
 
+  if(MovingPreview.isEmpty())
+    paintDocument(&Painter, cX, cY, cW, cH);
+  else {
+    // the document without the dragged elements is drawn once
+    if(!MovingCacheValid || MovingCacheX != contentsX() ||
+       MovingCacheY != contentsY() || MovingCacheScale != Scale ||
+       MovingCache.size() != viewport()->size()) {
+      MovingCache = QPixmap(viewport()->size());
+      MovingCache.fill(viewport()->palette().color(viewport()->backgroundRole()));
+      QPainter CachePainter(&MovingCache);
+      ViewPainter Cache;
+      Cache.init(&CachePainter, Scale, -ViewX1, -ViewY1, contentsX(), contentsY());
+      paintDocument(&Cache, contentsX(), contentsY(),
+                    visibleWidth(), visibleHeight());
+      MovingCacheValid = true;
+      MovingCacheX = contentsX();
+      MovingCacheY = contentsY();
+      MovingCacheScale = Scale;
+    }
+    p->drawPixmap(0, 0, MovingCache);
+
+    p->save();
+    p->setCompositionMode(QPainter::RasterOp_SourceAndNotDestination);
+    p->setPen(Qt::DotLine);
+    foreach(PostedPaintEvent e, MovingPreview) {
+      switch(e.pe) {
+        case _Rect:
+          Painter.drawRect(e.x1+MovingDX, e.y1+MovingDY, e.x2, e.y2);
+          break;
+        case _Line:
+          Painter.drawLine(e.x1+MovingDX, e.y1+MovingDY,
+                           e.x2+MovingDX, e.y2+MovingDY);
+          break;
+        case _Ellipse:
+          Painter.drawEllipse(e.x1+MovingDX, e.y1+MovingDY, e.x2, e.y2);
+          break;
+        case _Arc:
+          Painter.drawArc(e.x1+MovingDX, e.y1+MovingDY, e.x2, e.y2, e.a, e.b);
+          break;
+        default:
+          break;
+      }
+    }
+    p->restore();
+  }
+
+  /*
+   * The following events used to be drawn from mouseactions.cpp, but since Qt4
+   * Paint actions can only be called from within the paint event, so they
+   * are put into a QList (PostedPaintEvents) and processed here
+   */
+  for(int i=0;i<PostedPaintEvents.size();i++)
+  {
+    PostedPaintEvent p = PostedPaintEvents[i];
+
+    // a viewport painter lasts for one event only, thus it is set up
+    // for the events drawing on the viewport only
+    if(!p.PaintOnViewport)
+      switch(p.pe)
+      {
+        case _NotRop:
+          Painter.Painter->setCompositionMode(QPainter::RasterOp_SourceAndNotDestination);
+          break;
+        case _Rect:
+          Painter.drawRect(p.x1, p.y1, p.x2, p.y2);
+          break;
+        case _Line:
+          Painter.drawLine(p.x1, p.y1, p.x2, p.y2);
+          break;
+        case _Ellipse:
+          Painter.drawEllipse(p.x1, p.y1, p.x2, p.y2);
+          break;
+        case _Arc:
+          Painter.drawArc(p.x1, p.y1, p.x2, p.y2, p.a, p.b);
+          break;
+        case _DotLine:
+          Painter.Painter->setPen(Qt::DotLine);
+          break;
+        default:
+          break;
+      }
+    else if(p.pe == _Rect || p.pe == _Line || p.pe == _Ellipse || p.pe == _Arc)
+    {
+      QPainter painter2(viewport());
+      switch(p.pe)
+      {
+        case _Rect:
+          painter2.drawRect(p.x1, p.y1, p.x2, p.y2);
+          break;
+        case _Line:
+          painter2.drawLine(p.x1, p.y1, p.x2, p.y2);
+          break;
+        case _Ellipse:
+          painter2.drawEllipse(p.x1, p.y1, p.x2, p.y2);
+          break;
+        case _Arc:
+          painter2.drawArc(p.x1, p.y1, p.x2, p.y2, p.a, p.b);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  PostedPaintEvents.clear();
+
+}
+
+// -----------------------------------------------------------
+// Draws the elements touching the given area (in contents coordinates)
+// together with the grid and the frame.
+void Schematic::paintDocument(ViewPainter *pPainter, int cX, int cY, int cW, int cH)
+{
+  ViewPainter &Painter = *pPainter;
+
   paintGrid(&Painter, contentsX(), contentsY(),
             visibleWidth(), visibleHeight());
 
   if(!symbolMode)
     paintFrame(&Painter);
 
-  for(Component *pc = Components->first(); pc != 0; pc = Components->next())
+  // area to repaint in schematic coordinates, enlarged by some pixels
+  // for pen widths and selection markers
+  int d  = int(8.0 / Scale) + 8;
+  int ax1 = int(float(cX)/Scale) + ViewX1 - d;
+  int ay1 = int(float(cY)/Scale) + ViewY1 - d;
+  int ax2 = int(float(cX+cW)/Scale) + ViewX1 + d;
+  int ay2 = int(float(cY+cH)/Scale) + ViewY1 + d;
+
+  float Corr = textCorr();
+  int x1, y1, x2, y2;
+  for(Component *pc = Components->first(); pc != 0; pc = Components->next()) {
+    pc->entireBounds(x1, y1, x2, y2, Corr);
+    if(outsideArea(x1, y1, x2, y2, ax1, ay1, ax2, ay2)) continue;
     pc->paint(&Painter);
+  }
 
+  WireLabel *pl;
   for(Wire *pw = Wires->first(); pw != 0; pw = Wires->next()) {
-    pw->paint(&Painter);
-    if(pw->Label)
-      pw->Label->paint(&Painter);  // separate because of paintSelected
+    if(!outsideArea(pw->x1, pw->y1, pw->x2, pw->y2, ax1, ay1, ax2, ay2))
+      pw->paint(&Painter);
+    pl = pw->Label;
+    if(pl) {  // separate because of paintSelected
+      pl->getLabelBounding(x1, y1, x2, y2);
+      if(!outsideArea(qMin(x1, pl->cx), qMin(y1, pl->cy),
+                      qMax(x2, pl->cx), qMax(y2, pl->cy), ax1, ay1, ax2, ay2))
+        pl->paint(&Painter);
+    }
   }
 
   Node *pn;
   for(pn = Nodes->first(); pn != 0; pn = Nodes->next()) {
-    pn->paint(&Painter);
-    if(pn->Label)
-      pn->Label->paint(&Painter);  // separate because of paintSelected
+    if(!outsideArea(pn->cx, pn->cy, pn->cx, pn->cy, ax1, ay1, ax2, ay2))
+      pn->paint(&Painter);
+    pl = pn->Label;
+    if(pl) {  // separate because of paintSelected
+      pl->getLabelBounding(x1, y1, x2, y2);
+      if(!outsideArea(qMin(x1, pl->cx), qMin(y1, pl->cy),
+                      qMax(x2, pl->cx), qMax(y2, pl->cy), ax1, ay1, ax2, ay2))
+        pl->paint(&Painter);
+    }
   }
 
   // FIXME disable here, issue with select box goes away
   // also, instead of red, line turns blue
-  for(Diagram *pd = Diagrams->first(); pd != 0; pd = Diagrams->next())
+  int bx1, by1, bx2, by2;
+  for(Diagram *pd = Diagrams->first(); pd != 0; pd = Diagrams->next()) {
+    pd->Bounding(x1, y1, x2, y2);
+    foreach(Graph *pg, pd->Graphs)   // markers may lie outside
+      foreach(Marker *pm, pg->Markers) {
+        pm->Bounding(bx1, by1, bx2, by2);
+        x1 = qMin(x1, bx1);  y1 = qMin(y1, by1);
+        x2 = qMax(x2, bx2);  y2 = qMax(y2, by2);
+      }
+    if(outsideArea(x1, y1, x2, y2, ax1, ay1, ax2, ay2)) continue;
     pd->paint(&Painter);
+  }
 
-  for(Painting *pp = Paintings->first(); pp != 0; pp = Paintings->next())
+  for(Painting *pp = Paintings->first(); pp != 0; pp = Paintings->next()) {
+    pp->Bounding(x1, y1, x2, y2);
+    if(outsideArea(x1, y1, x2, y2, ax1, ay1, ax2, ay2)) continue;
     pp->paint(&Painter);
+  }
 
   if(showBias > 0) {  // show DC bias points in schematic ?
     int x, y, z;
@@ -449,64 +623,6 @@ void Schematic::drawContents(QPainter *p, int, int, int, int)
       Painter.drawText(pn->Name, x, y);
     }
   }
-
-  /*
-   * The following events used to be drawn from mouseactions.cpp, but since Qt4
-   * Paint actions can only be called from within the paint event, so they
-   * are put into a QList (PostedPaintEvents) and processed here
-   */
-  for(int i=0;i<PostedPaintEvents.size();i++)
-  {
-    PostedPaintEvent p = PostedPaintEvents[i];
-    QPainter painter2(viewport());
-
-    switch(p.pe)
-    {
-      case _NotRop:
-        if(p.PaintOnViewport)
-          painter2.setCompositionMode(QPainter::RasterOp_SourceAndNotDestination);
-        else
-          Painter.Painter->setCompositionMode(QPainter::RasterOp_SourceAndNotDestination);
-        break;
-      case _Rect:
-        if(p.PaintOnViewport)
-          painter2.drawRect(p.x1, p.y1, p.x2, p.y2);
-        else
-          Painter.drawRect(p.x1, p.y1, p.x2, p.y2);
-        break;
-      case _Line:
-        if(p.PaintOnViewport)
-          painter2.drawLine(p.x1, p.y1, p.x2, p.y2);
-        else
-          Painter.drawLine(p.x1, p.y1, p.x2, p.y2);
-        break;
-      case _Ellipse:
-        if(p.PaintOnViewport)
-          painter2.drawEllipse(p.x1, p.y1, p.x2, p.y2);
-        else
-          Painter.drawEllipse(p.x1, p.y1, p.x2, p.y2);
-        break;
-      case _Arc:
-        if(p.PaintOnViewport)
-          painter2.drawArc(p.x1, p.y1, p.x2, p.y2, p.a, p.b);
-        else
-          Painter.drawArc(p.x1, p.y1, p.x2, p.y2, p.a, p.b);
-        break;
-      case _DotLine:
-        Painter.Painter->setPen(Qt::DotLine);
-        break;
-      case _Translate:
-
-        painter2.translate(p.x1, p.y1);
-        break;
-      case _Scale:
-        painter2.scale(p.x1,p.y1);
-        break;
-    }
-
-  }
-  PostedPaintEvents.clear();
-
 }
 
 void Schematic::PostPaintEvent (PE pe, int x1, int y1, int x2, int y2, int a, int b, bool PaintOnViewport)
@@ -517,6 +633,40 @@ void Schematic::PostPaintEvent (PE pe, int x1, int y1, int x2, int y2, int a, in
   update();
 }
 
+// -----------------------------------------------------------
+// The events posted between beginMovingPreview() and endMovingPreview()
+// become the outline of the dragged elements. It is drawn at the offset
+// given by moveMovingPreview() until clearMovingPreview() is called.
+void Schematic::beginMovingPreview()
+{
+  MovingPreviewStart = PostedPaintEvents.size();
+}
+
+void Schematic::endMovingPreview()
+{
+  MovingPreview.clear();
+  MovingDX = MovingDY = 0;
+  while(PostedPaintEvents.size() > MovingPreviewStart)
+    MovingPreview.append(PostedPaintEvents.takeAt(MovingPreviewStart));
+  MovingCacheValid = false;
+  viewport()->update();
+}
+
+void Schematic::moveMovingPreview(int dx, int dy)
+{
+  MovingDX = dx;
+  MovingDY = dy;
+  viewport()->update();
+}
+
+void Schematic::clearMovingPreview()
+{
+  MovingPreview.clear();
+  MovingCache = QPixmap();
+  MovingCacheValid = false;
+  viewport()->update();
+}
+
 
 // ---------------------------------------------------
 void Schematic::contentsMouseMoveEvent(QMouseEvent *Event)
@@ -1261,12 +1411,87 @@ bool Schematic::mirrorYComponents()
 }
 
 // ---------------------------------------------------
-// Updates the graph data of all diagrams (load from data files).
-void Schematic::reloadGraphs()
+// Updates the graph data of all diagrams (load from data files).  If
+// "progressive" is set, the datasets are read on worker threads and the
+// diagrams are filled one by one from the event loop, so the view stays
+// responsive while loading large datasets.  "file" replaces the dataset
+// of the document, e.g. by the results of a simulation still running.
+void Schematic::reloadGraphs(bool progressive, const QString& file)
 {
   QFileInfo Info(DocName);
+  QString DataFile = Info.path()+QDir::separator()+DataSet;
+  if(!file.isEmpty())  DataFile = file;
+  GraphLoadFile = DataFile;
+  if(!progressive) {
+    GraphLoadQueue.clear();  // cancel pending background loading
+    for(Diagram *pd = Diagrams->first(); pd != 0; pd = Diagrams->next())
+      pd->loadGraphData(DataFile);
+    return;
+  }
+
+  for(Diagram *pd = Diagrams->first(); pd != 0; pd = Diagrams->next())
+    foreach(Graph *pg, pd->Graphs)
+      DataSetIndex::prefetch(pg->dataSetFile(DataFile));
+
+  bool running = !GraphLoadQueue.isEmpty();
+  GraphLoadQueue.clear();   // (re)start with all diagrams
   for(Diagram *pd = Diagrams->first(); pd != 0; pd = Diagrams->next())
-    pd->loadGraphData(Info.path()+QDir::separator()+DataSet);
+    GraphLoadQueue.append(pd);
+  if(!running)
+    QTimer::singleShot(0, this, SLOT(slotLoadGraphs()));
+}
+
+// ---------------------------------------------------
+// Returns true if the diagram lies at least partly within the visible
+// part of the document.
+bool Schematic::isVisible(Diagram *pd)
+{
+  int x1, y1, x2, y2;
+  pd->Bounding(x1, y1, x2, y2);
+  float vx1 = float(contentsX())/Scale + float(ViewX1);
+  float vy1 = float(contentsY())/Scale + float(ViewY1);
+  float vx2 = vx1 + float(visibleWidth())/Scale;
+  float vy2 = vy1 + float(visibleHeight())/Scale;
+  return x2 >= vx1 && x1 <= vx2 && y2 >= vy1 && y1 <= vy2;
+}
+
+// ---------------------------------------------------
+// Loads the graph data of the next diagram once its datasets are
+// available. Diagrams within the view are filled first, the others
+// afterwards.
+void Schematic::slotLoadGraphs()
+{
+  Diagram *pd = 0;
+  QMutableListIterator<Diagram *> it(GraphLoadQueue);
+  while(it.hasNext()) {
+    Diagram *p = it.next();
+    if(Diagrams->findRef(p) < 0) {
+      it.remove();    // deleted meanwhile
+      continue;
+    }
+    if(!pd)  pd = p;
+    if(isVisible(p)) {
+      pd = p;
+      break;
+    }
+  }
+  if(!pd)  return;    // all diagrams loaded or cancelled
+
+  QString DataFile = GraphLoadFile;
+  foreach(Graph *pg, pd->Graphs)
+    if(!DataSetIndex::isReady(pg->dataSetFile(DataFile))) {
+      QTimer::singleShot(20, this, SLOT(slotLoadGraphs()));  // wait
+      return;
+    }
+
+  pd->loadGraphData(DataFile);
+  QFileInfo Info(DocName);
+  if(DataFile != Info.path()+QDir::separator()+DataSet)
+    foreach(Graph *pg, pd->Graphs)
+      pg->lastLoaded = QDateTime();  // temporary data, reload later anyway
+  GraphLoadQueue.removeAll(pd);
+  viewport()->update();
+  QTimer::singleShot(0, this, SLOT(slotLoadGraphs()));
 }
 
 // Copy function, 
@@ -1275,6 +1500,22 @@ void Schematic::copy()
   QString s = createClipboardFile();
   QClipboard *cb = QApplication::clipboard();  // get system clipboard
   if (!s.isEmpty()) {
+    QList<Component *> List;
+    bool cloned = true;
+    for(Component *pc = Components->first(); pc != 0; pc = Components->next())
+      if(pc->isSelected) {
+        Component *c = pc->clone();
+        if(!c) {   // not to be cloned, paste the text then
+          cloned = false;
+          break;
+        }
+        List.append(c);
+      }
+    if(!cloned) {
+      qDeleteAll(List);
+      List.clear();
+    }
+    setClipboardComponents(cloned ? s : QString(), List);
     cb->setText(s, QClipboard::Clipboard);
   }
 }
@@ -1309,23 +1550,17 @@ bool Schematic::load()
   if(!loadDocument()) return false;
   lastSaved = QDateTime::currentDateTime();
 
-  while(!undoAction.isEmpty()) {
-    delete undoAction.last();
-    undoAction.pop_back();
-  }
+  undoAction.clear();
   undoActionIdx = 0;
-  while(!undoSymbol.isEmpty()) {
-    delete undoSymbol.last();
-    undoSymbol.pop_back();
-  }
+  undoSymbol.clear();
   symbolMode = true;
   setChanged(false, true); // "not changed" state, but put on undo stack
   undoSymbolIdx = 0;
-  undoSymbol.at(undoSymbolIdx)->replace(1, 1, 'i');
+  undoSymbol.setUnchanged(undoSymbolIdx, true);
   symbolMode = false;
   setChanged(false, true); // "not changed" state, but put on undo stack
   undoActionIdx = 0;
-  undoAction.at(undoActionIdx)->replace(1, 1, 'i');
+  undoAction.setUnchanged(undoActionIdx, true);
 
   // The undo stack of the circuit symbol is initialized when first
   // entering its edit mode.
@@ -1358,18 +1593,15 @@ int Schematic::save()
   if(result >= 0) {
     setChanged(false);
 
-    QVector<QString *>::iterator it;
-    for (it = undoAction.begin(); it != undoAction.end(); it++) {
-      (*it)->replace(1, 1, ' '); //at(1) = ' '; state of being changed
+    for (int i = 0; i < undoAction.size(); i++) {
+      undoAction.setUnchanged(i, false); // state of being changed
     }
-    //(1) = 'i';   // state of being unchanged
-    undoAction.at(undoActionIdx)->replace(1, 1, 'i');
+    undoAction.setUnchanged(undoActionIdx, true); // state of being unchanged
 
-    for (it = undoSymbol.begin(); it != undoSymbol.end(); it++) {
-      (*it)->replace(1, 1, ' '); //at(1) = ' '; state of being changed
+    for (int i = 0; i < undoSymbol.size(); i++) {
+      undoSymbol.setUnchanged(i, false); // state of being changed
     }
-    //at(1) = 'i';   // state of being unchanged
-    undoSymbol.at(undoSymbolIdx)->replace(1, 1, 'i');
+    undoSymbol.setUnchanged(undoSymbolIdx, true); // state of being unchanged
   }
   // update the subcircuit file lookup hashes
   QucsMain->updateSchNameHash();
@@ -1621,14 +1853,15 @@ bool Schematic::undo()
   if(symbolMode) {
     if (undoSymbolIdx == 0) { return false; }
 
-    rebuildSymbol(undoSymbol.at(--undoSymbolIdx));
+    QString state = undoSymbol.at(--undoSymbolIdx);
+    rebuildSymbol(&state);
     adjustPortNumbers();  // set port names
 
     emit signalUndoState(undoSymbolIdx != 0);
     emit signalRedoState(undoSymbolIdx != undoSymbol.size()-1);
 
-    if(undoSymbol.at(undoSymbolIdx)->at(1) == 'i' && 
-        undoAction.at(undoActionIdx)->at(1) == 'i') {
+    if(undoSymbol.isUnchanged(undoSymbolIdx) && 
+        undoAction.isUnchanged(undoActionIdx)) {
       setChanged(false, false);
       return true;
     }
@@ -1641,18 +1874,19 @@ bool Schematic::undo()
   // ...... for schematic edit mode .......
   if (undoActionIdx == 0) { return false; }
 
-  rebuild(undoAction.at(--undoActionIdx));
+  QString state = undoAction.at(--undoActionIdx);
+  rebuild(&state);
   reloadGraphs();  // load recent simulation data
 
   emit signalUndoState(undoActionIdx != 0);
   emit signalRedoState(undoActionIdx != undoAction.size()-1);
 
-  if(undoAction.at(undoActionIdx)->at(1) == 'i') {
+  if(undoAction.isUnchanged(undoActionIdx)) {
     if(undoSymbol.isEmpty()) {
       setChanged(false, false);
       return true;
     }
-    else if(undoSymbol.at(undoSymbolIdx)->at(1) == 'i') {
+    else if(undoSymbol.isUnchanged(undoSymbolIdx)) {
       setChanged(false, false);
       return true;
     }
@@ -1668,14 +1902,15 @@ bool Schematic::redo()
   if(symbolMode) {
     if (undoSymbolIdx == undoSymbol.size() - 1) { return false; }
 
-    rebuildSymbol(undoSymbol.at(++undoSymbolIdx));
+    QString state = undoSymbol.at(++undoSymbolIdx);
+    rebuildSymbol(&state);
     adjustPortNumbers();  // set port names
 
     emit signalUndoState(undoSymbolIdx != 0);
     emit signalRedoState(undoSymbolIdx != undoSymbol.size()-1);
 
-    if(undoSymbol.at(undoSymbolIdx)->at(1) == 'i'
-        && undoAction.at(undoActionIdx)->at(1) == 'i') {
+    if(undoSymbol.isUnchanged(undoSymbolIdx)
+        && undoAction.isUnchanged(undoActionIdx)) {
       setChanged(false, false);
       return true;
     }
@@ -1689,18 +1924,19 @@ bool Schematic::redo()
   // ...... for schematic edit mode .......
   if (undoActionIdx == undoAction.size()-1) { return false; }
 
-  rebuild(undoAction.at(++undoActionIdx));
+  QString state = undoAction.at(++undoActionIdx);
+  rebuild(&state);
   reloadGraphs();  // load recent simulation data
 
   emit signalUndoState(undoActionIdx != 0);
   emit signalRedoState(undoActionIdx != undoAction.size()-1);
 
-  if (undoAction.at(undoActionIdx)->at(1) == 'i') {
+  if (undoAction.isUnchanged(undoActionIdx)) {
     if(undoSymbol.isEmpty()) {
       setChanged(false, false);
       return true;
     }
-    else if(undoSymbol.at(undoSymbolIdx)->at(1) == 'i') {
+    else if(undoSymbol.isUnchanged(undoSymbolIdx)) {
       setChanged(false, false);
       return true;
     }
@@ -30,6 +30,7 @@
 #include "wire.h"
 #include "node.h"
 #include "qucsdoc.h"
+#include "undostack.h"
 #include "viewpainter.h"
 #include "diagrams/diagram.h"
 #include "paintings/painting.h"
@@ -38,6 +39,9 @@
 #include <Q3ScrollView>
 #include <Q3PtrList>
 #include <QVector>
+#include <QHash>
+#include <QPixmap>
+#include <QRect>
 #include <QStringList>
 #include <QFileInfo>
 
@@ -75,11 +79,48 @@ struct SubFile {
 };
 typedef QMap<QString, SubFile> SubMap;
 
+// Edge length of the grid cells of the spatial indices.
+#define SPATIAL_CELL  64
+
+// Keeps the wires sorted into grid cells, so that the wires lying at a
+// position are found without walking the whole list. A wire is filed
+// under every cell its extents touch. As the lists are modified by
+// their non-virtual functions, the index is only maintained if they are
+// called through the derived class.
 // TODO: refactor here
 class WireList : public Q3PtrList<Wire> {
+public:
+  void  append(const Wire*);
+  bool  removeRef(const Wire*);
+  bool  remove();
+  Wire* take();
+  Wire* take(uint);
+  void  clear();
+  void  update(Wire*);   // call after enlarging a wire of the list
+  QList<Wire*> find(int, int, int d=0) const;
+
+private:
+  void  addIndex(Wire*);
+  void  removeIndex(Wire*);
+  QHash<qint64, QList<Wire*> > Cells;
+  QHash<Wire*, QRect> Extents;   // cells a wire is filed under
 };
+
+// Keeps the nodes sorted into grid cells, so that the node at a
+// position is found without walking the whole list. The coordinates
+// of nodes never change, nodes are replaced instead.
 // TODO: refactor here
 class NodeList : public Q3PtrList<Node> {
+public:
+  void  append(const Node*);
+  bool  removeRef(const Node*);
+  bool  remove();
+  void  clear();
+  Node* find(int, int) const;
+  Node* findNear(int, int, int) const;
+
+private:
+  QHash<qint64, QList<Node*> > Cells;
 };
 // TODO: refactor here
 class DiagramList : public Q3PtrList<Diagram> {
@@ -107,6 +148,13 @@ public:
 
   void PostPaintEvent(PE pe, int x1=0, int y1=0, int x2=0, int y2=0, int a=0, int b=0,bool PaintOnViewport=false);
 
+  // outline of the elements dragged as a whole, see MouseActions::MMoveMoving
+  void beginMovingPreview();
+  void endMovingPreview();
+  void moveMovingPreview(int, int);
+  void clearMovingPreview();
+  bool hasMovingPreview() const { return !MovingPreview.isEmpty(); }
+
   float textCorr();
   bool sizeOfFrame(int&, int&);
   void  sizeOfAll(int&, int&, int&, int&);
@@ -123,7 +171,7 @@ public:
   void  enlargeView(int, int, int, int);
   void  switchPaintMode();
   int   adjustPortNumbers();
-  void  reloadGraphs();
+  void  reloadGraphs(bool progressive=false, const QString& file=QString());
   bool  createSubcircuitSymbol();
 
   void    cut();
@@ -177,9 +225,9 @@ public:
   int tmpUsedX1, tmpUsedY1, tmpUsedX2, tmpUsedY2;
 
   int undoActionIdx;
-  QVector<QString *> undoAction;
+  UndoStack undoAction;
   int undoSymbolIdx;
-  QVector<QString *> undoSymbol;    // undo stack for circuit symbol
+  UndoStack undoSymbol;    // undo stack for circuit symbol
 
   /*! \brief Get (schematic) file reference */
   QFileInfo getFileInfo (void) { return FileInfo; }
@@ -194,9 +242,10 @@ signals:
 
 protected:
   void paintFrame(ViewPainter*);
+  void paintDocument(ViewPainter*, int, int, int, int);
 
   // overloaded function to get actions of user
-  void drawContents(QPainter*, int, int, int, int);
+  void drawContents(QPainter*, int, int, int, int);   // area to repaint
   void contentsMouseMoveEvent(QMouseEvent*);
   void contentsMousePressEvent(QMouseEvent*);
   void contentsMouseDoubleClickEvent(QMouseEvent*);
@@ -213,8 +262,24 @@ protected slots:
   void slotScrollLeft();
   void slotScrollRight();
 
+private slots:
+  void slotLoadGraphs();
+
 private:
   bool dragIsOkay;
+
+  // While a selection is dragged the rest of the document does not
+  // change, it is drawn into a pixmap once. The outline of the dragged
+  // elements is recorded once and drawn at the current offset.
+  QList<PostedPaintEvent> MovingPreview;
+  int MovingPreviewStart, MovingDX, MovingDY;
+  QPixmap MovingCache;
+  bool MovingCacheValid;
+  int MovingCacheX, MovingCacheY;
+  float MovingCacheScale;
+  QList<Diagram *> GraphLoadQueue;  // diagrams still to be loaded
+  QString GraphLoadFile;  // dataset of the diagrams loading
+  bool isVisible(Diagram*);
   /*! \brief hold system-independent information about a schematic file */
   QFileInfo FileInfo;
 
@@ -320,6 +385,13 @@ private:
   QString createClipboardFile();
   bool    pasteFromClipboard(QTextStream *, Q3PtrList<Element>*);
 
+  // The components of the last copy within this instance. They are
+  // cloned on paste instead of being loaded from the clipboard text,
+  // as long as the clipboard still holds that text.
+  static QString ClipboardText;
+  static QList<Component *> ClipboardComponents;
+  static void setClipboardComponents(const QString&, const QList<Component *>&);
+
   QString createUndoString(char);
   bool    rebuild(QString *);
   QString createSymbolUndoString(char);
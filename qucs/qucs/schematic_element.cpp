@@ -19,9 +19,202 @@
 
 #include "schematic.h"
 #include <Q3PtrList>
+#include <QVector>
 #include <QDebug>
 
 
+/* *******************************************************************
+   *****                                                         *****
+   *****            Spatial indices of nodes and wires           *****
+   *****                                                         *****
+   ******************************************************************* */
+
+// Returns the key of the grid cell with the given cell coordinates.
+static inline qint64 cellKey(int cx, int cy)
+{
+    return qint64((quint64(quint32(cx)) << 32) | quint32(cy));
+}
+
+// Returns the cell coordinate of a schematic coordinate (rounds down).
+static inline int cellOf(int v)
+{
+    return v >= 0 ? v / SPATIAL_CELL : -((SPATIAL_CELL - 1 - v) / SPATIAL_CELL);
+}
+
+// ---------------------------------------------------
+void WireList::addIndex(Wire *w)
+{
+    QRect r(QPoint(cellOf(qMin(w->x1, w->x2)), cellOf(qMin(w->y1, w->y2))),
+            QPoint(cellOf(qMax(w->x1, w->x2)), cellOf(qMax(w->y1, w->y2))));
+    Extents.insert(w, r);
+    for(int i = r.left(); i <= r.right(); i++)
+        for(int j = r.top(); j <= r.bottom(); j++)
+            Cells[cellKey(i, j)].append(w);
+}
+
+// ---------------------------------------------------
+// Does not touch the wire, since it may already be deleted.
+void WireList::removeIndex(Wire *w)
+{
+    QHash<Wire*, QRect>::iterator it = Extents.find(w);
+    if(it == Extents.end()) return;
+    QRect r = it.value();
+    Extents.erase(it);
+    for(int i = r.left(); i <= r.right(); i++)
+        for(int j = r.top(); j <= r.bottom(); j++)
+        {
+            QHash<qint64, QList<Wire*> >::iterator c = Cells.find(cellKey(i, j));
+            if(c == Cells.end()) continue;
+            c.value().removeOne(w);
+            if(c.value().isEmpty()) Cells.erase(c);
+        }
+}
+
+// ---------------------------------------------------
+void WireList::append(const Wire *w)
+{
+    Q3PtrList<Wire>::append(w);
+    addIndex((Wire*)w);
+}
+
+// ---------------------------------------------------
+bool WireList::removeRef(const Wire *w)
+{
+    if(findRef(w) < 0) return false;
+    return remove();
+}
+
+// ---------------------------------------------------
+bool WireList::remove()
+{
+    Wire *w = current();
+    if(w == 0) return false;
+    removeIndex(w);
+    return Q3PtrList<Wire>::remove();
+}
+
+// ---------------------------------------------------
+Wire* WireList::take()
+{
+    Wire *w = Q3PtrList<Wire>::take();
+    if(w) removeIndex(w);
+    return w;
+}
+
+// ---------------------------------------------------
+Wire* WireList::take(uint i)
+{
+    Wire *w = Q3PtrList<Wire>::take(i);
+    if(w) removeIndex(w);
+    return w;
+}
+
+// ---------------------------------------------------
+void WireList::clear()
+{
+    Cells.clear();
+    Extents.clear();
+    Q3PtrList<Wire>::clear();
+}
+
+// ---------------------------------------------------
+// Files the wire anew after its coordinates have changed. A wire that
+// only got shorter is still found, but would be offered as a candidate
+// for cells it does not reach anymore.
+void WireList::update(Wire *w)
+{
+    if(!Extents.contains(w)) return;
+    removeIndex(w);
+    addIndex(w);
+}
+
+// ---------------------------------------------------
+// Returns the wires that may lie within the distance "d" of the given
+// position, in no particular order. The caller has to check them.
+QList<Wire*> WireList::find(int x, int y, int d) const
+{
+    QList<Wire*> found;
+    for(int i = cellOf(x-d); i <= cellOf(x+d); i++)
+        for(int j = cellOf(y-d); j <= cellOf(y+d); j++)
+        {
+            QHash<qint64, QList<Wire*> >::const_iterator c =
+                Cells.constFind(cellKey(i, j));
+            if(c == Cells.constEnd()) continue;
+            foreach(Wire *w, c.value())
+                if(!found.contains(w)) found.append(w);
+        }
+    return found;
+}
+
+// ---------------------------------------------------
+void NodeList::append(const Node *n)
+{
+    Q3PtrList<Node>::append(n);
+    Cells[cellKey(cellOf(n->cx), cellOf(n->cy))].append((Node*)n);
+}
+
+// ---------------------------------------------------
+bool NodeList::removeRef(const Node *n)
+{
+    if(findRef(n) < 0) return false;
+    return remove();
+}
+
+// ---------------------------------------------------
+bool NodeList::remove()
+{
+    Node *n = current();
+    if(n == 0) return false;
+    QHash<qint64, QList<Node*> >::iterator c =
+        Cells.find(cellKey(cellOf(n->cx), cellOf(n->cy)));
+    if(c != Cells.end())
+    {
+        c.value().removeOne(n);
+        if(c.value().isEmpty()) Cells.erase(c);
+    }
+    return Q3PtrList<Node>::remove();
+}
+
+// ---------------------------------------------------
+void NodeList::clear()
+{
+    Cells.clear();
+    Q3PtrList<Node>::clear();
+}
+
+// ---------------------------------------------------
+// Returns the node lying exactly at the given position, or 0.
+Node* NodeList::find(int x, int y) const
+{
+    QHash<qint64, QList<Node*> >::const_iterator c =
+        Cells.constFind(cellKey(cellOf(x), cellOf(y)));
+    if(c != Cells.constEnd())
+        foreach(Node *n, c.value())
+            if(n->cx == x) if(n->cy == y)
+                return n;
+    return 0;
+}
+
+// ---------------------------------------------------
+// Returns a node lying within the distance "d" of the given position
+// (in both directions), or 0.
+Node* NodeList::findNear(int x, int y, int d) const
+{
+    for(int i = cellOf(x-d); i <= cellOf(x+d); i++)
+        for(int j = cellOf(y-d); j <= cellOf(y+d); j++)
+        {
+            QHash<qint64, QList<Node*> >::const_iterator c =
+                Cells.constFind(cellKey(i, j));
+            if(c == Cells.constEnd()) continue;
+            foreach(Node *n, c.value())
+                if(n->cx-d <= x) if(n->cx+d >= x)
+                    if(n->cy-d <= y) if(n->cy+d >= y)
+                        return n;
+        }
+    return 0;
+}
+
+
 /* *******************************************************************
    *****                                                         *****
    *****              Actions handling the nodes                 *****
@@ -32,25 +225,21 @@
 // the coordinates are identical. The node is returned.
 Node* Schematic::insertNode(int x, int y, Element *e)
 {
-    Node *pn;
     // check if new node lies upon existing node
-    for(pn = Nodes->first(); pn != 0; pn = Nodes->next())  // check every node
-        if(pn->cx == x) if(pn->cy == y)
-            {
-                pn->Connections.append(e);
-                break;
-            }
-
-    if(pn == 0)   // create new node, if no existing one lies at this position
+    Node *pn = Nodes->find(x, y);
+    if(pn != 0)
     {
-        pn = new Node(x, y);
-        Nodes->append(pn);
-        pn->Connections.append(e);  // connect schematic node to component node
+        pn->Connections.append(e);
+        return pn;   // return, if node is not new
     }
-    else return pn;   // return, if node is not new
+
+    // create new node, if no existing one lies at this position
+    pn = new Node(x, y);
+    Nodes->append(pn);
+    pn->Connections.append(e);  // connect schematic node to component node
 
     // check if the new node lies upon an existing wire
-    for(Wire *pw = Wires->first(); pw != 0; pw = Wires->next())
+    foreach(Wire *pw, Wires->find(x, y))
     {
         if(pw->x1 == x)
         {
@@ -75,11 +264,7 @@ Node* Schematic::insertNode(int x, int y, Element *e)
 // ---------------------------------------------------
 Node* Schematic::selectedNode(int x, int y)
 {
-    for(Node *pn = Nodes->first(); pn != 0; pn = Nodes->next()) // test nodes
-        if(pn->getSelected(x, y))
-            return pn;
-
-    return 0;
+    return Nodes->findNear(x, y, 5);   // same range as Node::getSelected
 }
 
 
@@ -94,10 +279,8 @@ Node* Schematic::selectedNode(int x, int y)
 // If 2 is returned, the wire line ended.
 int Schematic::insertWireNode1(Wire *w)
 {
-    Node *pn;
     // check if new node lies upon an existing node
-    for(pn = Nodes->first(); pn != 0; pn = Nodes->next()) // check every node
-        if(pn->cx == w->x1) if(pn->cy == w->y1) break;
+    Node *pn = Nodes->find(w->x1, w->y1);
 
     if(pn != 0)
     {
@@ -109,7 +292,7 @@ int Schematic::insertWireNode1(Wire *w)
 
 
     // check if the new node lies upon an existing wire
-    for(Wire *ptr2 = Wires->first(); ptr2 != 0; ptr2 = Wires->next())
+    foreach(Wire *ptr2, Wires->find(w->x1, w->y1))
     {
         if(ptr2->x1 == w->x1)
         {
@@ -344,10 +527,8 @@ bool Schematic::connectVWires1(Wire *w)
 // If 2 is returned, the wire line ended.
 int Schematic::insertWireNode2(Wire *w)
 {
-    Node *pn;
     // check if new node lies upon an existing node
-    for(pn = Nodes->first(); pn != 0; pn = Nodes->next())  // check every node
-        if(pn->cx == w->x2) if(pn->cy == w->y2) break;
+    Node *pn = Nodes->find(w->x2, w->y2);
 
     if(pn != 0)
     {
@@ -359,7 +540,7 @@ int Schematic::insertWireNode2(Wire *w)
 
 
     // check if the new node lies upon an existing wire
-    for(Wire *ptr2 = Wires->first(); ptr2 != 0; ptr2 = Wires->next())
+    foreach(Wire *ptr2, Wires->find(w->x2, w->y2))
     {
         if(ptr2->x1 == w->x2)
         {
@@ -710,6 +891,7 @@ int Schematic::insertWire(Wire *w)
             pw->x1 = pn2->cx;
             pw->y1 = pn2->cy;
             pw->Port1 = pn2;
+            Wires->update(pw);
             pn2->Connections.append(pw);
 
             pn = Nodes->next();
@@ -743,7 +925,7 @@ void Schematic::selectWireLine(Element *pe, Node *pn, bool ctrl)
 // ---------------------------------------------------
 Wire* Schematic::selectedWire(int x, int y)
 {
-    for(Wire *pw = Wires->first(); pw != 0; pw = Wires->next())
+    foreach(Wire *pw, Wires->find(x, y, 5))   // range of Wire::getSelected
         if(pw->getSelected(x, y))
             return pw;
 
@@ -760,6 +942,7 @@ Wire* Schematic::splitWire(Wire *pw, Node *pn)
     pw->x2 = pn->cx;
     pw->y2 = pn->cy;
     pw->Port2 = pn;
+    Wires->update(pw);
 
     newWire->Port2->Connections.prepend(newWire);
     pn->Connections.prepend(pw);
@@ -813,6 +996,7 @@ bool Schematic::oneTwoWires(Node *n)
                 e1->x2 = e2->x2;
                 e1->y2 = e2->y2;
                 e1->Port2 = e2->Port2;
+                Wires->update(e1);
                 Nodes->removeRef(n);    // delete node (is auto delete)
                 e1->Port2->Connections.removeRef(e2);
                 e1->Port2->Connections.append(e1);
@@ -2966,15 +3150,16 @@ void Schematic::oneLabel(Node *n1)
     Element *pe;
     WireLabel *pl = 0;
     bool named=false;   // wire line already named ?
-    Q3PtrList<Node> Cons;
+    QVector<Node*> Cons;
 
     for(pn = Nodes->first(); pn!=0; pn = Nodes->next())
         pn->y1 = 0;   // mark all nodes as not checked
 
     Cons.append(n1);
     n1->y1 = 1;  // mark Node as already checked
-    for(pn = Cons.first(); pn!=0; pn = Cons.next())
+    for(int i = 0; i < Cons.size(); i++)
     {
+        pn = Cons.at(i);
         if(pn->Label)
         {
             if(named)
@@ -3014,7 +3199,6 @@ void Schematic::oneLabel(Node *n1)
             if(pNode->y1) continue;
             pNode->y1 = 1;  // mark Node as already checked
             Cons.append(pNode);
-            Cons.findRef(pn);
 
             if(pw->Label)
             {
@@ -3073,36 +3257,37 @@ Element* Schematic::getWireLabel(Node *pn_)
     Wire *pw;
     Node *pn, *pNode;
     Element *pe;
-    Q3PtrList<Node> Cons;
+    QVector<Node*> Cons;
 
     for(pn = Nodes->first(); pn!=0; pn = Nodes->next())
         pn->y1 = 0;   // mark all nodes as not checked
 
     Cons.append(pn_);
     pn_->y1 = 1;  // mark Node as already checked
-    for(pn = Cons.first(); pn!=0; pn = Cons.next())
+    for(int i = 0; i < Cons.size(); i++)
+    {
+        pn = Cons.at(i);
         if(pn->Label) return pn;
-        else
-            for(pe = pn->Connections.first(); pe!=0; pe = pn->Connections.next())
+        for(pe = pn->Connections.first(); pe!=0; pe = pn->Connections.next())
+        {
+            if(pe->Type != isWire)
             {
-                if(pe->Type != isWire)
-                {
-                    if(((Component*)pe)->isActive == COMP_IS_ACTIVE)
-                        if(((Component*)pe)->obsolete_model_hack() == "GND") return pe;
-                    continue;
-                }
+                if(((Component*)pe)->isActive == COMP_IS_ACTIVE)
+                    if(((Component*)pe)->obsolete_model_hack() == "GND") return pe;
+                continue;
+            }
 
-                pw = (Wire*)pe;
-                if(pw->Label) return pw;
+            pw = (Wire*)pe;
+            if(pw->Label) return pw;
 
-                if(pn != pw->Port1) pNode = pw->Port1;
-                else pNode = pw->Port2;
+            if(pn != pw->Port1) pNode = pw->Port1;
+            else pNode = pw->Port2;
 
-                if(pNode->y1) continue;
-                pNode->y1 = 1;  // mark Node as already checked
-                Cons.append(pNode);
-                Cons.findRef(pn);
-            }
+            if(pNode->y1) continue;
+            pNode->y1 = 1;  // mark Node as already checked
+            Cons.append(pNode);
+        }
+    }
     return 0;   // no wire label found
 }
 
@@ -29,6 +29,9 @@
 #include <QList>
 #include <QProcess>
 #include <QDebug>
+#include <QHash>
+#include <QFileInfo>
+#include <QDateTime>
 
 #include "qucs.h"
 #include "node.h"
@@ -39,6 +42,7 @@
 #include "components/vhdlfile.h"
 #include "components/verilogfile.h"
 #include "components/libcomp.h"
+#include "components/symbolcache.h"
 #include "module.h"
 #include "misc.h"
 
@@ -47,6 +51,55 @@
 // global to also work within the subcircuits.
 SubMap FileList;
 
+// The netlist of a subcircuit schematic as it has been emitted, together
+// with everything its netlisting changed. It is reused as long as neither
+// the file nor one of the subcircuits netlisted within has changed.
+struct SubNetlist {
+  QString Text;          // written into the netlist stream
+  QStringList PortTypes; // in/out signal types of the subcircuit
+  QStringList Collect;   // nodesets collected
+  int countInit;         // nodeset counter after netlisting
+  SubMap Files;          // subcircuits netlisted within
+  QMap<QString, QPair<QDateTime, qint64> > Stamps; // state of the files
+};
+static QHash<QString, SubNetlist> SubNetlists;
+
+// Returns whether the file is still in the given state.
+static bool subFileUnchanged(const QString& f, const QPair<QDateTime, qint64>& st)
+{
+  QFileInfo Info(f);
+  return Info.exists() && (Info.lastModified() == st.first) &&
+         (Info.size() == st.second);
+}
+
+// Returns whether the netlist can be reused: None of the files changed
+// and none of the inner subcircuits is in the netlist already.
+static bool subNetlistReusable(const SubNetlist& n)
+{
+  QMap<QString, QPair<QDateTime, qint64> >::const_iterator st;
+  for(st = n.Stamps.constBegin(); st != n.Stamps.constEnd(); ++st)
+    if(!subFileUnchanged(st.key(), st.value()))  return false;
+
+  SubMap::const_iterator it;
+  for(it = n.Files.constBegin(); it != n.Files.constEnd(); ++it)
+    if(FileList.contains(it.key()))  return false;
+  return true;
+}
+
+
+QString Schematic::ClipboardText;
+QList<Component *> Schematic::ClipboardComponents;
+
+// -------------------------------------------------------------
+// Keeps the copied components for pasting them into any document of
+// this instance. An empty text means they have to be loaded again.
+void Schematic::setClipboardComponents(const QString& Text,
+                                       const QList<Component *>& List)
+{
+  qDeleteAll(ClipboardComponents);
+  ClipboardComponents = List;
+  ClipboardText = Text;
+}
 
 // -------------------------------------------------------------
 // Creates a Qucs file format (without document properties) in the returning
@@ -166,10 +219,28 @@ bool Schematic::pasteFromClipboard(QTextStream *stream, Q3PtrList<Element> *pe)
     return true;
   }
 
+  // components copied within this instance are cloned, the symbols of
+  // subcircuits and libraries are taken from the symbol cache then
+  bool cloned = !ClipboardText.isEmpty() && stream->string() &&
+                *stream->string() == ClipboardText;
+
   // read content in schematic edit mode *************************
   while(!stream->atEnd()) {
     Line = stream->readLine();
     if(Line == "<Components>") {
+      if(cloned) {
+        if(!loadIntoNothing(stream)) return false;
+        foreach(Component *pc, ClipboardComponents) {
+          Component *c = pc->clone();
+          int z;
+          for(z=c->name().length()-1; z>=0; z--) // cut off number of component name
+            if(!c->name().at(z).isDigit()) break;
+          c->obsolete_name_override_hack(c->name().left(z+1));
+          c->setSchematic(this);
+          pe->append(c);
+        }
+      }
+      else
       if(!loadComponents(stream, (Q3PtrList<Component>*)pe)) return false; }
     else
     if(Line == "<Wires>") {
@@ -352,6 +423,7 @@ int Schematic::saveDocument()
 				QObject::tr("Cannot save document!"));
     return -1;
   }
+  SymbolCache::forget(DocName);   // instances must not use the old symbol
 
   QTextStream stream(&file);
 
@@ -621,16 +693,15 @@ void Schematic::simpleInsertComponent(Component *c)
     y = pp->y+c->cy;
 
     // check if new node lies upon existing node
-    for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next())
-      if(pn->cx == x) if(pn->cy == y) {
-	if (!pn->DType.isEmpty()) {
-	  pp->Type = pn->DType;
-	}
-	if (!pp->Type.isEmpty()) {
-	  pn->DType = pp->Type;
-	}
-	break;
+    pn = DocNodes.find(x, y);
+    if(pn) {
+      if (!pn->DType.isEmpty()) {
+	pp->Type = pn->DType;
       }
+      if (!pp->Type.isEmpty()) {
+	pn->DType = pp->Type;
+      }
+    }
 
     if(pn == 0) { // create new node, if no existing one lies at this position
       pn = new Node(x, y);
@@ -684,8 +755,7 @@ void Schematic::simpleInsertWire(Wire *pw)
 {
   Node *pn;
   // check if first wire node lies upon existing node
-  for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next())
-    if(pn->cx == pw->x1) if(pn->cy == pw->y1) break;
+  pn = DocNodes.find(pw->x1, pw->y1);
 
   if(!pn) {   // create new node, if no existing one lies at this position
     pn = new Node(pw->x1, pw->y1);
@@ -705,8 +775,7 @@ void Schematic::simpleInsertWire(Wire *pw)
   pw->Port1 = pn;
 
   // check if second wire node lies upon existing node
-  for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next())
-    if(pn->cx == pw->x2) if(pn->cy == pw->y2) break;
+  pn = DocNodes.find(pw->x2, pw->y2);
 
   if(!pn) {   // create new node, if no existing one lies at this position
     pn = new Node(pw->x2, pw->y2);
@@ -868,8 +937,13 @@ bool Schematic::loadDocument()
   // Keep reference to source file (the schematic file)
   setFileInfo(DocName);
 
+  // The whole file is read into the memory in one piece and parsed
+  // from there, which is much faster than reading it line by line.
   QString Line;
-  QTextStream stream(&file);
+  QTextStream ReadWhole(&file);
+  QString FileString = ReadWhole.readAll();
+  file.close();
+  QTextStream stream(&FileString, QIODevice::ReadOnly);
 
   // read header **************************
   do {
@@ -1168,43 +1242,32 @@ void Schematic::collectDigitalSignals(void)
 
 // ---------------------------------------------------
 // Propagates the given node to connected component ports.
+// The nodes of the net are visited once each, in the order they are
+// found, so naming a net takes time linear to its size.
 void Schematic::propagateNode(QStringList& Collect,
 			      int& countInit, Node *pn)
 {
-  bool setName=false;
-  Q3PtrList<Node> Cons;
-  Node *p2;
+  QVector<Node*> Cons;
+  Node *p2, *p3;
   Wire *pw;
   Element *pe;
 
   Cons.append(pn);
-  for(p2 = Cons.first(); p2 != 0; p2 = Cons.next())
+  for(int i = 0; i < Cons.size(); i++) {
+    p2 = Cons.at(i);
     for(pe = p2->Connections.first(); pe != 0; pe = p2->Connections.next())
       if(pe->Type == isWire) {
 	pw = (Wire*)pe;
-	if(p2 != pw->Port1) {
-	  if(pw->Port1->Name.isEmpty()) {
-	    pw->Port1->Name = pn->Name;
-	    pw->Port1->State = 1;
-	    Cons.append(pw->Port1);
-	    setName = true;
-	  }
-	}
-	else {
-	  if(pw->Port2->Name.isEmpty()) {
-	    pw->Port2->Name = pn->Name;
-	    pw->Port2->State = 1;
-	    Cons.append(pw->Port2);
-	    setName = true;
-	  }
-	}
-	if(setName) {
-	  Cons.findRef(p2);   // back to current Connection
-	  if (isAnalog) createNodeSet(Collect, countInit, pw, pn);
-	  setName = false;
-	}
+	if(p2 != pw->Port1) p3 = pw->Port1;
+	else p3 = pw->Port2;
+	if(!p3->Name.isEmpty()) continue;
+
+	p3->Name = pn->Name;
+	p3->State = 1;
+	Cons.append(p3);
+	if (isAnalog) createNodeSet(Collect, countInit, pw, pn);
       }
-  Cons.clear();
+  }
 }
 
 #include <iostream>
@@ -1281,8 +1344,38 @@ bool Schematic::throughAllComps(QTextStream *stream, int& countInit,
       FileList.insert(f, sub);
 
 
-      // load subcircuit schematic
+      // reuse the netlist of an unchanged subcircuit
       s = pc->Props.first()->Value;
+      QString key = f + "\n" + s + "\n" + QString::number(isAnalog) +
+                    QString::number(isVerilog) + QString::number(creatingLib) +
+                    " " + QString::number(NumPorts) +
+                    " " + QString::number(countInit);
+      QHash<QString, SubNetlist>::const_iterator sn = SubNetlists.constFind(key);
+      if(sn != SubNetlists.constEnd() && subNetlistReusable(sn.value()))
+      {
+        (*stream) << sn.value().Text;
+        Collect += sn.value().Collect;
+        countInit = sn.value().countInit;
+        SubMap::const_iterator si;
+        for(si = sn.value().Files.constBegin(); si != sn.value().Files.constEnd(); ++si)
+          FileList.insert(si.key(), si.value());
+
+        i = 0;
+        // apply in/out signal types of subcircuit
+        foreach(Port *pp, pc->Ports)
+        {
+            pp->Type = sn.value().PortTypes[i];
+            pp->Connection->DType = pp->Type;
+            i++;
+        }
+        sub.PortTypes = sn.value().PortTypes;
+        FileList.insert(f, sub);
+        continue;
+      }
+
+      // load subcircuit schematic
+      QFileInfo Info(f);
+      QPair<QDateTime, qint64> stamp(Info.lastModified(), Info.size());
       Schematic *d = new Schematic(0, pc->getSubcircuitFile());
       if(!d->loadDocument())      // load document if possible
       {
@@ -1299,7 +1392,16 @@ bool Schematic::throughAllComps(QTextStream *stream, int& countInit,
       d->isVerilog = isVerilog;
       d->isAnalog = isAnalog;
       d->creatingLib = creatingLib;
-      r = d->createSubNetlist(stream, countInit, Collect, ErrText, NumPorts);
+
+      // netlist into a string first to keep it for reuse
+      SubMap filesBefore = FileList;
+      int countBefore = Collect.count();
+      int errorsBefore = ErrText ? ErrText->blockCount() : 0;
+      SubNetlist n;
+      QTextStream subStream(&n.Text, QIODevice::WriteOnly);
+      r = d->createSubNetlist(&subStream, countInit, Collect, ErrText, NumPorts);
+      subStream.flush();
+      (*stream) << n.Text;
       if (r)
       {
         i = 0;
@@ -1313,6 +1415,27 @@ bool Schematic::throughAllComps(QTextStream *stream, int& countInit,
         }
         sub.PortTypes = d->PortTypes;
         FileList.insert(f, sub);
+
+        // Keep the netlist if it only depends on schematics and nothing
+        // has been reported. Library, SPICE and HDL files are handled by
+        // their own components and are not tracked here.
+        bool keep = !ErrText || (ErrText->blockCount() == errorsBefore);
+        n.Stamps.insert(f, stamp);
+        SubMap::const_iterator si;
+        for(si = FileList.constBegin(); keep && si != FileList.constEnd(); ++si) {
+          if(si.key() == f || filesBefore.contains(si.key()))  continue;
+          if(si.value().Type != "SCH")  keep = false;
+          Info.setFile(si.key());
+          n.Files.insert(si.key(), si.value());
+          n.Stamps.insert(si.key(), qMakePair(Info.lastModified(), Info.size()));
+        }
+        if(keep) {
+          n.PortTypes = d->PortTypes;
+          n.Collect = Collect.mid(countBefore);
+          n.countInit = countInit;
+          SubNetlists.insert(key, n);
+        }
+        else  SubNetlists.remove(key);
       }
       delete d;
       if(!r)
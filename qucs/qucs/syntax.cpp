@@ -24,11 +24,16 @@
 #include "textdoc.h"
 #include "syntax.h"
 
+#include <QTextDocument>
+
 
 SyntaxHighlighter::SyntaxHighlighter(TextDoc *textEdit) : QSyntaxHighlighter(textEdit)
 {
   Doc = textEdit;
   language = LANG_NONE;
+  Lazy = Forced = false;
+  FirstVisible = LastVisible = -1;
+  NextBlock = 0;
 
   reservedWordFormat.setForeground(Qt::darkBlue);
   reservedWordFormat.setFontWeight(QFont::Bold);
@@ -58,204 +63,219 @@ SyntaxHighlighter::~SyntaxHighlighter()
 void SyntaxHighlighter::setLanguage(int lang)
 {
   language = lang;
+  Words.clear();
+  CommentStart.clear();
 
-  HighlightingRule rule;
-
-  QStringList reservedWordPattern;
-  QStringList unitPattern;
-  QStringList datatypePattern;
-  QStringList directivePattern;
-  QStringList functionPattern;
-  QStringList commentPattern;
+  QStringList reservedWords;
+  QStringList units;
+  QStringList datatypes;
+  QStringList directives;
+  QStringList functions;
 
   switch (language) {
-    case LANG_VHDL:
-        reservedWordPattern << "\\babs\\b" << "\\baccess\\b" << "\\bafter\\b" << "\\balias\\b" << "\\ball\\b" << "\\band\\b" <<
-                        "\\barchitecture\\b\\b"<< "\\barray\\b"<< "\\bassert\\b" << "\\battribute\\b"<<
-                        "\\bbegin\\b\\b"<< "\\bblock\\b"<< "\\bbody\\b"<< "\\bbuffer\\b"<< "\\bbus\\b"<<
-                        "\\bcase\\b"<< "\\bcomponent\\b"<< "\\bconfiguration\\b"<< "\\bconstant\\b"<<
-                        "\\bdisconnect\\b"<< "\\bdownto\\b"<<
-                        "\\belse\\b"<< "\\belsif\\b"<< "\\bend\\b"<< "\\bentity\\b"<< "\\bexit\\b"<<
-                        "\\bfile\\b"<< "\\bfor\\b"<< "\\bfunction"
-                        "\\bgenerate\\b"<< "\\bgeneric\\b"<< "\\bgroup\\b"<< "\\bguarded"
-                        "\\bif\\b"<< "\\bimpure\\b"<< "\\bin\\b"<< "\\binertial\\b"<< "\\binout\\b"<< "\\bis\\b"<<
-                        "\\blabel\\b"<< "\\blibrary\\b"<< "\\blinkage\\b"<< "\\bliteral\\b"<< "\\bloop\\b"<<
-                        "\\bmap\\b"<< "\\bmod\\b"<< 
-                        "\\bnand\\b"<< "\\bnew\\b"<< "\\bnext\\b"<< "\\bnor\\b"<< "\\bnot\\b"<< "\\bnull"
-                        "\\bof\\b"<< "\\bon\\b"<< "\\bopen\\b"<< "\\bor\\b"<< "\\bothers\\b"<< "\\bout\\b"<<
-                        "\\bpackage\\b"<< "\\bport\\b"<< "\\bpostponed\\b"<< "\\bprocedure\\b"<< "\\bprocess\\b"<< "\\bpure\\b"<<
-                        "\\brange\\b"<< "\\brecord\\b"<< "\\bregister\\b"<< "\\breject\\b"<< "\\brem\\b"<< "\\breport\\b"<< "\\breturn\\b"<< "\\brol\\b"<< "\\bror\\b"<<
-                        "\\bselect\\b"<< "\\bseverity\\b"<< "\\bshared\\b"<< "\\bsignal\\b"<< "\\bsla\\b"<< "\\bsll\\b"<< "\\bsra\\b"<< "\\bsrl\\b"<< "\\bsubtype\\b"<<
-                        "\\bthen\\b"<< "\\bto\\b"<< "\\btransport\\b"<< "\\btype\\b"<<
-                        "\\bunaffected\\b"<< "\\bunits\\b"<< "\\buntil\\b"<< "\\buse\\b"<<
-                        "\\bvariable\\b"<<
-                        "\\bwait\\b"<< "\\bwhen\\b"<< "\\bwhile\\b"<< "\\bwith\\b"<<
-                        "\\bxnor\\b"<< "\\bxor\\b";
-
-          unitPattern <<  "\\bfs\\b"<< "\\bps\\b"<< "\\bns\\b"<< "\\bus\\b"<< "\\bms\\b"<< "\\bsec\\b"<< "\\bmin\\b"<< "\\bhr\\b";
-
-          datatypePattern << "\\bbit\\b"<< "\\bbit_vector\\b"<< "\\bboolean\\b"<< "\\bstd_logic\\b"<< "\\bstd_logic_vector\\b"<< "\\bstd_ulogic\\b"<< "\\bstd_ulogic_vector\\b"<< "\\bsigned\\b"<< "\\bunsigned\\b"<< "\\binteger\\b"<< "\\breal\\b"<< "\\btime\\b"<< "\\bcharacter\\b"<< "\\bnatural\\b";
-
-          directivePattern << "\\bactive\\b"<< "\\bascending\\b" <<
-                        "\\bbase\\b" <<
-                        "\\bdelayed\\b" <<
-                        "\\bevent\\b" <<
-                        "\\bhigh\\b" <<
-                        "\\bimage\\b" <<
-                        "\\blast_active\\b"<< "\\blast_event\\b"<< "\\blast_value\\b"<< "\\bleft\\b"<< "\\bleftof\\b"<< "\\blength\\b"<< "\\blow\\b" <<
-                        "\\bpos\\b"<< "\\bpred\\b"<<
-                        "\\bquiet\\b"<<
-                        "\\brange\\b"<< "\\breverse_range\\b"<< "\\bright\\b"<< "\\brightof\\b"<<
-                        "\\bstable\\b"<< "\\bsucc\\b"<<
-                        "\\btransaction\\b"<<
-                        "\\bval\\b"<< "\\bvalue\\b";
-
-          commentPattern << "--[^\n]*";
-
-        break;
+  case LANG_VHDL:
+    reservedWords << "abs" << "access" << "after" << "alias" << "all"
+      << "and" << "architecture" << "array" << "assert" << "attribute"
+      << "begin" << "block" << "body" << "buffer" << "bus" << "case"
+      << "component" << "configuration" << "constant" << "disconnect"
+      << "downto" << "else" << "elsif" << "end" << "entity" << "exit"
+      << "file" << "for" << "function" << "generate" << "generic" << "group"
+      << "guarded" << "if" << "impure" << "in" << "inertial" << "inout"
+      << "is" << "label" << "library" << "linkage" << "literal" << "loop"
+      << "map" << "mod" << "nand" << "new" << "next" << "nor" << "not"
+      << "null" << "of" << "on" << "open" << "or" << "others" << "out"
+      << "package" << "port" << "postponed" << "procedure" << "process"
+      << "pure" << "range" << "record" << "register" << "reject" << "rem"
+      << "report" << "return" << "rol" << "ror" << "select" << "severity"
+      << "shared" << "signal" << "sla" << "sll" << "sra" << "srl"
+      << "subtype" << "then" << "to" << "transport" << "type"
+      << "unaffected" << "units" << "until" << "use" << "variable" << "wait"
+      << "when" << "while" << "with" << "xnor" << "xor";
+    units << "fs" << "ps" << "ns" << "us" << "ms" << "sec" << "min" << "hr";
+    datatypes << "bit" << "bit_vector" << "boolean" << "std_logic"
+      << "std_logic_vector" << "std_ulogic" << "std_ulogic_vector"
+      << "signed" << "unsigned" << "integer" << "real" << "time"
+      << "character" << "natural";
+    directives << "active" << "ascending" << "base" << "delayed" << "event"
+      << "high" << "image" << "last_active" << "last_event" << "last_value"
+      << "left" << "leftof" << "length" << "low" << "pos" << "pred"
+      << "quiet" << "range" << "reverse_range" << "right" << "rightof"
+      << "stable" << "succ" << "transaction" << "val" << "value";
+    CommentStart = "--";
+    break;
 
   case LANG_VERILOG:
-        reservedWordPattern << "\\balways\\b"<< "\\band\\b"<< "\\bassign\\b"<< "\\battribute\\b"<<
-                        "\\bbegin\\b"<< "\\bbuf\\b"<< "\\bbufif0\\b"<< "\\bbufif1\\b"<<
-                        "\\bcase\\b"<< "\\bcasex\\b"<< "\\bcasez\\b" <<  "\\bcmos\\b"<< 
-                        "\\bdeassign\\b"<< "\\bdefault\\b"<< "\\bdefparam\\b"<< "\\bdisable\\b"<<
-                        "\\bedge\\b"<< "\\belse\\b"<< "\\bend\\b"<< "\\bendattribute\\b"<< "\\bendcase\\b"<< "\\bendfunction\\b"<< "\\bendmodule\\b"<< "\\bendprimitive\\b"<< "\\bendspecify\\b"<< "\\bendtable\\b"<< "\\bendtask\\b"<< "\\bevent\\b"<<
-                        "\\bfor\\b"<< "\\bforce\\b"<< "\\bforever\\b"<< "\\bfork\\b"<< "\\bfunction\\b"<<
-                        "\\bhighz0\\b"<< "\\bhighz1\\b"<<
-                        "\\bif\\b"<< "\\bifnone\\b"<< "\\binitial\\b"<< "\\binout\\b"<< "\\binput\\b"<<
-                        "\\bjoin\\b"<<
-                        "\\blarge\\b"<<
-                        "\\bmedium\\b"<< "\\bmodule\\b"<< "\\bmacromodule\\b"<<
-                        "\\bnand\\b"<< "\\bnegedge\\b"<< "\\bnmos\\b"<< "\\bnor\\b"<< "\\bnot\\b"<< "\\bnotif0\\b"<< "\\bnotif1\\b"<<
-                        "\\bor\\b"<< "\\boutput\\b"<<
-                        "\\bpmos\\b"<< "\\bposedge\\b"<< "\\bprimitive\\b"<< "\\bpull0\\b"<< "\\bpull1\\b"<< "\\bpulldown\\b"<< "\\bpullup\\b"<<
-                        "\\brcmos\\b"<< "\\brelease\\b"<< "\\brepeat\\b"<< "\\brnmos\\b"<< "\\brpmos\\b"<< "\\brtran\\b"<< "\\brtranif0\\b"<< "\\brtranif1\\b"<<
-                        "\\bscalared\\b"<< "\\bsigned\\b"<< "\\bsmall\\b"<< "\\bspecify\\b"<< "\\bstrength\\b"<< "\\bstrong0\\b"<< "\\bstrong1\\b"<<
-                        "\\btable\\b"<< "\\btask\\b"<< "\\btran\\b"<< "\\btranif0\\b"<< "\\btranif1\\b"<<
-                        "\\bunsigned\\b"<<
-                        "\\bvectored\\b"<<
-                        "\\bwait\\b"<< "\\bweak0\\b"<< "\\bweak1\\b"<< "\\bwhile\\b"<<
-                        "\\bxnor\\b"<< "\\bxor\\b";
-
-        directivePattern << "\\breset_all\\b"<< "\\btimescale\\b"<< "\\bdefine\\b"<< "\\binclude\\b"<< "\\bifdef\\b"<< "\\belse\\b"<< "\\bendif\\b"<<
-                          "\\bcelldefine\\b"<< "\\bendcelldefine\\b"<< "\\bdefault_nettype\\b"<< "\\bunconnected_drive\\b"<<
-                          "\\bnounconnected_drive\\b"<< "\\bdelay_mode_zero\\b"<< "\\bdelay_mode_unit\\b"<<
-                          "\\bdelay_mode_path\\b"<< "\\bdelay_mode_distributed\\b"<< "\\buselib\\b";
-
-        datatypePattern << "\\breg\\b"<< "\\binteger\\b"<< "\\btime\\b"<< "\\breal\\b"<< "\\brealtime\\b"<< "\\bwire\\b"<< "\\btri\\b"<< "\\bwor\\b"<<
-                          "\\btrior\\b"<< "\\bwand\\b"<< "\\btriand\\b"<< "\\btri0\\b"<< "\\btri1\\b"<< "\\bsupply0\\b"<< "\\bsupply1\\b"<< "\\btrireg\\b"<<
-                          "\\bparameter\\b"<< "\\bspecparam\\b"<< "\\bevent\\b";
-
-        functionPattern <<  "\\bsetup\\b"<< "\\bhold\\b"<< "\\bsetuphold\\b"<< "\\bskew\\b"<< "\\brecovery\\b"<< "\\bperiod\\b"<< "\\bwidth\\b"<<
-                          "\\bmonitor\\b"<< "\\bdisplay\\b"<< "\\bwrite\\b"<< "\\bstrobe\\b"<< "\\bfopen\\b"<< "\\bfclose\\b"<< "\\btime\\b"<<
-                          "\\bstime\\b"<< "\\brealtime\\b"<< "\\btimeformat\\b"<< "\\bprinttimescale\\b"<< "\\brandom\\b"<< "\\breadmemb\\b"<<
-                          "\\breadmemh\\b"<< "\\bfinish\\b"<< "\\bstop\\b";
-
-        commentPattern << "//[^\n]*";
-
+    reservedWords << "always" << "and" << "assign" << "attribute" << "begin"
+      << "buf" << "bufif0" << "bufif1" << "case" << "casex" << "casez"
+      << "cmos" << "deassign" << "default" << "defparam" << "disable"
+      << "edge" << "else" << "end" << "endattribute" << "endcase"
+      << "endfunction" << "endmodule" << "endprimitive" << "endspecify"
+      << "endtable" << "endtask" << "event" << "for" << "force" << "forever"
+      << "fork" << "function" << "highz0" << "highz1" << "if" << "ifnone"
+      << "initial" << "inout" << "input" << "join" << "large" << "medium"
+      << "module" << "macromodule" << "nand" << "negedge" << "nmos" << "nor"
+      << "not" << "notif0" << "notif1" << "or" << "output" << "pmos"
+      << "posedge" << "primitive" << "pull0" << "pull1" << "pulldown"
+      << "pullup" << "rcmos" << "release" << "repeat" << "rnmos" << "rpmos"
+      << "rtran" << "rtranif0" << "rtranif1" << "scalared" << "signed"
+      << "small" << "specify" << "strength" << "strong0" << "strong1"
+      << "table" << "task" << "tran" << "tranif0" << "tranif1" << "unsigned"
+      << "vectored" << "wait" << "weak0" << "weak1" << "while" << "xnor"
+      << "xor";
+    datatypes << "reg" << "integer" << "time" << "real" << "realtime"
+      << "wire" << "tri" << "wor" << "trior" << "wand" << "triand" << "tri0"
+      << "tri1" << "supply0" << "supply1" << "trireg" << "parameter"
+      << "specparam" << "event";
+    directives << "reset_all" << "timescale" << "define" << "include"
+      << "ifdef" << "else" << "endif" << "celldefine" << "endcelldefine"
+      << "default_nettype" << "unconnected_drive" << "nounconnected_drive"
+      << "delay_mode_zero" << "delay_mode_unit" << "delay_mode_path"
+      << "delay_mode_distributed" << "uselib";
+    functions << "setup" << "hold" << "setuphold" << "skew" << "recovery"
+      << "period" << "width" << "monitor" << "display" << "write"
+      << "strobe" << "fopen" << "fclose" << "time" << "stime" << "realtime"
+      << "timeformat" << "printtimescale" << "random" << "readmemb"
+      << "readmemh" << "finish" << "stop";
+    CommentStart = "//";
     break;
 
   case LANG_VERILOGA:
-
-        reservedWordPattern << "\\babstol\\b"<< "\\baccess\\b"<< "\\banalog\\b"<< "\\bac_stim\\b"<< "\\banalysis\\b"<<
-                          "\\bbegin\\b"<< "\\bbranch\\b"<< "\\bbound_step\\b"<<
-                          "\\bcase\\b"<<
-                          "\\bdiscipline\\b"<< "\\bddt_nature\\b"<< "\\bddt\\b"<< "\\bdelay\\b"<< "\\bdiscontinuity\\b"<< "\\bdefault\\b"<< 
-                          "\\benddiscipline\\b"<< "\\belse\\b"<< "\\bend\\b"<< "\\bendnature\\b"<< "\\bexclude\\b"<< "\\bendfunction\\b"<< "\\bendmodule\\b"<< "\\belectrical\\b"<< "\\bendcase\\b"<<
-                          "\\bfor\\b"<< "\\bflow\\b"<< "\\bfrom\\b"<< "\\bfinal_step\\b"<< "\\bflicker_noise\\b"<< "\\bfunction\\b"<<
-                          "\\bgenerate\\b"<< "\\bground\\b"<<
-                          "\\bif\\b"<< "\\bidt_nature\\b"<< "\\binf\\b"<< "\\bidt\\b"<< "\\binitial_step\\b"<< "\\binput\\b"<< "\\binout\\b"<<
-                          "\\blaplace_nd\\b"<< "\\blaplace_np\\b"<< "\\blaplace_zd\\b"<< "\\blaplace_zp\\b"<< "\\blast_crossing\\b"<<
-                          "\\bmodule\\b"<<
-                          "\\bnature\\b"<< "\\bnoise_table\\b"<<
-                          "\\bpotential\\b"<< "\\bparameter\\b"<<
-                          "\\bslew\\b"<<
-                          "\\btimer\\b"<< "\\btransition\\b"<<
-                          "\\bunits\\b"<<
-                          "\\bwhite_noise\\b"<< "\\bwhile\\b"<<
-                          "\\bzi_nd\\b"<< "\\bzi_np\\b"<< "\\bzi_zd\\b"<< "\\bzi_zp\\b";
-
-        unitPattern << "\\bT\\b"<< "\\bG\\b"<< "\\bM\\b"<< "\\bK\\b"<< "\\bm\\b"<< "\\bu\\b"<< "\\bn\\b"<< "\\bp\\b"<< "\\bf\\b"<< "\\ba\\b";
-
-        datatypePattern << "\\binteger\\b"<< "\\breal\\b";
-
-        directivePattern << "\\bdefine\\b"<< "\\belse\\b"<< "\\bundef\\b"<< "\\bifdef\\b"<< "\\bendif\\b"<< "\\binclude\\b"<< "\\bresetall\\b";
-
-        functionPattern << "\\brealtime\\b"<< "\\btemperature\\b"<< "\\bvt\\b"<< "\\bdisplay\\b"<< "\\bstrobe\\b";
-
-        commentPattern << "//[^\n]*";
-
+    reservedWords << "abstol" << "access" << "analog" << "ac_stim"
+      << "analysis" << "begin" << "branch" << "bound_step" << "case"
+      << "discipline" << "ddt_nature" << "ddt" << "delay" << "discontinuity"
+      << "default" << "enddiscipline" << "else" << "end" << "endnature"
+      << "exclude" << "endfunction" << "endmodule" << "electrical"
+      << "endcase" << "for" << "flow" << "from" << "final_step"
+      << "flicker_noise" << "function" << "generate" << "ground" << "if"
+      << "idt_nature" << "inf" << "idt" << "initial_step" << "input"
+      << "inout" << "laplace_nd" << "laplace_np" << "laplace_zd"
+      << "laplace_zp" << "last_crossing" << "module" << "nature"
+      << "noise_table" << "potential" << "parameter" << "slew" << "timer"
+      << "transition" << "units" << "white_noise" << "while" << "zi_nd"
+      << "zi_np" << "zi_zd" << "zi_zp";
+    units << "T" << "G" << "M" << "K" << "m" << "u" << "n" << "p" << "f"
+      << "a";
+    datatypes << "integer" << "real";
+    directives << "define" << "else" << "undef" << "ifdef" << "endif"
+      << "include" << "resetall";
+    functions << "realtime" << "temperature" << "vt" << "display"
+      << "strobe";
+    CommentStart = "//";
     break;
+
   case LANG_OCTAVE:
-      
-        reservedWordPattern << "\\bcase\\b"<< "\\bcatch\\b"<<
-                          "\\belse\\b"<< "\\belseif\\b"<< "\\bend\\b"<< "\\bendfor\\b"<< "\\bendfunction\\b"<< "\\bendif\\b"<< "\\bendswitch\\b"<< "\\bend_try_catch\\b"<< "\\bendwhile\\b"<< "\\bend_unwind_protect\\b"
-                          "\\bfor\\b" << "\\bfunction\\b" <<
-                          "\\bif\\b" <<
-                          "\\botherwise\\b" <<
-                          "\\bswitch\\b" <<
-                          "\\btry\\b" <<
-                          "\\bunwind_protect\\b"<< "\\bunwind_protect_cleanup\\b" <<
-                          "\\bwhile\\b";
+    reservedWords << "case" << "catch" << "else" << "elseif" << "end"
+      << "endfor" << "endfunction" << "endif" << "endswitch"
+      << "end_try_catch" << "endwhile" << "end_unwind_protect" << "for"
+      << "function" << "if" << "otherwise" << "switch" << "try"
+      << "unwind_protect" << "unwind_protect_cleanup" << "while";
+    datatypes << "inf" << "nan" << "pi";
+    functions << "plot";
+    CommentStart = "//";
+    break;
+  }
 
-        datatypePattern << "\\binf\\b"<< "\\bnan\\b"<< "\\bpi\\b";
+  addWords(reservedWords, &reservedWordFormat);
+  addWords(units, &unitFormat);
+  addWords(datatypes, &datatypeFormat);
+  addWords(directives, &directiveFormat);
+  addWords(functions, &functionFormat);
+}
 
-        functionPattern << "\\bplot\\b";
+// ---------------------------------------------------
+void SyntaxHighlighter::addWords(const QStringList& List,
+                                 const QTextCharFormat *Format)
+{
+  foreach (const QString &word, List)
+    Words.insert(word, Format);
+}
 
-        commentPattern << "//[^\n]*";
+// ---------------------------------------------------
+// In lazy mode only the blocks within the view (or those already
+// highlighted once) are processed, the others wait for highlightMore().
+void SyntaxHighlighter::setLazy(bool on)
+{
+  Lazy = on;
+  NextBlock = 0;
+}
 
-    break;
-    }
+// ---------------------------------------------------
+static inline bool isWordChar(const QChar& c)
+{
+  return c.isLetterOrNumber() || c == '_';
+}
 
-  foreach (const QString &pattern, reservedWordPattern) {
-    rule.pattern = QRegExp(pattern);
-    rule.format = reservedWordFormat;
-    highlightingRules.append(rule);
+// ---------------------------------------------------
+void SyntaxHighlighter::highlightBlock(const QString& text)
+{
+  if(Words.isEmpty() && CommentStart.isEmpty())  return;
+
+  // the user data marks blocks that have been highlighted; they never
+  // change the block state, so no block drags its successors along
+  if(!currentBlockUserData()) {
+    if(Lazy && !Forced) {
+      int n = currentBlock().blockNumber();
+      if(n < FirstVisible || n > LastVisible)  return;
+    }
+    setCurrentBlockUserData(new QTextBlockUserData);
   }
 
-  foreach (const QString &pattern, unitPattern) {
-    rule.pattern = QRegExp(pattern);
-    rule.format = unitFormat;
-    highlightingRules.append(rule);
-  }
+  int end = CommentStart.isEmpty() ? -1 : text.indexOf(CommentStart);
+  if(end < 0)  end = text.length();
 
-  foreach (const QString &pattern, datatypePattern) {
-    rule.pattern = QRegExp(pattern);
-    rule.format = datatypeFormat;
-    highlightingRules.append(rule);
+  for(int i = 0; i < end; ) {
+    if(!isWordChar(text.at(i))) {
+      i++;
+      continue;
+    }
+    int j = i + 1;
+    while(j < end && isWordChar(text.at(j)))  j++;
+    const QTextCharFormat *Format = Words.value(text.mid(i, j - i));
+    if(Format)  setFormat(i, j - i, *Format);
+    i = j;
   }
 
-  foreach (const QString &pattern, directivePattern) {
-    rule.pattern = QRegExp(pattern);
-    rule.format = directiveFormat;
-    highlightingRules.append(rule);
-  }
+  if(end < text.length())
+    setFormat(end, text.length() - end, commentFormat);
+}
 
-  foreach (const QString &pattern, functionPattern) {
-    rule.pattern = QRegExp(pattern);
-    rule.format = functionFormat;
-    highlightingRules.append(rule);
+// ---------------------------------------------------
+void SyntaxHighlighter::highlightLater(const QTextBlock& block)
+{
+  if(block.isValid() && !block.userData()) {
+    Forced = true;
+    rehighlightBlock(block);
+    Forced = false;
   }
+}
 
-  foreach (const QString &pattern, commentPattern) {
-    rule.pattern = QRegExp(pattern);
-    rule.format = commentFormat;
-    highlightingRules.append(rule);
+// ---------------------------------------------------
+// Highlights the blocks 'First' to 'Last' that have not been yet.
+void SyntaxHighlighter::highlightVisible(int First, int Last)
+{
+  FirstVisible = First;
+  LastVisible = Last;
+  if(!Lazy || !document())  return;
+
+  QTextBlock block = document()->findBlockByNumber(First);
+  for(int n = First; n <= Last && block.isValid(); n++) {
+    highlightLater(block);
+    block = block.next();
   }
 }
 
 // ---------------------------------------------------
-void SyntaxHighlighter::highlightBlock(const QString& text) {
-
+// Background step: highlights the next HIGHLIGHT_CHUNK blocks. Returns
+// false once the whole document is done.
+bool SyntaxHighlighter::highlightMore()
+{
+  if(!Lazy || !document())  return false;
 
-foreach (const HighlightingRule &rule, highlightingRules) {
-         QRegExp expression(rule.pattern);
-         int index = expression.indexIn(text);
-         while (index >= 0) {
-             int length = expression.matchedLength();
-             setFormat(index, length, rule.format);
-             index = expression.indexIn(text, index + length);
-         }
+  QTextBlock block = document()->findBlockByNumber(NextBlock);
+  for(int n = 0; n < HIGHLIGHT_CHUNK && block.isValid(); n++) {
+    highlightLater(block);
+    block = block.next();
+    NextBlock++;
   }
-
+  return block.isValid();
 }
@@ -20,6 +20,7 @@
 
 #include "textdoc.h"
 #include <QSyntaxHighlighter>
+#include <QHash>
 
 enum language_type {
   LANG_NONE = 0,
@@ -34,25 +35,39 @@ enum textstate_type {
   STATE_COMMENT = 100,
 };
 
+// text documents larger than this (in characters) are only highlighted
+// where they are shown, the rest follows in the background
+#define HIGHLIGHT_LAZY_SIZE (1 << 20)
+
+// number of text blocks highlighted per background step
+#define HIGHLIGHT_CHUNK 500
+
 class SyntaxHighlighter : public QSyntaxHighlighter {
 public:
  SyntaxHighlighter(TextDoc*);
  virtual ~SyntaxHighlighter();
 
  void setLanguage(int);
+ void setLazy(bool);
  void highlightBlock(const QString&);
+ void highlightVisible(int, int);
+ bool highlightMore();
 
 private:
+  void addWords(const QStringList&, const QTextCharFormat*);
+  void highlightLater(const QTextBlock&);
+
   int language;
   TextDoc *Doc;
 
-  struct HighlightingRule
-     {
-         QRegExp pattern;
-         QTextCharFormat format;
-     };
-  
-  QVector<HighlightingRule> highlightingRules;
+  // keyword -> format, later categories override earlier ones
+  QHash<QString, const QTextCharFormat*> Words;
+  QString CommentStart;
+
+  bool Lazy;          // only highlight blocks shown or forced
+  bool Forced;        // highlight the current block in any case
+  int FirstVisible, LastVisible;
+  int NextBlock;      // next block for the background highlighting
 
   QTextCharFormat reservedWordFormat;
   QTextCharFormat unitFormat;
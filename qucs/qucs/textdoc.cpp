@@ -20,6 +20,7 @@ Copyright (C) 2014 by Guilherme Brondani Torri <guitorri@gmail.com>
 #endif
 #include <QAction>
 #include <QMessageBox>
+#include <QScrollBar>
 #include <QTextStream>
 
 #include "qucs.h"
@@ -81,6 +82,11 @@ TextDoc::TextDoc(QucsApp *App_, const QString& Name_) : QPlainTextEdit(), QucsDo
   syntaxHighlight->setLanguage(language);
   syntaxHighlight->setDocument(document());
 
+  connect(&HighlightTimer, SIGNAL(timeout()), SLOT(slotHighlightMore()));
+  connect(verticalScrollBar(), SIGNAL(valueChanged(int)),
+          SLOT(slotHighlightVisible()));
+  connect(this, SIGNAL(textChanged()), SLOT(slotHighlightVisible()));
+
   connect(this, SIGNAL(cursorPositionChanged()), this, SLOT(highlightCurrentLine()));
   highlightCurrentLine();
 }
@@ -379,6 +385,8 @@ bool TextDoc::load ()
     return false;
   setLanguage (DocName);
 
+  // no highlighting while inserting, refreshLanguage() decides how
+  syntaxHighlight->setDocument(0);
   QTextStream stream (&file);
   insertPlainText(stream.readAll());
   document()->setModified(false);
@@ -596,9 +604,44 @@ void TextDoc::highlightCurrentLine()
     setExtraSelections(extraSelections);
 }
 
+/*!
+ * \brief TextDoc::refreshLanguage sets up the syntax highlighting
+ *
+ * Documents larger than QucsSettings.maxHighlightSize are not highlighted
+ * at all, those above HIGHLIGHT_LAZY_SIZE only where they are shown and
+ * in the background.
+ */
 void TextDoc::refreshLanguage()
 {
     this->setLanguage(DocName);
-    syntaxHighlight->setLanguage(language);
+    int size = document()->characterCount();
+    bool off = size > int(QucsSettings.maxHighlightSize << 20);
+    bool lazy = !off && size > HIGHLIGHT_LAZY_SIZE;
+
+    HighlightTimer.stop();
+    syntaxHighlight->setLanguage(off ? int(LANG_NONE) : language);
+    syntaxHighlight->setLazy(lazy);
+    slotHighlightVisible();
     syntaxHighlight->setDocument(document());
+    if(lazy)
+      HighlightTimer.start(0);
+}
+
+/*!
+ * \brief TextDoc::slotHighlightVisible highlights the blocks in the view
+ */
+void TextDoc::slotHighlightVisible()
+{
+  int first = cursorForPosition(QPoint(0, 0)).blockNumber();
+  int last = cursorForPosition(QPoint(0, viewport()->height())).blockNumber();
+  syntaxHighlight->highlightVisible(first, last);
+}
+
+/*!
+ * \brief TextDoc::slotHighlightMore highlights the next part of the document
+ */
+void TextDoc::slotHighlightMore()
+{
+  if(!syntaxHighlight->highlightMore())
+    HighlightTimer.stop();
 }
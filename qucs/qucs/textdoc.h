@@ -20,6 +20,7 @@ Copyright (C) 2014 by Guilherme Brondani Torri <guitorri@gmail.com>
 
 #include <QPlainTextEdit>
 #include <QFont>
+#include <QTimer>
 
 #include "qucsdoc.h"
 
@@ -99,10 +100,13 @@ public slots:
 
 private:
   SyntaxHighlighter * syntaxHighlight;
+  QTimer HighlightTimer;  // background highlighting of large documents
   QucsApp *App;
 
 private slots:
   void highlightCurrentLine();
+  void slotHighlightVisible();
+  void slotHighlightMore();
   bool baseSearch(const QString &, bool, bool, bool);
 };
 
@@ -0,0 +1,131 @@
+/***************************************************************************
+                                twoport.h
+                               -----------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+/*!
+ * \file twoport.h
+ * \brief Chain matrices of simple two-ports and their S-parameters
+ *
+ * Used by the synthesis tools to preview the response of the networks
+ * they create without running the simulator. The conversions are the
+ * ones of stoa() and atos() in qucs-core (src/math/matrix.cpp).
+ */
+
+#ifndef TWOPORT_H
+#define TWOPORT_H
+
+#include <cmath>
+#include <complex>
+
+namespace twoport {
+
+  typedef std::complex<double> cplx;
+
+  // chain (ABCD) matrix
+  struct abcd {
+    cplx a, b, c, d;
+  };
+
+  struct sparam {
+    cplx s11, s12, s21, s22;
+  };
+
+  struct yparam {
+    cplx y11, y12, y21, y22;
+  };
+
+  inline abcd through()
+  { abcd m = { 1.0, 0.0, 0.0, 1.0 }; return m; }
+
+  // series impedance
+  inline abcd series(cplx z)
+  { abcd m = { 1.0, z, 0.0, 1.0 }; return m; }
+
+  // shunt admittance
+  inline abcd shunt(cplx y)
+  { abcd m = { 1.0, 0.0, y, 1.0 }; return m; }
+
+  // transmission line of impedance z and propagation gamma*l
+  inline abcd line(double z, cplx gl)
+  {
+    abcd m = { cosh(gl), z * sinh(gl), sinh(gl) / z, cosh(gl) };
+    return m;
+  }
+
+  // two two-ports in a row
+  inline abcd cascade(const abcd &m1, const abcd &m2)
+  {
+    abcd m = { m1.a * m2.a + m1.b * m2.c, m1.a * m2.b + m1.b * m2.d,
+               m1.c * m2.a + m1.d * m2.c, m1.c * m2.b + m1.d * m2.d };
+    return m;
+  }
+
+  // admittance matrix, the two-port must not be a pure shunt (b = 0)
+  inline yparam atoy(const abcd &m)
+  {
+    yparam y = { m.d / m.b, -(m.a * m.d - m.b * m.c) / m.b,
+                 -1.0 / m.b, m.a / m.b };
+    return y;
+  }
+
+  inline abcd ytoa(const yparam &y)
+  {
+    abcd m = { -y.y22 / y.y21, -1.0 / y.y21,
+               -(y.y11 * y.y22 - y.y12 * y.y21) / y.y21, -y.y11 / y.y21 };
+    return m;
+  }
+
+  // two two-ports connected in parallel at both ports
+  inline abcd parallel(const abcd &m1, const abcd &m2)
+  {
+    yparam y1 = atoy(m1), y2 = atoy(m2);
+    yparam y = { y1.y11 + y2.y11, y1.y12 + y2.y12,
+                 y1.y21 + y2.y21, y1.y22 + y2.y22 };
+    return ytoa(y);
+  }
+
+  // chain matrix to S-parameters for the reference impedances z1, z2
+  inline sparam atos(const abcd &m, cplx z1, cplx z2)
+  {
+    cplx d = 2.0 * sqrt(fabs(real(z1) * real(z2)));
+    cplx n = m.a * z2 + m.b + m.c * z1 * z2 + m.d * z1;
+    sparam s;
+    s.s11 = (m.a * z2 + m.b - m.c * conj(z1) * z2 - m.d * conj(z1)) / n;
+    s.s12 = (m.a * m.d - m.b * m.c) * d / n;
+    s.s21 = d / n;
+    s.s22 = (m.d * z1 - m.a * conj(z2) + m.b - m.c * z1 * conj(z2)) / n;
+    return s;
+  }
+
+  // S-parameters to chain matrix for the reference impedances z1, z2
+  inline abcd stoa(const sparam &s, cplx z1, cplx z2)
+  {
+    cplx d = s.s11 * s.s22 - s.s12 * s.s21;
+    cplx n = 2.0 * s.s21 * sqrt(fabs(real(z1) * real(z2)));
+    abcd m;
+    m.a = (conj(z1) + z1 * s.s11 - conj(z1) * s.s22 - z1 * d) / n;
+    m.b = (conj(z1) * conj(z2) + z1 * conj(z2) * s.s11 +
+           conj(z1) * z2 * s.s22 + z1 * z2 * d) / n;
+    m.c = (1.0 - s.s11 - s.s22 + d) / n;
+    m.d = (conj(z2) - conj(z2) * s.s11 + z2 * s.s22 - z2 * d) / n;
+    return m;
+  }
+
+  // magnitude in dB
+  inline double dB(cplx s)
+  { return 20.0 * log10(std::abs(s)); }
+
+}
+
+#endif
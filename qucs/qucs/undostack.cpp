@@ -0,0 +1,249 @@
+/***************************************************************************
+                               undostack.cpp
+                              ---------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "undostack.h"
+
+#include <QHash>
+
+
+UndoStack::UndoStack()
+{
+  Memory = 0;
+  CachedIdx = -1;
+}
+
+UndoStack::~UndoStack()
+{
+  clear();
+}
+
+// ---------------------------------------------------
+// Puts the given state on top of the stack.
+void UndoStack::append(const QString& s)
+{
+  State *st = new State;
+  QStringList cur;
+  int n = s.indexOf('\n');
+  if(n < 0)  st->Head = s;
+  else {
+    st->Head = s.left(n);
+    cur = s.mid(n+1).split('\n');
+  }
+
+  // count the states since the last one stored completely
+  int depth = 0;
+  for(int i = States.size()-1; i >= 0; i--, depth++)
+    if(States.at(i)->Full) break;
+
+  st->Full = true;
+  if(!States.isEmpty() && depth < UNDO_KEYFRAME-1) {
+    makeDelta(st, lines(States.size()-1), cur);
+    // not worth it if most of the lines are new
+    if(2*st->Lines.size() > cur.size()) {
+      st->Runs.clear();
+      st->Full = true;
+    }
+    else  st->Full = false;
+  }
+  if(st->Full)  st->Lines = cur;
+
+  setSize(st);
+  Memory += st->Size;
+  States.append(st);
+
+  CachedIdx = States.size()-1;
+  CachedLines = cur;
+}
+
+// ---------------------------------------------------
+// Removes the oldest state. The state after it is stored completely
+// if it has been stored as difference to the removed one.
+void UndoStack::removeFirst()
+{
+  if(States.isEmpty())  return;
+
+  if(States.size() > 1) {
+    State *next = States.at(1);
+    if(!next->Full) {
+      QStringList l = lines(1);
+      Memory -= next->Size;
+      next->Lines = l;
+      next->Runs.clear();
+      next->Full = true;
+      setSize(next);
+      Memory += next->Size;
+    }
+  }
+
+  State *st = States.first();
+  Memory -= st->Size;
+  delete st;
+  States.pop_front();
+
+  if(CachedIdx == 0)  CachedIdx = -1;
+  else if(CachedIdx > 0)  CachedIdx--;
+}
+
+// ---------------------------------------------------
+void UndoStack::removeLast()
+{
+  if(States.isEmpty())  return;
+
+  State *st = States.last();
+  Memory -= st->Size;
+  delete st;
+  States.pop_back();
+
+  if(CachedIdx >= States.size())  CachedIdx = -1;
+}
+
+// ---------------------------------------------------
+void UndoStack::clear()
+{
+  foreach(State *st, States)
+    delete st;
+  States.clear();
+  Memory = 0;
+  CachedIdx = -1;
+  CachedLines.clear();
+}
+
+// ---------------------------------------------------
+// Returns the state with the given index as it has been appended.
+QString UndoStack::at(int i) const
+{
+  return States.at(i)->Head + "\n" + lines(i).join("\n");
+}
+
+// ---------------------------------------------------
+QChar UndoStack::operation(int i) const
+{
+  const QString& h = States.at(i)->Head;
+  return h.isEmpty() ? QChar(' ') : h.at(0);
+}
+
+// ---------------------------------------------------
+bool UndoStack::isUnchanged(int i) const
+{
+  const QString& h = States.at(i)->Head;
+  return (h.length() > 1) && (h.at(1) == 'i');
+}
+
+// ---------------------------------------------------
+void UndoStack::setUnchanged(int i, bool u)
+{
+  QString& h = States[i]->Head;
+  while(h.length() < 2)  h += ' ';
+  h[1] = u ? 'i' : ' ';
+}
+
+// ---------------------------------------------------
+// Puts the lines of the given state together, starting at the state
+// put together last if possible, otherwise at the last state stored
+// completely before.
+QStringList UndoStack::lines(int i) const
+{
+  if(CachedIdx == i)  return CachedLines;
+
+  int k = i;
+  while(!States.at(k)->Full)  k--;
+
+  QStringList l;
+  if((CachedIdx >= k) && (CachedIdx < i)) {
+    l = CachedLines;
+    k = CachedIdx;
+  }
+  else  l = States.at(k)->Lines;
+
+  for(k++; k <= i; k++)
+    l = apply(l, States.at(k));
+
+  CachedIdx = i;
+  CachedLines = l;
+  return l;
+}
+
+// ---------------------------------------------------
+// Returns the lines of a state stored as difference to the given lines.
+QStringList UndoStack::apply(const QStringList& prev, const State *st) const
+{
+  QStringList l;
+  int n = 0;
+  foreach(const Run& r, st->Runs) {
+    if(r.Start < 0) {
+      for(int i = 0; i < r.Count; i++)
+        l.append(st->Lines.at(n++));
+    }
+    else {
+      for(int i = r.Start; i < r.Start + r.Count; i++)
+        l.append(prev.at(i));
+    }
+  }
+  return l;
+}
+
+// ---------------------------------------------------
+// Stores the lines "cur" as difference to the lines "prev". Runs of
+// lines found in "prev" are referenced, the other lines are kept.
+void UndoStack::makeDelta(State *st, const QStringList& prev,
+                          const QStringList& cur)
+{
+  // first occurrence of every line
+  QHash<QString, int> pos;
+  for(int i = prev.size()-1; i >= 0; i--)
+    pos.insert(prev.at(i), i);
+
+  st->Lines.clear();
+  st->Runs.clear();
+  foreach(const QString& s, cur) {
+    if(!st->Runs.isEmpty()) {
+      Run& r = st->Runs.last();
+      if(r.Start >= 0) {
+        int next = r.Start + r.Count;
+        if((next < prev.size()) && (prev.at(next) == s)) {
+          r.Count++;
+          continue;
+        }
+      }
+    }
+
+    QHash<QString, int>::const_iterator it = pos.constFind(s);
+    if(it != pos.constEnd()) {
+      Run r = { it.value(), 1 };
+      st->Runs.append(r);
+      continue;
+    }
+
+    st->Lines.append(s);
+    if(!st->Runs.isEmpty() && (st->Runs.last().Start < 0))
+      st->Runs.last().Count++;
+    else {
+      Run r = { -1, 1 };
+      st->Runs.append(r);
+    }
+  }
+}
+
+// ---------------------------------------------------
+// Estimates the memory taken by the given state.
+void UndoStack::setSize(State *st)
+{
+  qint64 n = sizeof(State) + 2 * st->Head.length();
+  foreach(const QString& s, st->Lines)
+    n += sizeof(QString) + 2 * s.length();
+  n += st->Runs.size() * sizeof(Run);
+  st->Size = n;
+}
@@ -0,0 +1,83 @@
+/***************************************************************************
+                                undostack.h
+                               -------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef UNDOSTACK_H
+#define UNDOSTACK_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// every that many states one is stored completely
+#define UNDO_KEYFRAME  16
+
+/*!
+ * \class UndoStack
+ * \brief states of a document for the undo and redo operations
+ *
+ * A state is the document in the format of "Schematic::createUndoString",
+ * i.e. one element per line after a header line holding the operation
+ * and the flag of being unchanged. As an edit changes only a few lines,
+ * most states are stored as the difference to the state before: runs
+ * of lines taken from there and the lines that are new. Every
+ * UNDO_KEYFRAME states, a state is stored completely to limit the work
+ * of putting a state together again.
+ */
+class UndoStack {
+public:
+  UndoStack();
+ ~UndoStack();
+
+  int  size() const { return States.size(); }
+  bool isEmpty() const { return States.isEmpty(); }
+  void append(const QString&);
+  void removeFirst();
+  void removeLast();
+  void clear();
+
+  QString at(int) const;
+  QChar   operation(int) const;
+  bool    isUnchanged(int) const;
+  void    setUnchanged(int, bool);
+  qint64  memory() const { return Memory; }
+
+private:
+  struct Run {
+    int Start;   // first line in the state before, -1 for new lines
+    int Count;
+  };
+  struct State {
+    QString     Head;    // operation and flag of being unchanged
+    bool        Full;    // stored completely in "Lines" ?
+    QStringList Lines;   // all lines, or the new ones only
+    QVector<Run> Runs;
+    qint64      Size;    // bytes taken by this state
+  };
+
+  QStringList lines(int) const;
+  QStringList apply(const QStringList&, const State*) const;
+  void  makeDelta(State*, const QStringList&, const QStringList&);
+  void  setSize(State*);
+
+  QVector<State*> States;
+  qint64 Memory;
+
+  // the lines of the state put together last
+  mutable int CachedIdx;
+  mutable QStringList CachedLines;
+};
+
+#endif
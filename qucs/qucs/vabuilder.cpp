@@ -0,0 +1,224 @@
+/***************************************************************************
+                               vabuilder.cpp
+                              ---------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QCryptographicHash>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include "vabuilder.h"
+#include "qucs.h"
+
+// the code generator templates, a change of them invalidates the cache
+static const char * vaTemplates[] = {
+  "qucsVersion.xml", "qucsMODULEcore.xml", "qucsMODULEdefs.xml",
+  "analogfunction.xml", 0
+};
+
+// admsXml writes its intermediate files (.interface.xml etc.) under
+// the same names for all modules, so only the C++ compiler runs in
+// parallel
+static QMutex admsLock;
+
+VaBuilder::VaBuilder(const QString &dir)
+{
+#ifdef __MINGW32__
+  make = "mingw32-make.exe";    // must be on the path!
+#else
+  make = "make";                // must be on the path!
+#endif
+
+  prefix = QDir::toNativeSeparators(QDir(QucsSettings.BinDir+"../").absolutePath());
+  include = QDir(QucsSettings.BinDir+"../include/qucs-core").absolutePath();
+  workDir = dir;
+
+  admsXml = QucsSettings.AdmsXmlBinDir.canonicalPath();
+#ifdef __MINGW32__
+  admsXml = QDir::toNativeSeparators(admsXml+"/"+"admsXml.exe");
+#else
+  admsXml = QDir::toNativeSeparators(admsXml+"/"+"admsXml");
+#endif
+
+  cache = QString::fromLocal8Bit(qgetenv("QUCS_VACACHE"));
+  if (cache.isEmpty())
+    cache = QucsSettings.QucsHomeDir.absoluteFilePath("vacache");
+}
+
+QString VaBuilder::libraryName(const QString &module) const
+{
+#if defined(__MINGW32__)
+  return module + ".dll";
+#elif defined(__APPLE__)
+  return module + ".dylib";
+#else
+  return module + ".so";
+#endif
+}
+
+/*!
+ * Returns the cache key of the module, the hash of its Verilog-A file,
+ * the templates and the installation it is built with.  Returns an
+ * empty string if the Verilog-A file cannot be read.
+ */
+QString VaBuilder::cacheKey(const QString &module) const
+{
+  QFile va(QDir(workDir).absoluteFilePath(module + ".va"));
+  if (!va.open(QIODevice::ReadOnly))
+    return QString();
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(va.readAll());
+  for (int i = 0; vaTemplates[i]; i++) {
+    QFile xml(QDir(include).absoluteFilePath(vaTemplates[i]));
+    if (xml.open(QIODevice::ReadOnly))
+      hash.addData(xml.readAll());
+  }
+  hash.addData(prefix.toUtf8());
+  hash.addData(admsXml.toUtf8());
+  return QString(hash.result().toHex());
+}
+
+bool VaBuilder::runMake(const QStringList &arguments, QString &log) const
+{
+  QProcess builder;
+  builder.setProcessChannelMode(QProcess::MergedChannels);
+  builder.setProcessEnvironment(QProcessEnvironment::systemEnvironment());
+  builder.setWorkingDirectory(workDir);
+
+  // prepend command to log
+  log = QString("%1 %2\n").arg(make, arguments.join(" "));
+
+  builder.start(make, arguments);
+  // admsXml seems to communicate all via stdout, or is it because of make?
+  if (!builder.waitForFinished(-1)) {
+    log += builder.errorString();
+    return false;
+  }
+  log += builder.readAll();
+  return builder.exitStatus() == QProcess::NormalExit && builder.exitCode() == 0;
+}
+
+/*!
+ * Builds the library of the Verilog-A file `module'.va in the working
+ * directory, or copies it from the cache if it was built before.  Can
+ * be called from several threads at once.
+ */
+VaBuilder::Result VaBuilder::build(const QString &module) const
+{
+  Result res;
+  res.module = module;
+  res.ok = res.cached = false;
+
+  QString lib = libraryName(module);
+  QString target = QDir(workDir).absoluteFilePath(lib);
+  QString key = cacheKey(module);
+  QString entry = key.isEmpty() ? QString() :
+    QDir(cache).absoluteFilePath(key + "/" + lib);
+
+  if (!entry.isEmpty() && QFile::exists(entry)) {
+    QFile::remove(target);
+    if (QFile::copy(entry, target)) {
+      res.ok = res.cached = true;
+      res.admsLog = res.cppLog =
+        QObject::tr("%1 taken from cache %2\n").arg(lib, entry);
+      return res;
+    }
+  }
+
+  // admsXml emmits C++
+  QStringList arguments;
+  arguments << "-f" << QDir::toNativeSeparators(QDir(include).absoluteFilePath("va2cpp.makefile"))
+            << QString("ADMSXML=%1").arg(admsXml)
+            << QString("PREFIX=%1").arg(prefix)
+            << QString("MODEL=%1").arg(module);
+  {
+    QMutexLocker locker(&admsLock);
+    if (!runMake(arguments, res.admsLog))
+      return res;
+  }
+
+  // build libs
+  arguments.clear();
+  arguments << "-f" << QDir::toNativeSeparators(QDir(include).absoluteFilePath("cpp2lib.makefile"))
+            << QString("PREFIX=\"%1\"").arg(prefix)
+            << QString("PROJDIR=\"%1\"").arg(QDir::toNativeSeparators(workDir))
+            << QString("MODEL=%1").arg(module);
+  if (!runMake(arguments, res.cppLog))
+    return res;
+  res.ok = QFile::exists(target);
+
+  // store a copy under a temporary name and rename it, so no other
+  // build ever picks up a partially written library
+  if (res.ok && !entry.isEmpty() && QDir().mkpath(QFileInfo(entry).path())) {
+    QString temp = entry + QString(".%1").arg(QCoreApplication::applicationPid());
+    QFile::remove(temp);
+    if (!QFile::copy(target, temp) || !QFile::rename(temp, entry))
+      QFile::remove(temp);
+  }
+  return res;
+}
+
+// One module built by a thread of buildAll(), used by QtConcurrent.
+struct VaBuildJob {
+  const VaBuilder *builder;
+  VaBuilder::Result result;
+};
+
+static void buildJob(VaBuildJob &job)
+{
+  job.result = job.builder->build(job.result.module);
+}
+
+/*!
+ * Builds the given modules distributed among several threads, all
+ * available cores by default.  The results are in the order of the
+ * modules.
+ */
+QList<VaBuilder::Result> VaBuilder::buildAll(const QStringList &modules,
+                                             int threads) const
+{
+  QList<VaBuildJob> jobs;
+  foreach (const QString &module, modules) {
+    VaBuildJob job;
+    job.builder = this;
+    job.result.module = module;
+    job.result.ok = job.result.cached = false;
+    jobs.append(job);
+  }
+
+  if (threads < 1)
+    threads = QThread::idealThreadCount();
+  if (threads > 1 && jobs.size() > 1) {
+    QThreadPool::globalInstance()->setMaxThreadCount(qMin(threads, jobs.size()));
+    QtConcurrent::blockingMap(jobs, buildJob);
+  }
+  else {
+    for (int i = 0; i < jobs.size(); i++)
+      buildJob(jobs[i]);
+  }
+
+  QList<Result> results;
+  foreach (const VaBuildJob &job, jobs)
+    results.append(job.result);
+  return results;
+}
@@ -0,0 +1,60 @@
+/***************************************************************************
+                                vabuilder.h
+                               -------------
+    begin                : Wed Oct 14 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+/*!
+ * \file vabuilder.h
+ * \brief Builds Verilog-A modules into libraries loadable by qucsator
+ *
+ * The modules are run through admsXml (va2cpp.makefile) and the C++
+ * compiler (cpp2lib.makefile).  Every library built is kept in a cache
+ * keyed by the content of the Verilog-A file and of the code generator
+ * templates, so the same module is compiled only once for all projects.
+ * The cache is ~/.qucs/vacache unless QUCS_VACACHE names another,
+ * e.g. shared, directory.
+ */
+
+#ifndef VABUILDER_H
+#define VABUILDER_H
+
+#include <QString>
+#include <QStringList>
+
+class VaBuilder
+{
+public:
+  VaBuilder(const QString &workDir);
+
+  // result of building one module
+  struct Result {
+    QString module;
+    bool ok;
+    bool cached;    // library taken from the cache
+    QString admsLog, cppLog;
+  };
+
+  Result build(const QString &module) const;
+  QList<Result> buildAll(const QStringList &modules, int threads = 0) const;
+
+  QString cacheDir() const { return cache; }
+  QString cacheKey(const QString &module) const;
+  QString libraryName(const QString &module) const;
+
+private:
+  bool runMake(const QStringList &, QString &) const;
+
+  QString make, admsXml, prefix, include, workDir, cache;
+};
+
+#endif
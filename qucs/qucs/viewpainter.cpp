@@ -23,6 +23,8 @@
 #include <QFont>
 #include <QDebug>
 #include <QPolygon>
+#include <QPolygonF>
+#include <QMatrix>
 
 ViewPainter::ViewPainter(QPainter *p)
 {
@@ -105,7 +107,6 @@ void ViewPainter::drawLine(int x1i, int y1i, int x2i, int y2i)
 void Graph::drawLines(int x0, int y0, ViewPainter *p) const
 {
   float DX_, DY_;
-  float x1, y1;
   auto Scale = p->Scale;
   auto Painter = p->Painter;
   QVector<qreal> dashes;
@@ -140,34 +141,53 @@ void Graph::drawLines(int x0, int y0, ViewPainter *p) const
   }
   Painter->setPen(pen);
 
-  auto pp = begin();
-  if(!pp->isPt())
-    pp++;
+  if(!StrokesValid)  buildStrokes();
 
   DX_ = p->DX + float(x0)*Scale;
   DY_ = p->DY + float(y0)*Scale;
 
+  // The strokes are kept in the coordinates of the diagram, so panning
+  // and zooming only changes the transformation. The pen stays cosmetic
+  // to keep its width and dashes in screen pixels.
+  pen.setCosmetic(true);
+  Painter->setPen(pen);
+  Painter->save();
+  Painter->setWorldMatrixEnabled(true);
+  Painter->setWorldMatrix(QMatrix(Scale, 0, 0, Scale, DX_, DY_));
+  foreach(const QPolygonF& s, Strokes)
+    Painter->drawPolyline(s);
+  Painter->restore();
+}
+
+// -------------------------------------------------------------
+// Puts the screen coordinates of the graph together into one polyline
+// per stroke, with the y axis pointing down.
+void Graph::buildStrokes() const
+{
+  Strokes.clear();
+
+  auto pp = begin();
+  if(!pp->isPt())
+    pp++;
+
   while(!pp->isGraphEnd()) {
     if(pp->isStrokeEnd()) ++pp; // ??
-    QPainterPath path;
+    QPolygonF s;
     if(pp->isPt()) {
-      x1 = DX_ + pp->getScrX()*Scale;
-      y1 = DY_ - pp->getScrY()*Scale;
-      path.moveTo(x1,y1);
+      s.append(QPointF(pp->getScrX(), -pp->getScrY()));
       ++pp;
     }else{
       break;
     }
 
     while(!pp->isStrokeEnd()) {
-      x1 = DX_ + pp->getScrX()*Scale;
-      y1 = DY_ - pp->getScrY()*Scale;
-      path.lineTo(x1,y1);
+      s.append(QPointF(pp->getScrX(), -pp->getScrY()));
       ++pp;
     }
 
-    Painter->drawPath(path);
+    Strokes.append(s);
   }
+  StrokesValid = true;
 }
 // -------------------------------------------------------------
 //draws the vectors of phasor diagram
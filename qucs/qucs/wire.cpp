@@ -17,6 +17,7 @@
 #include "wire.h"
 
 #include <QPainter>
+#include <QStringList>
 
 Wire::Wire(int _x1, int _y1, int _x2, int _y2, Node *n1, Node *n2)
 {
@@ -173,35 +174,40 @@ bool Wire::load(const QString& _s)
   if(s.at(s.length()-1) != '>') return false;
   s = s.mid(1, s.length()-2);   // cut off start and end character
 
+  // split the line only once instead of searching each field from its
+  // start
+  QStringList Fields = s.split(' ');
+  QStringList Quoted = s.split('"');
+
   QString n;
-  n  = s.section(' ',0,0);    // x1
+  n  = Fields.value(0);    // x1
   x1 = n.toInt(&ok);
   if(!ok) return false;
 
-  n  = s.section(' ',1,1);    // y1
+  n  = Fields.value(1);    // y1
   y1 = n.toInt(&ok);
   if(!ok) return false;
 
-  n  = s.section(' ',2,2);    // x2
+  n  = Fields.value(2);    // x2
   x2 = n.toInt(&ok);
   if(!ok) return false;
 
-  n  = s.section(' ',3,3);    // y2
+  n  = Fields.value(3);    // y2
   y2 = n.toInt(&ok);
   if(!ok) return false;
 
-  n = s.section('"',1,1);
+  n = Quoted.value(1);
   if(!n.isEmpty()) {     // is wire labeled ?
-    int nx = s.section(' ',5,5).toInt(&ok);   // x coordinate
+    int nx = Fields.value(5).toInt(&ok);   // x coordinate
     if(!ok) return false;
 
-    int ny = s.section(' ',6,6).toInt(&ok);   // y coordinate
+    int ny = Fields.value(6).toInt(&ok);   // y coordinate
     if(!ok) return false;
 
-    int delta = s.section(' ',7,7).toInt(&ok);// delta for x/y root coordinate
+    int delta = Fields.value(7).toInt(&ok);// delta for x/y root coordinate
     if(!ok) return false;
 
-    setName(n, s.section('"',3,3), delta, nx, ny);  // Wire Label
+    setName(n, Quoted.value(3), delta, nx, ny);  // Wire Label
   }
 
   return true;